@@ -527,6 +527,13 @@ TF_CAPI_EXPORT extern void TFE_AbortCollectiveOps(TFE_Context* ctx,
   collective_executor_handle->get()->StartAbort(status->status);
 }
 
+TF_CAPI_EXPORT extern void TFE_ResetCollectiveOps(TFE_Context* ctx,
+                                                  TF_Status* status) {
+  tensorflow::EagerContext* context =
+      tensorflow::ContextFromInterface(tensorflow::unwrap(ctx));
+  status->status = context->collective_executor_mgr()->Reset();
+}
+
 TF_CAPI_EXPORT extern void TFE_CollectiveOpsCheckPeerHealth(
     TFE_Context* ctx, const char* task, int64_t timeout_in_ms,
     TF_Status* status) {
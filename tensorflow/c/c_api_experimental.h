@@ -218,12 +218,20 @@ TF_CAPI_EXPORT extern void TFE_EnableCollectiveOps(TFE_Context* ctx,
 
 // Aborts all ongoing collectives with the specified status. After abortion,
 // subsequent collectives will error with this status immediately. To reset the
-// collectives, create a new EagerContext.
+// collectives, call TFE_ResetCollectiveOps or create a new EagerContext.
 //
 // This is intended to be used when a peer failure is detected.
 TF_CAPI_EXPORT extern void TFE_AbortCollectiveOps(TFE_Context* ctx,
                                                   TF_Status* status);
 
+// Makes collectives usable again after TFE_AbortCollectiveOps, without
+// creating a new EagerContext. Collective groups are formed again by the next
+// collectives, so they can include replacements of failed tasks. Must be
+// called once the aborted collectives returned, and by all the tasks of a
+// group before any of them runs collectives again.
+TF_CAPI_EXPORT extern void TFE_ResetCollectiveOps(TFE_Context* ctx,
+                                                  TF_Status* status);
+
 // Checks the health of collective ops peers. Explicit health check is needed in
 // multi worker collective ops to detect failures in the cluster.  If a peer is
 // down, collective ops may hang.
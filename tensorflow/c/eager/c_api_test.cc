@@ -150,6 +150,61 @@ void BM_Execute_Identity(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Execute_Identity)->Arg(0)->Arg(1);
 
+// Creates a new op for each execution, as the Python API does.
+void BM_Execute_NewOp(::testing::benchmark::State& state) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle(ctx);
+  TFE_TensorHandle* retvals[1];
+  int num_retvals = 1;
+  const int64_t num_allocated = tensorflow::EagerOperation::NumAllocated();
+  for (auto s : state) {
+    TFE_Op* identity = TFE_NewOp(ctx, "Identity", status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpAddInput(identity, m, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_Execute(identity, &retvals[0], &num_retvals, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteOp(identity);
+    TFE_DeleteTensorHandle(retvals[0]);
+  }
+  state.counters["operations_allocated"] =
+      tensorflow::EagerOperation::NumAllocated() - num_allocated;
+  TFE_DeleteTensorHandle(m);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+BENCHMARK(BM_Execute_NewOp);
+
+TEST(CAPI, ReuseReleasedOps) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_Op* op = TFE_NewOp(ctx, "Identity", status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_OpSetDevice(op, "/job:localhost/replica:0/task:0/device:CPU:0", status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteOp(op);
+
+  // The released op is reused, without the device of the last op.
+  const int64_t num_allocated = tensorflow::EagerOperation::NumAllocated();
+  op = TFE_NewOp(ctx, "Identity", status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_EQ(tensorflow::EagerOperation::NumAllocated(), num_allocated);
+  EXPECT_STREQ(TFE_OpGetDevice(op, status), "");
+  TFE_DeleteOp(op);
+
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 TEST(CAPI, Context) {
   TF_Status* status = TF_NewStatus();
   TFE_ContextOptions* opts = TFE_NewContextOptions();
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/c/eager/dlpack.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "include/dlpack/dlpack.h"  // from @dlpack
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
 
 namespace tensorflow {
 
@@ -260,6 +263,10 @@ void DeallocatorWrapperFunc(void* data, size_t len, void* dlmt_vptr) {
   TFE_CallDLManagedTensorDeleter(dlmt_vptr);
 }
 
+void AlignedFreeFunc(void* data, size_t len, void* arg) {
+  port::AlignedFree(data);
+}
+
 // Checks whether the stride array matches the layout of compact, row-majored
 // data.
 bool IsValidStrideCompactRowMajorData(int64_t* shape_arr, int64_t* stride_arr,
@@ -298,6 +305,9 @@ void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
   }
 
   const Tensor* tensor = GetTensorFromHandle(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
   TF_DataType data_type = static_cast<TF_DataType>(tensor->dtype());
 
   auto tf_dlm_type = GetDlDataType(data_type, status);
@@ -361,14 +371,7 @@ TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
   }
   int num_dims = dl_tensor->ndim;
   const int64_t* dims = dl_tensor->shape;
-  void* data = dl_tensor->data;
-
-  if (dl_tensor->byte_offset != 0) {
-    status->status = tensorflow::errors::InvalidArgument(
-        "Unsupported byte_offset (", dl_tensor->byte_offset,
-        ") from DLPack, must be zero");
-    return nullptr;
-  }
+  void* data = static_cast<char*>(dl_tensor->data) + dl_tensor->byte_offset;
 
   size_t total_bytes = dl_tensor->dtype.bits / 8;
   for (int i = 0; i < num_dims; i++) {
@@ -383,6 +386,25 @@ TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
     return nullptr;
   }
 
+  // Host buffers are used in place if they are aligned as the CPU kernels
+  // require. Device buffers are always used in place.
+  const size_t alignment = std::max<size_t>(1, TF_TensorDefaultAlignment());
+  if (dl_tensor->device.device_type == DLDeviceType::kDLCPU &&
+      total_bytes > 0 && reinterpret_cast<uintptr_t>(data) % alignment != 0) {
+    void* aligned_data =
+        port::AlignedMalloc(total_bytes, static_cast<int>(alignment));
+    if (aligned_data == nullptr) {
+      status->status = tensorflow::errors::ResourceExhausted(
+          "Failed to allocate ", total_bytes, " bytes for a DLPack tensor");
+      return nullptr;
+    }
+    std::memcpy(aligned_data, data, total_bytes);
+    TFE_CallDLManagedTensorDeleter(dlmt);
+    return TFE_NewTensorHandleFromDeviceMemory(
+        ctx, device_name.value().c_str(), dtype, dims, num_dims, aligned_data,
+        total_bytes, &AlignedFreeFunc, nullptr, status);
+  }
+
   TFE_TensorHandle* handle = TFE_NewTensorHandleFromDeviceMemory(
       ctx, device_name.value().c_str(), dtype, dims, num_dims, data,
       total_bytes, &DeallocatorWrapperFunc, dlmt, status);
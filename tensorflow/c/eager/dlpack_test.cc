@@ -109,5 +109,40 @@ TEST(DLPack, HandleFromDLPackStrides) {
   TF_DeleteStatus(status);
 }
 
+TEST(DLPack, HandleFromDLPackByteOffset) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  // The data starts one element into the buffer, so it is not aligned.
+  std::vector<float> data = {-1, 0, 1, 2, 3};
+  std::vector<int64_t> shape = {4};
+  DLManagedTensor dlm_in = {};
+  DLTensor* dltensor_in = &dlm_in.dl_tensor;
+  dltensor_in->data = data.data();
+  dltensor_in->byte_offset = sizeof(float);
+  dltensor_in->device = {kDLCPU, 0};
+  dltensor_in->ndim = 1;
+  dltensor_in->dtype = {kDLFloat, 32, 1};
+  dltensor_in->shape = shape.data();
+  TFE_TensorHandle* handle = TFE_HandleFromDLPack(&dlm_in, status, ctx);
+  ASSERT_NE(handle, nullptr) << TF_Message(status);
+
+  TF_Tensor* tensor = TFE_TensorHandleResolve(handle, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  EXPECT_TRUE(TF_TensorIsAligned(tensor));
+  const float* values = static_cast<const float*>(TF_TensorData(tensor));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+
+  TF_DeleteTensor(tensor);
+  TFE_DeleteTensorHandle(handle);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -104,7 +104,8 @@ TF_Tensor* TF_NewTensor(TF_DataType dtype, const int64_t* dims, int num_dims,
                         void (*deallocator)(void* data, size_t len, void* arg),
                         void* deallocator_arg) {
   TF_ManagedBuffer* buf = nullptr;
-  if (dtype != TF_STRING && dtype != TF_RESOURCE &&
+  // Empty tensors are never accessed, so their data needs no alignment.
+  if (len > 0 && dtype != TF_STRING && dtype != TF_RESOURCE &&
       tensorflow::DataTypeCanUseMemcpy(
           static_cast<tensorflow::DataType>(dtype)) &&
       reinterpret_cast<intptr_t>(data) % std::max(1, EIGEN_MAX_ALIGN_BYTES) !=
@@ -30,9 +30,11 @@ limitations under the License.
 #include "tensorflow/cc/saved_model/reader.h"
 #include "tensorflow/cc/saved_model/util.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/graph_debug_info.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -48,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
@@ -142,6 +145,37 @@ static Status ValidateSavedTensors(const GraphDef& graph_def) {
   return absl::OkStatus();
 }
 
+// Whether to drop the functions that the graph does not reach from its library
+// before loading it, e.g. the traces of functions that no signature calls.
+bool PruneUnreachableFunctionsFromEnv() {
+  static const bool prune = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_SAVED_MODEL_PRUNE_UNREACHABLE_FUNCTIONS",
+                                  false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.message();
+      return false;
+    }
+    return value;
+  }();
+  return prune;
+}
+
+// Drops the functions that `graph_def` does not reach from its library if
+// TF_SAVED_MODEL_PRUNE_UNREACHABLE_FUNCTIONS is set, so that sessions do not
+// copy and instantiate them.
+void MaybePruneUnreachableFunctions(GraphDef* graph_def) {
+  const int num_functions = graph_def->library().function_size();
+  if (!PruneUnreachableFunctionsFromEnv() || num_functions == 0) return;
+  const FunctionLibraryDefinition reachable =
+      FunctionLibraryDefinition(OpRegistry::Global(), graph_def->library())
+          .ReachableDefinitions(*graph_def);
+  *graph_def->mutable_library() = reachable.ToProto();
+  LOG(INFO) << "Pruned "
+            << num_functions - graph_def->library().function_size() << " of "
+            << num_functions << " functions unreachable from the graph";
+}
+
 Tensor CreateStringTensor(const string& value) {
   Tensor tensor(DT_STRING, TensorShape({}));
   tensor.scalar<tstring>()() = value;
@@ -301,6 +335,7 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  MaybePruneUnreachableFunctions(bundle->meta_graph_def.mutable_graph_def());
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
       session_options, bundle->meta_graph_def, &bundle->session));
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
@@ -427,6 +462,7 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   MetaGraphDef meta_graph_def;
   TF_RETURN_IF_ERROR(
       ReadMetaGraphDefFromSavedModel(export_dir, tags, &meta_graph_def));
+  MaybePruneUnreachableFunctions(meta_graph_def.mutable_graph_def());
   std::unique_ptr<Session> session;
   TF_RETURN_IF_ERROR(LoadGraphDefIntoSession(
       session_options, std::move(*meta_graph_def.mutable_graph_def()),
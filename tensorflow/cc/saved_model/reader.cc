@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -46,6 +47,126 @@ limitations under the License.
 #define IS_OSS true
 
 namespace tensorflow {
+namespace {
+
+using ::tensorflow::protobuf::internal::WireFormatLite;
+
+// Merges the meta_info_def fields of the serialized MetaGraphDef
+// `serialized_meta_graph` into `meta_info_def`, skipping the other fields.
+Status ParseMetaInfoDef(absl::string_view serialized_meta_graph,
+                        MetaInfoDef* meta_info_def) {
+  protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized_meta_graph.data()),
+      serialized_meta_graph.size());
+  while (const uint32 tag = input.ReadTag()) {
+    if (WireFormatLite::GetTagFieldNumber(tag) !=
+            MetaGraphDef::kMetaInfoDefFieldNumber ||
+        WireFormatLite::GetTagWireType(tag) !=
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      if (!WireFormatLite::SkipField(&input, tag)) {
+        return errors::DataLoss("Could not parse MetaGraphDef");
+      }
+      continue;
+    }
+    uint32 length;
+    if (!input.ReadVarint32(&length)) {
+      return errors::DataLoss("Could not parse MetaGraphDef");
+    }
+    const protobuf::io::CodedInputStream::Limit limit = input.PushLimit(length);
+    if (!meta_info_def->MergeFromCodedStream(&input) ||
+        !input.ConsumedEntireMessage()) {
+      return errors::DataLoss("Could not parse MetaInfoDef");
+    }
+    input.PopLimit(limit);
+  }
+  return absl::OkStatus();
+}
+
+// Parses the MetaGraphDef matching `tags` out of the serialized SavedModel
+// `serialized`. The other meta graphs, which may be as large, are only parsed
+// as far as their tags. Sets `*found` if a MetaGraphDef matched, and
+// `*num_meta_graphs` to the number of meta graphs in the SavedModel.
+Status ParseMetaGraphDefWithTags(absl::string_view serialized,
+                                 const std::unordered_set<string>& tags,
+                                 MetaGraphDef* meta_graph_def, bool* found,
+                                 int* num_meta_graphs) {
+  *found = false;
+  *num_meta_graphs = 0;
+  protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  while (const uint32 tag = input.ReadTag()) {
+    if (WireFormatLite::GetTagFieldNumber(tag) !=
+            SavedModel::kMetaGraphsFieldNumber ||
+        WireFormatLite::GetTagWireType(tag) !=
+            WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      if (!WireFormatLite::SkipField(&input, tag)) {
+        return errors::DataLoss("Could not parse SavedModel");
+      }
+      continue;
+    }
+    uint32 length;
+    if (!input.ReadVarint32(&length)) {
+      return errors::DataLoss("Could not parse SavedModel");
+    }
+    const int offset = input.CurrentPosition();
+    if (!input.Skip(length)) {
+      return errors::DataLoss("Could not parse SavedModel");
+    }
+    ++*num_meta_graphs;
+    if (*found) continue;
+
+    const absl::string_view serialized_meta_graph =
+        serialized.substr(offset, length);
+    MetaInfoDef meta_info_def;
+    TF_RETURN_IF_ERROR(ParseMetaInfoDef(serialized_meta_graph, &meta_info_def));
+    const std::unordered_set<string> graph_tags(meta_info_def.tags().begin(),
+                                                meta_info_def.tags().end());
+    if (graph_tags != tags) continue;
+    if (!meta_graph_def->ParseFromArray(serialized_meta_graph.data(),
+                                        serialized_meta_graph.size())) {
+      return errors::DataLoss("Could not parse MetaGraphDef");
+    }
+    *found = true;
+  }
+  return absl::OkStatus();
+}
+
+// Reads the MetaGraphDef matching `tags` from the binary SavedModel at
+// `saved_model_pb_path` with ParseMetaGraphDefWithTags().
+Status ReadMetaGraphDefFromSavedModelPb(const string& saved_model_pb_path,
+                                        const std::unordered_set<string>& tags,
+                                        MetaGraphDef* meta_graph_def) {
+  LOG(INFO) << "Reading meta graph with tags { " << absl::StrJoin(tags, " ")
+            << " } from: " << saved_model_pb_path;
+  string serialized;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(Env::Default(), saved_model_pb_path, &serialized));
+  bool found;
+  int num_meta_graphs;
+  TF_RETURN_IF_ERROR(ParseMetaGraphDefWithTags(
+      serialized, tags, meta_graph_def, &found, &num_meta_graphs));
+  // Same as saved_model::GetWriteVersion() on the whole SavedModel.
+  metrics::SavedModelReadCount(
+      num_meta_graphs == 1 && meta_graph_def->has_object_graph_def() ? "2"
+                                                                     : "1")
+      .IncrementBy(1);
+  if (!found) {
+    return Status(
+        absl::StatusCode::kNotFound,
+        strings::StrCat(
+            "Could not find meta graph def matching supplied tags: { ",
+            absl::StrJoin(tags, " "),
+            " }. To inspect available tag-sets in the SavedModel, please "
+            "use the SavedModel CLI: `saved_model_cli`"));
+  }
+  // Correct the endiness of Tensor content on big-endian system
+  if (!port::kLittleEndian) {
+    TF_RETURN_IF_ERROR(ByteSwapTensorContentInMetaGraphDef(meta_graph_def));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
 
 absl::StatusOr<MetaGraphDef*> FindMetaGraphDef(
     const std::unordered_set<string>& tags, SavedModel* saved_model_proto) {
@@ -133,6 +254,20 @@ Status ReadSavedModel(absl::string_view export_dir,
 Status ReadMetaGraphDefFromSavedModel(absl::string_view export_dir,
                                       const std::unordered_set<string>& tags,
                                       MetaGraphDef* const meta_graph_def) {
+  if (IS_OSS) {
+    const std::string saved_model_pb_path =
+        io::JoinPath(export_dir, kSavedModelFilenamePb);
+    TF_ASSIGN_OR_RETURN(
+        bool saved_model_pb_exists,
+        internal::FileExists(Env::Default(), saved_model_pb_path));
+    if (saved_model_pb_exists) {
+      // Avoids parsing the meta graphs that do not match the tags.
+      LOG(INFO) << "Reading SavedModel from: " << export_dir;
+      return ReadMetaGraphDefFromSavedModelPb(saved_model_pb_path, tags,
+                                              meta_graph_def);
+    }
+  }
+
   SavedModel saved_model_proto;
   TF_RETURN_IF_ERROR(ReadSavedModel(export_dir, &saved_model_proto));
   TF_ASSIGN_OR_RETURN(MetaGraphDef * m,
@@ -23,8 +23,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/resource_loader.h"
+#include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
 namespace {
@@ -137,6 +139,34 @@ TEST_F(ReaderTest, MetricsUpdatedSuccessfulRead) {
   EXPECT_EQ(metrics::SavedModelReadCount("1").value(), read_count_v1 + 1);
 }
 
+TEST_F(ReaderTest, ReadsOnlyTheMatchingMetaGraph) {
+  SavedModel saved_model;
+  saved_model.set_saved_model_schema_version(1);
+  MetaGraphDef* train = saved_model.add_meta_graphs();
+  train->mutable_meta_info_def()->add_tags(kSavedModelTagTrain);
+  train->mutable_graph_def()->add_node()->set_name("train_node");
+  MetaGraphDef* serve = saved_model.add_meta_graphs();
+  serve->mutable_meta_info_def()->add_tags(kSavedModelTagServe);
+  serve->mutable_meta_info_def()->add_tags(kSavedModelTagGpu);
+  serve->mutable_graph_def()->add_node()->set_name("serve_node");
+  const string export_dir =
+      io::JoinPath(testing::TmpDir(), "two_meta_graphs_saved_model");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(),
+                                io::JoinPath(export_dir, kSavedModelFilenamePb),
+                                saved_model));
+
+  MetaGraphDef meta_graph_def;
+  TF_ASSERT_OK(ReadMetaGraphDefFromSavedModel(
+      export_dir, {kSavedModelTagGpu, kSavedModelTagServe}, &meta_graph_def));
+  EXPECT_EQ(meta_graph_def.SerializeAsString(), serve->SerializeAsString());
+  TF_ASSERT_OK(ReadMetaGraphDefFromSavedModel(export_dir, {kSavedModelTagTrain},
+                                              &meta_graph_def));
+  EXPECT_EQ(meta_graph_def.SerializeAsString(), train->SerializeAsString());
+  EXPECT_TRUE(absl::IsNotFound(ReadMetaGraphDefFromSavedModel(
+      export_dir, {kSavedModelTagServe}, &meta_graph_def)));
+}
+
 // Placeholder for protosplitter merger merge test.
 
 }  // namespace
@@ -62,12 +62,15 @@ inline int64_t ExecutableSize<xla::PjRtLoadedExecutable>(
 // Cache to store compiled HLO, executables and related metadata keyed by
 // `DeviceCompilationClusterSignature`. The cache owns the stored
 // CompilationResults and Executables.
-// Currently no cache eviction policy is implemented and the cache grows without
-// bound.
+// If `capacity` is positive, the least recently used entries are evicted when
+// the cache holds more than `capacity` entries, except for pinned entries and
+// entries that are being compiled. Otherwise the cache grows without bound.
+// An evicted CompilationResult and Executable are destroyed once the
+// `keep_alive` references of the values returned for them are released.
 template <typename ExecutableType>
 class DeviceCompilationCache {
  public:
-  DeviceCompilationCache() = default;
+  explicit DeviceCompilationCache(int64_t capacity = 0) : capacity_(capacity) {}
   ~DeviceCompilationCache() = default;
 
   using Key = DeviceCompilationClusterSignature;
@@ -77,6 +80,9 @@ class DeviceCompilationCache {
     int64_t request_count = 0;
     const XlaCompiler::CompilationResult* compilation_result = nullptr;
     ExecutableType* executable = nullptr;
+    // Keeps `compilation_result` and `executable` alive if the entry is
+    // evicted.
+    std::shared_ptr<const void> keep_alive;
   };
 
   // Returns std::nullopt if value for the supplied key is not found. If a value
@@ -91,12 +97,21 @@ class DeviceCompilationCache {
   // `executable` and associates them with the provided `key`. Takes ownership
   // of `compilation_result` and `executable`. Does not increment the
   // corresponding `request_count`. Only arguments that are not std::nullopt are
-  // updated in the cache.
-  void Store(const Key& key, std::optional<DeviceCompileState> compile_state,
-             std::optional<Status> compilation_status,
-             std::optional<std::unique_ptr<XlaCompiler::CompilationResult>>
-                 compilation_result,
-             std::optional<std::unique_ptr<ExecutableType>> executable);
+  // updated in the cache. Returns a reference that keeps the stored
+  // `compilation_result` and `executable` alive if the entry is evicted.
+  std::shared_ptr<const void> Store(
+      const Key& key, std::optional<DeviceCompileState> compile_state,
+      std::optional<Status> compilation_status,
+      std::optional<std::unique_ptr<XlaCompiler::CompilationResult>>
+          compilation_result,
+      std::optional<std::unique_ptr<ExecutableType>> executable);
+
+  // Prevents the entry for `key` from being evicted, e.g. because pointers to
+  // its contents were handed out without a `keep_alive` reference.
+  void Pin(const Key& key);
+
+  // Returns the number of entries in the cache.
+  int64_t size() const;
 
   std::string DebugString() const;
 
@@ -123,6 +138,11 @@ class DeviceCompilationCache {
     // executable has been built.
     std::unique_ptr<ExecutableType> executable TF_GUARDED_BY(mu);
 
+    // When the entry was last used, and whether it may be evicted. Guarded by
+    // `compile_cache_mu_`.
+    int64_t last_use = 0;
+    bool pinned = false;
+
     std::string DebugString() const {
       mutex_lock lock(mu);
 
@@ -147,9 +167,22 @@ class DeviceCompilationCache {
     }
   };
 
+  // Returns the entry for `key`, creating it if needed, and marks it as the
+  // most recently used one.
+  std::shared_ptr<Entry> GetOrCreateEntry(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(compile_cache_mu_);
+
+  // Evicts the least recently used entries other than `key` while the cache
+  // holds more than `capacity_` entries.
+  void EvictEntries(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(compile_cache_mu_);
+
+  const int64_t capacity_;
+
   mutable mutex compile_cache_mu_;
-  absl::flat_hash_map<Key, std::unique_ptr<Entry>, Key::Hash> cache_
+  absl::flat_hash_map<Key, std::shared_ptr<Entry>, Key::Hash> cache_
       TF_GUARDED_BY(compile_cache_mu_);
+  mutable int64_t use_count_ TF_GUARDED_BY(compile_cache_mu_) = 0;
 
   DeviceCompilationCache(const DeviceCompilationCache&) = delete;
   void operator=(const DeviceCompilationCache&) = delete;
@@ -160,7 +193,7 @@ std::optional<typename DeviceCompilationCache<ExecutableType>::Value>
 DeviceCompilationCache<ExecutableType>::Lookup(const Key& key) const {
   // The outer lock protects the existence of the cache entry. It does not
   // protect the contents of the cache entry.
-  Entry* entry;
+  std::shared_ptr<Entry> entry;
   {
     mutex_lock lock(compile_cache_mu_);
     // Find cache entry.
@@ -169,7 +202,8 @@ DeviceCompilationCache<ExecutableType>::Lookup(const Key& key) const {
       return std::nullopt;
     }
 
-    entry = it->second.get();
+    entry = it->second;
+    entry->last_use = ++use_count_;
   }
 
   mutex_lock lock(entry->mu);
@@ -177,7 +211,8 @@ DeviceCompilationCache<ExecutableType>::Lookup(const Key& key) const {
                  /*compilation_status=*/entry->compilation_status,
                  /*request_count=*/++entry->request_count,
                  /*compilation_result=*/entry->compilation_result.get(),
-                 /*executable=*/entry->executable.get()};
+                 /*executable=*/entry->executable.get(),
+                 /*keep_alive=*/entry};
   return value;
 }
 
@@ -186,12 +221,10 @@ typename DeviceCompilationCache<ExecutableType>::Value
 DeviceCompilationCache<ExecutableType>::LookupOrCreate(const Key& key) {
   // The outer lock protects the existence of the cache entry. It does not
   // protect the contents of the cache entry.
-  Entry* entry;
+  std::shared_ptr<Entry> entry;
   {
     mutex_lock lock(compile_cache_mu_);
-    // Emplace empty cache entry if not found.
-    auto it = cache_.emplace(key, std::make_unique<Entry>()).first;
-    entry = it->second.get();
+    entry = GetOrCreateEntry(key);
   }
 
   mutex_lock lock(entry->mu);
@@ -199,23 +232,73 @@ DeviceCompilationCache<ExecutableType>::LookupOrCreate(const Key& key) {
                  /*compilation_status=*/entry->compilation_status,
                  /*request_count=*/++entry->request_count,
                  /*compilation_result=*/entry->compilation_result.get(),
-                 /*executable=*/entry->executable.get()};
+                 /*executable=*/entry->executable.get(),
+                 /*keep_alive=*/entry};
   return value;
 }
 
 template <typename ExecutableType>
-void DeviceCompilationCache<ExecutableType>::Store(
+std::shared_ptr<typename DeviceCompilationCache<ExecutableType>::Entry>
+DeviceCompilationCache<ExecutableType>::GetOrCreateEntry(const Key& key) {
+  // Emplace empty cache entry if not found.
+  auto [it, inserted] = cache_.try_emplace(key);
+  if (inserted) {
+    it->second = std::make_shared<Entry>();
+  }
+  it->second->last_use = ++use_count_;
+  std::shared_ptr<Entry> entry = it->second;
+  if (inserted && capacity_ > 0) {
+    EvictEntries(key);
+  }
+  return entry;
+}
+
+template <typename ExecutableType>
+void DeviceCompilationCache<ExecutableType>::EvictEntries(const Key& key) {
+  while (static_cast<int64_t>(cache_.size()) > capacity_) {
+    auto victim = cache_.end();
+    for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+      const Entry& entry = *it->second;
+      if (entry.pinned || it->first == key ||
+          (victim != cache_.end() &&
+           victim->second->last_use <= entry.last_use)) {
+        continue;
+      }
+      mutex_lock lock(entry.mu);
+      if (entry.compile_state != DeviceCompileState::kCompiling) victim = it;
+    }
+    if (victim == cache_.end()) return;
+    VLOG(2) << "Evicting cache entry: key=" << victim->first.HumanString();
+    cache_.erase(victim);
+  }
+}
+
+template <typename ExecutableType>
+void DeviceCompilationCache<ExecutableType>::Pin(const Key& key) {
+  mutex_lock lock(compile_cache_mu_);
+  auto it = cache_.find(key);
+  if (it != cache_.end()) {
+    it->second->pinned = true;
+  }
+}
+
+template <typename ExecutableType>
+int64_t DeviceCompilationCache<ExecutableType>::size() const {
+  mutex_lock lock(compile_cache_mu_);
+  return cache_.size();
+}
+
+template <typename ExecutableType>
+std::shared_ptr<const void> DeviceCompilationCache<ExecutableType>::Store(
     const Key& key, std::optional<DeviceCompileState> compile_state,
     std::optional<Status> compilation_status,
     std::optional<std::unique_ptr<XlaCompiler::CompilationResult>>
         compilation_result,
     std::optional<std::unique_ptr<ExecutableType>> executable) {
-  Entry* entry;
+  std::shared_ptr<Entry> entry;
   {
     mutex_lock lock(compile_cache_mu_);
-    // Emplace empty cache entry if not found.
-    auto it = cache_.emplace(key, std::make_unique<Entry>()).first;
-    entry = it->second.get();
+    entry = GetOrCreateEntry(key);
   }
 
   {
@@ -236,6 +319,7 @@ void DeviceCompilationCache<ExecutableType>::Store(
 
   VLOG(4) << "Added/updated cache entry: key=" << key.HumanString()
           << ", entry=" << entry->DebugString();
+  return entry;
 }
 
 template <typename ExecutableType>
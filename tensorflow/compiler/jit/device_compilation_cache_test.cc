@@ -216,5 +216,72 @@ TEST(DeviceCompilationCacheTest, StoreMultipleEntries) {
   EXPECT_EQ(cache_value_2->executable->data, "bar_exe");
 }
 
+TEST(DeviceCompilationCacheTest, EvictsLeastRecentlyUsedEntry) {
+  auto cache = std::make_unique<Cache>(/*capacity=*/2);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key3, BuildSampleSignature("baz"));
+
+  cache->Store(key1, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::make_unique<XlaCompiler::CompilationResult>(),
+               std::make_unique<FakeExecutable>("foo_exe"));
+  cache->Store(key2, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::make_unique<XlaCompiler::CompilationResult>(),
+               std::make_unique<FakeExecutable>("bar_exe"));
+  // Makes `key2` the least recently used entry.
+  EXPECT_TRUE(cache->Lookup(key1).has_value());
+  cache->Store(key3, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::make_unique<XlaCompiler::CompilationResult>(),
+               std::make_unique<FakeExecutable>("baz_exe"));
+
+  EXPECT_EQ(cache->size(), 2);
+  EXPECT_TRUE(cache->Lookup(key1).has_value());
+  EXPECT_FALSE(cache->Lookup(key2).has_value());
+  EXPECT_TRUE(cache->Lookup(key3).has_value());
+}
+
+TEST(DeviceCompilationCacheTest, DoesNotEvictPinnedOrCompilingEntries) {
+  auto cache = std::make_unique<Cache>(/*capacity=*/1);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key3, BuildSampleSignature("baz"));
+
+  cache->Store(key1, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::make_unique<XlaCompiler::CompilationResult>(),
+               std::make_unique<FakeExecutable>("foo_exe"));
+  cache->Pin(key1);
+  cache->Store(key2, DeviceCompileState::kCompiling, std::nullopt,
+               std::nullopt, std::nullopt);
+  cache->Store(key3, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::make_unique<XlaCompiler::CompilationResult>(),
+               std::make_unique<FakeExecutable>("baz_exe"));
+
+  EXPECT_EQ(cache->size(), 3);
+  EXPECT_TRUE(cache->Lookup(key1).has_value());
+  EXPECT_TRUE(cache->Lookup(key2).has_value());
+}
+
+TEST(DeviceCompilationCacheTest, KeepAliveOutlivesEviction) {
+  auto cache = std::make_unique<Cache>(/*capacity=*/1);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto key1, BuildSampleSignature("foo"));
+  TF_ASSERT_OK_AND_ASSIGN(auto key2, BuildSampleSignature("bar"));
+
+  cache->Store(key1, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::make_unique<XlaCompiler::CompilationResult>(),
+               std::make_unique<FakeExecutable>("foo_exe"));
+  std::optional<Cache::Value> cache_value = cache->Lookup(key1);
+  ASSERT_TRUE(cache_value.has_value());
+  EXPECT_NE(cache_value->keep_alive, nullptr);
+  cache->Store(key2, DeviceCompileState::kCompiled, absl::OkStatus(),
+               std::make_unique<XlaCompiler::CompilationResult>(),
+               std::make_unique<FakeExecutable>("bar_exe"));
+
+  EXPECT_FALSE(cache->Lookup(key1).has_value());
+  EXPECT_EQ(cache_value->executable->data, "foo_exe");
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -201,11 +201,20 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
 void DeviceCompilationProfiler::IncrementOngoingAsyncCompilations() {
   mutex_lock lock(mu_);
   num_ongoing_compilations_++;
+  metrics::UpdateXlaOngoingAsyncCompilations(1);
 }
 
 void DeviceCompilationProfiler::DecrementOngoingAsyncCompilations() {
   mutex_lock lock(mu_);
   num_ongoing_compilations_--;
+  metrics::UpdateXlaOngoingAsyncCompilations(-1);
+}
+
+void DeviceCompilationProfiler::RegisterAsyncCompilationStart(
+    int64_t queue_time_us) {
+  metrics::UpdateXlaAsyncCompilationQueueTime(queue_time_us);
+  VLOG(2) << "Asynchronous compilation started after " << queue_time_us
+          << " us in the queue.";
 }
 
 int64_t DeviceCompilationProfiler::GetNumOngoingAsyncCompilations() const {
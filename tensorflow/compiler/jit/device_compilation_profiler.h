@@ -81,6 +81,10 @@ class DeviceCompilationProfiler : public ResourceBase {
   void IncrementOngoingAsyncCompilations();
   void DecrementOngoingAsyncCompilations();
   int64_t GetNumOngoingAsyncCompilations() const;
+
+  // Registers the start of an asynchronous compilation that was queued for
+  // `queue_time_us`.
+  void RegisterAsyncCompilationStart(int64_t queue_time_us);
   std::string DebugString() const override;
 
  private:
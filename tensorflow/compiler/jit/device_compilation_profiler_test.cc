@@ -24,10 +24,13 @@ limitations under the License.
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 
 namespace tensorflow {
 namespace {
 
+using ::tensorflow::monitoring::testing::CellReader;
+
 TEST(DeviceCompilationProfilerTest, RegisterExecution) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -105,6 +108,28 @@ TEST(DeviceCompilationProfilerTest, OngoingAsyncCompilations) {
   EXPECT_EQ(profiler->GetNumOngoingAsyncCompilations(), 0);
 }
 
+TEST(DeviceCompilationProfilerTest, OngoingAsyncCompilationsMetric) {
+  CellReader<int64_t> ongoing_compilations(
+      "/tensorflow/core/xla_ongoing_async_compilations");
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+  DeviceCompilationProfiler* other_profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref other_profiler_ref(other_profiler);
+
+  // The metric counts the compilations of every device.
+  profiler->IncrementOngoingAsyncCompilations();
+  profiler->IncrementOngoingAsyncCompilations();
+  other_profiler->IncrementOngoingAsyncCompilations();
+  EXPECT_EQ(ongoing_compilations.Read(), 3);
+
+  other_profiler->DecrementOngoingAsyncCompilations();
+  EXPECT_EQ(ongoing_compilations.Read(), 2);
+
+  profiler->DecrementOngoingAsyncCompilations();
+  profiler->DecrementOngoingAsyncCompilations();
+  EXPECT_EQ(ongoing_compilations.Read(), 0);
+}
+
 TEST(DeviceCompilationProfilerTest, ShouldCompileClusterNotFound) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
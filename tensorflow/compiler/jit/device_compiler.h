@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 
+#include <functional>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -99,13 +101,18 @@ class DeviceCompiler : public ResourceBase {
   // `ExecutableType` and sets `out_executable` to point to it. The
   // resulting executable pointer may be null if the computation has no
   // non-constant outputs.
+  //
+  // If `out_keep_alive` is non-null, it is set to a reference that keeps the
+  // compilation result and executable alive, and they may be evicted from the
+  // cache once it is released. Otherwise they are never evicted.
   Status CompileIfNeeded(
       const XlaCompiler::Options& options, const NameAttrList& function,
       const std::vector<XlaCompiler::Argument>& args,
       const XlaCompiler::CompileOptions& compile_options,
       DeviceCompileMode compile_mode, DeviceCompilationProfiler* profiler,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      ExecutableType** out_executable);
+      ExecutableType** out_executable,
+      std::shared_ptr<const void>* out_keep_alive = nullptr);
 
   // As above, but for a single op.
   Status CompileSingleOpIfNeeded(
@@ -114,7 +121,8 @@ class DeviceCompiler : public ResourceBase {
       const XlaCompiler::CompileOptions& compile_options, OpKernelContext* ctx,
       DeviceCompilationProfiler* profiler,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      ExecutableType** out_executable);
+      ExecutableType** out_executable,
+      std::shared_ptr<const void>* out_keep_alive = nullptr);
 
   ClientType* client() const { return compiler_client_->client(); }
   const DeviceType& device_type() const { return persistor_->device_type(); }
@@ -138,7 +146,8 @@ class DeviceCompiler : public ResourceBase {
       DeviceCompileMode compile_mode, OpKernelContext* ctx,
       DeviceCompilationProfiler* profiler,
       const XlaCompiler::CompilationResult** out_compilation_result,
-      ExecutableType** out_executable);
+      ExecutableType** out_executable,
+      std::shared_ptr<const void>* out_keep_alive);
 
   StatusOr<typename DeviceCompilationCache<ExecutableType>::Value>
   CompileStrict(
@@ -160,6 +169,9 @@ class DeviceCompiler : public ResourceBase {
                              OpKernelContext* ctx,
                              DeviceCompilationProfiler* profiler);
 
+  // Runs the queued asynchronous compilation with the highest priority.
+  void RunNextAsyncCompilation();
+
   std::unique_ptr<DeviceExecutablePersistor<ExecutableType, ClientType>>
       persistor_;
   std::unique_ptr<DeviceCompilerClient<ExecutableType, ClientType>>
@@ -169,6 +181,16 @@ class DeviceCompiler : public ResourceBase {
   // Pool of threads for asynchronous compilations.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
+  // Asynchronous compilations waiting for a thread, keyed by the negated
+  // execution count of their cluster when queued and their order of arrival.
+  // Each one has been scheduled on `async_compiler_threads_`, which runs the
+  // first one.
+  mutex async_compilations_mu_;
+  std::map<std::pair<int64_t, int64_t>, std::function<void()>>
+      pending_async_compilations_ TF_GUARDED_BY(async_compilations_mu_);
+  int64_t next_async_compilation_id_ TF_GUARDED_BY(async_compilations_mu_) =
+      0;
+
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
                       DeviceCompilationClusterSignature::Hash>
@@ -213,10 +235,14 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
         compiler_client)
     : persistor_(std::move(persistor)),
       compiler_client_(std::move(compiler_client)) {
-  cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
+  cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>(
+      GetMarkForCompilationPassFlags()->tf_xla_compilation_cache_capacity);
+  const int64_t num_async_compiler_threads =
+      GetXlaOpsCommonFlags()->tf_xla_async_compilation_threads;
   async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
       tensorflow::Env::Default(), "async_compiler_threads",
-      kNumAsyncDeviceCompilerThreads);
+      num_async_compiler_threads > 0 ? num_async_compiler_threads
+                                     : kNumAsyncDeviceCompilerThreads);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -250,10 +276,12 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileIfNeeded(
     const XlaCompiler::CompileOptions& compile_options,
     DeviceCompileMode compile_mode, DeviceCompilationProfiler* profiler,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    ExecutableType** out_executable) {
+    ExecutableType** out_executable,
+    std::shared_ptr<const void>* out_keep_alive) {
   return CompileImpl(compile_options, options, function, args,
                      CompileScope::kFunction, compile_mode, /*ctx=*/nullptr,
-                     profiler, out_compilation_result, out_executable);
+                     profiler, out_compilation_result, out_executable,
+                     out_keep_alive);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -263,7 +291,8 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileSingleOpIfNeeded(
     const XlaCompiler::CompileOptions& compile_options, OpKernelContext* ctx,
     DeviceCompilationProfiler* profiler,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    ExecutableType** out_executable) {
+    ExecutableType** out_executable,
+    std::shared_ptr<const void>* out_keep_alive) {
   const NodeDef& def = ctx->op_kernel().def();
   NameAttrList name;
   name.set_name(def.op());
@@ -274,7 +303,7 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileSingleOpIfNeeded(
   name.mutable_attr()->erase("_class");
   return CompileImpl(compile_options, options, name, args, CompileScope::kOp,
                      DeviceCompileMode::kStrict, ctx, profiler,
-                     out_compilation_result, out_executable);
+                     out_compilation_result, out_executable, out_keep_alive);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -337,8 +366,9 @@ DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
 
   cache_value.compilation_result = out_compilation_result.get();
   cache_value.executable = out_executable.get();
-  cache_->Store(sig, cache_value.compile_state, cache_value.compilation_status,
-                std::move(out_compilation_result), std::move(out_executable));
+  cache_value.keep_alive = cache_->Store(
+      sig, cache_value.compile_state, cache_value.compilation_status,
+      std::move(out_compilation_result), std::move(out_executable));
 
   const uint64 compile_end_us = env->NowMicros();
   const uint64 compile_time_us = compile_end_us - compile_start_us;
@@ -365,6 +395,14 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // Don't move the above code into the thread function as it synchronously
   // updates the async compilation state!
 
+  // Clusters that have been executed the most are compiled first, since they
+  // are the most likely to benefit from compilation.
+  int64_t priority = 0;
+  if (auto stats = profiler->GetCompileStats(function); stats.ok()) {
+    priority = stats->execution_count;
+  }
+  const uint64 enqueue_time_us = tensorflow::Env::Default()->NowMicros();
+
   // When the ThreadPool for the compilation cache is destroyed, it waits for
   // compilations to have finished. This means that both 'entry' and 'this' will
   // be alive for the duration of the compilation.
@@ -372,7 +410,9 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  auto compile = [=] {
+    profiler->RegisterAsyncCompilationStart(
+        tensorflow::Env::Default()->NowMicros() - enqueue_time_us);
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
     // We don't need to lock mu, but do it anyway to satisfy thread safety
@@ -390,10 +430,30 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
-  });
+  };
+  {
+    mutex_lock lock(async_compilations_mu_);
+    pending_async_compilations_.emplace(
+        std::make_pair(-priority, next_async_compilation_id_++),
+        std::move(compile));
+  }
+  async_compiler_threads_->Schedule([this] { RunNextAsyncCompilation(); });
   return absl::OkStatus();
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType, ClientType>::RunNextAsyncCompilation() {
+  std::function<void()> compile;
+  {
+    mutex_lock lock(async_compilations_mu_);
+    DCHECK(!pending_async_compilations_.empty());
+    auto it = pending_async_compilations_.begin();
+    compile = std::move(it->second);
+    pending_async_compilations_.erase(it);
+  }
+  compile();
+}
+
 template <typename ExecutableType, typename ClientType>
 Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
@@ -402,7 +462,8 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     DeviceCompileMode compile_mode, OpKernelContext* ctx,
     DeviceCompilationProfiler* profiler,
     const XlaCompiler::CompilationResult** out_compilation_result,
-    ExecutableType** out_executable) {
+    ExecutableType** out_executable,
+    std::shared_ptr<const void>* out_keep_alive) {
   DCHECK_NE(out_executable, nullptr);
   VLOG(2) << "DeviceCompiler::Compile " << DebugString();
 
@@ -432,9 +493,8 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     VLOG(2) << "DeviceCompilationClusterSignature: " << human_signature;
   }
 
-  // Acquire the cache entry lock and compile, if necessary.
-  // TODO(phawkins): this locking will need to be restructured when we implement
-  // cache eviction.
+  // Acquire the cache entry lock and compile, if necessary. An evicted entry is
+  // created again by LookupOrCreate and compiled again under this lock.
   mutex_lock cluster_compile_lock(*cluster_mutex);
   auto cache_value = cache_->LookupOrCreate(signature);
 
@@ -495,6 +555,11 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
   TF_RETURN_IF_ERROR(cache_value.compilation_status);
   *out_compilation_result = cache_value.compilation_result;
   *out_executable = cache_value.executable;
+  if (out_keep_alive != nullptr) {
+    *out_keep_alive = std::move(cache_value.keep_alive);
+  } else {
+    cache_->Pin(signature);
+  }
   return absl::OkStatus();
 }
 
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/device_compiler_client.h"
 
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "xla/xla.pb.h"
 #include "tensorflow/core/util/determinism.h"
 
 namespace tensorflow {
@@ -40,6 +42,14 @@ xla::ExecutableBuildOptions GetExecutableBuildOptions(
   if (tensorflow::OpDeterminismRequired()) {
     build_options.mutable_debug_options()->set_xla_gpu_deterministic_ops(true);
   }
+  // Collectives are converted to asynchronous start/done pairs by XLA, but
+  // only the latency hiding scheduler moves compute between them.
+  if (result.collective_info &&
+      GetXlaOpsCommonFlags()->tf_xla_latency_hiding_scheduler_for_collectives) {
+    xla::DebugOptions* debug_options = build_options.mutable_debug_options();
+    debug_options->set_xla_gpu_enable_latency_hiding_scheduler(true);
+    debug_options->set_xla_gpu_enable_analytical_latency_estimator(true);
+  }
   return build_options;
 }
 
@@ -59,6 +59,11 @@ class DeviceCompilerClient {
   // executing before returning.
   virtual void WaitForProgramsToFinish() = 0;
 
+  // Returns a description of the device that executables are built for, e.g.
+  // its model, so that serialized executables are only loaded on matching
+  // devices. Returns an empty string if unknown.
+  virtual std::string GetDeviceDescription() const { return ""; }
+
   virtual ClientType* client() const = 0;
 
  private:
@@ -40,6 +40,26 @@ TEST(GetExecutableOptionTest, Basic) {
   EXPECT_EQ(build_option.debug_options().xla_enable_dumping(), true);
 }
 
+TEST(GetExecutableOptionTest, LatencyHidingSchedulerForCollectives) {
+  XlaCompiler::Options options;
+  XlaCompiler::CompilationResult result;
+
+  auto build_option =
+      GetExecutableBuildOptions(options, result, /*default_device_ordinal=*/-1);
+  EXPECT_FALSE(
+      build_option.debug_options().xla_gpu_enable_latency_hiding_scheduler());
+
+  result.collective_info = XlaCompiler::CompilationResult::CollectiveInfo{
+      /*group_key=*/1, /*group_size=*/2, /*next_id=*/1};
+  build_option =
+      GetExecutableBuildOptions(options, result, /*default_device_ordinal=*/-1);
+  EXPECT_EQ(build_option.num_replicas(), 2);
+  EXPECT_TRUE(
+      build_option.debug_options().xla_gpu_enable_latency_hiding_scheduler());
+  EXPECT_TRUE(build_option.debug_options()
+                  .xla_gpu_enable_analytical_latency_estimator());
+}
+
 TEST(GetExecutableOptionTest, DefaultDeviceOrdinal) {
   XlaCompiler::Options options;
   XlaCompiler::CompilationResult result;
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "xla/client/client_library.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -318,6 +320,66 @@ TEST_F(DeviceCompilerTest, CompileAsyncSuccess) {
   EXPECT_TRUE(cache_value->compilation_status.ok());
 }
 
+TEST_F(DeviceCompilerTest, CompileAsyncMostExecutedClusterFirst) {
+  for (const char* name : {"bar", "baz"}) {
+    TF_ASSERT_OK_AND_ASSIGN(auto fdef, SampleFuntionAddXY(name));
+    TF_ASSERT_OK(flib_def_->AddFunctionDef(fdef));
+  }
+
+  // With a single compiler thread, compilations requested while "foo" is
+  // compiling wait in the queue.
+  XlaOpsCommonFlags* flags = GetXlaOpsCommonFlags();
+  const int64_t old_num_threads = flags->tf_xla_async_compilation_threads;
+  flags->tf_xla_async_compilation_threads = 1;
+  XlaDeviceCompiler* xla_device_compiler = CreateXlaDeviceCompiler();
+  core::ScopedUnref xla_device_compiler_ref(xla_device_compiler);
+  flags->tf_xla_async_compilation_threads = old_num_threads;
+
+  mutex mu;
+  std::vector<std::string> compiled;
+  Notification foo_compiled, release, all_compiled;
+  EXPECT_CALL(*mock_profiler_,
+              ShouldCompileCluster(_, DeviceCompileMode::kAsync, _))
+      .WillRepeatedly(Return(true));
+  EXPECT_CALL(*mock_profiler_, RegisterCompilation(_, _, false))
+      .Times(3)
+      .WillRepeatedly([&](const NameAttrList& function, int64_t, bool) {
+        if (function.name() == "foo") {
+          foo_compiled.Notify();
+          release.WaitForNotification();
+        }
+        mutex_lock lock(mu);
+        compiled.push_back(function.name());
+        if (compiled.size() == 3) all_compiled.Notify();
+        return absl::OkStatus();
+      });
+
+  auto args = SampleArgsForAddXY();
+  auto compile = [&](const std::string& name) {
+    NameAttrList fn;
+    fn.set_name(name);
+    const XlaCompiler::CompilationResult* compilation_result = nullptr;
+    xla::LocalExecutable* xla_executable = nullptr;
+    TF_EXPECT_OK(xla_device_compiler->CompileIfNeeded(
+        GetDefaultXlaOptions(), fn, args, XlaCompiler::CompileOptions{},
+        DeviceCompileMode::kAsync, mock_profiler_, &compilation_result,
+        &xla_executable));
+  };
+  compile("foo");
+  foo_compiled.WaitForNotification();
+
+  NameAttrList baz;
+  baz.set_name("baz");
+  for (int i = 0; i < 3; ++i) mock_profiler_->RegisterExecution(baz);
+  compile("bar");
+  compile("baz");
+  release.Notify();
+
+  all_compiled.WaitForNotification();
+  mutex_lock lock(mu);
+  EXPECT_THAT(compiled, ::testing::ElementsAre("foo", "baz", "bar"));
+}
+
 TEST_F(DeviceCompilerTest, CompilePersistentCacheEnabled) {
   auto xla_device_compiler =
       CreateXlaDeviceCompiler(/*enable_persistence=*/true);
@@ -18,11 +18,23 @@ limitations under the License.
 #include <string>
 
 #include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 
 namespace tensorflow {
 
 std::string XlaSerializedCacheKeyToFileName(const XlaSerializedCacheKey& key) {
   static constexpr char kXlaSerializedCacheKeySeparator[] = "__";
+  if (key.content_addressed()) {
+    return absl::StrCat(
+        key.prefix(),
+        key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
+        DeterministicProtoHash64(key), kXlaSerializedCacheKeySeparator,
+        key.device_type(),
+        key.compiled_using_pjrt()
+            ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
+            : "",
+        ".pb");
+  }
   return absl::StrCat(
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
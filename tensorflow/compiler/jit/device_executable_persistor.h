@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "xla/client/executable_build_options.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/service/hlo.pb.h"
 #include "xla/util.h"
@@ -83,6 +84,12 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If true, entries are keyed by the HLO, the compilation options and the
+    // device description rather than by the TF cluster signature, so that
+    // processes running the same model share them, e.g. replicas pointing at
+    // a common directory. Existing entries are not overwritten.
+    bool content_addressed = false;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -129,6 +136,13 @@ class DeviceExecutablePersistor {
       uint64 signature_hash, const xla::HloModuleProto& hlo_module,
       bool compiled_using_pjrt) const;
 
+  // Returns the cache key for `compilation_result`, which is content-addressed
+  // if `content_addressed_` is set.
+  XlaSerializedCacheKey BuildSerializedCacheKey(
+      uint64 signature_hash, const XlaCompiler::Options& options,
+      const XlaCompiler::CompilationResult& compilation_result,
+      DeviceCompilerClient<ExecutableType, ClientType>* client) const;
+
   // Serializes the signature and its corresponding entry to a proto message.
   absl::StatusOr<XlaSerializedCacheEntry> SerializeEntry(
       uint64 signature_hash, const XlaCompiler::Options& options,
@@ -137,7 +151,8 @@ class DeviceExecutablePersistor {
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
   // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // construction of this class. Overwrites existing entries, unless they are
+  // content-addressed.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
 
   // Tries to read a cache entry given a `key` by searching the file directory
@@ -164,6 +179,8 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const bool content_addressed_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -177,7 +194,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      content_addressed_(config.content_addressed) {}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::GetFilePath(
@@ -217,6 +235,40 @@ DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>::
   return BuildSerializedCacheKey(signature_hash, hlo_module, true);
 }
 
+template <typename ExecutableType, typename ClientType>
+XlaSerializedCacheKey
+DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
+    uint64 signature_hash, const XlaCompiler::Options& options,
+    const XlaCompiler::CompilationResult& compilation_result,
+    DeviceCompilerClient<ExecutableType, ClientType>* client) const {
+  const xla::HloModuleProto& hlo_module =
+      compilation_result.computation->proto();
+  if (!content_addressed_) {
+    return BuildSerializedCacheKey(signature_hash, hlo_module);
+  }
+
+  XlaSerializedCacheKey key =
+      BuildSerializedCacheKey(/*signature_hash=*/0, hlo_module);
+  key.set_content_addressed(true);
+  key.set_device_description(client->GetDeviceDescription());
+  xla::ExecutableBuildOptions build_options = GetExecutableBuildOptions(
+      options, compilation_result, /*default_device_ordinal=*/-1);
+  if (auto build_options_proto = build_options.ToProto();
+      build_options_proto.ok()) {
+    // The executable is loaded for the local device, so the device ordinal it
+    // was built for does not matter.
+    build_options_proto->clear_device_ordinal();
+    key.set_compile_options_fingerprint(
+        DeterministicProtoHash64(*build_options_proto));
+  } else {
+    // Don't share entries whose compilation options are unknown.
+    VLOG(1) << "Could not fingerprint compilation options: "
+            << build_options_proto.status();
+    key.set_signature_fingerprint(signature_hash);
+  }
+  return key;
+}
+
 template <typename ExecutableType, typename ClientType>
 absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
 DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
@@ -310,11 +362,10 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SerializeEntry(
     const ExecutableType& executable,
     DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const {
   XlaSerializedCacheEntry serialized_entry;
-  const xla::HloModuleProto& hlo_module =
+  *serialized_entry.mutable_key() = BuildSerializedCacheKey(
+      signature_hash, options, compilation_result, compiler_client);
+  *serialized_entry.mutable_hlo_module() =
       compilation_result.computation->proto();
-  *serialized_entry.mutable_key() =
-      BuildSerializedCacheKey(signature_hash, hlo_module);
-  *serialized_entry.mutable_hlo_module() = hlo_module;
 
   // XLA compiler supports exporting executables as an AOT compilation result
   // to avoid running potentially expensive compilation pipeline twice.
@@ -351,8 +402,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
   const xla::HloModuleProto& hlo_module =
       compilation_result.computation->proto();
 
-  XlaSerializedCacheKey cache_key =
-      BuildSerializedCacheKey(signature_hash, hlo_module);
+  XlaSerializedCacheKey cache_key = BuildSerializedCacheKey(
+      signature_hash, options, compilation_result, compiler_client);
 
   std::optional<XlaSerializedCacheEntry> serialized_entry;
   {
@@ -388,6 +439,19 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
     return absl::OkStatus();
   }
 
+  // A content-addressed entry that exists already was published by another
+  // process for the same executable.
+  if (content_addressed_ &&
+      Env::Default()
+          ->FileExists(GetFilePath(BuildSerializedCacheKey(
+              signature_hash, options, compilation_result, client)))
+          .ok()) {
+    VLOG(1) << "Not persisting executable. It was already persisted for "
+               "signature: ["
+            << signature_str << "]";
+    return absl::OkStatus();
+  }
+
   XLA_SCOPED_LOGGING_TIMER(
       absl::StrCat("Serializing and saving cache entry: ", signature_str));
   TF_ASSIGN_OR_RETURN(XlaSerializedCacheEntry serialized_entry,
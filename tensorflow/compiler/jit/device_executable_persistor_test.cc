@@ -631,5 +631,37 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, ContentAddressedSharedAcrossSignatures) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla_content_addressed");
+  config.content_addressed = true;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  // The executable is only serialized once, since later persistence requests
+  // find the published entry.
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/456, "other_signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  // Another cluster signature with the same HLO loads the entry.
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/789, "another_signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+}
+
 }  // namespace
 }  // namespace tensorflow
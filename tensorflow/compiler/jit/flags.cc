@@ -108,6 +108,19 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_op_cost_profile",
+           &mark_for_compilation_flags->tf_xla_op_cost_profile,
+           "If non-empty, path to a StepStats proto with recorded execution "
+           "times of TF operators. Clusters whose estimated gain from XLA "
+           "compilation is not positive are not compiled."),
+      Flag("tf_xla_estimated_fusion_speedup",
+           &mark_for_compilation_flags->tf_xla_estimated_fusion_speedup,
+           "Estimated speedup of an XLA cluster over executing its operators "
+           "one by one. Only used with --tf_xla_op_cost_profile."),
+      Flag("tf_xla_cluster_launch_overhead_us",
+           &mark_for_compilation_flags->tf_xla_cluster_launch_overhead_us,
+           "Estimated overhead in microseconds of launching an XLA cluster. "
+           "Only used with --tf_xla_op_cost_profile."),
       Flag(
           "tf_xla_ops_to_cluster",
           &mark_for_compilation_flags->tf_xla_ops_to_cluster,
@@ -167,6 +180,13 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_read_only",
            &mark_for_compilation_flags->tf_xla_persistent_cache_read_only,
            "If true, the persistent cache will be read-only."),
+      Flag("tf_xla_persistent_cache_content_addressed",
+           &mark_for_compilation_flags
+                ->tf_xla_persistent_cache_content_addressed,
+           "If true, persisted executables are keyed by their HLO, "
+           "compilation options and device rather than by the TF cluster "
+           "signature, so that processes sharing the persistent cache "
+           "directory reuse each other's executables."),
       Flag("tf_xla_disable_strict_signature_checks",
            &mark_for_compilation_flags->tf_xla_disable_strict_signature_checks,
            "If true, entires loaded into the XLA compile cache will not have "
@@ -175,6 +195,12 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
            "\"xla_compile_cache\""),
+      Flag("tf_xla_compilation_cache_capacity",
+           &mark_for_compilation_flags->tf_xla_compilation_cache_capacity,
+           "If positive, the maximum number of entries in each in-memory XLA "
+           "compilation cache. The least recently used entries are evicted "
+           "beyond it, e.g. when a cluster is run with many different input "
+           "shapes. Defaults to 0, i.e. unbounded."),
       Flag("tf_xla_sparse_core_disable_table_stacking",
            &sparse_core_flags->tf_xla_sparse_core_disable_table_stacking,
            "Disable table stacking for all the tables passed to the SparseCore"
@@ -230,6 +256,9 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
+  mark_for_compilation_flags->tf_xla_op_cost_profile = "";
+  mark_for_compilation_flags->tf_xla_estimated_fusion_speedup = 2.0;
+  mark_for_compilation_flags->tf_xla_cluster_launch_overhead_us = 20;
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
   mark_for_compilation_flags->tf_xla_cpu_global_jit = false;
   mark_for_compilation_flags->tf_xla_clustering_fuel =
@@ -242,9 +271,11 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_persistent_cache_directory = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_device_types = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_read_only = false;
+  mark_for_compilation_flags->tf_xla_persistent_cache_content_addressed = false;
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_compilation_cache_capacity = 0;
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -263,6 +294,8 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_async_compilation_threads = 0;
+  ops_flags->tf_xla_latency_hiding_scheduler_for_collectives = true;
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -334,6 +367,16 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_async_compilation_threads",
+            &ops_flags->tf_xla_async_compilation_threads,
+            "If positive, the maximum number of asynchronous compilations "
+            "that run concurrently. Further compilations are queued and the "
+            "most executed clusters are compiled first."),
+       Flag("tf_xla_latency_hiding_scheduler_for_collectives",
+            &ops_flags->tf_xla_latency_hiding_scheduler_for_collectives,
+            "If true, clusters with collective ops are compiled for GPU with "
+            "the latency hiding scheduler and the analytical latency "
+            "estimator, to overlap collectives with compute."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
@@ -62,6 +62,19 @@ struct MarkForCompilationPassFlags {
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
+  // If non-empty, path to a StepStats proto (text or binary) with recorded
+  // execution times of TF nodes.  Clusters whose estimated gain from XLA
+  // compilation is not positive are not compiled.
+  string tf_xla_op_cost_profile;
+
+  // Estimated speedup of an XLA cluster over executing its operators one by
+  // one.  Only used with `tf_xla_op_cost_profile`.
+  float tf_xla_estimated_fusion_speedup;
+
+  // Estimated overhead in microseconds of launching an XLA cluster.  Only
+  // used with `tf_xla_op_cost_profile`.
+  int64_t tf_xla_cluster_launch_overhead_us;
+
   // If non-empty, limit XLA clustering to the following TF operations.
   string tf_xla_ops_to_cluster;
 
@@ -104,6 +117,11 @@ struct MarkForCompilationPassFlags {
 
   bool tf_xla_persistent_cache_read_only;
 
+  // If true, persisted executables are keyed by their HLO, compilation options
+  // and device rather than by the TF cluster signature, so that processes
+  // sharing the persistent cache directory reuse each other's executables.
+  bool tf_xla_persistent_cache_content_addressed;
+
   // If true, entries loaded into the XLA compile cache will not have their
   // signatures checked strictly. This should generally not be disabled except
   // for debugging. Defaults to false.
@@ -111,6 +129,11 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If positive, the maximum number of entries in each in-memory XLA
+  // compilation cache, beyond which the least recently used entries are
+  // evicted. Defaults to 0, i.e. unbounded.
+  int64_t tf_xla_compilation_cache_capacity;
 };
 
 // Flags associated with XLA Sparse Core.
@@ -151,6 +174,15 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If positive, the maximum number of asynchronous compilations that run
+  // concurrently. Further compilations are queued, and the clusters that have
+  // been executed the most are compiled first. Defaults to 0, i.e.
+  // kNumAsyncDeviceCompilerThreads.
+  int64_t tf_xla_async_compilation_threads;
+  // If true, clusters with collective ops are compiled for GPU with XLA's
+  // latency hiding scheduler and its analytical latency estimator, so that
+  // asynchronous collectives overlap with compute. Defaults to true.
+  bool tf_xla_latency_hiding_scheduler_for_collectives;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
@@ -105,12 +105,14 @@ class ExecutableClosure {
   explicit ExecutableClosure(
       ClientType* client, ExecutableType* executable,
       const XlaCompiler::CompilationResult* compilation_result,
-      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args)
+      ResourceVarsSnapshot resource_var_snapshots, int num_constant_args,
+      std::shared_ptr<const void> keep_alive = nullptr)
       : client_(client),
         executable_(executable),
         compilation_result_(compilation_result),
         resource_var_snapshots_(std::move(resource_var_snapshots)),
-        num_constant_args_(num_constant_args) {}
+        num_constant_args_(num_constant_args),
+        keep_alive_(std::move(keep_alive)) {}
 
   ExecutableClosure(ExecutableClosure&&) = default;
   ExecutableClosure& operator=(ExecutableClosure&&) = default;
@@ -131,6 +133,9 @@ class ExecutableClosure {
   const XlaCompiler::CompilationResult* compilation_result_;
   ResourceVarsSnapshot resource_var_snapshots_;
   int num_constant_args_;
+  // Keeps `executable_` and `compilation_result_` alive if they are evicted
+  // from the compilation cache.
+  std::shared_ptr<const void> keep_alive_;
 
   ExecutableClosure(const ExecutableClosure&) = delete;
   void operator=(const ExecutableClosure&) = delete;
@@ -373,7 +378,8 @@ Status CompileToLocalExecutable(
     DeviceCompileMode compile_mode, bool may_alias_resource_update,
     xla::LocalClient** client,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::LocalExecutable** executable) {
+    xla::LocalExecutable** executable,
+    std::shared_ptr<const void>* keep_alive = nullptr) {
   // We store information about the JIT-compiled XLA computation
   // in the ResourceMgr.
   ResourceMgr* rm = ctx->resource_manager();
@@ -416,7 +422,7 @@ Status CompileToLocalExecutable(
 
   return xla_device_compiler->CompileIfNeeded(
       options, function, args, compile_options, compile_mode, profiler,
-      compilation_result, executable);
+      compilation_result, executable, keep_alive);
 }
 
 Status GetUpdatedVariables(
@@ -494,6 +500,8 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
 
   xla::LocalClient* client;          // Not owned.
   xla::LocalExecutable* executable;  // Not owned.
+  // Keeps `compilation_result` and `executable` alive until the cluster ran.
+  std::shared_ptr<const void> keep_alive;
 
   xla::PjRtClient* pjrt_client;                // Not owned.
   xla::PjRtLoadedExecutable* pjrt_executable;  // Not owned.
@@ -573,12 +581,12 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
       ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
       xla_compiler_args, DeviceCompileMode::kStrict,
       /*may_alias_resource_update=*/true, &client, &compilation_result,
-      &executable);
+      &executable, &keep_alive);
   OP_REQUIRES_OK_ASYNC(ctx, status, done);
 
   // Continuation of the execution, may be run in a different thread.
   auto run_xla_cluster = [ctx, client, executable, compilation_result, done,
-                          inputs, resources = resources_]() {
+                          inputs, resources = resources_, keep_alive]() {
     // Separate scope so that VariableInfo locks are released before done is
     // called.
     {
@@ -739,6 +747,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
   const XlaCompiler::CompilationResult* kernel = nullptr;
   xla::LocalClient* client = nullptr;
   xla::LocalExecutable* executable = nullptr;
+  std::shared_ptr<const void> keep_alive;
   xla::PjRtClient* pjrt_client = nullptr;
   xla::PjRtLoadedExecutable* pjrt_executable = nullptr;
   ResourceVarsSnapshot variables_snapshot;
@@ -787,7 +796,8 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     } else {
       status = CompileToLocalExecutable(
           ctx, function_, has_ref_vars_, platform_info_, args, compile_mode,
-          /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+          /*may_alias_resource_update=*/false, &client, &kernel, &executable,
+          &keep_alive);
     }
     if (compile_mode != DeviceCompileMode::kLazy ||
         status.code() != error::UNIMPLEMENTED) {
@@ -840,7 +850,7 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     XlaExecutableClosureStore::KeyT key =
         XlaExecutableClosureStore::Global()->Produce(XlaExecutableClosure(
             client, executable, kernel, std::move(variables_snapshot),
-            constants_.size()));
+            constants_.size(), std::move(keep_alive)));
     compilation_key.flat<tstring>()(0) = key;
     VLOG(2) << "Compiled with XLA. compilation_key: " << key;
   }
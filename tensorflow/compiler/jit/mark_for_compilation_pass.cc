@@ -55,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -62,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -112,6 +114,17 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // Recorded execution times of TF nodes in microseconds, keyed by node
+    // name.  If set, clusters are compiled only if the estimated gain from
+    // compiling them is positive.  Clusters without any recorded node are
+    // compiled based on their size only.
+    const absl::flat_hash_map<string, int64_t>* node_costs_us;
+
+    // Estimated speedup of a compiled cluster over executing its nodes one by
+    // one, and the overhead in microseconds of launching a compiled cluster.
+    double estimated_fusion_speedup;
+    int64_t cluster_launch_overhead_us;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -147,13 +160,15 @@ class MarkForCompilationPassImpl {
    public:
     // Constructs a trivial cluster representing a single TF node.
     Cluster(int tf_graph_node_id, int effective_cluster_size,
-            bool has_functional_control_flow, DeviceSet devices,
+            std::optional<int64_t> cost_us, bool has_functional_control_flow,
+            DeviceSet devices,
             std::optional<DeviceId> resource_op_device,
             std::optional<int> resource_var_operation_node_id,
             std::optional<DeadnessPredicate> deadness_predicate,
             bool is_xla_compile_attr_true, std::optional<string> xla_scope)
         : cycles_graph_node_id_(tf_graph_node_id),
           effective_cluster_size_(effective_cluster_size),
+          cost_us_(cost_us),
           has_functional_control_flow_(has_functional_control_flow),
           devices_(std::move(devices)),
           resource_op_device_(resource_op_device),
@@ -191,6 +206,10 @@ class MarkForCompilationPassImpl {
     // The size of the cluster excluding constant and identity nodes.
     int effective_cluster_size() const { return effective_cluster_size_; }
 
+    // The total recorded execution time of nodes in the cluster in
+    // microseconds, or nullopt if no node in the cluster has a recorded cost.
+    const std::optional<int64_t>& cost_us() const { return cost_us_; }
+
     // True if the cluster has functional control flow like `If` and `While`.
     bool has_functional_control_flow() const {
       return has_functional_control_flow_;
@@ -249,6 +268,7 @@ class MarkForCompilationPassImpl {
     int cluster_size_ = 1;
     int cycles_graph_node_id_;
     int effective_cluster_size_;
+    std::optional<int64_t> cost_us_;
     bool has_functional_control_flow_;
     DeviceSet devices_;
     std::optional<DeviceId> resource_op_device_;
@@ -358,7 +378,12 @@ class MarkForCompilationPassImpl {
   void DumpPostClusteringGraphs();
   void VLogClusteringSummary();
 
+  // Returns the estimated time in microseconds saved on every execution of
+  // `cluster` by compiling it, or nullopt if the cluster has no recorded cost.
+  std::optional<int64_t> EstimatedGainUs(const Cluster& cluster) const;
+
   Cluster* MakeNewCluster(int cycles_graph_node_id, int effective_cluster_size,
+                          std::optional<int64_t> cost_us,
                           bool has_functional_control_flow,
                           const DeviceSet& device_set,
                           std::optional<DeviceId> resource_op_device,
@@ -367,7 +392,7 @@ class MarkForCompilationPassImpl {
                           bool is_xla_compile_attr_true,
                           std::optional<string> xla_scope) {
     cluster_storage_.push_back(std::make_unique<Cluster>(
-        cycles_graph_node_id, effective_cluster_size,
+        cycles_graph_node_id, effective_cluster_size, cost_us,
         has_functional_control_flow, device_set, resource_op_device,
         resource_var_operation_node_id, deadness_predicate,
         is_xla_compile_attr_true, xla_scope));
@@ -587,6 +612,9 @@ void MarkForCompilationPassImpl::Cluster::Merge(Cluster* other) {
 
   cluster_size_ += other->cluster_size_;
   effective_cluster_size_ += other->effective_cluster_size_;
+  if (other->cost_us_.has_value()) {
+    cost_us_ = cost_us_.value_or(0) + *other->cost_us_;
+  }
   has_functional_control_flow_ |= other->has_functional_control_flow_;
 
   devices_.UnionWith(other->devices_);
@@ -975,7 +1003,9 @@ Status MarkForCompilationPassImpl::CreateClusters() {
   // * are explicitly marked for compilation (_XlaCompile=true), or
   // * have more than debug_options_.xla_min_cluster_size elements (applicable
   //   only if compilation is enabled, otherwise there will be no such
-  //   candidates).
+  //   candidates) and, if their nodes have recorded costs, a positive
+  //   estimated gain from compilation.
+  absl::flat_hash_set<const Cluster*> reported_clusters;
   for (Node* n : compilation_candidates_) {
     Cluster* cluster = GetClusterForNode(n);
     TF_ASSIGN_OR_RETURN(bool should_compile_cluster,
@@ -989,9 +1019,22 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     // to (recursively) verify this fact, but that's probably not worth the
     // trouble.
 
-    if (cluster->effective_cluster_size() >= debug_options_.min_cluster_size ||
-        cluster->has_functional_control_flow() ||
-        cluster->is_xla_compile_attr_true()) {
+    std::optional<int64_t> gain_us = EstimatedGainUs(*cluster);
+    bool is_beneficial = !gain_us.has_value() || *gain_us > 0;
+    bool is_large_enough =
+        cluster->effective_cluster_size() >= debug_options_.min_cluster_size;
+    bool compile = (is_large_enough && is_beneficial) ||
+                   cluster->has_functional_control_flow() ||
+                   cluster->is_xla_compile_attr_true();
+    if (gain_us.has_value() && reported_clusters.insert(cluster).second) {
+      VLOG(2) << (compile ? "Compiling" : "Not compiling") << " cluster "
+              << cluster->DebugString(*graph_)
+              << ": effective size = " << cluster->effective_cluster_size()
+              << ", recorded cost = " << *cluster->cost_us()
+              << "us, estimated gain = " << *gain_us << "us";
+    }
+
+    if (compile) {
       string& name = cluster_names[cluster->cycles_graph_node_id()];
 
       if (name.empty()) {
@@ -1016,6 +1059,18 @@ Status MarkForCompilationPassImpl::CreateClusters() {
   return absl::OkStatus();
 }
 
+std::optional<int64_t> MarkForCompilationPassImpl::EstimatedGainUs(
+    const Cluster& cluster) const {
+  if (!cluster.cost_us().has_value()) {
+    return std::nullopt;
+  }
+  double cost_us = *cluster.cost_us();
+  double compiled_cost_us =
+      cost_us / std::max(debug_options_.estimated_fusion_speedup, 1.0);
+  return static_cast<int64_t>(cost_us - compiled_cost_us) -
+         debug_options_.cluster_launch_overhead_us;
+}
+
 Status MarkForCompilationPassImpl::DumpDebugInfo() {
   TF_RET_CHECK(initialized_ && edges_contracted_ && clusters_created_);
 
@@ -1139,6 +1194,14 @@ Status MarkForCompilationPassImpl::BuildInitialClusterSet() {
     int effective_cluster_size =
         (node->IsIdentity() || node->IsConstant()) ? 0 : 1;
 
+    std::optional<int64_t> cost_us;
+    if (debug_options_.node_costs_us != nullptr) {
+      auto it = debug_options_.node_costs_us->find(node->name());
+      if (it != debug_options_.node_costs_us->end()) {
+        cost_us = it->second;
+      }
+    }
+
     bool has_functional_control_flow = node->IsWhileNode() || node->IsIfNode();
 
     std::optional<DeadnessPredicate> deadness_predicate;
@@ -1176,6 +1239,7 @@ Status MarkForCompilationPassImpl::BuildInitialClusterSet() {
     Cluster* new_cluster = MakeNewCluster(
         /*cycles_graph_node_id=*/node->id(),
         /*effective_cluster_size=*/effective_cluster_size,
+        /*cost_us=*/cost_us,
         /*has_functional_control_flow=*/has_functional_control_flow, devices,
         resource_op_device, resource_var_operation_node_id, deadness_predicate,
         /*is_xla_compile_attr_true=*/is_xla_compile_attr_true,
@@ -1896,6 +1960,50 @@ Status MarkForCompilation(
       .Run();
 }
 
+// Returns the average recorded execution time of TF nodes in microseconds,
+// keyed by node name, from the StepStats proto in `path`.  Returns nullptr if
+// `path` is empty or the profile can't be read.
+const absl::flat_hash_map<string, int64_t>* GetNodeCostsUs(const string& path) {
+  static mutex* mu = new mutex;
+  static auto* profiles =
+      new absl::flat_hash_map<string,
+                              absl::flat_hash_map<string, int64_t>*>();
+  if (path.empty()) {
+    return nullptr;
+  }
+
+  mutex_lock lock(*mu);
+  auto it = profiles->find(path);
+  if (it != profiles->end()) {
+    return it->second;
+  }
+
+  absl::flat_hash_map<string, int64_t>* node_costs_us = nullptr;
+  StepStats step_stats;
+  Status status = ReadTextOrBinaryProto(Env::Default(), path, &step_stats);
+  if (status.ok()) {
+    absl::flat_hash_map<string, std::pair<int64_t, int64_t>> totals;
+    for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+      for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+        auto& [total_us, count] = totals[node_stats.node_name()];
+        total_us += node_stats.all_end_rel_micros();
+        ++count;
+      }
+    }
+    node_costs_us = new absl::flat_hash_map<string, int64_t>();
+    for (const auto& [node_name, total] : totals) {
+      (*node_costs_us)[node_name] = total.first / total.second;
+    }
+    VLOG(1) << "Loaded recorded costs of " << node_costs_us->size()
+            << " nodes from " << path;
+  } else {
+    LOG(WARNING) << "Failed to read the op cost profile " << path
+                 << ", clustering ignores op costs: " << status;
+  }
+  (*profiles)[path] = node_costs_us;
+  return node_costs_us;
+}
+
 std::atomic<int64_t>* GetPointerToFuel(int64_t initial_value) {
   static std::atomic<int64_t>* fuel = [&]() {
     std::atomic<int64_t>* fuel = new std::atomic<int64_t>;
@@ -1922,6 +2030,11 @@ Status MarkForCompilationPass::Run(
       flags->tf_xla_deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.node_costs_us = GetNodeCostsUs(flags->tf_xla_op_cost_profile);
+  debug_options.estimated_fusion_speedup =
+      flags->tf_xla_estimated_fusion_speedup;
+  debug_options.cluster_launch_overhead_us =
+      flags->tf_xla_cluster_launch_overhead_us;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1941,6 +2054,11 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.node_costs_us = GetNodeCostsUs(flags->tf_xla_op_cost_profile);
+  debug_options.estimated_fusion_speedup =
+      flags->tf_xla_estimated_fusion_speedup;
+  debug_options.cluster_launch_overhead_us =
+      flags->tf_xla_cluster_launch_overhead_us;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -48,10 +49,13 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_def_builder_util.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 
 using ::tensorflow::testing::FindNodeByName;
@@ -142,6 +146,59 @@ TEST(XlaCompilationTest, Chains) {
   EXPECT_TRUE(clusters.find("D") == clusters.cend());
 }
 
+// Writes a StepStats profile that records `cost_us` for each of `nodes` and
+// returns its path.
+string WriteOpCostProfile(const string& name,
+                          const std::vector<string>& nodes, int64_t cost_us) {
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  for (const string& node : nodes) {
+    NodeExecStats* node_stats = dev_stats->add_node_stats();
+    node_stats->set_node_name(node);
+    node_stats->set_all_end_rel_micros(cost_us);
+  }
+  string path = io::JoinPath(testing::TmpDir(), name);
+  TF_CHECK_OK(WriteTextProto(Env::Default(), path, step_stats));
+  return path;
+}
+
+TEST(XlaCompilationTest, OpCostProfile) {
+  auto build_graph = [](std::unique_ptr<Graph>* graph) {
+    *graph = std::make_unique<Graph>(OpRegistry::Global());
+    GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+    Node* a =
+        ops::SourceOp("UncompilableNullary", builder.opts().WithName("A"));
+    Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+    Node* c = ops::UnaryOp("Relu", b, builder.opts().WithName("C"));
+    Node* d = ops::UnaryOp("Relu", c, builder.opts().WithName("D"));
+    ops::UnaryOp("Relu", d, builder.opts().WithName("E"));
+    TF_EXPECT_OK(GraphDefBuilderToGraph(builder, graph->get()));
+  };
+
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  MarkForCompilationPassFlags saved_flags = *flags;
+  flags->tf_xla_estimated_fusion_speedup = 2.0;
+  flags->tf_xla_cluster_launch_overhead_us = 20;
+
+  // The cluster is large enough, but compiling it costs more than it saves.
+  std::unique_ptr<Graph> graph;
+  build_graph(&graph);
+  flags->tf_xla_op_cost_profile =
+      WriteOpCostProfile("cheap_ops.pbtxt", {"B", "C", "D", "E"}, 5);
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  EXPECT_TRUE(GetClusters(*graph).empty());
+
+  build_graph(&graph);
+  flags->tf_xla_op_cost_profile =
+      WriteOpCostProfile("expensive_ops.pbtxt", {"B", "C", "D", "E"}, 100);
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(4, clusters.size());
+  EXPECT_EQ(clusters["B"], clusters["E"]);
+
+  *flags = saved_flags;
+}
+
 TEST(XlaCompilationTest, UncompilableCycles) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
   {
@@ -19,6 +19,8 @@ limitations under the License.
 #include <string>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
+
 namespace tensorflow {
 
 xla::CompileOptions GetPjRtCompileOptions(
@@ -88,4 +90,10 @@ void PjRtDeviceCompilerClient::WaitForProgramsToFinish() {
                "finish isn't necessary.";
 }
 
+std::string PjRtDeviceCompilerClient::GetDeviceDescription() const {
+  if (client_ == nullptr) return "";
+  return absl::StrCat(client_->platform_name(), ";",
+                      client_->platform_version());
+}
+
 }  // namespace tensorflow
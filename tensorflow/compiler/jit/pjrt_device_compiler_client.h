@@ -66,6 +66,9 @@ class PjRtDeviceCompilerClient
   // necessary.
   void WaitForProgramsToFinish() override;
 
+  // Returns the platform name and version of the client.
+  std::string GetDeviceDescription() const override;
+
   xla::PjRtClient* client() const override { return client_; }
 
  private:
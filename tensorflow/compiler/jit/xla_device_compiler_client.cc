@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "xla/client/local_client.h"
 
 namespace tensorflow {
@@ -113,4 +114,15 @@ void XlaDeviceCompilerClient::WaitForProgramsToFinish() {
   }
 }
 
+std::string XlaDeviceCompilerClient::GetDeviceDescription() const {
+  if (client_ == nullptr) return "";
+
+  auto executor =
+      client_->backend().stream_executor(client_->default_device_ordinal());
+  if (!executor.ok()) return "";
+  const auto& description = (*executor)->GetDeviceDescription();
+  return absl::StrCat(description.name(), ";", description.model_str(), ";",
+                      description.platform_version());
+}
+
 }  // namespace tensorflow
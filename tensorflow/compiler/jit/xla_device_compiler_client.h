@@ -55,6 +55,9 @@ class XlaDeviceCompilerClient
 
   void WaitForProgramsToFinish() override;
 
+  // Returns the name, model and platform version of the default device.
+  std::string GetDeviceDescription() const override;
+
   xla::LocalClient* client() const override { return client_; }
 
  private:
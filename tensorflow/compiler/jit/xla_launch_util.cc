@@ -49,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_serving_device_selector.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -819,6 +820,33 @@ xla::ExecuteOptions GetPjRtExecuteOptions(
   return options;
 }
 
+// Returns the number of bytes copied between TF tensors and XLA buffers when
+// running `compilation_result` with PJRT. Arguments and outputs alias XLA
+// buffers, except that XLA copies resource variables updated in place whose
+// buffers can't be donated, and constant outputs are copied to the device.
+static int64_t PjRtLaunchCopiedBytes(
+    const absl::flat_hash_map<int, const Tensor*>& variable_snapshots,
+    const XlaCompiler::CompilationResult& compilation_result,
+    const DeviceType& device_type) {
+  int64_t copied_bytes = 0;
+  for (const XlaCompiler::ResourceUpdate& update :
+       compilation_result.resource_updates) {
+    auto it = variable_snapshots.find(update.input_index);
+    if (it != variable_snapshots.end() && !it->second->RefCountIsOne()) {
+      copied_bytes += it->second->TotalBytes();
+    }
+  }
+  if (device_type != DEVICE_CPU) {
+    for (const XlaCompiler::OutputDescription& output :
+         compilation_result.outputs) {
+      if (output.is_constant) {
+        copied_bytes += output.constant_value.TotalBytes();
+      }
+    }
+  }
+  return copied_bytes;
+}
+
 DeviceType GetDeviceType(OpKernelContext* ctx) {
   auto* device =
       tensorflow::down_cast<Device*>(ctx->device()->UnderlyingDevice());
@@ -878,6 +906,10 @@ Status RunPjRtExecutable(
                         executable->FingerprintExecutable());
     device_selector_resource->selector()->Enqueue(pjrt_device_id, fingerprint);
   }
+  // Buffers are only donated if nothing else references them, so copies must
+  // be accounted for before running the executable.
+  const int64_t copied_bytes = PjRtLaunchCopiedBytes(
+      variable_snapshots, compilation_result, device_type);
   TF_ASSIGN_OR_RETURN(
       std::vector<std::unique_ptr<xla::PjRtBuffer>> execute_outputs,
       RunPjRtExecutable(num_missing_prefix_ctx_inputs, inputs,
@@ -892,6 +924,10 @@ Status RunPjRtExecutable(
   TF_RETURN_IF_ERROR(PopulateCtxOutputsFromPjRtExecutableOutputs(
       num_missing_prefix_ctx_inputs, inputs, updated_variables,
       compilation_result, use_pjrt_tensor_buffer, execute_outputs, ctx));
+
+  VLOG(2) << "Copied " << copied_bytes
+          << " bytes between TF tensors and XLA buffers";
+  metrics::RecordXlaLaunchCopiedBytes(copied_bytes);
   return absl::OkStatus();
 }
 
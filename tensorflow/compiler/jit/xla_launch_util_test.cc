@@ -43,6 +43,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
@@ -51,6 +53,8 @@ limitations under the License.
 
 namespace tensorflow {
 namespace {
+using ::tensorflow::monitoring::testing::CellReader;
+using ::tensorflow::monitoring::testing::Histogram;
 using PjRtDeviceCompiler =
     DeviceCompiler<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 using PjRtDeviceExecutablePersistor =
@@ -215,13 +219,14 @@ class PjRtExecutionUtilTest : public OpsTestBase {
                                        exe_options);
   }
 
-  // Creates a Variable. Doesn't add it to the resource manager.
+  // Creates a Variable, which is the only reference to its value. Doesn't add
+  // it to the resource manager.
   template <typename T>
   Var* CreateVariable(const string& name, const TensorShape& shape,
                       const gtl::ArraySlice<T> data) {
     Tensor* init_var_value = CreateDeviceTensor<T>(shape, data);
     Var* var = new Var(DataTypeToEnum<T>::v());
-    *var->tensor() = *init_var_value;
+    *var->tensor() = std::move(*init_var_value);
     var->is_initialized = true;
 
     return var;
@@ -250,6 +255,57 @@ class PjRtExecutionUtilTest : public OpsTestBase {
     inputs_.push_back({nullptr, input});
   }
 
+  // Runs AssignAddVariableOp on an int32[1, 3] variable with RunPjRtExecutable.
+  // If `share_variable`, the value of the variable is also referenced by
+  // another tensor while the executable runs, so it can't be donated.
+  void RunAssignAddVariable(bool share_variable) {
+    XlaOpRegistry::RegisterCompilationKernels();
+    TF_ASSERT_OK(
+        NodeDefBuilder("AssignAddVariableOp", "AssignAddVariableOp")
+            .Input(FakeInput(DT_RESOURCE))
+            .Input(FakeInput(DT_INT32))
+            .Attr("dtype", DT_INT32)
+            .Device("/job:localhost/replica:0/task:0/device:XLA_CPU:0")
+            .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+
+    AddVariableInput<int32>("var", TensorShape({1, 3}), {1, 2, 3});
+    Tensor* a = CreateDeviceTensor<int32>(TensorShape({1, 3}), {2, 2, 2});
+    inputs_.push_back({nullptr, a});
+
+    CreateContext();
+
+    std::vector<const Tensor*> inputs = InputsFromContext(context_.get());
+    std::vector<int> variables_indices =
+        GetResourceVariableIndicesFromContext(context_.get());
+    std::vector<VariableInfo> variables;
+    variables.reserve(variables_indices.size());
+    TF_ASSERT_OK(GetVariableInfosFromInputs(context_->resource_manager(),
+                                            context_->device(), inputs,
+                                            variables_indices, &variables));
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::vector<int> constant_input_indices,
+        GetConstantInputIndicesFromContext(context_.get()));
+    TF_ASSERT_OK(LockVariables(absl::MakeSpan(variables)));
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::vector<XlaCompiler::Argument> args,
+        XlaComputationLaunchContext::BuildXlaCompilerArguments(
+            constant_input_indices, inputs, variables,
+            static_cast<Device*>(context_->device())));
+
+    const XlaCompiler::CompilationResult* result;
+    xla::PjRtLoadedExecutable* executable;
+    CompileToExecutable(args, &result, &executable);
+
+    ASSERT_EQ(variables.size(), 1);
+    Tensor shared_value;
+    if (share_variable) {
+      shared_value = *variables[0].var()->tensor();
+    }
+    TF_ASSERT_OK(RunPjRtExecutable(inputs, variables, *result, pjrt_client_,
+                                   executable, context_.get()));
+  }
+
  protected:
   DeviceContext* device_context_;
   Allocator* host_allocator_;
@@ -569,6 +625,27 @@ TEST_F(PjRtExecutionUtilTest, RunPjRtExecutable) {
   test::ExpectTensorEqual<int32>(*expected, *GetOutput(0));
 }
 
+TEST_F(PjRtExecutionUtilTest, RunPjRtExecutableDonatedVariableCopiedBytes) {
+  CellReader<Histogram> copied_bytes(
+      "/tensorflow/core/xla_launch_copied_bytes");
+  RunAssignAddVariable(/*share_variable=*/false);
+
+  Histogram histogram = copied_bytes.Delta();
+  EXPECT_FLOAT_EQ(histogram.num(), 1.0);
+  EXPECT_FLOAT_EQ(histogram.sum(), 0.0);
+}
+
+TEST_F(PjRtExecutionUtilTest, RunPjRtExecutableSharedVariableCopiedBytes) {
+  CellReader<Histogram> copied_bytes(
+      "/tensorflow/core/xla_launch_copied_bytes");
+  RunAssignAddVariable(/*share_variable=*/true);
+
+  // XLA copies the variable, whose value can't be donated.
+  Histogram histogram = copied_bytes.Delta();
+  EXPECT_FLOAT_EQ(histogram.num(), 1.0);
+  EXPECT_FLOAT_EQ(histogram.sum(), 3 * sizeof(int32));
+}
+
 TEST_F(PjRtExecutionUtilTest,
        RunPjRtExecutableWithVariableSnapshotsAndMissingInputs) {
   XlaOpRegistry::RegisterCompilationKernels();
@@ -78,6 +78,9 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  persistor_config.content_addressed =
+      GetMarkForCompilationPassFlags()
+          ->tf_xla_persistent_cache_content_addressed;
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -225,6 +228,9 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  persistor_config.content_addressed =
+      GetMarkForCompilationPassFlags()
+          ->tf_xla_persistent_cache_content_addressed;
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
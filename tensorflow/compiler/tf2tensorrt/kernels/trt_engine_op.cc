@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include <algorithm>
 #include <memory>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -46,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/env_var.h"
@@ -188,13 +191,24 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& input_concrete_shapes,
       OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
 
-  // Builds and returns a cuda engine for the input shapes. If building the
-  // engine fails, enters a dummy entry into the cache_resource cache so we
-  // don't continually try to build the same failing engine.
+  // Builds and returns a cuda engine for the input shapes on the device named
+  // `device_name`. `ctx` is only needed if the segment has resource inputs.
+  // If building the engine fails, callers enter a dummy entry into the
+  // cache_resource cache so we don't continually try to build the same
+  // failing engine.
   StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> BuildEngine(
       const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
       bool use_calibration, TRTInt8Calibrator* calibrator,
-      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
+      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx,
+      const string& device_name);
+
+  // Schedules building an engine for the input shapes on a background thread,
+  // unless one is already being built. The engine is added to the cache once
+  // it is built.
+  void BuildEngineInBackground(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_res)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
 
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
@@ -276,6 +290,17 @@ class TRTEngineOp : public AsyncOpKernel {
 
   // Whether to use explicit precision (QDQ) mode.
   bool use_explicit_precision_;
+
+  // Whether engines for new input shapes are built on a background thread
+  // while the native segment serves the requests that need them.
+  bool build_engines_in_background_;
+
+  // Input shapes of the engines that are being built in the background.
+  std::set<string> pending_engine_builds_ TF_GUARDED_BY(engine_mutex_);
+
+  // Declared last so that pending engine builds finish before the rest of the
+  // op is destroyed.
+  std::unique_ptr<thread::ThreadPool> engine_build_pool_;
 };
 
 #define TYPECASE(dt, X)                                       \
@@ -550,6 +575,21 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
       [](PartialTensorShape shape) { return !shape.IsFullyDefined(); });
   VLOG(2) << "TRTEngineOp has_dynamic_shape_input_: "
           << has_dynamic_shape_input_;
+
+  bool build_engines_in_background = false;
+  OP_REQUIRES_OK(context,
+                 ReadBoolFromEnvVar("TF_TRT_BUILD_ENGINES_IN_BACKGROUND",
+                                    /*default_val=*/false,
+                                    &build_engines_in_background));
+  // Engines built in the background have no OpKernelContext to read resource
+  // inputs from, and explicit batch engines share their optimization
+  // profiles with the engines that are running.
+  build_engines_in_background_ =
+      build_engines_in_background && use_implicit_batch_ && !static_engine_ &&
+      !native_segment_absent_ && !use_calibration_ &&
+      absl::c_all_of(input_mask_, [](bool is_engine_input) {
+        return is_engine_input;
+      });
 }
 
 // Copies input tensor ctx->input(i) (which is in device memory) to the host,
@@ -1087,11 +1127,11 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
-    TRTEngineCacheResource* cache_resource, OpKernelContext* ctx) {
+    TRTEngineCacheResource* cache_resource, OpKernelContext* ctx,
+    const string& device_name) {
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::BuildEngine", tensorflow::profiler::TraceMeLevel::kInfo);
   TRT_ENSURE(cache_resource);
-  TRT_ENSURE(ctx);
   // Use concrete shapes for implicit batch mode and partial shapes for
   // explicit batch mode.
   bool use_concrete_shapes =
@@ -1107,9 +1147,8 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
 
   std::unordered_map<string, tensorflow::DeviceProperties> device_map;
   DeviceNameUtils::ParsedName full_parsed_name;
-  DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
-  device_map.emplace(ctx->device()->name(),
-                     grappler::GetDeviceInfo(full_parsed_name));
+  DeviceNameUtils::ParseFullName(device_name, &full_parsed_name);
+  device_map.emplace(device_name, grappler::GetDeviceInfo(full_parsed_name));
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
@@ -1118,21 +1157,71 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
       conversion_input_shapes, &logger, cache_resource->allocator_.get(),
       calibrator, &engine, use_calibration, use_implicit_batch_, nullptr,
       &cache_resource->profiles_, name(), use_explicit_precision_, &cluster,
-      ctx->device()->name());
+      device_name);
   if (!status.ok()) {
     LOG_FIRST_FEW_WARNING_WITH_PREFIX
         << "Engine creation for " << name() << " failed. "
         << "The native segment will be used instead. "
         << "Reason: " << status;
-    // Store an empty engine in the cache for these input shapes so we don't try
-    // to build the same failing engine again.
-    cache_resource->cache_.emplace(input_concrete_shapes,
-                                   std::make_unique<EngineContext>());
     return status;
   }
   return engine;
 }
 
+void TRTEngineOp::BuildEngineInBackground(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_res) {
+  const string shapes_key =
+      TensorShapeUtils::ShapeListString(input_concrete_shapes);
+  if (!pending_engine_builds_.insert(shapes_key).second) return;
+  if (!engine_build_pool_) {
+    engine_build_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "trt_engine_build", /*num_threads=*/1);
+  }
+  VLOG(1) << "Building a TensorRT engine for " << name()
+          << " in the background for input shapes: " << shapes_key;
+
+  const int platform_device_id =
+      ctx->device()->tensorflow_accelerator_device_info()->gpu_id;
+  cache_res->Ref();
+  engine_build_pool_->Schedule([this, input_concrete_shapes, batch_size,
+                                platform_device_id,
+                                device_name = ctx->device()->name(),
+                                cache_res, shapes_key]() {
+    core::ScopedUnref sc(cache_res);
+    if (cudaSetDevice(platform_device_id) != cudaSuccess) {
+      LOG(ERROR) << "Couldn't set cuda device to " << platform_device_id
+                 << " in engine build thread";
+    }
+    auto result = BuildEngine(input_concrete_shapes, batch_size,
+                              /*use_calibration=*/false,
+                              /*calibrator=*/nullptr, cache_res,
+                              /*ctx=*/nullptr, device_name);
+
+    mutex_lock lock(engine_mutex_);
+    pending_engine_builds_.erase(shapes_key);
+    std::vector<ExecutionContext> exec_contexts;
+    Status status = result.status();
+    if (status.ok()) {
+      status = cache_res->profiles_.CreateExecutionContexts(
+          result.value().get(), &exec_contexts);
+    }
+    if (!status.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache_res->cache_.emplace(input_concrete_shapes,
+                                std::make_unique<EngineContext>());
+      return;
+    }
+    cache_res->cache_.emplace(
+        input_concrete_shapes,
+        std::make_unique<EngineContext>(std::move(result.value()),
+                                        std::move(exec_contexts)));
+    VLOG(1) << "Added new engine built in the background to cache of "
+            << name() << ". Cache size: " << cache_res->cache_.size();
+  });
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1220,8 +1309,12 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       }
       auto result = BuildEngine(input_concrete_shapes, batch_size,
                                 /*use_calibration=*/false,
-                                /*calibrator=*/nullptr, cache_res, ctx);
+                                /*calibrator=*/nullptr, cache_res, ctx,
+                                ctx->device()->name());
       if (!result.ok()) {
+        // Store an empty engine in the cache for these input shapes so we
+        // don't try to build the same failing engine again.
+        cache.emplace(input_concrete_shapes, std::make_unique<EngineContext>());
         return std::pair<EngineContext*, int>(&empty_context, 0);
       }
       static_engine = std::move(result.value());
@@ -1290,12 +1383,22 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
+    // Serve the requests with the native segment while the engine is built.
+    if (build_engines_in_background_ && AllowEngineNativeSegmentExecution()) {
+      BuildEngineInBackground(input_concrete_shapes, batch_size, ctx,
+                              cache_res);
+      return std::pair<EngineContext*, int>(&empty_context, 0);
+    }
+
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto result =
         BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
-                    calibrator_.get(), cache_res, ctx);
+                    calibrator_.get(), cache_res, ctx, ctx->device()->name());
     if (!result.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache.emplace(input_concrete_shapes, std::make_unique<EngineContext>());
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
     TrtUniquePtrType<nvinfer1::ICudaEngine> engine = std::move(result.value());
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdlib>
 #include <memory>
 #include <numeric>
 #include <utility>
@@ -172,7 +173,7 @@ class TRTEngineOpTestBase : public OpsTestBase {
     tensors_.clear();
   }
 
- private:
+ protected:
   Status InitOpWithFunctionLibrary() {
     OpKernel* kernel = nullptr;
     auto flr = pflr_->GetFLR(device_->name());
@@ -283,6 +284,43 @@ TEST_F(TRTEngineOpTestBase, AllowBuildAtRuntime) {
   EXPECT_EQ(ectx->GetCudaEngine(), nullptr);
 }
 
+TEST_F(TRTEngineOpTestBase, BuildEnginesInBackground) {
+  setenv("TF_TRT_BUILD_ENGINES_IN_BACKGROUND", "true", /*overwrite=*/1);
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT);
+  unsetenv("TF_TRT_BUILD_ENGINES_IN_BACKGROUND");
+
+  // The native segment serves the request while the engine is built.
+  TensorShape input_shape({2, 2});
+  TRTEngineOpTestBase::AddSimpleInput<float>(input_shape);
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  Tensor* output = OpsTestBase::GetOutput(0);
+  EXPECT_THAT(absl::Span<const float>(output->flat<float>().data(),
+                                      output->NumElements()),
+              ElementsAre(0.0f, 2.0f, 4.0f, 6.0f));
+
+  // Destroying the op waits for the engine build.
+  kernel_.reset();
+  TRTEngineCacheResource* cache_resource = nullptr;
+  TF_ASSERT_OK(device_->resource_manager()->Lookup(
+      std::string(kTfTrtContainerName), std::string(kOpName), &cache_resource));
+  core::ScopedUnref sc(cache_resource);
+  auto cache = &cache_resource->cache_;
+  EXPECT_EQ(1, cache->size());
+  ASSERT_EQ(1, cache->count({input_shape}));
+  EngineContext* ectx = cache->at({input_shape}).get();
+  EXPECT_NE(ectx->GetCudaEngine(), nullptr);
+
+  // A new op with the same name uses the engine in the cache.
+  TF_ASSERT_OK(InitOpWithFunctionLibrary());
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  output = OpsTestBase::GetOutput(0);
+  EXPECT_THAT(absl::Span<const float>(output->flat<float>().data(),
+                                      output->NumElements()),
+              ElementsAre(0.0f, 2.0f, 4.0f, 6.0f));
+  EXPECT_EQ(1, cache->size());
+  EXPECT_EQ(ectx, cache->at({input_shape}).get());
+}
+
 TEST_P(TRTEngineOpTestWithParam, ExplicitBatch) {
   // Test inference in explicit batch mode with static input shapes. Static
   // shapes in this context means that the TensorRT knows all the input shapes
@@ -241,8 +241,8 @@ void BaseCollectiveExecutor::StartAbort(const Status& s) {
         s.code(),
         absl::StrCat(
             "Collective ops is aborted by: ", s.message(),
-            "\nThe error could be from a previous operation. Restart your "
-            "program to reset.")));
+            "\nThe error could be from a previous operation. Reset the "
+            "collective ops or restart your program to reset.")));
     status = status_;
   }
   LOG(ERROR) << "BaseCollectiveExecutor::StartAbort " << s;
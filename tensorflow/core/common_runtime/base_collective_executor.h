@@ -19,6 +19,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
+#include "tensorflow/core/common_runtime/collective_compression.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
@@ -120,6 +121,10 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
     return remote_access_.get();
   }
 
+  CollectiveCompressionResiduals* compression_residuals() override {
+    return &compression_residuals_;
+  }
+
   void RunClosure(std::function<void()> closure) override {
     work_queue_->Schedule(std::move(closure));
   }
@@ -148,6 +153,7 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   std::unordered_map<int32, int32> launched_ TF_GUARDED_BY(launch_mu_);
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
+  CollectiveCompressionResiduals compression_residuals_;
 
  private:
   Status CreateCollective(const CollectiveParams& col_params,
@@ -48,6 +48,9 @@ string BuildGraphOptions::DebugString() const {
       break;
   }
   strings::StrAppend(&rv, "\ncollective_order: ", collective_order_str);
+  if (!optimize_graph) {
+    strings::StrAppend(&rv, "\noptimize_graph: false");
+  }
   return rv;
 }
 
@@ -40,6 +40,10 @@ struct BuildGraphOptions {
   // edges, if `kAttrs` encode as attribute on collective op.
   GraphCollectiveOrder collective_order = GraphCollectiveOrder::kNone;
 
+  // If `false`, the client graph is built from the original graph without
+  // running Grappler on it.
+  bool optimize_graph = true;
+
   string DebugString() const;
 };
 
@@ -0,0 +1,240 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+std::unordered_map<string, CollectiveCompressorRegistry::Factory>*
+CompressorFactories() {
+  static auto* factories =
+      new std::unordered_map<string, CollectiveCompressorRegistry::Factory>;
+  return factories;
+}
+
+bool IsFloatType(DataType dtype) {
+  return dtype == DT_FLOAT || dtype == DT_DOUBLE;
+}
+
+// Encodes each element as a bfloat16, halving the size of float chunks.
+class BF16Compressor : public CollectiveCompressor {
+ public:
+  bool SupportsType(DataType dtype) const override {
+    return IsFloatType(dtype);
+  }
+
+  int64_t EncodedBytes(DataType dtype, int64_t num_elements) const override {
+    return num_elements * sizeof(bfloat16);
+  }
+
+  void Encode(const Tensor& chunk, Tensor* residual,
+              Tensor* encoded) const override {
+    if (chunk.dtype() == DT_FLOAT) {
+      EncodeT<float>(chunk, residual, encoded);
+    } else {
+      EncodeT<double>(chunk, residual, encoded);
+    }
+  }
+
+  void Decode(const Tensor& encoded, Tensor* chunk) const override {
+    if (chunk->dtype() == DT_FLOAT) {
+      DecodeT<float>(encoded, chunk);
+    } else {
+      DecodeT<double>(encoded, chunk);
+    }
+  }
+
+ private:
+  template <typename T>
+  static void EncodeT(const Tensor& chunk, Tensor* residual, Tensor* encoded) {
+    auto in = chunk.flat<T>();
+    auto r = residual->flat<T>();
+    bfloat16* out = reinterpret_cast<bfloat16*>(encoded->data());
+    for (int64_t i = 0; i < in.size(); ++i) {
+      const T value = in(i) + r(i);
+      out[i] = static_cast<bfloat16>(static_cast<float>(value));
+      r(i) = value - static_cast<T>(static_cast<float>(out[i]));
+    }
+  }
+
+  template <typename T>
+  static void DecodeT(const Tensor& encoded, Tensor* chunk) {
+    auto out = chunk->flat<T>();
+    const bfloat16* in = reinterpret_cast<const bfloat16*>(encoded.data());
+    for (int64_t i = 0; i < out.size(); ++i) {
+      out(i) = static_cast<T>(static_cast<float>(in[i]));
+    }
+  }
+};
+
+// Sends only the `ratio` fraction of the elements with the largest magnitude,
+// as (int32 index, value) pairs. The others are left for error feedback.
+class TopKCompressor : public CollectiveCompressor {
+ public:
+  explicit TopKCompressor(double ratio) : ratio_(ratio) {}
+
+  bool SupportsType(DataType dtype) const override {
+    return IsFloatType(dtype);
+  }
+
+  int64_t EncodedBytes(DataType dtype, int64_t num_elements) const override {
+    return K(num_elements) * (sizeof(int32) + DataTypeSize(dtype));
+  }
+
+  void Encode(const Tensor& chunk, Tensor* residual,
+              Tensor* encoded) const override {
+    if (chunk.dtype() == DT_FLOAT) {
+      EncodeT<float>(chunk, residual, encoded);
+    } else {
+      EncodeT<double>(chunk, residual, encoded);
+    }
+  }
+
+  void Decode(const Tensor& encoded, Tensor* chunk) const override {
+    if (chunk->dtype() == DT_FLOAT) {
+      DecodeT<float>(encoded, chunk);
+    } else {
+      DecodeT<double>(encoded, chunk);
+    }
+  }
+
+ private:
+  int64_t K(int64_t num_elements) const {
+    if (num_elements == 0) return 0;
+    return std::clamp<int64_t>(std::ceil(ratio_ * num_elements), 1,
+                               num_elements);
+  }
+
+  template <typename T>
+  void EncodeT(const Tensor& chunk, Tensor* residual, Tensor* encoded) const {
+    auto in = chunk.flat<T>();
+    auto r = residual->flat<T>();
+    for (int64_t i = 0; i < in.size(); ++i) {
+      r(i) += in(i);
+    }
+    const int64_t k = K(in.size());
+    std::vector<int32> indices(in.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::nth_element(indices.begin(), indices.begin() + k - 1, indices.end(),
+                     [&r](int32 a, int32 b) {
+                       return std::abs(r(a)) > std::abs(r(b));
+                     });
+    char* out = static_cast<char*>(encoded->data());
+    for (int64_t i = 0; i < k; ++i) {
+      const int32 index = indices[i];
+      const T value = r(index);
+      std::memcpy(out, &index, sizeof(index));
+      std::memcpy(out + sizeof(index), &value, sizeof(value));
+      out += sizeof(index) + sizeof(value);
+      r(index) = T(0);
+    }
+  }
+
+  template <typename T>
+  void DecodeT(const Tensor& encoded, Tensor* chunk) const {
+    auto out = chunk->flat<T>();
+    out.setZero();
+    const char* in = static_cast<const char*>(encoded.data());
+    for (int64_t i = 0; i < K(out.size()); ++i) {
+      int32 index;
+      T value;
+      std::memcpy(&index, in, sizeof(index));
+      std::memcpy(&value, in + sizeof(index), sizeof(value));
+      in += sizeof(index) + sizeof(value);
+      out(index) = value;
+    }
+  }
+
+  const double ratio_;
+};
+
+REGISTER_COLLECTIVE_COMPRESSOR(
+    bf16, [](absl::string_view options,
+             std::unique_ptr<CollectiveCompressor>* out) {
+      if (!options.empty()) {
+        return errors::InvalidArgument("bf16 compression takes no options");
+      }
+      *out = std::make_unique<BF16Compressor>();
+      return absl::OkStatus();
+    });
+
+// "topk=<ratio>", with a default ratio of 1%.
+REGISTER_COLLECTIVE_COMPRESSOR(
+    topk, [](absl::string_view options,
+             std::unique_ptr<CollectiveCompressor>* out) {
+      double ratio = 0.01;
+      if (!options.empty() &&
+          (!absl::SimpleAtod(options, &ratio) || ratio <= 0 || ratio > 1)) {
+        return errors::InvalidArgument(
+            "topk compression ratio must be in (0, 1], got ", options);
+      }
+      *out = std::make_unique<TopKCompressor>(ratio);
+      return absl::OkStatus();
+    });
+
+}  // namespace
+
+Status CollectiveCompressorRegistry::Create(
+    absl::string_view spec, std::unique_ptr<CollectiveCompressor>* compressor) {
+  absl::string_view name = spec, options;
+  const size_t pos = spec.find('=');
+  if (pos != absl::string_view::npos) {
+    name = spec.substr(0, pos);
+    options = spec.substr(pos + 1);
+  }
+  auto it = CompressorFactories()->find(string(name));
+  if (it == CompressorFactories()->end()) {
+    return errors::InvalidArgument("Unknown collective compression ", spec);
+  }
+  return it->second(options, compressor);
+}
+
+void CollectiveCompressorRegistry::Register(const string& name,
+                                            Factory factory) {
+  CHECK(CompressorFactories()->emplace(name, std::move(factory)).second)
+      << "Collective compressor " << name << " registered twice";
+}
+
+Tensor* CollectiveCompressionResiduals::Get(const string& key,
+                                            const Tensor& chunk) {
+  mutex_lock l(mu_);
+  Tensor& residual = residuals_[key];
+  if (residual.dtype() != chunk.dtype() ||
+      residual.shape() != chunk.shape()) {
+    residual = Tensor(cpu_allocator(), chunk.dtype(), chunk.shape());
+    std::memset(residual.data(), 0, residual.TotalBytes());
+  }
+  return &residual;
+}
+
+}  // namespace tensorflow
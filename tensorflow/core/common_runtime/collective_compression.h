@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Lossy encoding of the chunks that collective implementations send between
+// devices, to trade precision for bandwidth.
+//
+// A chunk is a 1-D host tensor and is encoded into a DT_UINT8 tensor whose size
+// depends only on the data type and size of the chunk, so that receivers can
+// allocate it in advance.
+//
+// Encoding uses error feedback: the part of a chunk that the encoding loses is
+// kept in a residual and added to the chunk sent at the same position the next
+// time, so that the loss does not accumulate over training steps.
+//
+// Implementations must be thread-safe.
+class CollectiveCompressor {
+ public:
+  virtual ~CollectiveCompressor() = default;
+
+  // Returns whether chunks of `dtype` can be encoded.
+  virtual bool SupportsType(DataType dtype) const = 0;
+
+  // Returns the size of the encoding of a chunk of `num_elements` elements of
+  // `dtype`.
+  virtual int64_t EncodedBytes(DataType dtype, int64_t num_elements) const = 0;
+
+  // Encodes `chunk` plus `residual` into `encoded`, and sets `residual` to the
+  // difference between that sum and its encoding. `residual` has the shape and
+  // data type of `chunk`.
+  virtual void Encode(const Tensor& chunk, Tensor* residual,
+                      Tensor* encoded) const = 0;
+
+  // Decodes `encoded` into `chunk`, which has the data type and size it was
+  // encoded with.
+  virtual void Decode(const Tensor& encoded, Tensor* chunk) const = 0;
+};
+
+// Static-methods only class for registering and looking up collective
+// compressors.
+//
+// A compression spec is the name of a compressor, optionally followed by "="
+// and options for it, e.g. "topk=0.01".
+class CollectiveCompressorRegistry {
+ public:
+  using Factory = std::function<Status(
+      absl::string_view options, std::unique_ptr<CollectiveCompressor>* out)>;
+
+  // Creates the compressor of `spec`.
+  static Status Create(absl::string_view spec,
+                       std::unique_ptr<CollectiveCompressor>* compressor);
+
+  static void Register(const string& name, Factory factory);
+};
+
+// The residuals for error feedback of the chunks sent by compressed
+// collectives, by the position of the chunk. Kept by the collective executor
+// of a step, so they carry over between executions of an instance within the
+// step and are freed when the step is cleaned up.
+class CollectiveCompressionResiduals {
+ public:
+  // Returns the residual of the chunk at position `key`, creating a zero
+  // residual with the data type and shape of `chunk` if needed. The residual
+  // stays valid for the lifetime of `this`.
+  Tensor* Get(const string& key, const Tensor& chunk) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutex mu_;
+  std::unordered_map<string, Tensor> residuals_ TF_GUARDED_BY(mu_);
+};
+
+class CollectiveCompressorRegistration {
+ public:
+  CollectiveCompressorRegistration(const string& name,
+                                   CollectiveCompressorRegistry::Factory f) {
+    CollectiveCompressorRegistry::Register(name, std::move(f));
+  }
+};
+
+#define REGISTER_COLLECTIVE_COMPRESSOR(name, factory) \
+  static CollectiveCompressorRegistration             \
+      register_##name##_collective_compressor(#name, factory)
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_COMPRESSION_H_
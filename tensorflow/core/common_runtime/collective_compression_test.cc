@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_compression.h"
+
+#include <cstring>
+#include <memory>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor ZerosLike(const Tensor& t) {
+  Tensor zeros(t.dtype(), t.shape());
+  std::memset(zeros.data(), 0, zeros.TotalBytes());
+  return zeros;
+}
+
+// Encodes and decodes `chunk` with `residual`.
+Tensor RoundTrip(const CollectiveCompressor& compressor, const Tensor& chunk,
+                 Tensor* residual) {
+  Tensor encoded(DT_UINT8, TensorShape({compressor.EncodedBytes(
+                               chunk.dtype(), chunk.NumElements())}));
+  compressor.Encode(chunk, residual, &encoded);
+  Tensor decoded(chunk.dtype(), chunk.shape());
+  compressor.Decode(encoded, &decoded);
+  return decoded;
+}
+
+TEST(CollectiveCompressionTest, BF16) {
+  std::unique_ptr<CollectiveCompressor> compressor;
+  TF_ASSERT_OK(CollectiveCompressorRegistry::Create("bf16", &compressor));
+  EXPECT_TRUE(compressor->SupportsType(DT_FLOAT));
+  EXPECT_FALSE(compressor->SupportsType(DT_INT32));
+  EXPECT_EQ(compressor->EncodedBytes(DT_FLOAT, 10), 20);
+
+  // 1 + 2^-10 is not a bfloat16, so its low bits are kept in the residual.
+  const float value = 1.0f + 1.0f / 1024;
+  Tensor chunk = test::AsTensor<float>({value, 2.0f});
+  Tensor residual = ZerosLike(chunk);
+  test::ExpectTensorEqual<float>(RoundTrip(*compressor, chunk, &residual),
+                                 test::AsTensor<float>({1.0f, 2.0f}));
+  test::ExpectTensorEqual<float>(residual,
+                                 test::AsTensor<float>({1.0f / 1024, 0.0f}));
+}
+
+TEST(CollectiveCompressionTest, TopKWithErrorFeedback) {
+  std::unique_ptr<CollectiveCompressor> compressor;
+  TF_ASSERT_OK(CollectiveCompressorRegistry::Create("topk=0.5", &compressor));
+  EXPECT_EQ(compressor->EncodedBytes(DT_FLOAT, 4), 2 * (4 + 4));
+
+  Tensor chunk = test::AsTensor<float>({1.0f, -4.0f, 2.0f, 3.0f});
+  Tensor residual = ZerosLike(chunk);
+  test::ExpectTensorEqual<float>(
+      RoundTrip(*compressor, chunk, &residual),
+      test::AsTensor<float>({0.0f, -4.0f, 0.0f, 3.0f}));
+  test::ExpectTensorEqual<float>(
+      residual, test::AsTensor<float>({1.0f, 0.0f, 2.0f, 0.0f}));
+
+  // The elements that were not sent are sent the next time.
+  test::ExpectTensorEqual<float>(
+      RoundTrip(*compressor, ZerosLike(chunk), &residual),
+      test::AsTensor<float>({1.0f, 0.0f, 2.0f, 0.0f}));
+}
+
+TEST(CollectiveCompressionTest, ResidualsByPosition) {
+  CollectiveCompressionResiduals residuals;
+  const Tensor chunk = test::AsTensor<float>({1.0f, 2.0f});
+  Tensor* residual = residuals.Get("0:1:dev:0", chunk);
+  test::ExpectTensorEqual<float>(*residual, ZerosLike(chunk));
+  residual->flat<float>()(0) = 0.5f;
+  EXPECT_EQ(residuals.Get("0:1:dev:0", chunk), residual);
+  EXPECT_EQ(residual->flat<float>()(0), 0.5f);
+  EXPECT_NE(residuals.Get("0:1:dev:1", chunk), residual);
+
+  // A chunk of another shape at the same position starts from zero again.
+  const Tensor longer_chunk = test::AsTensor<float>({1.0f, 2.0f, 3.0f});
+  test::ExpectTensorEqual<float>(*residuals.Get("0:1:dev:0", longer_chunk),
+                                 ZerosLike(longer_chunk));
+}
+
+TEST(CollectiveCompressionTest, InvalidSpecs) {
+  std::unique_ptr<CollectiveCompressor> compressor;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      CollectiveCompressorRegistry::Create("fp8", &compressor)));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      CollectiveCompressorRegistry::Create("topk=2", &compressor)));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      CollectiveCompressorRegistry::Create("bf16=1", &compressor)));
+}
+
+}  // namespace
+}  // namespace tensorflow
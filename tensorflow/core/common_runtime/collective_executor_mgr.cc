@@ -92,6 +92,18 @@ void CollectiveExecutorMgr::CleanupAll() {
   }
 }
 
+Status CollectiveExecutorMgr::Reset() {
+  // The executors of the aborted steps keep their aborted status, so the next
+  // collectives get new ones.
+  CleanupAll();
+  TF_RETURN_IF_ERROR(param_resolver_->Reset());
+  if (nccl_communicator_ != nullptr) {
+    nccl_communicator_->Reset();
+  }
+  VLOG(1) << "Reset collective ops after abortion";
+  return absl::OkStatus();
+}
+
 void CollectiveExecutorMgr::GetStepSequenceAsync(
     const GetStepSequenceRequest* request, GetStepSequenceResponse* response,
     const StatusCallback& done) {
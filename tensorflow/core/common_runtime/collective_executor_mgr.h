@@ -39,6 +39,8 @@ class CollectiveExecutorMgr : public CollectiveExecutorMgrInterface {
 
   void CleanupAll() override;
 
+  Status Reset() override;
+
   ParamResolverInterface* GetParamResolver() const override {
     return param_resolver_.get();
   }
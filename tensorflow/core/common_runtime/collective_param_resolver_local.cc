@@ -684,8 +684,23 @@ void CollectiveParamResolverLocal::CompleteInstanceAsync(
 
 // TODO(b/111897089): we need a better way to pick the collective
 // implementation.  The ideal way would depend upon the topology and link
-// strength before picking a particular implementation.
+// strength before picking a particular implementation.  For now, reductions
+// across tasks with several devices each use `HierarchicalRingReduce`, which
+// keeps most of the traffic on intra-task links.
 void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
+  // A reduction hint of the form "<hint>:<compression spec>", e.g. "ring:bf16",
+  // selects `RingReduce` with compression of the data it sends.
+  CollImplDetails& impl_details = cp->instance.impl_details;
+  const size_t compression_pos = impl_details.communication_hint.find(':');
+  if (compression_pos != string::npos &&
+      cp->instance.type == REDUCTION_COLLECTIVE) {
+    impl_details.compression =
+        impl_details.communication_hint.substr(compression_pos + 1);
+    impl_details.collective_name = "RingReduce";
+    VLOG(1) << "AssignCollectiveType RingReduce with compression "
+            << impl_details.compression;
+    return;
+  }
   // We use the NCCL implementation if this is an environment which supports
   // NCCL, i.e. `LookupParamResolverInstance` for `NcclReduce` returns OK, and
   // also if indicated either in `ConfigProto` or `communication_hint`.
@@ -698,7 +713,16 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       cp->group.device_type == DEVICE_GPU &&
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
-  cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // Members are sorted by task and, within a task, by locality, which gives the
+  // hierarchical rings their order. The "ring" hint keeps the flat ring.
+  bool use_hierarchical_ring =
+      !use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.impl_details.communication_hint != "ring" &&
+      cp->group.num_tasks > 1 && cp->group.same_num_devices_per_task &&
+      cp->group.group_size > cp->group.num_tasks;
+  cp->instance.impl_details.collective_name =
+      use_hierarchical_ring ? "HierarchicalRingReduce"
+                            : GetCollectiveName(cp, use_nccl);
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -855,6 +879,26 @@ void CollectiveParamResolverLocal::StartAbort(const Status& s) {
   StartAbortLocal(s);
 }
 
+Status CollectiveParamResolverLocal::Reset() {
+  mutex_lock l(status_mu_);
+  if (status_.ok()) {
+    return errors::FailedPrecondition(
+        "Collective ops must be aborted before they are reset");
+  }
+  // The tables are cleared while still aborted, so that no record of the
+  // aborted groups survives.
+  {
+    mutex_lock gl(group_mu_);
+    group_table_.clear();
+  }
+  {
+    mutex_lock il(instance_mu_);
+    instance_table_.clear();
+  }
+  status_ = absl::OkStatus();
+  return absl::OkStatus();
+}
+
 void CollectiveParamResolverLocal::StartAbortLocal(const Status& s) {
   std::vector<StatusCallback> pending_done;
   {
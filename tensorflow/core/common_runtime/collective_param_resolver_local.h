@@ -67,6 +67,8 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
 
   void StartAbort(const Status& s) override;
 
+  Status Reset() override;
+
  protected:
   // For access to InstanceRec and CompleteDefaultRanking.
   friend class CollectiveParamResolverLocalTest;
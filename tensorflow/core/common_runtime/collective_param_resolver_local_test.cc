@@ -444,6 +444,37 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsAfterAbortion) {
   complete_params(group_key + 1, instance_key + 1);
 }
 
+TEST_F(CollectiveParamResolverLocalTest, CompleteParamsAfterReset) {
+  CancellationManager cancel_mgr;
+  auto complete_group = [this, &cancel_mgr] {
+    std::vector<CollectiveParams*> cp(NUM_DEVS);
+    BlockingCounter done(NUM_DEVS);
+    for (int i = 0; i < NUM_DEVS; ++i) {
+      Env::Default()->SchedClosure([this, i, &cancel_mgr, &cp, &done] {
+        string device =
+            strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i);
+        cp[i] = MakeCollectiveParams(/*group_key*/ 100, /*instance_key*/ 100,
+                                     /*is_source*/ i == 0);
+        prl_->CompleteParamsAsync(GetDeviceAttributes(device), cp[i],
+                                  &cancel_mgr,
+                                  [&done, cp = cp[i]](const Status& s) {
+                                    TF_EXPECT_OK(s);
+                                    done.DecrementCount();
+                                    cp->Unref();
+                                  });
+      });
+    }
+    done.Wait();
+  };
+  complete_group();
+  // Only aborted resolvers can be reset.
+  EXPECT_TRUE(errors::IsFailedPrecondition(prl_->Reset()));
+  prl_->StartAbort(Status(absl::StatusCode::kAborted, "__aborted__"));
+  TF_ASSERT_OK(prl_->Reset());
+  // The same group and instance are formed again.
+  complete_group();
+}
+
 TEST_F(CollectiveParamResolverLocalTest, AbortNormalCompleteParamsAsync) {
   // The concurrent nature makes it hard to test abortion, which can happen at
   // any moment. We don't have good options to inject control points into the
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
@@ -39,10 +40,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
 
@@ -613,6 +617,62 @@ bool ReplaceTensorWithConstant(
   return true;
 }
 
+// Computes the key under which the outputs `fetches` of `constant_graph` are
+// cached. The key covers the op, attributes and data inputs of every node,
+// with nodes identified by their position in a stable topological order
+// rather than by name, so that the same subgraph gets the same key in graphs
+// whose node names differ. Returns false if the outputs cannot be cached.
+bool ConstantGraphCacheKey(const Graph& constant_graph,
+                           const std::vector<NodeAndOutput>& fetches,
+                           string* key) {
+  std::vector<Node*> order;
+  GetReversePostOrder(constant_graph, &order, NodeComparatorName());
+  std::unordered_map<const Node*, int> position;
+  for (int i = 0; i < order.size(); ++i) position[order[i]] = i;
+
+  // Kernels may change across releases, so entries written by another
+  // version (e.g. to a cache directory) must not be reused.
+  string canonical = strings::StrCat(TF_VERSION_STRING, ";");
+  for (const Node* n : order) {
+    // The fingerprint does not include function bodies.
+    if (n->IsFunctionCall()) return false;
+    strings::StrAppend(&canonical, n->type_string(), "(");
+    std::vector<const Edge*> inputs;
+    if (!n->input_edges(&inputs).ok()) return false;
+    for (const Edge* e : inputs) {
+      strings::StrAppend(&canonical, position.at(e->src()), ":",
+                         e->src_output(), ",");
+    }
+    strings::StrAppend(&canonical, ")");
+    std::vector<std::pair<string, const AttrValue*>> attrs;
+    for (const auto& attr : n->def().attr()) {
+      // Internal attributes, e.g. colocation constraints, refer to node names
+      // and do not change the result.
+      if (absl::StartsWith(attr.first, "_")) continue;
+      if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+        return false;
+      }
+      attrs.emplace_back(attr.first, &attr.second);
+    }
+    std::sort(attrs.begin(), attrs.end());
+    for (const auto& attr : attrs) {
+      string value;
+      if (!SerializeToStringDeterministic(*attr.second, &value)) return false;
+      strings::StrAppend(&canonical, attr.first, "=", value.size(), ":",
+                         value, ";");
+    }
+  }
+  strings::StrAppend(&canonical, "->");
+  for (const NodeAndOutput& fetch : fetches) {
+    strings::StrAppend(&canonical, position.at(fetch.first), ":",
+                       fetch.second, ",");
+  }
+  const Fprint128 fingerprint = Fingerprint128(canonical);
+  *key = strings::StrCat(strings::Hex(fingerprint.high64, strings::kZeroPad16),
+                         strings::Hex(fingerprint.low64, strings::kZeroPad16));
+  return true;
+}
+
 }  // namespace
 
 Status ConstantFold(const ConstantFoldingOptions& opts,
@@ -663,6 +723,7 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
           << graph->num_node_ids();
 
   std::vector<string> tensors_to_fetch_names;
+  std::vector<NodeAndOutput> tensors_to_fetch_in_constant_graph;
   std::vector<NodeAndOutput> tensors_to_replace;
   // Sorting the nodes based on the name gives us a stable ordering between runs
   // for the same graph.
@@ -677,9 +738,16 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
   for (auto n : tensors_to_fetch_sorted) {
     tensors_to_fetch_names.push_back(
         strings::StrCat(n.first.first->name(), ":", n.first.second));
+    tensors_to_fetch_in_constant_graph.push_back(n.first);
     tensors_to_replace.push_back(n.second);
   }
 
+  string cache_key;
+  const bool use_cache =
+      opts.cache != nullptr &&
+      ConstantGraphCacheKey(*constant_graph,
+                            tensors_to_fetch_in_constant_graph, &cache_key);
+
   auto graph_runner = std::unique_ptr<GraphRunner>(new GraphRunner(env));
   // Evaluate the constant foldable nodes.
   std::vector<Tensor> outputs;
@@ -689,13 +757,19 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
     graph_runner.reset(nullptr);
   });
 
-  Status s =
-      graph_runner->Run(constant_graph.get(), function_library, {} /* inputs*/,
-                        tensors_to_fetch_names, &outputs);
-  if (!s.ok()) {
-    VLOG(1) << "Could not fetch constants: " << s;
-    *was_mutated = false;
-    return s;
+  if (use_cache &&
+      opts.cache->Lookup(cache_key, tensors_to_fetch_names.size(), &outputs)) {
+    VLOG(1) << "Found " << outputs.size() << " folded constants in the cache";
+  } else {
+    Status s = graph_runner->Run(constant_graph.get(), function_library,
+                                 {} /* inputs*/, tensors_to_fetch_names,
+                                 &outputs);
+    if (!s.ok()) {
+      VLOG(1) << "Could not fetch constants: " << s;
+      *was_mutated = false;
+      return s;
+    }
+    if (use_cache) opts.cache->Insert(cache_key, outputs);
   }
 
   // Fetch the constant tensors and replace the corresponding tensors in the
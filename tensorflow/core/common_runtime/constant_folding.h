@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 
+#include "tensorflow/core/common_runtime/constant_folding_cache.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -49,6 +50,13 @@ struct ConstantFoldingOptions {
   // default id generator that monotonically increases is used if nullptr is
   // passed.
   ConstantFoldNameGenerator generate_new_name = nullptr;
+
+  // If not null, the tensors produced by evaluating the constant-foldable
+  // subgraph are looked up in, and stored into, this cache. The key is a
+  // fingerprint of the subgraph's ops, attributes and edges (not its node
+  // names), so identical subgraphs in other graphs share an entry. Subgraphs
+  // that call functions are not cached.
+  ConstantFoldingCache* cache = nullptr;  // not owned
 };
 
 // Perform constant folding optimization on "graph".
@@ -0,0 +1,170 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/constant_folding_cache.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr int64_t kGlobalCacheCapacityInBytes = 256 << 20;
+
+int64_t TotalBytes(const std::vector<Tensor>& tensors) {
+  int64_t total = 0;
+  for (const Tensor& t : tensors) total += t.TotalBytes();
+  return total;
+}
+
+}  // namespace
+
+ConstantFoldingCache::ConstantFoldingCache(int64_t capacity_in_bytes,
+                                           std::string cache_dir, Env* env)
+    : capacity_in_bytes_(capacity_in_bytes),
+      cache_dir_(std::move(cache_dir)),
+      env_(env) {
+  if (!cache_dir_.empty()) {
+    Status s = env_->RecursivelyCreateDir(cache_dir_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Could not create constant folding cache directory "
+                   << cache_dir_ << ": " << s;
+    }
+  }
+}
+
+/* static */
+ConstantFoldingCache* ConstantFoldingCache::Global() {
+  static ConstantFoldingCache* cache = [] {
+    std::string cache_dir;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_CONSTANT_FOLDING_CACHE_DIR", "",
+                                     &cache_dir));
+    return new ConstantFoldingCache(kGlobalCacheCapacityInBytes,
+                                    std::move(cache_dir));
+  }();
+  return cache;
+}
+
+bool ConstantFoldingCache::Lookup(const std::string& key, int num_outputs,
+                                  std::vector<Tensor>* outputs) {
+  {
+    mutex_lock l(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      if (it->second->second.size() != num_outputs) return false;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      *outputs = it->second->second;
+      return true;
+    }
+  }
+  if (cache_dir_.empty() || !ReadFromDisk(key, num_outputs, outputs)) {
+    return false;
+  }
+  mutex_lock l(mu_);
+  InsertInMemory(key, *outputs);
+  return true;
+}
+
+void ConstantFoldingCache::Insert(const std::string& key,
+                                  const std::vector<Tensor>& outputs) {
+  {
+    mutex_lock l(mu_);
+    InsertInMemory(key, outputs);
+  }
+  if (!cache_dir_.empty()) WriteToDisk(key, outputs);
+}
+
+int64_t ConstantFoldingCache::size_in_bytes() const {
+  mutex_lock l(mu_);
+  return size_in_bytes_;
+}
+
+int64_t ConstantFoldingCache::num_entries() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+void ConstantFoldingCache::InsertInMemory(const std::string& key,
+                                          std::vector<Tensor> outputs) {
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    size_in_bytes_ -= TotalBytes(it->second->second);
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  const int64_t bytes = TotalBytes(outputs);
+  if (bytes > capacity_in_bytes_) return;
+  while (size_in_bytes_ + bytes > capacity_in_bytes_) {
+    size_in_bytes_ -= TotalBytes(entries_.back().second);
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, std::move(outputs));
+  index_[key] = entries_.begin();
+  size_in_bytes_ += bytes;
+}
+
+bool ConstantFoldingCache::ReadFromDisk(const std::string& key,
+                                        int num_outputs,
+                                        std::vector<Tensor>* outputs) const {
+  std::vector<Tensor> tensors(num_outputs);
+  for (int i = 0; i < num_outputs; ++i) {
+    const std::string path = DiskPath(key, i);
+    if (!env_->FileExists(path).ok()) return false;
+    TensorProto proto;
+    Status s = ReadBinaryProto(env_, path, &proto);
+    if (!s.ok() || !tensors[i].FromProto(proto)) {
+      VLOG(1) << "Could not read cached constant " << path << ": " << s;
+      return false;
+    }
+  }
+  *outputs = std::move(tensors);
+  return true;
+}
+
+void ConstantFoldingCache::WriteToDisk(
+    const std::string& key, const std::vector<Tensor>& outputs) const {
+  for (int i = 0; i < outputs.size(); ++i) {
+    const std::string path = DiskPath(key, i);
+    if (env_->FileExists(path).ok()) continue;
+    TensorProto proto;
+    outputs[i].AsProtoTensorContent(&proto);
+    // Write to a temporary file first so that concurrent readers never see a
+    // partially written entry.
+    std::string tmp_path = path;
+    if (!env_->CreateUniqueFileName(&tmp_path, ".tmp")) continue;
+    Status s = WriteBinaryProto(env_, tmp_path, proto);
+    if (s.ok()) s = env_->RenameFile(tmp_path, path);
+    if (!s.ok()) {
+      VLOG(1) << "Could not write cached constant " << path << ": " << s;
+      env_->DeleteFile(tmp_path).IgnoreError();
+    }
+  }
+}
+
+std::string ConstantFoldingCache::DiskPath(const std::string& key,
+                                           int output_index) const {
+  return io::JoinPath(cache_dir_, absl::StrCat(key, "_", output_index, ".pb"));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Caches the tensors produced by evaluating a constant-foldable subgraph,
+// keyed by a fingerprint of that subgraph (see `ConstantFold`). This lets
+// repeated instantiations of the same function or model skip re-evaluating
+// subgraphs such as vocabulary tables or position encodings.
+//
+// Entries are kept in memory up to `capacity_in_bytes`, evicting the least
+// recently used entry first. If `cache_dir` is not empty, entries are also
+// written to (and, on a miss in memory, read from) that directory as
+// serialized `TensorProto`s, so that they survive across processes.
+//
+// This class is thread-safe.
+class ConstantFoldingCache {
+ public:
+  ConstantFoldingCache(int64_t capacity_in_bytes, std::string cache_dir,
+                       Env* env = Env::Default());
+
+  ConstantFoldingCache(const ConstantFoldingCache&) = delete;
+  void operator=(const ConstantFoldingCache&) = delete;
+
+  // Returns the process-wide cache. Its capacity is 256MiB, and the
+  // `TF_CONSTANT_FOLDING_CACHE_DIR` environment variable, if set, is used as
+  // its `cache_dir`.
+  static ConstantFoldingCache* Global();
+
+  // Looks up the `num_outputs` tensors cached for `key`. Returns true and
+  // fills `outputs` on a hit.
+  bool Lookup(const std::string& key, int num_outputs,
+              std::vector<Tensor>* outputs);
+
+  // Caches `outputs` for `key`, replacing any previous entry.
+  void Insert(const std::string& key, const std::vector<Tensor>& outputs);
+
+  int64_t size_in_bytes() const;
+  int64_t num_entries() const;
+
+ private:
+  using Entry = std::pair<std::string, std::vector<Tensor>>;
+
+  void InsertInMemory(const std::string& key, std::vector<Tensor> outputs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool ReadFromDisk(const std::string& key, int num_outputs,
+                    std::vector<Tensor>* outputs) const;
+  void WriteToDisk(const std::string& key,
+                   const std::vector<Tensor>& outputs) const;
+  std::string DiskPath(const std::string& key, int output_index) const;
+
+  const int64_t capacity_in_bytes_;
+  const std::string cache_dir_;
+  Env* const env_;
+
+  mutable mutex mu_;
+  // Most recently used entries are at the front.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+  int64_t size_in_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_CACHE_H_
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/constant_folding_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(ConstantFoldingCacheTest, LookupAfterInsert) {
+  ConstantFoldingCache cache(1 << 20, "");
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(cache.Lookup("a", 1, &outputs));
+
+  cache.Insert("a", {test::AsTensor<float>({1.0, 2.0}),
+                     test::AsTensor<int32>({3})});
+  EXPECT_EQ(cache.num_entries(), 1);
+  EXPECT_EQ(cache.size_in_bytes(), 12);
+
+  ASSERT_TRUE(cache.Lookup("a", 2, &outputs));
+  ASSERT_EQ(outputs.size(), 2);
+  test::ExpectTensorEqual<float>(outputs[0], test::AsTensor<float>({1.0, 2.0}));
+  test::ExpectTensorEqual<int32>(outputs[1], test::AsTensor<int32>({3}));
+
+  // A lookup with a different number of outputs is a miss.
+  EXPECT_FALSE(cache.Lookup("a", 1, &outputs));
+}
+
+TEST(ConstantFoldingCacheTest, EvictsLeastRecentlyUsed) {
+  ConstantFoldingCache cache(8, "");
+  cache.Insert("a", {test::AsTensor<int32>({1})});
+  cache.Insert("b", {test::AsTensor<int32>({2})});
+  std::vector<Tensor> outputs;
+  // Touch "a" so that "b" is the least recently used entry.
+  EXPECT_TRUE(cache.Lookup("a", 1, &outputs));
+  cache.Insert("c", {test::AsTensor<int32>({3})});
+
+  EXPECT_EQ(cache.num_entries(), 2);
+  EXPECT_EQ(cache.size_in_bytes(), 8);
+  EXPECT_TRUE(cache.Lookup("a", 1, &outputs));
+  EXPECT_FALSE(cache.Lookup("b", 1, &outputs));
+  EXPECT_TRUE(cache.Lookup("c", 1, &outputs));
+
+  // Entries larger than the capacity are not cached in memory.
+  cache.Insert("d", {test::AsTensor<int32>({1, 2, 3})});
+  EXPECT_FALSE(cache.Lookup("d", 1, &outputs));
+  EXPECT_EQ(cache.num_entries(), 2);
+}
+
+TEST(ConstantFoldingCacheTest, PersistsToCacheDir) {
+  const std::string cache_dir =
+      io::JoinPath(testing::TmpDir(), "constant_folding_cache_test");
+  {
+    ConstantFoldingCache cache(1 << 20, cache_dir);
+    cache.Insert("key", {test::AsTensor<float>({4.0, 5.0})});
+  }
+  // A new cache, e.g. in another process, reads the entry back from disk.
+  ConstantFoldingCache cache(1 << 20, cache_dir);
+  EXPECT_EQ(cache.num_entries(), 0);
+  std::vector<Tensor> outputs;
+  ASSERT_TRUE(cache.Lookup("key", 1, &outputs));
+  test::ExpectTensorEqual<float>(outputs[0], test::AsTensor<float>({4.0, 5.0}));
+  EXPECT_EQ(cache.num_entries(), 1);
+  EXPECT_FALSE(cache.Lookup("other_key", 1, &outputs));
+}
+
+}  // namespace
+}  // namespace tensorflow
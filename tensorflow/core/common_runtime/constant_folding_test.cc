@@ -134,6 +134,54 @@ TEST_F(ConstantFoldingTest, Basic) {
                          {2, 2});
 }
 
+TEST_F(ConstantFoldingTest, CachesFoldedConstants) {
+  ConstantFoldingCache cache(1 << 20, "");
+  ConstantFoldingOptions opts;
+  opts.cache = &cache;
+
+  Scope s1 = Scope::NewRootScope();
+  BuildSimpleGraph(&s1);
+  Graph g1(OpRegistry::Global());
+  TF_ASSERT_OK(s1.ToGraph(&g1));
+  bool was_mutated;
+  TF_ASSERT_OK(
+      ConstantFold(opts, nullptr, Env::Default(), nullptr, &g1, &was_mutated));
+  EXPECT_TRUE(was_mutated);
+  EXPECT_EQ(cache.num_entries(), 1);
+
+  // The same subgraph under different node names is served from the cache.
+  Scope s2 = Scope::NewRootScope().NewSubScope("other");
+  BuildSimpleGraph(&s2);
+  Graph g2(OpRegistry::Global());
+  TF_ASSERT_OK(s2.ToGraph(&g2));
+  TF_ASSERT_OK(
+      ConstantFold(opts, nullptr, Env::Default(), nullptr, &g2, &was_mutated));
+  EXPECT_TRUE(was_mutated);
+  EXPECT_EQ(cache.num_entries(), 1);
+
+  std::unordered_map<string, Node*> index = g2.BuildNodeNameIndex();
+  Node* send1 = index.at("other/s1");
+  Node* send2 = index.at("other/s2");
+  EXPECT_EQ(1, send1->num_inputs());
+  ExpectNodeClose<float>(*(send1->in_nodes().begin()), {1.0, 2.0, 3.0, 4.0},
+                         {2, 2});
+  EXPECT_EQ(1, send2->num_inputs());
+  ExpectNodeClose<float>(*(send2->in_nodes().begin()), {2.0, 1.0, 4.0, 3.0},
+                         {2, 2});
+
+  // A subgraph with different constants gets its own entry.
+  Scope s3 = Scope::NewRootScope();
+  auto a = ops::Const<float>(s3, {2.0}, {});
+  auto add = ops::Add(s3.WithOpName("add"), a, a);
+  ops::_Send(s3.WithOpName("send"), add, "add", "sender", 0, "receiver");
+  Graph g3(OpRegistry::Global());
+  TF_ASSERT_OK(s3.ToGraph(&g3));
+  TF_ASSERT_OK(
+      ConstantFold(opts, nullptr, Env::Default(), nullptr, &g3, &was_mutated));
+  EXPECT_TRUE(was_mutated);
+  EXPECT_EQ(cache.num_entries(), 2);
+}
+
 // Tests that different node creation ordering creates same graph after constant
 // folding.
 TEST_F(ConstantFoldingTest, DeterministicFolding) {
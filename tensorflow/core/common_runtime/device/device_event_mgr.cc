@@ -18,6 +18,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -165,6 +166,24 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+void EventMgr::BeginCapture(se::Stream* stream) {
+  mutex_lock l(mu_);
+  captured_callbacks_[stream];
+}
+
+int EventMgr::EndCapture(se::Stream* stream) {
+  mutex_lock l(mu_);
+  auto it = captured_callbacks_.find(stream);
+  if (it == captured_callbacks_.end()) return 0;
+  std::vector<std::function<void()>> callbacks = std::move(it->second);
+  captured_callbacks_.erase(it);
+  for (auto& func : callbacks) {
+    EnqueueCallback(stream, std::move(func));
+  }
+  PollEvents(stream);
+  return callbacks.size();
+}
+
 void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   VLOG(2) << "EnqueueCallback with one or more callbacks pending on "
           << callbacks_.size() << " streams and " << free_events_.size()
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -69,10 +70,26 @@ class EventMgr {
   // such callbacks and also buffer deletions.
   void ThenExecute(se::Stream* stream, std::function<void()> func) {
     mutex_lock l(mu_);
+    if (TF_PREDICT_FALSE(!captured_callbacks_.empty())) {
+      auto it = captured_callbacks_.find(stream);
+      if (it != captured_callbacks_.end()) {
+        it->second.push_back(std::move(func));
+        return;
+      }
+    }
     EnqueueCallback(stream, std::move(func));
     PollEvents(stream);
   }
 
+  // Starts holding the callbacks passed to ThenExecute() on `stream`, whose
+  // work is being captured into a graph. Events recorded on a stream under
+  // capture only become nodes of the graph and can't be polled.
+  void BeginCapture(se::Stream* stream);
+
+  // Stops holding the callbacks on `stream`, enqueues the held callbacks as
+  // ThenExecute() would now, and returns how many there were.
+  int EndCapture(se::Stream* stream);
+
  private:
   friend class TEST_EventMgr;
   friend class TEST_EventMgrHelper;
@@ -115,6 +132,10 @@ class EventMgr {
       std::deque<std::pair<std::unique_ptr<se::Event>, std::function<void()>>>>
       callbacks_ TF_GUARDED_BY(mu_);
 
+  // Callbacks held for the streams under capture.
+  absl::flat_hash_map<se::Stream*, std::vector<std::function<void()>>>
+      captured_callbacks_ TF_GUARDED_BY(mu_);
+
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
@@ -134,6 +134,25 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that callbacks on a stream under capture are held until EndCapture().
+TEST(EventMgr, HoldsCallbacksDuringCapture) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  TEST_EventMgrHelper th(&em);
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, stream_exec->CreateStream());
+  em.BeginCapture(stream.get());
+  std::atomic<int> hits(0);
+  em.ThenExecute(stream.get(), [&hits]() { ++hits; });
+  em.ThenExecute(stream.get(), [&hits]() { ++hits; });
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(2, em.EndCapture(stream.get()));
+  th.PollEvents();
+  EXPECT_EQ(0, th.queue_size());
+  // Callbacks run in the event manager's thread pool.
+  while (hits < 2) Env::Default()->SleepForMicroseconds(100);
+  EXPECT_EQ(0, em.EndCapture(stream.get()));
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
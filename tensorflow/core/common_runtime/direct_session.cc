@@ -52,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/subgraph.h"
@@ -159,6 +160,52 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Returns whether the steps of a callable, whose graph runs as `graph` on
+// `device` alone, may be captured by the device. Its feeds and fetches must be
+// in device memory on `device`, and `graph` must not contain stateful ops,
+// whose effects a replay would not repeat.
+bool CanCaptureSteps(const CallableOptions& callable_options,
+                     const DataTypeVector& input_types,
+                     const DataTypeVector& output_types,
+                     const DeviceMgr& device_mgr, const Device* device,
+                     const Graph& graph) {
+  if (callable_options.run_options().trace_level() != RunOptions::NO_TRACE) {
+    return false;
+  }
+  auto all_on_device = [&](const auto& names, const auto& devices) {
+    for (const string& name : names) {
+      auto it = devices.find(name);
+      Device* named_device;
+      if (it == devices.end() ||
+          !device_mgr.LookupDevice(it->second, &named_device).ok() ||
+          named_device != device) {
+        return false;
+      }
+    }
+    return true;
+  };
+  if (!all_on_device(callable_options.feed(),
+                     callable_options.feed_devices()) ||
+      !all_on_device(callable_options.fetch(),
+                     callable_options.fetch_devices())) {
+    return false;
+  }
+  for (const DataTypeVector* types : {&input_types, &output_types}) {
+    for (DataType dtype : *types) {
+      if (!DataTypeCanUseMemcpy(dtype) ||
+          MTypeFromDType(dtype) != DEVICE_MEMORY) {
+        return false;
+      }
+    }
+  }
+  for (const Node* node : graph.op_nodes()) {
+    if (node->op_def().is_stateful() && !node->IsArg() && !node->IsRetval()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -364,6 +411,13 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.message();
   }
+  step_capture_warmup_steps_ = options_.config.gpu_options()
+                                   .experimental()
+                                   .step_capture_warmup_steps();
+  if (options_.config.experimental().optimize_graphs_in_background()) {
+    background_optimization_pool_ = std::make_unique<thread::ThreadPool>(
+        options_.env, "tf_background_graph_optimization", 1);
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   if (options.config.log_device_placement()) {
@@ -389,12 +443,16 @@ DirectSession::DirectSession(const SessionOptions& options,
 
 DirectSession::~DirectSession() {
   if (!closed_) Close().IgnoreError();
+  // Waits for the background optimizations, which return early once the
+  // session is closed.
+  background_optimization_pool_.reset();
   for (auto& it : partial_runs_) {
     it.second.reset(nullptr);
   }
   for (auto& it : executors_) {
     it.second.reset();
   }
+  retired_executors_.clear();
   callables_.clear();
   for (auto d : device_mgr_->ListDevices()) {
     d->op_segment()->RemoveHold(session_handle_);
@@ -618,12 +676,15 @@ Status DirectSession::RunInternal(
   }
 
   std::unique_ptr<RunHandler> handler;
+  uint64 run_handler_wait_usecs = 0;
   if (ShouldUseRunHandlerPool(run_options) &&
       run_options.experimental().use_run_handler_pool()) {
     VLOG(1) << "Using RunHandler to scheduler inter-op closures.";
+    const uint64 wait_start_usecs = options_.env->NowMicros();
     handler = GetOrCreateRunHandlerPool(options_)->Get(
         step_id, call_timeout,
         run_options.experimental().run_handler_pool_options());
+    run_handler_wait_usecs = options_.env->NowMicros() - wait_start_usecs;
     if (!handler) {
       return errors::DeadlineExceeded(
           "Could not obtain RunHandler for request after waiting for ",
@@ -695,6 +756,15 @@ Status DirectSession::RunInternal(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
   }
+  if (args.stats_collector == nullptr &&
+      SampledStepStatsCollector::ShouldSampleStep(
+          executor_step_count,
+          options_.config.experimental().sampled_step_stats_every_n_steps())) {
+    run_state.sampled_collector = std::make_unique<SampledStepStatsCollector>(
+        step_id,
+        options_.config.experimental().sampled_step_stats_node_fraction());
+    args.stats_collector = run_state.sampled_collector.get();
+  }
 
   std::unique_ptr<DeviceProfilerSession> device_profiler_session;
   if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
@@ -710,6 +780,7 @@ Status DirectSession::RunInternal(
   args.cancellation_manager = &step_cancellation_manager;
 
   Status run_status;
+  const uint64 execution_start_usecs = options_.env->NowMicros();
 
   auto set_threadpool_args_for_item =
       [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
@@ -772,6 +843,8 @@ Status DirectSession::RunInternal(
     }
   }
 
+  const uint64 execution_end_usecs = options_.env->NowMicros();
+
   if (step_cancellation_manager.IsCancelled()) {
     run_status.Update(errors::Cancelled("Run call was cancelled"));
   }
@@ -794,6 +867,9 @@ Status DirectSession::RunInternal(
   if (run_state.collector) {
     run_state.collector->Finalize();
   }
+  if (run_state.sampled_collector) {
+    run_state.sampled_collector->Finalize();
+  }
 
   // Build and return the cost model as instructed.
   if (update_cost_model) {
@@ -835,7 +911,22 @@ Status DirectSession::RunInternal(
       }
     }
   }
-  metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
+  const uint64 end_time_usecs = options_.env->NowMicros();
+  metrics::UpdateGraphExecTime(end_time_usecs - start_time_usecs);
+  metrics::UpdateGraphRunPhaseTimes(
+      execution_start_usecs - start_time_usecs, run_handler_wait_usecs,
+      execution_end_usecs - execution_start_usecs,
+      end_time_usecs - execution_end_usecs);
+  if (run_metadata != nullptr &&
+      run_options.experimental().report_latency_breakdown()) {
+    RunMetadata::LatencyBreakdown* breakdown =
+        run_metadata->mutable_latency_breakdown();
+    breakdown->set_setup_usecs(execution_start_usecs - start_time_usecs);
+    breakdown->set_run_handler_wait_usecs(run_handler_wait_usecs);
+    breakdown->set_execution_usecs(execution_end_usecs -
+                                   execution_start_usecs);
+    breakdown->set_finalize_usecs(end_time_usecs - execution_end_usecs);
+  }
 
   return absl::OkStatus();
 }
@@ -914,9 +1005,13 @@ Status DirectSession::Run(const RunOptions& run_options,
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
-  TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
-                                 executors_and_keys, run_metadata,
-                                 threadpool_options));
+  {
+    absl::optional<tf_shared_lock> capture_lock;
+    if (step_capture_warmup_steps_ > 0) capture_lock.emplace(step_capture_mu_);
+    TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
+                                   executors_and_keys, run_metadata,
+                                   threadpool_options));
+  }
 
   // Receive outputs.
   if (outputs) {
@@ -1313,6 +1408,38 @@ Status DirectSession::CheckFetch(const NamedTensorList& feeds,
   return absl::OkStatus();
 }
 
+void DirectSession::InitCriticalPathCostModel(const Graph& graph,
+                                              const Device* device,
+                                              CostModel* cost_model) {
+  cost_model->InitFromGraph(graph);
+  std::unordered_map<StringPiece, const Node*, StringPieceHasher> nodes;
+  for (const Node* n : graph.op_nodes()) {
+    nodes.emplace(n->name(), n);
+  }
+
+  // The cost models are updated under `executor_lock_`, and only the graphs of
+  // the cached executors are known to be alive.
+  mutex_lock l(executor_lock_);
+  CostModelManager::CostModelMap measured_models;
+  cost_model_manager_.ExportCostModels(&measured_models);
+  if (measured_models.empty()) return;
+  for (const auto& executors : executors_) {
+    for (const PerPartitionExecutorsAndLib& item : executors.second->items) {
+      if (item.device != device || item.graph == nullptr) continue;
+      auto it = measured_models.find(item.graph.get());
+      if (it == measured_models.end()) continue;
+      const CostModel& measured = *it->second;
+      for (const Node* n : item.graph->op_nodes()) {
+        const int32_t count = measured.TotalCount(n);
+        auto node = nodes.find(n->name());
+        if (count == 0 || node == nodes.end()) continue;
+        cost_model->RecordCount(node->second, count);
+        cost_model->RecordTime(node->second, measured.TotalTime(n));
+      }
+    }
+  }
+}
+
 Status DirectSession::CreateExecutors(
     const CallableOptions& callable_options,
     std::unique_ptr<ExecutorsAndKeys>* out_executors_and_keys,
@@ -1329,6 +1456,7 @@ Status DirectSession::CreateExecutors(
   } else if (options_.config.experimental().collective_nccl()) {
     options.collective_order = GraphCollectiveOrder::kAttrs;
   }
+  options.optimize_graph = run_state_args->optimize_graph;
 
   std::unique_ptr<FunctionInfo> func_info(new FunctionInfo);
   std::unique_ptr<ExecutorsAndKeys> ek(new ExecutorsAndKeys);
@@ -1398,6 +1526,8 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.use_critical_path_priorities =
+        options_.config.experimental().use_critical_path_scheduling();
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
@@ -1438,11 +1568,24 @@ Status DirectSession::CreateExecutors(
                                          device->name(),
                                          partition_graph.get()));
 
+    // Only used while the executor is initialized.
+    CostModel cost_model(/*is_global=*/false);
+    if (params.use_critical_path_priorities) {
+      InitCriticalPathCostModel(*partition_graph, device, &cost_model);
+      params.cost_model = &cost_model;
+    }
+
     item->executor = nullptr;
     item->device = device;
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    if (step_capture_warmup_steps_ > 0 && graphs.size() == 1 &&
+        !run_state_args->is_partial_run &&
+        CanCaptureSteps(callable_options, ek->input_types, ek->output_types,
+                        *device_mgr_, device, *partition_graph)) {
+      ek->step_captures = std::make_unique<StepCaptures>();
+    }
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
@@ -1579,6 +1722,9 @@ Status DirectSession::GetOrCreateExecutors(
       ->set_collective_graph_key(run_state_args->collective_graph_key);
   std::unique_ptr<ExecutorsAndKeys> ek;
   std::unique_ptr<FunctionInfo> func_info;
+  const bool optimize_in_background =
+      ShouldOptimizeInBackground(*run_state_args);
+  run_state_args->optimize_graph = !optimize_in_background;
   TF_RETURN_IF_ERROR(
       CreateExecutors(callable_options, &ek, &func_info, run_state_args));
 
@@ -1591,6 +1737,24 @@ Status DirectSession::GetOrCreateExecutors(
       sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
   if (insert_result.second) {
     functions_.push_back(std::move(func_info));
+    if (optimize_in_background) {
+      const ExecutorsAndKeys* unoptimized = insert_result.first->second.get();
+      OptimizeExecutorsInBackground(
+          callable_options,
+          [this, unoptimized](std::shared_ptr<ExecutorsAndKeys> optimized) {
+            mutex_lock l(executor_lock_);
+            // Replaces the executors under both the sorted and the original
+            // keys.
+            std::shared_ptr<ExecutorsAndKeys> retired;
+            for (auto& it : executors_) {
+              if (it.second.get() == unoptimized) {
+                retired = it.second;
+                it.second = optimized;
+              }
+            }
+            if (retired) retired_executors_.push_back(std::move(retired));
+          });
+    }
   }
 
   // Insert the value under the original key, so the fast path lookup will work
@@ -1601,6 +1765,46 @@ Status DirectSession::GetOrCreateExecutors(
   return absl::OkStatus();
 }
 
+bool DirectSession::ShouldOptimizeInBackground(
+    const RunStateArgs& run_state_args) const {
+  // Partial runs keep state across calls, and debug watches refer to the
+  // nodes of the optimized graph.
+  return background_optimization_pool_ != nullptr &&
+         !run_state_args.is_partial_run &&
+         run_state_args.debug_options.debug_tensor_watch_opts().empty();
+}
+
+void DirectSession::OptimizeExecutorsInBackground(
+    const CallableOptions& callable_options,
+    std::function<void(std::shared_ptr<ExecutorsAndKeys>)> swap) {
+  background_optimization_pool_->Schedule(
+      [this, callable_options, swap = std::move(swap)]() {
+        if (!CheckNotClosed().ok()) return;
+        RunStateArgs run_state_args(
+            callable_options.run_options().debug_options());
+        run_state_args.collective_graph_key =
+            callable_options.run_options()
+                .experimental()
+                .collective_graph_key();
+        std::unique_ptr<ExecutorsAndKeys> ek;
+        std::unique_ptr<FunctionInfo> func_info;
+        const Status s =
+            CreateExecutors(callable_options, &ek, &func_info, &run_state_args);
+        if (!s.ok()) {
+          VLOG(1) << "Keeping the unoptimized executors, as the optimized ones "
+                     "could not be created: "
+                  << s;
+          return;
+        }
+        {
+          // The optimized executors may outlive the entry they replace.
+          mutex_lock l(executor_lock_);
+          functions_.push_back(std::move(func_info));
+        }
+        swap(std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
+      });
+}
+
 Status DirectSession::CreateGraphs(
     const BuildGraphOptions& subgraph_options,
     std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
@@ -1727,6 +1931,9 @@ Status DirectSession::CreateGraphs(
     // There are internal operations (e.g., send/recv) that we now allow.
     device_opts.allow_internal_ops = true;
     device_opts.expect_device_spec = true;
+    if (!thread_pools_.empty()) {
+      device_opts.thread_pool = thread_pools_[0].first;
+    }
     TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
         device_opts, std::move(partition.second), device_graph.get()));
     outputs->emplace(partition.first, std::move(device_graph));
@@ -1874,6 +2081,9 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   std::unique_ptr<ExecutorsAndKeys> ek;
   std::unique_ptr<FunctionInfo> func_info;
   RunStateArgs run_state_args(callable_options.run_options().debug_options());
+  const bool optimize_in_background =
+      ShouldOptimizeInBackground(run_state_args);
+  run_state_args.optimize_graph = !optimize_in_background;
   TF_RETURN_IF_ERROR(
       CreateExecutors(callable_options, &ek, &func_info, &run_state_args));
   {
@@ -1881,6 +2091,20 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
     *out_handle = next_callable_handle_++;
     callables_[*out_handle] = {std::move(ek), std::move(func_info)};
   }
+  if (optimize_in_background) {
+    const CallableHandle handle = *out_handle;
+    OptimizeExecutorsInBackground(
+        callable_options,
+        [this, handle](std::shared_ptr<ExecutorsAndKeys> optimized) {
+          // RunCallable() holds a reference to the executors it runs, so the
+          // unoptimized ones are released once their last run completes.
+          mutex_lock l(callables_lock_);
+          auto it = callables_.find(handle);
+          if (it != callables_.end()) {
+            it->second.executors_and_keys = std::move(optimized);
+          }
+        });
+  }
   return absl::OkStatus();
 }
 
@@ -1926,6 +2150,69 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   std::vector<Tensor>* const fetch_tensors_;       // Not owned.
 };
 
+::tensorflow::Status DirectSession::MaybeRunCapturedStep(
+    int64_t step_id, ExecutorsAndKeys* executors_and_keys,
+    const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* fetch_tensors,
+    const thread::ThreadPoolOptions& threadpool_options, bool* ran) {
+  *ran = false;
+  Device* device = executors_and_keys->items[0].device;
+  StepCaptures* captures = executors_and_keys->step_captures.get();
+
+  string key;
+  for (const Tensor& tensor : feed_tensors) {
+    strings::StrAppend(&key, tensor.shape().DebugString());
+  }
+
+  std::vector<Tensor> outputs;
+  {
+    mutex_lock l(captures->mu);
+    StepCaptures::Entry& entry = captures->entries[key];
+    if (entry.capture == nullptr) {
+      if (entry.failed || ++entry.num_steps <= step_capture_warmup_steps_) {
+        return absl::OkStatus();
+      }
+      std::unique_ptr<DeviceStepCapture> capture = device->CreateStepCapture();
+      if (capture == nullptr) {
+        entry.failed = true;
+        return absl::OkStatus();
+      }
+      auto step = [&](const std::vector<Tensor>& feeds,
+                      std::vector<Tensor>* fetches) {
+        fetches->resize(executors_and_keys->output_types.size());
+        RunCallableCallFrame call_frame(this, executors_and_keys, &feeds,
+                                        fetches);
+        return RunInternal(step_id,
+                           executors_and_keys->callable_options.run_options(),
+                           &call_frame, executors_and_keys,
+                           /*run_metadata=*/nullptr, threadpool_options);
+      };
+      mutex_lock capture_lock(step_capture_mu_);
+      const Status s = capture->Capture(feed_tensors, step, &outputs);
+      if (!s.ok()) {
+        VLOG(1) << "Running the steps of the callable on the executor, as "
+                << "they could not be captured on " << device->name() << ": "
+                << s;
+        entry.failed = true;
+        return absl::OkStatus();
+      }
+      entry.capture = std::move(capture);
+    } else {
+      tf_shared_lock capture_lock(step_capture_mu_);
+      TF_RETURN_IF_ERROR(entry.capture->Replay(feed_tensors, &outputs));
+    }
+  }
+
+  if (sync_on_finish_) {
+    TF_RETURN_IF_ERROR(device->Sync());
+  }
+  if (fetch_tensors != nullptr) {
+    *fetch_tensors = std::move(outputs);
+  }
+  *ran = true;
+  return absl::OkStatus();
+}
+
 ::tensorflow::Status DirectSession::RunCallable(
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata) {
@@ -2006,18 +2293,29 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     actual_feed_tensors = &feed_tensors;
   }
 
-  // A specialized CallFrame implementation that takes advantage of the
-  // optimized RunCallable interface.
-  RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
-
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
-  TF_RETURN_IF_ERROR(RunInternal(
-      step_id, executors_and_keys->callable_options.run_options(), &call_frame,
-      executors_and_keys.get(), run_metadata, threadpool_options));
+  bool ran_captured_step = false;
+  if (executors_and_keys->step_captures != nullptr && run_metadata == nullptr) {
+    TF_RETURN_IF_ERROR(MaybeRunCapturedStep(
+        step_id, executors_and_keys.get(), *actual_feed_tensors, fetch_tensors,
+        threadpool_options, &ran_captured_step));
+  }
+  if (!ran_captured_step) {
+    // A specialized CallFrame implementation that takes advantage of the
+    // optimized RunCallable interface.
+    RunCallableCallFrame call_frame(this, executors_and_keys.get(),
+                                    actual_feed_tensors, fetch_tensors);
+
+    absl::optional<tf_shared_lock> capture_lock;
+    if (step_capture_warmup_steps_ > 0) capture_lock.emplace(step_capture_mu_);
+    TF_RETURN_IF_ERROR(RunInternal(
+        step_id, executors_and_keys->callable_options.run_options(),
+        &call_frame, executors_and_keys.get(), run_metadata,
+        threadpool_options));
+  }
 
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DIRECT_SESSION_H_
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -39,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -150,6 +152,19 @@ class DirectSession : public Session {
     std::unique_ptr<Executor> executor;
   };
 
+  // The steps of a callable captured on its device, keyed by the shapes of its
+  // feeds. See GPUOptions.Experimental.step_capture_warmup_steps.
+  struct StepCaptures {
+    struct Entry {
+      int64_t num_steps = 0;
+      // Set if the step could not be captured.
+      bool failed = false;
+      std::unique_ptr<DeviceStepCapture> capture;
+    };
+    mutex mu;
+    std::unordered_map<string, Entry> entries TF_GUARDED_BY(mu);
+  };
+
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
   // 'step_count' is the number of times this graph is executed.
   // 'graph' is the entire graph being executed. 'name_to_node'
@@ -176,6 +191,9 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // Only set for callables whose steps may be captured.
+    std::unique_ptr<StepCaptures> step_captures;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -201,6 +219,7 @@ class DirectSession : public Session {
     Status status TF_GUARDED_BY(mu);
     std::unique_ptr<CollectiveExecutor::Handle> collective_executor;
     std::unique_ptr<StepStatsCollector> collector;
+    std::unique_ptr<SampledStepStatsCollector> sampled_collector;
     TensorStore tensor_store;
     ScopedStepContainer step_container;
 
@@ -236,6 +255,9 @@ class DirectSession : public Session {
     std::unique_ptr<Graph> graph;
     const DebugOptions& debug_options;
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+    // If false, the executors are created from the graph without Grappler
+    // optimization.
+    bool optimize_graph = true;
   };
 
   // Retrieves an already existing set of executors to run 'inputs' and
@@ -253,6 +275,25 @@ class DirectSession : public Session {
       std::unique_ptr<FunctionInfo>* out_func_info,
       RunStateArgs* run_state_args);
 
+  // Initializes `cost_model` for the critical-path priorities of the executor
+  // of `graph` on `device`. The nodes executed before on `device` by the
+  // cached executors get the execution times measured by their cost models
+  // (see GraphOptions.build_cost_model), and the others a unit cost.
+  void InitCriticalPathCostModel(const Graph& graph, const Device* device,
+                                 CostModel* cost_model);
+
+  // Returns true if the executors for a run with `run_state_args` should
+  // first be created from the unoptimized graph, and replaced by the optimized
+  // ones once they have been created in the background.
+  bool ShouldOptimizeInBackground(const RunStateArgs& run_state_args) const;
+
+  // Creates the executors for `callable_options` from the optimized graph on
+  // `background_optimization_pool_`, and passes them to `swap` unless the
+  // session has been closed or their creation failed.
+  void OptimizeExecutorsInBackground(
+      const CallableOptions& callable_options,
+      std::function<void(std::shared_ptr<ExecutorsAndKeys>)> swap);
+
   // Creates several graphs given the existing graph_def_ and the
   // input feeds and fetches, given 'devices'. The graphs share a common
   // function library 'flib_def'.
@@ -301,6 +342,16 @@ class DirectSession : public Session {
       const ExecutorsAndKeys* executors_and_keys,
       const PartialRunState* run_state);
 
+  // Runs a step of a callable with `step_captures` by replaying its capture
+  // for the shapes of `feed_tensors`, capturing it if it has run enough steps
+  // with those shapes. Sets `*ran` to false if the step must run on the
+  // executor instead.
+  ::tensorflow::Status MaybeRunCapturedStep(
+      int64_t step_id, ExecutorsAndKeys* executors_and_keys,
+      const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors,
+      const thread::ThreadPoolOptions& threadpool_options, bool* ran);
+
   // Use the appropriate WaitForNotification function based on whether
   // operation_timeout_in_ms is greater than 0.
   //
@@ -350,11 +401,21 @@ class DirectSession : public Session {
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
 
+  // Creates the optimized executors for the signatures that first run
+  // unoptimized. Only set if `optimize_graphs_in_background` is true.
+  std::unique_ptr<thread::ThreadPool> background_optimization_pool_;
+
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
+  // See GPUOptions.Experimental.step_capture_warmup_steps.
+  int32 step_capture_warmup_steps_ = 0;
+  // Held exclusively while a step is captured, and shared by the other steps,
+  // whose work would otherwise be captured with it.
+  mutex step_capture_mu_;
+
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
@@ -366,6 +427,11 @@ class DirectSession : public Session {
   // same ExecutorsAndKey object.
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       TF_GUARDED_BY(executor_lock_);
+  // The unoptimized executors replaced in `executors_` by optimized ones,
+  // which are kept alive because Run() holds no reference to the executors
+  // it runs.
+  std::vector<std::shared_ptr<ExecutorsAndKeys>> retired_executors_
+      TF_GUARDED_BY(executor_lock_);
 
   class RunCallableCallFrame;
   struct Callable {
@@ -201,6 +201,74 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, ReuseOptimizedGraphsAcrossSignatures) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()
+      ->set_reuse_optimized_graphs_across_signatures(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0", y_neg_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(2, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(-5.0, outputs[1].matrix<float>()(0, 0));
+
+  // A subset of the fetches of the first signature.
+  TF_ASSERT_OK(session->Run({}, {y_neg_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-5.0, outputs[0].matrix<float>()(0, 0));
+
+  // Different feeds cannot reuse the first signature's optimized graph.
+  Tensor x(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&x, {2, 2});
+  TF_ASSERT_OK(session->Run({{x_, x}}, {y_neg_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-10.0, outputs[0].matrix<float>()(0, 0));
+
+  // A node that was not fetched before.
+  TF_ASSERT_OK(session->Run({}, {z_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-5.0, outputs[0].matrix<float>()(0, 0));
+}
+
+TEST_F(DirectSessionMinusAXTest, OptimizeGraphsInBackground) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_optimize_graphs_in_background(
+      true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({}, {y_neg_ + ":0"}, {}), &handle));
+
+  // The first runs may use either the unoptimized or the optimized executors.
+  for (int i = 0; i < 10; ++i) {
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0", z_ + ":0"}, {}, &outputs));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(-5.0, outputs[1].matrix<float>()(0, 0));
+
+    // The same signature with the fetches in a different order.
+    TF_ASSERT_OK(session->Run({}, {z_ + ":0", y_ + ":0"}, {}, &outputs));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_FLOAT_EQ(-5.0, outputs[0].matrix<float>()(0, 0));
+    EXPECT_FLOAT_EQ(5.0, outputs[1].matrix<float>()(0, 0));
+
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_FLOAT_EQ(-5.0, outputs[0].matrix<float>()(0, 0));
+  }
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+  TF_ASSERT_OK(session->Close());
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -739,6 +807,34 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts) {
   EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 2);
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithLatencyBreakdown) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<string> output_names = {y_ + ":0"};
+  std::vector<Tensor> outputs;
+
+  RunOptions run_options;
+  RunMetadata run_metadata;
+  TF_ASSERT_OK(session->Run(run_options, {}, output_names, {}, &outputs,
+                            &run_metadata));
+  EXPECT_FALSE(run_metadata.has_latency_breakdown());
+
+  run_options.mutable_experimental()->set_report_latency_breakdown(true);
+  const uint64 start_usecs = Env::Default()->NowMicros();
+  TF_ASSERT_OK(session->Run(run_options, {}, output_names, {}, &outputs,
+                            &run_metadata));
+  const uint64 run_usecs = Env::Default()->NowMicros() - start_usecs;
+  ASSERT_TRUE(run_metadata.has_latency_breakdown());
+  const RunMetadata::LatencyBreakdown& breakdown =
+      run_metadata.latency_breakdown();
+  EXPECT_GE(breakdown.setup_usecs(), breakdown.run_handler_wait_usecs());
+  EXPECT_LE(breakdown.setup_usecs() + breakdown.execution_usecs() +
+                breakdown.finalize_usecs(),
+            run_usecs);
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithOpts_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -2493,6 +2589,74 @@ TEST(DirectSessionTest, FeedAndFetchTensorsInDeviceMemory) {
   }
 }
 
+TEST(DirectSessionTest, ReplaysCapturedStepsOfCallables) {
+  SessionOptions options;
+  options.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_step_capture_warmup_steps(1);
+  std::unique_ptr<Session> session(NewSession(options));
+  const string gpu_device_name = GPUDeviceName(session.get());
+  if (gpu_device_name.empty()) {
+    LOG(INFO) << "Skipping test since no GPU is available";
+    return;
+  }
+
+  TF_ASSERT_OK(session->Create(CreateGraphForYEqualsXSquared()));
+
+  CallableOptions opts;
+  opts.add_feed("x:0");
+  opts.add_fetch("y:0");
+
+  // Squares a host tensor into device memory.
+  Session::CallableHandle feed_cpu_fetch_gpu;
+  opts.mutable_fetch_devices()->insert({"y:0", gpu_device_name});
+  opts.set_fetch_skip_sync(true);
+  TF_ASSERT_OK(session->MakeCallable(opts, &feed_cpu_fetch_gpu));
+
+  // Squares a device tensor in device memory. Only the steps of this callable
+  // may be captured, as its feeds and fetches are all on the GPU.
+  Session::CallableHandle feed_gpu_fetch_gpu;
+  opts.mutable_feed_devices()->insert({"x:0", gpu_device_name});
+  TF_ASSERT_OK(session->MakeCallable(opts, &feed_gpu_fetch_gpu));
+
+  // Squares a device tensor into host memory.
+  Session::CallableHandle feed_gpu_fetch_cpu;
+  opts.clear_fetch_devices();
+  opts.set_fetch_skip_sync(false);
+  TF_ASSERT_OK(session->MakeCallable(opts, &feed_gpu_fetch_cpu));
+
+  // The first step runs on the executor, the second one is captured and the
+  // others replay it. Each step is fed other values.
+  for (int step = 0; step < 5; ++step) {
+    Tensor input(DT_FLOAT, {3});
+    Tensor expected(DT_FLOAT, {3});
+    for (int i = 0; i < 3; ++i) {
+      const float x = 0.5f * step + 0.25f * i + 1.0f;
+      input.flat<float>()(i) = x;
+      const float x2 = x * x;
+      const float x4 = x2 * x2;
+      expected.flat<float>()(i) = x4 * x4;
+    }
+    std::vector<Tensor> squares;
+    TF_ASSERT_OK(session->RunCallable(feed_cpu_fetch_gpu, {input}, &squares,
+                                      nullptr));
+    std::vector<Tensor> fourth_powers;
+    TF_ASSERT_OK(session->RunCallable(feed_gpu_fetch_gpu, squares,
+                                      &fourth_powers, nullptr));
+    ASSERT_EQ(1, fourth_powers.size());
+    ASSERT_TRUE(IsCUDATensor(fourth_powers[0]));
+    std::vector<Tensor> eighth_powers;
+    TF_ASSERT_OK(session->RunCallable(feed_gpu_fetch_cpu, fourth_powers,
+                                      &eighth_powers, nullptr));
+    ASSERT_EQ(1, eighth_powers.size());
+    test::ExpectClose(expected, eighth_powers[0]);
+  }
+
+  TF_ASSERT_OK(session->ReleaseCallable(feed_cpu_fetch_gpu));
+  TF_ASSERT_OK(session->ReleaseCallable(feed_gpu_fetch_gpu));
+  TF_ASSERT_OK(session->ReleaseCallable(feed_gpu_fetch_cpu));
+}
+
 GraphDef CreateIdentityGraphDef(DataType dtype) {
   GraphDef def;
 
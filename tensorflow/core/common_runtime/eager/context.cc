@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/context.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <thread>
@@ -105,6 +107,34 @@ auto* eager_context_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/core/eager_context_created",
                                     "True if an eager context was created.");
 
+// Returns an id of the contents of a kernel cache, unique across the contexts.
+// 0 is never returned.
+uint64_t NewKernelCacheId() {
+  static std::atomic<uint64_t> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+// A direct-mapped cache of the kernels recently looked up by a thread, in front
+// of the kernel caches of the contexts. It does not own the kernels: an entry
+// is only valid while its `kernel_cache_id` is the id of the kernel cache that
+// holds its kernel.
+struct ThreadLocalKernelCache {
+  static constexpr int kNumEntries = 64;
+
+  struct Entry {
+    uint64_t kernel_cache_id = 0;
+    Fprint128 cache_key = {0, 0};
+    KernelAndDevice* kernel = nullptr;
+  };
+
+  static Entry& GetEntry(const Fprint128& cache_key) {
+    thread_local ThreadLocalKernelCache cache;
+    return cache.entries[cache_key.low64 % kNumEntries];
+  }
+
+  Entry entries[kNumEntries];
+};
+
 }  // namespace
 
 const int64_t EagerContext::kGlobalRendezvousId = -1;
@@ -160,6 +190,8 @@ EagerContext::EagerContext(
       use_send_tensor_rpc_(false),
       pin_small_ops_to_cpu_(ReadBoolFromEnvVar(
           "TF_EAGER_ENABLE_SMALL_TENSOR_CPU_PINNING", false)),
+      step_tracing_enabled_(
+          ReadBoolFromEnvVar("TF_EAGER_STEP_TRACING", false)),
       run_eager_op_as_function_(run_eager_op_as_function),
       jit_compile_rewrite_(jit_compile_rewrite),
       register_abstract_functions_local_only_(ReadBoolFromEnvVar(
@@ -167,6 +199,7 @@ EagerContext::EagerContext(
   ResetPFLR(device_mgr, opts.env, &opts.config, TF_GRAPH_DEF_VERSION,
             &func_lib_def_, opts.config.graph_options().optimizer_options(),
             thread_pool_.get(), cluster_flr);
+  kernel_cache_id_.store(NewKernelCacheId(), std::memory_order_relaxed);
   // Starts exporting metrics through a platform-specific monitoring API (if
   // provided). For builds using "tensorflow/tsl/platform/default", this is
   // currently a no-op.
@@ -472,6 +505,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     // during this time as well.
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
+    kernel_cache_id_.store(NewKernelCacheId(), std::memory_order_release);
     kernel_cache_.clear();
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
@@ -1131,6 +1165,7 @@ Status EagerContext::RemoveFunction(const string& func) {
     }
     is_last_ref = registered_function->RefCountIsOne();
     if (is_last_ref) {
+      kernel_cache_id_.store(NewKernelCacheId(), std::memory_order_release);
       for (auto& key : *registered_function->cached_kernel_keys) {
         kernel_cache_.erase(key);
       }
@@ -1154,6 +1189,11 @@ Status EagerContext::RemoveFunction(const string& func) {
     for (const auto& notifier : notifiers) {
       notifier();
     }
+    for (const string& variant : specialization_cache_.RemoveVariants(func)) {
+      if (func_lib_def_.Find(variant) != nullptr) {
+        TF_RETURN_IF_ERROR(RemoveFunction(variant));
+      }
+    }
     return MaybeRemoveFunctionRemotely(func);
   }
   return absl::OkStatus();
@@ -1215,13 +1255,27 @@ Status EagerContext::SyncExecutors() {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
+  ThreadLocalKernelCache::Entry& entry =
+      ThreadLocalKernelCache::GetEntry(cache_key);
   tf_shared_lock l(cache_mu_);
+  // The entry does not own its kernel, which is only known to be alive while
+  // `cache_mu_` is held and the id of the kernel cache is unchanged.
+  if (entry.kernel_cache_id ==
+          kernel_cache_id_.load(std::memory_order_relaxed) &&
+      entry.cache_key == cache_key) {
+    core::RefCountPtr<KernelAndDevice> new_ref(entry.kernel);
+    new_ref->Ref();
+    return new_ref;
+  }
+
   auto iter = kernel_cache_.find(cache_key);
   if (iter == kernel_cache_.end()) {
     return nullptr;
   }
   core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
   new_ref->Ref();
+  entry = {kernel_cache_id_.load(std::memory_order_relaxed), cache_key,
+           new_ref.get()};
   return new_ref;
 }
 
@@ -1234,16 +1288,22 @@ Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::AddKernelToCache(
     Fprint128 cache_key, core::RefCountPtr<KernelAndDevice> kernel) {
+  ThreadLocalKernelCache::Entry& entry =
+      ThreadLocalKernelCache::GetEntry(cache_key);
   mutex_lock ml(cache_mu_);
   auto iter = kernel_cache_.find(cache_key);
   if (iter != kernel_cache_.end()) {
     core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
     new_ref->Ref();
+    entry = {kernel_cache_id_.load(std::memory_order_relaxed), cache_key,
+             new_ref.get()};
     return new_ref;
   }
   core::RefCountPtr<KernelAndDevice> new_ref(kernel.get());
   new_ref->Ref();
   kernel_cache_[cache_key] = std::move(new_ref);
+  entry = {kernel_cache_id_.load(std::memory_order_relaxed), cache_key,
+           kernel.get()};
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
 
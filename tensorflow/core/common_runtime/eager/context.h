@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/eager/rendezvous_cache.h"
+#include "tensorflow/core/common_runtime/eager/small_constants_optimizer.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/example/example.pb.h"
@@ -264,6 +265,12 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   const FunctionDef* GetFunctionDef(const string& function_name);
 
+  // Returns the variants of functions specialized on their small input values
+  // by small_constants_optimizer.
+  small_constants_optimizer::SpecializationCache& specialization_cache() {
+    return specialization_cache_;
+  }
+
   std::vector<string> ListFunctionNames() override;
   tensorflow::ImmediateExecutionContext::CacheStats GetCacheStats() override;
 
@@ -280,6 +287,9 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   Status AsyncWait() override { return SyncExecutors(); }
 
+  // Returns the cached kernel for `cache_key`, or nullptr. The kernels
+  // recently looked up or added by the calling thread are found without a
+  // lookup in the kernel cache.
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
   Device* GetCachedDevice(Fprint128 device_cache_key);
 
@@ -556,6 +566,10 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   bool PinSmallOpsToCPU() const { return pin_small_ops_to_cpu_; }
 
+  // Whether repeated sequences of ops are replayed as step functions in async
+  // mode. See StepTracer.
+  bool StepTracingEnabled() const { return step_tracing_enabled_; }
+
   tensorflow::Env* TFEnv() const { return env_; }
 
   Status FindDeviceFromName(const char* device_name, Device** device) const;
@@ -776,8 +790,13 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
                      Fprint128Hasher>
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  // Identifies the contents of `kernel_cache_` in the thread-local kernel
+  // caches, uniquely across contexts. It is changed, with `cache_mu_` held,
+  // before kernels are removed from `kernel_cache_`.
+  std::atomic<uint64_t> kernel_cache_id_{0};
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
+  small_constants_optimizer::SpecializationCache specialization_cache_;
 
   std::unordered_map<string, std::unique_ptr<FunctionLibraryDefinition>>
       component_function_libraries_ TF_GUARDED_BY(cache_mu_);
@@ -893,6 +912,7 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   bool lazy_copy_function_remote_inputs_ = false;
   bool use_send_tensor_rpc_;
   const bool pin_small_ops_to_cpu_;
+  const bool step_tracing_enabled_;
 
   // Function that will be invoked in destructor to deallocate resources related
   // to this context.
@@ -51,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/device_filters.pb.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/macros.h"
 #include "tsl/platform/statusor.h"
@@ -110,6 +111,20 @@ namespace {
     }                                           \
   } while (0);
 
+// Whether collectives are aborted when another task announces its preemption.
+// Off by default, as it prevents the tasks from checkpointing with collectives
+// during the grace period of the preemption.
+bool AbortCollectivesOnPreemption() {
+  bool result;
+  absl::Status s = ReadBoolFromEnvVar("TF_COLLECTIVE_ABORT_ON_PREEMPTION",
+                                      false, &result);
+  if (!s.ok()) {
+    LOG(ERROR) << s.message();
+    return false;
+  }
+  return result;
+}
+
 #ifdef TF_GPU_USE_PJRT
 // Provide a KeyValue interface to the coordination service agent for use by
 // BuildDistributedDevices.
@@ -1100,6 +1115,19 @@ Status EagerContextDistributedManager::EnableCollectiveOps(
           coordination_service_agent_->WaitForAllTasks(devices));
       // Coordination service agent is now connected.
 
+      if (AbortCollectivesOnPreemption()) {
+        // Aborts the collectives as soon as a task announces its preemption,
+        // instead of when its heartbeats time out after it died.
+        coordination_service_agent_->GetKeyValueAsync(
+            "TF_DEFAULT_PREEMPTION_NOTICE_KEY",
+            [this](const absl::StatusOr<std::string>& task) {
+              // Fails when the agent is shut down.
+              if (!task.ok()) return;
+              context_->GetCollectiveExecutorHandle()->get()->StartAbort(
+                  errors::Unavailable("Task ", *task, " is being preempted"));
+            });
+      }
+
       // Convert nested "job name" and "task index" into a flat "node_id" index
       // in 0..num_nodes-1. num_nodes is the sum of the number of tasks in each
       // job.
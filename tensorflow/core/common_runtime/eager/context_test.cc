@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/context.h"
 
+#include <atomic>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -30,11 +32,13 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/eager/context_distributed_manager.h"
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/test.h"
@@ -160,6 +164,88 @@ TEST_F(EagerContextTest, CompositeDeviceWithGivenName) {
   EXPECT_EQ(composite_device_1, composite_device_0);
 }
 
+TEST_F(EagerContextTest, KernelCache) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const Fprint128 cache_key = {1, 2};
+  core::RefCountPtr<KernelAndDevice> kernel(new KernelAndDeviceFunc(
+      /*flr=*/nullptr, /*pflr=*/nullptr, /*input_devices=*/{},
+      /*composite_devices=*/{}, /*input_resource_dtypes_and_shapes=*/{},
+      /*runner=*/nullptr, /*collective_executor=*/nullptr,
+      /*host_cpu_device=*/nullptr, /*name=*/"kernel",
+      /*outputs_on_op_device=*/false,
+      /*allow_small_function_optimizations=*/false,
+      /*allow_control_flow_sync_execution=*/false,
+      /*shape_inference_on_tfe_dialect_import=*/true,
+      /*int_args_and_retvals_on_device=*/false,
+      /*xla_compile_device_type=*/std::nullopt,
+      /*allow_soft_placement=*/false,
+      /*rendezvous_factory=*/Rendezvous::Factory(),
+      /*get_op_id=*/nullptr));
+  KernelAndDevice* kernel_ptr = kernel.get();
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+  context()->AddKernelToCache(cache_key, std::move(kernel));
+  // The second lookup hits the thread-local cache.
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel_ptr);
+  EXPECT_EQ(context()->GetCachedKernel(cache_key).get(), kernel_ptr);
+
+  // The thread-local cache of another context doesn't return the kernel.
+  core::RefCountPtr<EagerContext> other_context(new EagerContext(
+      SessionOptions(), DEVICE_PLACEMENT_EXPLICIT, /*async=*/false,
+      device_manager_.get(), /*device_mgr_owned=*/false,
+      /*rendezvous=*/nullptr, /*cluster_flr=*/nullptr,
+      /*collective_executor_mgr=*/nullptr,
+      /*run_eager_op_as_function=*/true));
+  EXPECT_EQ(other_context->GetCachedKernel(cache_key), nullptr);
+
+  // Nor after the cache is cleared.
+  context()->ClearCachesAndDefaultExecutor();
+  EXPECT_EQ(context()->GetCachedKernel(cache_key), nullptr);
+}
+
+// Removing the function of a kernel must not free it while another thread,
+// which had looked it up before, looks it up again.
+TEST_F(EagerContextTest, KernelCacheRemoveFunctionRace) {
+  InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
+  const Fprint128 cache_key = {3, 4};
+  const FunctionDef x_times_two = FDH::Define(
+      "XTimesTwo", {"x: float"}, {"y: float"}, {},
+      {{{"y"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}}});
+  for (int i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(context()->AddFunctionDef(x_times_two));
+    context()->AddKernelToCache(
+        cache_key,
+        core::RefCountPtr<KernelAndDevice>(new KernelAndDeviceFunc(
+            /*flr=*/nullptr, /*pflr=*/nullptr, /*input_devices=*/{},
+            /*composite_devices=*/{}, /*input_resource_dtypes_and_shapes=*/{},
+            /*runner=*/nullptr, /*collective_executor=*/nullptr,
+            /*host_cpu_device=*/nullptr, /*name=*/"XTimesTwo",
+            /*outputs_on_op_device=*/false,
+            /*allow_small_function_optimizations=*/false,
+            /*allow_control_flow_sync_execution=*/false,
+            /*shape_inference_on_tfe_dialect_import=*/true,
+            /*int_args_and_retvals_on_device=*/false,
+            /*xla_compile_device_type=*/std::nullopt,
+            /*allow_soft_placement=*/false,
+            /*rendezvous_factory=*/Rendezvous::Factory(),
+            /*get_op_id=*/nullptr)));
+
+    std::atomic<bool> looked_up(false);
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), "lookup", [&]() {
+          // Looks the kernel up, from the thread-local cache after the first
+          // time, until the function is removed.
+          while (context()->GetCachedKernel(cache_key) != nullptr) {
+            looked_up = true;
+          }
+        }));
+    while (!looked_up) {
+      Env::Default()->SleepForMicroseconds(10);
+    }
+    TF_ASSERT_OK(context()->RemoveFunction("XTimesTwo"));
+    thread.reset();
+  }
+}
+
 TEST_F(EagerContextTest, AddFunctionDef) {
   InitContext(SessionOptions(), DEVICE_PLACEMENT_EXPLICIT);
   const Tensor kTwo = test::AsScalar<int64_t>(2);
@@ -150,7 +150,7 @@ ImmediateExecutionTensorHandle* EagerContext::CreateLocalHandleFromTFTensor(
 // depends on EagerContext. Thus, the context build target can't depend on
 // EagerOperation.
 ImmediateExecutionOperation* EagerContext::CreateOperation() {
-  return new EagerOperation(this);
+  return EagerOperation::Create(this);
 }
 
 // TODO(b/152902651): Once we move many execute.cc functions into
@@ -168,12 +168,12 @@ Status EagerOperation::Execute(absl::Span<AbstractTensorHandle*> retvals,
   if (device == nullptr) {
     TF_RETURN_IF_ERROR(eager::MaybePinToResourceDevice(&device, *this));
   }
-  if (device == nullptr && ctx_.PinSmallOpsToCPU()) {
+  if (device == nullptr && ctx_->PinSmallOpsToCPU()) {
     bool pin_to_cpu;
     TF_RETURN_IF_ERROR(eager::MaybePinSmallOpsToCpu(
-        &pin_to_cpu, Name(), GetInputs(), ctx_.HostCPU()->name()));
+        &pin_to_cpu, Name(), GetInputs(), ctx_->HostCPU()->name()));
     if (pin_to_cpu) {
-      device = ctx_.HostCPU();
+      device = ctx_->HostCPU();
     }
   }
 
@@ -18,8 +18,10 @@ limitations under the License.
 #include <forward_list>
 #include <functional>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/util/env_var.h"
@@ -32,12 +34,41 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+std::unique_ptr<thread::ThreadPool> CreateDispatchPool(
+    bool async, int num_dispatch_threads) {
+  if (num_dispatch_threads < 0) {
+    int64_t num_threads = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_ASYNC_DISPATCH_THREADS", 0,
+                                    &num_threads));
+    num_dispatch_threads = num_threads;
+  }
+  if (!async || num_dispatch_threads <= 0) return nullptr;
+  return std::make_unique<thread::ThreadPool>(
+      Env::Default(), "eager_async_dispatch", num_dispatch_threads);
+}
+
+// The executor in which the current thread last held nodes.
+thread_local EagerExecutor* holding_executor = nullptr;
+
+// The executors that currently hold nodes, so that `holding_executor` is not
+// used after the executor is destroyed.
+mutex* HoldingExecutorsMutex() {
+  static mutex* mu = new mutex;
+  return mu;
+}
+absl::flat_hash_set<EagerExecutor*>* HoldingExecutors() {
+  static auto* executors = new absl::flat_hash_set<EagerExecutor*>;
+  return executors;
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
-                             int in_flight_nodes_limit)
+                             int in_flight_nodes_limit,
+                             int num_dispatch_threads)
     : next_node_id_(0),
       ok_(true),
+      dispatch_pool_(CreateDispatchPool(async, num_dispatch_threads)),
       thread_(async ? tensorflow::Env::Default()->StartThread(
                           tensorflow::ThreadOptions(), "eager_async_executor",
                           std::bind(&EagerExecutor::Run, this))
@@ -54,6 +85,10 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
 }
 
 EagerExecutor::~EagerExecutor() {
+  for (auto& node : TakeHeldNodes()) {
+    node->Abort(errors::Cancelled(
+        "EagerExecutor was destroyed before scheduling its held nodes."));
+  }
   tensorflow::mutex_lock l(node_queue_mutex_);
   state_ = ExecutorState::kShutDown;
   nodes_pending_.notify_all();
@@ -65,6 +100,7 @@ EagerExecutor::~EagerExecutor() {
 }
 
 Status EagerExecutor::ShutDown() {
+  AddHeldNodes();
   {
     bool has_thread;
     Status status;
@@ -132,6 +168,7 @@ Status EagerExecutor::SyncExecute(EagerNode* node) {
 }
 
 Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
+  if (has_held_nodes_.load(std::memory_order_acquire)) AddHeldNodes();
   Status status;
   core::RefCountPtr<NodeItem> item(new NodeItem);
   item->id = next_node_id_++;
@@ -196,10 +233,79 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
 }
 
 tensorflow::Status EagerExecutor::WaitForAllPendingNodes() {
+  AddHeldNodes();
   tensorflow::mutex_lock l(node_queue_mutex_);
   return WaitForAllPendingNodesLocked(&l);
 }
 
+std::unique_ptr<EagerNode> EagerExecutor::HoldNode(
+    std::unique_ptr<EagerNode> node) {
+  DCHECK(Async());
+  {
+    mutex_lock l(held_nodes_mu_);
+    if (held_nodes_.empty()) {
+      holding_thread_ = std::this_thread::get_id();
+      mutex_lock registry_lock(*HoldingExecutorsMutex());
+      HoldingExecutors()->insert(this);
+    } else if (holding_thread_ != std::this_thread::get_id()) {
+      return node;
+    }
+    held_nodes_.push_back(std::move(node));
+    has_held_nodes_.store(true, std::memory_order_release);
+  }
+  holding_executor = this;
+  return nullptr;
+}
+
+void EagerExecutor::AddHeldNodes() {
+  std::vector<std::unique_ptr<EagerNode>> nodes = TakeHeldNodes();
+  if (nodes.empty()) return;
+  held_nodes_generation_.fetch_add(1, std::memory_order_acq_rel);
+  for (auto& node : nodes) {
+    // On error, AddOrExecute() aborts the node, which poisons its outputs.
+    AddOrExecute(std::move(node)).IgnoreError();
+  }
+}
+
+std::vector<std::unique_ptr<EagerNode>> EagerExecutor::TakeHeldNodes() {
+  std::vector<std::unique_ptr<EagerNode>> nodes;
+  if (!has_held_nodes_.load(std::memory_order_acquire)) return nodes;
+  mutex_lock l(held_nodes_mu_);
+  nodes.swap(held_nodes_);
+  has_held_nodes_.store(false, std::memory_order_release);
+  if (!nodes.empty()) {
+    mutex_lock registry_lock(*HoldingExecutorsMutex());
+    HoldingExecutors()->erase(this);
+  }
+  return nodes;
+}
+
+void EagerExecutor::AddHeldNodesIfHolding(EagerExecutor* executor) {
+  {
+    mutex_lock l(*HoldingExecutorsMutex());
+    if (!HoldingExecutors()->contains(executor)) return;
+  }
+  executor->AddHeldNodes();
+}
+
+void EagerExecutor::AddHeldNodesOfCurrentThread() {
+  EagerExecutor* executor = holding_executor;
+  if (executor == nullptr) return;
+  holding_executor = nullptr;
+  AddHeldNodesIfHolding(executor);
+}
+
+void EagerExecutor::AddAllHeldNodes() {
+  std::vector<EagerExecutor*> executors;
+  {
+    mutex_lock l(*HoldingExecutorsMutex());
+    executors.assign(HoldingExecutors()->begin(), HoldingExecutors()->end());
+  }
+  for (EagerExecutor* executor : executors) {
+    AddHeldNodesIfHolding(executor);
+  }
+}
+
 tensorflow::Status EagerExecutor::WaitForAllPendingNodesLocked(
     mutex_lock* lock) {
   tensorflow::condition_variable cond;
@@ -237,9 +343,11 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
   DVLOG(3) << "Node Done: [id " << item->id << "] " << item->node->DebugString()
            << " with status: " << status;
   DCHECK(item->state != NodeState::kDONE);
+  // Async nodes and nodes run on `dispatch_pool_` are in unfinished_nodes_.
+  bool async = item->node->AsAsync() != nullptr ||
+               item->state == NodeState::kSCHEDULED;
   item->state = NodeState::kDONE;
 
-  bool async = item->node->AsAsync() != nullptr;
   // If executing synchronously we don't need to notify if status is OK since
   // the node  was never added to the unfinished_nodes_ list and nobody should
   // ever be waiting for it.
@@ -365,7 +473,10 @@ void EagerExecutor::Run() {
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
     }
-    Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
+    Status status =
+        dispatch_pool_ != nullptr && curr_item->node->CanRunConcurrently()
+            ? DispatchItem(std::move(curr_item))
+            : RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
       VLOG(1) << "Failed to run item: " << status;
     }
@@ -425,6 +536,26 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
   return status();
 }
 
+Status EagerExecutor::DispatchItem(core::RefCountPtr<NodeItem> item) {
+  DVLOG(3) << "Dispatching Node: [id " << item->id << "] "
+           << item->node->DebugString();
+  item->state = NodeState::kSCHEDULED;
+  NodeItem* dispatched = item.get();
+  dispatched->Ref();
+  Status status = MoveToUnfinished(std::move(item), /*from_queue=*/true);
+  if (!status.ok()) {
+    dispatched->Unref();
+    return status;
+  }
+
+  dispatch_pool_->Schedule([this, dispatched]() {
+    core::RefCountPtr<NodeItem> dispatched_item(dispatched);
+    NodeDone(dispatched_item, dispatched_item->node->Run(),
+             /*from_queue=*/false);
+  });
+  return absl::OkStatus();
+}
+
 Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                        bool from_queue) {
   tensorflow::mutex_lock l(node_queue_mutex_);
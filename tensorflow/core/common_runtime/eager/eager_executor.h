@@ -23,6 +23,7 @@ limitations under the License.
 #include <memory>
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_map>
 #include <vector>
 
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/version.h"
 
@@ -79,6 +81,11 @@ class EagerNode {
 
   // Indicates whether a node failure should make the executor unusable.
   virtual bool Fatal() const { return true; }
+
+  // Returns true if this node has no side effects and all its inputs are
+  // ready, in which case an async EagerExecutor with dispatch threads may run
+  // it concurrently with the nodes added before and after it.
+  virtual bool CanRunConcurrently() const { return false; }
 };
 
 class AsyncEagerNode : public EagerNode {
@@ -110,13 +117,17 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // TODO(agarwal): TFE_OpAddInput may currently block if it tries to access the
 // device of the input handle. Fix that.
 // TODO(agarwal): Implement support for control dependencies.
-// TODO(agarwal): Support out-of-order execution and dispatching multiple
-// EagerNode in parallel.
-// TODO(agarwal): Implement optimizations over EagerNode traces.
 class EagerExecutor {
  public:
+  // In async mode, nodes for which EagerNode::CanRunConcurrently() returns
+  // true are run on a pool of `num_dispatch_threads` threads instead of the
+  // executor thread, so that independent nodes run in parallel. Other nodes
+  // still run in order on the executor thread. A negative
+  // `num_dispatch_threads` reads it from TF_EAGER_ASYNC_DISPATCH_THREADS,
+  // which defaults to 0, i.e. no dispatch threads.
   explicit EagerExecutor(bool async, bool enable_streaming_enqueue = true,
-                         int in_flight_nodes_limit = 0);
+                         int in_flight_nodes_limit = 0,
+                         int num_dispatch_threads = -1);
 
   ~EagerExecutor();
 
@@ -147,6 +158,39 @@ class EagerExecutor {
   // returned.
   Status WaitForAllPendingNodes();
 
+  // In async mode, holds `node` back instead of scheduling it, so that the
+  // caller can replace a trace of held nodes by an equivalent node with
+  // TakeHeldNodes(). Held nodes are scheduled in order by AddHeldNodes(),
+  // which is called before any other node is added, before waiting for
+  // pending nodes, and before any thread blocks on a TensorHandle that is not
+  // ready. Only one thread at a time holds nodes:
+  // returns `node` without holding it if another thread holds nodes.
+  std::unique_ptr<EagerNode> HoldNode(std::unique_ptr<EagerNode> node);
+
+  // Schedules the held nodes.
+  void AddHeldNodes();
+
+  // Returns the held nodes without scheduling them.
+  std::vector<std::unique_ptr<EagerNode>> TakeHeldNodes();
+
+  // Incremented whenever AddHeldNodes() schedules held nodes, so that the
+  // caller of HoldNode() can tell whether its nodes are still held.
+  uint64 held_nodes_generation() const {
+    return held_nodes_generation_.load(std::memory_order_acquire);
+  }
+
+  // Schedules the held nodes of the executor in which the current thread last
+  // held nodes, if it still holds any.
+  static void AddHeldNodesOfCurrentThread();
+
+  // Schedules the held nodes of all executors, e.g. before blocking on a
+  // TensorHandle, which a node held by any thread may produce.
+  static void AddAllHeldNodes();
+
+  // Schedules the held nodes of `executor` if it still holds any. Unlike
+  // AddHeldNodes(), can be called after `executor` is destroyed.
+  static void AddHeldNodesIfHolding(EagerExecutor* executor);
+
   // Clears all currently set errors which re-enables async execution.
   void ClearError();
 
@@ -211,6 +255,8 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+  // Runs `item`, which is at the front of node_queue_, on `dispatch_pool_`.
+  Status DispatchItem(core::RefCountPtr<NodeItem> item);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -258,6 +304,11 @@ class EagerExecutor {
   ExecutorState state_ TF_GUARDED_BY(node_queue_mutex_) =
       ExecutorState::kActive;
 
+  // Runs the nodes that can run concurrently in async mode. It is `nullptr` in
+  // sync mode or if there are no dispatch threads. Declared before `thread_`
+  // so that the executor thread is joined before the pool is destroyed.
+  const std::unique_ptr<thread::ThreadPool> dispatch_pool_;
+
   // Thread object that calls the `Run` method in async mode.This thread runs
   // until state_ is set to kShuttingDown. It is `nullptr` in sync mode.
   const std::unique_ptr<Thread> thread_;
@@ -277,6 +328,14 @@ class EagerExecutor {
   // async nodes reach this number, enqueuing to the eager async queue is
   // blocked.
   const int64_t in_flight_nodes_limit_;
+
+  // Nodes held back by HoldNode(), in order.
+  mutex held_nodes_mu_;
+  std::vector<std::unique_ptr<EagerNode>> held_nodes_
+      TF_GUARDED_BY(held_nodes_mu_);
+  std::thread::id holding_thread_ TF_GUARDED_BY(held_nodes_mu_);
+  std::atomic<bool> has_held_nodes_{false};
+  std::atomic<uint64> held_nodes_generation_{0};
 };
 
 inline bool EagerExecutor::Async() const { return thread_ != nullptr; }
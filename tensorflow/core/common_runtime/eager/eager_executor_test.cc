@@ -18,6 +18,7 @@ limitations under the License.
 #include <utility>
 
 #include "xla/tsl/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +103,27 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+class TestConcurrentEagerNode : public EagerNode {
+ public:
+  explicit TestConcurrentEagerNode(BlockingCounter* started)
+      : started_(started) {}
+  TestConcurrentEagerNode(const TestConcurrentEagerNode&) = delete;
+  TestConcurrentEagerNode& operator=(const TestConcurrentEagerNode&) = delete;
+
+  Status Run() override {
+    started_->DecrementCount();
+    started_->Wait();
+    return absl::OkStatus();
+  }
+
+  void Abort(Status status) override {}
+  bool CanRunConcurrently() const override { return true; }
+  string DebugString() const override { return "testConcurrentEagerNode"; }
+
+ private:
+  BlockingCounter* started_;
+};
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -269,6 +291,27 @@ TEST(EagerExecutorTest, TestAsyncExecutorFailRunWithAsyncNode) {
   ASSERT_EQ(state->read_state(), TestState::State::kFailure);
 }
 
+TEST(EagerExecutorTest, TestAsyncExecutorWithDispatchThreads) {
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true,
+      /*in_flight_nodes_limit=*/0, /*num_dispatch_threads=*/2);
+
+  // Each node waits for the other one to start, so they only finish if they
+  // run concurrently.
+  BlockingCounter started(2);
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestConcurrentEagerNode>(&started)));
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestConcurrentEagerNode>(&started)));
+
+  auto state = std::make_unique<TestState>();
+  auto node = std::make_unique<TestEagerNode>(state.get());
+  TF_ASSERT_OK(async_executor->AddOrExecute(std::move(node)));
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  ASSERT_EQ(state->read_state(), TestState::State::kSuccess);
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
 TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
   auto async_executor = std::make_unique<EagerExecutor>(
       /*async=*/true, /*enable_streaming_enqueue=*/true);
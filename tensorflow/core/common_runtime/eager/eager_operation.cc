@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <variant>
@@ -36,6 +38,88 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// The number of released operations that a thread keeps for reuse.
+constexpr int kMaxFreeOperations = 16;
+
+std::atomic<int64_t> num_operations_allocated{0};
+
+// Set when the operations kept by the thread are deleted, after which the
+// released operations are deleted right away.
+thread_local bool free_operations_deleted = false;
+
+}  // namespace
+
+// The operations released by a thread, linked through their `next_free_`.
+// They are not bound to a context until they are reused.
+class EagerOperation::FreeOperations {
+ public:
+  ~FreeOperations() {
+    free_operations_deleted = true;
+    while (head_ != nullptr) delete Pop();
+  }
+
+  // Returns nullptr once the thread is exiting.
+  static FreeOperations* Get() {
+    if (free_operations_deleted) return nullptr;
+    thread_local FreeOperations free_operations;
+    return &free_operations;
+  }
+
+  // Returns nullptr if no operation is kept.
+  EagerOperation* Pop() {
+    EagerOperation* op = head_;
+    if (op == nullptr) return nullptr;
+    head_ = op->next_free_;
+    op->next_free_ = nullptr;
+    --size_;
+    return op;
+  }
+
+  // Returns false if the thread keeps enough operations already.
+  bool Push(EagerOperation* op) {
+    if (size_ == kMaxFreeOperations) return false;
+    op->next_free_ = head_;
+    head_ = op;
+    ++size_;
+    return true;
+  }
+
+ private:
+  EagerOperation* head_ = nullptr;
+  int size_ = 0;
+};
+
+EagerOperation* EagerOperation::Create(tensorflow::EagerContext* ctx) {
+  FreeOperations* free_operations = FreeOperations::Get();
+  EagerOperation* op =
+      free_operations != nullptr ? free_operations->Pop() : nullptr;
+  if (op == nullptr) {
+    num_operations_allocated.fetch_add(1, std::memory_order_relaxed);
+    return new EagerOperation(ctx);
+  }
+  op->ctx_ = ctx;
+  return op;
+}
+
+int64_t EagerOperation::NumAllocated() {
+  return num_operations_allocated.load(std::memory_order_relaxed);
+}
+
+void EagerOperation::Release() {
+  Clear();
+  // Forgets the state of the last op that Reset doesn't, since the operation
+  // may be reused with another context.
+  eager_func_params_.reset();
+  last_set_device_name_.clear();
+  device_name_.clear();
+  device_parsed_name_.Clear();
+  device_ = kVariantDeviceNull;
+  FreeOperations* free_operations = FreeOperations::Get();
+  if (free_operations == nullptr || !free_operations->Push(this)) delete this;
+}
+
 // An EagerOperation object can be reused for a different op by calling
 // Clear(), and then Reset(...) with the same arguments that would have
 // been provided to the constructor.
@@ -343,7 +427,7 @@ Status EagerOperation::Reset(
         eager_func_params.value().func_lib_def_override != nullptr) {
       func_lib_def = eager_func_params.value().func_lib_def_override;
     } else {
-      func_lib_def = ctx_.FuncLibDef();
+      func_lib_def = ctx_->FuncLibDef();
     }
     if (func_lib_def->Find(op) == nullptr) {
       return absl::NotFoundError(absl::StrCat(
@@ -359,7 +443,7 @@ Status EagerOperation::Reset(
   stack_trace_.reset();
   is_function_ = is_function;
   cancellation_manager_ = nullptr;
-  executor_ = executor ? executor : &ctx_.Executor();
+  executor_ = executor ? executor : &ctx_->Executor();
   if (eager_func_params.has_value()) {
     eager_func_params_ = eager_func_params;
   }
@@ -479,12 +563,12 @@ Status EagerOperation::SetDeviceName(const char* c_name) {
 }
 
 bool EagerOperation::IsLocal() const {
-  if (ctx_.remote_device_mgr() == nullptr) return true;
+  if (ctx_->remote_device_mgr() == nullptr) return true;
 
   if (!device_parsed_name_.has_job && !device_parsed_name_.has_replica &&
       !device_parsed_name_.has_task)
     return true;
-  auto& host_cpu_name = ctx_.HostCPU()->parsed_name();
+  auto& host_cpu_name = ctx_->HostCPU()->parsed_name();
   return device_parsed_name_.job == host_cpu_name.job &&
          device_parsed_name_.replica == host_cpu_name.replica &&
          device_parsed_name_.task == host_cpu_name.task;
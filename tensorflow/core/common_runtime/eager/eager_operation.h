@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OPERATION_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EAGER_OPERATION_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <variant>
@@ -43,14 +44,22 @@ namespace tensorflow {
 class EagerOperation : public ImmediateExecutionOperation {
  public:
   explicit EagerOperation(tensorflow::EagerContext* ctx)
-      : ImmediateExecutionOperation(kEager), ctx_(*ctx), is_function_(false) {}
+      : ImmediateExecutionOperation(kEager), ctx_(ctx), is_function_(false) {}
   ~EagerOperation() override {
     for (ImmediateExecutionTensorHandle* h : inputs_) {
       h->Unref();
     }
   }
 
-  void Release() override { delete this; }
+  // Returns an operation of `ctx`, reusing one released by this thread if
+  // there is one.
+  static EagerOperation* Create(tensorflow::EagerContext* ctx);
+  // The number of operations allocated by Create.
+  static int64_t NumAllocated();
+
+  // Clears the operation and keeps it for reuse by Create on this thread, or
+  // deletes it if the thread keeps enough operations already.
+  void Release() override;
 
   void Clear() override;
   Status Reset(const char* op, const char* raw_device_name) override {
@@ -61,7 +70,7 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   const string& DeviceName() const override { return device_name_; }
 
-  ImmediateExecutionContext* GetContext() const override { return &ctx_; }
+  ImmediateExecutionContext* GetContext() const override { return ctx_; }
 
   const DeviceNameUtils::ParsedName& GetDeviceParsedName() const {
     return device_parsed_name_;
@@ -152,14 +161,14 @@ class EagerOperation : public ImmediateExecutionOperation {
   bool is_function() const { return is_function_; }
   bool colocation_exempt() const { return colocation_exempt_; }
 
-  tensorflow::EagerContext& EagerContext() const { return ctx_; }
+  tensorflow::EagerContext& EagerContext() const { return *ctx_; }
 
   const FunctionLibraryDefinition* FuncLibDef() const {
     if (eager_func_params_.has_value() &&
         eager_func_params_.value().func_lib_def_override) {
       return eager_func_params_.value().func_lib_def_override;
     } else {
-      return ctx_.FuncLibDef();
+      return ctx_->FuncLibDef();
     }
   }
 
@@ -252,6 +261,8 @@ class EagerOperation : public ImmediateExecutionOperation {
   }
 
  private:
+  class FreeOperations;
+
   void AddTensorHandle(ImmediateExecutionTensorHandle* h);
 
   const tensorflow::OpDef* GetOpDef(Status* status);
@@ -270,7 +281,8 @@ class EagerOperation : public ImmediateExecutionOperation {
   void InferMixedTypeInputListAttrs(const OpDef::ArgDef& input_def,
                                     const std::vector<DataType>& dtypes);
 
-  tensorflow::EagerContext& ctx_;
+  // Not owned. Only changes when a released operation is reused.
+  tensorflow::EagerContext* ctx_;
   const char* op_name_ = nullptr;
   AttrBuilder attrs_;
   const AttrTypeMap* attr_types_;
@@ -314,6 +326,9 @@ class EagerOperation : public ImmediateExecutionOperation {
   int inference_arg_idx_;  // arg definition index for the next input to be
                            // added
   gtl::FlatSet<std::string> inference_attrs_;  // attributes inferred so far
+
+  // The next released operation kept by the thread, while this one is kept.
+  EagerOperation* next_free_ = nullptr;
 };
 
 inline void EagerOperation::UpdateInput(int i, TensorHandle* h) {
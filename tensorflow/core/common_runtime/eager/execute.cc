@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -31,11 +32,13 @@ limitations under the License.
 // clang-format off
 // Required for IS_MOBILE_PLATFORM
 #include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_replace.h"
 #include "tensorflow/core/common_runtime/arg_ret_placement.h"
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
 #include "tensorflow/core/common_runtime/eager/small_constants_optimizer.h"
+#include "tensorflow/core/common_runtime/eager/step_tracer.h"
 #include "tensorflow/core/common_runtime/eager/summary_optimizer.h"
 #include "tensorflow/core/common_runtime/int32_fulltype.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -1082,6 +1085,64 @@ std::optional<bool> GetBoolArgumentValue(const EagerOperation& op,
   return std::nullopt;
 }
 
+// Renames `op` to a variant of its function specialized on the values of its
+// small integer inputs, which small_constants_optimizer folds as constants.
+// Variants are keyed by the fingerprint of the input values and their number
+// is bounded, past which `op` keeps calling the generic function. Inputs that
+// are not ready host tensors are never specialized on, so that this does not
+// block on pending async operations.
+Status SpecializeSmallInputs(EagerOperation* op) {
+  EagerContext& ctx = op->EagerContext();
+  // Extract tensor inputs.
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  if (!op->TensorHandleInputs(&inputs).ok()) return absl::OkStatus();
+  // Extract the FunctionDef.
+  const FunctionDef* fdef = ctx.GetFunctionDef(op->Name());
+  if (fdef == nullptr) return absl::OkStatus();
+  if (small_constants_optimizer::IsSpecializedFunction(*fdef)) {
+    return absl::OkStatus();
+  }
+  // Ensure the number of inputs matches the specification in the FunctionDef.
+  if (fdef->signature().input_arg_size() != inputs->size()) {
+    return absl::OkStatus();
+  }
+
+  small_constants_optimizer::InputValues input_values;
+  for (int32_t i = 0; i < fdef->signature().input_arg_size(); ++i) {
+    const TensorHandle* handle = inputs->at(i);
+    if (handle->Type() != TensorHandle::LOCAL || !handle->IsReady()) continue;
+    Status s;
+    const char* input_device = handle->DeviceType(&s);
+    if (!s.ok() || !absl::StrContains(input_device, "CPU")) continue;
+    const Tensor* tensor;
+    if (!handle->Tensor(&tensor).ok()) continue;
+    const auto& input_arg = fdef->signature().input_arg(i);
+    if (!small_constants_optimizer::IsSpecializableInput(input_arg, *tensor)) {
+      continue;
+    }
+    input_values.emplace_back(input_arg.name(), *tensor);
+  }
+  if (input_values.empty()) return absl::OkStatus();
+
+  bool is_new = false;
+  const std::optional<string> specialized_name =
+      ctx.specialization_cache().GetOrAddVariant(
+          op->Name(),
+          small_constants_optimizer::InputValuesFingerprint(input_values),
+          &is_new);
+  if (!specialized_name.has_value()) return absl::OkStatus();
+  if (is_new) {
+    TF_RETURN_IF_ERROR(ctx.AddFunctionDef(
+        small_constants_optimizer::SpecializeInputs(*fdef, *specialized_name,
+                                                    input_values)));
+  } else if (ctx.GetFunctionDef(*specialized_name) == nullptr) {
+    // Another thread is still adding the variant.
+    return absl::OkStatus();
+  }
+  op->UpdateName(*specialized_name);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<Fprint128> GetKernelCacheKey(
     const EagerOperation& op, const Fprint128& op_cache_key,
     const std::vector<Device*>& input_device_ptrs,
@@ -1246,6 +1307,7 @@ Status GetOrCreateKernelAndDevice(
     return small_constants_optimizer::IsSmallConstantOptimizationEnabled(*fdef);
   };
   if (is_small_constant_optimization_enabled(*op)) {
+    TF_RETURN_IF_ERROR(SpecializeSmallInputs(op));
     TF_ASSIGN_OR_RETURN(BoolTensorInputs bool_inputs,
                         GetBoolInputs(op, /*delete_inputs=*/false));
     string folded_name = op->Name();
@@ -1303,8 +1365,10 @@ Status GetOrCreateKernelAndDevice(
   absl::flat_hash_map<string, const std::vector<string>*> composite_devices;
   std::unordered_map<int, DtypeAndPartialTensorShape>
       input_resource_variable_dtypes_and_shapes;
+  // The kernel def is only needed to run the op as a function, so that looking
+  // up a cached kernel does not search the kernel registry.
   const KernelDef* kernel_def = nullptr;
-  if (!op->is_function()) {
+  if (!op->is_function() && ctx.RunEagerOpAsFunction()) {
     const NodeDef& node_def = op->MutableAttrs()->BuildNodeDef();
     auto get_kernel_def = [](const EagerOperation& op, const NodeDef& node_def,
                              const Device* op_device) -> const KernelDef* {
@@ -1610,6 +1674,271 @@ Status CreateUnshapedOutput(
 #endif  // !IS_MOBILE_PLATFORM
 }
 
+// Per-thread state for replaying steps of async eager ops as functions. See
+// StepTracer.
+struct StepTracingState {
+  EagerContext* ctx = nullptr;
+  EagerExecutor* executor = nullptr;
+  // The held nodes generation of `executor` when this thread last held a node.
+  uint64 generation = 0;
+  StepTracer tracer;
+  // The ops of the current step of `tracer`, whose nodes `executor` holds.
+  std::vector<TracedOp> held_ops;
+  // Names of the step functions, keyed by step fingerprint and topology.
+  absl::flat_hash_map<std::pair<uint64, uint64>, string> functions;
+  // Fingerprints of the steps with a step function, whose ops are traced
+  // without their NodeDefs.
+  absl::flat_hash_set<uint64> steps_with_functions;
+  // The cancellation manager of the ops of the current step, if any, and the
+  // token of its callback, which schedules the held nodes on cancellation.
+  CancellationManager* cancellation_manager = nullptr;
+  CancellationToken cancellation_token = CancellationManager::kInvalidToken;
+
+  void ClearHeldOps() {
+    held_ops.clear();
+    if (cancellation_manager != nullptr) {
+      cancellation_manager->TryDeregisterCallback(cancellation_token);
+      cancellation_manager = nullptr;
+    }
+  }
+
+  void EndStep() {
+    tracer.EndStep();
+    ClearHeldOps();
+  }
+};
+
+StepTracingState& ThreadStepTracingState() {
+  static thread_local StepTracingState state;
+  return state;
+}
+
+// Returns the signature of `op` for StepTracer, or 0 if it can not be part
+// of a step function.
+uint64 StepSignature(
+    EagerOperation* op, KernelAndDevice& kernel,
+    const absl::InlinedVector<TensorHandle*, 4>& inputs,
+    const std::optional<EagerFunctionParams>& eager_func_params,
+    GraphCollector* graph_collector) {
+  if (op->is_function() || kernel.IsFunction() || kernel.IsCrossProcess() ||
+      eager_func_params.has_value() || graph_collector != nullptr ||
+      op->OpDef() == nullptr || kernel.device() == nullptr) {
+    return 0;
+  }
+  for (DataType dtype : kernel.output_dtypes()) {
+    if (dtype == DT_RESOURCE || IsRefType(dtype)) return 0;
+  }
+  const Fprint128 cache_key =
+      op->MutableAttrs()->CacheKey(kernel.device()->name());
+  uint64 signature = FingerprintCat64(cache_key.low64, cache_key.high64);
+  // The ops of a step share their cancellation manager, which the step
+  // function is run with.
+  signature = FingerprintCat64(
+      signature, reinterpret_cast<uintptr_t>(op->GetCancellationManager()));
+  for (TensorHandle* input : inputs) {
+    if (input->Type() != TensorHandle::LOCAL) return 0;
+    signature = FingerprintCat64(signature, input->dtype);
+  }
+  return signature == 0 ? 1 : signature;
+}
+
+// Adds `op` to the StepTracer of the current thread and returns what to do
+// with its node. Fills `traced_op` unless the node is to be run as usual.
+StepTracer::Action TraceStepOp(
+    EagerOperation* op, KernelAndDevice& kernel,
+    const absl::InlinedVector<TensorHandle*, 4>& inputs,
+    const std::optional<EagerFunctionParams>& eager_func_params,
+    GraphCollector* graph_collector, absl::Span<TensorHandle* const> retvals,
+    TracedOp* traced_op) {
+  StepTracingState& state = ThreadStepTracingState();
+  EagerExecutor* executor = &op->Executor();
+  if (state.ctx != &op->EagerContext() || state.executor != executor) {
+    if (!state.held_ops.empty()) {
+      EagerExecutor::AddHeldNodesOfCurrentThread();
+    }
+    state.ClearHeldOps();
+    state = StepTracingState();
+    state.ctx = &op->EagerContext();
+    state.executor = executor;
+  } else if (state.generation != executor->held_nodes_generation()) {
+    // The held nodes were scheduled, e.g. because an output was waited on.
+    state.EndStep();
+  }
+  state.generation = executor->held_nodes_generation();
+
+  const StepTracer::Action action = state.tracer.AddOp(
+      StepSignature(op, kernel, inputs, eager_func_params, graph_collector));
+  if (action == StepTracer::Action::kRun) {
+    // Adding the node schedules the held nodes first.
+    state.ClearHeldOps();
+    return action;
+  }
+  if (state.tracer.num_held_ops() == 1 && !state.held_ops.empty()) {
+    // The op starts another step: run the ops of the previous one as usual.
+    executor->AddHeldNodes();
+    state.ClearHeldOps();
+    state.generation = executor->held_nodes_generation();
+  }
+
+  if (!state.steps_with_functions.contains(state.tracer.step_fingerprint())) {
+    traced_op->ndef = op->MutableAttrs()->BuildNodeDef();
+    traced_op->ndef.set_device(kernel.device()->name());
+  }
+  traced_op->is_stateful = op->OpDef()->is_stateful();
+  traced_op->inputs.assign(inputs.begin(), inputs.end());
+  traced_op->outputs.assign(retvals.begin(), retvals.end());
+  for (TensorHandle* input : inputs) {
+    traced_op->input_dtypes.push_back(input->dtype);
+  }
+  traced_op->output_dtypes = kernel.output_dtypes();
+  return action;
+}
+
+TensorHandle* TracedHandle(const void* handle) {
+  return const_cast<TensorHandle*>(static_cast<const TensorHandle*>(handle));
+}
+
+// Creates a node that calls the step function `function_name` with `args`,
+// and sets `retvals`, the outputs of the held nodes it replaces.
+absl::StatusOr<std::unique_ptr<EagerNode>> CreateStepNode(
+    EagerContext& ctx, EagerExecutor& executor, const string& function_name,
+    absl::Span<const void* const> args, absl::Span<TensorHandle*> retvals,
+    CancellationManager* cancellation_manager) {
+  EagerOperation op(&ctx);
+  TF_RETURN_IF_ERROR(op.Reset(function_name.c_str(), /*device_name=*/nullptr,
+                              /*remote=*/false, &executor));
+  for (const void* arg : args) {
+    TF_RETURN_IF_ERROR(op.AddInput(TracedHandle(arg)));
+  }
+  core::RefCountPtr<KernelAndDevice> kernel;
+  int num_retvals = retvals.size();
+  std::vector<TensorHandle*> unused_retvals(num_retvals);
+  TF_RETURN_IF_ERROR(GetOrCreateKernelAndDevice(&op, unused_retvals.data(),
+                                                &num_retvals, &kernel));
+  TF_RETURN_IF_ERROR(ValidateInputTypeAndPlacement(&ctx, &op, kernel));
+  if (kernel->num_outputs() != retvals.size()) {
+    return errors::Internal("Step function ", function_name, " has ",
+                            kernel->num_outputs(), " outputs, expected ",
+                            retvals.size());
+  }
+  for (int i = 0; i < retvals.size(); ++i) {
+    if (kernel->output_dtypes()[i] != retvals[i]->dtype ||
+        ctx.CanonicalDevice(kernel->OutputDevice(i)) != retvals[i]->device()) {
+      return errors::FailedPrecondition("Output ", i, " of step function ",
+                                        function_name,
+                                        " does not match the op it replaces.");
+    }
+  }
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  TF_RETURN_IF_ERROR(op.TensorHandleInputs(&inputs));
+  return std::unique_ptr<EagerNode>(std::make_unique<AsyncExecuteNode>(
+      &ctx, *inputs, /*eager_func_params=*/std::nullopt, std::move(kernel),
+      /*graph_collector=*/nullptr, cancellation_manager, retvals,
+      /*stack_trace=*/std::nullopt));
+}
+
+// Replaces the nodes held for the current step by a call to its step
+// function, building the function if needed. Returns an error if the step
+// can not be replayed, in which case the held nodes are left to be scheduled.
+Status ReplayStep(StepTracingState& state, EagerContext& ctx,
+                  EagerExecutor& executor) {
+  const uint64 step_fingerprint = state.tracer.step_fingerprint();
+  std::vector<const void*> args;
+  const auto key =
+      std::make_pair(step_fingerprint, StepTopology(state.held_ops, &args));
+  string& function_name = state.functions[key];
+  if (function_name.empty()) {
+    function_name = absl::StrCat(
+        "__eager_step_", absl::Hex(FingerprintCat64(key.first, key.second)));
+  }
+  if (ctx.FindFunctionDef(function_name) == nullptr) {
+    if (state.held_ops.front().ndef.op().empty()) {
+      // Trace the NodeDefs of the ops the next time the step is run.
+      state.steps_with_functions.erase(step_fingerprint);
+      return errors::Unavailable("The NodeDefs of the step were not traced.");
+    }
+    TF_ASSIGN_OR_RETURN(FunctionDef fdef,
+                        BuildStepFunction(function_name, state.held_ops));
+    TF_RETURN_IF_ERROR(ctx.AddFunctionDef(fdef));
+    state.steps_with_functions.insert(step_fingerprint);
+  }
+
+  std::vector<TensorHandle*> retvals;
+  for (const TracedOp& op : state.held_ops) {
+    for (const void* output : op.outputs) {
+      retvals.push_back(TracedHandle(output));
+    }
+  }
+  // Take the held nodes first, since copying the inputs of the step function
+  // adds nodes, which would schedule them.
+  std::vector<std::unique_ptr<EagerNode>> held_nodes = executor.TakeHeldNodes();
+  // Another thread schedules the held nodes when it waits on their outputs.
+  absl::StatusOr<std::unique_ptr<EagerNode>> step_node = errors::Unavailable(
+      "Held ", held_nodes.size(), " nodes for a step of ",
+      state.held_ops.size(), " ops.");
+  if (held_nodes.size() == state.held_ops.size()) {
+    step_node =
+        CreateStepNode(ctx, executor, function_name, args,
+                       absl::MakeSpan(retvals), state.cancellation_manager);
+  }
+  if (!step_node.ok()) {
+    for (auto& node : held_nodes) {
+      executor.AddOrExecute(std::move(node)).IgnoreError();
+    }
+    return step_node.status();
+  }
+  // The held nodes were not run: destroying them only releases their inputs
+  // and outputs, which the step node sets instead.
+  held_nodes.clear();
+  executor.AddOrExecute(*std::move(step_node)).IgnoreError();
+  return absl::OkStatus();
+}
+
+// Holds `node`, the node of an op traced as part of a step, and replays the
+// step when `action` completes it. Cancelling `cancellation_manager`, the
+// cancellation manager of the ops of the step, schedules the held nodes.
+Status HoldStepNode(EagerContext& ctx, EagerExecutor& executor,
+                    std::unique_ptr<EagerNode> node, StepTracer::Action action,
+                    TracedOp traced_op,
+                    CancellationManager* cancellation_manager) {
+  StepTracingState& state = ThreadStepTracingState();
+  node = executor.HoldNode(std::move(node));
+  if (node != nullptr) {
+    // Another thread holds nodes of the executor.
+    state.EndStep();
+    return executor.AddOrExecute(std::move(node));
+  }
+  if (state.held_ops.empty() && cancellation_manager != nullptr) {
+    const CancellationToken token =
+        cancellation_manager->get_cancellation_token();
+    EagerExecutor* executor_ptr = &executor;
+    if (!cancellation_manager->RegisterCallback(token, [executor_ptr]() {
+          EagerExecutor::AddHeldNodesIfHolding(executor_ptr);
+        })) {
+      // Already cancelled: run the op as usual.
+      state.EndStep();
+      executor.AddHeldNodes();
+      return absl::OkStatus();
+    }
+    state.cancellation_manager = cancellation_manager;
+    state.cancellation_token = token;
+  }
+  state.held_ops.push_back(std::move(traced_op));
+  if (action == StepTracer::Action::kReplay) {
+    Status s = ReplayStep(state, ctx, executor);
+    if (s.ok()) {
+      state.EndStep();
+    } else {
+      VLOG(1) << "Not replaying eager step: " << s;
+      if (!absl::IsUnavailable(s)) state.tracer.RejectStep();
+      state.EndStep();
+      executor.AddHeldNodes();
+    }
+  }
+  state.generation = executor.held_nodes_generation();
+  return absl::OkStatus();
+}
+
 Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
                         EagerOperation* op, TensorHandle** retvals) {
   EagerExecutor& executor = op->Executor();
@@ -1649,14 +1978,30 @@ Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
     }
     const absl::InlinedVector<TensorHandle*, 4>* inputs;
     TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
+    const bool stateless = !op->is_function() && op->OpDef() != nullptr &&
+                           !op->OpDef()->is_stateful();
+    StepTracer::Action step_action = StepTracer::Action::kRun;
+    TracedOp traced_op;
+    CancellationManager* cancellation_manager = op->GetCancellationManager();
+    if (ctx.StepTracingEnabled()) {
+      step_action = TraceStepOp(op, *kernel, *inputs, eager_func_params,
+                                graph_collector,
+                                absl::MakeConstSpan(retvals, num_outputs),
+                                &traced_op);
+    }
     auto node = std::make_unique<AsyncExecuteNode>(
         &ctx, *inputs, eager_func_params, std::move(kernel), graph_collector,
         op->GetCancellationManager(),
-        absl::Span<TensorHandle*>(retvals, num_outputs), op->GetStackTrace());
+        absl::Span<TensorHandle*>(retvals, num_outputs), op->GetStackTrace(),
+        stateless);
     // Release the inputs from the eager operation since the AsyncExecuteNode
     // would have taken ownership. This allows the inputs to be forwarded if
     // possible.
     op->Clear();
+    if (step_action != StepTracer::Action::kRun) {
+      return HoldStepNode(ctx, executor, std::move(node), step_action,
+                          std::move(traced_op), cancellation_manager);
+    }
     // For async mode, execution order will make sure that all
     // input handles are ready before executing them.
     // TODO(b/137118203): Consider executing "cheap" kernels inline for
@@ -157,7 +157,8 @@ class AsyncExecuteNode : public EagerNode {
                    GraphCollector* graph_collector,
                    CancellationManager* cancellation_manager,
                    absl::Span<TensorHandle*> retvals,
-                   std::optional<ManagedStackTrace> stack_trace)
+                   std::optional<ManagedStackTrace> stack_trace,
+                   bool stateless = false)
       : EagerNode(),
         ctx_(ctx),
         inputs_(inputs),
@@ -165,7 +166,8 @@ class AsyncExecuteNode : public EagerNode {
         kernel_(std::move(kernel)),
         graph_collector_(graph_collector),
         cancellation_manager_(cancellation_manager),
-        stack_trace_(stack_trace) {
+        stack_trace_(stack_trace),
+        stateless_(stateless) {
     // Copy the output handles, since the container for them might get
     // destroyed.
     for (auto handle : retvals) {
@@ -227,6 +229,20 @@ class AsyncExecuteNode : public EagerNode {
     }
   }
 
+  // Stateless ops only depend on their inputs, so they may run out of order
+  // once the inputs are computed. Resource inputs are excluded since the ops
+  // reading them must stay ordered with the ops updating them.
+  bool CanRunConcurrently() const override {
+    if (!stateless_ || graph_collector_ != nullptr) return false;
+    for (const TensorHandle* h : inputs_) {
+      if (h->Type() != TensorHandle::LOCAL || h->dtype == DT_RESOURCE ||
+          !h->IsReady()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   std::string DebugString() const override {
     std::string out = "[AsyncExecuteNode]";
     strings::StrAppend(&out, " kernel: ", kernel_->name());
@@ -241,6 +257,7 @@ class AsyncExecuteNode : public EagerNode {
   GraphCollector* graph_collector_;
   CancellationManager* const cancellation_manager_;
   std::optional<ManagedStackTrace> stack_trace_;
+  const bool stateless_;
   absl::InlinedVector<TensorHandle*, 2> retvals_;
 };
 
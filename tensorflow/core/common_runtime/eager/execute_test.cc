@@ -14,10 +14,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/execute.h"
 
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -428,5 +434,121 @@ TEST(ExecuteTest, MultipleNestedCompiledFunction) {
   ctx->Unref();
 }
 
+// Runs eager ops in async mode with step tracing, which replays repeated
+// sequences of ops as step functions.
+class StepTracingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    setenv("TF_EAGER_STEP_TRACING", "1", /*overwrite=*/1);
+    device_mgr_ = std::make_unique<StaticDeviceMgr>(
+        DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+    ctx_ = new EagerContext(
+        SessionOptions(),
+        tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+        /*async=*/true, device_mgr_.get(), /*device_mgr_owned=*/false,
+        /*rendezvous=*/nullptr);
+    unsetenv("TF_EAGER_STEP_TRACING");
+    ASSERT_TRUE(ctx_->StepTracingEnabled());
+  }
+
+  void TearDown() override {
+    TF_ASSERT_OK(ctx_->Executor().WaitForAllPendingNodes());
+    one_.reset();
+    two_.reset();
+    ctx_->Unref();
+  }
+
+  core::RefCountPtr<TensorHandle> Scalar(int64_t value) {
+    return core::RefCountPtr<TensorHandle>(TensorHandleFromInterface(
+        ctx_->CreateLocalHandleFromTFTensor(test::AsScalar<int64_t>(value),
+                                            ctx_->HostCPUName().c_str())));
+  }
+
+  core::RefCountPtr<TensorHandle> Run(
+      const char* op_name, TensorHandle* x, TensorHandle* y,
+      CancellationManager* cancellation_manager = nullptr) {
+    EagerOperation op(ctx_);
+    TF_CHECK_OK(
+        op.Reset(op_name, "/job:localhost/replica:0/task:0/device:CPU:0"));
+    TF_CHECK_OK(op.AddInput(x));
+    TF_CHECK_OK(op.AddInput(y));
+    op.SetCancellationManager(cancellation_manager);
+    TensorHandle* retval = nullptr;
+    int num_retvals = 1;
+    TF_CHECK_OK(EagerExecute(&op, &retval, &num_retvals));
+    return core::RefCountPtr<TensorHandle>(retval);
+  }
+
+  // Runs the steps x = x * 2 + 1, from x = 1, and returns x.
+  core::RefCountPtr<TensorHandle> RunSteps(
+      int num_steps, CancellationManager* cancellation_manager = nullptr) {
+    core::RefCountPtr<TensorHandle> x = Scalar(1);
+    for (int i = 0; i < num_steps; ++i) {
+      x = Run("Mul", x.get(), two_.get(), cancellation_manager);
+      x = Run("AddV2", x.get(), one_.get(), cancellation_manager);
+    }
+    return x;
+  }
+
+  int64_t Value(TensorHandle* handle) {
+    const Tensor* tensor = nullptr;
+    TF_CHECK_OK(handle->Tensor(&tensor));
+    return tensor->scalar<int64_t>()();
+  }
+
+  bool HasStepFunction() {
+    for (const string& name : ctx_->FuncLibDef()->ListFunctionNames()) {
+      if (absl::StartsWith(name, "__eager_step_")) return true;
+    }
+    return false;
+  }
+
+  std::unique_ptr<StaticDeviceMgr> device_mgr_;
+  EagerContext* ctx_ = nullptr;
+  core::RefCountPtr<TensorHandle> one_ = nullptr;
+  core::RefCountPtr<TensorHandle> two_ = nullptr;
+};
+
+TEST_F(StepTracingTest, ReplaysRepeatedSteps) {
+  one_ = Scalar(1);
+  two_ = Scalar(2);
+  core::RefCountPtr<TensorHandle> x = RunSteps(/*num_steps=*/6);
+  EXPECT_EQ(Value(x.get()), 127);
+  EXPECT_TRUE(HasStepFunction());
+}
+
+// A thread waiting on the output of a node held by another thread schedules
+// the held nodes instead of blocking until that thread runs another op.
+TEST_F(StepTracingTest, WaitingOnAnotherThreadSchedulesHeldNodes) {
+  one_ = Scalar(1);
+  two_ = Scalar(2);
+  core::RefCountPtr<TensorHandle> x = RunSteps(/*num_steps=*/4);
+  // Held as the first op of a recorded step.
+  core::RefCountPtr<TensorHandle> y = Run("Mul", x.get(), two_.get());
+  int64_t value = 0;
+  std::thread waiter([&] { value = Value(y.get()); });
+  waiter.join();
+  EXPECT_EQ(value, 62);
+  core::RefCountPtr<TensorHandle> z = Run("AddV2", y.get(), one_.get());
+  EXPECT_EQ(Value(z.get()), 63);
+}
+
+// Cancelling the cancellation manager of the ops of a step schedules its
+// held nodes, so that their outputs become ready without any wait.
+TEST_F(StepTracingTest, CancellationSchedulesHeldNodes) {
+  one_ = Scalar(1);
+  two_ = Scalar(2);
+  CancellationManager cancellation_manager;
+  core::RefCountPtr<TensorHandle> x =
+      RunSteps(/*num_steps=*/4, &cancellation_manager);
+  core::RefCountPtr<TensorHandle> y =
+      Run("Mul", x.get(), two_.get(), &cancellation_manager);
+  cancellation_manager.StartCancel();
+  for (int i = 0; i < 1000 && !y->IsReady(); ++i) {
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+  }
+  EXPECT_TRUE(y->IsReady());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/small_constants_optimizer.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <iterator>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,13 +26,17 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow::small_constants_optimizer {
 namespace {
@@ -46,6 +52,17 @@ constexpr char kStatefulPartitionedCallOp[] = "StatefulPartitionedCall";
 // restriction later.
 constexpr int32_t kMaxBoolArguments = 1;
 
+// Attribute marking the variants generated by SpecializeInputs, which are not
+// specialized any further.
+constexpr char kSpecializedInputs[] = "_rt_specialized_inputs";
+
+// Limit the specialization to inputs with at most this many elements, which
+// covers scalar sizes and the shapes of tensors of rank up to 8.
+constexpr int64_t kMaxSpecializedInputElements = 8;
+
+// Limit the number of specialized variants of a function.
+constexpr int kMaxSpecializedVariants = 8;
+
 // Returns a list of input arguments that have dtype tf.bool in a FunctionDef.
 // NOTE: This function requires that the FunctionDef outlive the returned
 // result.
@@ -281,4 +298,97 @@ std::vector<FunctionDef> FoldInputTensors(
   return result;
 }
 
+bool IsSpecializableInput(const OpDef::ArgDef& input_arg, const Tensor& value) {
+  if (!input_arg.number_attr().empty() || !input_arg.type_list_attr().empty()) {
+    return false;
+  }
+  if (input_arg.type() != DT_INT32 && input_arg.type() != DT_INT64) {
+    return false;
+  }
+  return value.dtype() == input_arg.type() &&
+         value.NumElements() <= kMaxSpecializedInputElements;
+}
+
+bool IsSpecializedFunction(const FunctionDef& fdef) {
+  return fdef.attr().find(kSpecializedInputs) != fdef.attr().end();
+}
+
+uint64_t InputValuesFingerprint(
+    absl::Span<const InputValues::value_type> inputs) {
+  uint64_t fingerprint = 0;
+  for (const auto& [input_name, value] : inputs) {
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(input_name));
+    fingerprint = FingerprintCat64(fingerprint, value.dtype());
+    for (const int64_t dim : value.shape().dim_sizes()) {
+      fingerprint = FingerprintCat64(fingerprint, dim);
+    }
+    fingerprint =
+        FingerprintCat64(fingerprint, Fingerprint64(value.tensor_data()));
+  }
+  return fingerprint;
+}
+
+std::string SpecializedFunctionName(absl::string_view fname,
+                                    uint64_t fingerprint) {
+  return absl::StrCat(fname, "_specialized_", absl::Hex(fingerprint));
+}
+
+FunctionDef SpecializeInputs(const FunctionDef& fdef,
+                             absl::string_view specialized_name,
+                             absl::Span<const InputValues::value_type> inputs) {
+  FunctionDef result = fdef;
+  result.mutable_signature()->set_name(std::string(specialized_name));
+  AttrValue specialized_value;
+  specialized_value.set_b(true);
+  result.mutable_attr()->insert({kSpecializedInputs, specialized_value});
+
+  for (const auto& [input_name, value] : inputs) {
+    const std::string const_name = absl::StrCat(input_name, "_rt_specialized");
+    const std::string const_output = absl::StrCat(const_name, ":output:0");
+    // Point all references of the input to the constant tensor.
+    for (auto& node_def : *result.mutable_node_def()) {
+      for (auto& input : *node_def.mutable_input()) {
+        if (input == input_name) input = const_output;
+      }
+    }
+
+    auto* const_tensor = result.add_node_def();
+    const_tensor->set_name(const_name);
+    const_tensor->set_op("Const");
+    AttrValue dtype_value;
+    dtype_value.set_type(value.dtype());
+    const_tensor->mutable_attr()->insert({"dtype", dtype_value});
+    AttrValue tensor_value;
+    value.AsProtoTensorContent(tensor_value.mutable_tensor());
+    const_tensor->mutable_attr()->insert({"value", tensor_value});
+  }
+  return result;
+}
+
+std::optional<std::string> SpecializationCache::GetOrAddVariant(
+    absl::string_view fname, uint64_t fingerprint, bool* is_new) {
+  mutex_lock l(mu_);
+  auto& variants = variants_[std::string(fname)];
+  *is_new = false;
+  if (!variants.contains(fingerprint)) {
+    if (variants.size() >= kMaxSpecializedVariants) return std::nullopt;
+    variants.insert(fingerprint);
+    *is_new = true;
+  }
+  return SpecializedFunctionName(fname, fingerprint);
+}
+
+std::vector<std::string> SpecializationCache::RemoveVariants(
+    absl::string_view fname) {
+  std::vector<std::string> result;
+  mutex_lock l(mu_);
+  auto it = variants_.find(fname);
+  if (it == variants_.end()) return result;
+  for (const uint64_t fingerprint : it->second) {
+    result.push_back(SpecializedFunctionName(fname, fingerprint));
+  }
+  variants_.erase(it);
+  return result;
+}
+
 }  // namespace tensorflow::small_constants_optimizer
@@ -16,12 +16,22 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SMALL_CONSTANTS_OPTIMIZER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SMALL_CONSTANTS_OPTIMIZER_H_
 
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow::small_constants_optimizer {
 
@@ -37,6 +47,57 @@ std::vector<FunctionDef> FoldInputTensors(
 std::string FoldedFunctionName(absl::string_view fname,
                                absl::string_view input_name, bool input_value);
 
+// Input values of a tf.function call, keyed by the input argument name.
+using InputValues = std::vector<std::pair<std::string, Tensor>>;
+
+// Checks whether the host tensor `value` passed for the input `input_arg` is
+// small enough for the function to be specialized on it, e.g. a flag or a
+// shape-like int32/int64 tensor.
+bool IsSpecializableInput(const OpDef::ArgDef& input_arg, const Tensor& value);
+
+// Checks whether `fdef` was generated by SpecializeInputs.
+bool IsSpecializedFunction(const FunctionDef& fdef);
+
+// Returns a fingerprint of the input names and values in `inputs`.
+uint64_t InputValuesFingerprint(
+    absl::Span<const InputValues::value_type> inputs);
+
+// Generates the FunctionDef name for the variant of `fname` specialized on the
+// input values with fingerprint `fingerprint`.
+std::string SpecializedFunctionName(absl::string_view fname,
+                                    uint64_t fingerprint);
+
+// Generates a variant of `fdef` named `specialized_name` where the inputs in
+// `inputs` are replaced by constants holding their values, so that kernels
+// consuming them (e.g. the shape inputs of Reshape, Tile or StridedSlice) can
+// be constant folded when the variant is instantiated. The inputs are kept in
+// the signature so the variant is called with the same arguments.
+FunctionDef SpecializeInputs(const FunctionDef& fdef,
+                             absl::string_view specialized_name,
+                             absl::Span<const InputValues::value_type> inputs);
+
+// Tracks the specialized variants generated for each function and bounds
+// their number, so that a function called with ever-changing input values
+// falls back to its generic version instead of growing the function library.
+class SpecializationCache {
+ public:
+  // Returns the name of the variant of `fname` for the input values with
+  // fingerprint `fingerprint`, or std::nullopt if `fname` already has the
+  // maximum number of variants. Sets `*is_new` if the caller is the first to
+  // request the variant and must add it to the function library.
+  std::optional<std::string> GetOrAddVariant(absl::string_view fname,
+                                             uint64_t fingerprint,
+                                             bool* is_new);
+
+  // Forgets the variants of `fname` and returns their names.
+  std::vector<std::string> RemoveVariants(absl::string_view fname);
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<std::string, absl::flat_hash_set<uint64_t>> variants_
+      TF_GUARDED_BY(mu_);
+};
+
 }  // namespace tensorflow::small_constants_optimizer
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SMALL_CONSTANTS_OPTIMIZER_H_
@@ -0,0 +1,257 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/step_tracer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Bounds on the number of ops in a step. Longer sequences of ops are not
+// detected, which also bounds the cost of detecting steps.
+constexpr int64_t kMinStepLength = 2;
+constexpr int64_t kMaxStepLength = 512;
+
+// Bound on the number of steps recorded by a tracer.
+constexpr int kMaxSteps = 16;
+
+// Where the value of an input of a traced op comes from: output `index` of
+// the traced op `op`, or argument `index` of the step function if `op` is -1.
+struct InputSource {
+  int op;
+  int index;
+};
+
+// Returns the sources of the inputs of `ops`, flattened, and appends the
+// arguments of the step function to `args`.
+std::vector<InputSource> InputSources(absl::Span<const TracedOp> ops,
+                                      std::vector<const void*>* args) {
+  absl::flat_hash_map<const void*, InputSource> sources;
+  std::vector<InputSource> result;
+  for (int i = 0; i < ops.size(); ++i) {
+    for (const void* input : ops[i].inputs) {
+      auto it = sources.find(input);
+      if (it == sources.end()) {
+        const InputSource arg = {-1, static_cast<int>(args->size())};
+        args->push_back(input);
+        it = sources.emplace(input, arg).first;
+      }
+      result.push_back(it->second);
+    }
+    for (int j = 0; j < ops[i].outputs.size(); ++j) {
+      sources[ops[i].outputs[j]] = {i, j};
+    }
+  }
+  return result;
+}
+
+uint64_t SignaturesFingerprint(absl::Span<const uint64_t> signatures) {
+  return Fingerprint64(
+      absl::string_view(reinterpret_cast<const char*>(signatures.data()),
+                        signatures.size() * sizeof(uint64_t)));
+}
+
+// Returns a fingerprint of the signatures of `step` that does not depend on
+// which of its ops comes first, since the same loop may be recorded starting
+// from any of its ops.
+uint64_t RejectionFingerprint(std::vector<uint64_t> step) {
+  std::sort(step.begin(), step.end());
+  return SignaturesFingerprint(step);
+}
+
+std::string StepNodeName(int op) { return absl::StrCat("op", op); }
+
+}  // namespace
+
+StepTracer::Action StepTracer::AddOp(uint64_t signature) {
+  if (num_held_ops_ > 0) {
+    const auto it = steps_.find(step_key_);
+    if (signature != 0 && it != steps_.end() &&
+        it->second[num_held_ops_] == signature) {
+      ++num_held_ops_;
+      return num_held_ops_ == it->second.size() ? Action::kReplay
+                                                : Action::kHold;
+    }
+    // The op diverges from the step: the held ops are run as usual.
+    EndStep();
+  }
+  if (signature != 0) {
+    const auto it = steps_.find(signature);
+    if (it != steps_.end()) {
+      step_key_ = signature;
+      step_fingerprint_ = SignaturesFingerprint(it->second);
+      num_held_ops_ = 1;
+      return Action::kHold;
+    }
+  }
+  Record(signature);
+  return Action::kRun;
+}
+
+void StepTracer::EndStep() {
+  step_key_ = 0;
+  step_fingerprint_ = 0;
+  num_held_ops_ = 0;
+}
+
+void StepTracer::RejectStep() {
+  const auto it = steps_.find(step_key_);
+  if (num_held_ops_ > 0 && it != steps_.end()) {
+    rejected_steps_.insert(RejectionFingerprint(it->second));
+    steps_.erase(it);
+  }
+  EndStep();
+}
+
+void StepTracer::Record(uint64_t signature) {
+  const int64_t position = history_start_ + history_.size();
+  history_.push_back(signature);
+  if (history_.size() > 2 * kMaxStepLength) {
+    history_.pop_front();
+    ++history_start_;
+  }
+  if (signature == 0) return;
+  if (last_positions_.size() > 4 * kMaxStepLength) last_positions_.clear();
+  auto [it, inserted] = last_positions_.try_emplace(signature, position);
+  if (inserted) return;
+  const int64_t previous = it->second;
+  it->second = position;
+
+  // The ops since the previous op with the same signature are a step if they
+  // repeat the ops before it.
+  const int64_t length = position - previous;
+  if (length < kMinStepLength || length > kMaxStepLength) return;
+  if (previous - length < history_start_) return;
+  const auto first = history_.begin() + (previous - history_start_);
+  const auto last = history_.begin() + (position - history_start_);
+  if (std::find(first, last, 0) != last) return;
+  if (!std::equal(first, last, first - length)) return;
+  if (steps_.size() >= kMaxSteps) return;
+
+  std::vector<uint64_t> step(first, last);
+  if (rejected_steps_.contains(RejectionFingerprint(step))) return;
+  VLOG(1) << "Recorded an eager step of " << step.size() << " ops.";
+  steps_[signature] = std::move(step);
+  history_.clear();
+  history_start_ = position + 1;
+  last_positions_.clear();
+}
+
+uint64_t StepTopology(absl::Span<const TracedOp> ops,
+                      std::vector<const void*>* args) {
+  uint64_t fingerprint = 0;
+  for (const InputSource& source : InputSources(ops, args)) {
+    fingerprint = FingerprintCat64(fingerprint, source.op);
+    fingerprint = FingerprintCat64(fingerprint, source.index);
+  }
+  return fingerprint;
+}
+
+absl::StatusOr<FunctionDef> BuildStepFunction(absl::string_view name,
+                                              absl::Span<const TracedOp> ops) {
+  std::vector<const void*> args;
+  const std::vector<InputSource> sources = InputSources(ops, &args);
+
+  FunctionDef fdef;
+  OpDef* signature = fdef.mutable_signature();
+  signature->set_name(std::string(name));
+  for (int i = 0; i < args.size(); ++i) {
+    signature->add_input_arg()->set_name(absl::StrCat("arg", i));
+  }
+
+  // The inputs of the function nodes for the outputs of each op.
+  std::vector<std::vector<std::string>> output_names(ops.size());
+  int next_source = 0;
+  int last_stateful_op = -1;
+  for (int i = 0; i < ops.size(); ++i) {
+    const TracedOp& op = ops[i];
+    if (op.ndef.op().empty()) {
+      return errors::FailedPrecondition("The NodeDef of op ", i,
+                                        " of the step was not captured.");
+    }
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(
+        OpRegistry::Global()->LookUpOpDef(op.ndef.op(), &op_def));
+    NodeDef* node = fdef.add_node_def();
+    *node = op.ndef;
+    node->set_name(StepNodeName(i));
+    node->clear_input();
+    for (int j = 0; j < op.inputs.size(); ++j) {
+      const InputSource& source = sources[next_source++];
+      if (source.op < 0) {
+        OpDef::ArgDef* arg = signature->mutable_input_arg(source.index);
+        arg->set_type(op.input_dtypes[j]);
+        node->add_input(arg->name());
+      } else {
+        node->add_input(output_names[source.op][source.index]);
+      }
+    }
+    if (op.is_stateful) {
+      if (last_stateful_op >= 0) {
+        node->add_input(absl::StrCat("^", StepNodeName(last_stateful_op)));
+      }
+      last_stateful_op = i;
+      signature->add_control_output(node->name());
+      (*fdef.mutable_control_ret())[node->name()] = node->name();
+      signature->set_is_stateful(true);
+    }
+
+    NameRangeMap output_ranges;
+    TF_RETURN_IF_ERROR(
+        NameRangesForNode(*node, *op_def, nullptr, &output_ranges));
+    output_names[i].resize(op.outputs.size());
+    for (const auto& [output_name, range] : output_ranges) {
+      for (int j = range.first; j < range.second && j < op.outputs.size();
+           ++j) {
+        output_names[i][j] = absl::StrCat(node->name(), ":", output_name, ":",
+                                          j - range.first);
+      }
+    }
+    for (int j = 0; j < op.outputs.size(); ++j) {
+      if (output_names[i][j].empty()) {
+        return errors::Internal("Output ", j, " of ", op.ndef.op(),
+                                " does not match its OpDef.");
+      }
+      const std::string ret_name = absl::StrCat(node->name(), "_output", j);
+      OpDef::ArgDef* output_arg = signature->add_output_arg();
+      output_arg->set_name(ret_name);
+      output_arg->set_type(op.output_dtypes[j]);
+      (*fdef.mutable_ret())[ret_name] = output_names[i][j];
+    }
+  }
+  return fdef;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_STEP_TRACER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_STEP_TRACER_H_
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+
+// Detects steps, i.e. sequences of eager ops that are run over and over with
+// the same signatures, e.g. by a Python training loop that can not be wrapped
+// in a tf.function, so that they can be replayed as a single function call.
+//
+// The signature of an op is a fingerprint of its type, attributes, device and
+// input dtypes and shapes, computed by the caller. Once the same sequence of
+// signatures has been run twice in a row, it is recorded as a step. When the
+// ops of a recorded step are run again, the caller holds them back until the
+// step is complete, and replays them as the function built by
+// BuildStepFunction(). If an op diverges from the step, the held ops are run
+// as usual instead.
+//
+// Not thread-safe: each thread running eager ops has its own tracer.
+class StepTracer {
+ public:
+  enum class Action {
+    // Run the op as usual, after any held ops.
+    kRun,
+    // Hold the op back as part of the current step.
+    kHold,
+    // Hold the op back, which completes the current step: replay the held
+    // ops.
+    kReplay,
+  };
+
+  // Returns what to do with the next op, with signature `signature`. A
+  // signature of 0 marks an op that can not be part of a step.
+  Action AddOp(uint64_t signature);
+
+  // Ends the current step, whose held ops were replayed or run as usual.
+  void EndStep();
+
+  // Ends the current step and forgets it, e.g. because it can not be replayed
+  // as a function, so that it is not recorded again.
+  void RejectStep();
+
+  // Returns a fingerprint of the signatures of the ops of the current step.
+  uint64_t step_fingerprint() const { return step_fingerprint_; }
+
+  // Returns the number of ops of the current step held so far, including the
+  // op just added.
+  size_t num_held_ops() const { return num_held_ops_; }
+
+ private:
+  // Adds `signature` to the history of ops run as usual, and records a step
+  // if it completes the second repetition of a sequence of ops.
+  void Record(uint64_t signature);
+
+  // Recent signatures of ops run as usual. `history_[i]` is the signature of
+  // the op at position `history_start_ + i`.
+  std::deque<uint64_t> history_;
+  int64_t history_start_ = 0;
+  // Position of the last op with each signature in `history_`.
+  absl::flat_hash_map<uint64_t, int64_t> last_positions_;
+
+  // Signatures of the ops of the recorded steps, keyed by the signature of
+  // their first op.
+  absl::flat_hash_map<uint64_t, std::vector<uint64_t>> steps_;
+  // Fingerprints of the steps that can not be replayed, independent of the
+  // op they start with.
+  absl::flat_hash_set<uint64_t> rejected_steps_;
+
+  // The step whose ops are being held, keyed by its first signature, and the
+  // number of its ops held so far. `num_held_ops_` is 0 if there is none.
+  uint64_t step_key_ = 0;
+  uint64_t step_fingerprint_ = 0;
+  size_t num_held_ops_ = 0;
+};
+
+// An op held back as part of a step.
+struct TracedOp {
+  // The type, attributes and device of the op. Only needed to build a step
+  // function, and its op type is empty if it was not captured.
+  NodeDef ndef;
+  bool is_stateful = false;
+  // Identities of the TensorHandles passed to and returned by the op.
+  std::vector<const void*> inputs;
+  std::vector<const void*> outputs;
+  DataTypeVector input_dtypes;
+  DataTypeVector output_dtypes;
+};
+
+// Returns a fingerprint of the way the inputs of `ops` are connected to the
+// outputs of earlier ops. Appends the inputs that are not outputs of earlier
+// ops, in order of first use, to `args`: they are the arguments of the step
+// function.
+uint64_t StepTopology(absl::Span<const TracedOp> ops,
+                      std::vector<const void*>* args);
+
+// Builds a function named `name` that runs `ops`, taking the arguments
+// returned by StepTopology() and returning the outputs of all of `ops` in
+// order. Stateful ops are run in the order of `ops`.
+absl::StatusOr<FunctionDef> BuildStepFunction(absl::string_view name,
+                                              absl::Span<const TracedOp> ops);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_STEP_TRACER_H_
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/step_tracer.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Action = StepTracer::Action;
+
+TEST(StepTracer, RecordsRepeatedSequence) {
+  StepTracer tracer;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(tracer.AddOp(1), Action::kRun);
+    EXPECT_EQ(tracer.AddOp(2), Action::kRun);
+    EXPECT_EQ(tracer.AddOp(3), Action::kRun);
+  }
+  EXPECT_EQ(tracer.AddOp(1), Action::kHold);
+  EXPECT_EQ(tracer.AddOp(2), Action::kHold);
+  EXPECT_EQ(tracer.num_held_ops(), 2u);
+  EXPECT_EQ(tracer.AddOp(3), Action::kReplay);
+  const uint64_t fingerprint = tracer.step_fingerprint();
+  EXPECT_NE(fingerprint, 0u);
+  tracer.EndStep();
+
+  EXPECT_EQ(tracer.AddOp(1), Action::kHold);
+  EXPECT_EQ(tracer.AddOp(2), Action::kHold);
+  EXPECT_EQ(tracer.AddOp(3), Action::kReplay);
+  EXPECT_EQ(tracer.step_fingerprint(), fingerprint);
+}
+
+TEST(StepTracer, RunsDivergingOps) {
+  StepTracer tracer;
+  for (int i = 0; i < 3; ++i) {
+    tracer.AddOp(1);
+    tracer.AddOp(2);
+  }
+  EXPECT_EQ(tracer.AddOp(1), Action::kHold);
+  EXPECT_EQ(tracer.AddOp(4), Action::kRun);
+  EXPECT_EQ(tracer.num_held_ops(), 0u);
+}
+
+TEST(StepTracer, IgnoresUntraceableOps) {
+  StepTracer tracer;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(tracer.AddOp(1), Action::kRun);
+    EXPECT_EQ(tracer.AddOp(0), Action::kRun);
+  }
+}
+
+TEST(StepTracer, ForgetsRejectedSteps) {
+  StepTracer tracer;
+  for (int i = 0; i < 3; ++i) {
+    tracer.AddOp(1);
+    tracer.AddOp(2);
+  }
+  EXPECT_EQ(tracer.AddOp(1), Action::kHold);
+  tracer.RejectStep();
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(tracer.AddOp(1), Action::kRun);
+    EXPECT_EQ(tracer.AddOp(2), Action::kRun);
+  }
+}
+
+TracedOp MakeOp(const char* op, const std::vector<const void*>& inputs,
+                const void* output) {
+  TracedOp traced;
+  traced.ndef.set_op(op);
+  (*traced.ndef.mutable_attr())["T"].set_type(DT_FLOAT);
+  traced.inputs = inputs;
+  traced.input_dtypes = DataTypeVector(inputs.size(), DT_FLOAT);
+  traced.outputs = {output};
+  traced.output_dtypes = {DT_FLOAT};
+  return traced;
+}
+
+TEST(StepTracer, BuildsStepFunction) {
+  int x, y, sum, product;
+  const std::vector<TracedOp> ops = {MakeOp("Add", {&x, &y}, &sum),
+                                     MakeOp("Mul", {&sum, &x}, &product)};
+
+  std::vector<const void*> args;
+  const uint64_t topology = StepTopology(ops, &args);
+  EXPECT_EQ(args, (std::vector<const void*>{&x, &y}));
+
+  absl::StatusOr<FunctionDef> fdef = BuildStepFunction("step", ops);
+  TF_ASSERT_OK(fdef.status());
+  EXPECT_EQ(fdef->signature().name(), "step");
+  ASSERT_EQ(fdef->signature().input_arg_size(), 2);
+  EXPECT_EQ(fdef->signature().input_arg(0).type(), DT_FLOAT);
+  ASSERT_EQ(fdef->signature().output_arg_size(), 2);
+  ASSERT_EQ(fdef->node_def_size(), 2);
+  EXPECT_EQ(fdef->node_def(1).input(0), "op0:z:0");
+  EXPECT_EQ(fdef->node_def(1).input(1), "arg0");
+  EXPECT_EQ(fdef->ret().at("op1_output0"), "op1:z:0");
+  EXPECT_FALSE(fdef->signature().is_stateful());
+
+  // The same ops with different inputs have a different topology.
+  const std::vector<TracedOp> other_ops = {
+      MakeOp("Add", {&x, &y}, &sum), MakeOp("Mul", {&x, &sum}, &product)};
+  args.clear();
+  EXPECT_NE(StepTopology(other_ops, &args), topology);
+}
+
+TEST(StepTracer, FailsWithoutNodeDef) {
+  int x, y;
+  TracedOp op = MakeOp("Add", {&x, &x}, &y);
+  op.ndef.clear_op();
+  EXPECT_FALSE(BuildStepFunction("step", {op}).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -255,6 +255,10 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   HandleType Type() const;
   string TypeString() const;
 
+  // Returns true if the handle is ready, i.e. accessing its tensor or remote
+  // shape does not block.
+  bool IsReady() const;
+
   void SetResourceHandleDtypeAndShape(
       std::vector<DtypeAndPartialTensorShape> dtypes_and_shapes);
 
@@ -291,7 +295,6 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // Further, it can be in a non-ready state. It would become ready with a call
   // to either SetTensor or SetRemoteShape which replaces the underlying data
   // with a ready version of the tensor handle data.
-  bool IsReady() const;
   Status WaitReady(const char* caller) const;
 
   tensorflow::Device* device_;
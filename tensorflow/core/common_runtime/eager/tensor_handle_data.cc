@@ -111,6 +111,8 @@ void LocalTensorHandleData::BlockingControl::SetReady() {
 
 Status LocalTensorHandleData::BlockingControl::WaitReady(
     const char* caller) const {
+  // The node producing this handle may be held back, by any thread.
+  if (!IsReady()) EagerExecutor::AddAllHeldNodes();
   tf_shared_lock l(mu_);
   if (!is_ready_) {
     tsl::profiler::TraceMe activity(
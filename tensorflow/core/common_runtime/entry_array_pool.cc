@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/entry_array_pool.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+
+namespace tensorflow {
+
+namespace {
+int64_t ArrayBytes(int size) {
+  return static_cast<int64_t>(size) * sizeof(Entry);
+}
+}  // namespace
+
+EntryArrayPool::~EntryArrayPool() {
+  mutex_lock l(mu_);
+  for (auto& size_and_arrays : free_lists_) {
+    for (Entry* entries : size_and_arrays.second) {
+      delete[] entries;
+    }
+  }
+}
+
+Entry* EntryArrayPool::Allocate(int size, Stats* stats) {
+  if (size == 0) return nullptr;
+  const int64_t bytes = ArrayBytes(size);
+  {
+    mutex_lock l(mu_);
+    auto it = free_lists_.find(size);
+    if (it != free_lists_.end() && !it->second.empty()) {
+      Entry* entries = it->second.back();
+      it->second.pop_back();
+      cached_bytes_ -= bytes;
+      if (stats != nullptr) {
+        stats->bytes_reused.fetch_add(bytes, std::memory_order_relaxed);
+      }
+      return entries;
+    }
+  }
+  if (stats != nullptr) {
+    stats->bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  return new Entry[size];
+}
+
+void EntryArrayPool::Deallocate(Entry* entries, int size) {
+  if (entries == nullptr) return;
+  // Reset the entries to the state of a newly-constructed array outside the
+  // lock; this releases any tensors still held, e.g. on dead paths.
+  for (int i = 0; i < size; ++i) {
+    entries[i].ClearVal();
+    entries[i].alloc_attr = AllocatorAttributes();
+  }
+  const int64_t bytes = ArrayBytes(size);
+  {
+    mutex_lock l(mu_);
+    if (cached_bytes_ + bytes <= kMaxCachedBytes) {
+      std::vector<Entry*>& free_list = free_lists_[size];
+      if (free_list.size() < kMaxCachedArraysPerSize) {
+        free_list.push_back(entries);
+        cached_bytes_ += bytes;
+        return;
+      }
+    }
+  }
+  delete[] entries;
+}
+
+int64_t EntryArrayPool::cached_bytes() const {
+  mutex_lock l(mu_);
+  return cached_bytes_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_ENTRY_ARRAY_POOL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_ENTRY_ARRAY_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A pool of `Entry` arrays, used by the propagators to hold the input tensors
+// of an iteration (or of the whole graph, for `SimplePropagatorState`).
+//
+// Arrays are cached by size, so that repeated runs of the same graph, and
+// successive iterations of a loop, reuse the arrays freed by earlier ones
+// instead of going through the global allocator. The pool is owned by the
+// `ImmutableExecutorState` and shared by all concurrent steps of an executor.
+//
+// This class is thread-safe.
+class EntryArrayPool {
+ public:
+  // Per-step accounting of the bytes handed out by `Allocate()`.
+  struct Stats {
+    std::atomic<int64_t> bytes_reused{0};
+    std::atomic<int64_t> bytes_allocated{0};
+  };
+
+  EntryArrayPool() = default;
+  ~EntryArrayPool();
+
+  // Returns an array of `size` entries, all in the `NO_VALUE` state. Adds the
+  // size of the array in bytes to either `stats->bytes_reused` or
+  // `stats->bytes_allocated`. `stats` may be null.
+  //
+  // Returns nullptr if `size` is 0.
+  Entry* Allocate(int size, Stats* stats);
+
+  // Returns `entries`, which must have been returned by `Allocate(size)`, to
+  // the pool. Clears any values still held by the entries. `entries` may be
+  // null.
+  void Deallocate(Entry* entries, int size);
+
+  // Returns the number of bytes held by arrays that are currently cached.
+  int64_t cached_bytes() const;
+
+ private:
+  // Bounds on the entries retained by the pool. Arrays freed beyond these
+  // limits are returned to the global allocator.
+  static constexpr int kMaxCachedArraysPerSize = 32;
+  static constexpr int64_t kMaxCachedBytes = 64 << 20;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<int, std::vector<Entry*>> free_lists_ TF_GUARDED_BY(mu_);
+  int64_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  EntryArrayPool(const EntryArrayPool&) = delete;
+  void operator=(const EntryArrayPool&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_ENTRY_ARRAY_POOL_H_
@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/entry_array_pool.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(EntryArrayPoolTest, ZeroSize) {
+  EntryArrayPool pool;
+  EntryArrayPool::Stats stats;
+  EXPECT_EQ(pool.Allocate(0, &stats), nullptr);
+  pool.Deallocate(nullptr, 0);
+  EXPECT_EQ(stats.bytes_reused, 0);
+  EXPECT_EQ(stats.bytes_allocated, 0);
+}
+
+TEST(EntryArrayPoolTest, ReusesArraysOfTheSameSize) {
+  EntryArrayPool pool;
+  EntryArrayPool::Stats stats;
+  Entry* first = pool.Allocate(8, &stats);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(stats.bytes_allocated, 8 * sizeof(Entry));
+  EXPECT_EQ(stats.bytes_reused, 0);
+
+  pool.Deallocate(first, 8);
+  EXPECT_EQ(pool.cached_bytes(), 8 * sizeof(Entry));
+
+  // An array of a different size is not reused.
+  Entry* other = pool.Allocate(4, &stats);
+  EXPECT_EQ(stats.bytes_allocated, 12 * sizeof(Entry));
+
+  Entry* second = pool.Allocate(8, &stats);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(stats.bytes_reused, 8 * sizeof(Entry));
+  EXPECT_EQ(pool.cached_bytes(), 0);
+
+  pool.Deallocate(second, 8);
+  pool.Deallocate(other, 4);
+  EXPECT_EQ(pool.cached_bytes(), 12 * sizeof(Entry));
+}
+
+TEST(EntryArrayPoolTest, ReusedEntriesAreCleared) {
+  EntryArrayPool pool;
+  Entry* entries = pool.Allocate(2, nullptr);
+  Tensor t(DT_FLOAT, TensorShape({16}));
+  entries[0].state = Entry::State::HAS_VALUE;
+  entries[0].val.Init(t);
+  AllocatorAttributes on_host;
+  on_host.set_on_host(true);
+  entries[0].alloc_attr = on_host;
+  EXPECT_FALSE(t.RefCountIsOne());
+
+  pool.Deallocate(entries, 2);
+  // The pool must not keep the tensor alive.
+  EXPECT_TRUE(t.RefCountIsOne());
+
+  Entry* reused = pool.Allocate(2, nullptr);
+  ASSERT_EQ(reused, entries);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(reused[i].state, Entry::State::NO_VALUE);
+    EXPECT_FALSE(reused[i].alloc_attr.on_host());
+  }
+  pool.Deallocate(reused, 2);
+}
+
+TEST(EntryArrayPoolTest, BoundsArraysPerSize) {
+  EntryArrayPool pool;
+  std::vector<Entry*> arrays;
+  for (int i = 0; i < 100; ++i) {
+    arrays.push_back(pool.Allocate(1, nullptr));
+  }
+  for (Entry* entries : arrays) {
+    pool.Deallocate(entries, 1);
+  }
+  EXPECT_LT(pool.cached_bytes(), 100 * sizeof(Entry));
+}
+
+}  // namespace
+}  // namespace tensorflow
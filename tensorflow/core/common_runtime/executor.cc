@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -35,7 +36,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -94,9 +98,9 @@ static const Tensor* const kEmptyTensor = new Tensor;
 namespace nodestats {
 inline int64_t NowInNsec() { return EnvTime::NowNanos(); }
 
-void SetScheduled(NodeExecStatsInterface* stats, int64_t micros) {
+void SetScheduled(NodeExecStatsInterface* stats, int64_t nanos) {
   if (!stats) return;
-  stats->SetScheduled(micros * EnvTime::kMicrosToNanos);
+  stats->SetScheduled(nanos);
 }
 
 void SetAllStart(NodeExecStatsInterface* stats) {
@@ -167,6 +171,7 @@ class ExecutorImpl : public Executor {
     KernelStats() = default;
 
     void Initialize(const GraphView& gview) {
+      expensive_threshold_cycles_ = kOpIsExpensiveThresholdCycles;
       is_expensive_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
@@ -185,7 +190,7 @@ class ExecutorImpl : public Executor {
     bool IsExpensive(const NodeItem& node) const {
       return is_expensive_[node.node_id] &&
              (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
-              kOpIsExpensiveThresholdCycles);
+              expensive_threshold_cycles_.load(std::memory_order_relaxed));
     }
 
     // Returns the value of kernel->IsExpensive().
@@ -210,14 +215,45 @@ class ExecutorImpl : public Executor {
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
     }
 
+    // Adjusts the cost threshold above which a kernel is considered expensive.
+    // Used by the work-stealing scheduler: when ready nodes back up in the
+    // worker deques, dispatching more of them to other workers only adds
+    // queueing overhead, so the threshold is raised and more kernels run
+    // inline. When workers go idle, the threshold is lowered so that more
+    // kernels are handed off to them.
+    //
+    // N.B. As with `UpdateCostEstimate()`, concurrent updates may be lost.
+    void AdjustExpensiveThreshold(bool backlogged) {
+      const uint64 prev_threshold =
+          expensive_threshold_cycles_.load(std::memory_order_relaxed);
+      const uint64 new_threshold =
+          backlogged
+              ? std::min(prev_threshold * 2, kMaxExpensiveThresholdCycles)
+              : std::max(prev_threshold / 2, kMinExpensiveThresholdCycles);
+      expensive_threshold_cycles_.store(new_threshold,
+                                        std::memory_order_relaxed);
+    }
+
+    uint64 expensive_threshold_cycles() const {
+      return expensive_threshold_cycles_.load(std::memory_order_relaxed);
+    }
+
    private:
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
     // Operations start out "expensive".
     static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
     static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
+    // Bounds for `AdjustExpensiveThreshold()`.
+    static constexpr uint64 kMinExpensiveThresholdCycles =
+        kOpIsExpensiveThresholdCycles / 8;
+    static constexpr uint64 kMaxExpensiveThresholdCycles =
+        kOpIsExpensiveThresholdCycles * 64;
     static constexpr uint64 kCostDecay = 10;
 
+    std::atomic_uint_fast64_t expensive_threshold_cycles_{
+        kOpIsExpensiveThresholdCycles};
+
     std::vector<bool> is_expensive_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
@@ -346,6 +382,52 @@ class ExecutorState {
   template <typename Closure>
   void RunTask(Closure&& c, int sample_rate = 0);
 
+  // Work-stealing scheduling (ConfigProto.Experimental.use_work_stealing_
+  // executor). Instead of issuing one `runner_` closure per expensive node,
+  // ready nodes are pushed onto per-worker deques that are drained by at most
+  // `num_workers` long-running closures, which steal from each other when
+  // their own deque runs dry.
+  struct ReadyNode {
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+
+  // The scheduler state is reference counted separately from the
+  // `ExecutorState`, because a worker may observe the queue after the last
+  // node it processed has caused `this` to be deleted.
+  struct WorkStealingState {
+    explicit WorkStealingState(int num_workers) : queue(num_workers) {}
+
+    WorkStealingQueue<ReadyNode> queue;
+    // Number of worker closures currently draining `queue`.
+    std::atomic<int> num_active_workers{0};
+    // Worker slot handed to the next worker closure.
+    std::atomic<int> next_worker_id{0};
+    // Set when a worker exits because it found nothing to steal. Consumed by
+    // the next worker to pop a node, which lowers the expensive threshold.
+    std::atomic<bool> workers_idle{false};
+  };
+
+  // Returns the id of the work-stealing worker running on the current thread
+  // for this step, or -1 if the current thread is not such a worker.
+  int CurrentWorkStealingWorker() const;
+
+  // Pushes `nodes` onto the work-stealing deques and starts more workers if
+  // any are available.
+  template <typename Iterator>
+  void ScheduleWorkStealing(Iterator begin, Iterator end,
+                            int64_t scheduled_nsec);
+
+  // Starts worker closures until either all `num_workers` slots are taken or
+  // there are no more queued nodes than active workers.
+  void MaybeStartWorkStealingWorkers();
+
+  // The body of a work-stealing worker closure. Does not touch `this` after
+  // the deques have been observed empty.
+  static void WorkStealingLoop(ExecutorState* self,
+                               std::shared_ptr<WorkStealingState> ws_state,
+                               int worker_id);
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -370,6 +452,10 @@ class ExecutorState {
   // TODO(fishx): Make it configurable if necessary.
   static constexpr uint64 kInlineScheduleReadyThreshold = 500;
 
+  // In work-stealing mode, the deques are considered backlogged when they
+  // hold more than this many nodes per worker.
+  static constexpr int kWorkStealingBacklogPerWorker = 4;
+
   // Not owned.
   RendezvousInterface* rendezvous_;
   CollectiveExecutor* collective_executor_ = nullptr;
@@ -399,6 +485,18 @@ class ExecutorState {
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
 
+  // Non-null iff work-stealing scheduling is enabled for this step.
+  std::shared_ptr<WorkStealingState> work_stealing_state_;
+
+  // If true, the nodes made ready by an async kernel are scheduled from the
+  // thread that completes it like those of a sync kernel, so that inexpensive
+  // nodes run inline instead of being dispatched to the thread pool.
+  bool low_latency_ = false;
+
+  // Non-null iff static memory planning is enabled for this step. Released
+  // with `Finish()` when the step is destroyed.
+  StepArenaAllocator* step_allocator_ = nullptr;
+
   PropagatorStateType propagator_;
 
   // Invoked when the execution finishes.
@@ -455,6 +553,24 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  // Work stealing changes the order in which ready nodes are run, so it is
+  // not used when op order determinism is required.
+  if (session_config_ != nullptr &&
+      session_config_->experimental().use_work_stealing_executor() &&
+      !run_all_kernels_inline_ && !OpOrderDeterminismRequired()) {
+    int num_workers = session_config_->inter_op_parallelism_threads();
+    if (num_workers <= 0) num_workers = port::MaxParallelism();
+    work_stealing_state_ = std::make_shared<WorkStealingState>(num_workers);
+  }
+  low_latency_ = session_config_ != nullptr &&
+                 session_config_->experimental().use_low_latency_executor() &&
+                 !run_all_kernels_inline_;
+  if (session_config_ != nullptr &&
+      session_config_->experimental().use_static_memory_planning()) {
+    step_allocator_ = new StepArenaAllocator(
+        immutable_state_.params().device->GetAllocator(AllocatorAttributes()),
+        immutable_state_.memory_planner());
+  }
 }
 
 template <class PropagatorStateType>
@@ -463,6 +579,9 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_allocator_ != nullptr) {
+    step_allocator_->Finish();
+  }
 }
 
 template <class PropagatorStateType>
@@ -489,6 +608,121 @@ void ExecutorState<PropagatorStateType>::RunTask(Closure&& c, int sample_rate) {
   });
 }
 
+// Identifies the work-stealing worker running on the current thread, if any.
+// `owner` is the `WorkStealingState` the worker belongs to, so that threads
+// shared between concurrent steps are not confused with each other.
+struct WorkStealingWorkerContext {
+  const void* owner = nullptr;
+  int worker_id = -1;
+};
+thread_local WorkStealingWorkerContext work_stealing_worker_context;
+
+// Number of `ProcessInline()` loops running on the current thread. In
+// low-latency mode, the successors of an async kernel are only run inline on
+// the thread that completes it when this is zero, so that kernels whose
+// completion callbacks run synchronously (e.g. a local Recv satisfied by a
+// Send) do not recursively nest inline loops.
+thread_local int process_inline_depth = 0;
+
+template <class PropagatorStateType>
+int ExecutorState<PropagatorStateType>::CurrentWorkStealingWorker() const {
+  if (work_stealing_worker_context.owner != work_stealing_state_.get()) {
+    return -1;
+  }
+  return work_stealing_worker_context.worker_id;
+}
+
+template <class PropagatorStateType>
+template <typename Iterator>
+void ExecutorState<PropagatorStateType>::ScheduleWorkStealing(
+    Iterator begin, Iterator end, int64_t scheduled_nsec) {
+  WorkStealingState* ws_state = work_stealing_state_.get();
+  const int worker_id = CurrentWorkStealingWorker();
+  if (worker_id >= 0) {
+    // Keep the nodes on this worker's deque; idle workers will steal them.
+    for (Iterator it = begin; it != end; ++it) {
+      ws_state->queue.Push(worker_id, ReadyNode{*it, scheduled_nsec});
+    }
+  } else {
+    // Not on a worker thread: spread the nodes over all the deques.
+    int next = ws_state->next_worker_id.fetch_add(1, std::memory_order_relaxed);
+    for (Iterator it = begin; it != end; ++it) {
+      ws_state->queue.Push(next++ % ws_state->queue.num_workers(),
+                           ReadyNode{*it, scheduled_nsec});
+    }
+  }
+  MaybeStartWorkStealingWorkers();
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartWorkStealingWorkers() {
+  const std::shared_ptr<WorkStealingState>& ws_state = work_stealing_state_;
+  const int num_workers = ws_state->queue.num_workers();
+  int active = ws_state->num_active_workers.load();
+  while (active < num_workers &&
+         static_cast<size_t>(active) < ws_state->queue.ApproximateSize()) {
+    if (!ws_state->num_active_workers.compare_exchange_weak(active,
+                                                            active + 1)) {
+      continue;
+    }
+    const int worker_id =
+        ws_state->next_worker_id.fetch_add(1, std::memory_order_relaxed) %
+        num_workers;
+    RunTask([this, ws_state, worker_id]() {
+      WorkStealingLoop(this, ws_state, worker_id);
+    });
+    ++active;
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::WorkStealingLoop(
+    ExecutorState* self, std::shared_ptr<WorkStealingState> ws_state,
+    int worker_id) {
+  tsl::profiler::TraceMe activity("ExecutorState::WorkStealingLoop",
+                                  tsl::profiler::TraceMeLevel::kVerbose);
+  const WorkStealingWorkerContext saved_context = work_stealing_worker_context;
+  work_stealing_worker_context = {ws_state.get(), worker_id};
+  WorkStealingQueue<ReadyNode>& queue = ws_state->queue;
+  const size_t backlog_threshold =
+      static_cast<size_t>(kWorkStealingBacklogPerWorker) * queue.num_workers();
+  while (true) {
+    std::optional<ReadyNode> ready_node = queue.Pop(worker_id);
+    if (!ready_node.has_value()) {
+      // N.B. `self` may already have been deleted here: the node that
+      // completed the step might have been processed by this or another
+      // worker. Only `ws_state` may be accessed until a node is popped.
+      ws_state->workers_idle.store(true, std::memory_order_relaxed);
+      ws_state->num_active_workers.fetch_sub(1);
+      // Re-check for nodes that were pushed after the failed pop but before
+      // the pusher could observe this worker leaving.
+      if (queue.ApproximateSize() == 0) break;
+      int active = ws_state->num_active_workers.load();
+      bool rejoined = false;
+      while (active < queue.num_workers()) {
+        if (ws_state->num_active_workers.compare_exchange_weak(active,
+                                                               active + 1)) {
+          rejoined = true;
+          break;
+        }
+      }
+      if (!rejoined) break;
+      continue;
+    }
+    // A popped node keeps the step alive until it has been processed, so
+    // `self` is valid until `Process()` returns.
+    ExecutorImpl::KernelStats* kernel_stats = self->kernel_stats_;
+    if (queue.ApproximateSize() > backlog_threshold) {
+      kernel_stats->AdjustExpensiveThreshold(/*backlogged=*/true);
+    } else if (ws_state->workers_idle.exchange(false,
+                                               std::memory_order_relaxed)) {
+      kernel_stats->AdjustExpensiveThreshold(/*backlogged=*/false);
+    }
+    self->Process(ready_node->tagged_node, ready_node->scheduled_nsec);
+  }
+  work_stealing_worker_context = saved_context;
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   TaggedNodeSeq ready;
@@ -698,9 +932,20 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
         propagator_.PropagateOutputs(state->tagged_node, &outputs, &ready);
       }
       outputs.clear();
-      const bool completed = NodeDone(s, &ready, stats, nullptr);
+      TaggedNodeReadyQueue inline_ready;
+      const bool run_inline = low_latency_ && process_inline_depth == 0;
+      const bool completed =
+          NodeDone(s, &ready, stats, run_inline ? &inline_ready : nullptr);
       delete state;
-      if (completed) ScheduleFinish();
+      if (completed) {
+        ScheduleFinish();
+      } else if (!inline_ready.empty()) {
+        int64_t scheduled_nsec = 0;
+        if (stats_collector_) {
+          scheduled_nsec = nodestats::NowInNsec();
+        }
+        ProcessInline(&inline_ready, scheduled_nsec);
+      }
     };
 
     immutable_state_.params().device->ComputeAsync(async_kernel, &state->ctx,
@@ -740,6 +985,7 @@ template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ProcessInline(
     TaggedNodeReadyQueue* inline_ready, int64_t scheduled_nsec) {
   WithContext wc(context_);
+  ++process_inline_depth;
   auto ready = std::make_unique<TaggedNodeSeq>();
 
   // Parameters passed to OpKernel::Compute.
@@ -763,6 +1009,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->rendezvous = rendezvous_;
   params->collective_executor = collective_executor_;
   params->session_config = session_config_;
+  params->step_allocator = step_allocator_;
   params->session_state = session_state_;
   params->session_handle = session_handle_;
   params->session_metadata = session_metadata_;
@@ -913,6 +1160,9 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
 
       // Set up compute params.
       params->op_kernel = item.kernel;
+      params->op_device_context = item.device_context != nullptr
+                                      ? item.device_context
+                                      : device_context_;
       params->frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params->is_input_dead = is_input_dead;
       params->output_attr_array = item.output_attrs();
@@ -964,6 +1214,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       completed = NodeDone(s, ready.get(), stats, inline_ready);
     }
   }  // while !inline_ready.empty()
+  --process_inline_depth;
 
   // This thread of computation is done if completed = true.
   if (completed) ScheduleFinish();
@@ -1277,6 +1528,19 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
   DCHECK(!ready->empty());
 
+  const bool prioritize = immutable_state_.has_critical_path_priorities();
+  if (prioritize && ready->size() > 1) {
+    // Run the nodes that start the longest remaining paths first, so that
+    // long chains that become ready late do not determine the step latency.
+    std::stable_sort(ready->begin(), ready->end(),
+                     [this](const TaggedNode& a, const TaggedNode& b) {
+                       return immutable_state_.critical_path_priority(
+                                  *a.node_item) >
+                              immutable_state_.critical_path_priority(
+                                  *b.node_item);
+                     });
+  }
+
   int64_t scheduled_nsec = 0;
   if (stats_collector_) {
     scheduled_nsec = nodestats::NowInNsec();
@@ -1301,7 +1565,9 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
-    if (inline_ready == nullptr) {
+    if (inline_ready == nullptr && work_stealing_state_) {
+      ScheduleWorkStealing(ready->begin(), ready->end(), scheduled_nsec);
+    } else if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
         RunTask([=]() { Process(tagged_node, scheduled_nsec); },
@@ -1313,10 +1579,13 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
           // Inline this inexpensive node.
           inline_ready->push_back(tagged_node);
+        } else if (curr_expensive_node == nullptr) {
+          curr_expensive_node = &tagged_node;
+        } else if (prioritize) {
+          // Keep the highest-priority expensive node to run inline.
+          expensive_nodes.push_back(tagged_node);
         } else {
-          if (curr_expensive_node) {
-            expensive_nodes.push_back(*curr_expensive_node);
-          }
+          expensive_nodes.push_back(*curr_expensive_node);
           curr_expensive_node = &tagged_node;
         }
       }
@@ -1324,6 +1593,10 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     if (curr_expensive_node) {
       if (inline_ready->empty()) {
         inline_ready->push_back(*curr_expensive_node);
+      } else if (prioritize) {
+        // There are inline nodes to run already. We dispatch this expensive
+        // node, which has the highest priority, to other thread first.
+        expensive_nodes.insert(expensive_nodes.begin(), *curr_expensive_node);
       } else {
         // There are inline nodes to run already. We dispatch this expensive
         // node to other thread.
@@ -1331,7 +1604,12 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       }
     }
     if (!expensive_nodes.empty()) {
-      if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
+      if (work_stealing_state_) {
+        // The workers bound the number of closures, so there is no need to
+        // split large batches of expensive nodes into child tasks.
+        ScheduleWorkStealing(expensive_nodes.begin(), expensive_nodes.end(),
+                             scheduled_nsec);
+      } else if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
         for (auto& tagged_node : expensive_nodes) {
           RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
                             scheduled_nsec),
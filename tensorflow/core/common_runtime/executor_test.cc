@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <deque>
+#include <functional>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -43,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -81,6 +84,7 @@ class ExecutorTest : public ::testing::Test {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.use_critical_path_priorities = use_critical_path_priorities_;
     params.create_kernel =
         [this, version](const std::shared_ptr<const NodeProperties>& props,
                         OpKernel** kernel) {
@@ -101,6 +105,7 @@ class ExecutorTest : public ::testing::Test {
     args.rendezvous = rendez;
     args.stats_collector = &step_stats_collector_;
     args.runner = runner_;
+    args.session_config = session_config_;
     return exec_->Run(args);
   }
 
@@ -111,6 +116,8 @@ class ExecutorTest : public ::testing::Test {
   StepStats step_stats_;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  const ConfigProto* session_config_ = nullptr;
+  bool use_critical_path_priorities_ = false;
 };
 
 // A float val -> Tensor<float>
@@ -265,6 +272,142 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  ConfigProto config;
+  config.set_inter_op_parallelism_threads(4);
+  config.mutable_experimental()->set_use_work_stealing_executor(true);
+  session_config_ = &config;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  // Run several steps so that the expensive threshold is adjusted between
+  // them.
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+  session_config_ = nullptr;
+}
+
+TEST_F(ExecutorTest, RandomTreeCriticalPathPriorities) {
+  use_critical_path_priorities_ = true;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+  use_critical_path_priorities_ = false;
+}
+
+TEST_F(ExecutorTest, RandomTreeLowLatency) {
+  ConfigProto config;
+  config.mutable_experimental()->set_use_low_latency_executor(true);
+  session_config_ = &config;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  // Send the input once the executor waits on it, so that the tree runs on
+  // the thread that completes the Recv.
+  rendez_->Ref();
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(100 * 1000);
+    Status s = rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"),
+                             Rendezvous::Args(), V(1.0), false);
+    rendez_->Unref();
+  });
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"),
+                             Rendezvous::Args(), &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+  session_config_ = nullptr;
+}
+
+TEST_F(ExecutorTest, CriticalPathPrioritiesDispatchOrder) {
+  // "src" feeds an inexpensive Identity, which runs inline, and chains of 1,
+  // 3 and 2 expensive Neg ops, which are dispatched to the runner.
+  use_critical_path_priorities_ = true;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto src = test::graph::Identity(g.get(), in);
+  test::graph::Send(g.get(), test::graph::Identity(g.get(), src), "b", BOB, 1,
+                    ALICE);
+  std::vector<string> chain_heads;
+  for (const int length : {1, 3, 2}) {
+    Node* n = test::graph::Unary(g.get(), "Neg", src);
+    chain_heads.push_back(n->name());
+    for (int i = 1; i < length; ++i) {
+      n = test::graph::Unary(g.get(), "Neg", n);
+    }
+  }
+  Create(std::move(g));
+
+  // Runs the closures one at a time, in the order in which they are
+  // dispatched.
+  std::deque<std::function<void()>> closures;
+  StepStats step_stats;
+  StepStatsCollector collector(&step_stats);
+  Executor::Args args;
+  args.rendezvous = rendez_;
+  args.stats_collector = &collector;
+  args.runner = [&closures](std::function<void()> fn) {
+    closures.push_back(std::move(fn));
+  };
+  Rendezvous::Args rendez_args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), rendez_args,
+                             V(1.0), false));
+  Notification done;
+  Status status;
+  exec_->RunAsync(args, [&](const Status& s) {
+    status = s;
+    done.Notify();
+  });
+  while (!closures.empty()) {
+    std::function<void()> fn = std::move(closures.front());
+    closures.pop_front();
+    fn();
+  }
+  ASSERT_TRUE(done.HasBeenNotified());
+  TF_ASSERT_OK(status);
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), rendez_args,
+                             &out, &is_dead));
+  EXPECT_EQ(1.0, V(out));
+
+  // The longest chain runs first, although it is not the last expensive node
+  // to become ready.
+  collector.Finalize();
+  std::vector<string> executed_heads;
+  for (const auto& dev_stats : step_stats.dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      if (std::find(chain_heads.begin(), chain_heads.end(),
+                    node_stats.node_name()) != chain_heads.end()) {
+        executed_heads.push_back(node_stats.node_name());
+      }
+    }
+  }
+  EXPECT_THAT(executed_heads, ::testing::ElementsAre(
+                                  chain_heads[1], chain_heads[2],
+                                  chain_heads[0]));
+  use_critical_path_priorities_ = false;
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
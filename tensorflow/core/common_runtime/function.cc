@@ -51,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/graph/optimizer_cse.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/str_util.h"
@@ -425,6 +426,8 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
     string executor_type;
     bool allow_small_function_optimizations = false;
     bool allow_control_flow_sync_execution = false;
+    // Schedules closures on the private thread pool of the function, if any.
+    Executor::Args::Runner runner = nullptr;
 
     ~Item() {
       delete this->func_graph;
@@ -433,6 +436,10 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
   };
   std::unique_ptr<absl::flat_hash_map<Handle, std::unique_ptr<Item>>> items_
       TF_GUARDED_BY(mu_);
+  // Private thread pools of functions, keyed by
+  // InstantiateOptions::thread_pool_name.
+  absl::flat_hash_map<string, std::unique_ptr<thread::ThreadPool>>
+      thread_pools_ TF_GUARDED_BY(mu_);
   std::unique_ptr<FunctionHandleCache> function_handle_cache_;
   ProcessFunctionLibraryRuntime* parent_ = nullptr;  // not owned.
 
@@ -467,6 +474,16 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
                                CallFrameInterface* frame,
                                Executor::Args* exec_args);
 
+  // Returns a runner that schedules closures on the private thread pool
+  // requested by `options`, creating the pool if needed.
+  Executor::Args::Runner GetOrCreateThreadPoolRunner(
+      const InstantiateOptions& options) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Sets the runner of `run_opts` to the runner of `item` if the function has
+  // a private thread pool, or to `default_runner_` if the caller did not set
+  // one.
+  void SetRunner(Item* item, Options* run_opts);
+
   FunctionLibraryRuntimeImpl(const FunctionLibraryRuntimeImpl&) = delete;
   void operator=(const FunctionLibraryRuntimeImpl&) = delete;
 };
@@ -843,6 +860,9 @@ Status FunctionLibraryRuntimeImpl::Instantiate(
           options.allow_small_function_optimizations;
       item->allow_control_flow_sync_execution =
           options.allow_control_flow_sync_execution;
+      if (!options.thread_pool_name.empty()) {
+        item->runner = GetOrCreateThreadPoolRunner(options);
+      }
       if (options.lib_def) {
         TF_ASSIGN_OR_RETURN(
             FunctionLibraryDefinition reachable_lib_def,
@@ -984,6 +1004,36 @@ Status FunctionLibraryRuntimeImpl::GetOrCreateItem(LocalHandle local_handle,
   return CreateItem(item);
 }
 
+Executor::Args::Runner FunctionLibraryRuntimeImpl::GetOrCreateThreadPoolRunner(
+    const InstantiateOptions& options) {
+  std::unique_ptr<thread::ThreadPool>& pool =
+      thread_pools_[options.thread_pool_name];
+  if (pool == nullptr) {
+    ThreadOptions thread_options;
+    thread_options.numa_node = options.thread_pool_numa_node;
+    const int num_threads =
+        options.thread_pool_num_threads > 0
+            ? options.thread_pool_num_threads
+            : port::MaxParallelism(options.thread_pool_numa_node);
+    VLOG(1) << "Creating thread pool " << options.thread_pool_name << " with "
+            << num_threads << " threads for functions on " << device_name_;
+    pool = std::make_unique<thread::ThreadPool>(
+        env_, thread_options, options.thread_pool_name, num_threads,
+        /*low_latency_hint=*/false);
+  }
+  return [pool = pool.get()](Executor::Args::Closure c) {
+    pool->Schedule(std::move(c));
+  };
+}
+
+void FunctionLibraryRuntimeImpl::SetRunner(Item* item, Options* run_opts) {
+  if (item->runner != nullptr) {
+    run_opts->runner = &item->runner;
+  } else if (run_opts->runner == nullptr) {
+    run_opts->runner = &default_runner_;
+  }
+}
+
 void FunctionLibraryRuntimeImpl::ExecutorArgsFromOptions(
     const FunctionLibraryRuntime::Options& run_opts, CallFrameInterface* frame,
     Executor::Args* exec_args) {
@@ -1123,17 +1173,14 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
     return;
   }
 
-  if (run_opts.runner == nullptr) {
-    run_opts.runner = &default_runner_;
-  }
-  DCHECK(run_opts.runner != nullptr);
-
   Item* item = nullptr;
   Status s = GetOrCreateItem(local_handle, &item);
   if (!s.ok()) {
     done(s);
     return;
   }
+  SetRunner(item, &run_opts);
+  DCHECK(run_opts.runner != nullptr);
 
   if (run_opts.remote_execution) {
     // NOTE(mrry): `RunRemote()` will set `exec_args->call_frame` for us.
@@ -1219,9 +1266,7 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
     done(s);
     return;
   }
-  if (run_opts.runner == nullptr) {
-    run_opts.runner = &default_runner_;
-  }
+  SetRunner(item, &run_opts);
   DCHECK(run_opts.runner != nullptr);
 
   Executor::Args exec_args;
@@ -1270,9 +1315,7 @@ Status FunctionLibraryRuntimeImpl::PrepareRunSync(
 
   TF_RETURN_IF_ERROR(GetOrCreateItem(local_handle, out_item));
 
-  if (run_opts->runner == nullptr) {
-    run_opts->runner = &default_runner_;
-  }
+  SetRunner(*out_item, run_opts);
   DCHECK(run_opts->runner != nullptr);
 
   return absl::OkStatus();
@@ -740,6 +740,40 @@ class DummyExecutorRegistrar {
 static DummyExecutorRegistrar registrar;
 }  // namespace
 
+TEST_F(FunctionLibraryRuntimeTest, PrivateThreadPool) {
+  Init({test::function::XTimesTwo()});
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor y;
+
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, &handle));
+
+  FunctionLibraryRuntime::InstantiateOptions options;
+  options.thread_pool_name = "tenant_a";
+  options.thread_pool_num_threads = 2;
+  FunctionLibraryRuntime::Handle handle_a;
+  TF_CHECK_OK(
+      Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, options, &handle_a));
+  EXPECT_NE(handle, handle_a);
+
+  // Functions instantiated with the same thread pool share a handle.
+  FunctionLibraryRuntime::Handle handle_a_again;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, options,
+                          &handle_a_again));
+  EXPECT_EQ(handle_a, handle_a_again);
+
+  options.thread_pool_name = "tenant_b";
+  FunctionLibraryRuntime::Handle handle_b;
+  TF_CHECK_OK(
+      Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, options, &handle_b));
+  EXPECT_NE(handle_a, handle_b);
+
+  for (FunctionLibraryRuntime::Handle h : {handle_a, handle_b}) {
+    TF_CHECK_OK(Run(flr0_, h, FunctionLibraryRuntime::Options(), {x}, {&y}));
+    test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  }
+}
+
 TEST_F(FunctionLibraryRuntimeTest, ExecutorFactory) {
   Init({test::function::XTimesTwo()});
 
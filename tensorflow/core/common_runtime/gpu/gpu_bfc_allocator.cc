@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 
 #include "xla/tsl/framework/bfc_allocator.h"
+#include "xla/tsl/util/env_var.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
@@ -80,6 +81,17 @@ bool GetGarbageCollectionValue() {
       << " Using the default value \"true\".";
   return true;
 }
+
+int64_t GetMemoryTimelineSampleRate() {
+  int64_t sample_rate = 0;
+  absl::Status status = tsl::ReadInt64FromEnvVar(
+      "TF_GPU_MEMORY_TIMELINE_SAMPLE_RATE", 0, &sample_rate);
+  if (!status.ok()) {
+    LOG(ERROR) << "GPUBFCAllocator: " << status.message();
+    return 0;
+  }
+  return sample_rate;
+}
 }  // anonymous namespace
 
 GPUBFCAllocator::GPUBFCAllocator(
@@ -95,6 +107,10 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.fast_bin_max_bytes = opts.fast_bin_max_bytes;
+        o.memory_timeline_sample_rate =
+            opts.memory_timeline_sample_rate.value_or(
+                GetMemoryTimelineSampleRate());
         return o;
       }()) {}
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_BFC_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_BFC_ALLOCATOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -46,6 +47,11 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+    size_t fast_bin_max_bytes = 0;
+
+    // If nullopt, defaults to TF_GPU_MEMORY_TIMELINE_SAMPLE_RATE, or 0 (off) if
+    // that envvar is not present.
+    std::optional<int64_t> memory_timeline_sample_rate;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
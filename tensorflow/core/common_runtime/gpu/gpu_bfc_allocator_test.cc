@@ -233,6 +233,142 @@ TEST_P(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   a.DeallocateRaw(first_ptr);
 }
 
+TEST_P(GPUBFCAllocatorTest, FastBinsReuseSmallChunks) {
+  GPUBFCAllocator::Options opts;
+  opts.fast_bin_max_bytes = 4096;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  void* p1 = a.AllocateRaw(1, 100);
+  EXPECT_EQ(100, a.RequestedSize(p1));
+  EXPECT_EQ(256, a.AllocatedSize(p1));
+  const int64_t id1 = a.AllocationId(p1);
+  a.DeallocateRaw(p1);
+  CheckStats(&a, 1, 0, 256, 256);
+
+  // The chunk is served again from the fast bins, with a new identity.
+  void* p2 = a.AllocateRaw(1, 200);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(200, a.RequestedSize(p2));
+  EXPECT_EQ(256, a.AllocatedSize(p2));
+  EXPECT_GT(a.AllocationId(p2), id1);
+  CheckStats(&a, 2, 256, 256, 256);
+
+  // Allocations larger than the fast bins use the regular bins.
+  void* p3 = a.AllocateRaw(1, 8192);
+  CheckStats(&a, 3, 256 + 8192, 256 + 8192, 8192);
+  a.DeallocateRaw(p2);
+  a.DeallocateRaw(p3);
+  CheckStats(&a, 3, 0, 256 + 8192, 8192);
+
+  // The memory map shows cached chunks as free.
+  MemoryDump md = a.RecordMemoryMap();
+  for (const auto& chunk : md.chunk()) {
+    EXPECT_FALSE(chunk.in_use());
+  }
+  EXPECT_EQ(md.stats().bytes_in_use(), 0);
+}
+
+TEST_P(GPUBFCAllocatorTest, FastBinsFlushedWhenOutOfMemory) {
+  GPUBFCAllocator::Options opts;
+  opts.fast_bin_max_bytes = 4096;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 2 << 20, "GPU_0_bfc", opts);
+
+  // Cache 1MiB of small chunks in the fast bins.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 256; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 4096));
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  CheckStats(&a, 256, 0, 1 << 20, 4096);
+
+  // This only fits once the cached chunks are coalesced.
+  void* large = a.AllocateRaw(1, 3 << 19);
+  EXPECT_NE(nullptr, large);
+  a.DeallocateRaw(large);
+}
+
+TEST_P(GPUBFCAllocatorTest, FastBinsThreaded) {
+  GPUBFCAllocator::Options opts;
+  opts.fast_bin_max_bytes = 4096;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; t++) {
+      pool.Schedule([&a]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; i++) {
+          ptrs.push_back(a.AllocateRaw(1, 256 * (1 + i % 16)));
+          if (i % 3 == 0) {
+            a.DeallocateRaw(ptrs.back());
+            ptrs.pop_back();
+          }
+        }
+        for (void* p : ptrs) {
+          a.DeallocateRaw(p);
+        }
+      });
+    }
+  }
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 8000);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+  EXPECT_EQ(stats->largest_alloc_size, 4096);
+}
+
+TEST_P(GPUBFCAllocatorTest, MemoryTimelineSamplesEvents) {
+  GPUBFCAllocator::Options opts;
+  opts.memory_timeline_sample_rate = 2;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  void* p0 = a.AllocateRaw(1, 1 << 20);
+  void* p1 = a.AllocateRaw(1, 1 << 20);
+  void* p2 = a.AllocateRaw(1, 1 << 20);
+  a.DeallocateRaw(p1);
+
+  // Only the second allocation and the deallocation are sampled.
+  std::vector<tsl::BFCAllocator::MemoryTimelineEvent> timeline =
+      a.MemoryTimeline();
+  ASSERT_EQ(timeline.size(), 2);
+  EXPECT_TRUE(timeline[0].is_allocation);
+  EXPECT_EQ(timeline[0].address, reinterpret_cast<uint64>(p1));
+  EXPECT_EQ(timeline[0].bytes_in_use, 2 << 20);
+  EXPECT_EQ(timeline[0].fragmentation, 0);
+  EXPECT_FALSE(timeline[1].is_allocation);
+  EXPECT_EQ(timeline[1].allocation_bytes, 1 << 20);
+  EXPECT_EQ(timeline[1].bytes_in_use, 2 << 20);
+  EXPECT_EQ(timeline[1].largest_free_block_bytes, (1 << 30) - (3 << 20));
+  // The freed chunk is a hole between p0 and p2.
+  EXPECT_DOUBLE_EQ(timeline[1].fragmentation,
+                   static_cast<double>(1 << 20) / ((1 << 30) - (2 << 20)));
+  EXPECT_LE(timeline[0].time_micros, timeline[1].time_micros);
+
+  a.DeallocateRaw(p0);
+  a.DeallocateRaw(p2);
+}
+
+TEST_P(GPUBFCAllocatorTest, MemoryTimelineKeepsLatestEvents) {
+  GPUBFCAllocator::Options opts;
+  opts.memory_timeline_sample_rate = 1;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  const int64_t num_pairs = tsl::BFCAllocator::kMemoryTimelineCapacity;
+  for (int64_t i = 0; i < num_pairs; ++i) {
+    a.DeallocateRaw(a.AllocateRaw(1, 256 * (1 + i)));
+  }
+
+  // The ring buffer only holds the last half of the events, oldest first.
+  std::vector<tsl::BFCAllocator::MemoryTimelineEvent> timeline =
+      a.MemoryTimeline();
+  ASSERT_EQ(timeline.size(), tsl::BFCAllocator::kMemoryTimelineCapacity);
+  for (size_t i = 0; i < timeline.size(); ++i) {
+    EXPECT_EQ(timeline[i].is_allocation, i % 2 == 0);
+    EXPECT_EQ(timeline[i].requested_bytes, 256 * (1 + num_pairs / 2 + i / 2));
+  }
+}
+
 TEST_P(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   GPUOptions options;
   options.set_allow_growth(true);
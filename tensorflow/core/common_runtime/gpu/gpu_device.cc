@@ -53,8 +53,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_multi_stream_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_step_capture.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_assignment.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -410,6 +414,25 @@ class BaseGPUDevice::StreamGroupFactory {
       }
     }
     streams_.clear();
+    users_.clear();
+  }
+
+  // Counts the devices that enqueue work on the stream group of `compute`.
+  void AddUser(se::Stream* compute) {
+    mutex_lock guard(lock_);
+    ++users_[compute];
+  }
+
+  void RemoveUser(se::Stream* compute) {
+    mutex_lock guard(lock_);
+    auto it = users_.find(compute);
+    if (it != users_.end() && --it->second == 0) users_.erase(it);
+  }
+
+  int NumUsers(se::Stream* compute) {
+    mutex_lock guard(lock_);
+    auto it = users_.find(compute);
+    return it == users_.end() ? 0 : it->second;
   }
 
   std::optional<tsl::TfDeviceId> FindTfDeviceId(se::Stream* compute) const {
@@ -438,6 +461,7 @@ class BaseGPUDevice::StreamGroupFactory {
   using key_type = std::tuple<int, int>;
   std::map<key_type, StreamGroup> streams_;
   std::vector<std::unique_ptr<se::Stream>> allocated_streams_;
+  std::map<se::Stream*, int> users_;
 
   // StreamGroupFactory cannot be created directly; Call
   // StreamGroupFactory::Global() to get the global instance.
@@ -479,30 +503,64 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 }
 
 BaseGPUDevice::~BaseGPUDevice() {
+  if (stream_ != nullptr) {
+    StreamGroupFactory::Global().RemoveUser(stream_->compute);
+  }
   delete accelerator_device_info_;
+  // The buffers used on the side streams are released once they are done.
+  multi_stream_allocator_.reset();
+  for (const auto& stream : side_streams_) {
+    stream->BlockHostUntilDone().IgnoreError();
+  }
+  for (char* scratch : side_stream_scratch_) {
+    gpu_allocator_->DeallocateRaw(scratch);
+  }
+  for (const auto& [key, context] : stream_contexts_) {
+    context->Unref();
+  }
   if (scratch_) gpu_allocator_->DeallocateRaw(scratch_);
   device_context_->Unref();
 }
 
+Allocator* BaseGPUDevice::device_allocator() const {
+  Allocator* allocator =
+      step_capture_allocator_.load(std::memory_order_acquire);
+  if (allocator != nullptr) return allocator;
+  if (multi_stream_allocator_ != nullptr) return multi_stream_allocator_.get();
+  return gpu_allocator_;
+}
+
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
   if (!scratch_) {
     DCHECK(stream_);
-    size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
-    profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
-    void* scratch_buffer = gpu_allocator_->AllocateRaw(
-        Allocator::kAllocatorAlignment, scratch_buffer_size);
-    if (scratch_buffer == nullptr) {
-      return errors::FailedPrecondition(
-          "Failed to allocate scratch buffer for device ",
-          tf_device_id_.value());
-    }
-    se::DeviceMemory<char> mem(
-        se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
-    TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
-        &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    // Each compute stream has its own, as the kernels of different streams
+    // may run concurrently.
+    auto allocate_scratch = [this](char** scratch) -> Status {
+      size_t scratch_buffer_size =
+          Eigen::kGpuScratchSize + sizeof(unsigned int);
+      profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
+      void* scratch_buffer = gpu_allocator_->AllocateRaw(
+          Allocator::kAllocatorAlignment, scratch_buffer_size);
+      if (scratch_buffer == nullptr) {
+        return errors::FailedPrecondition(
+            "Failed to allocate scratch buffer for device ",
+            tf_device_id_.value());
+      }
+      se::DeviceMemory<char> mem(
+          se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
+      TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
+          &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
+      *scratch = static_cast<char*>(scratch_buffer);
+      return OkStatus();
+    };
+    while (side_stream_scratch_.size() < side_streams_.size()) {
+      char* scratch;
+      TF_RETURN_IF_ERROR(allocate_scratch(&scratch));
+      side_stream_scratch_.push_back(scratch);
+    }
+    TF_RETURN_IF_ERROR(allocate_scratch(&scratch_));
   }
   return OkStatus();
 }
@@ -550,6 +608,7 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   stream_ = StreamGroupFactory::Global().GetOrCreate(
       tf_device_id_, 0, executor_, options.config.gpu_options());
 #endif  // TF_GPU_USE_PJRT
+  StreamGroupFactory::Global().AddUser(stream_->compute);
 
   // Get an allocator that allocates pinned memory on host.
   AllocatorAttributes attr;
@@ -593,6 +652,24 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
 
+  const int num_compute_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+  if (num_compute_streams > 1 && kernel_tracker_ != nullptr) {
+    LOG(WARNING) << "Running all the kernels of " << name()
+                 << " on one compute stream, as the kernel tracker only "
+                    "follows one.";
+  } else if (num_compute_streams > 1) {
+    for (int i = 1; i < num_compute_streams; ++i) {
+      TF_ASSIGN_OR_RETURN(std::unique_ptr<se::Stream> stream,
+                          executor_->CreateStream(stream_->priority));
+      side_streams_.push_back(std::move(stream));
+    }
+    multi_stream_allocator_ = std::make_unique<MultiStreamAllocator>(
+        gpu_allocator_, em_, stream_->compute);
+    VLOG(1) << "Created " << side_streams_.size()
+            << " side compute streams on " << name();
+  }
+
   accelerator_device_info_ = new DeviceBase::AcceleratorDeviceInfo;
   accelerator_device_info_->stream = stream_->compute;
   accelerator_device_info_->default_context = device_context_;
@@ -776,6 +853,15 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
   }
   se::Stream* stream = gpu_device_context->stream();
   const auto stream_id = gpu_device_context->stream_id();
+  for (se::Stream* wait_stream : gpu_device_context->wait_streams()) {
+    Status s = stream->WaitFor(wait_stream);
+    if (!s.ok()) {
+      context->SetStatus(s);
+      return;
+    }
+  }
+  const bool on_side_stream =
+      multi_stream_allocator_ != nullptr && stream != stream_->compute;
 
   const bool vlog_1 = VLOG_IS_ON(1);
 
@@ -799,7 +885,14 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     LogInputs(op_kernel, context);
   }
 
-  op_kernel->Compute(context);
+  if (on_side_stream) {
+    RecordSideStreamUses(context, stream, /*outputs=*/false);
+    MultiStreamAllocator::ScopedStream scoped_stream(stream);
+    op_kernel->Compute(context);
+    RecordSideStreamUses(context, stream, /*outputs=*/true);
+  } else {
+    op_kernel->Compute(context);
+  }
 
   if (should_log_inputs_and_outputs) {
     LogOutputs(op_kernel, context);
@@ -854,12 +947,29 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
+  if (step_capture_allocator_.load(std::memory_order_acquire) != nullptr) {
+    return OkStatus();
+  }
+  if (multi_stream_allocator_ != nullptr) {
+    multi_stream_allocator_->Flush();
+  }
+  for (const auto& stream : side_streams_) {
+    TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+  }
   return stream_->compute->BlockHostUntilDone();
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
                                  OpKernelContext* context,
                                  AsyncOpKernel::DoneCallback done) {
+  if (TF_PREDICT_FALSE(step_capture_allocator_.load(
+                           std::memory_order_acquire) != nullptr)) {
+    context->SetStatus(errors::Unimplemented(
+        "Can't capture a step with the asynchronous kernel ",
+        op_kernel->name(), " on ", name()));
+    done();
+    return;
+  }
   GPUDeviceContext* gpu_device_context = device_context_;
   if (context->op_device_context() != nullptr) {
     gpu_device_context =
@@ -867,6 +977,14 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   }
   se::Stream* stream = gpu_device_context->stream();
   const auto stream_id = gpu_device_context->stream_id();
+  for (se::Stream* wait_stream : gpu_device_context->wait_streams()) {
+    Status s = stream->WaitFor(wait_stream);
+    if (!s.ok()) {
+      context->SetStatus(s);
+      done();
+      return;
+    }
+  }
 
   VLOG(1) << "GpuDevice::ComputeAsync " << op_kernel->name() << " op "
           << op_kernel->type_string() << " on GPU" << tf_device_id_
@@ -1289,11 +1407,11 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
   const gpuStream_t gpu_stream = reinterpret_cast<gpuStream_t>(
-      stream_->compute->platform_specific_handle().stream);
-  concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
-                                scratch_);
+      ComputeStream(stream_id)->platform_specific_handle().stream);
+  concrete_device->Reinitialize(
+      context, gpu_stream, tf_device_id_, allocator,
+      stream_id == 0 ? scratch_ : side_stream_scratch_[stream_id - 1]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1310,7 +1428,6 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
@@ -1318,6 +1435,122 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
   return OkStatus();
 }
 
+void BaseGPUDevice::RecordSideStreamUses(OpKernelContext* context,
+                                         se::Stream* stream, bool outputs) {
+  auto record_use = [&](const Tensor& tensor) {
+    const TensorBuffer* buffer = DMAHelper::buffer(&tensor);
+    if (buffer != nullptr) {
+      multi_stream_allocator_->RecordUse(buffer->root_buffer()->data(),
+                                         stream);
+    }
+  };
+  if (outputs) {
+    for (int i = 0; i < context->num_outputs(); ++i) {
+      const Tensor* output = context->mutable_output(i);
+      if (output != nullptr &&
+          context->output_memory_type(i) == DEVICE_MEMORY) {
+        record_use(*output);
+      }
+    }
+  } else {
+    for (int i = 0; i < context->num_inputs(); ++i) {
+      if (context->has_input(i) &&
+          context->input_memory_type(i) == DEVICE_MEMORY) {
+        record_use(context->input(i));
+      }
+    }
+  }
+}
+
+namespace {
+
+// Returns whether the kernel of `node` may run on any compute stream. The
+// device can only see the buffers of the inputs and outputs of a kernel, and
+// those it allocates while it computes. So stateful and control flow ops, ops
+// on resources, refs and variants, which hold on to other buffers, and
+// asynchronous kernels, which may use theirs after they return, stay on the
+// compute stream of the device.
+bool CanRunOnAnyStream(const Node* node, OpKernel* kernel) {
+  if (kernel == nullptr || kernel->AsAsync() != nullptr ||
+      node->op_def().is_stateful() || node->IsControlFlow() ||
+      node->IsSend() || node->IsRecv()) {
+    return false;
+  }
+  for (const DataTypeVector* types :
+       {&node->input_types(), &node->output_types()}) {
+    for (DataType dtype : *types) {
+      if (IsRefType(dtype) || dtype == DT_RESOURCE || dtype == DT_VARIANT) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+Status BaseGPUDevice::FillContextMap(
+    const Graph& graph, absl::Span<OpKernel* const> kernels,
+    std::vector<DeviceContext*>* device_contexts) {
+  if (side_streams_.empty()) return OkStatus();
+  const std::vector<ComputeStreamAssignment> assignments =
+      AssignComputeStreams(graph, side_streams_.size() + 1,
+                           [&](const Node* node) {
+                             return CanRunOnAnyStream(node,
+                                                      kernels[node->id()]);
+                           });
+  device_contexts->assign(graph.num_node_ids(), nullptr);
+  mutex_lock l(stream_contexts_mu_);
+  for (const Node* node : graph.op_nodes()) {
+    const ComputeStreamAssignment& assignment = assignments[node->id()];
+    if (assignment.stream == 0 && assignment.wait_streams.empty()) continue;
+    GPUDeviceContext*& context =
+        stream_contexts_[{assignment.stream, assignment.wait_streams}];
+    if (context == nullptr) {
+      context = new GPUDeviceContext(
+          assignment.stream, ComputeStream(assignment.stream),
+#if TENSORFLOW_USE_ROCM
+          stream_->nccl,
+#endif
+          stream_->host_to_device, stream_->device_to_host,
+          stream_->device_to_device, device_context_->host_memory_allocator());
+      absl::InlinedVector<se::Stream*, 2UL> wait_streams;
+      for (int wait_stream : assignment.wait_streams) {
+        wait_streams.push_back(ComputeStream(wait_stream));
+      }
+      context->set_wait_streams(std::move(wait_streams));
+    }
+    context->Ref();
+    (*device_contexts)[node->id()] = context;
+  }
+  return OkStatus();
+}
+
+std::unique_ptr<DeviceStepCapture> BaseGPUDevice::CreateStepCapture() {
+  // The capture only records the work on the compute stream of the device.
+  if (!side_streams_.empty()) return nullptr;
+  if (SharesComputeStream()) {
+    VLOG(1) << "Not capturing steps on " << name()
+            << ", whose compute stream is shared with other devices";
+    return nullptr;
+  }
+  return std::make_unique<GpuStepCapture>(this);
+}
+
+bool BaseGPUDevice::SharesComputeStream() const {
+  return StreamGroupFactory::Global().NumUsers(stream_->compute) > 1;
+}
+
+void BaseGPUDevice::BeginStepCapture(Allocator* allocator) {
+  em_->BeginCapture(stream_->compute);
+  step_capture_allocator_.store(allocator, std::memory_order_release);
+}
+
+int BaseGPUDevice::EndStepCapture() {
+  step_capture_allocator_.store(nullptr, std::memory_order_release);
+  return em_->EndCapture(stream_->compute);
+}
+
 Allocator* BaseGPUDevice::GetScopedAllocator(AllocatorAttributes attr,
                                              int64_t step_id) {
   if (attr.scope_id > 0) {
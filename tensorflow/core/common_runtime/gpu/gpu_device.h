@@ -26,6 +26,7 @@ limitations under the License.
 #define TF_GPU_USE_PJRT
 #endif  // PLATFORM_GOOGLE && TF_PLATFORM_LINUX_X86_64
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -35,6 +36,9 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/types/span.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #ifdef TF_GPU_USE_PJRT
 #include "tensorflow/compiler/jit/pjrt_device_context.h"
@@ -68,6 +72,7 @@ class StreamInterface;
 
 namespace tensorflow {
 class GPUKernelTracker;
+class MultiStreamAllocator;
 
 class ConcretePerOpGpuDevice : public PerOpGpuDevice {
  public:
@@ -193,10 +198,34 @@ class BaseGPUDevice : public LocalDevice {
     return stream_merge_options_.merge_device_to_device_stream();
   }
 
+  // Runs the kernels of independent branches of `graph` on different compute
+  // streams, if the device has more than one.
+  Status FillContextMap(const Graph& graph, absl::Span<OpKernel* const> kernels,
+                        std::vector<DeviceContext*>* device_contexts) override;
+
+  // Returns nullptr if other devices, e.g. those of other sessions, enqueue
+  // work on the same compute stream, as a capture would record it too.
+  std::unique_ptr<DeviceStepCapture> CreateStepCapture() override;
+
+  // Returns whether other devices enqueue work on the compute stream.
+  bool SharesComputeStream() const;
+
+  // Between these calls a GpuStepCapture records the work enqueued on the
+  // compute stream, none of which runs: device memory is allocated from
+  // `allocator`, Sync() has nothing to wait for, asynchronous kernels fail as
+  // their callbacks could only run after the capture, and the event manager
+  // holds the callbacks on the compute stream. EndStepCapture() returns how
+  // many it held.
+  void BeginStepCapture(Allocator* allocator);
+  int EndStepCapture();
+
  protected:
   Allocator* gpu_allocator_;  // not owned
   Allocator* cpu_allocator_;  // not owned
 
+  // Returns the allocator of device memory.
+  Allocator* device_allocator() const;
+
   se::StreamExecutor* executor_;  // not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
 
@@ -205,7 +234,7 @@ class BaseGPUDevice : public LocalDevice {
   class StreamGroupFactory;
 
   core::RefCountPtr<DeviceContext> pjrt_device_context_;
-  StreamGroup* stream_;
+  StreamGroup* stream_ = nullptr;
   mutex scratch_init_mutex_;
   char* scratch_ = nullptr;
   GPUDeviceContext* device_context_;
@@ -220,6 +249,32 @@ class BaseGPUDevice : public LocalDevice {
   bool timestamped_allocator_ = false;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
   const GPUOptions::Experimental::StreamMergeOptions stream_merge_options_;
+  // The allocator of the step being captured, if any.
+  std::atomic<Allocator*> step_capture_allocator_{nullptr};
+  // The compute streams after the one of `stream_`, and their Eigen scratch
+  // buffers. See GPUOptions.Experimental.num_compute_streams.
+  std::vector<std::unique_ptr<se::Stream>> side_streams_;
+  std::vector<char*> side_stream_scratch_;
+  // Wraps `gpu_allocator_` if there are `side_streams_`.
+  std::unique_ptr<MultiStreamAllocator> multi_stream_allocator_;
+  // The contexts of the nodes that run on a side stream or wait for one, keyed
+  // by their stream and the streams they wait for.
+  mutex stream_contexts_mu_;
+  absl::flat_hash_map<std::pair<int, absl::InlinedVector<int, 2>>,
+                      GPUDeviceContext*>
+      stream_contexts_ TF_GUARDED_BY(stream_contexts_mu_);
+
+  // Returns the compute stream with the given id, where 0 is the one of
+  // `stream_`.
+  se::Stream* ComputeStream(int stream_id) const {
+    return stream_id == 0 ? stream_->compute
+                          : side_streams_[stream_id - 1].get();
+  }
+
+  // Records the buffers of the inputs, or outputs, of the kernel of `context`
+  // as used on the side stream `stream`.
+  void RecordSideStreamUses(OpKernelContext* context, se::Stream* stream,
+                            bool outputs);
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
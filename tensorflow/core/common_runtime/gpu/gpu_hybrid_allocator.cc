@@ -0,0 +1,141 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_hybrid_allocator.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/lib/monitoring/gauge.h"
+
+namespace tensorflow {
+
+namespace {
+
+auto* fragmentation_gauge = monitoring::Gauge<double, 1>::New(
+    "/tensorflow/core/gpu/allocator/fragmentation",
+    "The fraction of the free memory of the BFC allocator of a GPU that is "
+    "not in its largest free block.",
+    "allocator");
+
+}  // namespace
+
+GPUHybridAllocator::GPUHybridAllocator(
+    std::unique_ptr<GPUBFCAllocator> bfc_allocator,
+    std::unique_ptr<Allocator> temporary_allocator)
+    : bfc_allocator_(std::move(bfc_allocator)),
+      temporary_allocator_(std::move(temporary_allocator)) {}
+
+void* GPUHybridAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (!allocation_attr.short_lived) {
+    return bfc_allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  void* ptr =
+      temporary_allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) {
+    // The pool may be out of memory that the BFC allocator still has.
+    return bfc_allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  mutex_lock l(mu_);
+  temporaries_[ptr] = num_bytes;
+  return ptr;
+}
+
+void GPUHybridAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  bool temporary;
+  {
+    mutex_lock l(mu_);
+    temporary = temporaries_.erase(ptr) > 0;
+  }
+  if (temporary) {
+    temporary_allocator_->DeallocateRaw(ptr);
+  } else {
+    bfc_allocator_->DeallocateRaw(ptr);
+  }
+}
+
+bool GPUHybridAllocator::IsTemporary(const void* ptr) const {
+  tf_shared_lock l(mu_);
+  return temporaries_.contains(ptr);
+}
+
+size_t GPUHybridAllocator::RequestedSize(const void* ptr) const {
+  {
+    tf_shared_lock l(mu_);
+    auto it = temporaries_.find(ptr);
+    if (it != temporaries_.end()) return it->second;
+  }
+  return bfc_allocator_->RequestedSize(ptr);
+}
+
+size_t GPUHybridAllocator::AllocatedSize(const void* ptr) const {
+  if (IsTemporary(ptr)) return RequestedSize(ptr);
+  return bfc_allocator_->AllocatedSize(ptr);
+}
+
+int64_t GPUHybridAllocator::AllocationId(const void* ptr) const {
+  if (IsTemporary(ptr)) return 0;
+  return bfc_allocator_->AllocationId(ptr);
+}
+
+absl::optional<AllocatorStats> GPUHybridAllocator::GetStats() {
+  absl::optional<AllocatorStats> stats = bfc_allocator_->GetStats();
+  if (!stats) return stats;
+  fragmentation_gauge->GetCell(Name())->Set(Fragmentation(*stats));
+
+  absl::optional<AllocatorStats> temporary_stats =
+      temporary_allocator_->GetStats();
+  if (!temporary_stats) return stats;
+  stats->num_allocs += temporary_stats->num_allocs;
+  stats->bytes_in_use += temporary_stats->bytes_in_use;
+  // The peaks of the two allocators need not coincide, so this is an upper
+  // bound.
+  stats->peak_bytes_in_use += temporary_stats->peak_bytes_in_use;
+  stats->largest_alloc_size =
+      std::max(stats->largest_alloc_size, temporary_stats->largest_alloc_size);
+  if (stats->bytes_limit && temporary_stats->bytes_limit) {
+    *stats->bytes_limit += *temporary_stats->bytes_limit;
+  }
+  stats->bytes_reserved += temporary_stats->bytes_reserved;
+  stats->peak_bytes_reserved += temporary_stats->peak_bytes_reserved;
+  if (stats->pool_bytes) {
+    *stats->pool_bytes += temporary_stats->pool_bytes.value_or(
+        temporary_stats->bytes_in_use);
+  }
+  if (stats->peak_pool_bytes) {
+    *stats->peak_pool_bytes += temporary_stats->peak_pool_bytes.value_or(
+        temporary_stats->peak_bytes_in_use);
+  }
+  return stats;
+}
+
+bool GPUHybridAllocator::ClearStats() {
+  const bool cleared = bfc_allocator_->ClearStats();
+  return temporary_allocator_->ClearStats() && cleared;
+}
+
+double GPUHybridAllocator::Fragmentation(const AllocatorStats& bfc_stats) {
+  const int64_t bytes_free =
+      bfc_stats.pool_bytes.value_or(0) - bfc_stats.bytes_in_use;
+  if (bytes_free <= 0) return 0;
+  return static_cast<double>(bytes_free - bfc_stats.largest_free_block_bytes) /
+         bytes_free;
+}
+
+}  // namespace tensorflow
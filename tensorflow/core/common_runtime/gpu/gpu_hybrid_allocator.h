@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HYBRID_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HYBRID_ALLOCATOR_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Allocates the device memory of a GPU from two allocators: the short-lived
+// temporaries of kernels (AllocationAttributes::short_lived) from a
+// stream-ordered pool, e.g. a GpuCudaMallocAsyncAllocator, and all the other
+// buffers from a BFC allocator.
+//
+// Temporaries such as cuDNN workspaces come and go with every kernel, and
+// carving them out of the BFC regions splits the chunks that hold the
+// long-lived tensors around them. Keeping them in their own pool leaves the
+// BFC allocator with fewer, larger buffers.
+class GPUHybridAllocator : public Allocator {
+ public:
+  GPUHybridAllocator(std::unique_ptr<GPUBFCAllocator> bfc_allocator,
+                     std::unique_ptr<Allocator> temporary_allocator);
+  ~GPUHybridAllocator() override = default;
+
+  GPUBFCAllocator* bfc_allocator() const { return bfc_allocator_.get(); }
+
+  std::string Name() override { return bfc_allocator_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override {
+    return bfc_allocator_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+  int64_t AllocationId(const void* ptr) const override;
+
+  // Returns the stats of both allocators added up. `largest_free_block_bytes`
+  // is that of the BFC allocator, whose free blocks are the only ones known.
+  absl::optional<AllocatorStats> GetStats() override;
+  bool ClearStats() override;
+
+  // Sets the stream the temporaries are ordered on.
+  void SetStreamAndPreallocateMemory(void* stream) override {
+    temporary_allocator_->SetStreamAndPreallocateMemory(stream);
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return bfc_allocator_->GetMemoryType();
+  }
+
+  // The fraction of the free memory held by the BFC allocator that is not in
+  // its largest free block, which is 0 when all of it can serve a single
+  // allocation. Also exported as /tensorflow/core/gpu/allocator/fragmentation
+  // whenever the stats are read.
+  static double Fragmentation(const AllocatorStats& bfc_stats);
+
+ private:
+  bool IsTemporary(const void* ptr) const;
+
+  const std::unique_ptr<GPUBFCAllocator> bfc_allocator_;
+  const std::unique_ptr<Allocator> temporary_allocator_;
+
+  mutable mutex mu_;
+  // The requested sizes of the live buffers of `temporary_allocator_`.
+  absl::flat_hash_map<const void*, size_t> temporaries_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HYBRID_ALLOCATOR_H_
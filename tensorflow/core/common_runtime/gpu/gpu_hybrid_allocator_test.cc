@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include "tensorflow/core/common_runtime/gpu/gpu_hybrid_allocator.h"
+
+#include <memory>
+
+#include "xla/stream_executor/gpu/gpu_init.h"
+#include "xla/tsl/framework/device_id.h"
+#include "tensorflow/core/common_runtime/device/device_mem_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kMemoryLimit = 1 << 30;
+
+std::unique_ptr<GPUBFCAllocator> CreateBFCAllocator(const string& name) {
+  tsl::PlatformDeviceId gpu_id(0);
+  auto sub_allocator = std::make_unique<DeviceMemAllocator>(
+      se::GPUMachineManager()->ExecutorForDevice(gpu_id.value()).value(),
+      gpu_id, stream_executor::MemoryType::kDevice,
+      std::vector<SubAllocator::Visitor>(),
+      std::vector<SubAllocator::Visitor>());
+  return std::make_unique<GPUBFCAllocator>(std::move(sub_allocator),
+                                           kMemoryLimit, name,
+                                           GPUBFCAllocator::Options());
+}
+
+class GPUHybridAllocatorTest : public ::testing::Test {
+ protected:
+  GPUHybridAllocatorTest() {
+    auto bfc_allocator = CreateBFCAllocator("GPU_0_bfc");
+    auto temporary_allocator = CreateBFCAllocator("GPU_0_temporaries");
+    bfc_allocator_ = bfc_allocator.get();
+    temporary_allocator_ = temporary_allocator.get();
+    allocator_ = std::make_unique<GPUHybridAllocator>(
+        std::move(bfc_allocator), std::move(temporary_allocator));
+  }
+
+  GPUBFCAllocator* bfc_allocator_;
+  Allocator* temporary_allocator_;
+  std::unique_ptr<GPUHybridAllocator> allocator_;
+};
+
+TEST_F(GPUHybridAllocatorTest, RoutesTemporariesToTheirPool) {
+  void* tensor = allocator_->AllocateRaw(64, 1024);
+  AllocationAttributes temp_attr;
+  temp_attr.short_lived = true;
+  void* temp = allocator_->AllocateRaw(64, 4096, temp_attr);
+  ASSERT_NE(tensor, nullptr);
+  ASSERT_NE(temp, nullptr);
+
+  EXPECT_EQ(bfc_allocator_->GetStats()->bytes_in_use, 1024);
+  EXPECT_EQ(temporary_allocator_->GetStats()->bytes_in_use, 4096);
+  EXPECT_EQ(allocator_->RequestedSize(temp), 4096);
+  EXPECT_EQ(allocator_->RequestedSize(tensor), 1024);
+
+  auto stats = allocator_->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 2);
+  EXPECT_EQ(stats->bytes_in_use, 1024 + 4096);
+  EXPECT_EQ(stats->largest_alloc_size, 4096);
+  EXPECT_EQ(*stats->bytes_limit, static_cast<int64_t>(2 * kMemoryLimit));
+
+  allocator_->DeallocateRaw(temp);
+  EXPECT_EQ(temporary_allocator_->GetStats()->bytes_in_use, 0);
+  EXPECT_EQ(bfc_allocator_->GetStats()->bytes_in_use, 1024);
+  allocator_->DeallocateRaw(tensor);
+  EXPECT_EQ(bfc_allocator_->GetStats()->bytes_in_use, 0);
+}
+
+TEST(GPUHybridAllocatorFragmentationTest, Fragmentation) {
+  AllocatorStats stats;
+  stats.pool_bytes = 1000;
+  stats.bytes_in_use = 600;
+  stats.largest_free_block_bytes = 400;
+  EXPECT_DOUBLE_EQ(GPUHybridAllocator::Fragmentation(stats), 0.0);
+  stats.largest_free_block_bytes = 100;
+  EXPECT_DOUBLE_EQ(GPUHybridAllocator::Fragmentation(stats), 0.75);
+  stats.bytes_in_use = 1000;
+  EXPECT_DOUBLE_EQ(GPUHybridAllocator::Fragmentation(stats), 0.0);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
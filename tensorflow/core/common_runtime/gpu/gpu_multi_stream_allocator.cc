@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_multi_stream_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The number of deallocated buffers that are held before their deallocation
+// is enqueued, which takes an event per stream.
+constexpr int kMaxPendingBuffers = 64;
+
+thread_local se::Stream* current_stream = nullptr;
+
+}  // namespace
+
+MultiStreamAllocator::MultiStreamAllocator(Allocator* wrapped,
+                                           EventMgr* event_mgr,
+                                           se::Stream* default_stream)
+    : wrapped_(wrapped),
+      event_mgr_(event_mgr),
+      default_stream_(default_stream) {}
+
+MultiStreamAllocator::~MultiStreamAllocator() { Flush(); }
+
+MultiStreamAllocator::ScopedStream::ScopedStream(se::Stream* stream)
+    : saved_stream_(current_stream) {
+  current_stream = stream;
+}
+
+MultiStreamAllocator::ScopedStream::~ScopedStream() {
+  current_stream = saved_stream_;
+}
+
+void MultiStreamAllocator::RecordUse(const void* ptr, se::Stream* stream) {
+  if (ptr == nullptr || stream == default_stream_) return;
+  mutex_lock l(mu_);
+  SideStreams& streams = side_streams_[ptr];
+  if (!absl::c_linear_search(streams, stream)) {
+    streams.push_back(stream);
+    absl::c_sort(streams);
+  }
+}
+
+void* MultiStreamAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) {
+    // Some of the memory may only be waiting for its deallocation to be
+    // enqueued.
+    Flush();
+    ptr = wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  if (current_stream != nullptr) {
+    RecordUse(ptr, current_stream);
+  }
+  return ptr;
+}
+
+void MultiStreamAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  bool flush;
+  {
+    mutex_lock l(mu_);
+    SideStreams streams;
+    auto it = side_streams_.find(ptr);
+    if (it != side_streams_.end()) {
+      streams = std::move(it->second);
+      side_streams_.erase(it);
+    }
+    pending_[streams].push_back(ptr);
+    flush = ++num_pending_ >= kMaxPendingBuffers;
+  }
+  if (flush) Flush();
+}
+
+void MultiStreamAllocator::Flush() {
+  absl::flat_hash_map<SideStreams, std::vector<void*>> pending;
+  {
+    mutex_lock l(mu_);
+    pending.swap(pending_);
+    num_pending_ = 0;
+  }
+  for (auto& [side_streams, buffers] : pending) {
+    // The buffers are deallocated by the last of the callbacks on their
+    // streams.
+    auto batch = std::make_shared<std::vector<void*>>(std::move(buffers));
+    auto remaining =
+        std::make_shared<std::atomic<int>>(side_streams.size() + 1);
+    Allocator* wrapped = wrapped_;
+    auto release = [wrapped, batch, remaining]() {
+      if (remaining->fetch_sub(1) != 1) return;
+      for (void* ptr : *batch) {
+        wrapped->DeallocateRaw(ptr);
+      }
+    };
+    event_mgr_->ThenExecute(default_stream_, release);
+    for (se::Stream* stream : side_streams) {
+      event_mgr_->ThenExecute(stream, release);
+    }
+  }
+}
+
+}  // namespace tensorflow
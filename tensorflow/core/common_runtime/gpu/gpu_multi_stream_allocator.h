@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MULTI_STREAM_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MULTI_STREAM_ALLOCATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "tensorflow/core/common_runtime/device/device_event_mgr.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Wraps the allocator of device memory of a GPU that runs kernels on more than
+// one compute stream.
+//
+// With a single compute stream, a buffer can be reused as soon as it is
+// deallocated, because the work that still reads it is ordered before any work
+// enqueued on the stream by its next owner. That does not hold across streams,
+// so a deallocated buffer is only returned to the wrapped allocator once the
+// compute stream of the device, and the other streams it was used on, have
+// finished the work enqueued on them before.
+class MultiStreamAllocator : public Allocator {
+ public:
+  // Does not take ownership of `wrapped`, `event_mgr` or `default_stream`.
+  MultiStreamAllocator(Allocator* wrapped, EventMgr* event_mgr,
+                       se::Stream* default_stream);
+  ~MultiStreamAllocator() override;
+
+  // Makes the buffers allocated by the calling thread in its scope count as
+  // used on `stream`, which runs the kernel the thread computes.
+  class ScopedStream {
+   public:
+    explicit ScopedStream(se::Stream* stream);
+    ~ScopedStream();
+
+   private:
+    se::Stream* const saved_stream_;
+  };
+
+  // Records that the buffer at `ptr`, which this allocator allocated, is used
+  // on `stream`.
+  void RecordUse(const void* ptr, se::Stream* stream);
+
+  // Enqueues the deallocation of the buffers deallocated so far.
+  void Flush();
+
+  std::string Name() override { return wrapped_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override {
+    return wrapped_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return wrapped_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return wrapped_->AllocatedSize(ptr);
+  }
+  int64_t AllocationId(const void* ptr) const override {
+    return wrapped_->AllocationId(ptr);
+  }
+  size_t AllocatedSizeSlow(const void* ptr) const override {
+    return wrapped_->AllocatedSizeSlow(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped_->GetStats();
+  }
+  bool ClearStats() override { return wrapped_->ClearStats(); }
+  AllocatorMemoryType GetMemoryType() const override {
+    return wrapped_->GetMemoryType();
+  }
+
+ private:
+  // The streams other than `default_stream_` that a buffer was used on.
+  using SideStreams = absl::InlinedVector<se::Stream*, 2>;
+
+  Allocator* const wrapped_;
+  EventMgr* const event_mgr_;
+  se::Stream* const default_stream_;
+
+  mutex mu_;
+  absl::flat_hash_map<const void*, SideStreams> side_streams_
+      TF_GUARDED_BY(mu_);
+  // The buffers deallocated since the last flush, grouped by side streams.
+  absl::flat_hash_map<SideStreams, std::vector<void*>> pending_
+      TF_GUARDED_BY(mu_);
+  int num_pending_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MULTI_STREAM_ALLOCATOR_H_
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -41,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_cudamalloc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_debug_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_hybrid_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -163,8 +165,22 @@ Allocator* GPUProcessState::GetGPUAllocator(
                            total_bytes, peer_gpu_ids);
     SubAllocator* sub_allocator_ptr = sub_allocator.get();
 
+    // The memory cached by the pool of kernel temporaries, if they have one,
+    // which the BFC allocator leaves to it.
+    size_t temporary_pool_bytes = 0;
+#if GOOGLE_CUDA
+    if (options.experimental().temporary_memory_pool_bytes() > 0 &&
+        !UseCudaMemoryGuardAllocator() && !UseCudaMallocAllocator() &&
+        !UseCudaMallocAsyncAllocator() &&
+        !options.experimental().use_cuda_malloc_async()) {
+      temporary_pool_bytes = std::min<size_t>(
+          options.experimental().temporary_memory_pool_bytes(),
+          total_bytes / 2);
+    }
+#endif  // GOOGLE_CUDA
+
     auto gpu_bfc_allocator = std::make_unique<GPUBFCAllocator>(
-        std::move(sub_allocator), total_bytes,
+        std::move(sub_allocator), total_bytes - temporary_pool_bytes,
         strings::StrCat("GPU_", tf_device_id.value(), "_bfc"), [&] {
           GPUBFCAllocator::Options o;
           o.allow_growth = options.allow_growth();
@@ -211,6 +227,21 @@ Allocator* GPUProcessState::GetGPUAllocator(
 #endif
     }
 
+    GPUBFCAllocator* bfc_allocator_ptr = gpu_bfc_allocator.release();
+#if GOOGLE_CUDA
+    if (temporary_pool_bytes > 0) {
+      LOG(INFO) << "Allocating kernel temporaries of GPU "
+                << platform_device_id << " with CUDA malloc Async, caching "
+                << (temporary_pool_bytes >> 20) << " MB.";
+      // `gpu_allocator` is the BFC allocator, which the hybrid takes over.
+      gpu_allocator = new GPUHybridAllocator(
+          absl::WrapUnique(bfc_allocator_ptr),
+          std::make_unique<se::GpuCudaMallocAsyncAllocator>(
+              platform_device_id, /*create_new_pool=*/true,
+              /*new_pool_size=*/temporary_pool_bytes));
+    }
+#endif  // GOOGLE_CUDA
+
     Allocator* recording_allocator = nullptr;
     if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
       ProcessState::MemDesc md;
@@ -225,14 +256,14 @@ Allocator* GPUProcessState::GetGPUAllocator(
     // Owning allocator is not set if `allocator_not_owned` is set.
     allocator_parts.allocator_not_owned = gpu_allocator;
     allocator_parts.counter.reset(timing_counter);
-    allocator_parts.bfc_allocator = gpu_bfc_allocator.release();
+    allocator_parts.bfc_allocator = bfc_allocator_ptr;
     allocator_parts.sub_allocator = sub_allocator_ptr;
     allocator_parts.recording_allocator.reset(recording_allocator);
 #else
     allocator_parts = {
         std::unique_ptr<Allocator>(gpu_allocator),
         std::unique_ptr<SharedCounter>(timing_counter),
-        gpu_bfc_allocator.release(),
+        bfc_allocator_ptr,
         sub_allocator_ptr,
         std::unique_ptr<Allocator>(recording_allocator),
     };
@@ -67,6 +67,44 @@ TEST(GpuServingDeviceSelector, Basic) {
   EXPECT_EQ(reservation.device_index(), 0);
 }
 
+TEST(GpuServingDeviceSelector, LeastLoadedPolicy) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(/*num_devices=*/2,
+                                    std::make_unique<tsl::LeastLoadedPolicy>());
+  helper.ElapseNs(1e6);
+
+  // Learn the execution times of a slow and a fast program.
+  selector.Enqueue(0, "slow");
+  selector.Enqueue(1, "fast");
+  helper.ElapseNs(2e6);
+  selector.Completed(1, false);
+  helper.ElapseNs(14e6);
+  selector.Completed(0, false);
+
+  // Device 0 has one 16ms program queued and device 1 two 2ms programs.
+  selector.Enqueue(0, "slow");
+  selector.Enqueue(1, "fast");
+  selector.Enqueue(1, "fast");
+  tsl::DeviceReservation reservation = selector.ReserveDevice("fast");
+  EXPECT_EQ(reservation.device_index(), 1);
+}
+
+TEST(GpuServingDeviceSelector, LeastLoadedPolicyPrefersShorterQueue) {
+  GpuServingDeviceSelector selector(/*num_devices=*/2,
+                                    std::make_unique<tsl::LeastLoadedPolicy>());
+  const std::string program_fingerprint = "TensorFlow";
+
+  tsl::DeviceReservation first = selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(first.device_index(), 0);
+  tsl::DeviceReservation second = selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(second.device_index(), 1);
+
+  // Device 1 is idle again while device 0 is still busy.
+  second.reset();
+  tsl::DeviceReservation third = selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(third.device_index(), 1);
+}
+
 TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
   ServingDeviceSelectorTestHelper helper;
   auto policy = std::make_unique<tsl::RoundRobinPolicy>();
@@ -0,0 +1,180 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include "tensorflow/core/common_runtime/gpu/gpu_step_capture.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "xla/stream_executor/trace_command_buffer_factory.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_device.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stream_executor.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Enqueues a copy of the `num_bytes` bytes of device memory at `src` to `dst`.
+Status CopyOnDevice(se::Stream* stream, void* src, void* dst,
+                    size_t num_bytes) {
+  if (num_bytes == 0) return OkStatus();
+  se::DeviceMemoryBase dst_memory(dst, num_bytes);
+  return stream->MemcpyD2D(&dst_memory, se::DeviceMemoryBase(src, num_bytes),
+                           num_bytes);
+}
+
+}  // namespace
+
+GpuStepCapture::RetainingAllocator::~RetainingAllocator() {
+  for (void* ptr : buffers_) {
+    wrapped_->DeallocateRaw(ptr);
+  }
+}
+
+void* GpuStepCapture::RetainingAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = wrapped_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    buffers_.push_back(ptr);
+  }
+  return ptr;
+}
+
+GpuStepCapture::GpuStepCapture(BaseGPUDevice* device)
+    : device_(device),
+      allocator_(std::make_unique<RetainingAllocator>(
+          device->GetAllocator(AllocatorAttributes()))) {}
+
+// Replays may still be pending on the compute stream when the buffers of the
+// step are released. As for the tensors of the executor, that is safe because
+// the buffers are only reused by work enqueued on the stream afterwards.
+GpuStepCapture::~GpuStepCapture() = default;
+
+Status GpuStepCapture::Capture(const std::vector<Tensor>& feeds,
+                               const StepFn& step,
+                               std::vector<Tensor>* fetches) {
+  DCHECK(command_buffer_ == nullptr) << "A step was already captured";
+  inputs_.reserve(feeds.size());
+  for (const Tensor& feed : feeds) {
+    if (!DataTypeCanUseMemcpy(feed.dtype())) {
+      return errors::Unimplemented("Can't capture a step fed with ",
+                                   DataTypeString(feed.dtype()));
+    }
+    inputs_.emplace_back(allocator_.get(), feed.dtype(), feed.shape());
+    if (!inputs_.back().IsInitialized()) {
+      return errors::ResourceExhausted("OOM when allocating a feed of shape ",
+                                       feed.shape().DebugString());
+    }
+  }
+  TF_RETURN_IF_ERROR(CopyFeeds(feeds));
+
+  // The step enqueues its work from the threads of the executor, while this
+  // thread waits for it in `step`.
+  Status step_status;
+  std::vector<Tensor> outputs;
+  device_->BeginStepCapture(allocator_.get());
+  auto command_buffer = se::TraceCommandBufferFactory::Create(
+      device_->executor(), device_->compute_stream(),
+      [&](se::Stream*) {
+        step_status = step(inputs_, &outputs);
+        return step_status;
+      },
+      se::CommandBuffer::Mode::kPrimary);
+  const int held_callbacks = device_->EndStepCapture();
+  TF_RETURN_IF_ERROR(step_status);
+  TF_RETURN_IF_ERROR(command_buffer.status());
+  // A device created since CreateStepCapture() may have enqueued work on the
+  // compute stream, which the graph would replay.
+  if (device_->SharesComputeStream()) {
+    return errors::Unavailable(
+        "The compute stream was shared while the step was captured");
+  }
+  // A callback, e.g. the one releasing a staging buffer of a copy from the
+  // host, would have to run after every replay.
+  if (held_callbacks > 0) {
+    return errors::Unimplemented("The step waits for ", held_callbacks,
+                                 " host callbacks on the compute stream");
+  }
+  for (const Tensor& output : outputs) {
+    if (!DataTypeCanUseMemcpy(output.dtype())) {
+      return errors::Unimplemented("Can't capture a step fetching ",
+                                   DataTypeString(output.dtype()));
+    }
+  }
+  outputs_ = std::move(outputs);
+  command_buffer_ = std::move(command_buffer).value();
+
+  // Recording the step did not run it.
+  return Replay(feeds, fetches);
+}
+
+Status GpuStepCapture::Replay(const std::vector<Tensor>& feeds,
+                              std::vector<Tensor>* fetches) {
+  se::Stream* stream = device_->compute_stream();
+  TF_RETURN_IF_ERROR(CopyFeeds(feeds));
+  TF_RETURN_IF_ERROR(command_buffer_->Submit(stream));
+
+  // The next replay overwrites the outputs of the step.
+  Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+  fetches->clear();
+  fetches->reserve(outputs_.size());
+  for (const Tensor& output : outputs_) {
+    Tensor fetch(allocator, output.dtype(), output.shape());
+    if (!fetch.IsInitialized()) {
+      return errors::ResourceExhausted("OOM when allocating a fetch of shape ",
+                                       output.shape().DebugString());
+    }
+    TF_RETURN_IF_ERROR(
+        CopyOnDevice(stream, output.data(), fetch.data(), output.TotalBytes()));
+    fetches->push_back(std::move(fetch));
+  }
+  return OkStatus();
+}
+
+Status GpuStepCapture::CopyFeeds(const std::vector<Tensor>& feeds) {
+  if (feeds.size() != inputs_.size()) {
+    return errors::InvalidArgument("Expected ", inputs_.size(),
+                                   " feeds for the captured step, got ",
+                                   feeds.size());
+  }
+  se::Stream* stream = device_->compute_stream();
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    const Tensor& feed = feeds[i];
+    Tensor& input = inputs_[i];
+    if (feed.dtype() != input.dtype() || feed.shape() != input.shape()) {
+      return errors::InvalidArgument(
+          "Feed ", i, " is a ", DataTypeString(feed.dtype()),
+          " tensor of shape ", feed.shape().DebugString(),
+          ", but the step was captured with a ",
+          DataTypeString(input.dtype()), " tensor of shape ",
+          input.shape().DebugString());
+    }
+    TF_RETURN_IF_ERROR(
+        CopyOnDevice(stream, feed.data(), input.data(), input.TotalBytes()));
+  }
+  return OkStatus();
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,90 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STEP_CAPTURE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STEP_CAPTURE_H_
+
+#include <memory>
+#include <vector>
+
+#include "xla/stream_executor/command_buffer.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+class BaseGPUDevice;
+
+// Records the work that a step enqueues on the compute stream of a GPU into a
+// CUDA graph, and replays the graph on new feeds.
+//
+// The graph refers to the buffers of the step by address, so the feeds are
+// copied into buffers owned by this object before every replay, the fetches
+// are copied out of the buffers of the recorded step after it, and all the
+// device memory allocated while recording is only released with this object.
+class GpuStepCapture : public DeviceStepCapture {
+ public:
+  explicit GpuStepCapture(BaseGPUDevice* device);
+  ~GpuStepCapture() override;
+
+  Status Capture(const std::vector<Tensor>& feeds, const StepFn& step,
+                 std::vector<Tensor>* fetches) override;
+
+  Status Replay(const std::vector<Tensor>& feeds,
+                std::vector<Tensor>* fetches) override;
+
+ private:
+  // Allocates the device memory of the recorded step and keeps it until it is
+  // destroyed.
+  class RetainingAllocator : public Allocator {
+   public:
+    explicit RetainingAllocator(Allocator* wrapped) : wrapped_(wrapped) {}
+    ~RetainingAllocator() override;
+
+    std::string Name() override { return wrapped_->Name(); }
+    void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+      return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+    }
+    void* AllocateRaw(size_t alignment, size_t num_bytes,
+                      const AllocationAttributes& allocation_attr) override;
+    void DeallocateRaw(void* ptr) override {}
+    AllocatorMemoryType GetMemoryType() const override {
+      return wrapped_->GetMemoryType();
+    }
+
+   private:
+    Allocator* const wrapped_;
+    mutex mu_;
+    std::vector<void*> buffers_ TF_GUARDED_BY(mu_);
+  };
+
+  // Copies `feeds` into `inputs_` on the compute stream.
+  Status CopyFeeds(const std::vector<Tensor>& feeds);
+
+  BaseGPUDevice* const device_;  // not owned
+  // Declared before the tensors of the step, which it outlives.
+  std::unique_ptr<RetainingAllocator> allocator_;
+  std::vector<Tensor> inputs_;
+  std::vector<Tensor> outputs_;
+  std::unique_ptr<se::CommandBuffer> command_buffer_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STEP_CAPTURE_H_
@@ -0,0 +1,76 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_assignment.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/core/graph/algorithm.h"
+
+namespace tensorflow {
+
+std::vector<ComputeStreamAssignment> AssignComputeStreams(
+    const Graph& graph, int num_streams,
+    const std::function<bool(const Node*)>& can_use_any_stream) {
+  std::vector<ComputeStreamAssignment> assignments(graph.num_node_ids());
+  if (num_streams <= 1) return assignments;
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+
+  // Whether a consumer of the node already runs on its stream.
+  std::vector<bool> continued(graph.num_node_ids(), false);
+  std::vector<int64_t> num_nodes(num_streams, 0);
+  for (const Node* node : order) {
+    if (!node->IsOp()) continue;
+    int& stream = assignments[node->id()].stream;
+    if (can_use_any_stream(node)) {
+      stream = -1;
+      for (const Edge* edge : node->in_edges()) {
+        const Node* src = edge->src();
+        if (edge->IsControlEdge() || !src->IsOp() || continued[src->id()]) {
+          continue;
+        }
+        continued[src->id()] = true;
+        stream = assignments[src->id()].stream;
+        break;
+      }
+      if (stream < 0) {
+        stream = absl::c_min_element(num_nodes) - num_nodes.begin();
+      }
+    }
+    ++num_nodes[stream];
+  }
+
+  // Back edges of loops are only seen now that all the nodes have a stream.
+  for (const Node* node : graph.op_nodes()) {
+    ComputeStreamAssignment& assignment = assignments[node->id()];
+    for (const Edge* edge : node->in_edges()) {
+      if (!edge->src()->IsOp()) continue;
+      const int src_stream = assignments[edge->src()->id()].stream;
+      if (src_stream != assignment.stream &&
+          !absl::c_linear_search(assignment.wait_streams, src_stream)) {
+        assignment.wait_streams.push_back(src_stream);
+      }
+    }
+    absl::c_sort(assignment.wait_streams);
+  }
+  return assignments;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ASSIGNMENT_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ASSIGNMENT_H_
+
+#include <functional>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// The compute stream that a node of a partition graph runs on.
+struct ComputeStreamAssignment {
+  // In [0, num_streams). Stream 0 is the compute stream of the device.
+  int stream = 0;
+  // The other streams, in increasing order, that run nodes the node consumes
+  // outputs of or has control dependencies on. Before it runs, its stream must
+  // wait for the work enqueued on them so far.
+  absl::InlinedVector<int, 2> wait_streams;
+};
+
+// Assigns the nodes of `graph`, indexed by node id, to `num_streams` compute
+// streams so that independent branches of the graph run on different streams.
+// A node continues the stream of the first of its producers that no other
+// node has continued yet, and otherwise starts a branch on the stream with the
+// fewest nodes. The nodes for which `can_use_any_stream` returns false run on
+// stream 0.
+std::vector<ComputeStreamAssignment> AssignComputeStreams(
+    const Graph& graph, int num_streams,
+    const std::function<bool(const Node*)>& can_use_any_stream);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_ASSIGNMENT_H_
@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_assignment.h"
+
+#include <vector>
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Builds two branches of two ops from one input, joined by `join`.
+class AssignComputeStreamsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Scope root = Scope::NewRootScope();
+    auto x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT);
+    auto a = ops::Square(root.WithOpName("a"), x);
+    auto b = ops::Neg(root.WithOpName("b"), x);
+    auto a2 = ops::Exp(root.WithOpName("a2"), a);
+    auto b2 = ops::Exp(root.WithOpName("b2"), b);
+    auto join = ops::Add(root.WithOpName("join"), a2, b2);
+    TF_ASSERT_OK(root.ToGraph(&graph_));
+  }
+
+  const ComputeStreamAssignment& Get(
+      const std::vector<ComputeStreamAssignment>& assignments,
+      const string& name) {
+    for (const Node* node : graph_.op_nodes()) {
+      if (node->name() == name) return assignments[node->id()];
+    }
+    LOG(FATAL) << "No node " << name;
+  }
+
+  Graph graph_{OpRegistry::Global()};
+};
+
+TEST_F(AssignComputeStreamsTest, OneStream) {
+  auto assignments = AssignComputeStreams(
+      graph_, 1, [](const Node*) { return true; });
+  for (const Node* node : graph_.op_nodes()) {
+    EXPECT_EQ(assignments[node->id()].stream, 0);
+    EXPECT_THAT(assignments[node->id()].wait_streams, IsEmpty());
+  }
+}
+
+TEST_F(AssignComputeStreamsTest, BranchesRunOnDifferentStreams) {
+  auto assignments = AssignComputeStreams(
+      graph_, 2, [](const Node*) { return true; });
+  const int x = Get(assignments, "x").stream;
+  const int a = Get(assignments, "a").stream;
+  const int b = Get(assignments, "b").stream;
+  EXPECT_NE(a, b);
+  EXPECT_TRUE(a == x || b == x);
+  EXPECT_EQ(Get(assignments, "a2").stream, a);
+  EXPECT_EQ(Get(assignments, "b2").stream, b);
+
+  // Each branch only waits for the input if it runs on another stream.
+  const ComputeStreamAssignment& start = a == x ? Get(assignments, "b")
+                                                : Get(assignments, "a");
+  EXPECT_THAT(start.wait_streams, ElementsAre(x));
+  EXPECT_THAT(Get(assignments, "a2").wait_streams, IsEmpty());
+  EXPECT_THAT(Get(assignments, "b2").wait_streams, IsEmpty());
+
+  // The join continues one branch and waits for the other.
+  const ComputeStreamAssignment& join = Get(assignments, "join");
+  EXPECT_TRUE(join.stream == a || join.stream == b);
+  EXPECT_THAT(join.wait_streams, ElementsAre(join.stream == a ? b : a));
+}
+
+TEST_F(AssignComputeStreamsTest, PinnedNodesRunOnStreamZero) {
+  auto assignments =
+      AssignComputeStreams(graph_, 3, [](const Node* node) {
+        return node->name() != "x" && node->name() != "join";
+      });
+  EXPECT_EQ(Get(assignments, "x").stream, 0);
+  EXPECT_EQ(Get(assignments, "join").stream, 0);
+  const int a = Get(assignments, "a").stream;
+  const int b = Get(assignments, "b").stream;
+  EXPECT_NE(a, b);
+
+  // The join waits for both branches, unless one of them runs on stream 0.
+  std::vector<int> expected_waits;
+  for (int stream : {a, b}) {
+    if (stream != 0) expected_waits.push_back(stream);
+  }
+  EXPECT_THAT(Get(assignments, "join").wait_streams,
+              ::testing::UnorderedElementsAreArray(expected_waits));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <utility>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -60,6 +62,15 @@ class GPUDeviceContext : public DeviceContext {
     return device_to_device_stream_[index % device_to_device_stream_.size()];
   }
   int stream_id() const { return stream_id_; }
+
+  // The other compute streams, whose work enqueued so far the kernels run in
+  // this context must wait for before they enqueue theirs on stream().
+  const absl::InlinedVector<se::Stream*, 2UL>& wait_streams() const {
+    return wait_streams_;
+  }
+  void set_wait_streams(absl::InlinedVector<se::Stream*, 2UL> wait_streams) {
+    wait_streams_ = std::move(wait_streams);
+  }
   Allocator* host_memory_allocator() const override {
     return host_memory_allocator_;
   }
@@ -100,6 +111,8 @@ class GPUDeviceContext : public DeviceContext {
   // The allocator to use for allocating pinned host memory.
   // Not owned.
   Allocator* host_memory_allocator_;
+  // Not owned.
+  absl::InlinedVector<se::Stream*, 2UL> wait_streams_;
 };
 
 }  // namespace tensorflow
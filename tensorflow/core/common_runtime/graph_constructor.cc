@@ -53,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -107,7 +108,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -162,6 +164,10 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // If not null, and not `importing`, NodeDefs are prepared in parallel on
+    // this thread pool. Not owned.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef absl::Span<const NodeDef* const> NodeDefSlice;
@@ -243,6 +249,12 @@ class GraphConstructor {
            const std::vector<absl::string_view>& node_names);
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
+  // Looks up the op of `node_def`, adds default attributes to it and validates
+  // it, as configured in `opts_`. Does not depend on other nodes.
+  Status PrepareNodeDef(NodeDef* node_def) const;
+  // Consumes all the NodeDefs into `*node_defs` and prepares them in parallel
+  // on `opts_.thread_pool`.
+  Status PrepareNodeDefsInParallel(std::vector<NodeDef>* node_defs);
   Status MakeNode(NodeDef&& node_def, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
@@ -802,6 +814,50 @@ Status GraphConstructor::ValidateColocationConstraints(
   return absl::OkStatus();
 }
 
+Status GraphConstructor::PrepareNodeDef(NodeDef* node_def) const {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
+  }
+  return absl::OkStatus();
+}
+
+Status GraphConstructor::PrepareNodeDefsInParallel(
+    std::vector<NodeDef>* node_defs) {
+  const int num_node_defs = node_def_count();
+  node_defs->reserve(num_node_defs);
+  for (int i = 0; i < num_node_defs; ++i) {
+    node_defs->push_back(consume_node_def(i));
+  }
+
+  // Report the error of the first invalid node, as the serial path would for
+  // a graph in which the nodes are already in topological order.
+  mutex mu;
+  int first_error_index = num_node_defs;
+  Status first_error;
+  // Rough cost of preparing one NodeDef, in cycles.
+  constexpr int64_t kCostPerNodeDef = 10000;
+  opts_.thread_pool->ParallelFor(
+      num_node_defs, kCostPerNodeDef, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          Status s = PrepareNodeDef(&(*node_defs)[i]);
+          if (TF_PREDICT_FALSE(!s.ok())) {
+            mutex_lock l(mu);
+            if (i < first_error_index) {
+              first_error_index = i;
+              first_error = std::move(s);
+            }
+            return;
+          }
+        }
+      });
+  return first_error;
+}
+
 Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   // Add the node to the graph.
   Status status;
@@ -1185,6 +1241,16 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // The op lookup and validation of the nodes do not depend on each other, so
+  // for large graphs they can be done up front on a thread pool.
+  constexpr int kMinNodeDefsToPrepareInParallel = 1024;
+  std::vector<NodeDef> prepared_node_defs;
+  const bool prepared = !opts_.importing && opts_.thread_pool != nullptr &&
+                        node_def_count() >= kMinNodeDefsToPrepareInParallel;
+  if (prepared) {
+    TF_RETURN_IF_ERROR(PrepareNodeDefsInParallel(&prepared_node_defs));
+  }
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1201,7 +1267,8 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    NodeDef node_def =
+        prepared ? std::move(prepared_node_defs[o]) : consume_node_def(o);
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1297,16 +1364,8 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
-      if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
-      }
+    } else if (!prepared) {
+      TF_RETURN_IF_ERROR(PrepareNodeDef(&node_def));
     }
 
     TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
@@ -1352,7 +1411,9 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        LOG(WARNING) << "PENDING: "
+                     << SummarizeNodeDef(prepared ? prepared_node_defs[i]
+                                                  : get_node_def(i))
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
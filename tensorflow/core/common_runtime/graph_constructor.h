@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 class ShapeRefiner;
@@ -52,6 +53,11 @@ struct GraphConstructorOptions {
   // If true, GraphConstructor will add attributes with their default
   // value to the Node when they are missing from the NodeDef.
   bool add_default_attributes = true;
+
+  // If not null, the op lookup, default attribute and validation steps for
+  // large graphs are done for all nodes in parallel on this thread pool,
+  // before the nodes are added to the graph. Not owned.
+  thread::ThreadPool* thread_pool = nullptr;
 };
 extern Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                      const GraphDef& gdef, Graph* g);
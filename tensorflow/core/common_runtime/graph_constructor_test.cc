@@ -29,10 +29,12 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
@@ -898,6 +900,61 @@ TEST_F(GraphConstructorTest, SimpleModel) {
   EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
 }
 
+// Returns a GraphDef with `num_nodes` nodes: a chain of `TestMul` nodes, and
+// a `TestDefaultAttr` node, which has a default attribute.
+GraphDef MakeLargeGraphDef(int num_nodes) {
+  GraphDef gdef;
+  NodeDef* params = gdef.add_node();
+  params->set_name("W1");
+  params->set_op("TestParams");
+  NodeDef* default_attr = gdef.add_node();
+  default_attr->set_name("default_attr");
+  default_attr->set_op("TestDefaultAttr");
+  string prev = "W1";
+  for (int i = 2; i < num_nodes; ++i) {
+    NodeDef* mul = gdef.add_node();
+    mul->set_name(strings::StrCat("mul", i));
+    mul->set_op("TestMul");
+    mul->add_input(prev);
+    mul->add_input("W1");
+    prev = mul->name();
+  }
+  return gdef;
+}
+
+TEST_F(GraphConstructorTest, PrepareNodeDefsInParallel) {
+  constexpr int kNumNodes = 4096;
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  opts.thread_pool = &pool;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, MakeLargeGraphDef(kNumNodes),
+                                      &graph_));
+  EXPECT_EQ(graph_.num_op_nodes(), kNumNodes);
+  EXPECT_TRUE(HasEdge("W1", 0, "mul2", 0));
+  EXPECT_TRUE(HasEdge(strings::StrCat("mul", kNumNodes - 2), 0,
+                      strings::StrCat("mul", kNumNodes - 1), 0));
+  Node* default_attr = FindNode("default_attr");
+  ASSERT_NE(default_attr, nullptr);
+  int value = 0;
+  TF_ASSERT_OK(GetNodeAttr(default_attr->attrs(), "default_int", &value));
+  EXPECT_EQ(value, 31415);
+}
+
+TEST_F(GraphConstructorTest, PrepareNodeDefsInParallelError) {
+  constexpr int kNumNodes = 4096;
+  GraphDef gdef = MakeLargeGraphDef(kNumNodes);
+  gdef.mutable_node(kNumNodes / 2)->set_op("NoSuchOp");
+  gdef.mutable_node(kNumNodes - 1)->set_op("NoSuchOpEither");
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  GraphConstructorOptions opts;
+  opts.thread_pool = &pool;
+  Status s = ConvertGraphDefToGraph(opts, std::move(gdef), &graph_);
+  EXPECT_FALSE(s.ok());
+  EXPECT_TRUE(absl::StrContains(s.message(), "NoSuchOp"));
+  EXPECT_FALSE(absl::StrContains(s.message(), "NoSuchOpEither"));
+}
+
 TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   ExpectOK(
       "node { name: 'W1' op: 'TestParams' }"
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
@@ -69,6 +70,46 @@ bool IsCollectiveV2(const string& op) {
          op == "CollectiveBcastRecvV2" || op == "CollectiveBcastSendV2" ||
          op == "ColectiveReduceScatterV2" || op == "ColectiveAllToAllV2";
 }
+
+// Returns the sorted tensor names fed by the signature in `options`.
+std::vector<string> SortedFeeds(const BuildGraphOptions& options) {
+  std::vector<string> feeds(options.callable_options.feed().begin(),
+                            options.callable_options.feed().end());
+  for (const TensorConnection& tensor_connection :
+       options.callable_options.tensor_connection()) {
+    feeds.push_back(tensor_connection.to_tensor());
+  }
+  std::sort(feeds.begin(), feeds.end());
+  return feeds;
+}
+
+// Returns the sorted, unique names of the nodes fetched or targeted by the
+// signature in `options`.
+std::vector<string> SortedPreservedNodes(const BuildGraphOptions& options) {
+  std::vector<string> nodes;
+  for (const string& fetch : options.callable_options.fetch()) {
+    nodes.emplace_back(ParseTensorName(fetch).node());
+  }
+  for (const string& target : options.callable_options.target()) {
+    nodes.push_back(target);
+  }
+  for (const TensorConnection& tensor_connection :
+       options.callable_options.tensor_connection()) {
+    nodes.emplace_back(ParseTensorName(tensor_connection.from_tensor()).node());
+  }
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  return nodes;
+}
+
+// Copies an optimized graph, including the function library that it was
+// converted with, which `CopyGraph()` does not copy.
+Status CopyOptimizedGraph(const Graph& graph, std::unique_ptr<Graph>* copy) {
+  *copy = std::make_unique<Graph>(OpRegistry::Global());
+  TF_RETURN_IF_ERROR((*copy)->AddFunctionLibrary(graph.flib_def().ToProto()));
+  CopyGraph(graph, copy->get());
+  return absl::OkStatus();
+}
 }  // namespace
 
 GraphExecutionState::GraphExecutionState(
@@ -856,6 +897,57 @@ Status GraphExecutionState::OptimizeGraph(
 #endif  // IS_MOBILE_PLATFORM
 }
 
+bool GraphExecutionState::LookupOptimizedGraph(
+    const BuildGraphOptions& options, std::unique_ptr<Graph>* optimized_graph,
+    std::unique_ptr<FunctionLibraryDefinition>* optimized_flib) {
+  const std::vector<string> feeds = SortedFeeds(options);
+  const std::vector<string> preserved_nodes = SortedPreservedNodes(options);
+  mutex_lock l(optimized_graph_cache_mu_);
+  // Prefer the most recent entries, which are more likely to be for
+  // signatures that are still in use.
+  for (auto it = optimized_graph_cache_.rbegin();
+       it != optimized_graph_cache_.rend(); ++it) {
+    // Grappler keeps the fanin of the preserved nodes given the feeds, so an
+    // entry computes every node of a signature with the same feeds whose
+    // preserved nodes are a subset of the entry's. `PruneGraph()` then
+    // removes the nodes that this signature does not need.
+    if (it->feeds != feeds ||
+        !std::includes(it->preserved_nodes.begin(), it->preserved_nodes.end(),
+                       preserved_nodes.begin(), preserved_nodes.end())) {
+      continue;
+    }
+    Status s = CopyOptimizedGraph(*it->graph, optimized_graph);
+    if (!s.ok()) {
+      VLOG(2) << "Failed to copy a cached optimized graph: " << s;
+      return false;
+    }
+    VLOG(1) << "Reusing the optimized graph of a previous signature";
+    *optimized_flib =
+        std::make_unique<FunctionLibraryDefinition>(*it->flib_def);
+    return true;
+  }
+  return false;
+}
+
+void GraphExecutionState::SaveOptimizedGraph(
+    const BuildGraphOptions& options, const Graph& optimized_graph,
+    const FunctionLibraryDefinition& optimized_flib) {
+  OptimizedGraphCacheEntry entry;
+  entry.feeds = SortedFeeds(options);
+  entry.preserved_nodes = SortedPreservedNodes(options);
+  Status s = CopyOptimizedGraph(optimized_graph, &entry.graph);
+  if (!s.ok()) {
+    VLOG(2) << "Failed to cache an optimized graph: " << s;
+    return;
+  }
+  entry.flib_def = std::make_unique<FunctionLibraryDefinition>(optimized_flib);
+  mutex_lock l(optimized_graph_cache_mu_);
+  if (optimized_graph_cache_.size() >= kMaxOptimizedGraphCacheEntries) {
+    optimized_graph_cache_.erase(optimized_graph_cache_.begin());
+  }
+  optimized_graph_cache_.push_back(std::move(entry));
+}
+
 Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
                                        std::unique_ptr<ClientGraph>* out) {
   VLOG(1) << "BuildGraph";
@@ -872,12 +964,28 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
   std::unique_ptr<Graph> optimized_graph;
   std::unique_ptr<FunctionLibraryDefinition> optimized_flib;
 
-  Status s = OptimizeGraph(options, *graph_, flib_def_.get(), &optimized_graph,
-                           &optimized_flib);
-  if (!s.ok()) {
-    VLOG(2) << "Grappler optimization failed. Error: " << s.message();
+  const bool reuse_optimized_graphs =
+      session_options_ != nullptr &&
+      session_options_->config.experimental()
+          .reuse_optimized_graphs_across_signatures();
+  Status s;
+  if (!options.optimize_graph) {
+    VLOG(2) << "Skipping Grappler optimization.";
+  } else if (!reuse_optimized_graphs ||
+             !LookupOptimizedGraph(options, &optimized_graph,
+                                   &optimized_flib)) {
+    s = OptimizeGraph(options, *graph_, flib_def_.get(), &optimized_graph,
+                      &optimized_flib);
+    if (s.ok() && reuse_optimized_graphs) {
+      SaveOptimizedGraph(options, *optimized_graph, *optimized_flib);
+    }
+  }
+  if (!options.optimize_graph || !s.ok()) {
+    if (!s.ok()) {
+      VLOG(2) << "Grappler optimization failed. Error: " << s.message();
+    }
     // Simply copy the original graph and the function library if we couldn't
-    // optimize it.
+    // or weren't asked to optimize it.
     optimized_graph.reset(new Graph(flib_def_.get()));
     CopyGraph(*graph_, optimized_graph.get());
     optimized_flib = std::make_unique<FunctionLibraryDefinition>(*flib_def_);
@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -198,6 +200,33 @@ class GraphExecutionState {
   Status PruneGraph(const BuildGraphOptions& options, Graph* graph,
                     subgraph::RewriteGraphMetadata* out_rewrite_metadata);
 
+  // A Grappler result saved for reuse by `BuildGraph()` calls for other
+  // feed/fetch signatures.
+  struct OptimizedGraphCacheEntry {
+    // The sorted tensor names fed by the signature that was optimized.
+    std::vector<string> feeds;
+    // The sorted names of the nodes that the optimized signature fetches or
+    // targets. Grappler preserves these nodes.
+    std::vector<string> preserved_nodes;
+    std::unique_ptr<Graph> graph;
+    std::unique_ptr<FunctionLibraryDefinition> flib_def;
+  };
+
+  // Maximum number of entries in `optimized_graph_cache_`.
+  static constexpr int kMaxOptimizedGraphCacheEntries = 8;
+
+  // If the optimized graph saved for a previous signature can be used for the
+  // signature in `options`, i.e. it has the same feeds and preserves all the
+  // nodes that `options` fetches or targets, sets `*optimized_graph` and
+  // `*optimized_flib` to copies of it and returns true.
+  bool LookupOptimizedGraph(
+      const BuildGraphOptions& options, std::unique_ptr<Graph>* optimized_graph,
+      std::unique_ptr<FunctionLibraryDefinition>* optimized_flib);
+  // Saves a copy of the optimized graph for the signature in `options`.
+  void SaveOptimizedGraph(const BuildGraphOptions& options,
+                          const Graph& optimized_graph,
+                          const FunctionLibraryDefinition& optimized_flib);
+
   // The GraphExecutionState must store a copy of the original GraphDef if
   // either of the following conditions holds:
   //
@@ -228,6 +257,13 @@ class GraphExecutionState {
   // Whether to run Placer.
   bool run_placer_;
 
+  // Grappler results for recently built signatures, most recent last. Only
+  // used if `session_options_->config.experimental()
+  // .reuse_optimized_graphs_across_signatures()` is true.
+  mutex optimized_graph_cache_mu_;
+  std::vector<OptimizedGraphCacheEntry> optimized_graph_cache_
+      TF_GUARDED_BY(optimized_graph_cache_mu_);
+
   GraphExecutionState(const GraphExecutionState&) = delete;
   void operator=(const GraphExecutionState&) = delete;
 };
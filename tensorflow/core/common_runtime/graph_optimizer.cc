@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 
 #include "tensorflow/core/common_runtime/constant_folding.h"
+#include "tensorflow/core/common_runtime/constant_folding_cache.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/inline_function_utils.h"
@@ -79,6 +80,9 @@ void GraphOptimizer::Optimize(FunctionLibraryRuntime* runtime, Env* env,
         cf_opts.max_constant_size_in_bytes =
             opts_.max_folded_constant_in_bytes();
       }
+      if (opts_.cache_constant_folding_results()) {
+        cf_opts.cache = ConstantFoldingCache::Global();
+      }
       bool was_mutated;
       ConstantFold(cf_opts, runtime, env, device, g, &was_mutated)
           .IgnoreError();
@@ -0,0 +1,346 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+enum Phase {
+  kLocalReduceScatter = 0,
+  kCrossTaskReduceScatter,
+  kCrossTaskAllGather,
+  kLocalAllGather,
+};
+
+int Mod(int x, int n) { return ((x % n) + n) % n; }
+
+string HierarchicalRingBufKey(const string& exec_key, int phase, int step,
+                              int piece, int source_member) {
+  return strings::StrCat(exec_key, ":", phase, ":", step, ":", piece, ":",
+                         source_member);
+}
+
+}  // namespace
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalRingReduce");
+  // Precondition: members are sorted so that all devices in the same task are
+  // adjacent, in ring order.
+  std::vector<std::vector<int>>& perms =
+      col_params->instance.impl_details.subdiv_permutations;
+  perms.clear();
+  for (int mi = 0; mi < col_params->group.group_size; ++mi) {
+    if (mi == 0 || col_params->group.members[mi].task !=
+                       col_params->group.members[mi - 1].task) {
+      perms.emplace_back();
+    }
+    perms.back().push_back(mi);
+  }
+  for (const std::vector<int>& perm : perms) {
+    if (perm.size() != perms[0].size()) {
+      return errors::InvalidArgument(
+          "HierarchicalRingReduce requires the same number of devices on "
+          "every task, got ",
+          perms[0].size(), " and ", perm.size(), " devices in group ",
+          col_params->group.group_key);
+    }
+  }
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  Status s = RunBlocking();
+  pieces_.clear();  // Give up Refs on output tensor.
+  tmp_pieces_.clear();
+  done(s);
+}
+
+Status HierarchicalRingReducer::RunBlocking() {
+  const std::vector<std::vector<int>>& perms =
+      col_params_->instance.impl_details.subdiv_permutations;
+  num_tasks_ = perms.size();
+  devices_per_task_ = perms[0].size();
+  const int T = num_tasks_;
+  const int L = devices_per_task_;
+  int t = -1, l = -1;
+  for (int ti = 0; ti < T; ++ti) {
+    auto it = std::find(perms[ti].begin(), perms[ti].end(),
+                        col_params_->default_rank);
+    if (it != perms[ti].end()) {
+      t = ti;
+      l = it - perms[ti].begin();
+    }
+  }
+  if (t < 0) {
+    return errors::Internal("Device ", col_ctx_->device_name,
+                            " not found in the subdiv permutations.");
+  }
+
+  // Copy input to output if they're not already the same.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    tsl::profiler::TraceMe activity("MemCpyAsync",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, L * T,
+                                  col_ctx_->device->GetAllocator(attr)));
+  pieces_.resize(L * T);
+  tmp_pieces_.resize(L * T);
+  for (int p = 0; p < L * T; ++p) {
+    pieces_[p] = ca_->ChunkAlias(p);
+  }
+  if (col_params_->final_op) {
+    TF_RETURN_IF_ERROR(MakeGroupSizeTensor());
+  }
+
+  // The chunk this device reduces across tasks.
+  const int own_chunk = Mod(l + 1, L);
+  // The pieces that are received and merged into the value.
+  std::vector<int> reduced_pieces;
+  for (int s = 0; s < L - 1; ++s) {
+    AppendChunkPieces(Mod(l - s - 1, L), &reduced_pieces);
+  }
+  for (int s = 0; s < T - 1; ++s) {
+    reduced_pieces.push_back(own_chunk * T + Mod(t - s - 1, T));
+  }
+  for (int p : reduced_pieces) {
+    tmp_pieces_[p] = ca_->TempChunk(p);
+  }
+  const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_accelerator_device_info();
+  if (gpu_info) {
+    // Wait for the temp buffer allocations to be valid, as in RingReducer.
+    Notification note;
+    TF_RETURN_IF_ERROR(gpu_info->default_context->ThenExecute(
+        col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); }));
+    note.WaitForNotification();
+  }
+
+  const int local_prev = perms[t][Mod(l - 1, L)];
+  const int local_next = perms[t][Mod(l + 1, L)];
+  const int cross_prev = perms[Mod(t - 1, T)][l];
+  const int cross_next = perms[Mod(t + 1, T)][l];
+
+  // 1. Reduce-scatter among the devices of this task.
+  for (int s = 0; s < L - 1; ++s) {
+    std::vector<int> send_pieces, recv_pieces;
+    AppendChunkPieces(Mod(l - s, L), &send_pieces);
+    AppendChunkPieces(Mod(l - s - 1, L), &recv_pieces);
+    TF_RETURN_IF_ERROR(Exchange(kLocalReduceScatter, s, local_next,
+                                send_pieces, local_prev, recv_pieces,
+                                /*reduce=*/true));
+  }
+  // 2. All-reduce of `own_chunk` among the devices with local rank `l`.
+  for (int s = 0; s < T - 1; ++s) {
+    TF_RETURN_IF_ERROR(Exchange(
+        kCrossTaskReduceScatter, s, cross_next, {own_chunk * T + Mod(t - s, T)},
+        cross_prev, {own_chunk * T + Mod(t - s - 1, T)}, /*reduce=*/true));
+  }
+  const int own_piece = own_chunk * T + Mod(t + 1, T);
+  if (col_params_->final_op && ca_->ChunkBytes(own_piece) > 0) {
+    Status s = collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &pieces_[own_piece], &group_size_tensor_);
+    if (!s.ok()) {
+      StartAbort(s);
+      return s;
+    }
+  }
+  for (int s = 0; s < T - 1; ++s) {
+    TF_RETURN_IF_ERROR(Exchange(
+        kCrossTaskAllGather, s, cross_next, {own_chunk * T + Mod(t + 1 - s, T)},
+        cross_prev, {own_chunk * T + Mod(t - s, T)}, /*reduce=*/false));
+  }
+  // 3. All-gather among the devices of this task.
+  for (int s = 0; s < L - 1; ++s) {
+    std::vector<int> send_pieces, recv_pieces;
+    AppendChunkPieces(Mod(l + 1 - s, L), &send_pieces);
+    AppendChunkPieces(Mod(l - s, L), &recv_pieces);
+    TF_RETURN_IF_ERROR(Exchange(kLocalAllGather, s, local_next, send_pieces,
+                                local_prev, recv_pieces, /*reduce=*/false));
+  }
+
+  ca_->ConsumeFinalValue(col_ctx_->output);
+  return absl::OkStatus();
+}
+
+void HierarchicalRingReducer::AppendChunkPieces(
+    int chunk, std::vector<int>* pieces) const {
+  for (int j = 0; j < num_tasks_; ++j) {
+    pieces->push_back(chunk * num_tasks_ + j);
+  }
+}
+
+Status HierarchicalRingReducer::Exchange(int phase, int step, int send_to,
+                                         const std::vector<int>& send_pieces,
+                                         int recv_from,
+                                         const std::vector<int>& recv_pieces,
+                                         bool reduce) {
+  // Both ends skip the same empty pieces.
+  std::vector<int> sends, recvs;
+  std::copy_if(send_pieces.begin(), send_pieces.end(),
+               std::back_inserter(sends),
+               [this](int p) { return ca_->ChunkBytes(p) > 0; });
+  std::copy_if(recv_pieces.begin(), recv_pieces.end(),
+               std::back_inserter(recvs),
+               [this](int p) { return ca_->ChunkBytes(p) > 0; });
+  if (sends.empty() && recvs.empty()) {
+    return absl::OkStatus();
+  }
+
+  mutex mu;
+  Status status;
+  BlockingCounter pending(sends.size() + recvs.size());
+  auto op_done = [this, &mu, &status, &pending](const Status& s) {
+    if (!s.ok()) {
+      StartAbort(s);
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  const CollGroupMember& send_member = col_params_->group.members[send_to];
+  const CollGroupMember& recv_member = col_params_->group.members[recv_from];
+  for (int p : sends) {
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        send_member.device.name(), send_member.task,
+        HierarchicalRingBufKey(col_ctx_->exec_key, phase, step, p,
+                               col_params_->default_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &pieces_[p],
+        col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+        op_done);
+  }
+  for (int p : recvs) {
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        recv_member.device.name(), recv_member.task, recv_member.is_local,
+        HierarchicalRingBufKey(col_ctx_->exec_key, phase, step, p, recv_from),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0),
+        reduce ? &tmp_pieces_[p] : &pieces_[p], col_ctx_->device_locality,
+        0 /*dev_to_dev_stream_index*/,
+        col_ctx_->op_ctx->cancellation_manager(), op_done);
+  }
+  pending.Wait();
+  TF_RETURN_IF_ERROR(status);
+
+  if (reduce) {
+    for (int p : recvs) {
+      Status s = collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &pieces_[p], &tmp_pieces_[p]);
+      if (!s.ok()) {
+        StartAbort(s);
+        return s;
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalRingReducer::MakeGroupSizeTensor() {
+  Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type == "CPU") {
+    group_size_tensor_ = group_size_val;
+    return absl::OkStatus();
+  }
+  group_size_tensor_ = ca_->Scalar(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      AllocationAttributes());
+  Notification note;
+  Status status;
+  col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, col_ctx_->device, &group_size_tensor_,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+void HierarchicalRingReducer::StartAbort(const Status& s) {
+  // Cancels the outstanding sends and receives of all devices, unless the op
+  // is already being cancelled.
+  CancellationManager* cancel_mgr = col_ctx_->op_ctx->cancellation_manager();
+  if (cancel_mgr == nullptr ||
+      (!cancel_mgr->IsCancelled() && !cancel_mgr->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective all-reduce for groups that span
+// several tasks with the same number of devices each.
+//
+// With L devices per task and T tasks, the tensor is split into L chunks of T
+// pieces each. The all-reduce runs in three phases:
+//  1. A ring reduce-scatter among the devices of each task, after which the
+//     device with local rank l holds the task's sum of chunk (l + 1) % L.
+//  2. A ring all-reduce of that chunk among the T devices with local rank l,
+//     one per task.
+//  3. A ring all-gather of the chunks among the devices of each task.
+// Compared to a single ring over all devices, each device sends only 1/L of
+// the tensor across tasks, so cross-task links carry L times less data.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer() = default;
+  ~HierarchicalRingReducer() override = default;
+
+  // Establishes one subdiv permutation per task, listing the group members on
+  // that task in ring order.  Fails unless every task has the same number of
+  // devices.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Executes the all-reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  Status RunBlocking();
+
+  // Sends `send_pieces` to member `send_to` and receives `recv_pieces` from
+  // member `recv_from`, then merges the received pieces into the value if
+  // `reduce`.  Pieces are chunks of `ca_`.
+  Status Exchange(int phase, int step, int send_to,
+                  const std::vector<int>& send_pieces, int recv_from,
+                  const std::vector<int>& recv_pieces, bool reduce);
+
+  // Appends to `pieces` the pieces of chunk `chunk`.
+  void AppendChunkPieces(int chunk, std::vector<int>* pieces) const;
+
+  Status MakeGroupSizeTensor();
+  void StartAbort(const Status& s);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+  int num_tasks_ = 0;
+  int devices_per_task_ = 0;
+  std::unique_ptr<CollectiveAdapter> ca_;
+  // Aliases and temporary buffers of the pieces of `ca_`.
+  std::vector<Tensor> pieces_;
+  std::vector<Tensor> tmp_pieces_;
+  Tensor group_size_tensor_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/memory/memory.h"
+#include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -38,6 +43,9 @@ ImmutableExecutorState::~ImmutableExecutorState() {
     NodeItem* item = gview_.node(i);
     if (item != nullptr) {
       params_.delete_kernel(item->kernel);
+      if (item->device_context != nullptr) {
+        item->device_context->Unref();
+      }
     }
   }
 }
@@ -242,6 +250,25 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
   }
 
+  // Ask the device for the contexts of nodes that do not run in its own.
+  std::vector<OpKernel*> kernels(graph.num_node_ids(), nullptr);
+  for (const Node* n : graph.nodes()) {
+    if (IsSink(n)) continue;
+    kernels[n->id()] = gview_.node(n->id())->kernel;
+  }
+  std::vector<DeviceContext*> device_contexts;
+  TF_RETURN_IF_ERROR(
+      params_.device->FillContextMap(graph, kernels, &device_contexts));
+  for (int id = 0, n = device_contexts.size(); id < n; ++id) {
+    if (device_contexts[id] == nullptr) continue;
+    NodeItem* item = gview_.node(id);
+    if (item == nullptr) {
+      device_contexts[id]->Unref();
+      continue;
+    }
+    item->device_context = device_contexts[id];
+  }
+
   // Rewrite each `EdgeInfo::input_slot` member to refer directly to the input
   // location.
   for (const Node* n : graph.nodes()) {
@@ -259,9 +286,58 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  if (params_.use_critical_path_priorities) {
+    InitializeCriticalPathPriorities(graph);
+  }
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
+void ImmutableExecutorState::InitializeCriticalPathPriorities(
+    const Graph& graph) {
+  // Edges out of NextIteration nodes close loops; ignoring them makes the
+  // graph acyclic.
+  auto is_back_edge = [](const Edge* e) { return e->src()->IsNextIteration(); };
+
+  // Visit the nodes in reverse topological order, so that the priorities of
+  // all successors of a node are known when the node is visited.
+  const int num_ids = graph.num_node_ids();
+  std::vector<int> num_pending_successors(num_ids, 0);
+  std::vector<const Node*> ready;
+  for (const Node* n : graph.nodes()) {
+    int num_successors = 0;
+    for (const Edge* e : n->out_edges()) {
+      if (!is_back_edge(e)) ++num_successors;
+    }
+    num_pending_successors[n->id()] = num_successors;
+    if (num_successors == 0) ready.push_back(n);
+  }
+
+  critical_path_priorities_.assign(num_ids, 0);
+  while (!ready.empty()) {
+    const Node* n = ready.back();
+    ready.pop_back();
+    int64_t successor_priority = 0;
+    for (const Edge* e : n->out_edges()) {
+      if (is_back_edge(e)) continue;
+      successor_priority = std::max(
+          successor_priority, critical_path_priorities_[e->dst()->id()]);
+    }
+    int64_t cost = 0;
+    if (n->IsOp()) {
+      cost = params_.cost_model != nullptr
+                 ? params_.cost_model->TimeEstimate(n).value()
+                 : 1;
+    }
+    critical_path_priorities_[n->id()] = cost + successor_priority;
+    for (const Edge* e : n->in_edges()) {
+      if (is_back_edge(e)) continue;
+      if (--num_pending_successors[e->src()->id()] == 0) {
+        ready.push_back(e->src());
+      }
+    }
+  }
+}
+
 namespace {
 // If a Node has been marked to use a ScopedAllocator x for output i, then
 // sc_attr will contain the subsequence (i, x) at an even offset.  This function
@@ -21,9 +21,11 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/entry_array_pool.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
@@ -101,6 +103,27 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns true if the critical-path priorities of the nodes were computed,
+  // i.e. if `LocalExecutorParams::use_critical_path_priorities` is set.
+  bool has_critical_path_priorities() const {
+    return !critical_path_priorities_.empty();
+  }
+
+  // Returns the estimated cost of the longest path from `node_item` to the end
+  // of the graph, including `node_item` itself. Back edges of loops are
+  // ignored. REQUIRES: `has_critical_path_priorities()`.
+  int64_t critical_path_priority(const NodeItem& node_item) const {
+    return critical_path_priorities_[node_item.node_id];
+  }
+
+  // Returns the pool from which the propagators of all steps of this executor
+  // allocate their input `Entry` arrays.
+  EntryArrayPool* entry_pool() const { return &entry_pool_; }
+
+  // Returns the planner that lays out the allocations of the steps of this
+  // executor in a per-step arena, if static memory planning is enabled.
+  StaticMemoryPlanner* memory_planner() const { return &memory_planner_; }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -125,6 +148,7 @@ class ImmutableExecutorState {
   static Status BuildControlFlowInfo(const Graph* graph,
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  void InitializeCriticalPathPriorities(const Graph& graph);
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
@@ -152,9 +176,20 @@ class ImmutableExecutorState {
   // pending counts for the nodes in the graph, indexed by node ID.
   std::unique_ptr<std::atomic<int32>[]> atomic_pending_counts_;
 
+  // If `params_.use_critical_path_priorities` is set, the critical-path
+  // priority of each node, indexed by node ID. Empty otherwise.
+  std::vector<int64_t> critical_path_priorities_;
+
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // Reusable per-step input `Entry` arrays. Mutable because it is shared by
+  // concurrent steps, which only see a const `ImmutableExecutorState`.
+  mutable EntryArrayPool entry_pool_;
+
+  // Shared by concurrent steps like `entry_pool_`.
+  mutable StaticMemoryPlanner memory_planner_;
+
   ImmutableExecutorState(const ImmutableExecutorState&) = delete;
   void operator=(const ImmutableExecutorState&) = delete;
 };
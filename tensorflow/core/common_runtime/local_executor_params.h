@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 
 namespace tensorflow {
+class CostModel;
 class Device;
 class StepStatsCollector;
 class SessionMetadata;
@@ -50,6 +51,16 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // Whether the executor runs ready nodes in decreasing order of the
+  // estimated cost of the longest path from each node to the end of the
+  // graph, instead of in the order in which they became ready.
+  bool use_critical_path_priorities = false;
+
+  // Node cost estimates used to compute the critical-path priorities. If
+  // null, every op node has a unit cost. Only used during executor
+  // initialization.
+  const CostModel* cost_model = nullptr;
 };
 
 }  // end namespace tensorflow
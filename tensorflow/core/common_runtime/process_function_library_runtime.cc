@@ -437,6 +437,34 @@ Status FunctionRetsToTensors(const std::vector<FunctionRet>* function_rets,
   }
   return absl::OkStatus();
 }
+
+bool HasSendOrRecv(const Graph& graph) {
+  for (const Node* node : graph.op_nodes()) {
+    if (node->IsSend() || node->IsHostSend() || node->IsRecv() ||
+        node->IsHostRecv()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if the i-th argument and return value of a component function
+// are the i-th argument and return value of a function with `num_outputs`
+// outputs.
+bool TakesArgsAndRetsInOrder(const std::vector<FunctionArgIndex>& arg_indices,
+                             const std::vector<int>& ret_indices,
+                             int num_outputs) {
+  for (int i = 0; i < arg_indices.size(); ++i) {
+    if (arg_indices[i].index != i || arg_indices[i].sub_index != -1) {
+      return false;
+    }
+  }
+  if (ret_indices.size() != num_outputs) return false;
+  for (int i = 0; i < ret_indices.size(); ++i) {
+    if (ret_indices[i] != i) return false;
+  }
+  return true;
+}
 }  // namespace
 
 ProcessFunctionLibraryRuntime::AsyncAttributes::Summary
@@ -639,6 +667,10 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   const int num_subgraphs = subgraphs->size();
   gtl::InlinedVector<Status, 4> instantiate_status(num_subgraphs);
 
+  // A single component without Send/Recv ops does not need a rendezvous.
+  const bool single_component_without_send_recv =
+      num_subgraphs == 1 && !HasSendOrRecv(*subgraphs->begin()->second);
+
   // Before instantiating component functions, determine synchronous execution.
   data->enable_sync_execution = false;
   if (options.allow_small_function_optimizations) {
@@ -714,6 +746,9 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     opts.lib_def = &data_lib_def;
     opts.create_kernels_eagerly = options.create_kernels_eagerly;
     opts.state_handle = options.state_handle;
+    opts.thread_pool_name = options.thread_pool_name;
+    opts.thread_pool_num_threads = options.thread_pool_num_threads;
+    opts.thread_pool_numa_node = options.thread_pool_numa_node;
     opts.allow_small_function_optimizations = data->enable_sync_execution;
     opts.allow_control_flow_sync_execution =
         options.allow_control_flow_sync_execution;
@@ -756,7 +791,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
   };
 
-  // Instantiate each component function (subgraph).
+  // Instantiate each component function (subgraph). Errors of all the
+  // component functions are reported together below.
   //
   // NOTE: Only use thread pool to instantiate sub-function when there are
   // more than a threshold (default 8) of sub-functions. We want to avoid cost
@@ -770,15 +806,22 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
       Status* status = &instantiate_status[i];
       ComponentFunctionData* comp_data = &data->glue_[pair.first];
       comp_data->name = name_generator.GetName();
-      default_thread_pool_->Schedule(
-          [&instantiate_component, &pair, comp_data, &counter, status]() {
-            instantiate_component(pair.first, std::move(pair.second), comp_data,
-                                  [&counter, status](Status s) {
-                                    status->Update(s);
-                                    counter.DecrementCount();
-                                  });
-          });
+      auto fn = [&instantiate_component, &pair, comp_data, &counter,
+                 status]() {
+        instantiate_component(pair.first, std::move(pair.second), comp_data,
+                              [&counter, status](Status s) {
+                                status->Update(s);
+                                counter.DecrementCount();
+                              });
+      };
       i += 1;
+      // Instantiates the last component function on this thread, which
+      // would otherwise only wait for the others.
+      if (i == num_subgraphs) {
+        fn();
+      } else {
+        default_thread_pool_->Schedule(std::move(fn));
+      }
     }
     counter.Wait();
   } else {
@@ -813,6 +856,14 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
   }
 
+  if (single_component_without_send_recv && !data->is_cross_process_) {
+    const auto& pair = *data->glue_.begin();
+    if (TakesArgsAndRetsInOrder(pair.second.arg_indices,
+                                pair.second.ret_indices, data->num_outputs_)) {
+      data->single_component_flr = GetFLR(pair.first);
+    }
+  }
+
   *handle = AddMultiDeviceHandle(std::move(data), function_key);
   VLOG(1) << "Instantiated MultiDevice function \"" << function_name
           << "\" with handle " << *handle;
@@ -902,6 +953,32 @@ Status ProcessFunctionLibraryRuntime::PrepareRunMultiDevice(
   return absl::OkStatus();
 }
 
+const ProcessFunctionLibraryRuntime::ComponentFunctionData*
+ProcessFunctionLibraryRuntime::PrepareRunSingleComponent(
+    const FunctionLibraryRuntime::Options& opts,
+    const MultiDeviceFunctionData* data, size_t num_args,
+    FunctionLibraryRuntime::Options* comp_opts) const {
+  // Leaves create_rendezvous=true to PrepareRunMultiDevice to reject.
+  if (data == nullptr || data->single_component_flr == nullptr ||
+      opts.create_rendezvous) {
+    return nullptr;
+  }
+  const ComponentFunctionData& comp_data = data->glue_.begin()->second;
+  if (comp_data.arg_indices.size() != num_args) return nullptr;
+
+  FunctionLibraryRuntime* flr = data->single_component_flr;
+  *comp_opts = opts;
+  comp_opts->args_alloc_attrs = comp_data.arg_alloc_attrs;
+  comp_opts->rets_alloc_attrs = comp_data.ret_alloc_attrs;
+  comp_opts->remote_execution = false;
+  thread::ThreadPool* pool = flr->device()->tensorflow_device_thread_pool();
+  comp_opts->runner = (pool == nullptr) ? opts.runner : flr->runner();
+  VLOG(1) << "Running single component function " << comp_data.name
+          << " from " << data->function_name_ << " with handle "
+          << comp_data.handle;
+  return &comp_data;
+}
+
 std::vector<string> ProcessFunctionLibraryRuntime::GetOrderedSubgraphs(
     const MultiDeviceFunctionData* data) const {
   std::vector<string> subgraph_keys;
@@ -1379,6 +1456,26 @@ void ProcessFunctionLibraryRuntime::Run(
     FunctionLibraryRuntime::Handle handle, absl::Span<const Tensor> args,
     std::vector<Tensor>* rets,
     FunctionLibraryRuntime::DoneCallback done) const {
+  FunctionLibraryRuntime::Options comp_opts;
+  const MultiDeviceFunctionData* data = IsMultiDevice(handle);
+  const ComponentFunctionData* comp_data =
+      PrepareRunSingleComponent(opts, data, args.size(), &comp_opts);
+  if (comp_data != nullptr) {
+    data->single_component_flr->Run(
+        comp_opts, comp_data->handle, args, rets,
+        [data, done = std::move(done)](const Status& s) {
+          if (s.ok()) {
+            done(s);
+            return;
+          }
+          done(errors::CreateWithUpdatedMessage(
+              s, strings::StrCat(
+                     errors::FormatFunctionForError(data->function_name_), " ",
+                     s.message())));
+        });
+    return;
+  }
+
   FunctionLibraryRuntime::Options new_opts = opts;
   tsl::core::RefCountPtr<Rendezvous> created_rendezvous = nullptr;
   if (!opts.rendezvous) {
@@ -1564,6 +1661,21 @@ Status ProcessFunctionLibraryRuntime::RunSync(
     FunctionLibraryRuntime::Handle handle, absl::Span<const Tensor> args,
     std::vector<Tensor>* rets) const {
   MultiDeviceFunctionData* multi_device_data = IsMultiDevice(handle);
+  FunctionLibraryRuntime::Options comp_opts;
+  const ComponentFunctionData* comp_data = PrepareRunSingleComponent(
+      orig_opts, multi_device_data, args.size(), &comp_opts);
+  if (comp_data != nullptr) {
+    metrics::IncrementTestCounter("pflr_runsync", "sync");
+    Status s = multi_device_data->single_component_flr->RunSync(
+        comp_opts, comp_data->handle, args, rets);
+    if (!s.ok()) {
+      return errors::CreateWithUpdatedMessage(
+          s, strings::StrCat(errors::FormatFunctionForError(
+                                 multi_device_data->function_name_),
+                             " ", s.message()));
+    }
+    return s;
+  }
   if (multi_device_data && multi_device_data->enable_sync_execution) {
     metrics::IncrementTestCounter("pflr_runsync", "sync");
     FunctionLibraryRuntime::Options new_opts = orig_opts;
@@ -300,7 +300,8 @@ class ProcessFunctionLibraryRuntime {
           num_outputs_(num_outputs),
           ret_types_(std::move(ret_types)),
           is_cross_process_(false),
-          has_remote_outputs(false) {}
+          has_remote_outputs(false),
+          single_component_flr(nullptr) {}
 
     const string function_name_;
     const string function_key_;
@@ -317,6 +318,12 @@ class ProcessFunctionLibraryRuntime {
     //  Indicates if running this function synchronously is both allowed + safe.
     bool enable_sync_execution;
 
+    // Set when the function has a single component function, placed on a
+    // local device, that has no Send/Recv ops and returns the outputs of the
+    // function in order. Such a function is run directly on this FLR, without
+    // creating a rendezvous or remapping its arguments and return values.
+    FunctionLibraryRuntime* single_component_flr;
+
     // Maps the device name to the information about the component function
     // be run on this device.
     std::unordered_map<string, ComponentFunctionData> glue_;
@@ -427,6 +434,15 @@ class ProcessFunctionLibraryRuntime {
                                FunctionLibraryRuntime::Handle handle,
                                const MultiDeviceFunctionData** data) const;
 
+  // Returns the component function to run `data` with `num_args` arguments
+  // directly on its `single_component_flr`, filling `comp_opts` with the
+  // options to run it with. Returns nullptr if `data` has to be run through
+  // RunMultiDeviceSync or RunMultiDeviceAsync.
+  const ComponentFunctionData* PrepareRunSingleComponent(
+      const FunctionLibraryRuntime::Options& opts,
+      const MultiDeviceFunctionData* data, size_t num_args,
+      FunctionLibraryRuntime::Options* comp_opts) const;
+
   Status RunMultiDeviceSync(
       const FunctionLibraryRuntime::Options& opts,
       FunctionLibraryRuntime::Handle handle, std::vector<FunctionRet>* rets,
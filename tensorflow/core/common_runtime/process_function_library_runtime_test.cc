@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -155,6 +156,7 @@ class ProcessFunctionLibraryRuntimeTest : public ::testing::Test {
         Rendezvous::Factory{[this](const int64_t step_id,
                                    const DeviceMgr* device_mgr,
                                    tsl::core::RefCountPtr<Rendezvous>* r) {
+          ++this->num_rendezvous_created_;
           *r = this->rendezvous_cache_->FindOrCreate(step_id, [device_mgr]() {
             return tsl::core::RefCountPtr<IntraProcessRendezvous>(
                 new IntraProcessRendezvous(device_mgr));
@@ -325,6 +327,7 @@ class ProcessFunctionLibraryRuntimeTest : public ::testing::Test {
   // To ensure that we are cleaning up the rendezvous properly.
   tsl::core::RefCountPtr<RendezvousCache<IntraProcessRendezvous>>
       rendezvous_cache_;
+  std::atomic<int> num_rendezvous_created_{0};
 };
 
 TEST_F(ProcessFunctionLibraryRuntimeTest, GetFLRNull) {
@@ -850,6 +853,31 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_FlipBoth) {
       this, MakeOptions("CPU:0", {"GPU:0", "CPU:0"}, {"GPU:0", "CPU:0"}));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_SingleComponent) {
+  Init({test::function::Swap()});
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate("Swap", {{"T", DT_FLOAT}},
+                          MakeOptions("CPU:0", {"CPU:0", "CPU:0"},
+                                      {"CPU:0", "CPU:0"}),
+                          &handle));
+  auto x1 = test::AsTensor<float>({1, 2});
+  auto x2 = test::AsTensor<float>({3, 4});
+  Tensor y1, y2;
+  TF_CHECK_OK(RunInstantiated(handle, {}, {x1, x2}, {&y1, &y2}));
+  test::ExpectTensorEqual<float>(y1, x2);
+  test::ExpectTensorEqual<float>(y2, x1);
+
+  std::vector<Tensor> args = {x1, x2};
+  std::vector<Tensor> out;
+  TF_CHECK_OK(proc_flr_->RunSync({}, handle, args, &out));
+  ASSERT_EQ(out.size(), 2);
+  test::ExpectTensorEqual<float>(out[0], x2);
+  test::ExpectTensorEqual<float>(out[1], x1);
+
+  // The single component function runs directly on the FLR of CPU:0.
+  EXPECT_EQ(num_rendezvous_created_, 0);
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_EmptyBodySwap) {
   if (gpu_device_ == nullptr) {
     GTEST_SKIP() << "No GPUs available";
@@ -1123,6 +1151,66 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_CreateKernelsEagerly) {
   EXPECT_TRUE(errors::IsInternal(status));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest,
+       MultiDevice_CreateKernelsEagerlyInParallel) {
+  // More component functions than TF_PFLR_PARALLEL_INSTANTIATE_THRESHOLD
+  // (default 8), so that they are instantiated on the thread pool.
+  constexpr int kNumDevices = 10;
+  SessionOptions session_options;
+  session_options.config.mutable_device_count()->insert({"CPU", kNumDevices});
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::AddDevices(
+      session_options, "/job:a/replica:0/task:0", &devices));
+  auto device_mgr = std::make_unique<DynamicDeviceMgr>();
+  TF_ASSERT_OK(device_mgr->AddDevices(std::move(devices)));
+
+  // One broken node per device, each in its own component function.
+  std::vector<string> rets;
+  std::vector<FunctionDefHelper::Node> nodes;
+  for (int i = 0; i < kNumDevices; ++i) {
+    const string y = strings::StrCat("y", i);
+    rets.push_back(strings::StrCat(y, ": int32"));
+    nodes.push_back({{y},
+                     "BrokenOp",
+                     {"x"},
+                     {{"T", DT_INT32}},
+                     {},
+                     strings::StrCat("/device:CPU:", i)});
+  }
+  FunctionDef broken_func = FunctionDefHelper::Define(
+      "BrokenOnAllDevices", {"x: int32"}, rets, {}, nodes);
+  FunctionDefLibrary proto;
+  *proto.add_function() = broken_func;
+  FunctionLibraryDefinition lib_def(OpRegistry::Global(), proto);
+  thread::ThreadPool thread_pool(Env::Default(), "pflr_test", 4);
+  ProcessFunctionLibraryRuntime proc_flr(
+      device_mgr.get(), Env::Default(), /*config=*/nullptr,
+      TF_GRAPH_DEF_VERSION, &lib_def, OptimizerOptions(), &thread_pool);
+
+  // Kernels are still created lazily unless the caller asks otherwise.
+  FunctionLibraryRuntime::InstantiateOptions inst_opts =
+      MakeOptions("CPU:0", {"CPU:0"}, {});
+  FunctionLibraryRuntime::Handle handle;
+  TF_ASSERT_OK(proc_flr.Instantiate("BrokenOnAllDevices", AttrSlice(),
+                                    inst_opts, &handle));
+  TF_ASSERT_OK(proc_flr.ReleaseHandle(handle));
+
+  // Kernels are created while instantiating, and the errors of all the
+  // component functions are reported.
+  inst_opts.create_kernels_eagerly = true;
+  Status status = proc_flr.Instantiate("BrokenOnAllDevices", AttrSlice(),
+                                       inst_opts, &handle);
+  EXPECT_TRUE(errors::IsInternal(status)) << status;
+  EXPECT_TRUE(absl::StrContains(
+      status.message(), strings::StrCat(kNumDevices, " root error(s) found")))
+      << status;
+  for (int i = 0; i < kNumDevices; ++i) {
+    EXPECT_TRUE(absl::StrContains(status.message(),
+                                  strings::StrCat("{{node y", i, "}}")))
+        << status;
+  }
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_StateHandle) {
   auto T = DT_INT32;
   // The expected sequence of outputs from this function is [6, 4, 0, 1, ...].
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 #include "tensorflow/core/common_runtime/propagator_debug_utils.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/hash.h"
@@ -33,14 +34,12 @@ PropagatorState::PropagatorState(const ImmutableExecutorState& immutable_state,
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
   // We assume root_frame_->frame_name.empty().
-  root_frame_ = new FrameState(immutable_state_, 1);
+  root_frame_ = new FrameState(immutable_state_, 1, &entry_pool_stats_);
   root_frame_->frame_id = 0;  // must be 0
   root_frame_->InitializeFrameInfo(immutable_state_.get_root_frame_info());
 
   // Initialize iteration 0.
-  root_frame_->SetIteration(
-      0, new PropagatorState::IterationState(0, root_frame_->pending_counts,
-                                             root_frame_->total_input_tensors));
+  root_frame_->SetIteration(0, root_frame_->NewIterationState(0));
 
   outstanding_frames_.emplace(root_frame_->frame_id, root_frame_);
 }
@@ -49,6 +48,8 @@ PropagatorState::~PropagatorState() {
   for (auto name_frame : outstanding_frames_) {
     delete name_frame.second;
   }
+  metrics::RecordExecutorEntryPoolBytes(entry_pool_stats_.bytes_reused,
+                                        entry_pool_stats_.bytes_allocated);
 }
 
 void PropagatorState::ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
@@ -280,8 +281,8 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
     VLOG(2) << "Create frame: " << child_name << " id: " << child_id;
   }
 
-  FrameState* temp =
-      new FrameState(immutable_state_, frame_info.parallel_iterations);
+  FrameState* temp = new FrameState(
+      immutable_state_, frame_info.parallel_iterations, &entry_pool_stats_);
   temp->frame_id = child_id;
   temp->parent_frame = frame;
   temp->parent_iter = iter_state;
@@ -290,8 +291,7 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
   // Initialize iteration 0.
   {
     mutex_lock l(temp->mu);
-    temp->SetIteration(0, new IterationState(0, temp->pending_counts,
-                                             temp->total_input_tensors));
+    temp->SetIteration(0, temp->NewIterationState(0));
   }
 
   {
@@ -753,8 +753,7 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
 
   // Initialize the next iteration.
-  IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
+  IterationState* next_iter = NewIterationState(iteration_count);
   SetIteration(iteration_count, next_iter);
   num_outstanding_iterations++;
   {
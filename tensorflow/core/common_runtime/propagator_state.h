@@ -19,6 +19,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/entry_array_pool.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -127,9 +128,13 @@ class PropagatorState {
   struct IterationState {
     explicit IterationState(int64_t iter_num,
                             const PendingCounts* pending_counts,
-                            int total_input_tensors)
+                            int total_input_tensors, EntryArrayPool* entry_pool,
+                            EntryArrayPool::Stats* entry_pool_stats)
         : iter_num(iter_num),
-          input_tensors(new Entry[total_input_tensors]),
+          input_tensors(
+              entry_pool->Allocate(total_input_tensors, entry_pool_stats)),
+          num_input_tensors(total_input_tensors),
+          entry_pool(entry_pool),
           outstanding_ops(0),
           outstanding_frame_count(0),
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
@@ -147,6 +152,10 @@ class PropagatorState {
     // source node of an edge and is cleared by the destination of the same
     // edge. The latter node is never run concurrently with the former node.
     Entry* input_tensors;
+    const int num_input_tensors;
+
+    // The pool that `input_tensors` was allocated from, and is returned to.
+    EntryArrayPool* const entry_pool;
 
     // The number of outstanding ops for each iteration.
     std::atomic<size_t> outstanding_ops;
@@ -206,7 +215,9 @@ class PropagatorState {
       return counts.adjust_for_activation_atomic(h, increment_dead);
     }
 
-    ~IterationState() { delete[] input_tensors; }
+    ~IterationState() {
+      entry_pool->Deallocate(input_tensors, num_input_tensors);
+    }
 
    private:
     PendingCounts counts;
@@ -214,8 +225,10 @@ class PropagatorState {
 
   struct FrameState {
     explicit FrameState(const ImmutableExecutorState& immutable_state,
-                        int parallel_iters)
+                        int parallel_iters,
+                        EntryArrayPool::Stats* entry_pool_stats)
         : immutable_state(immutable_state),
+          entry_pool_stats(entry_pool_stats),
           max_parallel_iterations(parallel_iters),
           num_outstanding_iterations(1),
           iterations(parallel_iters + 1),
@@ -252,6 +265,10 @@ class PropagatorState {
     // The immutable state of the executor the frame is in.
     const ImmutableExecutorState& immutable_state;
 
+    // Accounting for the input tensor arrays of this frame's iterations. Owned
+    // by the `PropagatorState`.
+    EntryArrayPool::Stats* const entry_pool_stats;
+
     // The name of this frame, which is the concatenation of its parent
     // frame name, the iteration of the parent frame when this frame was
     // created, and the value of the attr 'frame_name'.
@@ -321,6 +338,14 @@ class PropagatorState {
 
     void InitializeFrameInfo(const ImmutableExecutorState::FrameInfo& finfo);
 
+    // Creates the state for iteration `iter_num` of this frame, with input
+    // tensors taken from the executor's `EntryArrayPool`.
+    IterationState* NewIterationState(int64_t iter_num) {
+      return new IterationState(iter_num, pending_counts, total_input_tensors,
+                                immutable_state.entry_pool(),
+                                entry_pool_stats);
+    }
+
     inline IterationState* GetIteration(int64_t iter)
         TF_SHARED_LOCKS_REQUIRED(mu) {
       if (TF_PREDICT_TRUE(iter == 0)) {
@@ -533,6 +558,10 @@ class PropagatorState {
   const int64_t step_id_;
   const bool vlog_;
 
+  // Bytes of input tensor arrays reused from, or newly allocated by, the
+  // executor's `EntryArrayPool` during this step.
+  EntryArrayPool::Stats entry_pool_stats_;
+
   mutex mu_;
 
   // The root frame in which the execution of this step is started.
@@ -139,6 +139,11 @@ class RenamedDevice : public Device {
     return underlying_device_->TryGetDeviceContext(out_context);
   }
 
+  Status FillContextMap(const Graph& graph, absl::Span<OpKernel* const> kernels,
+                        std::vector<DeviceContext*>* device_contexts) override {
+    return underlying_device_->FillContextMap(graph, kernels, device_contexts);
+  }
+
   // Returns the resource manager associated w/ this device.
   ResourceMgr* resource_manager() override {
     if (isolate_session_state_) {
@@ -394,7 +394,8 @@ string RingAlg::RingField::DebugString() const {
   return rv;
 }
 
-void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
+void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done,
+                           const Tensor* tensor) {
   DCHECK(rf->do_send);
   string send_buf_key = RingAlgBufKey(name_, col_ctx_->exec_key,
                                       rf->second_pass, rf->sc_idx, rf->rank);
@@ -408,12 +409,13 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
-      col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
-      done);
+      col_ctx_->op_ctx->output_alloc_attr(0),
+      tensor != nullptr ? tensor : &rf->chunk, col_ctx_->device_locality,
+      col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
-void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
+void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done,
+                           Tensor* tensor) {
   DCHECK(rf->do_recv);
   string recv_buf_key =
       RingAlgBufKey(name_, col_ctx_->exec_key, rf->second_pass, rf->sc_idx,
@@ -424,6 +426,7 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (tensor != nullptr) dst_tensor = tensor;
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
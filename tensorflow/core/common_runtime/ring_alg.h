@@ -81,8 +81,12 @@ class RingAlg : public CollectiveImplementationInterface {
   virtual void InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
                              int field_idx);
   void AdvanceToSecondPass(RingField* rf);
-  void DispatchSend(RingField* rf, const StatusCallback& done);
-  void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Sends `rf->chunk`, or `tensor` in its place if not null.
+  void DispatchSend(RingField* rf, const StatusCallback& done,
+                    const Tensor* tensor = nullptr);
+  // Receives the value of `rf`, into `tensor` if not null.
+  void DispatchRecv(RingField* rf, const StatusCallback& done,
+                    Tensor* tensor = nullptr);
 
   // For constructing log messages for debugging.
   string FieldState();
@@ -64,6 +64,14 @@ void RingReducer::Run(StatusCallback done) {
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
+  if (!col_params_->instance.impl_details.compression.empty()) {
+    Status s = InitializeCompression();
+    if (!s.ok()) {
+      group_size_tensor_ready_.Notify();  // To unblock destructor.
+      done_(s);
+      return;
+    }
+  }
 
   if (VLOG_IS_ON(1)) {
     string buf;
@@ -162,12 +170,50 @@ void RingReducer::ContinueAfterInputCopy() {
   Finish(RunAsyncParts());
 }
 
+Status RingReducer::InitializeCompression() {
+  const string& spec = col_params_->instance.impl_details.compression;
+  TF_RETURN_IF_ERROR(CollectiveCompressorRegistry::Create(spec, &compressor_));
+  residuals_ = col_ctx_->col_exec->compression_residuals();
+  if (residuals_ == nullptr) {
+    return errors::Unimplemented(
+        "Collective compression ", spec,
+        " is not supported by this collective executor");
+  }
+  // Compressors work on host memory, and only approximate sums.
+  if (col_params_->group.device_type != DEVICE_CPU) {
+    return errors::Unimplemented("Collective compression ", spec,
+                                 " is not supported on ",
+                                 col_params_->group.device_type.type_string());
+  }
+  if (!compressor_->SupportsType(col_params_->instance.data_type)) {
+    return errors::InvalidArgument(
+        "Collective compression ", spec, " does not support ",
+        DataTypeString(col_params_->instance.data_type));
+  }
+  if (col_params_->merge_op == nullptr ||
+      col_params_->merge_op->type_string() != "Add") {
+    return errors::InvalidArgument("Collective compression ", spec,
+                                   " requires the Add merge op");
+  }
+  return absl::OkStatus();
+}
+
 void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
                                 int field_idx) {
   RingAlg::InitRingField(rf, chunk_idx, subdiv_idx, field_idx);
   if (rf->do_recv) {
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
   }
+  if (compressor_ != nullptr) {
+    const TensorShape encoded_shape({compressor_->EncodedBytes(
+        col_params_->instance.data_type, rf->chunk.NumElements())});
+    if (rf->do_recv) {
+      encoded_recvs_[field_idx] = Tensor(DT_UINT8, encoded_shape);
+    }
+    if (rf->do_send) {
+      encoded_sends_[field_idx] = Tensor(DT_UINT8, encoded_shape);
+    }
+  }
 }
 
 // At the beginning of the algorithm initialize a RingField struct for
@@ -180,6 +226,10 @@ bool RingReducer::RunAsyncParts() {
   // one thread and do not require an explicit mutex.
   rfv_.clear();
   rfv_.resize(group_size_ * num_subdivs_);
+  if (compressor_ != nullptr) {
+    encoded_sends_.resize(rfv_.size());
+    encoded_recvs_.resize(rfv_.size());
+  }
   PCQueue ready_queue;
   for (int chunk_idx = 0; chunk_idx < group_size_; ++chunk_idx) {
     for (int subdiv_idx = 0; subdiv_idx < num_subdivs_; ++subdiv_idx) {
@@ -243,7 +293,10 @@ bool RingReducer::RunAsyncParts() {
                 }
                 ready_queue.Enqueue(rf);
               };
-              DispatchRecv(rf, requeue);
+              DispatchRecv(rf, requeue,
+                           (compressor_ != nullptr && !rf->second_pass)
+                               ? &encoded_recvs_[FieldIndex(rf)]
+                               : nullptr);
               dispatched = true;
               ++recv_pending_count;
             } else {
@@ -255,6 +308,10 @@ bool RingReducer::RunAsyncParts() {
             --recv_pending_count;
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
+              if (compressor_ != nullptr) {
+                compressor_->Decode(encoded_recvs_[FieldIndex(rf)],
+                                    &rf->tmp_chunk);
+              }
               Status s = collective_util::ComputeBinOp(
                   col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
                   col_params_->merge_op, &rf->chunk, &rf->tmp_chunk);
@@ -295,7 +352,21 @@ bool RingReducer::RunAsyncParts() {
                 }
                 ready_queue.Enqueue(rf);
               };
-              DispatchSend(rf, send_complete);
+              if (compressor_ != nullptr && !rf->second_pass) {
+                // Residuals persist across executions of the same instance
+                // within the step.
+                const int field_idx = FieldIndex(rf);
+                Tensor* residual = residuals_->Get(
+                    strings::StrCat(col_params_->group.group_key, ":",
+                                    col_params_->instance.instance_key, ":",
+                                    col_ctx_->device_name, ":", field_idx),
+                    rf->chunk);
+                compressor_->Encode(rf->chunk, residual,
+                                    &encoded_sends_[field_idx]);
+                DispatchSend(rf, send_complete, &encoded_sends_[field_idx]);
+              } else {
+                DispatchSend(rf, send_complete);
+              }
               dispatched = true;
               ++send_pending_count;
             } else {
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_compression.h"
 #include "tensorflow/core/common_runtime/ring_alg.h"
 #include "tensorflow/core/framework/collective.h"
 
@@ -28,6 +29,10 @@ namespace tensorflow {
 class Device;
 
 // Ring-algorithm implementation of collective all-reduce.
+//
+// If `CollImplDetails::compression` is set, the partial sums sent in the
+// reduction pass are encoded by that `CollectiveCompressor`. The final values
+// sent in the second pass are not, so that all devices end with the same value.
 class RingReducer : public RingAlg {
  public:
   RingReducer() : RingAlg(REDUCTION_COLLECTIVE, "Reduce") {}
@@ -48,9 +53,18 @@ class RingReducer : public RingAlg {
  private:
   void ContinueAfterInputCopy();
   bool RunAsyncParts();
+  Status InitializeCompression();
+  // Returns the index of `rf` in `rfv_`.
+  int FieldIndex(const RingField* rf) const { return rf - rfv_.data(); }
 
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
+  std::unique_ptr<CollectiveCompressor> compressor_;
+  // Owned by the collective executor.
+  CollectiveCompressionResiduals* residuals_ = nullptr;
+  // The encoded values sent and received in the first pass, by field index.
+  std::vector<Tensor> encoded_sends_;
+  std::vector<Tensor> encoded_recvs_;
 
   friend class RingReducerTest;
   friend class RingReducerInitParamsTest;
@@ -153,6 +153,33 @@ class RingReducerTest : public ::testing::Test {
     }
   }
 
+  // Runs a float reduction of 2 workers with 2 devices each, with the
+  // partial sums sent with `compression`.
+  void RunCompressionTest(const string& compression, int tensor_len,
+                          float tolerance) {
+    Init(/*num_workers=*/2, /*num_devices=*/2, DT_FLOAT,
+         TensorShape({tensor_len}), DEVICE_CPU, /*num_subdivs=*/1,
+         /*fail_after=*/0);
+    std::vector<float> expected(tensor_len);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->col_params_->instance.impl_details.compression =
+          compression;
+      instances_[di]->InitTensor([&expected, di](Tensor* t) {
+        for (size_t i = 0; i < t->NumElements(); ++i) {
+          float value = di + (i % 7) * 0.25f;
+          t->flat<float>()(i) = value;
+          expected[i] += value / 4;
+        }
+      });
+    }
+    Reduce(/*fail_after=*/0);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      test::ExpectTensorNear<float>(test::AsTensor<float>(expected),
+                                    instances_[di]->tensor(), tolerance);
+    }
+  }
+
   class DeviceInstance {
    public:
     DeviceInstance(int rank, int num_subdivs, DataType dtype,
@@ -401,6 +428,26 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivDisabled) {
   }
 
 #if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+TEST_F(RingReducerTest, BF16Compression) {
+  RunCompressionTest("bf16", /*tensor_len=*/1001, /*tolerance=*/1e-2);
+}
+
+TEST_F(RingReducerTest, TopKCompressionOfAllElements) {
+  RunCompressionTest("topk=1", /*tensor_len=*/1001, /*tolerance=*/1e-6);
+}
+
+TEST_F(RingReducerTest, CompressionRequiresFloats) {
+  Init(/*num_workers=*/1, /*num_devices=*/2, DT_INT32, TensorShape({8}),
+       DEVICE_CPU, /*num_subdivs=*/1, /*fail_after=*/0);
+  for (auto& instance : instances_) {
+    instance->col_params_->instance.impl_details.compression = "bf16";
+  }
+  Reduce(/*fail_after=*/0);
+  for (auto& instance : instances_) {
+    EXPECT_TRUE(errors::IsInvalidArgument(instance->status_));
+  }
+}
+
 // Success tests
 DEF_TEST(FLOAT, CPU, 1, 2, 1, 1, 0)
 DEF_TEST(FLOAT, CPU, 1, 2, 1, 2, 0)
@@ -17,6 +17,7 @@ limitations under the License.
 #include <atomic>
 
 #include "tensorflow/core/common_runtime/propagator_debug_utils.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 
@@ -33,7 +34,9 @@ SimplePropagatorState::SimplePropagatorState(
     : immutable_state_(immutable_state),
       step_id_(step_id),
       vlog_(vlog || VLOG_IS_ON(1)),
-      input_tensors_(finfo.total_inputs),
+      num_input_tensors_(finfo.total_inputs),
+      input_tensors_(immutable_state.entry_pool()->Allocate(
+          num_input_tensors_, &entry_pool_stats_)),
       pending_(
           new std::atomic<int32>[immutable_state.graph_view().num_nodes()]),
       active_(vlog_ ? new std::vector<bool>(
@@ -43,7 +46,12 @@ SimplePropagatorState::SimplePropagatorState(
   immutable_state_.copy_pending_counts(pending_.get());
 }
 
-SimplePropagatorState::~SimplePropagatorState() {}
+SimplePropagatorState::~SimplePropagatorState() {
+  immutable_state_.entry_pool()->Deallocate(input_tensors_,
+                                            num_input_tensors_);
+  metrics::RecordExecutorEntryPoolBytes(entry_pool_stats_.bytes_reused,
+                                        entry_pool_stats_.bytes_allocated);
+}
 
 void SimplePropagatorState::ActivateRoots(
     gtl::ArraySlice<const NodeItem*> roots, TaggedNodeSeq* ready) {
@@ -108,18 +116,18 @@ void SimplePropagatorState::DumpState() {
   // Dump any waiting nodes that are holding on to tensors.
   for (const NodeItem* node : *nodes_) {
     if (pending_[node->node_id]) {
-      DumpPendingNodeState(*node, input_tensors_.data(), false);
+      DumpPendingNodeState(*node, input_tensors_, false);
     }
   }
   // Then the active nodes.
   for (const NodeItem* node : *nodes_) {
     if ((*active_)[node->node_id]) {
-      DumpActiveNodeState(*node, input_tensors_.data());
+      DumpActiveNodeState(*node, input_tensors_);
     }
   }
   // Show all input tensors in use.
   size_t total_bytes = 0;
-  for (size_t i = 0; i < input_tensors_.size(); ++i) {
+  for (int i = 0; i < num_input_tensors_; ++i) {
     const Entry& input = input_tensors_[i];
     const Tensor* tensor = GetTensorValueForDump(input);
     if (tensor && tensor->IsInitialized()) {
@@ -18,6 +18,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/entry_array_pool.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -127,7 +128,7 @@ class SimplePropagatorState {
     // `PrepareInputs()`.
     CHECK_EQ(pending_[tagged_node.node_item->node_id], 0);
 #endif  // defined(THREAD_SANITIZER) || defined(DEBUG)
-    return input_tensors_.data() + tagged_node.node_item->input_start;
+    return input_tensors_ + tagged_node.node_item->input_start;
   }
 
   FrameAndIter GetFrameAndIter(const TaggedNode& tagged_node) const {
@@ -173,7 +174,11 @@ class SimplePropagatorState {
   // source node of an edge and is cleared by the destination of the same
   // edge. The destination node always runs after the source node, so there
   // is never concurrent access to the same entry.
-  std::vector<Entry> input_tensors_;
+  //
+  // The array is taken from, and returned to, `immutable_state_.entry_pool()`.
+  const int num_input_tensors_;
+  EntryArrayPool::Stats entry_pool_stats_;
+  Entry* const input_tensors_;
 
   std::unique_ptr<std::atomic<int32>[]> pending_;
 
@@ -0,0 +1,224 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t AlignedSize(size_t size) {
+  constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+  return (std::max<size_t>(size, 1) + kAlignment - 1) / kAlignment *
+         kAlignment;
+}
+
+bool LifetimesOverlap(const StaticMemoryPlanner::Allocation& a,
+                      const StaticMemoryPlanner::Allocation& b) {
+  return a.alloc_time <= b.free_time && b.alloc_time <= a.free_time;
+}
+
+}  // namespace
+
+size_t StaticMemoryPlanner::AssignOffsets(
+    const std::vector<Allocation>& allocations, std::vector<size_t>* offsets) {
+  offsets->assign(allocations.size(), 0);
+  // Place the largest buffers first; for each buffer take the lowest offset
+  // that does not overlap a placed buffer whose lifetime overlaps its own.
+  std::vector<int> order(allocations.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return allocations[a].size > allocations[b].size;
+  });
+
+  std::vector<int> placed;
+  std::vector<int> conflicts;
+  size_t arena_size = 0;
+  for (int i : order) {
+    const Allocation& allocation = allocations[i];
+    const size_t size = AlignedSize(allocation.size);
+    conflicts.clear();
+    for (int j : placed) {
+      if (LifetimesOverlap(allocation, allocations[j])) conflicts.push_back(j);
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [&](int a, int b) { return (*offsets)[a] < (*offsets)[b]; });
+    size_t offset = 0;
+    for (int j : conflicts) {
+      const size_t begin = (*offsets)[j];
+      if (offset + size <= begin) break;
+      offset = std::max(offset, begin + AlignedSize(allocations[j].size));
+    }
+    (*offsets)[i] = offset;
+    arena_size = std::max(arena_size, offset + size);
+    placed.push_back(i);
+  }
+  return arena_size;
+}
+
+void StaticMemoryPlanner::Plan(std::vector<Allocation> allocations) {
+  mutex_lock l(mu_);
+  if (has_plan()) return;
+  allocations.erase(std::remove_if(allocations.begin(), allocations.end(),
+                                   [](const Allocation& allocation) {
+                                     return allocation.free_time < 0 ||
+                                            allocation.op_name == nullptr;
+                                   }),
+                    allocations.end());
+  std::vector<size_t> offsets;
+  arena_size_ = AssignOffsets(allocations, &offsets);
+  for (size_t i = 0; i < allocations.size(); ++i) {
+    plan_[{allocations[i].op_name, allocations[i].ordinal}] = {
+        offsets[i], allocations[i].size};
+  }
+  VLOG(1) << "Planned " << allocations.size() << " allocations in an arena of "
+          << arena_size_ << " bytes";
+  has_plan_.store(true, std::memory_order_release);
+}
+
+const StaticMemoryPlanner::PlannedAllocation* StaticMemoryPlanner::Find(
+    const char* op_name, int ordinal) const {
+  DCHECK(has_plan());
+  auto it = plan_.find({op_name, ordinal});
+  return it == plan_.end() ? nullptr : &it->second;
+}
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base,
+                                       StaticMemoryPlanner* planner)
+    : base_(base), planner_(planner), recording_(!planner->has_plan()) {
+  if (!recording_ && planner_->arena_size() > 0) {
+    arena_ = static_cast<char*>(base_->AllocateRaw(
+        Allocator::kAllocatorAlignment, planner_->arena_size(),
+        AllocationAttributes()));
+    // If the arena cannot be allocated, every allocation falls back to
+    // `base_`.
+    if (arena_ != nullptr) arena_size_ = planner_->arena_size();
+  }
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  if (arena_ != nullptr) base_->DeallocateRaw(arena_);
+}
+
+std::string StepArenaAllocator::Name() {
+  return absl::StrCat("step_arena_", base_->Name());
+}
+
+bool StepArenaAllocator::IsArenaRangeFree(size_t offset, size_t size) const {
+  auto it = live_arena_ranges_.upper_bound(offset);
+  if (it != live_arena_ranges_.end() && it->first < offset + size) {
+    return false;
+  }
+  if (it == live_arena_ranges_.begin()) return true;
+  --it;
+  return it->second <= offset;
+}
+
+void* StepArenaAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  const char* op_name =
+      tsl::profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation()
+          .pending_op_name;
+  int ordinal = 0;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!finished_);
+    if (op_name != nullptr) ordinal = ordinals_[op_name]++;
+    if (arena_ != nullptr && op_name != nullptr) {
+      const StaticMemoryPlanner::PlannedAllocation* planned =
+          planner_->Find(op_name, ordinal);
+      if (planned != nullptr && num_bytes <= planned->size &&
+          reinterpret_cast<uintptr_t>(arena_ + planned->offset) %
+                  alignment ==
+              0 &&
+          IsArenaRangeFree(planned->offset, num_bytes)) {
+        live_arena_ranges_[planned->offset] = planned->offset + num_bytes;
+        ++num_arena_allocations_;
+        ++num_live_;
+        return arena_ + planned->offset;
+      }
+    }
+  }
+
+  void* ptr = base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) return nullptr;
+  mutex_lock l(mu_);
+  ++num_live_;
+  if (recording_) {
+    record_index_[ptr] = records_.size();
+    StaticMemoryPlanner::Allocation record;
+    record.op_name = op_name;
+    record.ordinal = ordinal;
+    record.size = num_bytes;
+    record.alloc_time = clock_++;
+    records_.push_back(record);
+  }
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  bool delete_self = false;
+  {
+    mutex_lock l(mu_);
+    if (InArena(ptr)) {
+      live_arena_ranges_.erase(static_cast<char*>(ptr) - arena_);
+    } else {
+      if (recording_) {
+        auto it = record_index_.find(ptr);
+        if (it != record_index_.end()) {
+          // Buffers freed after the end of the step outlive it.
+          if (!finished_) records_[it->second].free_time = clock_++;
+          record_index_.erase(it);
+        }
+      }
+      base_->DeallocateRaw(ptr);
+    }
+    --num_live_;
+    delete_self = finished_ && num_live_ == 0;
+  }
+  if (delete_self) delete this;
+}
+
+void StepArenaAllocator::Finish() {
+  bool delete_self = false;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!finished_);
+    finished_ = true;
+    if (recording_) planner_->Plan(std::move(records_));
+    delete_self = num_live_ == 0;
+  }
+  if (delete_self) delete this;
+}
+
+int64_t StepArenaAllocator::num_arena_allocations() const {
+  mutex_lock l(mu_);
+  return num_arena_allocations_;
+}
+
+}  // namespace tensorflow
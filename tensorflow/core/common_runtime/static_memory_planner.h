@@ -0,0 +1,175 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Plans the placement of the buffers that a step of an executor allocates in
+// a single per-step arena, from the allocations recorded in an earlier step.
+//
+// Allocations are identified by the name of the op making them, and by their
+// ordinal among the allocations of that op in the step. Buffers whose
+// lifetimes do not overlap may share memory. This is the same greedy-by-size
+// strategy that TFLite's `ArenaPlanner` applies to tensors ahead of time,
+// except that lifetimes come from a recorded (warmup) step.
+//
+// This class is thread-safe.
+class StaticMemoryPlanner {
+ public:
+  // An allocation observed during a recorded step. `alloc_time` and
+  // `free_time` are logical timestamps in that step; `free_time` is -1 if the
+  // buffer was not freed before the end of the step.
+  struct Allocation {
+    const char* op_name = nullptr;
+    int ordinal = 0;
+    size_t size = 0;
+    int64_t alloc_time = 0;
+    int64_t free_time = -1;
+  };
+
+  struct PlannedAllocation {
+    size_t offset = 0;
+    size_t size = 0;
+  };
+
+  StaticMemoryPlanner() = default;
+
+  // Returns true once `Plan()` has computed a plan.
+  bool has_plan() const { return has_plan_.load(std::memory_order_acquire); }
+
+  // Computes the plan from the allocations of a recorded step, unless a plan
+  // already exists. Allocations that outlive the step are left out of the
+  // plan.
+  void Plan(std::vector<Allocation> allocations);
+
+  // The size of the arena that the plan lays out. REQUIRES: `has_plan()`.
+  size_t arena_size() const { return arena_size_; }
+
+  // Returns the planned placement of the `ordinal`-th allocation of `op_name`,
+  // or nullptr if it is not part of the plan. REQUIRES: `has_plan()`.
+  const PlannedAllocation* Find(const char* op_name, int ordinal) const;
+
+  // Assigns an offset to each of `allocations`, such that allocations with
+  // overlapping lifetimes do not overlap in memory, and returns the size of
+  // the arena they span. Offsets are aligned to
+  // `Allocator::kAllocatorAlignment`. Exposed for testing.
+  static size_t AssignOffsets(const std::vector<Allocation>& allocations,
+                              std::vector<size_t>* offsets);
+
+ private:
+  mutex mu_;
+  std::atomic<bool> has_plan_{false};
+
+  // Immutable once `has_plan_` is set.
+  absl::flat_hash_map<std::pair<const char*, int>, PlannedAllocation> plan_;
+  size_t arena_size_ = 0;
+
+  StaticMemoryPlanner(const StaticMemoryPlanner&) = delete;
+  void operator=(const StaticMemoryPlanner&) = delete;
+};
+
+// An allocator for the buffers of one step. With a plan, it serves the planned
+// allocations from one arena that is allocated from `base` at construction.
+// An allocation is served by `base` instead if it is not in the plan, if it
+// is larger than planned, or if its planned memory is still in use (e.g.
+// because the step ran its ops in a different order than the recorded step).
+// Without a plan, every allocation is served by `base` and recorded, and the
+// recording is handed to the planner at the end of the step.
+//
+// Buffers may outlive the step (e.g. fetched outputs), so the allocator must
+// not be deleted directly. Call `Finish()` at the end of the step instead; the
+// allocator deletes itself once all the buffers it returned have been freed.
+//
+// This class is thread-safe.
+class StepArenaAllocator : public Allocator {
+ public:
+  // `base` and `planner` must outlive this allocator.
+  StepArenaAllocator(Allocator* base, StaticMemoryPlanner* planner);
+
+  std::string Name() override;
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+
+  void DeallocateRaw(void* ptr) override;
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Marks the end of the step. No allocations may be made afterwards.
+  void Finish();
+
+  // Returns the number of allocations served from the arena so far.
+  int64_t num_arena_allocations() const;
+
+ private:
+  ~StepArenaAllocator() override;
+
+  bool InArena(const void* ptr) const {
+    return arena_ != nullptr && ptr >= arena_ && ptr < arena_ + arena_size_;
+  }
+
+  // Returns true if no buffer that is in use overlaps the `size` bytes at
+  // `offset` in the arena.
+  bool IsArenaRangeFree(size_t offset, size_t size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;
+  StaticMemoryPlanner* const planner_;
+  const bool recording_;
+  size_t arena_size_ = 0;
+  char* arena_ = nullptr;
+
+  mutable mutex mu_;
+  // Number of allocations made by each op so far in this step.
+  absl::flat_hash_map<const char*, int> ordinals_ TF_GUARDED_BY(mu_);
+  // Buffers in use in the arena, as a map from offset to end offset.
+  std::map<size_t, size_t> live_arena_ranges_ TF_GUARDED_BY(mu_);
+  int64_t num_arena_allocations_ TF_GUARDED_BY(mu_) = 0;
+  // Number of buffers returned by this allocator that are not yet freed.
+  int64_t num_live_ TF_GUARDED_BY(mu_) = 0;
+  bool finished_ TF_GUARDED_BY(mu_) = false;
+
+  // Recording state.
+  int64_t clock_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<StaticMemoryPlanner::Allocation> records_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<void*, size_t> record_index_ TF_GUARDED_BY(mu_);
+
+  StepArenaAllocator(const StepArenaAllocator&) = delete;
+  void operator=(const StepArenaAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
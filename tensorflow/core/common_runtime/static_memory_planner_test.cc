@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
+
+namespace tensorflow {
+namespace {
+
+StaticMemoryPlanner::Allocation MakeAllocation(const char* op_name,
+                                               size_t size, int64_t alloc_time,
+                                               int64_t free_time) {
+  StaticMemoryPlanner::Allocation allocation;
+  allocation.op_name = op_name;
+  allocation.size = size;
+  allocation.alloc_time = alloc_time;
+  allocation.free_time = free_time;
+  return allocation;
+}
+
+TEST(StaticMemoryPlannerTest, DisjointLifetimesShareMemory) {
+  std::vector<StaticMemoryPlanner::Allocation> allocations = {
+      MakeAllocation("a", 1024, 0, 1), MakeAllocation("b", 1024, 2, 3)};
+  std::vector<size_t> offsets;
+  EXPECT_EQ(StaticMemoryPlanner::AssignOffsets(allocations, &offsets), 1024);
+  EXPECT_EQ(offsets[0], 0);
+  EXPECT_EQ(offsets[1], 0);
+}
+
+TEST(StaticMemoryPlannerTest, OverlappingLifetimesDoNotOverlapInMemory) {
+  std::vector<StaticMemoryPlanner::Allocation> allocations = {
+      MakeAllocation("a", 100, 0, 4), MakeAllocation("b", 2000, 1, 2),
+      MakeAllocation("c", 300, 3, 5), MakeAllocation("d", 1000, 2, 6)};
+  std::vector<size_t> offsets;
+  const size_t arena_size =
+      StaticMemoryPlanner::AssignOffsets(allocations, &offsets);
+  for (size_t i = 0; i < allocations.size(); ++i) {
+    EXPECT_EQ(offsets[i] % Allocator::kAllocatorAlignment, 0);
+    EXPECT_LE(offsets[i] + allocations[i].size, arena_size);
+    for (size_t j = i + 1; j < allocations.size(); ++j) {
+      const auto& a = allocations[i];
+      const auto& b = allocations[j];
+      if (a.alloc_time <= b.free_time && b.alloc_time <= a.free_time) {
+        EXPECT_TRUE(offsets[i] + a.size <= offsets[j] ||
+                    offsets[j] + b.size <= offsets[i])
+            << a.op_name << " overlaps " << b.op_name;
+      }
+    }
+  }
+  // `b` and `c` can share memory, so the arena is smaller than the sum.
+  EXPECT_LT(arena_size, 2000 + 1000 + 300 + 100 + 4 * 64);
+}
+
+TEST(StaticMemoryPlannerTest, EscapingAllocationsAreNotPlanned) {
+  StaticMemoryPlanner planner;
+  EXPECT_FALSE(planner.has_plan());
+  static const char kA[] = "a";
+  static const char kB[] = "b";
+  planner.Plan({MakeAllocation(kA, 64, 0, 1), MakeAllocation(kB, 64, 1, -1)});
+  ASSERT_TRUE(planner.has_plan());
+  EXPECT_NE(planner.Find(kA, 0), nullptr);
+  EXPECT_EQ(planner.Find(kA, 1), nullptr);
+  EXPECT_EQ(planner.Find(kB, 0), nullptr);
+  EXPECT_EQ(planner.arena_size(), 64);
+
+  // Only the first plan is kept.
+  planner.Plan({MakeAllocation(kB, 64, 0, 1)});
+  EXPECT_EQ(planner.Find(kB, 0), nullptr);
+}
+
+// Runs a step that allocates and frees three buffers, one after the other,
+// from `allocator`, and a fourth buffer that outlives the step.
+void RunStep(Allocator* allocator, std::vector<void*>* ptrs,
+             void** escaped) {
+  static const char kOpName[] = "op";
+  static const char kOutputOpName[] = "output";
+  ptrs->clear();
+  for (int i = 0; i < 3; ++i) {
+    tsl::profiler::ScopedMemoryDebugAnnotation annotation(kOpName);
+    void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+    ASSERT_NE(ptr, nullptr);
+    ptrs->push_back(ptr);
+    allocator->DeallocateRaw(ptr);
+  }
+  tsl::profiler::ScopedMemoryDebugAnnotation annotation(kOutputOpName);
+  *escaped = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 128);
+  ASSERT_NE(*escaped, nullptr);
+}
+
+TEST(StepArenaAllocatorTest, RecordThenServeFromArena) {
+  StaticMemoryPlanner planner;
+  Allocator* base = cpu_allocator();
+  std::vector<void*> ptrs;
+  void* escaped = nullptr;
+
+  // The first step records its allocations.
+  auto* recording = new StepArenaAllocator(base, &planner);
+  RunStep(recording, &ptrs, &escaped);
+  EXPECT_EQ(recording->num_arena_allocations(), 0);
+  recording->Finish();
+  ASSERT_TRUE(planner.has_plan());
+  EXPECT_EQ(planner.arena_size(), 256);
+  // The escaped buffer keeps the allocator alive until it is freed.
+  recording->DeallocateRaw(escaped);
+
+  // Later steps serve the buffers with disjoint lifetimes from the arena.
+  auto* planned = new StepArenaAllocator(base, &planner);
+  RunStep(planned, &ptrs, &escaped);
+  EXPECT_EQ(planned->num_arena_allocations(), 3);
+  EXPECT_EQ(ptrs[0], ptrs[1]);
+  EXPECT_EQ(ptrs[1], ptrs[2]);
+  EXPECT_NE(escaped, ptrs[0]);
+  planned->Finish();
+  planned->DeallocateRaw(escaped);
+}
+
+TEST(StepArenaAllocatorTest, FallsBackWhenPlannedMemoryIsInUse) {
+  static const char kA[] = "a";
+  static const char kB[] = "b";
+  StaticMemoryPlanner planner;
+  planner.Plan({MakeAllocation(kA, 256, 0, 1), MakeAllocation(kB, 256, 2, 3)});
+  ASSERT_EQ(planner.arena_size(), 256);
+
+  auto* allocator = new StepArenaAllocator(cpu_allocator(), &planner);
+  void* a;
+  void* b;
+  {
+    tsl::profiler::ScopedMemoryDebugAnnotation annotation(kA);
+    a = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  }
+  {
+    // `a` is still live, so `b` cannot use its planned memory.
+    tsl::profiler::ScopedMemoryDebugAnnotation annotation(kB);
+    b = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  }
+  EXPECT_NE(a, b);
+  EXPECT_EQ(allocator->num_arena_allocations(), 1);
+  {
+    // Larger than planned.
+    tsl::profiler::ScopedMemoryDebugAnnotation annotation(kA);
+    void* c = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 512);
+    EXPECT_EQ(allocator->num_arena_allocations(), 1);
+    allocator->DeallocateRaw(c);
+  }
+  allocator->DeallocateRaw(a);
+  allocator->DeallocateRaw(b);
+  allocator->Finish();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,10 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_description.pb.h"
@@ -49,6 +53,17 @@ bool IsSend(const NodeDef* node) {
   return node->op() == "_Send" || node->op() == "_HostSend";
 }
 
+// The finalizer of MurmurHash3, used to turn node addresses into uniformly
+// distributed sampling decisions.
+uint64 MixBits(uint64 x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
 }  // namespace
 
 NodeExecStatsWrapper::NodeExecStatsWrapper(
@@ -558,4 +573,157 @@ void StepStatsCollector::FinalizeInternal() {
     }
   }
 }
+
+// Collects the timings of one node. Deletes itself when done.
+class SampledStepStatsCollector::NodeStats : public NodeExecStatsInterface {
+ public:
+  NodeStats(const NodeDef* node, SampledStepStatsCollector* collector)
+      : node_(node), collector_(collector) {}
+
+  void Done(const string& device) override {
+    collector_->Save(*this);
+    delete this;
+  }
+  void RecordExecutorStarted() override {
+    executor_start_nanos_ = EnvTime::NowNanos();
+  }
+  void RecordComputeStarted() override {
+    compute_start_nanos_ = EnvTime::NowNanos();
+  }
+  void RecordComputeEnded() override {
+    compute_end_nanos_ = EnvTime::NowNanos();
+  }
+  void RecordExecutorEnded() override {}
+  bool TrackAllocations() const override { return false; }
+  void SetMemory(OpKernelContext* ctx) override {
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      if (ctx->has_input(i) && !ctx->input_is_ref(i)) {
+        input_bytes_ += ctx->input(i).TotalBytes();
+      }
+    }
+  }
+  void SetOutput(int slot, const Tensor* tensor) override {}
+  void SetScheduled(int64_t nanos) override { scheduled_nanos_ = nanos; }
+
+ private:
+  friend class SampledStepStatsCollector;
+
+  const NodeDef* const node_;
+  SampledStepStatsCollector* const collector_;
+  int64_t scheduled_nanos_ = 0;
+  int64_t executor_start_nanos_ = 0;
+  int64_t compute_start_nanos_ = 0;
+  int64_t compute_end_nanos_ = 0;
+  int64_t input_bytes_ = 0;
+};
+
+namespace {
+
+// The phases of a step that `SampledStepStatsCollector` attributes the time
+// spent in ops to.
+enum class StepPhase { kInput, kCompute, kCollective };
+
+StepPhase PhaseOfOp(const string& op) {
+  if (absl::StrContains(op, "IteratorGetNext") ||
+      absl::StartsWith(op, "QueueDequeue")) {
+    return StepPhase::kInput;
+  }
+  if (absl::StartsWith(op, "Collective") || absl::StartsWith(op, "Nccl") ||
+      op == "_Recv" || op == "_HostRecv") {
+    return StepPhase::kCollective;
+  }
+  return StepPhase::kCompute;
+}
+
+}  // namespace
+
+SampledStepStatsCollector::SampledStepStatsCollector(int64_t step_id,
+                                                     double node_sample_rate)
+    : step_seed_(MixBits(static_cast<uint64>(step_id))),
+      // Scale to [0, 2^63) before shifting, so that rounding cannot overflow.
+      sample_threshold_(
+          node_sample_rate > 0 && node_sample_rate < 1
+              ? static_cast<uint64>(node_sample_rate * 9223372036854775808.0)
+                    << 1
+              : std::numeric_limits<uint64>::max()),
+      node_sample_rate_(node_sample_rate > 0 && node_sample_rate < 1
+                            ? node_sample_rate
+                            : 1.0),
+      records_(new Record[kMaxRecords]) {}
+
+SampledStepStatsCollector::~SampledStepStatsCollector() {}
+
+NodeExecStatsInterface* SampledStepStatsCollector::CreateNodeExecStats(
+    const NodeDef* node) {
+  if (sample_threshold_ != std::numeric_limits<uint64>::max() &&
+      MixBits(step_seed_ ^ reinterpret_cast<uintptr_t>(node)) >=
+          sample_threshold_) {
+    return nullptr;
+  }
+  return new NodeStats(node, this);
+}
+
+void SampledStepStatsCollector::Save(const NodeStats& stats) {
+  const int64_t index = num_records_.fetch_add(1, std::memory_order_relaxed);
+  if (index >= kMaxRecords) return;
+  Record& record = records_[index];
+  record.node = stats.node_;
+  record.scheduled_nanos = stats.scheduled_nanos_;
+  record.executor_start_nanos = stats.executor_start_nanos_;
+  record.compute_start_nanos = stats.compute_start_nanos_;
+  record.compute_end_nanos = stats.compute_end_nanos_;
+  record.input_bytes = stats.input_bytes_;
+  record.ready.store(true, std::memory_order_release);
+}
+
+void SampledStepStatsCollector::Finalize() {
+  DCHECK(!finalized_);
+  finalized_ = true;
+  const int64_t num_records = num_recorded_nodes();
+  int64_t phase_nanos[3] = {0, 0, 0};
+  for (int64_t i = 0; i < num_records; ++i) {
+    const Record& record = records_[i];
+    if (!record.ready.load(std::memory_order_acquire)) continue;
+    // The executor does not report a scheduled time for every node.
+    const int64_t scheduling_delay_nanos =
+        record.scheduled_nanos > 0
+            ? record.executor_start_nanos - record.scheduled_nanos
+            : 0;
+    const int64_t compute_nanos =
+        record.compute_end_nanos - record.compute_start_nanos;
+    metrics::RecordSampledNodeStats(
+        record.node->op(), InputBytesBucket(record.input_bytes),
+        compute_nanos / EnvTime::kMicrosToNanos,
+        scheduling_delay_nanos / EnvTime::kMicrosToNanos);
+    phase_nanos[static_cast<int>(PhaseOfOp(record.node->op()))] +=
+        std::max<int64_t>(compute_nanos, 0);
+  }
+  if (num_records == 0) return;
+  const double scale = 1.0 / (node_sample_rate_ * EnvTime::kMicrosToNanos);
+  metrics::RecordSampledStepPhaseTimes(
+      phase_nanos[static_cast<int>(StepPhase::kInput)] * scale,
+      phase_nanos[static_cast<int>(StepPhase::kCompute)] * scale,
+      phase_nanos[static_cast<int>(StepPhase::kCollective)] * scale);
+}
+
+string SampledStepStatsCollector::InputBytesBucket(int64_t input_bytes) {
+  static constexpr const char* kBuckets[] = {
+      "<16", "<256", "<4K", "<64K", "<1M", "<16M", "<256M", "<4G"};
+  int64_t limit = 16;
+  for (const char* bucket : kBuckets) {
+    if (input_bytes < limit) return bucket;
+    limit *= 16;
+  }
+  return ">=4G";
+}
+
+int64_t SampledStepStatsCollector::num_recorded_nodes() const {
+  return std::min(num_records_.load(std::memory_order_relaxed), kMaxRecords);
+}
+
+int64_t SampledStepStatsCollector::num_dropped_nodes() const {
+  return std::max<int64_t>(
+      num_records_.load(std::memory_order_relaxed) - kMaxRecords, 0);
+}
+
 }  // namespace tensorflow
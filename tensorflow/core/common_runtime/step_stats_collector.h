@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -203,6 +204,85 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   uint64 collected_nodes_ TF_GUARDED_BY(mu_) = 0;
 };
 
+// SampledStepStatsCollector records the timings of a random sample of the
+// nodes of one step, and exports them to the sampled op metrics in
+// `tensorflow/core/framework/metrics.h` when the step is finalized.
+//
+// Node compute times are exported by op type and by bucket of the total size
+// of the node's inputs. The compute times of the sampled nodes of each step
+// are also summed, scaled by the sample rate, into an estimate of the time the
+// step spent in input, compute and collective ops.
+//
+// Unlike `StepStatsCollector`, it builds no `NodeExecStats` protos and tracks
+// no allocations. Timings are appended to a fixed-size buffer with a single
+// atomic increment, so recording a node takes no locks; nodes that do not fit
+// in the buffer are dropped. This keeps the overhead low enough to leave
+// sampling enabled in production.
+class SampledStepStatsCollector : public StepStatsCollectorInterface {
+ public:
+  // Records each node with probability `node_sample_rate`. Rates outside of
+  // (0, 1) record every node. `step_id` seeds the per-node decisions.
+  SampledStepStatsCollector(int64_t step_id, double node_sample_rate);
+  ~SampledStepStatsCollector() override;
+
+  // Returns true if the step with the given count should be sampled when one
+  // in every `every_n_steps` steps is sampled.
+  static bool ShouldSampleStep(int64_t step_count, int64_t every_n_steps) {
+    return every_n_steps > 0 && step_count % every_n_steps == 0;
+  }
+
+  // Returns nullptr for nodes that are not sampled.
+  NodeExecStatsInterface* CreateNodeExecStats(const NodeDef* node) override;
+  string ReportAllocsOnResourceExhausted(absl::string_view err) override {
+    return "";
+  }
+
+  // Exports the recorded timings. Must be called at most once, after all the
+  // `NodeExecStatsInterface` objects created by this collector are `Done()`.
+  void Finalize();
+
+  // The number of nodes whose timings were recorded, and dropped because the
+  // buffer was full. Exposed for testing.
+  int64_t num_recorded_nodes() const;
+  int64_t num_dropped_nodes() const;
+
+  // Returns the label of the bucket of the input sizes of sampled nodes that
+  // `input_bytes` falls into. Buckets grow by a factor of 16.
+  static string InputBytesBucket(int64_t input_bytes);
+
+ private:
+  class NodeStats;
+
+  struct Record {
+    const NodeDef* node = nullptr;
+    int64_t scheduled_nanos = 0;
+    int64_t executor_start_nanos = 0;
+    int64_t compute_start_nanos = 0;
+    int64_t compute_end_nanos = 0;
+    int64_t input_bytes = 0;
+    // Set with release semantics once the other fields are written.
+    std::atomic<bool> ready{false};
+  };
+
+  static constexpr int64_t kMaxRecords = 4096;
+
+  // Called by `NodeStats::Done()`.
+  void Save(const NodeStats& stats);
+
+  const uint64 step_seed_;
+  // Nodes are sampled if the hash of their address and `step_seed_` is below
+  // this threshold.
+  const uint64 sample_threshold_;
+  // The fraction of nodes that are sampled, to scale the step phase times.
+  const double node_sample_rate_;
+  std::unique_ptr<Record[]> records_;
+  std::atomic<int64_t> num_records_{0};
+  bool finalized_ = false;
+
+  SampledStepStatsCollector(const SampledStepStatsCollector&) = delete;
+  void operator=(const SampledStepStatsCollector&) = delete;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
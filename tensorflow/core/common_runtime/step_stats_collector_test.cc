@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using monitoring::testing::CellReader;
+using monitoring::testing::Histogram;
+
+void RunNode(NodeExecStatsInterface* stats) {
+  stats->SetScheduled(EnvTime::NowNanos());
+  stats->RecordExecutorStarted();
+  stats->RecordComputeStarted();
+  stats->RecordComputeEnded();
+  stats->RecordExecutorEnded();
+  stats->Done("/device:CPU:0");
+}
+
+TEST(SampledStepStatsCollectorTest, ShouldSampleStep) {
+  EXPECT_FALSE(SampledStepStatsCollector::ShouldSampleStep(0, 0));
+  EXPECT_TRUE(SampledStepStatsCollector::ShouldSampleStep(0, 1));
+  EXPECT_TRUE(SampledStepStatsCollector::ShouldSampleStep(7, 1));
+  EXPECT_TRUE(SampledStepStatsCollector::ShouldSampleStep(20, 10));
+  EXPECT_FALSE(SampledStepStatsCollector::ShouldSampleStep(21, 10));
+}
+
+TEST(SampledStepStatsCollectorTest, RecordsAllNodes) {
+  std::vector<NodeDef> nodes(10);
+  for (NodeDef& node : nodes) node.set_op("NoOp");
+  SampledStepStatsCollector collector(/*step_id=*/1, /*node_sample_rate=*/0);
+  for (const NodeDef& node : nodes) {
+    NodeExecStatsInterface* stats = collector.CreateNodeExecStats(&node);
+    ASSERT_NE(stats, nullptr);
+    EXPECT_FALSE(stats->TrackAllocations());
+    RunNode(stats);
+  }
+  EXPECT_EQ(collector.num_recorded_nodes(), nodes.size());
+  EXPECT_EQ(collector.num_dropped_nodes(), 0);
+  collector.Finalize();
+}
+
+TEST(SampledStepStatsCollectorTest, SamplesFractionOfNodes) {
+  std::vector<NodeDef> nodes(10000);
+  for (NodeDef& node : nodes) node.set_op("NoOp");
+  SampledStepStatsCollector collector(/*step_id=*/1, /*node_sample_rate=*/0.1);
+  for (const NodeDef& node : nodes) {
+    NodeExecStatsInterface* stats = collector.CreateNodeExecStats(&node);
+    if (stats != nullptr) RunNode(stats);
+  }
+  EXPECT_GT(collector.num_recorded_nodes(), 700);
+  EXPECT_LT(collector.num_recorded_nodes(), 1300);
+  collector.Finalize();
+}
+
+TEST(SampledStepStatsCollectorTest, DropsNodesWhenFull) {
+  std::vector<NodeDef> nodes(5000);
+  for (NodeDef& node : nodes) node.set_op("NoOp");
+  SampledStepStatsCollector collector(/*step_id=*/1, /*node_sample_rate=*/1);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 4);
+    for (const NodeDef& node : nodes) {
+      pool.Schedule([&collector, &node]() {
+        RunNode(collector.CreateNodeExecStats(&node));
+      });
+    }
+  }
+  EXPECT_EQ(collector.num_recorded_nodes() + collector.num_dropped_nodes(),
+            nodes.size());
+  EXPECT_GT(collector.num_dropped_nodes(), 0);
+  collector.Finalize();
+}
+
+TEST(SampledStepStatsCollectorTest, InputBytesBucket) {
+  EXPECT_EQ(SampledStepStatsCollector::InputBytesBucket(0), "<16");
+  EXPECT_EQ(SampledStepStatsCollector::InputBytesBucket(16), "<256");
+  EXPECT_EQ(SampledStepStatsCollector::InputBytesBucket(100000), "<1M");
+  EXPECT_EQ(SampledStepStatsCollector::InputBytesBucket(int64_t{1} << 40),
+            ">=4G");
+}
+
+TEST(SampledStepStatsCollectorTest, RecordsStepPhases) {
+  CellReader<Histogram> phase_time(
+      "/tensorflow/core/sampled_step_phase_time_usecs");
+  CellReader<Histogram> compute_time(
+      "/tensorflow/core/sampled_node_compute_time_usecs");
+  std::vector<NodeDef> nodes(3);
+  nodes[0].set_op("IteratorGetNext");
+  nodes[1].set_op("MatMul");
+  nodes[2].set_op("CollectiveReduceV2");
+  SampledStepStatsCollector collector(/*step_id=*/1, /*node_sample_rate=*/1);
+  for (const NodeDef& node : nodes) {
+    RunNode(collector.CreateNodeExecStats(&node));
+  }
+  collector.Finalize();
+  // One sample of each phase for the step.
+  EXPECT_FLOAT_EQ(phase_time.Delta("input").num(), 1.0);
+  EXPECT_FLOAT_EQ(phase_time.Delta("compute").num(), 1.0);
+  EXPECT_FLOAT_EQ(phase_time.Delta("collective").num(), 1.0);
+  // RunNode does not set any inputs.
+  EXPECT_FLOAT_EQ(compute_time.Delta("MatMul", "<16").num(), 1.0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,133 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A set of `num_workers` double-ended queues of `T`, one per worker. A worker
+// pushes and pops work at the back of its own deque (LIFO, which keeps
+// producer/consumer pairs cache-warm), and steals from the front of the other
+// workers' deques when its own deque is empty.
+//
+// Each deque is protected by its own mutex, so workers only contend with each
+// other when stealing. The total number of queued elements is tracked with an
+// atomic counter that is updated after each push and pop completes.
+//
+// This class is thread-safe.
+template <typename T>
+class WorkStealingQueue {
+ public:
+  explicit WorkStealingQueue(int num_workers)
+      : num_workers_(num_workers > 0 ? num_workers : 1),
+        queues_(new Queue[num_workers_]) {}
+
+  WorkStealingQueue(const WorkStealingQueue&) = delete;
+  void operator=(const WorkStealingQueue&) = delete;
+
+  int num_workers() const { return num_workers_; }
+
+  // Returns the total number of queued elements. The value may be stale by
+  // the time it is used if other threads are concurrently pushing or popping.
+  size_t ApproximateSize() const { return size_.load(); }
+
+  // Pushes `value` to the back of worker `worker_id`'s deque.
+  void Push(int worker_id, T value) {
+    Queue& q = queues_[Index(worker_id)];
+    {
+      mutex_lock l(q.mu);
+      q.items.push_back(std::move(value));
+    }
+    size_.fetch_add(1);
+  }
+
+  // Pops an element from the back of worker `worker_id`'s deque. If that deque
+  // is empty, attempts to steal an element from the front of the other
+  // workers' deques, starting at the next worker. Returns `std::nullopt` if
+  // all deques were observed empty. Sets `*stolen` (if not null) to whether
+  // the returned element was taken from another worker.
+  std::optional<T> Pop(int worker_id, bool* stolen = nullptr) {
+    const int self = Index(worker_id);
+    std::optional<T> value = PopBack(&queues_[self]);
+    if (value.has_value()) {
+      if (stolen != nullptr) *stolen = false;
+      return value;
+    }
+    for (int i = 1; i < num_workers_; ++i) {
+      value = PopFront(&queues_[(self + i) % num_workers_]);
+      if (value.has_value()) {
+        if (stolen != nullptr) *stolen = true;
+        return value;
+      }
+    }
+    return std::nullopt;
+  }
+
+ private:
+  // Pad each deque to its own cache line to avoid false sharing between the
+  // mutexes of neighbouring workers.
+  struct alignas(64) Queue {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  int Index(int worker_id) const {
+    DCHECK_GE(worker_id, 0);
+    return worker_id % num_workers_;
+  }
+
+  std::optional<T> PopBack(Queue* q) {
+    std::optional<T> value;
+    {
+      mutex_lock l(q->mu);
+      if (q->items.empty()) return std::nullopt;
+      value.emplace(std::move(q->items.back()));
+      q->items.pop_back();
+    }
+    size_.fetch_sub(1);
+    return value;
+  }
+
+  std::optional<T> PopFront(Queue* q) {
+    std::optional<T> value;
+    {
+      mutex_lock l(q->mu);
+      if (q->items.empty()) return std::nullopt;
+      value.emplace(std::move(q->items.front()));
+      q->items.pop_front();
+    }
+    size_.fetch_sub(1);
+    return value;
+  }
+
+  const int num_workers_;
+  std::unique_ptr<Queue[]> queues_;
+  std::atomic<size_t> size_{0};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_QUEUE_H_
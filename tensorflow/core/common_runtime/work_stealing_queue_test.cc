@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_queue.h"
+
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingQueueTest, OwnDequeIsLifo) {
+  WorkStealingQueue<int> queue(2);
+  queue.Push(0, 1);
+  queue.Push(0, 2);
+  queue.Push(0, 3);
+  EXPECT_EQ(queue.ApproximateSize(), 3);
+
+  bool stolen = true;
+  EXPECT_EQ(queue.Pop(0, &stolen), 3);
+  EXPECT_FALSE(stolen);
+  EXPECT_EQ(queue.Pop(0, &stolen), 2);
+  EXPECT_FALSE(stolen);
+  EXPECT_EQ(queue.Pop(0, &stolen), 1);
+  EXPECT_FALSE(stolen);
+  EXPECT_EQ(queue.Pop(0), std::nullopt);
+  EXPECT_EQ(queue.ApproximateSize(), 0);
+}
+
+TEST(WorkStealingQueueTest, StealsFromFrontOfOtherDeques) {
+  WorkStealingQueue<int> queue(3);
+  queue.Push(1, 1);
+  queue.Push(1, 2);
+
+  bool stolen = false;
+  EXPECT_EQ(queue.Pop(0, &stolen), 1);
+  EXPECT_TRUE(stolen);
+  EXPECT_EQ(queue.Pop(2, &stolen), 2);
+  EXPECT_TRUE(stolen);
+  EXPECT_EQ(queue.Pop(1), std::nullopt);
+}
+
+TEST(WorkStealingQueueTest, WorkerIdsWrapAround) {
+  WorkStealingQueue<int> queue(2);
+  queue.Push(5, 7);
+  bool stolen = true;
+  EXPECT_EQ(queue.Pop(1, &stolen), 7);
+  EXPECT_FALSE(stolen);
+}
+
+TEST(WorkStealingQueueTest, NonPositiveNumWorkers) {
+  WorkStealingQueue<int> queue(0);
+  EXPECT_EQ(queue.num_workers(), 1);
+  queue.Push(0, 42);
+  EXPECT_EQ(queue.Pop(0), 42);
+}
+
+TEST(WorkStealingQueueTest, ConcurrentPushAndPop) {
+  constexpr int kNumWorkers = 4;
+  constexpr int kItemsPerWorker = 10000;
+  WorkStealingQueue<int> queue(kNumWorkers);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> num_popped{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumWorkers);
+    for (int w = 0; w < kNumWorkers; ++w) {
+      pool.Schedule([&queue, &sum, &num_popped, w]() {
+        for (int i = 0; i < kItemsPerWorker; ++i) {
+          queue.Push(w, i);
+          // Pop every other iteration so that deques fill up and other
+          // workers have something to steal.
+          if (i % 2 == 1) {
+            std::optional<int> value = queue.Pop(w);
+            if (value.has_value()) {
+              sum += *value;
+              ++num_popped;
+            }
+          }
+        }
+        while (std::optional<int> value = queue.Pop(w)) {
+          sum += *value;
+          ++num_popped;
+        }
+      });
+    }
+  }
+  EXPECT_EQ(num_popped, kNumWorkers * kItemsPerWorker);
+  EXPECT_EQ(sum, static_cast<int64_t>(kNumWorkers) * kItemsPerWorker *
+                     (kItemsPerWorker - 1) / 2);
+  EXPECT_EQ(queue.ApproximateSize(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
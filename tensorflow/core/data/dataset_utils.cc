@@ -19,6 +19,7 @@ limitations under the License.
 #include <array>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <queue>
@@ -29,6 +30,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -41,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
@@ -50,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
@@ -436,6 +440,66 @@ std::function<void(std::function<void()>)> RunnerWithMaxParallelism(
       std::move(runner), std::placeholders::_1);
 }
 
+namespace {
+
+// The NUMA node that the current thread was last pinned to by
+// `PinCurrentThreadToNumaNode`, to avoid repeating the system call for every
+// function run on the same thread.
+thread_local int current_thread_numa_node = port::kNUMANoAffinity;
+
+void PinCurrentThreadToNumaNode(int numa_node) {
+  if (current_thread_numa_node != numa_node) {
+    port::NUMASetThreadNodeAffinity(numa_node);
+    current_thread_numa_node = numa_node;
+  }
+}
+
+class NumaThreadFactory : public ThreadFactory {
+ public:
+  NumaThreadFactory(std::shared_ptr<ThreadFactory> base, int numa_node)
+      : base_(std::move(base)), numa_node_(numa_node) {}
+
+  std::unique_ptr<Thread> StartThread(const string& name,
+                                      std::function<void()> fn) override {
+    auto pinned_fn = [numa_node = numa_node_, fn = std::move(fn)]() {
+      PinCurrentThreadToNumaNode(numa_node);
+      fn();
+    };
+    if (base_) return base_->StartThread(name, std::move(pinned_fn));
+    return absl::WrapUnique(
+        Env::Default()->StartThread({}, name, std::move(pinned_fn)));
+  }
+
+ private:
+  const std::shared_ptr<ThreadFactory> base_;
+  const int numa_node_;
+};
+
+}  // namespace
+
+std::function<void(std::function<void()>)> RunnerWithNumaAffinity(
+    std::function<void(std::function<void()>)> runner, int numa_node) {
+  return std::bind(
+      [numa_node](
+          // Note: `runner` is a const reference to avoid copying it.
+          const std::function<void(std::function<void()>)>& runner,
+          std::function<void()> fn) {
+        std::function<void()> pinned_fn = std::bind(
+            [numa_node](const std::function<void()>& fn) {
+              PinCurrentThreadToNumaNode(numa_node);
+              fn();
+            },
+            std::move(fn));
+        runner(std::move(pinned_fn));
+      },
+      std::move(runner), std::placeholders::_1);
+}
+
+std::shared_ptr<ThreadFactory> ThreadFactoryWithNumaAffinity(
+    std::shared_ptr<ThreadFactory> base, int numa_node) {
+  return std::make_shared<NumaThreadFactory>(std::move(base), numa_node);
+}
+
 Status DeterminismPolicy::FromString(const std::string& s,
                                      DeterminismPolicy* out) {
   DeterminismPolicy::Type type;
@@ -872,6 +936,37 @@ Status CopyBatch(AnyContext ctx,
   return absl::OkStatus();
 }
 
+Status CopyToPinnedHostMemory(IteratorContext* ctx,
+                              std::vector<Tensor>* value) {
+  AllocatorAttributes attr;
+  attr.set_on_host(true);
+  attr.set_gpu_compatible(true);
+  Allocator* pinned_allocator = ctx->allocator(attr);
+  if (pinned_allocator == ctx->allocator({})) {
+    return absl::OkStatus();
+  }
+  for (Tensor& tensor : *value) {
+    if (!DataTypeCanUseMemcpy(tensor.dtype()) || tensor.TotalBytes() == 0) {
+      continue;
+    }
+    TensorDescription description;
+    tensor.FillDescription(&description);
+    if (description.allocation_description().allocator_name() ==
+        pinned_allocator->Name()) {
+      continue;
+    }
+    Tensor pinned(pinned_allocator, tensor.dtype(), tensor.shape());
+    if (!pinned.IsInitialized()) {
+      return errors::ResourceExhausted(
+          "Failed to allocate ", tensor.TotalBytes(),
+          " bytes of pinned host memory");
+    }
+    std::memcpy(pinned.data(), tensor.data(), tensor.TotalBytes());
+    tensor = std::move(pinned);
+  }
+  return absl::OkStatus();
+}
+
 absl::flat_hash_set<tstring> CreateGraphRewriteConfigs(const Options& options) {
   absl::flat_hash_set<tstring> configs;
   const auto& autotune_options = options.autotune_options();
@@ -922,6 +1017,11 @@ bool ShouldUsePrivateThreadPool(const Options& options) {
          ThreadingOptions::kPrivateThreadpoolSize;
 }
 
+bool ShouldUseNumaAffinity(const Options& options) {
+  return options.threading_options().optional_numa_node_case() ==
+         ThreadingOptions::kNumaNode;
+}
+
 bool ShouldUseAutotuning(const Options& options) {
   return options.autotune_options().optional_enabled_case() !=
              AutotuneOptions::kEnabled ||
@@ -1024,6 +1124,8 @@ REGISTER_DATASET_EXPERIMENT("inject_io_prefetch", RandomJobSamplePercentage<0>,
                             AllTasks);
 REGISTER_DATASET_EXPERIMENT("map_fusion", RandomJobSamplePercentage<0>,
                             IndependentHostTasks);
+REGISTER_DATASET_EXPERIMENT("scaled_jpeg_decode", RandomJobSamplePercentage<0>,
+                            AllTasks);
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -213,6 +213,15 @@ Status IsNodeStateful(const FunctionLibraryDefinition& library,
 std::function<void(std::function<void()>)> RunnerWithMaxParallelism(
     std::function<void(std::function<void()>)> runner, int max_parallelism);
 
+// Creates a runner that pins the threads running functions to `numa_node`.
+std::function<void(std::function<void()>)> RunnerWithNumaAffinity(
+    std::function<void(std::function<void()>)> runner, int numa_node);
+
+// Creates a thread factory whose threads are pinned to `numa_node`. Threads
+// are started by `base` if it is not null, and by `Env::Default()` otherwise.
+std::shared_ptr<ThreadFactory> ThreadFactoryWithNumaAffinity(
+    std::shared_ptr<ThreadFactory> base, int numa_node);
+
 // Op for creating a typed dummy resource.
 //
 // This op is used to provide a resource "placeholder" for ops such as
@@ -290,6 +299,11 @@ Status CopyBatch(AnyContext ctx,
                  std::vector<std::vector<Tensor>>&& batch_elements,
                  bool parallel_copy, std::vector<Tensor>* out_tensors);
 
+// Copies the components of `value` that are not already in GPU-compatible
+// (pinned) host memory into pinned host memory. Does nothing if
+// `ctx->allocator` has no pinned allocator, e.g. if no GPU is present.
+Status CopyToPinnedHostMemory(IteratorContext* ctx, std::vector<Tensor>* value);
+
 // Computes the set of experiments to apply based on the job name, task id,
 // rollout percentage of registered experiments, and the
 // TF_DATA_EXPERIMENT_OPT_IN and TF_DATA_EXPERIMENT_OPT_OUT environment
@@ -323,6 +337,9 @@ bool ShouldConfigureMaxIntraOpParallelism(const Options& options);
 // Determines whether private threadpool should be used.
 bool ShouldUsePrivateThreadPool(const Options& options);
 
+// Determines whether threads should be pinned to a NUMA node.
+bool ShouldUseNumaAffinity(const Options& options);
+
 // Determines whether autotuning should be used.
 bool ShouldUseAutotuning(const Options& options);
 
@@ -26,12 +26,15 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/data/test_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -169,6 +172,23 @@ TEST(DatasetUtilsTest, RunnerWithMaxParallelism) {
   runner(fn);
 }
 
+TEST(DatasetUtilsTest, RunnerWithNumaAffinity) {
+  bool ran = false;
+  auto runner = RunnerWithNumaAffinity(
+      [](const std::function<void()> fn) { fn(); }, /*numa_node=*/0);
+  runner([&ran]() { ran = true; });
+  EXPECT_TRUE(ran);
+}
+
+TEST(DatasetUtilsTest, ThreadFactoryWithNumaAffinity) {
+  bool ran = false;
+  auto thread_factory =
+      ThreadFactoryWithNumaAffinity(/*base=*/nullptr, /*numa_node=*/0);
+  // Joins the thread when it goes out of scope.
+  thread_factory->StartThread("test", [&ran]() { ran = true; }).reset();
+  EXPECT_TRUE(ran);
+}
+
 TEST(DatasetUtilsTest, ParseDeterminismPolicy) {
   DeterminismPolicy determinism;
   TF_ASSERT_OK(DeterminismPolicy::FromString("true", &determinism));
@@ -227,6 +247,91 @@ TEST(DatasetUtilsTest, MakeNestedIteratorContext) {
   EXPECT_TRUE(nested_ctx.split_providers().empty());
 }
 
+// Stands in for the GPU host allocator.
+class TestPinnedAllocator : public Allocator {
+ public:
+  explicit TestPinnedAllocator(bool fail_allocations)
+      : fail_allocations_(fail_allocations) {}
+
+  std::string Name() override { return "test_pinned"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    if (fail_allocations_) {
+      return nullptr;
+    }
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+ private:
+  const bool fail_allocations_;
+};
+
+std::string AllocatorName(const Tensor& tensor) {
+  TensorDescription description;
+  tensor.FillDescription(&description);
+  return description.allocation_description().allocator_name();
+}
+
+TEST(DatasetUtilsTest, CopyToPinnedHostMemory) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TestContext> test_ctx,
+                          TestContext::Create());
+  TestPinnedAllocator pinned_allocator(/*fail_allocations=*/false);
+  IteratorContext::Params params(test_ctx->op_ctx());
+  params.allocator_getter = [&pinned_allocator](AllocatorAttributes attrs) {
+    return attrs.gpu_compatible() ? &pinned_allocator : cpu_allocator();
+  };
+  IteratorContext iter_ctx(params);
+
+  Tensor pinned(&pinned_allocator, DT_INT64, TensorShape({2}));
+  test::FillValues<int64_t>(&pinned, {3, 4});
+  std::vector<Tensor> value = {test::AsTensor<int64_t>({1, 2}),
+                               test::AsScalar<tstring>("string"), pinned};
+  const std::vector<Tensor> original = value;
+  TF_ASSERT_OK(CopyToPinnedHostMemory(&iter_ctx, &value));
+
+  // Pageable tensors are copied.
+  EXPECT_EQ(AllocatorName(value[0]), "test_pinned");
+  EXPECT_NE(value[0].data(), original[0].data());
+  test::ExpectTensorEqual<int64_t>(value[0], original[0]);
+  // Strings can't be copied with memcpy and pinned tensors need no copy.
+  EXPECT_EQ(value[1].data(), original[1].data());
+  EXPECT_EQ(value[2].data(), original[2].data());
+}
+
+TEST(DatasetUtilsTest, CopyToPinnedHostMemoryWithoutPinnedAllocator) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TestContext> test_ctx,
+                          TestContext::Create());
+  IteratorContext::Params params(test_ctx->op_ctx());
+  params.allocator_getter = [](AllocatorAttributes attrs) {
+    return cpu_allocator();
+  };
+  IteratorContext iter_ctx(params);
+
+  std::vector<Tensor> value = {test::AsTensor<int64_t>({1, 2})};
+  const void* data = value[0].data();
+  TF_ASSERT_OK(CopyToPinnedHostMemory(&iter_ctx, &value));
+  EXPECT_EQ(value[0].data(), data);
+}
+
+TEST(DatasetUtilsTest, CopyToPinnedHostMemoryAllocationFails) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TestContext> test_ctx,
+                          TestContext::Create());
+  TestPinnedAllocator pinned_allocator(/*fail_allocations=*/true);
+  IteratorContext::Params params(test_ctx->op_ctx());
+  params.allocator_getter = [&pinned_allocator](AllocatorAttributes attrs) {
+    return attrs.gpu_compatible() ? &pinned_allocator : cpu_allocator();
+  };
+  IteratorContext iter_ctx(params);
+
+  std::vector<Tensor> value = {test::AsTensor<int64_t>({1, 2})};
+  EXPECT_THAT(CopyToPinnedHostMemory(&iter_ctx, &value),
+              StatusIs(tsl::error::RESOURCE_EXHAUSTED));
+}
+
 REGISTER_DATASET_EXPERIMENT("test_only_experiment_0",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("test_only_experiment_1",
@@ -0,0 +1,273 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/pipeline_benchmark.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Position of the parallelism input of the dataset ops that have one, counted
+// backwards from their last data input.
+const absl::flat_hash_map<std::string, int>& ParallelismInputOffsets() {
+  static const auto* const kOffsets = new absl::flat_hash_map<std::string, int>(
+      {{"MapAndBatchDataset", 1},
+       {"ParallelBatchDataset", 1},
+       {"ParallelFilterDataset", 0},
+       {"ParallelInterleaveDatasetV2", 0},
+       {"ParallelInterleaveDatasetV3", 0},
+       {"ParallelInterleaveDatasetV4", 0},
+       {"ParallelMapDatasetV2", 0},
+       {"PrefetchDataset", 0}});
+  return *kOffsets;
+}
+
+NodeDef MakeInt64Const(const std::string& name, const std::string& device,
+                       int64_t value) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op("Const");
+  node.set_device(device);
+  (*node.mutable_attr())["dtype"].set_type(DT_INT64);
+  TensorProto* tensor = (*node.mutable_attr())["value"].mutable_tensor();
+  tensor->set_dtype(DT_INT64);
+  tensor->mutable_tensor_shape();
+  tensor->add_int64_val(value);
+  return node;
+}
+
+// Counters of a model node that accumulate over the lifetime of the iterator.
+struct NodeCounters {
+  int64_t num_elements = 0;
+  int64_t processing_time_ns = 0;
+};
+
+std::vector<std::shared_ptr<model::Node>> ModelNodes(
+    const model::Model* model) {
+  if (model == nullptr || model->output() == nullptr) return {};
+  std::shared_ptr<model::Node> output = model->output();
+  std::vector<std::shared_ptr<model::Node>> nodes = {output};
+  for (const auto& node :
+       output->CollectNodes(model::TraversalOrder::BFS, model::IsAnyNode)) {
+    nodes.push_back(node);
+  }
+  return nodes;
+}
+
+absl::flat_hash_map<std::string, NodeCounters> SnapshotCounters(
+    const model::Model* model) {
+  absl::flat_hash_map<std::string, NodeCounters> counters;
+  for (const auto& node : ModelNodes(model)) {
+    counters[node->long_name()] = {node->num_elements(),
+                                   node->processing_time()};
+  }
+  return counters;
+}
+
+// Returns the parallelism of `node`, or its buffer size for nodes that
+// prefetch without parallelism.
+std::optional<double> Parallelism(const model::Node& node) {
+  absl::StatusOr<double> parallelism = node.ParameterValue(model::kParallelism);
+  if (parallelism.ok() && *parallelism > 0) return *parallelism;
+  absl::StatusOr<double> buffer_size = node.ParameterValue(model::kBufferSize);
+  if (buffer_size.ok() && *buffer_size > 0) return *buffer_size;
+  return std::nullopt;
+}
+
+}  // namespace
+
+Status ApplyParallelismOverrides(
+    const absl::flat_hash_map<std::string, int64_t>& overrides,
+    GraphDef* graph_def) {
+  absl::flat_hash_set<std::string> used_keys;
+  std::vector<NodeDef> new_nodes;
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    auto offset = ParallelismInputOffsets().find(node.op());
+    if (offset == ParallelismInputOffsets().end()) continue;
+    auto value = overrides.find(node.name());
+    if (value == overrides.end()) value = overrides.find(node.op());
+    if (value == overrides.end()) continue;
+    used_keys.insert(value->first);
+
+    int last_data_input = node.input_size() - 1;
+    while (last_data_input >= 0 &&
+           absl::StartsWith(node.input(last_data_input), "^")) {
+      --last_data_input;
+    }
+    const int input_index = last_data_input - offset->second;
+    if (input_index < 1) {
+      return errors::InvalidArgument("Dataset node ", node.name(),
+                                     " has too few inputs to override its "
+                                     "parallelism.");
+    }
+    // The parallelism may come from a constant shared with other nodes, so a
+    // new constant is added instead of rewriting it.
+    const std::string const_name =
+        absl::StrCat(node.name(), "/parallelism_override");
+    new_nodes.push_back(
+        MakeInt64Const(const_name, node.device(), value->second));
+    node.set_input(input_index, const_name);
+  }
+  for (NodeDef& node : new_nodes) {
+    *graph_def->add_node() = std::move(node);
+  }
+  for (const auto& [key, value] : overrides) {
+    if (!used_keys.contains(key)) {
+      return errors::InvalidArgument(
+          "Parallelism override ", key, "=", value,
+          " matches no dataset node whose parallelism can be overridden.");
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<PipelineBenchmarkResult> RunPipelineBenchmark(
+    GraphDef graph_def, const PipelineBenchmarkOptions& options) {
+  TF_RETURN_IF_ERROR(
+      ApplyParallelismOverrides(options.parallelism_overrides, &graph_def));
+  std::unique_ptr<standalone::Dataset> dataset;
+  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<standalone::Iterator> iterator;
+  TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+
+  bool end_of_input = false;
+  std::vector<Tensor> outputs;
+  for (int64_t i = 0; i < options.warmup_elements && !end_of_input; ++i) {
+    outputs.clear();
+    TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &end_of_input));
+  }
+
+  // The model is null if autotuning is disabled for the pipeline.
+  std::shared_ptr<model::Model> model = iterator->model();
+  absl::flat_hash_map<std::string, NodeCounters> start_counters =
+      SnapshotCounters(model.get());
+  absl::flat_hash_map<std::string, int64_t> buffered_elements;
+  int64_t num_buffer_samples = 0;
+
+  Env* env = Env::Default();
+  const uint64_t start_usecs = env->NowMicros();
+  const uint64_t deadline_usecs =
+      start_usecs + absl::ToInt64Microseconds(options.max_duration);
+  PipelineBenchmarkResult result;
+  while (!end_of_input &&
+         (options.max_elements < 0 ||
+          result.num_elements < options.max_elements) &&
+         env->NowMicros() < deadline_usecs) {
+    outputs.clear();
+    TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &end_of_input));
+    if (end_of_input) break;
+    ++result.num_elements;
+    if (model != nullptr && options.buffer_sample_interval > 0 &&
+        result.num_elements % options.buffer_sample_interval == 0) {
+      for (const auto& node : ModelNodes(model.get())) {
+        buffered_elements[node->long_name()] += node->buffered_elements();
+      }
+      ++num_buffer_samples;
+    }
+  }
+  result.wall_time_seconds = (env->NowMicros() - start_usecs) / 1e6;
+  if (result.wall_time_seconds > 0) {
+    result.elements_per_second =
+        result.num_elements / result.wall_time_seconds;
+  }
+
+  double max_busy_fraction = -1.0;
+  for (const auto& node : ModelNodes(model.get())) {
+    PipelineStageStats stage;
+    stage.name = node->long_name();
+    const NodeCounters& start = start_counters[stage.name];
+    stage.num_elements = node->num_elements() - start.num_elements;
+    stage.cpu_time_seconds =
+        (node->processing_time() - start.processing_time_ns) / 1e9;
+    if (stage.num_elements > 0) {
+      stage.cpu_time_per_element_usecs =
+          stage.cpu_time_seconds * 1e6 / stage.num_elements;
+    }
+    if (result.wall_time_seconds > 0) {
+      stage.elements_per_second =
+          stage.num_elements / result.wall_time_seconds;
+    }
+    stage.parallelism = Parallelism(*node);
+    if (stage.parallelism.has_value() && num_buffer_samples > 0) {
+      stage.buffer_utilization =
+          static_cast<double>(buffered_elements[stage.name]) /
+          num_buffer_samples / *stage.parallelism;
+    }
+    if (result.wall_time_seconds > 0) {
+      stage.busy_fraction = stage.cpu_time_seconds /
+                            stage.parallelism.value_or(1.0) /
+                            result.wall_time_seconds;
+    }
+    if (stage.busy_fraction > max_busy_fraction) {
+      max_busy_fraction = stage.busy_fraction;
+      result.bottleneck = stage.name;
+    }
+    result.stages.push_back(std::move(stage));
+  }
+  return result;
+}
+
+std::string FormatPipelineBenchmarkResult(
+    const PipelineBenchmarkResult& result) {
+  std::string output = absl::StrFormat(
+      "%d elements in %.3fs (%.1f elements/s)\n", result.num_elements,
+      result.wall_time_seconds, result.elements_per_second);
+  absl::StrAppendFormat(&output, "%-40s %12s %12s %12s %11s %11s %8s\n",
+                        "Iterator", "Elements/s", "CPU time(s)", "us/element",
+                        "Parallelism", "Buffer util", "Busy");
+  for (const PipelineStageStats& stage : result.stages) {
+    absl::StrAppendFormat(
+        &output, "%-40s %12.1f %12.3f %12.1f %11s %11s %7.1f%%%s\n",
+        stage.name, stage.elements_per_second, stage.cpu_time_seconds,
+        stage.cpu_time_per_element_usecs,
+        stage.parallelism.has_value()
+            ? absl::StrFormat("%.0f", *stage.parallelism)
+            : "-",
+        stage.buffer_utilization.has_value()
+            ? absl::StrFormat("%.1f%%", 100 * *stage.buffer_utilization)
+            : "-",
+        100 * stage.busy_fraction,
+        stage.name == result.bottleneck ? " <- bottleneck" : "");
+  }
+  return output;
+}
+
+}  // namespace data
+}  // namespace tensorflow
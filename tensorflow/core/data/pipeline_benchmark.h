@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
+#define TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Runs a serialized tf.data input pipeline standalone (see `standalone.h`) and
+// reports the throughput and resource usage of each of its iterators, so that
+// input pipelines can be tuned offline.
+//
+// Example usage:
+//
+//   PipelineBenchmarkOptions options;
+//   options.max_elements = 10000;
+//   TF_ASSIGN_OR_RETURN(PipelineBenchmarkResult result,
+//                       RunPipelineBenchmark(graph_def, options));
+//   LOG(INFO) << FormatPipelineBenchmarkResult(result);
+
+struct PipelineBenchmarkOptions {
+  // Number of elements to produce before measurements start.
+  int64_t warmup_elements = 0;
+  // Stops after producing this many elements. -1 means no limit.
+  int64_t max_elements = -1;
+  // Stops after running for this long.
+  absl::Duration max_duration = absl::Seconds(60);
+  // Number of produced elements between samples of the buffered elements.
+  int64_t buffer_sample_interval = 16;
+  // Overrides the parallelism of the dataset nodes, keyed by GraphDef node
+  // name or dataset op type. See `ApplyParallelismOverrides`.
+  absl::flat_hash_map<std::string, int64_t> parallelism_overrides;
+};
+
+// Statistics of one iterator of the benchmarked pipeline.
+struct PipelineStageStats {
+  // Name of the iterator in the autotuning model, e.g. "ParallelMapV2(id:3)".
+  std::string name;
+  int64_t num_elements = 0;
+  double elements_per_second = 0.0;
+  // CPU time spent in this iterator, excluding its inputs.
+  double cpu_time_seconds = 0.0;
+  // CPU time spent in this iterator per produced element.
+  double cpu_time_per_element_usecs = 0.0;
+  // Parallelism or buffer size of the iterator, if it has one.
+  std::optional<double> parallelism;
+  // Average number of buffered elements as a fraction of the buffer capacity,
+  // if the iterator buffers elements.
+  std::optional<double> buffer_utilization;
+  // CPU time divided by the parallelism and the wall time of the run.
+  double busy_fraction = 0.0;
+};
+
+struct PipelineBenchmarkResult {
+  int64_t num_elements = 0;
+  double wall_time_seconds = 0.0;
+  double elements_per_second = 0.0;
+  // Iterators in breadth-first order from the output of the pipeline.
+  std::vector<PipelineStageStats> stages;
+  // Name of the iterator that was busy for the largest fraction of the time,
+  // i.e. whose CPU time divided by its parallelism covers the most of the wall
+  // time. Empty if autotuning is disabled for the pipeline, since no
+  // per-iterator statistics are collected then.
+  std::string bottleneck;
+};
+
+// Rewrites the parallelism of the dataset nodes in `graph_def`. Each key of
+// `overrides` is either a node name or a dataset op type, e.g.
+// "ParallelMapDatasetV2", and node names take precedence. For
+// `PrefetchDataset` the value overrides the buffer size. Returns an error if a
+// key matches no node whose parallelism can be overridden.
+Status ApplyParallelismOverrides(
+    const absl::flat_hash_map<std::string, int64_t>& overrides,
+    GraphDef* graph_def);
+
+// Builds the dataset in `graph_def`, iterates over it and returns the
+// statistics of its iterators.
+absl::StatusOr<PipelineBenchmarkResult> RunPipelineBenchmark(
+    GraphDef graph_def, const PipelineBenchmarkOptions& options);
+
+// Returns a human readable table of `result`.
+std::string FormatPipelineBenchmarkResult(
+    const PipelineBenchmarkResult& result);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_PIPELINE_BENCHMARK_H_
@@ -0,0 +1,144 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Runs a serialized tf.data input pipeline standalone and reports the
+// throughput, CPU time and buffer utilization of each of its iterators.
+//
+// Example usage:
+//
+//   pipeline_benchmark --graph=/tmp/dataset_graph.pb --max_elements=10000 \
+//     --what_if="ParallelMapDatasetV2=16;ParallelMapDatasetV2=32"
+//
+// The dataset graph can be obtained in Python with
+// `tf.data.Dataset._as_serialized_graph()`. Each `--what_if` scenario is a
+// comma-separated list of `<node name or op type>=<parallelism>` overrides and
+// reruns the pipeline with them applied.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/data/pipeline_benchmark.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+absl::StatusOr<absl::flat_hash_map<std::string, int64_t>> ParseScenario(
+    absl::string_view scenario) {
+  absl::flat_hash_map<std::string, int64_t> overrides;
+  for (absl::string_view entry :
+       absl::StrSplit(scenario, ',', absl::SkipWhitespace())) {
+    std::vector<absl::string_view> key_value = absl::StrSplit(entry, '=');
+    int64_t value;
+    if (key_value.size() != 2 || !absl::SimpleAtoi(key_value[1], &value)) {
+      return errors::InvalidArgument("Invalid parallelism override: ", entry);
+    }
+    overrides[key_value[0]] = value;
+  }
+  return overrides;
+}
+
+Status LoadGraph(const std::string& path, GraphDef* graph_def) {
+  if (ReadBinaryProto(Env::Default(), path, graph_def).ok()) {
+    return absl::OkStatus();
+  }
+  return ReadTextProto(Env::Default(), path, graph_def);
+}
+
+Status RunBenchmarks(const std::string& graph_path,
+                     const PipelineBenchmarkOptions& options,
+                     const std::string& what_if) {
+  GraphDef graph_def;
+  TF_RETURN_IF_ERROR(LoadGraph(graph_path, &graph_def));
+
+  TF_ASSIGN_OR_RETURN(PipelineBenchmarkResult baseline,
+                      RunPipelineBenchmark(graph_def, options));
+  LOG(INFO) << "Baseline:\n" << FormatPipelineBenchmarkResult(baseline);
+
+  for (absl::string_view scenario :
+       absl::StrSplit(what_if, ';', absl::SkipWhitespace())) {
+    PipelineBenchmarkOptions scenario_options = options;
+    TF_ASSIGN_OR_RETURN(scenario_options.parallelism_overrides,
+                        ParseScenario(scenario));
+    TF_ASSIGN_OR_RETURN(PipelineBenchmarkResult result,
+                        RunPipelineBenchmark(graph_def, scenario_options));
+    LOG(INFO) << "What-if " << scenario << " ("
+              << (baseline.elements_per_second > 0
+                      ? result.elements_per_second /
+                            baseline.elements_per_second
+                      : 0.0)
+              << "x baseline throughput):\n"
+              << FormatPipelineBenchmarkResult(result);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
+
+int main(int argc, char* argv[]) {
+  std::string graph;
+  std::string what_if;
+  int64_t warmup_elements = 0;
+  int64_t max_elements = -1;
+  int64_t max_seconds = 60;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("graph", &graph,
+                       "path to the binary or text GraphDef of the dataset"),
+      tensorflow::Flag("warmup_elements", &warmup_elements,
+                       "number of elements to produce before measuring"),
+      tensorflow::Flag("max_elements", &max_elements,
+                       "number of elements to measure, -1 for all"),
+      tensorflow::Flag("max_seconds", &max_seconds,
+                       "maximum duration of each measured run"),
+      tensorflow::Flag("what_if", &what_if,
+                       "';'-separated scenarios of ','-separated "
+                       "<node name or op type>=<parallelism> overrides"),
+  };
+  std::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  const bool parse_result = tensorflow::Flags::Parse(&argc, argv, flag_list);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (!parse_result || argc > 1 || graph.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  tensorflow::data::PipelineBenchmarkOptions options;
+  options.warmup_elements = warmup_elements;
+  options.max_elements = max_elements;
+  options.max_duration = absl::Seconds(max_seconds);
+  tensorflow::Status status =
+      tensorflow::data::RunBenchmarks(graph, options, what_if);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return -1;
+  }
+  return 0;
+}
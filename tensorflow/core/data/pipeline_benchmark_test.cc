@@ -0,0 +1,167 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/pipeline_benchmark.h"
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string Int64ConstNode(const std::string& name, int64_t value) {
+  return absl::StrCat("node { name: '", name, "' op: 'Const' ",
+                      "attr { key: 'dtype' value { type: DT_INT64 } } ",
+                      "attr { key: 'value' value { tensor { dtype: DT_INT64 ",
+                      "tensor_shape {} int64_val: ", value, " } } } }");
+}
+
+// range(100).prefetch(buffer_size)
+GraphDef RangePrefetchGraph(int64_t buffer_size) {
+  std::string graph = absl::StrCat(
+      Int64ConstNode("start", 0), Int64ConstNode("stop", 100),
+      Int64ConstNode("step", 1), Int64ConstNode("buffer_size", buffer_size),
+      R"pb(
+        node {
+          name: "range"
+          op: "RangeDataset"
+          input: "start"
+          input: "stop"
+          input: "step"
+          attr {
+            key: "output_shapes"
+            value { list { shape {} } }
+          }
+          attr {
+            key: "output_types"
+            value { list { type: DT_INT64 } }
+          }
+        }
+        node {
+          name: "prefetch"
+          op: "PrefetchDataset"
+          input: "range"
+          input: "buffer_size"
+          attr {
+            key: "output_shapes"
+            value { list { shape {} } }
+          }
+          attr {
+            key: "output_types"
+            value { list { type: DT_INT64 } }
+          }
+        }
+        node {
+          name: "dataset"
+          op: "_Retval"
+          input: "prefetch"
+          attr {
+            key: "T"
+            value { type: DT_VARIANT }
+          }
+          attr {
+            key: "index"
+            value { i: 0 }
+          }
+        }
+        versions { producer: 1594 }
+      )pb");
+  GraphDef graph_def;
+  CHECK(protobuf::TextFormat::ParseFromString(graph, &graph_def));
+  return graph_def;
+}
+
+const NodeDef* FindNode(const GraphDef& graph_def, const std::string& name) {
+  for (const NodeDef& node : graph_def.node()) {
+    if (node.name() == name) return &node;
+  }
+  return nullptr;
+}
+
+TEST(PipelineBenchmarkTest, OverridesParallelismByOpType) {
+  GraphDef graph_def = RangePrefetchGraph(/*buffer_size=*/-1);
+  TF_ASSERT_OK(
+      ApplyParallelismOverrides({{"PrefetchDataset", 4}}, &graph_def));
+  const NodeDef* prefetch = FindNode(graph_def, "prefetch");
+  ASSERT_NE(prefetch, nullptr);
+  EXPECT_EQ(prefetch->input(1), "prefetch/parallelism_override");
+  const NodeDef* override_node =
+      FindNode(graph_def, "prefetch/parallelism_override");
+  ASSERT_NE(override_node, nullptr);
+  EXPECT_EQ(override_node->attr().at("value").tensor().int64_val(0), 4);
+  // The original constant is left in place.
+  ASSERT_NE(FindNode(graph_def, "buffer_size"), nullptr);
+}
+
+TEST(PipelineBenchmarkTest, RejectsUnmatchedOverride) {
+  GraphDef graph_def = RangePrefetchGraph(/*buffer_size=*/-1);
+  EXPECT_FALSE(ApplyParallelismOverrides({{"range", 4}}, &graph_def).ok());
+  EXPECT_FALSE(
+      ApplyParallelismOverrides({{"ParallelMapDatasetV2", 4}}, &graph_def)
+          .ok());
+}
+
+TEST(PipelineBenchmarkTest, ReportsStages) {
+  PipelineBenchmarkOptions options;
+  options.warmup_elements = 10;
+  options.buffer_sample_interval = 1;
+  TF_ASSERT_OK_AND_ASSIGN(
+      PipelineBenchmarkResult result,
+      RunPipelineBenchmark(RangePrefetchGraph(/*buffer_size=*/2), options));
+  EXPECT_EQ(result.num_elements, 90);
+  EXPECT_GT(result.elements_per_second, 0);
+  EXPECT_FALSE(result.bottleneck.empty());
+
+  bool found_prefetch = false;
+  for (const PipelineStageStats& stage : result.stages) {
+    if (!absl::StartsWith(stage.name, "Prefetch")) continue;
+    found_prefetch = true;
+    ASSERT_TRUE(stage.parallelism.has_value());
+    EXPECT_EQ(*stage.parallelism, 2);
+    EXPECT_TRUE(stage.buffer_utilization.has_value());
+  }
+  EXPECT_TRUE(found_prefetch);
+  EXPECT_TRUE(absl::StrContains(FormatPipelineBenchmarkResult(result),
+                                "elements/s"));
+}
+
+TEST(PipelineBenchmarkTest, WhatIfOverride) {
+  PipelineBenchmarkOptions options;
+  options.max_elements = 50;
+  options.parallelism_overrides = {{"prefetch", 8}};
+  TF_ASSERT_OK_AND_ASSIGN(
+      PipelineBenchmarkResult result,
+      RunPipelineBenchmark(RangePrefetchGraph(/*buffer_size=*/2), options));
+  EXPECT_EQ(result.num_elements, 50);
+  for (const PipelineStageStats& stage : result.stages) {
+    if (absl::StartsWith(stage.name, "Prefetch")) {
+      EXPECT_EQ(stage.parallelism, 8);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
@@ -52,6 +53,7 @@ constexpr char kReadRoundtripLatency[] = "read_latency_usec";
 constexpr char kReadResponseBytes[] = "read_bytes";
 constexpr char kIntraOpParallelism[] = "intra_op_parallelism";
 constexpr char kMemBandwidth[] = "mem_bw_used_megabytes_per_sec";
+constexpr char kNumaNode[] = "numa_node";
 constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
 constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
@@ -72,6 +74,9 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
     params->private_threadpool_size =
         options.threading_options().private_threadpool_size();
   }
+  if (ShouldUseNumaAffinity(options)) {
+    params->numa_node = options.threading_options().numa_node();
+  }
   params->autotune = ShouldUseAutotuning(options);
   params->autotune_algorithm = model::AutotuneAlgorithm::DEFAULT;
   auto experiments = GetExperiments();
@@ -135,6 +140,11 @@ void AddTraceMetadata(const RootDataset::Params& params, const Options& options,
                                     params.private_threadpool_size, 0,
                                     port::MaxParallelism())))));
   }
+  if (params.numa_node != port::kNUMANoAffinity) {
+    trace_metadata->push_back(std::make_pair(
+        kNumaNode,
+        strings::Printf("%lld", static_cast<long long>(params.numa_node))));
+  }
   auto experiments = GetExperiments();
   if (!experiments.empty()) {
     trace_metadata->push_back(
@@ -187,6 +197,17 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
           Env::Default(), ThreadOptions{}, "data_private_threadpool",
           threadpool_size_);
     }
+    const int64_t numa_node = dataset()->params_.numa_node;
+    if (numa_node != port::kNUMANoAffinity) {
+      if (port::NUMANumNodes() > 1 && numa_node >= 0 &&
+          numa_node < port::NUMANumNodes()) {
+        numa_node_ = numa_node;
+      } else {
+        LOG_FIRST_N(WARNING, 1)
+            << "Ignoring tf.data NUMA node " << numa_node << " because the "
+            << "host has " << port::NUMANumNodes() << " NUMA node(s).";
+      }
+    }
     cancellation_manager_ = std::make_unique<CancellationManager>();
   }
 
@@ -217,6 +238,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
         model_->AddExperiment("autotune_buffer_optimization");
       }
     }
+    if (numa_node_ != port::kNUMANoAffinity) {
+      numa_thread_factory_ =
+          ThreadFactoryWithNumaAffinity(ctx->thread_factory(), numa_node_);
+    }
     IteratorContext iter_ctx(CreateParams(ctx));
     if (model_) {
       auto factory = [&iter_ctx, this](model::Node::Args args) {
@@ -332,6 +357,15 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       };
       params.runner_threadpool_size = threadpool_size_;
     }
+    if (numa_thread_factory_) {
+      // Threads that tf.data starts itself, and the threads of the private
+      // threadpool, are pinned. Functions run by a shared runner are not, as
+      // pinning would also affect the other work of its threads.
+      params.thread_factory = numa_thread_factory_;
+      if (dataset()->params_.private_threadpool_size >= 0) {
+        params.runner = RunnerWithNumaAffinity(params.runner, numa_node_);
+      }
+    }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       params.runner =
           RunnerWithMaxParallelism(params.runner, max_intra_op_parallelism_);
@@ -378,6 +412,10 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   int64_t max_intra_op_parallelism_;
   int64_t threadpool_size_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
+  int64_t numa_node_ = port::kNUMANoAffinity;
+  // Starts threads pinned to `numa_node_`, if set. Must outlive `input_impl_`,
+  // which owns the threads.
+  std::shared_ptr<ThreadFactory> numa_thread_factory_;
 
   // The end time of the previous `GetNextInternal` call.
   uint64_t end_time_usec_ TF_GUARDED_BY(mu_) = 0;
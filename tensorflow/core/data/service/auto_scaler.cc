@@ -22,10 +22,12 @@ limitations under the License.
 #include <numeric>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -37,6 +39,45 @@ namespace data {
 
 constexpr double kAutoScalerOutlierSigmas = 1.0;
 
+namespace {
+
+using WorkerScalingActuatorFactories =
+    absl::flat_hash_map<std::string, WorkerScalingActuator::Factory>;
+
+tsl::mutex* GetWorkerScalingActuatorFactoriesLock() {
+  static tsl::mutex* lock = new tsl::mutex();
+  return lock;
+}
+
+WorkerScalingActuatorFactories& GetWorkerScalingActuatorFactories() {
+  static auto* factories = new WorkerScalingActuatorFactories();
+  return *factories;
+}
+
+}  // namespace
+
+void WorkerScalingActuator::Register(const std::string& name,
+                                     Factory factory) {
+  tsl::mutex_lock l(*GetWorkerScalingActuatorFactoriesLock());
+  if (!GetWorkerScalingActuatorFactories()
+           .insert({name, std::move(factory)})
+           .second) {
+    LOG(ERROR) << "Two worker scaling actuators are being registered as "
+               << name << ". Which one gets used is undefined.";
+  }
+}
+
+absl::StatusOr<std::unique_ptr<WorkerScalingActuator>>
+WorkerScalingActuator::Create(const std::string& name) {
+  tsl::mutex_lock l(*GetWorkerScalingActuatorFactoriesLock());
+  auto it = GetWorkerScalingActuatorFactories().find(name);
+  if (it == GetWorkerScalingActuatorFactories().end()) {
+    return absl::NotFoundError(absl::StrCat(
+        "No worker scaling actuator has been registered as ", name));
+  }
+  return it->second();
+}
+
 template <typename T>
 double GetMedian(const absl::flat_hash_map<T, double>& rates) {
   std::vector<double> sorted_rates;
@@ -239,9 +280,21 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
   metrics::RecordTFDataServiceOptimalNumberOfWorkers(
       bound_optimal_number_of_workers);
 
+  tsl::tf_shared_lock l(mu_);
+  if (actuator_ != nullptr &&
+      bound_optimal_number_of_workers != current_number_of_workers) {
+    return actuator_->RequestNumberOfWorkers(current_number_of_workers,
+                                             bound_optimal_number_of_workers);
+  }
   return absl::OkStatus();
 }
 
+void MultipleIterationsAutoScaler::SetWorkerScalingActuator(
+    std::unique_ptr<WorkerScalingActuator> actuator) TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  actuator_ = std::move(actuator);
+}
+
 std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
     const TF_LOCKS_EXCLUDED(mu_) {
   int64_t optimal_number_of_workers = 0;
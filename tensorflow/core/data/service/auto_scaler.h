@@ -17,11 +17,13 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALER_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
@@ -104,6 +106,33 @@ class AutoScaler {
   absl::flat_hash_map<int64_t, double> consumption_rates_ TF_GUARDED_BY(mu_);
 };
 
+// Acts on the number of workers estimated by the AutoScaler, e.g. by asking an
+// external orchestrator to add or remove tf.data service workers.
+// Implementations are registered by name with `Register` and selected with
+// `DispatcherConfig.worker_scaling_actuator`.
+class WorkerScalingActuator {
+ public:
+  using Factory = std::function<std::unique_ptr<WorkerScalingActuator>()>;
+
+  virtual ~WorkerScalingActuator() = default;
+
+  // Requests resizing the cluster from `current_number_of_workers` to
+  // `target_number_of_workers`. It is called from the dispatcher's maintenance
+  // thread each time the estimate differs from the current number of workers,
+  // so implementations should return quickly and apply their own damping
+  // (e.g. a cooldown between scale-downs).
+  virtual absl::Status RequestNumberOfWorkers(
+      int64_t current_number_of_workers, int64_t target_number_of_workers) = 0;
+
+  // Registers `factory` under `name`.
+  static void Register(const std::string& name, Factory factory);
+
+  // Creates the actuator registered under `name`. Returns NotFound if there is
+  // none.
+  static absl::StatusOr<std::unique_ptr<WorkerScalingActuator>> Create(
+      const std::string& name);
+};
+
 // Exports a metric (/tensorflow/data/service/optimal_number_of_workers) with
 // the estimated optimal number of tf.data service workers, according to
 // the observed cluster workload.
@@ -120,10 +149,13 @@ class MultipleIterationsAutoScaler {
   // Returns an error if the specified iteration does not exist.
   absl::Status UnregisterIteration(int64_t iteration_id) TF_LOCKS_EXCLUDED(mu_);
   // Updates the metric value with the current estimated optimal number of
-  // workers. The estimate is limited to min(4 * `current_number_of_workers`,
+  // workers, and forwards it to the worker scaling actuator if one is set and
+  // the estimate differs from `current_number_of_workers`. The estimate is
+  // limited to min(4 * `current_number_of_workers`,
   // `current_number_of_workers` + 500). Returns an error if there are no
   // previously reported processing and target processing times for at least one
-  // iteration, or `current_number_of_workers` is not positive.
+  // iteration, `current_number_of_workers` is not positive, or the actuator
+  // fails.
   absl::Status UpdateOptimalNumberOfWorkersMetric(
       int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_);
   // Returns the estimated optimal number of workers according to the current
@@ -160,6 +192,10 @@ class MultipleIterationsAutoScaler {
   // `iteration_id` and the specified consumer.
   absl::Status RemoveConsumer(int64_t iteration_id, int64_t consumer_id)
       TF_LOCKS_EXCLUDED(mu_);
+  // Sets the actuator that the estimated optimal number of workers is
+  // forwarded to by `UpdateOptimalNumberOfWorkersMetric`.
+  void SetWorkerScalingActuator(
+      std::unique_ptr<WorkerScalingActuator> actuator) TF_LOCKS_EXCLUDED(mu_);
 
  private:
   // Registers iteration with `iteration_id` if it does not exist already,
@@ -171,6 +207,7 @@ class MultipleIterationsAutoScaler {
   // Map from iteration id to AutoScaler.
   absl::flat_hash_map<int64_t, std::unique_ptr<AutoScaler>> auto_scalers_
       TF_GUARDED_BY(mu_);
+  std::unique_ptr<WorkerScalingActuator> actuator_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace data
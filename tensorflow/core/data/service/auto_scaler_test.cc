@@ -15,13 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/auto_scaler.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "absl/time/time.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
@@ -29,6 +34,25 @@ namespace {
 
 using ::tsl::testing::StatusIs;
 
+// Records the requests it receives in `requests`.
+class FakeWorkerScalingActuator : public WorkerScalingActuator {
+ public:
+  explicit FakeWorkerScalingActuator(
+      std::vector<std::pair<int64_t, int64_t>>* requests)
+      : requests_(requests) {}
+
+  absl::Status RequestNumberOfWorkers(
+      int64_t current_number_of_workers,
+      int64_t target_number_of_workers) override {
+    requests_->push_back(
+        {current_number_of_workers, target_number_of_workers});
+    return absl::OkStatus();
+  }
+
+ private:
+  std::vector<std::pair<int64_t, int64_t>>* const requests_;
+};
+
 TEST(AutoScalerTest, GetOptimalNumberOfWorkersInitialState) {
   AutoScaler auto_scaler;
   EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), std::nullopt);
@@ -743,6 +767,43 @@ TEST(MultipleIterationsAutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0, 0));
 }
 
+TEST(MultipleIterationsAutoScalerTest, ActuatorReceivesBoundEstimate) {
+  MultipleIterationsAutoScaler auto_scaler;
+  std::vector<std::pair<int64_t, int64_t>> requests;
+  auto_scaler.SetWorkerScalingActuator(
+      std::make_unique<FakeWorkerScalingActuator>(&requests));
+
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(1)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  // Estimated workers = 10, limited to 4 * 2 = 8.
+  TF_ASSERT_OK(auto_scaler.UpdateOptimalNumberOfWorkersMetric(2));
+  // Estimated workers = 10, which is the current number of workers.
+  TF_ASSERT_OK(auto_scaler.UpdateOptimalNumberOfWorkersMetric(10));
+  // Estimated workers = 10, scaling down from 20.
+  TF_ASSERT_OK(auto_scaler.UpdateOptimalNumberOfWorkersMetric(20));
+  EXPECT_THAT(requests, ::testing::ElementsAre(std::make_pair(2, 8),
+                                               std::make_pair(20, 10)));
+  metrics::RecordTFDataServiceOptimalNumberOfWorkers(0);
+}
+
+TEST(WorkerScalingActuatorTest, CreateRegisteredActuator) {
+  std::vector<std::pair<int64_t, int64_t>> requests;
+  WorkerScalingActuator::Register("fake", [&requests]() {
+    return std::make_unique<FakeWorkerScalingActuator>(&requests);
+  });
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<WorkerScalingActuator> actuator,
+                          WorkerScalingActuator::Create("fake"));
+  TF_ASSERT_OK(actuator->RequestNumberOfWorkers(1, 2));
+  EXPECT_THAT(requests, ::testing::ElementsAre(std::make_pair(1, 2)));
+}
+
+TEST(WorkerScalingActuatorTest, CreateUnregisteredActuator) {
+  EXPECT_THAT(WorkerScalingActuator::Create("unregistered"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 
 }  // namespace data
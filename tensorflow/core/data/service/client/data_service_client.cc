@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/data/service/client/data_service_client.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -29,12 +31,14 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/client/common.h"
 #include "tensorflow/core/data/service/client/validate_utils.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/compression_cost_model.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/worker_client.h"
@@ -42,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.h"
@@ -78,10 +83,39 @@ absl::StatusOr<DataTransferServerInfo> GetTransferServer(
                           task_info.worker_address());
 }
 
+// Returns the topology tags of this client (e.g. "host:h1,rack:r1,zone:z1"),
+// read from the TF_DATA_SERVICE_CLIENT_TAGS environment variable.
+std::vector<std::string> ClientTagsFromEnv() {
+  const char* tags = std::getenv("TF_DATA_SERVICE_CLIENT_TAGS");
+  if (tags == nullptr) {
+    return {};
+  }
+  return absl::StrSplit(tags, ',', absl::SkipWhitespace());
+}
+
+// Returns the number of bytes received for `components`, counting compressed
+// elements by their serialized size.
+int64_t TransferredBytes(const std::vector<Tensor>& components) {
+  int64_t bytes = 0;
+  for (const Tensor& component : components) {
+    if (component.dtype() == DT_VARIANT && component.NumElements() == 1) {
+      const CompressedElement* compressed =
+          component.scalar<Variant>()().get<CompressedElement>();
+      if (compressed != nullptr) {
+        bytes += compressed->ByteSizeLong();
+        continue;
+      }
+    }
+    bytes += component.TotalBytes();
+  }
+  return bytes;
+}
+
 }  // namespace
 
 DataServiceClient::DataServiceClient(const DataServiceParams& params)
     : params_(params),
+      client_tags_(ClientTagsFromEnv()),
       max_outstanding_requests_(params.max_outstanding_requests) {}
 
 DataServiceClient::~DataServiceClient() {
@@ -445,6 +479,7 @@ Status DataServiceClient::AddTask(const TaskInfo& task_info)
 void DataServiceClient::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   ClientHeartbeatRequest req;
   req.set_iteration_client_id(iteration_client_id_);
+  *req.mutable_client_tags() = {client_tags_.begin(), client_tags_.end()};
   if (IsCoordinatedRead()) {
     mutex_lock l(mu_);
     req.set_current_round(current_round_);
@@ -769,7 +804,17 @@ Status DataServiceClient::TryGetElement(const Task& task, bool allow_skip,
   if (params_.cross_trainer_cache_options) {
     req.set_trainer_id(params_.cross_trainer_cache_options->trainer_id());
   }
-  return task.worker->GetElement(req, result);
+  if (!CompressionCostModel::Enabled()) {
+    return task.worker->GetElement(req, result);
+  }
+  const uint64_t start_us = Env::Default()->NowMicros();
+  TF_RETURN_IF_ERROR(task.worker->GetElement(req, result));
+  if (!result.end_of_sequence && !result.skip) {
+    CompressionCostModel::Global()->RecordTransfer(
+        TransferredBytes(result.components),
+        Env::Default()->NowMicros() - start_us);
+  }
+  return absl::OkStatus();
 }
 
 void DataServiceClient::ProcessGetElementResponse(
@@ -193,6 +193,8 @@ class DataServiceClient {
   std::string DebugString() const;
 
   const DataServiceParams params_;
+  // Topology tags sent to the dispatcher for locality-aware reads.
+  const std::vector<std::string> client_tags_;
 
   mutable mutex mu_;
   condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
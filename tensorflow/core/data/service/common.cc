@@ -16,7 +16,10 @@ limitations under the License.
 
 #include <string>
 
+#include "absl/algorithm/container.h"
+#include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/platform/errors.h"
@@ -131,6 +134,19 @@ absl::StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s) {
                                  "COLOCATED, REMOTE, and HYBRID.");
 }
 
+int TopologyDistance(absl::Span<const std::string> worker_tags,
+                     absl::Span<const std::string> client_tags) {
+  for (int level = 0; level < kNumTopologyLevels; ++level) {
+    for (const std::string& tag : client_tags) {
+      if (absl::StartsWith(tag, kTopologyTagPrefixes[level]) &&
+          absl::c_linear_search(worker_tags, tag)) {
+        return level;
+      }
+    }
+  }
+  return kNumTopologyLevels;
+}
+
 bool IsPreemptedError(const Status& status) {
   return errors::IsAborted(status) || errors::IsCancelled(status) ||
          errors::IsUnavailable(status);
@@ -19,6 +19,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -39,6 +40,12 @@ constexpr int kDataServiceVersion = 9;
 // workers on other TF hosts when the host runs a local tf.data service worker.
 constexpr absl::string_view kColocatedWorkerTag = "COLOCATED";
 
+// Prefixes of the worker and client tags describing where they run, from the
+// closest to the farthest topology level, e.g. "rack:r17" or "zone:us-east1-b".
+constexpr absl::string_view kTopologyTagPrefixes[] = {"host:", "rack:",
+                                                      "zone:"};
+constexpr int kNumTopologyLevels = 3;
+
 // Container to hold the result of a `GetNext` call.
 struct GetNextResult final {
   explicit GetNextResult() = default;
@@ -85,6 +92,12 @@ std::string TargetWorkersToString(TargetWorkers target_workers);
 // Returns InvalidArgument if the string is not recognized.
 absl::StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s);
 
+// Returns the closest topology level at which `worker_tags` and `client_tags`
+// carry the same tag, as an index into `kTopologyTagPrefixes`, or
+// `kNumTopologyLevels` if they share none.
+int TopologyDistance(absl::Span<const std::string> worker_tags,
+                     absl::Span<const std::string> client_tags);
+
 // Returns true if `status` is a retriable error that indicates preemption.
 bool IsPreemptedError(const Status& status);
 
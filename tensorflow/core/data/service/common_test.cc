@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/framework/dataset_options.pb.h"
@@ -170,6 +171,20 @@ TEST(CommonTest, ParseInvalidDeploymentMode) {
               testing::StatusIs(error::INVALID_ARGUMENT));
 }
 
+TEST(CommonTest, TopologyDistance) {
+  const std::vector<std::string> worker_tags = {"COLOCATED", "host:h1",
+                                                "rack:r1", "zone:z1"};
+  EXPECT_EQ(TopologyDistance(worker_tags, {"host:h1", "rack:r1", "zone:z1"}),
+            0);
+  EXPECT_EQ(TopologyDistance(worker_tags, {"host:h2", "rack:r1", "zone:z1"}),
+            1);
+  EXPECT_EQ(TopologyDistance(worker_tags, {"host:h2", "rack:r2", "zone:z1"}),
+            2);
+  EXPECT_EQ(TopologyDistance(worker_tags, {"zone:z2"}), kNumTopologyLevels);
+  EXPECT_EQ(TopologyDistance(worker_tags, {"COLOCATED"}), kNumTopologyLevels);
+  EXPECT_EQ(TopologyDistance({}, {"host:h1"}), kNumTopologyLevels);
+}
+
 TEST(CommonTest, IsPreemptedError) {
   EXPECT_TRUE(IsPreemptedError(errors::Aborted("Aborted")));
   EXPECT_TRUE(IsPreemptedError(errors::Cancelled("Cancelled")));
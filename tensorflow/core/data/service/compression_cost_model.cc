@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/compression_cost_model.h"
+
+#include <cstdint>
+#include <optional>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+
+/* static */ constexpr int64_t CompressionCostModel::kMinSamples;
+/* static */ constexpr double
+    CompressionCostModel::kCompressionToUncompressionCostRatio;
+
+bool CompressionCostModel::Enabled() {
+  static const bool enabled = [] {
+    bool enabled = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_DATA_SERVICE_ADAPTIVE_COMPRESSION",
+                                   /*default_val=*/false, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
+CompressionCostModel* CompressionCostModel::Global() {
+  static CompressionCostModel* model = new CompressionCostModel();
+  return model;
+}
+
+void CompressionCostModel::Add(Totals& totals, int64_t bytes,
+                               int64_t output_bytes, int64_t duration_us) {
+  totals.bytes += bytes;
+  totals.output_bytes += output_bytes;
+  totals.duration_us += duration_us;
+  ++totals.num_samples;
+}
+
+void CompressionCostModel::RecordCompression(int64_t uncompressed_bytes,
+                                             int64_t compressed_bytes,
+                                             int64_t duration_us) {
+  mutex_lock l(mu_);
+  Add(compression_, uncompressed_bytes, compressed_bytes, duration_us);
+}
+
+void CompressionCostModel::RecordUncompression(int64_t compressed_bytes,
+                                               int64_t uncompressed_bytes,
+                                               int64_t duration_us) {
+  mutex_lock l(mu_);
+  Add(uncompression_, compressed_bytes, uncompressed_bytes, duration_us);
+}
+
+void CompressionCostModel::RecordTransfer(int64_t bytes, int64_t duration_us) {
+  mutex_lock l(mu_);
+  Add(transfer_, bytes, bytes, duration_us);
+}
+
+std::optional<bool> CompressionCostModel::ShouldDisableCompression() const {
+  mutex_lock l(mu_);
+  if (transfer_.num_samples < kMinSamples ||
+      uncompression_.num_samples < kMinSamples || transfer_.bytes <= 0 ||
+      uncompression_.bytes <= 0 || uncompression_.output_bytes <= 0) {
+    return std::nullopt;
+  }
+  // All costs are in microseconds per uncompressed byte.
+  const double transfer_cost = transfer_.duration_us / transfer_.bytes;
+  const double compression_ratio =
+      uncompression_.output_bytes / uncompression_.bytes;
+  const double uncompression_cost =
+      uncompression_.duration_us / uncompression_.output_bytes;
+  const double compression_cost =
+      compression_.num_samples > 0 && compression_.bytes > 0
+          ? compression_.duration_us / compression_.bytes
+          : uncompression_cost * kCompressionToUncompressionCostRatio;
+  const double compressed_cost =
+      compression_cost + transfer_cost / compression_ratio + uncompression_cost;
+  VLOG(2) << "Estimated per-byte cost with compression: " << compressed_cost
+          << "us, without compression: " << transfer_cost
+          << "us (compression ratio " << compression_ratio << ").";
+  return compressed_cost > transfer_cost;
+}
+
+}  // namespace data
+}  // namespace tensorflow
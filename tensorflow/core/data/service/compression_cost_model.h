@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_COST_MODEL_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_COST_MODEL_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Estimates online whether compressing tf.data service elements pays off,
+// from the bandwidth observed when fetching elements from workers and the
+// measured cost of compressing and uncompressing them.
+//
+// Compression pays off if, per uncompressed byte, the time spent compressing,
+// sending the compressed bytes, and uncompressing is less than the time spent
+// sending the uncompressed bytes. On fast links (e.g. intra-rack), the CPU cost
+// of compression dominates; on slow links, compression is essential.
+//
+// This class is thread-safe.
+class CompressionCostModel {
+ public:
+  // The minimum number of transfer and uncompression samples required before
+  // the model makes a decision.
+  static constexpr int64_t kMinSamples = 100;
+
+  CompressionCostModel() = default;
+  CompressionCostModel(const CompressionCostModel&) = delete;
+  void operator=(const CompressionCostModel&) = delete;
+
+  // Returns whether runtime compression decisions should consult the model,
+  // i.e. whether the `TF_DATA_SERVICE_ADAPTIVE_COMPRESSION` environment
+  // variable is set to true.
+  static bool Enabled();
+
+  // Returns the process-wide model.
+  static CompressionCostModel* Global();
+
+  // Records that compressing `uncompressed_bytes` into `compressed_bytes` took
+  // `duration_us`.
+  void RecordCompression(int64_t uncompressed_bytes, int64_t compressed_bytes,
+                         int64_t duration_us);
+
+  // Records that uncompressing `compressed_bytes` into `uncompressed_bytes`
+  // took `duration_us`.
+  void RecordUncompression(int64_t compressed_bytes, int64_t uncompressed_bytes,
+                           int64_t duration_us);
+
+  // Records that fetching `bytes` from a worker took `duration_us`. The
+  // duration includes the time the worker spent producing the element, so the
+  // bandwidth is underestimated when the workers are the bottleneck, which
+  // biases the model towards keeping compression.
+  void RecordTransfer(int64_t bytes, int64_t duration_us);
+
+  // Returns whether compression should be disabled, or `std::nullopt` if not
+  // enough samples have been recorded yet.
+  std::optional<bool> ShouldDisableCompression() const;
+
+ private:
+  // If compression was not measured in this process (i.e. the workers run in
+  // other processes), compressing is assumed to be this many times as
+  // expensive as uncompressing, which holds for Snappy.
+  static constexpr double kCompressionToUncompressionCostRatio = 3.0;
+
+  struct Totals {
+    double bytes = 0;
+    double output_bytes = 0;
+    double duration_us = 0;
+    int64_t num_samples = 0;
+  };
+
+  static void Add(Totals& totals, int64_t bytes, int64_t output_bytes,
+                  int64_t duration_us);
+
+  mutable mutex mu_;
+  Totals compression_ TF_GUARDED_BY(mu_);
+  Totals uncompression_ TF_GUARDED_BY(mu_);
+  Totals transfer_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_COMPRESSION_COST_MODEL_H_
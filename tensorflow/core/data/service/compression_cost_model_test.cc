@@ -0,0 +1,84 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/compression_cost_model.h"
+
+#include <cstdint>
+#include <optional>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Records `kMinSamples` uncompressions of 1MB elements with a compression
+// ratio of 2 that take 1000us each.
+void RecordUncompressions(CompressionCostModel& model) {
+  for (int64_t i = 0; i < CompressionCostModel::kMinSamples; ++i) {
+    model.RecordUncompression(/*compressed_bytes=*/500'000,
+                              /*uncompressed_bytes=*/1'000'000,
+                              /*duration_us=*/1000);
+  }
+}
+
+TEST(CompressionCostModelTest, NotEnoughSamples) {
+  CompressionCostModel model;
+  EXPECT_EQ(model.ShouldDisableCompression(), std::nullopt);
+  RecordUncompressions(model);
+  EXPECT_EQ(model.ShouldDisableCompression(), std::nullopt);
+  model.RecordTransfer(/*bytes=*/500'000, /*duration_us=*/100);
+  EXPECT_EQ(model.ShouldDisableCompression(), std::nullopt);
+}
+
+TEST(CompressionCostModelTest, FastLinkDisablesCompression) {
+  CompressionCostModel model;
+  RecordUncompressions(model);
+  // 5GB/s: sending 1MB uncompressed takes 200us, much less than the 1000us
+  // needed to uncompress it.
+  for (int64_t i = 0; i < CompressionCostModel::kMinSamples; ++i) {
+    model.RecordTransfer(/*bytes=*/500'000, /*duration_us=*/100);
+  }
+  EXPECT_EQ(model.ShouldDisableCompression(), true);
+}
+
+TEST(CompressionCostModelTest, SlowLinkKeepsCompression) {
+  CompressionCostModel model;
+  RecordUncompressions(model);
+  // 50MB/s: sending 1MB uncompressed takes 20ms, compression halves that.
+  for (int64_t i = 0; i < CompressionCostModel::kMinSamples; ++i) {
+    model.RecordTransfer(/*bytes=*/500'000, /*duration_us=*/10'000);
+  }
+  EXPECT_EQ(model.ShouldDisableCompression(), false);
+}
+
+TEST(CompressionCostModelTest, UsesMeasuredCompressionCost) {
+  CompressionCostModel model;
+  RecordUncompressions(model);
+  // 250MB/s: sending 1MB uncompressed takes 4000us, and 2000us compressed.
+  for (int64_t i = 0; i < CompressionCostModel::kMinSamples; ++i) {
+    model.RecordTransfer(/*bytes=*/500'000, /*duration_us=*/2000);
+  }
+  // With the default compression cost estimate of 3000us, compression costs
+  // 6000us per element.
+  EXPECT_EQ(model.ShouldDisableCompression(), true);
+  // Cheap measured compression brings the cost down to 3500us.
+  model.RecordCompression(/*uncompressed_bytes=*/1'000'000,
+                          /*compressed_bytes=*/500'000, /*duration_us=*/500);
+  EXPECT_EQ(model.ShouldDisableCompression(), false);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
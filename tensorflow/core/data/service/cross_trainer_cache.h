@@ -15,13 +15,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
 #include <limits>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/byte_size.h"
@@ -46,6 +50,12 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements evicted from memory are spilled to a second, larger
+// `CacheSpillTier` (e.g. local SSD) if a trainer that is not too far behind has
+// yet to read them. Trainers that fall behind the in-memory window then read
+// the spilled elements instead of skipping ahead, so the elements don't need to
+// be recomputed for them.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -91,6 +101,25 @@ class CachableSequence {
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
 };
 
+// Second tier of a `CrossTrainerCache`, holding elements evicted from memory.
+// Elements are identified by their index in the sequence. Implementations must
+// be thread-safe.
+template <class ElementType>
+class CacheSpillTier {
+ public:
+  virtual ~CacheSpillTier() = default;
+
+  // Writes the element with index `index`.
+  virtual Status Write(size_t index, const ElementType& element) = 0;
+
+  // Reads the element written with index `index`. Returns NotFound if it does
+  // not exist, e.g. if it has been concurrently deleted.
+  virtual StatusOr<ElementType> Read(size_t index) = 0;
+
+  // Deletes the element written with index `index`.
+  virtual Status Delete(size_t index) = 0;
+};
+
 // Sliding-window cache shared across concurrent trainers.
 template <class ElementType>
 class CrossTrainerCache {
@@ -101,6 +130,16 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+  // Creates a `CrossTrainerCache` which spills elements evicted from memory to
+  // `spill_tier`, up to `max_spill_size_bytes` (as estimated by
+  // `GetElementSizeBytes`). An evicted element is only spilled if a trainer
+  // which is at most `max_trainer_lag_elements` behind the newest element has
+  // not read it; trainers further behind are considered stalled.
+  CrossTrainerCache(
+      size_t max_cache_size_bytes,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<CacheSpillTier<ElementType>> spill_tier,
+      size_t max_spill_size_bytes, size_t max_trainer_lag_elements);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -126,6 +165,16 @@ class CrossTrainerCache {
     bool cache_hit;
   };
 
+  struct SpilledElement {
+    size_t size_bytes;
+    // The element while it is being written to the spill tier, or nullptr once
+    // it has been written.
+    std::shared_ptr<const ElementType> element;
+  };
+
+  using ElementsToSpill =
+      std::vector<std::pair<size_t, std::shared_ptr<const ElementType>>>;
+
   // Returns the next element and metrics about this query.
   StatusOr<CacheQueryResult> GetCacheQueryResult(const std::string& trainer_id);
 
@@ -142,12 +191,23 @@ class CrossTrainerCache {
   StatusOr<std::shared_ptr<const ElementType>> GetElement(
       const std::string& trainer_id);
 
-  // Reads a new element and writes it into the cache.
-  Status ExtendCache();
+  // Reads a new element and writes it into the cache. Sets
+  // `elements_to_spill` to the elements it evicted which should be written to
+  // the spill tier.
+  Status ExtendCache(ElementsToSpill* elements_to_spill);
 
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
-  void FreeSpace(size_t new_element_size_bytes);
+  // Returns the freed elements which should be written to the spill tier.
+  ElementsToSpill FreeSpace(size_t new_element_size_bytes);
+
+  // Returns the lowest index that a trainer which is not stalled has yet to
+  // read, or the index of the next element if there is no such trainer.
+  size_t MinActiveTrainerIndex() const;
+
+  // Writes `elements` to the spill tier, then deletes the spilled elements no
+  // trainer needs or which exceed `max_spill_size_bytes_`.
+  void SpillElements(const ElementsToSpill& elements);
 
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
@@ -158,6 +218,11 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  // Optional second tier for elements evicted from memory.
+  const std::unique_ptr<CacheSpillTier<ElementType>> spill_tier_;
+  const size_t max_spill_size_bytes_;
+  const size_t max_trainer_lag_elements_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -170,6 +235,11 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // Elements in the spill tier, by index. All indices are smaller than
+  // `cache_start_index_`.
+  std::map<size_t, SpilledElement> spilled_elements_ TF_GUARDED_BY(mu_);
+  size_t spilled_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
@@ -184,12 +254,29 @@ template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
     std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    : CrossTrainerCache(max_cache_size_bytes, std::move(cachable_sequence),
+                        /*spill_tier=*/nullptr, /*max_spill_size_bytes=*/0,
+                        /*max_trainer_lag_elements=*/0) {}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<CacheSpillTier<ElementType>> spill_tier,
+    size_t max_spill_size_bytes, size_t max_trainer_lag_elements)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      spill_tier_(std::move(spill_tier)),
+      max_spill_size_bytes_(max_spill_size_bytes),
+      max_trainer_lag_elements_(max_trainer_lag_elements) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
           << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
+  if (spill_tier_ != nullptr) {
+    VLOG(2) << "tf.data service cross-trainer cache spills up to "
+            << ByteSize::Bytes(max_spill_size_bytes) << ".";
+  }
 }
 
 template <class ElementType>
@@ -212,10 +299,25 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<size_t> spilled_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
+      // New trainers start from the oldest element in memory.
+      trainer_to_element_index_map_.try_emplace(trainer_id, cache_start_index_);
+      // Trainers behind the in-memory window first read the elements spilled
+      // for them.
+      auto spilled = spilled_elements_.lower_bound(
+          trainer_to_element_index_map_[trainer_id]);
+      if (spilled != spilled_elements_.end()) {
+        trainer_to_element_index_map_[trainer_id] = spilled->first + 1;
+        if (spilled->second.element != nullptr) {
+          return CacheQueryResult{spilled->second.element,
+                                  /*is_cache_hit=*/true};
+        }
+        spilled_index = spilled->first;
+        should_extend_cache = false;
+      } else if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
@@ -234,11 +336,31 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (spilled_index.has_value()) {
+      StatusOr<ElementType> element = spill_tier_->Read(*spilled_index);
+      if (errors::IsNotFound(element.status())) {
+        // The element was deleted after it was looked up. Skip it.
+        continue;
+      }
+      TF_RETURN_IF_ERROR(element.status());
+      return CacheQueryResult{
+          std::make_shared<const ElementType>(std::move(element).value()),
+          /*is_cache_hit=*/true};
+    }
+
     if (should_extend_cache) {
-      Status s = ExtendCache();
-      mutex_lock l(mu_);
-      extending_cache_ = false;
-      cv_.notify_all();
+      ElementsToSpill elements_to_spill;
+      Status s = ExtendCache(&elements_to_spill);
+      {
+        mutex_lock l(mu_);
+        extending_cache_ = false;
+        cv_.notify_all();
+      }
+      // Spills after releasing `extending_cache_`, so that other trainers
+      // don't wait for the spill tier to get their next element.
+      if (!elements_to_spill.empty()) {
+        SpillElements(elements_to_spill);
+      }
       TF_RETURN_IF_ERROR(s);
     }
   }
@@ -278,7 +400,8 @@ size_t CrossTrainerCache<ElementType>::GetElementIndex(
 }
 
 template <class ElementType>
-Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
+Status CrossTrainerCache<ElementType>::ExtendCache(
+    ElementsToSpill* elements_to_spill) TF_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(ElementType element, cachable_sequence_->GetNext());
   size_t new_element_size_bytes =
       cachable_sequence_->GetElementSizeBytes(element);
@@ -291,20 +414,32 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
 
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
+  *elements_to_spill = FreeSpace(new_element_size_bytes);
   cache_.push_back(std::make_shared<ElementType>(std::move(element)));
   cache_size_bytes_ += new_element_size_bytes;
   return absl::OkStatus();
 }
 
 template <class ElementType>
-void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
+typename CrossTrainerCache<ElementType>::ElementsToSpill
+CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  ElementsToSpill elements_to_spill;
+  const size_t min_active_trainer_index =
+      spill_tier_ != nullptr ? MinActiveTrainerIndex() : 0;
   size_t num_elements_discarded = 0;
   while (!cache_.empty() &&
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
+    if (spill_tier_ != nullptr &&
+        cache_start_index_ >= min_active_trainer_index &&
+        free_bytes <= max_spill_size_bytes_) {
+      spilled_elements_[cache_start_index_] =
+          SpilledElement{free_bytes, cache_.front()};
+      spilled_size_bytes_ += free_bytes;
+      elements_to_spill.push_back({cache_start_index_, cache_.front()});
+    }
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
@@ -312,8 +447,74 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
   }
 
   VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
-          << "tf.data service cross-trainer cache. Memory usage: "
-          << ByteSize::Bytes(cache_size_bytes_) << ".";
+          << "tf.data service cross-trainer cache, spilling "
+          << elements_to_spill.size()
+          << " of them. Memory usage: " << ByteSize::Bytes(cache_size_bytes_)
+          << ".";
+  return elements_to_spill;
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::MinActiveTrainerIndex() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const size_t next_index = cache_start_index_ + cache_.size();
+  size_t min_index = next_index;
+  for (const auto& [trainer_id, element_index] :
+       trainer_to_element_index_map_) {
+    if (next_index - element_index <= max_trainer_lag_elements_) {
+      min_index = std::min(min_index, element_index);
+    }
+  }
+  return min_index;
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::SpillElements(
+    const ElementsToSpill& elements) TF_LOCKS_EXCLUDED(mu_) {
+  std::vector<size_t> indices_to_delete;
+  for (const auto& [index, element] : elements) {
+    Status s = spill_tier_->Write(index, *element);
+    mutex_lock l(mu_);
+    auto it = spilled_elements_.find(index);
+    if (it == spilled_elements_.end()) {
+      // The element was dropped while it was being written, possibly before
+      // the write created it in the tier.
+      if (s.ok()) {
+        indices_to_delete.push_back(index);
+      }
+      continue;
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to spill element " << index
+                   << " of tf.data service cross-trainer cache: " << s;
+      spilled_size_bytes_ -= it->second.size_bytes;
+      spilled_elements_.erase(it);
+      continue;
+    }
+    it->second.element = nullptr;
+  }
+
+  {
+    mutex_lock l(mu_);
+    const size_t min_active_trainer_index = MinActiveTrainerIndex();
+    while (!spilled_elements_.empty() &&
+           (spilled_elements_.begin()->first < min_active_trainer_index ||
+            spilled_size_bytes_ > max_spill_size_bytes_)) {
+      indices_to_delete.push_back(spilled_elements_.begin()->first);
+      spilled_size_bytes_ -= spilled_elements_.begin()->second.size_bytes;
+      spilled_elements_.erase(spilled_elements_.begin());
+    }
+    VLOG(3) << "tf.data service cross-trainer cache spill usage: "
+            << ByteSize::Bytes(spilled_size_bytes_) << " in "
+            << spilled_elements_.size() << " element(s).";
+  }
+  for (size_t index : indices_to_delete) {
+    Status s = spill_tier_->Delete(index);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete spilled element " << index
+                   << " of tf.data service cross-trainer cache: " << s;
+    }
+  }
 }
 
 template <class ElementType>
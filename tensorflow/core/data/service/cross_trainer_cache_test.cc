@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -121,6 +122,63 @@ size_t ElementOrErrorDataset<Tensor>::GetElementSizeBytes(
   return element.TotalBytes();
 }
 
+// Spill tier backed by an in-memory map.
+class FakeSpillTier : public CacheSpillTier<int64_t> {
+ public:
+  Status Write(size_t index, const int64_t& element) override {
+    mutex_lock l(mu_);
+    elements_[index] = element;
+    return absl::OkStatus();
+  }
+
+  StatusOr<int64_t> Read(size_t index) override {
+    mutex_lock l(mu_);
+    auto it = elements_.find(index);
+    if (it == elements_.end()) {
+      return errors::NotFound("Element ", index, " not found.");
+    }
+    return it->second;
+  }
+
+  Status Delete(size_t index) override {
+    mutex_lock l(mu_);
+    elements_.erase(index);
+    return absl::OkStatus();
+  }
+
+  size_t size() const {
+    mutex_lock l(mu_);
+    return elements_.size();
+  }
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<size_t, int64_t> elements_ TF_GUARDED_BY(mu_);
+};
+
+// Spill tier whose writes of one element block until `Unblock` is called.
+class BlockingSpillTier : public FakeSpillTier {
+ public:
+  explicit BlockingSpillTier(size_t blocked_index)
+      : blocked_index_(blocked_index) {}
+
+  Status Write(size_t index, const int64_t& element) override {
+    if (index == blocked_index_) {
+      write_started_.Notify();
+      unblocked_.WaitForNotification();
+    }
+    return FakeSpillTier::Write(index, element);
+  }
+
+  void WaitForBlockedWrite() { write_started_.WaitForNotification(); }
+  void Unblock() { unblocked_.Notify(); }
+
+ private:
+  const size_t blocked_index_;
+  Notification write_started_;
+  Notification unblocked_;
+};
+
 std::vector<int64_t> GetRange(const size_t range) {
   std::vector<int64_t> result;
   for (int64_t i = 0; i < range; ++i) {
@@ -443,6 +501,125 @@ TEST(CrossTrainerCacheTest, TrainerIDMustBeNonEmpty) {
                                       "requires a non-empty trainer ID."));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledElements) {
+  auto spill_tier = std::make_unique<FakeSpillTier>();
+  FakeSpillTier* spill_tier_ptr = spill_tier.get();
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::move(spill_tier),
+      /*max_spill_size_bytes=*/1024, /*max_trainer_lag_elements=*/1000);
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // 1 to 14 have been evicted from memory and spilled for the slow trainer.
+  EXPECT_EQ(spill_tier_ptr->size(), 14);
+
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // New trainers start from memory rather than from the spilled elements.
+  EXPECT_THAT(cache.Get("New trainer"), IsOkAndHolds(Pointee(15)));
+}
+
+TEST(CrossTrainerCacheTest, SpillSizeIsBounded) {
+  auto spill_tier = std::make_unique<FakeSpillTier>();
+  FakeSpillTier* spill_tier_ptr = spill_tier.get();
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::move(spill_tier),
+      /*max_spill_size_bytes=*/5 * sizeof(int64_t),
+      /*max_trainer_lag_elements=*/1000);
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // Only the newest 5 evicted elements, 10 to 14, fit in the spill tier.
+  EXPECT_EQ(spill_tier_ptr->size(), 5);
+  for (int i = 10; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, StalledTrainersAreNotSpilledFor) {
+  auto spill_tier = std::make_unique<FakeSpillTier>();
+  FakeSpillTier* spill_tier_ptr = spill_tier.get();
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::move(spill_tier),
+      /*max_spill_size_bytes=*/1024, /*max_trainer_lag_elements=*/10);
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Stalled trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // Once the stalled trainer is more than 10 elements behind, its spilled
+  // elements are deleted and no new ones are spilled.
+  EXPECT_EQ(spill_tier_ptr->size(), 0);
+  EXPECT_THAT(cache.Get("Stalled trainer"), IsOkAndHolds(Pointee(Gt(94))));
+}
+
+TEST(CrossTrainerCacheTest, SpillingDoesNotBlockOtherTrainers) {
+  auto spill_tier = std::make_unique<BlockingSpillTier>(/*blocked_index=*/1);
+  BlockingSpillTier* spill_tier_ptr = spill_tier.get();
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::move(spill_tier),
+      /*max_spill_size_bytes=*/1024, /*max_trainer_lag_elements=*/1000);
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(1)));
+
+  // Element 1 is evicted for element 2 and its spill blocks.
+  std::unique_ptr<Thread> fast_trainer(Env::Default()->StartThread(
+      /*thread_options=*/{}, /*name=*/"fast_trainer", [&cache]() {
+        EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(2)));
+      }));
+  spill_tier_ptr->WaitForBlockedWrite();
+  // Other trainers keep extending the cache meanwhile.
+  EXPECT_THAT(cache.Get("Other trainer"), IsOkAndHolds(Pointee(2)));
+  EXPECT_THAT(cache.Get("Other trainer"), IsOkAndHolds(Pointee(3)));
+  EXPECT_THAT(cache.Get("Other trainer"), IsOkAndHolds(Pointee(4)));
+
+  spill_tier_ptr->Unblock();
+  fast_trainer.reset();
+  for (int i = 1; i < 5; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, ElementsDroppedWhileSpillingAreDeleted) {
+  auto spill_tier = std::make_unique<BlockingSpillTier>(/*blocked_index=*/1);
+  BlockingSpillTier* spill_tier_ptr = spill_tier.get();
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::move(spill_tier),
+      /*max_spill_size_bytes=*/sizeof(int64_t),
+      /*max_trainer_lag_elements=*/1000);
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(1)));
+
+  std::unique_ptr<Thread> fast_trainer(Env::Default()->StartThread(
+      /*thread_options=*/{}, /*name=*/"fast_trainer", [&cache]() {
+        EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(2)));
+      }));
+  spill_tier_ptr->WaitForBlockedWrite();
+  // Spilling element 2 drops element 1, which only fits alone, before its
+  // write creates it.
+  EXPECT_THAT(cache.Get("Other trainer"), IsOkAndHolds(Pointee(2)));
+  EXPECT_THAT(cache.Get("Other trainer"), IsOkAndHolds(Pointee(3)));
+  EXPECT_EQ(spill_tier_ptr->size(), 1);
+
+  spill_tier_ptr->Unblock();
+  fast_trainer.reset();
+  // The late write of element 1 is deleted again.
+  EXPECT_EQ(spill_tier_ptr->size(), 1);
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(2)));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -185,6 +185,30 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
   }
   return new_config;
 }
+
+// Returns the tasks whose workers are topologically closest to a client tagged
+// with `client_tags`, or all `tasks` if none shares a topology tag with it.
+std::vector<std::shared_ptr<const Task>> ClosestTasks(
+    std::vector<std::shared_ptr<const Task>> tasks,
+    const std::vector<std::string>& client_tags) {
+  std::vector<int> distances;
+  distances.reserve(tasks.size());
+  int min_distance = kNumTopologyLevels;
+  for (const auto& task : tasks) {
+    distances.push_back(TopologyDistance(task->worker_tags, client_tags));
+    min_distance = std::min(min_distance, distances.back());
+  }
+  if (min_distance == kNumTopologyLevels) {
+    return tasks;
+  }
+  std::vector<std::shared_ptr<const Task>> closest_tasks;
+  for (int i = 0; i < tasks.size(); ++i) {
+    if (distances[i] == min_distance) {
+      closest_tasks.push_back(std::move(tasks[i]));
+    }
+  }
+  return closest_tasks;
+}
 }  // namespace
 
 DataServiceDispatcherImpl::DataServiceDispatcherImpl(
@@ -212,6 +236,12 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
 
 Status DataServiceDispatcherImpl::Start() {
   mutex_lock l(mu_);
+  if (!config_.worker_scaling_actuator().empty()) {
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<WorkerScalingActuator> actuator,
+        WorkerScalingActuator::Create(config_.worker_scaling_actuator()));
+    auto_scaler_.SetWorkerScalingActuator(std::move(actuator));
+  }
   if (config_.job_gc_timeout_ms() >= 0) {
     maintenance_thread_ = absl::WrapUnique(env_->StartThread(
         {}, "maintenance-thread", [&] { MaintenanceThread(); }));
@@ -1149,6 +1179,12 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
 
   std::vector<std::shared_ptr<const Task>> tasks;
   TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration->iteration_id, tasks));
+  if (config_.locality_aware_reads() && !request->client_tags().empty() &&
+      IsNoShard(iteration->job->processing_mode) &&
+      !iteration->IsRoundRobin()) {
+    tasks = ClosestTasks(std::move(tasks), {request->client_tags().begin(),
+                                            request->client_tags().end()});
+  }
   for (const auto& task : tasks) {
     TaskInfo* task_info = response->mutable_task_info()->Add();
     task_info->set_worker_address(task->worker_address);
@@ -0,0 +1,841 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tsl/platform/host_info.h"
+#endif  // __linux__
+
+namespace tensorflow {
+namespace data {
+
+std::string ShmSegmentName(int port) {
+  return absl::StrCat("/tf_data_service_", port);
+}
+
+#if defined(__linux__)
+namespace {
+
+constexpr uint64_t kSegmentMagic = 0x7466646174617368;  // "tfdatash"
+constexpr int64_t kNumSlots = 16;
+constexpr int64_t kDefaultSlotBytes = 1 << 20;
+// Servers in the same process are told apart by their index in the port.
+constexpr int kMaxServersPerProcess = 256;
+constexpr int64_t kMinPollIntervalUs = 2;
+constexpr int64_t kMaxPollIntervalUs = 1000;
+// Clients consider the server gone if it has not updated its heartbeat for
+// this long.
+constexpr int64_t kServerHeartbeatTimeoutUs = 30 * 1000 * 1000;
+constexpr size_t kOverflowNameBytes = 64;
+
+enum SlotState : uint32_t {
+  kFree = 0,
+  // A client is writing a request into the slot.
+  kClaimed,
+  // The request is ready for the server.
+  kRequested,
+  // The server is producing the response.
+  kProcessing,
+  // The response is ready for the client.
+  kResponded,
+  // The client stopped waiting for the response. The server frees the slot
+  // once the response is produced.
+  kAbandoned,
+};
+
+enum Encoding : int64_t {
+  // The tensor buffer, for types that can be memcpy'd.
+  kRaw = 0,
+  // A serialized `CompressedElement`.
+  kCompressed = 1,
+  // A serialized `TensorProto`, for all other types.
+  kTensorProto = 2,
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<int64_t>::is_always_lock_free);
+
+struct SegmentHeader {
+  uint64_t magic;
+  uint64_t nonce;
+  int64_t num_slots;
+  int64_t slot_bytes;
+  std::atomic<int64_t> heartbeat_us;
+  std::atomic<uint32_t> shutdown;
+};
+
+struct alignas(64) Slot {
+  std::atomic<uint32_t> state;
+  // The `absl::StatusCode` of the response. If not OK, the slot data holds the
+  // error message.
+  int32_t status_code;
+  int64_t request_bytes;
+  int64_t response_bytes;
+  // If not empty, the response is in this segment instead of the slot data.
+  char overflow_name[kOverflowNameBytes];
+};
+
+constexpr size_t RoundUp(size_t n, size_t alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+constexpr size_t kSlotsOffset = RoundUp(sizeof(SegmentHeader), 64);
+
+size_t SlotDataOffset(int64_t num_slots, int64_t slot_bytes, int64_t index) {
+  return kSlotsOffset + num_slots * sizeof(Slot) + index * slot_bytes;
+}
+
+size_t SegmentBytes(int64_t num_slots, int64_t slot_bytes) {
+  return SlotDataOffset(num_slots, slot_bytes, num_slots);
+}
+
+// A mapped POSIX shared memory segment.
+class MappedSegment {
+ public:
+  // Creates the segment `name` with `size` bytes, replacing any stale segment
+  // of the same name. The segment is unlinked when this object is destroyed,
+  // unless `Disown` is called.
+  static absl::StatusOr<std::unique_ptr<MappedSegment>> Create(
+      const std::string& name, size_t size) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+      shm_unlink(name.c_str());
+      fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+      return errors::Unavailable("Failed to create shared memory segment ",
+                                 name, ": ", strerror(errno));
+    }
+    // Reserve the memory up front, so that running out of shared memory is
+    // reported here instead of as a SIGBUS when the segment is written.
+    if (int error = posix_fallocate(fd, 0, size); error != 0) {
+      close(fd);
+      shm_unlink(name.c_str());
+      return errors::ResourceExhausted("Failed to allocate ", size,
+                                       " bytes of shared memory for ", name,
+                                       ": ", strerror(error));
+    }
+    return Map(name, fd, size, /*owned=*/true);
+  }
+
+  // Opens the existing segment `name`.
+  static absl::StatusOr<std::unique_ptr<MappedSegment>> Open(
+      const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::Unavailable("Failed to open shared memory segment ", name,
+                                 ": ", strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      const int error = errno;
+      close(fd);
+      return errors::Unavailable("Failed to stat shared memory segment ", name,
+                                 ": ", strerror(error));
+    }
+    return Map(name, fd, st.st_size, /*owned=*/false);
+  }
+
+  MappedSegment(const MappedSegment&) = delete;
+  void operator=(const MappedSegment&) = delete;
+
+  ~MappedSegment() {
+    munmap(data_, size_);
+    if (owned_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  // Keeps the segment after this object is destroyed. The reader of the
+  // segment is then responsible for unlinking it.
+  void Disown() { owned_ = false; }
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedSegment(std::string name, char* data, size_t size, bool owned)
+      : name_(std::move(name)), data_(data), size_(size), owned_(owned) {}
+
+  static absl::StatusOr<std::unique_ptr<MappedSegment>> Map(
+      const std::string& name, int fd, size_t size, bool owned) {
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                      /*offset=*/0);
+    const int error = errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+      if (owned) {
+        shm_unlink(name.c_str());
+      }
+      return errors::Unavailable("Failed to map shared memory segment ", name,
+                                 ": ", strerror(error));
+    }
+    return absl::WrapUnique(
+        new MappedSegment(name, static_cast<char*>(data), size, owned));
+  }
+
+  const std::string name_;
+  char* const data_;
+  const size_t size_;
+  bool owned_;
+};
+
+// Accessors for the header and slots of a transfer segment.
+class SegmentView {
+ protected:
+  void Init(std::unique_ptr<MappedSegment> segment, int64_t num_slots,
+            int64_t slot_bytes) {
+    segment_ = std::move(segment);
+    num_slots_ = num_slots;
+    slot_bytes_ = slot_bytes;
+  }
+
+  SegmentHeader* header() const {
+    return reinterpret_cast<SegmentHeader*>(segment_->data());
+  }
+  Slot* slot(int64_t index) const {
+    return reinterpret_cast<Slot*>(segment_->data() + kSlotsOffset) + index;
+  }
+  char* slot_data(int64_t index) const {
+    return segment_->data() + SlotDataOffset(num_slots_, slot_bytes_, index);
+  }
+
+  std::unique_ptr<MappedSegment> segment_;
+  int64_t num_slots_ = 0;
+  int64_t slot_bytes_ = 0;
+};
+
+// A component of an encoded response.
+struct EncodedComponent {
+  Encoding encoding;
+  DataType dtype;
+  TensorShape shape;
+  // The tensor buffer for `kRaw`, the serialized proto otherwise.
+  absl::string_view raw;
+  std::string serialized;
+
+  absl::string_view bytes() const {
+    return encoding == kRaw ? raw : absl::string_view(serialized);
+  }
+};
+
+absl::StatusOr<std::vector<EncodedComponent>> EncodeComponents(
+    const std::vector<Tensor>& components) {
+  std::vector<EncodedComponent> encoded(components.size());
+  for (int i = 0; i < components.size(); ++i) {
+    const Tensor& tensor = components[i];
+    EncodedComponent& component = encoded[i];
+    component.dtype = tensor.dtype();
+    component.shape = tensor.shape();
+    const CompressedElement* compressed =
+        tensor.dtype() == DT_VARIANT && tensor.dims() == 0
+            ? tensor.scalar<Variant>()().get<CompressedElement>()
+            : nullptr;
+    if (DataTypeCanUseMemcpy(tensor.dtype())) {
+      component.encoding = kRaw;
+      component.raw = tensor.tensor_data();
+    } else if (compressed != nullptr) {
+      component.encoding = kCompressed;
+      if (!compressed->SerializeToString(&component.serialized)) {
+        return errors::Internal("Failed to serialize compressed element.");
+      }
+    } else {
+      component.encoding = kTensorProto;
+      TensorProto proto;
+      tensor.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&component.serialized)) {
+        return errors::Internal("Failed to serialize tensor.");
+      }
+    }
+  }
+  return encoded;
+}
+
+// Layout: element index, end of sequence, skip, number of components, then for
+// each component: encoding, dtype, rank, dimensions, and byte size followed by
+// the bytes, padded to 8 bytes.
+size_t EncodedBytes(const std::vector<EncodedComponent>& components) {
+  size_t bytes = 4 * sizeof(int64_t);
+  for (const EncodedComponent& component : components) {
+    bytes += (4 + component.shape.dims()) * sizeof(int64_t) +
+             RoundUp(component.bytes().size(), sizeof(int64_t));
+  }
+  return bytes;
+}
+
+class PayloadWriter {
+ public:
+  explicit PayloadWriter(char* data) : pos_(data) {}
+
+  void WriteInt(int64_t value) {
+    std::memcpy(pos_, &value, sizeof(value));
+    pos_ += sizeof(value);
+  }
+
+  void WriteBytes(absl::string_view bytes) {
+    WriteInt(bytes.size());
+    std::memcpy(pos_, bytes.data(), bytes.size());
+    pos_ += RoundUp(bytes.size(), sizeof(int64_t));
+  }
+
+ private:
+  char* pos_;
+};
+
+class PayloadReader {
+ public:
+  PayloadReader(const char* data, size_t size)
+      : pos_(data), end_(data + size) {}
+
+  bool ReadInt(int64_t* value) {
+    if (remaining() < sizeof(*value)) return false;
+    std::memcpy(value, pos_, sizeof(*value));
+    pos_ += sizeof(*value);
+    return true;
+  }
+
+  bool ReadBytes(absl::string_view* bytes) {
+    int64_t size;
+    if (!ReadInt(&size) || size < 0 ||
+        remaining() < RoundUp(size, sizeof(int64_t))) {
+      return false;
+    }
+    *bytes = absl::string_view(pos_, size);
+    pos_ += RoundUp(size, sizeof(int64_t));
+    return true;
+  }
+
+ private:
+  size_t remaining() const { return end_ - pos_; }
+
+  const char* pos_;
+  const char* const end_;
+};
+
+void WritePayload(const GetElementResult& result,
+                  const std::vector<EncodedComponent>& components,
+                  char* data) {
+  PayloadWriter writer(data);
+  writer.WriteInt(result.element_index);
+  writer.WriteInt(result.end_of_sequence);
+  writer.WriteInt(result.skip);
+  writer.WriteInt(components.size());
+  for (const EncodedComponent& component : components) {
+    writer.WriteInt(component.encoding);
+    writer.WriteInt(component.dtype);
+    writer.WriteInt(component.shape.dims());
+    for (int64_t dim : component.shape.dim_sizes()) {
+      writer.WriteInt(dim);
+    }
+    writer.WriteBytes(component.bytes());
+  }
+}
+
+Status ReadPayload(const char* data, size_t size, Allocator* allocator,
+                   GetElementResult& result) {
+  PayloadReader reader(data, size);
+  int64_t end_of_sequence, skip, num_components;
+  if (!reader.ReadInt(&result.element_index) ||
+      !reader.ReadInt(&end_of_sequence) || !reader.ReadInt(&skip) ||
+      !reader.ReadInt(&num_components) || num_components < 0) {
+    return errors::DataLoss("Malformed shared memory response header.");
+  }
+  result.end_of_sequence = end_of_sequence != 0;
+  result.skip = skip != 0;
+  result.components.reserve(num_components);
+  for (int64_t i = 0; i < num_components; ++i) {
+    int64_t encoding, dtype, rank;
+    if (!reader.ReadInt(&encoding) || !reader.ReadInt(&dtype) ||
+        !reader.ReadInt(&rank) || rank < 0 || !DataType_IsValid(dtype)) {
+      return errors::DataLoss("Malformed shared memory response component.");
+    }
+    TensorShape shape;
+    for (int64_t d = 0; d < rank; ++d) {
+      int64_t dim;
+      if (!reader.ReadInt(&dim)) {
+        return errors::DataLoss("Malformed shared memory response shape.");
+      }
+      TF_RETURN_IF_ERROR(shape.AddDimWithStatus(dim));
+    }
+    absl::string_view bytes;
+    if (!reader.ReadBytes(&bytes)) {
+      return errors::DataLoss("Malformed shared memory response data.");
+    }
+    switch (encoding) {
+      case kRaw: {
+        const DataType type = static_cast<DataType>(dtype);
+        if (!DataTypeCanUseMemcpy(type)) {
+          return errors::DataLoss("Unexpected raw tensor of type ",
+                                  DataTypeString(type), ".");
+        }
+        Tensor tensor(allocator, type, shape);
+        if (tensor.TotalBytes() != bytes.size()) {
+          return errors::DataLoss("Expected ", tensor.TotalBytes(),
+                                  " bytes for tensor of shape ",
+                                  shape.DebugString(), ", got ", bytes.size());
+        }
+        std::memcpy(const_cast<char*>(tensor.tensor_data().data()),
+                    bytes.data(), bytes.size());
+        result.components.push_back(std::move(tensor));
+        break;
+      }
+      case kCompressed: {
+        CompressedElement compressed;
+        if (!compressed.ParseFromArray(bytes.data(), bytes.size())) {
+          return errors::DataLoss("Failed to parse compressed element.");
+        }
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(compressed);
+        result.components.push_back(std::move(tensor));
+        break;
+      }
+      case kTensorProto: {
+        TensorProto proto;
+        Tensor tensor;
+        if (!proto.ParseFromArray(bytes.data(), bytes.size()) ||
+            !tensor.FromProto(allocator, proto)) {
+          return errors::DataLoss("Failed to parse tensor.");
+        }
+        result.components.push_back(std::move(tensor));
+        break;
+      }
+      default:
+        return errors::DataLoss("Unknown component encoding ", encoding, ".");
+    }
+  }
+  return absl::OkStatus();
+}
+
+class ShmDataTransferServer : public DataTransferServer, SegmentView {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)) {}
+
+  ~ShmDataTransferServer() override {
+    if (!segment_) {
+      return;
+    }
+    header()->shutdown.store(1);
+    stopped_.store(true);
+    poll_thread_.reset();
+    // Waits for the requests in progress.
+    thread_pool_.reset();
+  }
+
+  Status Start(const experimental::WorkerConfig& config) override {
+    if (segment_) {
+      return errors::FailedPrecondition(
+          "Shared memory transfer server already started.");
+    }
+    int64_t slot_bytes;
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_DATA_SERVICE_SHM_SLOT_BYTES",
+                                           kDefaultSlotBytes, &slot_bytes));
+    slot_bytes = RoundUp(std::max<int64_t>(slot_bytes, 64), 64);
+    static std::atomic<int> next_server_index(0);
+    port_ = Env::Default()->GetProcessId() * kMaxServersPerProcess +
+            next_server_index.fetch_add(1) % kMaxServersPerProcess;
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<MappedSegment> segment,
+        MappedSegment::Create(ShmSegmentName(port_),
+                              SegmentBytes(kNumSlots, slot_bytes)));
+    Init(std::move(segment), kNumSlots, slot_bytes);
+
+    nonce_ = random::New64();
+    SegmentHeader* h = new (segment_->data()) SegmentHeader();
+    h->magic = kSegmentMagic;
+    h->nonce = nonce_;
+    h->num_slots = num_slots_;
+    h->slot_bytes = slot_bytes_;
+    h->heartbeat_us.store(Env::Default()->NowMicros());
+    for (int64_t i = 0; i < num_slots_; ++i) {
+      new (slot(i)) Slot();
+    }
+    thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "tf_data_shm_transfer", num_slots_);
+    poll_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_transfer_poll", [this] { PollLoop(); }));
+    VLOG(1) << "Started shared memory data transfer server at "
+            << ShmSegmentName(port_) << ".";
+    return absl::OkStatus();
+  }
+
+  int Port() const override { return port_; }
+
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override {
+    return absl::StrCat(tsl::port::Hostname(), "/", nonce_);
+  }
+
+ private:
+  void PollLoop() {
+    int64_t interval_us = kMinPollIntervalUs;
+    while (!stopped_.load()) {
+      header()->heartbeat_us.store(Env::Default()->NowMicros());
+      bool found = false;
+      for (int64_t i = 0; i < num_slots_; ++i) {
+        uint32_t expected = kRequested;
+        if (slot(i)->state.compare_exchange_strong(expected, kProcessing)) {
+          found = true;
+          thread_pool_->Schedule([this, i] { Process(i); });
+        }
+      }
+      interval_us =
+          found ? kMinPollIntervalUs
+                : std::min(interval_us * 2, kMaxPollIntervalUs);
+      Env::Default()->SleepForMicroseconds(interval_us);
+    }
+  }
+
+  void Process(int64_t index) {
+    Slot* s = slot(index);
+    GetElementRequest request;
+    GetElementResult result;
+    Status status;
+    if (s->request_bytes < 0 || s->request_bytes > slot_bytes_ ||
+        !request.ParseFromArray(slot_data(index), s->request_bytes)) {
+      status = errors::InvalidArgument("Failed to parse GetElementRequest.");
+    } else {
+      status = get_element_(&request, &result);
+    }
+    std::unique_ptr<MappedSegment> overflow;
+    if (status.ok()) {
+      status = WriteResponse(index, result, overflow);
+    }
+    if (!status.ok()) {
+      WriteError(index, status);
+    }
+    uint32_t expected = kProcessing;
+    if (s->state.compare_exchange_strong(expected, kResponded)) {
+      if (overflow) {
+        overflow->Disown();
+      }
+    } else {
+      s->state.store(kFree);
+    }
+  }
+
+  Status WriteResponse(int64_t index, const GetElementResult& result,
+                       std::unique_ptr<MappedSegment>& overflow) {
+    TF_ASSIGN_OR_RETURN(std::vector<EncodedComponent> components,
+                        EncodeComponents(result.components));
+    const size_t bytes = EncodedBytes(components);
+    Slot* s = slot(index);
+    char* data = slot_data(index);
+    s->overflow_name[0] = '\0';
+    if (bytes > slot_bytes_) {
+      const std::string name =
+          absl::StrCat(ShmSegmentName(port_), "_", next_overflow_id_++);
+      if (name.size() >= kOverflowNameBytes) {
+        return errors::Internal("Shared memory segment name ", name,
+                                " is too long.");
+      }
+      TF_ASSIGN_OR_RETURN(overflow, MappedSegment::Create(name, bytes));
+      data = overflow->data();
+      std::memcpy(s->overflow_name, name.c_str(), name.size() + 1);
+    }
+    WritePayload(result, components, data);
+    s->status_code = static_cast<int32_t>(absl::StatusCode::kOk);
+    s->response_bytes = bytes;
+    return absl::OkStatus();
+  }
+
+  void WriteError(int64_t index, const Status& status) {
+    Slot* s = slot(index);
+    const size_t bytes = std::min<size_t>(status.message().size(), slot_bytes_);
+    std::memcpy(slot_data(index), status.message().data(), bytes);
+    s->overflow_name[0] = '\0';
+    s->status_code = static_cast<int32_t>(status.code());
+    s->response_bytes = bytes;
+  }
+
+  const GetElementT get_element_;
+  int port_ = -1;
+  uint64_t nonce_ = 0;
+  std::atomic<int64_t> next_overflow_id_{0};
+  std::atomic<bool> stopped_{false};
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+  std::unique_ptr<Thread> poll_thread_;
+};
+
+class ShmDataTransferClient : public DataTransferClient, SegmentView {
+ public:
+  static absl::StatusOr<std::unique_ptr<ShmDataTransferClient>> Create(
+      const Config& config) {
+    const size_t colon = config.address.rfind(':');
+    int port;
+    if (!absl::SimpleAtoi(absl::string_view(config.address).substr(colon + 1),
+                          &port)) {
+      return errors::InvalidArgument(
+          "Expected an address of the form <host>:<port> for the shared memory "
+          "transfer server, got ",
+          config.address);
+    }
+    const std::string name = ShmSegmentName(port);
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<MappedSegment> segment,
+                        MappedSegment::Open(name));
+    const auto* h = reinterpret_cast<const SegmentHeader*>(segment->data());
+    if (segment->size() < kSlotsOffset || h->magic != kSegmentMagic ||
+        h->num_slots <= 0 || h->slot_bytes <= 0 ||
+        segment->size() < SegmentBytes(h->num_slots, h->slot_bytes)) {
+      return errors::FailedPrecondition(
+          name, " is not a tf.data service shared memory segment.");
+    }
+    VLOG(2) << "Create ShmDataTransferClient for " << name << ".";
+    return absl::WrapUnique(new ShmDataTransferClient(
+        std::move(segment),
+        config.allocator != nullptr ? config.allocator : cpu_allocator()));
+  }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id() << " from shared "
+            << "memory worker server.";
+    const int64_t start_time_us = env_->NowMicros();
+    TF_ASSIGN_OR_RETURN(int64_t index, ClaimSlot());
+    Slot* s = slot(index);
+    const size_t request_bytes = req.ByteSizeLong();
+    if (request_bytes > slot_bytes_ ||
+        !req.SerializeToArray(slot_data(index), request_bytes)) {
+      s->state.store(kFree);
+      return errors::InvalidArgument("Failed to write GetElementRequest of ",
+                                     request_bytes, " bytes to shared memory.");
+    }
+    s->request_bytes = request_bytes;
+    s->state.store(kRequested);
+    TF_RETURN_IF_ERROR(AwaitResponse(index));
+    Status status = ReadResponse(index, result);
+    ReleaseSlot(index);
+    TF_RETURN_IF_ERROR(status);
+    metrics::RecordTFDataServiceGetElementDuration(
+        kShmTransferProtocol, env_->NowMicros() - start_time_us);
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel ShmDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+  }
+
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override {
+    const size_t slash = server_compatibility_info.rfind('/');
+    const std::string server_host = server_compatibility_info.substr(0, slash);
+    uint64_t nonce;
+    if (slash == std::string::npos ||
+        !absl::SimpleAtoi(server_compatibility_info.substr(slash + 1),
+                          &nonce)) {
+      return errors::InvalidArgument(
+          "Malformed shared memory transfer server compatibility info: ",
+          server_compatibility_info);
+    }
+    if (server_host != tsl::port::Hostname()) {
+      return errors::FailedPrecondition(
+          "The worker runs on host ", server_host, ", not on this host (",
+          tsl::port::Hostname(), ").");
+    }
+    if (nonce != header()->nonce) {
+      return errors::FailedPrecondition(
+          "The shared memory segment belongs to a different transfer server.");
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  ShmDataTransferClient(std::unique_ptr<MappedSegment> segment,
+                        Allocator* allocator)
+      : allocator_(allocator) {
+    const auto* h = reinterpret_cast<const SegmentHeader*>(segment->data());
+    Init(std::move(segment), h->num_slots, h->slot_bytes);
+  }
+
+  // Returns an error if the client was cancelled or the server is gone.
+  Status CheckActive() {
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+    }
+    if (header()->shutdown.load()) {
+      return errors::Unavailable("Shared memory transfer server shut down.");
+    }
+    if (env_->NowMicros() - header()->heartbeat_us.load() >
+        kServerHeartbeatTimeoutUs) {
+      return errors::Unavailable(
+          "Shared memory transfer server stopped responding.");
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<int64_t> ClaimSlot() {
+    int64_t interval_us = kMinPollIntervalUs;
+    while (true) {
+      TF_RETURN_IF_ERROR(CheckActive());
+      const int64_t start = next_slot_.fetch_add(1);
+      for (int64_t i = 0; i < num_slots_; ++i) {
+        const int64_t index = (start + i) % num_slots_;
+        uint32_t expected = kFree;
+        if (slot(index)->state.compare_exchange_strong(expected, kClaimed)) {
+          return index;
+        }
+      }
+      env_->SleepForMicroseconds(interval_us);
+      interval_us = std::min(interval_us * 2, kMaxPollIntervalUs);
+    }
+  }
+
+  Status AwaitResponse(int64_t index) {
+    int64_t interval_us = kMinPollIntervalUs;
+    while (slot(index)->state.load() != kResponded) {
+      if (Status s = CheckActive(); !s.ok()) {
+        Abandon(index);
+        return s;
+      }
+      env_->SleepForMicroseconds(interval_us);
+      interval_us = std::min(interval_us * 2, kMaxPollIntervalUs);
+    }
+    return absl::OkStatus();
+  }
+
+  // Gives up on the request in slot `index`.
+  void Abandon(int64_t index) {
+    Slot* s = slot(index);
+    uint32_t expected = kRequested;
+    if (s->state.compare_exchange_strong(expected, kFree)) {
+      return;
+    }
+    expected = kProcessing;
+    if (s->state.compare_exchange_strong(expected, kAbandoned)) {
+      return;
+    }
+    // The response arrived in the meantime.
+    ReleaseSlot(index);
+  }
+
+  Status ReadResponse(int64_t index, GetElementResult& result) {
+    const Slot* s = slot(index);
+    if (s->status_code != static_cast<int32_t>(absl::StatusCode::kOk)) {
+      return Status(static_cast<absl::StatusCode>(s->status_code),
+                    absl::string_view(slot_data(index),
+                                      std::min(s->response_bytes,
+                                               slot_bytes_)));
+    }
+    if (s->overflow_name[0] == '\0') {
+      if (s->response_bytes > slot_bytes_) {
+        return errors::DataLoss("Shared memory response of ",
+                                s->response_bytes,
+                                " bytes does not fit into its slot.");
+      }
+      return ReadPayload(slot_data(index), s->response_bytes, allocator_,
+                         result);
+    }
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<MappedSegment> overflow,
+                        MappedSegment::Open(OverflowName(index)));
+    if (overflow->size() < s->response_bytes) {
+      return errors::DataLoss("Shared memory response is truncated.");
+    }
+    return ReadPayload(overflow->data(), s->response_bytes, allocator_,
+                       result);
+  }
+
+  // Frees slot `index` after its response has been consumed.
+  void ReleaseSlot(int64_t index) {
+    if (slot(index)->overflow_name[0] != '\0') {
+      shm_unlink(OverflowName(index).c_str());
+    }
+    slot(index)->state.store(kFree);
+  }
+
+  std::string OverflowName(int64_t index) const {
+    const char* name = slot(index)->overflow_name;
+    return std::string(name, strnlen(name, kOverflowNameBytes));
+  }
+
+  Allocator* const allocator_;
+  std::atomic<int64_t> next_slot_{0};
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+class ShmTransferRegistrar {
+ public:
+  ShmTransferRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out =
+              std::make_shared<ShmDataTransferServer>(std::move(get_element));
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          TF_ASSIGN_OR_RETURN(*out, ShmDataTransferClient::Create(config));
+          return absl::OkStatus();
+        });
+  }
+};
+static ShmTransferRegistrar shm_transfer_registrar;
+
+}  // namespace
+#endif  // __linux__
+
+}  // namespace data
+}  // namespace tensorflow
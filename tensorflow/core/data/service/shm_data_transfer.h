@@ -0,0 +1,49 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <string>
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for trainers that run on the same host as the
+// tf.data service worker but in a different process.
+//
+// The worker's transfer server creates a POSIX shared memory segment with a
+// fixed number of request slots. A client claims a free slot, writes its
+// `GetElementRequest` into it, and polls until the server has written the
+// response. Element tensors are copied into the slot as raw buffers instead of
+// being serialized into a `GetElementResponse` proto; responses that do not fit
+// into a slot are written to a temporary segment named in the slot.
+//
+// The server's port is derived from its process ID, and its compatibility info
+// identifies the host and segment, so clients on other hosts fall back to gRPC.
+// The protocol is only available on Linux.
+//
+// To use it, start workers with `data_transfer_protocol="shm"` and
+// `data_transfer_address="localhost:%dts_port%"`. The size of each slot can be
+// set with the `TF_DATA_SERVICE_SHM_SLOT_BYTES` environment variable.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+// Returns the name of the shared memory segment of the transfer server
+// listening on `port`.
+std::string ShmSegmentName(int port);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
@@ -0,0 +1,249 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::HasSubstr;
+
+#if defined(__linux__)
+
+// Starts a shared memory transfer server that serves `get_element` and
+// returns a client connected to it.
+class ShmDataTransferTest : public ::testing::Test {
+ protected:
+  void Start(DataTransferServer::GetElementT get_element) {
+    TF_ASSERT_OK(DataTransferServer::Build(kShmTransferProtocol,
+                                           std::move(get_element), &server_));
+    TF_ASSERT_OK(server_->Start(experimental::WorkerConfig()));
+    TF_ASSERT_OK_AND_ASSIGN(compatibility_info_,
+                            server_->GetCompatibilityInfo());
+    TF_ASSERT_OK(DataTransferClient::Build(
+        kShmTransferProtocol,
+        {kShmTransferProtocol, absl::StrCat("localhost:", server_->Port()),
+         /*accelerator_device_info=*/nullptr, /*allocator=*/nullptr},
+        &client_));
+    TF_ASSERT_OK(client_->CheckCompatibility(compatibility_info_));
+  }
+
+  std::shared_ptr<DataTransferServer> server_;
+  std::unique_ptr<DataTransferClient> client_;
+  std::string compatibility_info_;
+};
+
+TEST_F(ShmDataTransferTest, GetElement) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    result->components.push_back(
+        test::AsTensor<int64_t>({request->task_id(), 2, 3}, {3, 1}));
+    result->components.push_back(test::AsTensor<tstring>({"a", "bc"}));
+    result->element_index = 7;
+    return absl::OkStatus();
+  });
+
+  GetElementRequest request;
+  request.set_task_id(1);
+  GetElementResult result;
+  TF_ASSERT_OK(client_->GetElement(request, result));
+  EXPECT_FALSE(result.end_of_sequence);
+  EXPECT_FALSE(result.skip);
+  EXPECT_EQ(result.element_index, 7);
+  ASSERT_EQ(result.components.size(), 2);
+  test::ExpectEqual(result.components[0],
+                    test::AsTensor<int64_t>({1, 2, 3}, {3, 1}));
+  test::ExpectEqual(result.components[1], test::AsTensor<tstring>({"a", "bc"}));
+}
+
+TEST_F(ShmDataTransferTest, CompressedElement) {
+  std::vector<Tensor> components = {test::AsTensor<float>({1.0, 2.0})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(components, &compressed));
+  Start([&compressed](const GetElementRequest* request,
+                      GetElementResult* result) {
+    Tensor tensor(DT_VARIANT, TensorShape{});
+    tensor.scalar<Variant>()() = compressed;
+    result->components.push_back(std::move(tensor));
+    return absl::OkStatus();
+  });
+
+  GetElementResult result;
+  TF_ASSERT_OK(client_->GetElement(GetElementRequest(), result));
+  ASSERT_EQ(result.components.size(), 1);
+  const CompressedElement* received =
+      result.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(received, nullptr);
+  std::vector<Tensor> uncompressed;
+  TF_ASSERT_OK(UncompressElement(*received, &uncompressed));
+  ASSERT_EQ(uncompressed.size(), 1);
+  test::ExpectEqual(uncompressed[0], components[0]);
+}
+
+TEST_F(ShmDataTransferTest, ElementLargerThanSlot) {
+  // 16MiB, larger than the default 1MiB slots.
+  Tensor large(DT_INT32, TensorShape({4 << 20}));
+  for (int64_t i = 0; i < large.NumElements(); ++i) {
+    large.flat<int32_t>()(i) = i;
+  }
+  Start([&large](const GetElementRequest* request, GetElementResult* result) {
+    result->components.push_back(large);
+    return absl::OkStatus();
+  });
+
+  for (int i = 0; i < 3; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client_->GetElement(GetElementRequest(), result));
+    ASSERT_EQ(result.components.size(), 1);
+    test::ExpectEqual(result.components[0], large);
+  }
+}
+
+TEST_F(ShmDataTransferTest, EndOfSequence) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    result->end_of_sequence = true;
+    return absl::OkStatus();
+  });
+
+  GetElementResult result;
+  TF_ASSERT_OK(client_->GetElement(GetElementRequest(), result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST_F(ShmDataTransferTest, PropagatesErrors) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    return errors::NotFound("Task ", request->task_id(), " not found.");
+  });
+
+  GetElementRequest request;
+  request.set_task_id(5);
+  GetElementResult result;
+  EXPECT_THAT(client_->GetElement(request, result),
+              StatusIs(error::NOT_FOUND, HasSubstr("Task 5 not found.")));
+}
+
+TEST_F(ShmDataTransferTest, ConcurrentRequests) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    result->components.push_back(test::AsScalar<int64_t>(request->task_id()));
+    return absl::OkStatus();
+  });
+
+  constexpr int kNumThreads = 32;
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        {}, absl::StrCat("client_", i), [this, i] {
+          for (int j = 0; j < 100; ++j) {
+            GetElementRequest request;
+            request.set_task_id(i);
+            GetElementResult result;
+            TF_ASSERT_OK(client_->GetElement(request, result));
+            test::ExpectEqual(result.components[0],
+                              test::AsScalar<int64_t>(i));
+          }
+        })));
+  }
+}
+
+TEST_F(ShmDataTransferTest, CancelClient) {
+  Notification unblock;
+  Start([&unblock](const GetElementRequest* request,
+                   GetElementResult* result) {
+    unblock.WaitForNotification();
+    result->end_of_sequence = true;
+    return absl::OkStatus();
+  });
+
+  std::unique_ptr<Thread> cancel_thread =
+      absl::WrapUnique(Env::Default()->StartThread({}, "cancel", [this] {
+        Env::Default()->SleepForMicroseconds(100 * 1000);
+        client_->TryCancel();
+      }));
+  GetElementResult result;
+  EXPECT_THAT(client_->GetElement(GetElementRequest(), result),
+              StatusIs(error::CANCELLED));
+  unblock.Notify();
+  server_.reset();
+}
+
+TEST_F(ShmDataTransferTest, ServerShutsDown) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    result->end_of_sequence = true;
+    return absl::OkStatus();
+  });
+  server_.reset();
+
+  GetElementResult result;
+  EXPECT_THAT(client_->GetElement(GetElementRequest(), result),
+              StatusIs(error::UNAVAILABLE));
+}
+
+TEST_F(ShmDataTransferTest, IncompatibleServer) {
+  Start([](const GetElementRequest* request, GetElementResult* result) {
+    return absl::OkStatus();
+  });
+  EXPECT_THAT(client_->CheckCompatibility("other_host/1"),
+              StatusIs(error::FAILED_PRECONDITION));
+  EXPECT_THAT(client_->CheckCompatibility("malformed"),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(ShmDataTransferClientTest, NoServer) {
+  std::unique_ptr<DataTransferClient> client;
+  EXPECT_THAT(DataTransferClient::Build(kShmTransferProtocol,
+                                        {kShmTransferProtocol,
+                                         "localhost:-1",
+                                         /*accelerator_device_info=*/nullptr,
+                                         /*allocator=*/nullptr},
+                                        &client),
+              StatusIs(error::UNAVAILABLE));
+}
+
+#endif  // __linux__
+
+TEST(ShmSegmentNameTest, SegmentName) {
+  EXPECT_EQ(ShmSegmentName(123), "/tf_data_service_123");
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
@@ -47,6 +48,7 @@ limitations under the License.
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/path.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/traceme.h"
 
 namespace tensorflow {
@@ -198,9 +200,12 @@ bool SnapshotStreamWriter::ShouldWriteRecord() const {
   }
   const absl::Time now = absl::FromUnixMicros(params_.env->NowMicros());
   // Adjusts the checkpoint interval to speed up initial commits during startup.
-  // It will grow gradually from 5 min to the configured checkpoint interval.
-  const absl::Duration adjusted_checkpoint_interval = std::min(
-      params_.checkpoint_interval, absl::Minutes(0.5 * chunk_index_ + 5));
+  // It will grow gradually from the initial checkpoint interval (5 min by
+  // default) to the configured checkpoint interval.
+  const absl::Duration adjusted_checkpoint_interval =
+      std::min(params_.checkpoint_interval,
+               params_.initial_checkpoint_interval +
+                   absl::Minutes(0.5 * chunk_index_));
   return now < last_commit_time_ + adjusted_checkpoint_interval;
 }
 
@@ -221,18 +226,57 @@ absl::Status SnapshotStreamWriter::Commit(
   // worker should commit the uncommitted chunks (see SyncCheckpointWithChunks).
   TF_RETURN_IF_ERROR(Save(file_stats));
 
-  // Commits all chunks since the last commit.
+  // Commits all chunks since the last commit. The files are sorted so the
+  // chunk indices are deterministic: If the worker restarts in the middle of
+  // the commit, SyncCheckpointWithChunks assigns the remaining files to the
+  // remaining indices in the same order.
+  std::vector<std::string> files;
+  files.reserve(file_stats.size());
   for (const auto& [file, stats] : file_stats) {
-    std::string committed_chunk_path =
-        tsl::io::JoinPath(params_.CommittedChunksDirectory(),
-                          absl::StrCat("chunk_", params_.stream_index, "_",
-                                       chunk_index_++, "_", stats.num_records));
-    TF_RETURN_IF_ERROR(params_.env->RenameFile(file, committed_chunk_path));
+    files.push_back(file);
   }
+  std::sort(files.begin(), files.end());
+  std::vector<std::pair<std::string, std::string>> renames;
+  renames.reserve(files.size());
+  for (const std::string& file : files) {
+    std::string committed_chunk_path = tsl::io::JoinPath(
+        params_.CommittedChunksDirectory(),
+        absl::StrCat("chunk_", params_.stream_index, "_", chunk_index_++, "_",
+                     file_stats.at(file).num_records));
+    renames.emplace_back(file, std::move(committed_chunk_path));
+  }
+  TF_RETURN_IF_ERROR(RenameFiles(renames));
   last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
   return absl::OkStatus();
 }
 
+absl::Status SnapshotStreamWriter::RenameFiles(
+    const std::vector<std::pair<std::string, std::string>>& renames) {
+  if (renames.size() <= 1 || params_.max_parallel_commits <= 1) {
+    for (const auto& [source, target] : renames) {
+      TF_RETURN_IF_ERROR(params_.env->RenameFile(source, target));
+    }
+    return absl::OkStatus();
+  }
+
+  // On object stores, a rename is a copy followed by a delete, so committing
+  // the chunk files one at a time dominates the commit latency.
+  tsl::mutex mu;  // Protects `status`.
+  absl::Status status;
+  auto thread_pool = std::make_unique<tsl::thread::ThreadPool>(
+      params_.env, tsl::ThreadOptions{}, "commit_snapshot_chunk_thread",
+      std::min<int64_t>(params_.max_parallel_commits, renames.size()));
+  for (const auto& rename : renames) {
+    thread_pool->Schedule([this, &rename, &status, &mu]() {
+      absl::Status s = params_.env->RenameFile(rename.first, rename.second);
+      tsl::mutex_lock l(mu);
+      status.Update(s);
+    });
+  }
+  thread_pool.reset();
+  return status;
+}
+
 absl::Status SnapshotStreamWriter::FinalizeStream(absl::Status status) {
   if (status.ok()) {
     status = WriteDoneFile();
@@ -411,9 +455,7 @@ absl::Status SnapshotStreamWriter::SyncCheckpointWithChunks(
       std::vector<std::string> uncommitted_chunks,
       GetChildren(params_.UncommittedChunksDirectory(), params_.env));
 
-  TF_ASSIGN_OR_RETURN(int64_t last_committed_chunk_index,
-                      LastCommittedChunkIndex());
-  int64_t next_chunk_index = last_committed_chunk_index + 1;
+  std::vector<std::pair<int64_t, std::string>> chunks_to_commit;
   for (const std::string& uncommitted_chunk : uncommitted_chunks) {
     std::string uncommitted_chunk_filename = tsl::io::JoinPath(
         params_.UncommittedChunksDirectory(), uncommitted_chunk);
@@ -421,47 +463,84 @@ absl::Status SnapshotStreamWriter::SyncCheckpointWithChunks(
                         GetUncommittedChunkIndex(uncommitted_chunk));
     if (checkpoint_index.has_value() &&
         uncommitted_chunk_index < *checkpoint_index) {
-      int64_t chunk_num_elements = (next_chunk_index == *checkpoint_index - 1)
-                                       ? checkpoint_num_elements
-                                       : kUnknownNumElements;
-      std::string committed_chunk_filename = tsl::io::JoinPath(
-          params_.CommittedChunksDirectory(),
-          absl::StrCat("chunk_", params_.stream_index, "_", next_chunk_index,
-                       "_", chunk_num_elements));
-      TF_RETURN_IF_ERROR(params_.env->RenameFile(uncommitted_chunk_filename,
-                                                 committed_chunk_filename));
-      ++next_chunk_index;
+      chunks_to_commit.emplace_back(uncommitted_chunk_index,
+                                    std::move(uncommitted_chunk_filename));
     } else {
       TF_RETURN_IF_ERROR(params_.env->DeleteFile(uncommitted_chunk_filename));
     }
   }
-  if (checkpoint_index.has_value() && next_chunk_index != *checkpoint_index) {
+  if (!checkpoint_index.has_value()) {
+    return absl::OkStatus();
+  }
+
+  // Since the files of a commit are renamed in parallel (see RenameFiles), an
+  // interrupted commit may leave holes among the chunks before the checkpoint.
+  // The uncommitted files fill the highest missing chunk indices, in the order
+  // in which `Commit` assigned them.
+  std::sort(chunks_to_commit.begin(), chunks_to_commit.end());
+  TF_ASSIGN_OR_RETURN(absl::flat_hash_set<int64_t> committed_chunk_indices,
+                      CommittedChunkIndices());
+  int64_t last_committed_chunk_index = -1;
+  for (int64_t chunk_index : committed_chunk_indices) {
+    last_committed_chunk_index =
+        std::max(last_committed_chunk_index, chunk_index);
+  }
+  std::vector<int64_t> missing_chunk_indices;
+  for (int64_t i = *checkpoint_index - 1;
+       i >= 0 && missing_chunk_indices.size() < chunks_to_commit.size(); --i) {
+    if (!committed_chunk_indices.contains(i)) {
+      missing_chunk_indices.push_back(i);
+    }
+  }
+  if (missing_chunk_indices.size() < chunks_to_commit.size()) {
     return absl::InternalError(absl::StrCat(
-        "Failed to recover tf.data snapshot writer: Unable to find chunks [",
-        next_chunk_index, ", ", *checkpoint_index, ")."));
+        "Failed to recover tf.data snapshot writer: Found ",
+        chunks_to_commit.size(), " uncommitted chunks before checkpoint ",
+        *checkpoint_index, " but only ", missing_chunk_indices.size(),
+        " missing chunks."));
+  }
+  std::reverse(missing_chunk_indices.begin(), missing_chunk_indices.end());
+
+  for (size_t i = 0; i < chunks_to_commit.size(); ++i) {
+    const int64_t chunk_index = missing_chunk_indices[i];
+    int64_t chunk_num_elements = (chunk_index == *checkpoint_index - 1)
+                                     ? checkpoint_num_elements
+                                     : kUnknownNumElements;
+    std::string committed_chunk_filename = tsl::io::JoinPath(
+        params_.CommittedChunksDirectory(),
+        absl::StrCat("chunk_", params_.stream_index, "_", chunk_index, "_",
+                     chunk_num_elements));
+    TF_RETURN_IF_ERROR(params_.env->RenameFile(chunks_to_commit[i].second,
+                                               committed_chunk_filename));
+    committed_chunk_indices.insert(chunk_index);
+  }
+  for (int64_t i = *checkpoint_index - 1; i > last_committed_chunk_index;
+       --i) {
+    if (!committed_chunk_indices.contains(i)) {
+      return absl::InternalError(absl::StrCat(
+          "Failed to recover tf.data snapshot writer: Unable to find chunks [",
+          last_committed_chunk_index + 1, ", ", i + 1, ")."));
+    }
   }
   return absl::OkStatus();
 }
 
-absl::StatusOr<int64_t> SnapshotStreamWriter::LastCommittedChunkIndex() {
-  std::string committed_chunks_directory = params_.CommittedChunksDirectory();
+absl::StatusOr<absl::flat_hash_set<int64_t>>
+SnapshotStreamWriter::CommittedChunkIndices() {
   TF_ASSIGN_OR_RETURN(
       std::vector<std::string> committed_chunks,
       GetChildren(params_.CommittedChunksDirectory(), params_.env));
 
-  int64_t last_committed_chunk_index = -1;
+  absl::flat_hash_set<int64_t> committed_chunk_indices;
   for (const std::string& committed_chunk : committed_chunks) {
     TF_ASSIGN_OR_RETURN(auto chunk_filename_tokens,
                         ParseChunkFilename(committed_chunk));
     const auto [stream_index, chunk_index, _] = chunk_filename_tokens;
-    if (stream_index != params_.stream_index) {
-      continue;
-    }
-    if (chunk_index > last_committed_chunk_index) {
-      last_committed_chunk_index = chunk_index;
+    if (stream_index == params_.stream_index) {
+      committed_chunk_indices.insert(chunk_index);
     }
   }
-  return last_committed_chunk_index;
+  return committed_chunk_indices;
 }
 
 std::string SnapshotStreamWriter::CheckpointPath(
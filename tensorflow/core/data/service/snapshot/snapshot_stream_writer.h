@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
@@ -45,6 +46,8 @@ namespace data {
 
 constexpr ByteSize kDefaultMaxChunkSize = ByteSize::GB(6);
 constexpr absl::Duration kDefaultCheckpointInterval = absl::Minutes(30);
+constexpr absl::Duration kDefaultInitialCheckpointInterval = absl::Minutes(5);
+constexpr int64_t kDefaultMaxParallelCommits = 16;
 
 struct SnapshotWriterParams {
   // The directory path of the snapshot. See the comment on SnapshotStreamWriter
@@ -69,6 +72,16 @@ struct SnapshotWriterParams {
   // avoid starving training jobs during startup.
   absl::Duration checkpoint_interval = kDefaultCheckpointInterval;
 
+  // The checkpoint interval used for the first commit. It grows by 30 seconds
+  // per committed chunk until it reaches `checkpoint_interval`. Since readers
+  // stream committed chunks while the snapshot is being written, this bounds
+  // how long training waits for the first chunks.
+  absl::Duration initial_checkpoint_interval =
+      kDefaultInitialCheckpointInterval;
+
+  // The maximum number of chunk files renamed concurrently when committing.
+  int64_t max_parallel_commits = kDefaultMaxParallelCommits;
+
   // If true, keep temporary files (e.g., checkpoints) after completing the
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
@@ -175,6 +188,11 @@ class SnapshotStreamWriter {
   // Commits the chunks since the last commit.
   absl::Status Commit(const ParallelTFRecordWriter::FileToStatsMap& file_stats);
 
+  // Renames each (source, target) file pair, up to `max_parallel_commits` at a
+  // time.
+  absl::Status RenameFiles(
+      const std::vector<std::pair<std::string, std::string>>& renames);
+
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
   absl::Status FinalizeStream(absl::Status status);
@@ -203,8 +221,8 @@ class SnapshotStreamWriter {
   absl::Status SyncCheckpointWithChunks(std::optional<int64_t> checkpoint_index,
                                         int64_t checkpoint_num_elements);
 
-  // Index of the last committed chunk.
-  absl::StatusOr<int64_t> LastCommittedChunkIndex();
+  // Indices of the committed chunks of this stream.
+  absl::StatusOr<absl::flat_hash_set<int64_t>> CommittedChunkIndices();
 
   // Returns the path of the checkpoint for `chunk_index` with
   // `chunk_num_elements`.
@@ -359,6 +359,35 @@ TEST(SnapshotStreamWriterCheckpointTest, SyncCheckpointsWithChunks) {
               IsOkAndHolds(UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
 }
 
+TEST(SnapshotStreamWriterCheckpointTest, SyncInterruptedParallelCommit) {
+  const int64_t range = 10;
+  const std::string compression = tsl::io::compression::kSnappy;
+  const DatasetDef dataset = testing::RangeDataset(range);
+  const int64_t stream_index = 0;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string snapshot_path,
+                          CreateSnapshotDirectory());
+  TF_ASSERT_OK_AND_ASSIGN(
+      testing::PartialSnapshotWriter partial_writer,
+      testing::PartialSnapshotWriter::Create(dataset, snapshot_path,
+                                             stream_index, compression));
+
+  // The worker failed while renaming chunks [1, 5) in parallel: Chunks 1 and 3
+  // were committed, but chunks 2 and 4 were not. The uncommitted chunks should
+  // fill the holes.
+  TF_ASSERT_OK(partial_writer.WriteCheckpoints({5}));
+  TF_ASSERT_OK(partial_writer.WriteCommittedChunks({0, 1, 3}));
+  TF_ASSERT_OK(partial_writer.WriteUncommittedChunks({2, 4}));
+
+  SnapshotWriterParams writer_params{snapshot_path, stream_index, compression,
+                                     Env::Default()};
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          testing::TestIterator(dataset));
+  SnapshotStreamWriter writer(writer_params, std::move(iterator));
+  EXPECT_THAT(writer.Wait(), IsOkAndHolds(true));
+  EXPECT_THAT(testing::ReadSnapshot<int64_t>(snapshot_path, compression),
+              IsOkAndHolds(UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
+}
+
 TEST(SnapshotStreamWriterCheckpointTest, LostChunks) {
   const int64_t range = 10;
   const std::string compression = tsl::io::compression::kZlib;
@@ -15,17 +15,22 @@ limitations under the License.
 #include "tensorflow/core/data/service/task_runner.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -33,9 +38,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -48,6 +55,9 @@ namespace {
 constexpr int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 constexpr size_t kDefaultCrossTrainerCacheSizeBytes =
     10 * (size_t{1} << 30);  // 10GB
+constexpr size_t kDefaultCrossTrainerCacheSpillSizeBytes =
+    100 * (size_t{1} << 30);  // 100GB
+constexpr size_t kDefaultCrossTrainerCacheMaxTrainerLagElements = 1 << 20;
 
 }  // namespace
 
@@ -100,8 +110,26 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    if (worker_config.cross_trainer_cache_spill_dir().empty()) {
+      out = std::make_unique<CachingTaskRunner>(std::move(iterator),
+                                                max_cache_size_bytes);
+    } else {
+      const size_t max_spill_size_bytes =
+          worker_config.cross_trainer_cache_spill_size_bytes() > 0
+              ? worker_config.cross_trainer_cache_spill_size_bytes()
+              : kDefaultCrossTrainerCacheSpillSizeBytes;
+      const size_t max_trainer_lag_elements =
+          worker_config.cross_trainer_cache_max_trainer_lag_elements() > 0
+              ? worker_config.cross_trainer_cache_max_trainer_lag_elements()
+              : kDefaultCrossTrainerCacheMaxTrainerLagElements;
+      const std::string spill_dir =
+          io::JoinPath(worker_config.cross_trainer_cache_spill_dir(),
+                       absl::StrCat("task_", task_def.task_id()));
+      TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(spill_dir));
+      out = std::make_unique<CachingTaskRunner>(
+          std::move(iterator), max_cache_size_bytes, spill_dir,
+          max_spill_size_bytes, max_trainer_lag_elements);
+    }
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -186,6 +214,22 @@ CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
             << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
 
+CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
+                                     size_t max_cache_size_bytes,
+                                     const std::string& spill_dir,
+                                     size_t max_spill_size_bytes,
+                                     size_t max_trainer_lag_elements)
+    : fcfs_task_runner_(std::move(iterator)),
+      cache_(max_cache_size_bytes,
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             std::make_unique<GetElementResultSpillTier>(spill_dir),
+             max_spill_size_bytes, max_trainer_lag_elements) {
+  LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
+            << ByteSize::Bytes(max_cache_size_bytes) << " of memory and "
+            << ByteSize::Bytes(max_spill_size_bytes) << " of spill space in "
+            << spill_dir << ".";
+}
+
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
 
 Status CachingTaskRunner::GetNext(const GetElementRequest& req,
@@ -217,6 +261,60 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+CachingTaskRunner::GetElementResultSpillTier::GetElementResultSpillTier(
+    const std::string& spill_dir)
+    : spill_dir_(spill_dir) {}
+
+CachingTaskRunner::GetElementResultSpillTier::~GetElementResultSpillTier() {
+  int64_t undeleted_files, undeleted_dirs;
+  Status s = Env::Default()->DeleteRecursively(spill_dir_, &undeleted_files,
+                                               &undeleted_dirs);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete cross-trainer cache spill directory "
+                 << spill_dir_ << ": " << s;
+  }
+}
+
+Status CachingTaskRunner::GetElementResultSpillTier::Write(
+    size_t index, const GetElementResult& element) {
+  snapshot_util::TFRecordWriter writer(ElementPath(index),
+                                       io::compression::kSnappy);
+  TF_RETURN_IF_ERROR(writer.Initialize(Env::Default()));
+  std::vector<Tensor> tensors;
+  tensors.reserve(element.components.size() + 1);
+  tensors.push_back(Tensor(element.element_index));
+  tensors.insert(tensors.end(), element.components.begin(),
+                 element.components.end());
+  TF_RETURN_IF_ERROR(writer.WriteTensors(tensors));
+  return writer.Close();
+}
+
+absl::StatusOr<GetElementResult>
+CachingTaskRunner::GetElementResultSpillTier::Read(size_t index) {
+  snapshot_util::TFRecordReaderImpl reader(ElementPath(index),
+                                           io::compression::kSnappy);
+  TF_RETURN_IF_ERROR(reader.Initialize(Env::Default()));
+  TF_ASSIGN_OR_RETURN(std::vector<Tensor> tensors, reader.GetTensors());
+  if (tensors.empty()) {
+    return errors::DataLoss("Spilled cross-trainer cache element ",
+                            ElementPath(index), " is empty.");
+  }
+  GetElementResult result;
+  result.element_index = tensors[0].scalar<int64_t>()();
+  result.components.assign(std::make_move_iterator(tensors.begin() + 1),
+                           std::make_move_iterator(tensors.end()));
+  return result;
+}
+
+Status CachingTaskRunner::GetElementResultSpillTier::Delete(size_t index) {
+  return Env::Default()->DeleteFile(ElementPath(index));
+}
+
+std::string CachingTaskRunner::GetElementResultSpillTier::ElementPath(
+    size_t index) const {
+  return io::JoinPath(spill_dir_, absl::StrCat("element_", index));
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -155,6 +156,14 @@ class CachingTaskRunner : public TaskRunner {
  public:
   explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
                              size_t max_cache_size_bytes);
+  // Creates a task runner whose cache spills up to `max_spill_size_bytes` of
+  // elements evicted from memory to files in `spill_dir`, for trainers that
+  // are at most `max_trainer_lag_elements` behind. `spill_dir` is deleted when
+  // the task runner is destroyed.
+  CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
+                    size_t max_cache_size_bytes, const std::string& spill_dir,
+                    size_t max_spill_size_bytes,
+                    size_t max_trainer_lag_elements);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -185,6 +194,24 @@ class CachingTaskRunner : public TaskRunner {
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
   };
 
+  // Spills elements to one Snappy-compressed TFRecord file per element, in the
+  // snapshot format of `snapshot_util::TFRecordWriter`. The first record holds
+  // the element index.
+  class GetElementResultSpillTier : public CacheSpillTier<GetElementResult> {
+   public:
+    explicit GetElementResultSpillTier(const std::string& spill_dir);
+    ~GetElementResultSpillTier() override;
+
+    Status Write(size_t index, const GetElementResult& element) override;
+    absl::StatusOr<GetElementResult> Read(size_t index) override;
+    Status Delete(size_t index) override;
+
+   private:
+    std::string ElementPath(size_t index) const;
+
+    const std::string spill_dir_;
+  };
+
   FirstComeFirstServedTaskRunner fcfs_task_runner_;
   CrossTrainerCache<GetElementResult> cache_;
 
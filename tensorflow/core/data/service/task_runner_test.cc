@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -357,6 +358,41 @@ TEST(CachingTaskRunnerTest, SlowClientSkipsData) {
   EXPECT_THAT(slow_trainer_output[0], Gt(0));
 }
 
+TEST(CachingTaskRunnerTest, SlowClientReadsSpilledData) {
+  size_t range = 1000;
+  const std::string spill_dir =
+      io::JoinPath(testing::TmpDir(), "SlowClientReadsSpilledData");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(spill_dir));
+  {
+    CachingTaskRunner runner(std::make_unique<InfiniteRangeIterator>(),
+                             /*max_cache_size_bytes=*/kSmallCache, spill_dir,
+                             /*max_spill_size_bytes=*/kLargeCache,
+                             /*max_trainer_lag_elements=*/10 * range);
+
+    GetElementRequest request;
+    request.set_trainer_id("Slow trainer");
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::vector<int64_t> slow_trainer_output,
+        GetElementsFromTaskRunner<int64_t>(runner, request, 1));
+    request.set_trainer_id("Fast trainer");
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::vector<int64_t> fast_trainer_output,
+        GetElementsFromTaskRunner<int64_t>(runner, request, range));
+    EXPECT_THAT(fast_trainer_output, ElementsAreArray(GetRange(range)));
+
+    // The elements evicted from memory were spilled for the slow trainer.
+    request.set_trainer_id("Slow trainer");
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::vector<int64_t> remaining_output,
+        GetElementsFromTaskRunner<int64_t>(runner, request, range - 1));
+    slow_trainer_output.insert(slow_trainer_output.end(),
+                               remaining_output.begin(),
+                               remaining_output.end());
+    EXPECT_THAT(slow_trainer_output, ElementsAreArray(GetRange(range)));
+  }
+  EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(spill_dir)));
+}
+
 TEST(CachingTaskRunnerTest, ConcurrentTrainers) {
   size_t range = 100;
   size_t num_readers = 10;
@@ -118,6 +118,10 @@ WorkerConfig ApplyWorkerDefaults(const WorkerConfig& config) {
     new_config.set_snapshot_max_chunk_size_bytes(
         kDefaultMaxChunkSize.ToUnsignedBytes());
   }
+  if (new_config.snapshot_initial_commit_interval_ms() == 0) {
+    new_config.set_snapshot_initial_commit_interval_ms(
+        absl::ToInt64Milliseconds(kDefaultInitialCheckpointInterval));
+  }
   return new_config;
 }
 
@@ -743,15 +747,16 @@ Status DataServiceWorkerImpl::UpdateSnapshotWriters(
         &dataset_def));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
                         MakeSnapshotTaskIterator(snapshot_task, dataset_def));
+    SnapshotWriterParams params{
+        snapshot_task.base_path(), snapshot_task.stream_index(),
+        snapshot_task.metadata().compression(), Env::Default(),
+        ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())};
+    params.initial_checkpoint_interval =
+        absl::Milliseconds(config_.snapshot_initial_commit_interval_ms());
     mutex_lock l(mu_);
     snapshot_writers_.emplace(
         snapshot_task_key,
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{
-                snapshot_task.base_path(), snapshot_task.stream_index(),
-                snapshot_task.metadata().compression(), Env::Default(),
-                ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())},
-            std::move(iterator)));
+        std::make_unique<SnapshotStreamWriter>(params, std::move(iterator)));
   }
 
   // Cancel writers for snapshots that are no longer assigned by the dispatcher.
@@ -0,0 +1,235 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int kMaxOpenThreads = 32;
+constexpr int64_t kBuildIndexBufferSize = 256 << 10;  // 256KB
+
+constexpr size_t kIndexEntrySize = sizeof(uint64_t);
+
+// Reads `n` bytes at `offset` of `file` into `scratch`. Returns DATA_LOSS if
+// the file ends before.
+absl::Status ReadFully(const RandomAccessFile& file, const std::string& name,
+                       uint64_t offset, size_t n, char* scratch) {
+  absl::string_view result;
+  absl::Status s = file.Read(offset, n, &result, scratch);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  if (result.size() != n) {
+    return errors::DataLoss("Truncated read of ", n, " bytes at offset ",
+                            offset, " of ", name);
+  }
+  if (result.data() != scratch) {
+    std::memcpy(scratch, result.data(), n);
+  }
+  return absl::OkStatus();
+}
+
+// Reads the record at `offset` of the TFRecord file `file`.
+absl::Status ReadRecordAt(const RandomAccessFile& file,
+                          const std::string& name, uint64_t offset,
+                          tstring* record) {
+  char header[io::RecordReader::kHeaderSize];
+  TF_RETURN_IF_ERROR(ReadFully(file, name, offset, sizeof(header), header));
+  const uint32_t masked_length_crc =
+      core::DecodeFixed32(header + sizeof(uint64_t));
+  if (crc32c::Unmask(masked_length_crc) !=
+      crc32c::Value(header, sizeof(uint64_t))) {
+    return errors::DataLoss("Corrupted record at offset ", offset, " of ",
+                            name);
+  }
+  const uint64_t length = core::DecodeFixed64(header);
+  record->resize_uninitialized(length);
+  TF_RETURN_IF_ERROR(ReadFully(file, name, offset + sizeof(header), length,
+                               record->mdata()));
+  char footer[io::RecordReader::kFooterSize];
+  TF_RETURN_IF_ERROR(ReadFully(file, name, offset + sizeof(header) + length,
+                               sizeof(footer), footer));
+  if (crc32c::Unmask(core::DecodeFixed32(footer)) !=
+      crc32c::Value(record->data(), length)) {
+    return errors::DataLoss("Corrupted record at offset ", offset, " of ",
+                            name);
+  }
+  return absl::OkStatus();
+}
+
+// Returns the number of records listed in the index file of `filename`.
+absl::StatusOr<int64_t> ReadNumRecords(Env* env, const std::string& filename) {
+  const std::string index_filename = TFRecordIndexFilename(filename);
+  if (!env->FileExists(index_filename).ok()) {
+    return errors::NotFound("TFRecord file ", filename,
+                            " has no index file ", index_filename);
+  }
+  uint64_t size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(index_filename, &size));
+  std::unique_ptr<RandomAccessFile> index_file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(index_filename, &index_file));
+  char magic[io::RecordWriter::kIndexMagicSize];
+  if (size < sizeof(magic) ||
+      (size - sizeof(magic)) % kIndexEntrySize != 0 ||
+      !ReadFully(*index_file, index_filename, 0, sizeof(magic), magic).ok() ||
+      absl::string_view(magic, sizeof(magic)) !=
+          io::RecordWriter::kIndexMagic) {
+    return errors::DataLoss(index_filename, " is not a TFRecord index file.");
+  }
+  return (size - sizeof(magic)) / kIndexEntrySize;
+}
+
+}  // namespace
+
+std::string TFRecordIndexFilename(absl::string_view filename) {
+  return absl::StrCat(filename, ".index");
+}
+
+absl::Status BuildTFRecordIndex(Env* env, const std::string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReaderOptions options;
+  options.buffer_size = kBuildIndexBufferSize;
+  io::SequentialRecordReader reader(file.get(), options);
+
+  // Write to a temporary file first so that readers never see a partially
+  // written index.
+  const std::string index_filename = TFRecordIndexFilename(filename);
+  std::string tmp_filename = index_filename;
+  if (!env->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            index_filename);
+  }
+  std::unique_ptr<WritableFile> index_file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_filename, &index_file));
+  absl::Status s = index_file->Append(absl::string_view(
+      io::RecordWriter::kIndexMagic, io::RecordWriter::kIndexMagicSize));
+  while (s.ok()) {
+    const uint64_t offset = reader.TellOffset();
+    int num_skipped;
+    s = reader.SkipRecords(1, &num_skipped);
+    if (errors::IsOutOfRange(s)) {
+      s = absl::OkStatus();
+      break;
+    }
+    if (s.ok()) {
+      char entry[kIndexEntrySize];
+      core::EncodeFixed64(entry, offset);
+      s = index_file->Append(absl::string_view(entry, sizeof(entry)));
+    }
+  }
+  if (s.ok()) s = index_file->Close();
+  if (s.ok()) s = env->RenameFile(tmp_filename, index_filename);
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+absl::StatusOr<std::unique_ptr<TFRecordIndex>> TFRecordIndex::Open(
+    Env* env, std::vector<std::string> filenames) {
+  std::vector<absl::StatusOr<int64_t>> num_records(filenames.size());
+  {
+    // Opening files on remote file systems is slow, so open them in parallel.
+    thread::ThreadPool pool(
+        env, "tf_record_index",
+        std::clamp<int>(filenames.size(), 1, kMaxOpenThreads));
+    for (int i = 0; i < filenames.size(); ++i) {
+      pool.Schedule([env, &filenames, &num_records, i] {
+        num_records[i] = ReadNumRecords(env, filenames[i]);
+      });
+    }
+  }
+  std::vector<int64_t> cumulative_records = {0};
+  cumulative_records.reserve(filenames.size() + 1);
+  for (const absl::StatusOr<int64_t>& n : num_records) {
+    TF_RETURN_IF_ERROR(n.status());
+    cumulative_records.push_back(cumulative_records.back() + *n);
+  }
+  return absl::WrapUnique(new TFRecordIndex(env, std::move(filenames),
+                                            std::move(cumulative_records)));
+}
+
+TFRecordIndex::TFRecordIndex(Env* env, std::vector<std::string> filenames,
+                             std::vector<int64_t> cumulative_records)
+    : env_(env),
+      filenames_(std::move(filenames)),
+      cumulative_records_(std::move(cumulative_records)),
+      files_(filenames_.size()) {}
+
+absl::Status TFRecordIndex::ReadRecord(int64_t index, tstring* record) const {
+  if (index < 0 || index >= num_records()) {
+    return errors::OutOfRange("Record index ", index, " is out of range [0, ",
+                              num_records(), ")");
+  }
+  // The last file whose first record is at or before `index`.
+  const int64_t file_index =
+      std::upper_bound(cumulative_records_.begin(), cumulative_records_.end(),
+                       index) -
+      cumulative_records_.begin() - 1;
+  TF_ASSIGN_OR_RETURN(const File* file, GetFile(file_index));
+  const std::string& filename = filenames_[file_index];
+  char entry[kIndexEntrySize];
+  TF_RETURN_IF_ERROR(ReadFully(
+      *file->index, TFRecordIndexFilename(filename),
+      io::RecordWriter::kIndexMagicSize +
+          (index - cumulative_records_[file_index]) * kIndexEntrySize,
+      sizeof(entry), entry));
+  return ReadRecordAt(*file->data, filename, core::DecodeFixed64(entry),
+                      record);
+}
+
+absl::StatusOr<const TFRecordIndex::File*> TFRecordIndex::GetFile(
+    int64_t file_index) const {
+  mutex_lock l(mu_);
+  std::unique_ptr<File>& file = files_[file_index];
+  if (file == nullptr) {
+    auto new_file = std::make_unique<File>();
+    const std::string& filename = filenames_[file_index];
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename, &new_file->data));
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        TFRecordIndexFilename(filename), &new_file->index));
+    file = std::move(new_file);
+  }
+  return file.get();
+}
+
+}  // namespace data
+}  // namespace tensorflow
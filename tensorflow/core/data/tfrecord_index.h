@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+#define TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+
+// Returns the name of the index file of the TFRecord file `filename`. Index
+// files are written by `io::RecordWriter` when
+// `RecordWriterOptions::index_dest` is set, or by `BuildTFRecordIndex`.
+std::string TFRecordIndexFilename(absl::string_view filename);
+
+// Writes the index file of the existing uncompressed TFRecord file `filename`
+// by scanning its records.
+absl::Status BuildTFRecordIndex(Env* env, const std::string& filename);
+
+// Random access to the records of a sequence of uncompressed TFRecord files,
+// using their index files.
+//
+// Only the number of records of each file is kept in memory; the offset of a
+// record is read from the index file when the record is read. Files are opened
+// on first access and kept open.
+//
+// This class is thread-safe.
+class TFRecordIndex {
+ public:
+  // Opens the index files of `filenames`, in parallel. Returns NOT_FOUND if any
+  // of the files has no index file.
+  static absl::StatusOr<std::unique_ptr<TFRecordIndex>> Open(
+      Env* env, std::vector<std::string> filenames);
+
+  TFRecordIndex(const TFRecordIndex&) = delete;
+  void operator=(const TFRecordIndex&) = delete;
+
+  // The total number of records of all files.
+  int64_t num_records() const { return cumulative_records_.back(); }
+
+  // Reads the record at `index` among the records of all files.
+  absl::Status ReadRecord(int64_t index, tstring* record) const;
+
+ private:
+  struct File {
+    std::unique_ptr<RandomAccessFile> data;
+    std::unique_ptr<RandomAccessFile> index;
+  };
+
+  TFRecordIndex(Env* env, std::vector<std::string> filenames,
+                std::vector<int64_t> cumulative_records);
+
+  // Returns the opened data and index files of file `file_index`.
+  absl::StatusOr<const File*> GetFile(int64_t file_index) const;
+
+  Env* const env_;
+  const std::vector<std::string> filenames_;
+  // `cumulative_records_[i]` is the number of records in the files before
+  // file `i`. Has one more entry than `filenames_`.
+  const std::vector<int64_t> cumulative_records_;
+
+  mutable mutex mu_;
+  mutable std::vector<std::unique_ptr<File>> files_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
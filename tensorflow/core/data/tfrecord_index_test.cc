@@ -0,0 +1,125 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+std::string Record(int64_t file, int64_t index) {
+  // Records of different lengths.
+  return absl::StrCat("record_", file, "_", std::string(index, 'x'));
+}
+
+// Writes `num_records` records to a new TFRecord file, with an index file if
+// `write_index` is true.
+std::string WriteFile(int64_t file, int64_t num_records, bool write_index) {
+  Env* env = Env::Default();
+  std::string filename = io::JoinPath(
+      ::testing::TempDir(), absl::StrCat("tfrecord_index_test_", file));
+  std::unique_ptr<WritableFile> data_file, index_file;
+  TF_CHECK_OK(env->NewWritableFile(filename, &data_file));
+  io::RecordWriterOptions options;
+  if (write_index) {
+    TF_CHECK_OK(
+        env->NewWritableFile(TFRecordIndexFilename(filename), &index_file));
+    options.index_dest = index_file.get();
+  }
+  io::RecordWriter writer(data_file.get(), options);
+  for (int64_t i = 0; i < num_records; ++i) {
+    TF_CHECK_OK(writer.WriteRecord(Record(file, i)));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(data_file->Close());
+  if (index_file) {
+    TF_CHECK_OK(index_file->Close());
+  }
+  return filename;
+}
+
+TEST(TFRecordIndexTest, ReadRecords) {
+  std::vector<std::string> filenames = {
+      WriteFile(0, 10, /*write_index=*/true),
+      WriteFile(1, 0, /*write_index=*/true),
+      WriteFile(2, 5, /*write_index=*/true)};
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TFRecordIndex> index,
+                          TFRecordIndex::Open(Env::Default(), filenames));
+  EXPECT_EQ(index->num_records(), 15);
+
+  tstring record;
+  for (int64_t i = 14; i >= 0; --i) {
+    TF_ASSERT_OK(index->ReadRecord(i, &record));
+    EXPECT_EQ(record, i < 10 ? Record(0, i) : Record(2, i - 10));
+  }
+  EXPECT_THAT(index->ReadRecord(15, &record), StatusIs(error::OUT_OF_RANGE));
+  EXPECT_THAT(index->ReadRecord(-1, &record), StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST(TFRecordIndexTest, BuildIndex) {
+  std::string filename = WriteFile(3, 20, /*write_index=*/false);
+  EXPECT_THAT(TFRecordIndex::Open(Env::Default(), {filename}),
+              StatusIs(error::NOT_FOUND));
+
+  TF_ASSERT_OK(BuildTFRecordIndex(Env::Default(), filename));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TFRecordIndex> index,
+                          TFRecordIndex::Open(Env::Default(), {filename}));
+  EXPECT_EQ(index->num_records(), 20);
+  tstring record;
+  TF_ASSERT_OK(index->ReadRecord(17, &record));
+  EXPECT_EQ(record, Record(3, 17));
+}
+
+TEST(TFRecordIndexTest, InvalidIndexFile) {
+  std::string filename = WriteFile(4, 3, /*write_index=*/false);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 TFRecordIndexFilename(filename), "invalid"));
+  EXPECT_THAT(TFRecordIndex::Open(Env::Default(), {filename}),
+              StatusIs(error::DATA_LOSS));
+}
+
+TEST(TFRecordIndexTest, CorruptedRecord) {
+  std::string filename = WriteFile(5, 3, /*write_index=*/true);
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents[contents.size() - 6] ^= 1;  // In the data of the last record.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TFRecordIndex> index,
+                          TFRecordIndex::Open(Env::Default(), {filename}));
+  tstring record;
+  TF_EXPECT_OK(index->ReadRecord(0, &record));
+  EXPECT_THAT(index->ReadRecord(2, &record), StatusIs(error::DATA_LOSS));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,354 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the collective ops across a cluster, for each implementation
+// that `CollectiveParamResolverLocal::AssignCollectiveType` can select.
+//
+// By default the benchmarks start a local cluster of two tasks with two CPU
+// devices each. To benchmark an existing cluster instead, set
+// TF_COLLECTIVE_BENCH_CLUSTER to a text format `ClusterDef` whose servers are
+// running; the session connects to the first task of the first job and the
+// collectives run over all GPUs of the cluster, or all CPUs if there are none.
+//
+// Besides wall time per iteration, each benchmark reports:
+//   algbw_GBps: tensor bytes per device divided by the median latency.
+//   busbw_GBps: algbw scaled by the bytes each device sends for the algorithm,
+//     which is comparable to the link bandwidth across group sizes.
+//   p50_us, p90_us, p99_us: latency percentiles over the iterations.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_session.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/cluster.pb.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kLocalTasks = 2;
+constexpr int kLocalDevicesPerTask = 2;
+constexpr char kJobName[] = "localhost";
+
+enum class Collective { kAllReduce, kAllToAll, kBroadcast };
+
+// Communication hints that select each implementation.
+constexpr char kRingHint[] = "ring";
+constexpr char kAutoHint[] = "auto";  // Hierarchical ring for reductions.
+constexpr char kNcclHint[] = "nccl";
+
+void StartLocalCluster(ClusterDef* cluster) {
+  auto* job = cluster->add_job();
+  job->set_name(kJobName);
+  for (int i = 0; i < kLocalTasks; ++i) {
+    (*job->mutable_tasks())[i] =
+        strings::StrCat("localhost:", testing::PickUnusedPortOrDie());
+  }
+  static thread::ThreadPool* server_threads =
+      new thread::ThreadPool(Env::Default(), "server_threads", kLocalTasks);
+  for (int task_index = 0; task_index < kLocalTasks; ++task_index) {
+    ServerDef server;
+    server.set_protocol("grpc");
+    server.set_job_name(kJobName);
+    server.set_task_index(task_index);
+    *server.mutable_cluster() = *cluster;
+    ConfigProto* config = server.mutable_default_session_config();
+    (*config->mutable_device_count())["CPU"] = kLocalDevicesPerTask;
+    config->mutable_experimental()->set_collective_group_leader(
+        strings::StrCat("/job:", kJobName, "/replica:0/task:0"));
+    server_threads->Schedule([server] {
+      std::unique_ptr<ServerInterface> svr;
+      TF_CHECK_OK(NewServer(server, &svr));
+      TF_CHECK_OK(svr->Start());
+      TF_CHECK_OK(svr->Join());
+    });
+  }
+}
+
+struct Cluster {
+  SessionOptions options;
+  // Devices the collectives run on: all GPUs, or all CPUs if there are none.
+  std::vector<string> devices;
+  bool has_gpus = false;
+
+  Cluster() {
+    ClusterDef cluster;
+    const char* cluster_spec = std::getenv("TF_COLLECTIVE_BENCH_CLUSTER");
+    if (cluster_spec != nullptr) {
+      CHECK(protobuf::TextFormat::ParseFromString(cluster_spec, &cluster))
+          << "Invalid TF_COLLECTIVE_BENCH_CLUSTER: " << cluster_spec;
+    } else {
+      StartLocalCluster(&cluster);
+    }
+    CHECK_GT(cluster.job_size(), 0);
+    const auto& job = cluster.job(0);
+    CHECK(!job.tasks().empty());
+    options.target = strings::StrCat("grpc://", job.tasks().begin()->second);
+    *options.config.mutable_cluster_def() = cluster;
+    options.config.mutable_experimental()->set_collective_group_leader(
+        strings::StrCat("/job:", job.name(), "/replica:0/task:",
+                        job.tasks().begin()->first));
+
+    std::unique_ptr<GrpcSession> session;
+    TF_CHECK_OK(GrpcSession::Create(options, &session));
+    std::vector<DeviceAttributes> attributes;
+    TF_CHECK_OK(session->ListDevices(&attributes));
+    for (const DeviceAttributes& device : attributes) {
+      if (device.device_type() == DEVICE_GPU) has_gpus = true;
+    }
+    for (const DeviceAttributes& device : attributes) {
+      if (device.device_type() == (has_gpus ? DEVICE_GPU : DEVICE_CPU)) {
+        devices.push_back(device.name());
+      }
+    }
+    CHECK(!devices.empty());
+    std::sort(devices.begin(), devices.end());
+    LOG(INFO) << "Benchmarking collectives over " << devices.size()
+              << (has_gpus ? " GPUs" : " CPUs") << " at " << options.target;
+  }
+};
+
+const Cluster* GetCluster() {
+  static Cluster* cluster = new Cluster;
+  return cluster;
+}
+
+NodeDef Const(const string& name, const string& device, const Tensor& value) {
+  NodeDef node;
+  TF_CHECK_OK(NodeDefBuilder(name, "Const")
+                  .Device(device)
+                  .Attr("dtype", value.dtype())
+                  .Attr("value", value)
+                  .Finalize(&node));
+  return node;
+}
+
+// Returns a graph running one `collective` of `num_elements` floats per
+// device over `devices`, and the names of its collective nodes.
+GraphDef CreateCollectiveGraph(Collective collective, int64_t num_elements,
+                               const string& communication_hint,
+                               const std::vector<string>& devices,
+                               std::vector<string>* targets) {
+  // Instance keys must be unique among the collectives of a group.
+  static std::atomic<int32> next_instance_key{1};
+  const int32 instance_key = next_instance_key++;
+  const int32 group_key = 1;
+  const int32 group_size = devices.size();
+
+  GraphDef graph;
+  for (int i = 0; i < devices.size(); ++i) {
+    const string& device = devices[i];
+    const string prefix = strings::StrCat("d", i, "/");
+    auto add_const = [&](const string& name, const Tensor& value) {
+      *graph.add_node() = Const(prefix + name, device, value);
+      return NodeDefBuilder::NodeOut(prefix + name, 0, value.dtype());
+    };
+    const auto group_size_input =
+        add_const("group_size", test::AsScalar<int32>(group_size));
+    const auto group_key_input =
+        add_const("group_key", test::AsScalar<int32>(group_key));
+    const auto instance_key_input =
+        add_const("instance_key", test::AsScalar<int32>(instance_key));
+    const auto shape_input = add_const(
+        "shape", test::AsTensor<int32>({static_cast<int32>(num_elements)}));
+
+    const string name = prefix + "collective";
+    NodeDef* node = graph.add_node();
+    if (collective == Collective::kBroadcast && i > 0) {
+      TF_CHECK_OK(NodeDefBuilder(name, "CollectiveBcastRecvV2")
+                      .Device(device)
+                      .Input(group_size_input)
+                      .Input(group_key_input)
+                      .Input(instance_key_input)
+                      .Input(shape_input)
+                      .Attr("T", DT_FLOAT)
+                      .Attr("communication_hint", communication_hint)
+                      .Finalize(node));
+      targets->push_back(name);
+      continue;
+    }
+
+    // Fill the input on the device instead of embedding it in the graph.
+    const auto value_input = add_const("value", test::AsScalar<float>(1.0f));
+    TF_CHECK_OK(NodeDefBuilder(prefix + "input", "Fill")
+                    .Device(device)
+                    .Input(shape_input)
+                    .Input(value_input)
+                    .Finalize(graph.add_node()));
+    NodeDefBuilder::NodeOut input(prefix + "input", 0, DT_FLOAT);
+    switch (collective) {
+      case Collective::kAllReduce:
+        TF_CHECK_OK(NodeDefBuilder(name, "CollectiveReduceV2")
+                        .Device(device)
+                        .Input(input)
+                        .Input(group_size_input)
+                        .Input(group_key_input)
+                        .Input(instance_key_input)
+                        .Input(absl::Span<const NodeDefBuilder::NodeOut>())
+                        .Attr("merge_op", "Add")
+                        .Attr("final_op", "Id")
+                        .Attr("communication_hint", communication_hint)
+                        .Finalize(node));
+        break;
+      case Collective::kAllToAll:
+        TF_CHECK_OK(NodeDefBuilder(name, "CollectiveAllToAllV2")
+                        .Device(device)
+                        .Input(input)
+                        .Input(group_size_input)
+                        .Input(group_key_input)
+                        .Input(instance_key_input)
+                        .Input(absl::Span<const NodeDefBuilder::NodeOut>())
+                        .Attr("communication_hint", communication_hint)
+                        .Finalize(node));
+        break;
+      case Collective::kBroadcast:
+        TF_CHECK_OK(NodeDefBuilder(name, "CollectiveBcastSendV2")
+                        .Device(device)
+                        .Input(input)
+                        .Input(group_size_input)
+                        .Input(group_key_input)
+                        .Input(instance_key_input)
+                        .Attr("communication_hint", communication_hint)
+                        .Finalize(node));
+        break;
+    }
+    targets->push_back(name);
+  }
+  return graph;
+}
+
+// Bytes each device sends per byte of its tensor, for ring implementations:
+// an all-reduce reduce-scatters and all-gathers, an all-to-all keeps 1/n of
+// its tensor, and a broadcast forwards the whole tensor.
+double BusBandwidthFactor(Collective collective, int group_size) {
+  switch (collective) {
+    case Collective::kAllReduce:
+      return 2.0 * (group_size - 1) / group_size;
+    case Collective::kAllToAll:
+      return 1.0 * (group_size - 1) / group_size;
+    case Collective::kBroadcast:
+      return 1.0;
+  }
+  return 1.0;
+}
+
+double Percentile(const std::vector<double>& sorted_values, double fraction) {
+  if (sorted_values.empty()) return 0.0;
+  return sorted_values[std::min<size_t>(sorted_values.size() - 1,
+                                        fraction * sorted_values.size())];
+}
+
+void BM_Collective(::testing::benchmark::State& state, Collective collective,
+                   const string& communication_hint) {
+  const Cluster* cluster = GetCluster();
+  if (communication_hint == kNcclHint && !cluster->has_gpus) {
+    state.SkipWithError("NCCL needs GPUs");
+    return;
+  }
+  const int64_t num_bytes = state.range(0);
+  const int64_t num_elements = num_bytes / sizeof(float);
+  const int group_size = cluster->devices.size();
+
+  std::unique_ptr<Session> session(NewSession(cluster->options));
+  std::vector<string> targets;
+  TF_CHECK_OK(session->Create(CreateCollectiveGraph(
+      collective, num_elements, communication_hint, cluster->devices,
+      &targets)));
+  // The first run resolves the group and instance.
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, {}, targets, &outputs));
+
+  std::vector<double> latencies_us;
+  Env* env = Env::Default();
+  for (auto s : state) {
+    const uint64 start_us = env->NowMicros();
+    TF_CHECK_OK(session->Run({}, {}, targets, &outputs));
+    latencies_us.push_back(env->NowMicros() - start_us);
+  }
+  TF_CHECK_OK(session->Close());
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  const double p50_us = Percentile(latencies_us, 0.5);
+  const double algbw_gbps = p50_us > 0 ? num_bytes / (p50_us * 1e3) : 0.0;
+  state.counters["algbw_GBps"] = algbw_gbps;
+  state.counters["busbw_GBps"] =
+      algbw_gbps * BusBandwidthFactor(collective, group_size);
+  state.counters["p50_us"] = p50_us;
+  state.counters["p90_us"] = Percentile(latencies_us, 0.9);
+  state.counters["p99_us"] = Percentile(latencies_us, 0.99);
+  state.SetLabel(strings::StrCat(group_size, " devices; ",
+                                 communication_hint));
+  state.SetBytesProcessed(state.iterations() * num_bytes * group_size);
+}
+
+void BM_AllReduceRing(::testing::benchmark::State& state) {
+  BM_Collective(state, Collective::kAllReduce, kRingHint);
+}
+void BM_AllReduceHierarchical(::testing::benchmark::State& state) {
+  BM_Collective(state, Collective::kAllReduce, kAutoHint);
+}
+void BM_AllReduceNccl(::testing::benchmark::State& state) {
+  BM_Collective(state, Collective::kAllReduce, kNcclHint);
+}
+void BM_AllToAll(::testing::benchmark::State& state) {
+  BM_Collective(state, Collective::kAllToAll, kAutoHint);
+}
+void BM_AllToAllNccl(::testing::benchmark::State& state) {
+  BM_Collective(state, Collective::kAllToAll, kNcclHint);
+}
+void BM_Broadcast(::testing::benchmark::State& state) {
+  BM_Collective(state, Collective::kBroadcast, kAutoHint);
+}
+void BM_BroadcastNccl(::testing::benchmark::State& state) {
+  BM_Collective(state, Collective::kBroadcast, kNcclHint);
+}
+
+// Sizes in bytes per device, from 1KB to 1GB.
+#define BM_COLLECTIVE_SIZES(BM) \
+  BENCHMARK(BM)->RangeMultiplier(32)->Range(1 << 10, 1 << 30)->UseRealTime()
+
+BM_COLLECTIVE_SIZES(BM_AllReduceRing);
+BM_COLLECTIVE_SIZES(BM_AllReduceHierarchical);
+BM_COLLECTIVE_SIZES(BM_AllReduceNccl);
+BM_COLLECTIVE_SIZES(BM_AllToAll);
+BM_COLLECTIVE_SIZES(BM_AllToAllNccl);
+BM_COLLECTIVE_SIZES(BM_Broadcast);
+BM_COLLECTIVE_SIZES(BM_BroadcastNccl);
+
+}  // namespace
+}  // namespace tensorflow
@@ -285,18 +285,20 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
     // Need to update Group cache from the leader.
     CompleteGroupCall* call = new CompleteGroupCall(
         *group_params, device, cancel_mgr, group_leader_, worker_cache_);
+    std::shared_ptr<CancellationManager> abortion_cancel_mgr =
+        AbortionCancelMgr();
     CancellationToken abortion_token =
-        abortion_cancel_mgr_.get_cancellation_token();
-    bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
+        abortion_cancel_mgr->get_cancellation_token();
+    bool already_aborted = !abortion_cancel_mgr->RegisterCallback(
         abortion_token, [call] { call->Cancel(); });
     if (already_aborted) {
       done(errors::Cancelled("collective ops already aborted"));
       delete call;
       return;
     }
-    call->Start([this, device, group_params, call, cancel_mgr, abortion_token,
-                 done](const Status& s) {
-      abortion_cancel_mgr_.DeregisterCallback(abortion_token);
+    call->Start([this, device, group_params, call, cancel_mgr,
+                 abortion_cancel_mgr, abortion_token, done](const Status& s) {
+      abortion_cancel_mgr->DeregisterCallback(abortion_token);
       if (s.ok()) {
         Status status = UpdateGroupCache(call->resp_);
         if (status.ok()) {
@@ -375,17 +377,20 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
     CompleteInstanceCall* call = new CompleteInstanceCall(
         cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
         group_leader_, worker_cache_);
+    std::shared_ptr<CancellationManager> abortion_cancel_mgr =
+        AbortionCancelMgr();
     CancellationToken abortion_token =
-        abortion_cancel_mgr_.get_cancellation_token();
-    bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
+        abortion_cancel_mgr->get_cancellation_token();
+    bool already_aborted = !abortion_cancel_mgr->RegisterCallback(
         abortion_token, [call] { call->Cancel(); });
     if (already_aborted) {
       done(errors::Cancelled("collective ops already aborted"));
       delete call;
       return;
     }
-    call->Start([this, device, cp, call, abortion_token, done](Status s) {
-      abortion_cancel_mgr_.DeregisterCallback(abortion_token);
+    call->Start([this, device, cp, call, abortion_cancel_mgr, abortion_token,
+                 done](Status s) {
+      abortion_cancel_mgr->DeregisterCallback(abortion_token);
       if (s.ok()) {
         s = UpdateInstanceCache(cp, call->resp_);
       }
@@ -412,7 +417,27 @@ void CollectiveParamResolverDistributed::StartAbort(const Status& s) {
     status_ = s;
   }
   StartAbortLocal(s);
-  abortion_cancel_mgr_.StartCancel();
+  AbortionCancelMgr()->StartCancel();
+}
+
+Status CollectiveParamResolverDistributed::Reset() {
+  {
+    mutex_lock l(status_mu_);
+    if (status_.ok()) {
+      return errors::FailedPrecondition(
+          "Collective ops must be aborted before they are reset");
+    }
+    // The calls to the group leader of the aborted collectives were cancelled
+    // with the previous manager.
+    abortion_cancel_mgr_ = std::make_shared<CancellationManager>();
+  }
+  return CollectiveParamResolverLocal::Reset();
+}
+
+std::shared_ptr<CancellationManager>
+CollectiveParamResolverDistributed::AbortionCancelMgr() {
+  mutex_lock l(status_mu_);
+  return abortion_cancel_mgr_;
 }
 
 }  // namespace tensorflow
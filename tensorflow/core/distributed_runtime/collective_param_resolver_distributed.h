@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 
+#include <memory>
+
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -50,6 +52,8 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
 
   void StartAbort(const Status& s) override;
 
+  Status Reset() override;
+
  protected:
   // Returns the cached group iff there's an entry for this group_key in the
   // local group_table_; returns nullptr otherwise.
@@ -87,9 +91,15 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                                    const StatusCallback& done)
       TF_LOCKS_EXCLUDED(instance_mu_, group_mu_);
 
+  // Returns the manager cancelling the calls to the group leader on
+  // abortion, which is replaced when the resolver is reset.
+  std::shared_ptr<CancellationManager> AbortionCancelMgr()
+      TF_LOCKS_EXCLUDED(status_mu_);
+
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
-  CancellationManager abortion_cancel_mgr_;
+  std::shared_ptr<CancellationManager> abortion_cancel_mgr_
+      TF_GUARDED_BY(status_mu_) = std::make_shared<CancellationManager>();
 };
 
 }  // namespace tensorflow
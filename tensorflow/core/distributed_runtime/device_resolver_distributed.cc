@@ -20,7 +20,8 @@ limitations under the License.
 
 namespace tensorflow {
 
-DeviceResolverDistributed::DeviceResolverDistributed(const DeviceMgr* dev_mgr) {
+DeviceResolverDistributed::DeviceResolverDistributed(const DeviceMgr* dev_mgr)
+    : dev_mgr_(dev_mgr) {
   mutex_lock l(mu_);
   for (Device* device : dev_mgr->ListDevices()) {
     attr_table_[device->name()] = device->attributes();
@@ -73,4 +74,12 @@ Status DeviceResolverDistributed::UpdateDeviceAttributes(
   return absl::OkStatus();
 }
 
+void DeviceResolverDistributed::ClearRemoteDevices() {
+  mutex_lock l(mu_);
+  attr_table_.clear();
+  for (Device* device : dev_mgr_->ListDevices()) {
+    attr_table_[device->name()] = device->attributes();
+  }
+}
+
 }  // namespace tensorflow
@@ -40,7 +40,12 @@ class DeviceResolverDistributed : public DeviceResolverInterface {
   Status UpdateDeviceAttributes(
       const std::vector<DeviceAttributes>& attributes) override;
 
+  // Forgets the devices of the other tasks, so that restarted tasks, which
+  // have new incarnations, can be used.
+  void ClearRemoteDevices();
+
  protected:
+  const DeviceMgr* const dev_mgr_;  // Not owned.
   const string task_name_;
   mutex mu_;
   absl::flat_hash_map<string, DeviceAttributes> attr_table_ TF_GUARDED_BY(mu_);
@@ -161,5 +161,20 @@ TEST_F(DeviceResDistTest, UpdateDeviceAttributesDifferentIncarnation) {
       dev_resolver_->UpdateDeviceAttributes(attributes)));
 }
 
+TEST_F(DeviceResDistTest, ClearRemoteDevices) {
+  dev_resolver_->ClearRemoteDevices();
+  std::vector<DeviceAttributes> attributes;
+  EXPECT_TRUE(errors::IsNotFound(dev_resolver_->GetAllDeviceAttributes(
+      "/job:worker/replica:0/task:1", &attributes)));
+  TF_EXPECT_OK(dev_resolver_->GetAllDeviceAttributes(
+      "/job:worker/replica:0/task:0", &attributes));
+  // A restarted task has new incarnations.
+  attributes.clear();
+  attributes.push_back(
+      NewDevice("CPU", "/job:worker/replica:0/task:1/device:CPU:0")
+          ->attributes());
+  TF_EXPECT_OK(dev_resolver_->UpdateDeviceAttributes(attributes));
+}
+
 }  // namespace
 }  // namespace tensorflow
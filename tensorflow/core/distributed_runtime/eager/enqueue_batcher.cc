@@ -0,0 +1,170 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace eager {
+
+int64_t EnqueueBatcher::DeadlineMicrosFromEnv() {
+  static const int64_t deadline_us = [] {
+    int64_t value;
+    absl::Status s = ReadInt64FromEnvVar(
+        "TF_EAGER_CLIENT_ENQUEUE_BATCH_DEADLINE_US", 0, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.message();
+      return int64_t{0};
+    }
+    if (value > 0) {
+      VLOG(1) << "Batching remote eager enqueues for up to " << value << "us";
+    }
+    return value;
+  }();
+  return deadline_us;
+}
+
+EnqueueBatcher::EnqueueBatcher(Env* env, int64_t deadline_us,
+                               int max_batch_items, SendFn send)
+    : env_(env),
+      deadline_us_(deadline_us),
+      max_batch_items_(max_batch_items),
+      send_(std::move(send)) {}
+
+void EnqueueBatcher::Enqueue(const EnqueueRequest* request,
+                             EnqueueResponse* response, StatusCallback done) {
+  absl::Status closed_status;
+  bool send_now = false;
+  {
+    mutex_lock l(mu_);
+    closed_status = closed_status_;
+    if (!closed_status.ok()) {
+      // Fails below.
+    } else if (!sending_ && num_in_flight_ == 0 && pending_ == nullptr) {
+      // Nothing to batch with, so the request is sent as is.
+      sending_ = true;
+      ++num_in_flight_;
+      send_now = true;
+    } else {
+      if (pending_ == nullptr) {
+        pending_ = std::make_unique<Batch>();
+        pending_->request.set_context_id(request->context_id());
+        pending_start_us_ = env_->NowMicros();
+      }
+      for (const QueueItem& item : request->queue()) {
+        *pending_->request.add_queue() = item;
+      }
+      pending_->requests.push_back(
+          {request->queue_size(), response, std::move(done)});
+    }
+  }
+  if (!closed_status.ok()) {
+    done(closed_status);
+    return;
+  }
+  if (send_now) {
+    send_(request, response,
+          [self = shared_from_this(), done = std::move(done)](
+              const absl::Status& s) {
+            done(s);
+            self->BatchDone(/*batch=*/nullptr, s);
+          });
+    mutex_lock l(mu_);
+    sending_ = false;
+  }
+  MaybeSend();
+}
+
+void EnqueueBatcher::Close(const absl::Status& status) {
+  std::unique_ptr<Batch> pending;
+  {
+    mutex_lock l(mu_);
+    closed_status_ = status;
+    pending = std::move(pending_);
+  }
+  if (pending == nullptr) return;
+  for (PendingRequest& r : pending->requests) {
+    r.done(status);
+  }
+}
+
+bool EnqueueBatcher::ReadyToSendLocked() const {
+  if (pending_ == nullptr) return false;
+  return num_in_flight_ == 0 ||
+         pending_->request.queue_size() >= max_batch_items_ ||
+         env_->NowMicros() - pending_start_us_ >= deadline_us_;
+}
+
+void EnqueueBatcher::MaybeSend() {
+  while (true) {
+    Batch* batch;
+    {
+      mutex_lock l(mu_);
+      if (sending_ || !ReadyToSendLocked()) return;
+      sending_ = true;
+      ++num_in_flight_;
+      batch = pending_.release();
+    }
+    VLOG(3) << "Sending " << batch->requests.size()
+            << " enqueue requests with " << batch->request.queue_size()
+            << " items as one";
+    send_(&batch->request, &batch->response,
+          [self = shared_from_this(), batch](const absl::Status& s) {
+            self->BatchDone(batch, s);
+          });
+    mutex_lock l(mu_);
+    sending_ = false;
+  }
+}
+
+void EnqueueBatcher::BatchDone(Batch* batch, const absl::Status& status) {
+  if (batch != nullptr) {
+    absl::Status batch_status = status;
+    const int num_responses = batch->response.queue_response_size();
+    if (batch_status.ok() && num_responses != batch->request.queue_size()) {
+      batch_status = errors::Internal(
+          "Expected ", batch->request.queue_size(),
+          " queue responses for a batched enqueue request, got ",
+          num_responses);
+    }
+    int next = 0;
+    for (PendingRequest& r : batch->requests) {
+      for (int i = 0; i < r.num_items && next < num_responses; ++i) {
+        r.response->add_queue_response()->Swap(
+            batch->response.mutable_queue_response(next++));
+      }
+      r.done(batch_status);
+    }
+    delete batch;
+  }
+  {
+    mutex_lock l(mu_);
+    --num_in_flight_;
+  }
+  MaybeSend();
+}
+
+}  // namespace eager
+}  // namespace tensorflow
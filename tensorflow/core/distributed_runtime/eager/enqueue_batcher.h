@@ -0,0 +1,114 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Coalesces the enqueue requests of one remote context into fewer, larger
+// requests.
+//
+// A request is sent right away when no earlier request is in flight, so
+// synchronous execution sees no extra latency. Otherwise it waits in a
+// pending batch, which is sent as a single request when the requests in
+// flight complete, when it has `max_batch_items` queue items, or when a
+// request arrives more than `deadline_us` after the batch was started.
+// Batches are sent in order, and the responses of a batch are split back
+// into the responses of its requests. An error fails all the requests of
+// the batch that got it, as the server stops executing a stream at its first
+// error anyway.
+//
+// This class is thread-safe.
+class EnqueueBatcher : public std::enable_shared_from_this<EnqueueBatcher> {
+ public:
+  // Sends `request`, which is only valid until the function returns, and
+  // calls `done` once `response` is filled. Must preserve the order of the
+  // requests.
+  using SendFn = std::function<void(const EnqueueRequest* request,
+                                    EnqueueResponse* response,
+                                    StatusCallback done)>;
+
+  // Returns the TF_EAGER_CLIENT_ENQUEUE_BATCH_DEADLINE_US environment
+  // variable, or 0 if it is unset, which disables batching.
+  static int64_t DeadlineMicrosFromEnv();
+
+  static constexpr int kDefaultMaxBatchItems = 256;
+
+  EnqueueBatcher(Env* env, int64_t deadline_us, int max_batch_items,
+                 SendFn send);
+
+  EnqueueBatcher(const EnqueueBatcher&) = delete;
+  void operator=(const EnqueueBatcher&) = delete;
+
+  // Sends the queue items of `request`, which can be destroyed once this
+  // returns, as part of a batch. Fills `response` with their responses and
+  // calls `done` with the status of the batch.
+  void Enqueue(const EnqueueRequest* request, EnqueueResponse* response,
+               StatusCallback done);
+
+  // Fails the pending requests and the later ones with `status`.
+  void Close(const absl::Status& status);
+
+ private:
+  struct PendingRequest {
+    int num_items;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+
+  struct Batch {
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<PendingRequest> requests;
+  };
+
+  // Sends the pending batch while it is ready, unless another thread is
+  // already sending.
+  void MaybeSend();
+  bool ReadyToSendLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void BatchDone(Batch* batch, const absl::Status& status);
+
+  Env* const env_;
+  const int64_t deadline_us_;
+  const int max_batch_items_;
+  const SendFn send_;
+
+  mutex mu_;
+  // Set while a thread is sending, so that batches are sent in order.
+  bool sending_ TF_GUARDED_BY(mu_) = false;
+  int num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  std::unique_ptr<Batch> pending_ TF_GUARDED_BY(mu_);
+  uint64_t pending_start_us_ TF_GUARDED_BY(mu_) = 0;
+  absl::Status closed_status_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
@@ -0,0 +1,212 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+constexpr int64_t kLongDeadlineUs = 3600LL * 1000 * 1000;
+
+// Records the sent requests and completes them when asked to, answering
+// each item with its handle id as the shape of its output.
+class FakeServer {
+ public:
+  EnqueueBatcher::SendFn SendFn() {
+    return [this](const EnqueueRequest* request, EnqueueResponse* response,
+                  StatusCallback done) {
+      requests_.push_back(*request);
+      calls_.push_back({response, std::move(done)});
+    };
+  }
+
+  int num_sent() const { return requests_.size(); }
+  const EnqueueRequest& sent(int i) const { return requests_[i]; }
+
+  void Complete(int i, const absl::Status& status) {
+    for (const QueueItem& item : requests_[i].queue()) {
+      QueueResponse* r = calls_[i].response->add_queue_response();
+      r->add_shape()->add_dim()->set_size(item.handle_to_decref().op_id());
+    }
+    // `done` can send the next batch, which grows `calls_`.
+    StatusCallback done = std::move(calls_[i].done);
+    done(status);
+  }
+
+ private:
+  struct Call {
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+  std::vector<EnqueueRequest> requests_;
+  std::vector<Call> calls_;
+};
+
+EnqueueRequest Request(const std::vector<int64_t>& ids) {
+  EnqueueRequest request;
+  request.set_context_id(7);
+  for (int64_t id : ids) {
+    request.add_queue()->mutable_handle_to_decref()->set_op_id(id);
+  }
+  return request;
+}
+
+std::vector<int64_t> ResponseIds(const EnqueueResponse& response) {
+  std::vector<int64_t> ids;
+  for (const QueueResponse& r : response.queue_response()) {
+    ids.push_back(r.shape(0).dim(0).size());
+  }
+  return ids;
+}
+
+std::vector<int64_t> RequestIds(const EnqueueRequest& request) {
+  std::vector<int64_t> ids;
+  for (const QueueItem& item : request.queue()) {
+    ids.push_back(item.handle_to_decref().op_id());
+  }
+  return ids;
+}
+
+StatusCallback SetStatus(absl::Status* status) {
+  return [status](const absl::Status& s) { *status = s; };
+}
+
+TEST(EnqueueBatcherTest, BatchesBehindRequestInFlight) {
+  FakeServer server;
+  auto batcher = std::make_shared<EnqueueBatcher>(
+      Env::Default(), kLongDeadlineUs, /*max_batch_items=*/100,
+      server.SendFn());
+  constexpr int kNumRequests = 4;
+  std::vector<EnqueueResponse> responses(kNumRequests);
+  std::vector<absl::Status> statuses(kNumRequests,
+                                     errors::Unknown("Not done"));
+  for (int i = 0; i < kNumRequests; ++i) {
+    // Destroyed once enqueued.
+    EnqueueRequest request = Request({i * 10, i * 10 + 1});
+    batcher->Enqueue(&request, &responses[i], SetStatus(&statuses[i]));
+  }
+  // The first request is sent right away, and the others wait for it.
+  ASSERT_EQ(server.num_sent(), 1);
+  EXPECT_EQ(RequestIds(server.sent(0)), (std::vector<int64_t>{0, 1}));
+
+  server.Complete(0, absl::OkStatus());
+  TF_EXPECT_OK(statuses[0]);
+  ASSERT_EQ(server.num_sent(), 2);
+  EXPECT_EQ(server.sent(1).context_id(), 7);
+  EXPECT_EQ(RequestIds(server.sent(1)),
+            (std::vector<int64_t>{10, 11, 20, 21, 30, 31}));
+
+  server.Complete(1, absl::OkStatus());
+  for (int i = 0; i < kNumRequests; ++i) {
+    TF_EXPECT_OK(statuses[i]);
+    EXPECT_EQ(ResponseIds(responses[i]),
+              (std::vector<int64_t>{i * 10, i * 10 + 1}));
+  }
+  EXPECT_EQ(server.num_sent(), 2);
+}
+
+TEST(EnqueueBatcherTest, SendsFullBatch) {
+  FakeServer server;
+  auto batcher = std::make_shared<EnqueueBatcher>(
+      Env::Default(), kLongDeadlineUs, /*max_batch_items=*/3,
+      server.SendFn());
+  std::vector<EnqueueResponse> responses(4);
+  for (int i = 0; i < 4; ++i) {
+    EnqueueRequest request = Request({i, i + 100});
+    batcher->Enqueue(&request, &responses[i], [](const absl::Status& s) {});
+  }
+  // The second and third requests made a full batch.
+  ASSERT_EQ(server.num_sent(), 2);
+  EXPECT_EQ(RequestIds(server.sent(1)),
+            (std::vector<int64_t>{1, 101, 2, 102}));
+  server.Complete(0, absl::OkStatus());
+  server.Complete(1, absl::OkStatus());
+  ASSERT_EQ(server.num_sent(), 3);
+  EXPECT_EQ(RequestIds(server.sent(2)), (std::vector<int64_t>{3, 103}));
+}
+
+TEST(EnqueueBatcherTest, SendsAfterDeadline) {
+  FakeServer server;
+  auto batcher = std::make_shared<EnqueueBatcher>(
+      Env::Default(), /*deadline_us=*/0, /*max_batch_items=*/100,
+      server.SendFn());
+  std::vector<EnqueueResponse> responses(3);
+  for (int i = 0; i < 3; ++i) {
+    EnqueueRequest request = Request({i});
+    batcher->Enqueue(&request, &responses[i], [](const absl::Status& s) {});
+  }
+  EXPECT_EQ(server.num_sent(), 3);
+}
+
+TEST(EnqueueBatcherTest, ErrorFailsTheWholeBatch) {
+  FakeServer server;
+  auto batcher = std::make_shared<EnqueueBatcher>(
+      Env::Default(), kLongDeadlineUs, /*max_batch_items=*/100,
+      server.SendFn());
+  std::vector<EnqueueResponse> responses(3);
+  std::vector<absl::Status> statuses(3);
+  for (int i = 0; i < 3; ++i) {
+    EnqueueRequest request = Request({i});
+    batcher->Enqueue(&request, &responses[i], SetStatus(&statuses[i]));
+  }
+  server.Complete(0, absl::OkStatus());
+  server.Complete(1, errors::InvalidArgument("Bad op"));
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_THAT(statuses[1], StatusIs(error::INVALID_ARGUMENT));
+  EXPECT_THAT(statuses[2], StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(EnqueueBatcherTest, CloseFailsPendingRequests) {
+  FakeServer server;
+  auto batcher = std::make_shared<EnqueueBatcher>(
+      Env::Default(), kLongDeadlineUs, /*max_batch_items=*/100,
+      server.SendFn());
+  std::vector<EnqueueResponse> responses(3);
+  std::vector<absl::Status> statuses(3);
+  for (int i = 0; i < 2; ++i) {
+    EnqueueRequest request = Request({i});
+    batcher->Enqueue(&request, &responses[i], SetStatus(&statuses[i]));
+  }
+  batcher->Close(errors::Cancelled("Closed"));
+  EXPECT_THAT(statuses[1], StatusIs(error::CANCELLED));
+  EnqueueRequest request = Request({2});
+  batcher->Enqueue(&request, &responses[2], SetStatus(&statuses[2]));
+  EXPECT_THAT(statuses[2], StatusIs(error::CANCELLED));
+
+  // The request in flight completes normally.
+  server.Complete(0, absl::OkStatus());
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_EQ(server.num_sent(), 1);
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
@@ -175,6 +175,7 @@ Status GraphMgr::InitItem(const string& handle, const GraphDef& gdef,
   opts.allow_internal_ops = true;
   opts.expect_device_spec = true;
   opts.validate_nodes = true;
+  opts.thread_pool = worker_env_->compute_pool;
   TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(opts, gdef, &graph));
 
   // Splits "graph" into multiple subgraphs by device names.
@@ -209,6 +210,7 @@ Status GraphMgr::InitItem(const string& handle, const GraphDef& gdef,
     // There are internal operations (e.g., send/recv) that we now allow.
     device_opts.allow_internal_ops = true;
     device_opts.expect_device_spec = true;
+    device_opts.thread_pool = worker_env_->compute_pool;
     TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
         device_opts, std::move(partition.second), device_graph.get()));
     partition_graphs.emplace(partition.first, std::move(device_graph));
@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/tracing.h"
 #include "tsl/protobuf/coordination_config.pb.h"
 
@@ -96,6 +97,12 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
 
     stats_publisher_ = stats_publisher_factory(handle, bopts, session_opts);
 
+    Status s = ReadInt64FromEnvVar("TF_MASTER_SESSION_MAX_STEP_OVERLAP", 0,
+                                   &max_step_overlap_);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+    }
+
     // Initialize a name to node map for processing device stats.
     for (Node* n : client_graph_before_register_->graph.nodes()) {
       name_to_node_details_.emplace(
@@ -219,9 +226,14 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
                        RunCallableResponse* resp, CancellationManager* cm);
 
   // Calls workers to cleanup states for the step "step_id".  Calls
-  // `done` when all cleanup RPCs have completed.
+  // `done` when all cleanup RPCs have completed. If partitions of the step
+  // are still running (see `max_step_overlap_`), the cleanup starts when they
+  // are done.
   void CleanupPartitionsAsync(int64_t step_id, StatusCallback done);
 
+  // Blocks until no step has partitions running after the step returned.
+  void WaitForOverlappedSteps();
+
   // Post-processing of any runtime statistics gathered during execution.
   void ProcessStats(int64_t step_id, PerStepState* pss, ProfileHandler* ph,
                     const RunOptions& options, RunMetadata* resp);
@@ -256,6 +268,34 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   const int64_t collective_graph_key_;
   std::atomic<int64_t> execution_count_ = {0};
 
+  // The maximum number of steps whose partitions without fetches may still
+  // be running when the step returns, set with the
+  // TF_MASTER_SESSION_MAX_STEP_OVERLAP environment variable. 0 (the default)
+  // waits for all partitions. Overlapping steps lets short steps return
+  // after the partitions that produce their fetches, while e.g. the variable
+  // updates of the step run on the parameter servers, so later steps may see
+  // some of the step's updates. Errors of such partitions are returned by the
+  // next step.
+  int64_t max_step_overlap_ = 0;
+
+  // A step whose partitions without fetches may still be running.
+  struct OverlappedStep {
+    // Whether the step returned OK while the partitions were running, so
+    // that their error must be returned by the next step.
+    bool returned_ok = false;
+    // Cleans up the step when the partitions are done.
+    std::function<void()> cleanup;
+  };
+  mutex overlap_mu_;
+  condition_variable overlap_cv_;
+  std::unordered_map<int64_t, OverlappedStep> overlapped_steps_
+      TF_GUARDED_BY(overlap_mu_);
+  // The first error of an overlapped step that returned OK.
+  Status overlapped_status_ TF_GUARDED_BY(overlap_mu_);
+
+  // Called when all partitions of the overlapped step `step_id` are done.
+  void FinishOverlappedStep(int64_t step_id, const Status& s);
+
   // Graph partitioned into per-location subgraphs.
   struct Part {
     // Worker name.
@@ -507,11 +547,15 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
 
 namespace {
 // Helper class to manage "num" parallel RunGraph calls.
-class RunManyGraphs {
+//
+// `Wait()` does not wait for the `num_deferred` calls marked `deferred`;
+// `WhenAllDone()` is notified when all calls are done.
+class RunManyGraphs : public core::RefCounted {
  public:
-  explicit RunManyGraphs(int num) : calls_(num), pending_(num) {}
+  RunManyGraphs(int num, int num_deferred)
+      : calls_(num), pending_(num - num_deferred), num_running_(num) {}
 
-  ~RunManyGraphs() {}
+  ~RunManyGraphs() override {}
 
   // Returns the index-th call.
   struct Call {
@@ -520,6 +564,7 @@ class RunManyGraphs {
     std::atomic<bool> done{false};
     std::unique_ptr<MutableRunGraphRequestWrapper> req;
     std::unique_ptr<MutableRunGraphResponseWrapper> resp;
+    bool deferred = false;
   };
   Call* get(int index) { return &calls_[index]; }
 
@@ -541,7 +586,31 @@ class RunManyGraphs {
       ReportBadStatus(errors::CreateWithUpdatedMessage(
           s, strings::StrCat("From ", *call->worker_name, ":\n", s.message())));
     }
-    pending_.DecrementCount();
+    if (!call->deferred) {
+      pending_.DecrementCount();
+    }
+    std::function<void()> all_done;
+    {
+      mutex_lock l(mu_);
+      if (--num_running_ == 0) {
+        all_done = std::move(all_done_);
+      }
+    }
+    if (all_done) {
+      all_done();
+    }
+  }
+
+  // Calls `done` once all calls, including the deferred ones, are done.
+  void WhenAllDone(std::function<void()> done) {
+    {
+      mutex_lock l(mu_);
+      if (num_running_ > 0) {
+        all_done_ = std::move(done);
+        return;
+      }
+    }
+    done();
   }
 
   void StartCancel() {
@@ -572,7 +641,7 @@ class RunManyGraphs {
         << "RunStep still blocked after 60 seconds. Failed with error status: "
         << status();
     for (const Call& call : calls_) {
-      if (!call.done) {
+      if (!call.done && !call.deferred) {
         LOG(ERROR) << "- No response from RunGraph call to worker: "
                    << *call.worker_name;
       }
@@ -594,6 +663,8 @@ class RunManyGraphs {
   mutable mutex mu_;
   StatusGroup status_group_ TF_GUARDED_BY(mu_);
   bool cancel_issued_ TF_GUARDED_BY(mu_) = false;
+  int num_running_ TF_GUARDED_BY(mu_);
+  std::function<void()> all_done_ TF_GUARDED_BY(mu_);
 
   void ReportBadStatus(const Status& s) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     VLOG(1) << "Master received error status " << s;
@@ -672,13 +743,27 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     pss->step_stats.resize(partitions_.size());
   }
 
+  // Partitions without fetches are deferred: the step may return while they
+  // are still running.
+  const bool overlap =
+      max_step_overlap_ > 0 && !is_partial_ &&
+      collective_graph_key_ == BuildGraphOptions::kNoCollectiveGraphKey &&
+      !pss->collect_costs && !pss->collect_timeline &&
+      !pss->collect_partition_graphs;
   const int num = partitions_.size();
-  RunManyGraphs calls(num);
+  int num_deferred = 0;
+  if (overlap) {
+    for (const Part& part : partitions_) {
+      if (part.key_fetch.empty()) ++num_deferred;
+    }
+  }
+  core::RefCountPtr<RunManyGraphs> calls(new RunManyGraphs(num, num_deferred));
 
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
-    RunManyGraphs::Call* c = calls.get(i);
+    RunManyGraphs::Call* c = calls->get(i);
     c->worker_name = &part.name;
+    c->deferred = overlap && part.key_fetch.empty();
     c->req.reset(part.worker->CreateRunGraphRequest());
     c->resp.reset(part.worker->CreateRunGraphResponse());
     if (is_partial_) {
@@ -738,42 +823,96 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
     }
   }
 
+  if (max_step_overlap_ > 0) {
+    mutex_lock l(overlap_mu_);
+    if (num_deferred > 0) {
+      // Waits until fewer than `max_step_overlap_` steps overlap.
+      while (overlapped_steps_.size() >=
+             static_cast<size_t>(max_step_overlap_)) {
+        overlap_cv_.wait(l);
+      }
+    }
+    if (!overlapped_status_.ok()) {
+      Status s = errors::CreateWithUpdatedMessage(
+          overlapped_status_,
+          strings::StrCat("A previous step failed after returning: ",
+                          overlapped_status_.message()));
+      overlapped_status_ = absl::OkStatus();
+      return s;
+    }
+    if (num_deferred > 0) {
+      overlapped_steps_.emplace(step_id, OverlappedStep());
+    }
+  }
+
   // Issues RunGraph calls.
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
-    RunManyGraphs::Call* call = calls.get(i);
+    RunManyGraphs::Call* call = calls->get(i);
     TRACEPRINTF("Partition %d %s", i, part.name);
-    part.worker->RunGraphAsync(
-        &call->opts, call->req.get(), call->resp.get(),
-        std::bind(&RunManyGraphs::WhenDone, &calls, i, std::placeholders::_1));
+    calls->Ref();
+    part.worker->RunGraphAsync(&call->opts, call->req.get(), call->resp.get(),
+                               [calls = calls.get(), i](const Status& s) {
+                                 calls->WhenDone(i, s);
+                                 calls->Unref();
+                               });
   }
 
   // Waits for the RunGraph calls.
-  call_opts->SetCancelCallback([&calls]() {
+  RunManyGraphs* calls_ptr = calls.get();
+  call_opts->SetCancelCallback([calls_ptr]() {
     LOG(INFO) << "Client requested cancellation for RunStep, cancelling "
                  "worker operations.";
-    calls.StartCancel();
+    calls_ptr->StartCancel();
   });
   auto token = cm->get_cancellation_token();
   const bool success =
-      cm->RegisterCallback(token, [&calls]() { calls.StartCancel(); });
+      cm->RegisterCallback(token, [calls_ptr]() { calls_ptr->StartCancel(); });
   if (!success) {
-    calls.StartCancel();
+    calls->StartCancel();
   }
-  calls.Wait();
+  calls->Wait();
   call_opts->ClearCancelCallback();
-  if (success) {
+  if (num_deferred > 0) {
+    // The cancellation callback stays registered until the deferred calls
+    // are done.
+    Ref();
+    calls->Ref();
+    calls->WhenAllDone([this, calls_ptr, cm, token, success, step_id]() {
+      if (success) {
+        cm->DeregisterCallback(token);
+      }
+      FinishOverlappedStep(step_id, calls_ptr->status());
+      calls_ptr->Unref();
+      Unref();
+    });
+  } else if (success) {
     cm->DeregisterCallback(token);
-  } else {
+  }
+  if (!success) {
     return errors::Cancelled("Step was cancelled");
   }
-  TF_RETURN_IF_ERROR(calls.status());
+  if (num_deferred > 0) {
+    mutex_lock l(overlap_mu_);
+    Status s = calls->status();
+    auto it = overlapped_steps_.find(step_id);
+    if (s.ok() && it != overlapped_steps_.end()) {
+      it->second.returned_ok = true;
+    }
+    TF_RETURN_IF_ERROR(s);
+  } else {
+    TF_RETURN_IF_ERROR(calls->status());
+  }
 
   // Collects fetches and metadata.
   Status status;
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
-    MutableRunGraphResponseWrapper* run_graph_resp = calls.get(i)->resp.get();
+    if (calls->get(i)->deferred) {
+      // Still running, and has no fetches.
+      continue;
+    }
+    MutableRunGraphResponseWrapper* run_graph_resp = calls->get(i)->resp.get();
     for (size_t j = 0; j < run_graph_resp->num_recvs(); ++j) {
       auto iter = part.key_fetch.find(run_graph_resp->recv_key(j));
       if (iter == part.key_fetch.end()) {
@@ -929,6 +1068,16 @@ class CleanupBroadcastHelper {
 
 void MasterSession::ReffedClientGraph::CleanupPartitionsAsync(
     int64_t step_id, StatusCallback done) {
+  {
+    mutex_lock l(overlap_mu_);
+    auto it = overlapped_steps_.find(step_id);
+    if (it != overlapped_steps_.end()) {
+      it->second.cleanup = [this, step_id, done = std::move(done)]() mutable {
+        CleanupPartitionsAsync(step_id, std::move(done));
+      };
+      return;
+    }
+  }
   const int num = partitions_.size();
   // Helper object will be deleted when the final call completes.
   CleanupBroadcastHelper* helper =
@@ -941,6 +1090,33 @@ void MasterSession::ReffedClientGraph::CleanupPartitionsAsync(
   }
 }
 
+void MasterSession::ReffedClientGraph::FinishOverlappedStep(int64_t step_id,
+                                                            const Status& s) {
+  std::function<void()> cleanup;
+  {
+    mutex_lock l(overlap_mu_);
+    auto it = overlapped_steps_.find(step_id);
+    DCHECK(it != overlapped_steps_.end());
+    if (it->second.returned_ok && !s.ok()) {
+      LOG(ERROR) << "Step " << step_id << " failed after returning: " << s;
+      overlapped_status_.Update(s);
+    }
+    cleanup = std::move(it->second.cleanup);
+    overlapped_steps_.erase(it);
+    overlap_cv_.notify_all();
+  }
+  if (cleanup) {
+    cleanup();
+  }
+}
+
+void MasterSession::ReffedClientGraph::WaitForOverlappedSteps() {
+  mutex_lock l(overlap_mu_);
+  while (!overlapped_steps_.empty()) {
+    overlap_cv_.wait(l);
+  }
+}
+
 void MasterSession::ReffedClientGraph::ProcessStats(int64_t step_id,
                                                     PerStepState* pss,
                                                     ProfileHandler* ph,
@@ -2134,6 +2310,18 @@ Status MasterSession::Close() {
     mutex_lock l(mu_);
     closed_ = true;  // All subsequent calls to Run() or Extend() will fail.
   }
+  // Lets the steps that returned finish before cancelling the running steps.
+  std::vector<ReffedClientGraph*> rcgs;
+  {
+    mutex_lock l(mu_);
+    for (const auto& entry : run_graphs_) rcgs.push_back(entry.second);
+    for (const auto& entry : callables_) rcgs.push_back(entry.second);
+    for (ReffedClientGraph* rcg : rcgs) rcg->Ref();
+  }
+  for (ReffedClientGraph* rcg : rcgs) {
+    rcg->WaitForOverlappedSteps();
+    rcg->Unref();
+  }
   cancellation_manager_.StartCancel();
   std::vector<ReffedClientGraph*> to_unref;
   {
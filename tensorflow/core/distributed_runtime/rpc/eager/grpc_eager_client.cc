@@ -16,11 +16,14 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "xla/tsl/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -206,6 +209,21 @@ class GrpcEagerClient : public EagerClient {
     VLOG(1) << "Sending RPC to close remote eager context "
             << request->DebugString();
 
+    std::shared_ptr<EnqueueBatcher> batcher;
+    {
+      mutex_lock l(mu_);
+      auto it = enqueue_batchers_.find(request->context_id());
+      if (it != enqueue_batchers_.end()) {
+        batcher = std::move(it->second);
+        enqueue_batchers_.erase(it);
+      }
+    }
+    if (batcher != nullptr) {
+      batcher->Close(errors::Cancelled("Remote eager context ",
+                                       request->context_id(),
+                                       " was closed before the request"));
+    }
+
     mutex_lock l(mu_);
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
@@ -228,19 +246,13 @@ class GrpcEagerClient : public EagerClient {
     // 2. The flag set in the eager executor.
     // Streaming enqueue is allowed only when the both are enabled.
     if (EnableStreaming() && enable_streaming_enqueue) {
-      mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+      std::shared_ptr<EnqueueBatcher> batcher =
+          GetEnqueueBatcher(request->context_id());
+      if (batcher != nullptr) {
+        batcher->Enqueue(request, response, std::move(done_wrapped));
+      } else {
+        SendStreamingEnqueue(request, response, std::move(done_wrapped));
       }
-      // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -266,6 +278,46 @@ class GrpcEagerClient : public EagerClient {
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
 
+  // Batchers of the streaming enqueue requests, by context id, if
+  // TF_EAGER_CLIENT_ENQUEUE_BATCH_DEADLINE_US is set.
+  std::unordered_map<uint64, std::shared_ptr<EnqueueBatcher>>
+      enqueue_batchers_ TF_GUARDED_BY(mu_);
+
+  void SendStreamingEnqueue(const EnqueueRequest* request,
+                            EnqueueResponse* response, StatusCallback done) {
+    mutex_lock l(mu_);
+    auto it = enqueue_dispatchers_.find(request->context_id());
+    if (it == enqueue_dispatchers_.end()) {
+      auto it_and_bool = enqueue_dispatchers_.emplace(
+          std::piecewise_construct,
+          std::forward_as_tuple(request->context_id()),
+          std::forward_as_tuple(
+              &stub_, cq_, "/tensorflow.eager.EagerService/StreamingEnqueue"));
+      it = it_and_bool.first;
+    }
+    // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
+    it->second.SendNextRequest(*request, response, std::move(done));
+  }
+
+  // Returns nullptr if batching is disabled.
+  std::shared_ptr<EnqueueBatcher> GetEnqueueBatcher(uint64 context_id) {
+    const int64_t deadline_us = EnqueueBatcher::DeadlineMicrosFromEnv();
+    if (deadline_us <= 0) return nullptr;
+    mutex_lock l(mu_);
+    std::shared_ptr<EnqueueBatcher>& batcher = enqueue_batchers_[context_id];
+    if (batcher == nullptr) {
+      // Batches are only sent while requests of the batch hold a reference
+      // to this client.
+      batcher = std::make_shared<EnqueueBatcher>(
+          Env::Default(), deadline_us, EnqueueBatcher::kDefaultMaxBatchItems,
+          [this](const EnqueueRequest* request, EnqueueResponse* response,
+                 StatusCallback done) {
+            SendStreamingEnqueue(request, response, std::move(done));
+          });
+    }
+    return batcher;
+  }
+
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
     return [this, done = std::move(done)](const Status& status) {
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/default_device.h"
 #include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -931,6 +932,105 @@ TEST(SessionTest, SharedVar) {
   }
 }
 
+TEST(SessionTest, OverlappedSteps) {
+  // The servers read the variable when they start.
+  setenv("TF_MASTER_SESSION_MAX_STEP_OVERLAP", "2", 1);
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_ASSERT_OK(test::TestCluster::MakeTestCluster(
+      TestClusterConfig()
+          .Options(Devices(1, 0))
+          .Jobs({TestJob{"localhost", /*num_tasks=*/2}}),
+      &cluster));
+  unsetenv("TF_MASTER_SESSION_MAX_STEP_OVERLAP");
+  const string master = cluster->targets()[0];
+  const string& dev_b = cluster->devices()[1].name();
+
+  GraphDef gdef;
+  string init_name;
+  string inc_name;
+  string get_name;
+  {
+    Graph g(OpRegistry::Global());
+    Tensor one(DT_FLOAT, TensorShape({}));
+    one.scalar<float>()() = 1.0;
+    Node* var = test::graph::Var(&g, DT_FLOAT, one.shape());
+    var->set_assigned_device_name(dev_b);
+    Node* init = test::graph::Assign(&g, var, test::graph::Constant(&g, one));
+    init_name = init->name();
+    // Overlapping increments must not race.
+    Node* update;
+    TF_ASSERT_OK(NodeBuilder(g.NewName("n"), "AssignAdd")
+                     .Input(var)
+                     .Input(test::graph::Constant(&g, one))
+                     .Attr("use_locking", true)
+                     .Finalize(&g, &update));
+    inc_name = update->name();
+    get_name = var->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+
+  constexpr int kNumSteps = 20;
+  {
+    // The steps only have targets, so they may return before they finish.
+    std::unique_ptr<Session> sess(NewRemote(Options(master, 1)));
+    TF_ASSERT_OK(sess->Create(gdef));
+    // Fetching the initial value waits for the initialization.
+    std::vector<Tensor> ret;
+    TF_ASSERT_OK(sess->Run({}, {init_name}, {}, &ret));
+    for (int i = 0; i < kNumSteps; ++i) {
+      TF_ASSERT_OK(sess->Run({}, {}, {inc_name}, nullptr));
+    }
+    // Waits for the steps to finish.
+    TF_ASSERT_OK(sess->Close());
+  }
+  {
+    std::unique_ptr<Session> sess(NewRemote(Options(master, 1)));
+    TF_ASSERT_OK(sess->Create(gdef));
+    std::vector<Tensor> ret;
+    TF_ASSERT_OK(sess->Run({}, {get_name}, {}, &ret));
+    ASSERT_EQ(ret.size(), 1);
+    EXPECT_EQ(ret[0].scalar<float>()(), 1.0 + kNumSteps);
+    TF_ASSERT_OK(sess->Close());
+  }
+}
+
+TEST(SessionTest, OverlappedStepErrorIsReturned) {
+  setenv("TF_MASTER_SESSION_MAX_STEP_OVERLAP", "1", 1);
+  std::unique_ptr<test::TestCluster> cluster;
+  TF_ASSERT_OK(test::TestCluster::MakeTestCluster(
+      TestClusterConfig()
+          .Options(Devices(1, 0))
+          .Jobs({TestJob{"localhost", /*num_tasks=*/2}}),
+      &cluster));
+  unsetenv("TF_MASTER_SESSION_MAX_STEP_OVERLAP");
+  const string master = cluster->targets()[0];
+  const string& dev_b = cluster->devices()[1].name();
+
+  GraphDef gdef;
+  string target;
+  {
+    Graph g(OpRegistry::Global());
+    auto b = test::graph::Constant(&g, Tensor());
+    b->set_assigned_device_name(dev_b);
+    auto b_delay = test::graph::Delay(&g, b, Microseconds(100000));
+    b_delay->set_assigned_device_name(dev_b);
+    auto b_err = test::graph::Error(&g, b_delay, "fantasia!");
+    b_err->set_assigned_device_name(dev_b);
+    target = b_err->name();
+    test::graph::ToGraphDef(&g, &gdef);
+  }
+  std::unique_ptr<Session> sess(NewRemote(Options(master, 1)));
+  TF_ASSERT_OK(sess->Create(gdef));
+  // The first step may return before it fails, in which case the second
+  // step waits for it and returns its error.
+  Status first = sess->Run({}, {}, {target}, nullptr);
+  Status second = sess->Run({}, {}, {target}, nullptr);
+  const Status& failed = first.ok() ? second : first;
+  EXPECT_FALSE(failed.ok());
+  EXPECT_NE(failed.ToString().find("fantasia!"), string::npos);
+  TF_ASSERT_OK(sess->Close());
+}
+
 TEST(SessionTest, SharedVarWithMultipleLearnerReplicas) {
   std::unique_ptr<test::TestCluster> cluster;
   TF_ASSERT_OK(test::TestCluster::MakeTestCluster(
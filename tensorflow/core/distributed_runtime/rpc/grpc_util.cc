@@ -15,9 +15,57 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
+#include <utility>
+#include <vector>
+
+#include "grpcpp/support/slice.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
+namespace {
+
+// A TensorBuffer that refers to bytes of a received gRPC slice, which it keeps
+// alive.
+class GrpcSliceBuffer : public TensorBuffer {
+ public:
+  GrpcSliceBuffer(::grpc::Slice slice, const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        slice_(std::move(slice)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("grpc");
+  }
+  // The slice may be shared with gRPC, so the buffer must not be forwarded to
+  // ops that write to their inputs in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::Slice slice_;
+  const size_t size_;
+};
+
+}  // namespace
+
+TensorBuffer* GrpcByteSource::AdoptBytes(const char* data, size_t num_bytes) {
+  // Dumping the buffer only takes references to its slices. The bytes are not
+  // in any of them if the reader had to decompress or copy them, e.g. for
+  // inlined slices.
+  std::vector<::grpc::Slice> slices;
+  if (!buffer_->Dump(&slices).ok()) return nullptr;
+  for (::grpc::Slice& slice : slices) {
+    const char* begin = reinterpret_cast<const char*>(slice.begin());
+    if (data >= begin && data + num_bytes <= begin + slice.size()) {
+      return new GrpcSliceBuffer(std::move(slice), data, num_bytes);
+    }
+  }
+  return nullptr;
+}
 
 bool GrpcMaybeParseTensorResponse(::grpc::ByteBuffer* src,
                                   TensorResponse* dst) {
@@ -50,6 +50,10 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Returns a buffer that holds a reference to the slice of `buffer_` that
+  // contains the bytes, if any.
+  TensorBuffer* AdoptBytes(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
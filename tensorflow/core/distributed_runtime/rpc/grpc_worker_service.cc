@@ -447,11 +447,12 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [this, request, response, done, cache_enabled](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      EncodeRecvTensorResponse(*request, tensor, is_dead, cache_enabled,
+                               response);
     }
     done(status);
   };
@@ -741,6 +742,13 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
 
 WorkerEnv* GrpcWorker::env() { return env_; }
 
+void GrpcWorker::EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                          const Tensor& tensor, bool is_dead,
+                                          bool require_ack,
+                                          ::grpc::ByteBuffer* response) {
+  grpc::EncodeTensorToByteBuffer(is_dead, tensor, require_ack, response);
+}
+
 void GrpcWorker::RemoveCacheEntryForId(int64_t request_id) {
   if (response_cache_) {
     response_cache_->EraseRequestId(request_id);
@@ -67,6 +67,15 @@ class GrpcWorker : public Worker {
 
   void RemoveCacheEntryForId(int64_t request_id);
 
+ protected:
+  // Writes the response to `request`, which carries `tensor`, into
+  // `response`. Subclasses can override this to send the tensor contents by
+  // other means; see `RecvTensorTransport`.
+  virtual void EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                        const Tensor& tensor, bool is_dead,
+                                        bool require_ack,
+                                        ::grpc::ByteBuffer* response);
+
  private:
   std::unique_ptr<RpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
@@ -38,8 +38,9 @@ namespace {
 
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      std::shared_ptr<RecvTensorTransport> transport)
+      : BaseRemoteRendezvous(env, step_id), transport_(std::move(transport)) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +50,8 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  const std::shared_ptr<RecvTensorTransport> transport_;
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -60,8 +63,10 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   void Init(WorkerInterface* wi, int64_t step_id, StringPiece key,
             AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done,
+            RecvTensorTransport* transport) {
     wi_ = wi;
+    transport_ = transport;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
     recv_args_ = recv_args;
@@ -79,9 +84,11 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
     alloc_attrs_ = AllocatorAttributes();
     dst_device_ = nullptr;
+    transport_ = nullptr;
     // We don't clear opts_ and assume that Init will set up the state for
     // opts_ appropriately.
     req_.Clear();
+    refetch_req_.Clear();
     resp_.Clear();
     {
       mutex_lock l(mu_);
@@ -136,6 +143,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   // Start the main RecvTensor call, checking for an async abort.
   void StartRTCall(std::function<void()> recv_done) {
     resp_.InitAlloc(dst_device_, alloc_attrs_);
+    if (transport_ != nullptr) {
+      transport_->PrepareRequest(src_worker_, dst_device_, alloc_attrs_, &req_);
+    }
     auto abort_checked = std::make_shared<Notification>();
     auto cb = [this, abort_checked,
                recv_done = std::move(recv_done)](const Status& s) {
@@ -146,7 +156,22 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
         mutex_lock l(mu_);
         status_.Update(s);
       }
-      recv_done();
+      if (!s.ok() || transport_ == nullptr) {
+        recv_done();
+        return;
+      }
+      transport_->FinishResponse(
+          src_worker_, req_, &resp_,
+          [this](const RecvTensorRequest& request, StatusCallback done) {
+            Refetch(request, std::move(done));
+          },
+          [this, recv_done](const Status& s) {
+            if (!s.ok()) {
+              mutex_lock l(mu_);
+              status_.Update(s);
+            }
+            recv_done();
+          });
     };
     wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
 
@@ -167,13 +192,47 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Sends `request` for the tensor instead of `req_`, for a transport that
+  // failed to fetch the contents of the first response.
+  void Refetch(const RecvTensorRequest& request, StatusCallback done) {
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    refetch_req_ = request;
+    resp_.InitAlloc(dst_device_, alloc_attrs_);
+    auto abort_checked = std::make_shared<Notification>();
+    wi_->RecvTensorAsync(
+        &opts_, &refetch_req_, &resp_,
+        [abort_checked, done = std::move(done)](const Status& s) {
+          abort_checked->WaitForNotification();
+          done(s);
+        });
+    // As in StartRTCall.
+    {
+      mutex_lock l(mu_);
+      s = status_;
+    }
+    if (!s.ok()) {
+      opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
+  RecvTensorTransport* transport_ = nullptr;  // Not owned.
   AllocatorAttributes alloc_attrs_;
   Device* dst_device_;
   CallOptions opts_;
   RecvTensorRequest req_;
+  RecvTensorRequest refetch_req_;
   TensorResponse resp_;
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
@@ -270,7 +329,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   }
 
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+             recv_args, std::move(done), transport_.get());
 
   // Record "call" in calls_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
@@ -307,13 +366,14 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
 }  // namespace
 
-RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+RpcRendezvousMgr::RpcRendezvousMgr(
+    const WorkerEnv* env, std::shared_ptr<RecvTensorTransport> transport)
+    : BaseRendezvousMgr(env), transport_(std::move(transport)) {}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, transport_));
 }
 
 }  // end namespace tensorflow
@@ -16,14 +16,53 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 
+#include <functional>
+#include <memory>
+
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 
 class DeviceMgr;
 
+// Lets an RpcRendezvousMgr move the contents of received tensors by means
+// other than the RecvTensor response, e.g. RDMA. Control messages still go
+// through the RecvTensor RPC: the transport describes how it can receive the
+// tensor in the request's `transport_options`, and the sender may answer with
+// a response that carries the tensor's metadata and, in its
+// `transport_options`, what the transport needs to fetch the contents.
+class RecvTensorTransport {
+ public:
+  virtual ~RecvTensorTransport() = default;
+
+  // Called before `request` for a tensor that will be received into
+  // `dst_device` with `alloc_attrs` is sent to `src_worker`.
+  virtual void PrepareRequest(const string& src_worker,
+                              const Device* dst_device,
+                              const AllocatorAttributes& alloc_attrs,
+                              RecvTensorRequest* request) = 0;
+
+  // Sends `request` to the source worker over the RecvTensor RPC, and parses
+  // its response into the response given to `FinishResponse`.
+  using RefetchCallback = std::function<void(const RecvTensorRequest& request,
+                                             StatusCallback done)>;
+
+  // Called when the RPC for `request` succeeded. `response->tensor()` has the
+  // shape and type of the received tensor; the transport fills in its
+  // contents if the sender did not send them, then calls `done`. A transport
+  // that fails to fetch the contents can ask the sender for them again with
+  // `refetch`.
+  virtual void FinishResponse(const string& src_worker,
+                              const RecvTensorRequest& request,
+                              TensorResponse* response,
+                              RefetchCallback refetch,
+                              StatusCallback done) = 0;
+};
+
 // RendezvousMgr keeps track of a set of local rendezvous instances.
 // All tensors sent by this worker are buffered in a RendezvousMgr
 // until the tensor is received.  Each global unique "step_id"
@@ -44,13 +83,17 @@ class DeviceMgr;
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
-  explicit RpcRendezvousMgr(const WorkerEnv* env);
+  explicit RpcRendezvousMgr(
+      const WorkerEnv* env,
+      std::shared_ptr<RecvTensorTransport> transport = nullptr);
 
  protected:
   tsl::core::RefCountPtr<BaseRemoteRendezvous> Create(
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  const std::shared_ptr<RecvTensorTransport> transport_;
+
   RpcRendezvousMgr(const RpcRendezvousMgr&) = delete;
   void operator=(const RpcRendezvousMgr&) = delete;
 };
@@ -0,0 +1,590 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rpc/verbs/rdma.h"
+
+#include <arpa/inet.h>
+#include <infiniband/verbs.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/common_runtime/process_state.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+namespace tensorflow {
+namespace verbs {
+namespace {
+
+constexpr int kCompletionQueueSize = 16384;
+constexpr int kMaxSendRequests = 128;
+constexpr int kMaxReceiveRequests = 128;
+constexpr int kPollBatchSize = 32;
+constexpr int kMaxReadAtomic = 16;
+// The `wr_id` of receive requests. Send requests use their `SendRequest*`.
+constexpr uint64_t kReceiveWrId = 0;
+
+constexpr int kAccessFlags =
+    IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ | IBV_ACCESS_REMOTE_WRITE;
+
+struct Region {
+  size_t num_bytes = 0;
+  // Registered on first use.
+  RdmaMemoryRegion mr;
+};
+
+mutex* RegionsMutex() {
+  static mutex* mu = new mutex;
+  return mu;
+}
+
+// The regions added with `AddMemoryRegion`, by start address.
+std::map<uintptr_t, Region>& Regions() TF_EXCLUSIVE_LOCKS_REQUIRED(
+    *RegionsMutex()) {
+  static auto* regions = new std::map<uintptr_t, Region>;
+  return *regions;
+}
+
+absl::StatusOr<RdmaMemoryRegion> RegisterRegion(ibv_pd* pd, void* ptr,
+                                                size_t num_bytes) {
+  ibv_mr* mr = ibv_reg_mr(pd, ptr, num_bytes, kAccessFlags);
+  if (mr == nullptr) {
+    return errors::Unavailable("Failed to register ", num_bytes,
+                               " bytes of memory for RDMA: ",
+                               std::strerror(errno));
+  }
+  return RdmaMemoryRegion(mr, [](ibv_mr* mr) {
+    if (ibv_dereg_mr(mr) != 0) {
+      LOG(ERROR) << "Failed to deregister RDMA memory: "
+                 << std::strerror(errno);
+    }
+  });
+}
+
+absl::Status ModifyQueuePair(ibv_qp* qp, ibv_qp_attr* attr, int mask,
+                             const char* state) {
+  if (int error = ibv_modify_qp(qp, attr, mask); error != 0) {
+    return errors::Unavailable("Failed to move RDMA queue pair ", qp->qp_num,
+                               " to ", state, ": ", std::strerror(error));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+/* static */
+absl::StatusOr<RdmaContext*> RdmaContext::Global() {
+  static const absl::StatusOr<RdmaContext*>* context = [] {
+    auto* context = new RdmaContext;
+    absl::Status s = context->Init();
+    if (!s.ok()) {
+      LOG(WARNING) << "RDMA is not available: " << s;
+      delete context;
+      return new absl::StatusOr<RdmaContext*>(s);
+    }
+    return new absl::StatusOr<RdmaContext*>(context);
+  }();
+  return *context;
+}
+
+/* static */
+void RdmaContext::AddMemoryRegion(void* ptr, size_t num_bytes) {
+  mutex_lock l(*RegionsMutex());
+  Regions()[reinterpret_cast<uintptr_t>(ptr)].num_bytes = num_bytes;
+}
+
+/* static */
+void RdmaContext::RemoveMemoryRegion(void* ptr) {
+  mutex_lock l(*RegionsMutex());
+  Regions().erase(reinterpret_cast<uintptr_t>(ptr));
+}
+
+/* static */
+void RdmaContext::AddAllocatorVisitors() {
+  SubAllocator::Visitor alloc_visitor = [](void* ptr, int index,
+                                           size_t num_bytes) {
+    AddMemoryRegion(ptr, num_bytes);
+  };
+  SubAllocator::Visitor free_visitor = [](void* ptr, int index,
+                                          size_t num_bytes) {
+    RemoveMemoryRegion(ptr);
+  };
+  ProcessState::singleton()->AddCPUAllocVisitor(alloc_visitor);
+  ProcessState::singleton()->AddCPUFreeVisitor(free_visitor);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  // GPU sources are sent from a copy in pinned host memory.
+  for (int numa_node = 0; numa_node < port::NUMANumNodes(); ++numa_node) {
+    GPUProcessState::singleton()->AddGpuHostAllocVisitor(numa_node,
+                                                         alloc_visitor);
+    GPUProcessState::singleton()->AddGpuHostFreeVisitor(numa_node,
+                                                        free_visitor);
+  }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+RdmaContext::~RdmaContext() {
+  // Only reached when `Init` fails, before the poll thread is started.
+  if (cq_ != nullptr) ibv_destroy_cq(cq_);
+  if (channel_ != nullptr) ibv_destroy_comp_channel(channel_);
+  if (pd_ != nullptr) ibv_dealloc_pd(pd_);
+  if (context_ != nullptr) ibv_close_device(context_);
+}
+
+absl::Status RdmaContext::Init() {
+  std::string device_name;
+  int64_t port_num, gid_index;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_VERBS_DEVICE", "", &device_name));
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_VERBS_PORT", 1, &port_num));
+  TF_RETURN_IF_ERROR(
+      ReadInt64FromEnvVar("TF_VERBS_GID_INDEX", 0, &gid_index));
+  port_num_ = port_num;
+  gid_index_ = gid_index;
+
+  int num_devices = 0;
+  ibv_device** devices = ibv_get_device_list(&num_devices);
+  if (devices == nullptr || num_devices == 0) {
+    if (devices != nullptr) ibv_free_device_list(devices);
+    return errors::Unavailable("No RDMA devices found.");
+  }
+  ibv_device* device = nullptr;
+  for (int i = 0; i < num_devices; ++i) {
+    if (device_name.empty() || device_name == ibv_get_device_name(devices[i])) {
+      device = devices[i];
+      break;
+    }
+  }
+  if (device != nullptr) {
+    context_ = ibv_open_device(device);
+  }
+  ibv_free_device_list(devices);
+  if (device == nullptr) {
+    return errors::Unavailable("RDMA device ", device_name, " not found.");
+  }
+  if (context_ == nullptr) {
+    return errors::Unavailable("Failed to open RDMA device: ",
+                               std::strerror(errno));
+  }
+  if (ibv_query_device(context_, &device_attr_) != 0 ||
+      ibv_query_port(context_, port_num_, &port_attr_) != 0 ||
+      ibv_query_gid(context_, port_num_, gid_index_, &gid_) != 0) {
+    return errors::Unavailable("Failed to query port ", port_num_,
+                               " of the RDMA device.");
+  }
+  if (port_attr_.state != IBV_PORT_ACTIVE) {
+    return errors::Unavailable("Port ", port_num_,
+                               " of the RDMA device is not active.");
+  }
+  pd_ = ibv_alloc_pd(context_);
+  channel_ = ibv_create_comp_channel(context_);
+  if (pd_ == nullptr || channel_ == nullptr) {
+    return errors::Unavailable("Failed to set up the RDMA device: ",
+                               std::strerror(errno));
+  }
+  cq_ = ibv_create_cq(
+      context_, std::min(kCompletionQueueSize, device_attr_.max_cqe),
+      /*cq_context=*/nullptr, channel_, /*comp_vector=*/0);
+  if (cq_ == nullptr || ibv_req_notify_cq(cq_, /*solicited_only=*/0) != 0) {
+    return errors::Unavailable("Failed to create an RDMA completion queue: ",
+                               std::strerror(errno));
+  }
+  poll_thread_.reset(Env::Default()->StartThread(
+      {}, "tf_verbs_poll_completions", [this] { PollCompletions(); }));
+  return absl::OkStatus();
+}
+
+void RdmaContext::PollCompletions() {
+  ibv_wc wc[kPollBatchSize];
+  while (true) {
+    ibv_cq* cq;
+    void* cq_context;
+    if (ibv_get_cq_event(channel_, &cq, &cq_context) != 0) {
+      LOG(ERROR) << "Failed to get RDMA completion events: "
+                 << std::strerror(errno);
+      return;
+    }
+    ibv_ack_cq_events(cq, 1);
+    if (ibv_req_notify_cq(cq, /*solicited_only=*/0) != 0) {
+      LOG(ERROR) << "Failed to request RDMA completion events.";
+      return;
+    }
+    int n;
+    while ((n = ibv_poll_cq(cq, kPollBatchSize, wc)) > 0) {
+      for (int i = 0; i < n; ++i) {
+        HandleCompletion(wc[i]);
+      }
+    }
+  }
+}
+
+void RdmaContext::HandleCompletion(const ibv_wc& wc) {
+  if (wc.wr_id != kReceiveWrId) {
+    auto* request = reinterpret_cast<RdmaQueuePair::SendRequest*>(wc.wr_id);
+    std::shared_ptr<RdmaQueuePair> qp = request->qp;
+    qp->OnSendCompletion(request, wc);
+    return;
+  }
+  std::shared_ptr<RdmaQueuePair> qp;
+  {
+    mutex_lock l(mu_);
+    auto it = queue_pairs_.find(wc.qp_num);
+    if (it != queue_pairs_.end()) {
+      qp = it->second.lock();
+    }
+  }
+  if (qp != nullptr) {
+    qp->OnReceiveCompletion(wc);
+  }
+}
+
+absl::StatusOr<RdmaMemoryRegion> RdmaContext::RegisterMemory(
+    const void* ptr, size_t num_bytes) {
+  const uintptr_t start = reinterpret_cast<uintptr_t>(ptr);
+  {
+    mutex_lock l(*RegionsMutex());
+    auto& regions = Regions();
+    auto it = regions.upper_bound(start);
+    if (it != regions.begin()) {
+      --it;
+      if (start + num_bytes <= it->first + it->second.num_bytes) {
+        if (it->second.mr == nullptr) {
+          TF_ASSIGN_OR_RETURN(
+              it->second.mr,
+              RegisterRegion(pd_, reinterpret_cast<void*>(it->first),
+                             it->second.num_bytes));
+        }
+        return it->second.mr;
+      }
+    }
+  }
+  // Not in a region from an allocator, so register just this buffer.
+  return RegisterRegion(pd_, const_cast<void*>(ptr), num_bytes);
+}
+
+absl::StatusOr<std::shared_ptr<RdmaQueuePair>> RdmaContext::CreateQueuePair(
+    std::function<void(uint32_t)> on_receive) {
+  ibv_qp_init_attr init_attr;
+  std::memset(&init_attr, 0, sizeof(init_attr));
+  init_attr.send_cq = cq_;
+  init_attr.recv_cq = cq_;
+  init_attr.qp_type = IBV_QPT_RC;
+  init_attr.cap.max_send_wr =
+      std::min(kMaxSendRequests, device_attr_.max_qp_wr);
+  init_attr.cap.max_recv_wr =
+      std::min(kMaxReceiveRequests, device_attr_.max_qp_wr);
+  init_attr.cap.max_send_sge = 1;
+  init_attr.cap.max_recv_sge = 1;
+  ibv_qp* qp = ibv_create_qp(pd_, &init_attr);
+  if (qp == nullptr) {
+    return errors::Unavailable("Failed to create an RDMA queue pair: ",
+                               std::strerror(errno));
+  }
+  std::shared_ptr<RdmaQueuePair> queue_pair(
+      new RdmaQueuePair(this, qp, init_attr.cap.max_send_wr,
+                        std::move(on_receive)));
+
+  ibv_qp_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_INIT;
+  attr.pkey_index = 0;
+  attr.port_num = port_num_;
+  attr.qp_access_flags = kAccessFlags;
+  TF_RETURN_IF_ERROR(ModifyQueuePair(
+      qp, &attr,
+      IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT | IBV_QP_ACCESS_FLAGS,
+      "INIT"));
+  TF_RETURN_IF_ERROR(queue_pair->PostReceives(init_attr.cap.max_recv_wr));
+  {
+    mutex_lock l(mu_);
+    queue_pairs_[qp->qp_num] = queue_pair;
+  }
+  return queue_pair;
+}
+
+RdmaQueuePair::RdmaQueuePair(RdmaContext* context, ibv_qp* qp,
+                             int max_sends,
+                             std::function<void(uint32_t)> on_receive)
+    : context_(context),
+      qp_(qp),
+      max_sends_(max_sends),
+      on_receive_(std::move(on_receive)) {
+  endpoint_.set_lid(context->port_attr_.lid);
+  endpoint_.set_gid(context->gid_.raw, sizeof(context->gid_.raw));
+  endpoint_.set_qp_num(qp->qp_num);
+  endpoint_.set_psn(random::New64() & 0xffffff);
+}
+
+RdmaQueuePair::~RdmaQueuePair() {
+  {
+    mutex_lock l(context_->mu_);
+    context_->queue_pairs_.erase(qp_->qp_num);
+  }
+  if (int error = ibv_destroy_qp(qp_); error != 0) {
+    LOG(ERROR) << "Failed to destroy RDMA queue pair: "
+               << std::strerror(error);
+  }
+}
+
+absl::Status RdmaQueuePair::Connect(const VerbsEndpoint& remote) {
+  mutex_lock l(mu_);
+  if (connected_) {
+    if (remote.qp_num() != remote_.qp_num() || remote.gid() != remote_.gid()) {
+      return errors::FailedPrecondition(
+          "RDMA queue pair ", qp_->qp_num, " is already connected to ",
+          remote_.qp_num(), ", not ", remote.qp_num());
+    }
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(status_);
+
+  ibv_qp_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTR;
+  attr.path_mtu = context_->port_attr_.active_mtu;
+  attr.dest_qp_num = remote.qp_num();
+  attr.rq_psn = remote.psn();
+  attr.max_dest_rd_atomic =
+      std::min(kMaxReadAtomic, context_->device_attr_.max_qp_rd_atom);
+  attr.min_rnr_timer = 12;
+  attr.ah_attr.dlid = remote.lid();
+  attr.ah_attr.port_num = context_->port_num_;
+  if (remote.gid().size() == sizeof(attr.ah_attr.grh.dgid.raw)) {
+    // Required for RoCE, where there are no LIDs.
+    attr.ah_attr.is_global = 1;
+    std::memcpy(attr.ah_attr.grh.dgid.raw, remote.gid().data(),
+                remote.gid().size());
+    attr.ah_attr.grh.sgid_index = context_->gid_index_;
+    attr.ah_attr.grh.hop_limit = 255;
+  }
+  TF_RETURN_IF_ERROR(ModifyQueuePair(
+      qp_, &attr,
+      IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU | IBV_QP_DEST_QPN |
+          IBV_QP_RQ_PSN | IBV_QP_MAX_DEST_RD_ATOMIC | IBV_QP_MIN_RNR_TIMER,
+      "RTR"));
+
+  std::memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTS;
+  attr.timeout = 14;
+  attr.retry_cnt = 7;
+  attr.rnr_retry = 7;
+  attr.sq_psn = endpoint_.psn();
+  attr.max_rd_atomic =
+      std::min(kMaxReadAtomic, context_->device_attr_.max_qp_rd_atom);
+  TF_RETURN_IF_ERROR(ModifyQueuePair(
+      qp_, &attr,
+      IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT | IBV_QP_RNR_RETRY |
+          IBV_QP_SQ_PSN | IBV_QP_MAX_QP_RD_ATOMIC,
+      "RTS"));
+  remote_ = remote;
+  connected_ = true;
+  return absl::OkStatus();
+}
+
+bool RdmaQueuePair::connected() const {
+  mutex_lock l(mu_);
+  return connected_;
+}
+
+bool RdmaQueuePair::failed() const {
+  mutex_lock l(mu_);
+  return !status_.ok();
+}
+
+void RdmaQueuePair::ReadAsync(void* local, const RdmaMemoryRegion& local_mr,
+                              uint64_t remote_addr, uint32_t rkey,
+                              uint64_t num_bytes,
+                              std::function<void(absl::Status)> done) {
+  struct PendingRead {
+    mutex mu;
+    int remaining TF_GUARDED_BY(mu);
+    absl::Status status TF_GUARDED_BY(mu);
+    RdmaMemoryRegion local_mr;
+    std::function<void(absl::Status)> done;
+  };
+  const uint64_t max_chunk_bytes = context_->port_attr_.max_msg_sz;
+  const int num_chunks =
+      std::max<uint64_t>(1, (num_bytes + max_chunk_bytes - 1) /
+                                max_chunk_bytes);
+  auto pending = std::make_shared<PendingRead>();
+  pending->remaining = num_chunks;
+  pending->local_mr = local_mr;
+  pending->done = std::move(done);
+
+  for (int i = 0; i < num_chunks; ++i) {
+    const uint64_t offset = i * max_chunk_bytes;
+    auto request = std::make_unique<SendRequest>();
+    request->sge.addr = reinterpret_cast<uintptr_t>(local) + offset;
+    request->sge.length = std::min(max_chunk_bytes, num_bytes - offset);
+    request->sge.lkey = local_mr->lkey;
+    request->wr.opcode = IBV_WR_RDMA_READ;
+    request->wr.sg_list = &request->sge;
+    request->wr.num_sge = 1;
+    request->wr.wr.rdma.remote_addr = remote_addr + offset;
+    request->wr.wr.rdma.rkey = rkey;
+    request->done = [pending](absl::Status s) {
+      bool last;
+      absl::Status status;
+      {
+        mutex_lock l(pending->mu);
+        pending->status.Update(s);
+        last = --pending->remaining == 0;
+        status = pending->status;
+      }
+      if (last) {
+        pending->done(status);
+      }
+    };
+    PostSend(std::move(request));
+  }
+}
+
+void RdmaQueuePair::SendImmediate(uint32_t imm,
+                                  std::function<void(absl::Status)> done) {
+  auto request = std::make_unique<SendRequest>();
+  request->wr.opcode = IBV_WR_SEND_WITH_IMM;
+  request->wr.num_sge = 0;
+  request->wr.imm_data = htonl(imm);
+  request->done = std::move(done);
+  PostSend(std::move(request));
+}
+
+absl::Status RdmaQueuePair::PostReceives(int n) {
+  ibv_recv_wr wr;
+  std::memset(&wr, 0, sizeof(wr));
+  wr.wr_id = kReceiveWrId;
+  for (int i = 0; i < n; ++i) {
+    ibv_recv_wr* bad_wr;
+    if (int error = ibv_post_recv(qp_, &wr, &bad_wr); error != 0) {
+      return errors::Unavailable("Failed to post an RDMA receive request: ",
+                                 std::strerror(error));
+    }
+  }
+  return absl::OkStatus();
+}
+
+void RdmaQueuePair::PostSend(std::unique_ptr<SendRequest> request) {
+  absl::Status status;
+  {
+    mutex_lock l(mu_);
+    status = status_;
+    if (status.ok()) {
+      request->qp = shared_from_this();
+      request->wr.wr_id = reinterpret_cast<uintptr_t>(request.get());
+      request->wr.send_flags = IBV_SEND_SIGNALED;
+      if (outstanding_sends_ >= max_sends_) {
+        queued_sends_.push_back(std::move(request));
+      } else {
+        PostSendLocked(std::move(request));
+      }
+      return;
+    }
+  }
+  request->done(status);
+}
+
+void RdmaQueuePair::PostSendLocked(std::unique_ptr<SendRequest> request) {
+  ibv_send_wr* bad_wr;
+  if (int error = ibv_post_send(qp_, &request->wr, &bad_wr); error != 0) {
+    absl::Status status = errors::Unavailable(
+        "Failed to post an RDMA send request: ", std::strerror(error));
+    Fail(status);
+    // Run the callback without the lock: it may post another request.
+    SendRequest* r = request.release();
+    Env::Default()->SchedClosure([r, status] {
+      std::unique_ptr<SendRequest> request(r);
+      request->done(status);
+    });
+    return;
+  }
+  ++outstanding_sends_;
+  request.release();  // Owned by the completion.
+}
+
+void RdmaQueuePair::OnSendCompletion(SendRequest* r, const ibv_wc& wc) {
+  std::unique_ptr<SendRequest> request(r);
+  absl::Status status;
+  if (wc.status != IBV_WC_SUCCESS) {
+    status = errors::Unavailable("RDMA request on queue pair ", qp_->qp_num,
+                                 " failed: ", ibv_wc_status_str(wc.status));
+  }
+  {
+    mutex_lock l(mu_);
+    --outstanding_sends_;
+    if (!status.ok()) {
+      Fail(status);
+    } else if (!queued_sends_.empty()) {
+      std::unique_ptr<SendRequest> next = std::move(queued_sends_.front());
+      queued_sends_.pop_front();
+      PostSendLocked(std::move(next));
+    }
+  }
+  request->done(status);
+}
+
+void RdmaQueuePair::OnReceiveCompletion(const ibv_wc& wc) {
+  if (wc.status != IBV_WC_SUCCESS) {
+    mutex_lock l(mu_);
+    Fail(errors::Unavailable("RDMA receive on queue pair ", qp_->qp_num,
+                             " failed: ", ibv_wc_status_str(wc.status)));
+    return;
+  }
+  absl::Status s = PostReceives(1);
+  if (!s.ok()) {
+    mutex_lock l(mu_);
+    Fail(s);
+  }
+  if (wc.wc_flags & IBV_WC_WITH_IMM) {
+    on_receive_(ntohl(wc.imm_data));
+  }
+}
+
+void RdmaQueuePair::Fail(const absl::Status& status) {
+  if (!status_.ok()) {
+    return;
+  }
+  LOG(WARNING) << status;
+  status_ = status;
+  // Requests that were not posted never complete.
+  std::deque<std::unique_ptr<SendRequest>> queued = std::move(queued_sends_);
+  queued_sends_.clear();
+  Env::Default()->SchedClosure(
+      [queued = std::make_shared<decltype(queued)>(std::move(queued)),
+       status] {
+        for (auto& request : *queued) {
+          request->done(status);
+        }
+      });
+}
+
+}  // namespace verbs
+}  // namespace tensorflow
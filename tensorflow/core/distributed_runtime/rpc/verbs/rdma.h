@@ -0,0 +1,178 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_H_
+
+#include <infiniband/verbs.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace verbs {
+
+class RdmaQueuePair;
+
+// A registered memory region. Deregisters the region when destroyed.
+using RdmaMemoryRegion = std::shared_ptr<ibv_mr>;
+
+// The process-wide RDMA device, protection domain and completion queue.
+//
+// The device is selected with the TF_VERBS_DEVICE (default: the first
+// device), TF_VERBS_PORT (default: 1) and TF_VERBS_GID_INDEX (default: 0)
+// environment variables.
+//
+// Completions of all queue pairs are handled by one thread, which also runs
+// their callbacks, so callbacks must not block.
+class RdmaContext {
+ public:
+  // Returns the process-wide context, opening the device on first use.
+  // Returns UNAVAILABLE if there is no usable RDMA device.
+  static absl::StatusOr<RdmaContext*> Global();
+
+  // Registers a region of memory that `RegisterMemory` returns for buffers
+  // inside it, instead of registering every buffer separately. Used for the
+  // regions that allocators get from their `SubAllocator`s; see
+  // `AddAllocatorVisitors`.
+  static void AddMemoryRegion(void* ptr, size_t num_bytes);
+  static void RemoveMemoryRegion(void* ptr);
+
+  // Adds visitors to the process' CPU and pinned host allocators that call
+  // `AddMemoryRegion` and `RemoveMemoryRegion`. Must be called before the
+  // allocators are created.
+  static void AddAllocatorVisitors();
+
+  RdmaContext(const RdmaContext&) = delete;
+  void operator=(const RdmaContext&) = delete;
+
+  // Returns a memory region that contains `num_bytes` at `ptr`, registered
+  // for local writes and remote reads.
+  absl::StatusOr<RdmaMemoryRegion> RegisterMemory(const void* ptr,
+                                                  size_t num_bytes);
+
+  // Creates a queue pair. `on_receive` is called with the immediate data of
+  // the messages the remote queue pair sends with `SendImmediate`.
+  absl::StatusOr<std::shared_ptr<RdmaQueuePair>> CreateQueuePair(
+      std::function<void(uint32_t)> on_receive);
+
+ private:
+  RdmaContext() = default;
+  ~RdmaContext();
+
+  absl::Status Init();
+  void PollCompletions();
+  void HandleCompletion(const ibv_wc& wc);
+
+  friend class RdmaQueuePair;
+
+  ibv_context* context_ = nullptr;
+  ibv_pd* pd_ = nullptr;
+  ibv_comp_channel* channel_ = nullptr;
+  ibv_cq* cq_ = nullptr;
+  ibv_device_attr device_attr_;
+  ibv_port_attr port_attr_;
+  uint8_t port_num_ = 1;
+  int gid_index_ = 0;
+  ibv_gid gid_;
+  std::unique_ptr<Thread> poll_thread_;
+
+  mutex mu_;
+  std::unordered_map<uint32_t, std::weak_ptr<RdmaQueuePair>> queue_pairs_
+      TF_GUARDED_BY(mu_);
+};
+
+// A reliable connected queue pair.
+//
+// This class is thread-safe.
+class RdmaQueuePair : public std::enable_shared_from_this<RdmaQueuePair> {
+ public:
+  ~RdmaQueuePair();
+
+  RdmaQueuePair(const RdmaQueuePair&) = delete;
+  void operator=(const RdmaQueuePair&) = delete;
+
+  // The address to connect the remote queue pair to.
+  const VerbsEndpoint& endpoint() const { return endpoint_; }
+
+  // Connects to the remote queue pair at `remote`. Does nothing if already
+  // connected to it.
+  absl::Status Connect(const VerbsEndpoint& remote);
+
+  bool connected() const;
+  // Whether a work request failed, after which the queue pair is unusable.
+  bool failed() const;
+
+  // Reads `num_bytes` at `remote_addr` of the remote memory with `rkey` into
+  // `local`, which is in `local_mr`.
+  void ReadAsync(void* local, const RdmaMemoryRegion& local_mr,
+                 uint64_t remote_addr, uint32_t rkey, uint64_t num_bytes,
+                 std::function<void(absl::Status)> done);
+
+  // Sends `imm` to the remote queue pair's `on_receive` callback.
+  void SendImmediate(uint32_t imm, std::function<void(absl::Status)> done);
+
+ private:
+  struct SendRequest {
+    // Keeps the queue pair alive until the request completes.
+    std::shared_ptr<RdmaQueuePair> qp;
+    ibv_send_wr wr;
+    ibv_sge sge;
+    std::function<void(absl::Status)> done;
+  };
+
+  RdmaQueuePair(RdmaContext* context, ibv_qp* qp, int max_sends,
+                std::function<void(uint32_t)> on_receive);
+
+  absl::Status PostReceives(int n);
+  // Posts `request`, or queues it if the send queue is full.
+  void PostSend(std::unique_ptr<SendRequest> request);
+  void PostSendLocked(std::unique_ptr<SendRequest> request)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void OnSendCompletion(SendRequest* request, const ibv_wc& wc);
+  void OnReceiveCompletion(const ibv_wc& wc);
+  void Fail(const absl::Status& status) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  friend class RdmaContext;
+
+  RdmaContext* const context_;
+  ibv_qp* const qp_;
+  // The capacity of the send queue.
+  const int max_sends_;
+  const std::function<void(uint32_t)> on_receive_;
+  VerbsEndpoint endpoint_;
+
+  mutable mutex mu_;
+  bool connected_ TF_GUARDED_BY(mu_) = false;
+  absl::Status status_ TF_GUARDED_BY(mu_);
+  VerbsEndpoint remote_ TF_GUARDED_BY(mu_);
+  int outstanding_sends_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<std::unique_ptr<SendRequest>> queued_sends_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace verbs
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_H_
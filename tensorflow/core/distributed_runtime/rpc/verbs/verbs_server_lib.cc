@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_server_lib.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/rdma.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_transport.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_worker.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace verbs {
+namespace {
+
+RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
+  return new RpcRendezvousMgr(env);
+}
+
+}  // namespace
+
+/* static */
+Status VerbsServer::Create(const ServerDef& server_def, Env* env,
+                           DeviceMgr* local_device_mgr,
+                           std::unique_ptr<ServerInterface>* out_server) {
+  std::unique_ptr<VerbsServer> ret(
+      new VerbsServer(server_def, env == nullptr ? Env::Default() : env));
+  GrpcServerOptions options;
+  options.local_device_mgr = local_device_mgr;
+  absl::StatusOr<RdmaContext*> rdma = RdmaContext::Global();
+  if (rdma.ok()) {
+    auto transport = std::make_shared<VerbsRecvTensorTransport>(*rdma);
+    options.rendezvous_mgr_func = [transport](const WorkerEnv* env) {
+      return new RpcRendezvousMgr(env, transport);
+    };
+    options.worker_func = [rdma = *rdma](WorkerEnv* env,
+                                         const ConfigProto& config) {
+      return std::unique_ptr<GrpcWorker>(new VerbsWorker(env, config, rdma));
+    };
+  } else {
+    LOG(WARNING) << "Starting a " << kVerbsProtocol
+                 << " server without RDMA: " << rdma.status();
+    options.rendezvous_mgr_func = NewRpcRendezvousMgr;
+  }
+  Status s = ret->Init(options);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return s;
+  }
+  *out_server = std::move(ret);
+  return absl::OkStatus();
+}
+
+namespace {
+
+class VerbsServerFactory : public ServerFactory {
+ public:
+  bool AcceptsOptions(const ServerDef& server_def) override {
+    return server_def.protocol() == kVerbsProtocol;
+  }
+
+  Status NewServer(const ServerDef& server_def, const Options& options,
+                   std::unique_ptr<ServerInterface>* out_server) override {
+    return VerbsServer::Create(server_def, Env::Default(),
+                               options.local_device_mgr, out_server);
+  }
+};
+
+// Registers a `ServerFactory` for `VerbsServer` instances, and the allocator
+// visitors if requested. The visitors must be added before the allocators
+// are created, so this cannot wait until a server is created.
+class VerbsServerRegistrar {
+ public:
+  VerbsServerRegistrar() {
+    bool register_allocators;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_VERBS_REGISTER_ALLOCATORS",
+                                   /*default_val=*/false,
+                                   &register_allocators));
+    if (register_allocators) {
+      RdmaContext::AddAllocatorVisitors();
+    }
+    ServerFactory::Register("VERBS_SERVER", new VerbsServerFactory());
+  }
+};
+static VerbsServerRegistrar registrar;
+
+}  // namespace
+}  // namespace verbs
+}  // namespace tensorflow
@@ -0,0 +1,54 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_SERVER_LIB_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_SERVER_LIB_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_server_lib.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+
+namespace tensorflow {
+namespace verbs {
+
+// The protocol of `ServerDef`s for `VerbsServer`s.
+constexpr char kVerbsProtocol[] = "grpc+verbs";
+
+// A GrpcServer that sends the contents of tensors between workers with RDMA
+// over ibverbs, and everything else over gRPC.
+//
+// If there is no usable RDMA device, the server only uses gRPC. Setting
+// TF_VERBS_REGISTER_ALLOCATORS=true registers the memory of the process' CPU
+// and pinned host allocators with the device once, instead of registering
+// each tensor's memory when it is sent or received.
+class VerbsServer : public GrpcServer {
+ public:
+  static Status Create(const ServerDef& server_def, Env* env,
+                       DeviceMgr* local_device_mgr,
+                       std::unique_ptr<ServerInterface>* out_server);
+
+ protected:
+  VerbsServer(const ServerDef& server_def, Env* env)
+      : GrpcServer(server_def, env) {}
+};
+
+}  // namespace verbs
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_SERVER_LIB_H_
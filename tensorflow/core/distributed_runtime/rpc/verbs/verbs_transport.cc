@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_transport.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace verbs {
+
+void VerbsRecvTensorTransport::PrepareRequest(
+    const string& src_worker, const Device* dst_device,
+    const AllocatorAttributes& alloc_attrs, RecvTensorRequest* request) {
+  if (!alloc_attrs.on_host() && dst_device->device_type() != DEVICE_CPU) {
+    return;
+  }
+  absl::StatusOr<std::shared_ptr<RdmaQueuePair>> qp = GetQueuePair(src_worker);
+  if (!qp.ok()) {
+    VLOG(1) << "Receiving tensors from " << src_worker
+            << " over gRPC: " << qp.status();
+    return;
+  }
+  VerbsRecvTensorOptions options;
+  *options.mutable_endpoint() = (*qp)->endpoint();
+  request->mutable_transport_options()->PackFrom(options);
+}
+
+void VerbsRecvTensorTransport::FinishResponse(const string& src_worker,
+                                              const RecvTensorRequest& request,
+                                              TensorResponse* response,
+                                              RefetchCallback refetch,
+                                              StatusCallback done) {
+  VerbsRemoteBuffer buffer;
+  if (!response->metadata().transport_options().UnpackTo(&buffer)) {
+    // The sender sent the contents over gRPC.
+    done(absl::OkStatus());
+    return;
+  }
+  const Tensor& tensor = response->tensor();
+  if (buffer.num_bytes() != tensor.TotalBytes()) {
+    done(errors::Internal("RDMA buffer of ", buffer.num_bytes(),
+                          " bytes for tensor ", request.rendezvous_key(),
+                          " of ", tensor.TotalBytes(), " bytes."));
+    return;
+  }
+  std::shared_ptr<RdmaQueuePair> qp;
+  {
+    mutex_lock l(mu_);
+    auto it = queue_pairs_.find(src_worker);
+    if (it != queue_pairs_.end() &&
+        it->second->endpoint().qp_num() == buffer.receiver_qp_num()) {
+      qp = it->second;
+    }
+  }
+  if (qp == nullptr) {
+    FallBackToRpc(src_worker, request, buffer.buffer_id(), nullptr,
+                  errors::Unavailable("RDMA queue pair was reset"), refetch,
+                  std::move(done));
+    return;
+  }
+  absl::Status s = qp->Connect(buffer.endpoint());
+  // The tensor was allocated for this response and is not shared yet.
+  void* data = const_cast<void*>(DMAHelper::base(&tensor));
+  absl::StatusOr<RdmaMemoryRegion> mr;
+  if (s.ok()) {
+    mr = rdma_->RegisterMemory(data, buffer.num_bytes());
+    s = mr.status();
+  }
+  if (!s.ok()) {
+    FallBackToRpc(src_worker, request, buffer.buffer_id(), qp, s, refetch,
+                  std::move(done));
+    return;
+  }
+  qp->ReadAsync(
+      data, *mr, buffer.addr(), buffer.rkey(), buffer.num_bytes(),
+      [this, src_worker, request, qp, buffer_id = buffer.buffer_id(),
+       refetch = std::move(refetch),
+       done = std::move(done)](absl::Status read_status) mutable {
+        if (read_status.ok()) {
+          // Lets the sender release the tensor.
+          qp->SendImmediate(buffer_id, [](absl::Status s) {
+            if (!s.ok()) VLOG(1) << "Failed to release RDMA buffer: " << s;
+          });
+        }
+        // Called on the RDMA completion thread, which must not block.
+        Env::Default()->SchedClosure([this, src_worker = std::move(src_worker),
+                                      request = std::move(request),
+                                      qp = std::move(qp), buffer_id,
+                                      refetch = std::move(refetch),
+                                      done = std::move(done), read_status] {
+          if (read_status.ok()) {
+            done(read_status);
+            return;
+          }
+          FallBackToRpc(src_worker, request, buffer_id, qp, read_status,
+                        refetch, done);
+        });
+      });
+}
+
+void VerbsRecvTensorTransport::FallBackToRpc(
+    const string& src_worker, const RecvTensorRequest& request,
+    uint32_t buffer_id, const std::shared_ptr<RdmaQueuePair>& qp,
+    const absl::Status& status, const RefetchCallback& refetch,
+    StatusCallback done) {
+  LOG_EVERY_N_SEC(WARNING, 60)
+      << "Receiving tensor " << request.rendezvous_key() << " from "
+      << src_worker << " over gRPC, RDMA failed: " << status;
+  if (qp != nullptr) {
+    mutex_lock l(mu_);
+    auto it = queue_pairs_.find(src_worker);
+    if (it != queue_pairs_.end() && it->second == qp) {
+      queue_pairs_.erase(it);
+    }
+  }
+  RecvTensorRequest fetch_request = request;
+  VerbsFetchBuffer fetch;
+  fetch.set_buffer_id(buffer_id);
+  fetch_request.mutable_transport_options()->PackFrom(fetch);
+  refetch(fetch_request, std::move(done));
+}
+
+absl::StatusOr<std::shared_ptr<RdmaQueuePair>>
+VerbsRecvTensorTransport::GetQueuePair(const string& src_worker) {
+  mutex_lock l(mu_);
+  std::shared_ptr<RdmaQueuePair>& qp = queue_pairs_[src_worker];
+  if (qp == nullptr || qp->failed()) {
+    // Connected when the first response from `src_worker` arrives.
+    absl::StatusOr<std::shared_ptr<RdmaQueuePair>> new_qp =
+        rdma_->CreateQueuePair(/*on_receive=*/[](uint32_t) {});
+    if (!new_qp.ok()) {
+      queue_pairs_.erase(src_worker);
+      return new_qp.status();
+    }
+    qp = *std::move(new_qp);
+  }
+  return qp;
+}
+
+}  // namespace verbs
+}  // namespace tensorflow
@@ -0,0 +1,81 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_TRANSPORT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/rdma.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+namespace verbs {
+
+// Receives the contents of tensors sent by `VerbsWorker`s with RDMA reads.
+//
+// Only tensors received into host memory are read with RDMA; the others, and
+// tensors sent by workers that do not support RDMA, are received over gRPC.
+// So are tensors that cannot be read with RDMA, e.g. because the queue pair
+// failed to connect. One queue pair is used for each source worker.
+class VerbsRecvTensorTransport : public RecvTensorTransport {
+ public:
+  explicit VerbsRecvTensorTransport(RdmaContext* rdma) : rdma_(rdma) {}
+
+  void PrepareRequest(const string& src_worker, const Device* dst_device,
+                      const AllocatorAttributes& alloc_attrs,
+                      RecvTensorRequest* request) override;
+
+  void FinishResponse(const string& src_worker,
+                      const RecvTensorRequest& request,
+                      TensorResponse* response, RefetchCallback refetch,
+                      StatusCallback done) override;
+
+ private:
+  // Asks `src_worker` for the contents of its buffer `buffer_id` over gRPC,
+  // after reading them with RDMA failed with `status`. Drops `qp`, e.g. a
+  // queue pair that is stale because the sender restarted, so that the next
+  // request creates a new one.
+  void FallBackToRpc(const string& src_worker, const RecvTensorRequest& request,
+                     uint32_t buffer_id,
+                     const std::shared_ptr<RdmaQueuePair>& qp,
+                     const absl::Status& status,
+                     const RefetchCallback& refetch, StatusCallback done);
+
+  // Returns the queue pair for `src_worker`, replacing it if it failed.
+  absl::StatusOr<std::shared_ptr<RdmaQueuePair>> GetQueuePair(
+      const string& src_worker);
+
+  RdmaContext* const rdma_;
+
+  mutex mu_;
+  absl::flat_hash_map<string, std::shared_ptr<RdmaQueuePair>> queue_pairs_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace verbs
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_TRANSPORT_H_
@@ -0,0 +1,212 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_transport.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/rdma.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs.pb.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace verbs {
+namespace {
+
+constexpr char kSrcWorker[] = "/job:worker/replica:0/task:1";
+
+// Connects the queue pairs of the transport to queue pairs of the same
+// device, which stand for the senders.
+class VerbsRecvTensorTransportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    absl::StatusOr<RdmaContext*> rdma = RdmaContext::Global();
+    if (!rdma.ok()) {
+      GTEST_SKIP() << "No usable RDMA device: " << rdma.status();
+    }
+    rdma_ = *rdma;
+    device_ = DeviceFactory::NewDevice("CPU", SessionOptions(),
+                                       "/job:worker/replica:0/task:0");
+    transport_ = std::make_unique<VerbsRecvTensorTransport>(rdma_);
+  }
+
+  // Prepares `request` and returns the receiver's endpoint in it.
+  VerbsEndpoint PrepareRequest(RecvTensorRequest* request) {
+    request->set_rendezvous_key("key");
+    transport_->PrepareRequest(kSrcWorker, device_.get(), AllocatorAttributes(),
+                               request);
+    VerbsRecvTensorOptions options;
+    CHECK(request->transport_options().UnpackTo(&options));
+    return options.endpoint();
+  }
+
+  // Initializes `response` like the response of a sender that exposes
+  // `tensor` in `mr` through `sender` as `buffer_id`.
+  void MakeResponse(const Tensor& tensor, const RdmaMemoryRegion& mr,
+                    const RdmaQueuePair& sender, uint32_t receiver_qp_num,
+                    uint32_t buffer_id, TensorResponse* response) {
+    VerbsRemoteBuffer buffer;
+    *buffer.mutable_endpoint() = sender.endpoint();
+    buffer.set_receiver_qp_num(receiver_qp_num);
+    buffer.set_addr(reinterpret_cast<uintptr_t>(DMAHelper::base(&tensor)));
+    buffer.set_rkey(mr->rkey);
+    buffer.set_num_bytes(tensor.TotalBytes());
+    buffer.set_buffer_id(buffer_id);
+    RecvTensorResponse proto;
+    proto.mutable_tensor()->set_dtype(tensor.dtype());
+    tensor.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+    proto.mutable_transport_options()->PackFrom(buffer);
+    response->InitAlloc(device_.get(), AllocatorAttributes());
+    TF_CHECK_OK(response->InitFrom(&proto));
+  }
+
+  // Finishes `response` and records the requests sent again over gRPC.
+  Status FinishResponse(const RecvTensorRequest& request,
+                        TensorResponse* response,
+                        std::vector<RecvTensorRequest>* refetches) {
+    Notification done;
+    Status status;
+    transport_->FinishResponse(
+        kSrcWorker, request, response,
+        [refetches](const RecvTensorRequest& refetch_request,
+                    StatusCallback refetch_done) {
+          refetches->push_back(refetch_request);
+          refetch_done(absl::OkStatus());
+        },
+        [&](const Status& s) {
+          status = s;
+          done.Notify();
+        });
+    done.WaitForNotification();
+    return status;
+  }
+
+  static Tensor MakeTensor() {
+    Tensor tensor(DT_FLOAT, TensorShape({1024}));
+    test::FillIota<float>(&tensor, 1.0f);
+    return tensor;
+  }
+
+  static uint32_t FetchedBufferId(const RecvTensorRequest& request) {
+    VerbsFetchBuffer fetch;
+    CHECK(request.transport_options().UnpackTo(&fetch));
+    return fetch.buffer_id();
+  }
+
+  RdmaContext* rdma_ = nullptr;
+  std::unique_ptr<Device> device_;
+  std::unique_ptr<VerbsRecvTensorTransport> transport_;
+};
+
+TEST_F(VerbsRecvTensorTransportTest, ReadsTensorWithRdma) {
+  RecvTensorRequest request;
+  const VerbsEndpoint receiver = PrepareRequest(&request);
+  Notification released;
+  uint32_t released_id = 0;
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<RdmaQueuePair> sender,
+                          rdma_->CreateQueuePair([&](uint32_t buffer_id) {
+                            released_id = buffer_id;
+                            released.Notify();
+                          }));
+  TF_ASSERT_OK(sender->Connect(receiver));
+  const Tensor tensor = MakeTensor();
+  TF_ASSERT_OK_AND_ASSIGN(
+      RdmaMemoryRegion mr,
+      rdma_->RegisterMemory(DMAHelper::base(&tensor), tensor.TotalBytes()));
+
+  TensorResponse response;
+  MakeResponse(tensor, mr, *sender, receiver.qp_num(), /*buffer_id=*/7,
+               &response);
+  std::vector<RecvTensorRequest> refetches;
+  TF_ASSERT_OK(FinishResponse(request, &response, &refetches));
+  EXPECT_TRUE(refetches.empty());
+  test::ExpectTensorEqual<float>(tensor, response.tensor());
+  released.WaitForNotification();
+  EXPECT_EQ(released_id, 7);
+}
+
+TEST_F(VerbsRecvTensorTransportTest, FallsBackToRpcWhenSenderRestarted) {
+  const Tensor tensor = MakeTensor();
+  TF_ASSERT_OK_AND_ASSIGN(
+      RdmaMemoryRegion mr,
+      rdma_->RegisterMemory(DMAHelper::base(&tensor), tensor.TotalBytes()));
+
+  RecvTensorRequest request;
+  const VerbsEndpoint receiver = PrepareRequest(&request);
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<RdmaQueuePair> sender,
+                          rdma_->CreateQueuePair([](uint32_t) {}));
+  TF_ASSERT_OK(sender->Connect(receiver));
+  TensorResponse response;
+  MakeResponse(tensor, mr, *sender, receiver.qp_num(), /*buffer_id=*/1,
+               &response);
+  std::vector<RecvTensorRequest> refetches;
+  TF_ASSERT_OK(FinishResponse(request, &response, &refetches));
+  EXPECT_TRUE(refetches.empty());
+
+  // The restarted sender answers the next request, which still uses the
+  // receiver's queue pair connected to the old sender, from a new queue pair.
+  RecvTensorRequest stale_request;
+  EXPECT_EQ(PrepareRequest(&stale_request).qp_num(), receiver.qp_num());
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<RdmaQueuePair> restarted_sender,
+                          rdma_->CreateQueuePair([](uint32_t) {}));
+  TensorResponse stale_response;
+  MakeResponse(tensor, mr, *restarted_sender, receiver.qp_num(),
+               /*buffer_id=*/2, &stale_response);
+  TF_ASSERT_OK(FinishResponse(stale_request, &stale_response, &refetches));
+  ASSERT_EQ(refetches.size(), 1);
+  EXPECT_EQ(refetches[0].rendezvous_key(), "key");
+  EXPECT_EQ(FetchedBufferId(refetches[0]), 2);
+
+  // The stale queue pair is replaced.
+  RecvTensorRequest next_request;
+  EXPECT_NE(PrepareRequest(&next_request).qp_num(), receiver.qp_num());
+}
+
+TEST_F(VerbsRecvTensorTransportTest, FallsBackToRpcWhenQueuePairWasReset) {
+  const Tensor tensor = MakeTensor();
+  TF_ASSERT_OK_AND_ASSIGN(
+      RdmaMemoryRegion mr,
+      rdma_->RegisterMemory(DMAHelper::base(&tensor), tensor.TotalBytes()));
+  RecvTensorRequest request;
+  const VerbsEndpoint receiver = PrepareRequest(&request);
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<RdmaQueuePair> sender,
+                          rdma_->CreateQueuePair([](uint32_t) {}));
+
+  // The response was sent to a queue pair that the receiver replaced since.
+  TensorResponse response;
+  MakeResponse(tensor, mr, *sender, receiver.qp_num() + 1, /*buffer_id=*/3,
+               &response);
+  std::vector<RecvTensorRequest> refetches;
+  TF_ASSERT_OK(FinishResponse(request, &response, &refetches));
+  ASSERT_EQ(refetches.size(), 1);
+  EXPECT_EQ(FetchedBufferId(refetches[0]), 3);
+}
+
+}  // namespace
+}  // namespace verbs
+}  // namespace tensorflow
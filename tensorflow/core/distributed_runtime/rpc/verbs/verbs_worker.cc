@@ -0,0 +1,207 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_worker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "xla/tsl/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace verbs {
+namespace {
+
+int64_t MinTensorBytes() {
+  int64_t min_tensor_bytes;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_VERBS_MIN_TENSOR_BYTES", 4096,
+                                  &min_tensor_bytes));
+  // Empty tensors have no memory to read.
+  return std::max<int64_t>(min_tensor_bytes, 1);
+}
+
+}  // namespace
+
+uint32_t VerbsWorker::ExposedTensors::Add(int64_t step_id,
+                                          const Tensor& tensor,
+                                          RdmaMemoryRegion mr) {
+  mutex_lock l(mu_);
+  uint32_t buffer_id;
+  do {
+    buffer_id = next_buffer_id_++;
+  } while (entries_.contains(buffer_id));
+  entries_[buffer_id] = {step_id, tensor, std::move(mr)};
+  return buffer_id;
+}
+
+void VerbsWorker::ExposedTensors::Remove(uint32_t buffer_id) {
+  mutex_lock l(mu_);
+  entries_.erase(buffer_id);
+}
+
+std::optional<Tensor> VerbsWorker::ExposedTensors::Take(uint32_t buffer_id) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(buffer_id);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  Tensor tensor = std::move(it->second.tensor);
+  entries_.erase(it);
+  return tensor;
+}
+
+void VerbsWorker::ExposedTensors::RemoveStep(int64_t step_id) {
+  mutex_lock l(mu_);
+  absl::erase_if(entries_, [step_id](const auto& entry) {
+    return entry.second.step_id == step_id;
+  });
+}
+
+VerbsWorker::VerbsWorker(WorkerEnv* env, const ConfigProto& config,
+                         RdmaContext* rdma)
+    : GrpcWorker(env, config),
+      rdma_(rdma),
+      min_tensor_bytes_(MinTensorBytes()),
+      exposed_tensors_(std::make_shared<ExposedTensors>()) {}
+
+void VerbsWorker::GrpcRecvTensorAsync(CallOptions* opts,
+                                      const RecvTensorRequest* request,
+                                      ::grpc::ByteBuffer* response,
+                                      StatusCallback done) {
+  VerbsFetchBuffer fetch;
+  if (!request->transport_options().UnpackTo(&fetch)) {
+    GrpcWorker::GrpcRecvTensorAsync(opts, request, response, std::move(done));
+    return;
+  }
+  std::optional<Tensor> tensor = exposed_tensors_->Take(fetch.buffer_id());
+  if (!tensor.has_value()) {
+    done(errors::NotFound("RDMA buffer ", fetch.buffer_id(), " of tensor ",
+                          request->rendezvous_key(), " was released."));
+    return;
+  }
+  grpc::EncodeTensorToByteBuffer(/*is_dead=*/false, *tensor,
+                                 /*require_ack=*/false, response);
+  done(absl::OkStatus());
+}
+
+void VerbsWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
+                                    CleanupGraphResponse* response,
+                                    StatusCallback done) {
+  // Receivers that did not read their tensors will not read them anymore.
+  exposed_tensors_->RemoveStep(request->step_id());
+  GrpcWorker::CleanupGraphAsync(request, response, std::move(done));
+}
+
+void VerbsWorker::EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                           const Tensor& tensor, bool is_dead,
+                                           bool require_ack,
+                                           ::grpc::ByteBuffer* response) {
+  VerbsRecvTensorOptions options;
+  // A cached response would refer to a released buffer.
+  if (!is_dead && !require_ack && DataTypeCanUseMemcpy(tensor.dtype()) &&
+      tensor.TotalBytes() >= min_tensor_bytes_ &&
+      request.transport_options().UnpackTo(&options)) {
+    absl::Status s =
+        EncodeRemoteBuffer(request, options.endpoint(), tensor, response);
+    if (s.ok()) {
+      return;
+    }
+    VLOG(1) << "Sending tensor " << request.rendezvous_key()
+            << " over gRPC: " << s;
+  }
+  GrpcWorker::EncodeRecvTensorResponse(request, tensor, is_dead, require_ack,
+                                       response);
+}
+
+absl::Status VerbsWorker::EncodeRemoteBuffer(const RecvTensorRequest& request,
+                                             const VerbsEndpoint& receiver,
+                                             const Tensor& tensor,
+                                             ::grpc::ByteBuffer* response) {
+  TF_ASSIGN_OR_RETURN(std::shared_ptr<RdmaQueuePair> qp,
+                      GetQueuePair(receiver));
+  const void* data = DMAHelper::base(&tensor);
+  TF_ASSIGN_OR_RETURN(RdmaMemoryRegion mr,
+                      rdma_->RegisterMemory(data, tensor.TotalBytes()));
+
+  VerbsRemoteBuffer buffer;
+  *buffer.mutable_endpoint() = qp->endpoint();
+  buffer.set_receiver_qp_num(receiver.qp_num());
+  buffer.set_addr(reinterpret_cast<uintptr_t>(data));
+  buffer.set_rkey(mr->rkey);
+  buffer.set_num_bytes(tensor.TotalBytes());
+  buffer.set_buffer_id(
+      exposed_tensors_->Add(request.step_id(), tensor, std::move(mr)));
+
+  RecvTensorResponse proto;
+  proto.mutable_tensor()->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+  proto.set_send_start_micros(Env::Default()->NowMicros());
+  proto.mutable_transport_options()->PackFrom(buffer);
+  ::grpc::Status s = tsl::GrpcMaybeUnparseProto(proto, response);
+  if (!s.ok()) {
+    exposed_tensors_->Remove(buffer.buffer_id());
+    return errors::Internal("Failed to serialize RecvTensor response: ",
+                            s.error_message());
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::shared_ptr<RdmaQueuePair>> VerbsWorker::GetQueuePair(
+    const VerbsEndpoint& receiver) {
+  const std::string key = absl::StrCat(receiver.gid(), "/", receiver.qp_num());
+  mutex_lock l(mu_);
+  std::shared_ptr<RdmaQueuePair>& qp = queue_pairs_[key];
+  if (qp != nullptr && !qp->failed()) {
+    return qp;
+  }
+  std::weak_ptr<ExposedTensors> exposed_tensors = exposed_tensors_;
+  absl::StatusOr<std::shared_ptr<RdmaQueuePair>> new_qp =
+      rdma_->CreateQueuePair([exposed_tensors](uint32_t buffer_id) {
+        // The receiver has read the tensor.
+        if (auto tensors = exposed_tensors.lock()) {
+          tensors->Remove(buffer_id);
+        }
+      });
+  absl::Status s = new_qp.status();
+  if (s.ok()) {
+    s = (*new_qp)->Connect(receiver);
+  }
+  if (!s.ok()) {
+    queue_pairs_.erase(key);
+    return s;
+  }
+  qp = *std::move(new_qp);
+  return qp;
+}
+
+}  // namespace verbs
+}  // namespace tensorflow
@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_WORKER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_WORKER_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/rdma.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs.pb.h"
+#include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+namespace verbs {
+
+// A GrpcWorker that lets receivers read the contents of sent tensors with
+// RDMA, when they ask for it with `VerbsRecvTensorOptions`.
+//
+// Instead of the contents, the RecvTensor response then carries a
+// `VerbsRemoteBuffer` in its `transport_options`. The tensor is kept alive in
+// registered memory until the receiver sends the buffer id back, or until the
+// step is cleaned up.
+//
+// Tensors smaller than TF_VERBS_MIN_TENSOR_BYTES (default: 4096) are sent
+// over gRPC, as are dead tensors, tensors whose type cannot be memcpy'd and
+// responses that have to be cached.
+class VerbsWorker : public GrpcWorker {
+ public:
+  VerbsWorker(WorkerEnv* env, const ConfigProto& config, RdmaContext* rdma);
+
+  // Also answers the requests of receivers that failed to read a buffer,
+  // with a `VerbsFetchBuffer`, with its contents.
+  void GrpcRecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                           ::grpc::ByteBuffer* response,
+                           StatusCallback done) override;
+
+  void CleanupGraphAsync(const CleanupGraphRequest* request,
+                         CleanupGraphResponse* response,
+                         StatusCallback done) override;
+
+ protected:
+  void EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                const Tensor& tensor, bool is_dead,
+                                bool require_ack,
+                                ::grpc::ByteBuffer* response) override;
+
+ private:
+  // The tensors that receivers have not read yet.
+  class ExposedTensors {
+   public:
+    uint32_t Add(int64_t step_id, const Tensor& tensor, RdmaMemoryRegion mr);
+    void Remove(uint32_t buffer_id);
+    // Removes and returns the tensor of `buffer_id`, if it was not released.
+    std::optional<Tensor> Take(uint32_t buffer_id);
+    void RemoveStep(int64_t step_id);
+
+   private:
+    struct Entry {
+      int64_t step_id;
+      Tensor tensor;
+      RdmaMemoryRegion mr;
+    };
+
+    mutex mu_;
+    uint32_t next_buffer_id_ TF_GUARDED_BY(mu_) = 0;
+    absl::flat_hash_map<uint32_t, Entry> entries_ TF_GUARDED_BY(mu_);
+  };
+
+  absl::Status EncodeRemoteBuffer(const RecvTensorRequest& request,
+                                  const VerbsEndpoint& receiver,
+                                  const Tensor& tensor,
+                                  ::grpc::ByteBuffer* response);
+
+  // Returns the queue pair connected to the receiver's queue pair at
+  // `receiver`, creating it if needed.
+  absl::StatusOr<std::shared_ptr<RdmaQueuePair>> GetQueuePair(
+      const VerbsEndpoint& receiver);
+
+  RdmaContext* const rdma_;
+  const int64_t min_tensor_bytes_;
+  // Shared with the callbacks of the queue pairs.
+  const std::shared_ptr<ExposedTensors> exposed_tensors_;
+
+  mutex mu_;
+  // By the GID and queue pair number of the receiver's queue pair.
+  absl::flat_hash_map<std::string, std::shared_ptr<RdmaQueuePair>> queue_pairs_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace verbs
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_VERBS_WORKER_H_
@@ -169,6 +169,19 @@ void RpcCollectiveExecutorMgr::RetireStepId(int64_t graph_key,
   }
 }
 
+Status RpcCollectiveExecutorMgr::Reset() {
+  static_cast<DeviceResolverDistributed*>(dev_resolver_.get())
+      ->ClearRemoteDevices();
+  {
+    // The group leader may be a new task, so the step ids are refreshed.
+    mutex_lock l(sequence_mu_);
+    for (auto& it : sequence_table_) {
+      it.second->next_step_id_ = CollectiveExecutor::kInvalidId;
+    }
+  }
+  return CollectiveExecutorMgr::Reset();
+}
+
 std::unique_ptr<RpcCollectiveExecutorMgr> CreateProdRpcCollectiveExecutorMgr(
     const ConfigProto& config, const DeviceMgr* device_mgr,
     std::unique_ptr<NcclCommunicatorInterface> nccl_communicator,
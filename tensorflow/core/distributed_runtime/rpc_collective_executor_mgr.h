@@ -56,6 +56,9 @@ class RpcCollectiveExecutorMgr : public CollectiveExecutorMgr {
 
   void RetireStepId(int64_t graph_key, int64_t step_id) override;
 
+  // Also forgets the devices of the other tasks, which may be replaced.
+  Status Reset() override;
+
  protected:
   virtual CollectiveExecutor* Create(int64_t step_id) override;
 
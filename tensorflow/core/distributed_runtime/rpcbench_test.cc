@@ -241,6 +241,21 @@ static void BM_RPC(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_RPC)->ArgPair(30, 2)->ArgPair(30, 1000)->ArgPair(30, 100000);
 
+// Sends a tensor of `state.range(0)` bytes to another worker and back.
+static void BM_RecvTensor(::testing::benchmark::State& state) {
+  const int64_t num_bytes = state.range(0);
+
+  BM_Helper(state, 2 /*width*/, 1 /*num_stages*/, num_bytes / sizeof(float),
+            true /*multi-device*/);
+  state.SetBytesProcessed(state.iterations() * 2 * num_bytes);
+}
+BENCHMARK(BM_RecvTensor)
+    ->Arg(1 << 10)
+    ->Arg(64 << 10)
+    ->Arg(1 << 20)
+    ->Arg(16 << 20)
+    ->Arg(256 << 20);
+
 static void BM_SingleDevice(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int num_stages = state.range(1);
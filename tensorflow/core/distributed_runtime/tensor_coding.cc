@@ -143,8 +143,37 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+// Makes `tensor_` a view of the next `num_bytes` bytes of `input` instead of
+// copying them, if they are contiguous in the received data, suitably aligned,
+// and `source` can keep them alive. Tensors that must be allocated with
+// `allocator_` (e.g. in GPU-compatible memory) are always copied.
+bool TensorResponse::AdoptTensorContent(Source* source,
+                                        protobuf::io::CodedInputStream* input,
+                                        const TensorProto& tensor_meta,
+                                        int num_bytes) {
+  if (num_bytes == 0 || alloc_attrs_.gpu_compatible()) return false;
+  TensorShape shape(tensor_meta.tensor_shape());
+  if (shape.num_elements() * DataTypeSize(tensor_meta.dtype()) != num_bytes) {
+    return false;
+  }
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment !=
+          0) {
+    return false;
+  }
+  TensorBuffer* buf =
+      source->AdoptBytes(static_cast<const char*>(data), num_bytes);
+  if (buf == nullptr) return false;
+  tensor_ = Tensor(tensor_meta.dtype(), shape, buf);
+  buf->Unref();
+  return input->Skip(num_bytes);
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -194,13 +223,13 @@ bool TensorResponse::ParseTensorSubmessage(
         int num_bytes;
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
+        if (AdoptTensorContent(source, input, *tensor_meta, num_bytes)) {
+          break;
+        }
         TensorShape shape(tensor_meta->tensor_shape());
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -233,7 +262,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -63,6 +63,15 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // If the `num_bytes` bytes at `data`, which are part of a buffer returned
+    // by the stream of the last call to contents(), can be kept alive after
+    // this Source is destroyed, returns a buffer that refers to them and
+    // keeps them alive. Otherwise returns nullptr, and ParseFrom copies the
+    // bytes instead.
+    virtual TensorBuffer* AdoptBytes(const char* data, size_t num_bytes) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -91,8 +100,12 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  bool AdoptTensorContent(Source* source,
+                          protobuf::io::CodedInputStream* input,
+                          const TensorProto& tensor_meta, int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstring>
+#include <memory>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +161,106 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A TensorBuffer that refers to bytes owned by someone else.
+class UnownedBuffer : public TensorBuffer {
+ public:
+  UnownedBuffer(const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)), size_(size) {}
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+};
+
+// Serves `encoded` from a single block placed so that the tensor content
+// starts at an offset of `misalignment` bytes from an aligned address, and
+// lets ParseFrom adopt the content.
+class AdoptingSource : public TensorResponse::Source {
+ public:
+  AdoptingSource(const string& encoded, StringPiece content, int misalignment)
+      : storage_(encoded.size() + 2 * Allocator::kAllocatorAlignment, 0) {
+    const size_t content_offset = encoded.find(content);
+    CHECK_NE(content_offset, string::npos);
+    const uintptr_t base = reinterpret_cast<uintptr_t>(storage_.data());
+    const uintptr_t aligned_content =
+        (base + content_offset + Allocator::kAllocatorAlignment - 1) /
+        Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+    data_ = reinterpret_cast<char*>(aligned_content - content_offset +
+                                    misalignment);
+    size_ = encoded.size();
+    memcpy(data_, encoded.data(), size_);
+  }
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_ = std::make_unique<protobuf::io::ArrayInputStream>(data_, size_);
+    return stream_.get();
+  }
+
+  TensorBuffer* AdoptBytes(const char* data, size_t num_bytes) override {
+    EXPECT_GE(data, data_);
+    EXPECT_LE(data + num_bytes, data_ + size_);
+    ++num_adopted_;
+    return new UnownedBuffer(data, num_bytes);
+  }
+
+  int num_adopted() const { return num_adopted_; }
+
+ private:
+  string storage_;
+  char* data_;
+  size_t size_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+  int num_adopted_ = 0;
+};
+
+class TensorResponseAdoptTest : public ::testing::TestWithParam<int> {};
+
+TEST_P(TensorResponseAdoptTest, AdoptsAlignedContent) {
+  const int misalignment = GetParam();
+  Tensor src(DT_FLOAT, TensorShape({10, 100}));
+  for (int i = 0; i < src.NumElements(); ++i) {
+    src.flat<float>()(i) = i;
+  }
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  AdoptingSource source(proto.SerializeAsString(), src.tensor_data(),
+                        misalignment);
+
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+  test::ExpectTensorEqual<float>(response.tensor(), src);
+  EXPECT_EQ(source.num_adopted(), misalignment == 0 ? 1 : 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Misalignment, TensorResponseAdoptTest,
+                         ::testing::Values(0, 1, 4));
+
+TEST(TensorResponseAdoptGpuCompatibleTest, CopiesGpuCompatibleContent) {
+  Tensor src(DT_FLOAT, TensorShape({1000}));
+  src.flat<float>().setZero();
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  AdoptingSource source(proto.SerializeAsString(), src.tensor_data(),
+                        /*misalignment=*/0);
+
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  AllocatorAttributes attr;
+  attr.set_gpu_compatible(true);
+  response.InitAlloc(&cpu_device, attr);
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  test::ExpectTensorEqual<float>(response.tensor(), src);
+  EXPECT_EQ(source.num_adopted(), 0);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -30,6 +30,7 @@ limitations under the License.
 namespace tensorflow {
 
 class BufRendezvous;
+class CollectiveCompressionResiduals;
 class CompleteGroupRequest;
 class CompleteGroupResponse;
 class CompleteInstanceRequest;
@@ -116,6 +117,9 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // Compression spec for the data sent between devices, from the ":<spec>"
+  // suffix of communication_hint, e.g. "bf16". Empty for no compression.
+  string compression;
 };
 
 // Data common to all members of a collective instance.
@@ -215,8 +219,17 @@ class ParamResolverInterface {
   // found.
   virtual Status LookupGroup(int32_t group_key, CollGroupParams* group) = 0;
 
-  // Aborts the resolver. After abortion the resolver can no longer be used.
+  // Aborts the resolver. After abortion the resolver can no longer be used,
+  // unless it is reset.
   virtual void StartAbort(const Status& s) = 0;
+
+  // Resets an aborted resolver, forgetting its groups and instances so that
+  // they can be formed again, possibly by other tasks. Must only be called
+  // once the aborted collectives have returned.
+  virtual Status Reset() {
+    return errors::Unimplemented("This collective param resolver cannot be "
+                                 "reset after abortion");
+  }
 };
 
 // Graphs which utilize Collective Ops in a common instance must
@@ -273,6 +286,17 @@ class CollectiveExecutorMgrInterface : public StepSequenceInterface {
   virtual DeviceResolverInterface* GetDeviceResolver() const = 0;
 
   virtual NcclCommunicatorInterface* GetNcclCommunicator() const = 0;
+
+  // Makes collectives usable again after an abortion, without restarting the
+  // process. Drops the executors of all steps and resets the resolvers and
+  // the NCCL communicator. Groups are formed again by the next collectives,
+  // so they can have other members than before, e.g. replacements of failed
+  // tasks. All tasks of a group must be reset before they run collectives
+  // again.
+  virtual Status Reset() {
+    return errors::Unimplemented(
+        "This collective executor manager cannot be reset after abortion");
+  }
 };
 
 // Interface that a Collective Op implementation uses to exchange data
@@ -353,6 +377,12 @@ class CollectiveExecutor : public core::RefCounted {
 
   virtual CollectiveRemoteAccess* remote_access() { return nullptr; }
 
+  // Returns the error feedback residuals of the compressed collectives run by
+  // this executor, or nullptr if it does not support compression.
+  virtual CollectiveCompressionResiduals* compression_residuals() {
+    return nullptr;
+  }
+
   // `WaitForDependencies` and `Launched` are used for fine-grained control of
   // execution order between collective instances.  These functions are intended
   // to be called in `Run` function of collective implementations, and may be
@@ -429,6 +459,9 @@ class NcclCommunicatorInterface {
                        StatusCallback done) = 0;
 
   virtual void StartAbort(const Status& s) = 0;
+
+  // Makes an aborted communicator usable again.
+  virtual void Reset() {}
 };
 
 // Interface of a Collective Op implementation.  Each specific CollectiveOp will
@@ -29,9 +29,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_DEVICE_H_
 #define TENSORFLOW_CORE_FRAMEWORK_DEVICE_H_
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -51,6 +54,31 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Records the work that a step of a graph enqueues on a device, so that later
+// steps whose feeds have the same shapes can replay it without running the
+// executor. See GPUOptions.Experimental.step_capture_warmup_steps.
+class DeviceStepCapture {
+ public:
+  // Runs a step on `feeds` and sets `fetches` to its results.
+  typedef std::function<Status(const std::vector<Tensor>& feeds,
+                               std::vector<Tensor>* fetches)>
+      StepFn;
+
+  virtual ~DeviceStepCapture() = default;
+
+  // Records the work that `step` enqueues on the device when run on copies of
+  // `feeds`, which must be in device memory, then replays it on `feeds` to
+  // set `fetches`. Returns an error if the step failed or could not be
+  // recorded, in which case this object must not be used.
+  virtual Status Capture(const std::vector<Tensor>& feeds, const StepFn& step,
+                         std::vector<Tensor>* fetches) = 0;
+
+  // Replays the step recorded by Capture() on `feeds`, which must have the
+  // types and shapes of the feeds it was recorded with.
+  virtual Status Replay(const std::vector<Tensor>& feeds,
+                        std::vector<Tensor>* fetches) = 0;
+};
+
 class Device : public DeviceBase {
  public:
   // Callback type that takes a Status and returns void.
@@ -156,6 +184,19 @@ class Device : public DeviceBase {
     return absl::OkStatus();
   }
 
+  // Fills `device_contexts`, indexed by node id, with the DeviceContexts in
+  // which an executor runs the nodes of `graph`, given their kernels in
+  // `kernels`, also indexed by node id. The nodes left without one, or all of
+  // them if `device_contexts` is left empty, run in the DeviceContext of
+  // TryGetDeviceContext().
+  //
+  // The caller takes ownership of one reference on each DeviceContext*.
+  virtual Status FillContextMap(const Graph& graph,
+                                absl::Span<OpKernel* const> kernels,
+                                std::vector<DeviceContext*>* device_contexts) {
+    return absl::OkStatus();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
@@ -205,6 +246,12 @@ class Device : public DeviceBase {
   // Only useful for GPU devices.
   virtual bool merge_device_to_device_stream() const { return false; }
 
+  // Returns an object to record and replay a step on this device, or nullptr
+  // if the device can't replay steps.
+  virtual std::unique_ptr<DeviceStepCapture> CreateStepCapture() {
+    return nullptr;
+  }
+
  protected:
   void DeleteResourceMgr() {
     delete rmgr_;
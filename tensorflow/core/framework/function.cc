@@ -1108,6 +1108,11 @@ string Canonicalize(const string& funcname, AttrSlice attrs,
     entries.push_back(
         AttrKeyAndValue("_state_handle", -1, options.state_handle));
   }
+  if (!options.thread_pool_name.empty()) {
+    entries.push_back(AttrKeyAndValue("_thread_pool", -1,
+                                      options.thread_pool_name,
+                                      AttrKeyAndValue::kCEscape));
+  }
   string executor_type = FunctionLibraryRuntime::ExecutorType(options, attrs);
   if (!executor_type.empty()) {
     entries.push_back(AttrKeyAndValue(kExecutorAttr, -1, executor_type));
@@ -46,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/stack_frame.h"
@@ -872,6 +873,20 @@ class FunctionLibraryRuntime : public core::WeakRefCounted {
     //
     // Instantiates the function enabling soft placement or outside compilation.
     bool allow_soft_placement = false;
+
+    // This interface is EXPERIMENTAL and subject to change.
+    //
+    // If non-empty, the function runs its kernels on a private thread pool
+    // with this name instead of the runner of the caller, so that functions
+    // of different tenants of a process do not compete for the same threads.
+    // Functions instantiated with the same name share the pool, which is
+    // created by the first of them with `thread_pool_num_threads` threads (or
+    // as many as there are schedulable CPUs if 0) and, unless
+    // `thread_pool_numa_node` is port::kNUMANoAffinity, with its threads bound
+    // to that NUMA node.
+    std::string thread_pool_name;
+    int thread_pool_num_threads = 0;
+    int thread_pool_numa_node = port::kNUMANoAffinity;
   };
   typedef uint64 Handle;
   virtual Status Instantiate(const std::string& function_name, AttrSlice attrs,
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -29,11 +31,13 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/types.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/mutex_contention.h"
 #include "tsl/platform/refcount.h"
 
 namespace tensorflow {
@@ -135,15 +139,99 @@ LocalRendezvous::~LocalRendezvous() {
       table_not_empty = true;
     }
   }
+  while (num_fast_path_callbacks_.load() != 0) {
+    Env::Default()->SleepForMicroseconds(50);
+  }
+  for (int i = 0; i < kNumFastPathSlots; ++i) {
+    if (fast_path_slots_[i].item.load() != 0) {
+      table_not_empty = true;
+    }
+  }
   if (table_not_empty) {
     DoAbort(absl::CancelledError("LocalRendezvous deleted"));
   }
 }
 
 namespace {
+TSL_MUTEX_CONTENTION_SITE(send_contention_site, "LocalRendezvous::Send");
+TSL_MUTEX_CONTENTION_SITE(recv_contention_site, "LocalRendezvous::RecvAsync");
+
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
+
+activity_watcher::ActivityScope MakeActivityScope(
+    const char* name, const LocalRendezvous* rendezvous,
+    const Rendezvous::ParsedKey& key, uint64 key_hash) {
+  return activity_watcher::ActivityScope(
+      [&]() {
+        return std::make_unique<activity_watcher::Activity>(
+            name, activity_watcher::ActivityCategory::kRendezvous,
+            activity_watcher::Activity::Attributes{
+                {"Rendezvous", absl::StrFormat("%p", rendezvous)},
+                {"key", std::string(key.FullKey())},
+                {"key_hash", absl::StrCat(key_hash)},
+            });
+      },
+      /*level=*/1);
+}
 }  // namespace
 
+LocalRendezvous::FastPathSlot* LocalRendezvous::FindFastPathSlot(
+    uint64 key_hash, bool claim) {
+  // Hash 0 marks an unowned slot, so keys with that hash always take the
+  // locked path.
+  if (key_hash == 0) return nullptr;
+  for (int i = 0; i < kFastPathProbes; ++i) {
+    FastPathSlot* slot =
+        &fast_path_slots_[(key_hash + i) & (kNumFastPathSlots - 1)];
+    uint64 owner = slot->key_hash.load();
+    if (owner == 0 && claim) {
+      // Slots are never released, so once a key owns a slot, every operation
+      // on that key finds the same slot.
+      if (slot->key_hash.compare_exchange_strong(owner, key_hash)) {
+        return slot;
+      }
+    }
+    if (owner == key_hash) return slot;
+  }
+  return nullptr;
+}
+
+LocalRendezvous::Item* LocalRendezvous::TakeFromFastPathSlot(
+    FastPathSlot* slot, int type) {
+  uintptr_t tagged_item = slot->item.load();
+  while (tagged_item != 0 && (tagged_item & kItemTypeMask) == type) {
+    // N.B. The item is only dereferenced once it has been removed from the
+    // slot, so it does not matter if the item observed here was consumed and
+    // replaced with another item (of the same key and type) at the same
+    // address in the meantime.
+    if (slot->item.compare_exchange_weak(tagged_item, 0)) {
+      return reinterpret_cast<Item*>(tagged_item & ~kItemTypeMask);
+    }
+  }
+  return nullptr;
+}
+
+bool LocalRendezvous::PublishToFastPathSlot(FastPathSlot* slot, Item* item) {
+  uintptr_t expected = 0;
+  if (!slot->item.compare_exchange_strong(expected, TagItem(item))) {
+    // The slot already holds an item of the same type.
+    return false;
+  }
+  // A locked operation on the same key may have started after we checked
+  // `num_locked`, in which case it may have missed the item we just
+  // published. Take the item back and join the locked path, unless another
+  // operation has already consumed it.
+  if (slot->num_locked.load() == 0) return true;
+  expected = TagItem(item);
+  return !slot->item.compare_exchange_strong(expected, 0);
+}
+
+uintptr_t LocalRendezvous::TagItem(Item* item) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(item);
+  DCHECK_EQ(address & kItemTypeMask, 0);
+  return address | item->type;
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
@@ -162,48 +250,87 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 
   TF_RETURN_IF_ERROR(status());
 
+  // Fast path: if no locked operation is pending on this key, hand the value
+  // to a waiting receiver, or park it for the next receiver, without taking
+  // the bucket lock.
+  FastPathSlot* slot = FindFastPathSlot(key_hash, /*claim=*/true);
+  std::unique_ptr<Item> send_item;
+  if (slot != nullptr && slot->num_locked.load() == 0) {
+    Item* item = TakeFromFastPathSlot(slot, Item::kRecv);
+    if (item != nullptr) {
+      DVLOG(2) << "Consume Recv Item from fast path (key:" << key.FullKey()
+               << "). ";
+      num_fast_path_callbacks_.fetch_add(1);
+      (*item->recv_state.waiter)(absl::OkStatus(), send_args, item->args, val,
+                                 is_dead);
+      num_fast_path_callbacks_.fetch_sub(1);
+      // Delete the item at last since it may unref and destruct the
+      // rendezvous.
+      delete item;
+      return absl::OkStatus();
+    }
+    send_item = std::make_unique<Item>(
+        tsl::core::GetNewRef(rc_owner_), send_args, val, is_dead,
+        MakeActivityScope("LocalRendezvous::Send", this, key, key_hash));
+    if (PublishToFastPathSlot(slot, send_item.get())) {
+      DVLOG(2) << "Enqueue Send Item in fast path (key:" << key.FullKey()
+               << "). ";
+      send_item.release();
+      return absl::OkStatus();
+    }
+  }
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
-  bucket.mu.lock();
-
-  auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
-  ItemQueue* queue = &it->second;
-  if (queue->head == nullptr || queue->head->type == Item::kSend) {
-    // There is no waiter for this message. Append the message
-    // into the queue. The waiter will pick it up when arrives.
-    // Only send-related fields need to be filled.
-    // TODO(b/143786186): Investigate moving the allocation of `Item` outside
-    // the lock.
-    auto rc_owner = tsl::core::GetNewRef(rc_owner_);
-    DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
-    activity_watcher::ActivityScope activity_scope(
-        [&]() {
-          return std::make_unique<activity_watcher::Activity>(
-              "LocalRendezvous::Send",
-              activity_watcher::ActivityCategory::kRendezvous,
-              activity_watcher::Activity::Attributes{
-                  {"Rendezvous", absl::StrFormat("%p", this)},
-                  {"key", std::string(key.FullKey())},
-                  {"key_hash", absl::StrCat(key_hash)},
-              });
-        },
-        /*level=*/1);
-    queue->push_back(new Item(std::move(rc_owner), send_args, val, is_dead,
-                              std::move(activity_scope)));
-    bucket.mu.unlock();
-    return absl::OkStatus();
+  tsl::LockProfiled(bucket.mu, send_contention_site());
+
+  Item* item = nullptr;
+  if (slot != nullptr) {
+    // Keep fast-path operations on this key off the slot until this
+    // operation has either consumed an item or queued its own.
+    slot->num_locked.fetch_add(1);
+    // An item in the slot is older than any item queued in the table.
+    item = TakeFromFastPathSlot(slot, Item::kRecv);
+    if (item != nullptr) slot->num_locked.fetch_sub(1);
   }
 
-  DVLOG(2) << "Consume Recv Item (key:" << key.FullKey() << "). ";
-  // There is an earliest waiter to consume this message.
-  Item* item = queue->head;
+  if (item == nullptr) {
+    auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
+    ItemQueue* queue = &it->second;
+    if (queue->head == nullptr || queue->head->type == Item::kSend) {
+      // There is no waiter for this message. Append the message
+      // into the queue. The waiter will pick it up when arrives.
+      // Only send-related fields need to be filled.
+      // TODO(b/143786186): Investigate moving the allocation of `Item` outside
+      // the lock.
+      DVLOG(2) << "Enqueue Send Item (key:" << key.FullKey() << "). ";
+      if (send_item == nullptr) {
+        send_item = std::make_unique<Item>(
+            tsl::core::GetNewRef(rc_owner_), send_args, val, is_dead,
+            MakeActivityScope("LocalRendezvous::Send", this, key, key_hash));
+      }
+      // If this key owns a slot, `num_locked` now accounts for the queued
+      // item.
+      queue->push_back(send_item.release());
+      bucket.mu.unlock();
+      return absl::OkStatus();
+    }
 
-  // Delete the queue when the last element has been consumed.
-  if (item->next == nullptr) {
-    DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    bucket.table.erase(it);
-  } else {
-    queue->head = item->next;
+    DVLOG(2) << "Consume Recv Item (key:" << key.FullKey() << "). ";
+    // There is an earliest waiter to consume this message.
+    item = queue->head;
+
+    // Delete the queue when the last element has been consumed.
+    if (item->next == nullptr) {
+      DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
+      bucket.table.erase(it);
+    } else {
+      queue->head = item->next;
+    }
+    if (slot != nullptr) {
+      // One for this operation, and one for the consumed item.
+      slot->num_locked.fetch_sub(2);
+    }
   }
   bucket.pending_callback_counter++;
   // Invoke the done-callback, without holding the lock.
@@ -219,7 +346,9 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
       bucket.pending_callback_cond_var.notify_all();
     }
   }
-  // Delete the item at last since it may unref and destruct the rendezvous.
+  // Delete the items at last since they may unref and destruct the
+  // rendezvous.
+  send_item.reset();
   delete item;
   return absl::OkStatus();
 }
@@ -238,138 +367,202 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     return;
   }
 
+  // Fast path: if no locked operation is pending on this key, consume a
+  // parked value without taking the bucket lock. A receiver that has to wait
+  // may only be parked in the slot if it cannot be cancelled; cancellable
+  // receivers wait in the table, where the cancellation callback can find
+  // them under the bucket lock.
+  CancellationManager* cm = recv_args.cancellation_manager;
+  FastPathSlot* slot = FindFastPathSlot(key_hash, /*claim=*/true);
+  std::unique_ptr<Item> recv_item;
+  if (slot != nullptr && slot->num_locked.load() == 0) {
+    Item* item = TakeFromFastPathSlot(slot, Item::kSend);
+    if (item != nullptr) {
+      DVLOG(2) << "Consume Send Item from fast path (key:" << key.FullKey()
+               << "). ";
+      num_fast_path_callbacks_.fetch_add(1);
+      done(absl::OkStatus(), item->args, recv_args, *item->send_state.value,
+           item->send_state.is_dead);
+      num_fast_path_callbacks_.fetch_sub(1);
+      // Delete the item at last since it may unref and destruct the
+      // rendezvous.
+      delete item;
+      return;
+    }
+    if (cm == nullptr) {
+      recv_item = std::make_unique<Item>(
+          tsl::core::GetNewRef(rc_owner_), recv_args, std::move(done),
+          CancellationManager::kInvalidToken,
+          MakeActivityScope("LocalRendezvous::RecvAsync", this, key,
+                            key_hash));
+      if (PublishToFastPathSlot(slot, recv_item.get())) {
+        DVLOG(2) << "Enqueue Recv Item in fast path (key:" << key.FullKey()
+                 << "). ";
+        recv_item.release();
+        return;
+      }
+      // N.B. `done` has been moved into `recv_item`, which is used below.
+    }
+  }
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
-  bucket.mu.lock();
-
-  auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
-  ItemQueue* queue = &it->second;
-  if (queue->head == nullptr || queue->head->type == Item::kRecv) {
-    // There is no message to pick up.
-    // Only recv-related fields need to be filled.
-    CancellationManager* cm = recv_args.cancellation_manager;
-    CancellationToken token = CancellationManager::kInvalidToken;
-    bool already_cancelled = false;
-    if (cm != nullptr) {
-      token = cm->get_cancellation_token();
-      already_cancelled = !cm->RegisterCallback(token, [this, token, key_hash,
-                                                        &bucket] {
-        Item* item = nullptr;
-        {
-          mutex_lock l(bucket.mu);
-          auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
-          ItemQueue* queue = &it->second;
-          // Find an item in the queue with a cancellation token that matches
-          // `token`, and remove it.
-          if (queue->head != nullptr && queue->head->type == Item::kRecv) {
-            for (Item *prev = nullptr, *curr = queue->head; curr != nullptr;
-                 prev = curr, curr = curr->next) {
-              if (curr->recv_state.cancellation_token == token) {
-                item = curr;
-                if (queue->head->next == nullptr) {
-                  // We have a single-element queue, so we can erase it from
-                  // the table.
-                  bucket.table.erase(it);
-                } else {
-                  // Remove the current item from the queue.
-                  if (curr == queue->head) {
-                    DCHECK_EQ(prev, nullptr);
-                    queue->head = curr->next;
+  tsl::LockProfiled(bucket.mu, recv_contention_site());
+
+  Item* item = nullptr;
+  if (slot != nullptr) {
+    // Keep fast-path operations on this key off the slot until this
+    // operation has either consumed an item or queued its own.
+    slot->num_locked.fetch_add(1);
+    // An item in the slot is older than any item queued in the table.
+    item = TakeFromFastPathSlot(slot, Item::kSend);
+    if (item != nullptr) slot->num_locked.fetch_sub(1);
+  }
+
+  if (item == nullptr) {
+    auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
+    ItemQueue* queue = &it->second;
+    if (queue->head == nullptr || queue->head->type == Item::kRecv) {
+      // There is no message to pick up.
+      // Only recv-related fields need to be filled.
+      CancellationToken token = CancellationManager::kInvalidToken;
+      bool already_cancelled = false;
+      if (cm != nullptr) {
+        token = cm->get_cancellation_token();
+        already_cancelled = !cm->RegisterCallback(token, [this, token,
+                                                          key_hash, &bucket] {
+          Item* item = nullptr;
+          {
+            mutex_lock l(bucket.mu);
+            auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
+            ItemQueue* queue = &it->second;
+            // Find an item in the queue with a cancellation token that
+            // matches `token`, and remove it.
+            if (queue->head != nullptr && queue->head->type == Item::kRecv) {
+              for (Item *prev = nullptr, *curr = queue->head; curr != nullptr;
+                   prev = curr, curr = curr->next) {
+                if (curr->recv_state.cancellation_token == token) {
+                  item = curr;
+                  if (queue->head->next == nullptr) {
+                    // We have a single-element queue, so we can erase it from
+                    // the table.
+                    bucket.table.erase(it);
                   } else {
-                    DCHECK_NE(prev, nullptr);
-                    prev->next = curr->next;
-                  }
-                  if (queue->tail == curr) {
-                    queue->tail = prev;
+                    // Remove the current item from the queue.
+                    if (curr == queue->head) {
+                      DCHECK_EQ(prev, nullptr);
+                      queue->head = curr->next;
+                    } else {
+                      DCHECK_NE(prev, nullptr);
+                      prev->next = curr->next;
+                    }
+                    if (queue->tail == curr) {
+                      queue->tail = prev;
+                    }
                   }
+                  break;
                 }
-                break;
               }
             }
+            if (item != nullptr) {
+              FastPathSlot* slot =
+                  FindFastPathSlot(key_hash, /*claim=*/false);
+              if (slot != nullptr) slot->num_locked.fetch_sub(1);
+            } else if (queue->head == nullptr) {
+              bucket.table.erase(it);
+            }
           }
-        }
 
-        if (item != nullptr) {
-          (*item->recv_state.waiter)(
-              StatusGroup::MakeDerived(
-                  errors::Cancelled("RecvAsync is cancelled.")),
-              Rendezvous::Args(), item->args, Tensor(), /*is_dead=*/false);
-          delete item;
-        }
-      });
-    }
-    if (already_cancelled) {
+          if (item != nullptr) {
+            (*item->recv_state.waiter)(
+                StatusGroup::MakeDerived(
+                    errors::Cancelled("RecvAsync is cancelled.")),
+                Rendezvous::Args(), item->args, Tensor(), /*is_dead=*/false);
+            delete item;
+          }
+        });
+      }
+      if (already_cancelled) {
+        if (slot != nullptr) slot->num_locked.fetch_sub(1);
+        if (queue->head == nullptr) bucket.table.erase(it);
+        bucket.mu.unlock();
+        done(StatusGroup::MakeDerived(
+                 errors::Cancelled("RecvAsync is cancelled.")),
+             Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
+        return;
+      }
+
+      DVLOG(2) << "Enqueue Recv Item (key:" << key.FullKey() << "). ";
+
+      // TODO(b/143786186): Investigate moving the allocation of `Item` outside
+      // the lock.
+      // If this key owns a slot, `num_locked` now accounts for the queued
+      // item.
+      if (recv_item != nullptr) {
+        queue->push_back(recv_item.release());
+      } else if (cm != nullptr) {
+        // NOTE(mrry): We must wrap `done` with code that deregisters the
+        // cancellation callback before calling the `done` callback, because
+        // the cancellation manager may no longer be live after `done` is
+        // called.
+        queue->push_back(new Item(
+            tsl::core::GetNewRef(rc_owner_), recv_args,
+            [this, cm, token, done = std::move(done)](
+                const Status& s, const Rendezvous::Args& send_args,
+                const Rendezvous::Args& recv_args, const Tensor& v, bool dead) {
+              // TryDeregisterCallback returns true when the cancellation
+              // callback is successfully deregistered. If it fails because the
+              // CM already StartAbort, Unref will happen inside the
+              // cancellation callback when called by the CM.
+              if (cm->TryDeregisterCallback(token)) {
+                // Ignore the return value.
+              }
+              done(s, send_args, recv_args, v, dead);
+            },
+            token,
+            MakeActivityScope("LocalRendezvous::RecvAsync", this, key,
+                              key_hash)));
+      } else {
+        queue->push_back(new Item(
+            tsl::core::GetNewRef(rc_owner_), recv_args, std::move(done), token,
+            MakeActivityScope("LocalRendezvous::RecvAsync", this, key,
+                              key_hash)));
+      }
+
       bucket.mu.unlock();
-      done(StatusGroup::MakeDerived(
-               errors::Cancelled("RecvAsync is cancelled.")),
-           Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
       return;
     }
 
-    DVLOG(2) << "Enqueue Recv Item (key:" << key.FullKey() << "). ";
-
-    // TODO(b/143786186): Investigate moving the allocation of `Item` outside
-    // the lock.
-    activity_watcher::ActivityScope activity_scope(
-        [&]() {
-          return std::make_unique<activity_watcher::Activity>(
-              "LocalRendezvous::RecvAsync",
-              activity_watcher::ActivityCategory::kRendezvous,
-              activity_watcher::Activity::Attributes{
-                  {"Rendezvous", absl::StrFormat("%p", this)},
-                  {"key", std::string(key.FullKey())},
-                  {"key_hash", absl::StrCat(key_hash)},
-              });
-        },
-        /*level=*/1);
-    auto rc_owner = tsl::core::GetNewRef(rc_owner_);
-    if (cm != nullptr) {
-      // NOTE(mrry): We must wrap `done` with code that deregisters the
-      // cancellation callback before calling the `done` callback, because the
-      // cancellation manager may no longer be live after `done` is called.
-      queue->push_back(new Item(
-          std::move(rc_owner), recv_args,
-          [this, cm, token, done = std::move(done)](
-              const Status& s, const Rendezvous::Args& send_args,
-              const Rendezvous::Args& recv_args, const Tensor& v, bool dead) {
-            // TryDeregisterCallback returns true when the cancellation callback
-            // is successfully deregistered. If it fails because the CM already
-            // StartAbort, Unref will happen inside the cancellation callback
-            // when called by the CM.
-            if (cm->TryDeregisterCallback(token)) {
-              // Ignore the return value.
-            }
-            done(s, send_args, recv_args, v, dead);
-          },
-          token, std::move(activity_scope)));
+    DVLOG(2) << "Consume Send Item (key:" << key.FullKey() << "). ";
+    // A message has already arrived and is queued in the table under
+    // this key.  Consumes the message and invokes the done closure.
+    item = queue->head;
+
+    // Delete the queue when the last element has been consumed.
+    if (item->next == nullptr) {
+      DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
+      bucket.table.erase(it);
     } else {
-      queue->push_back(new Item(std::move(rc_owner), recv_args, std::move(done),
-                                token, std::move(activity_scope)));
+      queue->head = item->next;
+    }
+    if (slot != nullptr) {
+      // One for this operation, and one for the consumed item.
+      slot->num_locked.fetch_sub(2);
     }
-
-    bucket.mu.unlock();
-    return;
-  }
-
-  DVLOG(2) << "Consume Send Item (key:" << key.FullKey() << "). ";
-  // A message has already arrived and is queued in the table under
-  // this key.  Consumes the message and invokes the done closure.
-  Item* item = queue->head;
-
-  // Delete the queue when the last element has been consumed.
-  if (item->next == nullptr) {
-    DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    bucket.table.erase(it);
-  } else {
-    queue->head = item->next;
   }
   bucket.pending_callback_counter++;
   // Invoke the done-callback, without holding the lock.
   bucket.mu.unlock();
 
   DCHECK_EQ(item->type, Item::kSend);
-  done(absl::OkStatus(), item->args, recv_args, *item->send_state.value,
-       item->send_state.is_dead);
+  if (recv_item != nullptr) {
+    (*recv_item->recv_state.waiter)(absl::OkStatus(), item->args, recv_args,
+                                    *item->send_state.value,
+                                    item->send_state.is_dead);
+  } else {
+    done(absl::OkStatus(), item->args, recv_args, *item->send_state.value,
+         item->send_state.is_dead);
+  }
   {
     mutex_lock l(bucket.mu);
     bucket.pending_callback_counter--;
@@ -377,7 +570,9 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       bucket.pending_callback_cond_var.notify_all();
     }
   }
-  // Delete the item at last since it may unref and destruct the rendezvous.
+  // Delete the items at last since they may unref and destruct the
+  // rendezvous.
+  recv_item.reset();
   delete item;
 }
 
@@ -401,6 +596,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true, std::memory_order_release);
   }
   LOG_EVERY_POW_2(INFO) << "Local rendezvous is aborting with status: "
                         << status;
@@ -434,9 +630,31 @@ void LocalRendezvous::DoAbort(const Status& status) {
       }
     }
   }
+  for (int i = 0; i < kNumFastPathSlots; ++i) {
+    uintptr_t tagged_item = fast_path_slots_[i].item.exchange(0);
+    if (tagged_item == 0) continue;
+    Item* item = reinterpret_cast<Item*>(tagged_item & ~kItemTypeMask);
+    switch (item->type) {
+      case Item::kRecv:
+        (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                   Rendezvous::Args(), Tensor(), false);
+        LOG(INFO) << "Local rendezvous recv item cancelled. Key hash: "
+                  << fast_path_slots_[i].key_hash.load();
+        break;
+      case Item::kSend:
+        LOG(INFO) << "Local rendezvous send item cancelled. Key hash: "
+                  << fast_path_slots_[i].key_hash.load();
+        break;
+    }
+    to_delete.reset(item);
+  }
 }
 
 Status LocalRendezvous::status() {
+  // Avoid taking `mu_` on the Send/Recv path until the rendezvous is aborted.
+  if (TF_PREDICT_TRUE(!aborted_.load(std::memory_order_acquire))) {
+    return absl::OkStatus();
+  }
   tf_shared_lock ml(mu_);
   return status_;
 }
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -71,6 +73,45 @@ class LocalRendezvous {
 
   struct Item;
 
+  // A lock-free mailbox that holds at most one pending item of a single key.
+  //
+  // When no operation on the key is in progress under the bucket lock, a Send
+  // or Recv first tries to consume the opposite item from the slot or to park
+  // its own item there, which avoids the bucket lock entirely for the common
+  // case of one outstanding message per key. All other cases fall back to the
+  // bucket table.
+  struct FastPathSlot {
+    // Hash of the key that owns this slot, or 0 if the slot is unowned. Once
+    // set, ownership is never released.
+    std::atomic<uint64> key_hash{0};
+    // The parked Item, tagged in the low bit with its type, or 0 if empty.
+    std::atomic<uintptr_t> item{0};
+    // Number of items of this key queued in the bucket table, plus the number
+    // of in-progress operations on this key that hold the bucket lock. While
+    // non-zero, operations on this key must use the bucket table so that
+    // FIFO order is preserved.
+    std::atomic<int> num_locked{0};
+  };
+
+  static constexpr int kNumFastPathSlots = 64;
+  static_assert((kNumFastPathSlots & (kNumFastPathSlots - 1)) == 0,
+                "kNumFastPathSlots must be a power of 2");
+  static constexpr int kFastPathProbes = 4;
+  static constexpr uintptr_t kItemTypeMask = 1;
+
+  // Returns the slot owned by `key_hash`. If `claim` is true and no slot is
+  // owned by `key_hash`, claims an unowned slot. Returns nullptr if no slot is
+  // available.
+  FastPathSlot* FindFastPathSlot(uint64 key_hash, bool claim);
+  // Removes and returns the item in `slot` if it has the given `type`.
+  // Returns nullptr otherwise.
+  static Item* TakeFromFastPathSlot(FastPathSlot* slot, int type);
+  // Parks `item` in `slot`. Returns false, leaving the caller with ownership
+  // of `item`, if the slot is occupied or if a concurrent operation on the
+  // same key started using the bucket table.
+  static bool PublishToFastPathSlot(FastPathSlot* slot, Item* item);
+  static uintptr_t TagItem(Item* item);
+
   // By invariant, the item queue under each key is of the form
   //   [item.type == kSend]* meaning each item is a sent message.
   // or
@@ -100,8 +141,15 @@ class LocalRendezvous {
 
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
+  FastPathSlot fast_path_slots_[kNumFastPathSlots];
+  // Number of done-callbacks that are being invoked from the fast path.
+  std::atomic<int> num_fast_path_callbacks_{0};
+
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  // Set once `status_` holds an error, so that `status()` can skip `mu_` on
+  // the common path.
+  std::atomic<bool> aborted_{false};
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
@@ -15,17 +15,24 @@ limitations under the License.
 
 #include "tensorflow/core/framework/metrics.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
+#include "tsl/lib/monitoring/collection_registry.h"
 #include "tsl/lib/monitoring/counter.h"
 #include "tsl/lib/monitoring/gauge.h"
+#include "tsl/lib/monitoring/metric_def.h"
 #include "tsl/lib/monitoring/sampler.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/mutex_contention.h"
+#include "tsl/platform/threadpool_metrics.h"
 #include "tsl/platform/types.h"
 #include "tsl/protobuf/error_codes.pb.h"
 
@@ -57,12 +64,26 @@ auto* graph_run_time_usecs_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 20 (> 17 minutes)
     {tsl::monitoring::Buckets::Exponential(1000, 2, 20)});
 
+auto* graph_run_phase_time_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/graph_run_phase_time_usecs",
+     "The wall-clock time spent in each phase {'setup', 'run_handler_wait', "
+     "'execution', 'finalize'} of graph runs in microseconds.",
+     "phase"},
+    // Power of 2 with bucket count 30 (> 8 minutes)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 30)});
+
 auto* graph_pending_queue_length_histogram = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_pending_queue_length_histogram",
      "The number of pending (ready but not running) tasks in graph executor."},
     // Power of 1.5 with bucket count 30 (> 191k)
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* executor_entry_pool_bytes = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/executor_entry_pool_bytes",
+    "The number of bytes of executor input entry arrays obtained per step, "
+    "either reused from the executor's pool or newly allocated.",
+    "source");
+
 auto* graph_run_input_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -79,6 +100,19 @@ auto* graph_unused_outputs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* unforwarded_output_allocations = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/unforwarded_output_allocations",
+    "The number of outputs allocated by ops of a given type although an "
+    "input with the same type and size could have been forwarded. Only "
+    "recorded when output forwarding auditing is enabled.",
+    "name");
+
+auto* tensor_list_copies = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/tensor_list_copies",
+    "The number of times an op of a given type copied a TensorList because "
+    "it could not update its input list in place.",
+    "name");
+
 auto* tf_data_fetch_op_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/fetch_op",
     "The number of times a tf.data operation that fetches output(s) of a "
@@ -142,6 +176,30 @@ auto* tf_data_service_compression = tsl::monitoring::Counter<1>::New(
     "'not_disabled_at_runtime', 'not_eligible'}.",
     "action");
 
+auto* sampled_node_compute_time_usecs = tsl::monitoring::Sampler<2>::New(
+    {"/tensorflow/core/sampled_node_compute_time_usecs",
+     "The compute time of nodes sampled by the executor, in microseconds, by "
+     "op and bucket of the total size of the node's inputs.",
+     "op", "input_bytes"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* sampled_node_scheduling_delay_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/sampled_node_scheduling_delay_usecs",
+     "The time from a node sampled by the executor becoming ready until the "
+     "executor started processing it, in microseconds.",
+     "op"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* sampled_step_phase_time_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/sampled_step_phase_time_usecs",
+     "The estimated time that sampled steps spent in the ops of each phase "
+     "{'input', 'compute', 'collective'}, in microseconds.",
+     "phase"},
+    // Power of 2 with bucket count 30 (> 8 minutes)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 30)});
+
 auto* tf_data_service_get_element_duration_usecs_histogram =
     tsl::monitoring::Sampler<1>::New(
         {"/tensorflow/data/getelement_duration",
@@ -418,6 +476,25 @@ auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_ongoing_async_compilations =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/core/xla_ongoing_async_compilations",
+        "The number of asynchronous XLA compilations that are queued or "
+        "running.");
+
+auto* xla_async_compilation_queue_time_usecs =
+    tsl::monitoring::Counter<0>::New(
+        "/tensorflow/core/xla_async_compilation_queue_time_usecs",
+        "The total time asynchronous XLA compilations spent queued in "
+        "microseconds.");
+
+auto* xla_launch_copied_bytes = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/xla_launch_copied_bytes",
+     "The number of bytes copied between TF tensors and XLA buffers by an XLA "
+     "cluster launch."},
+    // Power of 2 with bucket count 14 (256MB)
+    {tsl::monitoring::Buckets::Exponential(1, 4, 14)});
+
 auto* xla_tpu_spmd_cores_per_replica = tsl::monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -432,6 +509,111 @@ auto* test_counters = tsl::monitoring::Counter<2>::New(
     "/tensorflow/core/test_counters", "Counters used for testing.", "name",
     "label");
 
+// The mutex contention metrics are read from the tsl::MutexContentionSite
+// registry when they are collected, so the profiled lock paths never touch the
+// monitoring cells.
+template <tsl::monitoring::MetricKind metric_kind>
+void RegisterMutexContentionMetric(
+    const char* name, const char* description,
+    int64_t tsl::MutexContentionStats::*field) {
+  const auto* metric_def =
+      new tsl::monitoring::MetricDef<metric_kind, int64_t, 1>(name, description,
+                                                              "site");
+  tsl::monitoring::CollectionRegistry::Default()
+      ->Register(metric_def,
+                 [metric_def, field](
+                     tsl::monitoring::MetricCollectorGetter getter) {
+                   auto collector = getter.Get(metric_def);
+                   for (const tsl::MutexContentionStats& stats :
+                        tsl::GetMutexContentionStats()) {
+                     if (stats.acquisitions == 0) continue;
+                     collector.CollectValue({stats.name}, stats.*field);
+                   }
+                 })
+      .release();
+}
+
+[[maybe_unused]] const bool mutex_contention_metrics_registered = [] {
+  using tsl::monitoring::MetricKind;
+  RegisterMutexContentionMetric<MetricKind::kCumulative>(
+      "/tensorflow/core/mutex_contention/acquisitions",
+      "The estimated number of acquisitions of each profiled mutex site.",
+      &tsl::MutexContentionStats::acquisitions);
+  RegisterMutexContentionMetric<MetricKind::kCumulative>(
+      "/tensorflow/core/mutex_contention/contended_acquisitions",
+      "The estimated number of acquisitions of each profiled mutex site that "
+      "had to wait.",
+      &tsl::MutexContentionStats::contended_acquisitions);
+  RegisterMutexContentionMetric<MetricKind::kCumulative>(
+      "/tensorflow/core/mutex_contention/wait_time_nsecs",
+      "The estimated total time spent waiting for each profiled mutex site.",
+      &tsl::MutexContentionStats::total_wait_ns);
+  RegisterMutexContentionMetric<MetricKind::kGauge>(
+      "/tensorflow/core/mutex_contention/max_wait_time_nsecs",
+      "The longest sampled wait for each profiled mutex site.",
+      &tsl::MutexContentionStats::max_wait_ns);
+  return true;
+}();
+
+// Like the mutex contention metrics, the thread pool metrics are read from the
+// tsl::thread::ThreadPoolMetrics registry when they are collected. The
+// utilization of a pool is the rate of busy_time_nsecs over num_threads.
+template <tsl::monitoring::MetricKind metric_kind>
+void RegisterThreadPoolMetric(const char* name, const char* description,
+                              int64_t tsl::thread::ThreadPoolStats::*field) {
+  const auto* metric_def =
+      new tsl::monitoring::MetricDef<metric_kind, int64_t, 1>(name, description,
+                                                              "pool");
+  tsl::monitoring::CollectionRegistry::Default()
+      ->Register(metric_def,
+                 [metric_def, field](
+                     tsl::monitoring::MetricCollectorGetter getter) {
+                   auto collector = getter.Get(metric_def);
+                   for (const tsl::thread::ThreadPoolStats& stats :
+                        tsl::thread::GetThreadPoolStats()) {
+                     collector.CollectValue({stats.name}, stats.*field);
+                   }
+                 })
+      .release();
+}
+
+[[maybe_unused]] const bool thread_pool_metrics_registered = [] {
+  using tsl::monitoring::MetricKind;
+  using tsl::thread::ThreadPoolStats;
+  RegisterThreadPoolMetric<MetricKind::kGauge>(
+      "/tensorflow/core/thread_pool/num_threads",
+      "The number of threads of the live thread pools with each name.",
+      &ThreadPoolStats::num_threads);
+  RegisterThreadPoolMetric<MetricKind::kCumulative>(
+      "/tensorflow/core/thread_pool/scheduled_tasks",
+      "The estimated number of tasks scheduled on each thread pool.",
+      &ThreadPoolStats::scheduled_tasks);
+  RegisterThreadPoolMetric<MetricKind::kGauge>(
+      "/tensorflow/core/thread_pool/queued_tasks",
+      "The estimated number of tasks waiting to run on each thread pool.",
+      &ThreadPoolStats::queued_tasks);
+  RegisterThreadPoolMetric<MetricKind::kCumulative>(
+      "/tensorflow/core/thread_pool/queue_wait_time_nsecs",
+      "The estimated total time tasks waited in the queues of each thread "
+      "pool.",
+      &ThreadPoolStats::total_queue_wait_ns);
+  RegisterThreadPoolMetric<MetricKind::kGauge>(
+      "/tensorflow/core/thread_pool/max_queue_wait_time_nsecs",
+      "The longest sampled queueing delay of each thread pool.",
+      &ThreadPoolStats::max_queue_wait_ns);
+  RegisterThreadPoolMetric<MetricKind::kCumulative>(
+      "/tensorflow/core/thread_pool/busy_time_nsecs",
+      "The estimated total time the threads of each thread pool spent "
+      "running tasks.",
+      &ThreadPoolStats::busy_ns);
+  RegisterThreadPoolMetric<MetricKind::kCumulative>(
+      "/tensorflow/core/thread_pool/stolen_tasks",
+      "The estimated number of tasks scheduled by one worker of each thread "
+      "pool and run by another.",
+      &ThreadPoolStats::stolen_tasks);
+  return true;
+}();
+
 }  // namespace
 
 auto* tpu_op_error_counter = tsl::monitoring::Counter<2>::New(
@@ -809,12 +991,55 @@ void UpdateGraphExecTime(const uint64 running_time_usecs) {
   }
 }
 
+void UpdateGraphRunPhaseTimes(uint64 setup_usecs, uint64 run_handler_wait_usecs,
+                              uint64 execution_usecs, uint64 finalize_usecs) {
+  static auto* setup_cell = graph_run_phase_time_usecs->GetCell("setup");
+  static auto* run_handler_wait_cell =
+      graph_run_phase_time_usecs->GetCell("run_handler_wait");
+  static auto* execution_cell =
+      graph_run_phase_time_usecs->GetCell("execution");
+  static auto* finalize_cell = graph_run_phase_time_usecs->GetCell("finalize");
+  setup_cell->Add(setup_usecs);
+  run_handler_wait_cell->Add(run_handler_wait_usecs);
+  execution_cell->Add(execution_usecs);
+  finalize_cell->Add(finalize_usecs);
+}
+
 void UpdateGraphPendingQueueLength(uint64 len) {
   static auto* graph_pending_queue_length_cell =
       graph_pending_queue_length_histogram->GetCell();
   graph_pending_queue_length_cell->Add(len);
 }
 
+void RecordExecutorEntryPoolBytes(int64_t bytes_reused,
+                                  int64_t bytes_allocated) {
+  static auto* reused_cell = executor_entry_pool_bytes->GetCell("reused");
+  static auto* allocated_cell = executor_entry_pool_bytes->GetCell("allocated");
+  if (bytes_reused > 0) reused_cell->IncrementBy(bytes_reused);
+  if (bytes_allocated > 0) allocated_cell->IncrementBy(bytes_allocated);
+}
+
+void RecordSampledNodeStats(const string& op_name,
+                            const string& input_bytes_bucket,
+                            int64_t compute_time_usecs,
+                            int64_t scheduling_delay_usecs) {
+  sampled_node_compute_time_usecs->GetCell(op_name, input_bytes_bucket)
+      ->Add(std::max<int64_t>(compute_time_usecs, 0));
+  sampled_node_scheduling_delay_usecs->GetCell(op_name)->Add(
+      std::max<int64_t>(scheduling_delay_usecs, 0));
+}
+
+void RecordSampledStepPhaseTimes(int64_t input_usecs, int64_t compute_usecs,
+                                 int64_t collective_usecs) {
+  static auto* input_cell = sampled_step_phase_time_usecs->GetCell("input");
+  static auto* compute_cell = sampled_step_phase_time_usecs->GetCell("compute");
+  static auto* collective_cell =
+      sampled_step_phase_time_usecs->GetCell("collective");
+  input_cell->Add(std::max<int64_t>(input_usecs, 0));
+  compute_cell->Add(std::max<int64_t>(compute_usecs, 0));
+  collective_cell->Add(std::max<int64_t>(collective_usecs, 0));
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
@@ -921,10 +1146,43 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void UpdateXlaOngoingAsyncCompilations(int64_t delta) {
+  // Every device has its own compiler, so the gauge holds the sum of their
+  // counts rather than the count of whichever device updated it last.
+  static tsl::mutex* mu = new tsl::mutex();
+  static int64_t num_compilations = 0;
+  static auto* xla_ongoing_async_compilations_cell =
+      xla_ongoing_async_compilations->GetCell();
+  tsl::mutex_lock lock(*mu);
+  num_compilations += delta;
+  xla_ongoing_async_compilations_cell->Set(num_compilations);
+}
+
+void UpdateXlaAsyncCompilationQueueTime(const uint64 queue_time_usecs) {
+  if (queue_time_usecs > 0) {
+    static auto* xla_async_compilation_queue_time_usecs_cell =
+        xla_async_compilation_queue_time_usecs->GetCell();
+    xla_async_compilation_queue_time_usecs_cell->IncrementBy(queue_time_usecs);
+  }
+}
+
+void RecordXlaLaunchCopiedBytes(const int64_t copied_bytes) {
+  static auto* xla_launch_copied_bytes_cell = xla_launch_copied_bytes->GetCell();
+  xla_launch_copied_bytes_cell->Add(copied_bytes);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void RecordUnforwardedOutputAllocation(const string& op_name) {
+  unforwarded_output_allocations->GetCell(op_name)->IncrementBy(1);
+}
+
+void RecordTensorListCopy(const string& op_name) {
+  tensor_list_copies->GetCell(op_name)->IncrementBy(1);
+}
+
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec) {
   GetTFDataPipelineProcessingTimeGauge(id)->Set(pipeline_processing_time_usec);
@@ -267,11 +267,47 @@ void RecordGraphOutputTensors(const size_t size);
 void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 
 void UpdateGraphExecTime(const uint64 running_time_usecs);
+// Updates the metrics stored about the time spent in each phase of a graph
+// run: before the executors were started (including waiting for a run
+// handler), executing, and after the executors were done.
+void UpdateGraphRunPhaseTimes(uint64 setup_usecs, uint64 run_handler_wait_usecs,
+                              uint64 execution_usecs, uint64 finalize_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the number of bytes of executor input `Entry` arrays that one step
+// took from the executor's pool (`bytes_reused`) and that had to be newly
+// allocated because the pool had no array of the right size
+// (`bytes_allocated`).
+void RecordExecutorEntryPoolBytes(int64_t bytes_reused,
+                                  int64_t bytes_allocated);
+
+// Records the compute time and the scheduling delay (from being made ready
+// until the executor started processing it) of one node of type `op_name`
+// sampled by `SampledStepStatsCollector`, in microseconds. The compute time is
+// also bucketed by `input_bytes_bucket`, a coarse bucket of the total size of
+// the node's inputs.
+void RecordSampledNodeStats(const string& op_name,
+                            const string& input_bytes_bucket,
+                            int64_t compute_time_usecs,
+                            int64_t scheduling_delay_usecs);
+
+// Records the estimated time that one step sampled by
+// `SampledStepStatsCollector` spent in input ops, in other ops and in
+// collective or cross-device receive ops, in microseconds.
+void RecordSampledStepPhaseTimes(int64_t input_usecs, int64_t compute_usecs,
+                                 int64_t collective_usecs);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records that an op of type `op_name` allocated an output that could have
+// reused the buffer of one of its inputs.
+void RecordUnforwardedOutputAllocation(const string& op_name);
+
+// Records that an op of type `op_name` copied its input TensorList instead of
+// updating it in place.
+void RecordTensorListCopy(const string& op_name);
+
 // Records the pipeline processing time in microseconds
 void RecordPipelineProcessingTime(const string& id,
                                   double pipeline_processing_time_usec);
@@ -522,6 +558,18 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Adds `delta` to the number of asynchronous XLA compilations that are queued
+// or running in the process.
+void UpdateXlaOngoingAsyncCompilations(int64_t delta);
+
+// Updates the metrics stored about time asynchronous XLA compilations spend
+// queued before they start.
+void UpdateXlaAsyncCompilationQueueTime(const uint64 queue_time_usecs);
+
+// Records the number of bytes copied between TF tensors and XLA buffers by a
+// single XLA cluster launch.
+void RecordXlaLaunchCopiedBytes(int64_t copied_bytes);
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
@@ -64,6 +64,9 @@ constexpr double kBufferDownsizeMultipliter = 0.9;
 // Threshold of low buffer watermark before a buffer is a candidate for
 // upsizing.
 constexpr int64_t kBufferLowWatermarkThreshold = 2;
+// Experiment that makes autotuning account for all buffered bytes against the
+// RAM budget and trade off output time improvements against memory.
+constexpr char kMemoryAwareAutotune[] = "autotune_memory_aware";
 
 constexpr char kDataService[] = "DataService";
 constexpr char kFlatMap[] = "FlatMap";
@@ -1758,6 +1761,16 @@ double Node::TotalMaximumBufferedBytes() const {
   return total_bytes[long_name()];
 }
 
+double Node::TotalUntunedBufferedBytes() const {
+  tf_shared_lock l(mu_);
+  double result = UntunedBufferedBytesLocked();
+  for (const auto& node : CollectNodesLocked(TraversalOrder::BFS, IsAnyNode)) {
+    tf_shared_lock l(node->mu_);
+    result += node->UntunedBufferedBytesLocked();
+  }
+  return result;
+}
+
 double Node::TotalProcessingTime(Node::NodeValues* processing_times) {
   // Create a hash map to store the per-element CPU time spent in the subtree
   // rooted in each node.
@@ -2138,6 +2151,14 @@ double Node::MaximumBufferedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_) {
   return 0;
 }
 
+double Node::UntunedBufferedBytesLocked() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+  if (autotune_ && (parameters_.contains(kBufferSize) ||
+                    parameters_.contains(kParallelism))) {
+    return 0;
+  }
+  return buffered_bytes_;
+}
+
 Status Node::ToProto(ModelProto::Node* node_proto) const {
   tf_shared_lock l(mu_);
   node_proto->set_id(id_);
@@ -2368,6 +2389,15 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
     total_ram_budget = ram_budget_share *
                        (port::AvailableRam() + TotalBufferedBytes(snapshot));
   }
+  const bool memory_aware = experiments_.contains(kMemoryAwareAutotune);
+  if (memory_aware) {
+    // Buffers whose sizes are not tuned, such as shuffle and cache buffers,
+    // still take up memory. Reserve their current size so that the tuned
+    // buffers are sized to what is actually left.
+    total_ram_budget = std::max<int64_t>(
+        0, total_ram_budget -
+               static_cast<int64_t>(TotalUntunedBufferedBytes(snapshot)));
+  }
 
   ram_budget_manager.UpdateBudget(total_ram_budget);
   int64_t model_ram_budget = ram_budget_manager.AvailableModelRam();
@@ -2411,6 +2441,12 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
   if (experiments_.contains("autotune_buffer_optimization")) {
     OptimizeBuffers(snapshot, optimization_params.ram_budget());
   }
+  if (memory_aware &&
+      ShrinkBuffersToRamBudget(snapshot, model_input_time,
+                               ram_budget_manager.AvailableModelRam(),
+                               cancellation_manager)) {
+    ResetBufferWatermarks();
+  }
   {
     // Save the snapshot of the model proto including the parameters used by
     // autotune. This will be used as the model proto returned in `tfstreamz`.
@@ -2682,6 +2718,11 @@ void Model::OptimizeHillClimbHelper(
   // Buffer size parameter will only be incremented if the output latency
   // improvement is greater than this constant.
   constexpr double kBufferSizeMinDelta = 1.0L;
+  // Parameters whose increase does not add buffered bytes are scored as if
+  // they added this many bytes when comparing improvements per byte.
+  constexpr double kMinDeltaBytes = 1.0L;
+
+  const bool memory_aware = experiments_.contains(kMemoryAwareAutotune);
 
   // Skip buffer size optimization if we are running the new buffering
   // algorithm.
@@ -2719,6 +2760,8 @@ void Model::OptimizeHillClimbHelper(
     }
 
     double best_delta = -1.0L;
+    double best_delta_per_byte = 0.0L;
+    bool ram_budget_reached = false;
     best_parameter = nullptr;
     for (auto& pair : parameters) {
       if (pair.second->value >= pair.second->max ||
@@ -2730,13 +2773,36 @@ void Model::OptimizeHillClimbHelper(
           OutputTime(snapshot, optimization_params.model_input_time(),
                      /*gradients=*/nullptr);
       double delta = output_time - new_output_time;
-      if (delta > best_delta &&
+      double delta_per_byte = 0.0L;
+      bool better = delta > best_delta;
+      if (memory_aware && delta > 0) {
+        const double candidate_buffered_bytes =
+            TotalMaximumBufferedBytes(snapshot);
+        if (candidate_buffered_bytes > ram_budget) {
+          ram_budget_reached = true;
+          better = false;
+        } else {
+          delta_per_byte =
+              delta / std::max(kMinDeltaBytes,
+                               candidate_buffered_bytes - new_buffered_bytes);
+          better = !best_parameter || delta_per_byte > best_delta_per_byte;
+        }
+      }
+      if (better &&
           (delta > kBufferSizeMinDelta || pair.second->name != kBufferSize)) {
         best_delta = delta;
+        best_delta_per_byte = delta_per_byte;
         best_parameter = pair.second.get();
       }
       pair.second->value--;
     }
+    if (!best_parameter && ram_budget_reached) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
+      VLOG(2) << "Every tunable parameter that would further decrease the "
+                 "output time would exceed the RAM budget. The optimization "
+                 "attempt will stop now.";
+      break;
+    }
     if (!best_parameter) {
       metrics::RecordTFDataAutotuneStoppingCriteria("local_maximum_reached");
       VLOG(2) << "Failed to find a tunable parameter that would further "
@@ -3101,6 +3167,81 @@ void Model::ResetBufferWatermarks() {
   }
 }
 
+bool Model::ShrinkBuffersToRamBudget(
+    std::shared_ptr<Node> snapshot, double model_input_time,
+    int64_t ram_budget, CancellationManager* cancellation_manager) {
+  // Start from the values the input pipeline is using, which differ from the
+  // snapshot parameter values if the last allocation request was rejected.
+  Node::NodeVector nodes =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(snapshot);
+  for (auto& node : nodes) {
+    node->SyncStateValuesToParameterValues(kParallelism);
+    node->SyncStateValuesToParameterValues(kBufferSize);
+  }
+  double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  if (buffered_bytes <= ram_budget) {
+    return false;
+  }
+  ModelParameters buffer_size_parameters;
+  for (auto& pair : CollectTunableParameters(snapshot)) {
+    if (pair.second->name == kBufferSize) {
+      buffer_size_parameters.push_back(std::move(pair));
+    }
+  }
+  VLOG(2) << "Shrinking buffers from " << buffered_bytes
+          << " bytes to fit the RAM budget of " << ram_budget << " bytes.";
+  bool shrunk = false;
+  while (buffered_bytes > ram_budget && !cancellation_manager->IsCancelled()) {
+    const double output_time =
+        OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+    Parameter* best_parameter = nullptr;
+    double best_value = 0;
+    double best_cost_per_byte = std::numeric_limits<double>::max();
+    for (auto& pair : buffer_size_parameters) {
+      Parameter* parameter = pair.second.get();
+      const double old_value = parameter->value;
+      if (old_value <= parameter->min) {
+        continue;
+      }
+      const double new_value = std::max(
+          parameter->min,
+          std::min(old_value - 1.0,
+                   std::floor(old_value * kBufferDownsizeMultipliter)));
+      parameter->value = new_value;
+      const double freed_bytes =
+          buffered_bytes - TotalMaximumBufferedBytes(snapshot);
+      const double cost =
+          OutputTime(snapshot, model_input_time, /*gradients=*/nullptr) -
+          output_time;
+      parameter->value = old_value;
+      if (freed_bytes <= 0) {
+        continue;
+      }
+      const double cost_per_byte = cost / freed_bytes;
+      if (cost_per_byte < best_cost_per_byte) {
+        best_cost_per_byte = cost_per_byte;
+        best_parameter = parameter;
+        best_value = new_value;
+      }
+    }
+    if (!best_parameter) {
+      break;
+    }
+    best_parameter->value = best_value;
+    buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+    shrunk = true;
+  }
+  if (shrunk) {
+    for (auto& [node_name, parameter] : buffer_size_parameters) {
+      VLOG(2) << "Shrink buffer " << node_name << "::" << parameter->name
+              << " to " << parameter->value;
+    }
+    UpdateStateValues(&buffer_size_parameters);
+  }
+  return shrunk;
+}
+
 void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
                               const OptimizationParams& optimization_params,
                               CancellationManager* cancellation_manager,
@@ -3178,6 +3319,10 @@ double Model::TotalMaximumBufferedBytes(std::shared_ptr<Node> node) {
   return node->TotalMaximumBufferedBytes();
 }
 
+double Model::TotalUntunedBufferedBytes(std::shared_ptr<Node> node) {
+  return node->TotalUntunedBufferedBytes();
+}
+
 double Model::TotalProcessingTime(std::shared_ptr<Node> node) {
   return node->TotalProcessingTime(/*processing_times=*/nullptr);
 }
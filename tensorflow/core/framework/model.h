@@ -594,6 +594,11 @@ class Node {
   // would be used by the subtree nodes if all of their buffers were full.
   double TotalMaximumBufferedBytes() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the total number of bytes buffered in all nodes in the subtree
+  // that are not accounted for by `TotalBufferedBytes()`, i.e. nodes whose
+  // buffer sizes are not tuned such as shuffle and cache buffers.
+  double TotalUntunedBufferedBytes() const TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the per-element CPU time in nanoseconds spent in the subtree rooted
   // in this node. If `processing_times` is not `nullptr`, collects the
   // per-element CPU time spent in each node of the subtree.
@@ -803,6 +808,10 @@ class Node {
   void TotalMaximumBufferedBytesHelper(NodeValues* total_bytes) const
       TF_SHARED_LOCKS_REQUIRED(mu_);
 
+  // Returns the bytes buffered by the node itself if they are not accounted
+  // for by `TotalBufferedBytesHelper()`, and 0 otherwise.
+  double UntunedBufferedBytesLocked() const TF_SHARED_LOCKS_REQUIRED(mu_);
+
   // Compute and return the maximum buffered bytes on the node itself. By
   // default non-tunable nodes are assumed not to buffer any bytes, so the
   // tunable nodes as subclasses are expected to override this method to ensure
@@ -1073,6 +1082,15 @@ class Model {
   // elements.
   void ResetBufferWatermarks();
 
+  // Shrinks the buffers of the nodes rooted at `snapshot`, starting from the
+  // values currently used by the input pipeline, until their maximum buffered
+  // bytes fit in `ram_budget`. Each step downsizes the buffer whose downsizing
+  // increases the output time the least per byte freed. Returns true if any
+  // buffer is downsized.
+  bool ShrinkBuffersToRamBudget(std::shared_ptr<Node> snapshot,
+                                double model_input_time, int64_t ram_budget,
+                                CancellationManager* cancellation_manager);
+
   // Collects buffer parameters of all nodes in the model that should be
   // upsized.
   absl::flat_hash_map<Node*, Parameter*> CollectBufferParametersToUpsize(
@@ -1094,6 +1112,11 @@ class Model {
 
   // Helper method for implementing hill-climb optimization that can be
   // parametrized by a predicate to use for stopping the optimization.
+  //
+  // If the `autotune_memory_aware` experiment is enabled, each step picks the
+  // parameter with the largest output time decrease per byte of additional
+  // buffer memory, and parameters whose increase would exceed `ram_budget` are
+  // skipped instead of stopping the optimization.
   void OptimizeHillClimbHelper(std::shared_ptr<Node> snapshot,
                                const OptimizationParams& optimization_params,
                                CancellationManager* cancellation_manager,
@@ -1172,6 +1195,11 @@ class Model {
   // buffers were full.
   double TotalMaximumBufferedBytes(std::shared_ptr<Node> node);
 
+  // Collects the total number of bytes buffered in all nodes in the subtree
+  // rooted in the given node whose buffer sizes are not tuned, such as shuffle
+  // and cache buffers.
+  double TotalUntunedBufferedBytes(std::shared_ptr<Node> node);
+
   std::optional<std::string> dataset_name_;
   // Used for coordination between different input pipeline threads. Exclusive
   // access is required only when adding or removing nodes. Concurrent access to
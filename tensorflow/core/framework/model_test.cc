@@ -687,6 +687,30 @@ TEST(BufferedBytesTest, Node) {
   EXPECT_EQ(node->inputs().size(), 0);
 }
 
+TEST(UntunedBufferedBytesTest, Node) {
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {0, "TestNode", nullptr}, 1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(/*value=*/2, nullptr, nullptr),
+          /*min=*/1, /*max=*/4)});
+  // A node without a buffer size or parallelism parameter, e.g. a shuffle or
+  // cache node, whose buffer is not tuned.
+  std::shared_ptr<Node> input =
+      model::MakeUnknownRatioNode({1, "TestInput", node});
+  node->add_input(input);
+
+  node->record_buffer_event(20, 1);
+  input->record_buffer_event(100, 4);
+  EXPECT_EQ(node->TotalBufferedBytes(), 20);
+  EXPECT_EQ(node->TotalUntunedBufferedBytes(), 100);
+  EXPECT_EQ(input->TotalUntunedBufferedBytes(), 100);
+
+  input->record_buffer_event(-40, -2);
+  EXPECT_EQ(node->TotalBufferedBytes(), 20);
+  EXPECT_EQ(node->TotalUntunedBufferedBytes(), 60);
+}
+
 // Returns a weighted sum of a prior and the actual processing time.
 double weighted_processing_time(int64_t num_elements, double processing_time,
                                 double prior) {
@@ -1386,6 +1410,67 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1, 2, 3));
 
+class OptimizeMemoryAwareTest
+    : public ::testing::TestWithParam<model::AutotuneAlgorithm> {};
+
+// With the `autotune_memory_aware` experiment, bytes buffered by untuned nodes
+// are reserved from the RAM budget, so a shuffle buffer that takes up the
+// whole fixed budget leaves no memory for the tunable parameters.
+TEST_P(OptimizeMemoryAwareTest, UntunedBuffersReduceRamBudget) {
+  const model::AutotuneAlgorithm algorithm = GetParam();
+
+  std::shared_ptr<mutex> mutex1 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv1 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 2,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex1, cv1),
+                            /*min=*/1, /*max=*/5)});
+  node1->record_buffer_event(1, 1);
+  node1->record_element();
+
+  std::shared_ptr<mutex> mutex2 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv2 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node2 = model::MakeAsyncKnownRatioNode(
+      {2, "2", node1}, 5,
+      {model::MakeParameter("buffer_size",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex2, cv2),
+                            /*min=*/0, /*max=*/6)});
+  node2->record_buffer_event(1, 1);
+  node2->record_element();
+
+  std::shared_ptr<Node> shuffle = model::MakeUnknownRatioNode({3, "3", node2});
+  shuffle->record_buffer_event(1000, 10);
+  shuffle->record_element();
+
+  model::Model model;
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+  model.AddNode([&shuffle](model::Node::Args args) { return shuffle; }, "3",
+                node2, &shuffle);
+  model.AddExperiment("autotune_memory_aware");
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(1000);
+  model.Optimize(algorithm, CpuBudgetFunc(40),
+                 /*ram_budget_share=*/1.0,
+                 /*fixed_ram_budget=*/1000,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  EXPECT_EQ(ram_budget_manager.AvailableModelRam(), 0);
+  EXPECT_EQ(node1->parameter_value("parallelism"), 1);
+  EXPECT_EQ(node2->parameter_value("buffer_size"), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, OptimizeMemoryAwareTest,
+                         ::testing::Values(0, 1, 2, 3));
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
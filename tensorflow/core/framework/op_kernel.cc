@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/kernel_def_util.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/memory_types.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/node_properties.h"
@@ -58,6 +60,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -379,6 +382,8 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
     CHECK(allocator);
+  } else if (params_->step_allocator != nullptr && attr.value == 0) {
+    allocator = params_->step_allocator;
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
@@ -701,6 +706,50 @@ Status OpKernelContext::output_list(StringPiece name, OpOutputList* list) {
   return absl::OkStatus();
 }
 
+namespace {
+
+bool OutputForwardingAuditFromEnv() {
+  bool enabled = false;
+  Status s = ReadBoolFromEnvVar("TF_AUDIT_OUTPUT_FORWARDING",
+                                /*default_val=*/false, &enabled);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  }
+  return enabled;
+}
+
+std::atomic<bool>& OutputForwardingAuditEnabled() {
+  static std::atomic<bool>* enabled =
+      new std::atomic<bool>(OutputForwardingAuditFromEnv());
+  return *enabled;
+}
+
+}  // namespace
+
+void SetOutputForwardingAuditEnabled(bool enabled) {
+  OutputForwardingAuditEnabled().store(enabled, std::memory_order_relaxed);
+}
+
+bool OpKernelContext::CouldForwardInputToOutput(
+    int index, DataType type, const TensorShape& shape) const {
+  if (shape.num_elements() == 0 ||
+      (params_->forward_from_array != nullptr &&
+       params_->forward_from_array[index] == Params::kNeverForward)) {
+    return false;
+  }
+  for (int i = 0; i < num_inputs(); ++i) {
+    const TensorValue& input = params_->inputs[i];
+    if (input.tensor != nullptr && !input.is_ref() &&
+        input_dtype(i) == type &&
+        input.tensor->NumElements() == shape.num_elements() &&
+        input_memory_type(i) == output_memory_type(index) &&
+        input.tensor->RefCountIsOne()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void OpKernelContext::maybe_initialize_scope_id_set() {
   if (allocated_scope_ids_ == nullptr) {
     allocated_scope_ids_ = std::make_unique<std::unordered_set<int32>>();
@@ -763,11 +812,11 @@ Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
   Allocator* a = get_allocator(attr);
-  Tensor new_tensor(
-      a, type, shape,
-      AllocationAttributes(
-          /*retry_on_failure=*/allocation_attr.retry_on_failure,
-          /*allocation_will_be_logged=*/true, allocation_attr.freed_by_func));
+  AllocationAttributes logged_attr(
+      /*retry_on_failure=*/allocation_attr.retry_on_failure,
+      /*allocation_will_be_logged=*/true, allocation_attr.freed_by_func);
+  logged_attr.short_lived = allocation_attr.short_lived;
+  Tensor new_tensor(a, type, shape, logged_attr);
 
   if (!new_tensor.IsInitialized()) {
     return errors::ResourceExhausted(
@@ -820,6 +869,10 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "output", type,
       [&shape]() { return shape.DebugString(); });
+  if (OutputForwardingAuditEnabled().load(std::memory_order_relaxed) &&
+      CouldForwardInputToOutput(index, type, shape)) {
+    metrics::RecordUnforwardedOutputAllocation(op_kernel().type_string());
+  }
   auto output_tensor = std::make_unique<Tensor>();
   Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
   if (s.ok()) {
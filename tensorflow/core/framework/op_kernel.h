@@ -642,6 +642,10 @@ class OpKernelContext {
     // Session configuration parameters. Can be nullptr.
     const ConfigProto* session_config = nullptr;
 
+    // If not null, serves this step's allocations that would otherwise come
+    // from the device's default allocator. Not owned.
+    Allocator* step_allocator = nullptr;
+
     // The session state for this op.
     SessionState* session_state = nullptr;
 
@@ -1296,6 +1300,11 @@ class OpKernelContext {
   // called.
   void maybe_initialize_scope_id_set();
 
+  // Returns true if an input could have been forwarded to output `index` of
+  // `type` and `shape` instead of allocating it.
+  bool CouldForwardInputToOutput(int index, DataType type,
+                                 const TensorShape& shape) const;
+
   Status status_;
   friend class CollectiveExecutor;  // for access to params_
   Params* params_;                  // not owned
@@ -1497,6 +1506,15 @@ class Name : public KernelDefBuilder {
   TF_ATTRIBUTE_ANNOTATE("tf:kernel:system")                 \
   REGISTER_KERNEL_BUILDER_IMPL(kernel_builder, true, __VA_ARGS__)
 
+// Enables or disables auditing output allocations. When enabled,
+// OpKernelContext::allocate_output counts, per op type, the outputs allocated
+// although an input of the same type and size had no other reference and
+// could have been forwarded. The counts are exported as
+// /tensorflow/core/unforwarded_output_allocations and are an upper bound, since
+// some kernels cannot run in place. Auditing can also be enabled by setting
+// TF_AUDIT_OUTPUT_FORWARDING=1.
+void SetOutputForwardingAuditEnabled(bool enabled);
+
 // Checks whether a given kernel is registered on device_type.
 bool KernelDefAvailable(const DeviceType& device_type, const NodeDef& node_def);
 
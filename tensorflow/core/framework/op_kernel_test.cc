@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -533,6 +534,49 @@ TEST_F(OpKernelTest, AllocateOutput) {
   EXPECT_THAT(s.message(), ::testing::ContainsRegex("bad index=1"));
 }
 
+TEST_F(OpKernelTest, AuditsUnforwardedOutputAllocations) {
+  monitoring::testing::CellReader<int64_t> unforwarded_allocations(
+      "/tensorflow/core/unforwarded_output_allocations");
+  SetOutputForwardingAuditEnabled(true);
+  Env* env = Env::Default();
+  DummyDevice device(env);
+  Status status;
+  std::unique_ptr<OpKernel> op(CreateOpKernel(
+      DEVICE_CPU, &device, cpu_allocator(), CreateNodeDef("Test4", {DT_FLOAT}),
+      TF_GRAPH_DEF_VERSION, &status));
+  TF_ASSERT_OK(status);
+  // Allocates output 0 of `shape` with `input` as the only input.
+  auto allocate_output = [&](Tensor* input, const TensorShape& shape) {
+    OpKernelContext::Params params;
+    params.device = &device;
+    params.op_kernel = op.get();
+    absl::InlinedVector<TensorValue, 4> inputs{TensorValue(input)};
+    params.inputs = inputs;
+    OpKernelContext ctx(&params);
+    Tensor* output = nullptr;
+    TF_ASSERT_OK(ctx.allocate_output(0, shape, &output));
+  };
+
+  // The input has no other reference, so it could have been forwarded.
+  Tensor input(DT_FLOAT, TensorShape({4}));
+  allocate_output(&input, TensorShape({2, 2}));
+  EXPECT_EQ(unforwarded_allocations.Delta("Test4"), 1);
+
+  // The output has another number of elements.
+  allocate_output(&input, TensorShape({2}));
+  EXPECT_EQ(unforwarded_allocations.Delta("Test4"), 0);
+
+  // The input buffer is shared.
+  Tensor shared = input;
+  allocate_output(&input, TensorShape({4}));
+  EXPECT_EQ(unforwarded_allocations.Delta("Test4"), 0);
+
+  SetOutputForwardingAuditEnabled(false);
+  Tensor other_input(DT_FLOAT, TensorShape({4}));
+  allocate_output(&other_input, TensorShape({4}));
+  EXPECT_EQ(unforwarded_allocations.Delta("Test4"), 0);
+}
+
 // A mock device that mimics the behavior of scoped allocator upon calling
 // GetAllocator with a positive scope_id.
 class ScopedAllocatorDevice : public DeviceBase {
@@ -627,6 +671,65 @@ TEST_F(OpKernelTest, ScopedAllocationTest) {
   EXPECT_EQ(sa_device->num_allocations(true), 1);
 }
 
+// Records whether the last allocation was marked short-lived.
+class ShortLivedRecordingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "short_lived_recording"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    last_short_lived_ = allocation_attr.short_lived;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  bool last_short_lived() const { return last_short_lived_; }
+
+ private:
+  bool last_short_lived_ = false;
+};
+
+class ShortLivedRecordingDevice : public DeviceBase {
+ public:
+  explicit ShortLivedRecordingDevice(Env* env) : DeviceBase(env) {}
+  Allocator* GetAllocator(AllocatorAttributes /*attrs*/) override {
+    return &allocator_;
+  }
+
+  ShortLivedRecordingAllocator allocator_;
+};
+
+// Temporaries may be kept by the kernel or returned as outputs, so only
+// callers that know them to be scratch space mark them as short-lived.
+TEST_F(OpKernelTest, AllocateTempIsShortLivedOnlyOnRequest) {
+  Env* env = Env::Default();
+  OpKernelContext::Params params;
+  ShortLivedRecordingDevice device(env);
+  params.device = &device;
+  Status status;
+  std::unique_ptr<OpKernel> op(CreateOpKernel(
+      DEVICE_CPU, params.device, cpu_allocator(),
+      CreateNodeDef("Test4", {DT_FLOAT}), TF_GRAPH_DEF_VERSION, &status));
+  TF_ASSERT_OK(status);
+  params.op_kernel = op.get();
+  OpKernelContext ctx(&params);
+
+  Tensor temp;
+  TF_EXPECT_OK(ctx.allocate_temp(DT_FLOAT, TensorShape({8}), &temp));
+  EXPECT_FALSE(device.allocator_.last_short_lived());
+
+  AllocationAttributes allocation_attr;
+  allocation_attr.short_lived = true;
+  Tensor scratch;
+  TF_EXPECT_OK(ctx.allocate_temp(DT_FLOAT, TensorShape({8}), &scratch,
+                                 AllocatorAttributes(), allocation_attr));
+  EXPECT_TRUE(device.allocator_.last_short_lived());
+}
+
 TEST_F(OpKernelTest, TraceString) {
   Env* env = Env::Default();
   OpKernelContext::Params params;
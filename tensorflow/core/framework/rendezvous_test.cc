@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <vector>
+
 #include "absl/status/status.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/cancellation.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -356,6 +359,90 @@ TEST_F(LocalRendezvousTest, MultiSends) {
   }
 }
 
+TEST_F(LocalRendezvousTest, MultiSendsMixedRecvs) {
+  // Interleaves receivers with and without a cancellation manager, which take
+  // different internal paths, and checks that values arrive in send order.
+  static const int N = 10;
+  const auto& key_foo = KeyFoo();
+  CancellationManager cm;
+  for (int i = 0; i < N; ++i) {
+    TF_ASSERT_OK(rendez_->Send(key_foo, Rendezvous::Args(),
+                               V(strings::StrCat(i)), false));
+  }
+  for (int i = 0; i < N; ++i) {
+    Rendezvous::Args args;
+    if (i % 3 == 0) args.cancellation_manager = &cm;
+    Tensor val;
+    bool val_dead;
+    TF_ASSERT_OK(rendez_->Recv(key_foo, args, &val, &val_dead));
+    EXPECT_EQ(strings::StrCat(i), V(val));
+  }
+  // Queue the receivers first this time.
+  BlockingState state;
+  state.counter = N;
+  int next = 0;
+  for (int i = 0; i < N; ++i) {
+    Rendezvous::Args args;
+    if (i % 3 == 1) args.cancellation_manager = &cm;
+    rendez_->RecvAsync(
+        key_foo, args,
+        [&state, &next, i](const Status& s, const Rendezvous::Args& send_args,
+                           const Rendezvous::Args& recv_args, const Tensor& v,
+                           const bool dead) {
+          TF_EXPECT_OK(s);
+          EXPECT_EQ(strings::StrCat(i), V(v));
+          EXPECT_EQ(next++, i);
+          mutex_lock l(state.lock);
+          if (--state.counter == 0) state.done.Notify();
+        });
+  }
+  for (int i = 0; i < N; ++i) {
+    TF_ASSERT_OK(rendez_->Send(key_foo, Rendezvous::Args(),
+                               V(strings::StrCat(i)), false));
+  }
+  state.done.WaitForNotification();
+}
+
+TEST_F(LocalRendezvousTest, ConcurrentSendRecvManyKeys) {
+  // Uses more keys than the rendezvous has lock-free slots, from several
+  // threads at once.
+  static const int kNumKeys = 200;
+  static const int kNumRounds = 20;
+  BlockingState state;
+  state.counter = kNumKeys;
+  for (int k = 0; k < kNumKeys; ++k) {
+    SchedClosure([this, &state, k]() {
+      const Rendezvous::ParsedKey key = MakeKey(strings::StrCat("key", k));
+      for (int i = 0; i < kNumRounds; ++i) {
+        TF_ASSERT_OK(rendez_->Send(key, Rendezvous::Args(),
+                                   V(strings::StrCat(k, ":", i)), false));
+      }
+      for (int i = 0; i < kNumRounds; ++i) {
+        Tensor val;
+        bool val_dead;
+        TF_ASSERT_OK(rendez_->Recv(key, Rendezvous::Args(), &val, &val_dead));
+        EXPECT_EQ(strings::StrCat(k, ":", i), V(val));
+      }
+      mutex_lock l(state.lock);
+      if (--state.counter == 0) state.done.Notify();
+    });
+  }
+  state.done.WaitForNotification();
+}
+
+TEST_F(LocalRendezvousTest, AbortWithPendingRecvAsync) {
+  Notification n;
+  rendez_->RecvAsync(KeyFoo(), Rendezvous::Args(),
+                     [&n](const Status& s, const Rendezvous::Args& send_args,
+                          const Rendezvous::Args& recv_args, const Tensor& v,
+                          const bool dead) {
+                       EXPECT_TRUE(absl::IsAborted(s));
+                       n.Notify();
+                     });
+  rendez_->StartAbort(errors::Aborted(""));
+  n.WaitForNotification();
+}
+
 TEST_F(LocalRendezvousTest, RecvAbort) {
   rendez_->Ref();
   SchedClosure([this]() {
@@ -519,5 +606,41 @@ void BM_PingPong(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PingPong)->Arg(100)->Arg(200)->Arg(300);
 
+void BM_ConcurrentSendRecv(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const int messages_count = 1000;
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", num_threads);
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_threads; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+
+  // Each thread repeatedly sends and receives on its own key, so threads only
+  // share the rendezvous itself.
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    BlockingCounter counter(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      pool->Schedule([rendez, &keys, &counter, i, messages_count]() {
+        Tensor orig = V("val");
+        Tensor val(DT_STRING, TensorShape({}));
+        bool is_dead = false;
+        Rendezvous::Args args;
+        for (int j = 0; j < messages_count; ++j) {
+          TF_CHECK_OK(rendez->Send(keys[i], args, orig, is_dead));
+          TF_CHECK_OK(rendez->Recv(keys[i], args, &val, &is_dead));
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    rendez->Unref();
+  }
+  state.SetItemsProcessed(num_threads * messages_count * state.iterations());
+  delete pool;
+}
+BENCHMARK(BM_ConcurrentSendRecv)->Arg(1)->Arg(4)->Arg(16);
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <array>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <variant>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/types/variant.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -41,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tsl/platform/mutex_contention.h"
 
 namespace tensorflow {
 
@@ -55,6 +58,10 @@ namespace tensorflow {
 // All resources for a given container can be dropped by one call of
 // Cleanup().
 //
+// Resources are sharded by container and resource name, so that lookups of
+// different resources, e.g. the tables and variables of a serving model, do not
+// contend on the same lock.
+//
 // E.g.,
 //   struct MyVar : public ResourceBase {
 //     mutex mu;
@@ -195,9 +202,9 @@ class ResourceMgr {
   Status Lookup(const ResourceHandle& handle,
                 ResourceBase** resource) const TF_MUST_USE_RESULT;
 
-  // Similar to Lookup, but looks up multiple resources at once, with only a
-  // single lock acquisition.  If containers_and_names[i] is uninitialized
-  // then this function does not modify resources[i].
+  // Similar to Lookup, but looks up multiple resources at once.  If
+  // containers_and_names[i] is uninitialized then this function does not
+  // modify resources[i].
   template <typename T, bool use_dynamic_cast = false>
   Status LookupMany(absl::Span<std::pair<const string*, const string*> const>
                         containers_and_names,
@@ -273,31 +280,56 @@ class ResourceMgr {
   typedef absl::flat_hash_map<Key, ResourceAndName, KeyHash, KeyEqual>
       Container;
 
+  // The resources whose container and name hash to one shard. A container
+  // has an entry in each shard that holds some of its resources.
+  struct Shard {
+    mutable mutex mu;
+    absl::flat_hash_map<string, Container*> containers TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumShards = 16;
+
+  // Contention profiling sites for lookups and for updates of the shards.
+  static tsl::MutexContentionSite& lookup_contention_site();
+  static tsl::MutexContentionSite& update_contention_site();
+
+  // Returns the shard of resource `name` in `container`.
+  Shard& GetShard(const std::string& container, const std::string& name);
+  const Shard& GetShard(const std::string& container,
+                        const std::string& name) const;
+
+  // Returns true if any shard has resources in `container`.
+  bool ContainerExists(const std::string& container) const
+      TF_LOCKS_EXCLUDED(container_names_mu_);
+
   const std::string default_container_;
-  mutable mutex mu_;
-  absl::flat_hash_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
+  std::array<Shard, kNumShards> shards_;
+
+  // Names of the containers in any shard, so that lookups can tell a missing
+  // container from a missing resource. Only used when creating resources,
+  // cleaning up containers and failing lookups.
+  mutable mutex container_names_mu_;
+  absl::flat_hash_set<string> container_names_
+      TF_GUARDED_BY(container_names_mu_);
 
   template <typename T, bool use_dynamic_cast = false>
-  Status LookupInternal(const std::string& container, const std::string& name,
-                        T** resource) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
-  Status LookupInternal(const std::string& container, uint64 type_hash_code,
-                        const std::string& name, ResourceBase** resource) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
-
-  Status DoCreate(const std::string& container, TypeIndex type,
+  Status LookupInternal(const Shard& shard, const std::string& container,
+                        const std::string& name, T** resource) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
+
+  Status DoCreate(Shard& shard, const std::string& container, TypeIndex type,
                   const std::string& name, ResourceBase* resource,
                   bool owns_resource)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
 
-  Status DoLookup(const std::string& container, TypeIndex type,
-                  const std::string& name, ResourceBase** resource) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
-  Status DoLookup(const std::string& container, uint64 type_hash_code,
-                  const std::string& type_name,
+  Status DoLookup(const Shard& shard, const std::string& container,
+                  TypeIndex type, const std::string& name,
+                  ResourceBase** resource) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
+  Status DoLookup(const Shard& shard, const std::string& container,
+                  uint64 type_hash_code, const std::string& type_name,
                   const std::string& resource_name,
                   ResourceBase** resource) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) TF_MUST_USE_RESULT;
 
   Status DoDelete(const std::string& container, uint64 type_hash_code,
                   const std::string& resource_name,
@@ -313,16 +345,18 @@ class ResourceMgr {
       ResourceAndName& resource_and_name) TF_MUST_USE_RESULT;
   // Inserts the type name for 'hash_code' into the hash_code to type name map.
   Status InsertDebugTypeName(uint64 hash_code, const std::string& type_name)
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+      TF_LOCKS_EXCLUDED(debug_type_names_mu_) TF_MUST_USE_RESULT;
 
   // Returns the type name for the 'hash_code'.
   // Returns "<unknown>" if a resource with such a type was never inserted into
   // the container.
   const char* DebugTypeName(uint64 hash_code) const
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+      TF_LOCKS_EXCLUDED(debug_type_names_mu_);
 
   // Map from type hash_code to type name.
-  std::unordered_map<uint64, string> debug_type_names_ TF_GUARDED_BY(mu_);
+  mutable mutex debug_type_names_mu_;
+  std::unordered_map<uint64, string> debug_type_names_
+      TF_GUARDED_BY(debug_type_names_mu_);
 
   ResourceMgr(const ResourceMgr&) = delete;
   void operator=(const ResourceMgr&) = delete;
@@ -641,8 +675,9 @@ Status ResourceMgr::Create(const std::string& container,
                            const std::string& name, T* resource) {
   CheckDeriveFromResourceBase<T>();
   CHECK(resource != nullptr);
-  mutex_lock l(mu_);
-  return DoCreate(container, TypeIndex::Make<T>(), name, resource,
+  Shard& shard = GetShard(container, name);
+  tsl::profiled_mutex_lock l(shard.mu, update_contention_site());
+  return DoCreate(shard, container, TypeIndex::Make<T>(), name, resource,
                   /* owns_resource */ true);
 }
 
@@ -650,8 +685,9 @@ template <typename T>
 Status ResourceMgr::CreateUnowned(const std::string& container,
                                   const std::string& name, T* resource) {
   CheckDeriveFromResourceBase<T>();
-  mutex_lock l(mu_);
-  return DoCreate(container, TypeIndex::Make<T>(), name, resource,
+  Shard& shard = GetShard(container, name);
+  tsl::profiled_mutex_lock l(shard.mu, update_contention_site());
+  return DoCreate(shard, container, TypeIndex::Make<T>(), name, resource,
                   /* owns_resource */ false);
 }
 
@@ -659,8 +695,9 @@ template <typename T, bool use_dynamic_cast>
 Status ResourceMgr::Lookup(const std::string& container,
                            const std::string& name, T** resource) const {
   CheckDeriveFromResourceBase<T>();
-  tf_shared_lock l(mu_);
-  return LookupInternal<T, use_dynamic_cast>(container, name, resource);
+  const Shard& shard = GetShard(container, name);
+  tsl::profiled_shared_lock l(shard.mu, lookup_contention_site());
+  return LookupInternal<T, use_dynamic_cast>(shard, container, name, resource);
 }
 
 template <typename T, bool use_dynamic_cast>
@@ -669,13 +706,15 @@ Status ResourceMgr::LookupMany(
         containers_and_names,
     std::vector<core::RefCountPtr<T>>* resources) const {
   CheckDeriveFromResourceBase<T>();
-  tf_shared_lock l(mu_);
   resources->resize(containers_and_names.size());
   for (size_t i = 0; i < containers_and_names.size(); ++i) {
+    const std::string& container = *containers_and_names[i].first;
+    const std::string& name = *containers_and_names[i].second;
+    const Shard& shard = GetShard(container, name);
+    tsl::profiled_shared_lock l(shard.mu, lookup_contention_site());
     T* resource;
-    Status s = LookupInternal<T, use_dynamic_cast>(
-        *containers_and_names[i].first, *containers_and_names[i].second,
-        &resource);
+    Status s =
+        LookupInternal<T, use_dynamic_cast>(shard, container, name, &resource);
     if (s.ok()) {
       (*resources)[i].reset(resource);
     }
@@ -695,11 +734,12 @@ struct TypeCastFunctor<T, true> {
 };
 
 template <typename T, bool use_dynamic_cast>
-Status ResourceMgr::LookupInternal(const std::string& container,
+Status ResourceMgr::LookupInternal(const Shard& shard,
+                                   const std::string& container,
                                    const std::string& name,
                                    T** resource) const {
   ResourceBase* found = nullptr;
-  Status s = DoLookup(container, TypeIndex::Make<T>(), name, &found);
+  Status s = DoLookup(shard, container, TypeIndex::Make<T>(), name, &found);
   if (s.ok()) {
     // It's safe to down cast 'found' to T* since
     // typeid(T).hash_code() is part of the map key.
@@ -715,16 +755,17 @@ Status ResourceMgr::LookupOrCreate(const std::string& container,
   CheckDeriveFromResourceBase<T>();
   *resource = nullptr;
   Status s;
+  Shard& shard = GetShard(container, name);
   {
-    tf_shared_lock l(mu_);
-    s = LookupInternal<T, use_dynamic_cast>(container, name, resource);
+    tsl::profiled_shared_lock l(shard.mu, lookup_contention_site());
+    s = LookupInternal<T, use_dynamic_cast>(shard, container, name, resource);
     if (s.ok()) return s;
   }
-  mutex_lock l(mu_);
-  s = LookupInternal<T, use_dynamic_cast>(container, name, resource);
+  tsl::profiled_mutex_lock l(shard.mu, update_contention_site());
+  s = LookupInternal<T, use_dynamic_cast>(shard, container, name, resource);
   if (s.ok()) return s;
   TF_RETURN_IF_ERROR(creator(resource));
-  s = DoCreate(container, TypeIndex::Make<T>(), name, *resource,
+  s = DoCreate(shard, container, TypeIndex::Make<T>(), name, *resource,
                /* owns_resource */ true);
   if (!s.ok()) {
     return errors::Internal("LookupOrCreate failed unexpectedly");
@@ -828,8 +869,7 @@ Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
   return absl::OkStatus();
 }
 
-// Similar to Lookup, but looks up multiple resources at once, with only a
-// single lock acquisition.
+// Similar to Lookup, but looks up multiple resources at once.
 template <typename T>
 Status LookupResources(OpKernelContext* ctx,
                        absl::Span<ResourceHandle const* const> p,
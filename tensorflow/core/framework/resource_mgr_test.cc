@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -213,6 +215,40 @@ TEST(ResourceMgrTest, CreateUnowned) {
   EXPECT_TRUE(kitty->RefCountIsOne());
 }
 
+TEST(ResourceMgrTest, ManyResourcesInOneContainer) {
+  // Enough resources for the container to span all shards.
+  constexpr int kNumResources = 100;
+  ResourceMgr rm;
+  std::vector<string> names;
+  for (int i = 0; i < kNumResources; ++i) {
+    names.push_back(strings::StrCat("name", i));
+    TF_CHECK_OK(
+        rm.Create("foo", names.back(), new Resource(strings::StrCat(i))));
+  }
+
+  std::vector<std::pair<const string*, const string*>> containers_and_names;
+  const string container = "foo";
+  for (const string& name : names) {
+    containers_and_names.push_back({&container, &name});
+  }
+  std::vector<core::RefCountPtr<Resource>> resources;
+  TF_CHECK_OK(rm.LookupMany(containers_and_names, &resources));
+  ASSERT_EQ(resources.size(), names.size());
+  for (int i = 0; i < kNumResources; ++i) {
+    ASSERT_NE(resources[i], nullptr);
+    EXPECT_EQ(resources[i]->DebugString(), strings::StrCat("R/", i));
+  }
+  resources.clear();
+
+  HasError(FindErr<Resource>(rm, "foo", "xxx"), error::NOT_FOUND,
+           "Resource foo/xxx");
+  TF_CHECK_OK(rm.Cleanup("foo"));
+  for (const string& name : names) {
+    HasError(FindErr<Resource>(rm, "foo", name), error::NOT_FOUND,
+             "Container foo");
+  }
+}
+
 TEST(ResourceMgrTest, CreateOrLookup) {
   ResourceMgr rm;
   EXPECT_EQ("R/cat", LookupOrCreate<Resource>(&rm, "foo", "bar", "cat"));
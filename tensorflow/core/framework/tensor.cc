@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -159,15 +160,141 @@ class Buffer : public BufferBase {
   void operator=(const Buffer&) = delete;
 };
 
-void LogUnexpectedSize(int64_t actual, int64_t expected) {
-  LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
-}
-
 bool MemoryLoggingEnabled() {
   static bool memory_logging_enabled = LogMemory::IsEnabled();
   return memory_logging_enabled;
 }
 
+// Tensors of simple types whose data fits in kSmallTensorBytes and that are
+// allocated with the default CPU allocator are stored inline in a
+// SmallTensorBuffer. Freed buffers are kept on a per-thread free list, so
+// creating scalar and shape tensors does not go through the allocator.
+constexpr size_t kSmallTensorBytes = 64;
+constexpr int kMaxFreeSmallTensorBuffers = 256;
+
+// A singly linked list of the blocks of freed SmallTensorBuffers. It is
+// trivially destructible so that it remains usable while the other
+// thread-local objects of an exiting thread are destroyed.
+struct SmallTensorFreeList {
+  void* head = nullptr;
+  int size = 0;
+  // Whether the SmallTensorFreeListReleaser of the thread was created.
+  bool has_releaser = false;
+};
+thread_local SmallTensorFreeList small_tensor_free_list;
+
+// Frees the blocks on the free list of an exiting thread.
+struct SmallTensorFreeListReleaser {
+  ~SmallTensorFreeListReleaser() {
+    SmallTensorFreeList& list = small_tensor_free_list;
+    while (list.head != nullptr) {
+      void* block = list.head;
+      list.head = *static_cast<void**>(block);
+      port::AlignedFree(block);
+    }
+    // Buffers freed later by this thread go back to the heap.
+    list.size = kMaxFreeSmallTensorBuffers;
+  }
+};
+
+// Returns the free list of the calling thread, whose blocks are freed when the
+// thread exits. Buffers may be freed on other threads than the ones that
+// created them, so both creating and freeing a buffer go through this.
+SmallTensorFreeList& GetSmallTensorFreeList() {
+  SmallTensorFreeList& list = small_tensor_free_list;
+  if (!list.has_releaser) {
+    // Not reset by the releaser, so that it is not created again once
+    // destroyed.
+    list.has_releaser = true;
+    thread_local SmallTensorFreeListReleaser releaser;
+    (void)releaser;
+  }
+  return list;
+}
+
+class SmallTensorBuffer : public TensorBuffer {
+ public:
+  // Returns a buffer of `size` <= kSmallTensorBytes uninitialized bytes.
+  static SmallTensorBuffer* New(size_t size) {
+    SmallTensorFreeList& list = GetSmallTensorFreeList();
+    void* block = list.head;
+    if (block != nullptr) {
+      list.head = *static_cast<void**>(block);
+      --list.size;
+    } else {
+      block = port::AlignedMalloc(sizeof(SmallTensorBuffer),
+                                  alignof(SmallTensorBuffer));
+    }
+    return new (block) SmallTensorBuffer(size);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("SmallTensorBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+  // Called by `delete this` in `core::RefCounted::Unref()`. Returns the block
+  // to the free list of the calling thread.
+  static void operator delete(void* ptr) {
+    SmallTensorFreeList& list = GetSmallTensorFreeList();
+    if (list.size >= kMaxFreeSmallTensorBuffers) {
+      port::AlignedFree(ptr);
+      return;
+    }
+    *static_cast<void**>(ptr) = list.head;
+    list.head = ptr;
+    ++list.size;
+  }
+
+  static void operator delete(void*, void*) {
+    // Some compilers require an overridden class-specific deallocation
+    // function, which will be called if placement `new` throws an exception.
+  }
+
+ private:
+  explicit SmallTensorBuffer(size_t size)
+      : TensorBuffer(inline_data_), size_(size) {}
+  ~SmallTensorBuffer() override {}
+
+  const size_t size_;
+  alignas(EIGEN_MAX_ALIGN_BYTES) char inline_data_[kSmallTensorBytes];
+
+  SmallTensorBuffer(const SmallTensorBuffer&) = delete;
+  void operator=(const SmallTensorBuffer&) = delete;
+};
+
+// Returns true if a tensor of `type` with `num_elements` elements allocated
+// with `a` should use a SmallTensorBuffer.
+bool UseSmallTensorBuffer(Allocator* a, Allocator* default_cpu_allocator,
+                          DataType type, int64_t num_elements) {
+  if (a != default_cpu_allocator || num_elements <= 0 ||
+      !DataTypeCanUseMemcpy(type)) {
+    return false;
+  }
+  const int type_size = DataTypeSize(type);
+  if (type_size <= 0 ||
+      num_elements > static_cast<int64_t>(kSmallTensorBytes / type_size)) {
+    return false;
+  }
+  // Allocations must remain visible to memory logging and allocator stats.
+  return !MemoryLoggingEnabled() && !CPUAllocatorStatsEnabled();
+}
+
+void LogUnexpectedSize(int64_t actual, int64_t expected) {
+  LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
+}
+
+
 // A set of helper functions depending on T.
 template <typename T>
 struct Helper {
@@ -964,10 +1091,29 @@ int Tensor::RefCount() const {
   CASES_WITH_DEFAULT(TYPE_ENUM, STMTS, LOG(FATAL) << "Type not set"; \
                      , LOG(FATAL) << "Unexpected type: " << TYPE_ENUM;)
 
+// NOTE(mrry): The default allocator for a Tensor (when none is specified) is
+// the default CPU allocator for NUMA zone 0. Accessing that currently involves
+// acquiring a lock, which guards initialization of the per-NUMA zone
+// allocators, and becomes highly contended.
+//
+// Note also that it would be better if all Tensor allocations required the user
+// to specify an allocator, for purposes of accounting, etc. However, the
+// default allocator is widely used throughout the codebase and in client code.
+static Allocator* get_default_cpu_allocator() {
+  static Allocator* default_cpu_allocator =
+      cpu_allocator(tsl::port::kNUMANoAffinity);
+  return default_cpu_allocator;
+}
+
 Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
+  if (UseSmallTensorBuffer(a, get_default_cpu_allocator(), type,
+                           shape_.num_elements())) {
+    buf_ = SmallTensorBuffer::New(shape_.num_elements() * DataTypeSize(type));
+    return;
+  }
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
   }
@@ -1002,20 +1148,6 @@ Status Tensor::BuildTensor(DataType type, const TensorShape& shape,
   return absl::OkStatus();
 }
 
-// NOTE(mrry): The default allocator for a Tensor (when none is specified) is
-// the default CPU allocator for NUMA zone 0. Accessing that currently involves
-// acquiring a lock, which guards initialization of the per-NUMA zone
-// allocators, and becomes highly contended.
-//
-// Note also that it would be better if all Tensor allocations required the user
-// to specify an allocator, for purposes of accounting, etc. However, the
-// default allocator is widely used throughout the codebase and in client code.
-static Allocator* get_default_cpu_allocator() {
-  static Allocator* default_cpu_allocator =
-      cpu_allocator(tsl::port::kNUMANoAffinity);
-  return default_cpu_allocator;
-}
-
 Tensor::Tensor(DataType type, const TensorShape& shape)
     : Tensor(get_default_cpu_allocator(), type, shape) {}
 
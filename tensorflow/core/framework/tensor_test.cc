@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -1043,6 +1044,53 @@ TEST(Tensor_Scalar, Basics) {
   }
 }
 
+TEST(Tensor_SmallTensor, Basics) {
+  TensorDescription description;
+  const void* data = nullptr;
+  {
+    Tensor t(DT_INT64, TensorShape({8}));
+    EXPECT_TRUE(t.IsAligned());
+    auto Tt = t.vec<int64_t>();
+    for (int i = 0; i < 8; ++i) Tt(i) = i * 10;
+    Tensor slice = t.Slice(2, 4);
+    EXPECT_EQ(20, slice.vec<int64_t>()(0));
+    EXPECT_EQ(30, slice.vec<int64_t>()(1));
+    t.FillDescription(&description);
+    EXPECT_EQ("SmallTensorBuffer",
+              description.allocation_description().allocator_name());
+    data = t.tensor_data().data();
+  }
+  {
+    // The freed buffer is reused by the next small tensor of this thread.
+    Tensor t(DT_FLOAT, TensorShape({}));
+    EXPECT_EQ(data, t.tensor_data().data());
+  }
+  {
+    // Tensors larger than 64 bytes, and tensors of non-simple types, use the
+    // allocator.
+    Tensor t(DT_INT64, TensorShape({9}));
+    t.FillDescription(&description);
+    EXPECT_NE("SmallTensorBuffer",
+              description.allocation_description().allocator_name());
+    Tensor s(DT_STRING, TensorShape({1}));
+    s.FillDescription(&description);
+    EXPECT_NE("SmallTensorBuffer",
+              description.allocation_description().allocator_name());
+  }
+}
+
+TEST(Tensor_SmallTensor, FreedOnAnotherThread) {
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < 10; ++i) tensors.emplace_back(DT_INT32, TensorShape({}));
+  // The buffers go on the free list of the thread, which frees them when it
+  // exits.
+  std::thread thread([&tensors] { tensors.clear(); });
+  thread.join();
+  Tensor t(DT_INT32, TensorShape({}));
+  t.scalar<int32>()() = 7;
+  EXPECT_EQ(7, t.scalar<int32>()());
+}
+
 TEST(Tensor_HostScalar, Basics) {
   {
     Tensor t(true);
@@ -1955,6 +2003,16 @@ void BM_CreateAndDestroyHostScalarOptimized(
 }
 BENCHMARK(BM_CreateAndDestroyHostScalarOptimized);
 
+// Benchmark creating and destroying a small shape tensor.
+void BM_CreateAndDestroySmallTensor(::testing::benchmark::State& state) {
+  TensorShape shape({4});
+  for (auto s : state) {
+    Tensor a(DT_INT32, shape);
+    a.vec<int32>()(0) = 37;
+  }
+}
+BENCHMARK(BM_CreateAndDestroySmallTensor);
+
 void BM_FromProto(::testing::benchmark::State& state) {
   const int size = state.range(0);
 
@@ -46,6 +46,11 @@ class GraphMemory {
   Status InferStatically(
       const std::unordered_map<string, DeviceProperties>& devices);
   Status InferDynamically(Cluster* cluster);
+  // Infers the memory usage from the trace of a step that already ran, e.g.
+  // the step stats of a session run with RunOptions::FULL_TRACE.
+  void InferFromStepStats(const StepStats& step_stats) {
+    InferFromTrace(step_stats);
+  }
 
   // Worst case memory usage in bytes, or -1 if the usage is unknown. If there
   // are multiple devices, returns the highest per device memory usage.
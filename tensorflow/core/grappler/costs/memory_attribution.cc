@@ -0,0 +1,218 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/memory_attribution.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/graph_memory.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr double kMiB = 1 << 20;
+
+bool IsGpuDevice(const std::string& device) {
+  return absl::StrContains(device, "GPU:") || absl::StrContains(device, "gpu:");
+}
+
+std::string Suggestion(const MemoryContributor& contributor,
+                       const std::string& device,
+                       const MemoryAttributionOptions& options) {
+  if (contributor.bytes < options.min_suggestion_bytes ||
+      contributor.lifetime_fraction <
+          options.min_suggestion_lifetime_fraction) {
+    return "";
+  }
+  const double micros_per_mib =
+      contributor.compute_micros / (contributor.bytes / kMiB);
+  if (micros_per_mib <= options.max_recompute_micros_per_mib) {
+    return absl::StrFormat(
+        "recompute: cheap to produce (%.1fus/MiB); set the _recompute_hint "
+        "attr on %s and enable the memory optimizer's recomputation",
+        micros_per_mib, contributor.node);
+  }
+  if (IsGpuDevice(device)) {
+    return absl::StrFormat(
+        "swap to host: set the _swap_to_host attr on its consumers to the "
+        "inputs reading %s:%d",
+        contributor.node, contributor.output_id);
+  }
+  return "";
+}
+
+}  // namespace
+
+Status AttributePeakMemory(const GraphDef& graph, const StepStats& step_stats,
+                           const MemoryAttributionOptions& options,
+                           std::vector<DeviceMemoryReport>* reports) {
+  reports->clear();
+  if (step_stats.dev_stats_size() == 0) {
+    return errors::InvalidArgument(
+        "The step stats are empty; run the step with RunOptions::FULL_TRACE.");
+  }
+
+  std::unordered_map<std::string, const NodeDef*> node_map;
+  for (const NodeDef& node : graph.node()) {
+    node_map[node.name()] = &node;
+  }
+  auto op_of = [&](const std::string& node_name) -> std::string {
+    auto it = node_map.find(node_name);
+    return it == node_map.end() ? "" : it->second->op();
+  };
+
+  int64_t step_start_micros = std::numeric_limits<int64_t>::max();
+  int64_t step_end_micros = 0;
+  std::unordered_map<std::string, int64_t> compute_micros;
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      step_start_micros =
+          std::min(step_start_micros, node_stats.all_start_micros());
+      step_end_micros =
+          std::max(step_end_micros, node_stats.all_start_micros() +
+                                        node_stats.all_end_rel_micros());
+      int64_t& micros = compute_micros[node_stats.node_name()];
+      micros = std::max(micros, node_stats.op_end_rel_micros() -
+                                    node_stats.op_start_rel_micros());
+    }
+  }
+  const double step_micros =
+      std::max<int64_t>(1, step_end_micros - step_start_micros);
+
+  GrapplerItem item;
+  item.graph = graph;
+  GraphMemory memory(item);
+  memory.InferFromStepStats(step_stats);
+
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    DeviceMemoryReport report;
+    report.device = dev_stats.device();
+
+    std::unordered_map<std::string, OpMemoryPeak> op_peaks;
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      int64_t peak_bytes = 0;
+      for (const AllocatorMemoryUsed& used : node_stats.memory()) {
+        peak_bytes += used.peak_bytes();
+        report.allocator_peak_bytes = std::max(report.allocator_peak_bytes,
+                                               used.allocator_bytes_in_use());
+      }
+      if (peak_bytes == 0) continue;
+      OpMemoryPeak& op_peak = op_peaks[node_stats.node_name()];
+      op_peak.node = node_stats.node_name();
+      op_peak.op = op_of(node_stats.node_name());
+      op_peak.peak_bytes = std::max(op_peak.peak_bytes, peak_bytes);
+      op_peak.temp_bytes = std::max(
+          op_peak.temp_bytes, node_stats.memory_stats().temp_memory_size());
+    }
+    for (auto& op_peak : op_peaks) {
+      report.top_op_peaks.push_back(std::move(op_peak.second));
+    }
+    std::sort(report.top_op_peaks.begin(), report.top_op_peaks.end(),
+              [](const OpMemoryPeak& a, const OpMemoryPeak& b) {
+                return a.peak_bytes > b.peak_bytes ||
+                       (a.peak_bytes == b.peak_bytes && a.node < b.node);
+              });
+    if (report.top_op_peaks.size() > static_cast<size_t>(options.top_k)) {
+      report.top_op_peaks.resize(options.top_k);
+    }
+
+    const GraphMemory::MemoryUsage& usage =
+        memory.GetPeakMemoryUsage(report.device);
+    report.peak_bytes = std::max<int64_t>(0, usage.used_memory);
+    for (const GraphMemory::LiveTensor& live : usage.live_tensors) {
+      MemoryContributor contributor;
+      contributor.node = live.node;
+      contributor.op = op_of(live.node);
+      contributor.output_id = live.output_id;
+      contributor.bytes = live.memory_used;
+      const double lifetime_micros =
+          (live.deallocation_time - live.allocation_time).count() / 1e3;
+      contributor.lifetime_fraction =
+          std::min(1.0, lifetime_micros / step_micros);
+      contributor.compute_micros = compute_micros[live.node];
+      report.top_contributors.push_back(std::move(contributor));
+    }
+    std::sort(report.top_contributors.begin(), report.top_contributors.end(),
+              [](const MemoryContributor& a, const MemoryContributor& b) {
+                return a.bytes > b.bytes ||
+                       (a.bytes == b.bytes && a.node < b.node);
+              });
+    if (report.top_contributors.size() >
+        static_cast<size_t>(options.top_k)) {
+      report.top_contributors.resize(options.top_k);
+    }
+    for (MemoryContributor& contributor : report.top_contributors) {
+      contributor.suggestion = Suggestion(contributor, report.device, options);
+    }
+    reports->push_back(std::move(report));
+  }
+  std::sort(reports->begin(), reports->end(),
+            [](const DeviceMemoryReport& a, const DeviceMemoryReport& b) {
+              return a.device < b.device;
+            });
+  return absl::OkStatus();
+}
+
+std::string FormatMemoryReports(
+    const std::vector<DeviceMemoryReport>& reports) {
+  std::string output;
+  for (const DeviceMemoryReport& report : reports) {
+    absl::StrAppendFormat(
+        &output, "%s: peak %.2f MiB of op outputs, %.2f MiB in allocators\n",
+        report.device, report.peak_bytes / kMiB,
+        report.allocator_peak_bytes / kMiB);
+    if (!report.top_contributors.empty()) {
+      absl::StrAppend(&output, "  Tensors live at the peak:\n");
+    }
+    for (const MemoryContributor& contributor : report.top_contributors) {
+      absl::StrAppendFormat(
+          &output, "    %10.2f MiB %5.1f%% %s:%d (%s), live %.0f%% of step\n",
+          contributor.bytes / kMiB,
+          report.peak_bytes > 0 ? 100.0 * contributor.bytes / report.peak_bytes
+                                : 0.0,
+          contributor.node, contributor.output_id, contributor.op,
+          100 * contributor.lifetime_fraction);
+      if (!contributor.suggestion.empty()) {
+        absl::StrAppend(&output, "      -> ", contributor.suggestion, "\n");
+      }
+    }
+    if (!report.top_op_peaks.empty()) {
+      absl::StrAppend(&output, "  Largest allocation peaks per op:\n");
+    }
+    for (const OpMemoryPeak& op_peak : report.top_op_peaks) {
+      absl::StrAppendFormat(&output, "    %10.2f MiB %s (%s), %.2f MiB temp\n",
+                            op_peak.peak_bytes / kMiB, op_peak.node,
+                            op_peak.op, op_peak.temp_bytes / kMiB);
+    }
+  }
+  return output;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
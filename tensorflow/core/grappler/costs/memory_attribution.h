@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_MEMORY_ATTRIBUTION_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_MEMORY_ATTRIBUTION_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Attributes the peak memory of a step of a classic graph to the ops that
+// produced the tensors live at the peak, and suggests which of them to
+// recompute or swap to host memory.
+//
+// The step stats must come from a run with RunOptions::FULL_TRACE, which
+// tracks the allocations of each op with a `TrackingAllocator` and records the
+// size of their outputs.
+
+// A tensor live at the peak memory usage of a device.
+struct MemoryContributor {
+  std::string node;
+  std::string op;
+  int output_id = 0;
+  int64_t bytes = 0;
+  // Fraction of the step during which the tensor was live.
+  double lifetime_fraction = 0.0;
+  // Time the producing op took to compute the tensor.
+  int64_t compute_micros = 0;
+  // Suggested way of reducing the peak, or empty.
+  std::string suggestion;
+};
+
+// An op with a large peak of allocations while it ran, including the
+// temporary memory that is freed before it completes.
+struct OpMemoryPeak {
+  std::string node;
+  std::string op;
+  int64_t peak_bytes = 0;
+  int64_t temp_bytes = 0;
+};
+
+struct DeviceMemoryReport {
+  std::string device;
+  // Peak of the memory used by op outputs, inferred from their lifetimes.
+  int64_t peak_bytes = 0;
+  // Highest number of bytes in use in the device allocators after an op.
+  int64_t allocator_peak_bytes = 0;
+  // Largest tensors live at `peak_bytes`, largest first.
+  std::vector<MemoryContributor> top_contributors;
+  // Ops with the largest peak of allocations, largest first.
+  std::vector<OpMemoryPeak> top_op_peaks;
+};
+
+struct MemoryAttributionOptions {
+  // Number of contributors and op peaks to report per device.
+  int top_k = 10;
+  // Tensors smaller than this get no suggestion.
+  int64_t min_suggestion_bytes = 1 << 20;
+  // Tensors live for less than this fraction of the step get no suggestion.
+  double min_suggestion_lifetime_fraction = 0.5;
+  // Tensors whose producer computes them at this many microseconds per MiB or
+  // less are suggested for recomputation rather than swapping.
+  double max_recompute_micros_per_mib = 100.0;
+};
+
+// Computes a report per device of `step_stats`, sorted by device name.
+Status AttributePeakMemory(const GraphDef& graph, const StepStats& step_stats,
+                           const MemoryAttributionOptions& options,
+                           std::vector<DeviceMemoryReport>* reports);
+
+// Returns a human readable rendering of `reports`.
+std::string FormatMemoryReports(const std::vector<DeviceMemoryReport>& reports);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_MEMORY_ATTRIBUTION_H_
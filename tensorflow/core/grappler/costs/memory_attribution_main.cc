@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Prints the tensors live at the peak memory usage of a step of a classic
+// graph, the ops with the largest allocation peaks, and recomputation or
+// swapping suggestions.
+//
+// Example usage:
+//
+//   memory_attribution --run_metadata=/tmp/run_metadata.pb
+//
+// The RunMetadata must come from a `Session::Run` with
+// `RunOptions::FULL_TRACE` and `output_partition_graphs` set. Without
+// partition graphs, pass the graph that was run with --graph.
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/costs/memory_attribution.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+template <typename Proto>
+Status ReadProto(const std::string& path, Proto* proto) {
+  if (ReadBinaryProto(Env::Default(), path, proto).ok()) {
+    return absl::OkStatus();
+  }
+  return ReadTextProto(Env::Default(), path, proto);
+}
+
+int Run(int argc, char* argv[]) {
+  std::string run_metadata_path;
+  std::string graph_path;
+  int top_k = 10;
+  std::vector<Flag> flag_list = {
+      Flag("run_metadata", &run_metadata_path,
+           "RunMetadata of a step run with FULL_TRACE"),
+      Flag("graph", &graph_path,
+           "GraphDef that was run, if the RunMetadata has no partition graphs"),
+      Flag("top_k", &top_k, "number of tensors and ops to report per device"),
+  };
+  std::string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  port::InitMain(argv[0], &argc, &argv);
+  if (!parse_result || argc > 1 || run_metadata_path.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  RunMetadata run_metadata;
+  Status status = ReadProto(run_metadata_path, &run_metadata);
+  if (!status.ok()) {
+    LOG(ERROR) << "Reading " << run_metadata_path << " failed: " << status;
+    return -1;
+  }
+  GraphDef graph;
+  if (!graph_path.empty()) {
+    status = ReadProto(graph_path, &graph);
+    if (!status.ok()) {
+      LOG(ERROR) << "Reading " << graph_path << " failed: " << status;
+      return -1;
+    }
+  } else {
+    for (const GraphDef& partition : run_metadata.partition_graphs()) {
+      graph.mutable_node()->MergeFrom(partition.node());
+    }
+  }
+
+  MemoryAttributionOptions options;
+  options.top_k = top_k;
+  std::vector<DeviceMemoryReport> reports;
+  status = AttributePeakMemory(graph, run_metadata.step_stats(), options,
+                               &reports);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return -1;
+  }
+  std::cout << FormatMemoryReports(reports);
+  return 0;
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+int main(int argc, char* argv[]) {
+  return tensorflow::grappler::Run(argc, argv);
+}
@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/memory_attribution.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kGpu[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+constexpr int64_t kMiB = 1 << 20;
+
+void AddNode(const std::string& name, const std::vector<std::string>& inputs,
+             GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Identity");
+  node->set_device(kGpu);
+  for (const std::string& input : inputs) node->add_input(input);
+}
+
+NodeExecStats* AddNodeStats(const std::string& name, int64_t start_micros,
+                            int64_t end_micros, int64_t output_bytes,
+                            DeviceStepStats* dev_stats) {
+  NodeExecStats* stats = dev_stats->add_node_stats();
+  stats->set_node_name(name);
+  stats->set_all_start_micros(start_micros);
+  stats->set_op_start_rel_micros(0);
+  stats->set_op_end_rel_micros(end_micros - start_micros);
+  stats->set_all_end_rel_micros(end_micros - start_micros);
+  stats->add_output()
+      ->mutable_tensor_description()
+      ->mutable_allocation_description()
+      ->set_allocated_bytes(output_bytes);
+  return stats;
+}
+
+class MemoryAttributionTest : public ::testing::Test {
+ protected:
+  MemoryAttributionTest() {
+    // `cheap` and `slow` are both consumed at the end of the step.
+    AddNode("cheap", {}, &graph_);
+    AddNode("slow", {}, &graph_);
+    AddNode("late", {"cheap", "slow"}, &graph_);
+
+    DeviceStepStats* dev_stats = step_stats_.add_dev_stats();
+    dev_stats->set_device(kGpu);
+    NodeExecStats* cheap = AddNodeStats("cheap", 0, 10, 4 * kMiB, dev_stats);
+    AllocatorMemoryUsed* memory = cheap->add_memory();
+    memory->set_allocator_name("GPU_0_bfc");
+    memory->set_peak_bytes(6 * kMiB);
+    memory->set_allocator_bytes_in_use(7 * kMiB);
+    cheap->mutable_memory_stats()->set_temp_memory_size(2 * kMiB);
+    AddNodeStats("slow", 0, 800, 2 * kMiB, dev_stats);
+    AddNodeStats("late", 900, 1000, 1024, dev_stats);
+  }
+
+  GraphDef graph_;
+  StepStats step_stats_;
+};
+
+TEST_F(MemoryAttributionTest, AttributesPeak) {
+  std::vector<DeviceMemoryReport> reports;
+  TF_ASSERT_OK(
+      AttributePeakMemory(graph_, step_stats_, /*options=*/{}, &reports));
+  ASSERT_EQ(reports.size(), 1);
+  const DeviceMemoryReport& report = reports[0];
+  EXPECT_EQ(report.device, kGpu);
+  EXPECT_EQ(report.peak_bytes, 6 * kMiB + 1024);
+  EXPECT_EQ(report.allocator_peak_bytes, 7 * kMiB);
+
+  ASSERT_EQ(report.top_contributors.size(), 3);
+  EXPECT_EQ(report.top_contributors[0].node, "cheap");
+  EXPECT_EQ(report.top_contributors[0].op, "Identity");
+  EXPECT_EQ(report.top_contributors[0].bytes, 4 * kMiB);
+  EXPECT_GT(report.top_contributors[0].lifetime_fraction, 0.9);
+  EXPECT_EQ(report.top_contributors[1].node, "slow");
+  EXPECT_EQ(report.top_contributors[2].node, "late");
+
+  ASSERT_EQ(report.top_op_peaks.size(), 1);
+  EXPECT_EQ(report.top_op_peaks[0].node, "cheap");
+  EXPECT_EQ(report.top_op_peaks[0].peak_bytes, 6 * kMiB);
+  EXPECT_EQ(report.top_op_peaks[0].temp_bytes, 2 * kMiB);
+}
+
+TEST_F(MemoryAttributionTest, Suggestions) {
+  std::vector<DeviceMemoryReport> reports;
+  TF_ASSERT_OK(
+      AttributePeakMemory(graph_, step_stats_, /*options=*/{}, &reports));
+  ASSERT_EQ(reports.size(), 1);
+  const auto& contributors = reports[0].top_contributors;
+  ASSERT_EQ(contributors.size(), 3);
+  // Cheap to produce, so recomputing it is suggested.
+  EXPECT_TRUE(absl::StartsWith(contributors[0].suggestion, "recompute"));
+  // Expensive to produce on a GPU, so swapping it is suggested.
+  EXPECT_TRUE(absl::StartsWith(contributors[1].suggestion, "swap to host"));
+  // Too small to matter.
+  EXPECT_TRUE(contributors[2].suggestion.empty());
+
+  const std::string formatted = FormatMemoryReports(reports);
+  EXPECT_TRUE(absl::StrContains(formatted, "cheap:0 (Identity)"));
+  EXPECT_TRUE(absl::StrContains(formatted, "_swap_to_host"));
+}
+
+TEST_F(MemoryAttributionTest, TopK) {
+  MemoryAttributionOptions options;
+  options.top_k = 1;
+  std::vector<DeviceMemoryReport> reports;
+  TF_ASSERT_OK(AttributePeakMemory(graph_, step_stats_, options, &reports));
+  ASSERT_EQ(reports.size(), 1);
+  ASSERT_EQ(reports[0].top_contributors.size(), 1);
+  EXPECT_EQ(reports[0].top_contributors[0].node, "cheap");
+}
+
+TEST(MemoryAttribution, RequiresStepStats) {
+  std::vector<DeviceMemoryReport> reports;
+  EXPECT_FALSE(AttributePeakMemory(GraphDef(), StepStats(), /*options=*/{},
+                                   &reports)
+                   .ok());
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
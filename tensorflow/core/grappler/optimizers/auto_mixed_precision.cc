@@ -15,19 +15,28 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
@@ -43,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -77,6 +87,7 @@ const char kSuffix[] = "AutoMixedPrecision";
 const char kCastToFp16[] = "CastToFp16";
 const char kCastToBf16[] = "CastToBf16";
 const char kCastToFp32[] = "CastToFp32";
+const char kQuantizeToInt8[] = "QuantizeToInt8";
 
 #if GOOGLE_CUDA
 // Returns the GPU architecture (compute capability) as a (major, minor) pair.
@@ -1051,9 +1062,10 @@ class AutoMixedPrecisionImpl {
         cudnn_version_(GetCudnnVersion(devices_)),
         num_nonvar_casts_to_f16_(0),
         mode_(mode),
-        target_dtype_((mode_ == AutoMixedPrecisionMode::CUDA ||
-                       mode_ == AutoMixedPrecisionMode::CPU ||
-                       mode_ == AutoMixedPrecisionMode::FP16_CPU)
+        target_dtype_(mode_ == AutoMixedPrecisionMode::INT8_CPU ? DT_QINT8
+                      : (mode_ == AutoMixedPrecisionMode::CUDA ||
+                         mode_ == AutoMixedPrecisionMode::CPU ||
+                         mode_ == AutoMixedPrecisionMode::FP16_CPU)
                           ? DT_HALF
                           : DT_BFLOAT16) {}
 
@@ -1077,6 +1089,8 @@ class AutoMixedPrecisionImpl {
       case AutoMixedPrecisionMode::FP16_CPU:
         return std::make_unique<AutoMixedPrecisionListsFp16>(
             0, 0, AutoMixedPrecisionMode::FP16_CPU);
+      case AutoMixedPrecisionMode::INT8_CPU:
+        return std::make_unique<AutoMixedPrecisionListsInt8>();
     }
   }
   Status PrintDebugLogs(bool preop, size_t timestamp);
@@ -1129,6 +1143,15 @@ class AutoMixedPrecisionImpl {
       const TypeAttrId& type_attr, NodeDef* node,
       std::vector<MutableGraphView::OutputPort>& output_ports) const;
   Status ChangeTypeAttrsAndAddCasts(const absl::flat_hash_set<int>& allow_set);
+  Status ReadInt8Ranges();
+  void RemoveAllowsetFedByDeny(const absl::flat_hash_set<int>& deny_set,
+                               absl::flat_hash_set<int>* allow_set) const;
+  string UniqueNodeName(absl::string_view prefix) const;
+  NodeDef* AddInt8Const(absl::string_view prefix, const string& device,
+                        const Tensor& value, const string& control_input);
+  absl::StatusOr<string> GetOrAddInt8Quantize(
+      const MutableGraphView::OutputPort& src, const string& device);
+  Status QuantizeAllowOpsToInt8(const absl::flat_hash_set<int>& allow_set);
 
   std::unordered_map<string, DeviceProperties> devices_;
   VirtualPlacer virtual_placer_;
@@ -1150,7 +1173,15 @@ class AutoMixedPrecisionImpl {
   gtl::FlatSet<string> f16_inferlist_;
   gtl::FlatSet<string> f16_clearlist_;
   absl::flat_hash_set<const NodeDef*> should_process_nodes_;
-  DataType target_dtype_;  // Either DT_HALF or DT_BFLOAT16
+  DataType target_dtype_;  // DT_HALF, DT_BFLOAT16 or DT_QINT8
+  // The calibrated [min, max] ranges of the activations quantized to int8, by
+  // tensor name.
+  absl::flat_hash_map<string, std::pair<float, float>> int8_ranges_;
+  // The activations quantized to int8 with ranges computed at run time.
+  std::vector<string> int8_dynamic_range_tensors_;
+  // The QuantizeV2 nodes added for the tensors quantized to int8, by tensor
+  // name.
+  absl::flat_hash_map<string, string> int8_quantize_nodes_;
 };
 
 NodeDef AutoMixedPrecisionImpl::BuildCastNode(
@@ -1246,6 +1277,18 @@ Status AutoMixedPrecisionImpl::PrintDebugLogs(bool preop, size_t timestamp) {
     f.close();
     LOG(INFO) << "Saved paint bucket info to " << fname;
   }
+  if (!preop && mode_ == AutoMixedPrecisionMode::INT8_CPU) {
+    // Lists the activations without a calibrated range, in the format of
+    // TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_INT8_RANGES.
+    fname = io::JoinPath(prepend_path,
+                         strings::StrCat("int8ranges", suffix, ".txt"));
+    f.open(fname.c_str(), std::fstream::out);
+    for (const string& tensor : int8_dynamic_range_tensors_) {
+      f << "# " << tensor << " <min> <max>\n";
+    }
+    f.close();
+    LOG(INFO) << "Saved the activations to calibrate to " << fname;
+  }
   return absl::OkStatus();
 }
 
@@ -1389,7 +1432,8 @@ Status AutoMixedPrecisionImpl::Optimize() {
   optimization_level = absl::AsciiStrToUpper(optimization_level);
   force_all_fp16_ = optimization_level == "UNSAFE_FORCE_ALL";
   if (force_all_fp16_ && (mode_ == AutoMixedPrecisionMode::BF16 ||
-                          mode_ == AutoMixedPrecisionMode::FP16_CPU)) {
+                          mode_ == AutoMixedPrecisionMode::FP16_CPU ||
+                          mode_ == AutoMixedPrecisionMode::INT8_CPU)) {
     // Many ops do not support bfloat16/fp16 on the CPU. So, disallowing
     // forcing to bfloat16/fp16.
     return errors::InvalidArgument(
@@ -1434,6 +1478,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
       case AutoMixedPrecisionMode::BF16:
       case AutoMixedPrecisionMode::CPU:
       case AutoMixedPrecisionMode::FP16_CPU:
+      case AutoMixedPrecisionMode::INT8_CPU:
         device_type = DEVICE_CPU;
         should_process = !MustPreserve(node) && IsOnDevice(node, device_type);
         break;
@@ -1514,6 +1559,18 @@ Status AutoMixedPrecisionImpl::Optimize() {
   PropagateDenyFwdThroughClearAndInfer(&deny_set);
   VLOG(2) << "Finished pass 2";
 
+  if (mode_ == AutoMixedPrecisionMode::INT8_CPU) {
+    // Int8 ops are only worth their quantize and dequantize boundaries on the
+    // compute-heavy allowlist ops, so the allow set is not grown any further.
+    VLOG(2) << "Removing allow nodes fed by deny nodes";
+    RemoveAllowsetFedByDeny(deny_set, &allow_set);
+    TF_RETURN_IF_ERROR(ReadInt8Ranges());
+    VLOG(2) << "Beginning final pass to quantize allow nodes to int8";
+    TF_RETURN_IF_ERROR(QuantizeAllowOpsToInt8(allow_set));
+    VLOG(2) << "Finished final pass";
+    return PrintDebugLogs(/* preop = */ false, timestamp);
+  }
+
   VLOG(2) << "Forcing color match between data structure ops";
   for (const auto& cluster : tensor_list_clusters) {
     ForceColorMatchBetweenTensorListOps(cluster, &allow_set, &deny_set);
@@ -2264,6 +2321,366 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
   return absl::OkStatus();
 }
 
+// Reads the calibrated activation ranges from the file named by
+// TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_INT8_RANGES, which holds a
+// "<tensor> <min> <max>" line per activation and '#' comments. The ranges can
+// be collected by running the fp32 graph over representative inputs and
+// fetching the activations listed in the int8ranges debug log.
+Status AutoMixedPrecisionImpl::ReadInt8Ranges() {
+  string path;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar(
+      "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_INT8_RANGES", "", &path));
+  if (path.empty()) return absl::OkStatus();
+
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), path, &contents));
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    line = absl::StripAsciiWhitespace(line);
+    if (line.empty() || absl::StartsWith(line, "#")) continue;
+    std::vector<absl::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipWhitespace());
+    float min_value, max_value;
+    if (fields.size() != 3 || !absl::SimpleAtof(fields[1], &min_value) ||
+        !absl::SimpleAtof(fields[2], &max_value) || min_value > max_value) {
+      return errors::InvalidArgument("Invalid int8 range in ", path, ": ",
+                                     line);
+    }
+    int8_ranges_[ParseTensorName(fields[0]).ToString()] = {min_value,
+                                                           max_value};
+  }
+  VLOG(1) << "Read " << int8_ranges_.size() << " int8 ranges from " << path;
+  return absl::OkStatus();
+}
+
+// Removes allow nodes that are fed by a deny node, directly or through clear
+// nodes, from allow_set.
+void AutoMixedPrecisionImpl::RemoveAllowsetFedByDeny(
+    const absl::flat_hash_set<int>& deny_set,
+    absl::flat_hash_set<int>* allow_set) const {
+  auto is_deny = [&](int idx) {
+    return deny_set.count(idx) ||
+           f16_denylist_.count(graph_type_view_.GetNode(idx)->node->op());
+  };
+  std::vector<int> fed_by_deny;
+  for (int root_idx : *allow_set) {
+    const NodeTypeId& root = *graph_type_view_.GetNode(root_idx);
+    bool found_deny = false;
+    DfsTypeTraversal(
+        graph_type_view_, {&root}, TypeTraversalDirection::kFollowInputs,
+        DfsTypePredicates::Enter([&](int idx) -> bool {
+          const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+          return !found_deny &&
+                 (idx == root_idx || is_deny(idx) ||
+                  f16_clearlist_.count(item.node->op()));
+        }),
+        DfsTypeCallbacks::PreOrder([&](int idx) {
+          if (idx != root_idx && is_deny(idx)) found_deny = true;
+        }));
+    if (found_deny) fed_by_deny.push_back(root_idx);
+  }
+  for (int idx : fed_by_deny) {
+    VLOG(2) << "Painting node " << graph_type_view_.GetNode(idx)->node->name()
+            << " DENY because it is fed by a deny node";
+    allow_set->erase(idx);
+  }
+}
+
+string AutoMixedPrecisionImpl::UniqueNodeName(absl::string_view prefix) const {
+  int id = 0;
+  string name;
+  do {
+    name = absl::StrCat(prefix, "-", id, "-", kSuffix);
+    ++id;
+  } while (graph_view_.GetNode(name));
+  return name;
+}
+
+// Adds a Const node, with a control dependency on `control_input` which
+// places it in the frame of the nodes that read it.
+NodeDef* AutoMixedPrecisionImpl::AddInt8Const(absl::string_view prefix,
+                                              const string& device,
+                                              const Tensor& value,
+                                              const string& control_input) {
+  NodeDef node;
+  node.set_name(UniqueNodeName(prefix));
+  node.set_op("Const");
+  node.set_device(device);
+  node.add_input(AsControlDependency(control_input));
+  (*node.mutable_attr())["dtype"].set_type(value.dtype());
+  value.AsProtoTensorContent((*node.mutable_attr())["value"].mutable_tensor());
+  return graph_view_.AddNode(std::move(node));
+}
+
+// Returns the name of the QuantizeV2 node quantizing `src` to qint8 with the
+// SCALED mode, which is added the first time. The range of a constant is
+// computed here, the range of an activation is the calibrated one or else
+// computed at run time.
+absl::StatusOr<string> AutoMixedPrecisionImpl::GetOrAddInt8Quantize(
+    const MutableGraphView::OutputPort& src, const string& device) {
+  const string tensor_name = TensorId(src.node->name(), src.port_id).ToString();
+  auto it = int8_quantize_nodes_.find(tensor_name);
+  if (it != int8_quantize_nodes_.end()) return it->second;
+
+  const string prefix =
+      absl::StrCat(src.node->name(), "-", src.port_id, "-", kQuantizeToInt8);
+  string min_input, max_input;
+  auto range_it = int8_ranges_.find(tensor_name);
+  if (IsConstant(*src.node) || range_it != int8_ranges_.end()) {
+    float min_value, max_value;
+    if (range_it != int8_ranges_.end()) {
+      std::tie(min_value, max_value) = range_it->second;
+    } else {
+      Tensor value;
+      if (!value.FromProto(src.node->attr().at("value").tensor())) {
+        return errors::InvalidArgument("Could not parse the value of ",
+                                       src.node->name());
+      }
+      const auto flat = value.flat<float>();
+      min_value = flat.size() > 0 ? flat(0) : 0.0f;
+      max_value = min_value;
+      for (int64_t i = 1; i < flat.size(); ++i) {
+        min_value = std::min(min_value, flat(i));
+        max_value = std::max(max_value, flat(i));
+      }
+    }
+    min_input = AddInt8Const(absl::StrCat(prefix, "-Min"), device,
+                             Tensor(min_value), src.node->name())
+                    ->name();
+    max_input = AddInt8Const(absl::StrCat(prefix, "-Max"), device,
+                             Tensor(max_value), src.node->name())
+                    ->name();
+  } else {
+    // Reduces the flattened activation to its range.
+    int8_dynamic_range_tensors_.push_back(tensor_name);
+    Tensor flat_shape(DT_INT32, TensorShape({1}));
+    flat_shape.vec<int32>()(0) = -1;
+    NodeDef flat;
+    flat.set_name(UniqueNodeName(absl::StrCat(prefix, "-Flat")));
+    flat.set_op("Reshape");
+    flat.set_device(device);
+    flat.add_input(tensor_name);
+    flat.add_input(AddInt8Const(absl::StrCat(prefix, "-FlatShape"), device,
+                                flat_shape, src.node->name())
+                       ->name());
+    (*flat.mutable_attr())["T"].set_type(DT_FLOAT);
+    (*flat.mutable_attr())["Tshape"].set_type(DT_INT32);
+    const string flat_name = graph_view_.AddNode(std::move(flat))->name();
+    const string axis = AddInt8Const(absl::StrCat(prefix, "-Axis"), device,
+                                     Tensor(0), src.node->name())
+                            ->name();
+    for (const char* op : {"Min", "Max"}) {
+      NodeDef reduce;
+      reduce.set_name(UniqueNodeName(absl::StrCat(prefix, "-", op)));
+      reduce.set_op(op);
+      reduce.set_device(device);
+      reduce.add_input(flat_name);
+      reduce.add_input(axis);
+      (*reduce.mutable_attr())["T"].set_type(DT_FLOAT);
+      (*reduce.mutable_attr())["Tidx"].set_type(DT_INT32);
+      (*reduce.mutable_attr())["keep_dims"].set_b(false);
+      (op == string("Min") ? min_input : max_input) =
+          graph_view_.AddNode(std::move(reduce))->name();
+    }
+  }
+
+  NodeDef quantize;
+  quantize.set_name(UniqueNodeName(prefix));
+  quantize.set_op("QuantizeV2");
+  quantize.set_device(device);
+  quantize.add_input(tensor_name);
+  quantize.add_input(min_input);
+  quantize.add_input(max_input);
+  auto* attr = quantize.mutable_attr();
+  (*attr)["T"].set_type(DT_QINT8);
+  (*attr)["mode"].set_s("SCALED");
+  (*attr)["round_mode"].set_s("HALF_TO_EVEN");
+  (*attr)["narrow_range"].set_b(false);
+  (*attr)["axis"].set_i(-1);
+  (*attr)["ensure_minimum_range"].set_f(0.01f);
+  const string name = graph_view_.AddNode(std::move(quantize))->name();
+  int8_quantize_nodes_[tensor_name] = name;
+  return name;
+}
+
+// Rewrites the allow MatMul and Conv2D nodes with a constant weight input to
+// _QuantizedMatMul and _FusedQuantizedConv2D, which take their activation and
+// weights quantized to qint8 and dequantize their result, so that the graph
+// around them stays in fp32.
+Status AutoMixedPrecisionImpl::QuantizeAllowOpsToInt8(
+    const absl::flat_hash_set<int>& allow_set) {
+  int num_nodes_quantized = 0;
+  const int num_nodes_preop = graph_->node_size();
+  for (int node_idx = 0; node_idx < num_nodes_preop; ++node_idx) {
+    NodeDef* node = graph_->mutable_node(node_idx);
+    const bool is_matmul = node->op() == "MatMul";
+    if (!is_matmul && node->op() != "Conv2D") continue;
+    auto get_bool_attr = [node](const char* name) {
+      auto it = node->attr().find(name);
+      return it != node->attr().end() && it->second.b();
+    };
+    const absl::optional<int> node_type_idx =
+        graph_type_view_.GetNodeIndex(node->name(), TypeAttrId("T"));
+    if (!node_type_idx.has_value() || !allow_set.count(*node_type_idx) ||
+        !IsFloat32(*graph_type_view_.GetNode(*node_type_idx))) {
+      continue;
+    }
+    const MutableGraphView::OutputPort activation =
+        graph_view_.GetRegularFanin({node, 0});
+    const MutableGraphView::OutputPort weights =
+        graph_view_.GetRegularFanin({node, 1});
+    if (activation.node == nullptr || weights.node == nullptr ||
+        !IsConstant(*weights.node) ||
+        GetDataTypeFromAttr(*weights.node, "dtype") != DT_FLOAT) {
+      continue;
+    }
+    TensorShape weights_shape;
+    if (!weights.node->attr().at("value").has_tensor() ||
+        !TensorShape::BuildTensorShape(
+             weights.node->attr().at("value").tensor().tensor_shape(),
+             &weights_shape)
+             .ok()) {
+      continue;
+    }
+
+    // The attributes of the quantized node, checked for a registered kernel
+    // before the graph is changed.
+    NodeDef quantized;
+    quantized.set_name(node->name());
+    quantized.set_device(node->device().empty()
+                             ? virtual_placer_.get_canonical_device_name(*node)
+                             : node->device());
+    auto* attr = quantized.mutable_attr();
+    SetAttrValue(std::vector<DataType>(), &(*attr)["Tdevice_inputs"]);
+    SetAttrValue(std::vector<DataType>(), &(*attr)["Tdevice_outputs"]);
+    if (is_matmul) {
+      if (weights_shape.dims() != 2) continue;
+      const bool transpose_b = get_bool_attr("transpose_b");
+      quantized.set_op("_QuantizedMatMul");
+      SetAttrValue(std::vector<DataType>{DT_QINT8, DT_QINT8, DT_FLOAT, DT_FLOAT,
+                                         DT_FLOAT, DT_FLOAT, DT_FLOAT},
+                   &(*attr)["Thost_inputs"]);
+      SetAttrValue(std::vector<DataType>{DT_FLOAT}, &(*attr)["Thost_outputs"]);
+      (*attr)["T1"].set_type(DT_QINT8);
+      (*attr)["T2"].set_type(DT_QINT8);
+      (*attr)["Tbias"].set_type(DT_FLOAT);
+      (*attr)["U"].set_type(DT_FLOAT);
+      (*attr)["Tout"].set_type(DT_FLOAT);
+      (*attr)["transpose_a"].set_b(get_bool_attr("transpose_a"));
+      (*attr)["transpose_b"].set_b(transpose_b);
+      (*attr)["is_weight_const"].set_b(true);
+      (*attr)["is_bias_const"].set_b(true);
+      // The kernel requires a bias, which is zero.
+      SetAttrValue(std::vector<string>{"BiasAdd", "Dequantize"},
+                   &(*attr)["fused_ops"]);
+      (*attr)["input_quant_mode"].set_s("SCALED");
+      (*attr)["output_quant_mode"].set_s("SCALED");
+      (*attr)["leakyrelu_alpha"].set_f(0.2f);
+      Tensor bias(DT_FLOAT, TensorShape({weights_shape.dim_size(
+                                transpose_b ? 0 : 1)}));
+      bias.flat<float>().setZero();
+      if (!IsKernelRegisteredForNode(quantized).ok()) continue;
+      TF_ASSIGN_OR_RETURN(const string activation_q,
+                          GetOrAddInt8Quantize(activation, node->device()));
+      TF_ASSIGN_OR_RETURN(const string weights_q,
+                          GetOrAddInt8Quantize(weights, node->device()));
+      const string bias_name =
+          AddInt8Const(absl::StrCat(node->name(), "-ZeroBias"), node->device(),
+                       bias, activation_q)
+              ->name();
+      const string& name = node->name();
+      TF_RETURN_IF_ERROR(
+          graph_view_.UpdateRegularFaninByPort(name, 0, {activation_q, 0}));
+      TF_RETURN_IF_ERROR(
+          graph_view_.UpdateRegularFaninByPort(name, 1, {weights_q, 0}));
+      for (const TensorId& fanin :
+           {TensorId(bias_name, 0), TensorId(activation_q, 1),
+            TensorId(activation_q, 2), TensorId(weights_q, 1),
+            TensorId(weights_q, 2)}) {
+        TF_RETURN_IF_ERROR(graph_view_.AddRegularFanin(name, fanin));
+      }
+      const std::vector<std::pair<string, AttrValue>> attrs(
+          quantized.attr().begin(), quantized.attr().end());
+      TF_RETURN_IF_ERROR(
+          graph_view_.UpdateNode(name, quantized.op(), node->device(), attrs));
+    } else {
+      if (weights_shape.dims() != 4 ||
+          (node->attr().count("data_format") &&
+           node->attr().at("data_format").s() != "NHWC")) {
+        continue;
+      }
+      quantized.set_op("_FusedQuantizedConv2D");
+      SetAttrValue(std::vector<DataType>{DT_QINT8, DT_QINT8, DT_FLOAT, DT_FLOAT,
+                                         DT_FLOAT, DT_FLOAT},
+                   &(*attr)["Thost_inputs"]);
+      SetAttrValue(std::vector<DataType>{DT_QINT32, DT_FLOAT, DT_FLOAT},
+                   &(*attr)["Thost_outputs"]);
+      (*attr)["Tinput"].set_type(DT_QINT8);
+      (*attr)["Tfilter"].set_type(DT_QINT8);
+      (*attr)["Tbias"].set_type(DT_FLOAT);
+      (*attr)["Tsummand"].set_type(DT_QINT32);
+      (*attr)["out_type"].set_type(DT_QINT32);
+      for (const char* name : {"strides", "padding", "explicit_paddings",
+                               "dilations", "data_format"}) {
+        if (node->attr().count(name)) (*attr)[name] = node->attr().at(name);
+      }
+      (*attr)["is_filter_const"].set_b(true);
+      (*attr)["is_bias_const"].set_b(true);
+      SetAttrValue(std::vector<string>(), &(*attr)["fused_ops"]);
+      (*attr)["alpha"].set_f(0.0f);
+      if (!IsKernelRegisteredForNode(quantized).ok()) continue;
+      TF_ASSIGN_OR_RETURN(const string activation_q,
+                          GetOrAddInt8Quantize(activation, node->device()));
+      TF_ASSIGN_OR_RETURN(const string weights_q,
+                          GetOrAddInt8Quantize(weights, node->device()));
+      quantized.set_name(UniqueNodeName(
+          absl::StrCat(node->name(), "-", kQuantizeToInt8, "-Conv2D")));
+      quantized.set_device(node->device());
+      for (const TensorId& fanin :
+           {TensorId(activation_q, 0), TensorId(weights_q, 0),
+            TensorId(activation_q, 1), TensorId(activation_q, 2),
+            TensorId(weights_q, 1), TensorId(weights_q, 2)}) {
+        quantized.add_input(fanin.ToString());
+      }
+      // The control dependencies move to the convolution.
+      for (const string& input : node->input()) {
+        if (IsControlInput(input)) quantized.add_input(input);
+      }
+      const string quantized_name =
+          graph_view_.AddNode(std::move(quantized))->name();
+
+      // The node keeps its name and becomes the Dequantize of the result.
+      const string name = node->name();
+      TF_RETURN_IF_ERROR(graph_view_.RemoveAllFanins(
+          name, /*keep_controlling_fanins=*/false));
+      for (int port = 0; port < 3; ++port) {
+        TF_RETURN_IF_ERROR(
+            graph_view_.AddRegularFanin(name, {quantized_name, port}));
+      }
+      AttrValue type, mode, narrow_range, axis, dtype;
+      type.set_type(DT_QINT32);
+      mode.set_s("SCALED");
+      narrow_range.set_b(false);
+      axis.set_i(-1);
+      dtype.set_type(DT_FLOAT);
+      TF_RETURN_IF_ERROR(graph_view_.UpdateNode(
+          name, "Dequantize", node->device(),
+          {{"T", type},
+           {"mode", mode},
+           {"narrow_range", narrow_range},
+           {"axis", axis},
+           {"dtype", dtype}}));
+    }
+    VLOG(1) << "Quantized " << (is_matmul ? "MatMul" : "Conv2D") << " node "
+            << node->name() << " to int8";
+    ++num_nodes_quantized;
+  }
+
+  LOG(INFO) << "Quantized " << num_nodes_quantized << "/" << num_nodes_preop
+            << " nodes to int8, " << int8_dynamic_range_tensors_.size()
+            << " of their activation(s) with ranges computed at run time";
+  return absl::OkStatus();
+}
+
 int GetNumGPUs(const Cluster& cluster) {
   if (ShouldSimulateGpu()) {
     return 1;
@@ -2289,6 +2706,11 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
 
 #if !defined(INTEL_MKL)
+  if (mode_ == AutoMixedPrecisionMode::INT8_CPU) {
+    return errors::Unimplemented(
+        "The auto_mixed_precision_onednn_int8 optimizer cannot be used since "
+        "this build of TensorFlow is not compiled with oneDNN support.");
+  }
   if (mode_ == AutoMixedPrecisionMode::BF16) {
     return errors::Unimplemented(
         "The auto_mixed_precision_onednn_bfloat16 optimizer cannot be used "
@@ -593,6 +593,72 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
   }
 };
 
+class AutoMixedPrecisionListsInt8 : public AutoMixedPrecisionLists {
+ public:
+  AutoMixedPrecisionListsInt8() {}
+
+  // The ops with an activation and a constant weight input that can be
+  // rewritten to the oneDNN int8 kernels.
+  gtl::FlatSet<string> AllowList() override {
+    auto list = gtl::FlatSet<string>{"Conv2D", "MatMul"};
+    UpdateList("ALLOWLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> InferList() override {
+    auto list = gtl::FlatSet<string>{"Add", "AddN",    "AddV2", "BiasAdd",
+                                     "Elu", "Mul",     "Selu",  "Sigmoid",
+                                     "Sub", "Tanh"};
+    UpdateList("INFERLIST", &list);
+    return list;
+  }
+
+  // Ops whose outputs are poorly represented with a per-tensor int8 scale,
+  // e.g. exponentials and softmax probabilities, most of which are much
+  // smaller than the largest one. Allow ops fed by them are kept in fp32.
+  gtl::FlatSet<string> DenyList() override {
+    auto list = gtl::FlatSet<string>{
+        "Exp",
+        "Expm1",
+        "Log",
+        "Log1p",
+        "LogSoftmax",
+        "Pow",
+        "Reciprocal",
+        "Rsqrt",
+        "Softmax",
+        "SoftmaxCrossEntropyWithLogits",
+        "SparseSoftmaxCrossEntropyWithLogits",
+        "Sqrt",
+    };
+    UpdateList("DENYLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> ClearList() override {
+    auto list = gtl::FlatSet<string>{
+        "AvgPool",
+        "ConcatV2",
+        "DepthToSpace",
+        "ExpandDims",
+        "Identity",
+        "MaxPool",
+        "Pad",
+        "Relu",
+        "Relu6",
+        "Reshape",
+        "Slice",
+        "Snapshot",
+        "SpaceToDepth",
+        "Squeeze",
+        "StridedSlice",
+        "Transpose",
+    };
+    UpdateList("CLEARLIST", &list);
+    return list;
+  }
+};
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
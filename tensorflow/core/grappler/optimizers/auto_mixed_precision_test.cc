@@ -34,6 +34,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/util/util.h"
 
 // TODO(benbarsdell): Improve the numerical checks in these tests. The tests
@@ -1761,6 +1763,197 @@ TEST_F(AutoMixedPrecisionMklTest, InferFollowUpStreamDeny) {
     test::ExpectClose(tensors_expected[i], tensors[i]);
   }
 }
+
+TEST_F(AutoMixedPrecisionMklTest, Int8) {
+  if (!IsMKLEnabled())
+    GTEST_SKIP() << "Test only applicable to MKL auto-mixed precision.";
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {32, 32});
+  Output weights1 = ops::Const(s.WithOpName("weights1"), 0.5f, {32, 16});
+  Output weights2 = ops::Const(s.WithOpName("weights2"), 0.25f, {16, 8});
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), input, weights1);
+  Output clr1 = ops::Relu(s.WithOpName("clr1"), allow1);
+  Output deny1 = ops::Softmax(s.WithOpName("deny1"), clr1);
+  Output allow2 = ops::MatMul(s.WithOpName("allow2"), deny1, weights2);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), allow2);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::INT8_CPU};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("allow1")->op(), "_QuantizedMatMul");
+  EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_FLOAT);
+  // allow2 is fed by a deny node, so its input is not quantized.
+  EXPECT_EQ(output_view.GetNode("allow2")->op(), "MatMul");
+  EXPECT_EQ(output_view.GetNode("allow2")->attr().at("T").type(), DT_FLOAT);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(tensors.size(), tensors_expected.size());
+  EXPECT_EQ(tensors.size(), item.fetch.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectClose(tensors_expected[i], tensors[i], -1, 1e-2);
+  }
+}
+
+TEST_F(AutoMixedPrecisionMklTest, Int8Conv2D) {
+  if (!IsMKLEnabled())
+    GTEST_SKIP() << "Test only applicable to MKL auto-mixed precision.";
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"), 0.5f, {1, 8, 8, 4});
+  Output act = ops::Relu(s.WithOpName("act"), input);
+  Output filter = ops::Const(s.WithOpName("filter"), 0.25f, {3, 3, 4, 8});
+  Output conv = ops::Conv2D(s.WithOpName("conv"), act, filter, {1, 1, 1, 1},
+                            "SAME");
+  Output fetch = ops::Identity(s.WithOpName("fetch"), conv);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::INT8_CPU};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  // The node becomes the Dequantize of the quantized convolution.
+  const NodeDef* conv_node = output_view.GetNode("conv");
+  EXPECT_EQ(conv_node->op(), "Dequantize");
+  const NodeDef* quantized_conv =
+      output_view.GetRegularFanin({conv_node, 0}).node;
+  EXPECT_EQ(quantized_conv->op(), "_FusedQuantizedConv2D");
+  const NodeDef* act_q = output_view.GetRegularFanin({quantized_conv, 0}).node;
+  EXPECT_EQ(act_q->op(), "QuantizeV2");
+  // Without a calibrated range, the range of the activation is computed at
+  // run time.
+  EXPECT_EQ(output_view.GetRegularFanin({act_q, 1}).node->op(), "Min");
+  EXPECT_EQ(output_view.GetRegularFanin({act_q, 2}).node->op(), "Max");
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(tensors.size(), tensors_expected.size());
+  EXPECT_EQ(tensors.size(), item.fetch.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectClose(tensors_expected[i], tensors[i], -1, 1e-2);
+  }
+}
+
+class AutoMixedPrecisionMklInt8RangesTest : public AutoMixedPrecisionMklTest {
+ protected:
+  void TearDown() override {
+    unsetenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_INT8_RANGES");
+    unsetenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LOG_PATH");
+    AutoMixedPrecisionMklTest::TearDown();
+  }
+
+  // Builds a MatMul of the activation "act" by constant weights.
+  GrapplerItem MatMulItem() {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+        "/job:localhost/replica:0/task:0/device:CPU:0");
+    Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {32, 32});
+    Output act = ops::Relu(s.WithOpName("act"), input);
+    Output weights = ops::Const(s.WithOpName("weights"), 0.5f, {32, 16});
+    Output allow1 = ops::MatMul(s.WithOpName("allow1"), act, weights);
+    Output fetch = ops::Identity(s.WithOpName("fetch"), allow1);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    return item;
+  }
+
+  // Writes `contents` to a ranges file and points the optimizer to it.
+  void SetRanges(const string& contents) {
+    const string path = io::JoinPath(testing::TmpDir(), "int8_ranges.txt");
+    TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, contents));
+    setenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_INT8_RANGES", path.c_str(),
+           1 /* replace */);
+  }
+};
+
+TEST_F(AutoMixedPrecisionMklInt8RangesTest, UsesCalibratedRanges) {
+  if (!IsMKLEnabled())
+    GTEST_SKIP() << "Test only applicable to MKL auto-mixed precision.";
+  SetRanges("# Calibrated on representative inputs.\n\nact:0 0 0.0625\n");
+  GrapplerItem item = MatMulItem();
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::INT8_CPU};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  const NodeDef* allow1 = output_view.GetNode("allow1");
+  EXPECT_EQ(allow1->op(), "_QuantizedMatMul");
+  const NodeDef* act_q = output_view.GetRegularFanin({allow1, 0}).node;
+  EXPECT_EQ(act_q->op(), "QuantizeV2");
+  const NodeDef* min_node = output_view.GetRegularFanin({act_q, 1}).node;
+  const NodeDef* max_node = output_view.GetRegularFanin({act_q, 2}).node;
+  ASSERT_EQ(min_node->op(), "Const");
+  ASSERT_EQ(max_node->op(), "Const");
+  Tensor min_value, max_value;
+  ASSERT_TRUE(min_value.FromProto(min_node->attr().at("value").tensor()));
+  ASSERT_TRUE(max_value.FromProto(max_node->attr().at("value").tensor()));
+  EXPECT_EQ(min_value.scalar<float>()(), 0.f);
+  EXPECT_EQ(max_value.scalar<float>()(), 0.0625f);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(tensors.size(), tensors_expected.size());
+  EXPECT_EQ(tensors.size(), item.fetch.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectClose(tensors_expected[i], tensors[i], -1, 1e-2);
+  }
+}
+
+TEST_F(AutoMixedPrecisionMklInt8RangesTest, RejectsInvalidRanges) {
+  if (!IsMKLEnabled())
+    GTEST_SKIP() << "Test only applicable to MKL auto-mixed precision.";
+  GrapplerItem item = MatMulItem();
+  for (const char* contents : {"act 1\n", "act 0 x\n", "act 1 0\n"}) {
+    SetRanges(contents);
+    AutoMixedPrecision optimizer{AutoMixedPrecisionMode::INT8_CPU};
+    GraphDef output;
+    EXPECT_TRUE(errors::IsInvalidArgument(
+        optimizer.Optimize(virtual_cluster_.get(), item, &output)))
+        << contents;
+  }
+}
+
+TEST_F(AutoMixedPrecisionMklInt8RangesTest, LogsActivationsToCalibrate) {
+  if (!IsMKLEnabled())
+    GTEST_SKIP() << "Test only applicable to MKL auto-mixed precision.";
+  const string log_path =
+      io::JoinPath(testing::TmpDir(), "int8_activations_to_calibrate");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(log_path));
+  setenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LOG_PATH", log_path.c_str(),
+         1 /* replace */);
+  GrapplerItem item = MatMulItem();
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::INT8_CPU};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  std::vector<string> files;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      io::JoinPath(log_path, "int8ranges*.txt"), &files));
+  ASSERT_EQ(files.size(), 1);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), files[0], &contents));
+  EXPECT_EQ(contents, "# act <min> <max>\n");
+}
 #endif  // INTEL_MKL
 
 }  // namespace
@@ -0,0 +1,332 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/collective_bucketing_optimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kCollectiveReduceV2[] = "CollectiveReduceV2";
+constexpr char kBucketPrefix[] = "CollectiveBucketing/";
+
+// A `CollectiveReduceV2` that can be bucketed.
+struct Candidate {
+  NodeDef* node;
+  int64_t instance_key;
+  TensorShape shape;
+  // The number of elements of the input, and of the zero padding after it in
+  // the bucket.
+  int64_t num_elements;
+  int64_t num_padding;
+};
+
+// Returns the value of the scalar int32 Const that produces `input`.
+bool GetConstScalar(const NodeMap& node_map, const string& input,
+                    int64_t* value) {
+  const NodeDef* node = node_map.GetNode(input);
+  if (node == nullptr || !IsConstant(*node) || NodePosition(input) != 0) {
+    return false;
+  }
+  Tensor t;
+  if (!t.FromProto(node->attr().at("value").tensor()) ||
+      t.dtype() != DT_INT32 || t.NumElements() != 1) {
+    return false;
+  }
+  *value = t.flat<int32>()(0);
+  return true;
+}
+
+NodeDef* AddConst(const string& name, const string& device, const Tensor& t,
+                  GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  (*node->mutable_attr())["dtype"].set_type(t.dtype());
+  t.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+Tensor Int64Vector(const std::vector<int64_t>& values) {
+  Tensor t(DT_INT64, TensorShape({static_cast<int64_t>(values.size())}));
+  std::copy(values.begin(), values.end(), t.flat<int64_t>().data());
+  return t;
+}
+
+// Rewrites the reductions of `bucket` into one reduction of their
+// concatenation.
+void RewriteBucket(const std::vector<Candidate>& bucket, DataType dtype,
+                   GraphDef* graph) {
+  const NodeDef& first = *bucket.front().node;
+  const string& device = first.device();
+  const string fused_name = strings::StrCat(kBucketPrefix, first.name());
+  const string scope = strings::StrCat(fused_name, "/");
+
+  NodeDef* concat = graph->add_node();
+  concat->set_name(strings::StrCat(scope, "concat"));
+  concat->set_op("ConcatV2");
+  concat->set_device(device);
+  AddConst(strings::StrCat(scope, "flat_shape"), device,
+           Int64Vector({-1}), graph);
+  std::vector<int64_t> split_sizes;
+  std::set<string> control_inputs;
+  for (int i = 0; i < bucket.size(); ++i) {
+    const Candidate& c = bucket[i];
+    NodeDef* flat = graph->add_node();
+    flat->set_name(strings::StrCat(scope, "flat_", i));
+    flat->set_op("Reshape");
+    flat->set_device(device);
+    flat->add_input(c.node->input(0));
+    flat->add_input(strings::StrCat(scope, "flat_shape"));
+    (*flat->mutable_attr())["T"].set_type(dtype);
+    (*flat->mutable_attr())["Tshape"].set_type(DT_INT64);
+    concat->add_input(flat->name());
+    split_sizes.push_back(c.num_elements);
+    if (c.num_padding > 0) {
+      Tensor zeros(dtype, TensorShape({c.num_padding}));
+      std::memset(zeros.data(), 0, zeros.TotalBytes());
+      concat->add_input(
+          AddConst(strings::StrCat(scope, "padding_", i), device, zeros, graph)
+              ->name());
+      split_sizes.push_back(c.num_padding);
+    }
+    for (const string& input : c.node->input()) {
+      if (IsControlInput(input)) control_inputs.insert(input);
+    }
+  }
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  concat->add_input(
+      AddConst(strings::StrCat(scope, "axis"), device, axis, graph)->name());
+  (*concat->mutable_attr())["N"].set_i(concat->input_size() - 1);
+  (*concat->mutable_attr())["T"].set_type(dtype);
+  (*concat->mutable_attr())["Tidx"].set_type(DT_INT32);
+
+  // The reduction keeps the attributes, group and smallest instance key of the
+  // first reduction.
+  NodeDef* fused = graph->add_node();
+  *fused = first;
+  fused->set_name(fused_name);
+  fused->clear_input();
+  fused->add_input(concat->name());
+  for (int i = 1; i < 4; ++i) {
+    fused->add_input(first.input(i));
+  }
+  for (const string& input : control_inputs) {
+    fused->add_input(input);
+  }
+
+  NodeDef* split = graph->add_node();
+  split->set_name(strings::StrCat(scope, "split"));
+  split->set_op("SplitV");
+  split->set_device(device);
+  split->add_input(fused->name());
+  split->add_input(AddConst(strings::StrCat(scope, "split_sizes"), device,
+                            Int64Vector(split_sizes), graph)
+                       ->name());
+  split->add_input(strings::StrCat(scope, "axis"));
+  (*split->mutable_attr())["num_split"].set_i(split_sizes.size());
+  (*split->mutable_attr())["T"].set_type(dtype);
+  (*split->mutable_attr())["Tlen"].set_type(DT_INT64);
+
+  // Replace the reductions with reshapes of their slices of the result, so
+  // that their consumers are unchanged.
+  int output = 0;
+  for (int i = 0; i < bucket.size(); ++i) {
+    const Candidate& c = bucket[i];
+    std::vector<int64_t> dims(c.shape.dim_sizes().begin(),
+                              c.shape.dim_sizes().end());
+    NodeDef* shape = AddConst(strings::StrCat(scope, "shape_", i), device,
+                              Int64Vector(dims), graph);
+    NodeDef* node = c.node;
+    node->set_op("Reshape");
+    node->clear_input();
+    node->add_input(strings::StrCat(split->name(), ":", output));
+    node->add_input(shape->name());
+    node->clear_attr();
+    (*node->mutable_attr())["T"].set_type(dtype);
+    (*node->mutable_attr())["Tshape"].set_type(DT_INT64);
+    output += c.num_padding > 0 ? 2 : 1;
+  }
+}
+
+}  // namespace
+
+Status CollectiveBucketingOptimizer::Optimize(Cluster* /*cluster*/,
+                                              const GrapplerItem& item,
+                                              GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  bool has_candidates = false;
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() == kCollectiveReduceV2) {
+      has_candidates = true;
+      break;
+    }
+  }
+  if (!has_candidates) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  NodeMap node_map(optimized_graph);
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(*optimized_graph));
+
+  // Finds the bucketable reductions. Reductions go in the same bucket only if
+  // they have the same key.
+  std::map<string, std::vector<Candidate>> candidates_by_key;
+  absl::flat_hash_map<string, string> key_by_name;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (node.op() != kCollectiveReduceV2 || NumNonControlInputs(node) != 4 ||
+        node.device().empty()) {
+      continue;
+    }
+    Candidate c;
+    c.node = &node;
+    int64_t group_size, group_key;
+    if (!GetConstScalar(node_map, node.input(1), &group_size) ||
+        !GetConstScalar(node_map, node.input(2), &group_key) ||
+        !GetConstScalar(node_map, node.input(3), &c.instance_key)) {
+      continue;
+    }
+    const std::vector<OpInfo::TensorProperties>& inputs =
+        properties.GetInputProperties(node.name());
+    if (inputs.empty()) continue;
+    PartialTensorShape shape(inputs[0].shape());
+    if (!shape.AsTensorShape(&c.shape)) continue;
+    const DataType dtype = node.attr().at("T").type();
+    const int64_t elem_size = DataTypeSize(dtype);
+    c.num_elements = c.shape.num_elements();
+    if (c.num_elements == 0 || c.num_elements * elem_size >= bucket_bytes_) {
+      continue;
+    }
+    const int64_t align = Allocator::kAllocatorAlignment / elem_size;
+    c.num_padding = (align - c.num_elements % align) % align;
+
+    const auto& attr = node.attr();
+    string key = strings::StrCat(
+        node.device(), "|", DataTypeString(dtype), "|",
+        attr.at("merge_op").s(), "|", attr.at("final_op").s(), "|",
+        attr.count("communication_hint") ? attr.at("communication_hint").s()
+                                         : "",
+        "|",
+        attr.count("timeout_seconds") ? attr.at("timeout_seconds").f() : 0.0f,
+        "|", attr.count("is_stateless") && attr.at("is_stateless").b(), "|",
+        attr.count("max_subdivs_per_device")
+            ? attr.at("max_subdivs_per_device").i()
+            : -1,
+        "|", group_size, "|", group_key, "|",
+        absl::StrJoin(frame_view.Frames(node), ","));
+    key_by_name[node.name()] = key;
+    candidates_by_key[key].push_back(c);
+  }
+
+  // A reduction can't be bucketed with another that it depends on. Append to
+  // the keys the number of candidates on the longest path to each candidate,
+  // which differs for any two that depend on each other.
+  std::vector<const NodeDef*> topo_order;
+  if (!candidates_by_key.empty() &&
+      ComputeTopologicalOrder(*optimized_graph, &topo_order).ok()) {
+    absl::flat_hash_map<string, int> depth;
+    for (const NodeDef* node : topo_order) {
+      int d = 0;
+      for (const string& input : node->input()) {
+        const string fanin = NodeName(input);
+        auto it = depth.find(fanin);
+        if (it == depth.end()) continue;
+        d = std::max(d, it->second + (key_by_name.contains(fanin) ? 1 : 0));
+      }
+      depth[node->name()] = d;
+    }
+    std::map<string, std::vector<Candidate>> by_key_and_depth;
+    for (auto& [key, candidates] : candidates_by_key) {
+      for (const Candidate& c : candidates) {
+        by_key_and_depth[strings::StrCat(key, "|", depth[c.node->name()])]
+            .push_back(c);
+      }
+    }
+    candidates_by_key = std::move(by_key_and_depth);
+  } else {
+    candidates_by_key.clear();
+  }
+
+  int num_bucketed = 0;
+  for (auto& [key, candidates] : candidates_by_key) {
+    // All group members run the same graph, so ordering by instance key gives
+    // them the same buckets.
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) {
+                return std::tie(a.instance_key, a.node->name()) <
+                       std::tie(b.instance_key, b.node->name());
+              });
+    const DataType dtype = candidates.front().node->attr().at("T").type();
+    const int64_t elem_size = DataTypeSize(dtype);
+    std::vector<Candidate> bucket;
+    int64_t bucket_bytes = 0;
+    auto flush = [&]() {
+      if (bucket.size() > 1) {
+        RewriteBucket(bucket, dtype, optimized_graph);
+        num_bucketed += bucket.size();
+      }
+      bucket.clear();
+      bucket_bytes = 0;
+    };
+    for (const Candidate& c : candidates) {
+      const int64_t bytes = (c.num_elements + c.num_padding) * elem_size;
+      if (bucket_bytes + bytes > bucket_bytes_) flush();
+      bucket.push_back(c);
+      bucket_bytes += bytes;
+    }
+    flush();
+  }
+  if (num_bucketed == 0) {
+    return errors::Aborted("Nothing to do.");
+  }
+  VLOG(1) << "Bucketed " << num_bucketed << " collective reductions.";
+  return absl::OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,69 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_COLLECTIVE_BUCKETING_OPTIMIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_COLLECTIVE_BUCKETING_OPTIMIZER_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Packs small `CollectiveReduceV2` ops into buckets of up to `bucket_bytes`
+// bytes and issues one reduction per bucket.
+//
+// Reductions are bucketed together when they run on the same device and frame
+// with the same element type, group, reduction and options, have static
+// shapes, and none depends on another. Buckets are formed in instance key
+// order, so that all group members that run the same graph form the same
+// buckets. Each bucket becomes
+//
+//   ConcatV2(Reshape(x_1), pad_1, ..., Reshape(x_n), pad_n)
+//     -> CollectiveReduceV2 -> SplitV -> Reshape(y_1), ..., Reshape(y_n)
+//
+// where the reduction reuses the smallest instance key of the bucket and the
+// zero padding aligns every result, so that SplitV returns slices of the
+// reduced tensor instead of copies. The final reshapes keep the names of the
+// original reductions.
+class CollectiveBucketingOptimizer : public GraphOptimizer {
+ public:
+  // Buckets of 4MB amortize the per-collective overhead without delaying the
+  // first reduction for too long.
+  static constexpr int64_t kDefaultBucketBytes = 4 << 20;
+
+  CollectiveBucketingOptimizer() : CollectiveBucketingOptimizer(0) {}
+  // A `bucket_bytes` of 0 picks `kDefaultBucketBytes`.
+  explicit CollectiveBucketingOptimizer(int64_t bucket_bytes)
+      : bucket_bytes_(bucket_bytes > 0 ? bucket_bytes : kDefaultBucketBytes) {}
+  ~CollectiveBucketingOptimizer() override {}
+
+  string name() const override { return "collective_bucketing_optimizer"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+ private:
+  const int64_t bucket_bytes_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_COLLECTIVE_BUCKETING_OPTIMIZER_H_
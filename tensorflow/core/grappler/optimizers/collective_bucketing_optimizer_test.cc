@@ -0,0 +1,183 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/collective_bucketing_optimizer.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class CollectiveBucketingOptimizerTest : public GrapplerTest {
+ protected:
+  void AddConst(const string& name, const Tensor& value) {
+    *item_.graph.add_node() = NDef(
+        name, "Const", {}, {{"dtype", value.dtype()}, {"value", value}},
+        kDevice);
+  }
+
+  void AddInput(const string& name, int num_elements) {
+    AddConst(name, test::AsTensor<float>(std::vector<float>(num_elements, 1),
+                                         {num_elements}));
+  }
+
+  void AddReduce(const string& name, const string& input,
+                 const string& group_key, int instance_key) {
+    const string instance_key_name = strings::StrCat(name, "/instance_key");
+    AddConst(instance_key_name, test::AsScalar<int32>(instance_key));
+    *item_.graph.add_node() =
+        NDef(name, "CollectiveReduceV2",
+             {input, "group_size", group_key, instance_key_name},
+             {{"T", DT_FLOAT},
+              {"merge_op", "Add"},
+              {"final_op", "Div"},
+              {"communication_hint", "auto"},
+              {"timeout_seconds", 0.0f},
+              {"is_stateless", false},
+              {"Nordering_token", 0},
+              {"max_subdivs_per_device", -1}},
+             kDevice);
+    item_.fetch.push_back(name);
+  }
+
+  void SetUp() override {
+    AddConst("group_size", test::AsScalar<int32>(2));
+    AddConst("group_key", test::AsScalar<int32>(1));
+    AddConst("other_group_key", test::AsScalar<int32>(2));
+  }
+
+  const NodeDef* GetNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  GrapplerItem item_;
+};
+
+TEST_F(CollectiveBucketingOptimizerTest, BucketsIndependentReductions) {
+  AddInput("x0", 3);
+  AddInput("x1", 16);
+  AddInput("x2", 5);
+  // Out of node order, to check that buckets follow instance keys.
+  AddReduce("r1", "x1", "group_key", 11);
+  AddReduce("r0", "x0", "group_key", 10);
+  AddReduce("r2", "x2", "group_key", 12);
+
+  CollectiveBucketingOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item_, &output));
+
+  const NodeDef* fused = GetNode(output, "CollectiveBucketing/r0");
+  ASSERT_NE(fused, nullptr);
+  EXPECT_EQ(fused->op(), "CollectiveReduceV2");
+  EXPECT_EQ(fused->input(0), "CollectiveBucketing/r0/concat");
+  EXPECT_EQ(fused->input(3), "r0/instance_key");
+  EXPECT_EQ(fused->attr().at("final_op").s(), "Div");
+
+  // Every input but the one that is already aligned is padded to 16 floats.
+  const NodeDef* concat = GetNode(output, "CollectiveBucketing/r0/concat");
+  ASSERT_NE(concat, nullptr);
+  EXPECT_EQ(concat->attr().at("N").i(), 5);
+  const NodeDef* split_sizes =
+      GetNode(output, "CollectiveBucketing/r0/split_sizes");
+  ASSERT_NE(split_sizes, nullptr);
+  Tensor sizes;
+  ASSERT_TRUE(sizes.FromProto(split_sizes->attr().at("value").tensor()));
+  test::ExpectTensorEqual<int64_t>(
+      sizes, test::AsTensor<int64_t>({3, 13, 16, 5, 11}));
+
+  const std::vector<std::pair<string, string>> expected_inputs = {
+      {"r0", "CollectiveBucketing/r0/split:0"},
+      {"r1", "CollectiveBucketing/r0/split:2"},
+      {"r2", "CollectiveBucketing/r0/split:3"}};
+  for (const auto& [name, input] : expected_inputs) {
+    const NodeDef* node = GetNode(output, name);
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->op(), "Reshape");
+    EXPECT_EQ(node->input(0), input);
+    EXPECT_EQ(node->device(), kDevice);
+  }
+}
+
+TEST_F(CollectiveBucketingOptimizerTest, DoesNotBucketDependentReductions) {
+  AddInput("x0", 3);
+  AddInput("x2", 5);
+  AddReduce("r0", "x0", "group_key", 10);
+  AddReduce("r1", "r0", "group_key", 11);
+  AddReduce("r2", "x2", "group_key", 12);
+
+  CollectiveBucketingOptimizer optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item_, &output));
+
+  EXPECT_NE(GetNode(output, "CollectiveBucketing/r0"), nullptr);
+  EXPECT_EQ(GetNode(output, "r0")->op(), "Reshape");
+  EXPECT_EQ(GetNode(output, "r2")->op(), "Reshape");
+  EXPECT_EQ(GetNode(output, "r1")->op(), "CollectiveReduceV2");
+  EXPECT_EQ(GetNode(output, "r1")->input(0), "r0");
+}
+
+TEST_F(CollectiveBucketingOptimizerTest, DoesNotBucketDifferentGroups) {
+  AddInput("x0", 3);
+  AddInput("x1", 5);
+  AddReduce("r0", "x0", "group_key", 10);
+  AddReduce("r1", "x1", "other_group_key", 11);
+
+  CollectiveBucketingOptimizer optimizer;
+  GraphDef output;
+  EXPECT_TRUE(errors::IsAborted(optimizer.Optimize(nullptr, item_, &output)));
+}
+
+TEST_F(CollectiveBucketingOptimizerTest, LimitsBucketSize) {
+  // Each input takes 64 bytes with its padding.
+  AddInput("x0", 10);
+  AddInput("x1", 10);
+  AddInput("x2", 10);
+  AddReduce("r0", "x0", "group_key", 10);
+  AddReduce("r1", "x1", "group_key", 11);
+  AddReduce("r2", "x2", "group_key", 12);
+
+  CollectiveBucketingOptimizer optimizer(/*bucket_bytes=*/128);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item_, &output));
+
+  EXPECT_NE(GetNode(output, "CollectiveBucketing/r0"), nullptr);
+  EXPECT_EQ(GetNode(output, "r1")->op(), "Reshape");
+  EXPECT_EQ(GetNode(output, "CollectiveBucketing/r2"), nullptr);
+  EXPECT_EQ(GetNode(output, "r2")->op(), "CollectiveReduceV2");
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/common_subgraph_elimination.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -24,6 +25,8 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/graph/tensor_id.h"
@@ -273,6 +276,120 @@ Status CommonSubgraphElimination::DedupComputations(GraphDef* optimized_graph) {
   return absl::OkStatus();
 }
 
+namespace {
+
+// Returns true if the functions that only differ from `func` by their name can
+// be replaced by it. The kernels of the ops that own a resource or a random
+// generator are shared by the calls to an instantiation of a function, so
+// that deduping two functions creating them would share their state.
+bool CanDedupFunction(const FunctionDef& func,
+                      const absl::flat_hash_set<string>& has_gradient) {
+  if (has_gradient.contains(func.signature().name())) return false;
+  for (const NodeDef& node : func.node_def()) {
+    if (node.attr().contains("shared_name") || node.attr().contains("seed")) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RenameFunctions(const absl::flat_hash_map<string, string>& renames,
+                     NameAttrList* func);
+
+void RenameFunctions(const absl::flat_hash_map<string, string>& renames,
+                     AttrValue* value) {
+  if (value->has_func()) {
+    RenameFunctions(renames, value->mutable_func());
+  } else if (value->has_list()) {
+    for (NameAttrList& func : *value->mutable_list()->mutable_func()) {
+      RenameFunctions(renames, &func);
+    }
+  }
+}
+
+void RenameFunctions(const absl::flat_hash_map<string, string>& renames,
+                     NameAttrList* func) {
+  auto it = renames.find(func->name());
+  if (it != renames.end()) func->set_name(it->second);
+  for (auto& attr : *func->mutable_attr()) {
+    RenameFunctions(renames, &attr.second);
+  }
+}
+
+// Updates the calls of `node` to the functions in `renames`, either as its op
+// or in its attributes.
+void RenameFunctions(const absl::flat_hash_map<string, string>& renames,
+                     NodeDef* node) {
+  auto it = renames.find(node->op());
+  if (it != renames.end()) node->set_op(it->second);
+  for (auto& attr : *node->mutable_attr()) {
+    RenameFunctions(renames, &attr.second);
+  }
+}
+
+}  // namespace
+
+Status CommonSubgraphElimination::DedupFunctions(GraphDef* optimized_graph) {
+  FunctionDefLibrary* library = optimized_graph->mutable_library();
+  absl::flat_hash_set<string> has_gradient;
+  for (const GradientDef& gradient : library->gradient()) {
+    has_gradient.insert(gradient.function_name());
+    has_gradient.insert(gradient.gradient_func());
+  }
+
+  // Deduping functions can make their callers identical, so this iterates
+  // until no function is deduped.
+  int num_deduped = 0;
+  absl::flat_hash_map<string, string> renames;
+  while (true) {
+    renames.clear();
+    // The functions without their name, grouped by hash.
+    std::vector<FunctionDef> unnamed(library->function_size());
+    absl::flat_hash_map<uint64, std::vector<int>> reps;
+    for (int i = 0; i < library->function_size(); ++i) {
+      const FunctionDef& func = library->function(i);
+      if (!CanDedupFunction(func, has_gradient)) continue;
+      unnamed[i] = func;
+      unnamed[i].mutable_signature()->clear_name();
+      std::vector<int>& candidates = reps[FunctionDefHash(unnamed[i])];
+      auto rep = std::find_if(
+          candidates.begin(), candidates.end(), [&](int candidate) {
+            return FunctionDefsEqual(unnamed[candidate], unnamed[i]);
+          });
+      if (rep == candidates.end()) {
+        candidates.push_back(i);
+      } else {
+        renames[func.signature().name()] =
+            library->function(*rep).signature().name();
+      }
+    }
+    if (renames.empty()) break;
+
+    for (NodeDef& node : *optimized_graph->mutable_node()) {
+      RenameFunctions(renames, &node);
+    }
+    auto* functions = library->mutable_function();
+    functions->erase(std::remove_if(functions->begin(), functions->end(),
+                                    [&](const FunctionDef& func) {
+                                      return renames.contains(
+                                          func.signature().name());
+                                    }),
+                     functions->end());
+    for (FunctionDef& func : *functions) {
+      for (NodeDef& node : *func.mutable_node_def()) {
+        RenameFunctions(renames, &node);
+      }
+    }
+    num_deduped += renames.size();
+  }
+
+  if (num_deduped > 0) {
+    VLOG(1) << "Deduped " << num_deduped << " functions (library size = "
+            << library->function_size() << ")";
+  }
+  return absl::OkStatus();
+}
+
 Status CommonSubgraphElimination::Optimize(Cluster* /*cluster*/,
                                            const GrapplerItem& item,
                                            GraphDef* optimized_graph) {
@@ -281,6 +398,10 @@ Status CommonSubgraphElimination::Optimize(Cluster* /*cluster*/,
   fetch_nodes_known_ = !item.fetch.empty();
   *optimized_graph = item.graph;
 
+  // Dedup the functions first, so that the calls to identical functions are
+  // deduped as well.
+  TF_RETURN_IF_ERROR(DedupFunctions(optimized_graph));
+
   // Perform topological sort on the graph in order to help DedupComputations
   // optimize larger subgraphs starting from the roots with more inputs.
   TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -44,7 +44,7 @@ class CommonSubgraphElimination : public GraphOptimizer {
 
   string name() const override { return "common_subgraph_elimination"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override { return true; }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
@@ -58,6 +58,10 @@ class CommonSubgraphElimination : public GraphOptimizer {
   // Dedup redundant nodes in the graph.
   Status DedupComputations(GraphDef* optimized_graph);
 
+  // Dedup the functions of the library that only differ by their name, and
+  // update the references to them.
+  Status DedupFunctions(GraphDef* optimized_graph);
+
   RewriterConfig::Toggle opt_level_;
 
   bool fetch_nodes_known_ = false;
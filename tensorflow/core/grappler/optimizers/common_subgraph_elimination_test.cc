@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -174,5 +176,51 @@ TEST_F(CommonSubgraphEliminationTest, OpDedupCommutative) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(CommonSubgraphEliminationTest, FunctionDedupping) {
+  using test::function::NDef;
+
+  // MySquare1 and MySquare2 only differ by their name and the name of the
+  // identical functions they call.
+  const auto mul_func = [](const string& name) {
+    return FunctionDefHelper::Create(
+        name, {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+        {{{"output"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+        {{"z", "output:z:0"}});
+  };
+  const auto square_func = [](const string& name, const string& mul) {
+    return FunctionDefHelper::Create(
+        name, {"x:T"}, {"z:T"}, {"T: {float, double}"},
+        {{{"output"}, mul, {"x", "x"}, {{"T", "$T"}}}}, {{"z", "output:z:0"}});
+  };
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("square1", "MySquare1", {"a"}, {{"T", DT_FLOAT}}),
+       NDef("square2", "MySquare2", {"a"}, {{"T", DT_FLOAT}}),
+       NDef("add", "Add", {"square1", "square2"}, {{"T", DT_FLOAT}})},
+      {mul_func("MyMul1"), mul_func("MyMul2"),
+       square_func("MySquare1", "MyMul1"), square_func("MySquare2", "MyMul2")});
+  item.fetch = {"add"};
+
+  CommonSubgraphElimination optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_EQ(output.library().function_size(), 2);
+  EXPECT_EQ(output.library().function(0).signature().name(), "MyMul1");
+  EXPECT_EQ(output.library().function(1).signature().name(), "MySquare1");
+  EXPECT_EQ(output.library().function(1).node_def(0).op(), "MyMul1");
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "MySquare2");
+  }
+
+  const Tensor a = test::AsScalar<float>(3.0f);
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"a", a}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"a", a}});
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
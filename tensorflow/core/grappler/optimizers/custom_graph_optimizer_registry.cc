@@ -68,6 +68,7 @@ const ConfigList& DefaultPluginConfigs() {
        {"auto_mixed_precision_onednn_bfloat16", RewriterConfig::ON},
        {"auto_mixed_precision_mkl", RewriterConfig::ON},
        {"auto_mixed_precision_cpu", RewriterConfig::ON},
+       {"auto_mixed_precision_onednn_int8", RewriterConfig::ON},
        {"pin_to_host_optimization", RewriterConfig::ON},
        {"layout_optimizer", RewriterConfig::ON},
        {"remapping", RewriterConfig::ON},
@@ -75,6 +76,7 @@ const ConfigList& DefaultPluginConfigs() {
        {"dependency_optimization", RewriterConfig::ON},
        {"auto_parallel", RewriterConfig::ON},
        {"memory_optimization", RewriterConfig::ON},
+       {"collective_bucketing", RewriterConfig::ON},
        {"scoped_allocator_optimization", RewriterConfig::ON}});
   return *default_plugin_configs;
 }
@@ -0,0 +1,155 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/scaled_jpeg_decode.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMinOutputSizeAttr[] = "_min_output_size";
+constexpr char kRatioAttr[] = "ratio";
+
+constexpr std::array<const char*, 2> kJpegDecodeOps = {
+    "DecodeJpeg",
+    "DecodeAndCropJpeg",
+};
+
+// Ops that keep the spatial size of the image they consume as input 0.
+constexpr std::array<const char*, 3> kPassThroughOps = {
+    "Cast",
+    "ExpandDims",
+    "Identity",
+};
+
+constexpr std::array<const char*, 4> kResizeOps = {
+    "ResizeArea",
+    "ResizeBicubic",
+    "ResizeBilinear",
+    "ResizeNearestNeighbor",
+};
+
+template <size_t N>
+bool IsOneOf(const NodeDef& node, const std::array<const char*, N>& ops) {
+  return absl::c_any_of(ops,
+                        [&node](const char* op) { return node.op() == op; });
+}
+
+// Returns the [height, width] that `resize` resizes to, or false if it is
+// not a constant.
+bool GetConstantResizeSize(const NodeDef& resize,
+                           const MutableGraphView& graph, int* height,
+                           int* width) {
+  const NodeDef* size_node = graph_utils::GetInputNode(resize, graph, 1);
+  if (size_node == nullptr || !IsConstant(*size_node) ||
+      !size_node->attr().contains("value")) {
+    return false;
+  }
+  Tensor size;
+  if (!size.FromProto(size_node->attr().at("value").tensor()) ||
+      size.dtype() != DT_INT32 || size.NumElements() != 2) {
+    return false;
+  }
+  *height = size.flat<int32>()(0);
+  *width = size.flat<int32>()(1);
+  return *height > 0 && *width > 0;
+}
+
+// Returns the smallest [height, width] that every resize of the image decoded
+// by `decode` produces, or an empty vector if the image has any other use.
+std::vector<int> GetMinOutputSize(const NodeDef& decode,
+                                  const MutableGraphView& graph,
+                                  const absl::flat_hash_set<string>& fetch) {
+  int min_height = 0;
+  int min_width = 0;
+  std::vector<const NodeDef*> to_visit = {&decode};
+  absl::flat_hash_set<const NodeDef*> visited = {&decode};
+  while (!to_visit.empty()) {
+    const NodeDef* node = to_visit.back();
+    to_visit.pop_back();
+    if (fetch.contains(node->name())) return {};
+    for (const auto& fanout :
+         graph.GetFanouts(*node, /*include_controlled_nodes=*/false)) {
+      const NodeDef* consumer = fanout.node;
+      if (fanout.port_id != 0) return {};
+      if (IsOneOf(*consumer, kPassThroughOps)) {
+        if (visited.insert(consumer).second) to_visit.push_back(consumer);
+        continue;
+      }
+      int height = 0;
+      int width = 0;
+      if (!IsOneOf(*consumer, kResizeOps) ||
+          !GetConstantResizeSize(*consumer, graph, &height, &width)) {
+        return {};
+      }
+      min_height = std::max(min_height, height);
+      min_width = std::max(min_width, width);
+    }
+  }
+  if (min_height == 0) return {};
+  return {min_height, min_width};
+}
+
+}  // namespace
+
+Status ScaledJpegDecode::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  const absl::flat_hash_set<string> fetch(item.fetch.begin(),
+                                          item.fetch.end());
+
+  for (NodeDef& node : *output->mutable_node()) {
+    if (!IsOneOf(node, kJpegDecodeOps) ||
+        node.attr().contains(kMinOutputSizeAttr)) {
+      continue;
+    }
+    // An explicit scaling denominator is kept as is.
+    if (node.attr().contains(kRatioAttr) &&
+        node.attr().at(kRatioAttr).i() != 1) {
+      continue;
+    }
+    const std::vector<int> min_output_size =
+        GetMinOutputSize(node, graph, fetch);
+    if (min_output_size.empty()) continue;
+    SetAttrValue(min_output_size, &(*node.mutable_attr())[kMinOutputSizeAttr]);
+    stats->num_changes++;
+  }
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(ScaledJpegDecode, "scaled_jpeg_decode");
+
+}  // namespace grappler
+}  // namespace tensorflow
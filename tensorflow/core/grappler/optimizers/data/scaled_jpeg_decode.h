@@ -0,0 +1,53 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_SCALED_JPEG_DECODE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_SCALED_JPEG_DECODE_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This optimization lets `DecodeJpeg` and `DecodeAndCropJpeg` nodes whose
+// image is only resized to constant sizes decode at a reduced DCT scale. It
+// sets the minimum size the decoded image must keep, and the kernel picks
+// the largest scaling denominator that satisfies it for each image.
+//
+// The resized images are close to, but not bitwise identical with, those of
+// a full resolution decode, so the optimization is opt-in.
+class ScaledJpegDecode : public TFDataOptimizerBase {
+ public:
+  ScaledJpegDecode() = default;
+  ~ScaledJpegDecode() override = default;
+
+  string name() const override { return "scaled_jpeg_decode"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return absl::OkStatus();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_SCALED_JPEG_DECODE_H_
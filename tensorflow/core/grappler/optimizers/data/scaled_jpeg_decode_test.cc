@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/scaled_jpeg_decode.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef SizeNode(const string& name, int height, int width) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsTensor<int32>({height, width})},
+               {"dtype", DT_INT32}});
+}
+
+const NodeDef& GetNode(const string& name, const GraphDef& graph) {
+  return graph.node(graph_utils::FindGraphNodeWithName(name, graph));
+}
+
+TEST(ScaledJpegDecodeTest, SetsMinOutputSizeOfResizedDecode) {
+  GrapplerItem item;
+  item.graph = test::function::GDef({
+      NDef("contents", "Placeholder", {}, {{"dtype", DT_STRING}}),
+      NDef("decode", "DecodeJpeg", {"contents"}, {{"ratio", 1}}),
+      NDef("axis", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+      NDef("expand", "ExpandDims", {"decode", "axis"}, {}),
+      SizeNode("size", 224, 256),
+      NDef("resize", "ResizeBilinear", {"expand", "size"}, {}),
+      SizeNode("small_size", 100, 300),
+      NDef("small_resize", "ResizeArea", {"decode", "small_size"}, {}),
+  });
+  item.fetch = {"resize", "small_resize"};
+
+  ScaledJpegDecode optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef& decode = GetNode("decode", output);
+  ASSERT_TRUE(decode.attr().contains("_min_output_size"));
+  EXPECT_THAT(decode.attr().at("_min_output_size").list().i(),
+              ::testing::ElementsAre(224, 300));
+}
+
+TEST(ScaledJpegDecodeTest, KeepsDecodeWithOtherUses) {
+  GrapplerItem item;
+  item.graph = test::function::GDef({
+      NDef("contents", "Placeholder", {}, {{"dtype", DT_STRING}}),
+      NDef("decode", "DecodeJpeg", {"contents"}, {{"ratio", 1}}),
+      NDef("shape", "Shape", {"decode"}, {}),
+      SizeNode("size", 224, 224),
+      NDef("resize", "ResizeBilinear", {"decode", "size"}, {}),
+  });
+  item.fetch = {"resize", "shape"};
+
+  ScaledJpegDecode optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(GetNode("decode", output).attr().contains("_min_output_size"));
+}
+
+TEST(ScaledJpegDecodeTest, KeepsDecodeResizedToDynamicSize) {
+  GrapplerItem item;
+  item.graph = test::function::GDef({
+      NDef("contents", "Placeholder", {}, {{"dtype", DT_STRING}}),
+      NDef("size", "Placeholder", {}, {{"dtype", DT_INT32}}),
+      NDef("decode", "DecodeJpeg", {"contents"}, {{"ratio", 1}}),
+      NDef("resize", "ResizeBilinear", {"decode", "size"}, {}),
+  });
+  item.fetch = {"resize"};
+
+  ScaledJpegDecode optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(GetNode("decode", output).attr().contains("_min_output_size"));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <numeric>
+#include <optional>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -30,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -40,6 +45,15 @@ constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
 constexpr float kGPURatioThreshold = 0.5;
 constexpr float kConvGPUExpectedDtypeThreshold = 0.5;
+// oneDNN reorders plain CPU activations into channel-blocked formats, e.g.
+// nChw8c for AVX2 or nChw16c for AVX-512, before running a convolution,
+// pooling or batch normalization. Channel counts that are not a multiple of
+// the block size are padded.
+constexpr int kCpuChannelBlockSize = 8;
+// The fraction of the memory traffic of such a reorder saved when starting
+// from channels-first activations: a block is then made of contiguous spatial
+// rows instead of a strided gather of channels per pixel.
+constexpr float kCpuBlockedReorderSavings = 0.5;
 
 struct MutableNodeViewFormatter {
   void operator()(std::string* out, utils::MutableNodeView* node_view) const {
@@ -175,6 +189,150 @@ inline std::pair<string, string> GetSrcAndDstDataFormats(
   return {src_format, dst_format};
 }
 
+// Returns the size in bytes of a tensor, or -1 if its shape is not fully
+// defined.
+int64_t TensorBytes(const OpInfo::TensorProperties& properties) {
+  const TensorShapeProto& shape = properties.shape();
+  if (shape.unknown_rank()) return -1;
+  int64_t num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return -1;
+    num_elements *= dim.size();
+  }
+  return num_elements * DataTypeSize(properties.dtype());
+}
+
+// Returns true if the node may be converted together with its neighbours in a
+// CPU layout region: a layout sensitive op in the source data format, or a
+// layout agnostic op.
+bool IsCpuLayoutRegionNode(const TransposeContext& context,
+                           const utils::MutableNodeView& node) {
+  const auto* node_def = node.node();
+  string device_type;
+  string task;
+  if (!DeviceNameUtils::SplitDeviceName(GetDeviceName(*node_def), &task,
+                                        &device_type) ||
+      !absl::StrContains(absl::AsciiStrToLower(device_type),
+                         absl::AsciiStrToLower(kCPU))) {
+    return false;
+  }
+  if (IsLayoutSensitiveOp(*node_def)) {
+    const auto* data_format = node.GetAttr("data_format");
+    return data_format != nullptr && data_format->s() == context.src_format;
+  }
+  return IsLayoutAgnosticOp(*node_def);
+}
+
+// Partitions the CPU nodes into connected regions of layout sensitive and
+// layout agnostic ops, and excludes from the conversion the regions where it
+// is not expected to pay off. Converting a region inserts a Transpose on each
+// 4D tensor crossing its boundary, costing a read and a write of the tensor.
+// It saves a fraction of the blocked format reorder that oneDNN runs on the
+// activations of every layout sensitive op of the region whose channels fill
+// whole blocks.
+Status ExcludeUnprofitableCpuRegions(TransposeContext* context) {
+  const int num_nodes = context->num_nodes;
+  utils::MutableGraphView* graph_view = context->graph_view.get();
+  const GraphProperties& properties = *context->graph_properties;
+
+  std::vector<bool> in_region(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    in_region[i] = IsCpuLayoutRegionNode(*context, *graph_view->GetNode(i));
+  }
+
+  // Union-find over the data edges between region nodes.
+  std::vector<int> parent(num_nodes);
+  std::iota(parent.begin(), parent.end(), 0);
+  const auto find = [&parent](int i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  for (int i = 0; i < num_nodes; ++i) {
+    if (!in_region[i]) continue;
+    for (const auto& fanin : graph_view->GetNode(i)->GetRegularFanins()) {
+      const int j = fanin.node_index();
+      if (j < num_nodes && in_region[j]) parent[find(i)] = find(j);
+    }
+  }
+
+  // Bytes saved (positive) or moved (negative) by converting each region, or
+  // nullopt when a tensor size is unknown.
+  absl::flat_hash_map<int, std::optional<double>> region_savings;
+  const int channel_index = context->src_dim_indices.at('C');
+  const auto add_savings = [&](int region, int64_t bytes, double factor) {
+    auto it = region_savings.try_emplace(region, 0.0).first;
+    if (!it->second.has_value()) return;
+    if (bytes < 0) {
+      it->second.reset();
+    } else {
+      *it->second += factor * bytes;
+    }
+  };
+  for (int i = 0; i < num_nodes; ++i) {
+    if (!in_region[i]) continue;
+    const int region = find(i);
+    auto* node = graph_view->GetNode(i);
+    const auto& input_props =
+        properties.GetInputProperties(node->node()->name());
+    const auto& output_props =
+        properties.GetOutputProperties(node->node()->name());
+
+    for (int port : GetDataFaninPorts(*node)) {
+      if (port >= static_cast<int>(input_props.size()) ||
+          port >= node->NumRegularFanins() ||
+          input_props[port].shape().dim_size() != 4) {
+        continue;
+      }
+      const int fanin = node->GetRegularFanin(port).node_index();
+      if (fanin >= num_nodes || find(fanin) != region) {
+        add_savings(region, TensorBytes(input_props[port]), -2.0);
+      }
+    }
+    for (int port : GetDataFanoutPorts(*node)) {
+      if (port >= static_cast<int>(output_props.size()) ||
+          output_props[port].shape().dim_size() != 4) {
+        continue;
+      }
+      for (const auto& fanout : node->GetRegularFanout(port)) {
+        const int j = fanout.node_index();
+        if (j >= num_nodes || find(j) != region) {
+          add_savings(region, TensorBytes(output_props[port]), -2.0);
+          break;
+        }
+      }
+    }
+
+    if (!IsLayoutSensitiveOp(*node->node()) || output_props.empty() ||
+        output_props[0].shape().dim_size() != 4) {
+      continue;
+    }
+    const int64_t channels =
+        output_props[0].shape().dim(channel_index).size();
+    if (channels <= 0 || channels % kCpuChannelBlockSize != 0) continue;
+    add_savings(region, TensorBytes(output_props[0]),
+                kCpuBlockedReorderSavings);
+    if (!input_props.empty() && input_props[0].shape().dim_size() == 4) {
+      add_savings(region, TensorBytes(input_props[0]),
+                  kCpuBlockedReorderSavings);
+    }
+  }
+
+  for (int i = 0; i < num_nodes; ++i) {
+    if (!in_region[i]) continue;
+    const auto& savings = region_savings[find(i)];
+    if (!savings.has_value() || *savings <= 0) {
+      context->nodes_to_skip.insert(graph_view->GetNode(i)->GetName());
+    }
+  }
+  VLOG(2) << "Keeping " << context->nodes_to_skip.size()
+          << " CPU nodes in unprofitable layout regions in "
+          << context->src_format;
+  return absl::OkStatus();
+}
+
 Status ExpandLayoutSensitiveOp(TransposeContext* context,
                                TransposerFactory* transposer_factory) {
   const int num_nodes = context->num_nodes;
@@ -456,8 +614,9 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
 
 // When there is a GPU, the computation graph is converted to NCHW format.
 // When there is only CPU, there will be no conversion by default, unless user
-// chose to convert the graph to a desired format. Currently, NCHW -> NHWC
-// format conversion is available on CPU.
+// chose to convert the graph to a desired format. NCHW -> NHWC format
+// conversion is available on CPU, and NHWC -> NCHW with oneDNN for the regions
+// of the graph where the cost model expects it to pay off.
 Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
                                         const GrapplerItem& item,
                                         GraphDef* output) {
@@ -494,12 +653,17 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
       case RewriterConfig::NCHW_TO_NHWC:
         context.AssignDeviceAndDataFormats(kCPU, kNCHW, kNHWC);
         break;
-      // TODO(intel-tf): Add functionality for NHWC_TO_NCHW layout conversion on
-      // CPU.
+      // oneDNN kernels accept channels-first activations, while the Eigen CPU
+      // kernels only support NHWC.
       case RewriterConfig::NHWC_TO_NCHW:
-        return errors::Aborted(
-            "Conversion from NHWC to NCHW is currently not  available for "
-            "CPU.");
+        if (!IsMKLEnabled()) {
+          return errors::Aborted(
+              "Conversion from NHWC to NCHW is only available for CPU with "
+              "oneDNN.");
+        }
+        context.AssignDeviceAndDataFormats(kCPU, kNHWC, kNCHW);
+        TF_RETURN_IF_ERROR(ExcludeUnprofitableCpuRegions(&context));
+        break;
       default:
         *output = item.graph;
         VLOG(2) << "No layout conversion will take place for CPU.";
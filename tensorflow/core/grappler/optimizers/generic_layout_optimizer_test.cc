@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -775,6 +776,57 @@ TEST_F(GenericLayoutOptimizerTest, OptimizeSimpleConv3DGraph_CPU) {
 #endif
 }
 
+TEST_F(GenericLayoutOptimizerTest, CpuNhwcToNchwProfitableRegionsOnly) {
+  if (GetNumAvailableGPUs() > 0) GTEST_SKIP() << "Tests the CPU-only path.";
+  if (!IsMKLEnabled()) GTEST_SKIP() << "NHWC to NCHW on CPU needs oneDNN.";
+
+  // A long chain of convolutions amortizes the transposes at its boundaries,
+  // a single convolution does not.
+  Scope scope = Scope::NewRootScope().WithDevice("/CPU:0");
+  auto filter = ops::Const(scope.WithOpName("filter"), 1.0f, {3, 3, 16, 16});
+  auto conv_chain_input = ops::Placeholder(
+      scope.WithOpName("chain_input"), DT_FLOAT,
+      ops::Placeholder::Shape({8, 32, 32, 16}));
+  Output chain = conv_chain_input;
+  for (int i = 0; i < 6; ++i) {
+    chain = Conv2D(scope.WithOpName(absl::StrCat("chain_conv", i)), chain,
+                   filter, {1, 1, 1, 1}, "SAME");
+    chain = ops::Relu(scope.WithOpName(absl::StrCat("chain_relu", i)), chain);
+  }
+  auto chain_output = Identity(scope.WithOpName("chain_output"), chain);
+
+  auto single_input = ops::Placeholder(
+      scope.WithOpName("single_input"), DT_FLOAT,
+      ops::Placeholder::Shape({8, 32, 32, 16}));
+  auto single_conv = Conv2D(scope.WithOpName("single_conv"), single_input,
+                            filter, {1, 1, 1, 1}, "SAME");
+  auto single_output = Identity(scope.WithOpName("single_output"), single_conv);
+
+  GrapplerItem item;
+  TF_ASSERT_OK(scope.ToGraphDef(&item.graph));
+
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NHWC_TO_NCHW);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  for (int i = 0; i < 6; ++i) {
+    auto* conv_node = graph_view.GetNode(absl::StrCat("chain_conv", i));
+    ASSERT_NE(conv_node, nullptr);
+    VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+  }
+  // Only the boundaries of the chain are transposed.
+  VerifyRegularFaninMatch(graph_view.GetNode("chain_conv1"), 0, "chain_relu0",
+                          0);
+  auto* single_conv_node = graph_view.GetNode("single_conv");
+  ASSERT_NE(single_conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(single_conv_node, "NHWC");
+  VerifyRegularFaninMatch(single_conv_node, 0, "single_input", 0);
+}
+
 // TODO(yanzha): Add more complex Graph for test.
 
 }  // namespace grappler
@@ -73,6 +73,9 @@ struct TransposeContext {
   // to this.
   int num_nodes;
   absl::flat_hash_set<string> nodes_to_preserve;
+  // Nodes to keep in the source data format, e.g. because the cost model
+  // rejected the conversion of their region of the graph.
+  absl::flat_hash_set<string> nodes_to_skip;
   std::unique_ptr<GraphProperties> graph_properties;
   std::unique_ptr<utils::MutableGraphView> graph_view;
 
@@ -15,14 +15,21 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 
+#include <algorithm>
+#include <numeric>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -43,6 +50,7 @@ constexpr char kConstOp[] = "Const";
 constexpr char kCaseOp[] = "Case";
 constexpr char kStatelessCaseOp[] = "StatelessCase";
 constexpr char kDeviceIndexOp[] = "DeviceIndex";
+constexpr char kSpecializeInputShapesAttr[] = "_specialize_input_shapes";
 
 // TODO(b/157615690): clean up function implementation swap code.
 // The overall idea for the function swap is like below:
@@ -371,6 +379,234 @@ Status ImplementationSelector::SelectDeviceIndex(GraphDef* graph) const {
   return absl::OkStatus();
 }
 
+namespace {
+
+NodeDef* AddShapeSpecializationNode(GraphDef* graph, const NodeDef& call,
+                                    absl::string_view name,
+                                    absl::string_view op) {
+  NodeDef* node = graph->add_node();
+  node->set_name(strings::StrCat(call.name(), "/ShapeSpecialization/", name));
+  node->set_op(string(op));
+  node->set_device(call.device());
+  return node;
+}
+
+NodeDef* AddShapeSpecializationConst(GraphDef* graph, const NodeDef& call,
+                                     absl::string_view name,
+                                     const Tensor& value) {
+  NodeDef* node = AddShapeSpecializationNode(graph, call, name, kConstOp);
+  (*node->mutable_attr())["dtype"].set_type(value.dtype());
+  value.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+// Returns true if `node` is a function call with shapes to specialize for.
+bool HasShapeSpecialization(const NodeDef& node) {
+  return (IsPartitionedCall(node) || IsStatefulPartitionedCall(node)) &&
+         node.attr().count(kSpecializeInputShapesAttr) > 0;
+}
+
+// Returns true if `bucket` is a fully defined shape compatible with the
+// statically inferred shape of the input.
+bool IsValidShapeBucket(const TensorShapeProto& bucket,
+                        const OpInfo::TensorProperties& input) {
+  const TensorShapeProto& shape = input.shape();
+  if (bucket.unknown_rank() || shape.unknown_rank() ||
+      bucket.dim_size() != shape.dim_size()) {
+    return false;
+  }
+  for (int d = 0; d < bucket.dim_size(); ++d) {
+    if (bucket.dim(d).size() < 0) return false;
+    if (shape.dim(d).size() >= 0 &&
+        shape.dim(d).size() != bucket.dim(d).size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+Status ImplementationSelector::SpecializeInputShapes(const GrapplerItem& item,
+                                                     GraphDef* graph) const {
+  std::vector<int> call_nodes;
+  for (int i = 0; i < graph->node_size(); ++i) {
+    if (HasShapeSpecialization(graph->node(i))) call_nodes.push_back(i);
+  }
+  if (call_nodes.empty()) return absl::OkStatus();
+
+  // The dispatch compares shape vectors, which needs the ranks of the inputs.
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(/*assume_valid_feeds=*/false));
+  FunctionLibraryDefinition flib(OpRegistry::Global(), graph->library());
+
+  for (int call_index : call_nodes) {
+    NodeDef call = graph->node(call_index);
+    const auto& bucket_list =
+        call.attr().at(kSpecializeInputShapesAttr).list().shape();
+    const std::vector<TensorShapeProto> buckets(bucket_list.begin(),
+                                                bucket_list.end());
+    call.mutable_attr()->erase(kSpecializeInputShapesAttr);
+
+    const string function_name = call.attr().at("f").func().name();
+    const FunctionDef* fdef = flib.Find(function_name);
+    const auto& input_props = properties.GetInputProperties(call.name());
+    const int num_inputs = input_props.size();
+    if (fdef == nullptr || num_inputs == 0 ||
+        fdef->signature().input_arg_size() != num_inputs ||
+        buckets.size() % num_inputs != 0) {
+      VLOG(2) << "Not specializing " << call.name() << ": expected "
+              << num_inputs << " shapes per bucket, got " << buckets.size();
+      *graph->mutable_node(call_index) = std::move(call);
+      continue;
+    }
+
+    // Copies the function for each valid bucket, with the bucket shapes
+    // attached to the `_Arg` nodes of its body.
+    std::vector<int> valid_buckets;
+    std::vector<string> branches;
+    const int num_buckets = buckets.size() / num_inputs;
+    for (int b = 0; b < num_buckets; ++b) {
+      bool is_valid = true;
+      for (int i = 0; i < num_inputs; ++i) {
+        is_valid &=
+            IsValidShapeBucket(buckets[b * num_inputs + i], input_props[i]);
+      }
+      if (!is_valid) continue;
+      FunctionDef specialized = *fdef;
+      string name = strings::StrCat(function_name, "_input_shapes_", b);
+      for (int suffix = 0; flib.Find(name) != nullptr; ++suffix) {
+        name = strings::StrCat(function_name, "_input_shapes_", b, "_",
+                               suffix);
+      }
+      specialized.mutable_signature()->set_name(name);
+      for (int i = 0; i < num_inputs; ++i) {
+        auto& output_shapes =
+            (*(*specialized.mutable_arg_attr())[i].mutable_attr())
+                ["_output_shapes"];
+        output_shapes.mutable_list()->clear_shape();
+        *output_shapes.mutable_list()->add_shape() =
+            buckets[b * num_inputs + i];
+      }
+      TF_RETURN_IF_ERROR(flib.AddFunctionDef(specialized));
+      *graph->mutable_library()->add_function() = std::move(specialized);
+      valid_buckets.push_back(b);
+      branches.push_back(name);
+    }
+    if (valid_buckets.empty()) {
+      *graph->mutable_node(call_index) = std::move(call);
+      continue;
+    }
+    VLOG(2) << "Specializing " << function_name << " called by "
+            << call.name() << " for " << valid_buckets.size()
+            << " input shape buckets";
+
+    // shapes = Concat(Shape(input_0), ..., Shape(input_n-1))
+    NodeDef* shapes =
+        AddShapeSpecializationNode(graph, call, "shapes", "ConcatV2");
+    for (int i = 0; i < num_inputs; ++i) {
+      NodeDef* shape = AddShapeSpecializationNode(
+          graph, call, strings::StrCat("shape_", i), "Shape");
+      shape->add_input(call.input(i));
+      (*shape->mutable_attr())["T"].set_type(input_props[i].dtype());
+      (*shape->mutable_attr())["out_type"].set_type(DT_INT64);
+      shapes->add_input(shape->name());
+    }
+    shapes->add_input(
+        AddShapeSpecializationConst(graph, call, "axis", Tensor(0))->name());
+    (*shapes->mutable_attr())["N"].set_i(num_inputs);
+    (*shapes->mutable_attr())["T"].set_type(DT_INT64);
+    (*shapes->mutable_attr())["Tidx"].set_type(DT_INT32);
+    const string shapes_name = shapes->name();
+
+    // matches[k] = All(shapes == bucket_k)
+    NodeDef* matches =
+        AddShapeSpecializationNode(graph, call, "matches", "Pack");
+    const int num_branches = valid_buckets.size();
+    for (int k = 0; k < num_branches; ++k) {
+      std::vector<int64_t> dims;
+      for (int i = 0; i < num_inputs; ++i) {
+        for (const auto& dim :
+             buckets[valid_buckets[k] * num_inputs + i].dim()) {
+          dims.push_back(dim.size());
+        }
+      }
+      Tensor bucket_dims(DT_INT64, TensorShape({static_cast<int64_t>(
+                                       dims.size())}));
+      std::copy(dims.begin(), dims.end(), bucket_dims.flat<int64_t>().data());
+      NodeDef* bucket = AddShapeSpecializationConst(
+          graph, call, strings::StrCat("bucket_", k), bucket_dims);
+      NodeDef* equal = AddShapeSpecializationNode(
+          graph, call, strings::StrCat("equal_", k), "Equal");
+      equal->add_input(shapes_name);
+      equal->add_input(bucket->name());
+      (*equal->mutable_attr())["T"].set_type(DT_INT64);
+      NodeDef* all = AddShapeSpecializationNode(
+          graph, call, strings::StrCat("match_", k), "All");
+      all->add_input(equal->name());
+      all->add_input(AddShapeSpecializationConst(
+                         graph, call, strings::StrCat("reduce_", k), Tensor(0))
+                         ->name());
+      (*all->mutable_attr())["Tidx"].set_type(DT_INT32);
+      matches->add_input(all->name());
+    }
+    (*matches->mutable_attr())["N"].set_i(num_branches);
+    (*matches->mutable_attr())["T"].set_type(DT_BOOL);
+    (*matches->mutable_attr())["axis"].set_i(0);
+    const string matches_name = matches->name();
+
+    // branch_index = Min(matches ? [0, ..., K-1] : K), with the original
+    // function as the last branch.
+    Tensor branch_ids(DT_INT32, TensorShape({num_branches}));
+    std::iota(branch_ids.flat<int32>().data(),
+              branch_ids.flat<int32>().data() + num_branches, 0);
+    NodeDef* candidates =
+        AddShapeSpecializationNode(graph, call, "candidates", "SelectV2");
+    candidates->add_input(matches_name);
+    candidates->add_input(
+        AddShapeSpecializationConst(graph, call, "branch_ids", branch_ids)
+            ->name());
+    candidates->add_input(AddShapeSpecializationConst(graph, call, "fallback",
+                                                      Tensor(num_branches))
+                              ->name());
+    (*candidates->mutable_attr())["T"].set_type(DT_INT32);
+    const string candidates_name = candidates->name();
+    NodeDef* branch_index =
+        AddShapeSpecializationNode(graph, call, "branch_index", "Min");
+    branch_index->add_input(candidates_name);
+    branch_index->add_input(
+        AddShapeSpecializationConst(graph, call, "reduce", Tensor(0))->name());
+    (*branch_index->mutable_attr())["T"].set_type(DT_INT32);
+    (*branch_index->mutable_attr())["Tidx"].set_type(DT_INT32);
+    const string branch_index_name = branch_index->name();
+
+    // Rewrites the call into a Case op with the same name, inputs and
+    // outputs.
+    call.set_op(IsStatefulPartitionedCall(call) ? kCaseOp : kStatelessCaseOp);
+    call.mutable_input()->Add();
+    for (int i = call.input_size() - 1; i > 0; --i) {
+      call.mutable_input()->SwapElements(i, i - 1);
+    }
+    call.set_input(0, branch_index_name);
+    auto* attr = call.mutable_attr();
+    auto* branch_list = (*attr)["branches"].mutable_list();
+    for (const string& branch : branches) {
+      // The copies take the same function attributes as the original.
+      NameAttrList* func = branch_list->add_func();
+      *func = attr->at("f").func();
+      func->set_name(branch);
+    }
+    *branch_list->add_func() = attr->at("f").func();
+    (*attr)["output_shapes"].mutable_list();
+    for (const char* call_attr : {"f", "config", "config_proto",
+                                  "executor_type"}) {
+      attr->erase(call_attr);
+    }
+    *graph->mutable_node(call_index) = std::move(call);
+  }
+  return absl::OkStatus();
+}
+
 Status ImplementationSelector::SelectImplementation(GraphDef* graph) const {
   if (!graph->has_library()) {
     VLOG(2) << "Skipping graph since it does not have function def";
@@ -413,6 +649,17 @@ Status ImplementationSelector::Optimize(Cluster* cluster,
     *optimized_graph = item.graph;
     VLOG(2) << "Could not rewrite device index due to error:" << status;
   }
+  // Only graphs with shapes to specialize for pay for the copy that undoes a
+  // failed specialization.
+  if (std::any_of(optimized_graph->node().begin(),
+                  optimized_graph->node().end(), HasShapeSpecialization)) {
+    GraphDef graph_before_specialization = *optimized_graph;
+    status = SpecializeInputShapes(item, optimized_graph);
+    if (!status.ok()) {
+      *optimized_graph = std::move(graph_before_specialization);
+      VLOG(2) << "Could not specialize input shapes due to error:" << status;
+    }
+  }
   return SelectImplementation(optimized_graph);
 }
 
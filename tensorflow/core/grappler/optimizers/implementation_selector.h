@@ -43,6 +43,10 @@ namespace grappler {
 // (1) Utilize case op and dynamacically change the branch index.
 // (2) Swap function implementation, it will be deprecated.
 //
+// In addition, function calls annotated with the input shapes they commonly
+// run with are dispatched at runtime to copies of the function specialized
+// for those shapes, see SpecializeInputShapes.
+//
 // Idea for approach 1.
 // This transformation rewrites the DeviceIndex op with a Const op with value
 // of the index of the device the associcated Case op runs.
@@ -187,6 +191,47 @@ class ImplementationSelector : public CustomGraphOptimizer {
   // }
   Status SelectDeviceIndex(GraphDef* graph) const;
 
+  // Rewrites the function calls annotated with `_specialize_input_shapes`
+  // into a Case op dispatching on the shapes of the call inputs.
+  //
+  // The attribute is a list of shapes holding one shape per function input
+  // for each bucket, e.g. the input shapes observed while warming up a
+  // serving model with a dynamic batch size. For each bucket, the function
+  // is copied with the shapes attached to its arguments, so that the function
+  // optimizers see static shapes in its body. The Case op runs the first
+  // specialized copy whose shapes equal the actual input shapes, and the
+  // original function otherwise.
+  //
+  // Example input nodes:
+  // node {
+  //   name: "call"
+  //   op: "PartitionedCall"
+  //   input: "x"
+  //   attr { key: "f" value { func { name: "MyFunc" } } }
+  //   attr {
+  //     key: "_specialize_input_shapes"
+  //     value { list { shape { dim { size: 1 } dim { size: 128 } }
+  //                    shape { dim { size: 8 } dim { size: 128 } } } }
+  //   }
+  //   ...
+  // }
+  // Example output nodes:
+  // node {
+  //   name: "call"
+  //   op: "StatelessCase"
+  //   input: "call/ShapeSpecialization/branch_index"
+  //   input: "x"
+  //   attr {
+  //     key: "branches"
+  //     value { list { func { name: "MyFunc_input_shapes_0" }
+  //                    func { name: "MyFunc_input_shapes_1" }
+  //                    func { name: "MyFunc" } } }
+  //   }
+  //   ...
+  // }
+  Status SpecializeInputShapes(const GrapplerItem& item,
+                               GraphDef* graph) const;
+
   std::unique_ptr<FunctionLibraryApiInfo> lib_info_;
 
   ImplementationSelector(const ImplementationSelector&) = delete;
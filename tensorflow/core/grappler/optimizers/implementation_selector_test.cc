@@ -508,6 +508,83 @@ TEST_F(ImplementationSelectorTest, SwapImplementationWithGradient) {
   test::ExpectTensorEqual<float>(twice_boosted_tensor[0],
                                  test::AsScalar<float>(2.0f));
 }
+
+TEST_F(ImplementationSelectorTest, SpecializeInputShapes) {
+  using test::function::NDef;
+  ImplementationSelector optimizer;
+  GrapplerItem item;
+  TensorShapeProto dynamic_batch;
+  dynamic_batch.add_dim()->set_size(-1);
+  dynamic_batch.add_dim()->set_size(2);
+  AttrValue xtimestwo;
+  xtimestwo.mutable_func()->set_name("XTimesTwo");
+  (*xtimestwo.mutable_func()->mutable_attr())["T"].set_type(DT_FLOAT);
+  // Two buckets of batch size 1 and 4, and a bucket of the wrong rank.
+  AttrValue buckets;
+  for (const auto& dims : std::vector<std::vector<int64_t>>{
+           {1, 2}, {4, 2}, {3}}) {
+    TensorShapeProto* shape = buckets.mutable_list()->add_shape();
+    for (int64_t dim : dims) shape->add_dim()->set_size(dim);
+  }
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {},
+            {{"dtype", DT_FLOAT}, {"shape", dynamic_batch}}, CpuDevice),
+       NDef("y", "PartitionedCall", {"x"},
+            {{"Tin", DataTypeSlice{DT_FLOAT}},
+             {"Tout", DataTypeSlice{DT_FLOAT}},
+             {"f", xtimestwo},
+             {"_specialize_input_shapes", buckets}},
+            CpuDevice),
+       NDef("z", "Identity", {"y"}, {{"T", DT_FLOAT}}, CpuDevice)},
+      // FunctionLib
+      {test::function::XTimesTwo()});
+  item.fetch = {"z"};
+
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* call = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "y") call = &node;
+  }
+  ASSERT_NE(call, nullptr);
+  EXPECT_EQ(call->op(), "StatelessCase");
+  EXPECT_EQ(call->attr().count("_specialize_input_shapes"), 0);
+  ASSERT_EQ(call->input_size(), 2);
+  EXPECT_EQ(call->input(0), "y/ShapeSpecialization/branch_index");
+  EXPECT_EQ(call->input(1), "x");
+  const auto& branches = call->attr().at("branches").list().func();
+  ASSERT_EQ(branches.size(), 3);
+  EXPECT_EQ(branches[0].name(), "XTimesTwo_input_shapes_0");
+  EXPECT_EQ(branches[1].name(), "XTimesTwo_input_shapes_1");
+  EXPECT_EQ(branches[2].name(), "XTimesTwo");
+
+  bool found = false;
+  for (const FunctionDef& func : output.library().function()) {
+    if (func.signature().name() != "XTimesTwo_input_shapes_1") continue;
+    found = true;
+    const auto& shapes =
+        func.arg_attr().at(0).attr().at("_output_shapes").list().shape();
+    ASSERT_EQ(shapes.size(), 1);
+    ASSERT_EQ(shapes[0].dim_size(), 2);
+    EXPECT_EQ(shapes[0].dim(0).size(), 4);
+    EXPECT_EQ(shapes[0].dim(1).size(), 2);
+  }
+  EXPECT_TRUE(found);
+
+  // Both the specialized and the fallback branches compute the same values.
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  for (int64_t batch_size : {4, 3}) {
+    Tensor x(DT_FLOAT, TensorShape({batch_size, 2}));
+    test::FillIota<float>(&x, 1.0f);
+    item.feed = {{"x", x}};
+    optimized.feed = item.feed;
+    const auto expected = EvaluateFetchNodes(item);
+    const auto actual = EvaluateFetchNodes(optimized);
+    test::ExpectTensorEqual<float>(expected[0], actual[0]);
+  }
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
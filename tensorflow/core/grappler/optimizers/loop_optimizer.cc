@@ -17,19 +17,28 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <functional>
 #include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
@@ -39,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -715,6 +725,464 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return absl::OkStatus();
 }
 
+// Hoists loop invariant computations out of the bodies of functional While
+// ops. A node of the body is invariant if it is stateless and only depends on
+// constants and on loop variables that the body passes through unchanged.
+// Every invariant value that the rest of the body uses is computed once in
+// front of the While and passed into the loop as an extra loop variable, so
+// that it is no longer recomputed on every iteration. The hoisted nodes run
+// even if the loop runs zero times, which is why this is only done in
+// aggressive mode.
+class WhileLoopInvariantNodeMotion {
+ public:
+  explicit WhileLoopInvariantNodeMotion(GraphDef* optimized_graph)
+      : optimized_graph_(optimized_graph),
+        flib_(OpRegistry::Global(), optimized_graph->library()) {}
+
+  Status Optimize();
+
+ private:
+  Status OptimizeWhile(NodeDef* while_node);
+  // Returns the index of output `output_name:index` of `node` among all the
+  // outputs of the node.
+  Status FlatOutputIndex(const NodeDef& node, absl::string_view output_name,
+                         int index, int* flat_index) const;
+  // Returns the node and flat output index of function body output `output`.
+  Status ParseFunctionOutput(
+      const absl::flat_hash_map<string, const NodeDef*>& body_nodes,
+      const string& output, const NodeDef** node, int* flat_index) const;
+  string UniqueNodeName(const string& name);
+  string UniqueFunctionName(const string& name) const;
+
+  GraphDef* optimized_graph_;  // Not owned.
+  FunctionLibraryDefinition flib_;
+  absl::flat_hash_set<string> node_names_;
+};
+
+// Returns the name of the node or argument that input `input` of a node in a
+// function body refers to.
+string FunctionInputName(absl::string_view input) {
+  absl::ConsumePrefix(&input, "^");
+  return string(input.substr(0, input.find(':')));
+}
+
+// Returns true if `node` of a function body can be evaluated outside of it.
+bool CanHoistFromFunctionBody(const NodeDef& node) {
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+    return false;
+  }
+  if (op_def->is_stateful() || IsControlFlow(node)) return false;
+  for (const auto& attr : node.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return false;
+    }
+  }
+  return node.input_size() > 0 || IsConstant(node);
+}
+
+Status WhileLoopInvariantNodeMotion::FlatOutputIndex(
+    const NodeDef& node, absl::string_view output_name, int index,
+    int* flat_index) const {
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(node.op(), &op_def));
+  NodeDef node_with_defaults = node;
+  AddDefaultsToNodeDef(*op_def, &node_with_defaults);
+  NameRangeMap outputs;
+  TF_RETURN_IF_ERROR(
+      NameRangesForNode(node_with_defaults, *op_def, nullptr, &outputs));
+  const auto it = outputs.find(output_name);
+  if (it == outputs.end() || it->second.first + index >= it->second.second) {
+    return errors::InvalidArgument("Node ", node.name(), " has no output ",
+                                   output_name, ":", index);
+  }
+  *flat_index = it->second.first + index;
+  return absl::OkStatus();
+}
+
+Status WhileLoopInvariantNodeMotion::ParseFunctionOutput(
+    const absl::flat_hash_map<string, const NodeDef*>& body_nodes,
+    const string& output, const NodeDef** node, int* flat_index) const {
+  const std::vector<string> parts = absl::StrSplit(output, ':');
+  int index = 0;
+  const auto it = body_nodes.find(parts[0]);
+  if (it == body_nodes.end() || parts.size() > 3 ||
+      (parts.size() == 3 && !absl::SimpleAtoi(parts[2], &index))) {
+    return errors::InvalidArgument("Invalid function body output ", output);
+  }
+  *node = it->second;
+  *flat_index = 0;
+  if (parts.size() > 1) {
+    TF_RETURN_IF_ERROR(FlatOutputIndex(**node, parts[1], index, flat_index));
+  }
+  return absl::OkStatus();
+}
+
+string WhileLoopInvariantNodeMotion::UniqueNodeName(const string& name) {
+  string unique_name = name;
+  for (int i = 1; node_names_.contains(unique_name); ++i) {
+    unique_name = strings::StrCat(name, "_", i);
+  }
+  node_names_.insert(unique_name);
+  return unique_name;
+}
+
+string WhileLoopInvariantNodeMotion::UniqueFunctionName(
+    const string& name) const {
+  string unique_name = name;
+  for (int i = 1; flib_.Find(unique_name) != nullptr; ++i) {
+    unique_name = strings::StrCat(name, "_", i);
+  }
+  return unique_name;
+}
+
+Status WhileLoopInvariantNodeMotion::Optimize() {
+  for (const NodeDef& node : optimized_graph_->node()) {
+    node_names_.insert(node.name());
+  }
+  // Hoisting adds nodes to the graph, so the While nodes are looked up by
+  // index.
+  const int num_nodes = optimized_graph_->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    if (IsWhile(optimized_graph_->node(i))) {
+      TF_RETURN_IF_ERROR(OptimizeWhile(optimized_graph_->mutable_node(i)));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status WhileLoopInvariantNodeMotion::OptimizeWhile(NodeDef* while_node) {
+  const NameAttrList* cond_attr;
+  const NameAttrList* body_attr;
+  TF_RETURN_IF_ERROR(GetNodeAttr(*while_node, "cond", &cond_attr));
+  TF_RETURN_IF_ERROR(GetNodeAttr(*while_node, "body", &body_attr));
+  const FunctionDef* cond = flib_.Find(cond_attr->name());
+  const FunctionDef* body = flib_.Find(body_attr->name());
+  if (cond == nullptr || body == nullptr || !cond_attr->attr().empty() ||
+      !body_attr->attr().empty() || HasParametrizedType(*body) ||
+      HasParametrizedBody(*body) || while_node->has_experimental_type()) {
+    return absl::OkStatus();
+  }
+
+  std::vector<string> outer_inputs;
+  std::vector<string> control_inputs;
+  for (const string& input : while_node->input()) {
+    (IsControlInput(input) ? control_inputs : outer_inputs).push_back(input);
+  }
+  const int num_vars = body->signature().input_arg_size();
+  if (outer_inputs.size() != static_cast<size_t>(num_vars) ||
+      body->signature().output_arg_size() != num_vars ||
+      cond->signature().input_arg_size() != num_vars) {
+    return absl::OkStatus();
+  }
+
+  absl::flat_hash_map<string, int> arg_index;
+  for (int i = 0; i < num_vars; ++i) {
+    arg_index[body->signature().input_arg(i).name()] = i;
+  }
+  absl::flat_hash_map<string, const NodeDef*> body_nodes;
+  for (const NodeDef& node : body->node_def()) {
+    body_nodes[node.name()] = &node;
+  }
+  // Follows Identity nodes from a body input or result until it reaches an
+  // input argument, and returns the argument name or an empty string.
+  auto forwarded_arg = [&](string input) -> string {
+    for (size_t i = 0; i <= body_nodes.size(); ++i) {
+      if (arg_index.contains(input)) return input;
+      const std::vector<string> parts = absl::StrSplit(input, ':');
+      if (parts.size() != 3 || parts[2] != "0") break;
+      const auto it = body_nodes.find(parts[0]);
+      if (it == body_nodes.end() || !IsIdentity(*it->second) ||
+          it->second->input_size() != 1) {
+        break;
+      }
+      input = it->second->input(0);
+    }
+    return "";
+  };
+
+  // A loop variable is invariant if the body returns it unchanged.
+  absl::flat_hash_set<string> invariant_args;
+  for (int i = 0; i < num_vars; ++i) {
+    const string& arg_name = body->signature().input_arg(i).name();
+    const auto ret = body->ret().find(body->signature().output_arg(i).name());
+    if (ret != body->ret().end() && forwarded_arg(ret->second) == arg_name) {
+      invariant_args.insert(arg_name);
+    }
+  }
+  if (invariant_args.empty()) return absl::OkStatus();
+
+  // The nodes of a function body are not sorted, so the invariant nodes are
+  // found by iterating to a fixed point.
+  absl::flat_hash_set<string> invariant_nodes;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const NodeDef& node : body->node_def()) {
+      if (invariant_nodes.contains(node.name()) ||
+          !CanHoistFromFunctionBody(node)) {
+        continue;
+      }
+      bool is_invariant = true;
+      for (const string& input : node.input()) {
+        if (IsControlInput(input) ||
+            (arg_index.contains(input)
+                 ? !invariant_args.contains(input)
+                 : !invariant_nodes.contains(FunctionInputName(input)))) {
+          is_invariant = false;
+          break;
+        }
+      }
+      if (is_invariant) {
+        invariant_nodes.insert(node.name());
+        changed = true;
+      }
+    }
+  }
+
+  // Constants, and identities of constants or of invariant loop variables,
+  // are as cheap to evaluate in the body as to pass in, so only the other
+  // invariant values are hoisted.
+  std::function<bool(const string&)> is_cheap = [&](const string& node_name) {
+    const NodeDef* node = body_nodes[node_name];
+    if (IsConstant(*node)) return true;
+    if (!IsIdentity(*node)) return false;
+    return arg_index.contains(node->input(0)) ||
+           is_cheap(FunctionInputName(node->input(0)));
+  };
+  auto hoisted_value = [&](const string& input) {
+    return !IsControlInput(input) && !arg_index.contains(input) &&
+           invariant_nodes.contains(FunctionInputName(input)) &&
+           !is_cheap(FunctionInputName(input));
+  };
+  std::vector<string> hoisted_values;
+  absl::flat_hash_set<string> seen_values;
+  for (const NodeDef& node : body->node_def()) {
+    if (invariant_nodes.contains(node.name())) continue;
+    for (const string& input : node.input()) {
+      if (hoisted_value(input) && seen_values.insert(input).second) {
+        hoisted_values.push_back(input);
+      }
+    }
+  }
+  for (const auto& ret : body->ret()) {
+    if (hoisted_value(ret.second) && seen_values.insert(ret.second).second) {
+      hoisted_values.push_back(ret.second);
+    }
+  }
+  if (hoisted_values.empty()) return absl::OkStatus();
+  // Sort the values to make the rewrite deterministic.
+  std::sort(hoisted_values.begin(), hoisted_values.end());
+
+  // Copy the invariant nodes the hoisted values depend on in front of the
+  // While, mapping the invariant loop variables to the While inputs.
+  absl::flat_hash_map<string, string> outer_names;
+  std::vector<const NodeDef*> to_copy;
+  std::deque<string> queue;
+  for (const string& value : hoisted_values) {
+    queue.push_back(FunctionInputName(value));
+  }
+  while (!queue.empty()) {
+    const string node_name = queue.front();
+    queue.pop_front();
+    if (outer_names.contains(node_name)) continue;
+    outer_names[node_name] = UniqueNodeName(
+        strings::StrCat(while_node->name(), "/licm/", node_name));
+    to_copy.push_back(body_nodes[node_name]);
+    for (const string& input : body_nodes[node_name]->input()) {
+      if (!arg_index.contains(input)) {
+        queue.push_back(FunctionInputName(input));
+      }
+    }
+  }
+  // Maps a body input of an invariant node to the corresponding outer tensor.
+  auto outer_tensor = [&](const string& input, string* outer) -> Status {
+    const auto arg = arg_index.find(input);
+    if (arg != arg_index.end()) {
+      *outer = outer_inputs[arg->second];
+      return absl::OkStatus();
+    }
+    const NodeDef* node;
+    int flat_index;
+    TF_RETURN_IF_ERROR(
+        ParseFunctionOutput(body_nodes, input, &node, &flat_index));
+    const string& name = outer_names[node->name()];
+    *outer = flat_index == 0 ? name : strings::StrCat(name, ":", flat_index);
+    return absl::OkStatus();
+  };
+
+  std::vector<NodeDef> copies;
+  for (const NodeDef* node : to_copy) {
+    NodeDef copy;
+    copy.set_name(outer_names[node->name()]);
+    copy.set_op(node->op());
+    copy.set_device(node->device().empty() ? while_node->device()
+                                           : node->device());
+    for (const auto& attr : node->attr()) {
+      // Colocation constraints refer to nodes of the body.
+      if (attr.first != kColocationAttrName) {
+        (*copy.mutable_attr())[attr.first] = attr.second;
+      }
+    }
+    for (const string& input : node->input()) {
+      TF_RETURN_IF_ERROR(outer_tensor(input, copy.add_input()));
+    }
+    if (node->input_size() == 0 && num_vars > 0) {
+      // Anchor constants to the While's inputs so that they run in the same
+      // frame.
+      *copy.add_input() = AsControlDependency(NodeName(outer_inputs[0]));
+    }
+    for (const string& input : control_inputs) *copy.add_input() = input;
+    copies.push_back(std::move(copy));
+  }
+
+  std::vector<string> new_inputs;
+  std::vector<DataType> new_types;
+  for (const string& value : hoisted_values) {
+    string outer;
+    TF_RETURN_IF_ERROR(outer_tensor(value, &outer));
+    new_inputs.push_back(outer);
+    const NodeDef* node;
+    int flat_index;
+    TF_RETURN_IF_ERROR(
+        ParseFunctionOutput(body_nodes, value, &node, &flat_index));
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(node->op(), &op_def));
+    NodeDef node_with_defaults = *node;
+    AddDefaultsToNodeDef(*op_def, &node_with_defaults);
+    DataType dtype;
+    TF_RETURN_IF_ERROR(
+        OutputTypeForNode(node_with_defaults, *op_def, flat_index, &dtype));
+    new_types.push_back(dtype);
+  }
+
+  // Pass the hoisted values through new copies of the body and condition.
+  absl::flat_hash_set<string> body_names;
+  absl::flat_hash_set<string> cond_names;
+  for (const auto& arg : body->signature().input_arg()) {
+    body_names.insert(arg.name());
+  }
+  for (const auto& arg : body->signature().output_arg()) {
+    body_names.insert(arg.name());
+  }
+  for (const auto& node : body->node_def()) body_names.insert(node.name());
+  for (const auto& arg : cond->signature().input_arg()) {
+    cond_names.insert(arg.name());
+  }
+  for (const auto& node : cond->node_def()) cond_names.insert(node.name());
+  auto add_unique_name = [](const string& name,
+                            absl::flat_hash_set<string>* names) {
+    string unique_name = name;
+    for (int i = 1; names->contains(unique_name); ++i) {
+      unique_name = strings::StrCat(name, "_", i);
+    }
+    names->insert(unique_name);
+    return unique_name;
+  };
+
+  FunctionDef new_body = *body;
+  FunctionDef new_cond = *cond;
+  new_body.mutable_signature()->set_name(
+      UniqueFunctionName(strings::StrCat(body->signature().name(), "_licm")));
+  new_cond.mutable_signature()->set_name(
+      UniqueFunctionName(strings::StrCat(cond->signature().name(), "_licm")));
+  absl::flat_hash_map<string, string> replacements;
+  for (int i = 0; i < hoisted_values.size(); ++i) {
+    const string arg_name = add_unique_name("licm_arg", &body_names);
+    const string out_name = add_unique_name("licm_arg_out", &body_names);
+    OpDef::ArgDef* arg = new_body.mutable_signature()->add_input_arg();
+    arg->set_name(arg_name);
+    arg->set_type(new_types[i]);
+    OpDef::ArgDef* out = new_body.mutable_signature()->add_output_arg();
+    out->set_name(out_name);
+    out->set_type(new_types[i]);
+    (*new_body.mutable_ret())[out_name] = arg_name;
+    replacements[hoisted_values[i]] = arg_name;
+
+    OpDef::ArgDef* cond_arg = new_cond.mutable_signature()->add_input_arg();
+    cond_arg->set_name(add_unique_name("licm_arg", &cond_names));
+    cond_arg->set_type(new_types[i]);
+  }
+  for (NodeDef& node : *new_body.mutable_node_def()) {
+    if (invariant_nodes.contains(node.name())) continue;
+    for (string& input : *node.mutable_input()) {
+      const auto it = replacements.find(input);
+      if (it != replacements.end()) input = it->second;
+    }
+  }
+  for (auto& ret : *new_body.mutable_ret()) {
+    const auto it = replacements.find(ret.second);
+    if (it != replacements.end()) ret.second = it->second;
+  }
+
+  // Remove the invariant nodes that the body no longer uses.
+  absl::flat_hash_set<string> live_nodes;
+  std::deque<string> live_queue;
+  for (const NodeDef& node : new_body.node_def()) {
+    if (!invariant_nodes.contains(node.name())) {
+      live_queue.push_back(node.name());
+    }
+  }
+  for (const auto& ret : new_body.ret()) {
+    live_queue.push_back(FunctionInputName(ret.second));
+  }
+  for (const auto& control_ret : new_body.control_ret()) {
+    live_queue.push_back(control_ret.second);
+  }
+  while (!live_queue.empty()) {
+    const string node_name = live_queue.front();
+    live_queue.pop_front();
+    const auto it = body_nodes.find(node_name);
+    if (it == body_nodes.end() || !live_nodes.insert(node_name).second) {
+      continue;
+    }
+    for (const string& input : it->second->input()) {
+      live_queue.push_back(FunctionInputName(input));
+    }
+  }
+  auto* body_node_defs = new_body.mutable_node_def();
+  body_node_defs->erase(
+      std::remove_if(body_node_defs->begin(), body_node_defs->end(),
+                     [&](const NodeDef& node) {
+                       return !live_nodes.contains(node.name());
+                     }),
+      body_node_defs->end());
+
+  VLOG(2) << "Hoisted " << hoisted_values.size()
+          << " loop invariant values out of " << while_node->name();
+  TF_RETURN_IF_ERROR(flib_.AddFunctionDef(new_body));
+  TF_RETURN_IF_ERROR(flib_.AddFunctionDef(new_cond));
+  *optimized_graph_->mutable_library()->add_function() = new_body;
+  *optimized_graph_->mutable_library()->add_function() = new_cond;
+
+  // Rewire the While. Its new outputs are not used.
+  auto* attrs = while_node->mutable_attr();
+  (*attrs)["cond"].mutable_func()->set_name(new_cond.signature().name());
+  (*attrs)["body"].mutable_func()->set_name(new_body.signature().name());
+  while_node->clear_input();
+  for (const string& input : outer_inputs) *while_node->add_input() = input;
+  for (const string& input : new_inputs) *while_node->add_input() = input;
+  for (const string& input : control_inputs) *while_node->add_input() = input;
+  auto* types = (*attrs)["T"].mutable_list();
+  for (DataType dtype : new_types) types->add_type(dtype);
+  for (const char* shapes_attr : {"output_shapes", "_output_shapes"}) {
+    auto it = attrs->find(shapes_attr);
+    if (it == attrs->end() ||
+        it->second.list().shape_size() != num_vars) {
+      continue;
+    }
+    for (int i = 0; i < new_types.size(); ++i) {
+      it->second.mutable_list()->add_shape()->set_unknown_rank(true);
+    }
+  }
+
+  // Adding nodes may invalidate `while_node`, so this is done last.
+  for (NodeDef& copy : copies) {
+    *optimized_graph_->add_node() = std::move(copy);
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -726,7 +1194,7 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -734,7 +1202,8 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
-      !options_.enable_dead_branch_removal) {
+      !options_.enable_dead_branch_removal &&
+      !options_.enable_while_loop_invariant_node_motion) {
     return errors::Aborted("Nothing to do.");
   }
   *optimized_graph = item.graph;
@@ -743,6 +1212,10 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     LoopInvariantNodeMotionOptimizer linm_optimizer(optimized_graph);
     TF_RETURN_IF_ERROR(linm_optimizer.Optimize());
   }
+  if (options_.enable_while_loop_invariant_node_motion) {
+    WhileLoopInvariantNodeMotion while_linm_optimizer(optimized_graph);
+    TF_RETURN_IF_ERROR(while_linm_optimizer.Optimize());
+  }
   if (options_.enable_stack_push_removal) {
     TF_RETURN_IF_ERROR(RemoveStackOps(item.NodesToPreserve(), optimized_graph));
   }
@@ -40,7 +40,9 @@ class LoopOptimizer : public GraphOptimizer {
 
   string name() const override { return "loop_optimizer"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override {
+    return options_.enable_while_loop_invariant_node_motion;
+  }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
@@ -53,9 +55,14 @@ class LoopOptimizer : public GraphOptimizer {
     bool enable_loop_invariant_node_motion = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
+    // Hoists invariant nodes out of the bodies of functional While ops. The
+    // hoisted nodes run even if the loop runs zero times.
+    bool enable_while_loop_invariant_node_motion = false;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_while_loop_invariant_node_motion =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
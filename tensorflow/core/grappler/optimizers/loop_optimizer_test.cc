@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -1802,5 +1804,87 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, HoistInvariantNodesOutOfFunctionalWhile) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // The body computes x += y * y, where y is loop invariant.
+  FunctionDef body = FDH::Create(
+      "Body", {"x: float", "y: float"}, {"x_out: float", "y_out: float"}, {},
+      {{{"mul"}, "Mul", {"y", "y"}, {{"T", DT_FLOAT}}},
+       {{"add"}, "Add", {"x", "mul:z:0"}, {{"T", DT_FLOAT}}}},
+      {{"x_out", "add:z:0"}, {"y_out", "y"}});
+  FunctionDef cond = FDH::Create(
+      "Cond", {"x: float", "y: float"}, {"pred: bool"}, {},
+      {FDH::Const("limit", 10.0f),
+       {{"less"}, "Less", {"x", "limit:output:0"}, {{"T", DT_FLOAT}}}},
+      {{"pred", "less:z:0"}});
+
+  AttrValue body_attr;
+  body_attr.mutable_func()->set_name("Body");
+  AttrValue cond_attr;
+  cond_attr.mutable_func()->set_name("Cond");
+  AttrValue output_shapes;
+  output_shapes.mutable_list()->add_shape();
+  output_shapes.mutable_list()->add_shape();
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Const", {},
+            {{"value", test::AsScalar<float>(0.0f)}, {"dtype", DT_FLOAT}}),
+       NDef("y", "Const", {},
+            {{"value", test::AsScalar<float>(3.0f)}, {"dtype", DT_FLOAT}}),
+       NDef("while", "While", {"x", "y"},
+            {{"T", DataTypeSlice{DT_FLOAT, DT_FLOAT}},
+             {"body", body_attr},
+             {"cond", cond_attr},
+             {"output_shapes", output_shapes}}),
+       NDef("out", "Identity", {"while"}, {{"T", DT_FLOAT}})},
+      {body, cond});
+  item.fetch = {"out"};
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+
+  // Hoisting is only done in aggressive mode.
+  LoopOptimizer default_optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(default_optimizer.Optimize(nullptr, item, &output));
+  CompareGraphs(item.graph, output);
+
+  LoopOptimizer optimizer(RewriterConfig::AGGRESSIVE, nullptr);
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* hoisted = node_map.GetNode("while/licm/mul");
+  ASSERT_NE(hoisted, nullptr);
+  EXPECT_EQ(hoisted->op(), "Mul");
+  ASSERT_EQ(hoisted->input_size(), 2);
+  EXPECT_EQ(hoisted->input(0), "y");
+  EXPECT_EQ(hoisted->input(1), "y");
+
+  const NodeDef* while_node = node_map.GetNode("while");
+  ASSERT_NE(while_node, nullptr);
+  ASSERT_EQ(while_node->input_size(), 3);
+  EXPECT_EQ(while_node->input(2), "while/licm/mul");
+  EXPECT_EQ(while_node->attr().at("T").list().type_size(), 3);
+  EXPECT_EQ(while_node->attr().at("output_shapes").list().shape_size(), 3);
+  const string& new_body_name = while_node->attr().at("body").func().name();
+  EXPECT_EQ(new_body_name, "Body_licm");
+  EXPECT_EQ(while_node->attr().at("cond").func().name(), "Cond_licm");
+
+  FunctionLibraryDefinition flib(OpRegistry::Global(), output.library());
+  const FunctionDef* new_body = flib.Find(new_body_name);
+  ASSERT_NE(new_body, nullptr);
+  EXPECT_EQ(new_body->signature().input_arg_size(), 3);
+  EXPECT_EQ(new_body->signature().output_arg_size(), 3);
+  for (const NodeDef& node : new_body->node_def()) {
+    EXPECT_NE(node.op(), "Mul");
+  }
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -20,8 +20,10 @@ limitations under the License.
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
@@ -30,6 +32,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -440,9 +444,168 @@ void RecomputeSubgraph(
   }
 }
 
-void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
-                                const string& recomputation_targets_name_scope,
-                                GraphDef* graph, const GrapplerItem& item) {
+// Returns true if `node` is in `name_scope`, meaning that its name either
+// begins with the scope or contains it after a "/".
+bool IsInNameScope(const NodeDef& node, const string& name_scope) {
+  return absl::StartsWith(node.name(), name_scope) ||
+         absl::StrContains(node.name(), absl::StrCat("/", name_scope));
+}
+
+// Selects the forward activations to recompute in the backward pass so that the
+// peak memory usage of every device fits in `budget_bytes`, or in the memory
+// size of the device if `budget_bytes` is 0. Of the activations live at the
+// peak that nodes in `gradient_scope` consume, the ones that free the most
+// memory per nanosecond of recomputation predicted by the cost model are
+// recomputed first. Recomputing an activation keeps its inputs alive until its
+// gradient uses, so only the inputs that are live at the peak anyway are free.
+std::unordered_set<string> SelectActivationsToRecompute(
+    Cluster* cluster, const GrapplerItem& item, const string& gradient_scope,
+    int64_t budget_bytes) {
+  std::unordered_set<string> nodes_to_recompute;
+  GraphMemory memory(item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.message();
+    return nodes_to_recompute;
+  }
+  GraphProperties properties(item);
+  if (!properties
+           .InferStatically(/*assume_valid_feeds=*/true,
+                            /*aggressive_shape_inference=*/false,
+                            /*include_tensor_values=*/false)
+           .ok()) {
+    return nodes_to_recompute;
+  }
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item.feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  std::unordered_map<string, const NodeDef*> name_map;
+  for (const NodeDef& node : item.graph.node()) {
+    name_map[node.name()] = &node;
+  }
+  // The outputs consumed by gradient nodes, as "node:port".
+  std::unordered_set<string> gradient_inputs;
+  for (const NodeDef& node : item.graph.node()) {
+    if (!IsInNameScope(node, gradient_scope)) {
+      continue;
+    }
+    for (const string& input : node.input()) {
+      const int port = NodePosition(input);
+      if (port >= 0) {
+        gradient_inputs.insert(strings::StrCat(NodeName(input), ":", port));
+      }
+    }
+  }
+  const auto is_recomputable = [&](const NodeDef& node) {
+    if (IsInNameScope(node, gradient_scope) || feeds.count(node.name()) > 0 ||
+        NumNonControlInputs(node) == 0 || IsControlFlow(node) ||
+        !IsFreeOfSideEffect(node)) {
+      return false;
+    }
+    for (const string& input : node.input()) {
+      auto it = name_map.find(NodeName(input));
+      if (it == name_map.end() || IsInNameScope(*it->second, gradient_scope)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  OpLevelCostEstimator estimator;
+  for (const auto& device : cluster->GetDevices()) {
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    const int64_t budget =
+        budget_bytes > 0 ? budget_bytes : device.second.memory_size();
+    int64_t required_savings = mem_usage.used_memory - budget;
+    if (mem_usage.live_tensors.empty() || budget <= 0 ||
+        required_savings <= 0) {
+      continue;
+    }
+    std::unordered_set<string> live_at_peak;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      live_at_peak.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    struct Candidate {
+      const NodeDef* node;
+      int64_t savings;
+      double savings_per_ns;
+    };
+    std::vector<Candidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      auto it = name_map.find(live_tensor.node);
+      if (it == name_map.end() ||
+          nodes_to_recompute.count(live_tensor.node) > 0 ||
+          gradient_inputs.count(strings::StrCat(
+              live_tensor.node, ":", live_tensor.output_id)) == 0 ||
+          !is_recomputable(*it->second)) {
+        continue;
+      }
+      const NodeDef& node = *it->second;
+      const std::vector<OpInfo::TensorProperties>& input_props =
+          properties.GetInputProperties(node.name());
+      int64_t savings = live_tensor.memory_used;
+      const int num_inputs =
+          std::min<int>(node.input_size(), input_props.size());
+      for (int i = 0; i < num_inputs; ++i) {
+        const NodeDef* input = name_map[NodeName(node.input(i))];
+        if (IsControlInput(node.input(i)) || NumNonControlInputs(*input) == 0 ||
+            live_at_peak.count(strings::StrCat(
+                input->name(), ":", NodePosition(node.input(i)))) > 0) {
+          continue;
+        }
+        savings -= CalculateTensorSize(input_props[i]);
+      }
+      if (savings <= 0) {
+        continue;
+      }
+
+      OpContext op_context;
+      op_context.name = node.name();
+      op_context.device_name = device.first;
+      op_context.op_info =
+          BuildOpInfoWithoutDevice(node, name_map, input_props);
+      for (const auto& output : properties.GetOutputProperties(node.name())) {
+        *op_context.op_info.add_outputs() = output;
+      }
+      *op_context.op_info.mutable_device() = device.second;
+      const Costs costs = estimator.PredictCosts(op_context);
+      const double time_ns =
+          std::max<double>(costs.execution_time.count(), 1.0);
+      candidates.push_back({&node, savings, savings / time_ns});
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) {
+                return a.savings_per_ns > b.savings_per_ns;
+              });
+    for (const Candidate& candidate : candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      if (!nodes_to_recompute.insert(candidate.node->name()).second) {
+        continue;
+      }
+      VLOG(1) << "Will recompute " << candidate.node->name() << " to save "
+              << candidate.savings << " bytes on " << device.first;
+      required_savings -= candidate.savings;
+    }
+    if (required_savings > 0) {
+      VLOG(1) << "Recomputation can't fit the peak memory usage of "
+              << device.first << " in " << budget << " bytes";
+    }
+  }
+  return nodes_to_recompute;
+}
+
+void RecomputationRewritingPass(
+    RewriterConfig::MemOptType optimization_level,
+    const string& recomputation_targets_name_scope,
+    const std::unordered_set<string>& nodes_to_recompute, GraphDef* graph,
+    const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
   // looks up nodes which were in the original graph, and preserves the graph
@@ -466,10 +629,7 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
         // meaning it either begins with or contains the name scope.
         // Defaults to "gradients/" which will match any node names that begins
         // with "gradients/" or contains "/gradients/".
-        return absl::StartsWith(node.name(),
-                                recomputation_targets_name_scope) ||
-               static_cast<int>(node.name().find(
-                   "/" + recomputation_targets_name_scope)) != -1;
+        return IsInNameScope(node, recomputation_targets_name_scope);
       };
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
@@ -496,6 +656,14 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                  node.attr().count(kRecomputeHint) > 0;
         },
         is_target);
+  } else if (optimization_level == RewriterConfig::AUTOMATIC_RECOMPUTATION) {
+    // The nodes selected by SelectActivationsToRecompute.
+    recomputed_subgraphs = GetOpGroupsToRecompute(
+        graph, node_map,
+        [&nodes_to_recompute](const NodeDef& node) {
+          return nodes_to_recompute.count(node.name()) > 0;
+        },
+        is_target);
   }
   if (!recomputed_subgraphs.empty()) {
     std::unordered_map<const NodeDef*, int> topological_numbering;
@@ -800,6 +968,10 @@ Status BuildSwapPair(NodeDef* node, int input_to_swap,
 struct SwapInfo {
   std::vector<int> inputs_to_swap;
   Costs::NanoSeconds time_to_swap = 0;
+  // Whether another consumer of each swapped tensor waits for it to be swapped
+  // out, which frees its memory as early as possible. Offloaded activations
+  // are rather copied out concurrently with their forward consumers.
+  bool wait_for_swap_out = true;
 };
 
 static const NodeDef* FindSwapInTrigger(
@@ -977,6 +1149,41 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
+// Estimates the times at which the nodes of the graph of `item` complete by
+// running it on a virtual cluster with the devices of `cluster`.
+static bool EstimateCompletionTimes(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* op_completion_times) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      Costs::NanoSeconds exec_time =
+          Costs::NanoSeconds(1) +
+          Costs::MicroSeconds(node_stats.all_start_micros() +
+                              node_stats.op_end_rel_micros());
+      op_completion_times->emplace(node_stats.node_name(), exec_time);
+    }
+  }
+  return true;
+}
+
+// Swaps are assumed to go over PCIe running at 16 GBps, i.e. 16 bytes per ns.
+static Costs::NanoSeconds EstimateSwapTime(int64_t bytes) {
+  return Costs::NanoSeconds(bytes / 16);
+}
+
 static bool IdentifySwappingCandidates(
     Cluster* cluster, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
@@ -1012,29 +1219,8 @@ static bool IdentifySwappingCandidates(
     int64_t required_savings = mem_usage.used_memory - prop.memory_size();
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
-    {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
-      RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
-        return false;
-      }
-
-      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
-        for (const auto& node_stats : dev_stats.node_stats()) {
-          Costs::NanoSeconds exec_time =
-              Costs::NanoSeconds(1) +
-              Costs::MicroSeconds(node_stats.all_start_micros() +
-                                  node_stats.op_end_rel_micros());
-          op_completion_times.emplace(node_stats.node_name(), exec_time);
-        }
-      }
+    if (!EstimateCompletionTimes(cluster, *item, &op_completion_times)) {
+      return false;
     }
 
     Costs::Duration peak_time = -1;
@@ -1146,9 +1332,126 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
+// Selects the forward activations to offload to the host: the tensors live at
+// the peak memory usage of a GPU that the nodes in `gradient_scope` consume,
+// and that the cost model predicts can be copied out after their last forward
+// use and back before their first gradient use without either copy
+// overlapping the peak. Their gradient uses are added to `nodes_to_swap`.
+static bool IdentifyActivationsToOffload(
+    Cluster* cluster, GrapplerItem* item, const string& gradient_scope,
+    std::unique_ptr<GraphMemory>* memory_ptr,
+    std::unordered_set<string>* skip_list,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+  // Smaller copies are dominated by their latency rather than bandwidth.
+  constexpr int64_t kMinActivationBytes = 64 * 1024;
+
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.message();
+      return false;
+    }
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  bool estimated_completion_times = false;
+  bool updated_graph = false;
+  MutableGraphView graph(&item->graph);
+  for (const auto& device : cluster->GetDevices()) {
+    if (device.second.type() != "GPU") {
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (mem_usage.live_tensors.empty()) {
+      continue;
+    }
+    if (!estimated_completion_times) {
+      if (!EstimateCompletionTimes(cluster, *item, &op_completion_times)) {
+        return false;
+      }
+      estimated_completion_times = true;
+    }
+
+    Costs::Duration peak_time = -1;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+    }
+
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used < kMinActivationBytes ||
+          skip_list->find(live_tensor.node) != skip_list->end()) {
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr || IsInNameScope(*port.node, gradient_scope) ||
+          !IsSwappable(graph, port)) {
+        continue;
+      }
+
+      // The tensor leaves the device once its forward uses are done and
+      // returns right before its first gradient use.
+      Costs::Duration last_forward_use = live_tensor.allocation_time;
+      Costs::Duration first_gradient_use(Costs::Duration::infinity());
+      std::vector<MutableGraphView::InputPort> gradient_uses;
+      bool valid = true;
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (!IsInNameScope(*input.node, gradient_scope)) {
+          last_forward_use = std::max(last_forward_use, it->second);
+          continue;
+        }
+        if (skip_list->find(input.node->name()) != skip_list->end() ||
+            skip_list->find(strings::StrCat(input.node->name(), ":",
+                                            input.port_id)) !=
+                skip_list->end() ||
+            !IsSwappable(input)) {
+          valid = false;
+          break;
+        }
+        gradient_uses.push_back(input);
+        first_gradient_use = std::min(first_gradient_use, it->second);
+      }
+      if (!valid || gradient_uses.empty()) {
+        continue;
+      }
+
+      const Costs::NanoSeconds swap_time =
+          EstimateSwapTime(live_tensor.memory_used);
+      if (last_forward_use + swap_time >= peak_time ||
+          first_gradient_use - swap_time <= peak_time) {
+        VLOG(2) << "Activation " << live_tensor.node << ":"
+                << live_tensor.output_id
+                << " is not idle for long enough around the peak to offload";
+        continue;
+      }
+      for (const MutableGraphView::InputPort& use : gradient_uses) {
+        VLOG(1) << "Will offload activation " << live_tensor.node << ":"
+                << live_tensor.output_id << " of size "
+                << live_tensor.memory_used << " for its use by "
+                << use.node->name() << ":" << use.port_id;
+        SwapInfo& swap_info = (*nodes_to_swap)[use.node];
+        swap_info.inputs_to_swap.push_back(use.port_id);
+        swap_info.wait_for_swap_out = false;
+      }
+      updated_graph = true;
+    }
+  }
+  return updated_graph;
+}
+
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
-                  GrapplerItem* item, std::unordered_set<string>* skip_list) {
+                  const string& gradient_scope, Cluster* cluster,
+                  std::unique_ptr<GraphMemory>* memory, GrapplerItem* item,
+                  std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
@@ -1157,6 +1460,10 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
     IdentifySwappingCandidates(cluster, item, memory, skip_list,
                                &nodes_to_swap);
   }
+  if (optimization_level == RewriterConfig::ACTIVATION_OFFLOADING) {
+    IdentifyActivationsToOffload(cluster, item, gradient_scope, memory,
+                                 skip_list, &nodes_to_swap);
+  }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
     if (node.attr().count("_swap_to_host") != 0) {
@@ -1196,8 +1503,7 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       const OpInfo::TensorProperties& t = props[input_id];
       bytes_to_swap += CalculateTensorSize(t);
     }
-    // Let's assume we're going to swap over PCIe running at 16 GBps.
-    swap_info.time_to_swap = bytes_to_swap / 16;
+    swap_info.time_to_swap = EstimateSwapTime(bytes_to_swap);
   }
 
   std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
@@ -1244,10 +1550,12 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       // Make sure the tensor is swapped out quickly: look for node that
       // will execute just after the tensor is generated and add a control
       // dependency from the swap out node to that node.
-      NodeDef* out_trigger =
-          FindSwapOutTrigger(node, input_id, view, execution_times);
-      if (!out_trigger) {
-        continue;
+      NodeDef* out_trigger = nullptr;
+      if (swap_info.wait_for_swap_out) {
+        out_trigger = FindSwapOutTrigger(node, input_id, view, execution_times);
+        if (!out_trigger) {
+          continue;
+        }
       }
 
       std::pair<NodeDef*, NodeDef*> swap_nodes;
@@ -1259,7 +1567,10 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
       *node->mutable_input(input_id) = swap_nodes.second->name();
 
       // Add the control dependencies needed to delay the execution of the swap.
-      out_trigger->add_input(strings::StrCat("^", swap_nodes.first->name()));
+      if (out_trigger) {
+        out_trigger->add_input(
+            strings::StrCat("^", swap_nodes.first->name()));
+      }
       swap_nodes.second->add_input(strings::StrCat("^", in_trigger->name()));
 
       // Make sure we won't try to swap the swap nodes in subsequent passes.
@@ -1376,6 +1687,195 @@ Status FindAssignNodesToRelax(const GraphDef& graph,
   return absl::OkStatus();
 }
 
+// Reorders the nodes of the graph to lower its peak memory usage, with a list
+// scheduler that picks among the ready nodes the one that frees the most memory
+// or allocates the least. `latency_weight` trades this off against the
+// earliest time at which the nodes can run: at 1, nodes are scheduled in the
+// order that the executor would run them in. The order is enforced by control
+// dependencies on the nodes that increase memory usage, from the node
+// scheduled before them on their device.
+bool MemoryAwareSchedulingPass(float latency_weight, Cluster* cluster,
+                               GrapplerItem* item) {
+  // Only apply the new order if it lowers the peak of a device by this
+  // fraction, as the control dependencies constrain the executor.
+  constexpr double kMinPeakReduction = 0.05;
+
+  GraphDef* graph = &item->graph;
+  for (const NodeDef& node : graph->node()) {
+    // The frames of loops and conditionals are not modeled.
+    if (IsControlFlow(node)) return false;
+  }
+  GraphProperties properties(*item);
+  if (!properties
+           .InferStatically(/*assume_valid_feeds=*/true,
+                            /*aggressive_shape_inference=*/false,
+                            /*include_tensor_values=*/false)
+           .ok()) {
+    return false;
+  }
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
+  if (!EstimateEarliestExecutionTimes(*item, cluster, &execution_times).ok()) {
+    return false;
+  }
+
+  const int num_nodes = graph->node_size();
+  std::unordered_map<string, int> node_index;
+  for (int i = 0; i < num_nodes; ++i) {
+    node_index[graph->node(i).name()] = i;
+  }
+  // Nodes without inputs, such as constants and variables, do not allocate
+  // memory at each step and can run at any time.
+  std::vector<int64_t> output_bytes(num_nodes, 0);
+  std::vector<int64_t> earliest_time(num_nodes, 0);
+  std::vector<std::vector<int>> data_fanins(num_nodes);
+  std::vector<std::vector<int>> fanouts(num_nodes);
+  std::vector<int> num_pending_fanins(num_nodes, 0);
+  std::vector<int> num_pending_consumers(num_nodes, 0);
+  std::unordered_map<string, int> device_index;
+  std::vector<int> device(num_nodes);
+  int64_t max_output_bytes = 1;
+  int64_t max_earliest_time = 1;
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph->node(i);
+    device[i] = device_index.emplace(node.device(), device_index.size())
+                    .first->second;
+    std::unordered_set<int> fanins;
+    for (const string& input : node.input()) {
+      auto it = node_index.find(NodeName(input));
+      if (it == node_index.end()) return false;
+      if (!fanins.insert(it->second).second) continue;
+      fanouts[it->second].push_back(i);
+      if (!IsControlInput(input)) {
+        data_fanins[i].push_back(it->second);
+        ++num_pending_consumers[it->second];
+      }
+    }
+    num_pending_fanins[i] = fanins.size();
+    if (!node.input().empty() && properties.HasOutputProperties(node.name())) {
+      for (const auto& output : properties.GetOutputProperties(node.name())) {
+        output_bytes[i] += std::max<int64_t>(CalculateTensorSize(output), 0);
+      }
+    }
+    auto it = execution_times.find(&node);
+    if (it == execution_times.end()) return false;
+    earliest_time[i] = it->second.count();
+    max_output_bytes = std::max(max_output_bytes, output_bytes[i]);
+    max_earliest_time = std::max(max_earliest_time, earliest_time[i]);
+  }
+
+  // Returns the memory that scheduling `i` next allocates, net of the inputs
+  // that it is the last consumer of.
+  const auto memory_delta = [&](int i, const std::vector<int>& pending) {
+    int64_t delta = output_bytes[i];
+    for (int fanin : data_fanins[i]) {
+      if (pending[fanin] == 1) delta -= output_bytes[fanin];
+    }
+    return delta;
+  };
+  // Returns the peak memory usage of each device when running the nodes in
+  // `order`.
+  const auto peak_memory = [&](const std::vector<int>& order) {
+    std::vector<int> pending = num_pending_consumers;
+    std::vector<int64_t> live(device_index.size(), 0);
+    std::vector<int64_t> peak(device_index.size(), 0);
+    for (int i : order) {
+      live[device[i]] += output_bytes[i];
+      peak[device[i]] = std::max(peak[device[i]], live[device[i]]);
+      for (int fanin : data_fanins[i]) {
+        if (--pending[fanin] == 0) live[device[fanin]] -= output_bytes[fanin];
+      }
+    }
+    return peak;
+  };
+
+  // The order in which the nodes would run without additional constraints.
+  std::vector<int> default_order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) default_order[i] = i;
+  std::stable_sort(
+      default_order.begin(), default_order.end(),
+      [&](int a, int b) { return earliest_time[a] < earliest_time[b]; });
+
+  // Ready nodes ordered by their normalized memory delta and earliest time.
+  const auto score = [&](int i, const std::vector<int>& pending) {
+    return (1 - latency_weight) * memory_delta(i, pending) / max_output_bytes +
+           latency_weight * earliest_time[i] / max_earliest_time;
+  };
+  std::vector<int> pending_consumers = num_pending_consumers;
+  std::vector<int> pending_fanins = num_pending_fanins;
+  std::vector<double> ready_score(num_nodes);
+  std::vector<bool> scheduled(num_nodes, false);
+  std::set<std::pair<double, int>> ready;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (pending_fanins[i] == 0) {
+      ready_score[i] = score(i, pending_consumers);
+      ready.emplace(ready_score[i], i);
+    }
+  }
+  std::vector<int> order;
+  std::vector<int64_t> scheduled_delta(num_nodes, 0);
+  order.reserve(num_nodes);
+  while (!ready.empty()) {
+    const int i = ready.begin()->second;
+    ready.erase(ready.begin());
+    scheduled[i] = true;
+    scheduled_delta[i] = memory_delta(i, pending_consumers);
+    order.push_back(i);
+    for (int fanin : data_fanins[i]) {
+      // Once a single consumer of the fanin is left, scheduling it frees the
+      // fanin.
+      if (--pending_consumers[fanin] != 1) continue;
+      for (int consumer : fanouts[fanin]) {
+        if (scheduled[consumer] || pending_fanins[consumer] != 0) continue;
+        ready.erase({ready_score[consumer], consumer});
+        ready_score[consumer] = score(consumer, pending_consumers);
+        ready.emplace(ready_score[consumer], consumer);
+      }
+    }
+    for (int fanout : fanouts[i]) {
+      if (--pending_fanins[fanout] == 0) {
+        ready_score[fanout] = score(fanout, pending_consumers);
+        ready.emplace(ready_score[fanout], fanout);
+      }
+    }
+  }
+  if (static_cast<int>(order.size()) != num_nodes) return false;
+
+  const std::vector<int64_t> default_peak = peak_memory(default_order);
+  const std::vector<int64_t> scheduled_peak = peak_memory(order);
+  bool reduces_peak = false;
+  for (size_t d = 0; d < default_peak.size(); ++d) {
+    if (scheduled_peak[d] > default_peak[d]) return false;
+    reduces_peak |=
+        scheduled_peak[d] < default_peak[d] * (1 - kMinPeakReduction);
+  }
+  if (!reduces_peak) return false;
+
+  // The nodes that allocate memory wait for the node scheduled before them on
+  // their device. As the control dependencies follow a topological order, they
+  // cannot create cycles.
+  bool updated_graph = false;
+  std::vector<int> last_scheduled(device_index.size(), -1);
+  for (int i : order) {
+    const NodeDef& node = graph->node(i);
+    if (node.input().empty()) continue;
+    const int prev = last_scheduled[device[i]];
+    last_scheduled[device[i]] = i;
+    if (prev < 0 || scheduled_delta[i] <= 0) continue;
+    const string& prev_name = graph->node(prev).name();
+    bool is_fanin = false;
+    for (const string& input : node.input()) {
+      is_fanin |= NodeName(input) == prev_name;
+    }
+    if (is_fanin) continue;
+    graph->mutable_node(i)->add_input(AsControlDependency(prev_name));
+    updated_graph = true;
+  }
+  VLOG(1) << "Memory aware scheduling lowers the peak memory usage of "
+          << absl::StrJoin(default_peak, ", ") << " bytes to "
+          << absl::StrJoin(scheduled_peak, ", ") << " bytes";
+  return updated_graph;
+}
+
 }  // namespace
 
 Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -1386,7 +1886,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
-       optimization_level_ == RewriterConfig::MANUAL);
+       optimization_level_ == RewriterConfig::MANUAL ||
+       optimization_level_ == RewriterConfig::AUTOMATIC_RECOMPUTATION);
   if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
   }
@@ -1395,9 +1896,24 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
-                               &optimized_item.graph, item);
+    std::unordered_set<string> nodes_to_recompute;
+    if (optimization_level_ == RewriterConfig::AUTOMATIC_RECOMPUTATION &&
+        !item.fetch.empty() && cluster != nullptr) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      nodes_to_recompute = SelectActivationsToRecompute(
+          cluster, optimized_item, recomputation_targets_name_scope_,
+          recomputation_budget_bytes_);
+    }
+    RecomputationRewritingPass(
+        optimization_level_, recomputation_targets_name_scope_,
+        nodes_to_recompute, &optimized_item.graph, item);
+  }
+
+  if (optimization_level_ == RewriterConfig::MEMORY_AWARE_SCHEDULING &&
+      !item.fetch.empty() && cluster != nullptr) {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    MemoryAwareSchedulingPass(scheduling_latency_weight_, cluster,
+                              &optimized_item);
   }
 
   std::unordered_set<string> skip_list;
@@ -1426,10 +1942,11 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
+           optimization_level_ == RewriterConfig::ACTIVATION_OFFLOADING ||
            optimization_level_ == RewriterConfig::MANUAL) &&
           cluster != nullptr) {
-        if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
-                         &skip_list)) {
+        if (SwappingPass(optimization_level_, recomputation_targets_name_scope_,
+                         cluster, &memory, &optimized_item, &skip_list)) {
           // Reset the inferred memory usage since the graph changed.
           memory.reset();
           updated_graph = true;
@@ -33,11 +33,19 @@ class MemoryOptimizer : public GraphOptimizer {
   // recomputation_targets_name_scope: Name scope for potential outputs of
   //   recomputations. See
   //   RewriterConfig::memory_optimizer_target_node_name_scope.
+  // scheduling_latency_weight: Trades peak memory usage for latency when
+  //   scheduling nodes. See RewriterConfig::memory_scheduling_latency_weight.
+  // recomputation_budget_bytes: Peak memory usage to fit in with automatic
+  //   recomputation. See RewriterConfig::recomputation_memory_budget_bytes.
   explicit MemoryOptimizer(
       RewriterConfig::MemOptType optimization_level,
-      const string& recomputation_targets_name_scope = "gradients/")
+      const string& recomputation_targets_name_scope = "gradients/",
+      float scheduling_latency_weight = 0,
+      int64_t recomputation_budget_bytes = 0)
       : optimization_level_(optimization_level),
-        recomputation_targets_name_scope_(recomputation_targets_name_scope) {}
+        recomputation_targets_name_scope_(recomputation_targets_name_scope),
+        scheduling_latency_weight_(scheduling_latency_weight),
+        recomputation_budget_bytes_(recomputation_budget_bytes) {}
   ~MemoryOptimizer() override {}
 
   string name() const override { return "memory_optimizer"; };
@@ -50,6 +58,8 @@ class MemoryOptimizer : public GraphOptimizer {
  private:
   RewriterConfig::MemOptType optimization_level_;
   string recomputation_targets_name_scope_;
+  float scheduling_latency_weight_;
+  int64_t recomputation_budget_bytes_;
 };
 
 }  // end namespace grappler
@@ -20,6 +20,8 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -346,6 +348,189 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, ActivationOffloading) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  Output v = ops::Variable(s.WithOpName("v"), {128, 128, 8}, DT_FLOAT);
+  // The activation is only used at the start of the forward computation and
+  // at the end of the gradient computation, so it is idle around the peak.
+  Output act = ops::Square(s.WithOpName("act"), v);
+  Output forward = ops::Sqrt(s.WithOpName("f1"), act);
+  for (int i = 2; i <= 10; ++i) {
+    forward = ops::Tanh(s.WithOpName(absl::StrCat("f", i)), forward);
+  }
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output big = ops::Concat(s.WithOpName("big"),
+                           {forward, forward, forward, forward}, axis);
+  Output g0 = ops::Exp(s.WithOpName("gradients/g0"), big);
+  Output g1 = ops::Sum(s.WithOpName("gradients/g1"), g0, axis);
+  Output g2 = ops::Mul(s.WithOpName("gradients/g2"), act, g1);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/g2"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::ACTIVATION_OFFLOADING);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  int found = 0;
+  for (const auto& node : output.node()) {
+    if (node.name() == "gradients/g2") {
+      ASSERT_EQ(2, node.input_size());
+      EXPECT_EQ("swap_in_gradients/g2_0", node.input(0));
+      EXPECT_EQ("gradients/g1", node.input(1));
+      ++found;
+    } else if (node.name() == "swap_out_gradients/g2_0") {
+      EXPECT_EQ("_CopyFromGpuToHost", node.op());
+      EXPECT_EQ("act", node.input(0));
+      ++found;
+    } else if (node.name() == "swap_in_gradients/g2_0") {
+      EXPECT_EQ("_CopyFromHostToGpu", node.op());
+      EXPECT_EQ("swap_out_gradients/g2_0", node.input(0));
+      // The activation is prefetched ahead of its use.
+      EXPECT_EQ(2, node.input_size());
+      ++found;
+    } else if (node.name() == "f1") {
+      // The forward computation does not wait for the copy to the host.
+      EXPECT_EQ(1, node.input_size());
+      ++found;
+    }
+  }
+  EXPECT_EQ(4, found);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+#endif
+}
+
+TEST_F(MemoryOptimizerTest, MemoryAwareScheduling) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  Output v = ops::Variable(s.WithOpName("v"), {128, 128, 8}, DT_FLOAT);
+  Output axis = ops::Const(s.WithOpName("axis"), {0, 1, 2});
+  // Every branch allocates a large tensor that it immediately reduces. Run in
+  // the order of their earliest start times, all the large tensors are alive
+  // at once, while running each branch to completion only keeps one alive.
+  std::vector<Output> sums;
+  for (int i = 0; i < 4; ++i) {
+    Output big = ops::Square(s.WithOpName(absl::StrCat("big", i)), v);
+    sums.push_back(ops::Sum(s.WithOpName(absl::StrCat("sum", i)), big, axis));
+  }
+  Output total = ops::AddN(s.WithOpName("total"), sums);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"total"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::MEMORY_AWARE_SCHEDULING);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  // All the branches but the first one wait for the previous one to complete.
+  int num_delayed = 0;
+  for (const auto& node : output.node()) {
+    if (!absl::StartsWith(node.name(), "big")) continue;
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) {
+        EXPECT_TRUE(absl::StartsWith(input, "^sum"));
+        ++num_delayed;
+      }
+    }
+  }
+  EXPECT_EQ(3, num_delayed);
+
+  // The weight of the latency keeps the original order.
+  MemoryOptimizer latency_optimizer(RewriterConfig::MEMORY_AWARE_SCHEDULING,
+                                    "gradients/",
+                                    /*scheduling_latency_weight=*/1);
+  GraphDef latency_output;
+  TF_EXPECT_OK(
+      latency_optimizer.Optimize(cluster.get(), item, &latency_output));
+  for (const auto& node : latency_output.node()) {
+    if (!absl::StartsWith(node.name(), "big")) continue;
+    EXPECT_EQ(1, node.input_size()) << node.name();
+  }
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+#endif
+}
+
+TEST_F(MemoryOptimizerTest, AutomaticRecomputation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  Output v = ops::Variable(s.WithOpName("v"), {128, 128, 8}, DT_FLOAT);
+  // The activation only depends on a variable, so recomputing it before its
+  // gradient use frees its memory during the rest of the forward computation.
+  Output act = ops::Square(s.WithOpName("act"), v);
+  Output forward = ops::Tanh(s.WithOpName("f1"), act);
+  for (int i = 2; i <= 5; ++i) {
+    forward = ops::Tanh(s.WithOpName(absl::StrCat("f", i)), forward);
+  }
+  Output g0 = ops::Exp(s.WithOpName("gradients/g0"), forward);
+  Output g1 = ops::Mul(s.WithOpName("gradients/g1"), act, g0);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/g1"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The budget is too small for the graph, so every activation that can be
+  // recomputed is.
+  MemoryOptimizer optimizer(RewriterConfig::AUTOMATIC_RECOMPUTATION,
+                            "gradients/", /*scheduling_latency_weight=*/0,
+                            /*recomputation_budget_bytes=*/1024);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* recomputed_act = node_map.GetNode("Recomputed/act");
+  ASSERT_NE(nullptr, recomputed_act);
+  EXPECT_EQ("Square", recomputed_act->op());
+  EXPECT_EQ("v", recomputed_act->input(0));
+  const NodeDef* gradient = node_map.GetNode("gradients/g1");
+  ASSERT_EQ(2, gradient->input_size());
+  EXPECT_EQ("Recomputed/act", gradient->input(0));
+
+  // Nothing is recomputed when the graph fits in the budget.
+  MemoryOptimizer unconstrained_optimizer(
+      RewriterConfig::AUTOMATIC_RECOMPUTATION, "gradients/",
+      /*scheduling_latency_weight=*/0,
+      /*recomputation_budget_bytes=*/1LL << 30);
+  GraphDef unconstrained_output;
+  TF_EXPECT_OK(unconstrained_optimizer.Optimize(cluster.get(), item,
+                                                &unconstrained_output));
+  EXPECT_EQ(item.graph.node_size(), unconstrained_output.node_size());
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
@@ -16,10 +16,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
+#include <map>
+#include <set>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
@@ -32,6 +36,8 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -39,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
+#include "tensorflow/core/grappler/optimizers/collective_bucketing_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/common_subgraph_elimination.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
@@ -62,7 +69,15 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_var.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -238,6 +253,9 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
     MK_OPT("auto_mixed_precision_onednn_bfloat16",
            "auto_mixed_precision_onednn_bfloat16",
            new AutoMixedPrecision(AutoMixedPrecisionMode::BF16));
+    MK_OPT("auto_mixed_precision_onednn_int8",
+           "auto_mixed_precision_onednn_int8",
+           new AutoMixedPrecision(AutoMixedPrecisionMode::INT8_CPU));
   }
 #endif
   MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
@@ -260,6 +278,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
                                       cfg_.scoped_allocator_opts()));
   MK_OPT("pin_to_host", "pin_to_host_optimization",
          new PinToHostOptimizer(cfg_.pin_to_host_optimization()));
+  MK_OPT("collective_bucketing", "collective_bucketing",
+         new CollectiveBucketingOptimizer(cfg_.collective_bucket_bytes()));
 
   return std::unique_ptr<GraphOptimizer>();
 }
@@ -400,6 +420,13 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::BF16));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_onednn_int8()) &&
+      AutoMixedPrecisionEnabled(
+          plugin_configs.toggle_config["auto_mixed_precision_onednn_int8"]) &&
+      IsMKLEnabled()) {
+    optimizers->push_back(
+        std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::INT8_CPU));
+  }
 #endif
   if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu()) &&
       AutoMixedPrecisionEnabled(
@@ -475,17 +502,28 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
+          std::make_unique<MemoryOptimizer>(
+              cfg_.memory_optimization(), "gradients/",
+              cfg_.memory_scheduling_latency_weight(),
+              cfg_.recomputation_memory_budget_bytes()));
     } else {
       optimizers->push_back(std::make_unique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_scheduling_latency_weight(),
+          cfg_.recomputation_memory_budget_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
     optimizers->push_back(
         std::make_unique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
   }
+  // Off by default: bucketing relies on static shapes, which every group
+  // member must infer the same way.
+  if (BOTH_ARE_ON(collective_bucketing)) {
+    optimizers->push_back(std::make_unique<CollectiveBucketingOptimizer>(
+        cfg_.collective_bucket_bytes()));
+  }
 
 #ifndef ENABLE_MKL
   if (BOTH_ARE_ON(scoped_allocator_optimization)) {
@@ -641,6 +679,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
+    PRINT_CFG(collective_bucketing)
 #undef PRINT_CFG
     user_cfg.toggle_config["auto_mixed_precision"] =
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())
@@ -658,6 +697,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())
             ? RewriterConfig::ON
             : RewriterConfig::OFF;
+    user_cfg.toggle_config["auto_mixed_precision_onednn_int8"] =
+        AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_onednn_int8())
+            ? RewriterConfig::ON
+            : RewriterConfig::OFF;
     user_cfg.toggle_config["memory_optimization"] =
         MemoryOptimizerEnabled(cfg_.memory_optimization(),
                                config_proto_.graph_options()
@@ -688,6 +731,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
                 "auto_mixed_precision_onednn_bfloat16")
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
       PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
+      PRINT_CFG("auto_mixed_precision_onednn_int8",
+                "auto_mixed_precision_onednn_int8")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
@@ -696,6 +741,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
       PRINT_CFG("memory", "memory_optimization")
       PRINT_CFG("autoparallel", "auto_parallel")
       PRINT_CFG("scoped_allocator", "scoped_allocator_optimization")
+      PRINT_CFG("collective_bucketing", "collective_bucketing")
 #undef PRINT_CFG
     }
   }
@@ -729,6 +775,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision_onednn_bfloat16" ||
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
+        pair.first == "auto_mixed_precision_onednn_int8" ||
         pair.first == "pin_to_host_optimization" ||
         pair.first == "scoped_allocator_optimization") {
       // These optimizers are turned off by default.
@@ -830,6 +877,12 @@ Status MetaOptimizer::OptimizeGraph(
           *optimized_graph);
     }
 
+    // The next iteration is skipped if this one leaves the graph unchanged, as
+    // its optimizers would see the graph this iteration started with.
+    const bool has_next_iteration = iteration + 1 < NumIterations(cfg_);
+    const uint64 graph_hash =
+        has_next_iteration ? DeterministicProtoHash64(*optimized_graph) : 0;
+
     for (const auto& optimizer : optimizers) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       // Some optimizers can run only once.
@@ -871,6 +924,13 @@ Status MetaOptimizer::OptimizeGraph(
     for (const auto& verifier : post_optimization_verifiers) {
       TF_RETURN_IF_ERROR(verifier->Verify(*optimized_graph));
     }
+
+    if (has_next_iteration &&
+        DeterministicProtoHash64(*optimized_graph) == graph_hash) {
+      VLOG(3) << "Stopping after iteration " << iteration
+              << ", graph is unchanged";
+      break;
+    }
   }
 #ifndef ENABLE_MKL
   // ScopedAllocatorOptimizer must run last.
@@ -888,7 +948,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1055,7 +1118,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1164,15 +1230,76 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimizes the body of `func` into `optimized_func_graph`, with the
+  // `func_item` to convert it back to a FunctionDef. Only reads `flib`, so that
+  // the functions of a pass over the library can be optimized concurrently.
+  const auto optimize_function =
+      [&](const FunctionDef& func, GrapplerFunctionItem* func_item,
+          GraphDef* optimized_func_graph) -> Status {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item->graph.release_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, *func_item,
+                                              optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = *func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         optimized_func_graph);
+  };
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
-    int function_idx = 0;
+    std::vector<const FunctionDef*> funcs;
     for (const FunctionDef& func : optimized_graph->library().function()) {
-      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
-
       const string& func_name = func.signature().name();
 
       // Skip functions that are not reachable from the optimized graph.
@@ -1193,69 +1320,47 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       if (data::IsTFDataFunction(func)) continue;
 
       VLOG(3) << "Optimize function: function=" << func_name << " ["
-              << function_idx++ << " of "
+              << funcs.size() << " of "
               << optimized_graph->library().function_size() << "]";
 
       // Function optimization might specialize nested function calls, so we
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    // The functions of a pass are independent of each other: each of them is
+    // optimized against the library as it was at the start of the pass, and
+    // the functions specialized for its call sites are named after it. Large
+    // libraries are therefore optimized on a thread pool, and the results
+    // merged back into the library in order.
+    std::vector<GrapplerFunctionItem> func_items(funcs.size());
+    std::vector<GraphDef> optimized_func_graphs(funcs.size());
+    std::vector<Status> statuses(funcs.size());
+    const int num_threads =
+        std::min<int>(funcs.size(), port::MaxParallelism());
+    if (num_threads > 1) {
+      thread::ThreadPool pool(Env::Default(), "optimize_function_library",
+                              num_threads);
+      for (int i = 0; i < funcs.size(); ++i) {
+        pool.Schedule([&, i]() {
+          statuses[i] = optimize_function(*funcs[i], &func_items[i],
+                                          &optimized_func_graphs[i]);
+        });
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+    } else {
+      for (int i = 0; i < funcs.size(); ++i) {
+        statuses[i] = optimize_function(*funcs[i], &func_items[i],
+                                        &optimized_func_graphs[i]);
       }
+    }
+
+    for (int i = 0; i < funcs.size(); ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+      const string& func_name = funcs[i]->signature().name();
+      GrapplerFunctionItem& func_item = func_items[i];
+      GraphDef& optimized_func_graph = optimized_func_graphs[i];
 
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
@@ -1321,6 +1426,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
+  mutex_lock l(optimization_results_mu_);
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
                     "Optimization results for grappler item: ", graph_result.id,
@@ -1357,23 +1463,230 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.scoped_allocator_optimization() == RewriterConfig::ON ||
 #endif
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
+         rewrite_cfg.collective_bucketing() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
+         AutoMixedPrecisionEnabled(
+             rewrite_cfg.auto_mixed_precision_onednn_int8()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
 
+namespace {
+
+// Returns the directory of the cache of optimized graphs, or an empty string
+// if it is disabled.
+string GetOptimizedGraphCacheDir() {
+  const char* cache_dir = std::getenv("TF_GRAPPLER_CACHE_DIR");
+  return cache_dir == nullptr ? "" : cache_dir;
+}
+
+// Returns whether the optimized graph of `item` only depends on what
+// OptimizedGraphFingerprint() covers. Custom and plugin optimizers may depend
+// on anything, so graphs they optimize are not cached.
+bool CanCacheOptimizedGraph(const GrapplerItem& item, const ConfigProto& cfg) {
+  const RewriterConfig& rewrite_cfg = cfg.graph_options().rewrite_options();
+  if (!rewrite_cfg.custom_optimizers().empty()) return false;
+  if (!rewrite_cfg.optimizers().empty()) {
+    const std::vector<string> custom_optimizers =
+        CustomGraphOptimizerRegistry::GetRegisteredOptimizers();
+    for (const string& optimizer : rewrite_cfg.optimizers()) {
+      if (std::find(custom_optimizers.begin(), custom_optimizers.end(),
+                    optimizer) != custom_optimizers.end()) {
+        return false;
+      }
+    }
+  }
+  if (rewrite_cfg.use_plugin_optimizers() != RewriterConfig::OFF) {
+    std::set<string> device_types;
+    if (!GetGraphDevice(item.graph, &device_types).ok() ||
+        !PluginGraphOptimizerRegistry::CreateOptimizers(device_types)
+             .empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fingerprints the build: its version, compiler and configuration and the ops
+// it registers. Computed once, so ops loaded later are not covered, but the
+// graphs that use them are.
+uint64 BuildFingerprint() {
+  static const uint64 fingerprint = [] {
+    string build =
+        strings::StrCat(TF_VERSION_STRING, "/", TF_GRAPH_DEF_VERSION);
+#ifdef __VERSION__
+    strings::StrAppend(&build, "/", __VERSION__);
+#endif
+#if GOOGLE_CUDA
+    strings::StrAppend(&build, "/cuda");
+#endif
+#if TENSORFLOW_USE_ROCM
+    strings::StrAppend(&build, "/rocm");
+#endif
+#ifdef INTEL_MKL
+    strings::StrAppend(&build, "/mkl");
+#endif
+    OpList ops;
+    OpRegistry::Global()->Export(/*include_internal=*/true, &ops);
+    return Hash64Combine(Hash64(build), DeterministicProtoHash64(ops));
+  }();
+  return fingerprint;
+}
+
+// Returns the values of the environment variables that change what the
+// optimizers do, other than through the ConfigProto.
+string OptimizerEnvironment() {
+  std::vector<string> names = {
+      "TF_ENABLE_ONEDNN_OPTS",
+      "TF_USE_CUBLASLT",
+      "TF_USE_CUDNN_BATCHNORM_SPATIAL_PERSISTENT",
+      "TF_XLA_FLAGS",
+      "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_EMULATE_FP16",
+      "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_IGNORE_PERFORMANCE",
+      "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_INT8_RANGES",
+      "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL",
+      "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_SIMULATE_GPU",
+  };
+  for (const char* list : {"ALLOWLIST", "INFERLIST", "DENYLIST", "CLEARLIST",
+                           "WHITELIST", "GRAYLIST", "BLACKLIST"}) {
+    for (const char* change : {"_ADD", "_REMOVE"}) {
+      names.push_back(
+          strings::StrCat("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_", list,
+                          change));
+    }
+  }
+  string environment;
+  for (const string& name : names) {
+    string value;
+    if (!ReadStringFromEnvVar(name, "", &value).ok()) continue;
+    strings::StrAppend(&environment, name, "=", value, "\n");
+  }
+  return environment;
+}
+
+// Fingerprints everything the output of the meta optimizer depends on when
+// CanCacheOptimizedGraph() holds: the item, the config, the environment, the
+// devices of the cluster and the build.
+uint64 OptimizedGraphFingerprint(const GrapplerItem& item,
+                                 const ConfigProto& cfg,
+                                 const Cluster* cluster) {
+  uint64 fingerprint = Hash64Combine(BuildFingerprint(), Hash64(item.id));
+  const auto combine = [&fingerprint](absl::string_view value) {
+    fingerprint = Hash64Combine(fingerprint, Hash64(value));
+  };
+  combine(OptimizerEnvironment());
+  const xla_config_registry::XlaGlobalJitLevel jit_level =
+      xla_config_registry::GetGlobalJitLevel(
+          cfg.graph_options().optimizer_options().global_jit_level());
+  combine(strings::StrCat("mkl=", IsMKLEnabled(), "/jit=",
+                          jit_level.single_gpu, ",", jit_level.general));
+  fingerprint =
+      Hash64Combine(fingerprint, DeterministicProtoHash64(item.graph));
+  fingerprint = Hash64Combine(fingerprint, DeterministicProtoHash64(cfg));
+  for (const auto& feed : item.feed) combine(feed.first);
+  combine("fetch");
+  for (const string& fetch : item.fetch) combine(fetch);
+  combine("init_ops");
+  for (const string& init_op : item.init_ops) combine(init_op);
+  combine("keep_ops");
+  for (const string& keep_op : item.keep_ops) combine(keep_op);
+  combine(item.save_op);
+  combine(item.restore_op);
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  combine(strings::StrCat(options.allow_non_differentiable_rewrites,
+                          options.allow_pruning_stateful_and_dataset_ops,
+                          options.optimize_function_library,
+                          options.is_eager_mode, "/",
+                          options.intra_op_parallelism_threads));
+
+  // Sets of devices are hashed in sorted order.
+  std::vector<string> devices(item.devices().begin(), item.devices().end());
+  std::sort(devices.begin(), devices.end());
+  combine("devices");
+  for (const string& device : devices) combine(device);
+  if (cluster != nullptr) {
+    std::map<string, const DeviceProperties*> cluster_devices;
+    for (const auto& device : cluster->GetDevices()) {
+      cluster_devices.emplace(device.first, &device.second);
+    }
+    combine("cluster_devices");
+    for (const auto& device : cluster_devices) {
+      combine(device.first);
+      fingerprint =
+          Hash64Combine(fingerprint, DeterministicProtoHash64(*device.second));
+    }
+  }
+  return fingerprint;
+}
+
+string OptimizedGraphCachePath(const string& cache_dir, uint64 fingerprint) {
+  return io::JoinPath(cache_dir,
+                      strings::StrCat("grappler_", fingerprint, ".pb"));
+}
+
+// Writes the optimized graph to a temporary file that is renamed into the
+// cache, so that concurrent readers never see a partial graph.
+void WriteOptimizedGraphToCache(const string& cache_dir, uint64 fingerprint,
+                                const GraphDef& optimized_graph) {
+  Env* env = Env::Default();
+  const string path = OptimizedGraphCachePath(cache_dir, fingerprint);
+  const string tmp_path = strings::StrCat(
+      path, ".tmp.", env->GetCurrentThreadId(), ".", env->NowMicros());
+  Status status = env->RecursivelyCreateDir(cache_dir);
+  if (status.ok()) {
+    status = WriteBinaryProto(env, tmp_path, optimized_graph);
+  }
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write the optimized graph to " << path << ": "
+                 << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+    return;
+  }
+  VLOG(1) << "Wrote the optimized graph to " << path;
+}
+
+}  // namespace
+
 Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                         DeviceBase* cpu_device, Cluster* cluster,
                         GraphDef* optimized_graph) {
+  // Restarts of a server optimize the same items with the same config, which
+  // the cache of optimized graphs keyed by their fingerprint skips.
+  const string cache_dir = CanCacheOptimizedGraph(item, cfg)
+                               ? GetOptimizedGraphCacheDir()
+                               : string();
+  uint64 fingerprint = 0;
+  if (!cache_dir.empty()) {
+    fingerprint = OptimizedGraphFingerprint(item, cfg, cluster);
+    const string path = OptimizedGraphCachePath(cache_dir, fingerprint);
+    if (Env::Default()->FileExists(path).ok()) {
+      Status status = ReadBinaryProto(Env::Default(), path, optimized_graph);
+      if (status.ok()) {
+        VLOG(1) << "Read the optimized graph of grappler item " << item.id
+                << " from " << path;
+        return absl::OkStatus();
+      }
+      LOG(WARNING) << "Failed to read the optimized graph from " << path
+                   << ", optimizing the graph again: " << status;
+    }
+  }
+
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  TF_RETURN_IF_ERROR(optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                   optimized_graph));
+  if (!cache_dir.empty()) {
+    WriteOptimizedGraphToCache(cache_dir, fingerprint, *optimized_graph);
+  }
+  return absl::OkStatus();
 }
 
 Status OptimizeGraph(
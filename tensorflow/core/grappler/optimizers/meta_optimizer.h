@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -118,7 +120,11 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  // Functions of the library are optimized concurrently, so the results of
+  // their OptimizeGraph calls are recorded under a lock.
+  mutable mutex optimization_results_mu_;
+  std::vector<GraphOptimizationResult> optimization_results_
+      TF_GUARDED_BY(optimization_results_mu_);
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
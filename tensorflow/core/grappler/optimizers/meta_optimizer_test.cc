@@ -16,8 +16,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <atomic>
+#include <cstdlib>
+#include <string>
+#include <vector>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -32,6 +36,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -64,10 +71,10 @@ class TestOptimizer : public CustomGraphOptimizer {
   }
 
  private:
-  static bool optimized_;
+  static std::atomic<bool> optimized_;
 };
 
-bool TestOptimizer::optimized_;
+std::atomic<bool> TestOptimizer::optimized_;
 
 REGISTER_GRAPH_OPTIMIZER(TestOptimizer);
 
@@ -114,16 +121,20 @@ class GrapplerItemPropertiesAccumulator : public CustomGraphOptimizer {
                   GraphDef* optimized_graph) override {
     *optimized_graph = item.graph;
     if (optimization_options_) {
+      // Functions are optimized concurrently.
+      mutex_lock l(mu_);
       optimization_options_->insert({item.id, item.optimization_options()});
     }
     return absl::OkStatus();
   }
 
  private:
+  static mutex mu_;
   static gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
       optimization_options_;
 };
 
+mutex GrapplerItemPropertiesAccumulator::mu_(LINKER_INITIALIZED);
 gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
     GrapplerItemPropertiesAccumulator::optimization_options_;
 
@@ -792,6 +803,204 @@ TEST_F(MetaOptimizerTest, OptimizerDoesNotTimeOut) {
   EXPECT_EQ(original_node_size + 2, output.node_size());
 }
 
+// Custom optimizer which leaves the graph unchanged and counts the number of
+// calls of its method `Optimize` across all class instances.
+class CountingOptimizer : public CustomGraphOptimizer {
+ public:
+  static void InitCount() { count_ = 0; }
+  static int GetCount() { return count_; }
+
+  string name() const override { return "counting_optimizer"; }
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return absl::OkStatus();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override {
+    ++count_;
+    *optimized_graph = item.graph;
+    return absl::OkStatus();
+  }
+
+ private:
+  static std::atomic<int> count_;
+};
+
+std::atomic<int> CountingOptimizer::count_;
+
+REGISTER_GRAPH_OPTIMIZER(CountingOptimizer);
+
+TEST_F(MetaOptimizerTest, StopIteratingOnceGraphIsUnchanged) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  CountingOptimizer::InitCount();
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("CountingOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+
+  MetaOptimizer optimizer(nullptr, config);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  // The second iteration would see the same graph as the first one.
+  EXPECT_EQ(CountingOptimizer::GetCount(), 1);
+}
+
+TEST_F(MetaOptimizerTest, OptimizeManyFunctions) {
+  using test::function::NDef;
+  constexpr int kNumFunctions = 32;
+
+  //   MySquare_i(x) = x * x
+  //   square_i = MySquare_i(a)
+  std::vector<FunctionDef> funcs;
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const string func_name = absl::StrCat("MySquare_", i);
+    funcs.push_back(FunctionDefHelper::Create(
+        func_name, {"x:float"}, {"z:float"}, {},
+        {{{"mul"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "mul:z:0"}}));
+    nodes.push_back(
+        NDef(absl::StrCat("square_", i), func_name, {"a"}, {}, kDevice));
+  }
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, funcs);
+
+  CountingOptimizer::InitCount();
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("CountingOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+
+  MetaOptimizer optimizer(nullptr, config);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The main graph and each of the functions are optimized once.
+  EXPECT_EQ(CountingOptimizer::GetCount(), 1 + kNumFunctions);
+  FunctionLibraryDefinition optimized_flib(OpRegistry::Global(),
+                                           output.library());
+  EXPECT_EQ(optimized_flib.num_functions(), kNumFunctions);
+  for (int i = 0; i < kNumFunctions; ++i) {
+    const FunctionDef* func =
+        optimized_flib.Find(absl::StrCat("MySquare_", i));
+    ASSERT_NE(func, nullptr);
+    EXPECT_EQ(func->node_def_size(), 1);
+  }
+}
+
+// Deletes the cache of optimized graphs and points the meta optimizer to it.
+string ResetOptimizedGraphCache(const string& name) {
+  const string cache_dir = io::JoinPath(testing::TmpDir(), name);
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  setenv("TF_GRAPPLER_CACHE_DIR", cache_dir.c_str(), /*overwrite=*/1);
+  return cache_dir;
+}
+
+std::vector<string> CachedFiles(const string& cache_dir) {
+  std::vector<string> cached_files;
+  Env::Default()->GetChildren(cache_dir, &cached_files).IgnoreError();
+  return cached_files;
+}
+
+bool HasNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) return true;
+  }
+  return false;
+}
+
+TEST_F(MetaOptimizerTest, ReadOptimizedGraphFromCache) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+  const string cache_dir =
+      ResetOptimizedGraphCache("ReadOptimizedGraphFromCache");
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("constfold");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+
+  GraphDef output;
+  TF_EXPECT_OK(RunMetaOptimizer(GrapplerItem(item), config, nullptr, nullptr,
+                                &output));
+  std::vector<string> cached_files = CachedFiles(cache_dir);
+  ASSERT_EQ(cached_files.size(), 1);
+
+  // Marks the cached graph, to tell it from a graph optimized again.
+  GraphDef marked_output = output;
+  marked_output.add_node()->set_name("cached");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(),
+                                io::JoinPath(cache_dir, cached_files[0]),
+                                marked_output));
+
+  // The same item is read from the cache.
+  GraphDef cached_output;
+  TF_EXPECT_OK(RunMetaOptimizer(GrapplerItem(item), config, nullptr, nullptr,
+                                &cached_output));
+  EXPECT_TRUE(HasNode(cached_output, "cached"));
+
+  // Not with another environment for the optimizers.
+  setenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL",
+         "TREAT_INFERLIST_AS_DENYLIST", /*overwrite=*/1);
+  TF_EXPECT_OK(RunMetaOptimizer(GrapplerItem(item), config, nullptr, nullptr,
+                                &cached_output));
+  EXPECT_FALSE(HasNode(cached_output, "cached"));
+  unsetenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL");
+
+  // Nor with another config.
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  TF_EXPECT_OK(RunMetaOptimizer(GrapplerItem(item), config, nullptr, nullptr,
+                                &cached_output));
+  EXPECT_FALSE(HasNode(cached_output, "cached"));
+
+  unsetenv("TF_GRAPPLER_CACHE_DIR");
+}
+
+TEST_F(MetaOptimizerTest, DoNotCacheGraphsOfCustomOptimizers) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+  const string cache_dir =
+      ResetOptimizedGraphCache("DoNotCacheGraphsOfCustomOptimizers");
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("CountingOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::ONE);
+
+  CountingOptimizer::InitCount();
+  for (int i = 0; i < 2; ++i) {
+    GraphDef output;
+    TF_EXPECT_OK(RunMetaOptimizer(GrapplerItem(item), config, nullptr,
+                                  nullptr, &output));
+  }
+  EXPECT_EQ(CountingOptimizer::GetCount(), 2);
+  EXPECT_TRUE(CachedFiles(cache_dir).empty());
+
+  unsetenv("TF_GRAPPLER_CACHE_DIR");
+}
+
 TEST_F(MetaOptimizerTest, RunPostOptimizationVerifiersOnValidGraph) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
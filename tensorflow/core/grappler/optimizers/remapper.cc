@@ -74,6 +74,15 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// ResourceGather + SparseSegment{Sum,Mean,SqrtN}[WithNumSegments] ->
+// _ResourceSparseSegmentReduction  // This fusion works on CPU and GPU.
+//
+// RaggedTensorToTensor + SequenceMask of its row lengths ->
+// _RaggedTensorToTensorWithMask  // This fusion only works on CPU.
+//
+// BatchMatMul(query, key, adj_y=True) + [Mul(scale)] + [Add(mask)] + Softmax +
+// BatchMatMul(value) -> _FusedMultiHeadAttention  // Only on CPU.
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -92,6 +101,11 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kResourceSparseSegmentReduction[] =
+    "_ResourceSparseSegmentReduction";
+constexpr char kRaggedTensorToTensorWithMask[] =
+    "_RaggedTensorToTensorWithMask";
+constexpr char kFusedMultiHeadAttention[] = "_FusedMultiHeadAttention";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -170,6 +184,49 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// ResourceGather whose only consumer is a SparseSegment{Sum,Mean,SqrtN}, which
+// can reduce the rows of the variable without gathering them first.
+struct ResourceGatherWithSparseSegmentReduction {
+  ResourceGatherWithSparseSegmentReduction() = default;
+  ResourceGatherWithSparseSegmentReduction(int resource_gather,
+                                           int sparse_segment_reduction)
+      : resource_gather(resource_gather),
+        sparse_segment_reduction(sparse_segment_reduction) {}
+
+  int resource_gather = kMissingIndex;
+  int sparse_segment_reduction = kMissingIndex;
+};
+
+// RaggedTensorToTensor of a ragged tensor with one level of row splits, and
+// the SequenceMask of its row lengths to the width of the dense tensor. The
+// nodes of the mask computation that have no other consumers are removed.
+struct RaggedTensorToTensorWithMask {
+  RaggedTensorToTensorWithMask() = default;
+  RaggedTensorToTensorWithMask(int ragged_tensor_to_tensor, int sequence_mask,
+                               std::vector<int> mask_inputs)
+      : ragged_tensor_to_tensor(ragged_tensor_to_tensor),
+        sequence_mask(sequence_mask),
+        mask_inputs(std::move(mask_inputs)) {}
+
+  int ragged_tensor_to_tensor = kMissingIndex;
+  int sequence_mask = kMissingIndex;
+  std::vector<int> mask_inputs;
+};
+
+// The scaled dot-product attention of classic transformers:
+// BatchMatMul(Softmax(BatchMatMul(query, key, adj_y=True) * scale + mask),
+// value), where the Mul and the Add are optional.
+struct MultiHeadAttention {
+  int output = kMissingIndex;
+  int softmax = kMissingIndex;
+  int add = kMissingIndex;
+  int mul = kMissingIndex;
+  int scores = kMissingIndex;
+  // The input of `add` that is the mask, if any.
+  string mask;
+  float scale = 1.0f;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -1185,6 +1242,39 @@ bool FindContractionWithBiasAddAndAdd(const RemapperContext& ctx,
   return FindContractionWithBiasAddAndAdd(ctx, *node_view, matched);
 }
 
+// Finds a MatMul+BiasAdd+{AddN,Add} pattern on GPU, e.g. the residual add of
+// a transformer block, whose add cuBLASLt computes as the C operand of the
+// matmul.
+bool FindGpuMatMulWithBiasAddAndAdd(const RemapperContext& ctx, int node_index,
+                                    ContractionWithBiasAddAndAdd* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  if (HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 2)
+    return false;
+
+  const auto* node_def = node_view->node();
+  if (!IsAddN(*node_def) && !IsAddWithNoBroadcast(ctx, *node_def)) return false;
+  if (!NodeIsOnGpu(node_def)) return false;
+
+  ContractionWithBiasAdd base;
+  matched->port_id = 0;
+  if (!FindContractionWithBiasInPort(ctx, *node_view, *node_def,
+                                     matched->port_id, &base)) {
+    matched->port_id = 1;
+    if (!FindContractionWithBiasInPort(ctx, *node_view, *node_def,
+                                       matched->port_id, &base)) {
+      return false;
+    }
+  }
+  if (!IsGpuCompatible(ctx, base, /*cluster=*/nullptr)) return false;
+
+  matched->contraction = base.contraction;
+  matched->bias_add = base.bias_add;
+  matched->add = node_view->node_index();
+  matched->bias_port = base.bias_port;
+  return true;
+}
+
 bool FindContractionWithBiasAndAddActivation(
     const RemapperContext& ctx, int node_index,
     ContractionWithBiasAndAddActivation* matched) {
@@ -2705,6 +2795,428 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Returns the combiner of a SparseSegment{Sum,Mean,SqrtN}[WithNumSegments]
+// node for _ResourceSparseSegmentReduction, or an empty string for other ops.
+string SparseSegmentReductionCombiner(const NodeDef& node) {
+  const string& op = node.op();
+  if (op == "SparseSegmentSum" || op == "SparseSegmentSumWithNumSegments") {
+    return "sum";
+  }
+  if (op == "SparseSegmentMean" || op == "SparseSegmentMeanWithNumSegments") {
+    return "mean";
+  }
+  if (op == "SparseSegmentSqrtN" || op == "SparseSegmentSqrtNWithNumSegments") {
+    return "sqrtn";
+  }
+  return "";
+}
+
+bool FindResourceGatherWithSparseSegmentReduction(
+    const RemapperContext& ctx, int node_index,
+    ResourceGatherWithSparseSegmentReduction* matched) {
+  // Root of the pattern must be a SparseSegment reduction on CPU or GPU, where
+  // the fused kernel is registered.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  const bool on_cpu = NodeIsOnCpu(node_def);
+
+  if (SparseSegmentReductionCombiner(*node_def).empty() ||
+      (!on_cpu && !NodeIsOnGpu(node_def)) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() < 3) {
+    return false;
+  }
+
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE && dtype != DT_HALF &&
+      dtype != DT_BFLOAT16) {
+    return false;
+  }
+  // The fused op only takes an int32 num_segments.
+  if (node_view->NumRegularFanins() > 3 &&
+      GetDataTypeFromAttr(*node_def, "Tnumsegments") != DT_INT32) {
+    return false;
+  }
+
+  // Input to the reduction must be a ResourceGather of rows on the same kind
+  // of device that is not used elsewhere.
+  const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
+  const auto* gather_node_view = regular_fanin_0.node_view();
+  const auto* gather_node_def = gather_node_view->node();
+
+  if (gather_node_def->op() != "ResourceGather" ||
+      (on_cpu ? !NodeIsOnCpu(gather_node_def)
+              : !NodeIsOnGpu(gather_node_def)) ||
+      HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(ctx, gather_node_def) ||
+      GetDataTypeFromAttr(*gather_node_def, "dtype") != dtype) {
+    return false;
+  }
+
+  int batch_dims = 0;
+  if (TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) &&
+      batch_dims != 0) {
+    return false;
+  }
+
+  // The gathered rows are only the rows reduced by the fused op if the
+  // gather indices are a vector.
+  const auto& props =
+      ctx.graph_properties.GetInputProperties(gather_node_def->name());
+  if (props.size() != 2 || props[1].shape().unknown_rank() ||
+      props[1].shape().dim_size() != 1) {
+    return false;
+  }
+
+  *matched = ResourceGatherWithSparseSegmentReduction(
+      gather_node_view->node_index(), node_index);
+  return true;
+}
+
+// Reads the value of an int32 or int64 Const node.
+bool GetIntegerConstValues(const NodeDef& node_def,
+                           std::vector<int64_t>* values) {
+  Tensor tensor;
+  if (node_def.op() != "Const" ||
+      !tensor.FromProto(node_def.attr().at("value").tensor())) {
+    return false;
+  }
+  values->clear();
+  if (tensor.dtype() == DT_INT32) {
+    for (int32_t value : tensor.flat<int32_t>()) values->push_back(value);
+  } else if (tensor.dtype() == DT_INT64) {
+    for (int64_t value : tensor.flat<int64_t>()) values->push_back(value);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns true if `fanin` is produced by an int32 or int64 Const node holding
+// exactly `expected`.
+bool IsIntegerConst(const utils::MutableFaninView& fanin,
+                    const std::vector<int64_t>& expected) {
+  std::vector<int64_t> values;
+  return GetIntegerConstValues(*fanin.node_view()->node(), &values) &&
+         values == expected;
+}
+
+// Returns true if the node is a StridedSlice x[begin:end] of a vector, with
+// the given masks and no others.
+bool IsVectorStridedSlice(const utils::MutableNodeView& node_view,
+                          int64_t begin, int64_t end, int begin_mask,
+                          int end_mask, int shrink_axis_mask) {
+  const NodeDef* node_def = node_view.node();
+  if (!IsStridedSlice(*node_def) || node_view.NumRegularFanins() != 4 ||
+      HasControlFaninOrFanout(node_view) ||
+      !IsIntegerConst(node_view.GetRegularFanin(1), {begin}) ||
+      !IsIntegerConst(node_view.GetRegularFanin(2), {end}) ||
+      !IsIntegerConst(node_view.GetRegularFanin(3), {1})) {
+    return false;
+  }
+  int value;
+  const auto has_mask = [&](const char* name, int expected) {
+    return TryGetNodeAttr(*node_def, name, &value) && value == expected;
+  };
+  return has_mask("begin_mask", begin_mask) && has_mask("end_mask", end_mask) &&
+         has_mask("ellipsis_mask", 0) && has_mask("new_axis_mask", 0) &&
+         has_mask("shrink_axis_mask", shrink_axis_mask);
+}
+
+// Returns the node if it is a RaggedTensorToTensor on CPU of only the given
+// row splits, which keeps all rows, or nullptr otherwise.
+const utils::MutableNodeView* GetRaggedTensorToTensorOfRowSplits(
+    const utils::MutableNodeView& node_view, int splits_node,
+    int splits_port) {
+  const NodeDef* node_def = node_view.node();
+  if (node_def->op() != "RaggedTensorToTensor" || !NodeIsOnCpu(node_def) ||
+      HasControlFaninOrFanout(node_view) ||
+      node_view.NumRegularFanins() != 4 ||
+      DataTypeIsQuantized(GetDataTypeFromAttr(*node_def, "T"))) {
+    return nullptr;
+  }
+  std::vector<string> row_partition_types;
+  if (!TryGetNodeAttr(*node_def, "row_partition_types",
+                      &row_partition_types) ||
+      row_partition_types != std::vector<string>{"ROW_SPLITS"}) {
+    return nullptr;
+  }
+  const auto& splits = node_view.GetRegularFanin(3);
+  if (splits.node_index() != splits_node || splits.index() != splits_port) {
+    return nullptr;
+  }
+  // The mask has a row for each row split, so the dense tensor must as well.
+  std::vector<int64_t> shape;
+  if (!GetIntegerConstValues(*node_view.GetRegularFanin(0).node_view()->node(),
+                             &shape) ||
+      shape.empty() || shape[0] != -1) {
+    return nullptr;
+  }
+  return &node_view;
+}
+
+// SequenceMask(row_lengths, maxlen) is built as
+//
+//   Less(Range(0, maxlen, 1), Cast(ExpandDims(row_lengths, -1)))
+//
+// where the row lengths of a ragged tensor are Sub(splits[1:], splits[:-1]).
+// The pattern matches when maxlen is the width of the RaggedTensorToTensor of
+// the same row splits, either as Shape(dense)[1] or as the constant width in
+// its shape.
+bool FindRaggedTensorToTensorWithMask(const RemapperContext& ctx,
+                                      int node_index,
+                                      RaggedTensorToTensorWithMask* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsLess(*node_def) || HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_INT32 && dtype != DT_INT64) return false;
+
+  // Nodes of the mask computation, each of which is removed if its only
+  // consumer is the previous one.
+  std::vector<const utils::MutableNodeView*> mask_inputs;
+
+  const auto* range_view = node_view->GetRegularFanin(0).node_view();
+  if (range_view->node()->op() != "Range" ||
+      range_view->NumRegularFanins() != 3 ||
+      HasControlFaninOrFanout(*range_view) ||
+      !IsIntegerConst(range_view->GetRegularFanin(0), {0}) ||
+      !IsIntegerConst(range_view->GetRegularFanin(2), {1})) {
+    return false;
+  }
+  mask_inputs.push_back(range_view);
+
+  const auto* lengths_view = node_view->GetRegularFanin(1).node_view();
+  if (IsCast(*lengths_view->node())) {
+    if (HasControlFaninOrFanout(*lengths_view)) return false;
+    mask_inputs.push_back(lengths_view);
+    lengths_view = lengths_view->GetRegularFanin(0).node_view();
+  }
+  const auto* expand_dims_view = lengths_view;
+  if (expand_dims_view->node()->op() != "ExpandDims" ||
+      expand_dims_view->NumRegularFanins() != 2 ||
+      HasControlFaninOrFanout(*expand_dims_view) ||
+      !(IsIntegerConst(expand_dims_view->GetRegularFanin(1), {-1}) ||
+        IsIntegerConst(expand_dims_view->GetRegularFanin(1), {1}))) {
+    return false;
+  }
+  mask_inputs.push_back(expand_dims_view);
+
+  const auto* sub_view = expand_dims_view->GetRegularFanin(0).node_view();
+  if (!IsSub(*sub_view->node()) || sub_view->NumRegularFanins() != 2 ||
+      HasControlFaninOrFanout(*sub_view)) {
+    return false;
+  }
+  mask_inputs.push_back(sub_view);
+  const auto* upper_view = sub_view->GetRegularFanin(0).node_view();
+  const auto* lower_view = sub_view->GetRegularFanin(1).node_view();
+  if (!IsVectorStridedSlice(*upper_view, 1, 0, /*begin_mask=*/0,
+                            /*end_mask=*/1, /*shrink_axis_mask=*/0) ||
+      !IsVectorStridedSlice(*lower_view, 0, -1, /*begin_mask=*/1,
+                            /*end_mask=*/0, /*shrink_axis_mask=*/0)) {
+    return false;
+  }
+  const auto& splits = upper_view->GetRegularFanin(0);
+  const auto& lower_splits = lower_view->GetRegularFanin(0);
+  if (splits.node_index() != lower_splits.node_index() ||
+      splits.index() != lower_splits.index()) {
+    return false;
+  }
+  mask_inputs.push_back(upper_view);
+  mask_inputs.push_back(lower_view);
+
+  // maxlen is either Shape(dense)[1], or the constant width of the dense
+  // tensor.
+  const utils::MutableNodeView* ragged_to_tensor_view = nullptr;
+  const auto* maxlen_view = range_view->GetRegularFanin(1).node_view();
+  std::vector<int64_t> width;
+  if (IsVectorStridedSlice(*maxlen_view, 1, 2, /*begin_mask=*/0,
+                           /*end_mask=*/0, /*shrink_axis_mask=*/1)) {
+    const auto* shape_view = maxlen_view->GetRegularFanin(0).node_view();
+    if (!IsShape(*shape_view->node()) || HasControlFaninOrFanout(*shape_view)) {
+      return false;
+    }
+    const auto& dense = shape_view->GetRegularFanin(0);
+    if (dense.index() != 0) return false;
+    ragged_to_tensor_view = GetRaggedTensorToTensorOfRowSplits(
+        *dense.node_view(), splits.node_index(), splits.index());
+    mask_inputs.push_back(maxlen_view);
+    mask_inputs.push_back(shape_view);
+  } else if (GetIntegerConstValues(*maxlen_view->node(), &width) &&
+             width.size() == 1 && width[0] >= 0) {
+    for (const auto& fanout :
+         splits.node_view()->GetRegularFanout(splits.index())) {
+      const auto* candidate = GetRaggedTensorToTensorOfRowSplits(
+          *fanout.node_view(), splits.node_index(), splits.index());
+      std::vector<int64_t> shape;
+      if (candidate != nullptr &&
+          GetIntegerConstValues(
+              *candidate->GetRegularFanin(0).node_view()->node(), &shape) &&
+          shape.size() >= 2 && shape[1] == width[0]) {
+        ragged_to_tensor_view = candidate;
+        break;
+      }
+    }
+  }
+  if (ragged_to_tensor_view == nullptr) return false;
+
+  // Keeps the nodes whose outputs are only used by the removed nodes.
+  absl::flat_hash_set<int> removed = {node_index};
+  std::vector<int> removed_mask_inputs;
+  for (const auto* mask_input : mask_inputs) {
+    const auto& fanouts = mask_input->GetRegularFanout(0);
+    bool only_used_by_mask =
+        mask_input->NumRegularFanouts() == static_cast<int>(fanouts.size());
+    for (const auto& fanout : fanouts) {
+      only_used_by_mask &= removed.contains(fanout.node_index());
+    }
+    if (only_used_by_mask && !IsInPreserveSet(ctx, mask_input->node())) {
+      removed.insert(mask_input->node_index());
+      removed_mask_inputs.push_back(mask_input->node_index());
+    }
+  }
+
+  *matched = RaggedTensorToTensorWithMask(ragged_to_tensor_view->node_index(),
+                                          node_index,
+                                          std::move(removed_mask_inputs));
+  return true;
+}
+
+// Returns the batch dimensions of a rank 3 or 4 matrix multiplication
+// operand, or an empty vector if its shape is not known well enough.
+std::vector<int64_t> AttentionBatchDims(const TensorShapeProto& shape) {
+  if (shape.unknown_rank() ||
+      (shape.dim_size() != 3 && shape.dim_size() != 4)) {
+    return {};
+  }
+  std::vector<int64_t> batch_dims;
+  for (int i = 0; i < shape.dim_size() - 2; ++i) {
+    if (shape.dim(i).size() < 0) return {};
+    batch_dims.push_back(shape.dim(i).size());
+  }
+  return batch_dims;
+}
+
+bool FindMultiHeadAttention(const RemapperContext& ctx, int node_index,
+                            MultiHeadAttention* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  const auto is_batch_matmul = [](const NodeDef& node, bool adj_y) {
+    bool adj_x = false;
+    bool node_adj_y = false;
+    return (node.op() == "BatchMatMul" || node.op() == "BatchMatMulV2") &&
+           TryGetNodeAttr(node, "adj_x", &adj_x) && !adj_x &&
+           TryGetNodeAttr(node, "adj_y", &node_adj_y) && node_adj_y == adj_y;
+  };
+  if (!is_batch_matmul(*node_def, /*adj_y=*/false) ||
+      HasControlFaninOrFanout(*node_view) || !NodeIsOnCpu(node_def)) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_HALF && dtype != DT_BFLOAT16) {
+    return false;
+  }
+
+  // The intermediate nodes are only consumed by the next node of the pattern.
+  const auto is_fusable = [&](const utils::MutableNodeView& view) {
+    return !HasControlFaninOrFanout(view) && HasAtMostOneFanoutAtPort0(view) &&
+           !IsInPreserveSet(ctx, view.node()) &&
+           view.node()->device() == node_def->device() &&
+           GetDataTypeFromAttr(*view.node(), "T") == dtype;
+  };
+
+  MultiHeadAttention attention;
+  attention.output = node_index;
+  auto* softmax_view = node_view->GetRegularFanin(0).node_view();
+  if (!IsSoftmax(*softmax_view->node()) || !is_fusable(*softmax_view)) {
+    return false;
+  }
+  attention.softmax = softmax_view->node_index();
+
+  auto* view = softmax_view->GetRegularFanin(0).node_view();
+  int mask_port = kMissingIndex;
+  if (IsAdd(*view->node()) && is_fusable(*view) &&
+      view->NumRegularFanins() == 2) {
+    // Either input of the Add may be the mask.
+    const int scores_port =
+        IsMul(*view->GetRegularFanin(0).node_view()->node()) ||
+                is_batch_matmul(*view->GetRegularFanin(0).node_view()->node(),
+                                /*adj_y=*/true)
+            ? 0
+            : 1;
+    attention.add = view->node_index();
+    mask_port = 1 - scores_port;
+    attention.mask = view->node()->input(mask_port);
+    view = view->GetRegularFanin(scores_port).node_view();
+  }
+  if (IsMul(*view->node()) && is_fusable(*view) &&
+      view->NumRegularFanins() == 2) {
+    const int scale_port =
+        IsConstant(*view->GetRegularFanin(0).node_view()->node()) ? 0 : 1;
+    const NodeDef* scale_node =
+        view->GetRegularFanin(scale_port).node_view()->node();
+    Tensor scale;
+    if (!IsConstant(*scale_node) ||
+        !scale.FromProto(scale_node->attr().at("value").tensor()) ||
+        scale.NumElements() != 1 || scale.dtype() != dtype) {
+      return false;
+    }
+    if (dtype == DT_FLOAT) {
+      attention.scale = scale.flat<float>()(0);
+    } else if (dtype == DT_HALF) {
+      attention.scale = static_cast<float>(scale.flat<Eigen::half>()(0));
+    } else {
+      attention.scale = static_cast<float>(scale.flat<bfloat16>()(0));
+    }
+    attention.mul = view->node_index();
+    view = view->GetRegularFanin(1 - scale_port).node_view();
+  }
+  if (!is_batch_matmul(*view->node(), /*adj_y=*/true) || !is_fusable(*view)) {
+    return false;
+  }
+  attention.scores = view->node_index();
+
+  // The fused op does not broadcast the batch dimensions of the query, key and
+  // value, and only broadcasts the mask to the scores.
+  const auto& scores_props =
+      ctx.graph_properties.GetInputProperties(view->node()->name());
+  const auto& output_props =
+      ctx.graph_properties.GetInputProperties(node_def->name());
+  if (scores_props.size() != 2 || output_props.size() != 2) return false;
+  const TensorShapeProto& query_shape = scores_props[0].shape();
+  const TensorShapeProto& key_shape = scores_props[1].shape();
+  const TensorShapeProto& value_shape = output_props[1].shape();
+  const std::vector<int64_t> batch_dims = AttentionBatchDims(query_shape);
+  if (batch_dims.empty() || AttentionBatchDims(key_shape) != batch_dims ||
+      AttentionBatchDims(value_shape) != batch_dims) {
+    return false;
+  }
+  const int rank = query_shape.dim_size();
+  if (attention.add != kMissingIndex) {
+    const auto& add_props = ctx.graph_properties.GetInputProperties(
+        ctx.graph_view.GetNode(attention.add)->node()->name());
+    if (add_props.size() != 2) return false;
+    const TensorShapeProto& mask_shape = add_props[mask_port].shape();
+    if (mask_shape.unknown_rank() || mask_shape.dim_size() != rank) {
+      return false;
+    }
+    std::vector<int64_t> scores_dims = batch_dims;
+    scores_dims.push_back(query_shape.dim(rank - 2).size());
+    scores_dims.push_back(key_shape.dim(rank - 2).size());
+    for (int i = 0; i < rank; ++i) {
+      const int64_t dim = mask_shape.dim(i).size();
+      if (dim != 1 && (dim < 0 || dim != scores_dims[i])) return false;
+    }
+  }
+
+  *matched = attention;
+  return true;
+}
+
 // clang-format off
 // HardSwish pattern
 //                        input     Const (value: 3)
@@ -3563,7 +4075,8 @@ Status AddFusedContractionNode(RemapperContext* ctx,
   const NodeDef& contraction = graph->node(matched.contraction);
   const NodeDef& bias_add = graph->node(matched.bias_add);
 
-  // oneDNN version only supports fusion for Conv2D/3D and MatMul
+  // oneDNN version only supports fusion for Conv2D/3D and MatMul, and the GPU
+  // version only for MatMul.
   DCHECK(IsConv2D(contraction) || IsMatMul(contraction) ||
          IsConv3D(contraction));
 
@@ -4336,6 +4849,153 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+Status AddResourceSparseSegmentReductionNode(
+    RemapperContext* ctx,
+    const ResourceGatherWithSparseSegmentReduction& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& resource_gather = graph->node(matched.resource_gather);
+  const NodeDef& reduction = graph->node(matched.sparse_segment_reduction);
+  VLOG(2) << "Fuse ResourceGather with " << reduction.op() << ":"
+          << " resource_gather=" << resource_gather.name()
+          << " reduction=" << reduction.name()
+          << " on device=" << reduction.device();
+
+  const auto* reduction_view =
+      ctx->graph_view.GetNode(matched.sparse_segment_reduction);
+  const int num_args = reduction_view->NumRegularFanins() - 3;
+
+  NodeDef fused_op;
+  fused_op.set_name(reduction.name());
+  fused_op.set_device(reduction.device());
+  fused_op.add_input(resource_gather.input(0));  // 0: resource
+  fused_op.add_input(resource_gather.input(1));  // 1: gather_indices
+  fused_op.add_input(reduction.input(1));        // 2: indices
+  fused_op.add_input(reduction.input(2));        // 3: segment_ids
+  if (num_args > 0) {
+    fused_op.add_input(reduction.input(3));  // 4: num_segments
+  }
+  fused_op.set_op(kResourceSparseSegmentReduction);
+
+  auto* attr = fused_op.mutable_attr();
+  auto& src_attr = reduction.attr();
+  (*attr)["dtype"] = src_attr.at("T");
+  (*attr)["Tgather"] = resource_gather.attr().at("Tindices");
+  if (src_attr.contains("Tidx")) (*attr)["Tidx"] = src_attr.at("Tidx");
+  if (src_attr.contains("Tsegmentids")) {
+    (*attr)["Tsegmentids"] = src_attr.at("Tsegmentids");
+  }
+  SetAttrValue(num_args, &(*attr)["num_args"]);
+  SetAttrValue(SparseSegmentReductionCombiner(reduction),
+               &(*attr)["combiner"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.sparse_segment_reduction] = true;
+  (*nodes_to_delete)[matched.resource_gather] = true;
+
+  return absl::OkStatus();
+}
+
+Status AddRaggedTensorToTensorWithMaskNode(
+    RemapperContext* ctx, const RaggedTensorToTensorWithMask& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& ragged_to_tensor =
+      graph->node(matched.ragged_tensor_to_tensor);
+  const NodeDef& sequence_mask = graph->node(matched.sequence_mask);
+  VLOG(2) << "Fuse RaggedTensorToTensor with SequenceMask:"
+          << " ragged_tensor_to_tensor=" << ragged_to_tensor.name()
+          << " sequence_mask=" << sequence_mask.name()
+          << " on device=" << ragged_to_tensor.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(ragged_to_tensor.name());
+  fused_op.set_device(ragged_to_tensor.device());
+  for (const string& input : ragged_to_tensor.input()) {
+    fused_op.add_input(input);
+  }
+  fused_op.set_op(kRaggedTensorToTensorWithMask);
+
+  auto* attr = fused_op.mutable_attr();
+  *attr = ragged_to_tensor.attr();
+  SetAttrValue(DT_BOOL, &(*attr)["Tmask"]);
+  SetAttrValue(1.0f, &(*attr)["valid_mask_value"]);
+  SetAttrValue(0.0f, &(*attr)["padding_mask_value"]);
+
+  // The mask replaces the result of the Less node.
+  NodeDef mask;
+  mask.set_name(sequence_mask.name());
+  mask.set_device(sequence_mask.device());
+  mask.set_op("Identity");
+  mask.add_input(absl::StrCat(ragged_to_tensor.name(), ":1"));
+  SetAttrValue(DT_BOOL, &(*mask.mutable_attr())["T"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(mask), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.ragged_tensor_to_tensor] = true;
+  (*invalidated_nodes)[matched.sequence_mask] = true;
+  for (int mask_input : matched.mask_inputs) {
+    (*nodes_to_delete)[mask_input] = true;
+  }
+
+  return absl::OkStatus();
+}
+
+Status AddFusedMultiHeadAttentionNode(RemapperContext* ctx,
+                                      const MultiHeadAttention& matched,
+                                      std::vector<bool>* invalidated_nodes,
+                                      std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+  const NodeDef& scores = graph->node(matched.scores);
+  VLOG(2) << "Fuse multi-head attention:"
+          << " scores=" << scores.name() << " output=" << output.name()
+          << " scale=" << matched.scale
+          << " mask=" << (matched.mask.empty() ? "none" : matched.mask)
+          << " on device=" << output.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(output.name());
+  fused_op.set_op(kFusedMultiHeadAttention);
+  fused_op.set_device(output.device());
+  fused_op.add_input(scores.input(0));  // 0: query
+  fused_op.add_input(scores.input(1));  // 1: key
+  fused_op.add_input(output.input(1));  // 2: value
+  if (!matched.mask.empty()) {
+    fused_op.add_input(matched.mask);  // 3: mask
+  }
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = output.attr().at("T");
+  SetAttrValue(matched.mask.empty() ? 0 : 1, &(*attr)["num_args"]);
+  SetAttrValue(matched.scale, &(*attr)["scale"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  (*nodes_to_delete)[matched.softmax] = true;
+  (*nodes_to_delete)[matched.scores] = true;
+  if (matched.add != kMissingIndex) (*nodes_to_delete)[matched.add] = true;
+  if (matched.mul != kMissingIndex) (*nodes_to_delete)[matched.mul] = true;
+
+  return absl::OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4809,17 +5469,54 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for a FusedMatmul fusion (MatMul + BiasAdd + Add) on GPU, which
+  // needs the shapes of the Add inputs to rule out broadcasting.
+  const auto is_biasadd_add_matmul_candidate = [&]() -> bool {
+    if (!IsAdd(*node_def) || !NodeIsOnGpu(node_def)) return false;
+    if (!BlasLtMatmulEnabled()) return false;
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      const auto* fanin_node_view = node_view->GetRegularFanin(i).node_view();
+      if (!IsBiasAdd(*fanin_node_view->node()) ||
+          fanin_node_view->NumRegularFanins() < 1)
+        continue;
+      if (IsMatMul(*fanin_node_view->GetRegularFanin(0).node_view()->node()))
+        return true;
+    }
+    return false;
+  };
+
+  // Candidate for a ResourceGather + SparseSegment reduction fusion, which
+  // needs the shape of the gather indices.
+  const auto is_sparse_segment_reduction_candidate = [&]() -> bool {
+    if (SparseSegmentReductionCombiner(*node_def).empty()) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    return node_view->GetRegularFanin(0).node_view()->node()->op() ==
+           "ResourceGather";
+  };
+
+  // Candidate for a multi-head attention fusion, which needs the shapes of
+  // the query, key, value and mask.
+  const auto is_attention_candidate = [&]() -> bool {
+    if (node_def->op() != "BatchMatMul" && node_def->op() != "BatchMatMulV2")
+      return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    return IsSoftmax(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
            is_act_biasadd_conv_candidate() || IsBiasAdd(*node_def) ||
-           IsTranspose(*node_def);
+           IsTranspose(*node_def) || is_sparse_segment_reduction_candidate() ||
+           is_attention_candidate();
 
   return is_act_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() ||
+         is_biasadd_add_matmul_candidate() ||
+         is_sparse_segment_reduction_candidate() || is_attention_candidate();
 }
 
 inline bool IsXlaCpuGlobalJitOn() {
@@ -5091,6 +5788,15 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap MatMul+BiasAdd+Add into the _FusedMatMul on GPU.
+    if (allow_non_differentiable_rewrites &&
+        FindGpuMatMulWithBiasAddAndAdd(ctx, i, &contract_with_bias_and_add)) {
+      TF_RETURN_IF_ERROR(
+          AddFusedContractionNode(&ctx, contract_with_bias_and_add,
+                                  &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // Fusions are disabled on XLA CPU in IsCpuCompatible(...) invoked by the
     // following fusions.
     //
@@ -5182,6 +5888,40 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap ResourceGather+SparseSegment{Sum,Mean,SqrtN} into the
+    // _ResourceSparseSegmentReduction, which does not materialize the gathered
+    // rows.
+    ResourceGatherWithSparseSegmentReduction gather_with_reduction;
+    if (allow_non_differentiable_rewrites &&
+        FindResourceGatherWithSparseSegmentReduction(ctx, i,
+                                                     &gather_with_reduction)) {
+      TF_RETURN_IF_ERROR(AddResourceSparseSegmentReductionNode(
+          &ctx, gather_with_reduction, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap RaggedTensorToTensor and the SequenceMask of its row lengths into
+    // the _RaggedTensorToTensorWithMask, which writes each row of the dense
+    // tensor and of the mask once.
+    RaggedTensorToTensorWithMask with_mask;
+    if (allow_non_differentiable_rewrites &&
+        FindRaggedTensorToTensorWithMask(ctx, i, &with_mask) &&
+        !invalidated_nodes[with_mask.ragged_tensor_to_tensor]) {
+      TF_RETURN_IF_ERROR(AddRaggedTensorToTensorWithMaskNode(
+          &ctx, with_mask, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap the MatMul+Mul+Add+Softmax+MatMul attention subgraph into the
+    // _FusedMultiHeadAttention, which does not materialize the scores.
+    MultiHeadAttention attention;
+    if (allow_non_differentiable_rewrites &&
+        FindMultiHeadAttention(ctx, i, &attention)) {
+      TF_RETURN_IF_ERROR(AddFusedMultiHeadAttentionNode(
+          &ctx, attention, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -15,11 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <cmath>
+#include <limits>
+#include <set>
+
 #include "tensorflow/cc/ops/nn_ops_internal.h"
+#include "tensorflow/cc/ops/resource_variable_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
@@ -1767,6 +1773,362 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, FuseResourceGatherWithSparseSegmentMean) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto var = ops::VarHandleOp(s.WithOpName("var"), DT_FLOAT, {100, 16});
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT64,
+                         ops::Placeholder::Shape({-1}));
+  auto idx = Placeholder(s.WithOpName("idx"), DT_INT32);
+  auto segment_ids = Placeholder(s.WithOpName("segment_ids"), DT_INT32);
+  auto num_segments = ops::Const(s.WithOpName("num_segments"), 8);
+
+  auto gather = ops::ResourceGather(s.WithOpName("gather"), var, ids, DT_FLOAT);
+  auto mean = ops::SparseSegmentMeanWithNumSegments(
+      s.WithOpName("mean"), gather, idx, segment_ids, num_segments);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), mean);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "gather");
+    if (node.name() == "mean") {
+      EXPECT_EQ(node.op(), "_ResourceSparseSegmentReduction");
+      ASSERT_EQ(node.input_size(), 5);
+      EXPECT_EQ(node.input(0), "var");
+      EXPECT_EQ(node.input(1), "ids");
+      EXPECT_EQ(node.input(2), "idx");
+      EXPECT_EQ(node.input(3), "segment_ids");
+      EXPECT_EQ(node.input(4), "num_segments");
+      EXPECT_EQ(node.attr().at("dtype").type(), DT_FLOAT);
+      EXPECT_EQ(node.attr().at("Tgather").type(), DT_INT64);
+      EXPECT_EQ(node.attr().at("num_args").i(), 1);
+      EXPECT_EQ(node.attr().at("combiner").s(), "mean");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+}
+
+TEST_F(RemapperTest, FuseResourceGatherWithSparseSegmentSqrtNOnGpu) {
+  using ::tensorflow::ops::Placeholder;
+
+  for (const string& gather_device : {"/device:GPU:0", "/device:CPU:0"}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto var = ops::VarHandleOp(s.WithOpName("var"), DT_HALF, {100, 16});
+    auto ids = Placeholder(s.WithOpName("ids"), DT_INT32,
+                           ops::Placeholder::Shape({-1}));
+    auto idx = Placeholder(s.WithOpName("idx"), DT_INT32);
+    auto segment_ids = Placeholder(s.WithOpName("segment_ids"), DT_INT64);
+
+    auto gather =
+        ops::ResourceGather(s.WithOpName("gather"), var, ids, DT_HALF);
+    auto sqrtn = ops::SparseSegmentSqrtN(s.WithOpName("sqrtn"), gather, idx,
+                                         segment_ids);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), sqrtn);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      NodeDef* node = item.graph.mutable_node(i);
+      node->set_device(node->name() == "gather" ? gather_device
+                                                : "/device:GPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    // The gather and the reduction are only fused on the same device type.
+    const bool fused = gather_device == "/device:GPU:0";
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.name() == "sqrtn") {
+        if (fused) {
+          EXPECT_EQ(node.op(), "_ResourceSparseSegmentReduction");
+          EXPECT_EQ(node.device(), "/device:GPU:0");
+          EXPECT_EQ(node.attr().at("num_args").i(), 0);
+          EXPECT_EQ(node.attr().at("combiner").s(), "sqrtn");
+        } else {
+          EXPECT_EQ(node.op(), "SparseSegmentSqrtN");
+        }
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+  }
+}
+
+TEST_F(RemapperTest, DoNotFuseSharedResourceGatherWithSparseSegmentSum) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto var = ops::VarHandleOp(s.WithOpName("var"), DT_FLOAT, {100, 16});
+  auto ids = Placeholder(s.WithOpName("ids"), DT_INT32,
+                         ops::Placeholder::Shape({-1}));
+  auto idx = Placeholder(s.WithOpName("idx"), DT_INT32);
+  auto segment_ids = Placeholder(s.WithOpName("segment_ids"), DT_INT32);
+
+  // The gathered rows are also used by another op, so they must be gathered.
+  auto gather = ops::ResourceGather(s.WithOpName("gather"), var, ids, DT_FLOAT);
+  auto sum = ops::SparseSegmentSum(s.WithOpName("sum"), gather, idx,
+                                   segment_ids);
+  auto fetch_sum = ops::Identity(s.WithOpName("fetch_sum"), sum);
+  auto fetch_gather = ops::Identity(s.WithOpName("fetch_gather"), gather);
+
+  GrapplerItem item;
+  item.fetch = {"fetch_sum", "fetch_gather"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "sum") {
+      EXPECT_EQ(node.op(), "SparseSegmentSum");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+}
+
+TEST_F(RemapperTest, FuseRaggedTensorToTensorWithSequenceMask) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto values = Placeholder(s.WithOpName("values"), DT_FLOAT,
+                            ops::Placeholder::Shape({-1}));
+  auto splits = Placeholder(s.WithOpName("splits"), DT_INT64,
+                            ops::Placeholder::Shape({-1}));
+  auto shape = ops::Const(s.WithOpName("shape"), int64_t{-1});
+  auto default_value = ops::Const(s.WithOpName("default_value"), 0.0f);
+  tensorflow::Node* dense_node;
+  TF_ASSERT_OK(
+      tensorflow::NodeBuilder("dense", "RaggedTensorToTensor",
+                              s.graph()->op_registry())
+          .Input(ops::AsNodeOut(s, shape))
+          .Input(ops::AsNodeOut(s, values))
+          .Input(ops::AsNodeOut(s, default_value))
+          .Input(ops::AsNodeOutList(s, {splits}))
+          .Attr("row_partition_types", std::vector<string>{"ROW_SPLITS"})
+          .Finalize(s.graph(), &dense_node));
+  Output dense(dense_node, 0);
+
+  // tf.sequence_mask(rt.row_lengths(), tf.shape(dense)[1])
+  auto upper = ops::StridedSlice(s.WithOpName("upper"), splits, {1}, {0}, {1},
+                                 ops::StridedSlice::EndMask(1));
+  auto lower = ops::StridedSlice(s.WithOpName("lower"), splits, {0}, {-1},
+                                 {1}, ops::StridedSlice::BeginMask(1));
+  auto row_lengths = ops::Sub(s.WithOpName("row_lengths"), upper, lower);
+  auto dense_shape = ops::Shape(s.WithOpName("dense_shape"), dense);
+  auto maxlen =
+      ops::StridedSlice(s.WithOpName("maxlen"), dense_shape, {1}, {2}, {1},
+                        ops::StridedSlice::ShrinkAxisMask(1));
+  auto range = ops::Range(s.WithOpName("range"), 0, maxlen, 1);
+  auto expand_dims = ops::ExpandDims(s.WithOpName("expand_dims"), row_lengths,
+                                     -1);
+  auto cast = ops::Cast(s.WithOpName("cast"), expand_dims, DT_INT32);
+  auto mask = ops::Less(s.WithOpName("mask"), range, cast);
+  auto fetch_dense = ops::Identity(s.WithOpName("fetch_dense"), dense);
+  auto fetch_mask = ops::Identity(s.WithOpName("fetch_mask"), mask);
+
+  GrapplerItem item;
+  item.fetch = {"fetch_dense", "fetch_mask"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The nodes of the mask computation are removed.
+  const std::set<string> removed = {"upper",       "lower",  "row_lengths",
+                                    "dense_shape", "maxlen", "range",
+                                    "expand_dims", "cast"};
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(removed.count(node.name()), 0) << node.name();
+    if (node.name() == "dense") {
+      EXPECT_EQ(node.op(), "_RaggedTensorToTensorWithMask");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "shape");
+      EXPECT_EQ(node.input(1), "values");
+      EXPECT_EQ(node.input(2), "default_value");
+      EXPECT_EQ(node.input(3), "splits");
+      EXPECT_EQ(node.attr().at("Tmask").type(), DT_BOOL);
+      found++;
+    } else if (node.name() == "mask") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "dense:1");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+}
+
+TEST_F(RemapperTest, FuseMultiHeadAttention) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 10, 8}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         ops::Placeholder::Shape({2, 4, 12, 8}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 4, 12, 6}));
+  auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                          ops::Placeholder::Shape({2, 1, 1, 12}));
+  auto scores =
+      ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                         ops::BatchMatMulV2::AdjY(true));
+  auto scale = ops::Const(s.WithOpName("scale"), 0.125f);
+  auto scaled = ops::Mul(s.WithOpName("scaled"), scores, scale);
+  auto masked = ops::AddV2(s.WithOpName("masked"), scaled, mask);
+  auto probs = ops::Softmax(s.WithOpName("probs"), masked);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), probs, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  auto query_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 10, 8});
+  auto key_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 12, 8});
+  auto value_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 12, 6});
+  auto mask_t = GenerateRandomTensor<DT_FLOAT>({2, 1, 1, 12});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"query", query_t},
+               {"key", key_t},
+               {"value", value_t},
+               {"mask", mask_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::AGGRESSIVE);  // trust placeholders shape
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The scores are never materialized.
+  const std::set<string> removed = {"scores", "scaled", "masked", "probs"};
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ(removed.count(node.name()), 0) << node.name();
+    if (node.name() == "attention") {
+      EXPECT_EQ(node.op(), "_FusedMultiHeadAttention");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "query");
+      EXPECT_EQ(node.input(1), "key");
+      EXPECT_EQ(node.input(2), "value");
+      EXPECT_EQ(node.input(3), "mask");
+      EXPECT_EQ(node.attr().at("num_args").i(), 1);
+      EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.125f);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseMultiHeadAttentionMatchesUnfusedGraph) {
+  using ::tensorflow::ops::Placeholder;
+
+  for (const string& device : {"/device:CPU:0", "/device:GPU:0"}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 3, 70, 16}));
+    auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 3, 300, 16}));
+    auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 3, 300, 8}));
+    auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT,
+                            ops::Placeholder::Shape({2, 1, 70, 300}));
+    auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                     ops::BatchMatMulV2::AdjY(true));
+    auto masked = ops::AddV2(s.WithOpName("masked"), mask, scores);
+    auto probs = ops::Softmax(s.WithOpName("probs"), masked);
+    auto attention =
+        ops::BatchMatMulV2(s.WithOpName("attention"), probs, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    // Spans several blocks of queries and keys of the CPU kernel, and masks
+    // out some rows entirely, which Softmax turns into NaN.
+    auto mask_t = GenerateRandomTensor<DT_FLOAT>({2, 1, 70, 300});
+    auto mask_values = mask_t.tensor<float, 4>();
+    for (int j = 0; j < 300; ++j) {
+      mask_values(0, 0, 3, j) = -std::numeric_limits<float>::infinity();
+      mask_values(1, 0, 69, j) = -std::numeric_limits<float>::infinity();
+    }
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", GenerateRandomTensor<DT_FLOAT>({2, 3, 70, 16})},
+                 {"key", GenerateRandomTensor<DT_FLOAT>({2, 3, 300, 16})},
+                 {"value", GenerateRandomTensor<DT_FLOAT>({2, 3, 300, 8})},
+                 {"mask", mask_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device(device);
+    }
+
+    Remapper optimizer(RewriterConfig::AGGRESSIVE);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    // There is no GPU kernel for the fused op.
+    const bool on_cpu = device == "/device:CPU:0";
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.name() == "attention") {
+        EXPECT_EQ(node.op(),
+                  on_cpu ? "_FusedMultiHeadAttention" : "BatchMatMulV2");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+    if (!on_cpu) continue;
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    EXPECT_TRUE(
+        std::isnan(tensors_expected[0].tensor<float, 4>()(0, 0, 3, 0)));
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+}
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -1871,6 +2233,67 @@ TEST_F(RemapperFuseMatMulWithBiasTest, Bf16) {
   RunTest<DT_BFLOAT16>();  // NOLINT
 }
 
+TEST_F(RemapperTest, FuseMatMulWithBiasAndAddOnGpu) {
+#if !(GOOGLE_CUDA)
+  GTEST_SKIP() << "No CUDA, skip FuseMatMulWithBiasAndAdd on GPU";
+#endif  // !GOOGLE_CUDA
+  using ::tensorflow::ops::Placeholder;
+
+  // The residual add is only fused if it does not broadcast.
+  for (const bool broadcast : {false, true}) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto lhs = Placeholder(s.WithOpName("lhs"), DT_HALF,
+                           ops::Placeholder::Shape({8, 32}));
+    auto rhs = Placeholder(s.WithOpName("rhs"), DT_HALF,
+                           ops::Placeholder::Shape({32, 64}));
+    auto bias = Placeholder(s.WithOpName("bias"), DT_HALF,
+                            ops::Placeholder::Shape({64}));
+    auto residual = Placeholder(
+        s.WithOpName("residual"), DT_HALF,
+        ops::Placeholder::Shape(broadcast ? PartialTensorShape({64})
+                                          : PartialTensorShape({8, 64})));
+
+    auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, rhs);
+    auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+    auto add = ops::Add(s.WithOpName("add"), bias_add, residual);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), add);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:GPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.name() == "add" && !broadcast) {
+        EXPECT_EQ(node.op(), "_FusedMatMul");
+        ASSERT_EQ(node.input_size(), 4);
+        EXPECT_EQ(node.input(0), "lhs");
+        EXPECT_EQ(node.input(1), "rhs");
+        EXPECT_EQ(node.input(2), "bias");
+        EXPECT_EQ(node.input(3), "residual");
+        EXPECT_EQ(node.attr().at("num_args").i(), 2);
+        const auto fused_ops = node.attr().at("fused_ops").list().s();
+        ASSERT_EQ(fused_ops.size(), 2);
+        EXPECT_EQ(fused_ops[0], "BiasAdd");
+        EXPECT_EQ(fused_ops[1], "Add");
+        found++;
+      } else if (node.name() == "add") {
+        EXPECT_EQ(node.op(), "Add");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+  }
+}
+
 // TODO(b/161005848): Fix flaky test.
 TEST_F(RemapperTest, DISABLED_FuseConv2DWithBiasAndActivationOnGPU) {
 #if !(GOOGLE_CUDA)
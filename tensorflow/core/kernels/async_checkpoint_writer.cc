@@ -0,0 +1,197 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/distributed_runtime/coordination/coordination_service_agent.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace checkpoint {
+namespace {
+
+// Set by a task when it starts an asynchronous write of a prefix.
+std::string PendingKey(absl::string_view prefix) {
+  return absl::StrCat("tf_async_checkpoint/", prefix, "/pending");
+}
+
+// Set by a task when the write is done, to "" if it succeeded and to the
+// error otherwise.
+std::string DoneKey(absl::string_view prefix) {
+  return absl::StrCat("tf_async_checkpoint/", prefix, "/done");
+}
+
+}  // namespace
+
+absl::Status WriteTensorBundle(Env* env, const std::string& prefix,
+                               const std::vector<BundleWriteEntry>& entries) {
+  BundleWriter writer(env, prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix;
+  for (const BundleWriteEntry& entry : entries) {
+    if (entry.is_slice) {
+      TF_RETURN_IF_ERROR(writer.AddSlice(entry.name, entry.full_shape,
+                                         entry.slice, entry.tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(entry.name, entry.tensor));
+    }
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix;
+  return absl::OkStatus();
+}
+
+AsyncCheckpointWriter* AsyncCheckpointWriter::Global() {
+  static AsyncCheckpointWriter* writer = [] {
+    int64_t num_threads;
+    absl::Status s =
+        ReadInt64FromEnvVar("TF_ASYNC_CHECKPOINT_THREADS", 0, &num_threads);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return static_cast<AsyncCheckpointWriter*>(nullptr);
+    }
+    if (num_threads <= 0) return static_cast<AsyncCheckpointWriter*>(nullptr);
+    return new AsyncCheckpointWriter(Env::Default(), num_threads);
+  }();
+  static const bool flushed_at_exit = [] {
+    if (writer != nullptr) {
+      // The writer is leaked, as kernels may still use it during static
+      // destruction, so its writes are waited for before.
+      std::atexit([] {
+        absl::Status s = writer->WaitForAll();
+        if (!s.ok()) {
+          LOG(ERROR) << "Asynchronous checkpoint writes failed at exit: " << s;
+        }
+      });
+    }
+    return true;
+  }();
+  (void)flushed_at_exit;
+  return writer;
+}
+
+AsyncCheckpointWriter::AsyncCheckpointWriter(Env* env, int num_threads)
+    : env_(env), pool_(env, "async_checkpoint_writer", num_threads) {}
+
+absl::Status AsyncCheckpointWriter::WriteAsync(
+    const std::string& prefix, std::vector<BundleWriteEntry> entries,
+    tsl::CoordinationServiceAgent* agent) {
+  // Waits for an earlier write to the same files, whose error was logged.
+  Wait(prefix, /*agent=*/nullptr).IgnoreError();
+  if (agent != nullptr) {
+    agent->DeleteKeyValue(DoneKey(prefix)).IgnoreError();
+    TF_RETURN_IF_ERROR(agent->InsertKeyValue(PendingKey(prefix), "",
+                                             /*allow_overwrite=*/true));
+  }
+  auto write = std::make_shared<PendingWrite>();
+  {
+    mutex_lock l(mu_);
+    writes_[prefix] = write;
+  }
+  pool_.Schedule([this, prefix, entries = std::move(entries), agent, write]() {
+    write->status = WriteTensorBundle(env_, prefix, entries);
+    if (!write->status.ok()) {
+      LOG(ERROR) << "Asynchronous write of checkpoint " << prefix
+                 << " failed: " << write->status;
+    }
+    if (agent != nullptr) {
+      absl::Status s = agent->InsertKeyValue(
+          DoneKey(prefix), write->status.ok() ? "" : write->status.ToString(),
+          /*allow_overwrite=*/true);
+      if (!s.ok()) {
+        LOG(ERROR) << "Failed to publish the write of checkpoint " << prefix
+                   << ": " << s;
+      }
+    }
+    {
+      mutex_lock l(mu_);
+      auto it = writes_.find(prefix);
+      // Only failed writes are kept for `Wait()`.
+      if (write->status.ok() && it != writes_.end() && it->second == write) {
+        writes_.erase(it);
+      }
+    }
+    write->done.Notify();
+  });
+  return absl::OkStatus();
+}
+
+absl::Status AsyncCheckpointWriter::Wait(const std::string& prefix,
+                                         tsl::CoordinationServiceAgent* agent) {
+  std::shared_ptr<PendingWrite> write;
+  {
+    mutex_lock l(mu_);
+    auto it = writes_.find(prefix);
+    if (it != writes_.end()) write = it->second;
+  }
+  absl::Status status;
+  if (write != nullptr) {
+    write->done.WaitForNotification();
+    status = write->status;
+    mutex_lock l(mu_);
+    auto it = writes_.find(prefix);
+    if (it != writes_.end() && it->second == write) {
+      writes_.erase(it);
+    }
+  }
+  if (agent == nullptr || !agent->TryGetKeyValue(PendingKey(prefix)).ok()) {
+    return status;
+  }
+  VLOG(1) << "Waiting for the asynchronous write of checkpoint " << prefix;
+  absl::StatusOr<std::string> result = agent->GetKeyValue(DoneKey(prefix));
+  TF_RETURN_IF_ERROR(result.status());
+  agent->DeleteKeyValue(PendingKey(prefix)).IgnoreError();
+  agent->DeleteKeyValue(DoneKey(prefix)).IgnoreError();
+  if (!result->empty()) {
+    status.Update(errors::DataLoss("Asynchronous write of checkpoint ",
+                                   prefix, " failed: ", *result));
+  }
+  return status;
+}
+
+absl::Status AsyncCheckpointWriter::WaitForAll() {
+  std::vector<std::string> prefixes;
+  {
+    mutex_lock l(mu_);
+    prefixes.reserve(writes_.size());
+    for (const auto& write : writes_) prefixes.push_back(write.first);
+  }
+  absl::Status status;
+  for (const std::string& prefix : prefixes) {
+    status.Update(Wait(prefix, /*agent=*/nullptr));
+  }
+  return status;
+}
+
+absl::Status WaitForAsyncCheckpointWrites() {
+  AsyncCheckpointWriter* writer = AsyncCheckpointWriter::Global();
+  return writer != nullptr ? writer->WaitForAll() : absl::OkStatus();
+}
+
+}  // namespace checkpoint
+}  // namespace tensorflow
@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
+#define TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tsl {
+class CoordinationServiceAgent;
+}  // namespace tsl
+
+namespace tensorflow {
+namespace checkpoint {
+
+// A tensor to write to a tensor bundle, or a slice of it.
+struct BundleWriteEntry {
+  std::string name;
+  Tensor tensor;
+  // Set if `tensor` is the slice `slice` of a tensor of shape `full_shape`.
+  bool is_slice = false;
+  TensorShape full_shape;
+  TensorSlice slice;
+};
+
+// Writes `entries` to the tensor bundle at `prefix`.
+absl::Status WriteTensorBundle(Env* env, const std::string& prefix,
+                               const std::vector<BundleWriteEntry>& entries);
+
+// Writes tensor bundles in background threads, so that `SaveV2` returns once
+// it has copied its inputs instead of once the bundle is written.
+//
+// A write is waited for by `MergeV2Checkpoints` and `RestoreV2` of its
+// prefix, and by `WaitForAsyncCheckpointWrites`. With sharded saves of
+// several tasks, the tasks publish the status of their writes to the
+// coordination service, where the merging task waits for them. The writes of
+// the global writer still pending when the process exits normally are
+// waited for.
+//
+// This class is thread-safe.
+class AsyncCheckpointWriter {
+ public:
+  // Returns the process-wide writer, which has as many threads as the
+  // TF_ASYNC_CHECKPOINT_THREADS environment variable. Returns nullptr if the
+  // variable is unset or 0, which makes saves synchronous. The variable must
+  // have the same value on all tasks of a job. The writer is never destroyed,
+  // but its pending writes are waited for at exit.
+  static AsyncCheckpointWriter* Global();
+
+  AsyncCheckpointWriter(Env* env, int num_threads);
+  // Waits for the pending writes.
+  ~AsyncCheckpointWriter() = default;
+
+  AsyncCheckpointWriter(const AsyncCheckpointWriter&) = delete;
+  void operator=(const AsyncCheckpointWriter&) = delete;
+
+  // Starts writing `entries` to the tensor bundle at `prefix`. The tensors
+  // of `entries` must not be modified until the write is done, so they are
+  // usually copies. If `agent` is not null, the status of the write is
+  // published to the coordination service.
+  absl::Status WriteAsync(const std::string& prefix,
+                          std::vector<BundleWriteEntry> entries,
+                          tsl::CoordinationServiceAgent* agent);
+
+  // Waits for the write to `prefix` and returns its status. If the write was
+  // started by another task, waits for it through `agent`, if not null.
+  // Returns OK if there is no such write.
+  absl::Status Wait(const std::string& prefix,
+                    tsl::CoordinationServiceAgent* agent);
+
+  // Waits for the writes started by this process and returns the first error
+  // among them.
+  absl::Status WaitForAll();
+
+ private:
+  struct PendingWrite {
+    absl::Status status;
+    Notification done;
+  };
+
+  Env* const env_;
+
+  mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<PendingWrite>> writes_
+      TF_GUARDED_BY(mu_);
+
+  // Destroyed first, which waits for the pending writes.
+  thread::ThreadPool pool_;
+};
+
+// Waits for the writes of the global writer, if any, and returns the first
+// error among them. Called before a checkpoint is reported as saved, since
+// a prefix that is not merged is not waited for otherwise.
+absl::Status WaitForAsyncCheckpointWrites();
+
+}  // namespace checkpoint
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
@@ -0,0 +1,143 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace checkpoint {
+namespace {
+
+std::string Prefix(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), "async_checkpoint_writer_test", name);
+}
+
+std::vector<BundleWriteEntry> Entries(float value) {
+  std::vector<BundleWriteEntry> entries(2);
+  entries[0].name = "a";
+  entries[0].tensor = test::AsTensor<float>({value, value + 1});
+  // The second half of a [4] tensor.
+  entries[1].name = "b";
+  entries[1].tensor = test::AsTensor<float>({value + 2, value + 3});
+  entries[1].is_slice = true;
+  entries[1].full_shape = TensorShape({4});
+  entries[1].slice = TensorSlice::ParseOrDie("2,2");
+  return entries;
+}
+
+void ExpectBundle(const std::string& prefix, float value) {
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor a;
+  TF_ASSERT_OK(reader.Lookup("a", &a));
+  test::ExpectTensorEqual<float>(a, test::AsTensor<float>({value, value + 1}));
+  Tensor b(DT_FLOAT, TensorShape({2}));
+  TF_ASSERT_OK(reader.LookupSlice("b", TensorSlice::ParseOrDie("2,2"), &b));
+  test::ExpectTensorEqual<float>(b,
+                                 test::AsTensor<float>({value + 2, value + 3}));
+}
+
+TEST(AsyncCheckpointWriterTest, WriteTensorBundle) {
+  const std::string prefix = Prefix("sync");
+  TF_ASSERT_OK(WriteTensorBundle(Env::Default(), prefix, Entries(1)));
+  ExpectBundle(prefix, 1);
+}
+
+TEST(AsyncCheckpointWriterTest, WriteAsync) {
+  AsyncCheckpointWriter writer(Env::Default(), /*num_threads=*/2);
+  const std::string prefix0 = Prefix("async0");
+  const std::string prefix1 = Prefix("async1");
+  TF_ASSERT_OK(writer.WriteAsync(prefix0, Entries(1), /*agent=*/nullptr));
+  TF_ASSERT_OK(writer.WriteAsync(prefix1, Entries(5), /*agent=*/nullptr));
+  TF_ASSERT_OK(writer.Wait(prefix0, /*agent=*/nullptr));
+  TF_ASSERT_OK(writer.Wait(prefix1, /*agent=*/nullptr));
+  ExpectBundle(prefix0, 1);
+  ExpectBundle(prefix1, 5);
+  // Nothing to wait for.
+  TF_EXPECT_OK(writer.Wait(Prefix("unknown"), /*agent=*/nullptr));
+}
+
+TEST(AsyncCheckpointWriterTest, RewriteSamePrefix) {
+  AsyncCheckpointWriter writer(Env::Default(), /*num_threads=*/2);
+  const std::string prefix = Prefix("rewrite");
+  TF_ASSERT_OK(writer.WriteAsync(prefix, Entries(1), /*agent=*/nullptr));
+  // Waits for the first write before starting.
+  TF_ASSERT_OK(writer.WriteAsync(prefix, Entries(7), /*agent=*/nullptr));
+  TF_ASSERT_OK(writer.Wait(prefix, /*agent=*/nullptr));
+  ExpectBundle(prefix, 7);
+}
+
+TEST(AsyncCheckpointWriterTest, FailedWrite) {
+  AsyncCheckpointWriter writer(Env::Default(), /*num_threads=*/1);
+  // A file where the directory of the prefix should be.
+  const std::string file = Prefix("file");
+  TF_ASSERT_OK(
+      Env::Default()->RecursivelyCreateDir(std::string(io::Dirname(file))));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file, "contents"));
+  const std::string prefix = io::JoinPath(file, "ckpt");
+  TF_ASSERT_OK(writer.WriteAsync(prefix, Entries(1), /*agent=*/nullptr));
+  EXPECT_FALSE(writer.Wait(prefix, /*agent=*/nullptr).ok());
+}
+
+TEST(AsyncCheckpointWriterTest, WaitForAll) {
+  AsyncCheckpointWriter writer(Env::Default(), /*num_threads=*/2);
+  const std::string prefix0 = Prefix("all0");
+  const std::string prefix1 = Prefix("all1");
+  TF_ASSERT_OK(writer.WriteAsync(prefix0, Entries(1), /*agent=*/nullptr));
+  TF_ASSERT_OK(writer.WriteAsync(prefix1, Entries(5), /*agent=*/nullptr));
+  const std::string file = Prefix("all_file");
+  TF_ASSERT_OK(
+      Env::Default()->RecursivelyCreateDir(std::string(io::Dirname(file))));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), file, "contents"));
+  TF_ASSERT_OK(writer.WriteAsync(io::JoinPath(file, "ckpt"), Entries(1),
+                                 /*agent=*/nullptr));
+  EXPECT_FALSE(writer.WaitForAll().ok());
+  ExpectBundle(prefix0, 1);
+  ExpectBundle(prefix1, 5);
+  // The failure was reported.
+  TF_EXPECT_OK(writer.WaitForAll());
+}
+
+TEST(AsyncCheckpointWriterTest, GlobalWritesAreWaitedForAtExit) {
+  const std::string prefix = Prefix("at_exit");
+  EXPECT_EXIT(
+      {
+        setenv("TF_ASYNC_CHECKPOINT_THREADS", "1", /*overwrite=*/1);
+        AsyncCheckpointWriter* writer = AsyncCheckpointWriter::Global();
+        if (writer == nullptr ||
+            !writer->WriteAsync(prefix, Entries(3), /*agent=*/nullptr).ok()) {
+          std::_Exit(1);
+        }
+        std::exit(0);
+      },
+      ::testing::ExitedWithCode(0), "");
+  ExpectBundle(prefix, 3);
+}
+
+}  // namespace
+}  // namespace checkpoint
+}  // namespace tensorflow
@@ -316,6 +316,10 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
                                  &enable_large_batch_splitting_));
     has_attribute_enable_large_batch_splitting_ = true;
   }
+  if (c->HasAttr("enable_ragged_batching")) {
+    OP_REQUIRES_OK(
+        c, c->GetAttr("enable_ragged_batching", &enable_ragged_batching_));
+  }
 
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
@@ -420,6 +424,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
           &new_resource));
+      new_resource->set_ragged_batching(enable_ragged_batching_);
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
@@ -442,6 +447,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           low_priority_max_enqueued_batches_, low_priority_allowed_batch_sizes_,
           mixed_priority_batching_policy, enable_large_batch_splitting_,
           batch_padding_policy_, &new_resource));
+      new_resource->set_ragged_batching(enable_ragged_batching_);
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
@@ -72,6 +72,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/incremental_barrier.h"
 #include "tsl/platform/criticality.h"
 #include "tsl/platform/errors.h"
@@ -81,6 +82,25 @@ namespace tensorflow {
 namespace serving {
 namespace {
 
+// Whether the outputs of the tasks alias the aligned slices of the batched
+// outputs instead of being copied out of them. This saves a copy of every
+// output, but keeps all of a batched output alive until the outputs of all
+// its tasks are released. Set by the TF_BATCH_ALIAS_OUTPUTS environment
+// variable.
+bool AliasBatchOutputs() {
+  static const bool alias = [] {
+    bool value;
+    absl::Status s =
+        ReadBoolFromEnvVar("TF_BATCH_ALIAS_OUTPUTS", false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.message();
+      return false;
+    }
+    return value;
+  }();
+  return alias;
+}
+
 // TODO(b/181883417): Replace with RecordPaddingSizeV2.
 void RecordPaddingSize(int32_t padding_size, const string& model_name,
                        int32_t execution_batch_size, const string& op_name) {
@@ -323,7 +343,9 @@ BatchResourceBase::BatchTask::CreateSplitTask(
 }
 
 using ::tensorflow::concat_split_util::Concat;
+using ::tensorflow::concat_split_util::FlattenRaggedRows;
 using ::tensorflow::concat_split_util::Split;
+using ::tensorflow::concat_split_util::SplitAliasing;
 using TensorMatrix = std::vector<std::vector<Tensor>>;
 
 string GetTensorNamesAndShapesString(const OpKernelContext* context,
@@ -708,7 +730,8 @@ Status BatchResourceBase::ConcatInputTensors(
 
   // All tasks should have the same number of input edges.
   const int num_inputs = batch.task(0).inputs.size();
-  concatenated_tensors->reserve(num_inputs);
+  concatenated_tensors->reserve(ragged_batching_ ? 2 * num_inputs
+                                                 : num_inputs);
 
   // Process each input one at a time (the typical case has just one). When
   // `just_for_warmup` is true, the real data is not added. Otherwise, the real
@@ -729,6 +752,26 @@ Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    if (ragged_batching_) {
+      // Padding rows are empty, so they cost no computation.
+      if (to_concatenate.empty()) {
+        to_concatenate.push_back(batch.task(0).inputs.at(i).Slice(0, 0));
+      }
+      std::vector<Tensor> flat_inputs;
+      Tensor row_splits;
+      TF_RETURN_IF_ERROR(FlattenRaggedRows(to_concatenate, padding_amount,
+                                           &flat_inputs, &row_splits));
+      Tensor values;
+      if (flat_inputs.size() == 1) {
+        values = std::move(flat_inputs[0]);
+      } else {
+        TF_RETURN_IF_ERROR(Concat(context, flat_inputs, &values));
+      }
+      concatenated_tensors->push_back(std::move(values));
+      concatenated_tensors->push_back(std::move(row_splits));
+      continue;
+    }
+
     // Add padding as needed if padding is allowed. Use the first row of the
     // first task's tensor as the data for padding.
     if (padding_amount != 0) {
@@ -751,9 +794,14 @@ Status BatchResourceBase::ConcatInputTensors(
     }
 
     Tensor concatenated_tensor;
-    Status concat_status =
-        Concat(context, to_concatenate, &concatenated_tensor);
-    TF_RETURN_IF_ERROR(concat_status);
+    if (to_concatenate.size() == 1) {
+      // A single task without padding is batched as is.
+      concatenated_tensor = std::move(to_concatenate[0]);
+    } else {
+      Status concat_status =
+          Concat(context, to_concatenate, &concatenated_tensor);
+      TF_RETURN_IF_ERROR(concat_status);
+    }
     concatenated_tensors->push_back(concatenated_tensor);
   }
   return absl::OkStatus();
@@ -789,10 +837,14 @@ Status BatchResourceBase::ConcatInputTensors(
           for (int j = 0; j < output->size(); ++j) {
             to_concatenate.push_back(std::move((*output)[j][i]));
           }
-          const auto concat_status =
-              Concat(op_kernel_context, to_concatenate, &output_tensor);
-          if (!concat_status.ok()) {
-            status->Update(concat_status);
+          if (to_concatenate.size() == 1) {
+            output_tensor = std::move(to_concatenate[0]);
+          } else {
+            const auto concat_status =
+                Concat(op_kernel_context, to_concatenate, &output_tensor);
+            if (!concat_status.ok()) {
+              status->Update(concat_status);
+            }
           }
           if (forced_warmup_batch_size == 0) {
             op_kernel_context->set_output(i, std::move(output_tensor));
@@ -908,8 +960,12 @@ Status BatchResourceBase::SplitOutputTensors(
     }
 
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+    const Status split_status =
+        AliasBatchOutputs()
+            ? SplitAliasing(output_tensor, task_sizes_plus_optional_padding,
+                            &split_tensor)
+            : tensor::Split(output_tensor, task_sizes_plus_optional_padding,
+                            &split_tensor);
     DCHECK(split_status.ok()) << split_status;
     if (!split_status.ok()) {
       return errors::Internal("Tensor split operation failed: ",
@@ -186,6 +186,14 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // If true, each batched input of the batch function, whose shape is
+  // [batch_size, row_length, ...] with a row length that may differ between
+  // tasks, is passed as the values and int64 row splits of a ragged tensor
+  // instead of as a dense tensor. Padding then only adds empty rows.
+  void set_ragged_batching(bool ragged_batching) {
+    ragged_batching_ = ragged_batching;
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -348,6 +356,8 @@ class BatchResourceBase : public ResourceBase {
 
   SessionMetadata session_metadata_;
 
+  bool ragged_batching_ = false;
+
   absl::Mutex outstanding_batch_mu_;
   int num_outstanding_batched_items_ TF_GUARDED_BY(outstanding_batch_mu_) = 0;
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/concat_lib.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/platform/status.h"
@@ -246,6 +247,98 @@ inline Status Split(OpKernelContext* context, const Tensor& input,
   return split_status;
 }
 
+// Splits 'input' along the zeroth dimension into slices that alias 'input'
+// where they are aligned, and into copies of the other slices. Unlike
+// 'Split', this does not copy the aligned slices of an unaligned input, but
+// an aliasing slice keeps all of 'input' alive.
+inline Status SplitAliasing(const Tensor& input,
+                            const absl::Span<const int64_t> sizes,
+                            std::vector<Tensor>* outputs) {
+  if (input.dims() == 0) {
+    return errors::InvalidArgument("Cannot split a zero-dimensional tensor");
+  }
+  int64_t total_size = 0;
+  for (const int64_t size : sizes) {
+    total_size += size;
+  }
+  if (total_size != input.dim_size(0)) {
+    return errors::InvalidArgument(
+        "Sum of split sizes must equal dim0-size of input tensor");
+  }
+  int64_t position = 0;
+  for (const int64_t size : sizes) {
+    Tensor slice = input.Slice(position, position + size);
+    if (!slice.IsAligned()) {
+      slice = tensor::DeepCopy(slice);
+    }
+    outputs->push_back(std::move(slice));
+    position += size;
+  }
+  return absl::OkStatus();
+}
+
+// Prepares 'inputs', whose shapes are [num_rows, row_length, ...] with row
+// lengths that may differ between inputs, to be batched as one ragged tensor.
+// Sets 'flat_inputs' to 'inputs' reshaped to [num_rows * row_length, ...],
+// which alias 'inputs' and concatenate to the values of the ragged tensor,
+// and 'row_splits' to its int64 row splits, ending with 'num_empty_rows'
+// rows of length zero.
+inline Status FlattenRaggedRows(const absl::Span<const Tensor> inputs,
+                                int64_t num_empty_rows,
+                                std::vector<Tensor>* flat_inputs,
+                                Tensor* row_splits) {
+  if (inputs.empty()) {
+    return errors::InvalidArgument("No tensors to batch as a ragged tensor");
+  }
+  const TensorShape& first_shape = inputs[0].shape();
+  int64_t num_rows = num_empty_rows;
+  for (const Tensor& input : inputs) {
+    if (input.dims() < 2) {
+      return errors::InvalidArgument(
+          "Ragged batching requires tensors of rank 2 or more; got shape ",
+          input.shape().DebugString());
+    }
+    if (input.dims() != first_shape.dims()) {
+      return errors::InvalidArgument(
+          "Ranks of all input tensors should match: shape[0] = ",
+          first_shape.DebugString(), " vs. ", input.shape().DebugString());
+    }
+    for (int j = 2; j < input.dims(); ++j) {
+      if (input.dim_size(j) != first_shape.dim_size(j)) {
+        return errors::InvalidArgument(
+            "Inner dimensions of inputs should match: shape[0] = ",
+            first_shape.DebugString(), " vs. ", input.shape().DebugString());
+      }
+    }
+    num_rows += input.dim_size(0);
+  }
+
+  *row_splits = Tensor(DT_INT64, TensorShape({num_rows + 1}));
+  auto splits = row_splits->vec<int64_t>();
+  int64_t row = 0;
+  splits(0) = 0;
+  flat_inputs->reserve(flat_inputs->size() + inputs.size());
+  for (const Tensor& input : inputs) {
+    const int64_t row_length = input.dim_size(1);
+    for (int64_t i = 0; i < input.dim_size(0); ++i, ++row) {
+      splits(row + 1) = splits(row) + row_length;
+    }
+    TensorShape flat_shape(input.shape());
+    flat_shape.RemoveDim(1);
+    flat_shape.set_dim(0, input.dim_size(0) * row_length);
+    Tensor flat_input;
+    if (!flat_input.CopyFrom(input, flat_shape)) {
+      return errors::Internal("Cannot reshape ", input.shape().DebugString(),
+                              " to ", flat_shape.DebugString());
+    }
+    flat_inputs->push_back(std::move(flat_input));
+  }
+  for (; row < num_rows; ++row) {
+    splits(row + 1) = splits(row);
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace concat_split_util
 }  // namespace tensorflow
 
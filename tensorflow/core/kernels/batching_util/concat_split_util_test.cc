@@ -0,0 +1,116 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/concat_split_util.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace concat_split_util {
+namespace {
+
+// Returns a [num_rows, row_size] tensor of 0, 1, 2, ...
+Tensor Iota(int64_t num_rows, int64_t row_size) {
+  Tensor t(DT_FLOAT, TensorShape({num_rows, row_size}));
+  auto flat = t.flat<float>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = i;
+  }
+  return t;
+}
+
+TEST(SplitAliasingTest, AlignedSlicesAlias) {
+  // Rows of 64 floats keep every slice aligned.
+  const Tensor input = Iota(5, 64);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(SplitAliasing(input, {2, 3}, &outputs));
+  ASSERT_EQ(outputs.size(), 2);
+  EXPECT_TRUE(outputs[0].SharesBufferWith(input));
+  EXPECT_TRUE(outputs[1].SharesBufferWith(input));
+  test::ExpectTensorEqual<float>(outputs[0], input.Slice(0, 2));
+  test::ExpectTensorEqual<float>(outputs[1], input.Slice(2, 5));
+}
+
+TEST(SplitAliasingTest, UnalignedSlicesAreCopied) {
+  const Tensor input = Iota(5, 3);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(SplitAliasing(input, {1, 4}, &outputs));
+  ASSERT_EQ(outputs.size(), 2);
+  // The first slice starts at the start of the buffer.
+  EXPECT_TRUE(outputs[0].SharesBufferWith(input));
+  EXPECT_FALSE(outputs[1].SharesBufferWith(input));
+  EXPECT_TRUE(outputs[1].IsAligned());
+  test::ExpectTensorEqual<float>(outputs[1],
+                                 tensor::DeepCopy(input.Slice(1, 5)));
+}
+
+TEST(SplitAliasingTest, WrongSizes) {
+  std::vector<Tensor> outputs;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      SplitAliasing(Iota(5, 3), {1, 1}, &outputs)));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      SplitAliasing(Tensor(1.0f), {1}, &outputs)));
+}
+
+TEST(FlattenRaggedRowsTest, RowLengthsDiffer) {
+  const Tensor a = test::AsTensor<float>({1, 2, 3, 4}, TensorShape({2, 2}));
+  const Tensor b = test::AsTensor<float>({5, 6, 7}, TensorShape({1, 3}));
+  std::vector<Tensor> flat_inputs;
+  Tensor row_splits;
+  TF_ASSERT_OK(FlattenRaggedRows({a, b}, /*num_empty_rows=*/2, &flat_inputs,
+                                 &row_splits));
+  ASSERT_EQ(flat_inputs.size(), 2);
+  EXPECT_TRUE(flat_inputs[0].SharesBufferWith(a));
+  test::ExpectTensorEqual<float>(flat_inputs[0],
+                                 test::AsTensor<float>({1, 2, 3, 4}));
+  test::ExpectTensorEqual<float>(flat_inputs[1],
+                                 test::AsTensor<float>({5, 6, 7}));
+  test::ExpectTensorEqual<int64_t>(
+      row_splits, test::AsTensor<int64_t>({0, 2, 4, 7, 7, 7}));
+}
+
+TEST(FlattenRaggedRowsTest, KeepsInnerDimensions) {
+  const Tensor input(DT_FLOAT, TensorShape({2, 3, 4}));
+  std::vector<Tensor> flat_inputs;
+  Tensor row_splits;
+  TF_ASSERT_OK(FlattenRaggedRows({input}, /*num_empty_rows=*/0, &flat_inputs,
+                                 &row_splits));
+  EXPECT_EQ(flat_inputs[0].shape(), TensorShape({6, 4}));
+  test::ExpectTensorEqual<int64_t>(row_splits,
+                                   test::AsTensor<int64_t>({0, 3, 6}));
+}
+
+TEST(FlattenRaggedRowsTest, InvalidShapes) {
+  std::vector<Tensor> flat_inputs;
+  Tensor row_splits;
+  EXPECT_TRUE(errors::IsInvalidArgument(FlattenRaggedRows(
+      {test::AsTensor<float>({1, 2})}, 0, &flat_inputs, &row_splits)));
+  EXPECT_TRUE(errors::IsInvalidArgument(FlattenRaggedRows(
+      {Tensor(DT_FLOAT, TensorShape({1, 2, 3})),
+       Tensor(DT_FLOAT, TensorShape({1, 2, 4}))},
+      0, &flat_inputs, &row_splits)));
+}
+
+}  // namespace
+}  // namespace concat_split_util
+}  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -32,6 +34,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/kernels/batching_util/batch_input_task.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
@@ -282,6 +285,19 @@ class SharedBatchScheduler
     // effective only when enable_priority_queue is true.
     MixedPriorityBatchingPolicy mixed_priority_batching_policy =
         MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
+
+    // If positive, the latency objective of the tasks in this queue, in
+    // microseconds. A batch is due `latency_slo_micros` after its first task
+    // was enqueued.
+    //
+    // Batch threads serve the queue whose next batch has the least slack,
+    // i.e. its deadline minus now minus its mean cost in `model_batch_stats`,
+    // before falling back to round-robin. Batches that would miss their
+    // deadline anyway are left to round-robin, so that they don't delay the
+    // batches that can still make theirs. High priority tasks whose estimated
+    // latency already exceeds the objective are rejected with an UNAVAILABLE
+    // error. The cost estimates are only available with `model_batch_stats`.
+    int64_t latency_slo_micros = 0;
   };
   // This method is marked virtual for testing purposes only.
   virtual Status AddQueue(const QueueOptions& options,
@@ -313,6 +329,9 @@ class SharedBatchScheduler
 
   mutex mu_;
 
+  // Whether a queue with a `latency_slo_micros` was ever added.
+  bool has_latency_slo_queues_ TF_GUARDED_BY(mu_) = false;
+
   // A list of queues. (We use std::list instead of std::vector to ensure that
   // iterators are not invalidated by adding/removing elements. It also offers
   // efficient removal of elements from the middle.)
@@ -415,6 +434,12 @@ class Queue {
   // size that's provided by caller of batch scheduler.
   size_t max_execution_batch_size() const { return max_execution_batch_size_; }
 
+  // Returns the time left before the deadline of the batch that
+  // ScheduleBatch() would return, minus its estimated cost, in microseconds.
+  // Returns std::nullopt if the queue has no `latency_slo_micros` or no
+  // schedulable high priority batch.
+  std::optional<int64_t> SchedulableBatchSlackMicros() const;
+
   // Called by a thread that is ready to process a batch, to request one from
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
@@ -522,6 +547,18 @@ class Queue {
   // Returns the number of enqueued batches.
   int64 num_enqueued_batches() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the size of the `i`-th enqueued batch, the front-most being 0.
+  size_t enqueued_batch_size(int64_t i) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the mean cost of processing a batch of `batch_size` tasks in
+  // `options_.model_batch_stats`, in microseconds, or 0 if it is unknown.
+  int64_t EstimatedBatchCostMicros(size_t batch_size) const;
+
+  // Returns an error if `task` is estimated to miss the queue's
+  // `latency_slo_micros` behind the batches enqueued ahead of it.
+  Status ValidateLatencySlo(const TaskType& task) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Gets the appropriate batches.
   std::deque<std::unique_ptr<Batch<TaskType>>>& GetBatches()
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -606,7 +643,11 @@ class Queue {
   //
   // Note that when using a batch padding policy other than PAD_UP, this field
   // might contain an approximate value (see ScheduleBatchWithEagerSplit).
-  uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
+  uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  // The values of `open_batch_start_time_micros_` for the closed batches, in
+  // the order of the batches.
+  std::deque<uint64> closed_batch_start_times_micros_ TF_GUARDED_BY(mu_);
 
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
@@ -750,6 +791,12 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.max_execution_batch_size);
   }
 
+  if (options.latency_slo_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_slo_micros must be non-negative; was ",
+        options.latency_slo_micros);
+  }
+
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
     schedulable_batch_cv_.notify_one();
@@ -763,6 +810,7 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
                                           internal_queue.get()));
   {
     mutex_lock l(mu_);
+    if (options.latency_slo_micros > 0) has_latency_slo_queues_ = true;
     queues_.push_back(std::move(internal_queue));
     if (next_queue_to_schedule_ == queues_.end()) {
       next_queue_to_schedule_ = queues_.begin();
@@ -802,6 +850,25 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     BatchUniquePtr* batch_to_process_out) {
   BatchUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
+  if (has_latency_slo_queues_) {
+    // Serve the batch closest to missing its deadline first, among those that
+    // can still meet it.
+    internal::Queue<TaskType>* most_urgent_queue = nullptr;
+    int64_t min_slack_micros = 0;
+    for (const auto& queue : queues_) {
+      const std::optional<int64_t> slack_micros =
+          queue->SchedulableBatchSlackMicros();
+      if (!slack_micros.has_value() || *slack_micros < 0) continue;
+      if (most_urgent_queue == nullptr || *slack_micros < min_slack_micros) {
+        most_urgent_queue = queue.get();
+        min_slack_micros = *slack_micros;
+      }
+    }
+    if (most_urgent_queue != nullptr) {
+      batch_to_process = most_urgent_queue->ScheduleBatch();
+      if (BatchExists(batch_to_process)) queue_for_batch = most_urgent_queue;
+    }
+  }
   const int num_queues = queues_.size();
   for (int num_queues_tried = 0;
        !BatchExists(batch_to_process) && num_queues_tried < num_queues;
@@ -953,6 +1020,7 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
     DCHECK(!closed_);
 
     TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    TF_RETURN_IF_ERROR(ValidateLatencySlo(**task));
 
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
@@ -1027,6 +1095,7 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
   // Add test coverage when when concurrent incoming batches arrives and
   // use up all queue capacity.
   TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+  TF_RETURN_IF_ERROR(ValidateLatencySlo(**task));
 
   std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
 
@@ -1278,6 +1347,7 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
       // There is at least one closed batch that is ready to be scheduled.
       batch_to_schedule = std::move(batches.front());
       batches.pop_front();
+      closed_batch_start_times_micros_.pop_front();
     }
 
     if (batch_to_schedule == nullptr) {
@@ -1323,6 +1393,7 @@ Queue<TaskType>::ScheduleBatch() {
       ++num_batches_being_processed_;
       task_handles_to_schedule = std::move(task_handle_batches_.front());
       task_handle_batches_.pop_front();
+      closed_batch_start_times_micros_.pop_front();
     } else {
       schedulable_batch_ = false;
     }
@@ -1437,6 +1508,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
 
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
+  closed_batch_start_times_micros_.push_back(open_batch_start_time_micros_);
   if (options_.enable_lazy_split) {
     task_handle_batches_.back()->Close();
     task_handle_batches_.emplace_back(new Batch<BatchInputTaskHandle<TaskType>>(
@@ -1534,6 +1606,85 @@ int64 Queue<TaskType>::num_enqueued_batches() const {
   return GetBatches().size();
 }
 
+template <typename TaskType>
+size_t Queue<TaskType>::enqueued_batch_size(int64_t i) const {
+  if (options_.enable_lazy_split) {
+    return task_handle_batches_[i]->size();
+  }
+  return GetBatches()[i]->size();
+}
+
+template <typename TaskType>
+int64_t Queue<TaskType>::EstimatedBatchCostMicros(size_t batch_size) const {
+  if (options_.model_batch_stats == nullptr) {
+    return 0;
+  }
+  const int padded_batch_size = GetNextAllowedBatchSize(
+      batch_size, options_.allowed_batch_sizes, options_.disable_padding);
+  std::optional<absl::Duration> cost =
+      options_.model_batch_stats->batch_size(padded_batch_size)
+          .tpu_cost()
+          .mean();
+  return cost.has_value() ? absl::ToInt64Microseconds(*cost) : 0;
+}
+
+template <typename TaskType>
+Status Queue<TaskType>::ValidateLatencySlo(const TaskType& task) const {
+  if (options_.latency_slo_micros <= 0 ||
+      options_.model_batch_stats == nullptr) {
+    return absl::OkStatus();
+  }
+  // The batches ahead of `task`, including the open batch when `task` doesn't
+  // fit in it.
+  int64 num_batches_ahead = num_enqueued_batches() - 1;
+  size_t batch_size = tail_batch_task_size() + task.size();
+  if (batch_size > max_execution_batch_size()) {
+    ++num_batches_ahead;
+    batch_size = task.size();
+  }
+  int64_t wait_micros = 0;
+  for (int64 i = 0; i < num_batches_ahead; ++i) {
+    wait_micros += EstimatedBatchCostMicros(enqueued_batch_size(i));
+  }
+  const int64_t num_batch_threads =
+      options_.model_batch_stats->num_batch_threads();
+  if (num_batch_threads > 1) {
+    wait_micros /= num_batch_threads;
+  }
+  const int64_t latency_micros =
+      wait_micros + EstimatedBatchCostMicros(
+                        std::min(batch_size, max_execution_batch_size()));
+  if (latency_micros > options_.latency_slo_micros) {
+    return errors::Unavailable(
+        "The task would miss the latency objective of the batch scheduling "
+        "queue to which it was submitted; estimated latency is ",
+        latency_micros, "us but latency_slo_micros is ",
+        options_.latency_slo_micros, " (num_batches_ahead=", num_batches_ahead,
+        ")");
+  }
+  return absl::OkStatus();
+}
+
+template <typename TaskType>
+std::optional<int64_t> Queue<TaskType>::SchedulableBatchSlackMicros() const {
+  if (options_.latency_slo_micros <= 0) {
+    return std::nullopt;
+  }
+  mutex_lock l(mu_);
+  uint64 start_time_micros;
+  if (num_enqueued_batches() > 1) {
+    start_time_micros = closed_batch_start_times_micros_.front();
+  } else if (IsOpenBatchSchedulable()) {
+    start_time_micros = open_batch_start_time_micros_;
+  } else {
+    return std::nullopt;
+  }
+  return static_cast<int64_t>(start_time_micros) +
+         options_.latency_slo_micros -
+         static_cast<int64_t>(env_->NowMicros()) -
+         EstimatedBatchCostMicros(enqueued_batch_size(0));
+}
+
 template <typename TaskType>
 std::deque<std::unique_ptr<Batch<TaskType>>>& Queue<TaskType>::GetBatches() {
   return high_priority_batches_;
@@ -30,6 +30,7 @@ limitations under the License.
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -807,6 +809,104 @@ TEST_P(SharedBatchSchedulerTest, Fairness) {
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, LatencySloServesMostUrgentQueueFirst) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<int> processed_queues;
+    Notification first_batch_scheduled, first_batch_proceed, all_processed;
+    auto callback = [&](int queue_index) {
+      return [&, queue_index](std::unique_ptr<Batch<FakeTask>> batch) {
+        if (!first_batch_scheduled.HasBeenNotified()) {
+          first_batch_scheduled.Notify();
+          first_batch_proceed.WaitForNotification();
+        }
+        mutex_lock l(mu);
+        processed_queues.push_back(queue_index);
+        if (processed_queues.size() == 3) all_processed.Notify();
+      };
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/100);
+    std::vector<std::unique_ptr<BatchScheduler<FakeTask>>> queues(2);
+    queue_options.latency_slo_micros = 1000;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback(0), &queues[0]));
+    queue_options.latency_slo_micros = 100;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback(1), &queues[1]));
+
+    // Keep the batch thread busy with a batch of queue 1, so that round-robin
+    // would serve queue 0 next.
+    TF_ASSERT_OK(ScheduleTask(10, queues[1].get()));
+    first_batch_scheduled.WaitForNotification();
+    TF_ASSERT_OK(ScheduleTask(10, queues[0].get()));
+    TF_ASSERT_OK(ScheduleTask(10, queues[1].get()));
+    first_batch_proceed.Notify();
+
+    all_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(processed_queues, (std::vector<int>{1, 1, 0}));
+    }
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, LatencySloRejectsTasksThatWouldMissIt) {
+  Notification processing, proceed;
+  auto callback = [&processing,
+                   &proceed](std::unique_ptr<Batch<FakeTask>> batch) {
+    if (!processing.HasBeenNotified()) {
+      processing.Notify();
+      proceed.WaitForNotification();
+    }
+  };
+
+  ModelBatchStats model_batch_stats;
+  model_batch_stats.batch_size(10).tpu_cost().Register(absl::Microseconds(600));
+
+  auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/100);
+  queue_options.latency_slo_micros = 1000;
+  queue_options.model_batch_stats = &model_batch_stats;
+  auto queue = CreateQueue(scheduler, queue_options, callback);
+
+  TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+  processing.WaitForNotification();
+
+  // Nothing is waiting ahead of this task.
+  TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+  // This one would wait for the full batch ahead of it, for 1200us in total.
+  EXPECT_THAT(ScheduleTask(10, queue.get()),
+              testing::StatusIs(error::UNAVAILABLE,
+                                HasSubstr("would miss the latency objective")));
+  EXPECT_EQ(queue->NumEnqueuedTasks(), 1);
+
+  proceed.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidLatencySlo) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/100);
+  queue_options.latency_slo_micros = -1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_THAT(scheduler->AddQueue(queue_options, callback, &queue),
+              testing::StatusIs(error::INVALID_ARGUMENT,
+                                HasSubstr("latency_slo_micros")));
+}
+
 TEST_P(SharedBatchSchedulerTest, ConstMethods) {
   for (const int max_enqueued_batches : {1, 2, 5}) {
     Notification processing, proceed;
@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/cast_op.h"
 
+#include <memory>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -105,6 +107,21 @@ void CastOpBase::Compute(OpKernelContext* ctx) {
     out->set_dtype(dst_dtype_);
     work_(ctx, in, out, use_truncation_);
     out->set_dtype(external_dst_dtype_);
+  } else if (CanCastInPlace()) {
+    // The cast is elementwise and both types have the same width, so an input
+    // that is not referenced elsewhere can be overwritten with the result.
+    std::unique_ptr<Tensor> forwarded = ctx->forward_input(
+        0, 0, inp.dtype(), inp.shape(), ctx->output_memory_type(0),
+        ctx->output_alloc_attr(0));
+    if (forwarded == nullptr) {
+      Tensor* out = nullptr;
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(0, inp.shape(), &out));
+      work_(ctx, inp, out, use_truncation_);
+      return;
+    }
+    forwarded->set_dtype(dst_dtype_);
+    work_(ctx, inp, forwarded.get(), use_truncation_);
+    ctx->set_output(0, *forwarded);
   } else {
     Tensor* out = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output(0, inp.shape(), &out));
@@ -112,6 +129,17 @@ void CastOpBase::Compute(OpKernelContext* ctx) {
   }
 }
 
+bool CastOpBase::CanCastInPlace() const {
+  // Sub-byte types are packed, so their elements do not map one to one onto
+  // elements of the other type.
+  if (src_dtype_ == DT_INT4 || src_dtype_ == DT_UINT4 ||
+      dst_dtype_ == DT_INT4 || dst_dtype_ == DT_UINT4) {
+    return false;
+  }
+  const int src_size = DataTypeSize(src_dtype_);
+  return src_size > 0 && src_size == DataTypeSize(dst_dtype_);
+}
+
 Status CastOpBase::Unimplemented() {
   return errors::Unimplemented("Cast ", DataTypeString(external_src_dtype_),
                                " to ", DataTypeString(external_dst_dtype_),
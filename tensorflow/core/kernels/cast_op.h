@@ -143,6 +143,8 @@ class CastOpBase : public OpKernel {
   bool use_truncation_;
   CastFunctorType work_ = nullptr;
   Status Unimplemented();
+  // Returns true if the input may be overwritten with the cast result.
+  bool CanCastInPlace() const;
 
   CastOpBase(const CastOpBase&) = delete;
   void operator=(const CastOpBase&) = delete;
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -156,6 +157,47 @@ TEST_CAST(uint4, uint4)
 #undef TEST_INT_CASTS_TO
 #undef TEST_CAST
 
+TEST_F(CastOpTest, CastsInPlaceWhenInputIsNotShared) {
+  MakeOp(DT_FLOAT, DT_INT32, false);
+  AddInputFromArray<float>(TensorShape({4}), {1.5f, -2.f, 3.f, 4.f});
+  const char* input_data = mutable_input(0).tensor->tensor_data().data();
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->tensor_data().data(), input_data);
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({1, -2, 3, 4}),
+                                 *GetOutput(0));
+}
+
+TEST_F(CastOpTest, DoesNotCastInPlaceWhenInputIsShared) {
+  MakeOp(DT_FLOAT, DT_INT32, false);
+  AddInputFromArray<float>(TensorShape({4}), {1.5f, -2.f, 3.f, 4.f});
+  const Tensor shared = *mutable_input(0).tensor;
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_NE(GetOutput(0)->tensor_data().data(), shared.tensor_data().data());
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({1, -2, 3, 4}),
+                                 *GetOutput(0));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1.5f, -2.f, 3.f, 4.f}),
+                                 shared);
+}
+
+TEST_F(CastOpTest, DoesNotCastInPlaceToAnotherWidth) {
+  MakeOp(DT_INT32, DT_INT64, false);
+  AddInputFromArray<int32>(TensorShape({4}), {1, -2, 3, 4});
+  const char* input_data = mutable_input(0).tensor->tensor_data().data();
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_NE(GetOutput(0)->tensor_data().data(), input_data);
+  test::ExpectTensorEqual<int64_t>(test::AsTensor<int64_t>({1, -2, 3, 4}),
+                                   *GetOutput(0));
+}
+
+TEST_F(CastOpTest, DoesNotCastPackedTypesInPlace) {
+  MakeOp(DT_INT4, DT_UINT4, false);
+  AddInputFromArray<int4>(TensorShape({4}),
+                          {int4(1), int4(2), int4(3), int4(4)});
+  const char* input_data = mutable_input(0).tensor->tensor_data().data();
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_NE(GetOutput(0)->tensor_data().data(), input_data);
+}
+
 // TODO(wicke): check conversions from/to bool, and bfloat16
 
 static void BM_cpu_float_int64(::testing::benchmark::State& state) {
@@ -68,6 +68,7 @@ class DnnScratchAllocator : public se::ScratchAllocator {
     }
     AllocationAttributes allocation_attr;
     allocation_attr.retry_on_failure = false;
+    allocation_attr.short_lived = true;
     Status allocation_status(context_->allocate_temp(
         DT_UINT8, TensorShape({byte_size}), &temporary_memory,
         AllocatorAttributes(), allocation_attr));
@@ -18,12 +18,14 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "tensorflow/core/data/global_shuffle_utils.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -68,6 +70,7 @@ constexpr char kMemoryDatasetPrefix[] = "Memory";
 constexpr char kMemoryCache[] = "MemoryCache";
 constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
+constexpr char kInputIndex[] = "input_index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
 constexpr char kIncompleteCacheErrorMessage[] =
@@ -76,6 +79,31 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+
+// Returns the key under which the elements of `input` are cached in the
+// process-wide `SharedMemoryCache`, or `std::nullopt` if the cache is disabled
+// or `input` cannot be fingerprinted, e.g. because it depends on external
+// state.
+std::optional<uint64_t> SharedMemoryCacheKey(OpKernelContext* ctx,
+                                             const DatasetBase* input) {
+  if (SharedMemoryCache::Global()->capacity_in_bytes() <= 0) {
+    return std::nullopt;
+  }
+  SerializationContext::Params params(ctx);
+  params.external_state_policy = ExternalStatePolicy::POLICY_FAIL;
+  GraphDef graph_def;
+  Status s = AsGraphDef(input, SerializationContext(params), &graph_def);
+  uint64_t hash = 0;
+  if (s.ok()) {
+    s = HashGraph(graph_def, &hash);
+  }
+  if (!s.ok()) {
+    VLOG(1) << "Not sharing the memory cache of " << input->DebugString()
+            << ": " << s;
+    return std::nullopt;
+  }
+  return hash;
+}
 }  // namespace
 
 class DatasetRandomAccessCache {
@@ -763,7 +791,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              std::shared_ptr<MemoryCache> cache)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
-        cache_(std::move(cache)) {
+        cache_(std::move(cache)),
+        shared_cache_key_(SharedMemoryCacheKey(ctx, input)) {
     input_->Ref();
     random_indexing_compatible_ = input_->RandomIndexingCompatible();
   }
@@ -1050,9 +1079,105 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       size_t index_ TF_GUARDED_BY(mu_);
     };  // MemoryReaderIterator
 
+    // Serves elements from the process-wide `SharedMemoryCache`, which other
+    // iterators of the same input pipeline may have populated. On a miss, the
+    // input iterator is advanced to the missing element, which is then cached.
+    class SharedMemoryIterator : public DatasetIterator<MemoryDatasetBase> {
+     public:
+      explicit SharedMemoryIterator(const Params& params)
+          : DatasetIterator<MemoryDatasetBase>(params),
+            cache_(SharedMemoryCache::Global()),
+            key_(*params.dataset->shared_cache_key_) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                               &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        if (cache_->Lookup(key_, index_, out_tensors)) {
+          ++index_;
+          *end_of_sequence = false;
+          return absl::OkStatus();
+        }
+        const int64_t num_elements = cache_->NumElements(key_);
+        if (num_elements != kUnknownCardinality && index_ >= num_elements) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        // Elements before `index_` were served from the cache, so catch the
+        // input up with this iterator before producing the missing element.
+        if (input_index_ < index_) {
+          int num_skipped = 0;
+          TF_RETURN_IF_ERROR(input_impl_->Skip(
+              ctx, static_cast<int>(index_ - input_index_), end_of_sequence,
+              &num_skipped));
+          input_index_ += num_skipped;
+          if (*end_of_sequence) {
+            cache_->SetNumElements(key_, input_index_);
+            return absl::OkStatus();
+          }
+        }
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          cache_->SetNumElements(key_, input_index_);
+          return absl::OkStatus();
+        }
+        ++input_index_;
+        if (cache_->Insert(key_, index_, *out_tensors)) {
+          RecordBufferEnqueue(ctx, *out_tensors);
+        }
+        ++index_;
+        return absl::OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kIndex, index_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kInputIndex, input_index_));
+        return SaveInput(ctx, writer, input_impl_);
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kIndex, &index_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kInputIndex, &input_index_));
+        return RestoreInput(ctx, reader, input_impl_);
+      }
+
+     private:
+      mutex mu_;
+      SharedMemoryCache* const cache_;  // not owned.
+      const uint64_t key_;
+      std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+      // The index of the next element to produce.
+      int64_t index_ TF_GUARDED_BY(mu_) = 0;
+      // The number of elements consumed from `input_impl_`.
+      int64_t input_index_ TF_GUARDED_BY(mu_) = 0;
+    };  // SharedMemoryIterator
+
     Status InitializeIterator(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-      if (cache_->IsCompleted()) {
+      if (dataset()->shared_cache_key_.has_value()) {
+        iterator_ = std::make_unique<SharedMemoryIterator>(
+            SharedMemoryIterator::Params{dataset(),
+                                         strings::StrCat(prefix(), kImpl)});
+      } else if (cache_->IsCompleted()) {
         iterator_ = std::make_unique<MemoryReaderIterator>(
             MemoryReaderIterator::Params{dataset(),
                                          strings::StrCat(prefix(), kImpl)},
@@ -1076,6 +1201,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
   mutable mutex mu_;
   const DatasetBase* const input_;
   const std::shared_ptr<MemoryCache> cache_;
+  // If set, iterators share elements through `SharedMemoryCache::Global()`
+  // under this key instead of using `cache_`.
+  const std::optional<uint64_t> shared_cache_key_;
   mutable std::unique_ptr<DatasetRandomAccessCache> dataset_random_access_cache_
       TF_GUARDED_BY(mu_);
   mutable std::unique_ptr<IteratorRandomAccessCache>
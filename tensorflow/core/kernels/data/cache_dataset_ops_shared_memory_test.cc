@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/kernels/data/cache_dataset_ops.h"
+#include "tensorflow/core/kernels/data/cache_ops.h"
+
+// Tests in-memory caches shared through `SharedMemoryCache::Global()`. The
+// test target sets `TF_DATA_SHARED_MEMORY_CACHE_BYTES` to 72 bytes, which
+// holds three of the 24-byte elements used below.
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kNodeName[] = "cache_dataset";
+constexpr int64_t kCapacityInBytes = 72;
+
+class CacheDatasetParams : public DatasetParams {
+ public:
+  explicit CacheDatasetParams(TensorSliceDatasetParams input_dataset_params)
+      : DatasetParams({DT_INT64}, {PartialTensorShape({3, 1})}, kNodeName) {
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+    input_dataset_params_.push_back(std::make_unique<TensorSliceDatasetParams>(
+        std::move(input_dataset_params)));
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<tstring>(TensorShape({}), {""})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {CacheDatasetOp::kInputDataset, CacheDatasetOp::kFileName};
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  string dataset_type() const override { return CacheDatasetOp::kDatasetType; }
+};
+
+// Returns a dataset of `num_elements` elements of shape [3, 1], starting at
+// `first_value`. Tests use different values so that they don't share entries.
+CacheDatasetParams MakeDatasetParams(int num_elements, int64_t first_value) {
+  std::vector<int64_t> values(num_elements * 3);
+  for (int i = 0; i < values.size(); ++i) {
+    values[i] = first_value + i;
+  }
+  return CacheDatasetParams(TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{num_elements, 3, 1},
+                                            values)},
+      /*node_name=*/"tensor_slice"));
+}
+
+class CacheDatasetOpSharedMemoryTest : public DatasetOpsTestBase {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(SharedMemoryCache::Global()->capacity_in_bytes(),
+              kCapacityInBytes);
+  }
+
+  std::unique_ptr<IteratorBase> MakeIterator(
+      const CacheDatasetParams& dataset_params) {
+    std::unique_ptr<IteratorBase> iterator;
+    TF_CHECK_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                       dataset_params.iterator_prefix(),
+                                       &iterator));
+    return iterator;
+  }
+
+  // Reads up to `num_elements` elements from `iterator` and appends them to
+  // `elements`. Returns true at the end of the sequence.
+  bool Read(IteratorBase* iterator, int num_elements,
+            std::vector<Tensor>* elements) {
+    bool end_of_sequence = false;
+    for (int i = 0; i < num_elements && !end_of_sequence; ++i) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      elements->insert(elements->end(), next.begin(), next.end());
+    }
+    return end_of_sequence;
+  }
+};
+
+TEST_F(CacheDatasetOpSharedMemoryTest, LaterIteratorsReadCachedElements) {
+  const CacheDatasetParams dataset_params =
+      MakeDatasetParams(/*num_elements=*/3, /*first_value=*/100);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> first;
+  EXPECT_TRUE(Read(iterator_.get(), /*num_elements=*/4, &first));
+  EXPECT_EQ(SharedMemoryCache::Global()->num_entries(), 3);
+
+  std::unique_ptr<IteratorBase> second_iterator = MakeIterator(dataset_params);
+  std::vector<Tensor> second;
+  EXPECT_TRUE(Read(second_iterator.get(), /*num_elements=*/4, &second));
+  ASSERT_EQ(second.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    // The cached tensors themselves are served, not recomputed ones.
+    EXPECT_EQ(second[i].tensor_data().data(), first[i].tensor_data().data());
+  }
+  EXPECT_EQ(SharedMemoryCache::Global()->num_entries(), 3);
+}
+
+TEST_F(CacheDatasetOpSharedMemoryTest, PartiallyCachedElementsAreShared) {
+  const CacheDatasetParams dataset_params =
+      MakeDatasetParams(/*num_elements=*/3, /*first_value=*/200);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> first;
+  EXPECT_FALSE(Read(iterator_.get(), /*num_elements=*/1, &first));
+
+  // The second iterator reads element 0 from the cache before any iterator
+  // completed an epoch, then skips it in its input to produce the others.
+  std::unique_ptr<IteratorBase> second_iterator = MakeIterator(dataset_params);
+  std::vector<Tensor> second;
+  EXPECT_TRUE(Read(second_iterator.get(), /*num_elements=*/4, &second));
+  TF_EXPECT_OK(ExpectEqual(second,
+                           CreateTensors<int64_t>(
+                               TensorShape({3, 1}), {{200, 201, 202},
+                                                     {203, 204, 205},
+                                                     {206, 207, 208}}),
+                           /*compare_order=*/true));
+  EXPECT_EQ(second[0].tensor_data().data(), first[0].tensor_data().data());
+
+  // The first iterator reads the elements the second one cached.
+  EXPECT_TRUE(Read(iterator_.get(), /*num_elements=*/3, &first));
+  ASSERT_EQ(first.size(), 3);
+  for (int i = 1; i < 3; ++i) {
+    EXPECT_EQ(first[i].tensor_data().data(), second[i].tensor_data().data());
+  }
+}
+
+TEST_F(CacheDatasetOpSharedMemoryTest, EvictedElementsAreRecomputed) {
+  const CacheDatasetParams dataset_params =
+      MakeDatasetParams(/*num_elements=*/4, /*first_value=*/300);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> first;
+  EXPECT_TRUE(Read(iterator_.get(), /*num_elements=*/5, &first));
+  // Element 0 was evicted to cache element 3.
+  EXPECT_EQ(SharedMemoryCache::Global()->num_entries(), 3);
+  EXPECT_EQ(SharedMemoryCache::Global()->size_in_bytes(), kCapacityInBytes);
+
+  std::unique_ptr<IteratorBase> second_iterator = MakeIterator(dataset_params);
+  std::vector<Tensor> second;
+  EXPECT_TRUE(Read(second_iterator.get(), /*num_elements=*/5, &second));
+  TF_EXPECT_OK(ExpectEqual(second, first, /*compare_order=*/true));
+  EXPECT_NE(second[0].tensor_data().data(), first[0].tensor_data().data());
+  EXPECT_LE(SharedMemoryCache::Global()->size_in_bytes(), kCapacityInBytes);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
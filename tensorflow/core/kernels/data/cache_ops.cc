@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -22,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -68,6 +72,72 @@ const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   return cache_;
 }
 
+/* static */
+SharedMemoryCache* SharedMemoryCache::Global() {
+  static SharedMemoryCache* cache = [] {
+    int64_t capacity_in_bytes;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_DATA_SHARED_MEMORY_CACHE_BYTES",
+                                    /*default_val=*/0, &capacity_in_bytes));
+    return new SharedMemoryCache(capacity_in_bytes);
+  }();
+  return cache;
+}
+
+bool SharedMemoryCache::Lookup(uint64_t key, int64_t index,
+                               std::vector<Tensor>* element) {
+  mutex_lock l(mu_);
+  auto it = index_.find(EntryKey(key, index));
+  if (it == index_.end()) {
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *element = it->second->element;
+  return true;
+}
+
+bool SharedMemoryCache::Insert(uint64_t key, int64_t index,
+                               const std::vector<Tensor>& element) {
+  const int64_t bytes = GetTotalBytes(element);
+  if (bytes > capacity_in_bytes_) {
+    return false;
+  }
+  mutex_lock l(mu_);
+  const EntryKey entry_key(key, index);
+  if (index_.contains(entry_key)) {
+    return false;
+  }
+  while (size_in_bytes_ + bytes > capacity_in_bytes_) {
+    size_in_bytes_ -= entries_.back().bytes;
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+  entries_.push_front(Entry{entry_key, element, bytes});
+  index_[entry_key] = entries_.begin();
+  size_in_bytes_ += bytes;
+  return true;
+}
+
+void SharedMemoryCache::SetNumElements(uint64_t key, int64_t num_elements) {
+  mutex_lock l(mu_);
+  num_elements_[key] = num_elements;
+}
+
+int64_t SharedMemoryCache::NumElements(uint64_t key) {
+  mutex_lock l(mu_);
+  auto it = num_elements_.find(key);
+  return it == num_elements_.end() ? kUnknownCardinality : it->second;
+}
+
+int64_t SharedMemoryCache::size_in_bytes() {
+  mutex_lock l(mu_);
+  return size_in_bytes_;
+}
+
+int64_t SharedMemoryCache::num_entries() {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
     OpKernelConstruction* ctx)
     : AnonymousResourceOp<MemoryCacheManager>(ctx,
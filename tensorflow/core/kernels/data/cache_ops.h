@@ -16,6 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <cstdint>
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 
@@ -57,6 +63,71 @@ class MemoryCache {
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
 };
 
+// A thread-safe, size-bounded cache of dataset elements that is shared by all
+// iterators of the same input pipeline in a process, including those of
+// different trainer replicas.
+//
+// Elements are keyed by a fingerprint of the input dataset graph and their
+// index in the dataset. Unlike `MemoryCache`, elements can be read as soon as
+// any iterator has produced them, without waiting for a full pass over the
+// dataset. Once `capacity_in_bytes` is reached, the least recently used
+// elements are evicted first; iterators recompute evicted elements from their
+// input.
+class SharedMemoryCache {
+ public:
+  explicit SharedMemoryCache(int64_t capacity_in_bytes)
+      : capacity_in_bytes_(capacity_in_bytes) {}
+
+  SharedMemoryCache(const SharedMemoryCache&) = delete;
+  void operator=(const SharedMemoryCache&) = delete;
+
+  // Returns the process-wide cache. Its capacity is read from the
+  // `TF_DATA_SHARED_MEMORY_CACHE_BYTES` environment variable and defaults to 0,
+  // which disables sharing.
+  static SharedMemoryCache* Global();
+
+  int64_t capacity_in_bytes() const { return capacity_in_bytes_; }
+
+  // Looks up the element at `index` of the dataset with fingerprint `key`.
+  // Returns true and fills `element` on a hit.
+  bool Lookup(uint64_t key, int64_t index, std::vector<Tensor>* element);
+
+  // Caches `element` as the element at `index` of the dataset with fingerprint
+  // `key`. Returns false if the element was not cached, e.g. because it is
+  // larger than the capacity or is already cached.
+  bool Insert(uint64_t key, int64_t index, const std::vector<Tensor>& element);
+
+  // Records that the dataset with fingerprint `key` has `num_elements`
+  // elements.
+  void SetNumElements(uint64_t key, int64_t num_elements);
+
+  // Returns the number of elements of the dataset with fingerprint `key` if an
+  // iterator has reached its end, and `kUnknownCardinality` otherwise.
+  int64_t NumElements(uint64_t key);
+
+  int64_t size_in_bytes();
+  int64_t num_entries();
+
+ private:
+  using EntryKey = std::pair<uint64_t, int64_t>;
+
+  struct Entry {
+    EntryKey key;
+    std::vector<Tensor> element;
+    int64_t bytes;
+  };
+
+  const int64_t capacity_in_bytes_;
+
+  mutex mu_;
+  // Most recently used entries are at the front.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<EntryKey, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64_t, int64_t> num_elements_ TF_GUARDED_BY(mu_);
+  int64_t size_in_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
 // A resource wrapping a shared instance of a memory cache.
 class MemoryCacheManager : public ResourceBase {
  public:
@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/cache_ops.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(SharedMemoryCacheTest, LookupAfterInsert) {
+  SharedMemoryCache cache(/*capacity_in_bytes=*/1 << 20);
+  std::vector<Tensor> element;
+  EXPECT_FALSE(cache.Lookup(/*key=*/1, /*index=*/0, &element));
+
+  EXPECT_TRUE(cache.Insert(1, 0, {test::AsTensor<int64_t>({1, 2})}));
+  EXPECT_TRUE(cache.Insert(1, 2, {test::AsTensor<int64_t>({3})}));
+  EXPECT_FALSE(cache.Insert(1, 2, {test::AsTensor<int64_t>({4})}));
+  EXPECT_EQ(cache.num_entries(), 2);
+  EXPECT_EQ(cache.size_in_bytes(), 24);
+
+  // Elements can be served before all preceding elements are cached.
+  ASSERT_TRUE(cache.Lookup(1, 2, &element));
+  test::ExpectTensorEqual<int64_t>(element[0], test::AsTensor<int64_t>({3}));
+  EXPECT_FALSE(cache.Lookup(1, 1, &element));
+  EXPECT_FALSE(cache.Lookup(/*key=*/2, 0, &element));
+}
+
+TEST(SharedMemoryCacheTest, EvictsLeastRecentlyUsed) {
+  SharedMemoryCache cache(/*capacity_in_bytes=*/16);
+  EXPECT_TRUE(cache.Insert(1, 0, {test::AsTensor<int64_t>({0})}));
+  EXPECT_TRUE(cache.Insert(1, 1, {test::AsTensor<int64_t>({1})}));
+  std::vector<Tensor> element;
+  // Touch element 0 so that element 1 is the least recently used one.
+  EXPECT_TRUE(cache.Lookup(1, 0, &element));
+  EXPECT_TRUE(cache.Insert(1, 2, {test::AsTensor<int64_t>({2})}));
+
+  EXPECT_EQ(cache.num_entries(), 2);
+  EXPECT_EQ(cache.size_in_bytes(), 16);
+  EXPECT_TRUE(cache.Lookup(1, 0, &element));
+  EXPECT_FALSE(cache.Lookup(1, 1, &element));
+  EXPECT_TRUE(cache.Lookup(1, 2, &element));
+
+  // Elements larger than the capacity are not cached.
+  EXPECT_FALSE(cache.Insert(1, 3, {test::AsTensor<int64_t>({1, 2, 3})}));
+  EXPECT_EQ(cache.num_entries(), 2);
+}
+
+TEST(SharedMemoryCacheTest, NumElements) {
+  SharedMemoryCache cache(/*capacity_in_bytes=*/1 << 20);
+  EXPECT_EQ(cache.NumElements(/*key=*/1), kUnknownCardinality);
+  cache.SetNumElements(1, 10);
+  EXPECT_EQ(cache.NumElements(1), 10);
+  EXPECT_EQ(cache.NumElements(/*key=*/2), kUnknownCardinality);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -15,14 +15,30 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/compression_ops.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/compression_cost_model.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
 namespace data {
 namespace experimental {
+namespace {
+
+int64_t TotalBytes(const std::vector<Tensor>& components) {
+  int64_t total = 0;
+  for (const Tensor& component : components) {
+    total += component.TotalBytes();
+  }
+  return total;
+}
+
+}  // namespace
 
 CompressElementOp::CompressElementOp(OpKernelConstruction* ctx)
     : OpKernel(ctx) {}
@@ -34,7 +50,13 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
     components.push_back(ctx->input(i));
   }
   CompressedElement compressed;
+  const uint64_t start_us = ctx->env()->NowMicros();
   OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  if (CompressionCostModel::Enabled()) {
+    CompressionCostModel::Global()->RecordCompression(
+        TotalBytes(components), compressed.ByteSizeLong(),
+        ctx->env()->NowMicros() - start_us);
+  }
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -68,7 +90,13 @@ void UncompressElementOp::Compute(OpKernelContext* ctx) {
           tensor.DebugString()));
 
   std::vector<Tensor> components;
+  const uint64_t start_us = ctx->env()->NowMicros();
   OP_REQUIRES_OK(ctx, UncompressElement(*compressed, &components));
+  if (CompressionCostModel::Enabled()) {
+    CompressionCostModel::Global()->RecordUncompression(
+        compressed->ByteSizeLong(), TotalBytes(components),
+        ctx->env()->NowMicros() - start_us);
+  }
   OP_REQUIRES(ctx, components.size() == output_types_.size(),
               errors::FailedPrecondition("Expected ", output_types_.size(),
                                          " outputs from uncompress, but got ",
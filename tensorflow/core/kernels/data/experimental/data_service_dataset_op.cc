@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/client/utils.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/compression_cost_model.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -704,6 +705,14 @@ void DataServiceDatasetOp::MakeDataset(OpKernelContext* ctx,
         DisableCompressionAtRuntime(data_transfer_protocol_,
                                     config->deployment_mode());
     OP_REQUIRES_OK(ctx, disable_compression_at_runtime.status());
+    if (CompressionCostModel::Enabled() && !*disable_compression_at_runtime) {
+      // Consult the transfer and uncompression costs observed by previous
+      // datasets in this process. Until enough samples have been recorded,
+      // compression stays enabled.
+      std::optional<bool> should_disable =
+          CompressionCostModel::Global()->ShouldDisableCompression();
+      *disable_compression_at_runtime = should_disable.value_or(false);
+    }
     absl::StatusOr<bool> compression_disabled_at_runtime =
         CompressionDisabledAtRuntime(dataset_id, address, protocol,
                                      *disable_compression_at_runtime);
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/root_dataset.h"
+#include "tensorflow/core/data/tfrecord_index.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,17 +25,25 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/resource.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
 namespace experimental {
 namespace {
 
+// If `TF_TFRECORD_WRITE_INDEX` is true, uncompressed files are written with
+// an index file, so that `TFRecordDataset` can read them in random order (see
+// `TFRecordIndex`).
 class ToTFRecordOp : public AsyncOpKernel {
  public:
   explicit ToTFRecordOp(OpKernelConstruction* ctx)
       : AsyncOpKernel(ctx),
-        background_worker_(ctx->env(), "tf_data_to_tf_record") {}
+        background_worker_(ctx->env(), "tf_data_to_tf_record") {
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_TFRECORD_WRITE_INDEX",
+                                           /*default_val=*/false,
+                                           &write_index_));
+  }
 
   template <typename T>
   Status ParseScalarArgument(OpKernelContext* ctx,
@@ -70,9 +79,16 @@ class ToTFRecordOp : public AsyncOpKernel {
                                                     &compression_type));
     std::unique_ptr<WritableFile> file;
     TF_RETURN_IF_ERROR(ctx->env()->NewWritableFile(filename, &file));
-    auto writer = std::make_unique<io::RecordWriter>(
-        file.get(),
-        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions(compression_type);
+    std::unique_ptr<WritableFile> index_file;
+    if (write_index_ &&
+        options.compression_type == io::RecordWriterOptions::NONE) {
+      TF_RETURN_IF_ERROR(ctx->env()->NewWritableFile(
+          TFRecordIndexFilename(filename), &index_file));
+      options.index_dest = index_file.get();
+    }
+    auto writer = std::make_unique<io::RecordWriter>(file.get(), options);
 
     DatasetBase* dataset;
     TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
@@ -119,10 +135,15 @@ class ToTFRecordOp : public AsyncOpKernel {
       }
       components.clear();
     } while (!end_of_sequence);
+    TF_RETURN_IF_ERROR(writer->Close());
+    if (index_file) {
+      TF_RETURN_IF_ERROR(index_file->Close());
+    }
     return absl::OkStatus();
   }
 
   BackgroundWorker background_worker_;
+  bool write_index_ = false;
 };
 
 REGISTER_KERNEL_BUILDER(Name("DatasetToTFRecord").Device(DEVICE_CPU),
@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/profiler/lib/traceme.h"
 #include "tsl/profiler/lib/traceme_encode.h"
 
@@ -63,6 +64,24 @@ struct HostBufferElement {
 using MultiDeviceIteratorCallback =
     std::function<void(const HostBufferElement&)>;
 
+// If `TF_MULTI_DEVICE_ITERATOR_PIN_HOST_MEMORY` is true, the background thread
+// copies buffered elements into GPU-compatible (pinned) host memory, so that
+// the copies to the devices are asynchronous DMA transfers instead of
+// synchronous copies out of pageable memory.
+//
+// There is no device-side stage here: `MultiDeviceIteratorGetNextFromShard`
+// runs on the host, the runtime copies its outputs to the device, and the
+// Python `MultiDeviceIterator` already prefetches them on each device.
+bool PinHostMemory() {
+  static const bool pin_host_memory = [] {
+    bool pin_host_memory = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_MULTI_DEVICE_ITERATOR_PIN_HOST_MEMORY",
+                                   /*default_val=*/false, &pin_host_memory));
+    return pin_host_memory;
+  }();
+  return pin_host_memory;
+}
+
 // MultiDeviceIterator provides the ability for multiple devices to fetch from
 // one iterator in a roundrobin sequence, which is deterministic. This means
 // that, for exmaple, starting from the beginning GetNextFromShard(0) always
@@ -376,6 +395,11 @@ class MultiDeviceIterator : public ResourceBase {
 
         elem.status = host_iterator_->GetNext(ctx.get(), &elem.value,
                                               &elem.end_of_sequence);
+        // Stage the element here rather than when the device requests it, to
+        // keep the staging copy off the critical path.
+        if (elem.status.ok() && !elem.end_of_sequence && PinHostMemory()) {
+          elem.status = CopyToPinnedHostMemory(ctx.get(), &elem.value);
+        }
 
         if (elem.status.ok() && elem.end_of_sequence) {
           end_of_iterator = true;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parallel_map_dataset_op.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
 #include "tensorflow/core/data/dataset_utils.h"
@@ -47,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
@@ -92,6 +95,19 @@ constexpr int kStatsReportingPeriodMillis = 1000;
 // large values for the parallelism, e.g. creating 300k threads.
 constexpr int kUnboundedThreadpoolAutotuningFactor = 10;
 
+// Returns the maximum number of map function calls to run in a single task
+// scheduled on the runner when the function uses a single-threaded executor,
+// as set by the `TF_DATA_PARALLEL_MAP_CALLS_PER_TASK` environment variable.
+int64_t GetCallsPerTask() {
+  static const int64_t calls_per_task = [] {
+    int64_t value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_DATA_PARALLEL_MAP_CALLS_PER_TASK",
+                                    /*default_val=*/1, &value));
+    return std::max<int64_t>(value, 1);
+  }();
+  return calls_per_task;
+}
+
 }  // namespace
 
 class ParallelMapDatasetOp::Dataset : public DatasetBase {
@@ -275,7 +291,12 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
                          params.dataset->deterministic_.IsDefault()),
           preserve_cardinality_(params.dataset->preserve_cardinality_),
           use_unbounded_threadpool_(params.dataset->use_unbounded_threadpool_),
-          autotune_(params.dataset->num_parallel_calls_ == model::kAutotune) {}
+          autotune_(params.dataset->num_parallel_calls_ == model::kAutotune),
+          calls_per_task_(
+              use_unbounded_threadpool_ ||
+                      params.dataset->captured_func_->use_inter_op_parallelism()
+                  ? 1
+                  : GetCallsPerTask()) {}
 
     ~Iterator() override {
       CancelThreads(/*wait=*/true);
@@ -608,6 +629,69 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Like `CallFunction`, but applies the map function to the input elements
+    // of all `results` in a single task scheduled on `ctx->runner()`. This
+    // amortizes the cost of scheduling and of entering the task over several
+    // calls of a cheap function. Must only be used when the function is
+    // executed with a single-threaded executor.
+    void CallFunctionBatch(
+        const std::shared_ptr<IteratorContext>& ctx,
+        absl::Span<const std::shared_ptr<InvocationResult>> results)
+        TF_LOCKS_EXCLUDED(*mu_) {
+      using Call = std::pair<std::shared_ptr<InvocationResult>,
+                             std::vector<Tensor>>;
+      auto calls = std::make_shared<std::vector<Call>>();
+      calls->reserve(results.size());
+      for (const auto& result : results) {
+        // Get the next input element.
+        std::vector<Tensor> input_element;
+        result->status = input_impl_->GetNext(ctx.get(), &input_element,
+                                              &result->end_of_input);
+        result->checkpoint.Merge(ctx->checkpoint());
+        if (result->end_of_input || !result->status.ok()) {
+          CallCompleted(ctx, result);
+          continue;
+        }
+        calls->emplace_back(result, std::move(input_element));
+      }
+      if (calls->empty()) {
+        return;
+      }
+      (*ctx->runner())([this, ctx, calls]() {
+        auto run = [this, ctx](Call& call) {
+          const std::shared_ptr<InvocationResult>& result = call.first;
+          tsl::profiler::TraceMe traceme([&] {
+            return tsl::profiler::TraceMeEncode("ParallelMapProduce",
+                                                {{"element_id", result->uid}});
+          });
+          Status s = instantiated_captured_func_->Run(
+              ctx.get(), std::move(call.second), &result->return_values,
+              model_node());
+          if (!s.ok()) {
+            result->status = AddErrorContext(s);
+          }
+          RecordBufferEnqueue(ctx.get(), result->return_values);
+        };
+        // Check whether we are already recording to prevent invalid nesting of
+        // `RecordStart` calls.
+        const bool is_recording = IsRecording(ctx.get());
+        if (!is_recording) {
+          RecordStart(ctx.get());
+        }
+        for (size_t i = 0; i + 1 < calls->size(); ++i) {
+          run((*calls)[i]);
+          CallCompleted(ctx, (*calls)[i].first);
+        }
+        run(calls->back());
+        if (!is_recording) {
+          RecordStop(ctx.get());
+        }
+        // The iterator may be destroyed once the last outstanding call
+        // completes, so this must come last.
+        CallCompleted(ctx, calls->back().first);
+      });
+    }
+
     Status ProcessResult(IteratorContext* ctx,
                          const std::shared_ptr<InvocationResult>& result,
                          std::vector<Tensor>* out_tensors,
@@ -671,8 +755,15 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
           }
           cond_var_->notify_all();
         }
-        for (const auto& call : new_calls) {
-          CallFunction(ctx, call);
+        if (calls_per_task_ > 1) {
+          absl::Span<const std::shared_ptr<InvocationResult>> calls(new_calls);
+          for (size_t i = 0; i < calls.size(); i += calls_per_task_) {
+            CallFunctionBatch(ctx, calls.subspan(i, calls_per_task_));
+          }
+        } else {
+          for (const auto& call : new_calls) {
+            CallFunction(ctx, call);
+          }
         }
         new_calls.clear();
       }
@@ -786,6 +877,9 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     const bool preserve_cardinality_;
     const bool use_unbounded_threadpool_;
     const bool autotune_;
+    // The maximum number of calls to run in a single task scheduled on the
+    // runner (see `CallFunctionBatch`).
+    const int64_t calls_per_task_;
     // Counts the number of outstanding calls.
     int64_t num_calls_ TF_GUARDED_BY(*mu_) = 0;
     // Controls cancellation of `input_impl_`. Must be ordered before
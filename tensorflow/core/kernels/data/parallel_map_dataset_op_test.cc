@@ -277,6 +277,57 @@ ParallelMapDatasetParams ParallelMapDatasetParams9() {
       /*node_name=*/kNodeName);
 }
 
+// test case 10: num_parallel_calls = 8, use_inter_op_parallelism = false,
+// deterministic = true, preserve_cardinality = false, MapFunc = XTimesTwo.
+// With TF_DATA_PARALLEL_MAP_CALLS_PER_TASK set, the calls are grouped into
+// runner tasks, the last of which reaches the end of the input.
+ParallelMapDatasetParams ParallelMapDatasetParams10() {
+  return ParallelMapDatasetParams(
+      RangeDatasetParams(0, 10, 1),
+      /*other_arguments=*/{},
+      /*num_parallel_calls=*/8,
+      /*func=*/MapFunc("XTimesTwo", DT_INT64),
+      /*func_lib*/ {test::function::XTimesTwo()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*use_inter_op_parallelism=*/false,
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*preserve_cardinality=*/false,
+      /*node_name=*/kNodeName);
+}
+
+// Returns x / x, which fails for x = 0.
+FunctionDef XDivX() {
+  return FunctionDefHelper::Define(
+      // Name
+      "XDivX",
+      // Args
+      {"x: T"},
+      // Return values
+      {"y: T"},
+      // Attr def
+      {"T: {int64}"},
+      // Nodes
+      {{{"y"}, "Div", {"x", "x"}, {{"T", "$T"}}}});
+}
+
+ParallelMapDatasetParams ParallelMapDatasetParamsWithFailingCall() {
+  return ParallelMapDatasetParams(
+      RangeDatasetParams(-2, 6, 1),
+      /*other_arguments=*/{},
+      /*num_parallel_calls=*/8,
+      /*func=*/MapFunc("XDivX", DT_INT64),
+      /*func_lib*/ {XDivX()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*use_inter_op_parallelism=*/false,
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*preserve_cardinality=*/false,
+      /*node_name=*/kNodeName);
+}
+
 ParallelMapDatasetParams ParallelMapDatasetParamsWithInvalidNumParallelCalls() {
   return ParallelMapDatasetParams(
       RangeDatasetParams(0, 10, 3),
@@ -324,6 +375,13 @@ std::vector<GetNextTestCase<ParallelMapDatasetParams>> GetNextTestCases() {
            /*expected_outputs=*/
            {CreateTensor<int64_t>(TensorShape{3}, {0, 2, 4}),
             CreateTensor<int64_t>(TensorShape{1}, {6})},
+           /*compare_order=*/true},
+          {/*dataset_params=*/
+           ParallelMapDatasetParams10(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(
+               TensorShape{},
+               {{0}, {2}, {4}, {6}, {8}, {10}, {12}, {14}, {16}, {18}}),
            /*compare_order=*/true}};
 }
 
@@ -444,6 +502,14 @@ IteratorSaveAndRestoreTestCases() {
            /*breakpoints=*/{0, 1, 5},
            /*expected_outputs=*/
            CreateTensors<int64_t>(TensorShape{}, {{0}, {12}, {24}, {36}}),
+           /*compare_order=*/true},
+          {/*dataset_params=*/
+           ParallelMapDatasetParams10(),
+           /*breakpoints=*/{0, 4, 11},
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(
+               TensorShape{},
+               {{0}, {2}, {4}, {6}, {8}, {10}, {12}, {14}, {16}, {18}}),
            /*compare_order=*/true}};
 }
 
@@ -451,6 +517,28 @@ ITERATOR_SAVE_AND_RESTORE_TEST_P(ParallelMapDatasetOpTest,
                                  ParallelMapDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+TEST_F(ParallelMapDatasetOpTest, FailingCallOnlyFailsItsElement) {
+  auto dataset_params = ParallelMapDatasetParamsWithFailingCall();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  // The calls for -2, -1 and 0 may run in the same runner task; only the one
+  // for 0 fails.
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  for (int i = 0; i < 2; ++i) {
+    out_tensors.clear();
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    TF_EXPECT_OK(ExpectEqual(out_tensors[0],
+                             CreateTensor<int64_t>(TensorShape{}, {1})));
+  }
+  out_tensors.clear();
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
 TEST_F(ParallelMapDatasetOpTest, InvalidNumParallelCalls) {
   auto dataset_params = ParallelMapDatasetParamsWithInvalidNumParallelCalls();
   EXPECT_EQ(Initialize(dataset_params).code(),
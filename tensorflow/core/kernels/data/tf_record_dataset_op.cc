@@ -15,12 +15,17 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
 #include <cstdint>
+#include <memory>
 
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/tfrecord_index.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -28,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -59,18 +65,143 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+namespace {
+
+// Reads uncompressed TFRecords directly out of a memory-mapped file, without
+// the read syscalls and the copy through an `InputBuffer` that
+// `io::SequentialRecordReader` performs.
+class MappedRecordReader {
+ public:
+  MappedRecordReader(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     bool verify_crc)
+      : region_(std::move(region)),
+        data_(static_cast<const char*>(region_->data())),
+        length_(region_->length()),
+        verify_crc_(verify_crc) {}
+
+  // Reads the next record into `*record`, which points into the mapping.
+  // Returns OUT_OF_RANGE at the end of the file, and DATA_LOSS if the record
+  // is truncated or (if CRC checking is enabled) corrupted.
+  Status ReadRecord(absl::string_view* record) {
+    uint64 length;
+    TF_RETURN_IF_ERROR(ReadHeader(&length));
+    const uint64 data_offset = offset_ + io::RecordReader::kHeaderSize;
+    const char* data = data_ + data_offset;
+    if (verify_crc_) {
+      const uint32 masked_crc = core::DecodeFixed32(data + length);
+      if (crc32c::Unmask(masked_crc) != crc32c::Value(data, length)) {
+        return errors::DataLoss("corrupted record at ", offset_);
+      }
+    }
+    *record = absl::string_view(data, length);
+    offset_ = data_offset + length + io::RecordReader::kFooterSize;
+    return absl::OkStatus();
+  }
+
+  // Skips up to `num_to_skip` records, setting `*num_skipped` to the number
+  // of records skipped. Record contents are not checked.
+  Status SkipRecords(int num_to_skip, int* num_skipped) {
+    for (*num_skipped = 0; *num_skipped < num_to_skip; ++*num_skipped) {
+      uint64 length;
+      TF_RETURN_IF_ERROR(ReadHeader(&length));
+      offset_ += io::RecordReader::kHeaderSize + length +
+                 io::RecordReader::kFooterSize;
+    }
+    return absl::OkStatus();
+  }
+
+  uint64 TellOffset() const { return offset_; }
+
+  Status SeekOffset(uint64 offset) {
+    if (offset > length_) {
+      return errors::OutOfRange("seek offset ", offset,
+                                " is past the end of the file");
+    }
+    offset_ = offset;
+    return absl::OkStatus();
+  }
+
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region() const {
+    return region_;
+  }
+
+ private:
+  // Reads and checks the header of the record at `offset_`, and checks that
+  // the rest of the record is within the file.
+  Status ReadHeader(uint64* length) const {
+    if (offset_ == length_) return errors::OutOfRange("eof");
+    if (length_ - offset_ < io::RecordReader::kHeaderSize) {
+      return errors::DataLoss("truncated record at ", offset_);
+    }
+    const char* header = data_ + offset_;
+    *length = core::DecodeFixed64(header);
+    if (verify_crc_) {
+      const uint32 masked_crc = core::DecodeFixed32(header + sizeof(uint64));
+      if (crc32c::Unmask(masked_crc) != crc32c::Value(header, sizeof(uint64))) {
+        return errors::DataLoss("corrupted record at ", offset_);
+      }
+    }
+    const uint64 remaining = length_ - offset_ - io::RecordReader::kHeaderSize;
+    if (remaining < io::RecordReader::kFooterSize ||
+        *length > remaining - io::RecordReader::kFooterSize) {
+      return errors::DataLoss("truncated record at ", offset_);
+    }
+    return absl::OkStatus();
+  }
+
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const char* const data_;
+  const uint64 length_;
+  const bool verify_crc_;
+  uint64 offset_ = 0;
+};
+
+// A buffer holding a single `tstring` that is a view of a record in a
+// memory-mapped file. The buffer keeps the mapping alive.
+class MappedRecordBuffer : public TensorBuffer {
+ public:
+  MappedRecordBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     absl::string_view record)
+      : TensorBuffer(&record_), region_(std::move(region)) {
+    record_.assign_as_view(record.data(), record.size());
+  }
+
+  size_t size() const override { return sizeof(tstring); }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(sizeof(tstring));
+    proto->set_allocator_name("mmap");
+  }
+  // The record is owned by the mapping, so the buffer must not be forwarded
+  // to ops that write to their inputs in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  tstring record_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+}  // namespace
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets, int op_version,
+                   bool use_mmap, bool alias_mmap_records,
+                   bool verify_mmap_crc, std::shared_ptr<TFRecordIndex> index)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        use_mmap_(use_mmap && options_.compression_type ==
+                                  io::RecordReaderOptions::NONE),
+        alias_mmap_records_(alias_mmap_records),
+        verify_mmap_crc_(verify_mmap_crc),
+        index_(std::move(index)) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
@@ -107,6 +238,35 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return index_ ? index_->num_records() : kUnknownCardinality;
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+    tstring& record = out_tensors->back().scalar<tstring>()();
+    TF_RETURN_IF_ERROR(index_->ReadRecord(index, &record));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record.size());
+    return absl::OkStatus();
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    if (index_) return absl::OkStatus();
+    return absl::FailedPreconditionError(
+        "Random access of TFRecord files requires their index files and "
+        "`TF_TFRECORD_DATASET_USE_INDEX=true`.");
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -128,16 +288,50 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
+        // We are currently processing a memory-mapped file, so try to read
+        // the next record out of the mapping.
+        if (mapped_reader_) {
+          absl::string_view record;
+          Status s = mapped_reader_->ReadRecord(&record);
+          if (s.ok()) {
+            if (dataset()->alias_mmap_records_) {
+              core::RefCountPtr<TensorBuffer> buf(
+                  new MappedRecordBuffer(mapped_reader_->region(), record));
+              out_tensors->emplace_back(DT_STRING, TensorShape({}),
+                                        std::move(buf));
+            } else {
+              out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                        TensorShape({}));
+              out_tensors->back().scalar<tstring>()().assign(record.data(),
+                                                             record.size());
+            }
+            static monitoring::CounterCell* bytes_counter =
+                metrics::GetTFDataBytesReadCounter(kDatasetType);
+            bytes_counter->IncrementBy(record.size());
+            *end_of_sequence = false;
+            return absl::OkStatus();
+          }
+          // See below for why the file index moves forward on all errors.
+          ResetStreamsLocked();
+          ++current_file_index_;
+          if (!errors::IsOutOfRange(s)) return s;
+        }
+
         // We are currently processing a file, so try to read the next record.
         if (reader_) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
@@ -185,10 +379,13 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       do {
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
-        if (reader_) {
+        if (reader_ || mapped_reader_) {
           int last_num_skipped;
-          Status s = reader_->SkipRecords(num_to_skip - *num_skipped,
-                                          &last_num_skipped);
+          Status s = mapped_reader_
+                         ? mapped_reader_->SkipRecords(
+                               num_to_skip - *num_skipped, &last_num_skipped)
+                         : reader_->SkipRecords(num_to_skip - *num_skipped,
+                                                &last_num_skipped);
           *num_skipped += last_num_skipped;
           if (s.ok()) {
             *end_of_sequence = false;
@@ -234,12 +431,23 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(prefix(), kOffset, reader_->TellOffset()));
+      } else if (mapped_reader_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), kOffset,
+            static_cast<int64_t>(mapped_reader_->TellOffset())));
+      }
+      if (dataset()->index_) {
+        TF_RETURN_IF_ERROR(
+            global_shuffle_iterator_.Save(prefix(), ctx, writer));
       }
       return absl::OkStatus();
     }
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return global_shuffle_iterator_.Restore(prefix(), ctx, reader);
+      }
       mutex_lock l(mu_);
       ResetStreamsLocked();
       int64_t current_file_index;
@@ -250,7 +458,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        TF_RETURN_IF_ERROR(mapped_reader_ ? mapped_reader_->SeekOffset(offset)
+                                          : reader_->SeekOffset(offset));
       }
       return absl::OkStatus();
     }
@@ -265,9 +474,25 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       }
 
       // Actually move on to next file.
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
+      const string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      if (dataset()->use_mmap_) {
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        Status s = env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+        if (s.ok()) {
+          mapped_reader_ = std::make_unique<MappedRecordReader>(
+              std::move(region), dataset()->verify_mmap_crc_);
+          if (!dataset()->byte_offsets_.empty()) {
+            TF_RETURN_IF_ERROR(mapped_reader_->SeekOffset(
+                dataset()->byte_offsets_[current_file_index_]));
+          }
+          return absl::OkStatus();
+        }
+        // Not all file systems support memory mapping, so fall back to
+        // reading the file.
+        VLOG(1) << "Could not memory-map " << filename << ": " << s;
+      }
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
       reader_ = std::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
       if (!dataset()->byte_offsets_.empty()) {
@@ -281,6 +506,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      mapped_reader_.reset();
     }
 
     mutex mu_;
@@ -290,6 +516,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+    // Set instead of `reader_` when reading a memory-mapped file.
+    std::unique_ptr<MappedRecordReader> mapped_reader_ TF_GUARDED_BY(mu_);
+
+    // Reads records through `dataset()->index_` when globally shuffled.
+    GlobalShuffleIterator global_shuffle_iterator_;
   };
 
   const std::vector<string> filenames_;
@@ -297,11 +528,43 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+  const bool use_mmap_;
+  const bool alias_mmap_records_;
+  const bool verify_mmap_crc_;
+  // Set if the files can be read in random order; see `TFRecordIndex`.
+  const std::shared_ptr<TFRecordIndex> index_;
 };
 
+// If `TF_TFRECORD_DATASET_USE_MMAP` is true, uncompressed files are
+// memory-mapped (where the file system supports it) and records are read
+// directly out of the mapping. CRCs are checked unless
+// `TF_TFRECORD_DATASET_VERIFY_MMAP_CRC` is false.
+//
+// If `TF_TFRECORD_DATASET_ALIAS_MMAP_RECORDS` is also true, the output
+// tensors are views of the mapping instead of copies. A string copied out of
+// such a tensor into another tensor is itself a view, and is only valid while
+// the mapping is alive, i.e. while some tensor produced from that file is.
+// Only enable this when records are consumed (e.g. parsed) before the tensors
+// produced by this dataset are released.
+//
+// If `TF_TFRECORD_DATASET_USE_INDEX` is true and all uncompressed files have
+// index files (see `TFRecordIndex`), the dataset has a known cardinality and
+// supports random access, so it can be globally shuffled. Otherwise the files
+// are read sequentially.
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_TFRECORD_DATASET_USE_MMAP",
+                                         /*default_val=*/false, &use_mmap_));
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar(
+                          "TF_TFRECORD_DATASET_ALIAS_MMAP_RECORDS",
+                          /*default_val=*/false, &alias_mmap_records_));
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_TFRECORD_DATASET_VERIFY_MMAP_CRC",
+                                         /*default_val=*/true,
+                                         &verify_mmap_crc_));
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_TFRECORD_DATASET_USE_INDEX",
+                                         /*default_val=*/false, &use_index_));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -379,8 +642,30 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
         << buffer_size;
   }
 
+  std::shared_ptr<TFRecordIndex> index;
+  if (use_index_ && byte_offsets.empty() &&
+      io::RecordReaderOptions::CreateRecordReaderOptions(compression_type)
+              .compression_type == io::RecordReaderOptions::NONE) {
+    std::vector<std::string> translated_filenames;
+    translated_filenames.reserve(filenames.size());
+    for (const string& filename : filenames) {
+      translated_filenames.push_back(TranslateFileName(filename));
+    }
+    absl::StatusOr<std::unique_ptr<TFRecordIndex>> opened =
+        TFRecordIndex::Open(ctx->env(), std::move(translated_filenames));
+    if (opened.ok()) {
+      index = std::move(*opened);
+    } else {
+      LOG_FIRST_N(WARNING, 1)
+          << "Reading TFRecord files sequentially because their index files "
+          << "could not be opened: " << opened.status();
+    }
+  }
+
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets), op_version_,
+                        use_mmap_, alias_mmap_records_, verify_mmap_crc_,
+                        std::move(index));
 }
 
 namespace {
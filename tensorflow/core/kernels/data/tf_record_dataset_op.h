@@ -36,6 +36,12 @@ class TFRecordDatasetOp : public DatasetOpKernel {
  private:
   class Dataset;
   int op_version_;
+  // Read from the `TF_TFRECORD_DATASET_*` environment variables; see
+  // documentation in tf_record_dataset_op.cc.
+  bool use_mmap_ = false;
+  bool alias_mmap_records_ = false;
+  bool verify_mmap_crc_ = true;
+  bool use_index_ = false;
 };
 
 }  // namespace data
@@ -11,8 +11,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <cstdlib>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/log/log.h"
@@ -352,6 +354,90 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+// Returns the records of `TFRecordDatasetParams1()` to
+// `TFRecordDatasetParams3()`.
+std::vector<Tensor> ExpectedRecords() {
+  return CreateTensors<tstring>(
+      TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}});
+}
+
+// Reads uncompressed files out of memory mappings.
+class TFRecordDatasetOpMmapTest : public TFRecordDatasetOpTest {
+ protected:
+  void SetUp() override { setenv("TF_TFRECORD_DATASET_USE_MMAP", "true", 1); }
+
+  void TearDown() override {
+    unsetenv("TF_TFRECORD_DATASET_USE_MMAP");
+    unsetenv("TF_TFRECORD_DATASET_ALIAS_MMAP_RECORDS");
+  }
+};
+
+TEST_F(TFRecordDatasetOpMmapTest, GetNext) {
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(ExpectedRecords(), /*compare_order=*/true));
+}
+
+TEST_F(TFRecordDatasetOpMmapTest, ByteOffsets) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(
+      CreateTensors<tstring>(
+          TensorShape({}), {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}}),
+      /*compare_order=*/true));
+}
+
+TEST_F(TFRecordDatasetOpMmapTest, CompressedFilesAreNotMapped) {
+  auto dataset_params = TFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(ExpectedRecords(), /*compare_order=*/true));
+}
+
+TEST_F(TFRecordDatasetOpMmapTest, Skip) {
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorSkip(
+      /*num_to_skip=*/4, /*expected_num_skipped=*/4, /*get_next=*/true,
+      CreateTensors<tstring>(TensorShape({}), {{"bb"}}),
+      /*compare_order=*/true));
+}
+
+TEST_F(TFRecordDatasetOpMmapTest, SaveAndRestore) {
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(
+      dataset_params.iterator_prefix(), ExpectedRecords(),
+      /*breakpoints=*/{0, 2, 7}, /*compare_order=*/true));
+}
+
+TEST_F(TFRecordDatasetOpMmapTest, InvalidByteOffsetsToSeek) {
+  auto dataset_params = InvalidByteOffsets();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      absl::StatusCode::kDataLoss);
+}
+
+TEST_F(TFRecordDatasetOpMmapTest, AliasRecords) {
+  setenv("TF_TFRECORD_DATASET_ALIAS_MMAP_RECORDS", "true", 1);
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> outputs;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &outputs, &end_of_sequence));
+  }
+  // The records remain valid after the iterator and its files are released.
+  iterator_.reset();
+  ASSERT_EQ(outputs.size(), 6);
+  EXPECT_EQ(outputs[0].scalar<tstring>()().type(), tstring::VIEW);
+  TF_EXPECT_OK(ExpectEqual(outputs, ExpectedRecords(), /*compare_order=*/true));
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
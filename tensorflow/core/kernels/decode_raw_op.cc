@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/string_bytes_buffer.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/byte_order.h"
@@ -71,6 +72,19 @@ class DecodeRawOp : public OpKernel {
                                 ", the size of ", DataTypeString(out_type_)));
     const int64_t added_dim = str_size / sizeof(T);
     OP_REQUIRES_OK(context, out_shape.AddDimWithStatus(added_dim));
+
+    // A single string already in the host's byte order becomes the output
+    // without a copy, if it is suitably aligned.
+    if (flat_in.size() == 1 && (!convert_data_endianness_ || sizeof(T) == 1) &&
+        !context->output_alloc_attr(0).gpu_compatible()) {
+      Tensor output;
+      if (AliasStringBytes(input, out_type_, out_shape, flat_in(0).data(),
+                           str_size, &output)) {
+        context->set_output(0, output);
+        return;
+      }
+    }
+
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(
         context, context->allocate_output("output", out_shape, &output_tensor));
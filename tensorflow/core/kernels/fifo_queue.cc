@@ -48,9 +48,59 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
   }
 }
 
+bool FIFOQueue::EnqueueIfRoom(absl::Span<const Tuple> elements,
+                              CancellationManager* cm) {
+  if (cm->IsCancelled()) return false;
+  bool has_dequeue_attempts;
+  {
+    mutex_lock l(mu_);
+    if (closed_ || !enqueue_attempts_.empty() ||
+        queues_[0].size() + elements.size() > static_cast<size_t>(capacity_)) {
+      return false;
+    }
+    for (const Tuple& element : elements) {
+      for (int i = 0; i < num_components(); ++i) {
+        queues_[i].push_back(element[i]);
+      }
+    }
+    has_dequeue_attempts = !dequeue_attempts_.empty();
+  }
+  if (has_dequeue_attempts) FlushUnlocked();
+  return true;
+}
+
+bool FIFOQueue::DequeueIfAvailable(int64_t num_elements,
+                                   CancellationManager* cm,
+                                   std::vector<Tuple>* elements) {
+  if (cm->IsCancelled()) return false;
+  bool has_enqueue_attempts;
+  {
+    mutex_lock l(mu_);
+    if (!dequeue_attempts_.empty() ||
+        queues_[0].size() < static_cast<size_t>(num_elements)) {
+      return false;
+    }
+    elements->resize(num_elements);
+    for (Tuple& element : *elements) {
+      element.reserve(num_components());
+      for (int i = 0; i < num_components(); ++i) {
+        element.push_back(std::move(queues_[i].front()));
+        queues_[i].pop_front();
+      }
+    }
+    has_enqueue_attempts = !enqueue_attempts_.empty();
+  }
+  if (has_enqueue_attempts) FlushUnlocked();
+  return true;
+}
+
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
   CancellationManager* cm = ctx->cancellation_manager();
+  if (EnqueueIfRoom(absl::MakeConstSpan(&tuple, 1), cm)) {
+    callback();
+    return;
+  }
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
   {
@@ -108,6 +158,31 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
   }
 
   CancellationManager* cm = ctx->cancellation_manager();
+  // A batch that fits in the queue is split before taking the lock, so that
+  // the copies do not hold up other queue operations. If it can't be enqueued
+  // right away, the copies are dropped and the attempt splits the batch as it
+  // makes room, so that a blocked enqueue does not hold the batch twice.
+  if (batch_size <= capacity_) {
+    std::vector<Tuple> elements(batch_size);
+    for (int64_t index = 0; index < batch_size; ++index) {
+      elements[index].reserve(num_components());
+      for (int i = 0; i < num_components(); ++i) {
+        Tensor element;
+        Status status =
+            GetElementComponentFromBatch(tuple, index, i, ctx, &element);
+        if (!status.ok()) {
+          ctx->SetStatus(status);
+          callback();
+          return;
+        }
+        elements[index].push_back(std::move(element));
+      }
+    }
+    if (EnqueueIfRoom(elements, cm)) {
+      callback();
+      return;
+    }
+  }
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
   {
@@ -154,6 +229,11 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
   CancellationManager* cm = ctx->cancellation_manager();
+  std::vector<Tuple> elements;
+  if (DequeueIfAvailable(1, cm, &elements)) {
+    callback(elements[0]);
+    return;
+  }
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
   {
@@ -245,6 +325,44 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
   }
 
   CancellationManager* cm = ctx->cancellation_manager();
+  // The queue never holds more than `capacity_` elements, so larger requests
+  // always wait in an attempt.
+  if (num_elements <= capacity_ && !cm->IsCancelled()) {
+    // Allocate the batch before dequeuing, so that a failed allocation does
+    // not lose the elements.
+    Tuple tuple;
+    tuple.reserve(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      Tensor batch;
+      Status status = ctx->allocate_temp(
+          component_dtypes_[i], ManyOutShape(i, num_elements), &batch);
+      if (!status.ok()) {
+        ctx->SetStatus(status);
+        callback(Tuple());
+        return;
+      }
+      tuple.push_back(std::move(batch));
+    }
+    std::vector<Tuple> elements;
+    if (DequeueIfAvailable(num_elements, cm, &elements)) {
+      // Assemble the batch after releasing the lock. The elements were
+      // checked against the component shapes and types when they were
+      // enqueued, so the copies only fail on a broken invariant.
+      for (int i = 0; i < num_components(); ++i) {
+        for (int64_t index = 0; index < num_elements; ++index) {
+          Status status = batch_util::CopyElementToSlice(
+              std::move(elements[index][i]), &tuple[i], index);
+          if (!status.ok()) {
+            ctx->SetStatus(status);
+            callback(Tuple());
+            return;
+          }
+        }
+      }
+      callback(tuple);
+      return;
+    }
+  }
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
   {
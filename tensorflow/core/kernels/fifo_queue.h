@@ -19,6 +19,7 @@ limitations under the License.
 #include <deque>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -61,6 +62,19 @@ class FIFOQueue : public TypedQueue<std::deque<Tensor> > {
   void DequeueLocked(OpKernelContext* ctx, Tuple* tuple)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Fast paths for operations that can complete right away. They run only
+  // when no attempt of the same kind is pending, so they never overtake a
+  // blocked operation, and skip creating and flushing an attempt. They
+  // return false if the caller must queue an attempt instead.
+  //
+  // Enqueues all of `elements` if the queue is open and has room for them.
+  bool EnqueueIfRoom(absl::Span<const Tuple> elements,
+                     CancellationManager* cm);
+  // Dequeues `num_elements` elements into `elements` if the queue holds at
+  // least that many.
+  bool DequeueIfAvailable(int64_t num_elements, CancellationManager* cm,
+                          std::vector<Tuple>* elements);
+
   static Status GetElementComponentFromBatch(const Tuple& tuple, int64_t index,
                                              int component,
                                              OpKernelContext* ctx,
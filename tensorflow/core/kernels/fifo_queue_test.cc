@@ -0,0 +1,264 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/fifo_queue.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Tuple = QueueInterface::Tuple;
+
+// Runs queue operations directly on a FIFOQueue of int32 scalars, each with
+// its own context, to control which operations are blocked when another one
+// runs.
+class FIFOQueueTest : public OpsTestBase {
+ protected:
+  void SetUp() override {
+    TF_ASSERT_OK(NodeDefBuilder("op", "NoOp").Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void CreateQueue(int32_t capacity) {
+    queue_.reset(
+        new FIFOQueue(capacity, {DT_INT32}, {TensorShape({})}, "queue"));
+    TF_ASSERT_OK(queue_->Initialize());
+  }
+
+  // Returns a new context, which lives as long as the test, using
+  // `cancellation_manager` or else one that is never cancelled.
+  OpKernelContext* NewContext(
+      CancellationManager* cancellation_manager = nullptr) {
+    auto params = std::make_unique<OpKernelContext::Params>();
+    params->device = device_;
+    params->op_kernel = kernel_.get();
+    params->cancellation_manager = cancellation_manager
+                                       ? cancellation_manager
+                                       : &cancellation_manager_;
+    contexts_.push_back(std::make_unique<OpKernelContext>(params.get()));
+    params_.push_back(std::move(params));
+    return contexts_.back().get();
+  }
+
+  // Enqueues `values` with EnqueueMany, or with Enqueue if there is one.
+  OpKernelContext* Enqueue(const std::vector<int32_t>& values, bool* done,
+                           CancellationManager* cm = nullptr) {
+    OpKernelContext* ctx = NewContext(cm);
+    *done = false;
+    if (values.size() == 1) {
+      queue_->TryEnqueue({test::AsScalar<int32_t>(values[0])}, ctx,
+                         [done]() { *done = true; });
+    } else {
+      queue_->TryEnqueueMany({test::AsTensor<int32_t>(values)}, ctx,
+                             [done]() { *done = true; });
+    }
+    return ctx;
+  }
+
+  // Dequeues `num_elements` with DequeueMany into `values`, or with Dequeue
+  // if `num_elements` is 0.
+  OpKernelContext* Dequeue(int num_elements, bool* done,
+                           std::vector<int32_t>* values,
+                           CancellationManager* cm = nullptr) {
+    OpKernelContext* ctx = NewContext(cm);
+    *done = false;
+    auto callback = [done, values](const Tuple& tuple) {
+      *done = true;
+      if (tuple.empty()) return;
+      const auto flat = tuple[0].flat<int32_t>();
+      values->assign(flat.data(), flat.data() + flat.size());
+    };
+    if (num_elements == 0) {
+      queue_->TryDequeue(ctx, callback);
+    } else {
+      queue_->TryDequeueMany(num_elements, ctx, /*allow_small_batch=*/false,
+                             callback);
+    }
+    return ctx;
+  }
+
+  void Close() {
+    bool closed = false;
+    queue_->Close(NewContext(), /*cancel_pending_enqueues=*/false,
+                  [&closed]() { closed = true; });
+    EXPECT_TRUE(closed);
+  }
+
+  CancellationManager cancellation_manager_;
+  std::vector<std::unique_ptr<OpKernelContext::Params>> params_;
+  std::vector<std::unique_ptr<OpKernelContext>> contexts_;
+  core::RefCountPtr<FIFOQueue> queue_;
+};
+
+TEST_F(FIFOQueueTest, EnqueueDoesNotOvertakeBlockedEnqueue) {
+  CreateQueue(2);
+  bool done;
+  Enqueue({1, 2}, &done);
+  ASSERT_TRUE(done);
+  bool blocked_done;
+  Enqueue({3}, &blocked_done);
+  EXPECT_FALSE(blocked_done);
+
+  // Dequeuing makes room, which the blocked enqueue takes first.
+  std::vector<int32_t> values;
+  Dequeue(0, &done, &values);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(blocked_done);
+  bool later_done;
+  Enqueue({4}, &later_done);
+  EXPECT_FALSE(later_done);
+
+  for (int32_t expected : {2, 3, 4}) {
+    Dequeue(0, &done, &values);
+    EXPECT_TRUE(done);
+    EXPECT_EQ(values, std::vector<int32_t>({expected}));
+  }
+  EXPECT_TRUE(later_done);
+  EXPECT_EQ(queue_->size(), 0);
+}
+
+TEST_F(FIFOQueueTest, DequeueDoesNotOvertakeBlockedDequeue) {
+  CreateQueue(4);
+  bool blocked_done, later_done, done;
+  std::vector<int32_t> blocked_values, later_values;
+  Dequeue(2, &blocked_done, &blocked_values);
+  EXPECT_FALSE(blocked_done);
+
+  // The blocked dequeue takes the first element, and a later dequeue waits
+  // behind it.
+  Enqueue({1}, &done);
+  ASSERT_TRUE(done);
+  Dequeue(0, &later_done, &later_values);
+  EXPECT_FALSE(later_done);
+
+  Enqueue({2, 3}, &done);
+  ASSERT_TRUE(done);
+  EXPECT_TRUE(blocked_done);
+  EXPECT_EQ(blocked_values, std::vector<int32_t>({1, 2}));
+  EXPECT_TRUE(later_done);
+  EXPECT_EQ(later_values, std::vector<int32_t>({3}));
+}
+
+TEST_F(FIFOQueueTest, ClosedQueue) {
+  CreateQueue(4);
+  bool done;
+  Enqueue({1, 2}, &done);
+  ASSERT_TRUE(done);
+  Close();
+
+  OpKernelContext* ctx = Enqueue({3}, &done);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(errors::IsCancelled(ctx->status()));
+  ctx = Enqueue({3, 4}, &done);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(errors::IsCancelled(ctx->status()));
+  EXPECT_EQ(queue_->size(), 2);
+
+  // The remaining elements can still be dequeued, but not more.
+  std::vector<int32_t> values;
+  ctx = Dequeue(3, &done, &values);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(errors::IsOutOfRange(ctx->status()));
+  EXPECT_EQ(queue_->size(), 2);
+  ctx = Dequeue(0, &done, &values);
+  EXPECT_TRUE(done);
+  TF_EXPECT_OK(ctx->status());
+  EXPECT_EQ(values, std::vector<int32_t>({1}));
+  ctx = Dequeue(1, &done, &values);
+  EXPECT_TRUE(done);
+  TF_EXPECT_OK(ctx->status());
+  EXPECT_EQ(values, std::vector<int32_t>({2}));
+}
+
+TEST_F(FIFOQueueTest, AlreadyCancelled) {
+  CreateQueue(4);
+  bool done;
+  Enqueue({1, 2}, &done);
+  ASSERT_TRUE(done);
+  CancellationManager cancelled;
+  cancelled.StartCancel();
+
+  // The queue could serve all of them right away, but none takes effect.
+  OpKernelContext* ctx = Enqueue({3}, &done, &cancelled);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(errors::IsCancelled(ctx->status()));
+  ctx = Enqueue({3, 4}, &done, &cancelled);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(errors::IsCancelled(ctx->status()));
+  std::vector<int32_t> values;
+  ctx = Dequeue(0, &done, &values, &cancelled);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(errors::IsCancelled(ctx->status()));
+  ctx = Dequeue(2, &done, &values, &cancelled);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(errors::IsCancelled(ctx->status()));
+  EXPECT_EQ(queue_->size(), 2);
+
+  ctx = Dequeue(2, &done, &values);
+  EXPECT_TRUE(done);
+  TF_EXPECT_OK(ctx->status());
+  EXPECT_EQ(values, std::vector<int32_t>({1, 2}));
+}
+
+TEST_F(FIFOQueueTest, BatchesLargerThanFreeCapacity) {
+  CreateQueue(4);
+  bool done;
+  Enqueue({1, 2}, &done);
+  ASSERT_TRUE(done);
+  // Partially enqueued until there is room for the rest.
+  bool enqueue_done;
+  OpKernelContext* enqueue_ctx = Enqueue({3, 4, 5}, &enqueue_done);
+  EXPECT_FALSE(enqueue_done);
+  EXPECT_EQ(queue_->size(), 4);
+
+  std::vector<int32_t> values;
+  OpKernelContext* ctx = Dequeue(3, &done, &values);
+  EXPECT_TRUE(done);
+  TF_EXPECT_OK(ctx->status());
+  EXPECT_EQ(values, std::vector<int32_t>({1, 2, 3}));
+  EXPECT_TRUE(enqueue_done);
+  TF_EXPECT_OK(enqueue_ctx->status());
+
+  // More than the capacity is enqueued and dequeued as room and elements
+  // become available.
+  OpKernelContext* big_enqueue_ctx = Enqueue({6, 7, 8, 9, 10}, &enqueue_done);
+  EXPECT_FALSE(enqueue_done);
+  bool dequeue_done;
+  std::vector<int32_t> big_values;
+  OpKernelContext* big_dequeue_ctx = Dequeue(7, &dequeue_done, &big_values);
+  EXPECT_TRUE(enqueue_done);
+  TF_EXPECT_OK(big_enqueue_ctx->status());
+  EXPECT_TRUE(dequeue_done);
+  TF_EXPECT_OK(big_dequeue_ctx->status());
+  EXPECT_EQ(big_values, std::vector<int32_t>({4, 5, 6, 7, 8, 9, 10}));
+  EXPECT_EQ(queue_->size(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
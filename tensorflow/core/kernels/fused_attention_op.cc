@@ -0,0 +1,277 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fused_attention_op.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace functor {
+
+// Computes the attention of a block of query rows over a block of keys at a
+// time, so that the scores of a block fit in the cache.
+template <typename T>
+struct FusedMultiHeadAttention<CPUDevice, T> {
+  static constexpr int64_t kQueryBlockSize = 64;
+  static constexpr int64_t kKeyBlockSize = 256;
+
+  template <typename Scalar>
+  using RowMajorMatrix =
+      Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+  Status operator()(OpKernelContext* context, const AttentionShape& shape,
+                    float scale, const T* query, const T* key, const T* value,
+                    const T* mask, T* output) {
+    const int64_t num_q_blocks =
+        Eigen::divup(shape.q_len, static_cast<int64_t>(kQueryBlockSize));
+    const int64_t num_blocks =
+        shape.batch_size * shape.num_heads * num_q_blocks;
+
+    auto compute_blocks = [&](int64_t begin, int64_t end) {
+      constexpr float kInfinity = std::numeric_limits<float>::infinity();
+      RowMajorMatrix<float> q, k, v, scores, acc;
+      std::vector<float> row_max, row_sum;
+      for (int64_t block = begin; block < end; ++block) {
+        const int64_t bh = block / num_q_blocks;
+        const int64_t b = bh / shape.num_heads;
+        const int64_t h = bh % shape.num_heads;
+        const int64_t q_begin = (block % num_q_blocks) * kQueryBlockSize;
+        const int64_t q_rows = std::min(kQueryBlockSize, shape.q_len - q_begin);
+
+        q = Eigen::Map<const RowMajorMatrix<T>>(
+                query + (bh * shape.q_len + q_begin) * shape.head_size, q_rows,
+                shape.head_size)
+                .template cast<float>();
+        acc.setZero(q_rows, shape.value_size);
+        row_max.assign(q_rows, -kInfinity);
+        row_sum.assign(q_rows, 0);
+
+        for (int64_t kv_begin = 0; kv_begin < shape.kv_len;
+             kv_begin += kKeyBlockSize) {
+          const int64_t kv_cols =
+              std::min(kKeyBlockSize, shape.kv_len - kv_begin);
+          k = Eigen::Map<const RowMajorMatrix<T>>(
+                  key + (bh * shape.kv_len + kv_begin) * shape.head_size,
+                  kv_cols, shape.head_size)
+                  .template cast<float>();
+          v = Eigen::Map<const RowMajorMatrix<T>>(
+                  value + (bh * shape.kv_len + kv_begin) * shape.value_size,
+                  kv_cols, shape.value_size)
+                  .template cast<float>();
+          scores.noalias() = q * k.transpose();
+          scores *= scale;
+          if (mask != nullptr) {
+            const T* mask_block = mask + b * shape.mask_strides[0] +
+                                  h * shape.mask_strides[1] +
+                                  q_begin * shape.mask_strides[2] +
+                                  kv_begin * shape.mask_strides[3];
+            for (int64_t i = 0; i < q_rows; ++i) {
+              const T* mask_row = mask_block + i * shape.mask_strides[2];
+              for (int64_t j = 0; j < kv_cols; ++j) {
+                scores(i, j) +=
+                    static_cast<float>(mask_row[j * shape.mask_strides[3]]);
+              }
+            }
+          }
+
+          // Rescales the sums of the previous blocks to the new maximum of
+          // each row, which keeps the exponentials in range.
+          for (int64_t i = 0; i < q_rows; ++i) {
+            const float new_max =
+                std::max(row_max[i], scores.row(i).maxCoeff());
+            if (new_max == -kInfinity) {
+              scores.row(i).setZero();
+              continue;
+            }
+            const float correction = std::exp(row_max[i] - new_max);
+            scores.row(i).array() = (scores.row(i).array() - new_max).exp();
+            row_sum[i] = row_sum[i] * correction + scores.row(i).sum();
+            acc.row(i) *= correction;
+            row_max[i] = new_max;
+          }
+          acc.noalias() += scores * v;
+        }
+
+        Eigen::Map<RowMajorMatrix<T>> out(
+            output + (bh * shape.q_len + q_begin) * shape.value_size, q_rows,
+            shape.value_size);
+        for (int64_t i = 0; i < q_rows; ++i) {
+          if (row_sum[i] > 0) {
+            out.row(i) = (acc.row(i) / row_sum[i]).template cast<T>();
+          } else {
+            // Softmax of a row of -inf scores is NaN.
+            out.row(i).setConstant(
+                static_cast<T>(std::numeric_limits<float>::quiet_NaN()));
+          }
+        }
+      }
+    };
+
+    const int64_t cost_per_block =
+        kQueryBlockSize * shape.kv_len * (shape.head_size + shape.value_size) *
+        2;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, compute_blocks);
+    return absl::OkStatus();
+  }
+};
+
+}  // namespace functor
+
+namespace {
+
+// Computes the scaled dot-product attention that the remapper fuses from
+// MatMul(query, key^T) -> Mul(scale) -> Add(mask) -> Softmax -> MatMul(value),
+// without materializing the [..., q_len, kv_len] scores and probabilities.
+template <typename Device, typename T>
+class FusedMultiHeadAttentionOp : public OpKernel {
+ public:
+  explicit FusedMultiHeadAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args <= 1,
+                errors::InvalidArgument(
+                    "_FusedMultiHeadAttention takes at most one mask, got ",
+                    num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    const int rank = query.dims();
+    OP_REQUIRES(context, rank == 3 || rank == 4,
+                errors::InvalidArgument(
+                    "query must be a rank 3 or 4 tensor, got shape ",
+                    query.shape().DebugString()));
+    OP_REQUIRES(
+        context, key.dims() == rank && value.dims() == rank,
+        errors::InvalidArgument("query, key and value must have the same rank, "
+                                "got shapes ",
+                                query.shape().DebugString(), ", ",
+                                key.shape().DebugString(), " and ",
+                                value.shape().DebugString()));
+    for (int i = 0; i < rank - 2; ++i) {
+      OP_REQUIRES(context,
+                  key.dim_size(i) == query.dim_size(i) &&
+                      value.dim_size(i) == query.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions, got shapes ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), " and ",
+                      value.shape().DebugString()));
+    }
+    OP_REQUIRES(context, key.dim_size(rank - 1) == query.dim_size(rank - 1),
+                errors::InvalidArgument(
+                    "query and key must have the same depth, got shapes ",
+                    query.shape().DebugString(), " and ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(rank - 2) == key.dim_size(rank - 2),
+                errors::InvalidArgument(
+                    "key and value must have the same length, got shapes ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+
+    functor::AttentionShape shape;
+    shape.batch_size = query.dim_size(0);
+    shape.num_heads = rank == 4 ? query.dim_size(1) : 1;
+    shape.q_len = query.dim_size(rank - 2);
+    shape.kv_len = key.dim_size(rank - 2);
+    shape.head_size = query.dim_size(rank - 1);
+    shape.value_size = value.dim_size(rank - 1);
+
+    const T* mask_data = nullptr;
+    if (context->num_inputs() > 3) {
+      const Tensor& mask = context->input(3);
+      const int64_t scores_dims[4] = {shape.batch_size, shape.num_heads,
+                                      shape.q_len, shape.kv_len};
+      OP_REQUIRES(context, mask.dims() == rank,
+                  errors::InvalidArgument("mask must have the rank of query, "
+                                          "got shape ",
+                                          mask.shape().DebugString()));
+      // The dimensions of the mask, with a head dimension of 1 for rank 3
+      // inputs.
+      int64_t mask_dims[4] = {mask.dim_size(0), 1, mask.dim_size(rank - 2),
+                              mask.dim_size(rank - 1)};
+      if (rank == 4) mask_dims[1] = mask.dim_size(1);
+      int64_t stride = 1;
+      for (int i = 3; i >= 0; --i) {
+        OP_REQUIRES(context,
+                    mask_dims[i] == 1 || mask_dims[i] == scores_dims[i],
+                    errors::InvalidArgument(
+                        "mask of shape ", mask.shape().DebugString(),
+                        " can't be broadcast to the attention scores"));
+        shape.mask_strides[i] = mask_dims[i] == 1 ? 0 : stride;
+        stride *= mask_dims[i];
+      }
+      mask_data = mask.flat<T>().data();
+    }
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(rank - 1, shape.value_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    functor::FusedMultiHeadAttention<Device, T> attention;
+    OP_REQUIRES_OK(
+        context,
+        attention(context, shape, scale_, query.flat<T>().data(),
+                  key.flat<T>().data(), value.flat<T>().data(), mask_data,
+                  output->flat<T>().data()));
+  }
+
+ private:
+  float scale_;
+};
+
+}  // namespace
+
+#define REGISTER_CPU(T)                                                       \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("_FusedMultiHeadAttention").Device(DEVICE_CPU).TypeConstraint<T>( \
+          "T"),                                                               \
+      FusedMultiHeadAttentionOp<CPUDevice, T>);
+
+TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
+TF_CALL_float(REGISTER_CPU);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,60 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
+
+#include <cstdint>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace functor {
+
+// The dimensions of a scaled dot-product attention. The query, key and value
+// are [batch_size, num_heads, length, depth] row-major tensors, with a single
+// head for rank 3 inputs.
+struct AttentionShape {
+  int64_t batch_size = 0;
+  int64_t num_heads = 0;
+  int64_t q_len = 0;
+  int64_t kv_len = 0;
+  int64_t head_size = 0;
+  int64_t value_size = 0;
+  // The strides of the mask along the batch, heads, q_len and kv_len
+  // dimensions, 0 along the dimensions it is broadcast.
+  int64_t mask_strides[4] = {};
+};
+
+template <typename Device, typename T>
+struct FusedMultiHeadAttention {
+  // Computes output[b, h, i] = sum_j p[b, h, i, j] * value[b, h, j], where
+  // p[b, h, i] is the softmax over j of
+  // scale * <query[b, h, i], key[b, h, j]> + mask[b, h, i, j].
+  //
+  // The scores are computed a tile of keys at a time and normalized with a
+  // running maximum and sum, so that they are never materialized. `mask` may
+  // be null. Rows whose scores are all -inf are NaN, as with Softmax.
+  Status operator()(OpKernelContext* context, const AttentionShape& shape,
+                    float scale, const T* query, const T* key, const T* value,
+                    const T* mask, T* output);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_ATTENTION_OP_H_
@@ -0,0 +1,186 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedMultiHeadAttentionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool with_mask, float scale) {
+    TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedMultiHeadAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(with_mask ? 1 : 0, DT_FLOAT))
+                     .Attr("num_args", with_mask ? 1 : 0)
+                     .Attr("scale", scale)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  static Tensor Iota(const TensorShape& shape, float step) {
+    Tensor tensor(DT_FLOAT, shape);
+    auto flat = tensor.flat<float>();
+    for (int64_t i = 0; i < flat.size(); ++i) {
+      flat(i) = std::sin(i * step);
+    }
+    return tensor;
+  }
+
+  // Computes Softmax(query @ key^T * scale + mask) @ value for [batch, heads,
+  // length, depth] inputs and a [batch, 1, 1, kv_len] mask.
+  static Tensor Reference(const Tensor& query, const Tensor& key,
+                          const Tensor& value, const Tensor* mask,
+                          float scale) {
+    const int64_t batch = query.dim_size(0), heads = query.dim_size(1);
+    const int64_t q_len = query.dim_size(2), kv_len = key.dim_size(2);
+    const int64_t head_size = query.dim_size(3);
+    const int64_t value_size = value.dim_size(3);
+    auto q = query.tensor<float, 4>();
+    auto k = key.tensor<float, 4>();
+    auto v = value.tensor<float, 4>();
+    Tensor output(DT_FLOAT, TensorShape({batch, heads, q_len, value_size}));
+    auto out = output.tensor<float, 4>();
+    std::vector<float> scores(kv_len);
+    for (int64_t b = 0; b < batch; ++b) {
+      for (int64_t h = 0; h < heads; ++h) {
+        for (int64_t i = 0; i < q_len; ++i) {
+          float max_score = -std::numeric_limits<float>::infinity();
+          for (int64_t j = 0; j < kv_len; ++j) {
+            float dot = 0;
+            for (int64_t d = 0; d < head_size; ++d) {
+              dot += q(b, h, i, d) * k(b, h, j, d);
+            }
+            scores[j] = dot * scale;
+            if (mask != nullptr) {
+              scores[j] += mask->tensor<float, 4>()(b, 0, 0, j);
+            }
+            max_score = std::max(max_score, scores[j]);
+          }
+          float sum = 0;
+          for (int64_t j = 0; j < kv_len; ++j) {
+            scores[j] = std::exp(scores[j] - max_score);
+            sum += scores[j];
+          }
+          for (int64_t d = 0; d < value_size; ++d) {
+            float o = 0;
+            for (int64_t j = 0; j < kv_len; ++j) {
+              o += scores[j] / sum * v(b, h, j, d);
+            }
+            out(b, h, i, d) = o;
+          }
+        }
+      }
+    }
+    return output;
+  }
+};
+
+TEST_F(FusedMultiHeadAttentionOpTest, MaskedAttention) {
+  // Spans several blocks of queries and of keys.
+  const TensorShape query_shape({2, 3, 70, 16});
+  const TensorShape key_shape({2, 3, 300, 16});
+  const TensorShape value_shape({2, 3, 300, 8});
+  const Tensor query = Iota(query_shape, 0.1f);
+  const Tensor key = Iota(key_shape, 0.37f);
+  const Tensor value = Iota(value_shape, 0.05f);
+  Tensor mask(DT_FLOAT, TensorShape({2, 1, 1, 300}));
+  auto m = mask.flat<float>();
+  for (int64_t i = 0; i < m.size(); ++i) {
+    // Masks out the padding at the end of the second sequence.
+    m(i) = i >= 300 + 250 ? -10000.0f : 0.0f;
+  }
+  const float scale = 0.25f;
+
+  MakeOp(/*with_mask=*/true, scale);
+  AddInputFromArray<float>(query_shape, query.flat<float>());
+  AddInputFromArray<float>(key_shape, key.flat<float>());
+  AddInputFromArray<float>(value_shape, value.flat<float>());
+  AddInputFromArray<float>(mask.shape(), mask.flat<float>());
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(Reference(query, key, value, &mask, scale),
+                                *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedMultiHeadAttentionOpTest, SingleHead) {
+  const Tensor query = Iota(TensorShape({2, 5, 4}), 0.3f);
+  const Tensor key = Iota(TensorShape({2, 7, 4}), 0.7f);
+  const Tensor value = Iota(TensorShape({2, 7, 3}), 0.2f);
+
+  MakeOp(/*with_mask=*/false, /*scale=*/1.0f);
+  AddInputFromArray<float>(query.shape(), query.flat<float>());
+  AddInputFromArray<float>(key.shape(), key.flat<float>());
+  AddInputFromArray<float>(value.shape(), value.flat<float>());
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor query_4d(DT_FLOAT, TensorShape({2, 1, 5, 4}));
+  Tensor key_4d(DT_FLOAT, TensorShape({2, 1, 7, 4}));
+  Tensor value_4d(DT_FLOAT, TensorShape({2, 1, 7, 3}));
+  ASSERT_TRUE(query_4d.CopyFrom(query, query_4d.shape()));
+  ASSERT_TRUE(key_4d.CopyFrom(key, key_4d.shape()));
+  ASSERT_TRUE(value_4d.CopyFrom(value, value_4d.shape()));
+  Tensor expected;
+  ASSERT_TRUE(expected.CopyFrom(
+      Reference(query_4d, key_4d, value_4d, nullptr, 1.0f),
+      TensorShape({2, 5, 3})));
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedMultiHeadAttentionOpTest, FullyMaskedRowsAreNaN) {
+  MakeOp(/*with_mask=*/true, /*scale=*/1.0f);
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 2}), {1, 0, 0, 1});
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 1}), {5, 7});
+  const float inf = std::numeric_limits<float>::infinity();
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 2}), {0, -inf, -inf, -inf});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Like Softmax, which divides 0 by 0 for a row of -inf scores.
+  const auto output = GetOutput(0)->flat<float>();
+  EXPECT_NEAR(output(0), 5, 1e-6);
+  EXPECT_TRUE(std::isnan(output(1)));
+}
+
+TEST_F(FusedMultiHeadAttentionOpTest, MaskMustBroadcast) {
+  MakeOp(/*with_mask=*/true, /*scale=*/1.0f);
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 2}), {1, 0, 0, 1});
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 1}), {5, 7});
+  AddInputFromArray<float>(TensorShape({1, 1, 1, 3}), {0, 0, 0});
+  const Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  EXPECT_TRUE(absl::StrContains(status.message(), "can't be broadcast"))
+      << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -46,6 +46,7 @@ enum class FusedComputationType {
   kBiasAddWithLeakyRelu,
   kBiasAddWithGeluApproximate,
   kBiasAddWithGeluExact,
+  kBiasAddWithAdd,
   kFusedBatchNorm,
   kFusedBatchNormWithRelu,
   kFusedBatchNormWithRelu6,
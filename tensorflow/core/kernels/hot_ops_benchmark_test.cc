@@ -0,0 +1,252 @@
+/* Copyright 2026 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A curated matrix of benchmarks of the kernels that dominate typical training
+// and inference profiles, tracked for regressions by
+// //tensorflow/tools/test:hot_ops_benchmark. Shapes are kept fixed so that
+// results stay comparable across runs; add new cases rather than changing
+// existing ones.
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+template <typename T>
+Node* RandomConstant(Graph* g, const TensorShape& shape) {
+  Tensor data(DataTypeToEnum<T>::value, shape);
+  data.flat<T>().setRandom();
+  return test::graph::Constant(g, data);
+}
+
+Node* Int32Constant(Graph* g, const std::vector<int32>& values) {
+  Tensor data(DT_INT32, TensorShape({static_cast<int64_t>(values.size())}));
+  std::copy(values.begin(), values.end(), data.flat<int32>().data());
+  return test::graph::Constant(g, data);
+}
+
+// MatMul of [m, k] by [k, n].
+template <typename T>
+Graph* MatMul(int m, int k, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(g, RandomConstant<T>(g, TensorShape({m, k})),
+                      RandomConstant<T>(g, TensorShape({k, n})), false, false);
+  return g;
+}
+
+#define BM_HOT_MATMUL(DEVICE, T, M, K, N)                                   \
+  void BM_Hot_MatMul_##DEVICE##_##T##_##M##_##K##_##N(                      \
+      ::testing::benchmark::State& state) {                                 \
+    test::Benchmark(#DEVICE, MatMul<T>(M, K, N),                            \
+                    /*old_benchmark_api=*/false)                            \
+        .Run(state);                                                        \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * M *  \
+                            K * N * 2);                                     \
+  }                                                                         \
+  BENCHMARK(BM_Hot_MatMul_##DEVICE##_##T##_##M##_##K##_##N)->UseRealTime();
+
+#define BM_HOT_MATMUL_SHAPES(DEVICE, T)      \
+  BM_HOT_MATMUL(DEVICE, T, 1, 1024, 1024);   \
+  BM_HOT_MATMUL(DEVICE, T, 128, 1024, 1024); \
+  BM_HOT_MATMUL(DEVICE, T, 1024, 1024, 1024);
+
+BM_HOT_MATMUL_SHAPES(cpu, float);
+BM_HOT_MATMUL_SHAPES(cpu, bfloat16);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+BM_HOT_MATMUL_SHAPES(gpu, float);
+BM_HOT_MATMUL_SHAPES(gpu, half);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Conv2D of a [batch, size, size, depth] NHWC input with a
+// [filter, filter, depth, out_depth] filter, stride 1 and SAME padding.
+Graph* Conv2D(int batch, int size, int depth, int filter, int out_depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const TensorShape input_shape({batch, size, size, depth});
+  const TensorShape filter_shape({filter, filter, depth, out_depth});
+  test::graph::Conv2D(g, RandomConstant<float>(g, input_shape),
+                      RandomConstant<float>(g, filter_shape));
+  return g;
+}
+
+#define BM_HOT_CONV2D(DEVICE, B, S, D, F, O)                                 \
+  void BM_Hot_Conv2D_##DEVICE##_##B##_##S##_##D##_##F##_##O(                 \
+      ::testing::benchmark::State& state) {                                  \
+    test::Benchmark(#DEVICE, Conv2D(B, S, D, F, O),                          \
+                    /*old_benchmark_api=*/false)                             \
+        .Run(state);                                                         \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * B *   \
+                            S * S * D * F * F * O * 2);                      \
+  }                                                                          \
+  BENCHMARK(BM_Hot_Conv2D_##DEVICE##_##B##_##S##_##D##_##F##_##O)            \
+      ->UseRealTime();
+
+#define BM_HOT_CONV2D_SHAPES(DEVICE)        \
+  BM_HOT_CONV2D(DEVICE, 1, 224, 3, 7, 64);  \
+  BM_HOT_CONV2D(DEVICE, 32, 56, 64, 3, 64); \
+  BM_HOT_CONV2D(DEVICE, 32, 14, 256, 3, 256);
+
+BM_HOT_CONV2D_SHAPES(cpu);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+BM_HOT_CONV2D_SHAPES(gpu);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Gathers `num_indices` random rows of a [kEmbeddingRows, dim] table.
+constexpr int kEmbeddingRows = 100000;
+
+std::vector<int32> RandomRows(int num_indices) {
+  std::vector<int32> rows(num_indices);
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int32& row : rows) row = rnd.Uniform(kEmbeddingRows);
+  return rows;
+}
+
+Graph* Gather(int num_indices, int dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  test::graph::Gather(
+      g, RandomConstant<float>(g, TensorShape({kEmbeddingRows, dim})),
+      Int32Constant(g, RandomRows(num_indices)),
+      test::graph::Constant(g, axis));
+  return g;
+}
+
+#define BM_HOT_GATHER(DEVICE, N, D)                                          \
+  void BM_Hot_Gather_##DEVICE##_##N##_##D(                                   \
+      ::testing::benchmark::State& state) {                                  \
+    test::Benchmark(#DEVICE, Gather(N, D), /*old_benchmark_api=*/false)      \
+        .Run(state);                                                         \
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * N *   \
+                            D * sizeof(float));                              \
+  }                                                                          \
+  BENCHMARK(BM_Hot_Gather_##DEVICE##_##N##_##D)->UseRealTime();
+
+#define BM_HOT_GATHER_SHAPES(DEVICE) \
+  BM_HOT_GATHER(DEVICE, 128, 64);    \
+  BM_HOT_GATHER(DEVICE, 4096, 64);   \
+  BM_HOT_GATHER(DEVICE, 4096, 512);
+
+BM_HOT_GATHER_SHAPES(cpu);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+BM_HOT_GATHER_SHAPES(gpu);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Sums `num_indices` random rows of a [kEmbeddingRows, dim] table into
+// segments of 8 rows each, as for a bag of embeddings.
+Graph* SparseSegmentSum(int num_indices, int dim) {
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<int32> segment_ids(num_indices);
+  for (int i = 0; i < num_indices; ++i) segment_ids[i] = i / 8;
+  Node* ret;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+          .Input(RandomConstant<float>(g, TensorShape({kEmbeddingRows, dim})))
+          .Input(Int32Constant(g, RandomRows(num_indices)))
+          .Input(Int32Constant(g, segment_ids))
+          .Finalize(g, &ret));
+  return g;
+}
+
+#define BM_HOT_SPARSE_SEGMENT_SUM(DEVICE, N, D)                              \
+  void BM_Hot_SparseSegmentSum_##DEVICE##_##N##_##D(                         \
+      ::testing::benchmark::State& state) {                                  \
+    test::Benchmark(#DEVICE, SparseSegmentSum(N, D),                         \
+                    /*old_benchmark_api=*/false)                             \
+        .Run(state);                                                         \
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * N *   \
+                            D * sizeof(float));                              \
+  }                                                                          \
+  BENCHMARK(BM_Hot_SparseSegmentSum_##DEVICE##_##N##_##D)->UseRealTime();
+
+#define BM_HOT_SPARSE_SEGMENT_SUM_SHAPES(DEVICE) \
+  BM_HOT_SPARSE_SEGMENT_SUM(DEVICE, 1024, 64);   \
+  BM_HOT_SPARSE_SEGMENT_SUM(DEVICE, 65536, 64);
+
+BM_HOT_SPARSE_SEGMENT_SUM_SHAPES(cpu);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+BM_HOT_SPARSE_SEGMENT_SUM_SHAPES(gpu);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Softmax over the classes of a [batch, classes] tensor.
+template <typename T>
+Graph* Softmax(int batch, int classes) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, "Softmax",
+                     RandomConstant<T>(g, TensorShape({batch, classes})));
+  return g;
+}
+
+#define BM_HOT_SOFTMAX(DEVICE, T, B, C)                                      \
+  void BM_Hot_Softmax_##DEVICE##_##T##_##B##_##C(                            \
+      ::testing::benchmark::State& state) {                                  \
+    test::Benchmark(#DEVICE, Softmax<T>(B, C), /*old_benchmark_api=*/false)  \
+        .Run(state);                                                         \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * B *   \
+                            C);                                              \
+  }                                                                          \
+  BENCHMARK(BM_Hot_Softmax_##DEVICE##_##T##_##B##_##C)->UseRealTime();
+
+#define BM_HOT_SOFTMAX_SHAPES(DEVICE, T)  \
+  BM_HOT_SOFTMAX(DEVICE, T, 128, 1000);   \
+  BM_HOT_SOFTMAX(DEVICE, T, 1024, 32000);
+
+BM_HOT_SOFTMAX_SHAPES(cpu, float);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+BM_HOT_SOFTMAX_SHAPES(gpu, float);
+BM_HOT_SOFTMAX_SHAPES(gpu, half);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// Transposes an NHWC [batch, size, size, depth] tensor to NCHW.
+Graph* Transpose(int batch, int size, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Binary(
+      g, "Transpose",
+      RandomConstant<float>(g, TensorShape({batch, size, size, depth})),
+      Int32Constant(g, {0, 3, 1, 2}));
+  return g;
+}
+
+#define BM_HOT_TRANSPOSE(DEVICE, B, S, D)                                    \
+  void BM_Hot_Transpose_##DEVICE##_##B##_##S##_##D(                          \
+      ::testing::benchmark::State& state) {                                  \
+    test::Benchmark(#DEVICE, Transpose(B, S, D),                             \
+                    /*old_benchmark_api=*/false)                             \
+        .Run(state);                                                         \
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * B *   \
+                            S * S * D * sizeof(float));                      \
+  }                                                                          \
+  BENCHMARK(BM_Hot_Transpose_##DEVICE##_##B##_##S##_##D)->UseRealTime();
+
+#define BM_HOT_TRANSPOSE_SHAPES(DEVICE)  \
+  BM_HOT_TRANSPOSE(DEVICE, 32, 56, 64);  \
+  BM_HOT_TRANSPOSE(DEVICE, 32, 14, 256);
+
+BM_HOT_TRANSPOSE_SHAPES(cpu);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+BM_HOT_TRANSPOSE_SHAPES(gpu);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,11 +15,13 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #define EIGEN_USE_THREADS
 
@@ -75,6 +77,18 @@ FileFormat ClassifyFileFormat(StringPiece data) {
   return kUnknownFormat;
 }
 
+// Returns the largest JPEG scaling denominator that still decodes a region of
+// `height` x `width` pixels to at least `min_height` x `min_width` pixels.
+int ScaledDecodeRatio(int height, int width, int min_height, int min_width) {
+  for (const int ratio : {8, 4, 2}) {
+    if ((height + ratio - 1) / ratio >= min_height &&
+        (width + ratio - 1) / ratio >= min_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
 // Decode an image. Supported image formats are JPEG, PNG, GIF and BMP. This is
 // a newer version of `DecodeImageOp` for enabling image data parsing to take
 // place in kernels only, reducing security vulnerabilities and redundancy.
@@ -129,6 +143,19 @@ class DecodeImageV2Op : public OpKernel {
       } else if (dct_method == "INTEGER_ACCURATE") {
         flags_.dct_method = JDCT_ISLOW;
       }
+      // Set by the `scaled_jpeg_decode` tf.data rewrite when the image is
+      // only resized to at least this [height, width] afterwards.
+      std::vector<int32> min_output_size;
+      if (flags_.ratio == 1 &&
+          context->GetAttr("_min_output_size", &min_output_size).ok()) {
+        OP_REQUIRES(context,
+                    min_output_size.size() == 2 && min_output_size[0] > 0 &&
+                        min_output_size[1] > 0,
+                    errors::InvalidArgument(
+                        "_min_output_size must be a positive [height, width]"));
+        min_output_height_ = min_output_size[0];
+        min_output_width_ = min_output_size[1];
+      }
     } else {
       flags_ = jpeg::UncompressFlags();
       flags_.dct_method = JDCT_IFAST;
@@ -262,6 +289,8 @@ class DecodeImageV2Op : public OpKernel {
                       "`decode_jpeg` or `decode_image` instead."));
     }
 
+    if (min_output_height_ > 0) ScaleDecode(input, &flags);
+
     // Output tensor and the image buffer size.
     Tensor* output = nullptr;
     int buffer_size = 0;
@@ -327,6 +356,47 @@ class DecodeImageV2Op : public OpKernel {
     }
   }
 
+  // Lets libjpeg scale the DCT down to the smallest output that is still at
+  // least `min_output_height_` x `min_output_width_`, moving the crop window
+  // into the scaled coordinates. Images whose header or crop window is invalid
+  // are left for `jpeg::Uncompress` to reject.
+  void ScaleDecode(StringPiece input, jpeg::UncompressFlags* flags) {
+    int width = 0;
+    int height = 0;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                            nullptr)) {
+      return;
+    }
+    int region_height = height;
+    int region_width = width;
+    if (flags->crop) {
+      if (flags->crop_height <= 0 || flags->crop_width <= 0 ||
+          flags->crop_y < 0 || flags->crop_x < 0 ||
+          flags->crop_y + flags->crop_height > height ||
+          flags->crop_x + flags->crop_width > width) {
+        return;
+      }
+      region_height = flags->crop_height;
+      region_width = flags->crop_width;
+    }
+    const int ratio = ScaledDecodeRatio(region_height, region_width,
+                                        min_output_height_, min_output_width_);
+    if (ratio == 1) return;
+    flags->ratio = ratio;
+    if (flags->crop) {
+      auto scale_down = [ratio](int x) { return x / ratio; };
+      auto scale_up = [ratio](int x) { return (x + ratio - 1) / ratio; };
+      const int y_end = std::min(scale_up(flags->crop_y + flags->crop_height),
+                                 scale_up(height));
+      const int x_end = std::min(scale_up(flags->crop_x + flags->crop_width),
+                                 scale_up(width));
+      flags->crop_y = scale_down(flags->crop_y);
+      flags->crop_x = scale_down(flags->crop_x);
+      flags->crop_height = y_end - flags->crop_y;
+      flags->crop_width = x_end - flags->crop_x;
+    }
+  }
+
   void DecodePngV2(OpKernelContext* context, StringPiece input) {
     int channel_bits = (data_type_ == DataType::DT_UINT8) ? 8 : 16;
     png::DecodeContext decode;
@@ -675,6 +745,9 @@ class DecodeImageV2Op : public OpKernel {
   DataType data_type_ = DataType::DT_UINT8;
   bool expand_animations_ = true;
   jpeg::UncompressFlags flags_;
+  // Minimum size of a JPEG output, or 0 to decode at the scale of `flags_`.
+  int min_output_height_ = 0;
+  int min_output_width_ = 0;
   string op_type_;
 };
 
@@ -0,0 +1,233 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/image/decode_jpeg_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// The first bytes of a JPEG file, see decode_image_op.cc.
+constexpr char kJpegMagicBytes[] = "\xff\xd8\xff";
+
+// Decodes a JPEG image into device memory, so that the images fed to a model
+// on a GPU do not take up host threads for their decoding and never land in
+// host memory. libjpeg still entropy decodes the data on the host, which is
+// inherently sequential, but the inverse DCT, upsampling and color conversion
+// that dominate the decoding run on the GPU, and only the compact quantized
+// coefficients are copied to it.
+//
+// Images that the GPU kernels do not support (ratio > 1, CMYK, unusual
+// subsampling, corrupt or truncated data) are decoded on the host as by the
+// CPU kernel and copied to the device. The GPU decoding uses a floating point
+// inverse DCT, whose results may differ from those of the integer methods of
+// `dct_method` by a unit, as they do from one another.
+//
+// The kernel has a lower priority than the CPU one, so the op only runs on a
+// GPU when placed there, e.g. in the input stage of a model, with the
+// encoded images coming from a tf.data pipeline.
+class DecodeJpegGpuOp : public OpKernel {
+ public:
+  explicit DecodeJpegGpuOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 0 || channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 0, 1, or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("ratio", &flags_.ratio));
+    OP_REQUIRES(context,
+                flags_.ratio == 1 || flags_.ratio == 2 || flags_.ratio == 4 ||
+                    flags_.ratio == 8,
+                errors::InvalidArgument("ratio must be 1, 2, 4, or 8, got ",
+                                        flags_.ratio));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    flags_.components = channels_;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(contents.shape()),
+        errors::InvalidArgument("`contents` must be scalar but got shape",
+                                contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, !input.empty(),
+                errors::InvalidArgument("Input is empty."));
+    OP_REQUIRES(context, absl::StartsWith(input, kJpegMagicBytes),
+                errors::InvalidArgument(
+                    "DecodeJpeg on GPU only decodes JPEG data. Place the op on "
+                    "the CPU to decode other image formats."));
+
+    bool decoded = false;
+    if (flags_.ratio == 1) {
+      OP_REQUIRES_OK(context, DecodeOnDevice(context, input, &decoded));
+    }
+    if (!decoded) DecodeOnHost(context, input);
+  }
+
+ private:
+  // Sets `decoded` to false if the image has to be decoded on the host
+  // instead.
+  Status DecodeOnDevice(OpKernelContext* context, StringPiece input,
+                        bool* decoded) {
+    AllocatorAttributes pinned;
+    pinned.set_on_host(true);
+    pinned.set_gpu_compatible(true);
+    jpeg::Coefficients coefficients;
+    Tensor blocks_host;
+    Status status;
+    if (!jpeg::ReadCoefficients(
+            input.data(), input.size(), &coefficients,
+            [&](int64_t num_blocks) -> int16* {
+              status = context->allocate_temp(
+                  DT_INT16, TensorShape({num_blocks, 64}), &blocks_host,
+                  pinned);
+              return status.ok() ? blocks_host.flat<int16>().data() : nullptr;
+            })) {
+      *decoded = false;
+      return status;
+    }
+
+    functor::JpegImage image;
+    image.width = coefficients.width;
+    image.height = coefficients.height;
+    image.num_components = coefficients.components.size();
+    image.num_blocks = blocks_host.dim_size(0);
+    for (int c = 0; c < image.num_components; ++c) {
+      const jpeg::Coefficients::Component& from = coefficients.components[c];
+      functor::JpegComponent& to = image.components[c];
+      to.h_factor = coefficients.max_h_samp_factor / from.h_samp_factor;
+      to.v_factor = coefficients.max_v_samp_factor / from.v_samp_factor;
+      to.width = from.width;
+      to.height = from.height;
+      to.width_in_blocks = from.width_in_blocks;
+      to.block_offset = from.block_offset;
+      std::copy(from.quant_table, from.quant_table + 64, to.quant_table);
+    }
+    const int channels = channels_ == 0 ? image.num_components : channels_;
+
+    *decoded = true;
+    Tensor* output = nullptr;
+    TF_RETURN_IF_ERROR(context->allocate_output(
+        0, TensorShape({image.height, image.width, channels}), &output));
+    Tensor blocks;
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(DT_INT16, blocks_host.shape(), &blocks));
+    Tensor samples;
+    TF_RETURN_IF_ERROR(context->allocate_temp(
+        DT_UINT8, TensorShape({image.num_blocks * 64}), &samples));
+
+    TF_RETURN_IF_ERROR(CopyToDevice(context, blocks_host, &blocks));
+    functor::DecodeJpegCoefficients<GPUDevice> decode;
+    return decode(context->eigen_device<GPUDevice>(), image, channels,
+                  flags_.fancy_upscaling, blocks.flat<int16>().data(),
+                  samples.flat<uint8>().data(), output->flat<uint8>().data());
+  }
+
+  void DecodeOnHost(OpKernelContext* context, StringPiece input) {
+    AllocatorAttributes pinned;
+    pinned.set_on_host(true);
+    pinned.set_gpu_compatible(true);
+    Tensor* output = nullptr;
+    Tensor image_host;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags_, nullptr /* nwarn */,
+        [&](int width, int height, int channels) -> uint8* {
+          const TensorShape shape({height, width, channels});
+          Status status = context->allocate_output(0, shape, &output);
+          if (status.ok()) {
+            status = context->allocate_temp(DT_UINT8, shape, &image_host,
+                                            pinned);
+          }
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return image_host.flat<uint8>().data();
+        });
+    OP_REQUIRES(
+        context, buffer,
+        errors::InvalidArgument(
+            "jpeg::Uncompress failed. Invalid JPEG data or crop window."));
+    OP_REQUIRES_OK(context, CopyToDevice(context, image_host, output));
+  }
+
+  // Enqueues the copy of `host` into `device` and keeps the buffer of `host`
+  // alive until it completes.
+  static Status CopyToDevice(OpKernelContext* context, const Tensor& host,
+                             Tensor* device) {
+    se::Stream* stream = context->op_device_context()->stream();
+    if (stream == nullptr) return errors::Internal("No GPU stream available.");
+    const uint64_t size = host.TotalBytes();
+    if (size == 0) return OkStatus();
+    se::DeviceMemoryBase device_memory(device->data(), size);
+    TF_RETURN_IF_ERROR(stream->Memcpy(&device_memory, host.data(), size));
+    context->device()
+        ->tensorflow_accelerator_device_info()
+        ->event_mgr->ThenExecute(stream, [host]() {});
+    return OkStatus();
+  }
+
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+}  // namespace
+
+REGISTER_KERNEL_BUILDER(
+    Name("DecodeJpeg").Device(DEVICE_GPU).HostMemory("contents").Priority(-1),
+    DecodeJpegGpuOp);
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
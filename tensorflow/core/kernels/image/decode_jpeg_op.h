@@ -0,0 +1,70 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_IMAGE_DECODE_JPEG_OP_H_
+#define TENSORFLOW_CORE_KERNELS_IMAGE_DECODE_JPEG_OP_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace functor {
+
+// Grayscale images have one component, color images Y, Cb and Cr.
+constexpr int kMaxJpegComponents = 3;
+
+// A component of a JPEG image, whose 8x8 blocks of samples are stored one
+// after the other in the blocks of DCT coefficients and, once decoded, as
+// rows of width_in_blocks * 8 samples.
+struct JpegComponent {
+  // The factors by which the component is subsampled: 1 or 2.
+  int h_factor = 1;
+  int v_factor = 1;
+  // The size of the component in samples and in blocks.
+  int width = 0;
+  int height = 0;
+  int width_in_blocks = 0;
+  int64_t block_offset = 0;
+  // The quantization table, in natural order.
+  uint16 quant_table[64] = {};
+};
+
+struct JpegImage {
+  int width = 0;
+  int height = 0;
+  int num_components = 0;
+  JpegComponent components[kMaxJpegComponents];
+  int64_t num_blocks = 0;
+};
+
+template <typename Device>
+struct DecodeJpegCoefficients {
+  // Decodes the [height, width, channels] image from the quantized DCT
+  // coefficients of its [num_blocks, 64] blocks: dequantizes them and
+  // computes their inverse DCT into `samples`, which holds num_blocks * 64
+  // samples, then upsamples the subsampled components and converts the colors
+  // to RGB or grayscale as libjpeg does.
+  Status operator()(const Device& d, const JpegImage& image, int channels,
+                    bool fancy_upscaling, const int16* blocks, uint8* samples,
+                    uint8* output);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_IMAGE_DECODE_JPEG_OP_H_
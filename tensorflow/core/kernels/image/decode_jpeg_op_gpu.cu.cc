@@ -0,0 +1,199 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc.
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/kernels/image/decode_jpeg_op.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+using functor::JpegComponent;
+using functor::JpegImage;
+
+__device__ inline uint8 ClampToUint8(int value) {
+  return static_cast<uint8>(min(max(value, 0), 255));
+}
+
+// Decodes a block of 8x8 samples per iteration, with a thread per sample:
+// dequantizes the coefficients of the block and computes their separable
+// inverse DCT, first along the rows and then along the columns.
+__global__ void __launch_bounds__(64)
+    JpegInverseDctKernel(const JpegImage image,
+                         const int16* __restrict__ blocks,  // [num_blocks, 64]
+                         uint8* __restrict__ samples) {
+  // cos_table[u][x] = C(u) / 2 * cos((2x + 1) u pi / 16), where C(0) is
+  // 1/sqrt(2) and C(u) is 1 otherwise, so that the 2D inverse DCT of F is
+  // f(y, x) = sum_{v,u} cos_table[v][y] * cos_table[u][x] * F(v, u).
+  __shared__ float cos_table[8][8];
+  __shared__ float coefficients[8][8];
+  __shared__ float row_sums[8][8];
+  const int x = threadIdx.x;
+  const int y = threadIdx.y;
+  cos_table[y][x] = (y == 0 ? static_cast<float>(M_SQRT1_2) : 1.0f) * 0.5f *
+                    cosf((2 * x + 1) * y * static_cast<float>(M_PI) / 16);
+
+  for (int64_t block = blockIdx.x; block < image.num_blocks;
+       block += gridDim.x) {
+    int c = 0;
+    while (c + 1 < image.num_components &&
+           block >= image.components[c + 1].block_offset) {
+      ++c;
+    }
+    const JpegComponent& component = image.components[c];
+    coefficients[y][x] = static_cast<float>(blocks[block * 64 + y * 8 + x]) *
+                         component.quant_table[y * 8 + x];
+    __syncthreads();
+
+    float sum = 0;
+    for (int u = 0; u < 8; ++u) sum += cos_table[u][x] * coefficients[y][u];
+    row_sums[y][x] = sum;
+    __syncthreads();
+
+    sum = 0;
+    for (int v = 0; v < 8; ++v) sum += cos_table[v][y] * row_sums[v][x];
+    const int64_t index = block - component.block_offset;
+    const int64_t block_x = index % component.width_in_blocks;
+    const int64_t block_y = index / component.width_in_blocks;
+    const int64_t stride = component.width_in_blocks * 8;
+    samples[component.block_offset * 64 + (block_y * 8 + y) * stride +
+            block_x * 8 + x] = ClampToUint8(__float2int_rn(sum) + 128);
+    __syncthreads();
+  }
+}
+
+// Returns the sample of `component` at pixel (x, y) of the image. Subsampled
+// components are upsampled by replicating their samples or, if
+// `fancy_upscaling`, with the triangle filters of libjpeg.
+__device__ int UpsampledSample(const JpegComponent& component,
+                               const uint8* __restrict__ samples, int x, int y,
+                               bool fancy_upscaling) {
+  const uint8* plane = samples + component.block_offset * 64;
+  const int64_t stride = component.width_in_blocks * 8;
+  const int cx = x / component.h_factor;
+  const int cy = y / component.v_factor;
+  const auto at = [&](int row, int col) -> int {
+    return plane[row * stride + col];
+  };
+  // As in libjpeg, components that are at most 2 samples wide are never
+  // upsampled with the triangle filters.
+  if (!fancy_upscaling || component.width <= 2 ||
+      (component.h_factor == 1 && component.v_factor == 1)) {
+    return at(cy, cx);
+  }
+  // The row of samples the output row lies closest to after `cy`, replicating
+  // the edge rows.
+  const bool upper = y % component.v_factor == 0;
+  const int next_cy =
+      upper ? max(cy - 1, 0) : min(cy + 1, component.height - 1);
+
+  if (component.v_factor == 1) {
+    // h2v1: horizontal triangle filter.
+    const int value = at(cy, cx);
+    if (x % 2 == 0) {
+      return cx == 0 ? value : (value * 3 + at(cy, cx - 1) + 1) >> 2;
+    }
+    return cx == component.width - 1 ? value
+                                     : (value * 3 + at(cy, cx + 1) + 2) >> 2;
+  }
+  if (component.h_factor == 1) {
+    // h1v2: vertical triangle filter.
+    return (at(cy, cx) * 3 + at(next_cy, cx) + (upper ? 1 : 2)) >> 2;
+  }
+  // h2v2: vertical, then horizontal triangle filter.
+  const auto column_sum = [&](int col) {
+    return at(cy, col) * 3 + at(next_cy, col);
+  };
+  const int value = column_sum(cx);
+  if (x % 2 == 0) {
+    return cx == 0 ? (value * 4 + 8) >> 4
+                   : (value * 3 + column_sum(cx - 1) + 8) >> 4;
+  }
+  return cx == component.width - 1 ? (value * 4 + 7) >> 4
+                                   : (value * 3 + column_sum(cx + 1) + 7) >> 4;
+}
+
+// Upsamples the components and converts them to `channels` channels per
+// pixel, with a thread per pixel.
+__global__ void JpegColorConvertKernel(const JpegImage image, int channels,
+                                       bool fancy_upscaling,
+                                       const uint8* __restrict__ samples,
+                                       uint8* __restrict__ output) {
+  const int64_t num_pixels = static_cast<int64_t>(image.width) * image.height;
+  GPU_1D_KERNEL_LOOP(pixel, num_pixels) {
+    const int x = pixel % image.width;
+    const int y = pixel / image.width;
+    const int luma = UpsampledSample(image.components[0], samples, x, y,
+                                     fancy_upscaling);
+    uint8* out = output + pixel * channels;
+    if (channels == 1 || image.num_components == 1) {
+      // Grayscale is the luma of color images, replicated for RGB.
+      for (int i = 0; i < channels; ++i) out[i] = ClampToUint8(luma);
+      continue;
+    }
+    const float cb = UpsampledSample(image.components[1], samples, x, y,
+                                     fancy_upscaling) -
+                     128;
+    const float cr = UpsampledSample(image.components[2], samples, x, y,
+                                     fancy_upscaling) -
+                     128;
+    // The JFIF conversion with the rounding of libjpeg.
+    out[0] = ClampToUint8(luma + __float2int_rd(1.40200f * cr + 0.5f));
+    out[1] = ClampToUint8(
+        luma + __float2int_rd(-0.34414f * cb - 0.71414f * cr + 0.5f));
+    out[2] = ClampToUint8(luma + __float2int_rd(1.77200f * cb + 0.5f));
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename Device>
+Status DecodeJpegCoefficients<Device>::operator()(
+    const Device& d, const JpegImage& image, int channels,
+    bool fancy_upscaling, const int16* blocks, uint8* samples, uint8* output) {
+  if (image.num_blocks == 0) return OkStatus();
+  const int idct_blocks = static_cast<int>(std::min<int64_t>(
+      image.num_blocks, std::numeric_limits<int>::max()));
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(JpegInverseDctKernel, idct_blocks,
+                                     dim3(8, 8), 0, d.stream(), image, blocks,
+                                     samples));
+
+  const int64_t num_pixels = static_cast<int64_t>(image.width) * image.height;
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_pixels, d);
+  return GpuLaunchKernel(JpegColorConvertKernel, config.block_count,
+                         config.thread_per_block, 0, d.stream(), image,
+                         channels, fancy_upscaling, samples, output);
+}
+
+template struct DecodeJpegCoefficients<GPUDevice>;
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
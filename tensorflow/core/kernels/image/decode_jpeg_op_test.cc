@@ -0,0 +1,179 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace {
+
+// The GPU kernel uses a floating point inverse DCT, the CPU kernel the
+// integer one of libjpeg, so their samples may differ slightly.
+constexpr int kTolerance = 3;
+
+// An odd size, so that the last blocks and chroma samples are partial.
+constexpr int kWidth = 67;
+constexpr int kHeight = 45;
+
+// Returns a JPEG image of a smooth pattern with `components` channels.
+tstring EncodeTestImage(int components, bool chroma_downsampling) {
+  std::vector<uint8> pixels(kWidth * kHeight * components);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      for (int c = 0; c < components; ++c) {
+        pixels[(y * kWidth + x) * components + c] =
+            (x * 3 + y * 5 + c * 70) % 256;
+      }
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = components == 1 ? jpeg::FORMAT_GRAYSCALE : jpeg::FORMAT_RGB;
+  flags.quality = 90;
+  flags.chroma_downsampling = chroma_downsampling;
+  return jpeg::Compress(pixels.data(), kWidth, kHeight, flags);
+}
+
+// Decodes `contents` as the CPU kernel does with dct_method
+// "INTEGER_ACCURATE".
+Tensor DecodeOnCpu(const tstring& contents, int channels, int ratio,
+                   bool fancy_upscaling) {
+  jpeg::UncompressFlags flags;
+  flags.components = channels;
+  flags.ratio = ratio;
+  flags.fancy_upscaling = fancy_upscaling;
+  flags.dct_method = JDCT_ISLOW;
+  Tensor image;
+  uint8* buffer = jpeg::Uncompress(
+      contents.data(), contents.size(), flags, /*nwarn=*/nullptr,
+      [&](int width, int height, int components) {
+        image = Tensor(DT_UINT8, TensorShape({height, width, components}));
+        return image.flat<uint8>().data();
+      });
+  CHECK(buffer != nullptr);
+  return image;
+}
+
+class DecodeJpegGpuOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int channels, int ratio, bool fancy_upscaling) {
+    SetDevice(DEVICE_GPU,
+              std::unique_ptr<tensorflow::Device>(DeviceFactory::NewDevice(
+                  "GPU", {}, "/job:a/replica:0/task:0")));
+    TF_ASSERT_OK(NodeDefBuilder("decode_jpeg_op", "DecodeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Attr("channels", channels)
+                     .Attr("ratio", ratio)
+                     .Attr("fancy_upscaling", fancy_upscaling)
+                     .Attr("dct_method", "INTEGER_ACCURATE")
+                     .Device(DEVICE_GPU)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Decodes `contents` with the GPU kernel and checks that the image matches
+  // the one the CPU kernel decodes within `tolerance`.
+  void ExpectCpuParity(const tstring& contents, int channels, int ratio,
+                       bool fancy_upscaling, int tolerance) {
+    MakeOp(channels, ratio, fancy_upscaling);
+    AddInputFromArray<tstring>(TensorShape({}), {contents});
+    TF_ASSERT_OK(RunOpKernel());
+    const Tensor& gpu = *GetOutput(0);
+    const Tensor cpu = DecodeOnCpu(contents, channels, ratio, fancy_upscaling);
+    ASSERT_EQ(gpu.shape(), cpu.shape());
+    const auto gpu_samples = gpu.flat<uint8>();
+    const auto cpu_samples = cpu.flat<uint8>();
+    int max_difference = 0;
+    for (int64_t i = 0; i < cpu_samples.size(); ++i) {
+      max_difference = std::max(
+          max_difference, std::abs(gpu_samples(i) - cpu_samples(i)));
+    }
+    EXPECT_LE(max_difference, tolerance);
+  }
+};
+
+TEST_F(DecodeJpegGpuOpTest, Subsampled420) {
+  const tstring contents =
+      EncodeTestImage(/*components=*/3, /*chroma_downsampling=*/true);
+  ExpectCpuParity(contents, /*channels=*/3, /*ratio=*/1,
+                  /*fancy_upscaling=*/true, kTolerance);
+}
+
+TEST_F(DecodeJpegGpuOpTest, Subsampled420WithoutFancyUpscaling) {
+  const tstring contents =
+      EncodeTestImage(/*components=*/3, /*chroma_downsampling=*/true);
+  ExpectCpuParity(contents, /*channels=*/3, /*ratio=*/1,
+                  /*fancy_upscaling=*/false, kTolerance);
+}
+
+TEST_F(DecodeJpegGpuOpTest, NotSubsampled444) {
+  const tstring contents =
+      EncodeTestImage(/*components=*/3, /*chroma_downsampling=*/false);
+  ExpectCpuParity(contents, /*channels=*/3, /*ratio=*/1,
+                  /*fancy_upscaling=*/true, kTolerance);
+}
+
+TEST_F(DecodeJpegGpuOpTest, Grayscale) {
+  const tstring contents =
+      EncodeTestImage(/*components=*/1, /*chroma_downsampling=*/false);
+  ExpectCpuParity(contents, /*channels=*/0, /*ratio=*/1,
+                  /*fancy_upscaling=*/true, kTolerance);
+}
+
+TEST_F(DecodeJpegGpuOpTest, ColorToGrayscale) {
+  const tstring contents =
+      EncodeTestImage(/*components=*/3, /*chroma_downsampling=*/true);
+  ExpectCpuParity(contents, /*channels=*/1, /*ratio=*/1,
+                  /*fancy_upscaling=*/true, kTolerance);
+}
+
+// Scaled decoding is done on the host, exactly as on the CPU.
+TEST_F(DecodeJpegGpuOpTest, FallsBackToHostForRatio) {
+  const tstring contents =
+      EncodeTestImage(/*components=*/3, /*chroma_downsampling=*/true);
+  ExpectCpuParity(contents, /*channels=*/3, /*ratio=*/2,
+                  /*fancy_upscaling=*/true, /*tolerance=*/0);
+}
+
+TEST_F(DecodeJpegGpuOpTest, RejectsCorruptData) {
+  tstring contents =
+      EncodeTestImage(/*components=*/3, /*chroma_downsampling=*/true);
+  contents.resize(contents.size() / 2);
+  MakeOp(/*channels=*/3, /*ratio=*/1, /*fancy_upscaling=*/true);
+  AddInputFromArray<tstring>(TensorShape({}), {contents});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -18,6 +18,7 @@ limitations under the License.
 #include <unordered_set>
 
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
 
 namespace tensorflow {
 
@@ -64,6 +65,12 @@ class MemmappedTensorAllocator : public Allocator {
 
   void set_delete_on_deallocate() { delete_on_deallocate_ = true; }
 
+  // Returns the whole memory region, e.g. to decode a string tensor from it.
+  StringPiece region_data() const {
+    return StringPiece(static_cast<const char*>(memory_region_->data()),
+                       memory_region_->length());
+  }
+
   // Make sure tensors or complex types (strings, variants, resources) don't get
   // their constructor called via a placement new since that would require
   // writing to immutable data.
@@ -82,6 +89,35 @@ class MemmappedTensorAllocator : public Allocator {
   MemmappedTensorAllocator(const MemmappedTensorAllocator&) = delete;
   void operator=(const MemmappedTensorAllocator&) = delete;
 };
+
+// Decodes a string tensor saved by MemmappedFileSystemWriter: a table of
+// num_elements + 1 little-endian uint64 offsets into the string bytes that
+// follow it.
+Status DecodeStringTensor(StringPiece data, Tensor* tensor) {
+  auto strings = tensor->flat<tstring>();
+  const uint64 table_size = (strings.size() + 1) * sizeof(uint64);
+  if (data.size() < table_size) {
+    return errors::DataLoss("Readonly memory region of ", data.size(),
+                            " bytes is too small for the offsets of ",
+                            strings.size(), " strings");
+  }
+  const uint64 bytes_size = data.size() - table_size;
+  uint64 start = core::DecodeFixed64(data.data());
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    const uint64 limit =
+        core::DecodeFixed64(data.data() + (i + 1) * sizeof(uint64));
+    if (start > limit || limit > bytes_size) {
+      return errors::DataLoss("Invalid offsets [", start, ", ", limit,
+                              ") of string ", i,
+                              " in readonly memory region of ", bytes_size,
+                              " string bytes");
+    }
+    strings(i).assign(data.data() + table_size + start, limit - start);
+    start = limit;
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 ImmutableConstantOp::ImmutableConstantOp(OpKernelConstruction* context)
@@ -101,9 +137,15 @@ void ImmutableConstantOp::Compute(OpKernelContext* ctx) {
 
   OP_REQUIRES_OK(ctx,
                  allocator->InitializeFromRegion(region_name_, ctx->env()));
-  OP_REQUIRES(ctx, dtype_ != DT_STRING,
-              errors::Unimplemented("Sorry, DT_STRING is not currently "
-                                    "supported for ImmutableConstOp."));
+  if (dtype_ == DT_STRING) {
+    // The string bytes are copied out of the region, since tstrings can not
+    // be placed in read-only memory.
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, shape_, &output));
+    OP_REQUIRES_OK(ctx,
+                   DecodeStringTensor(allocator->region_data(), output));
+    return;
+  }
   ctx->set_output(0, Tensor(allocator.get(), dtype_, shape_));
   OP_REQUIRES_OK(ctx, allocator->allocation_status());
   // Allocator is owned by the tensor from this point.
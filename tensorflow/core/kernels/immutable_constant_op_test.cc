@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
@@ -27,6 +28,8 @@ limitations under the License.
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+#include "tensorflow/core/util/memmapped_file_system_writer.h"
 
 namespace tensorflow {
 namespace {
@@ -202,7 +205,7 @@ Status CreateTempFileBadString(Env* env, char value, uint64 size,
   return absl::OkStatus();
 }
 
-TEST(ImmutableConstantOpTest, FromFileStringUnimplmented) {
+TEST(ImmutableConstantOpTest, FromFileStringCorrupted) {
   const TensorShape kFileTensorShape({1});
   Env* env = Env::Default();
   auto root = Scope::NewRootScope().ExitOnError();
@@ -222,7 +225,37 @@ TEST(ImmutableConstantOpTest, FromFileStringUnimplmented) {
   // Check that the run returned error.
   EXPECT_EQ(
       session->Run({}, {result.node()->name() + ":0"}, {}, &outputs).code(),
-      error::UNIMPLEMENTED);
+      error::DATA_LOSS);
+}
+
+TEST(ImmutableConstantOpTest, FromMemmappedFileString) {
+  const string region_name =
+      strings::StrCat(MemmappedFileSystem::kMemmappedPackagePrefix, "strings");
+  Tensor strings(DT_STRING, TensorShape({2, 2}));
+  test::FillValues<tstring>(&strings, {"a", "", "bcd", string(1000, 'e')});
+  const string filename = io::JoinPath(testing::TmpDir(), "memmapped_strings");
+  MemmappedFileSystemWriter writer;
+  TF_ASSERT_OK(writer.InitializeToFile(Env::Default(), filename));
+  TF_ASSERT_OK(writer.SetTensorAlignment(kTestAlignment));
+  TF_ASSERT_OK(writer.SaveTensor(strings, region_name));
+  TF_ASSERT_OK(writer.FlushAndClose());
+  MemmappedEnv memmapped_env(Env::Default());
+  TF_ASSERT_OK(memmapped_env.InitializeFromFile(filename));
+
+  auto root = Scope::NewRootScope().ExitOnError();
+  auto result = ops::ImmutableConst(root, DT_STRING, strings.shape(),
+                                    region_name);
+  GraphDef graph_def;
+  TF_ASSERT_OK(root.ToGraphDef(&graph_def));
+  SessionOptions session_options;
+  session_options.env = &memmapped_env;
+  std::unique_ptr<Session> session(NewSession(session_options));
+  ASSERT_TRUE(session != nullptr) << "Failed to create session";
+  TF_ASSERT_OK(session->Create(graph_def)) << "Can't create test graph";
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {result.node()->name() + ":0"}, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  test::ExpectTensorEqual<tstring>(strings, outputs.front());
 }
 
 }  // namespace
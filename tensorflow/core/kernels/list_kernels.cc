@@ -29,6 +29,7 @@ limitations under the License.
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -125,7 +126,9 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
   }
 
   // If forwarding is not possible allocate a new output tensor and copy
-  // the `input_list` to it.
+  // the `input_list` to it. Ops that update a list this way on every loop
+  // iteration take quadratic time, so the copies are counted.
+  metrics::RecordTensorListCopy(c->op_kernel().type_string());
   AllocatorAttributes attr;
   attr.set_on_host(true);
   TF_RETURN_IF_ERROR(
@@ -136,6 +139,10 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
   return absl::OkStatus();
 }
 
+// Largest `max_num_elements` of an EmptyTensorList whose storage is
+// preallocated.
+constexpr int32_t kMaxPreallocatedElements = 1 << 16;
+
 class EmptyTensorList : public OpKernel {
  public:
   explicit EmptyTensorList(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -156,6 +163,12 @@ class EmptyTensorList : public OpKernel {
     TensorList empty;
     empty.element_dtype = element_dtype_;
     empty.max_num_elements = max_num_elements_t.scalar<int32>()();
+    // Lists with a known bound are usually filled up to it, so their storage
+    // is allocated once up front.
+    if (empty.max_num_elements > 0 &&
+        empty.max_num_elements <= kMaxPreallocatedElements) {
+      empty.tensors().reserve(empty.max_num_elements);
+    }
     PartialTensorShape element_shape;
     OP_REQUIRES_OK(ctx, TensorShapeFromTensor(ctx->input(0), &element_shape));
     empty.element_shape = element_shape;
@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/tensor_list.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::monitoring::testing::CellReader;
+
+constexpr char kTensorListCopies[] = "/tensorflow/core/tensor_list_copies";
+
+TensorList EmptyFloatList() {
+  TensorList list;
+  list.element_dtype = DT_FLOAT;
+  list.element_shape = PartialTensorShape({2});
+  return list;
+}
+
+class TensorListPushBackTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("push_back", "TensorListPushBack")
+                     .Input(FakeInput(DT_VARIANT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("element_dtype", DT_FLOAT)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddInputs(const TensorList& list) {
+    AddInputFromArray<Variant>(TensorShape({}), {list});
+    AddInputFromArray<float>(TensorShape({2}), {1.f, 2.f});
+  }
+
+  const TensorList& OutputList() {
+    return *GetOutput(0)->scalar<Variant>()().get<TensorList>();
+  }
+};
+
+TEST_F(TensorListPushBackTest, UpdatesUnsharedListInPlace) {
+  CellReader<int64_t> copies(kTensorListCopies);
+  MakeOp();
+  AddInputs(EmptyFloatList());
+  const TensorList* input_list =
+      mutable_input(0).tensor->scalar<Variant>()().get<TensorList>();
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(&OutputList(), input_list);
+  ASSERT_EQ(OutputList().tensors().size(), 1);
+  test::ExpectTensorEqual<float>(OutputList().tensors()[0],
+                                 test::AsTensor<float>({1.f, 2.f}));
+  EXPECT_EQ(copies.Delta("TensorListPushBack"), 0);
+}
+
+TEST_F(TensorListPushBackTest, CopiesListWhoseInputIsShared) {
+  CellReader<int64_t> copies(kTensorListCopies);
+  MakeOp();
+  AddInputs(EmptyFloatList());
+  const Tensor shared_input = *mutable_input(0).tensor;
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(OutputList().tensors().size(), 1);
+  EXPECT_TRUE(
+      shared_input.scalar<Variant>()().get<TensorList>()->tensors().empty());
+  EXPECT_EQ(copies.Delta("TensorListPushBack"), 1);
+}
+
+TEST_F(TensorListPushBackTest, CopiesListWhoseStorageIsShared) {
+  CellReader<int64_t> copies(kTensorListCopies);
+  MakeOp();
+  const TensorList list = EmptyFloatList();
+  // Shares the storage of `list`.
+  AddInputs(list);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(OutputList().tensors().size(), 1);
+  EXPECT_TRUE(list.tensors().empty());
+  EXPECT_EQ(copies.Delta("TensorListPushBack"), 1);
+}
+
+class EmptyTensorListTest : public OpsTestBase {};
+
+TEST_F(EmptyTensorListTest, PreallocatesBoundedLists) {
+  TF_ASSERT_OK(NodeDefBuilder("empty", "EmptyTensorList")
+                   .Input(FakeInput(DT_INT32))
+                   .Input(FakeInput(DT_INT32))
+                   .Attr("element_dtype", DT_FLOAT)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<int32>(TensorShape({1}), {2});
+  AddInputFromArray<int32>(TensorShape({}), {100});
+  TF_ASSERT_OK(RunOpKernel());
+  const TensorList& list =
+      *GetOutput(0)->scalar<Variant>()().get<TensorList>();
+  EXPECT_TRUE(list.tensors().empty());
+  EXPECT_GE(list.tensors().capacity(), 100);
+}
+
+}  // namespace
+}  // namespace tensorflow
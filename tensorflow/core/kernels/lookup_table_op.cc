@@ -16,20 +16,39 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "absl/numeric/bits.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/random.h"
+#include "tsl/platform/mutex_contention.h"
 
 namespace tensorflow {
 namespace lookup {
+namespace {
+
+TSL_MUTEX_CONTENTION_SITE(find_contention_site, "MutableHashTable::Find");
+TSL_MUTEX_CONTENTION_SITE(insert_contention_site, "MutableHashTable::Insert");
+
+}  // namespace
 
 std::string UniqueNodeName(const std::string& base) {
   static std::atomic<int64_t> counter(0);
@@ -70,7 +89,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
+    tsl::profiled_shared_lock l(mu_, find_contention_site());
     for (int64_t i = 0; i < key_values.size(); ++i) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
@@ -90,7 +109,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
+    tsl::profiled_mutex_lock l(mu_, insert_contention_site());
     if (clear) {
       table_.clear();
     }
@@ -242,7 +261,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
+    tsl::profiled_shared_lock l(mu_, find_contention_site());
     for (int64_t i = 0; i < key_values.size(); ++i) {
       ValueArray* value_vec =
           gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
@@ -272,7 +291,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
+    tsl::profiled_mutex_lock l(mu_, insert_contention_site());
     if (clear) {
       table_.clear();
     }
@@ -425,6 +444,118 @@ TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   return shape;
 }
 
+// A reader-writer lock for tables that are mostly read. Each reader takes one
+// of kNumStripes mutexes in shared mode, chosen by thread, so that concurrent
+// readers do not all update the same cache line. A writer takes all of them.
+class TF_LOCKABLE StripedSharedMutex {
+ public:
+  class TF_SCOPED_LOCKABLE ReaderLock {
+   public:
+    explicit ReaderLock(StripedSharedMutex& mu) TF_SHARED_LOCK_FUNCTION(mu)
+        : mu_(mu), stripe_(mu.lock_shared()) {}
+    ~ReaderLock() TF_UNLOCK_FUNCTION() { mu_.unlock_shared(stripe_); }
+
+   private:
+    StripedSharedMutex& mu_;
+    const int stripe_;
+  };
+
+  class TF_SCOPED_LOCKABLE WriterLock {
+   public:
+    explicit WriterLock(StripedSharedMutex& mu) TF_EXCLUSIVE_LOCK_FUNCTION(mu)
+        : mu_(mu) {
+      mu_.lock();
+    }
+    ~WriterLock() TF_UNLOCK_FUNCTION() { mu_.unlock(); }
+
+   private:
+    StripedSharedMutex& mu_;
+  };
+
+  void lock() TF_EXCLUSIVE_LOCK_FUNCTION() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Stripe& stripe : stripes_) stripe.mu.lock();
+  }
+
+  void unlock() TF_UNLOCK_FUNCTION() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (int i = kNumStripes - 1; i >= 0; --i) stripes_[i].mu.unlock();
+  }
+
+  // Returns the stripe to pass to unlock_shared().
+  int lock_shared() TF_SHARED_LOCK_FUNCTION() TF_NO_THREAD_SAFETY_ANALYSIS {
+    static std::atomic<int> next_stripe(0);
+    thread_local const int stripe =
+        next_stripe.fetch_add(1, std::memory_order_relaxed) % kNumStripes;
+    stripes_[stripe].mu.lock_shared();
+    return stripe;
+  }
+
+  void unlock_shared(int stripe) TF_UNLOCK_FUNCTION()
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    stripes_[stripe].mu.unlock_shared();
+  }
+
+ private:
+  static constexpr int kNumStripes = 16;
+
+  struct alignas(64) Stripe {
+    mutex mu;
+  };
+  Stripe stripes_[kNumStripes];
+};
+
+// MutableDenseHashTable keeps a control byte per bucket, which is either
+// kControlEmpty, kControlDeleted, or 7 bits of the hash of the bucket's key.
+// Probes compare kControlGroupWidth consecutive control bytes at once, and
+// only compare the keys of the buckets whose hash bits match.
+constexpr int kControlGroupWidth = 16;
+constexpr uint8_t kControlEmpty = 0x80;
+constexpr uint8_t kControlDeleted = 0xfe;
+
+// Returns a mask with the bit LaneBit(i) set for each of the
+// kControlGroupWidth control bytes at `control` that equals `value`.
+#if defined(__SSE2__)
+constexpr int kControlLaneShift = 0;
+inline uint64_t MatchControlGroup(const uint8_t* control, uint8_t value) {
+  const __m128i bytes =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+  return static_cast<uint32_t>(_mm_movemask_epi8(
+      _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value)))));
+}
+#elif defined(__ARM_NEON)
+constexpr int kControlLaneShift = 2;
+inline uint64_t MatchControlGroup(const uint8_t* control, uint8_t value) {
+  const uint8x16_t equal = vceqq_u8(vld1q_u8(control), vdupq_n_u8(value));
+  // Narrows each byte of the comparison to a nibble, and keeps one bit of it.
+  const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(equal), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) &
+         0x1111111111111111ull;
+}
+#else
+constexpr int kControlLaneShift = 0;
+inline uint64_t MatchControlGroup(const uint8_t* control, uint8_t value) {
+  uint64_t mask = 0;
+  for (int i = 0; i < kControlGroupWidth; ++i) {
+    mask |= static_cast<uint64_t>(control[i] == value) << i;
+  }
+  return mask;
+}
+#endif
+
+constexpr uint64_t LaneBit(int lane) {
+  return uint64_t{1} << (lane << kControlLaneShift);
+}
+
+inline int LowestLane(uint64_t mask) {
+  return absl::countr_zero(mask) >> kControlLaneShift;
+}
+
+// The first kNumGroupProbes probes of the quadratic probing sequence, at
+// offsets 0, 1, 3, 6, 10 and 15 from its first bucket, fall in one group of
+// control bytes.
+constexpr int kNumGroupProbes = 6;
+constexpr uint64_t kGroupProbeMask = LaneBit(0) | LaneBit(1) | LaneBit(3) |
+                                     LaneBit(6) | LaneBit(10) | LaneBit(15);
+
 }  // namespace
 
 // Modeled after densehashtable in https://github.com/sparsehash/sparsehash
@@ -492,7 +623,7 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
   size_t size() const override TF_LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
+    StripedSharedMutex::ReaderLock l(mu_);
     return num_entries_;
   }
 
@@ -512,7 +643,7 @@ class MutableDenseHashTable final : public LookupInterface {
     auto value_matrix = value->shaped<V, 2>({num_elements, value_size});
     const auto default_flat = default_value.flat<V>();
 
-    tf_shared_lock l(mu_);
+    StripedSharedMutex::ReaderLock l(mu_);
     const auto key_buckets_matrix = key_buckets_.template matrix<K>();
     const auto value_buckets_matrix = value_buckets_.template matrix<V>();
     const auto empty_key_matrix =
@@ -520,43 +651,53 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_matrix =
         deleted_key_.template shaped<K, 2>({1, key_size});
     const int64_t bit_mask = num_buckets_ - 1;
+    // Keys are hashed a batch at a time, and the first control bytes and
+    // bucket of each are prefetched, so that the cache misses of a batch
+    // overlap.
+    constexpr int64_t kBatchSize = 16;
+    uint64 key_hashes[kBatchSize];
     // TODO(andreasst): parallelize using work_sharder
-    for (int64_t i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
+    for (int64_t batch_start = 0; batch_start < num_elements;
+         batch_start += kBatchSize) {
+      const int64_t batch_end =
+          std::min(num_elements, batch_start + kBatchSize);
+      for (int64_t i = batch_start; i < batch_end; ++i) {
+        const uint64 key_hash = HashKey(key_matrix, i);
+        key_hashes[i - batch_start] = key_hash;
+        const int64_t bucket_index = key_hash & bit_mask;
+        port::prefetch<port::PREFETCH_HINT_T0>(&control_[bucket_index]);
+        port::prefetch<port::PREFETCH_HINT_T0>(key_buckets_matrix.data() +
+                                               bucket_index * key_size);
       }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
-      }
-      int64_t bucket_index = key_hash & bit_mask;
-      int64_t num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+      for (int64_t i = batch_start; i < batch_end; ++i) {
+        const uint64 key_hash = key_hashes[i - batch_start];
+        if (empty_key_hash_ == key_hash &&
+            IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
+          return errors::InvalidArgument(
+              "Using the empty_key as a table key is not allowed");
+        }
+        if (deleted_key_hash_ == key_hash &&
+            IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
+          return errors::InvalidArgument(
+              "Using the deleted_key as a table key is not allowed");
+        }
+        int64_t bucket_index;
+        if (!FindBucket(key_buckets_matrix, key_matrix, i, key_hash,
+                        &bucket_index, /*free_bucket_index=*/nullptr)) {
+          return errors::Internal(
+              "Internal error in MutableDenseHashTable lookup");
+        }
+        if (bucket_index >= 0) {
           for (int64_t j = 0; j < value_size; ++j) {
             // TODO(andreasst): check if we can get rid of SubtleMustCopy
             // here and elsewhere in this file.
             value_matrix(i, j) =
                 SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
           }
-          break;
-        }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
+        } else {
           for (int64_t j = 0; j < value_size; ++j) {
             value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
           }
-          break;
-        }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
         }
       }
     }
@@ -573,7 +714,7 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
+    StripedSharedMutex::WriterLock l(mu_);
     // For simplicity we assume that all keys in the input result in inserts
     // rather than updates. That means we may grow the table even though we
     // don't need to. As long as the number of keys inserted in one call is
@@ -598,13 +739,13 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
-    mutex_lock l(mu_);
+    StripedSharedMutex::WriterLock l(mu_);
     return DoRemove(ctx, key);
   }
 
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
                       const Tensor& values) override TF_LOCKS_EXCLUDED(mu_) {
-    mutex_lock l(mu_);
+    StripedSharedMutex::WriterLock l(mu_);
     num_buckets_ = keys.dim_size(0);
     key_buckets_ = keys;
     value_buckets_ = values;
@@ -617,9 +758,17 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_tensor =
         deleted_key_.template shaped<K, 2>({1, key_shape_.num_elements()});
     const auto key_buckets_tensor = key_buckets_.template matrix<K>();
+    const auto keys_matrix = keys.template shaped<K, 2>(
+        {num_buckets_, key_shape_.num_elements()});
+    control_.assign(num_buckets_ + kControlGroupWidth - 1, kControlEmpty);
     for (int64_t i = 0; i < num_buckets_; ++i) {
-      if (!IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0) &&
-          !IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
+      if (IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0)) {
+        continue;
+      }
+      if (IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
+        SetControl(i, kControlDeleted);
+      } else {
+        SetControl(i, ControlTag(HashKey(keys_matrix, i)));
         ++num_entries_;
       }
     }
@@ -627,7 +776,7 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override TF_LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
+    StripedSharedMutex::ReaderLock l(mu_);
     TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_));
     TF_RETURN_IF_ERROR(ctx->set_output("values", value_buckets_));
     return absl::OkStatus();
@@ -667,9 +816,10 @@ class MutableDenseHashTable final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override TF_LOCKS_EXCLUDED(mu_) {
-    tf_shared_lock l(mu_);
+    StripedSharedMutex::ReaderLock l(mu_);
     return sizeof(MutableDenseHashTable) + key_buckets_.AllocatedBytes() +
-           value_buckets_.AllocatedBytes() + empty_key_.AllocatedBytes();
+           value_buckets_.AllocatedBytes() + empty_key_.AllocatedBytes() +
+           control_.capacity() * sizeof(uint8_t);
   }
 
  private:
@@ -688,7 +838,6 @@ class MutableDenseHashTable final : public LookupInterface {
         empty_key_.template shaped<K, 2>({1, key_size});
     const auto deleted_key_tensor =
         deleted_key_.template shaped<K, 2>({1, key_size});
-    const int64_t bit_mask = num_buckets_ - 1;
     for (int64_t i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
@@ -707,37 +856,28 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
-      int64_t bucket_index = key_hash & bit_mask;
-      int64_t num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64_t j = 0; j < value_size; ++j) {
-            value_buckets_matrix(bucket_index, j) =
-                SubtleMustCopyIfIntegral(value_matrix(i, j));
-          }
-          break;
-        }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_tensor, 0) ||
-            IsEqualKey(key_buckets_matrix, bucket_index, deleted_key_tensor,
-                       0)) {
-          ++num_entries_;
-          for (int64_t j = 0; j < key_size; ++j) {
-            key_buckets_matrix(bucket_index, j) =
-                SubtleMustCopyIfIntegral(key_matrix(i, j));
-          }
-          for (int64_t j = 0; j < value_size; ++j) {
-            value_buckets_matrix(bucket_index, j) =
-                SubtleMustCopyIfIntegral(value_matrix(i, j));
-          }
-          break;
-        }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
+      // An existing key is updated. A new key goes to the first empty or
+      // deleted bucket of its probing sequence.
+      int64_t bucket_index;
+      int64_t free_bucket_index;
+      FindBucket(key_buckets_matrix, key_matrix, i, key_hash, &bucket_index,
+                 &free_bucket_index);
+      if (bucket_index < 0) {
+        if (free_bucket_index < 0) {
           return errors::Internal(
               "Internal error in MutableDenseHashTable insert");
         }
+        bucket_index = free_bucket_index;
+        ++num_entries_;
+        for (int64_t j = 0; j < key_size; ++j) {
+          key_buckets_matrix(bucket_index, j) =
+              SubtleMustCopyIfIntegral(key_matrix(i, j));
+        }
+        SetControl(bucket_index, ControlTag(key_hash));
+      }
+      for (int64_t j = 0; j < value_size; ++j) {
+        value_buckets_matrix(bucket_index, j) =
+            SubtleMustCopyIfIntegral(value_matrix(i, j));
       }
     }
     return absl::OkStatus();
@@ -755,7 +895,6 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_tensor =
         deleted_key_.template shaped<K, 2>({1, key_size});
     const auto deleted_key_flat = deleted_key_.template flat<K>();
-    const int64_t bit_mask = num_buckets_ - 1;
     for (int64_t i = 0; i < num_elements; ++i) {
       const uint64 key_hash = HashKey(key_matrix, i);
       if (empty_key_hash_ == key_hash &&
@@ -768,27 +907,19 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
-      int64_t bucket_index = key_hash & bit_mask;
-      int64_t num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          --num_entries_;
-          for (int64_t j = 0; j < key_size; ++j) {
-            key_buckets_matrix(bucket_index, j) =
-                SubtleMustCopyIfIntegral(deleted_key_flat(j));
-          }
-          break;
-        }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_tensor, 0)) {
-          break;
-        }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable remove");
+      int64_t bucket_index;
+      if (!FindBucket(key_buckets_matrix, key_matrix, i, key_hash,
+                      &bucket_index, /*free_bucket_index=*/nullptr)) {
+        return errors::Internal(
+            "Internal error in MutableDenseHashTable remove");
+      }
+      if (bucket_index >= 0) {
+        --num_entries_;
+        for (int64_t j = 0; j < key_size; ++j) {
+          key_buckets_matrix(bucket_index, j) =
+              SubtleMustCopyIfIntegral(deleted_key_flat(j));
         }
+        SetControl(bucket_index, kControlDeleted);
       }
     }
     return absl::OkStatus();
@@ -804,6 +935,7 @@ class MutableDenseHashTable final : public LookupInterface {
     }
     num_buckets_ = new_num_buckets;
     num_entries_ = 0;
+    control_.assign(num_buckets_ + kControlGroupWidth - 1, kControlEmpty);
 
     const int64_t key_size = key_shape_.num_elements();
     TF_RETURN_IF_ERROR(ctx->allocate_temp(
@@ -840,6 +972,92 @@ class MutableDenseHashTable final : public LookupInterface {
     return DoInsert(ctx, old_key_buckets, old_value_buckets, true);
   }
 
+  // Walks the quadratic probing sequence of the key at `index` in
+  // `key_matrix`, whose hash is `key_hash`, up to the first empty bucket.
+  // Sets `*bucket_index` to the bucket holding the key, or to -1 if there is
+  // none. If `free_bucket_index` is not null, also sets it to the first empty
+  // or deleted bucket of the sequence, or to -1 if there is none. Returns
+  // false if the sequence has neither the key nor an empty bucket.
+  template <typename MT2>
+  bool FindBucket(typename TTypes<K>::Matrix key_buckets_matrix,
+                  MT2 key_matrix, int64_t index, uint64 key_hash,
+                  int64_t* bucket_index, int64_t* free_bucket_index) const
+      TF_SHARED_LOCKS_REQUIRED(mu_) {
+    const uint8_t tag = ControlTag(key_hash);
+    const int64_t bit_mask = num_buckets_ - 1;
+    const int64_t first_bucket_index = key_hash & bit_mask;
+    *bucket_index = -1;
+    if (free_bucket_index != nullptr) {
+      *free_bucket_index = -1;
+    }
+
+    // The probes that fall in the first group, from the first bucket on.
+    const uint8_t* group = control_.data() + first_bucket_index;
+    const uint64_t empty =
+        MatchControlGroup(group, kControlEmpty) & kGroupProbeMask;
+    uint64_t matches = MatchControlGroup(group, tag) & kGroupProbeMask;
+    if (free_bucket_index != nullptr) {
+      const uint64_t free =
+          empty | (MatchControlGroup(group, kControlDeleted) & kGroupProbeMask);
+      if (free != 0) {
+        *free_bucket_index = (first_bucket_index + LowestLane(free)) & bit_mask;
+      }
+    }
+    if (empty != 0) {
+      // Only the buckets probed before the first empty one can hold the key.
+      matches &= (empty & (~empty + 1)) - 1;
+    }
+    for (; matches != 0; matches &= matches - 1) {
+      const int64_t candidate =
+          (first_bucket_index + LowestLane(matches)) & bit_mask;
+      if (IsEqualKey(key_buckets_matrix, candidate, key_matrix, index)) {
+        *bucket_index = candidate;
+        return true;
+      }
+    }
+    if (empty != 0) {
+      return true;
+    }
+
+    int64_t num_probes = kNumGroupProbes;
+    int64_t probe_index =
+        (first_bucket_index + num_probes * (num_probes + 1) / 2) & bit_mask;
+    while (num_probes < num_buckets_) {
+      const uint8_t control = control_[probe_index];
+      if (control == tag &&
+          IsEqualKey(key_buckets_matrix, probe_index, key_matrix, index)) {
+        *bucket_index = probe_index;
+        return true;
+      }
+      if (control == kControlEmpty || control == kControlDeleted) {
+        if (free_bucket_index != nullptr && *free_bucket_index < 0) {
+          *free_bucket_index = probe_index;
+        }
+        if (control == kControlEmpty) {
+          return true;
+        }
+      }
+      ++num_probes;
+      probe_index = (probe_index + num_probes) & bit_mask;  // quadratic probing
+    }
+    return false;
+  }
+
+  // Sets the control byte of a bucket, and its copies past the end of
+  // control_, which let groups starting at any bucket wrap around.
+  void SetControl(int64_t bucket_index, uint8_t control)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (int64_t i = bucket_index; i < control_.size(); i += num_buckets_) {
+      control_[i] = control;
+    }
+  }
+
+  // Takes 7 bits of the key hash. The bucket is chosen by the low bits of
+  // the hash, which is the key itself for integers, so the hash is mixed first.
+  static uint8_t ControlTag(uint64 key_hash) {
+    return (key_hash * 0x9e3779b97f4a7c15ull) >> 57;
+  }
+
   uint64 HashKey(typename TTypes<K>::ConstMatrix key, int64_t index) const {
     if (key_shape_.num_elements() == 1) {
       return HashScalar(key(index, 0));
@@ -867,11 +1085,13 @@ class MutableDenseHashTable final : public LookupInterface {
   TensorShape key_shape_;
   TensorShape value_shape_;
   float max_load_factor_;
-  mutable mutex mu_;
+  mutable StripedSharedMutex mu_;
   int64_t num_entries_ TF_GUARDED_BY(mu_);
   int64_t num_buckets_ TF_GUARDED_BY(mu_);
   Tensor key_buckets_ TF_GUARDED_BY(mu_);
   Tensor value_buckets_ TF_GUARDED_BY(mu_);
+  // num_buckets_ + kControlGroupWidth - 1 control bytes, see SetControl().
+  std::vector<uint8_t> control_ TF_GUARDED_BY(mu_);
   Tensor empty_key_;
   uint64 empty_key_hash_;
   Tensor deleted_key_;
@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MATMUL_OP_CONSTANT_OPERAND_H_
+#define TENSORFLOW_CORE_KERNELS_MATMUL_OP_CONSTANT_OPERAND_H_
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+// Keeps the converted form (e.g. the float copy of a bfloat16 or half matrix)
+// of a MatMul operand that is the same tensor on every call, such as the
+// output of a Const node or a read-only variable, so that the conversion runs
+// once instead of on every step.
+//
+// The operand is recognized by its buffer and shape. The cache holds a
+// reference to the operand buffer, which keeps it from being freed and reused
+// and keeps in-place kernels and resource variable updates from writing to it
+// (both require a buffer that is referenced only once). Legacy reference
+// variables are updated in place regardless, so caching is opt-in with
+// TF_MATMUL_CACHE_CONSTANT_OPERANDS.
+class ConstantOperandCache {
+ public:
+  ConstantOperandCache() {
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_MATMUL_CACHE_CONSTANT_OPERANDS",
+                                   /*default_val=*/false, &enabled_));
+  }
+
+  ConstantOperandCache(const ConstantOperandCache&) = delete;
+  ConstantOperandCache& operator=(const ConstantOperandCache&) = delete;
+
+  bool enabled() const { return enabled_; }
+  void set_enabled(bool enabled) { enabled_ = enabled; }
+
+  // Returns the converted form of `operand`. `convert` is a callable taking
+  // `operand` and returning its converted form as a Tensor; it is only
+  // called when `operand` is not the operand of the previous call or the
+  // cache is disabled.
+  template <typename Convert>
+  Tensor GetOrConvert(const Tensor& operand, Convert convert) {
+    if (!enabled_) return convert(operand);
+    mutex_lock l(mu_);
+    if (!source_.IsInitialized() || source_.data() != operand.data() ||
+        source_.dtype() != operand.dtype() ||
+        source_.shape() != operand.shape()) {
+      converted_ = convert(operand);
+      source_ = operand;
+    }
+    return converted_;
+  }
+
+ private:
+  bool enabled_ = false;
+
+  mutex mu_;
+  Tensor source_ TF_GUARDED_BY(mu_);
+  Tensor converted_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MATMUL_OP_CONSTANT_OPERAND_H_
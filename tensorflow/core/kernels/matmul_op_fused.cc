@@ -48,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
+#include "tensorflow/core/kernels/matmul_op_constant_operand.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #include "tensorflow/core/util/tensor_format.h"
@@ -120,6 +121,20 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
 
       if constexpr (std::is_same_v<ComputeType, T>) {
         out.device(d) = lhs.contract(rhs, dim_pair, output_kernel_wrapper);
+      } else if (rhs_cache != nullptr && rhs_cache->enabled()) {
+        // Reuse the converted weights instead of casting them while packing.
+        const Tensor b_compute =
+            rhs_cache->GetOrConvert(b, [&d](const Tensor& weights) {
+              Tensor converted(DataTypeToEnum<ComputeType>::value,
+                               weights.shape());
+              converted.flat<ComputeType>().device(d) =
+                  weights.flat<T>().template cast<ComputeType>();
+              return converted;
+            });
+        out.device(d) = lhs.template cast<ComputeType>()
+                            .contract(b_compute.matrix<ComputeType>(),
+                                      dim_pair, output_kernel_wrapper)
+                            .template cast<T>();
       } else {
         out.device(d) = lhs.template cast<ComputeType>()
                             .contract(rhs.template cast<ComputeType>(),
@@ -169,6 +184,9 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
     }
   }
 
+  // If set, caches `b` converted to ComputeType across calls.
+  ConstantOperandCache* rhs_cache = nullptr;
+
  private:
   // Wrap output_kernel into type erased struct to reduce the number of unique
   // template instantiations for Eigen Tensor contraction expressions.
@@ -202,7 +220,8 @@ namespace {
 #if GOOGLE_CUDA || TF_HIPBLASLT
 StatusOr<se::gpu::BlasLt::Epilogue> GetBlasLtEpilogOp(
     FusedComputationType fusion) {
-  if (fusion == FusedComputationType::kBiasAdd) {
+  if (fusion == FusedComputationType::kBiasAdd ||
+      fusion == FusedComputationType::kBiasAddWithAdd) {
     return se::gpu::BlasLt::Epilogue::kBias;
   } else if (fusion == FusedComputationType::kBiasAddWithRelu) {
     return se::gpu::BlasLt::Epilogue::kBiasThenReLU;
@@ -469,6 +488,22 @@ struct LaunchFusedMatMulOp<GPUDevice, T> {
     auto c_ptr = AsDeviceMemory(output->template flat<T>().data(),
                                 output->template flat<T>().size());
 
+    // The residual add of MatMul + BiasAdd + Add adds a side input of the
+    // output shape, which cuBLASLt reads as the C operand of the matmul.
+    const bool with_side_input =
+        fusion == FusedComputationType::kBiasAddWithAdd;
+    se::DeviceMemory<T> side_input_ptr;
+    if (with_side_input) {
+      const Tensor& side_input = context->input(3);
+      OP_REQUIRES(context, side_input.shape() == output->shape(),
+                  errors::InvalidArgument(
+                      "side_input must have the shape of the output ",
+                      output->shape().DebugString(), ", got ",
+                      side_input.shape().DebugString()));
+      side_input_ptr = AsDeviceMemory(side_input.template flat<T>().data(),
+                                      side_input.template flat<T>().size());
+    }
+
     bool trans_a = dim_pair[0].first == 0 ? true : false;
     bool trans_b = dim_pair[0].second == 1 ? true : false;
 
@@ -492,6 +527,7 @@ struct LaunchFusedMatMulOp<GPUDevice, T> {
         use_cudnn = true;
         break;
       case FusedComputationType::kBiasAdd:
+      case FusedComputationType::kBiasAddWithAdd:
         matmul_activation_mode = se::dnn::ActivationMode::kNone;
         break;
       case FusedComputationType::kBiasAddWithRelu:
@@ -569,6 +605,11 @@ struct LaunchFusedMatMulOp<GPUDevice, T> {
           stream, nullptr, std::get<se::DeviceMemoryBase>(runner_and_scratch),
           a_ptr, b_ptr, bias_ptr, c_ptr);
       OP_REQUIRES_OK(context, cudnn_launch_status);
+      if (with_side_input) {
+        // The cuDNN matmul has no side input, add it separately.
+        output->flat<T>().device(context->eigen_device<GPUDevice>()) +=
+            context->input(3).flat<T>();
+      }
       return;
     }
 #if GOOGLE_CUDA || TF_HIPBLASLT
@@ -588,7 +629,8 @@ struct LaunchFusedMatMulOp<GPUDevice, T> {
                                          /*batch_size=*/1,
                                          /*broadcast_a=*/false,
                                          /*broadcast_b=*/false,
-                                         epilog_op};
+                                         epilog_op,
+                                         with_side_input};
     absl::Mutex* pmu;
     auto plan_and_algorithms_or =
         GetPlanAndAlgorithms(stream, matmul_params, &pmu);
@@ -604,7 +646,7 @@ struct LaunchFusedMatMulOp<GPUDevice, T> {
                            se::blas::ProfileResult* profile_result) {
       return DoBlasLtMatmul(stream, *plan_and_algorithms, a_ptr, b_ptr, c_ptr,
                             alg_idx, scratch_allocator, bias_ptr,
-                            profile_result);
+                            profile_result, side_input_ptr);
     };
 
     size_t alg_idx = 0;
@@ -649,7 +691,8 @@ class FusedMatMulOp : public OpKernel {
           {FCT::kBiasAddWithTanh, {"BiasAdd", "Tanh"}},
           {FCT::kBiasAddWithSigmoid, {"BiasAdd", "Sigmoid"}},
           {FCT::kBiasAddWithGeluApproximate, {"BiasAdd", "GeluApproximate"}},
-          {FCT::kBiasAddWithGeluExact, {"BiasAdd", "GeluExact"}}};
+          {FCT::kBiasAddWithGeluExact, {"BiasAdd", "GeluExact"}},
+          {FCT::kBiasAddWithAdd, {"BiasAdd", "Add"}}};
     }
 
     OP_REQUIRES_OK(context, InitializeFusedComputation(
@@ -716,6 +759,9 @@ class FusedMatMulOp : public OpKernel {
     }
 
     auto launch = LaunchFusedMatMulOp<Device, T>();
+    if constexpr (std::is_same<Device, CPUDevice>::value) {
+      launch.rhs_cache = &rhs_cache_;
+    }
     launch(ctx, a, b, dim_pair, fused_computation_, fused_computation_args_,
            out, use_autotune_);
   }
@@ -724,6 +770,7 @@ class FusedMatMulOp : public OpKernel {
   bool transpose_a_;
   bool transpose_b_;
   bool use_autotune_;
+  ConstantOperandCache rhs_cache_;
 
   FusedComputationType fused_computation_ = FusedComputationType::kUndefined;
   FusedComputationArgs fused_computation_args_;
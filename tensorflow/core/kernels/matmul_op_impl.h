@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/matmul_op_constant_operand.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/bfloat16.h"
@@ -515,8 +516,10 @@ class BlasScratchAllocator : public se::ScratchAllocator {
     }
     AllocationAttributes allocation_attr;
     allocation_attr.retry_on_failure = false;
+    allocation_attr.short_lived = true;
     Status allocation_status(context_->allocate_temp(
-        DT_UINT8, TensorShape({byte_size}), &temporary_memory));
+        DT_UINT8, TensorShape({byte_size}), &temporary_memory,
+        AllocatorAttributes(), allocation_attr));
     if (!allocation_status.ok()) {
       return tsl::Status{
           absl::StatusCode::kUnavailable,
@@ -982,11 +985,9 @@ class BaseBatchMatMulOp : public OpKernel {
     if constexpr (std::is_same_v<Device, CPUDevice> && std::is_same_v<Ta, Tb> &&
                   (std::is_same_v<Ta, bfloat16> ||
                    std::is_same_v<Ta, Eigen::half>)) {
-      Tensor in0_reshaped_float, in1_reshaped_float, out_reshaped_float;
+      Tensor in0_reshaped_float, out_reshaped_float;
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, in0_reshaped.shape(),
                                              &in0_reshaped_float));
-      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, in1_reshaped.shape(),
-                                             &in1_reshaped_float));
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, out_reshaped.shape(),
                                              &out_reshaped_float));
 
@@ -994,9 +995,16 @@ class BaseBatchMatMulOp : public OpKernel {
       FastConvertToFloat(in0_reshaped.flat<Ta>().data(),
                          in0_reshaped_float.flat<float>().data(),
                          in0_reshaped.NumElements());
-      FastConvertToFloat(in1_reshaped.flat<Tb>().data(),
-                         in1_reshaped_float.flat<float>().data(),
-                         in1_reshaped.NumElements());
+      // The right-hand side is usually the weights, which stay the same
+      // across steps, so its float copy can be reused.
+      const Tensor in1_reshaped_float =
+          in1_cache_.GetOrConvert(in1_reshaped, [](const Tensor& in1) {
+            Tensor in1_float(DT_FLOAT, in1.shape());
+            FastConvertToFloat(in1.flat<Tb>().data(),
+                               in1_float.flat<float>().data(),
+                               in1.NumElements());
+            return in1_float;
+          });
 
       LaunchBatchMatMul<Device, float>::Launch(
           ctx, in0_reshaped_float, in1_reshaped_float, adj_x_, adj_y_, trans_x_,
@@ -1011,7 +1019,10 @@ class BaseBatchMatMulOp : public OpKernel {
         in0_reshaped = CastTensor<Ta, Tout>(in0_reshaped);
       }
       if constexpr (!std::is_same<Tb, Tout>::value) {
-        in1_reshaped = CastTensor<Tb, Tout>(in1_reshaped);
+        in1_reshaped = in1_cache_.GetOrConvert(
+            in1_reshaped, [this](const Tensor& in1) {
+              return CastTensor<Tb, Tout>(in1);
+            });
       }
       LaunchBatchMatMul<Device, Tout>::Launch(
           ctx, in0_reshaped, in1_reshaped, adj_x_, adj_y_, trans_x_, trans_y_,
@@ -1031,6 +1042,8 @@ class BaseBatchMatMulOp : public OpKernel {
   bool trans_y_ = false;
   bool grad_input_1_ = false;
   bool grad_input_2_ = false;
+  // Converted copy of In[1], which is reused while In[1] is the same tensor.
+  ConstantOperandCache in1_cache_;
 
   // Cast `t` from `SrcT` to `DstT`.
   template <typename SrcT, typename DstT>
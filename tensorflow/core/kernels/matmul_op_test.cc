@@ -24,12 +24,14 @@ limitations under the License.
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/matmul_op_constant_operand.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/port.h"
 #include "tsl/platform/status.h"
 
 #if TENSORFLOW_USE_ROCM
@@ -320,6 +322,54 @@ class FusedMatMulOpTest : public OpsTestBase {
     VerifyBiasAddTensorsNear(m, k, n, transpose_a, transpose_b, run_default,
                              run_fused);
   }
+
+  // Verifies that computing MatMul+BiasAdd+Add in a graph is identical to
+  // FusedMatMul with a side input. The fusion is only implemented on GPU.
+  void VerifyMatMulWithBiasAndAdd(int m, int k, int n, bool transpose_a,
+                                  bool transpose_b) {
+    if (!IsGoogleCudaEnabled()) {
+      GTEST_SKIP() << "MatMul+BiasAdd+Add fusion is only supported on GPU";
+    }
+    DataType dtype = DataTypeToEnum<T>::v();
+
+    Tensor lhs(dtype, {transpose_a ? k : m, transpose_a ? m : k});
+    lhs.flat<T>() = lhs.flat<T>().setRandom();
+    Tensor rhs(dtype, {transpose_b ? n : k, transpose_b ? k : n});
+    rhs.flat<T>() = rhs.flat<T>().setRandom();
+    rhs.flat<T>() -= rhs.flat<T>().constant(static_cast<T>(0.5f));
+    Tensor bias(dtype, {n});
+    bias.flat<T>() = bias.flat<T>().setRandom();
+    Tensor side_input(dtype, {m, n});
+    side_input.flat<T>() = side_input.flat<T>().setRandom();
+
+    Scope root = tensorflow::Scope::NewRootScope();
+    ops::MatMul matmul = ops::MatMul(
+        root.WithOpName("matmul"),
+        ops::Const(root.WithOpName("lhs"), Input::Initializer(lhs)),
+        ops::Const(root.WithOpName("rhs"), Input::Initializer(rhs)),
+        ops::MatMul::Attrs().TransposeA(transpose_a).TransposeB(transpose_b));
+    ops::BiasAdd with_bias = ops::BiasAdd(
+        root.WithOpName("with_bias"), matmul,
+        ops::Const(root.WithOpName("bias"), Input::Initializer(bias)));
+    ops::Add(root.WithOpName("with_add"), with_bias,
+             ops::Const(root.WithOpName("side_input"),
+                        Input::Initializer(side_input)));
+    Tensor unfused;
+    RunAndFetch(root, "with_add", &unfused, /*allow_gpu_device=*/true);
+
+    Tensor fused;
+    bool skipped = false;
+    RunFusedMatMulOp(lhs, rhs, {bias, side_input}, {"BiasAdd", "Add"},
+                     transpose_a, transpose_b, &fused,
+                     /*allow_gpu_device=*/true, &skipped);
+    if (skipped) return;
+
+    ASSERT_EQ(unfused.dtype(), fused.dtype());
+    ASSERT_EQ(unfused.shape(), fused.shape());
+    double atol = this->kTValueType == DT_HALF ? 1e-3 : 1e-5;
+    double rtol = this->kTValueType == DT_HALF ? 1e-3 : -1.0;
+    test::ExpectClose(unfused, fused, atol, rtol);
+  }
 };
 
 // MatMul with BatchNorm can be tested only with `T=float`, because default
@@ -405,6 +455,21 @@ TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul1x256x1WithActivation) {
   }
 }
 
+// -------------------------------------------------------------------------- //
+// MatMul + BiasAdd + Add                                                     //
+// -------------------------------------------------------------------------- //
+
+TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul256x128x64WithAdd) {
+  this->VerifyMatMulWithBiasAndAdd(256, 128, 64, false, false);
+  this->VerifyMatMulWithBiasAndAdd(256, 128, 64, true, false);
+  this->VerifyMatMulWithBiasAndAdd(256, 128, 64, false, true);
+  this->VerifyMatMulWithBiasAndAdd(256, 128, 64, true, true);
+}
+
+TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul1x256x256WithAdd) {
+  this->VerifyMatMulWithBiasAndAdd(1, 256, 256, false, false);
+}
+
 REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,       //
                             MatMul256x128x64,                //
                             MatMul1x256x256,                 //
@@ -413,13 +478,47 @@ REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,       //
                             MatMul256x128x64WithActivation,  //
                             MatMul1x256x256WithActivation,   //
                             MatMul256x256x1WithActivation,   //
-                            MatMul1x256x1WithActivation);
+                            MatMul1x256x1WithActivation,     //
+                            MatMul256x128x64WithAdd,         //
+                            MatMul1x256x256WithAdd);
 
 // TODO(ezhulenev): Add support for more data types.
 using FusedBiasAddDataTypes = ::testing::Types<float, Eigen::half>;
 INSTANTIATE_TYPED_TEST_SUITE_P(Test, FusedMatMulWithBiasOpTest,
                                FusedBiasAddDataTypes);
 
+TEST(ConstantOperandCacheTest, ConvertsSameOperandOnce) {
+  ConstantOperandCache cache;
+  cache.set_enabled(true);
+  int conversions = 0;
+  auto convert = [&conversions](const Tensor& operand) {
+    ++conversions;
+    Tensor converted(DT_FLOAT, operand.shape());
+    converted.flat<float>() = operand.flat<Eigen::half>().cast<float>();
+    return converted;
+  };
+
+  Tensor weights(DT_HALF, TensorShape({2, 2}));
+  weights.flat<Eigen::half>().setConstant(Eigen::half(1.0f));
+  Tensor converted = cache.GetOrConvert(weights, convert);
+  EXPECT_EQ(converted.flat<float>()(0), 1.0f);
+  EXPECT_TRUE(cache.GetOrConvert(weights, convert).SharesBufferWith(converted));
+  EXPECT_EQ(conversions, 1);
+
+  // A reshaped view of another buffer is converted again.
+  Tensor other_weights(DT_HALF, TensorShape({4}));
+  other_weights.flat<Eigen::half>().setConstant(Eigen::half(2.0f));
+  Tensor other_reshaped;
+  ASSERT_TRUE(other_reshaped.CopyFrom(other_weights, TensorShape({2, 2})));
+  EXPECT_EQ(cache.GetOrConvert(other_reshaped, convert).flat<float>()(0),
+            2.0f);
+  EXPECT_EQ(conversions, 2);
+
+  cache.set_enabled(false);
+  cache.GetOrConvert(other_reshaped, convert);
+  EXPECT_EQ(conversions, 3);
+}
+
 //----------------------------------------------------------------------------//
 // Performance benchmarks are below.                                          //
 //----------------------------------------------------------------------------//
@@ -545,6 +644,78 @@ BM_Matmul(2000, 1, 2000, true, true);
 
 // LINT.ThenChange(//tensorflow/core/kernels/mkl/mkl_matmul_op_benchmark.cc)
 
+// Benchmarks for the residual add of transformer blocks, MatMul + BiasAdd +
+// Add, computed by separate kernels or by a single _FusedMatMul.
+template <typename T>
+static Graph* MatmulWithBiasAndAdd(int m, int k, int n, bool fused,
+                                   DataType type) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor lhs(type, TensorShape({m, k}));
+  lhs.flat<T>().setRandom();
+  Tensor rhs(type, TensorShape({k, n}));
+  rhs.flat<T>().setRandom();
+  Tensor bias(type, TensorShape({n}));
+  bias.flat<T>().setRandom();
+  Tensor side_input(type, TensorShape({m, n}));
+  side_input.flat<T>().setRandom();
+
+  Node* lhs_node = test::graph::Constant(g, lhs);
+  Node* rhs_node = test::graph::Constant(g, rhs);
+  Node* bias_node = test::graph::Constant(g, bias);
+  Node* side_input_node = test::graph::Constant(g, side_input);
+  if (fused) {
+    Node* ret;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedMatMul")
+                    .Input(lhs_node)
+                    .Input(rhs_node)
+                    .Input(std::vector<NodeBuilder::NodeOut>{bias_node,
+                                                             side_input_node})
+                    .Attr("num_args", 2)
+                    .Attr("fused_ops", std::vector<string>{"BiasAdd", "Add"})
+                    .Attr("transpose_a", false)
+                    .Attr("transpose_b", false)
+                    .Attr("T", type)
+                    .Finalize(g, &ret));
+  } else {
+    Node* matmul =
+        test::graph::Matmul(g, lhs_node, rhs_node, /*transpose_a=*/false,
+                            /*transpose_b=*/false);
+    test::graph::Add(g, test::graph::BiasAdd(g, matmul, bias_node),
+                     side_input_node);
+  }
+  return g;
+}
+
+// NOLINTBEGIN
+// Function names are already longer than 80 chars.
+#define BM_MatmulWithBiasAndAddDev(M, K, N, FUSED, T, TFTYPE, DEVICE)         \
+  static void                                                                 \
+      BM_MatmulWithBiasAndAdd##_##M##_##K##_##N##_##FUSED##_##TFTYPE##_##DEVICE( \
+          ::testing::benchmark::State& state) {                               \
+    test::Benchmark(#DEVICE,                                                  \
+                    MatmulWithBiasAndAdd<T>(M, K, N, FUSED, TFTYPE),          \
+                    /*old_benchmark_api*/ false)                              \
+        .Run(state);                                                          \
+    state.SetItemsProcessed(state.iterations() * M * K * N * 2);              \
+  }                                                                           \
+  BENCHMARK(                                                                  \
+      BM_MatmulWithBiasAndAdd##_##M##_##K##_##N##_##FUSED##_##TFTYPE##_##DEVICE) \
+      ->MeasureProcessCPUTime();
+
+#if GOOGLE_CUDA || TF_HIPBLASLT
+#define BM_MatmulWithBiasAndAdd(M, K, N)                                    \
+  BM_MatmulWithBiasAndAddDev(M, K, N, false, float, DT_FLOAT, gpu);         \
+  BM_MatmulWithBiasAndAddDev(M, K, N, true, float, DT_FLOAT, gpu);          \
+  BM_MatmulWithBiasAndAddDev(M, K, N, false, Eigen::half, DT_HALF, gpu);    \
+  BM_MatmulWithBiasAndAddDev(M, K, N, true, Eigen::half, DT_HALF, gpu);
+
+// The projections of the attention and feed-forward layers of a transformer
+// block, for 4096 tokens with a model dimension of 1024.
+BM_MatmulWithBiasAndAdd(4096, 1024, 1024);
+BM_MatmulWithBiasAndAdd(4096, 4096, 1024);
+#endif  // GOOGLE_CUDA || TF_HIPBLASLT
+// NOLINTEND
+
 // Benchmarks for batched matmul with broadcasting.
 Node* BroadcastTo(Graph* g, Node* input, Node* shape) {
   Node* ret;
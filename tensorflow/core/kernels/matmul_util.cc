@@ -164,7 +164,7 @@ StatusOr<const PlanAndAlgorithms*> GetPlanAndAlgorithms(
         .output_layout =
             se::gpu::MatrixLayout{xlatype, rows_c, cols_c, kRowMajor, batch_sz},
         .alpha = xla::complex128{1.0, 0.0},
-        .beta = 0.0,
+        .beta = params.with_side_input ? 1.0 : 0.0,
         .compute_precision = se::blas::kDefaultComputePrecision,
         .precision_algorithm = xla::PrecisionConfig::ALG_UNSET,
         .algorithm = {},
@@ -48,6 +48,9 @@ struct BlasLtMatmulPlanParams {
   bool broadcast_a = false;
   bool broadcast_b = false;
   se::gpu::BlasLt::Epilogue epilogue = se::gpu::BlasLt::Epilogue::kDefault;
+  // Whether the matmul adds a side input to its result, i.e. computes
+  // A * B + C, e.g. for the residual add of a transformer block.
+  bool with_side_input = false;
 };
 
 struct PlanAndAlgorithms {
@@ -61,7 +64,7 @@ namespace internal {
 inline auto AsTuple(const BlasLtMatmulPlanParams& p) {
   return std::make_tuple(p.dtype, p.m, p.n, p.k, p.trans_a, p.trans_b,
                          p.batch_count, p.broadcast_a, p.broadcast_b,
-                         p.epilogue);
+                         p.epilogue, p.with_side_input);
 }
 
 }  // namespace internal
@@ -75,29 +78,35 @@ StatusOr<const PlanAndAlgorithms*> GetPlanAndAlgorithms(
     se::Stream* stream, const BlasLtMatmulPlanParams& params, absl::Mutex** pmu,
     std::optional<int> max_algorithm_count = std::nullopt);
 
+// If `side_input` is given, the plan must have been created with
+// `with_side_input` and the result is A * B + side_input (+ bias).
 template <typename T>
 Status DoBlasLtMatmul(se::Stream* stream, const PlanAndAlgorithms& paa,
                       const se::DeviceMemory<T>& a,
                       const se::DeviceMemory<T>& b, se::DeviceMemory<T>& c,
                       size_t alg_idx, se::ScratchAllocator& scratch_allocator,
                       const se::DeviceMemory<T>& bias = {},
-                      se::blas::ProfileResult* profile_result = nullptr) {
+                      se::blas::ProfileResult* profile_result = nullptr,
+                      const se::DeviceMemory<T>& side_input = {}) {
   se::DeviceMemory<T> aux{};  // We don't use the auxilary buffers.
   const auto& algorithm = paa.algorithms[alg_idx];
+  const bool has_side_input = !side_input.is_null();
+  const se::DeviceMemory<T>& c_in = has_side_input ? side_input : c;
 
   // The scale type may be f32 if the data type is f16 and bf16.
   if constexpr (std::is_same_v<T, Eigen::half> ||
                 std::is_same_v<T, Eigen::bfloat16>) {
     if (paa.scale_type == se::blas::DataType::kFloat) {
-      return paa.plan->DoMatmul(stream, se::HostOrDeviceScalar<float>(1.0), b,
-                                a, se::HostOrDeviceScalar<float>(0.0), c, c,
-                                algorithm, scratch_allocator, bias, aux,
-                                profile_result);
+      return paa.plan->DoMatmul(
+          stream, se::HostOrDeviceScalar<float>(1.0), b, a,
+          se::HostOrDeviceScalar<float>(has_side_input ? 1.0 : 0.0), c_in, c,
+          algorithm, scratch_allocator, bias, aux, profile_result);
     }
   }
-  return paa.plan->DoMatmul(stream, se::HostOrDeviceScalar<T>(T(1.0)), b, a,
-                            se::HostOrDeviceScalar<T>(T(0.0)), c, c, algorithm,
-                            scratch_allocator, bias, aux, profile_result);
+  return paa.plan->DoMatmul(
+      stream, se::HostOrDeviceScalar<T>(T(1.0)), b, a,
+      se::HostOrDeviceScalar<T>(T(has_side_input ? 1.0 : 0.0)), c_in, c,
+      algorithm, scratch_allocator, bias, aux, profile_result);
 }
 
 }  // namespace tensorflow
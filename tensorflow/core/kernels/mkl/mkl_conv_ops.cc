@@ -20,13 +20,16 @@ limitations under the License.
 
 #include <algorithm>
 #include <map>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/kernels/mkl/mkl_kernel_util.h"
 #include "tensorflow/core/kernels/mkl/mkl_quantized_conv_ops.h"
 #include "tensorflow/core/kernels/no_op.h"
+#include "tensorflow/core/util/onednn_weight_cache.h"
 #if defined(DNNL_AARCH64_USE_ACL) && defined(ENABLE_ONEDNN_OPENMP)
 #include "tensorflow/core/platform/mutex.h"
 #endif
@@ -1444,7 +1447,13 @@ class MklConvOp : public OpKernel {
 
     *filter_tensor = &cached_filter_data_;
 
-    memory::desc weights_desc = conv_prim_desc.weights_desc();
+    SetCachedFilterMd(context, conv_prim_desc.weights_desc());
+  }
+
+  // Caches the memory descriptor (data format) of the cached filter data.
+  void SetCachedFilterMd(OpKernelContext* context,
+                         const memory::desc& weights_desc)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
 #ifndef ENABLE_ONEDNN_V3
     // There is no tensor format in DNNL 1.x. So we cache the complete filter
     // descriptor as flat byte array.
@@ -1532,6 +1541,22 @@ class MklConvOp : public OpKernel {
     }
 #endif  // ENABLE_ONEDNN_V3
 
+    // Other kernels, e.g. of another session serving the same model, may
+    // have reordered the same filter already.
+    OneDnnWeightCache* weight_cache = OneDnnWeightCache::Global();
+    string weight_cache_key;
+    if (weight_cache->enabled()) {
+      weight_cache_key = OneDnnWeightCache::MakeKey(
+          filter_tensor, conv_fwd_pd->weights_desc());
+      std::optional<Tensor> shared_filter =
+          weight_cache->Lookup(weight_cache_key);
+      if (shared_filter.has_value()) {
+        cached_filter_data_ = *std::move(shared_filter);
+        SetCachedFilterMd(context, conv_fwd_pd->weights_desc());
+        return;
+      }
+    }
+
     // Otherwise, cache reordered filter
     filter.SetUsrMem(filter_md, &filter_tensor);
     filter.CheckReorderToOpMem(conv_fwd_pd.get()->weights_desc(),
@@ -1544,6 +1569,9 @@ class MklConvOp : public OpKernel {
     void* cached_filter_data = filter.GetTensorBuffer(filter_tensor_ptr);
     size_t cached_filter_data_size = filter.GetOpMem().get_desc().get_size();
     memcpy(cached_filter_data, filter_data, cached_filter_data_size);
+    if (!weight_cache_key.empty() && context->status().ok()) {
+      weight_cache->Insert(weight_cache_key, cached_filter_data_);
+    }
   }
 
 #ifndef ENABLE_ONEDNN_V3
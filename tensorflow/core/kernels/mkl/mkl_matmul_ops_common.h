@@ -18,7 +18,9 @@ limitations under the License.
 
 #if defined(INTEL_MKL)
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/mkl/mkl_kernel_util.h"
 #include "tensorflow/core/util/mkl_util.h"
 #include "tensorflow/core/util/onednn_env_vars.h"
+#include "tensorflow/core/util/onednn_weight_cache.h"
 #if defined(DNNL_AARCH64_USE_ACL) && defined(ENABLE_ONEDNN_OPENMP)
 #include "tensorflow/core/platform/mutex.h"
 #endif
@@ -661,6 +664,22 @@ class MklDnnMatMulOpBase : public OpKernel {
     }
 #endif  // ENABLE_ONEDNN_V3
 
+    // Other kernels, e.g. of another session serving the same model, may
+    // have reordered the same weights already.
+    OneDnnWeightCache* weight_cache = OneDnnWeightCache::Global();
+    string weight_cache_key;
+    if (weight_cache->enabled()) {
+      weight_cache_key = OneDnnWeightCache::MakeKey(
+          weight_tensor, matmul_fwd_pd->weights_desc());
+      std::optional<Tensor> shared_weight =
+          weight_cache->Lookup(weight_cache_key);
+      if (shared_weight.has_value()) {
+        weight_oi_ = *std::move(shared_weight);
+        SetCachedWeightMd(context, matmul_fwd_pd->weights_desc());
+        return;
+      }
+    }
+
     // reorder and cache the weight
     weight.SetUsrMem(weight_md, &weight_tensor);
     weight.CheckReorderToOpMem(matmul_fwd_pd.get()->weights_desc(), cpu_engine_,
@@ -678,8 +697,16 @@ class MklDnnMatMulOpBase : public OpKernel {
     void* weight_oi_t_data = weight.GetTensorBuffer(&weight_oi_);
     memcpy(weight_oi_t_data, weight_data, weight_size);
 
-    // cache the memory descriptor
-    auto expected_md = matmul_fwd_pd->weights_desc();
+    SetCachedWeightMd(context, matmul_fwd_pd->weights_desc());
+    if (!weight_cache_key.empty() && context->status().ok()) {
+      weight_cache->Insert(weight_cache_key, weight_oi_);
+    }
+  }
+
+  // Caches the memory descriptor of the cached weight.
+  void SetCachedWeightMd(OpKernelContext* context,
+                         const memory::desc& expected_md)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
 #ifndef ENABLE_ONEDNN_V3
     TensorShape weight_mkl_format;
     weight_mkl_format.AddDim(sizeof(expected_md) / sizeof(Tweight));
@@ -1444,6 +1444,9 @@ BM_ImageNetSoftmaxFwd(32, 1008, 1, true, "softmax32");
 BM_ImageNetSoftmaxFwd(128, 1008, 1, true, "softmax128");
 BM_ImageNetSoftmaxFwd(8192, 1024, 1, true, "softmax32");
 BM_ImageNetSoftmaxFwd(8192, 32768, 1, true, "softmax128");
+// Attention probabilities: many short rows of a sequence length.
+BM_ImageNetSoftmaxFwd(262144, 64, 1, true, "softmax_attention64");
+BM_ImageNetSoftmaxFwd(65536, 512, 1, true, "softmax_attention512");
 
 static void BM_TopK(::testing::benchmark::State& state, int rows, int cols,
                     int k, int num_threads, bool use_gpu, const string& label) {
@@ -1526,6 +1529,11 @@ BM_TopKCPU(128, 1000, 100, 16, "topk_r_128_c_1000_k_100_th_16");
 BM_TopKCPU(128, 1000, 500, 16, "topk_r_128_c_1000_k_500_th_16");
 BM_TopKCPU(128, 1000, 1000, 16, "topk_r_128_c_1000_k_1000_th_16");
 
+// Retrieval scoring: a small k over long rows.
+BM_TopKCPU(1, 1048576, 100, 16, "topk_r_1_c_1048576_k_100_th_16");
+BM_TopKCPU(16, 1048576, 100, 16, "topk_r_16_c_1048576_k_100_th_16");
+BM_TopKCPU(128, 65536, 100, 16, "topk_r_128_c_65536_k_100_th_16");
+
 // From NMT Codebase:
 //   batch_sizes: 16, 128
 //   vocab_sizes: 10000 for small dataset, 35000 for large.
@@ -15,19 +15,39 @@ limitations under the License.
 
 // See docs in ../ops/parsing_ops.cc.
 
+#include <climits>
+#include <cstring>
+
 #include "absl/strings/escaping.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/string_bytes_buffer.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap_tensor.h"
 
 namespace tensorflow {
 
+namespace {
+
+// We only need some of the wiretype values for this code.
+enum WireType {
+  WIRETYPE_VARINT = 0,
+  WIRETYPE_LENGTH_DELIMITED = 2,
+};
+constexpr uint32 MakeTag(int field_number, WireType wire_type) {
+  return static_cast<uint32>(field_number) << 3 | wire_type;
+}
+
+}  // namespace
+
 class ParseTensorOp : public OpKernel {
  public:
   explicit ParseTensorOp(OpKernelConstruction* context) : OpKernel(context) {
@@ -44,13 +64,18 @@ class ParseTensorOp : public OpKernel {
 
     auto serialized_t = serialized.scalar<tstring>();
 
+    Tensor output;
+    if (ParseTensorContent(ctx, serialized, &output)) {
+      ctx->set_output(0, output);
+      return;
+    }
+
     TensorProto proto;
     OP_REQUIRES(ctx, ParseProtoUnlimited(&proto, serialized_t()),
                 errors::InvalidArgument(
                     "Could not parse `serialized` as TensorProto, base64: ",
                     absl::Base64Escape(serialized_t())));
 
-    Tensor output;
     OP_REQUIRES_OK(ctx, ctx->device()->MakeTensorFromProto(
                             proto, ctx->output_alloc_attr(0), &output));
 
@@ -67,6 +92,96 @@ class ParseTensorOp : public OpKernel {
   }
 
  private:
+  // Decodes a TensorProto whose values are all in `tensor_content` straight
+  // from the wire format, instead of parsing it into a message and then
+  // copying the message into a tensor. The content becomes a view of the
+  // bytes of `serialized` if they are suitably aligned, and is otherwise
+  // copied once. Returns false, leaving `*output` unchanged, if `serialized`
+  // holds anything else, including anything invalid, so that the caller
+  // parses it in full and reports the same errors as ever.
+  bool ParseTensorContent(OpKernelContext* ctx, const Tensor& serialized,
+                          Tensor* output) {
+    // Values in the wrong byte order are left to ByteSwapTensor.
+    if (!port::kLittleEndian) return false;
+    const tstring& bytes = serialized.scalar<tstring>()();
+    if (bytes.size() > INT_MAX) return false;
+    protobuf::io::CodedInputStream input(
+        reinterpret_cast<const uint8*>(bytes.data()), bytes.size());
+
+    uint32 dtype = DT_INVALID;
+    TensorShapeProto shape_proto;
+    const char* content = nullptr;
+    uint32 content_size = 0;
+    while (true) {
+      const uint32 tag = input.ReadTag();
+      if (tag == 0) break;
+      switch (tag) {
+        case MakeTag(TensorProto::kDtypeFieldNumber, WIRETYPE_VARINT):
+          if (!input.ReadVarint32(&dtype)) return false;
+          break;
+        case MakeTag(TensorProto::kTensorShapeFieldNumber,
+                     WIRETYPE_LENGTH_DELIMITED): {
+          string shape_bytes;
+          uint32 size;
+          if (!input.ReadVarint32(&size) ||
+              !input.ReadString(&shape_bytes, size) ||
+              !shape_proto.MergeFromString(shape_bytes)) {
+            return false;
+          }
+          break;
+        }
+        case MakeTag(TensorProto::kVersionNumberFieldNumber, WIRETYPE_VARINT): {
+          uint32 unused_version_number;
+          if (!input.ReadVarint32(&unused_version_number)) return false;
+          break;
+        }
+        case MakeTag(TensorProto::kTensorContentFieldNumber,
+                     WIRETYPE_LENGTH_DELIMITED): {
+          // The stream reads from a flat array, so its direct buffer is the
+          // rest of `bytes`.
+          const void* data;
+          int remaining;
+          if (!input.ReadVarint32(&content_size) ||
+              !input.GetDirectBufferPointer(&data, &remaining) ||
+              static_cast<uint32>(remaining) < content_size ||
+              !input.Skip(content_size)) {
+            return false;
+          }
+          content = static_cast<const char*>(data);
+          break;
+        }
+        default:
+          // Values in the typed fields, or fields this code does not know.
+          return false;
+      }
+    }
+    if (!input.ConsumedEntireMessage()) return false;
+
+    if (static_cast<DataType>(dtype) != out_type_ ||
+        !DataTypeCanUseMemcpy(out_type_) ||
+        !TensorShape::IsValid(shape_proto)) {
+      return false;
+    }
+    const TensorShape shape(shape_proto);
+    if (shape.num_elements() * DataTypeSize(out_type_) != content_size) {
+      return false;
+    }
+    const AllocatorAttributes attr = ctx->output_alloc_attr(0);
+    if (content_size > 0 && !attr.gpu_compatible() &&
+        AliasStringBytes(serialized, out_type_, shape, content, content_size,
+                         output)) {
+      return true;
+    }
+    Tensor copy;
+    if (!ctx->allocate_temp(out_type_, shape, &copy, attr).ok()) return false;
+    if (content_size > 0) {
+      std::memcpy(const_cast<char*>(copy.tensor_data().data()), content,
+                  content_size);
+    }
+    *output = std::move(copy);
+    return true;
+  }
+
   DataType out_type_;
 };
 
@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -197,5 +199,31 @@ TEST_F(SerializeTensorOpTest, SerializeTensorOpTest_string) {
   test::ExpectTensorEqual<tstring>(parse_output, GetInput(0));
 }
 
+TEST_F(SerializeTensorOpTest, SerializeTensorOpTest_largeFloat) {
+  MakeOp<float>(TensorShape({4, 64 * 1024}),
+                [](int x) -> float { return static_cast<float>(x) / 7.f; });
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor parse_output;
+  ParseSerializedOutput<float>(GetOutput(0), &parse_output);
+  test::ExpectTensorEqual<float>(parse_output, GetInput(0));
+}
+
+TEST_F(SerializeTensorOpTest, ParseTensorOpTest_typedValues) {
+  // Values outside of `tensor_content` are parsed into a message first.
+  TensorProto proto;
+  proto.set_dtype(DT_FLOAT);
+  proto.mutable_tensor_shape()->add_dim()->set_size(3);
+  proto.set_version_number(1);
+  proto.add_float_val(1.f);
+  proto.add_float_val(2.f);
+  proto.add_float_val(3.f);
+  Tensor serialized(DT_STRING, TensorShape({}));
+  serialized.scalar<tstring>()() = proto.SerializeAsString();
+  Tensor parse_output;
+  ParseSerializedOutput<float>(&serialized, &parse_output);
+  test::ExpectTensorEqual<float>(parse_output,
+                                 test::AsTensor<float>({1.f, 2.f, 3.f}));
+}
+
 }  // namespace
 }  // namespace tensorflow
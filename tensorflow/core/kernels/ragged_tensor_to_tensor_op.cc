@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -419,7 +421,7 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
                          const vector<INDEX_TYPE>& output_index,
                          Tensor* output_tensor) = 0;
 
- private:
+ protected:
   vector<RowPartitionType> row_partition_types_;
   int ragged_rank_;
 };
@@ -488,30 +490,10 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
     int value_element_size = element_shape.num_elements();
     size_t output_index_size = output_index.size();
 
-    // Broadcast the default value to value_element_size.  (We can skip this
-    // if default_value_tensor.NumElements() == 1, since we use std::fill
-    // when that's true.)
-    const VALUE_TYPE* default_value =
-        default_value_tensor.flat<VALUE_TYPE>().data();
+    const VALUE_TYPE* default_value;
     Tensor bcast_default;  // Temporary tensor for result of broadcast
-    if (default_value_tensor.NumElements() != value_element_size &&
-        default_value_tensor.NumElements() != 1) {
-      const auto& src_shape = default_value_tensor.shape();
-      BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
-                  /*fewer_dims_optimization=*/true);
-      // Note: bcast should always be valid, since we rejected any incompatible
-      // shapes when we called ValidateDefaultValueShape().
-      OP_REQUIRES(context, bcast.IsValid(),
-                  errors::InvalidArgument("Error broadcasting default_value"));
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(default_value_tensor.dtype(),
-                                            element_shape, &bcast_default));
-      const CPUDevice& device = context->eigen_device<CPUDevice>();
-      functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
-          device, context, bcast_default, element_shape, default_value_tensor,
-          src_shape, bcast);
-      default_value = bcast_default.flat<VALUE_TYPE>().data();
-    }
+    OP_REQUIRES_OK(context, GetDefaultValue(context, element_shape,
+                                            &bcast_default, &default_value));
 
     // Loop through the output_index vector, finding contiguous regions that
     // should be copied.  Once we find the end of a contiguous region, copy it
@@ -576,6 +558,204 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
       }
     }
   }
+
+ protected:
+  // Broadcasts the default value to element_shape, the shape of one value.
+  // (We can skip this if default_value_tensor.NumElements() == 1, since
+  // callers use std::fill when that's true.) On success, *default_value points
+  // either into the default_value input or into *bcast_default.
+  Status GetDefaultValue(OpKernelContext* context,
+                         const TensorShape& element_shape,
+                         Tensor* bcast_default,
+                         const VALUE_TYPE** default_value) {
+    const auto& default_value_tensor = context->input(kDefaultValueInputIndex);
+    *default_value = default_value_tensor.flat<VALUE_TYPE>().data();
+    if (default_value_tensor.NumElements() == element_shape.num_elements() ||
+        default_value_tensor.NumElements() == 1) {
+      return absl::OkStatus();
+    }
+    const auto& src_shape = default_value_tensor.shape();
+    BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
+                /*fewer_dims_optimization=*/true);
+    // Note: bcast should always be valid, since we rejected any incompatible
+    // shapes when we called ValidateDefaultValueShape().
+    if (!bcast.IsValid()) {
+      return errors::InvalidArgument("Error broadcasting default_value");
+    }
+    TF_RETURN_IF_ERROR(context->allocate_temp(default_value_tensor.dtype(),
+                                              element_shape, bcast_default));
+    const CPUDevice& device = context->eigen_device<CPUDevice>();
+    functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
+        device, context, *bcast_default, element_shape, default_value_tensor,
+        src_shape, bcast);
+    *default_value = bcast_default->flat<VALUE_TYPE>().data();
+    return absl::OkStatus();
+  }
+};
+
+// Implements _RaggedTensorToTensorWithMask, which also emits the mask of the
+// values in the dense result, in the shape of its first ragged_rank + 1
+// dimensions. The mask holds valid_mask_value where the result was copied
+// from `values`, and padding_mask_value where it was filled with the default.
+//
+// A ragged tensor with one level of row splits, which is what sequence
+// features are, is converted row by row in parallel, writing each row of the
+// result and of its mask once. Other partitions go through the output index
+// of RaggedTensorToTensor.
+template <typename VALUE_TYPE, typename INDEX_TYPE, typename MASK_TYPE>
+class RaggedTensorToTensorWithMaskOp
+    : public RaggedTensorToTensorOp<VALUE_TYPE, INDEX_TYPE> {
+ public:
+  explicit RaggedTensorToTensorWithMaskOp(OpKernelConstruction* context)
+      : RaggedTensorToTensorOp<VALUE_TYPE, INDEX_TYPE>(context) {
+    float valid_mask_value;
+    float padding_mask_value;
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("valid_mask_value", &valid_mask_value));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("padding_mask_value", &padding_mask_value));
+    if constexpr (std::is_same_v<MASK_TYPE, bool>) {
+      valid_mask_value_ = true;
+      padding_mask_value_ = false;
+    } else {
+      valid_mask_value_ = static_cast<MASK_TYPE>(valid_mask_value);
+      padding_mask_value_ = static_cast<MASK_TYPE>(padding_mask_value);
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    if (HasValidRowSplits(context)) {
+      ComputeFromRowSplits(context);
+      return;
+    }
+    RaggedTensorToTensorBaseOp<INDEX_TYPE>::Compute(context);
+    if (!context->status().ok()) return;
+    // SetOutput() is not called for an empty result.
+    if (context->mutable_output(1) == nullptr) {
+      TensorShape mask_shape = context->mutable_output(0)->shape();
+      mask_shape.RemoveDimRange(this->ragged_rank_ + 1, mask_shape.dims());
+      Tensor* mask_tensor = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(1, mask_shape, &mask_tensor));
+    }
+  }
+
+  void SetOutput(OpKernelContext* context, int ragged_rank,
+                 const vector<INDEX_TYPE>& output_index,
+                 Tensor* output_tensor) override {
+    RaggedTensorToTensorOp<VALUE_TYPE, INDEX_TYPE>::SetOutput(
+        context, ragged_rank, output_index, output_tensor);
+    if (!context->status().ok()) return;
+
+    // The output index counts in values, which are the elements of the mask.
+    TensorShape mask_shape = output_tensor->shape();
+    mask_shape.RemoveDimRange(ragged_rank + 1, mask_shape.dims());
+    Tensor* mask_tensor = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, mask_shape, &mask_tensor));
+    auto mask = mask_tensor->flat<MASK_TYPE>();
+    mask.setConstant(padding_mask_value_);
+    for (const INDEX_TYPE dst_i : output_index) {
+      if (dst_i >= 0) mask(dst_i) = valid_mask_value_;
+    }
+  }
+
+ private:
+  // Returns true if the input is a single level of row splits that the row
+  // parallel conversion can read without further checks. Anything else,
+  // including invalid splits, goes through the generic conversion, which
+  // reports the errors of RaggedTensorToTensor.
+  bool HasValidRowSplits(OpKernelContext* context) const {
+    if (this->row_partition_types_.size() != 1 ||
+        this->row_partition_types_[0] != RowPartitionType::ROW_SPLITS) {
+      return false;
+    }
+    const Tensor& values_tensor = context->input(kValueInputIndex);
+    const Tensor& splits_tensor = context->input(kFirstPartitionInputIndex);
+    if (values_tensor.dims() < 1 || splits_tensor.dims() != 1 ||
+        splits_tensor.NumElements() == 0) {
+      return false;
+    }
+    const auto splits = splits_tensor.vec<INDEX_TYPE>();
+    if (splits(0) != 0) return false;
+    for (int64_t i = 1; i < splits.size(); ++i) {
+      if (splits(i) < splits(i - 1)) return false;
+    }
+    return splits(splits.size() - 1) <= values_tensor.dim_size(0);
+  }
+
+  void ComputeFromRowSplits(OpKernelContext* context) {
+    const Tensor& values_tensor = context->input(kValueInputIndex);
+    const Tensor& default_value_tensor =
+        context->input(kDefaultValueInputIndex);
+    const auto splits = context->input(kFirstPartitionInputIndex)
+                            .vec<INDEX_TYPE>();
+    const int64_t num_rows = splits.size() - 1;
+
+    vector<INDEX_TYPE> output_size;
+    OP_REQUIRES_OK(context,
+                   this->CalculateOutputSize(num_rows, context, &output_size));
+    TensorShape output_shape;
+    OP_REQUIRES_OK(context,
+                   TensorShapeUtils::MakeShape(output_size, &output_shape));
+    TensorShape mask_shape = output_shape;
+    mask_shape.RemoveDimRange(2, mask_shape.dims());
+    Tensor* output_tensor = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output_tensor));
+    Tensor* mask_tensor = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, mask_shape, &mask_tensor));
+    if (mask_tensor->NumElements() == 0) return;
+
+    TensorShape element_shape = output_shape;
+    element_shape.RemoveDimRange(0, 2);
+    const int64_t value_element_size = element_shape.num_elements();
+    const VALUE_TYPE* default_value;
+    Tensor bcast_default;
+    OP_REQUIRES_OK(context, this->GetDefaultValue(context, element_shape,
+                                                  &bcast_default,
+                                                  &default_value));
+    const bool fill_default = default_value_tensor.NumElements() == 1;
+
+    const VALUE_TYPE* values_base = values_tensor.flat<VALUE_TYPE>().data();
+    VALUE_TYPE* output_base = output_tensor->flat<VALUE_TYPE>().data();
+    MASK_TYPE* mask_base = mask_tensor->flat<MASK_TYPE>().data();
+    const int64_t width = output_size[1];
+    const int64_t row_size = width * value_element_size;
+    auto convert_rows = [&](int64_t begin_row, int64_t end_row) {
+      for (int64_t row = begin_row; row < end_row; ++row) {
+        const int64_t length =
+            row < num_rows
+                ? std::min<int64_t>(splits(row + 1) - splits(row), width)
+                : 0;
+        VALUE_TYPE* dst = output_base + row * row_size;
+        const int64_t num_copied = length * value_element_size;
+        if (num_copied > 0) {
+          copy_array<VALUE_TYPE, int64_t>(
+              dst, values_base + splits(row) * value_element_size, num_copied);
+        }
+        if (fill_default) {
+          std::fill(dst + num_copied, dst + row_size, *default_value);
+        } else {
+          for (int64_t j = length; j < width; ++j) {
+            copy_array<VALUE_TYPE, int64_t>(dst + j * value_element_size,
+                                            default_value, value_element_size);
+          }
+        }
+        MASK_TYPE* mask_row = mask_base + row * width;
+        std::fill(mask_row, mask_row + length, valid_mask_value_);
+        std::fill(mask_row + length, mask_row + width, padding_mask_value_);
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, output_size[0],
+          /*cost_per_unit=*/row_size + width, convert_rows);
+  }
+
+  MASK_TYPE valid_mask_value_;
+  MASK_TYPE padding_mask_value_;
 };
 
 #define REGISTER_CPU_KERNEL_INDEX_TYPE(value_type, index_type)       \
@@ -596,6 +776,31 @@ TF_CALL_quint16(REGISTER_CPU_KERNEL);
 TF_CALL_qint16(REGISTER_CPU_KERNEL);
 
 #undef REGISTER_CPU_KERNEL
+#undef REGISTER_CPU_KERNEL_INDEX_TYPE
+
+#define REGISTER_CPU_KERNEL_MASK_TYPE(value_type, index_type, mask_type) \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_RaggedTensorToTensorWithMask")                              \
+          .Device(DEVICE_CPU)                                            \
+          .TypeConstraint<value_type>("T")                               \
+          .TypeConstraint<index_type>("Tindex")                          \
+          .TypeConstraint<mask_type>("Tmask"),                           \
+      RaggedTensorToTensorWithMaskOp<value_type, index_type, mask_type>);
+
+#define REGISTER_CPU_KERNEL_INDEX_TYPE(value_type, index_type) \
+  REGISTER_CPU_KERNEL_MASK_TYPE(value_type, index_type, bool)  \
+  REGISTER_CPU_KERNEL_MASK_TYPE(value_type, index_type, float)
+
+#define REGISTER_CPU_KERNEL(value_type)               \
+  REGISTER_CPU_KERNEL_INDEX_TYPE(value_type, int64_t) \
+  REGISTER_CPU_KERNEL_INDEX_TYPE(value_type, tensorflow::int32)
+
+TF_CALL_POD_TYPES(REGISTER_CPU_KERNEL);
+TF_CALL_string(REGISTER_CPU_KERNEL);
+
+#undef REGISTER_CPU_KERNEL
+#undef REGISTER_CPU_KERNEL_INDEX_TYPE
+#undef REGISTER_CPU_KERNEL_MASK_TYPE
 
 }  // namespace
 }  // namespace tensorflow
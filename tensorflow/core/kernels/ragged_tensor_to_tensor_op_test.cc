@@ -504,6 +504,135 @@ TEST_F(RaggedTensorToTensorOpTest, ShapeWrongDimensions) {
   EXPECT_EQ(errors::IsInvalidArgument(RunOpKernel()), true);
 }
 
+class RaggedTensorToTensorWithMaskOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for _RaggedTensorToTensorWithMask.
+  template <typename VALUE_TYPE, typename INDEX_TYPE, typename MASK_TYPE>
+  void BuildRaggedTensorToTensorWithMaskGraph(
+      const std::vector<INDEX_TYPE>& shape,
+      const std::vector<string>& row_partition_types,
+      const ShapeAndValues<VALUE_TYPE>& values,
+      const ShapeAndValues<VALUE_TYPE>& default_value,
+      const std::vector<ShapeAndValues<INDEX_TYPE>>& row_partition_tensors,
+      float valid_mask_value = 1.0f, float padding_mask_value = 0.0f) {
+    const auto& value_dtype = DataTypeToEnum<VALUE_TYPE>::v();
+    const auto& index_dtype = DataTypeToEnum<INDEX_TYPE>::v();
+    int num_row_partition_tensors = row_partition_tensors.size();
+    TF_ASSERT_OK(
+        NodeDefBuilder("tested_op", "_RaggedTensorToTensorWithMask")
+            .Attr("T", value_dtype)
+            .Attr("Tindex", index_dtype)
+            .Attr("Tmask", DataTypeToEnum<MASK_TYPE>::v())
+            .Attr("num_row_partition_tensors", num_row_partition_tensors)
+            .Attr("row_partition_types", row_partition_types)
+            .Attr("valid_mask_value", valid_mask_value)
+            .Attr("padding_mask_value", padding_mask_value)
+            .Input(FakeInput(index_dtype))
+            .Input(FakeInput(value_dtype))  // values
+            .Input(FakeInput(value_dtype))  // default_value
+            .Input(FakeInput(num_row_partition_tensors,
+                             index_dtype))  // row_partition_tensors
+            .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<INDEX_TYPE>(
+        TensorShape({static_cast<int64_t>(shape.size())}), shape);
+    AddInputFromArray<VALUE_TYPE>(values.shape, values.values);
+    AddInputFromArray<VALUE_TYPE>(default_value.shape, default_value.values);
+
+    for (const auto& row_partition_tensor : row_partition_tensors) {
+      AddInputFromArray<INDEX_TYPE>(row_partition_tensor.shape,
+                                    row_partition_tensor.values);
+    }
+  }
+};
+
+TEST_F(RaggedTensorToTensorWithMaskOpTest, RowSplits) {
+  // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]]
+  BuildRaggedTensorToTensorWithMaskGraph<float, int32, bool>(
+      {-1, 3},         // shape
+      {"ROW_SPLITS"},  // row_partition_types
+      createVector<float>({.1, .2, .3, .4, .5, .6, .7, .8, .9}),  // values
+      createScalar<float>(1.5),  // default_value
+      {createVector<int32>({0, 3, 3, 7, 9})}  // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      test::AsTensor<float>(
+          {.1, .2, .3, 1.5, 1.5, 1.5, .4, .5, .6, .8, .9, 1.5},
+          TensorShape({4, 3})),
+      0.01);
+  test::ExpectTensorEqual<bool>(
+      *GetOutput(1),
+      test::AsTensor<bool>({true, true, true, false, false, false, true, true,
+                            true, true, true, false},
+                           TensorShape({4, 3})));
+}
+
+TEST_F(RaggedTensorToTensorWithMaskOpTest, RowSplitsAdditiveMask) {
+  // params = [[[1, 2], [3, 4]], [], [[5, 6]]] padded to 3 rows of width 2.
+  BuildRaggedTensorToTensorWithMaskGraph<int32, int64_t, float>(
+      {4, 2, 2},       // shape
+      {"ROW_SPLITS"},  // row_partition_types
+      {TensorShape({3, 2}), {1, 2, 3, 4, 5, 6}},  // values
+      createVector<int32>({0, -1}),             // default_value
+      {createVector<int64_t>({0, 2, 2, 3})},    // row_partition_tensors
+      /*valid_mask_value=*/0.0f, /*padding_mask_value=*/-1e9f);
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0),
+      test::AsTensor<int32>(
+          {1, 2, 3, 4, 0, -1, 0, -1, 5, 6, 0, -1, 0, -1, 0, -1},
+          TensorShape({4, 2, 2})));
+  test::ExpectTensorEqual<float>(
+      *GetOutput(1),
+      test::AsTensor<float>({0, 0, -1e9, -1e9, 0, -1e9, -1e9, -1e9},
+                            TensorShape({4, 2})));
+}
+
+TEST_F(RaggedTensorToTensorWithMaskOpTest, ValueRowIds) {
+  // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]]
+  BuildRaggedTensorToTensorWithMaskGraph<float, int32, bool>(
+      {4, 4},                              // shape
+      {"FIRST_DIM_SIZE", "VALUE_ROWIDS"},  // row_partition_types
+      createVector<float>({.1, .2, .3, .4, .5, .6, .7, .8, .9}),  // values
+      createScalar<float>(1.5),  // default_value
+      {createScalar<int32>(4), createVector<int32>({0, 0, 0, 2, 2, 2, 2, 3, 3})}
+      // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({.1, .2, .3, 1.5, 1.5, 1.5, 1.5, 1.5, .4, .5, .6,
+                             .7, .8, .9, 1.5, 1.5},
+                            TensorShape({4, 4})),
+      0.01);
+  test::ExpectTensorEqual<bool>(
+      *GetOutput(1),
+      test::AsTensor<bool>({true, true, true, false, false, false, false,
+                            false, true, true, true, true, true, true, false,
+                            false},
+                           TensorShape({4, 4})));
+}
+
+TEST_F(RaggedTensorToTensorWithMaskOpTest, InvalidRowSplits) {
+  BuildRaggedTensorToTensorWithMaskGraph<float, int32, bool>(
+      {-1, -1},        // shape
+      {"ROW_SPLITS"},  // row_partition_types
+      createVector<float>({.1, .2, .3}),      // values
+      createScalar<float>(0),                 // default_value
+      {createVector<int32>({0, 2, 1, 3})}     // row_partition_tensors
+  );
+  // Falls back to RaggedTensorToTensor, which rejects the splits.
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
 class RaggedTensorToTensorOpUnknownShapeTest
     : public ::tensorflow::OpsTestBase {
  protected:
@@ -555,5 +684,15 @@ TEST_F(RaggedTensorToTensorOpUnknownShapeTest, RowSplits) {
   INFER_OK(*op_, "?;[3,2,7];[2,7];[6]", "[?,?,2,7]");
 }
 
+TEST_F(RaggedTensorToTensorOpUnknownShapeTest, WithMask) {
+  SetAttributes(absl::Span<const string>{"ROW_SPLITS"}, 1);
+  op_->name = "_RaggedTensorToTensorWithMask";
+  (*op_->node_def.mutable_attr())["Tmask"].set_type(DT_BOOL);
+
+  INFER_OK(*op_, "?;?;?;?", "?;[?,?]");
+  INFER_OK(*op_, "?;[3];[];[6]", "[?,?];[?,?]");
+  INFER_OK(*op_, "?;[3,2,7];[2,7];[6]", "[?,?,2,7];[?,?]");
+}
+
 }  // namespace
 }  // namespace tensorflow
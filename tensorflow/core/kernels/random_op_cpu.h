@@ -21,6 +21,7 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -72,6 +73,51 @@ struct FillPhiloxRandom {
   }
 };
 
+// A generator that replays Philox results generated ahead of time with
+// PhiloxRandom::GenerateBatch.
+class PhiloxBatchReplay {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+  static constexpr int kElementCost = PhiloxRandom::kElementCost;
+
+  explicit PhiloxBatchReplay(const ResultType* results) : next_(results) {}
+
+  ResultType operator()() { return *next_++; }
+
+ private:
+  const ResultType* next_;
+};
+
+// Distributions that draw exactly one Philox result per output group and have
+// no state can be fed from batches of pregenerated results. `Replay` is the
+// same distribution drawing from a PhiloxBatchReplay.
+template <class Distribution>
+struct PhiloxBatchDistribution {
+  static constexpr bool kEnabled = false;
+};
+
+template <typename T>
+struct PhiloxBatchDistribution<random::UniformDistribution<PhiloxRandom, T>> {
+  static constexpr bool kEnabled =
+      std::is_empty<random::UniformDistribution<PhiloxRandom, T>>::value;
+  using Replay = random::UniformDistribution<PhiloxBatchReplay, T>;
+};
+
+template <typename T>
+struct PhiloxBatchDistribution<random::NormalDistribution<PhiloxRandom, T>> {
+  static constexpr bool kEnabled = true;
+  using Replay = random::NormalDistribution<PhiloxBatchReplay, T>;
+};
+
+template <typename T>
+struct PhiloxBatchDistribution<
+    random::UniformFullIntDistribution<PhiloxRandom, T>> {
+  static constexpr bool kEnabled = true;
+  using Replay = random::UniformFullIntDistribution<PhiloxBatchReplay, T>;
+};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -90,7 +136,25 @@ struct FillPhiloxRandomTask<Distribution, false> {
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64_t index = start_group; index < limit_group_full; ++index) {
+    int64_t index = start_group;
+    if constexpr (PhiloxBatchDistribution<Distribution>::kEnabled) {
+      // Generate the Philox results of several groups at once, which
+      // vectorizes their rounds, then transform them in order. The samples
+      // are the same as when generating one group at a time.
+      constexpr int kBatchSize = PhiloxRandom::kBatchSize;
+      typename PhiloxBatchDistribution<Distribution>::Replay replay_dist;
+      PhiloxRandom::ResultType results[kBatchSize];
+      for (; index + kBatchSize <= limit_group_full; index += kBatchSize) {
+        gen.GenerateBatch(results, kBatchSize);
+        PhiloxBatchReplay replay(results);
+        for (int i = 0; i < kBatchSize; ++i) {
+          auto samples = replay_dist(&replay);
+          std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
+          offset += kGroupSize;
+        }
+      }
+    }
+    for (; index < limit_group_full; ++index) {
       auto samples = dist(&gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
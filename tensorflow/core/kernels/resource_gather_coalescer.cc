@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/resource_gather_coalescer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/util.h"
+
+namespace tensorflow {
+
+struct ResourceGatherCoalescer::Request {
+  const Tensor* indices;
+  Tensor* out;
+  absl::Status status;
+  Notification done;
+};
+
+ResourceGatherCoalescer* ResourceGatherCoalescer::Global() {
+  static ResourceGatherCoalescer* coalescer = [] {
+    int64_t window_us;
+    absl::Status s = ReadInt64FromEnvVar(
+        "TF_RESOURCE_GATHER_COALESCING_WINDOW_US", 0, &window_us);
+    if (!s.ok()) {
+      LOG(ERROR) << s.message();
+      return static_cast<ResourceGatherCoalescer*>(nullptr);
+    }
+    if (window_us <= 0) return static_cast<ResourceGatherCoalescer*>(nullptr);
+    VLOG(1) << "Coalescing ResourceGather ops within " << window_us << "us";
+    return new ResourceGatherCoalescer(window_us);
+  }();
+  return coalescer;
+}
+
+absl::Status ResourceGatherCoalescer::Gather(Var* var, const Tensor& indices,
+                                             Tensor* out) {
+  Request request;
+  request.indices = &indices;
+  request.out = out;
+  bool leader;
+  {
+    mutex_lock l(mu_);
+    std::vector<Request*>& batch = batches_[var];
+    leader = batch.empty();
+    batch.push_back(&request);
+  }
+  if (!leader) {
+    request.done.WaitForNotification();
+    return request.status;
+  }
+
+  Env::Default()->SleepForMicroseconds(window_us_);
+  std::vector<Request*> requests;
+  {
+    mutex_lock l(mu_);
+    auto it = batches_.find(var);
+    requests = std::move(it->second);
+    batches_.erase(it);
+  }
+  RunBatch(var, requests);
+  for (Request* r : requests) {
+    if (r != &request) r->done.Notify();
+  }
+  return request.status;
+}
+
+void ResourceGatherCoalescer::RunBatch(Var* var,
+                                       const std::vector<Request*>& requests) {
+  tf_shared_lock ml(*var->mu());
+  const Tensor& params = *var->tensor();
+  if (!params.IsInitialized() || params.dims() < 1) {
+    for (Request* r : requests) {
+      r->status =
+          errors::InvalidArgument("params must be at least 1 dimensional");
+    }
+    return;
+  }
+  const int64_t num_rows = params.dim_size(0);
+  int64_t row_elements = 1;
+  for (int i = 1; i < params.dims(); ++i) {
+    row_elements *= params.dim_size(i);
+  }
+  const int64_t row_bytes = row_elements * DataTypeSize(params.dtype());
+
+  // One entry per gathered row of every request, sorted by row so that each
+  // distinct row is read once and rows are read in memory order.
+  struct Entry {
+    int64_t row;
+    int request;
+    int64_t position;
+  };
+  std::vector<Entry> entries;
+  for (int i = 0; i < requests.size(); ++i) {
+    Request* r = requests[i];
+    const Tensor& indices = *r->indices;
+    const int64_t n = indices.NumElements();
+    if (r->out->dtype() != params.dtype() ||
+        r->out->NumElements() != n * row_elements) {
+      // The variable was assigned a new shape since the output was allocated.
+      r->status = errors::FailedPrecondition(
+          "Variable shape ", params.shape().DebugString(),
+          " changed during the gather");
+      continue;
+    }
+    const bool int32_indices = indices.dtype() == DT_INT32;
+    const int32* indices32 = int32_indices ? indices.flat<int32>().data()
+                                           : nullptr;
+    const int64_t* indices64 =
+        int32_indices ? nullptr : indices.flat<int64_t>().data();
+    const size_t first_entry = entries.size();
+    for (int64_t j = 0; j < n; ++j) {
+      const int64_t row = int32_indices ? indices32[j] : indices64[j];
+      if (row < 0 || row >= num_rows) {
+        r->status = errors::InvalidArgument(
+            "indices", SliceDebugString(indices.shape(), j), " = ", row,
+            " is not in [0, ", num_rows, ")");
+        entries.resize(first_entry);
+        break;
+      }
+      entries.push_back({row, i, j});
+    }
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.row < b.row; });
+
+  const char* params_data = params.tensor_data().data();
+  const char* src = nullptr;
+  int64_t src_row = -1;
+  for (const Entry& e : entries) {
+    if (e.row != src_row) {
+      src_row = e.row;
+      src = params_data + src_row * row_bytes;
+    }
+    char* out_data =
+        const_cast<char*>(requests[e.request]->out->tensor_data().data());
+    std::memcpy(out_data + e.position * row_bytes, src, row_bytes);
+  }
+}
+
+}  // namespace tensorflow
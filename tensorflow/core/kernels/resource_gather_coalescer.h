@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_RESOURCE_GATHER_COALESCER_H_
+#define TENSORFLOW_CORE_KERNELS_RESOURCE_GATHER_COALESCER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Coalesces concurrent gathers from the same resource variable.
+//
+// On a parameter server, the embedding lookups of many workers arrive as
+// separate `ResourceGather` ops on the same variable. The first gather from a
+// variable waits for a short window, during which later gathers from the
+// variable join it. All of them are then served under one acquisition of the
+// variable's lock, reading each distinct row once, in row order, and copying
+// it to every output that needs it.
+//
+// Gathers block for up to the window, so the window should be small compared
+// to the step time (e.g. a few hundred microseconds).
+//
+// This class is thread-safe.
+class ResourceGatherCoalescer {
+ public:
+  // Returns the process-wide coalescer, whose window is set with the
+  // TF_RESOURCE_GATHER_COALESCING_WINDOW_US environment variable. Returns
+  // nullptr if the variable is unset or 0, which disables coalescing.
+  static ResourceGatherCoalescer* Global();
+
+  explicit ResourceGatherCoalescer(int64_t window_us)
+      : window_us_(window_us) {}
+
+  ResourceGatherCoalescer(const ResourceGatherCoalescer&) = delete;
+  void operator=(const ResourceGatherCoalescer&) = delete;
+
+  // Gathers the rows `indices` of the first dimension of `var`'s tensor into
+  // `out`. `indices` is a non-empty DT_INT32 or DT_INT64 tensor, and `out` has
+  // the variable's dtype, which must support memcpy, and shape
+  // `indices.shape + var.shape[1:]`. The caller must not hold `var->mu()`.
+  absl::Status Gather(Var* var, const Tensor& indices, Tensor* out);
+
+ private:
+  struct Request;
+
+  // Serves `requests`, which are all gathers from `var`.
+  static void RunBatch(Var* var, const std::vector<Request*>& requests);
+
+  const int64_t window_us_;
+
+  mutex mu_;
+  // The gathers from each variable that wait for their window to end.
+  absl::flat_hash_map<Var*, std::vector<Request*>> batches_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_RESOURCE_GATHER_COALESCER_H_
@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/resource_gather_coalescer.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+constexpr int64_t kWindowUs = 10 * 1000;
+
+// Returns a [num_rows, 2] float variable whose row `i` is [i, -i].
+core::RefCountPtr<Var> MakeVar(int64_t num_rows) {
+  core::RefCountPtr<Var> var(new Var(DT_FLOAT));
+  *var->tensor() = Tensor(DT_FLOAT, TensorShape({num_rows, 2}));
+  auto params = var->tensor()->matrix<float>();
+  for (int64_t i = 0; i < num_rows; ++i) {
+    params(i, 0) = i;
+    params(i, 1) = -i;
+  }
+  var->is_initialized = true;
+  return var;
+}
+
+template <typename Index>
+Tensor ExpectedRows(const std::vector<Index>& ids) {
+  Tensor expected(DT_FLOAT, TensorShape({static_cast<int64_t>(ids.size()), 2}));
+  for (int i = 0; i < ids.size(); ++i) {
+    expected.matrix<float>()(i, 0) = ids[i];
+    expected.matrix<float>()(i, 1) = -ids[i];
+  }
+  return expected;
+}
+
+TEST(ResourceGatherCoalescerTest, ConcurrentGathers) {
+  ResourceGatherCoalescer coalescer(kWindowUs);
+  core::RefCountPtr<Var> var = MakeVar(100);
+
+  constexpr int kNumGathers = 8;
+  std::vector<std::vector<int64_t>> ids(kNumGathers);
+  std::vector<Tensor> indices(kNumGathers);
+  std::vector<Tensor> outputs(kNumGathers);
+  std::vector<absl::Status> statuses(kNumGathers);
+  for (int i = 0; i < kNumGathers; ++i) {
+    // Overlapping and repeated ids.
+    ids[i] = {i, 7, i * 10, 7, 99 - i};
+    indices[i] = test::AsTensor<int64_t>(ids[i]);
+    outputs[i] = Tensor(DT_FLOAT, TensorShape({5, 2}));
+  }
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumGathers);
+    for (int i = 0; i < kNumGathers; ++i) {
+      pool.Schedule([&, i] {
+        statuses[i] = coalescer.Gather(var.get(), indices[i], &outputs[i]);
+      });
+    }
+  }
+  for (int i = 0; i < kNumGathers; ++i) {
+    TF_EXPECT_OK(statuses[i]);
+    test::ExpectTensorEqual<float>(outputs[i], ExpectedRows(ids[i]));
+  }
+}
+
+TEST(ResourceGatherCoalescerTest, Int32Indices) {
+  ResourceGatherCoalescer coalescer(kWindowUs);
+  core::RefCountPtr<Var> var = MakeVar(10);
+  const std::vector<int32> ids = {3, 0, 9, 3};
+  Tensor out(DT_FLOAT, TensorShape({4, 2}));
+  TF_ASSERT_OK(coalescer.Gather(var.get(), test::AsTensor<int32>(ids), &out));
+  test::ExpectTensorEqual<float>(out, ExpectedRows(ids));
+}
+
+TEST(ResourceGatherCoalescerTest, BadIndexFailsOnlyItsGather) {
+  ResourceGatherCoalescer coalescer(kWindowUs);
+  core::RefCountPtr<Var> var = MakeVar(10);
+  Tensor good_indices = test::AsTensor<int64_t>({1, 2});
+  Tensor bad_indices = test::AsTensor<int64_t>({1, 10});
+  Tensor good_out(DT_FLOAT, TensorShape({2, 2}));
+  Tensor bad_out(DT_FLOAT, TensorShape({2, 2}));
+  absl::Status good_status, bad_status;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 2);
+    pool.Schedule([&] {
+      good_status = coalescer.Gather(var.get(), good_indices, &good_out);
+    });
+    pool.Schedule([&] {
+      bad_status = coalescer.Gather(var.get(), bad_indices, &bad_out);
+    });
+  }
+  TF_EXPECT_OK(good_status);
+  test::ExpectTensorEqual<float>(good_out,
+                                 ExpectedRows(std::vector<int64_t>{1, 2}));
+  EXPECT_THAT(bad_status, StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(ResourceGatherCoalescerTest, ShapeChangedSinceAllocation) {
+  ResourceGatherCoalescer coalescer(kWindowUs);
+  core::RefCountPtr<Var> var = MakeVar(10);
+  Tensor out(DT_FLOAT, TensorShape({1, 3}));
+  EXPECT_THAT(coalescer.Gather(var.get(), test::AsTensor<int64_t>({1}), &out),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
+}  // namespace
+}  // namespace tensorflow
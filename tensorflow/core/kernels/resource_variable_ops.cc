@@ -73,6 +73,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/kernels/gather_functor.h"
 #include "tensorflow/core/kernels/gather_nd_op.h"
+#include "tensorflow/core/kernels/resource_gather_coalescer.h"
 #include "tensorflow/core/kernels/resource_variable_ops.h"
 #include "tensorflow/core/kernels/resource_variable_util.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
@@ -721,6 +722,14 @@ class ResourceGatherOp : public OpKernel {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
     OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    if (std::is_same<Device, CPUDevice>::value && batch_dims_ == 0 &&
+        DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+      ResourceGatherCoalescer* coalescer = ResourceGatherCoalescer::Global();
+      if (coalescer != nullptr) {
+        ComputeCoalesced(c, coalescer, v.get());
+        return;
+      }
+    }
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -811,6 +820,36 @@ class ResourceGatherOp : public OpKernel {
   }
 
  private:
+  // Gathers with `coalescer`, which batches this gather with concurrent
+  // gathers from the same variable. Requires batch_dims == 0.
+  void ComputeCoalesced(OpKernelContext* c,
+                        ResourceGatherCoalescer* coalescer, Var* v) {
+    const Tensor& indices = c->input(1);
+    Tensor* out = nullptr;
+    {
+      tf_shared_lock ml(*v->mu());
+      const Tensor& params = *v->tensor();
+      OP_REQUIRES(
+          c, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+          errors::InvalidArgument("params must be at least 1 dimensional"));
+      OP_REQUIRES(
+          c, params.dim_size(0) <= std::numeric_limits<Index>::max(),
+          errors::InvalidArgument("params.shape[0] too large for ",
+                                  DataTypeString(DataTypeToEnum<Index>::v()),
+                                  " indexing: ", params.dim_size(0), " > ",
+                                  std::numeric_limits<Index>::max()));
+      TensorShape result_shape = indices.shape();
+      for (int i = 1; i < params.dims(); ++i) {
+        OP_REQUIRES_OK(c, result_shape.AddDimWithStatus(params.dim_size(i)));
+      }
+      OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, &out));
+    }
+    // The coalescer takes the variable's lock itself.
+    if (indices.NumElements() > 0) {
+      OP_REQUIRES_OK(c, coalescer->Gather(v, indices, out));
+    }
+  }
+
   // Add the batch offset derived from params to each batch of indices.
   // Example: batch_dims = 1, indices = [[0, 1, 2], [0, 1, 2]]
   // If indexing into a params dimension of size 4, then the indices will become
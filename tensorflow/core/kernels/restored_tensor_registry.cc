@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/restored_tensor_registry.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace checkpoint {
+
+RestoredTensorRegistry* RestoredTensorRegistry::Global() {
+  static RestoredTensorRegistry* registry = new RestoredTensorRegistry();
+  return registry;
+}
+
+int64_t RestoredTensorRegistry::MinBytesFromEnv() {
+  static const int64_t min_bytes = [] {
+    int64_t value;
+    absl::Status s =
+        ReadInt64FromEnvVar("TF_SHARE_RESTORED_TENSORS_MIN_BYTES", 0, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.message();
+      return int64_t{0};
+    }
+    if (value > 0) {
+      VLOG(1) << "Sharing restored tensors of at least " << value << " bytes";
+    }
+    return value;
+  }();
+  return min_bytes;
+}
+
+Tensor RestoredTensorRegistry::Share(uint32 crc32c, const Tensor& tensor) {
+  const absl::string_view data = tensor.tensor_data();
+  mutex_lock l(mu_);
+  std::vector<Tensor>& tensors = tensors_[Key(crc32c, data.size())];
+  for (const Tensor& t : tensors) {
+    // Checksums collide, so the contents are compared as well.
+    if (t.dtype() == tensor.dtype() && t.shape().IsSameSize(tensor.shape()) &&
+        t.tensor_data() == data) {
+      return t;
+    }
+  }
+  tensors.push_back(tensor);
+  return tensor;
+}
+
+void RestoredTensorRegistry::RemoveUnused() {
+  mutex_lock l(mu_);
+  for (auto it = tensors_.begin(); it != tensors_.end();) {
+    std::vector<Tensor>& tensors = it->second;
+    tensors.erase(std::remove_if(tensors.begin(), tensors.end(),
+                                 [](const Tensor& t) {
+                                   return t.RefCountIsOne();
+                                 }),
+                  tensors.end());
+    if (tensors.empty()) {
+      tensors_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+int RestoredTensorRegistry::size() const {
+  mutex_lock l(mu_);
+  int size = 0;
+  for (const auto& [key, tensors] : tensors_) size += tensors.size();
+  return size;
+}
+
+}  // namespace checkpoint
+}  // namespace tensorflow
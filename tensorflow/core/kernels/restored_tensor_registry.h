@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_RESTORED_TENSOR_REGISTRY_H_
+#define TENSORFLOW_CORE_KERNELS_RESTORED_TENSOR_REGISTRY_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace checkpoint {
+
+// Shares the buffers of identical tensors restored from checkpoints, so that
+// loading a new version of a model next to the old one only allocates the
+// variables that changed.
+//
+// Tensors are looked up by the checksum stored in the bundle and their size,
+// and are only shared when their contents are equal. The registry holds a
+// reference to each tensor it knows of; `RemoveUnused()` drops the tensors
+// that no one else refers to anymore, e.g. once the old model was unloaded.
+//
+// This class is thread-safe.
+class RestoredTensorRegistry {
+ public:
+  // Returns the process-wide registry.
+  static RestoredTensorRegistry* Global();
+
+  // Returns the TF_SHARE_RESTORED_TENSORS_MIN_BYTES environment variable, or
+  // 0 if it is unset, which disables sharing. Only tensors of at least this
+  // many bytes are shared.
+  static int64_t MinBytesFromEnv();
+
+  RestoredTensorRegistry() = default;
+  RestoredTensorRegistry(const RestoredTensorRegistry&) = delete;
+  void operator=(const RestoredTensorRegistry&) = delete;
+
+  // Returns a registered tensor equal to `tensor`, whose contents have the
+  // checksum `crc32c`, or registers `tensor` and returns it if there is none.
+  // REQUIRES: DataTypeCanUseMemcpy(tensor.dtype())
+  Tensor Share(uint32 crc32c, const Tensor& tensor);
+
+  // Drops the registered tensors that are only referred to by the registry.
+  void RemoveUnused();
+
+  // Returns the number of registered tensors.
+  int size() const;
+
+ private:
+  // The checksum and the size in bytes of the tensors.
+  using Key = std::pair<uint32, size_t>;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<Key, std::vector<Tensor>> tensors_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace checkpoint
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_RESTORED_TENSOR_REGISTRY_H_
@@ -0,0 +1,73 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/restored_tensor_registry.h"
+
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace checkpoint {
+namespace {
+
+TEST(RestoredTensorRegistryTest, SharesEqualTensors) {
+  RestoredTensorRegistry registry;
+  Tensor a = test::AsTensor<float>({1, 2, 3});
+  EXPECT_TRUE(registry.Share(/*crc32c=*/7, a).SharesBufferWith(a));
+
+  // Another restore of the same contents.
+  Tensor b = test::AsTensor<float>({1, 2, 3});
+  EXPECT_TRUE(registry.Share(/*crc32c=*/7, b).SharesBufferWith(a));
+  EXPECT_EQ(registry.size(), 1);
+}
+
+TEST(RestoredTensorRegistryTest, DoesNotShareDifferentTensors) {
+  RestoredTensorRegistry registry;
+  Tensor a = test::AsTensor<float>({1, 2, 3});
+  registry.Share(/*crc32c=*/7, a);
+
+  // The same checksum, but different contents.
+  Tensor b = test::AsTensor<float>({1, 2, 4});
+  EXPECT_TRUE(registry.Share(/*crc32c=*/7, b).SharesBufferWith(b));
+  // The same bytes, but a different dtype.
+  Tensor c(DT_INT32, TensorShape({3}));
+  std::memcpy(c.data(), a.data(), a.TotalBytes());
+  EXPECT_TRUE(registry.Share(/*crc32c=*/7, c).SharesBufferWith(c));
+  // The same contents, but a different shape.
+  Tensor d = test::AsTensor<float>({1, 2, 3}, TensorShape({3, 1}));
+  EXPECT_TRUE(registry.Share(/*crc32c=*/7, d).SharesBufferWith(d));
+  EXPECT_EQ(registry.size(), 4);
+}
+
+TEST(RestoredTensorRegistryTest, RemoveUnused) {
+  RestoredTensorRegistry registry;
+  Tensor a = test::AsTensor<float>({1, 2, 3});
+  registry.Share(/*crc32c=*/7, a);
+  registry.Share(/*crc32c=*/8, test::AsTensor<float>({4, 5, 6}));
+  EXPECT_EQ(registry.size(), 2);
+
+  registry.RemoveUnused();
+  EXPECT_EQ(registry.size(), 1);
+  a = Tensor();
+  registry.RemoveUnused();
+  EXPECT_EQ(registry.size(), 0);
+}
+
+}  // namespace
+}  // namespace checkpoint
+}  // namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/restored_tensor_registry.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -251,6 +253,29 @@ namespace {
 // Tensors larger than this threshold will be restored from a thread-pool.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
+// Whether to restore tensors as views of the memory-mapped bundles.
+bool UseMmapFromEnv() {
+  static const bool use_mmap = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_RESTORE_USE_MMAP", false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.message();
+      return false;
+    }
+    if (value) VLOG(1) << "Restoring tensors from memory-mapped bundles";
+    return value;
+  }();
+  return use_mmap;
+}
+
+// Returns the options of the readers of the bundles to restore from.
+BundleReader::Options ReaderOptions(BundleCache* cache) {
+  BundleReader::Options options;
+  options.cache = cache;
+  options.use_mmap = UseMmapFromEnv();
+  return options;
+}
+
 // A restore operation for a single tensor.  Small tensors may be restored
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
@@ -283,9 +308,20 @@ struct RestoreOp {
     return restored_full_shape.num_elements() > kLargeShapeThreshold;
   }
 
+  // Whether a full tensor of this shape is shared with the identical tensors
+  // restored earlier. Mapped tensors already share their pages.
+  bool can_share(const TensorShape& shape) const {
+    const int64_t min_bytes =
+        checkpoint::RestoredTensorRegistry::MinBytesFromEnv();
+    return min_bytes > 0 && !UseMmapFromEnv() &&
+           DataTypeCanUseMemcpy(dtype) &&
+           shape.num_elements() * DataTypeSize(dtype) >= min_bytes;
+  }
+
   // Run this restore operation using a new BundleReader.
   void run_with_new_reader(BundleCache* cache) {
-    BundleReader reader(tsl::Env::Default(), reader_prefix, {cache, false});
+    BundleReader reader(tsl::Env::Default(), reader_prefix,
+                        ReaderOptions(cache));
     if (!reader.status().ok()) {
       status = reader.status();
       return;
@@ -304,9 +340,24 @@ struct RestoreOp {
     Tensor* restored_tensor;
     if (shape_and_slice.empty()) {
       // Lookup the full tensor.
-      TF_RETURN_IF_ERROR(
-          context->allocate_output(idx, restored_full_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, restored_tensor));
+      uint32 crc32c;
+      if (can_share(restored_full_shape) &&
+          reader->LookupCrc32c(tensor_name, &crc32c).ok()) {
+        Tensor restored;
+        TF_RETURN_IF_ERROR(
+            context->allocate_temp(dtype, restored_full_shape, &restored));
+        TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, &restored));
+        // Shares the buffer of an identical tensor restored earlier, e.g. by
+        // another version of the model.
+        context->set_output(
+            idx, checkpoint::RestoredTensorRegistry::Global()->Share(
+                     crc32c, restored));
+        restored_tensor = context->mutable_output(idx);
+      } else {
+        TF_RETURN_IF_ERROR(context->allocate_output(idx, restored_full_shape,
+                                                    &restored_tensor));
+        TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, restored_tensor));
+      }
     } else {
       // Lookup the slice.
       TensorShape parsed_full_shape;
@@ -378,9 +429,14 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                            shape_and_slices_flat(i), prefix_string, dtypes[i]});
   }
 
+  if (checkpoint::RestoredTensorRegistry::MinBytesFromEnv() > 0) {
+    // Drops the tensors of the models that were unloaded since.
+    checkpoint::RestoredTensorRegistry::Global()->RemoveUnused();
+  }
+
   tsl::Env* const env = tsl::Env::Default();
   BundleCache cache(env);
-  BundleReader default_reader(env, prefix_string, {&cache, false});
+  BundleReader default_reader(env, prefix_string, ReaderOptions(&cache));
   TF_RETURN_IF_ERROR(default_reader.status());
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
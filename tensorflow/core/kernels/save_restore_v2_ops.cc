@@ -25,7 +25,9 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -111,35 +113,37 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    // With asynchronous checkpoints, the inputs are copied and written in the
+    // background.
+    checkpoint::AsyncCheckpointWriter* async_writer =
+        checkpoint::AsyncCheckpointWriter::Global();
+    std::vector<checkpoint::BundleWriteEntry> entries(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
       const string& tensor_name = tensor_names_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
+      checkpoint::BundleWriteEntry& entry = entries[i];
+      entry.name = tensor_name;
       VLOG(2) << "Starting save of " << tensor_name;
 
       if (!shape_and_slices_flat(i).empty()) {
         const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
         TensorSlice slice(tensor.dims());
         TensorShape slice_shape;
 
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
+        OP_REQUIRES_OK(context,
+                       checkpoint::ParseShapeAndSlice(shape_spec,
+                                                      &entry.full_shape, &slice,
+                                                      &slice_shape));
         OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
                     errors::InvalidArgument("Slice in shape_and_slice "
                                             "specification does not match the "
                                             "shape of the tensor to  save: ",
                                             shape_spec, ", tensor: ",
                                             tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
+        entry.is_slice = true;
+        entry.slice = std::move(slice);
       }
+      entry.tensor = async_writer ? tensor::DeepCopy(tensor) : tensor;
 
       if (VLOG_IS_ON(5)) {
         if (tensor.dtype() == DT_FLOAT) {
@@ -160,8 +164,14 @@ class SaveV2 : public OpKernel {
 
       VLOG(2) << "Done save of " << tensor_name;
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
+    if (async_writer != nullptr) {
+      OP_REQUIRES_OK(context, async_writer->WriteAsync(
+                                  prefix_string, std::move(entries),
+                                  context->coordination_service_agent()));
+    } else {
+      OP_REQUIRES_OK(context, checkpoint::WriteTensorBundle(
+                                  Env::Default(), prefix_string, entries));
+    }
 
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
@@ -207,6 +217,11 @@ class RestoreV2 : public OpKernel {
     const string& prefix_string = prefix.scalar<tstring>()();
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
+    if (checkpoint::AsyncCheckpointWriter* async_writer =
+            checkpoint::AsyncCheckpointWriter::Global()) {
+      OP_REQUIRES_OK(context,
+                     async_writer->Wait(prefix_string, /*agent=*/nullptr));
+    }
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
     // reader as we upgrade to the V2 format.  This allows transparent upgrade.
     // We here attempt to read a V1 checkpoint, if "prefix_string" does not
@@ -287,6 +302,15 @@ class MergeV2Checkpoints : public OpKernel {
         absl::Span<const tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    if (checkpoint::AsyncCheckpointWriter* async_writer =
+            checkpoint::AsyncCheckpointWriter::Global()) {
+      // The inputs may still be written by this or other tasks.
+      for (const tstring& input_prefix : input_prefixes) {
+        OP_REQUIRES_OK(context, async_writer->Wait(
+                                    input_prefix,
+                                    context->coordination_service_agent()));
+      }
+    }
     OP_REQUIRES_OK(context,
                    tensorflow::MergeBundles(env, input_prefixes, merged_prefix,
                                             allow_missing_files_));
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "Eigen/Core"  // from @eigen_archive
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -26,7 +28,6 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/kernels/dense_update_functor.h"
 #include "tensorflow/core/platform/types.h"
-#include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -136,48 +137,76 @@ struct ScatterFunctor {
                    typename TTypes<Index>::ConstFlat indices);
 };
 
+// Applies `update(i, index)` for every position i of `indices`, where index is
+// the value of indices(i), in parallel over disjoint ranges of rows of a
+// `limit` row tensor. All the updates of a row run on the same thread in the
+// order of `indices`, so no locking is needed and the result is the one of a
+// serial loop, also for duplicate indices and non-commutative updates. Returns
+// the position of the first index not in [0, limit), before applying any
+// update, or -1.
+template <typename Index, typename UpdateFn>
+Index ParallelScatterByRowRange(OpKernelContext* c,
+                                typename TTypes<Index>::ConstFlat indices,
+                                Index limit, float cost_per_update,
+                                UpdateFn update) {
+  const Index N = static_cast<Index>(indices.size());
+  // Grab the indices and check their validity once.  Do this carefully, to
+  // avoid checking a value and grabbing it again from memory a second time (a
+  // security risk since it may change in between).
+  std::vector<Index> rows(N);
+  for (Index i = 0; i < N; ++i) {
+    rows[i] = ::tensorflow::internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(rows[i], limit)) return i;
+  }
+  // A few row ranges per thread balance skewed indices.
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *(c->device()->tensorflow_cpu_worker_threads());
+  const Index kRangesPerThread = 8;
+  const Index num_ranges =
+      std::max<Index>(1, std::min<Index>(limit, worker_threads.num_threads *
+                                                    kRangesPerThread));
+  const Index rows_per_range = (limit + num_ranges - 1) / num_ranges;
+  // Stable counting sort of the positions of `indices` by row range.
+  std::vector<Index> range_begin(num_ranges + 1, 0);
+  for (Index i = 0; i < N; ++i) ++range_begin[rows[i] / rows_per_range + 1];
+  for (Index r = 0; r < num_ranges; ++r) range_begin[r + 1] += range_begin[r];
+  std::vector<Index> next(range_begin.begin(), range_begin.end() - 1);
+  std::vector<Index> order(N);
+  for (Index i = 0; i < N; ++i) order[next[rows[i] / rows_per_range]++] = i;
+  Shard(worker_threads.num_threads, worker_threads.workers, num_ranges,
+        cost_per_update * N / num_ranges, [&](int64_t start, int64_t end) {
+          for (int64_t k = range_begin[start]; k < range_begin[end]; ++k) {
+            const Index i = order[k];
+            update(i, rows[i]);
+          }
+        });
+  return -1;
+}
+
+// Whether to scatter `N` updates with ParallelScatterByRowRange. For small N
+// the overheads of parallel execution outweigh its benefits.
+template <typename Index>
+bool ShouldScatterInParallel(OpKernelContext* c, Index N) {
+  const Index min_n_threshold = 1024;
+  return N >= min_n_threshold &&
+         c->device()->tensorflow_cpu_worker_threads()->num_threads > 1;
+}
+
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 struct ScatterFunctorBase {
   Index ParallelExecute(OpKernelContext* c, const Device& d,
                         typename TTypes<T>::Matrix params,
                         typename TTypes<T>::ConstMatrix updates,
                         typename TTypes<Index>::ConstFlat indices) {
-    const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
-    const Index kMaxLocks = 1024;
-    const Index entries_per_lock = (limit + kMaxLocks - 1) / kMaxLocks;
-    // To reduce the number of locks and the memory usage, we divide the whole
-    // index space into kMaxLocks regions with each lock serializing access to
-    // a region.
-    mutex accessed[kMaxLocks];
-    std::atomic<Index> bad_index(-1);
-    auto ParallelScatter = [&](Index start, Index end) {
-      for (Index i = start; i < end; ++i) {
-        // Grab the index and check its validity.  Do this carefully,
-        // to avoid checking the value and grabbing it again from
-        // memory a second time (a security risk since it may change in
-        // between).
-        const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, limit)) {
-          bad_index = i;
-          return;
-        }
-        const Index lock_id = index / entries_per_lock;
-        // Copy last Ndim-1 dimensions of updates[i] to params[index]
-        {
-          mutex_lock l(accessed[lock_id]);
+    const float kMovingCost = 2.5f;
+    return ParallelScatterByRowRange<Index>(
+        c, indices, limit, kMovingCost * params.dimension(1),
+        [&](Index i, Index index) {
+          // Copy last Ndim-1 dimensions of updates[i] to params[index]
           scatter_op::internal::Assign<op>::Run(params.template chip<0>(index),
                                                 updates.template chip<0>(i));
-        }
-      }
-    };
-    const float kMovingCost = 2.5f;
-    float shard_cost = kMovingCost * params.dimension(1);
-    const DeviceBase::CpuWorkerThreads& worker_threads =
-        *(c->device()->tensorflow_cpu_worker_threads());
-    Shard(worker_threads.num_threads, worker_threads.workers, N, shard_cost,
-          ParallelScatter);  // TODO: Come up with a good cost estimate.
-    return bad_index;
+        });
   }
   Index SerialExecute(OpKernelContext* c, const Device& d,
                       typename TTypes<T>::Matrix params,
@@ -203,32 +232,14 @@ struct ScatterFunctorBase {
                    typename TTypes<T>::Matrix params,
                    typename TTypes<T>::ConstMatrix updates,
                    typename TTypes<Index>::ConstFlat indices) {
-#ifdef PLATFORM_GOOGLE
-    // The parallel version is significantly slower internally. Only call the
-    // serial version for now.
-    // TODO(penporn): Avoid locking in parallelization (sort beforehand).
-    return SerialExecute(c, d, params, updates, indices);
-#else
-    // indices and params sizes were validated in DoCompute().
+    // indices and params sizes were validated in DoCompute(). Updates of the
+    // same row are applied in the order of `indices` either way, so the
+    // parallel version is also deterministic.
     const Index N = static_cast<Index>(indices.size());
-    const Index limit = static_cast<Index>(params.dimension(0));
-    const Index min_n_threshold = 1024;
-    const Index ser_par_ratio = 10000;
-    // For parallelizing the updates, duplicate entries need to be handled
-    // correctly. Multiple updates to the same index has to be serialized.
-    // This can lead to lock contention which may nullify the benefits of
-    // parallelization. Assuming uniform random distribution of the indices, we
-    // come up with a rough heuristic and determine whether the updates execute
-    // serially or parallelly. Also if 'N' is small, overheads of parallel
-    // execution outweigh its benefits and hence we check the value of N.
-    const bool execute_serial = N < min_n_threshold ||
-                                (N / limit) > ser_par_ratio ||
-                                OpDeterminismRequired();
-    if (execute_serial)
-      return SerialExecute(c, d, params, updates, indices);
-    else
+    if (ShouldScatterInParallel(c, N))
       return ParallelExecute(c, d, params, updates, indices);
-#endif  // PLATFORM_GOOGLE
+    else
+      return SerialExecute(c, d, params, updates, indices);
   }
 };
 
@@ -278,6 +289,19 @@ struct ScatterFunctorBase<CPUDevice, T, Index, scatter_op::UpdateOp::ASSIGN> {
     // indices and params sizes were validated in DoCompute().
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
+    if (ShouldScatterInParallel(c, N)) {
+      return ParallelScatterByRowRange<Index>(
+          c, indices, limit, params.dimension(1), [&](Index i, Index index) {
+            if (!std::is_same<T, tstring>::value) {
+              memmove(params.data() + index * params.dimension(1),
+                      updates.data() + i * updates.dimension(1),
+                      updates.dimension(1) * sizeof(T));
+            } else {
+              scatter_op::internal::Assign<scatter_op::UpdateOp::ASSIGN>::Run(
+                  params.template chip<0>(index), updates.template chip<0>(i));
+            }
+          });
+    }
     if (!std::is_same<T, tstring>::value) {
       for (Index i = 0; i < N; i++) {
         // Grab the index and check its validity.  Do this carefully,
@@ -329,6 +353,14 @@ struct ScatterScalarFunctorBase {
     // indices and params sizes were validated in DoCompute().
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
+    if (ShouldScatterInParallel(c, N)) {
+      return ParallelScatterByRowRange<Index>(
+          c, indices, limit, params.dimension(1), [&](Index i, Index index) {
+            // Broadcast update to params[index]
+            scatter_op::internal::Assign<op>::RunScalar(
+                params.template chip<0>(index), update());
+          });
+    }
     for (Index i = 0; i < N; i++) {
       // Grab the index and check its validity.  Do this carefully,
       // to avoid checking the value and grabbing it again from
@@ -389,6 +421,15 @@ struct ScatterScalarFunctorBase<CPUDevice, T, Index,
     // indices and params sizes were validated in DoCompute().
     const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
+    if (ShouldScatterInParallel(c, N)) {
+      return ParallelScatterByRowRange<Index>(
+          c, indices, limit, params.dimension(1), [&](Index i, Index index) {
+            // Broadcast update to params[index]
+            using AssignOp =
+                scatter_op::internal::Assign<scatter_op::UpdateOp::ASSIGN>;
+            AssignOp::RunScalar(params.template chip<0>(index), update());
+          });
+    }
     for (Index i = 0; i < N; i++) {
       // Grab the index and check its validity.  Do this carefully,
       // to avoid checking the value and grabbing it again from
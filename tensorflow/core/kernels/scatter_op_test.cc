@@ -217,6 +217,35 @@ TEST_F(ScatterSubOpTest, StressIndexTest) {
   test::ExpectTensorEqual<int32>(expected, params_tensor);
 }
 
+TEST_F(ScatterUpdateOpTest, DuplicateIndicesKeepOrder) {
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+  // Enough updates to take the parallel path, each row updated many times.
+  const int kRows = 37;
+  const int kCols = 3;
+  const int kNumUpdates = 4096;
+  std::vector<int32> indices(kNumUpdates);
+  std::vector<float> updates(kNumUpdates * kCols);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[i] = (i * 7) % kRows;
+    for (int j = 0; j < kCols; ++j) updates[i * kCols + j] = i * kCols + j;
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}),
+                           std::vector<float>(kRows * kCols, 0));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The last update of each row wins.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  auto expected_matrix = expected.matrix<float>();
+  for (int i = 0; i < kNumUpdates; ++i) {
+    for (int j = 0; j < kCols; ++j) {
+      expected_matrix(indices[i], j) = updates[i * kCols + j];
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
 TEST_F(ScatterUpdateOpTest, Error_WrongDimsIndices) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
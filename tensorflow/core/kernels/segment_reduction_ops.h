@@ -145,6 +145,20 @@ struct SparseSegmentReductionFunctor {
                     typename TTypes<T, 2>::Tensor output);
 };
 
+// Functor for the GPU kernel of _ResourceSparseSegmentReduction: reduces the
+// rows params[gather_indices[indices[i]]] into output[segment_ids[i]] without
+// gathering them first. The rows of out of range indices reduce as zeros, as
+// ResourceGather gathers zeros for them on GPU.
+template <typename T, typename Tgather, typename Index, typename SegmentId>
+struct ResourceSparseSegmentReductionFunctor {
+  Status operator()(OpKernelContext* context, bool is_mean, bool is_sqrtn,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Tgather>::ConstVec gather_indices,
+                    typename TTypes<Index>::ConstVec indices,
+                    typename TTypes<SegmentId>::ConstVec segment_ids,
+                    typename TTypes<T, 2>::Tensor output);
+};
+
 template <class Device, typename T, typename Index, typename SegmentId>
 struct SparseSegmentGradFunctor {
   void operator()(OpKernelContext* context,
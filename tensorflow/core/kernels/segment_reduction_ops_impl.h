@@ -35,7 +35,6 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
-#include "absl/container/flat_hash_map.h"
 #include "Eigen/Core"  // from @eigen_archive
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
@@ -51,8 +50,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/bfloat16.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -83,11 +85,12 @@ Status ValidateUnsortedSegmentReduction(OpKernel* op_kernel,
                                         const Tensor& data,
                                         const Tensor& segment_ids,
                                         const Tensor& num_segments);
+// `num_segments` is null if the op does not take it.
 Status ValidateSparseSegmentReduction(OpKernelContext* context,
                                       const Tensor& input,
                                       const Tensor& indices,
                                       const Tensor& segment_ids,
-                                      bool has_num_segments);
+                                      const Tensor* num_segments);
 }  // namespace internal
 
 // This operator handles reducing segments along the first dimension.
@@ -553,20 +556,27 @@ class SparseSegmentReductionOpBase : public OpKernel {
         default_value_(default_value) {}
 
   void Compute(OpKernelContext* context) override {
-    const Tensor& input = context->input(0);
-    const Tensor& indices = context->input(1);
-    const Tensor& segment_ids = context->input(2);
+    ReduceSparseSegments(context, context->input(0), context->input(1),
+                         context->input(2),
+                         has_num_segments_ ? &context->input(3) : nullptr);
+  }
 
+ protected:
+  // Reduces the rows of `input` selected by `indices` into the segments given
+  // by `segment_ids`, and sets them as output 0. `num_segments` is null if the
+  // op does not take it.
+  void ReduceSparseSegments(OpKernelContext* context, const Tensor& input,
+                            const Tensor& indices, const Tensor& segment_ids,
+                            const Tensor* num_segments) {
     OP_REQUIRES_OK(
         context, internal::ValidateSparseSegmentReduction(
-                     context, input, indices, segment_ids, has_num_segments_));
+                     context, input, indices, segment_ids, num_segments));
 
     Index output_rows = -1;
-    if (has_num_segments_) {
-      const Tensor& num_segments = context->input(3);
+    if (num_segments != nullptr) {
       // Note that there is a Tnumsegments parameter on the op, but it is not
       // plumbed through to here and so always takes its default value of int32.
-      output_rows = internal::SubtleMustCopy(num_segments.scalar<int32>()());
+      output_rows = internal::SubtleMustCopy(num_segments->scalar<int32>()());
     }
     const int64_t num_indices = indices.NumElements();
 
@@ -590,7 +600,7 @@ class SparseSegmentReductionOpBase : public OpKernel {
             ? internal::SubtleMustCopy(segment_vec(num_indices - 1)) + 1
             : 0;
 
-    if (has_num_segments_) {
+    if (num_segments != nullptr) {
       OP_REQUIRES(
           context, output_rows >= last_segment_id_plus_one,
           errors::InvalidArgument("segment ids must be < num_segments"));
@@ -618,23 +628,16 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    // If we use DT_BFLOAT16 or DT_HALF, we need to use DT_FLOAT for
-    // accumulation. We create a temp tensor to perform this accumulation for
-    // every segment.
-    Tensor temp;
-    if (input.dtype() == DT_BFLOAT16 || input.dtype() == DT_HALF) {
-      TensorShape temp_shape = output_shape;
-      OP_REQUIRES_OK(context, temp_shape.SetDimWithStatus(/*d=*/0, /*size=*/1));
-      temp = tensorflow::Tensor(DT_FLOAT, temp_shape);
-    }
-    auto temp_flat = temp.flat_outer_dims<float>();
-
-    int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
+    // Finds the segments first, so that they can be reduced in parallel. The
+    // segments before an invalid segment id are still reduced, and a bad
+    // index in them is reported first, as when reducing one segment at a time.
+    // Segment i reduces indices [segment_starts[i], segment_starts[i + 1]).
+    std::vector<int64_t> segment_starts;
+    std::vector<SegmentId> segment_out_indices;
+    Status segment_status;
+    int64_t start = 0;
     SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
+    for (int64_t end = 1;; ++end) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
       // used uninitialized in this function" in the Mac build (since the
       // compiler isn't smart enough to realize the code is safe).
@@ -642,48 +645,96 @@ class SparseSegmentReductionOpBase : public OpKernel {
       if (end < num_indices) {
         next_index = internal::SubtleMustCopy(segment_vec(end));
         if (out_index == next_index) {
-          ++end;
           continue;
         }
         // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
+        if (out_index >= next_index) {
+          segment_status =
+              errors::InvalidArgument("segment ids are not increasing");
+          break;
+        }
       }
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+      if (!FastBoundsCheck(out_index, output_rows)) {
+        segment_status = errors::InvalidArgument(
+            "Segment id ", out_index, " out of range [0, ", output_rows,
+            "), possibly because 'segment_ids' input is not sorted.");
+        break;
       }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(0);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
+      segment_starts.push_back(start);
+      segment_out_indices.push_back(out_index);
       start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
       out_index = next_index;
-      if (end > num_indices) break;
+      if (end >= num_indices) break;
     }
+    segment_starts.push_back(start);
+    const int64_t num_segments = segment_out_indices.size();
+
+    // The first bad index found, as an offset in `indices`.
+    mutex bad_index_mu;
+    int64_t bad_index = num_indices;
+    auto reduce_segments = [&](int64_t first_segment, int64_t end_segment) {
+      // If we use DT_BFLOAT16 or DT_HALF, we need to use DT_FLOAT for
+      // accumulation. We create a temp tensor to perform this accumulation for
+      // every segment.
+      Tensor temp;
+      if (input.dtype() == DT_BFLOAT16 || input.dtype() == DT_HALF) {
+        temp = tensorflow::Tensor(DT_FLOAT, TensorShape({1, num_col}));
+      }
+      auto temp_flat = temp.flat_outer_dims<float>();
+
+      for (int64_t i = first_segment; i < end_segment; ++i) {
+        const SegmentId out_index = segment_out_indices[i];
+        // Index from which the output is not initialized.
+        const SegmentId uninitialized_index =
+            i == 0 ? 0 : segment_out_indices[i - 1] + 1;
+        // If there is a gap between two indices, we need to set that gap to
+        // the default value.
+        if (out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+
+        // Starts loading the first rows of the next segment.
+        if (i + 1 < num_segments) {
+          PrefetchRows<T, Index>(
+              input_flat, indices_vec, segment_starts[i + 1],
+              std::min(segment_starts[i + 2],
+                       segment_starts[i + 1] + kNumPrefetchedRows));
+        }
+
+        auto out = output_flat.template chip<0>(out_index);
+        auto temp = temp_flat.template chip<0>(0);
+        const int64_t segment_start = segment_starts[i];
+        const int64_t bad_offset = Reduce<T, Index>(
+            input_flat, indices_vec, segment_start,
+            segment_starts[i + 1] - segment_start, out, temp);
+        if (bad_offset >= 0) {
+          mutex_lock l(bad_index_mu);
+          bad_index = std::min(bad_index, segment_start + bad_offset);
+          return;
+        }
+      }
+    };
+    // Each segment gathers its rows, which are likely cache misses, and adds
+    // them up.
+    const int64_t cost_per_segment =
+        (num_indices / std::max<int64_t>(num_segments, 1) + 1) *
+        (num_col + 100);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES(context, bad_index == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_index, "] == ", indices_vec(bad_index),
+                    " out of range [0, ", input_flat.dimension(0), ")"));
+    OP_REQUIRES_OK(context, segment_status);
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = segment_out_indices.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -719,6 +770,25 @@ class SparseSegmentReductionOpBase : public OpKernel {
     return input_flat.template chip<0>(index).template cast<float>();
   }
 
+  // The number of rows of the next indices that are prefetched while
+  // reducing the current ones.
+  static constexpr int64_t kNumPrefetchedRows = 8;
+
+  // Starts loading the rows of indices [start, end) into the cache.
+  template <typename Tin, typename Tindex>
+  EIGEN_ALWAYS_INLINE void PrefetchRows(
+      const typename TTypes<Tin>::ConstMatrix& input_flat,
+      const typename TTypes<Tindex>::ConstVec& indices_vec, int64_t start,
+      int64_t end) {
+    for (int64_t i = start; i < end; ++i) {
+      const Tindex index = indices_vec(i);
+      if (FastBoundsCheck(index, input_flat.dimension(0))) {
+        port::prefetch<port::PREFETCH_HINT_T0>(
+            input_flat.data() + index * input_flat.dimension(1));
+      }
+    }
+  }
+
   template <typename Tout>
   EIGEN_ALWAYS_INLINE Tout get_scaling_factor(int64_t num) {
     Tout m(1);
@@ -856,6 +926,9 @@ class SparseSegmentReductionOpBase : public OpKernel {
         }
       }
       for (; r < num; r += 8) {
+        PrefetchRows<Tin, Tindex>(
+            input_flat, indices_vec, start + r + 8,
+            start + std::min(num, r + 8 + kNumPrefetchedRows));
         INDEX(0, r);
         INDEX(1, r + 1);
         INDEX(2, r + 2);
@@ -910,7 +983,8 @@ class SparseSegmentReductionOpBase<GPUDevice, T, Index, SegmentId>
     OP_REQUIRES_OK_ASYNC(
         context,
         internal::ValidateSparseSegmentReduction(
-            context, input, indices, segment_ids, has_num_segments_),
+            context, input, indices, segment_ids,
+            has_num_segments_ ? &context->input(3) : nullptr),
         done);
 
     ScratchSpace<SegmentId> last_segment_id_host(context, 1, /*on_host=*/true);
@@ -1113,13 +1187,37 @@ struct SparseSegmentGradFunctor<CPUDevice, T, Index, SegmentId> {
           context, FastBoundsCheck(idx, num_segments),
           absl::InvalidArgumentError(absl::StrCat(
               "Segment id ", idx, " out of range [0, ", num_segments, ").")));
+    }
 
-      const double scale = operation == SparseSegmentReductionOperation::kSum
-                               ? 1.0
-                               : scaling[idx];
-      Accumulate<T>(input_flat.template chip<0>(idx), scale,
-                    output_flat.template chip<0>(output_idx),
-                    temp_flat.template chip<0>(output_idx));
+    auto accumulate = [&](int64_t start, int64_t end) {
+      for (int64_t i = start; i < end; ++i) {
+        const Index output_idx = indices_vec(i);
+        const SegmentId idx = segment_vec(i);
+        const double scale = operation == SparseSegmentReductionOperation::kSum
+                                 ? 1.0
+                                 : scaling[idx];
+        Accumulate<T>(input_flat.template chip<0>(idx), scale,
+                      output_flat.template chip<0>(output_idx),
+                      temp_flat.template chip<0>(output_idx));
+      }
+    };
+    if (std::is_sorted(indices_vec.data(), indices_vec.data() + N)) {
+      // Sorted indices write to each output row from one run of consecutive
+      // inputs. Each shard moves its bounds to the start of a run, so that
+      // every row is accumulated by one thread, in the same order as below.
+      auto run_start = [&](int64_t i) {
+        while (i > 0 && i < N && indices_vec(i) == indices_vec(i - 1)) ++i;
+        return i;
+      };
+      auto worker_threads =
+          context->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads->num_threads, worker_threads->workers, N,
+            /*cost_per_unit=*/2 * input_flat.dimension(1),
+            [&](int64_t start, int64_t end) {
+              accumulate(run_start(start), run_start(end));
+            });
+    } else {
+      accumulate(0, N);
     }
 
     // Copy the contents of the temp tensor to the output tensor.
@@ -1222,36 +1320,43 @@ struct SparseSegmentGradV2Functor<CPUDevice, T, Index, SegmentId> {
                                   " out of range [0, ", num_segments, ")."));
     }
 
-    std::vector<Index> permutation;
-    permutation.reserve(N);
-    for (int64_t i = 0; i < N; ++i) {
-      permutation.push_back(i);
-    }
-    std::stable_sort(
-        permutation.begin(), permutation.end(),
-        [&](Index a, Index b) { return indices_vec(a) < indices_vec(b); });
+    // Indices that are already sorted, as when they come from a lookup of
+    // sorted ids, do not need to be permuted.
+    const bool is_sorted =
+        std::is_sorted(indices_vec.data(), indices_vec.data() + N);
     std::vector<Index> sorted_indices;
     std::vector<SegmentId> permuted_segments;
-    sorted_indices.reserve(N);
-    permuted_segments.reserve(N);
-    for (Index j : permutation) {
-      sorted_indices.push_back(indices_vec(j));
-      permuted_segments.push_back(segment_vec(j));
+    if (!is_sorted) {
+      std::vector<Index> permutation;
+      permutation.reserve(N);
+      for (int64_t i = 0; i < N; ++i) {
+        permutation.push_back(i);
+      }
+      std::stable_sort(
+          permutation.begin(), permutation.end(),
+          [&](Index a, Index b) { return indices_vec(a) < indices_vec(b); });
+      sorted_indices.reserve(N);
+      permuted_segments.reserve(N);
+      for (Index j : permutation) {
+        sorted_indices.push_back(indices_vec(j));
+        permuted_segments.push_back(segment_vec(j));
+      }
     }
+    const Index* sorted_indices_data =
+        is_sorted ? indices_vec.data() : sorted_indices.data();
 
-    // Maps indices to unique index IDs.
-    absl::flat_hash_map<Index, Index> unique_indices_map;
-    // The unique ID for each original index.
+    // The unique ID for each original index. Equal indices are adjacent once
+    // sorted, so the IDs number the runs of equal indices.
     std::vector<Index> unique_index_ids;
     unique_index_ids.reserve(N);
-    for (Index output_idx : sorted_indices) {
-      auto iter =
-          unique_indices_map.emplace(output_idx, unique_indices_map.size())
-              .first;
-      Index unique_id = iter->second;
-      unique_index_ids.push_back(unique_id);
+    Index num_unique = 0;
+    for (int64_t i = 0; i < N; ++i) {
+      if (i > 0 && sorted_indices_data[i] != sorted_indices_data[i - 1]) {
+        ++num_unique;
+      }
+      unique_index_ids.push_back(num_unique);
     }
-    const int64_t num_unique = unique_indices_map.size();
+    ++num_unique;
 
     // The original index for each unique ID.
     Tensor* unique_indices = nullptr;
@@ -1259,8 +1364,8 @@ struct SparseSegmentGradV2Functor<CPUDevice, T, Index, SegmentId> {
                    context->allocate_output(1, {num_unique}, &unique_indices));
     typename TTypes<Index>::Vec unique_indices_vec =
         unique_indices->vec<Index>();
-    for (const auto& idx_and_id : unique_indices_map) {
-      unique_indices_vec(idx_and_id.second) = idx_and_id.first;
+    for (int64_t i = 0; i < N; ++i) {
+      unique_indices_vec(unique_index_ids[i]) = sorted_indices_data[i];
     }
 
     TensorShape output_shape = dense_output_shape;
@@ -1272,7 +1377,7 @@ struct SparseSegmentGradV2Functor<CPUDevice, T, Index, SegmentId> {
     typename TTypes<Index>::ConstVec unique_index_ids_vec(
         unique_index_ids.data(), unique_index_ids.size());
     typename TTypes<SegmentId>::ConstVec permuted_segment_vec(
-        permuted_segments.data(), permuted_segments.size());
+        is_sorted ? segment_vec.data() : permuted_segments.data(), N);
     SparseSegmentGradFunctor<CPUDevice, T, Index, SegmentId>()(
         context, operation, input_flat, unique_index_ids_vec,
         permuted_segment_vec, output);
@@ -62,9 +62,9 @@ Status ValidateSparseSegmentReduction(OpKernelContext* context,
                                       const Tensor& input,
                                       const Tensor& indices,
                                       const Tensor& segment_ids,
-                                      bool has_num_segments) {
-  if (has_num_segments) {
-    const Tensor& num_segments_t = context->input(3);
+                                      const Tensor* num_segments) {
+  if (num_segments != nullptr) {
+    const Tensor& num_segments_t = *num_segments;
     if (!TensorShapeUtils::IsScalar(num_segments_t.shape())) {
       return errors::InvalidArgument(
           "num_segments should be a scalar, not shape ",
@@ -0,0 +1,320 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/resource_variable_ops.cc.
+
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_impl.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+bool HasCombiner(OpKernelConstruction* context, const string& combiner) {
+  string value;
+  return context->GetAttr("combiner", &value).ok() && value == combiner;
+}
+
+}  // namespace
+
+// Implements _ResourceSparseSegmentReduction, the fusion of a ResourceGather
+// with the SparseSegment{Sum,Mean,SqrtN}[WithNumSegments] that consumes it.
+// Instead of gathering the rows of the variable into a [nnz, ...] tensor, it
+// maps `indices` through `gather_indices` and reduces the rows of the variable
+// in place, under its shared lock.
+//
+// The template parameters are:
+// * T: The value type.
+// * Tgather: The element type of the gather_indices tensor (int32 or int64).
+// * Index: The element type of the indices tensor (int32 or int64).
+// * SegmentId: The element type of the segment_ids tensor (int32 or int64).
+template <class T, typename Tgather, typename Index, typename SegmentId>
+class ResourceSparseSegmentReductionOp
+    : public SparseSegmentReductionOpBase<CPUDevice, T, int64_t, SegmentId> {
+ public:
+  explicit ResourceSparseSegmentReductionOp(OpKernelConstruction* context)
+      : SparseSegmentReductionOpBase<CPUDevice, T, int64_t, SegmentId>(
+            context, HasCombiner(context, "mean"),
+            HasCombiner(context, "sqrtn"),
+            context->num_inputs() > 4 /* has_num_segments */,
+            T(0) /* default_value */) {
+    OP_REQUIRES(context, context->num_inputs() <= 5,
+                errors::InvalidArgument(
+                    "_ResourceSparseSegmentReduction takes at most one "
+                    "num_segments, got ",
+                    context->num_inputs() - 4));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    core::RefCountPtr<Var> v;
+    OP_REQUIRES_OK(context,
+                   LookupResource(context, HandleFromInput(context, 0), &v));
+    OP_REQUIRES_OK(context,
+                   EnsureSparseVariableAccess<CPUDevice, T>(context, v.get()));
+    // As in ResourceGather, the lock is held for the whole reduction rather
+    // than taking a reference to the buffer, which would make a concurrent
+    // write copy the whole variable.
+    tf_shared_lock ml(*v->mu());
+    const Tensor& params = *v->tensor();
+    const Tensor& gather_indices = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+
+    OP_REQUIRES(context, params.dtype() == DataTypeToEnum<T>::v(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(params.dtype()), " got ",
+                    DataTypeString(DataTypeToEnum<T>::v())));
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(gather_indices.shape()),
+                errors::InvalidArgument("gather_indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+
+    // Checks the gathered rows first, as the unfused ResourceGather does.
+    const int64_t num_gathered = gather_indices.NumElements();
+    const int64_t num_rows = params.dim_size(0);
+    const auto gather_indices_vec = gather_indices.vec<Tgather>();
+    for (int64_t i = 0; i < num_gathered; ++i) {
+      const Tgather row = internal::SubtleMustCopy(gather_indices_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(row, num_rows),
+                  errors::InvalidArgument("indices[", i, "] = ", row,
+                                          " is not in [0, ", num_rows, ")"));
+    }
+
+    // Maps the indices into the gathered rows to rows of the variable. The
+    // reduction reports an out of range index of the unfused op as such, with
+    // the bound of the gathered rows.
+    const int64_t num_indices = indices.NumElements();
+    const auto indices_vec = indices.vec<Index>();
+    Tensor rows(DT_INT64, TensorShape({num_indices}));
+    auto rows_vec = rows.vec<int64_t>();
+    for (int64_t i = 0; i < num_indices; ++i) {
+      const Index index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(index, num_gathered),
+                  errors::InvalidArgument("Bad: indices[", i, "] == ", index,
+                                          " out of range [0, ", num_gathered,
+                                          ")"));
+      rows_vec(i) = gather_indices_vec(index);
+    }
+
+    this->ReduceSparseSegments(
+        context, params, rows, segment_ids,
+        context->num_inputs() > 4 ? &context->input(4) : nullptr);
+  }
+};
+
+#define REGISTER_CPU_KERNEL(type, gather_type, index_type, segment_ids_type) \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("_ResourceSparseSegmentReduction")                                \
+          .Device(DEVICE_CPU)                                                \
+          .TypeConstraint<type>("dtype")                                     \
+          .TypeConstraint<gather_type>("Tgather")                            \
+          .TypeConstraint<index_type>("Tidx")                                \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                  \
+      ResourceSparseSegmentReductionOp<type, gather_type, index_type,        \
+                                       segment_ids_type>);
+#define REGISTER_CPU_KERNEL_FOR_EACH_SEGMENT_ID_TYPE(type, gather_type, \
+                                                     index_type)        \
+  REGISTER_CPU_KERNEL(type, gather_type, index_type, int32)             \
+  REGISTER_CPU_KERNEL(type, gather_type, index_type, int64_t)
+#define REGISTER_CPU_KERNEL_FOR_EACH_INDEX_TYPE(type, gather_type)        \
+  REGISTER_CPU_KERNEL_FOR_EACH_SEGMENT_ID_TYPE(type, gather_type, int32) \
+  REGISTER_CPU_KERNEL_FOR_EACH_SEGMENT_ID_TYPE(type, gather_type, int64_t)
+#define REGISTER_CPU_KERNEL_FOR_EACH_GATHER_TYPE(type)  \
+  REGISTER_CPU_KERNEL_FOR_EACH_INDEX_TYPE(type, int32) \
+  REGISTER_CPU_KERNEL_FOR_EACH_INDEX_TYPE(type, int64_t)
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNEL_FOR_EACH_GATHER_TYPE);
+
+#undef REGISTER_CPU_KERNEL_FOR_EACH_GATHER_TYPE
+#undef REGISTER_CPU_KERNEL_FOR_EACH_INDEX_TYPE
+#undef REGISTER_CPU_KERNEL_FOR_EACH_SEGMENT_ID_TYPE
+#undef REGISTER_CPU_KERNEL
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// The GPU kernel of _ResourceSparseSegmentReduction. A single kernel looks up
+// the rows of the variable through both index tensors and reduces them per
+// segment, so neither the gathered rows nor the composed indices are ever
+// materialized. Like the unfused ops on GPU, it does not check the indices:
+// the rows of out of range ones reduce as zeros, which is what ResourceGather
+// gathers for them.
+template <class T, typename Tgather, typename Index, typename SegmentId>
+class ResourceSparseSegmentReductionGpuOp : public AsyncOpKernel {
+ public:
+  explicit ResourceSparseSegmentReductionGpuOp(OpKernelConstruction* context)
+      : AsyncOpKernel(context),
+        is_mean_(HasCombiner(context, "mean")),
+        is_sqrtn_(HasCombiner(context, "sqrtn")),
+        has_num_segments_(context->num_inputs() > 4) {
+    OP_REQUIRES(context, context->num_inputs() <= 5,
+                errors::InvalidArgument(
+                    "_ResourceSparseSegmentReduction takes at most one "
+                    "num_segments, got ",
+                    context->num_inputs() - 4));
+  }
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    core::RefCountPtr<Var> v;
+    OP_REQUIRES_OK_ASYNC(
+        context, LookupResource(context, HandleFromInput(context, 0), &v),
+        done);
+    OP_REQUIRES_OK_ASYNC(
+        context, EnsureSparseVariableAccess<GPUDevice, T>(context, v.get()),
+        done);
+    const Tensor& gather_indices = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+    OP_REQUIRES_ASYNC(
+        context, TensorShapeUtils::IsVector(gather_indices.shape()),
+        errors::InvalidArgument("gather_indices should be a vector."), done);
+    {
+      tf_shared_lock ml(*v->mu());
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          internal::ValidateSparseSegmentReduction(
+              context, *v->tensor(), indices, segment_ids,
+              has_num_segments_ ? &context->input(4) : nullptr),
+          done);
+    }
+
+    if (has_num_segments_) {
+      const SegmentId num_segments = internal::SubtleMustCopy(
+          context->input(4).scalar<int32>()());
+      Reduce(context, v.get(), num_segments);
+      done();
+      return;
+    }
+    const int64_t num_indices = indices.NumElements();
+    if (num_indices == 0) {
+      Reduce(context, v.get(), 0);
+      done();
+      return;
+    }
+
+    // As in SparseSegmentReductionOpBase<GPUDevice>, the number of segments
+    // is the last segment id plus one, which has to be copied to the host
+    // before the output can be allocated.
+    ScratchSpace<SegmentId> last_segment_id_host(context, 1, /*on_host=*/true);
+    se::DeviceMemoryBase last_segment_id_device(
+        const_cast<Tensor&>(segment_ids).template flat<SegmentId>().data() +
+        (num_indices - 1));
+    auto stream = context->op_device_context()->stream();
+    OP_REQUIRES_OK_ASYNC(
+        context,
+        stream->Memcpy(last_segment_id_host.mutable_data(),
+                       last_segment_id_device, sizeof(SegmentId)),
+        done);
+    Var* var = v.release();
+    context->device()
+        ->tensorflow_accelerator_device_info()
+        ->event_mgr->ThenExecute(
+            stream, [this, context, var, last_segment_id_host, done]() {
+              core::ScopedUnref unref(var);
+              auto stream = context->op_device_context()->stream();
+              ScopedActivateExecutorContext scoped_activation{stream->parent()};
+              const SegmentId num_segments = *last_segment_id_host.data() + 1;
+              OP_REQUIRES_ASYNC(
+                  context, num_segments > 0,
+                  errors::InvalidArgument("segment ids must be >= 0"), done);
+              Reduce(context, var, num_segments);
+              done();
+            });
+  }
+
+ private:
+  // Allocates the [num_segments, ...] output and reduces into it. Holds the
+  // shared lock of the variable until the kernel is enqueued, as
+  // ResourceGather does, which orders it before any later update of the
+  // variable on the same stream.
+  void Reduce(OpKernelContext* context, Var* var, SegmentId num_segments) {
+    tf_shared_lock ml(*var->mu());
+    const Tensor& params = *var->tensor();
+    OP_REQUIRES(context, params.dtype() == DataTypeToEnum<T>::v(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(params.dtype()), " got ",
+                    DataTypeString(DataTypeToEnum<T>::v())));
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, num_segments);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (num_segments == 0 || output->NumElements() == 0) return;
+
+    functor::ResourceSparseSegmentReductionFunctor<T, Tgather, Index,
+                                                   SegmentId>
+        functor;
+    OP_REQUIRES_OK(context,
+                   functor(context, is_mean_, is_sqrtn_,
+                           params.flat_outer_dims<T>(),
+                           context->input(1).vec<Tgather>(),
+                           context->input(2).vec<Index>(),
+                           context->input(3).vec<SegmentId>(),
+                           output->flat_outer_dims<T>()));
+  }
+
+  const bool is_mean_;
+  const bool is_sqrtn_;
+  const bool has_num_segments_;
+};
+
+#define REGISTER_GPU_KERNEL(type, gather_type, index_type, segment_ids_type) \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("_ResourceSparseSegmentReduction")                                \
+          .Device(DEVICE_GPU)                                                \
+          .HostMemory("resource")                                            \
+          .HostMemory("num_segments")                                        \
+          .TypeConstraint<type>("dtype")                                     \
+          .TypeConstraint<gather_type>("Tgather")                            \
+          .TypeConstraint<index_type>("Tidx")                                \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                  \
+      ResourceSparseSegmentReductionGpuOp<type, gather_type, index_type,     \
+                                          segment_ids_type>);
+#define REGISTER_GPU_KERNEL_FOR_EACH_SEGMENT_ID_TYPE(type, gather_type, \
+                                                     index_type)        \
+  REGISTER_GPU_KERNEL(type, gather_type, index_type, int32)             \
+  REGISTER_GPU_KERNEL(type, gather_type, index_type, int64_t)
+#define REGISTER_GPU_KERNEL_FOR_EACH_INDEX_TYPE(type, gather_type)        \
+  REGISTER_GPU_KERNEL_FOR_EACH_SEGMENT_ID_TYPE(type, gather_type, int32) \
+  REGISTER_GPU_KERNEL_FOR_EACH_SEGMENT_ID_TYPE(type, gather_type, int64_t)
+#define REGISTER_GPU_KERNEL_FOR_EACH_GATHER_TYPE(type)  \
+  REGISTER_GPU_KERNEL_FOR_EACH_INDEX_TYPE(type, int32) \
+  REGISTER_GPU_KERNEL_FOR_EACH_INDEX_TYPE(type, int64_t)
+
+TF_CALL_GPU_NUMBER_TYPES(REGISTER_GPU_KERNEL_FOR_EACH_GATHER_TYPE);
+
+#undef REGISTER_GPU_KERNEL_FOR_EACH_GATHER_TYPE
+#undef REGISTER_GPU_KERNEL_FOR_EACH_INDEX_TYPE
+#undef REGISTER_GPU_KERNEL_FOR_EACH_SEGMENT_ID_TYPE
+#undef REGISTER_GPU_KERNEL
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
@@ -0,0 +1,234 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_gpu.cu.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The lanes that reduce a segment together. The columns of a row are spread
+// over the lanes so that they read it coalesced.
+constexpr int kLanes = 32;
+// The warps of a block of either kernel.
+constexpr int kWarpsPerBlock = 8;
+// The average number of rows per segment from which a whole block, rather
+// than a single warp, reduces each segment.
+constexpr int64_t kMinRowsPerSegmentForBlock = 256;
+
+// Returns the row of params that indices[i] refers to, or -1 if any of the
+// two indices is out of range.
+template <typename Tgather, typename Index>
+__device__ int64_t GatheredRow(const Tgather* __restrict__ gather_indices,
+                               int64_t num_gathered,
+                               const Index* __restrict__ indices,
+                               int64_t num_rows, int64_t i) {
+  const Index index = GpuLdg(indices + i);
+  if (index < 0 || index >= num_gathered) return -1;
+  const Tgather row = GpuLdg(gather_indices + index);
+  return row >= 0 && row < num_rows ? row : -1;
+}
+
+// Sums column x of the rows params[gather_indices[indices[i]]] for i in
+// [begin, end) on the lanes of a warp. The lanes look up kLanes rows at a time
+// and share them, so all of them must call this, even those with !x_ok.
+template <typename T, typename Treduce, typename Tgather, typename Index,
+          typename Toffsets>
+__device__ Treduce SumGatheredRows(const T* __restrict__ params,
+                                   int64_t num_rows, int64_t ninner,
+                                   const Tgather* __restrict__ gather_indices,
+                                   int64_t num_gathered,
+                                   const Index* __restrict__ indices,
+                                   Toffsets begin, Toffsets end, int64_t x,
+                                   bool x_ok) {
+  const int lane = threadIdx.x;
+  Treduce sum(0);
+  for (Toffsets chunk = begin; chunk < end; chunk += kLanes) {
+    const int n = static_cast<int>(min(static_cast<Toffsets>(kLanes),
+                                       static_cast<Toffsets>(end - chunk)));
+    const int64_t lane_row =
+        lane < n ? GatheredRow(gather_indices, num_gathered, indices, num_rows,
+                               chunk + lane)
+                 : -1;
+    for (int j = 0; j < n; ++j) {
+      const int64_t row = GpuShuffleSync(kCudaWarpAll, lane_row, j, kLanes);
+      if (x_ok && row >= 0) {
+        sum += static_cast<Treduce>(GpuLdg(params + row * ninner + x));
+      }
+    }
+  }
+  return sum;
+}
+
+template <typename Treduce>
+__device__ Treduce SegmentScale(int64_t num_rows, bool is_mean,
+                                bool is_sqrtn) {
+  if (num_rows == 0) return Treduce(1);
+  if (is_mean) return Treduce(1) / Treduce(num_rows);
+  if (is_sqrtn) return Treduce(1) / Treduce(sqrt(static_cast<double>(num_rows)));
+  return Treduce(1);
+}
+
+// Each warp of a block reduces a segment at a time. Suits the short segments
+// of typical embedding lookups, for which a block per segment would idle most
+// of its warps.
+template <typename T, typename Treduce, typename Tgather, typename Index,
+          typename Toffsets>
+__global__ void __launch_bounds__(kLanes* kWarpsPerBlock)
+    GatherSegmentReduceWarpKernel(
+        int64_t nsegments, int64_t num_rows, int64_t ninner, bool is_mean,
+        bool is_sqrtn, const T* __restrict__ params,  // [num_rows, ninner]
+        const Tgather* __restrict__ gather_indices,   // [num_gathered]
+        int64_t num_gathered,
+        const Index* __restrict__ indices,             // [nouter]
+        const Toffsets* __restrict__ segment_offsets,  // [nsegments + 1]
+        T* __restrict__ output) {                      // [nsegments, ninner]
+  for (int64_t seg = static_cast<int64_t>(blockIdx.x) * blockDim.y +
+                     threadIdx.y;
+       seg < nsegments; seg += static_cast<int64_t>(gridDim.x) * blockDim.y) {
+    const Toffsets begin = segment_offsets[seg];
+    const Toffsets end = segment_offsets[seg + 1];
+    const Treduce scale = SegmentScale<Treduce>(end - begin, is_mean, is_sqrtn);
+    for (int64_t x0 = 0; x0 < ninner; x0 += kLanes) {
+      const int64_t x = x0 + threadIdx.x;
+      const bool x_ok = x < ninner;
+      const Treduce sum = SumGatheredRows<T, Treduce>(
+          params, num_rows, ninner, gather_indices, num_gathered, indices,
+          begin, end, x, x_ok);
+      if (x_ok) output[seg * ninner + x] = static_cast<T>(sum * scale);
+    }
+  }
+}
+
+// Each block reduces a segment at a time, its warps each summing a part of
+// the rows before they add up their sums. Suits long segments, which would
+// leave a warp per segment with too little parallelism.
+template <typename T, typename Treduce, typename Tgather, typename Index,
+          typename Toffsets>
+__global__ void __launch_bounds__(kLanes* kWarpsPerBlock)
+    GatherSegmentReduceBlockKernel(
+        int64_t nsegments, int64_t num_rows, int64_t ninner, bool is_mean,
+        bool is_sqrtn, const T* __restrict__ params,  // [num_rows, ninner]
+        const Tgather* __restrict__ gather_indices,   // [num_gathered]
+        int64_t num_gathered,
+        const Index* __restrict__ indices,             // [nouter]
+        const Toffsets* __restrict__ segment_offsets,  // [nsegments + 1]
+        T* __restrict__ output) {                      // [nsegments, ninner]
+  __shared__ Treduce partial_sums[kWarpsPerBlock][kLanes];
+  const int lane = threadIdx.x;
+  const int warp = threadIdx.y;
+  for (int64_t seg = blockIdx.x; seg < nsegments; seg += gridDim.x) {
+    const Toffsets begin = segment_offsets[seg];
+    const Toffsets end = segment_offsets[seg + 1];
+    const Toffsets rows_per_warp =
+        (end - begin + kWarpsPerBlock - 1) / kWarpsPerBlock;
+    const Toffsets warp_begin =
+        min(end, static_cast<Toffsets>(begin + warp * rows_per_warp));
+    const Toffsets warp_end =
+        min(end, static_cast<Toffsets>(warp_begin + rows_per_warp));
+    const Treduce scale = SegmentScale<Treduce>(end - begin, is_mean, is_sqrtn);
+    for (int64_t x0 = 0; x0 < ninner; x0 += kLanes) {
+      const int64_t x = x0 + lane;
+      const bool x_ok = x < ninner;
+      partial_sums[warp][lane] = SumGatheredRows<T, Treduce>(
+          params, num_rows, ninner, gather_indices, num_gathered, indices,
+          warp_begin, warp_end, x, x_ok);
+      __syncthreads();
+      if (warp == 0 && x_ok) {
+        Treduce sum = partial_sums[0][lane];
+        for (int w = 1; w < kWarpsPerBlock; ++w) sum += partial_sums[w][lane];
+        output[seg * ninner + x] = static_cast<T>(sum * scale);
+      }
+      __syncthreads();
+    }
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T, typename Tgather, typename Index, typename SegmentId>
+Status ResourceSparseSegmentReductionFunctor<T, Tgather, Index, SegmentId>::
+operator()(OpKernelContext* context, bool is_mean, bool is_sqrtn,
+           typename TTypes<T, 2>::ConstTensor params,
+           typename TTypes<Tgather>::ConstVec gather_indices,
+           typename TTypes<Index>::ConstVec indices,
+           typename TTypes<SegmentId>::ConstVec segment_ids,
+           typename TTypes<T, 2>::Tensor output) {
+  using Treduce = typename ReduceType<functor::Sum, T>::type;
+  using Toffsets = Index;
+  const GPUDevice& device = context->eigen_gpu_device();
+  const Toffsets nouter = segment_ids.size();
+  const int64_t ninner = params.dimension(1);
+  const SegmentId nsegments = output.dimension(0);
+  if (ninner == 0 || nsegments == 0) return OkStatus();
+
+  Tensor segment_offsets;
+  TF_RETURN_IF_ERROR(context->allocate_temp(DataTypeToEnum<Toffsets>::value,
+                                            TensorShape({nsegments + 1}),
+                                            &segment_offsets));
+  Toffsets* segment_offsets_ptr = segment_offsets.flat<Toffsets>().data();
+  TF_RETURN_IF_ERROR(LaunchSegmentOffsetsKernel(
+      device, nouter, nsegments, segment_ids.data(), segment_offsets_ptr));
+
+  const dim3 block(kLanes, kWarpsPerBlock);
+  constexpr int64_t kMaxGrid = std::numeric_limits<int>::max();
+  if (nouter >= kMinRowsPerSegmentForBlock * nsegments) {
+    return GpuLaunchKernel(
+        GatherSegmentReduceBlockKernel<T, Treduce, Tgather, Index, Toffsets>,
+        static_cast<int>(std::min<int64_t>(nsegments, kMaxGrid)), block, 0,
+        device.stream(), nsegments, params.dimension(0), ninner, is_mean,
+        is_sqrtn, params.data(), gather_indices.data(), gather_indices.size(),
+        indices.data(), segment_offsets_ptr, output.data());
+  }
+  return GpuLaunchKernel(
+      GatherSegmentReduceWarpKernel<T, Treduce, Tgather, Index, Toffsets>,
+      static_cast<int>(std::min<int64_t>(
+          Eigen::divup<int64_t>(nsegments, kWarpsPerBlock), kMaxGrid)),
+      block, 0, device.stream(), nsegments, params.dimension(0), ninner,
+      is_mean, is_sqrtn, params.data(), gather_indices.data(),
+      gather_indices.size(), indices.data(), segment_offsets_ptr,
+      output.data());
+}
+
+#define DEFINE_GPU_SPECS_FOR_SEGMENT_ID(T, Tgather, Index)                   \
+  template struct ResourceSparseSegmentReductionFunctor<T, Tgather, Index,   \
+                                                        int32>;              \
+  template struct ResourceSparseSegmentReductionFunctor<T, Tgather, Index,   \
+                                                        int64_t>;
+#define DEFINE_GPU_SPECS_FOR_INDEX(T, Tgather)          \
+  DEFINE_GPU_SPECS_FOR_SEGMENT_ID(T, Tgather, int32) \
+  DEFINE_GPU_SPECS_FOR_SEGMENT_ID(T, Tgather, int64_t)
+#define DEFINE_GPU_SPECS(T)                \
+  DEFINE_GPU_SPECS_FOR_INDEX(T, int32) \
+  DEFINE_GPU_SPECS_FOR_INDEX(T, int64_t)
+
+TF_CALL_GPU_NUMBER_TYPES(DEFINE_GPU_SPECS);
+
+#undef DEFINE_GPU_SPECS
+#undef DEFINE_GPU_SPECS_FOR_INDEX
+#undef DEFINE_GPU_SPECS_FOR_SEGMENT_ID
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
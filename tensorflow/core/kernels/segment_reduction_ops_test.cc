@@ -290,4 +290,58 @@ BENCHMARK(BM_SparseSegmentMeanGrad_High_FP16)
     ->Arg(1000)
     ->Arg(100000);
 
+static void SparseSegmentSumHelper(::testing::benchmark::State& state,
+                                   bool sorted_indices, int size) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  const int kNumIndices = size;
+  const int kNumRows = size;
+  const int kDim2 = 128;
+  Tensor indices(DT_INT32, TensorShape({kNumIndices}));
+  auto indices_flat = indices.flat<int32>();
+  Tensor segments(DT_INT32, TensorShape({kNumIndices}));
+  auto segments_flat = segments.flat<int32>();
+
+  // Segments of 8 indices, which either read consecutive rows or rows spread
+  // over the input.
+  for (int i = 0; i < kNumIndices; ++i) {
+    indices_flat(i) = sorted_indices ? i : (i * 7919) % kNumRows;
+    segments_flat(i) = i / 8;
+  }
+
+  Tensor input(DT_FLOAT, TensorShape({kNumRows, kDim2}));
+  input.flat<float>().setRandom();
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          (kNumIndices * kDim2) * sizeof(float));
+}
+
+static void BM_SparseSegmentSum_Sorted(::testing::benchmark::State& state) {
+  const int size = state.range(0);
+
+  return SparseSegmentSumHelper(state, /*sorted_indices=*/true, size);
+}
+
+static void BM_SparseSegmentSum_Scattered(
+    ::testing::benchmark::State& state) {
+  const int size = state.range(0);
+
+  return SparseSegmentSumHelper(state, /*sorted_indices=*/false, size);
+}
+
+BENCHMARK(BM_SparseSegmentSum_Sorted)->UseRealTime()->Arg(1000)->Arg(100000);
+BENCHMARK(BM_SparseSegmentSum_Scattered)
+    ->UseRealTime()
+    ->Arg(1000)
+    ->Arg(100000);
+
 }  // namespace tensorflow
@@ -159,6 +159,104 @@ struct SubtractAndExpFunctor {
   const int num_cols_;
 };
 
+// The rows of at most kWarpSoftmaxMaxCols columns are each computed by a
+// single warp of WarpSoftmaxKernel, kWarpSoftmaxWarpsPerBlock per block.
+constexpr int kWarpSoftmaxMaxCols = 1024;
+constexpr int kWarpSoftmaxWarpsPerBlock = 4;
+
+template <typename U>
+__device__ U WarpAllReduceMax(U value) {
+  for (int offset = TF_RED_WARPSIZE / 2; offset > 0; offset /= 2) {
+    value = max(value, GpuShuffleXorSync(kCudaWarpAll, value, offset));
+  }
+  return value;
+}
+
+template <typename U>
+__device__ U WarpAllReduceSum(U value) {
+  for (int offset = TF_RED_WARPSIZE / 2; offset > 0; offset /= 2) {
+    value += GpuShuffleXorSync(kCudaWarpAll, value, offset);
+  }
+  return value;
+}
+
+// Computes the softmax of a row per warp in a single pass over the logits,
+// keeping the row in registers: each lane holds kColsPerLane columns, read
+// kVecSize at a time. Suits the many short rows of attention, which the
+// generic row reductions below go over three times.
+template <typename T, typename U, int kColsPerLane, int kVecSize>
+__global__ void __launch_bounds__(TF_RED_WARPSIZE* kWarpSoftmaxWarpsPerBlock)
+    WarpSoftmaxKernel(const T* logits, T* output, const int num_rows,
+                      const int num_cols, const bool in_log_space) {
+  using Vec = AlignedVector<T, kVecSize>;
+  constexpr int kVecsPerLane = kColsPerLane / kVecSize;
+  const int lane = threadIdx.x;
+  for (int64_t row = static_cast<int64_t>(blockIdx.x) * blockDim.y +
+                     threadIdx.y;
+       row < num_rows; row += static_cast<int64_t>(gridDim.x) * blockDim.y) {
+    const T* row_logits = logits + row * num_cols;
+    T* row_output = output + row * num_cols;
+
+    U values[kColsPerLane];
+    U max_value = Eigen::NumTraits<U>::lowest();
+    for (int v = 0; v < kVecsPerLane; ++v) {
+      const int col = (v * TF_RED_WARPSIZE + lane) * kVecSize;
+      if (col >= num_cols) break;
+      const Vec vec = *reinterpret_cast<const Vec*>(row_logits + col);
+      for (int i = 0; i < kVecSize; ++i) {
+        values[v * kVecSize + i] = static_cast<U>(vec[i]);
+        max_value = max(max_value, values[v * kVecSize + i]);
+      }
+    }
+    max_value = WarpAllReduceMax(max_value);
+
+    U sum(0);
+    for (int v = 0; v < kVecsPerLane; ++v) {
+      const int col = (v * TF_RED_WARPSIZE + lane) * kVecSize;
+      if (col >= num_cols) break;
+      for (int i = 0; i < kVecSize; ++i) {
+        U& value = values[v * kVecSize + i];
+        value -= max_value;
+        const U exp_value = exp(value);
+        sum += exp_value;
+        if (!in_log_space) value = exp_value;
+      }
+    }
+    sum = WarpAllReduceSum(sum);
+    const U log_sum = in_log_space ? log(sum) : U(0);
+
+    for (int v = 0; v < kVecsPerLane; ++v) {
+      const int col = (v * TF_RED_WARPSIZE + lane) * kVecSize;
+      if (col >= num_cols) break;
+      Vec vec;
+      for (int i = 0; i < kVecSize; ++i) {
+        const U value = values[v * kVecSize + i];
+        vec[i] = static_cast<T>(in_log_space ? value - log_sum : value / sum);
+      }
+      *reinterpret_cast<Vec*>(row_output + col) = vec;
+    }
+  }
+}
+
+// Launches WarpSoftmaxKernel with the fewest columns per lane that hold rows
+// of num_cols columns.
+template <typename T, typename U, int kVecSize, int kColsPerLane = kVecSize>
+Status LaunchWarpSoftmax(const GPUDevice& d, const T* logits, T* output,
+                         int num_rows, int num_cols, bool in_log_space) {
+  if constexpr (kColsPerLane * TF_RED_WARPSIZE < kWarpSoftmaxMaxCols) {
+    if (num_cols > kColsPerLane * TF_RED_WARPSIZE) {
+      return LaunchWarpSoftmax<T, U, kVecSize, kColsPerLane * 2>(
+          d, logits, output, num_rows, num_cols, in_log_space);
+    }
+  }
+  const int num_blocks = Eigen::divup(num_rows, kWarpSoftmaxWarpsPerBlock);
+  return GpuLaunchKernel(WarpSoftmaxKernel<T, U, kColsPerLane, kVecSize>,
+                         num_blocks,
+                         dim3(TF_RED_WARPSIZE, kWarpSoftmaxWarpsPerBlock), 0,
+                         d.stream(), logits, output, num_rows, num_cols,
+                         in_log_space);
+}
+
 template <typename T, typename Op, typename InputIter>
 void DoRowReduction(OpKernelContext* context, T* output, InputIter input,
                     int rows, int cols) {
@@ -192,14 +290,29 @@ class SoftmaxOpGPU : public OpKernel {
                                 {0}, 0, logits_in_.shape(), &softmax_out));
 
     const auto& cu_stream = GetGpuStream(context);
-    if (logits_in_.NumElements() > 0) {
+    typedef typename softmax_traits<T>::accumulator_type acc_type;
+    if (logits_in_.NumElements() > 0 && cols <= kWarpSoftmaxMaxCols) {
+      const T* logits_ptr = logits_in_.flat<T>().data();
+      T* out_ptr = softmax_out->flat<T>().data();
+      const GPUDevice& d = context->eigen_device<GPUDevice>();
+      // Halves and bfloat16s are read in pairs where the rows allow it.
+      constexpr bool kIs16Bit = DataTypeToEnum<T>::value == DT_HALF ||
+                                DataTypeToEnum<T>::value == DT_BFLOAT16;
+      if (kIs16Bit && cols % 2 == 0 &&
+          MinAlignmentOf(logits_ptr, out_ptr) >= 2) {
+        OP_REQUIRES_OK(context, LaunchWarpSoftmax<T, acc_type, 2>(
+                                    d, logits_ptr, out_ptr, rows, cols, log_));
+      } else {
+        OP_REQUIRES_OK(context, LaunchWarpSoftmax<T, acc_type, 1>(
+                                    d, logits_ptr, out_ptr, rows, cols, log_));
+      }
+    } else if (logits_in_.NumElements() > 0) {
       Tensor max_logits;
       Tensor sum_probs;
       OP_REQUIRES_OK(context,
                      context->allocate_temp(DataTypeToEnum<T>::value,
                                             softmax_out->shape(), &max_logits));
 
-      typedef typename softmax_traits<T>::accumulator_type acc_type;
       OP_REQUIRES_OK(context,
                      context->allocate_temp(DataTypeToEnum<acc_type>::value,
                                             softmax_out->shape(), &sum_probs));
@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/nn_ops.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// Compares the GPU Softmax and LogSoftmax kernels, which compute rows of at
+// most 1024 columns with a warp per row and longer rows with three passes,
+// with the CPU kernels.
+class SoftmaxOpGpuTest : public ::testing::Test {
+ protected:
+  template <typename T>
+  void ExpectGpuMatchesCpu(int rows, int cols, bool log_softmax, double atol,
+                           double rtol) {
+    Tensor logits(DataTypeToEnum<T>::value, TensorShape({rows, cols}));
+    logits.flat<T>().setRandom();
+    // Spreads the logits so that the rows are not close to uniform.
+    logits.flat<T>() = logits.flat<T>() * static_cast<T>(8.0f);
+
+    Scope root = Scope::NewRootScope();
+    auto input = ops::Const(root.WithOpName("logits"), logits);
+    auto softmax = [&](const Scope& scope) -> Output {
+      if (log_softmax) return ops::LogSoftmax(scope, input);
+      return ops::Softmax(scope, input);
+    };
+    Output cpu = softmax(root.WithOpName("cpu").WithDevice("/device:CPU:0"));
+    Output gpu = softmax(root.WithOpName("gpu").WithDevice("/device:GPU:0"));
+    GraphDef graph;
+    TF_ASSERT_OK(root.ToGraphDef(&graph));
+
+    SessionOptions session_options;
+    session_options.config.mutable_graph_options()
+        ->mutable_optimizer_options()
+        ->set_opt_level(OptimizerOptions::L0);
+    session_options.config.mutable_graph_options()
+        ->mutable_rewrite_options()
+        ->set_constant_folding(RewriterConfig::OFF);
+    std::unique_ptr<Session> session(NewSession(session_options));
+    TF_ASSERT_OK(session->Create(graph));
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {"cpu", "gpu"}, {}, &outputs));
+    ASSERT_EQ(outputs.size(), 2);
+    test::ExpectClose(outputs[1], outputs[0], atol, rtol);
+  }
+};
+
+TEST_F(SoftmaxOpGpuTest, ShortRowsFloat) {
+  for (int cols : {1, 7, 32, 33, 100, 512, 1000, 1024}) {
+    SCOPED_TRACE(cols);
+    ExpectGpuMatchesCpu<float>(/*rows=*/37, cols, /*log_softmax=*/false,
+                               /*atol=*/1e-6, /*rtol=*/1e-5);
+    ExpectGpuMatchesCpu<float>(/*rows=*/37, cols, /*log_softmax=*/true,
+                               /*atol=*/1e-5, /*rtol=*/1e-5);
+  }
+}
+
+// Even rows of halves and bfloat16s are read in pairs, odd ones one by one.
+TEST_F(SoftmaxOpGpuTest, ShortRowsHalf) {
+  for (int cols : {1, 7, 64, 127, 1024}) {
+    SCOPED_TRACE(cols);
+    ExpectGpuMatchesCpu<Eigen::half>(/*rows=*/37, cols,
+                                     /*log_softmax=*/false, /*atol=*/1e-3,
+                                     /*rtol=*/1e-2);
+    ExpectGpuMatchesCpu<Eigen::half>(/*rows=*/37, cols, /*log_softmax=*/true,
+                                     /*atol=*/1e-2, /*rtol=*/1e-2);
+  }
+}
+
+TEST_F(SoftmaxOpGpuTest, ShortRowsBfloat16) {
+  for (int cols : {2, 9, 256, 1024}) {
+    SCOPED_TRACE(cols);
+    ExpectGpuMatchesCpu<bfloat16>(/*rows=*/37, cols, /*log_softmax=*/false,
+                                  /*atol=*/1e-2, /*rtol=*/5e-2);
+    ExpectGpuMatchesCpu<bfloat16>(/*rows=*/37, cols, /*log_softmax=*/true,
+                                  /*atol=*/5e-2, /*rtol=*/5e-2);
+  }
+}
+
+// Rows longer than a warp handles keep the three-pass path.
+TEST_F(SoftmaxOpGpuTest, LongRowsFloat) {
+  ExpectGpuMatchesCpu<float>(/*rows=*/5, /*cols=*/1025, /*log_softmax=*/false,
+                             /*atol=*/1e-6, /*rtol=*/1e-5);
+  ExpectGpuMatchesCpu<float>(/*rows=*/5, /*cols=*/1025, /*log_softmax=*/true,
+                             /*atol=*/1e-5, /*rtol=*/1e-5);
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -302,46 +302,74 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
                                              const CSRSparseMatrix& lhs,
                                              const Tensor& rhs,
                                              Tensor* output) {
+    const int64_t total_rows = batch_size * num_lhs_rows;
+    if (total_rows == 0) return;
     // Parallelize matrix multiplication across batch dimensions and across
-    // rows in each batch.
+    // rows in each batch. The shards hold about the same number of nonzeros
+    // rather than of rows, so that matrices with very uneven row lengths, such
+    // as graph adjacency matrices, keep all threads busy. Each row costs one
+    // unit for its output plus one unit per nonzero.
     auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
     const int32_t num_threads = worker_threads.num_threads;
-    const int64_t block_size =
-        num_lhs_rows / std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    const int64_t num_shards = std::min<int64_t>(
+        total_rows, std::max(kMaxShards, kNumShardsPerThread * num_threads));
+    const int64_t cost_per_shard =
+        (total_rows + lhs.total_nnz() + num_shards - 1) / num_shards;
+    std::vector<int64_t> shard_begins = {0};
+    int64_t shard_cost = 0;
+    for (int64_t batch_idx = 0; batch_idx < batch_size; ++batch_idx) {
+      const auto row_ptrs = lhs.row_pointers_vec(batch_idx);
+      for (int64_t row = 0; row < num_lhs_rows; ++row) {
+        shard_cost += 1 + row_ptrs(row + 1) - row_ptrs(row);
+        if (shard_cost >= cost_per_shard) {
+          shard_begins.push_back(batch_idx * num_lhs_rows + row + 1);
+          shard_cost = 0;
+        }
+      }
+    }
+    if (shard_begins.back() != total_rows) shard_begins.push_back(total_rows);
+
     const int64_t num_rhs_rows = rhs.dim_size(rhs.dims() - 2);
     const int64_t num_rhs_cols = rhs.dim_size(rhs.dims() - 1);
     worker_threads.workers->ParallelFor(
-        batch_size * num_lhs_rows /* total */,
+        shard_begins.size() - 1 /* total */,
         thread::ThreadPool::SchedulingParams(
             thread::ThreadPool::SchedulingStrategy::
                 kFixedBlockSize /* strategy */,
-            absl::nullopt /* cost_per_unit */, block_size),
-        [&](int64_t batch_and_row_begin, int64_t batch_and_row_end) {
-          HandleBatchAndRowRange(
-              num_lhs_rows, batch_and_row_begin, batch_and_row_end,
-              [&](int64_t batch_idx, int64_t row_begin, int64_t row_end) {
-                const int64_t num_shard_rows = row_end - row_begin;
-
-                // Define an Eigen::SparseMatrix over the row range:
-                // [row_begin, row_end) of the CSR SparseMatrix A.
-                std::vector<int32> row_ptrs;
-                auto sparse_matrix = GetSparseMatrixRef(
-                    lhs, batch_idx, row_begin, num_shard_rows, &row_ptrs);
-
-                // Map the corresponding rows of the rhs.
-                ConstMatrixMap rhs_map(rhs.flat<T>().data() + batch_idx *
-                                                                  num_rhs_rows *
-                                                                  num_rhs_cols,
-                                       num_rhs_rows, num_rhs_cols);
-
-                // Write to the corresponding rows of the output matrix.
-                MatrixMap output_map(
-                    output->flat<T>().data() +
-                        batch_idx * num_lhs_rows * num_rhs_cols +
-                        row_begin * num_rhs_cols,
-                    num_shard_rows, num_rhs_cols);
-                output_map.noalias() = sparse_matrix * rhs_map;
-              });
+            absl::nullopt /* cost_per_unit */, 1 /* block_size */),
+        [&](int64_t shard_begin, int64_t shard_end) {
+          for (int64_t shard = shard_begin; shard < shard_end; ++shard) {
+            HandleBatchAndRowRange(
+                num_lhs_rows, shard_begins[shard], shard_begins[shard + 1],
+                [&](int64_t batch_idx, int64_t row_begin, int64_t row_end) {
+                  const auto row_ptrs = lhs.row_pointers_vec(batch_idx);
+                  const auto col_indices = lhs.col_indices_vec(batch_idx);
+                  const auto values = lhs.values_vec<T>(batch_idx);
+
+                  // Map the corresponding rows of the rhs and the output.
+                  ConstMatrixMap rhs_map(
+                      rhs.flat<T>().data() +
+                          batch_idx * num_rhs_rows * num_rhs_cols,
+                      num_rhs_rows, num_rhs_cols);
+                  MatrixMap output_map(
+                      output->flat<T>().data() +
+                          batch_idx * num_lhs_rows * num_rhs_cols,
+                      num_lhs_rows, num_rhs_cols);
+
+                  // Accumulate each output row from the rows of the rhs
+                  // selected by its nonzeros. The rows are contiguous, so the
+                  // updates are vectorized over the columns of the rhs.
+                  for (int64_t row = row_begin; row < row_end; ++row) {
+                    auto output_row = output_map.row(row);
+                    output_row.setZero();
+                    for (int32_t k = row_ptrs(row); k < row_ptrs(row + 1);
+                         ++k) {
+                      output_row.noalias() +=
+                          values(k) * rhs_map.row(col_indices(k));
+                    }
+                  }
+                });
+          }
         });
   }
 
@@ -0,0 +1,73 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_STRING_BYTES_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_STRING_BYTES_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/refcount.h"
+
+namespace tensorflow {
+
+// A buffer that is a view of bytes within the strings of another tensor, such
+// as the raw values decoded by DecodeRaw and ParseTensor. The buffer keeps
+// that tensor alive.
+class StringBytesBuffer : public TensorBuffer {
+ public:
+  StringBytesBuffer(const Tensor& strings, const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)), strings_(strings), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("string_bytes");
+  }
+  // The bytes belong to the strings, so the buffer must not be forwarded to
+  // ops that write to their inputs in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const Tensor strings_;
+  const size_t size_;
+};
+
+// Makes `*out` a tensor of `dtype` and `shape` that is a view of the `size`
+// bytes at `data` within the strings of `strings`, if they are aligned as
+// allocated tensors are. Returns false, leaving `*out` unchanged, otherwise.
+inline bool AliasStringBytes(const Tensor& strings, DataType dtype,
+                             const TensorShape& shape, const char* data,
+                             size_t size, Tensor* out) {
+  if (reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment !=
+      0) {
+    return false;
+  }
+  core::RefCountPtr<TensorBuffer> buf(
+      new StringBytesBuffer(strings, data, size));
+  *out = Tensor(dtype, shape, std::move(buf));
+  return true;
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_STRING_BYTES_BUFFER_H_
@@ -37,6 +37,127 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Rows of at least this many columns, with k at most a
+// kMaxFilteredTopKRatio-th of them, are reduced by filtering the columns
+// against a running estimate of the k-th largest value instead of pushing all
+// of them through a heap.
+constexpr int64_t kMinFilteredTopKCols = 1024;
+constexpr int64_t kMaxFilteredTopKRatio = 16;
+// Filtered rows are split between threads, when there are fewer rows than
+// threads, in blocks of at least this many columns.
+constexpr int64_t kMinFilteredTopKBlockCols = 32 * 1024;
+// The number of columns compared with the threshold at once.
+constexpr int kFilterChunk = 16;
+
+// Orders columns by decreasing value, breaking ties by increasing column, as
+// the stable comparator of the heap path does.
+template <typename T, typename Tidx>
+struct StableGreater {
+  bool operator()(const Tidx a, const Tidx b) const {
+    if (row[b] < row[a]) return true;
+    if (row[b] > row[a]) return false;
+    return a < b;
+  }
+  const T* row;
+};
+
+// Returns whether any of the kFilterChunk values at `data` is greater than
+// `threshold` or NaN.
+template <typename T>
+EIGEN_ALWAYS_INLINE bool AnyAboveThreshold(const T* data, T threshold) {
+  bool any = false;
+  for (int i = 0; i < kFilterChunk; ++i) {
+    any |= !(data[i] <= threshold);
+  }
+  return any;
+}
+
+// Compares whole packets for the types Eigen vectorizes comparisons of.
+template <typename T>
+EIGEN_ALWAYS_INLINE bool AnyAboveThresholdPacket(const T* data, T threshold) {
+  using Eigen::internal::pcmp_lt_or_nan;
+  using Eigen::internal::ploadu;
+  using Eigen::internal::por;
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+  constexpr int kPacketSize = Eigen::internal::unpacket_traits<Packet>::size;
+  static_assert(kFilterChunk % kPacketSize == 0,
+                "kFilterChunk must be a multiple of the packet size");
+  const Packet t = Eigen::internal::pset1<Packet>(threshold);
+  Packet above = pcmp_lt_or_nan(t, ploadu<Packet>(data));
+  for (int i = kPacketSize; i < kFilterChunk; i += kPacketSize) {
+    above = por(above, pcmp_lt_or_nan(t, ploadu<Packet>(data + i)));
+  }
+  return Eigen::internal::predux_any(above);
+}
+
+template <>
+EIGEN_ALWAYS_INLINE bool AnyAboveThreshold<float>(const float* data,
+                                                  float threshold) {
+  return AnyAboveThresholdPacket(data, threshold);
+}
+
+template <>
+EIGEN_ALWAYS_INLINE bool AnyAboveThreshold<double>(const double* data,
+                                                   double threshold) {
+  return AnyAboveThresholdPacket(data, threshold);
+}
+
+// Collects into `top` the top min(k, end - begin) columns of row[begin, end),
+// in the order of StableGreater. The first of them seed the candidates; from
+// then on, a column is a candidate only if it is greater than the k-th
+// largest candidate so far, as a column equal to it comes after k others.
+// Whole chunks of columns are skipped when none of them is, and the
+// candidates are cut back to k whenever they fill up twice that. Returns
+// false if the row has a NaN, which has no place in that order.
+template <typename T, typename Tidx>
+bool FilteredTopK(const T* row, int64_t begin, int64_t end, int64_t k,
+                  std::vector<Tidx>* top) {
+  const StableGreater<T, Tidx> comp{row};
+  k = std::min(k, end - begin);
+  std::vector<Tidx>& candidates = *top;
+  candidates.clear();
+  candidates.reserve(2 * k);
+  const auto compact = [&]() {
+    std::nth_element(candidates.begin(), candidates.begin() + (k - 1),
+                     candidates.end(), comp);
+    candidates.resize(k);
+    return row[candidates[k - 1]];
+  };
+  for (int64_t c = begin; c < begin + k; ++c) {
+    if (Eigen::numext::isnan(row[c])) return false;
+    candidates.push_back(static_cast<Tidx>(c));
+  }
+  T threshold = compact();
+  const auto consider = [&](int64_t c) {
+    const T value = row[c];
+    if (value <= threshold) return true;
+    if (Eigen::numext::isnan(value)) return false;
+    candidates.push_back(static_cast<Tidx>(c));
+    if (static_cast<int64_t>(candidates.size()) == 2 * k) {
+      threshold = compact();
+    }
+    return true;
+  };
+
+  int64_t c = begin + k;
+  for (; c + kFilterChunk <= end; c += kFilterChunk) {
+    if (!AnyAboveThreshold(row + c, threshold)) continue;
+    for (int i = 0; i < kFilterChunk; ++i) {
+      if (!consider(c + i)) return false;
+    }
+  }
+  for (; c < end; ++c) {
+    if (!consider(c)) return false;
+  }
+  if (static_cast<int64_t>(candidates.size()) > k) compact();
+  std::sort(candidates.begin(), candidates.end(), comp);
+  return true;
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Tidx>
 class TopK : public OpKernel {
  public:
@@ -233,6 +354,65 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       }  // for (Tidx b = ...
     };
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    if (k > 1 && num_cols >= kMinFilteredTopKCols &&
+        k <= num_cols / kMaxFilteredTopKRatio) {
+      // Splits each row into as many blocks as it takes to keep the threads
+      // busy. Each block selects its own top k, and the top k of each row is
+      // the top k of those of its blocks.
+      const int64_t block_cols =
+          std::max(kMinFilteredTopKBlockCols, k * kMaxFilteredTopKRatio);
+      const int64_t blocks_per_row = std::max<int64_t>(
+          1, std::min<int64_t>(
+                 Eigen::divup<int64_t>(worker_threads.num_threads, num_rows),
+                 num_cols / block_cols));
+      const int64_t cols_per_block = Eigen::divup(num_cols, blocks_per_row);
+      const int64_t num_blocks = num_rows * blocks_per_row;
+      std::vector<std::vector<Tidx>> block_tops(num_blocks);
+      std::vector<char> block_has_nan(num_blocks, false);
+      auto FilterBlocks = [&](int64_t start_block, int64_t limit_block) {
+        for (int64_t i = start_block; i < limit_block; ++i) {
+          const int64_t begin = (i % blocks_per_row) * cols_per_block;
+          const int64_t end = std::min(num_cols, begin + cols_per_block);
+          block_has_nan[i] = !FilteredTopK(&input(i / blocks_per_row, 0),
+                                           begin, end, k, &block_tops[i]);
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+            cols_per_block * 2 * Eigen::TensorOpCost::AddCost<T>(),
+            FilterBlocks);
+
+      auto MergeBlocks = [&](int64_t start_batch, int64_t limit_batch) {
+        for (int64_t b = start_batch; b < limit_batch; ++b) {
+          // Leaves rows with NaNs to the heap.
+          const auto row_blocks = block_has_nan.begin() + b * blocks_per_row;
+          if (std::any_of(row_blocks, row_blocks + blocks_per_row,
+                          [](const char has_nan) { return has_nan; })) {
+            SortIndices(b, b + 1);
+            continue;
+          }
+          std::vector<Tidx>& top = block_tops[b * blocks_per_row];
+          for (int64_t i = 1; i < blocks_per_row; ++i) {
+            const std::vector<Tidx>& block_top =
+                block_tops[b * blocks_per_row + i];
+            top.insert(top.end(), block_top.begin(), block_top.end());
+          }
+          if (blocks_per_row > 1) {
+            std::partial_sort(top.begin(), top.begin() + k, top.end(),
+                              StableGreater<T, Tidx>{&input(b, 0)});
+          }
+          std::copy(top.begin(), top.begin() + k, &indices(b, 0));
+          std::transform(
+              &indices(b, 0), &indices(b, k), &values(b, 0),
+              [b, &input](const Tidx loc) { return input(b, loc); });
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+            k * blocks_per_row * 8 * Eigen::TensorOpCost::AddCost<T>(),
+            MergeBlocks);
+      return OkStatus();
+    }
+
     // Guesstimate of cost; 4*N*log(K) where N == num_cols.
     // If K == N, assume the cost is N*log(K + 1).
     const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
@@ -247,7 +427,6 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
@@ -15,7 +15,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -68,12 +70,257 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Bytes of the input tile transposed at once. The input and output tiles
+// together fit in the L1 data cache.
+constexpr int64_t kTransposeTileBytes = 8 * 1024;
+
+// Returns the side of the square tiles of T, a multiple of 16 elements.
+template <typename T>
+constexpr int64_t TransposeTileSize() {
+  int64_t size = 16;
+  while ((size + 16) * (size + 16) * sizeof(T) <= kTransposeTileBytes) {
+    size += 16;
+  }
+  return size;
+}
+
+// Lanes of the packets that move T through registers. The transpose only moves
+// bits, so 32 and 64 bit elements use float and double packets.
+template <typename T>
+struct TransposeLane {
+  using type = void;
+};
+template <>
+struct TransposeLane<uint32> {
+  using type = float;
+};
+template <>
+struct TransposeLane<uint64> {
+  using type = double;
+};
+
+// Transposes the rows x cols block at `src`, whose rows are src_stride apart,
+// into the cols x rows block at `dst`, whose rows are dst_stride apart.
+template <typename T>
+void TransposeTile(const T* src, int64_t src_stride, T* dst,
+                   int64_t dst_stride, int64_t rows, int64_t cols) {
+  int64_t vectorized_rows = 0;
+  int64_t vectorized_cols = 0;
+  using Lane = typename TransposeLane<T>::type;
+  if constexpr (!std::is_void_v<Lane>) {
+    using Packet = typename Eigen::internal::packet_traits<Lane>::type;
+    constexpr int kLanes = Eigen::internal::unpacket_traits<Packet>::size;
+    static_assert(sizeof(Lane) == sizeof(T));
+    if constexpr (kLanes > 1) {
+      // In-register transposes of kLanes x kLanes blocks.
+      vectorized_rows = rows - rows % kLanes;
+      vectorized_cols = cols - cols % kLanes;
+      for (int64_t i = 0; i < vectorized_rows; i += kLanes) {
+        for (int64_t j = 0; j < vectorized_cols; j += kLanes) {
+          Eigen::internal::PacketBlock<Packet, kLanes> block;
+          const Lane* block_src =
+              reinterpret_cast<const Lane*>(src + i * src_stride + j);
+          for (int k = 0; k < kLanes; ++k) {
+            block.packet[k] = Eigen::internal::ploadu<Packet>(
+                block_src + k * src_stride);
+          }
+          Eigen::internal::ptranspose(block);
+          Lane* block_dst = reinterpret_cast<Lane*>(dst + j * dst_stride + i);
+          for (int k = 0; k < kLanes; ++k) {
+            Eigen::internal::pstoreu(block_dst + k * dst_stride,
+                                     block.packet[k]);
+          }
+        }
+      }
+    }
+  }
+  // The remaining columns of the vectorized rows, then the remaining rows.
+  for (int64_t j = vectorized_cols; j < cols; ++j) {
+    for (int64_t i = 0; i < vectorized_rows; ++i) {
+      dst[j * dst_stride + i] = src[i * src_stride + j];
+    }
+  }
+  for (int64_t j = 0; j < cols; ++j) {
+    for (int64_t i = vectorized_rows; i < rows; ++i) {
+      dst[j * dst_stride + i] = src[i * src_stride + j];
+    }
+  }
+}
+
+// Drops the dimensions of size 1, then merges the dimensions that stay next to
+// each other with ReduceTransposeDimensions.
+void ReduceTransposeDimensionsWithoutSingletons(
+    const TensorShape& shape, const absl::Span<const int32> perm,
+    internal::TransposePermsVec* new_perm,
+    internal::TransposeDimsVec* new_dims) {
+  internal::TransposePermsVec new_dim_index(shape.dims(), -1);
+  TensorShape squeezed_shape;
+  for (int i = 0; i < shape.dims(); ++i) {
+    if (shape.dim_size(i) != 1) {
+      new_dim_index[i] = squeezed_shape.dims();
+      squeezed_shape.AddDim(shape.dim_size(i));
+    }
+  }
+  internal::TransposePermsVec squeezed_perm;
+  for (const int32 dim : perm) {
+    if (new_dim_index[dim] >= 0) squeezed_perm.push_back(new_dim_index[dim]);
+  }
+  if (squeezed_perm.empty()) {
+    squeezed_shape.AddDim(1);
+    squeezed_perm.push_back(0);
+  }
+  new_dims->resize(1);
+  internal::TransposePermsVec output_positions;
+  internal::ReduceTransposeDimensions(squeezed_shape, squeezed_perm,
+                                      &output_positions, new_dims);
+  // ReduceTransposeDimensions returns the output position of each input
+  // dimension, which is the inverse of the permutation.
+  new_perm->resize(output_positions.size());
+  for (int i = 0; i < output_positions.size(); ++i) {
+    (*new_perm)[output_positions[i]] = i;
+  }
+}
+
+// Transposes trivially copyable elements with the dimensions reduced by
+// ReduceTransposeDimensionsWithoutSingletons. When the innermost dimension
+// stays innermost, the output is a gather of contiguous runs of the input.
+// Otherwise the innermost input and output dimensions are transposed in L1
+// sized square tiles, which are spread over the device threads together with
+// the other dimensions.
+template <typename T>
+void TransposeBlocked(const CPUDevice& device, const T* in,
+                      const internal::TransposePermsVec& perm,
+                      const internal::TransposeDimsVec& dims, T* out) {
+  const int ndims = dims.size();
+  int64_t num_elements = 1;
+  gtl::InlinedVector<int64_t, 8> in_strides(ndims);
+  for (int i = ndims - 1; i >= 0; --i) {
+    in_strides[i] = num_elements;
+    num_elements *= dims[i];
+  }
+  // Stride in the output of each input dimension.
+  gtl::InlinedVector<int64_t, 8> out_strides(ndims);
+  for (int64_t i = ndims - 1, stride = 1; i >= 0; --i) {
+    out_strides[perm[i]] = stride;
+    stride *= dims[perm[i]];
+  }
+
+  if (ndims == 1) {
+    device.parallelFor(num_elements,
+                       Eigen::TensorOpCost(sizeof(T), sizeof(T), 0),
+                       [in, out](int64_t begin, int64_t end) {
+                         std::copy(in + begin, in + end, out + begin);
+                       });
+    return;
+  }
+
+  // Dimensions iterated outside of the innermost copy or tile, in output
+  // order.
+  const int row_dim = perm[ndims - 1];
+  gtl::InlinedVector<int, 8> outer_dims;
+  for (int i = 0; i < ndims; ++i) {
+    if (perm[i] != row_dim && perm[i] != ndims - 1) {
+      outer_dims.push_back(perm[i]);
+    }
+  }
+  // Returns the offsets in the input and output of the index'th combination
+  // of outer dimensions.
+  const auto outer_offsets = [&](int64_t index, int64_t* in_offset,
+                                 int64_t* out_offset) {
+    *in_offset = 0;
+    *out_offset = 0;
+    for (int i = outer_dims.size() - 1; i >= 0; --i) {
+      const int dim = outer_dims[i];
+      const int64_t dim_index = index % dims[dim];
+      index /= dims[dim];
+      *in_offset += dim_index * in_strides[dim];
+      *out_offset += dim_index * out_strides[dim];
+    }
+  };
+
+  const int64_t cols = dims[ndims - 1];
+  if (row_dim == ndims - 1) {
+    // The innermost dimension is not moved, and cols elements are copied at a
+    // time. outer_dims holds all other dimensions.
+    const int64_t num_rows = num_elements / cols;
+    device.parallelFor(
+        num_rows,
+        Eigen::TensorOpCost(cols * sizeof(T), cols * sizeof(T),
+                            outer_dims.size() *
+                                Eigen::TensorOpCost::AddCost<int64_t>()),
+        [&](int64_t begin, int64_t end) {
+          // Walks the input offsets of consecutive output rows like an
+          // odometer, instead of dividing for each row.
+          gtl::InlinedVector<int64_t, 8> index(outer_dims.size());
+          int64_t in_offset = 0;
+          int64_t rest = begin;
+          for (int i = outer_dims.size() - 1; i >= 0; --i) {
+            index[i] = rest % dims[outer_dims[i]];
+            rest /= dims[outer_dims[i]];
+            in_offset += index[i] * in_strides[outer_dims[i]];
+          }
+          for (int64_t row = begin; row < end; ++row) {
+            std::copy(in + in_offset, in + in_offset + cols, out + row * cols);
+            for (int i = outer_dims.size() - 1; i >= 0; --i) {
+              const int dim = outer_dims[i];
+              in_offset += in_strides[dim];
+              if (++index[i] < dims[dim]) break;
+              in_offset -= index[i] * in_strides[dim];
+              index[i] = 0;
+            }
+          }
+        });
+    return;
+  }
+
+  constexpr int64_t kTileSize = TransposeTileSize<T>();
+  const int64_t rows = dims[row_dim];
+  const int64_t row_tiles = (rows + kTileSize - 1) / kTileSize;
+  const int64_t col_tiles = (cols + kTileSize - 1) / kTileSize;
+  const int64_t tiles_per_matrix = row_tiles * col_tiles;
+  const int64_t tile_elements = std::min(rows, kTileSize) *
+                                std::min(cols, kTileSize);
+  device.parallelFor(
+      num_elements / (rows * cols) * tiles_per_matrix,
+      Eigen::TensorOpCost(tile_elements * sizeof(T), tile_elements * sizeof(T),
+                          tile_elements),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t tile = begin; tile < end; ++tile) {
+          int64_t in_offset, out_offset;
+          outer_offsets(tile / tiles_per_matrix, &in_offset, &out_offset);
+          // Tiles of a matrix are visited in output order.
+          const int64_t col_tile = tile % tiles_per_matrix / row_tiles;
+          const int64_t row_tile = tile % row_tiles;
+          const int64_t row = row_tile * kTileSize;
+          const int64_t col = col_tile * kTileSize;
+          TransposeTile(in + in_offset + row * in_strides[row_dim] + col,
+                        in_strides[row_dim],
+                        out + out_offset + col * out_strides[ndims - 1] + row,
+                        out_strides[ndims - 1],
+                        std::min(kTileSize, rows - row),
+                        std::min(kTileSize, cols - col));
+        }
+      });
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const absl::Span<const int32> perm, Tensor* out) {
+    if constexpr (!conjugate && std::is_trivially_copyable_v<T>) {
+      if (in.NumElements() == 0) return;
+      internal::TransposePermsVec new_perm;
+      internal::TransposeDimsVec new_dims;
+      ReduceTransposeDimensionsWithoutSingletons(in.shape(), perm, &new_perm,
+                                                 &new_dims);
+      TransposeBlocked<T>(
+          d, reinterpret_cast<const T*>(in.tensor_data().data()), new_perm,
+          new_dims,
+          reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data())));
+      return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,10 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include <utility>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -35,6 +44,53 @@ class TransposeUtilTest : public ::testing::Test {
     EXPECT_EQ(computed_perm, expected_perm);
     EXPECT_EQ(computed_dims, expected_dims);
   }
+
+  // Checks DoTranspose on CPU against an element by element transpose.
+  template <typename T>
+  void TestCpuTranspose(const TensorShape& shape,
+                        const std::vector<int32>& perm) {
+    thread::ThreadPool pool(Env::Default(), "transpose", 4);
+    Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(),
+                                   pool.NumThreads());
+    const DataType dtype = DataTypeToEnum<T>::v();
+    Tensor in(dtype, shape);
+    auto in_flat = in.flat<T>();
+    for (int64_t i = 0; i < in.NumElements(); ++i) {
+      in_flat(i) = static_cast<T>(i % 127);
+    }
+    TensorShape out_shape;
+    for (const int32 dim : perm) out_shape.AddDim(shape.dim_size(dim));
+    Tensor out(dtype, out_shape);
+    TF_ASSERT_OK(DoTranspose(device, in, perm, &out));
+
+    Tensor expected(dtype, out_shape);
+    auto expected_flat = expected.flat<T>();
+    const int ndims = shape.dims();
+    std::vector<int64_t> index(ndims, 0);
+    for (int64_t i = 0; i < expected.NumElements(); ++i) {
+      int64_t in_index = 0;
+      for (int d = 0; d < ndims; ++d) {
+        in_index = in_index * shape.dim_size(d) + index[perm[d]];
+      }
+      expected_flat(i) = in_flat(in_index);
+      for (int d = ndims - 1; d >= 0; --d) {
+        if (++index[perm[d]] < out_shape.dim_size(d)) break;
+        index[perm[d]] = 0;
+      }
+    }
+    test::ExpectTensorEqual<T>(out, expected);
+  }
+
+  template <typename T>
+  void TestCpuTransposes() {
+    TestCpuTranspose<T>({67, 45}, {1, 0});
+    TestCpuTranspose<T>({3, 35, 1, 70}, {0, 3, 2, 1});
+    TestCpuTranspose<T>({2, 5, 33, 17, 3}, {4, 2, 0, 3, 1});
+    TestCpuTranspose<T>({4, 3, 6, 5, 7, 2}, {5, 3, 1, 4, 2, 0});
+    // The innermost dimension is not moved.
+    TestCpuTranspose<T>({8, 9, 10, 11}, {0, 2, 1, 3});
+    TestCpuTranspose<T>({2, 1, 3}, {1, 0, 2});
+  }
 };
 
 TEST_F(TransposeUtilTest, NormalDimensionReduction) {
@@ -130,4 +186,14 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+TEST_F(TransposeUtilTest, CpuTransposeUint8) { TestCpuTransposes<uint8>(); }
+
+TEST_F(TransposeUtilTest, CpuTransposeFloat) { TestCpuTransposes<float>(); }
+
+TEST_F(TransposeUtilTest, CpuTransposeInt64) { TestCpuTransposes<int64_t>(); }
+
+TEST_F(TransposeUtilTest, CpuTransposeComplex128) {
+  TestCpuTransposes<complex128>();
+}
+
 }  // namespace tensorflow
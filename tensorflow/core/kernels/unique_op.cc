@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +74,97 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Vectors of integers with at least this many elements are uniquified by a
+// parallel radix sort rather than by a hash map, unless overridden by the
+// TF_UNIQUE_SORT_MIN_SIZE environment variable. A negative value disables
+// sorting.
+constexpr int64_t kDefaultUniqueSortMinSize = 128 * 1024;
+
+// The radix sort orders keys by one byte per pass.
+constexpr int kRadixBits = 8;
+constexpr int kRadixBuckets = 1 << kRadixBits;
+
+// The minimum number of elements handled by each block of the parallel sort
+// and scans, so that small inputs do not pay for many tiny blocks.
+constexpr int64_t kMinElementsPerBlock = 16 * 1024;
+
+// Integer elements (other than bool, which has only two values) may be
+// uniquified by sorting.
+template <typename T>
+struct UniqueOpIsSortable
+    : std::integral_constant<bool, std::is_integral<T>::value &&
+                                       !std::is_same<T, bool>::value> {};
+
+// Splits [0, size) into `num_blocks` contiguous blocks and runs
+// `fn(block, begin, end)` for each of them on the CPU worker threads.
+template <typename Fn>
+void ForEachBlock(OpKernelContext* context, int64_t size, int64_t num_blocks,
+                  const Fn& fn) {
+  const int64_t block_size = Eigen::divup(size, num_blocks);
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+        /*cost_per_unit=*/block_size * 8, [&](int64_t start, int64_t limit) {
+          for (int64_t block = start; block < limit; ++block) {
+            fn(block, std::min(size, block * block_size),
+               std::min(size, (block + 1) * block_size));
+          }
+        });
+}
+
+// Stably sorts `keys` in ascending order with a parallel LSD radix sort and
+// applies the same permutation to `positions`. Each pass histograms the
+// digits of every block, turns the histograms into per-block output offsets,
+// and scatters the blocks concurrently. Passes over a digit on which all keys
+// agree, such as the high bytes of small ids, are skipped.
+template <typename Key>
+void ParallelRadixSort(OpKernelContext* context, int64_t num_blocks,
+                       std::vector<Key>* keys, std::vector<int32>* positions) {
+  const int64_t n = keys->size();
+  std::vector<Key> keys_out(n);
+  std::vector<int32> positions_out(n);
+  std::vector<int64_t> offsets(num_blocks * kRadixBuckets);
+  for (int shift = 0; shift < static_cast<int>(sizeof(Key)) * 8;
+       shift += kRadixBits) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    const Key* keys_in = keys->data();
+    ForEachBlock(context, n, num_blocks,
+                 [&](int64_t block, int64_t begin, int64_t end) {
+                   int64_t* histogram = &offsets[block * kRadixBuckets];
+                   for (int64_t i = begin; i < end; ++i) {
+                     ++histogram[(keys_in[i] >> shift) & (kRadixBuckets - 1)];
+                   }
+                 });
+
+    // Orders the offsets by digit, then by block, which keeps the sort stable.
+    bool single_digit = false;
+    int64_t sum = 0;
+    for (int digit = 0; digit < kRadixBuckets; ++digit) {
+      const int64_t digit_start = sum;
+      for (int64_t block = 0; block < num_blocks; ++block) {
+        const int64_t count = offsets[block * kRadixBuckets + digit];
+        offsets[block * kRadixBuckets + digit] = sum;
+        sum += count;
+      }
+      single_digit |= (sum - digit_start == n);
+    }
+    if (single_digit) continue;
+
+    const int32* positions_in = positions->data();
+    ForEachBlock(context, n, num_blocks,
+                 [&](int64_t block, int64_t begin, int64_t end) {
+                   int64_t* offset = &offsets[block * kRadixBuckets];
+                   for (int64_t i = begin; i < end; ++i) {
+                     const int64_t out =
+                         offset[(keys_in[i] >> shift) & (kRadixBuckets - 1)]++;
+                     keys_out[out] = keys_in[i];
+                     positions_out[out] = positions_in[i];
+                   }
+                 });
+    keys->swap(keys_out);
+    positions->swap(positions_out);
+  }
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -76,7 +173,11 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
-  explicit UniqueOp(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit UniqueOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_UNIQUE_SORT_MIN_SIZE",
+                                                kDefaultUniqueSortMinSize,
+                                                &sort_min_size_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& input = context->input(0);
@@ -144,6 +245,13 @@ class UniqueOp : public OpKernel {
 
     int64_t uniq_size;
     if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+      if constexpr (UniqueOpIsSortable<T>::value) {
+        if (sort_min_size_ >= 0 && new_sizes[1] >= sort_min_size_) {
+          ComputeBySorting(context, input, axis, idx_vec);
+          return;
+        }
+      }
+
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -237,6 +345,104 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Uniquifies a vector of integers by sorting it. Equal elements form runs
+  // of the stably sorted vector, and the first element of each run is the
+  // first occurrence of its value. Numbering the first occurrences in input
+  // order keeps the output order of the hash map implementation, and the
+  // length of each run is its count.
+  void ComputeBySorting(OpKernelContext* context, const Tensor& input,
+                        int64_t axis, typename TTypes<TIndex>::Vec idx_vec) {
+    using Key = typename std::make_unsigned<T>::type;
+    auto Tin = input.flat<T>();
+    const int64_t N = static_cast<int64_t>(Tin.size());
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64_t num_blocks = std::max<int64_t>(
+        1, std::min<int64_t>(worker_threads->num_threads,
+                             N / kMinElementsPerBlock));
+
+    std::vector<Key> keys(N);
+    std::vector<int32> positions(N);
+    ForEachBlock(context, N, num_blocks,
+                 [&](int64_t block, int64_t begin, int64_t end) {
+                   for (int64_t i = begin; i < end; ++i) {
+                     keys[i] = static_cast<Key>(Tin(i));
+                     positions[i] = static_cast<int32>(i);
+                   }
+                 });
+    ParallelRadixSort(context, num_blocks, &keys, &positions);
+
+    // Marks the first occurrence of each value, then numbers the marked
+    // elements in input order with an exclusive scan.
+    std::vector<int32> ids(N, 0);
+    ForEachBlock(context, N, num_blocks,
+                 [&](int64_t block, int64_t begin, int64_t end) {
+                   for (int64_t p = begin; p < end; ++p) {
+                     if (p == 0 || keys[p] != keys[p - 1]) {
+                       ids[positions[p]] = 1;
+                     }
+                   }
+                 });
+    std::vector<int64_t> block_starts(num_blocks);
+    ForEachBlock(context, N, num_blocks,
+                 [&](int64_t block, int64_t begin, int64_t end) {
+                   int64_t count = 0;
+                   for (int64_t i = begin; i < end; ++i) count += ids[i];
+                   block_starts[block] = count;
+                 });
+    int64_t uniq_size = 0;
+    for (int64_t& block_start : block_starts) {
+      const int64_t count = block_start;
+      block_start = uniq_size;
+      uniq_size += count;
+    }
+    ForEachBlock(context, N, num_blocks,
+                 [&](int64_t block, int64_t begin, int64_t end) {
+                   int32 next = static_cast<int32>(block_starts[block]);
+                   for (int64_t i = begin; i < end; ++i) {
+                     const int32 is_first = ids[i];
+                     ids[i] = next;
+                     next += is_first;
+                   }
+                 });
+
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    TIndex* counts = nullptr;
+    if (num_outputs() > 2) {
+      Tensor* count_output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(2, TensorShape({uniq_size}),
+                                              &count_output));
+      counts = count_output->vec<TIndex>().data();
+    }
+
+    // Each block expands the runs that start in it, which may extend into the
+    // following blocks.
+    ForEachBlock(context, N, num_blocks,
+                 [&](int64_t block, int64_t begin, int64_t end) {
+                   for (int64_t p = begin; p < end; ++p) {
+                     if (p > 0 && keys[p] == keys[p - 1]) continue;
+                     const int32 first = positions[p];
+                     const TIndex id = static_cast<TIndex>(ids[first]);
+                     Tout(id) = Tin(first);
+                     int64_t q = p;
+                     for (; q < N && keys[q] == keys[p]; ++q) {
+                       idx_vec(positions[q]) = id;
+                     }
+                     if (counts != nullptr) {
+                       counts[id] = static_cast<TIndex>(q - p);
+                     }
+                     p = q - 1;
+                   }
+                 });
+  }
+
+  int64_t sort_min_size_;
 };
 
 #define REGISTER_UNIQUE(type)                                      \
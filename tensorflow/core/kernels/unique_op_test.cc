@@ -13,14 +13,22 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/node_builder.h"
@@ -28,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -35,6 +44,82 @@ namespace tensorflow {
 
 namespace {
 
+class UniqueWithCountsOpTest : public OpsTestBase {
+ protected:
+  // Builds UniqueWithCounts, sorting its input when it has at least
+  // `sort_min_size` elements.
+  void MakeOp(DataType dtype, int64_t sort_min_size) {
+    tensorflow::setenv("TF_UNIQUE_SORT_MIN_SIZE",
+                       std::to_string(sort_min_size).c_str(),
+                       1 /* overwrite */);
+    TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                     .Input(FakeInput(dtype))
+                     .Attr("out_idx", DT_INT32)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    tensorflow::unsetenv("TF_UNIQUE_SORT_MIN_SIZE");
+  }
+};
+
+TEST_F(UniqueWithCountsOpTest, SortedInt64) {
+  MakeOp(DT_INT64, 0);
+  AddInputFromArray<int64_t>(TensorShape({8}),
+                             {7, -3, 7, int64_t{1} << 40, -3, 0, 7, -1});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(0), test::AsTensor<int64_t>({7, -3, int64_t{1} << 40, 0, -1}));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(1), test::AsTensor<int32>({0, 1, 0, 2, 1, 3, 0, 4}));
+  test::ExpectTensorEqual<int32>(*GetOutput(2),
+                                 test::AsTensor<int32>({3, 2, 1, 1, 1}));
+}
+
+TEST_F(UniqueWithCountsOpTest, SortedInt8) {
+  MakeOp(DT_INT8, 0);
+  AddInputFromArray<int8>(TensorShape({6}), {-128, 127, 0, -128, -1, 127});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int8>(*GetOutput(0),
+                                test::AsTensor<int8>({-128, 127, 0, -1}));
+  test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                 test::AsTensor<int32>({0, 1, 2, 0, 3, 1}));
+  test::ExpectTensorEqual<int32>(*GetOutput(2),
+                                 test::AsTensor<int32>({2, 2, 1, 1}));
+}
+
+TEST_F(UniqueWithCountsOpTest, SortedMatchesFirstOccurrenceOrder) {
+  // Large enough to be split between several blocks, with runs that cross
+  // block boundaries.
+  const int kSize = 1 << 18;
+  std::mt19937_64 rng(0);
+  std::vector<int64_t> values(kSize);
+  for (int64_t& value : values) {
+    value = static_cast<int64_t>(rng() % 5000) - 2500;
+  }
+  std::vector<int64_t> expected_y;
+  std::vector<int32> expected_idx;
+  std::vector<int32> expected_count;
+  std::unordered_map<int64_t, int32> ids;
+  for (int64_t value : values) {
+    auto it = ids.emplace(value, static_cast<int32>(expected_y.size()));
+    if (it.second) {
+      expected_y.push_back(value);
+      expected_count.push_back(0);
+    }
+    expected_idx.push_back(it.first->second);
+    ++expected_count[it.first->second];
+  }
+
+  MakeOp(DT_INT64, 0);
+  AddInputFromArray<int64_t>(TensorShape({kSize}), values);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0),
+                                   test::AsTensor<int64_t>(expected_y));
+  test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                 test::AsTensor<int32>(expected_idx));
+  test::ExpectTensorEqual<int32>(*GetOutput(2),
+                                 test::AsTensor<int32>(expected_count));
+}
+
 const int kMaxStrLen = 40;
 
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
@@ -111,6 +196,56 @@ void BM_Unique_INT32_Repeat(::testing::benchmark::State& state) {
                           sizeof(int32));
 }
 
+// Typical distributions of int64 ids.
+enum IdDistribution {
+  kFewIds = 0,     // Uniform over 1024 ids, so almost all are duplicates.
+  kManyIds = 1,    // Uniform over 2^40 ids, so almost none are duplicates.
+  kSkewedIds = 2,  // Power law over 2^24 ids, as for embedding lookups.
+};
+
+Tensor GetRandomInt64Ids(int dim, IdDistribution distribution) {
+  Tensor ids(DT_INT64, TensorShape({dim}));
+  auto ids_flat = ids.flat<int64_t>();
+  std::mt19937_64 rng(0);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  for (int i = 0; i < dim; ++i) {
+    switch (distribution) {
+      case kFewIds:
+        ids_flat(i) = rng() % 1024;
+        break;
+      case kManyIds:
+        ids_flat(i) = rng() % (int64_t{1} << 40);
+        break;
+      case kSkewedIds:
+        ids_flat(i) = static_cast<int64_t>(std::pow(2.0, 24 * uniform(rng)));
+        break;
+    }
+  }
+  return ids;
+}
+
+void BM_Unique_INT64(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  const IdDistribution distribution =
+      static_cast<IdDistribution>(state.range(1));
+
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UniqueWithCounts")
+                  .Input(test::graph::Constant(
+                      g, GetRandomInt64Ids(dim, distribution)))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+  FixupSourceAndSinkEdges(g);
+
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr,
+                  "SINGLE_THREADED_EXECUTOR", /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * dim *
+                          sizeof(int64_t));
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -193,6 +328,18 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+BENCHMARK(BM_Unique_INT64)
+    ->UseRealTime()
+    ->ArgPair(64 * 1024, kFewIds)
+    ->ArgPair(64 * 1024, kManyIds)
+    ->ArgPair(64 * 1024, kSkewedIds)
+    ->ArgPair(1024 * 1024, kFewIds)
+    ->ArgPair(1024 * 1024, kManyIds)
+    ->ArgPair(1024 * 1024, kSkewedIds)
+    ->ArgPair(10 * 1024 * 1024, kFewIds)
+    ->ArgPair(10 * 1024 * 1024, kManyIds)
+    ->ArgPair(10 * 1024 * 1024, kSkewedIds);
+
 BENCHMARK(BM_Unique_STRING)
     ->UseRealTime()
     ->Arg(32)
@@ -593,6 +593,99 @@ bool GetImageInfo(const void* srcdata, int datasize, int* width, int* height,
   return true;
 }
 
+bool ReadCoefficients(const void* srcdata, int datasize,
+                      Coefficients* coefficients,
+                      std::function<int16*(int64_t)> allocate_blocks) {
+  if (datasize == 0 || srcdata == nullptr) return false;
+
+  struct jpeg_decompress_struct cinfo;
+  struct jpeg_error_mgr jerr;
+  jmp_buf jpeg_jmpbuf;
+  cinfo.err = jpeg_std_error(&jerr);
+  cinfo.client_data = &jpeg_jmpbuf;
+  jerr.error_exit = CatchError;
+#ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
+  jerr.output_message = no_print;
+#endif
+  if (setjmp(jpeg_jmpbuf)) {
+    return false;
+  }
+
+  jpeg_create_decompress(&cinfo);
+  SetSrc(&cinfo, srcdata, datasize, false);
+  jpeg_read_header(&cinfo, TRUE);
+
+  const bool supported_color_space =
+      (cinfo.jpeg_color_space == JCS_GRAYSCALE && cinfo.num_components == 1) ||
+      (cinfo.jpeg_color_space == JCS_YCbCr && cinfo.num_components == 3);
+  const int64_t total_size = static_cast<int64_t>(cinfo.image_width) *
+                             cinfo.image_height * cinfo.num_components;
+  if (!supported_color_space || cinfo.image_width <= 0 ||
+      cinfo.image_height <= 0 || total_size >= (1LL << 29)) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+
+  jvirt_barray_ptr* arrays = jpeg_read_coefficients(&cinfo);
+  if (arrays == nullptr || jerr.num_warnings > 0) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+
+  coefficients->width = cinfo.image_width;
+  coefficients->height = cinfo.image_height;
+  coefficients->max_h_samp_factor = cinfo.max_h_samp_factor;
+  coefficients->max_v_samp_factor = cinfo.max_v_samp_factor;
+  coefficients->components.resize(cinfo.num_components);
+  int64_t num_blocks = 0;
+  for (int c = 0; c < cinfo.num_components; ++c) {
+    const jpeg_component_info& info = cinfo.comp_info[c];
+    Coefficients::Component& component = coefficients->components[c];
+    // Only the upsampling of subsampled chroma by a factor of 1 or 2 is
+    // supported.
+    if (info.quant_table == nullptr ||
+        cinfo.max_h_samp_factor % info.h_samp_factor != 0 ||
+        cinfo.max_v_samp_factor % info.v_samp_factor != 0 ||
+        cinfo.max_h_samp_factor / info.h_samp_factor > 2 ||
+        cinfo.max_v_samp_factor / info.v_samp_factor > 2) {
+      jpeg_destroy_decompress(&cinfo);
+      return false;
+    }
+    component.h_samp_factor = info.h_samp_factor;
+    component.v_samp_factor = info.v_samp_factor;
+    component.width = info.downsampled_width;
+    component.height = info.downsampled_height;
+    component.width_in_blocks = info.width_in_blocks;
+    component.height_in_blocks = info.height_in_blocks;
+    component.block_offset = num_blocks;
+    std::copy(info.quant_table->quantval, info.quant_table->quantval + 64,
+              component.quant_table);
+    num_blocks +=
+        static_cast<int64_t>(info.width_in_blocks) * info.height_in_blocks;
+  }
+
+  int16* blocks = allocate_blocks(num_blocks);
+  if (blocks == nullptr) {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+  }
+  for (int c = 0; c < cinfo.num_components; ++c) {
+    const Coefficients::Component& component = coefficients->components[c];
+    int16* component_blocks = blocks + component.block_offset * DCTSIZE2;
+    for (int row = 0; row < component.height_in_blocks; ++row) {
+      JBLOCKARRAY block_row = (*cinfo.mem->access_virt_barray)(
+          reinterpret_cast<j_common_ptr>(&cinfo), arrays[c], row, 1, FALSE);
+      memcpy(component_blocks + static_cast<int64_t>(row) *
+                                    component.width_in_blocks * DCTSIZE2,
+             block_row[0], component.width_in_blocks * sizeof(JBLOCK));
+    }
+  }
+
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  return true;
+}
+
 // -----------------------------------------------------------------------------
 // Compression
 
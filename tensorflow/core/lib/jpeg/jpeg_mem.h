@@ -23,6 +23,7 @@ limitations under the License.
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/platform/jpeg.h"
@@ -106,6 +107,45 @@ uint8* Uncompress(const void* srcdata, int datasize,
 bool GetImageInfo(const void* srcdata, int datasize, int* width, int* height,
                   int* components);
 
+// The quantized DCT coefficients of a JPEG image, as entropy decoded by
+// libjpeg before the inverse DCT, upsampling and color conversion, which the
+// caller performs instead (e.g. on a GPU).
+struct Coefficients {
+  // The size of the image in pixels.
+  int width = 0;
+  int height = 0;
+  // The largest sampling factors of the components.
+  int max_h_samp_factor = 1;
+  int max_v_samp_factor = 1;
+
+  struct Component {
+    int h_samp_factor = 1;
+    int v_samp_factor = 1;
+    // The size of the component in samples and in 8x8 blocks.
+    int width = 0;
+    int height = 0;
+    int width_in_blocks = 0;
+    int height_in_blocks = 0;
+    // The offset of the first block of the component in the coefficients.
+    int64_t block_offset = 0;
+    // The quantization table, in natural order.
+    uint16 quant_table[64] = {};
+  };
+  // One component for grayscale images, or Y, Cb and Cr for color images.
+  std::vector<Component> components;
+};
+
+// Entropy decodes the JPEG data given by srcdata and datasize into the
+// blocks of 64 coefficients, in natural order, of all the components one after
+// the other. They are stored in the buffer returned by `allocate_blocks`,
+// which is called with the total number of blocks.
+// Only grayscale and YCbCr images with sampling factors of at most 2 are
+// supported. Returns false for other images, on errors, and on corrupt or
+// truncated data that libjpeg would warn about.
+bool ReadCoefficients(const void* srcdata, int datasize,
+                      Coefficients* coefficients,
+                      std::function<int16*(int64_t)> allocate_blocks);
+
 // Note: (format & 0xff) = number of components (<=> bytes per pixels)
 enum Format {
   FORMAT_GRAYSCALE = 0x001,  // 1 byte/pixel
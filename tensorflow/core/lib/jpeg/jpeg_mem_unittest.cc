@@ -21,6 +21,7 @@ limitations under the License.
 #include <string.h>
 
 #include <memory>
+#include <vector>
 
 #include "absl/base/casts.h"
 #include "jpeglib.h"  // from @libjpeg_turbo
@@ -522,6 +523,76 @@ TEST(JpegMemTest, BadJpeg) {
   TestBadJPEG(env, data_path + "corrupt34_4.jpg", 2544, 3300, "", true);
 }
 
+TEST(JpegMemTest, ReadCoefficients) {
+  // Compress a uniform gray image, whose blocks only have a DC coefficient.
+  constexpr int kWidth = 40;
+  constexpr int kHeight = 24;
+  constexpr int kValue = 200;
+  std::vector<uint8> image(kWidth * kHeight * 3, kValue);
+  CompressFlags flags;
+  flags.format = FORMAT_RGB;
+  flags.quality = 100;
+  tstring jpeg;
+  ASSERT_TRUE(Compress(image.data(), kWidth, kHeight, flags, &jpeg));
+
+  Coefficients coefficients;
+  std::vector<int16> blocks;
+  ASSERT_TRUE(ReadCoefficients(jpeg.data(), jpeg.size(), &coefficients,
+                               [&](int64_t num_blocks) {
+                                 blocks.resize(num_blocks * 64);
+                                 return blocks.data();
+                               }));
+  EXPECT_EQ(coefficients.width, kWidth);
+  EXPECT_EQ(coefficients.height, kHeight);
+  EXPECT_EQ(coefficients.max_h_samp_factor, 2);
+  EXPECT_EQ(coefficients.max_v_samp_factor, 2);
+  ASSERT_EQ(coefficients.components.size(), 3);
+
+  // The luma is not subsampled and the chroma is subsampled 2x2.
+  const Coefficients::Component& luma = coefficients.components[0];
+  EXPECT_EQ(luma.width, kWidth);
+  EXPECT_EQ(luma.height, kHeight);
+  EXPECT_EQ(luma.width_in_blocks, kWidth / 8);
+  EXPECT_EQ(luma.height_in_blocks, kHeight / 8);
+  const Coefficients::Component& cr = coefficients.components[2];
+  EXPECT_EQ(cr.width, kWidth / 2);
+  EXPECT_EQ(cr.width_in_blocks, 3);
+  EXPECT_EQ(cr.height_in_blocks, 2);
+  EXPECT_EQ(cr.block_offset, luma.width_in_blocks * luma.height_in_blocks + 6);
+  EXPECT_EQ(blocks.size(), (cr.block_offset + 6) * 64);
+
+  // The DC coefficient of a block is 8 times its mean, shifted by -128.
+  for (int64_t block = 0; block < luma.width_in_blocks * luma.height_in_blocks;
+       ++block) {
+    EXPECT_NEAR(blocks[block * 64] * luma.quant_table[0], 8 * (kValue - 128),
+                luma.quant_table[0]);
+    EXPECT_EQ(blocks[block * 64 + 1], 0);
+  }
+}
+
+TEST(JpegMemTest, ReadCoefficientsOfUnsupportedJpeg) {
+  Env* env = Env::Default();
+  const string data_path = kTestData;
+  const auto allocate = [](int64_t num_blocks) {
+    static int16 blocks[1];
+    return blocks;
+  };
+
+  string jpeg;
+  ReadFileToStringOrDie(env, data_path + "jpeg_merge_test1_cmyk.jpg", &jpeg);
+  Coefficients coefficients;
+  EXPECT_FALSE(ReadCoefficients(jpeg.data(), jpeg.size(), &coefficients,
+                                allocate));
+
+  ReadFileToStringOrDie(env, data_path + "corrupt34_2.jpg", &jpeg);
+  std::vector<int16> blocks;
+  EXPECT_FALSE(ReadCoefficients(jpeg.data(), jpeg.size(), &coefficients,
+                                [&](int64_t num_blocks) {
+                                  blocks.resize(num_blocks * 64);
+                                  return blocks.data();
+                                }));
+}
+
 }  // namespace
 }  // namespace jpeg
 }  // namespace tensorflow
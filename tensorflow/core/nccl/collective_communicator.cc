@@ -37,6 +37,8 @@ class NcclCommunicator : public NcclCommunicatorInterface {
 
   void StartAbort(const Status& s) override;
 
+  void Reset() override;
+
  private:
   NcclManager nccl_manager_;
 };
@@ -221,6 +223,8 @@ void NcclCommunicator::StartAbort(const Status& s) {
   nccl_manager_.StartAbort(s);
 }
 
+void NcclCommunicator::Reset() { nccl_manager_.Reset(); }
+
 }  // namespace tensorflow
 
 #else
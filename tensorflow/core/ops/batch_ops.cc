@@ -96,6 +96,14 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If 'enable_ragged_batching' is true, the row lengths (dimension 1) of
+    // each of 'in_tensors' may differ between the batched invocations. Each of
+    // them is passed to 'f' as two tensors, the values and the int64 row splits
+    // of a ragged tensor of the batch, so no computation is spent on padding
+    // the rows to the longest one. Padding up to 'allowed_batch_sizes' only
+    // adds empty rows. The outputs of 'f' are split along dimension 0 as
+    // usual.
+    .Attr("enable_ragged_batching: bool = false")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape)
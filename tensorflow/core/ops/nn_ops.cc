@@ -1301,6 +1301,75 @@ REGISTER_OP("LogSoftmax")
 
 // --------------------------------------------------------------------------
 
+REGISTER_OP("_FusedMultiHeadAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("mask: num_args * T")
+    .Output("output: T")
+    .Attr("T: {half, bfloat16, float}")
+    .Attr("num_args: int >= 0 = 0")
+    .Attr("scale: float = 1.0")
+    .SetShapeFn([](InferenceContext* c) {
+      int num_args;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_args", &num_args));
+      if (num_args > 1) {
+        return errors::InvalidArgument(
+            "_FusedMultiHeadAttention takes at most one mask, got ", num_args);
+      }
+      // query: [batch, (heads,) q_len, head_size]
+      // key:   [batch, (heads,) kv_len, head_size]
+      // value: [batch, (heads,) kv_len, value_size]
+      ShapeHandle query;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 3, &query));
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(query, 4, &query));
+      const int32_t rank = c->Rank(query);
+      ShapeHandle key;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), rank, &key));
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), rank, &value));
+
+      ShapeHandle batch_dims;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, rank - 2, &batch_dims));
+      ShapeHandle key_batch_dims;
+      TF_RETURN_IF_ERROR(c->Subshape(key, 0, rank - 2, &key_batch_dims));
+      ShapeHandle value_batch_dims;
+      TF_RETURN_IF_ERROR(c->Subshape(value, 0, rank - 2, &value_batch_dims));
+      TF_RETURN_IF_ERROR(c->Merge(batch_dims, key_batch_dims, &batch_dims));
+      TF_RETURN_IF_ERROR(c->Merge(batch_dims, value_batch_dims, &batch_dims));
+
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(query, -1), c->Dim(key, -1), &unused));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(key, -2), c->Dim(value, -2), &unused));
+      if (num_args == 1) {
+        ShapeHandle mask;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(3), rank, &mask));
+      }
+
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          batch_dims, c->Matrix(c->Dim(query, -2), c->Dim(value, -1)),
+          &output));
+      c->set_output(0, output);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes the scaled dot-product attention of `query` over `key` and `value`:
+`Softmax(MatMul(query, key, adj_y=True) * scale + mask) @ value`, without
+materializing the attention scores.
+
+`mask` is added to the scaled scores and has the rank of `query`, each of its
+dimensions being either 1 or the matching dimension of the
+[..., q_len, kv_len] scores.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
+
+// --------------------------------------------------------------------------
+
 REGISTER_OP("SoftmaxCrossEntropyWithLogits")
     .Input("features: T")
     .Input("labels: T")
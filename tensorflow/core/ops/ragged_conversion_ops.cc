@@ -94,6 +94,7 @@ Status RaggedTensorToVariantShapeFn(InferenceContext* c);
 Status RaggedTensorFromVariantShapeFn(InferenceContext* c);
 Status RaggedTensorToVariantGradientShapeFn(InferenceContext* c);
 Status RaggedTensorToTensorShapeFn(InferenceContext* c);
+Status RaggedTensorToTensorWithMaskShapeFn(InferenceContext* c);
 
 //==============================================================================
 // Registered Ops
@@ -153,6 +154,35 @@ REGISTER_OP("RaggedTensorToTensor")
     .Output("result: T")
     .SetShapeFn(RaggedTensorToTensorShapeFn);
 
+// Fusion of RaggedTensorToTensor with the padding mask of its result. The mask
+// has the shape of the first ragged_rank + 1 dimensions of `result`, and holds
+// `valid_mask_value` where `result` was copied from `values` and
+// `padding_mask_value` where it was filled with `default_value`. A bool mask is
+// true and false, respectively.
+REGISTER_OP("_RaggedTensorToTensorWithMask")
+    .Attr("T: type")
+    .Attr("Tindex: {int64, int32}")
+    .Attr("Tshape: {int64, int32}")
+    .Attr("num_row_partition_tensors: int")
+    .Attr("row_partition_types: list(string)")
+    .Attr("Tmask: {bool, float} = DT_BOOL")
+    .Attr("valid_mask_value: float = 1.0")
+    .Attr("padding_mask_value: float = 0.0")
+    .Input("shape: Tshape")
+    .Input("values: T")
+    .Input("default_value: T")
+    .Input("row_partition_tensors: num_row_partition_tensors * Tindex")
+    .Output("result: T")
+    .Output("mask: Tmask")
+    .SetShapeFn(RaggedTensorToTensorWithMaskShapeFn)
+    .Doc(R"doc(
+Converts a RaggedTensor into a dense tensor and the mask of its padding.
+
+Internal fusion of RaggedTensorToTensor with the SequenceMask of the row
+lengths of its input. NOTE: Do not invoke this operator directly in Python.
+Grappler is expected to create these operators.
+)doc");
+
 //==============================================================================
 // Shape Functions
 //==============================================================================
@@ -279,4 +309,22 @@ tensorflow::Status RaggedTensorToTensorShapeFn(InferenceContext* c) {
   return absl::OkStatus();
 }
 
+Status RaggedTensorToTensorWithMaskShapeFn(InferenceContext* c) {
+  TF_RETURN_IF_ERROR(RaggedTensorToTensorShapeFn(c));
+
+  std::vector<RowPartitionType> row_partition_types;
+  TF_RETURN_IF_ERROR(GetRowPartitionTypes(c, &row_partition_types));
+  const int ragged_rank = GetRaggedRank(row_partition_types);
+
+  ShapeHandle mask_shape;
+  if (c->RankKnown(c->output(0))) {
+    TF_RETURN_IF_ERROR(
+        c->Subshape(c->output(0), 0, ragged_rank + 1, &mask_shape));
+  } else {
+    mask_shape = c->UnknownShapeOfRank(ragged_rank + 1);
+  }
+  c->set_output(1, mask_shape);
+  return absl::OkStatus();
+}
+
 }  // namespace tensorflow
@@ -310,6 +310,75 @@ REGISTER_OP("ResourceGather")
       return absl::OkStatus();
     });
 
+REGISTER_OP("_ResourceSparseSegmentReduction")
+    .Input("resource: resource")
+    .Input("gather_indices: Tgather")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Input("num_segments: num_args * int32")
+    .Output("output: dtype")
+    .Attr("dtype: {bfloat16, half, float, double}")
+    .Attr("Tgather: {int32, int64}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("num_args: int >= 0 = 0")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'}")
+    .SetShapeFn([](InferenceContext* c) {
+      std::vector<ShapeAndType> handle_shape_and_type;
+      TF_RETURN_IF_ERROR(shape_inference::ValidateVariableResourceHandle(
+          c, &handle_shape_and_type));
+
+      ShapeHandle params_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(handle_shape_and_type[0].shape, 1,
+                                            &params_shape));
+
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+
+      ShapeHandle indices_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+
+      ShapeHandle segment_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids_shape));
+
+      // indices and segment_ids should merge cleanly.
+      TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+
+      int num_args;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_args", &num_args));
+      if (num_args > 1) {
+        return errors::InvalidArgument(
+            "_ResourceSparseSegmentReduction takes at most one num_segments, "
+            "got ",
+            num_args);
+      }
+      shape_inference::DimensionHandle dim0 = c->UnknownDim();
+      if (num_args == 1) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));
+        TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(4, &dim0));
+      }
+
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &subshape));
+
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(c->Vector(dim0), subshape, &out));
+      c->set_output(0, out);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Internal operation which is a composition of gathering rows of a resource
+variable (ResourceGather) and reducing them by segments (SparseSegmentSum,
+SparseSegmentMean or SparseSegmentSqrtN, as given by `combiner`): reserved for
+internal use.
+
+The reduced rows are `resource[gather_indices[indices[i]]]`, read straight from
+the variable buffer.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("ResourceGatherNd")
     .Input("resource: resource")
     .Input("indices: Tindices")
@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/summary/summary_file_writer.h"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -24,12 +26,20 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/util/events_writer.h"
 
 namespace tensorflow {
 namespace {
 
+auto* summary_writer_blocked_usecs = monitoring::Counter<0>::New(
+    "/tensorflow/core/summary_file_writer/blocked_usecs",
+    "Time step threads waited for the background writing of summary events.");
+
+// Queues the events written to it, and writes them to the events file in
+// batches from a background thread, so that writing a summary only blocks on
+// the file system when the background thread falls behind.
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
@@ -56,6 +66,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
     const string uniquified_filename_suffix = absl::StrCat(
         ".", pid, ".", file_id_counter.fetch_add(1), sep, filename_suffix);
     mutex_lock ml(mu_);
+    mutex_lock writer_lock(writer_mu_);
     events_writer_ =
         std::make_unique<EventsWriter>(io::JoinPath(logdir, "events"));
     TF_RETURN_WITH_CONTEXT_IF_ERROR(
@@ -63,6 +74,9 @@ class SummaryFileWriter : public SummaryWriterInterface {
         "Could not initialize events writer.");
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    writer_thread_.reset(env_->StartThread(ThreadOptions(),
+                                           "summary_file_writer",
+                                           [this]() { WriterLoop(); }));
     return absl::OkStatus();
   }
 
@@ -71,11 +85,28 @@ class SummaryFileWriter : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    HandOffQueue(&ml);
+    while (!pending_.empty() || writing_) {
+      cv_.wait(ml);
+    }
+    Status status = ConsumeWriteStatus();
+    {
+      // Flushes the events file even if the background thread had nothing to
+      // write, e.g. to report that it can no longer be written.
+      mutex_lock writer_lock(writer_mu_);
+      status.Update(events_writer_->Flush());
+    }
+    return status;
   }
 
   ~SummaryFileWriter() override {
     (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      shutdown_ = true;
+      cv_.notify_all();
+    }
+    writer_thread_.reset();  // Waits for the background thread to exit.
   }
 
   Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
@@ -155,9 +186,10 @@ class SummaryFileWriter : public SummaryWriterInterface {
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      HandOffQueue(&ml);
     }
-    return absl::OkStatus();
+    // Reports the errors of the previous background writes.
+    return ConsumeWriteStatus();
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -167,14 +199,61 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Hands the queued events to the background thread. Blocks while the
+  // background thread has not started writing the previous batch yet, which
+  // bounds the memory held by the queued events.
+  void HandOffQueue(mutex_lock* lock) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!pending_.empty()) {
+      const uint64 start = env_->NowMicros();
+      while (!pending_.empty()) {
+        cv_.wait(*lock);
+      }
+      summary_writer_blocked_usecs->GetCell()->IncrementBy(env_->NowMicros() -
+                                                           start);
+    }
+    pending_.swap(queue_);
+    last_flush_ = env_->NowMicros();
+    cv_.notify_all();
+  }
+
+  // Returns the errors of the background writes since the last call.
+  Status ConsumeWriteStatus() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status status = write_status_;
+    write_status_ = absl::OkStatus();
+    return status;
+  }
+
+  // Writes and flushes the handed off batches of events until shutdown.
+  void WriterLoop() {
+    while (true) {
+      std::vector<std::unique_ptr<Event>> events;
+      {
+        mutex_lock ml(mu_);
+        while (pending_.empty() && !shutdown_) {
+          cv_.wait(ml);
+        }
+        if (pending_.empty()) return;
+        events.swap(pending_);
+        writing_ = true;
+        cv_.notify_all();
+      }
+      Status status = WriteEvents(events);
+      {
+        mutex_lock ml(mu_);
+        writing_ = false;
+        write_status_.Update(status);
+        cv_.notify_all();
+      }
+    }
+  }
+
+  Status WriteEvents(const std::vector<std::unique_ptr<Event>>& events) {
+    mutex_lock ml(writer_mu_);
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
     return absl::OkStatus();
   }
 
@@ -184,11 +263,22 @@ class SummaryFileWriter : public SummaryWriterInterface {
   uint64 last_flush_;
   Env* env_;
   mutex mu_;
+  condition_variable cv_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  // The batch of events handed off to the background thread.
+  std::vector<std::unique_ptr<Event>> pending_ TF_GUARDED_BY(mu_);
+  // Whether the background thread is writing a batch of events.
+  bool writing_ TF_GUARDED_BY(mu_) = false;
+  bool shutdown_ TF_GUARDED_BY(mu_) = false;
+  Status write_status_ TF_GUARDED_BY(mu_);
+  // Serializes the writes of the background thread and of Flush().
+  mutex writer_mu_;
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(writer_mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+  // Declared last, so that it exits before the members it uses are destroyed.
+  std::unique_ptr<Thread> writer_thread_;
 };
 
 }  // namespace
@@ -281,5 +281,47 @@ TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
       << "files = [" << absl::StrJoin(files, ", ") << "]";
 }
 
+TEST_F(SummaryFileWriterTest, WritesInBackgroundInOrder) {
+  // Keep unique with all other test names in this file.
+  const string test_name = "background_writes_test";
+  const int num_events = 100;
+  {
+    SummaryWriterInterface* writer;
+    // Hands off each event to the background thread as it is written.
+    TF_CHECK_OK(CreateSummaryFileWriter(0, 1, testing::TmpDir(), test_name,
+                                        &env_, &writer));
+    core::ScopedUnref deleter(writer);
+    for (int i = 0; i < num_events; ++i) {
+      std::unique_ptr<Event> e{new Event};
+      e->set_step(i);
+      TF_CHECK_OK(writer->WriteEvent(std::move(e)));
+    }
+    TF_CHECK_OK(writer->Flush());
+  }
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  int num_files = 0;
+  for (const string& f : files) {
+    if (!absl::StrContains(f, test_name)) continue;
+    ++num_files;
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env_.NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    tstring record;
+    uint64 offset = 0;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));  // The version event.
+    for (int i = 0; i < num_events; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      Event e;
+      e.ParseFromString(record);
+      EXPECT_EQ(i, e.step());
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+  EXPECT_EQ(1, num_files);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -45,5 +45,17 @@ tsl::monitoring::SamplerCell* GetTfrtDeviceExecutionLatency(
   return cell->GetCell(model_name, absl::StrCat(model_version));
 }
 
+tsl::monitoring::SamplerCell* GetTfrtRunHandlerQueueingDelaySampler(
+    const std::string& pool_name, int sub_thread_pool_id,
+    const std::string& work_type) {
+  static auto* cell = tsl::monitoring::Sampler<3>::New(
+      {"/tfrt/run_handler/queueing_delay",
+       "Tracks the time (in microseconds) tasks wait in the queues of the run "
+       "handlers before a thread of the sub thread pool runs them.",
+       "pool_name", "sub_thread_pool", "work_type"},
+      tsl::monitoring::Buckets::Exponential(1, 1.5, 40));
+  return cell->GetCell(pool_name, absl::StrCat(sub_thread_pool_id), work_type);
+}
+
 }  // namespace tfrt_metrics
 }  // namespace tensorflow
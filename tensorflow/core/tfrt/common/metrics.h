@@ -31,6 +31,11 @@ tsl::monitoring::SamplerCell* GetTfrtGraphExecutorLatencySampler(
 tsl::monitoring::SamplerCell* GetTfrtDeviceExecutionLatency(
     const std::string& model_name, int64_t model_version);
 
+// `work_type` is either "inter" or "intra".
+tsl::monitoring::SamplerCell* GetTfrtRunHandlerQueueingDelaySampler(
+    const std::string& pool_name, int sub_thread_pool_id,
+    const std::string& work_type);
+
 }  // namespace tfrt_metrics
 }  // namespace tensorflow
 
@@ -52,6 +52,13 @@ uint64_t CostRecorder::GetCost(int64_t op_key) const {
 }
 
 Status CostRecorder::WriteToFile() const {
+  std::string measured_cost_path;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar(MesuredCostPathEnvVarName(), "",
+                                          &measured_cost_path));
+  return WriteToFile(measured_cost_path);
+}
+
+Status CostRecorder::WriteToFile(const std::string& path) const {
   OpCostMapProto op_cost_map_proto;
   {
     tf_shared_lock l(op_cost_map_mutex_);
@@ -61,11 +68,18 @@ Status CostRecorder::WriteToFile() const {
     }
   }
 
-  std::string measured_cost_path;
-  TF_RETURN_IF_ERROR(ReadStringFromEnvVar(MesuredCostPathEnvVarName(), "",
-                                          &measured_cost_path));
-  return tensorflow::WriteTextProto(tensorflow::Env::Default(),
-                                    measured_cost_path, op_cost_map_proto);
+  return tensorflow::WriteTextProto(tensorflow::Env::Default(), path,
+                                    op_cost_map_proto);
+}
+
+Status CostRecorder::ReadFromFile(const std::string& path) {
+  OpCostMapProto op_cost_map_proto;
+  TF_RETURN_IF_ERROR(tensorflow::ReadTextProto(tensorflow::Env::Default(),
+                                               path, &op_cost_map_proto));
+  for (const auto& [op_key, op_cost] : op_cost_map_proto.op_cost_map()) {
+    RecordCost(op_key, op_cost);
+  }
+  return absl::OkStatus();
 }
 
 size_t CostRecorder::size() const {
@@ -18,6 +18,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_COST_RECORDER_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_COST_RECORDER_H_
 
+#include <string>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
@@ -47,6 +48,14 @@ class CostRecorder {
   // TODO(b/263837451): Fix the op_key unstableness during serialization.
   Status WriteToFile() const;
 
+  // Writes the op cost map (in format of `OpCostMapProto`) to `path`.
+  Status WriteToFile(const std::string& path) const;
+
+  // Records the costs of the op cost map (in format of `OpCostMapProto`) in
+  // `path`, e.g. one written by `WriteToFile()` in an earlier load of the
+  // model, as one execution of each op.
+  Status ReadFromFile(const std::string& path);
+
   size_t size() const;
 
   static const char* MesuredCostPathEnvVarName() {
@@ -98,6 +98,27 @@ TEST(CostRecorderTest, ProtoRecordsTest) {
             kTestAvgCost);
 }
 
+TEST(CostRecorderTest, ReadFromFileTest) {
+  CostRecorder recorder;
+  recorder.RecordCost(kTestOpKey, kTestCost);
+  recorder.RecordCost(kTestOpKey, 2 * kTestCost);
+
+  std::string measured_cost_path;
+  tensorflow::Env::Default()->LocalTempFilename(&measured_cost_path);
+  TF_CHECK_OK(recorder.WriteToFile(measured_cost_path));
+
+  // The persisted average counts as one execution.
+  CostRecorder loaded_recorder;
+  TF_CHECK_OK(loaded_recorder.ReadFromFile(measured_cost_path));
+  ASSERT_EQ(loaded_recorder.size(), 1);
+  EXPECT_EQ(loaded_recorder.GetCost(kTestOpKey), kTestAvgCost);
+  loaded_recorder.RecordCost(kTestOpKey, kTestAvgCost + 2);
+  EXPECT_EQ(loaded_recorder.GetCost(kTestOpKey), kTestAvgCost + 1);
+
+  EXPECT_FALSE(loaded_recorder.ReadFromFile(measured_cost_path + ".missing")
+                   .ok());
+}
+
 }  // namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
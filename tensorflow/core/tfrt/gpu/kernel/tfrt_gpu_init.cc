@@ -30,7 +30,15 @@ namespace gpu {
 
 Status InitTfrtGpu(const GpuRunnerOptions& options,
                    tensorflow::tfrt_stub::Runtime& runtime) {
-  auto policy = std::make_unique<tsl::RoundRobinPolicy>();
+  std::unique_ptr<tsl::ServingDeviceSelector::Policy> policy;
+  switch (options.serving_selector_policy) {
+    case tsl::ServingDeviceSelectorPolicy::kRoundRobin:
+      policy = std::make_unique<tsl::RoundRobinPolicy>();
+      break;
+    case tsl::ServingDeviceSelectorPolicy::kLeastLoaded:
+      policy = std::make_unique<tsl::LeastLoadedPolicy>();
+      break;
+  }
   auto serving_device_selector =
       std::make_unique<tensorflow::gpu::GpuServingDeviceSelector>(
           options.num_gpu_streams, std::move(policy));
@@ -96,6 +96,14 @@ struct GraphExecutionOptions {
     // Number of times to record costs before resetting Op cost estimates.
     // However, a reset always occurs after the first execution.
     int updates_per_interval = 1;
+
+    // If non-empty, the op costs used at each recompilation are also written
+    // to a file per client graph in this directory. A later load of the same
+    // graph, e.g. after recording costs on canary traffic, compiles with the
+    // costs in that file, so that its streams are already merged by measured
+    // costs. Used with `enable_mlrt` only, and even when `version` is
+    // `kDisabled`.
+    std::string persisted_cost_dir;
   };
 
   CostAnalysisOptions cost_analysis_options;
@@ -108,6 +116,13 @@ struct GraphExecutionOptions {
   // This option is experimental.
   bool use_ifrt = false;
 
+  // If non-empty, the MLRT bytecode of the client graphs is cached in files
+  // in this directory, keyed by the fingerprint of the graph, the client graph
+  // and the compile options. A reloaded or restarted model then loads the
+  // bytecode instead of lowering the client graphs again. Only used with
+  // `enable_mlrt` for CPU graphs without a backend compiler or cost analysis.
+  std::string executable_cache_dir;
+
   tensorflow::TfrtCompileOptions compile_options;
 };
 
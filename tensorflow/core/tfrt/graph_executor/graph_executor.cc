@@ -17,10 +17,12 @@ limitations under the License.
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,6 +32,7 @@ limitations under the License.
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
@@ -61,10 +64,14 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/regularization/util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
@@ -523,14 +530,21 @@ absl::StatusOr<std::unique_ptr<GraphExecutor>> GraphExecutor::Create(
       ->GetCell(options.model_metadata.name(),
                 absl::StrCat(options.model_metadata.version()))
       ->Set(options.enable_mlrt ? "mlrt" : "bef");
+  const uint64_t graph_fingerprint =
+      options.executable_cache_dir.empty() &&
+              options.cost_analysis_options.persisted_cost_dir.empty()
+          ? 0
+          : graph_regularization::ComputeHash(graph_def);
   TF_ASSIGN_OR_RETURN(
       auto graph_execution_state,
       TfrtGraphExecutionState::Create(graph_execution_state_options,
                                       std::move(graph_def), *fallback_state));
-  return std::make_unique<GraphExecutor>(
+  auto graph_executor = std::make_unique<GraphExecutor>(
       std::move(options), std::move(fallback_state),
       std::move(resource_context), std::move(graph_execution_state),
       std::move(kernel_registry));
+  graph_executor->graph_fingerprint_ = graph_fingerprint;
+  return graph_executor;
 }
 
 namespace {
@@ -678,9 +692,110 @@ tensorflow::Status GraphExecutor::Run(
 }
 
 tensorflow::Status GraphExecutor::Extend(const GraphDef& graph) {
-  return graph_execution_state_->Extend(graph);
+  TF_RETURN_IF_ERROR(graph_execution_state_->Extend(graph));
+  if (!options_.executable_cache_dir.empty() ||
+      !options_.cost_analysis_options.persisted_cost_dir.empty()) {
+    graph_fingerprint_ = FingerprintCat64(
+        graph_fingerprint_, graph_regularization::ComputeHash(graph));
+  }
+  return absl::OkStatus();
+}
+
+namespace {
+
+// Returns the file of `options.executable_cache_dir` caching the bytecode of
+// `client_graph`, whose graph has the fingerprint `graph_fingerprint`.
+std::string BytecodeCachePath(const GraphExecutionOptions& options,
+                              uint64_t graph_fingerprint,
+                              const GraphExecutor::ClientGraph& client_graph) {
+  std::string key = absl::StrCat(TF_VERSION_STRING, ";", graph_fingerprint,
+                                 ";", client_graph.name, ";");
+  for (const auto& [name, info] : client_graph.input_nodes) {
+    absl::StrAppend(&key, name, ":", DataTypeString(info.imported_dtype), ",");
+  }
+  std::ostringstream compile_options;
+  compile_options << options.compile_options;
+  absl::StrAppend(&key, ";", absl::StrJoin(client_graph.output_nodes, ","), ";",
+                  absl::StrJoin(client_graph.target_nodes, ","), ";",
+                  compile_options.str());
+  return tensorflow::io::JoinPath(
+      options.executable_cache_dir,
+      absl::StrFormat("%016x.mlrt", tensorflow::Fingerprint64(key)));
+}
+
+// Returns the file of `options.cost_analysis_options.persisted_cost_dir`
+// persisting the op costs of the client graph `client_graph_name`, whose graph
+// has the fingerprint `graph_fingerprint`.
+std::string PersistedCostPath(const GraphExecutionOptions& options,
+                              uint64_t graph_fingerprint,
+                              absl::string_view client_graph_name) {
+  return tensorflow::io::JoinPath(
+      options.cost_analysis_options.persisted_cost_dir,
+      absl::StrFormat("%016x.op_costs.pbtxt",
+                      FingerprintCat64(graph_fingerprint,
+                                       Fingerprint64(client_graph_name))));
+}
+
+// A bytecode cache file holds the fingerprint of the bytecode, followed by the
+// bytecode, so that truncated or corrupt files are detected before loading.
+constexpr size_t kBytecodeCacheHeaderSize = sizeof(uint64_t);
+
+// Returns the bytecode in `path`, or nullopt if it can't be read. A corrupt
+// file is deleted, so that the bytecode is cached again.
+std::optional<mlrt::bc::Buffer> ReadBytecodeCache(const std::string& path) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  std::string contents;
+  absl::Status status = ReadFileToString(env, path, &contents);
+  if (!status.ok()) {
+    VLOG(1) << "Cannot read cached bytecode " << path << ": " << status;
+    return std::nullopt;
+  }
+  uint64_t fingerprint = 0;
+  absl::string_view bytecode;
+  if (contents.size() > kBytecodeCacheHeaderSize) {
+    std::memcpy(&fingerprint, contents.data(), kBytecodeCacheHeaderSize);
+    bytecode = absl::string_view(contents).substr(kBytecodeCacheHeaderSize);
+  }
+  if (bytecode.empty() || fingerprint != tensorflow::Fingerprint64(bytecode)) {
+    LOG(WARNING) << "Deleting corrupt cached bytecode " << path;
+    status = env->DeleteFile(path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to delete " << path << ": " << status;
+    }
+    return std::nullopt;
+  }
+  mlrt::bc::Buffer buffer;
+  mlrt::bc::Allocator allocator(&buffer);
+  auto offset = allocator.Allocate(bytecode.size(), alignof(char));
+  std::memcpy(buffer.data() + offset, bytecode.data(), bytecode.size());
+  return buffer;
+}
+
+// Writes `buffer` to `path` through a temporary file, so that concurrent
+// loads of the same model never read a partial file.
+absl::Status WriteBytecodeCache(const std::string& path,
+                                const mlrt::bc::Buffer& buffer) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(
+      std::string(tensorflow::io::Dirname(path))));
+  std::string tmp_path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return absl::InternalError("Cannot create a temporary file name");
+  }
+  tmp_path = absl::StrCat(path, ".", tensorflow::io::Basename(tmp_path));
+  const absl::string_view bytecode(buffer.data(), buffer.size());
+  const uint64_t fingerprint = tensorflow::Fingerprint64(bytecode);
+  std::string contents(kBytecodeCacheHeaderSize, '\0');
+  std::memcpy(contents.data(), &fingerprint, kBytecodeCacheHeaderSize);
+  contents.append(bytecode.data(), bytecode.size());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, contents));
+  absl::Status status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) env->DeleteFile(tmp_path).IgnoreError();
+  return status;
 }
 
+}  // namespace
+
 absl::StatusOr<std::unique_ptr<GraphExecutor::LoadedClientGraph>>
 GraphExecutor::ImportAndCompileClientGraph(
     const GraphExecutor::ClientGraph& client_graph,
@@ -764,11 +879,63 @@ GraphExecutor::ImportAndCompileClientGraph(
       return tensorflow::errors::Internal("Missing kernel registry in MLRT.");
     }
 
-    ASSIGN_OR_RETURN_IN_COMPILE(
-        auto bytecode_buffer,
-        tensorflow::mlrt_compiler::ConvertTfMlirToBytecode(
-            options_.compile_options, fallback_state(), module.get(),
-            model_context, &module_with_op_keys));
+    // The lowering of other devices and of backend compilers can add functions
+    // to the fallback state, which a cached bytecode would miss.
+    const bool use_bytecode_cache =
+        !options_.executable_cache_dir.empty() &&
+        options_.cost_analysis_options.persisted_cost_dir.empty() &&
+        options_.compile_options.backend_compiler == nullptr &&
+        options_.compile_options.device_target ==
+            TfrtDeviceInfraTarget::kCpu &&
+        options_.cost_analysis_options.version ==
+            Options::CostAnalysisOptions::kDisabled;
+    std::string cache_path;
+    std::optional<mlrt::bc::Buffer> cached_buffer;
+    if (use_bytecode_cache) {
+      cache_path =
+          BytecodeCachePath(options_, graph_fingerprint_, client_graph);
+      cached_buffer = ReadBytecodeCache(cache_path);
+    }
+    mlrt::bc::Buffer bytecode_buffer;
+    if (cached_buffer.has_value()) {
+      LOG(INFO) << "TFRT loaded the bytecode of client graph "
+                << client_graph.name << " from " << cache_path;
+      bytecode_buffer = *std::move(cached_buffer);
+    } else {
+      ASSIGN_OR_RETURN_IN_COMPILE(
+          bytecode_buffer,
+          tensorflow::mlrt_compiler::ConvertTfMlirToBytecode(
+              options_.compile_options, fallback_state(), module.get(),
+              model_context, &module_with_op_keys));
+      if (!options_.cost_analysis_options.persisted_cost_dir.empty()) {
+        const std::string cost_path = PersistedCostPath(
+            options_, graph_fingerprint_, client_graph.name);
+        CostRecorder persisted_costs;
+        absl::Status status = persisted_costs.ReadFromFile(cost_path);
+        if (status.ok()) {
+          LOG(INFO) << "TFRT recompiling client graph " << client_graph.name
+                    << " with the op costs in " << cost_path;
+          auto tf_mlir_with_op_keys = ::mlir::OwningOpRef<mlir::ModuleOp>(
+              module_with_op_keys.get().clone());
+          ASSIGN_OR_RETURN_IN_COMPILE(
+              bytecode_buffer,
+              tensorflow::mlrt_compiler::ConvertTfMlirWithOpKeysToBytecode(
+                  options_.compile_options, fallback_state(),
+                  tf_mlir_with_op_keys.get(), persisted_costs));
+        } else {
+          VLOG(1) << "No persisted op costs for client graph "
+                  << client_graph.name << ": " << status;
+        }
+      }
+      if (use_bytecode_cache) {
+        absl::Status status = WriteBytecodeCache(cache_path, bytecode_buffer);
+        if (!status.ok()) {
+          LOG(WARNING) << "Failed to cache the bytecode of client graph "
+                       << client_graph.name << " in " << cache_path << ": "
+                       << status;
+        }
+      }
+    }
     mlrt::bc::Executable executable(bytecode_buffer.data());
     auto bytecode_executable =
         std::make_unique<mlrt::LoadedExecutable>(executable, *kernel_registry_);
@@ -1079,6 +1246,20 @@ Status GraphExecutor::LoadedClientGraph::UpdateCost(
         executable, *graph_executor_->kernel_registry_);
     new_executable_context = std::make_shared<ExecutableContext>(
         std::move(bytecode_buffer), std::move(bytecode_executable));
+    const auto& persisted_cost_dir =
+        graph_executor_->options().cost_analysis_options.persisted_cost_dir;
+    if (!persisted_cost_dir.empty()) {
+      const std::string cost_path =
+          PersistedCostPath(graph_executor_->options(),
+                            graph_executor_->graph_fingerprint_, name_);
+      absl::Status status =
+          tensorflow::Env::Default()->RecursivelyCreateDir(persisted_cost_dir);
+      if (status.ok()) status = cost_recorder.WriteToFile(cost_path);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to persist the op costs of client graph "
+                     << name_ << " in " << cost_path << ": " << status;
+      }
+    }
   } else {
     // Update costs in TFRT MLIR.
     auto tfrt_mlir = ::mlir::OwningOpRef<mlir::ModuleOp>(
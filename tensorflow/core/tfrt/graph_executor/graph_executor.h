@@ -377,6 +377,9 @@ class GraphExecutor {
 
   std::unique_ptr<tfrt::ResourceContext> resource_context_;
 
+  // The fingerprint of the graph, used to key `options_.executable_cache_dir`.
+  uint64_t graph_fingerprint_ = 0;
+
  protected:
   // For testing basic Cost Analysis functionality.
   absl::Duration simulated_duration_ = absl::ZeroDuration();
@@ -42,7 +42,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
@@ -503,6 +505,138 @@ TEST_F(GraphExecutorTest, Extend) {
               ::testing::ElementsAreArray({2}));
 }
 
+TEST_F(GraphExecutorTest, ExecutableCache) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+  const std::string cache_dir =
+      io::JoinPath(::testing::TempDir(), "graph_executor_executable_cache");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  // The second executor loads the bytecode cached by the first one.
+  for (int i = 0; i < 2; ++i) {
+    GraphExecutor::Options options(runtime.get());
+    options.enable_mlrt = true;
+    options.executable_cache_dir = cache_dir;
+
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto fallback_state,
+        tensorflow::tfrt_stub::FallbackState::Create(
+            CreateDefaultSessionOptions(options), graph_def.library()));
+    auto resource_context = std::make_unique<tfrt::ResourceContext>();
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto graph_executor,
+        GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                              std::move(resource_context), graph_def,
+                              GetKernelRegistry()));
+
+    std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+    inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                   /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+    std::vector<tensorflow::Tensor> outputs;
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                     /*output_tensor_names=*/{"rank"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({2}));
+
+    std::vector<std::string> files;
+    TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &files));
+    EXPECT_EQ(files.size(), 1);
+  }
+}
+
+TEST_F(GraphExecutorTest, ExecutableCacheRecomputesCorruptFile) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+  const std::string cache_dir = io::JoinPath(
+      ::testing::TempDir(), "graph_executor_corrupt_executable_cache");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  const std::string corrupt_contents = "not bytecode";
+  for (int i = 0; i < 2; ++i) {
+    GraphExecutor::Options options(runtime.get());
+    options.enable_mlrt = true;
+    options.executable_cache_dir = cache_dir;
+
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto fallback_state,
+        tensorflow::tfrt_stub::FallbackState::Create(
+            CreateDefaultSessionOptions(options), graph_def.library()));
+    auto resource_context = std::make_unique<tfrt::ResourceContext>();
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto graph_executor,
+        GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                              std::move(resource_context), graph_def,
+                              GetKernelRegistry()));
+
+    std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+    inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                   /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+    std::vector<tensorflow::Tensor> outputs;
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                     /*output_tensor_names=*/{"rank"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({2}));
+
+    std::vector<std::string> files;
+    TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &files));
+    ASSERT_EQ(files.size(), 1);
+    const std::string path = io::JoinPath(cache_dir, files[0]);
+    std::string contents;
+    TF_ASSERT_OK(ReadFileToString(Env::Default(), path, &contents));
+    // The second executor replaces the corrupt file with the bytecode.
+    EXPECT_NE(contents, corrupt_contents);
+    TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, corrupt_contents));
+  }
+}
+
+TEST_F(GraphExecutorTest, PersistedCosts) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+  const std::string cost_dir =
+      io::JoinPath(::testing::TempDir(), "graph_executor_persisted_costs");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  // The first executor records and persists the costs, and the second one
+  // compiles with them.
+  for (auto version : {GraphExecutionOptions::CostAnalysisOptions::kOnce,
+                       GraphExecutionOptions::CostAnalysisOptions::kDisabled}) {
+    GraphExecutor::Options options(runtime.get());
+    options.enable_mlrt = true;
+    options.cost_analysis_options.version = version;
+    options.cost_analysis_options.persisted_cost_dir = cost_dir;
+
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto fallback_state,
+        tensorflow::tfrt_stub::FallbackState::Create(
+            CreateDefaultSessionOptions(options), graph_def.library()));
+    auto resource_context = std::make_unique<tfrt::ResourceContext>();
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto graph_executor,
+        GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                              std::move(resource_context), graph_def,
+                              GetKernelRegistry()));
+
+    std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+    inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                   /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+    std::vector<tensorflow::Tensor> outputs;
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                     /*output_tensor_names=*/{"rank"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({2}));
+
+    std::vector<std::string> files;
+    TF_ASSERT_OK(Env::Default()->GetChildren(cost_dir, &files));
+    EXPECT_EQ(files.size(), 1);
+  }
+}
+
 TEST_F(GraphExecutorTest, DisableCompilation) {
   GraphDef graph_def;
   TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
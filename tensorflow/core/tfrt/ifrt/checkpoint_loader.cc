@@ -20,11 +20,14 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
@@ -92,6 +95,48 @@ struct AsyncState {
   std::vector<xla::ifrt::Promise<tensorflow::Tensor>> results;
 };
 
+// Schedules the restore of a shard on the checkpoint loader queue once it is
+// requested. The restore can be requested before it is set.
+class ShardRestore {
+ public:
+  explicit ShardRestore(tfrt::ConcurrentWorkQueue* work_queue)
+      : work_queue_(work_queue) {}
+
+  void Set(absl::AnyInvocable<void()> restore) {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!requested_) {
+        restore_ = std::move(restore);
+        return;
+      }
+    }
+    Schedule(std::move(restore));
+  }
+
+  // Schedules the restore the first time it is called.
+  void Request() {
+    absl::AnyInvocable<void()> restore;
+    {
+      absl::MutexLock lock(&mutex_);
+      if (requested_) return;
+      requested_ = true;
+      restore = std::move(restore_);
+    }
+    if (restore) Schedule(std::move(restore));
+  }
+
+ private:
+  void Schedule(absl::AnyInvocable<void()> restore) {
+    work_queue_->AddTask(
+        [restore = std::move(restore)]() mutable { restore(); });
+  }
+
+  tfrt::ConcurrentWorkQueue* const work_queue_;
+  absl::Mutex mutex_;
+  bool requested_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::AnyInvocable<void()> restore_ ABSL_GUARDED_BY(mutex_);
+};
+
 // Returns a casted tensor if successful.
 absl::StatusOr<tensorflow::Tensor> Cast(
     tensorflow::Tensor& in_tensor, tensorflow::DataType restored_dtype,
@@ -139,10 +184,13 @@ absl::StatusOr<tensorflow::Tensor> Cast(
   return *(op_kernel_context.mutable_output(0));
 }
 
-absl::Status RunShard(RestoreVariableShard shard,
-                      IfrtRestoreTensorRegistry* ifrt_restore_tensor_registry,
-                      tfrt::ConcurrentWorkQueue* checkpoint_loader_work_queue,
-                      tf_mlrt::Context& context) {
+// Registers the variables of `shard` and returns their restore, which is
+// started right away unless `lazy_restore` is set.
+absl::StatusOr<std::shared_ptr<ShardRestore>> RunShard(
+    RestoreVariableShard shard,
+    IfrtRestoreTensorRegistry* ifrt_restore_tensor_registry,
+    tfrt::ConcurrentWorkQueue* checkpoint_loader_work_queue,
+    tf_mlrt::Context& context, bool lazy_restore) {
   if (!ifrt_restore_tensor_registry) {
     return absl::InternalError("ifrt_restore_tensor_registry must not be null");
   }
@@ -186,12 +234,25 @@ absl::Status RunShard(RestoreVariableShard shard,
   tf_mlrt::SetUpParams(runner, input_tf_tensor_values, params);
   // Use persistent device instead of the per request device.
   params.device = context.fallback_request_state().device_manager().HostCPU();
+  if (lazy_restore) {
+    // A lazy restore can run after the request that loaded the variables
+    // is done, so it must not refer to its state.
+    params.step_container = nullptr;
+    params.function_library = nullptr;
+    params.runner = nullptr;
+    params.collective_executor = nullptr;
+    params.rendezvous = nullptr;
+    params.session_metadata = nullptr;
+    params.cancellation_manager = nullptr;
+  }
 
   auto async_state = std::make_unique<AsyncState>(
       input_tf_tensor_values, params, num_outputs,
       fallback_request_state.device_manager(),
       fallback_request_state.process_function_library_runtime());
 
+  auto shard_restore =
+      std::make_shared<ShardRestore>(checkpoint_loader_work_queue);
   for (int i = 0; i < num_outputs; ++i) {
     auto promise = xla::ifrt::Future<tensorflow::Tensor>::CreatePromise();
     auto future = xla::ifrt::Future<tensorflow::Tensor>(promise);
@@ -207,6 +268,11 @@ absl::Status RunShard(RestoreVariableShard shard,
     ifrt_serving::IfrtRestoreTensorRegistry::RestoredTensorInfo
         restored_tensor_info = {false, std::move(dtype_and_shape),
                                 std::move(future)};
+    if (lazy_restore) {
+      restored_tensor_info.start_restore = [shard_restore]() {
+        shard_restore->Request();
+      };
+    }
     if (auto status = ifrt_restore_tensor_registry->TryRegister(
             runtime_name, restored_tensor_info);
         !status.ok()) {
@@ -221,9 +287,9 @@ absl::Status RunShard(RestoreVariableShard shard,
   }
 
   // Use dedicated work queue for restore operation.
-  checkpoint_loader_work_queue->AddTask([runner = std::move(runner),
-                                         async_state = std::move(async_state),
-                                         shard = std::move(shard)]() {
+  shard_restore->Set([runner = std::move(runner),
+                      async_state = std::move(async_state),
+                      shard = std::move(shard)]() {
     // Keep input tensor alive in `shard`.
     auto* op_kernel_context_ptr = &async_state->context;
     runner.Run(op_kernel_context_ptr);
@@ -273,7 +339,8 @@ absl::Status RunShard(RestoreVariableShard shard,
       }
     }
   });
-  return absl::OkStatus();
+  if (!lazy_restore) shard_restore->Request();
+  return shard_restore;
 }
 
 int64_t GetSizeFromVarHandle(const ResourceHandle& handle) {
@@ -307,8 +374,17 @@ absl::Status CheckpointLoader::Load(
         handle.tensor().scalar<tensorflow::ResourceHandle>()()));
   }
 
-  std::vector<std::vector<int>> sharded_indices = tf_mlrt::ShardVariables(
-      kNumRestoreClusters, absl::MakeSpan(variable_sizes));
+  std::vector<std::vector<int>> sharded_indices;
+  if (options_.lazy_restore) {
+    // Each variable is restored on its own when it is first retrieved.
+    sharded_indices.resize(var_handles.size());
+    for (int i = 0; i < var_handles.size(); ++i) {
+      sharded_indices[i].push_back(i);
+    }
+  } else {
+    sharded_indices = tf_mlrt::ShardVariables(kNumRestoreClusters,
+                                              absl::MakeSpan(variable_sizes));
+  }
 
   // Converts the names and slices back to the tensor.
   auto vector_to_tensor = [](const std::vector<tsl::tstring>& vec) {
@@ -348,9 +424,25 @@ absl::Status CheckpointLoader::Load(
     shard.shape_and_slices = vector_to_tensor(shape_and_slices);
     shards.push_back(std::move(shard));
   }
+  std::vector<std::shared_ptr<ShardRestore>> shard_restores;
+  shard_restores.reserve(shards.size());
   for (const auto& shard : shards) {
-    TF_RETURN_IF_ERROR(RunShard(shard, ifrt_restore_tensor_registry_,
-                                checkpoint_loader_work_queue_, context));
+    TF_ASSIGN_OR_RETURN(
+        std::shared_ptr<ShardRestore> shard_restore,
+        RunShard(shard, ifrt_restore_tensor_registry_,
+                 checkpoint_loader_work_queue_, context,
+                 options_.lazy_restore));
+    shard_restores.push_back(std::move(shard_restore));
+  }
+  if (options_.lazy_restore && options_.prefetch) {
+    // Restores the variables that were not retrieved since, behind the
+    // restores already started.
+    checkpoint_loader_work_queue_->AddTask(
+        [shard_restores = std::move(shard_restores)]() {
+          for (const auto& shard_restore : shard_restores) {
+            shard_restore->Request();
+          }
+        });
   }
   return absl::OkStatus();
 }
@@ -36,13 +36,32 @@ namespace ifrt_serving {
 // Implement the `CheckpointLoaderInterface` by using RestoreV2.
 class CheckpointLoader {
  public:
+  struct Options {
+    // Restores each variable the first time it is retrieved from the
+    // `IfrtRestoreTensorRegistry` instead of when it is loaded, so that a
+    // model is ready before its variables are read.
+    bool lazy_restore = false;
+    // With `lazy_restore`, also restores the variables that were not
+    // retrieved yet in the background once they are loaded.
+    bool prefetch = false;
+  };
+
   explicit CheckpointLoader(
       IfrtRestoreTensorRegistry* ifrt_restore_tensor_registry,
       tfrt::ConcurrentWorkQueue* checkpoint_loader_work_queue)
+      : CheckpointLoader(ifrt_restore_tensor_registry,
+                         checkpoint_loader_work_queue, Options()) {}
+  CheckpointLoader(IfrtRestoreTensorRegistry* ifrt_restore_tensor_registry,
+                   tfrt::ConcurrentWorkQueue* checkpoint_loader_work_queue,
+                   const Options& options)
       : ifrt_restore_tensor_registry_(ifrt_restore_tensor_registry),
-        checkpoint_loader_work_queue_(checkpoint_loader_work_queue) {}
+        checkpoint_loader_work_queue_(checkpoint_loader_work_queue),
+        options_(options) {}
   virtual ~CheckpointLoader() = default;
 
+  // Sets the options of the next `Load`.
+  void set_options(const Options& options) { options_ = options; }
+
   // Called before `Load` to do some preparation work.
   virtual absl::Status PrepareRestore(mlir::OwningOpRef<mlir::ModuleOp> module);
 
@@ -59,6 +78,7 @@ class CheckpointLoader {
 
   IfrtRestoreTensorRegistry* ifrt_restore_tensor_registry_;
   tfrt::ConcurrentWorkQueue* checkpoint_loader_work_queue_;
+  Options options_;
 };
 
 }  // namespace ifrt_serving
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 
+#include <functional>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
@@ -45,14 +46,21 @@ absl::Status IfrtRestoreTensorRegistry::TryRegister(
 
 xla::ifrt::Future<tensorflow::Tensor>
 IfrtRestoreTensorRegistry::GetRestoredTensor(absl::string_view name) const {
-  absl::MutexLock lock(&mutex_);
-  auto it = restored_tensors_.find(name);
-  if (it == restored_tensors_.end()) {
-    return xla::ifrt::Future<tensorflow::Tensor>(
-        absl::NotFoundError(absl::StrCat("Variable '", name, "' not found.")));
+  xla::ifrt::Future<tensorflow::Tensor> tensor_future;
+  std::function<void()> start_restore;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = restored_tensors_.find(name);
+    if (it == restored_tensors_.end()) {
+      return xla::ifrt::Future<tensorflow::Tensor>(absl::NotFoundError(
+          absl::StrCat("Variable '", name, "' not found.")));
+    }
+    tensor_future = it->second.tensor_future;
+    start_restore = it->second.start_restore;
   }
-
-  return it->second.tensor_future;
+  // Started outside of the lock to keep it short.
+  if (start_restore) start_restore();
+  return tensor_future;
 }
 
 absl::Status IfrtRestoreTensorRegistry::SetUsedByHost(absl::string_view name) {
@@ -76,6 +84,7 @@ void IfrtRestoreTensorRegistry::Freeze() {
       // Release the tensor by replacing the future containing the tensor with
       // an future containing a status.
       info.tensor_future = release_tensor_future;
+      info.start_restore = nullptr;
     }
   }
 }
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_RESTORE_TENSOR_REGISTRY_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_RESTORE_TENSOR_REGISTRY_H_
 
+#include <functional>
 #include <string>
 
 #include "absl/base/thread_annotations.h"
@@ -39,6 +40,9 @@ class IfrtRestoreTensorRegistry {
     bool used_by_host = false;
     DtypeAndShape dtype_and_shape;
     xla::ifrt::Future<tensorflow::Tensor> tensor_future;
+    // If set, starts restoring the tensor, which is then read lazily. Called
+    // each time the tensor is retrieved, so it must be idempotent.
+    std::function<void()> start_restore;
   };
   // Tries to register a loaded variable with the given name.
   // Returns an error if the named tensor already exists.
@@ -46,6 +50,8 @@ class IfrtRestoreTensorRegistry {
                            RestoredTensorInfo restored_tensor_info)
       ABSL_LOCKS_EXCLUDED(mutex_);
 
+  // Returns the future of the named tensor, after starting its restore if it
+  // is restored lazily.
   xla::ifrt::Future<tensorflow::Tensor> GetRestoredTensor(
       absl::string_view name) const ABSL_LOCKS_EXCLUDED(mutex_);
 
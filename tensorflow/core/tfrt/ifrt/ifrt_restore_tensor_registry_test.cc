@@ -185,6 +185,37 @@ TEST(IfrtRestoreTensorRegistryTest, FeezeTensorRegistry) {
                           registry.GetRestoredTensor("input_tensor_2").Await());
   test::ExpectEqual(retrieved, input_tensor);
 }
+
+TEST(IfrtRestoreTensorRegistryTest, RetrievingTensorStartsLazyRestore) {
+  auto input_tensor =
+      test::AsTensor<int32_t>({1, 2, 3, 4}, tensorflow::TensorShape({2, 2}));
+  auto promise = xla::ifrt::Future<tensorflow::Tensor>::CreatePromise();
+  auto future = xla::ifrt::Future<tensorflow::Tensor>(promise);
+
+  int num_starts = 0;
+  IfrtRestoreTensorRegistry::RestoredTensorInfo restored_tensor_info = {
+      .used_by_host = false,
+      .dtype_and_shape =
+          {
+              .dtype = DT_INT32,
+              .shape = tensorflow::TensorShape({2, 2}),
+          },
+      .tensor_future = future,
+      .start_restore =
+          [&]() {
+            if (num_starts++ == 0) promise.Set(input_tensor);
+          }};
+  IfrtRestoreTensorRegistry registry;
+  TF_ASSERT_OK(registry.TryRegister("input_tensor_1", restored_tensor_info));
+  // Looking up the dtype and shape does not start the restore.
+  TF_ASSERT_OK(registry.GetDtypeAndShape("input_tensor_1").status());
+  EXPECT_EQ(num_starts, 0);
+
+  TF_ASSERT_OK_AND_ASSIGN(tensorflow::Tensor retrieved,
+                          registry.GetRestoredTensor("input_tensor_1").Await());
+  test::ExpectEqual(retrieved, input_tensor);
+  EXPECT_EQ(num_starts, 1);
+}
 }  // namespace
 }  // namespace ifrt_serving
 }  // namespace tensorflow
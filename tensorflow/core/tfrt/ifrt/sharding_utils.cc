@@ -153,39 +153,51 @@ SplitAndCreateArraysFromHostBuffer(
                      split_tensors.size(), " x ", num_replicas));
   }
 
+  TF_ASSIGN_OR_RETURN(xla::ifrt::DType dtype, ToIfrtDType(tensor_data_type));
+  // Host-to-device transfers of large slices can block their caller, so the
+  // arrays of the devices are created in parallel. Small slices are cheap
+  // enough for parallelFor to create them inline.
+  std::vector<absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>> results(
+      devices.size());
+  auto make_array = [&](int64_t device_index) {
+    const int slice_idx = device_index / num_replicas;
+    const tensorflow::Tensor& tensor = split_tensors[slice_idx];
+    VLOG(2) << "Make array for buffer slice " << slice_idx << " at "
+            << tensor.data();
+    auto single_device_sharding = xla::ifrt::SingleDeviceSharding::Create(
+        devices[device_index], xla::ifrt::MemoryKind());
+    results[device_index] = ifrt_client.MakeArrayFromHostBuffer(
+        tensor.data(), dtype, xla::ifrt::Shape(tensor.shape().dim_sizes()),
+        GetByteStrides(tensor_data_type, tensor.shape()),
+        std::move(single_device_sharding),
+        xla::ifrt::Client::HostBufferSemantics::
+            kImmutableUntilTransferCompletes,
+        [tensor, slice_idx]() {
+          // Keep tensor alive
+          VLOG(2) << "Done with host buffer for slice " << slice_idx << " at "
+                  << tensor.data();
+        });
+  };
+  const double slice_bytes = split_tensors.empty()
+                                 ? 0
+                                 : split_tensors.front().TotalBytes();
+  thread_pool_device.parallelFor(
+      devices.size(),
+      Eigen::TensorOpCost(/*bytes_loaded=*/slice_bytes,
+                          /*bytes_stored=*/slice_bytes,
+                          /*compute_cycles=*/0),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t device_index = begin; device_index < end;
+             ++device_index) {
+          make_array(device_index);
+        }
+      });
+
   std::vector<tsl::RCReference<xla::ifrt::Array>> arrays;
   arrays.reserve(devices.size());
-  TF_ASSIGN_OR_RETURN(xla::ifrt::DType dtype, ToIfrtDType(tensor_data_type));
-  auto device_iter = devices.begin();
-  for (int slice_idx = 0; slice_idx < split_tensors.size(); ++slice_idx) {
-    auto& tensor = split_tensors[slice_idx];
-
-    for (int i = 0; i < num_replicas; ++i) {
-      VLOG(2) << "Make array for buffer slice " << slice_idx << " at "
-              << tensor.data();
-      if (device_iter == devices.end()) {
-        return absl::InternalError(
-            absl::StrCat("Missing Device ", i, " for slice ", slice_idx));
-      }
-      auto single_device_sharding = xla::ifrt::SingleDeviceSharding::Create(
-          *device_iter, xla::ifrt::MemoryKind());
-
-      TF_ASSIGN_OR_RETURN(auto array,
-                          ifrt_client.MakeArrayFromHostBuffer(
-                              tensor.data(), dtype,
-                              xla::ifrt::Shape(tensor.shape().dim_sizes()),
-                              GetByteStrides(tensor_data_type, tensor.shape()),
-                              std::move(single_device_sharding),
-                              xla::ifrt::Client::HostBufferSemantics::
-                                  kImmutableUntilTransferCompletes,
-                              [tensor, slice_idx]() {
-                                // Keep tensor alive
-                                VLOG(2) << "Done with host buffer for slice "
-                                        << slice_idx << " at " << tensor.data();
-                              }));
-      arrays.push_back(std::move(array));
-      device_iter++;
-    }
+  for (auto& result : results) {
+    TF_RETURN_IF_ERROR(result.status());
+    arrays.push_back(*std::move(result));
   }
   return arrays;
 }
@@ -48,8 +48,15 @@ LoadedExecutable::LoadedExecutable(bc::Executable executable,
   }
 
   functions_.reserve(executable_.functions().size());
+  function_kernels_.reserve(executable_.functions().size());
   for (auto function : executable_.functions()) {
     functions_[function.name().Get()] = function;
+
+    auto& function_kernels = function_kernels_[function.kernels().data()];
+    function_kernels.reserve(function.kernels().size());
+    for (auto kernel : function.kernels()) {
+      function_kernels.push_back(kernels_[kernel.code()]);
+    }
   }
 }
 
@@ -83,6 +83,18 @@ class LoadedExecutable {
 
   absl::Span<const KernelImplementation> kernels() const { return kernels_; }
 
+  // Returns the implementations of the kernels of `function` in program
+  // order, so that the interpreter dispatches a kernel without decoding its
+  // code first. Returns nullptr if `function` is not in this executable.
+  const KernelImplementation* GetFunctionKernels(bc::Function function) const {
+    if (auto iter = function_kernels_.find(function.kernels().data());
+        iter != function_kernels_.end()) {
+      return iter->second.data();
+    }
+
+    return nullptr;
+  }
+
   bc::Function GetFunction(absl::string_view name) const {
     if (auto iter = functions_.find(name); iter != functions_.end()) {
       return iter->second;
@@ -98,6 +110,9 @@ class LoadedExecutable {
 
   absl::flat_hash_map<std::string, bc::Function> functions_;
   std::vector<KernelImplementation> kernels_;
+  // Keyed by the address of the kernels of each function.
+  absl::flat_hash_map<const char*, std::vector<KernelImplementation>>
+      function_kernels_;
 };
 
 // A helper structure that holds states for a kernel. Typical usuage is that a
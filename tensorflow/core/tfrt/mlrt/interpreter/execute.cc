@@ -92,7 +92,11 @@ void Execute(ExecutionContext& ctx) {
     FunctionContext* current_function = &context.function_stack_.back();
     int64_t pc = current_function->pc_;
 
-    auto kernels = context.loaded_executable().kernels();
+    const KernelImplementation* kernels =
+        context.loaded_executable().GetFunctionKernels(
+            current_function->function_object());
+    DCHECK(kernels);
+    kernels += pc;
 
     auto kernel_object_iter =
         current_function->function_object().kernels().begin();
@@ -109,8 +113,9 @@ void Execute(ExecutionContext& ctx) {
              current_function->function_object().kernels().end());
       bc::Kernel kernel_object = *kernel_object_iter;
       frame.set_kernel(kernel_object);
-      kernels[kernel_object.code()](frame);
+      (*kernels)(frame);
       ++kernel_object_iter;
+      ++kernels;
     }
 
     // Update the program counter if we need to break the sequential execution
@@ -3153,6 +3153,43 @@ void BM_SequentialAdd(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_SequentialAdd);
 
+// Measures the dispatch overhead per kernel for chains of tiny kernels.
+void BM_SequentialAddChain(::testing::benchmark::State& state) {
+  const int num_adds = state.range(0);
+  auto buffer = CreateSequentialAddExecutable(num_adds);
+
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+  kernel_registry.Register<AddI32Kernel>();
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  int32_t v = 1;
+  Value arg(v);
+  Value result;
+
+  auto function = loaded_executable.GetFunction("main");
+  ASSERT_TRUE(function);
+
+  std::vector<uint8_t> last_uses = {false};
+  for (auto s : state) {
+    absl::Notification notification;
+
+    ExecutionContext execution_context(&loaded_executable);
+    execution_context.set_exit_handler([&]() { notification.Notify(); });
+
+    execution_context.Call(function, last_uses, absl::Span<Value>(&arg, 1),
+                           absl::Span<Value>(&result, 1));
+    Execute(execution_context);
+    notification.WaitForNotification();
+  }
+  CHECK_EQ(result.Get<int32_t>(), num_adds + 1);
+  state.SetItemsProcessed(state.iterations() * num_adds);
+}
+BENCHMARK(BM_SequentialAddChain)->Range(8, 4096);
+
 void BM_SequentialAddAttributes(::testing::benchmark::State& state) {
   auto buffer = CreateSequentialAddAttributesExecutable(99);
 
@@ -24,11 +24,13 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/synchronization/notification.h"
 #include "absl/types/span.h"
+#include "tensorflow/compiler/mlir/tfrt/transforms/ifrt/ifrt_types.h"
 #include "xla/python/ifrt/client.h"
 #include "xla/python/ifrt/future.h"
 #include "xla/python/ifrt/test_util.h"
@@ -61,6 +63,8 @@ limitations under the License.
 #include "tensorflow/core/tfrt/mlrt/kernel/kernel.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/refcount.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/status_matchers.h"
@@ -748,6 +752,142 @@ TEST_F(KernelTest, IfrtRestoreVariableOp4Variables) {
               TensorEq(AsTensor<int16_t>({10, 11, 12}, {3})));
 }
 
+// Restores the variables of a copy of the test checkpoint with the
+// `tf_mlrt.ifrt_restore_variable` kernel, so that the copy can be deleted to
+// tell which variables were already read.
+class LazyRestoreTest : public KernelTest {
+ protected:
+  static constexpr int kNumVariables = 4;
+
+  void SetUp() override {
+    KernelTest::SetUp();
+    checkpoint_dir_ = tsl::io::JoinPath(
+        ::testing::TempDir(),
+        ::testing::UnitTest::GetInstance()->current_test_info()->name());
+  }
+
+  // Restores the variables with `options`, then waits for the restores
+  // started meanwhile.
+  void Restore(const ifrt_serving::CheckpointLoader::Options& options) {
+    TF_ASSERT_OK_AND_ASSIGN(std::string checkpoint_prefix, CopyCheckpoint());
+    ifrt_serving::IfrtModelRestoreContext* restore_context =
+        *resource_context_
+             .GetResource<ifrt_serving::IfrtModelRestoreContext>(
+                 ifrt_serving::kIfrtModelRestoreContextName);
+    restore_context->checkpoint_loader()->set_options(options);
+
+    auto buffer = CreateExecutableForIfrtRestoreVariableOp(kNumVariables);
+    mlrt::bc::Executable executable(buffer.data());
+    mlrt::LoadedExecutable loaded_executable(executable, registry_);
+    mlrt::ExecutionContext execution_context(&loaded_executable);
+    execution_context.set_work_queue(execution_work_queue_.get());
+    execution_context.AddUserContext(std::move(tf_context_));
+
+    std::vector<mlrt::Value> args;
+    args.resize(3);
+    args.at(0).Set(tfrt_stub::FallbackTensor(
+        AsTensor<tsl::tstring>({tsl::tstring(checkpoint_prefix)})));
+    tensorflow::Tensor name_tensor =
+        AsTensor<tsl::tstring>({tsl::tstring("w/.ATTRIBUTES/VARIABLE_VALUE"),
+                                tsl::tstring("w1/.ATTRIBUTES/VARIABLE_VALUE"),
+                                tsl::tstring("w2/.ATTRIBUTES/VARIABLE_VALUE"),
+                                tsl::tstring("w3/.ATTRIBUTES/VARIABLE_VALUE")});
+    args.at(1).Set(tfrt_stub::FallbackTensor(std::move(name_tensor)));
+    args.at(2).Set(tfrt_stub::FallbackTensor(
+        AsTensor<tsl::tstring>({tsl::tstring(""), tsl::tstring(""),
+                                tsl::tstring(""), tsl::tstring("")})));
+    std::vector<uint8_t> last_uses = {true, true, true};
+    std::vector<mlrt::Value> results;
+
+    absl::Notification notification;
+    execution_context.set_exit_handler(
+        [&notification]() { notification.Notify(); });
+    execution_context.Call(executable.functions()[0], last_uses,
+                           absl::MakeSpan(args), absl::MakeSpan(results));
+    mlrt::Execute(execution_context);
+    notification.WaitForNotification();
+    TF_ASSERT_OK(execution_context.status());
+    restore_work_queue_->Quiesce();
+  }
+
+  // Deletes the checkpoint, so that restoring any variable not read yet
+  // fails.
+  void DeleteCheckpoint() {
+    int64_t undeleted_files = 0;
+    int64_t undeleted_dirs = 0;
+    TF_ASSERT_OK(tsl::Env::Default()->DeleteRecursively(
+        checkpoint_dir_, &undeleted_files, &undeleted_dirs));
+  }
+
+  absl::StatusOr<tensorflow::Tensor> GetRestoredTensor(int index) {
+    return ifrt_model_context_->GetRestoreTensorRegistry()
+        .GetRestoredTensor(absl::StrCat(kVariableRuntimeName, index))
+        .Await();
+  }
+
+ private:
+  // Copies the test checkpoint to `checkpoint_dir_` and returns its prefix.
+  absl::StatusOr<std::string> CopyCheckpoint() {
+    const std::string prefix =
+        tensorflow::GetDataDependencyFilepath(
+            "tensorflow/core/tfrt/mlrt/kernel/testdata/"
+            "gen_checkpoint_data/variables") +
+        "/variables";
+    tsl::Env* env = tsl::Env::Default();
+    TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(checkpoint_dir_));
+    std::vector<std::string> files;
+    TF_RETURN_IF_ERROR(
+        env->GetMatchingPaths(absl::StrCat(prefix, "*"), &files));
+    for (const std::string& file : files) {
+      TF_RETURN_IF_ERROR(env->CopyFile(
+          file, tsl::io::JoinPath(checkpoint_dir_, tsl::io::Basename(file))));
+    }
+    return tsl::io::JoinPath(checkpoint_dir_, tsl::io::Basename(prefix));
+  }
+
+  std::string checkpoint_dir_;
+};
+
+TEST_F(LazyRestoreTest, RestoresVariablesWhenRetrieved) {
+  ifrt_serving::CheckpointLoader::Options options;
+  options.lazy_restore = true;
+  Restore(options);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      ifrt_serving::DtypeAndShape dtype_and_shape,
+      ifrt_model_context_->GetRestoreTensorRegistry().GetDtypeAndShape(
+          absl::StrCat(kVariableRuntimeName, 0)));
+  EXPECT_EQ(dtype_and_shape.dtype, DT_INT16);
+  absl::StatusOr<tensorflow::Tensor> restored_tensor = GetRestoredTensor(2);
+  TF_ASSERT_OK(restored_tensor.status());
+  EXPECT_THAT(*restored_tensor, TensorEq(AsTensor<int16_t>({7, 8, 9}, {3})));
+
+  DeleteCheckpoint();
+  EXPECT_FALSE(GetRestoredTensor(0).ok());
+  restored_tensor = GetRestoredTensor(2);
+  TF_ASSERT_OK(restored_tensor.status());
+  EXPECT_THAT(*restored_tensor, TensorEq(AsTensor<int16_t>({7, 8, 9}, {3})));
+}
+
+TEST_F(LazyRestoreTest, PrefetchesVariables) {
+  ifrt_serving::CheckpointLoader::Options options;
+  options.lazy_restore = true;
+  options.prefetch = true;
+  Restore(options);
+
+  DeleteCheckpoint();
+  for (int i = 0; i < kNumVariables; ++i) {
+    absl::StatusOr<tensorflow::Tensor> restored_tensor = GetRestoredTensor(i);
+    TF_ASSERT_OK(restored_tensor.status());
+    EXPECT_THAT(*restored_tensor,
+                TensorEq(AsTensor<int16_t>(
+                    {static_cast<int16_t>(3 * i + 1),
+                     static_cast<int16_t>(3 * i + 2),
+                     static_cast<int16_t>(3 * i + 3)},
+                    {3})));
+  }
+}
+
 }  // namespace
 }  // namespace tf_mlrt
 }  // namespace tensorflow
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/tfrt/common/metrics.h"
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler.h"
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler_util.h"
 #include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
@@ -82,6 +83,7 @@ RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(TaskFunction f) {
           std::move(f),
           tensorflow::Context(tensorflow::ContextKind::kThread),
           id,
+          env_->NowMicros(),
       }),
   };
 }
@@ -373,6 +375,14 @@ RunHandlerThreadPool::RunHandlerThreadPool(
         std::make_unique<Eigen::MaxSizeVector<ThreadWorkSource*>>(
             options.max_concurrent_handler);
   }
+  for (int i = 0; i < num_threads_in_sub_thread_pool_.size(); ++i) {
+    inter_queueing_delay_.push_back(
+        tensorflow::tfrt_metrics::GetTfrtRunHandlerQueueingDelaySampler(
+            name_, i, "inter"));
+    intra_queueing_delay_.push_back(
+        tensorflow::tfrt_metrics::GetTfrtRunHandlerQueueingDelaySampler(
+            name_, i, "intra"));
+  }
   VLOG(1) << "Creating RunHandlerThreadPool " << name << " with  "
           << num_blocking_threads_ << " blocking threads and "
           << num_non_blocking_threads_ << " non-blocking threads.";
@@ -515,6 +525,41 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+Task RunHandlerThreadPool::StealTaskFromBusiestRequest(
+    int thread_id, int max_blocking_inflight,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    bool* task_from_blocking_queue, ThreadWorkSource** tws) {
+  *task_from_blocking_queue = false;
+  ThreadWorkSource* busiest = nullptr;
+  bool busiest_may_steal_blocking_work = false;
+  int busiest_queue_size = 0;
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    ThreadWorkSource* source = thread_work_sources[i];
+    const bool may_steal_blocking_work =
+        source->GetInflightTaskCount(true) < max_blocking_inflight;
+    int queue_size = source->TaskQueueSize(false);
+    if (may_steal_blocking_work) queue_size += source->TaskQueueSize(true);
+    // Ties go to the request with the higher priority.
+    if (queue_size > busiest_queue_size) {
+      busiest = source;
+      busiest_may_steal_blocking_work = may_steal_blocking_work;
+      busiest_queue_size = queue_size;
+    }
+  }
+  Task t;
+  if (busiest == nullptr) return t;
+  *tws = busiest;
+  if (busiest_may_steal_blocking_work) {
+    t = busiest->PopBlockingTask();
+    if (t.f) {
+      *task_from_blocking_queue = true;
+      return t;
+    }
+  }
+  return busiest->PopNonBlockingTask(thread_id,
+                                     /*search_from_all_queue=*/true);
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -563,8 +608,14 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                    /*may_steal_blocking_work=*/true, *thread_work_sources,
                    &task_from_blocking_queue, &tws);
       if (!t.f) {
-        // Search from all requests if the thread cannot find tasks from
-        // requests that belong to its own sub thread pool.
+        // Steal from the most backed up request if the thread cannot find
+        // tasks from requests that belong to its own sub thread pool.
+        t = StealTaskFromBusiestRequest(thread_id, kMaxBlockingInflight,
+                                        *thread_work_sources,
+                                        &task_from_blocking_queue, &tws);
+      }
+      if (!t.f) {
+        // Search from all requests, as the queue sizes are approximate.
         t = FindTask(0, active_requests, thread_id, sub_thread_pool_id,
                      kMaxBlockingInflight,
                      /*may_steal_blocking_work=*/true, *thread_work_sources,
@@ -581,6 +632,11 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
     if (t.f) {
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
+      const uint64_t now_us = env_.env_->NowMicros();
+      const uint64_t enqueue_time_us = t.f->enqueue_time_us;
+      (task_from_blocking_queue ? inter_queueing_delay_
+                                : intra_queueing_delay_)[sub_thread_pool_id]
+          ->Add(now_us > enqueue_time_us ? now_us - enqueue_time_us : 0);
       tws->IncrementInflightTaskCount(task_from_blocking_queue);
       env_.ExecuteTask(t);
       tws->DecrementInflightTaskCount(task_from_blocking_queue);
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
+#include "tsl/lib/monitoring/sampler.h"
 #include "tfrt/host_context/task_function.h"  // from @tf_runtime
 namespace Eigen {
 struct ThreadPoolDevice;
@@ -182,6 +183,7 @@ class RunHandlerEnvironment {
     TaskFunction f;
     tensorflow::Context context;
     uint64_t trace_id;
+    uint64_t enqueue_time_us;
   };
   tensorflow::Env* const env_;
   const tensorflow::ThreadOptions thread_options_;
@@ -369,6 +371,16 @@ class RunHandlerThreadPool {
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
       bool* task_from_blocking_queue, ThreadWorkSource** tws);
 
+  // Steals a task from the request with the most queued tasks, skipping the
+  // blocking tasks of requests with `max_blocking_inflight` blocking tasks
+  // running. Used by blocking threads that found no task in their own sub
+  // thread pool, so that a request whose tasks pile up gets the idle
+  // threads of all sub thread pools rather than a round robin share.
+  Task StealTaskFromBusiestRequest(
+      int thread_id, int max_blocking_inflight,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      bool* task_from_blocking_queue, ThreadWorkSource** tws);
+
   void WaitForWorkInSubThreadPool(int thread_id, bool is_blocking,
                                   int sub_thread_pool_id);
 
@@ -412,6 +424,11 @@ class RunHandlerThreadPool {
   // the end_request_percentage of previous sub thread pool to its own
   // end_request_percentage in a round robin fashion.
   std::vector<double> sub_thread_pool_end_request_percentage_;
+
+  // The queueing delay samplers of each sub thread pool, for the blocking
+  // (inter) and non-blocking (intra) tasks.
+  std::vector<tsl::monitoring::SamplerCell*> inter_queueing_delay_;
+  std::vector<tsl::monitoring::SamplerCell*> intra_queueing_delay_;
 };
 
 }  // namespace internal
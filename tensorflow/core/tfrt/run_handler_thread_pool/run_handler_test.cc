@@ -484,6 +484,62 @@ TEST_P(RunHandlerThreadPoolTest, FindTask) {
   }
 }
 
+TEST_P(RunHandlerThreadPoolTest, StealTaskFromBusiestRequest) {
+  Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(2);
+  waiters_mu.resize(2);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(2);
+  waiters.resize(2);
+  internal::RunHandlerThreadPool run_handler_thread_pool(
+      internal::RunHandlerThreadPool::Options(
+          /*num_blocking_threads=*/1, /*num_non_blocking_threads=*/0,
+          /*wait_if_no_active_request=*/true,
+          /*non_blocking_threads_sleep_time_micro_sec=*/250,
+          /*blocking_threads_max_sleep_time_micro_sec=*/250,
+          /*use_adaptive_waiting_time=*/true, /*enable_wake_up=*/true,
+          /*max_concurrent_handler=*/128,
+          /*num_threads_in_sub_thread_pool=*/{1},
+          /*sub_thread_request_percentage=*/{1}),
+      tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+      "tf_run_handler_pool", &waiters_mu, &waiters);
+
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(3);
+  thread_work_sources.resize(3);
+  internal::ThreadWorkSource tws[3];
+  for (int i = 0; i < 3; ++i) {
+    tws[i].SetWaiter(1, &waiters[0], &waiters_mu[0]);
+    thread_work_sources[i] = &tws[i];
+  }
+
+  int result = -1;
+  const auto steal = [&](bool* task_from_blocking_queue) {
+    internal::ThreadWorkSource* source = nullptr;
+    internal::Task t = run_handler_thread_pool.StealTaskFromBusiestRequest(
+        /*thread_id=*/0, /*max_blocking_inflight=*/10, thread_work_sources,
+        task_from_blocking_queue, &source);
+    if (t.f) t.f->f();
+    return t.f != nullptr;
+  };
+
+  run_handler_thread_pool.AddWorkToQueue(
+      &tws[0], /*is_blocking=*/true, TaskFunction([&result] { result = 0; }));
+  for (int i = 0; i < 2; ++i) {
+    run_handler_thread_pool.AddWorkToQueue(
+        &tws[2], /*is_blocking=*/true, TaskFunction([&result] { result = 2; }));
+  }
+  run_handler_thread_pool.AddWorkToQueue(
+      &tws[2], /*is_blocking=*/false, TaskFunction([&result] { result = 2; }));
+
+  // The request with the most queued tasks goes first, whatever its
+  // priority, until it is no busier than the others.
+  bool task_from_blocking_queue;
+  for (int expected : {2, 2, 0, 2}) {
+    ASSERT_TRUE(steal(&task_from_blocking_queue));
+    EXPECT_EQ(result, expected);
+  }
+  EXPECT_FALSE(task_from_blocking_queue);
+  EXPECT_FALSE(steal(&task_from_blocking_queue));
+}
+
 TEST_P(RunHandlerThreadPoolTest, RoundRobinExecution) {
   Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(1);
   waiters_mu.resize(1);
@@ -626,10 +682,11 @@ TEST_P(RunHandlerThreadPoolTest, MultipleSubThreadPool) {
     }
   }
 
-  // Pick task from any task if there is no tasks from the requests in the sub
-  // thread pool.
-  for (int i = 0; i < 2; ++i) {
-    for (int round = 0; round < 2; ++round) {
+  // Steal from the request with the most queued tasks if there is no tasks
+  // from the requests in the sub thread pool, preferring the higher priority
+  // request on ties.
+  for (int round = 0; round < 2; ++round) {
+    for (int i = 0; i < 2; ++i) {
       ok_to_execute = true;
       function_start.notify_one();
       while (!ok_to_validate) {
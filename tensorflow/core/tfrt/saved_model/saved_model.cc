@@ -154,6 +154,12 @@ absl::Status PrepareRestore(mlir::MLIRContext* context,
   if (!checkpoint_loader) {
     return absl::InternalError("Missing checkpoint loader.");
   }
+  if (options.ifrt_lazy_restore) {
+    ifrt_serving::CheckpointLoader::Options checkpoint_loader_options;
+    checkpoint_loader_options.lazy_restore = true;
+    checkpoint_loader_options.prefetch = options.ifrt_prefetch_restore;
+    checkpoint_loader->set_options(checkpoint_loader_options);
+  }
 
   TF_RETURN_IF_ERROR(checkpoint_loader->PrepareRestore(
       std::move(mlir_module_restore_analysis)));
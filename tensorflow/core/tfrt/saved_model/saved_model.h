@@ -110,6 +110,15 @@ class SavedModel {
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
+    // If true and `graph_execution_options.use_ifrt` is set, each variable is
+    // restored the first time it is used instead of when the model is loaded.
+    // See `ifrt_serving::CheckpointLoader::Options`.
+    bool ifrt_lazy_restore = false;
+
+    // If true with `ifrt_lazy_restore`, the variables that are not used yet
+    // are also restored in the background once the model is loaded.
+    bool ifrt_prefetch_restore = false;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -53,7 +53,9 @@ tsl::thread::ThreadPool& GetThreadPool() {
   return *thread_pool;
 }
 
-TEST(SavedModelIfrt, Basic) {
+// Runs the toy model with IFRT, restoring its variables with the given
+// `SavedModel::Options`.
+void ExpectToyModelRuns(bool ifrt_lazy_restore, bool ifrt_prefetch_restore) {
   std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
       "tensorflow/core/tfrt/saved_model/tests/toy_v2");
 
@@ -101,6 +103,11 @@ TEST(SavedModelIfrt, Basic) {
   options.lazy_loading_use_graph_executor = true;
   options.graph_execution_options.compile_options.backend_compiler =
       &ifrt_compiler;
+  if (ifrt_lazy_restore) {
+    options.graph_execution_options.use_ifrt = true;
+    options.ifrt_lazy_restore = true;
+    options.ifrt_prefetch_restore = ifrt_prefetch_restore;
+  }
 
   TF_ASSERT_OK_AND_ASSIGN(
       auto saved_model, SavedModelImpl::LoadSavedModel(options, saved_model_dir,
@@ -122,6 +129,21 @@ TEST(SavedModelIfrt, Basic) {
               ::testing::ElementsAreArray({6}));
 }
 
+TEST(SavedModelIfrt, Basic) {
+  ExpectToyModelRuns(/*ifrt_lazy_restore=*/false,
+                     /*ifrt_prefetch_restore=*/false);
+}
+
+TEST(SavedModelIfrt, LazyRestore) {
+  ExpectToyModelRuns(/*ifrt_lazy_restore=*/true,
+                     /*ifrt_prefetch_restore=*/false);
+}
+
+TEST(SavedModelIfrt, LazyRestoreWithPrefetch) {
+  ExpectToyModelRuns(/*ifrt_lazy_restore=*/true,
+                     /*ifrt_prefetch_restore=*/true);
+}
+
 }  // namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
@@ -16,22 +16,33 @@ limitations under the License.
 // For Google-internal use only.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
+#include <cstdlib>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/base/call_once.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "xla/status_macros.h"
 #include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "xla/stream_executor/platform_manager.h"
 #include "xla/tsl/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/protobuf/dnn.pb.h"
 
 namespace tensorflow {
@@ -170,10 +181,56 @@ Status PopulateConvMap(
   return OkStatus();
 }
 
+// Appends the entries of `from` whose keys are not in `to` to `to`.
+Status MergeConvMap(const ConvMapProto &from, ConvMapProto *to) {
+  absl::flat_hash_set<std::string> keys;
+  std::string serialized_key;
+  for (const ConvMapProto::Entry &kv : to->kv_pairs()) {
+    TF_RET_CHECK(tsl::SerializeToStringDeterministic(kv.key(), &serialized_key));
+    keys.insert(serialized_key);
+  }
+  for (const ConvMapProto::Entry &kv : from.kv_pairs()) {
+    TF_RET_CHECK(tsl::SerializeToStringDeterministic(kv.key(), &serialized_key));
+    if (keys.insert(serialized_key).second) {
+      *to->add_kv_pairs() = kv;
+    }
+  }
+  return OkStatus();
+}
+
+// Returns the path of the cache file in `dir` for the GPUs of this process.
+StatusOr<std::string> AutotuneCacheFile(absl::string_view dir) {
+  TF_ASSIGN_OR_RETURN(
+      se::Platform * platform,
+      se::PlatformManager::PlatformWithName(se::GpuPlatformName()));
+  std::string key;
+  for (int i = 0; i < platform->VisibleDeviceCount(); i++) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<se::DeviceDescription> device_desc,
+                        platform->DescriptionForDevice(i));
+    absl::StrAppend(&key, device_desc->model_str(), ";",
+                    device_desc->driver_version(), ";");
+  }
+  if (platform->VisibleDeviceCount() > 0) {
+    TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
+                        platform->ExecutorForDevice(0));
+    if (auto *dnn = executor->AsDnn()) {
+      TF_ASSIGN_OR_RETURN(se::dnn::VersionInfo version, dnn->GetVersion());
+      absl::StrAppend(&key, "dnn:", version.major_version(), ".",
+                      version.minor_version(), ".", version.patch());
+    }
+  }
+  return io::JoinPath(
+      dir, absl::StrCat("autotune_maps_",
+                        absl::Hex(Fingerprint64(key), absl::kZeroPad16),
+                        ".pb"));
+}
+
 }  // namespace
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
-Status SerializeAutotuneMaps(std::string *output) {
+namespace {
+
+StatusOr<AutotuneMapsProto> AutotuneMapsToProto() {
   AutotuneMapsProto proto;
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_ASSIGN_OR_RETURN(*proto.mutable_conv_map(),
@@ -181,6 +238,22 @@ Status SerializeAutotuneMaps(std::string *output) {
   TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
                       ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return proto;
+}
+
+const std::string &AutotuneCacheDir() {
+  static const std::string *dir = [] {
+    auto *dir = new std::string;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_AUTOTUNE_CACHE_DIR", "", dir));
+    return dir;
+  }();
+  return *dir;
+}
+
+}  // namespace
+
+Status SerializeAutotuneMaps(std::string *output) {
+  TF_ASSIGN_OR_RETURN(AutotuneMapsProto proto, AutotuneMapsToProto());
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return absl::OkStatus();
 }
@@ -204,6 +277,177 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
   return absl::OkStatus();
 }
 
+Status LoadAutotuneMapsFromCache(absl::string_view dir) {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  TF_ASSIGN_OR_RETURN(std::string file, AutotuneCacheFile(dir));
+  Env *env = Env::Default();
+  if (!env->FileExists(file).ok()) {
+    return absl::OkStatus();
+  }
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, file, &serialized));
+  TF_RETURN_IF_ERROR(LoadSerializedAutotuneMaps(serialized));
+  VLOG(1) << "Loaded the autotune maps from " << file;
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return absl::OkStatus();
+}
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+namespace {
+
+// Saves the autotune maps to `file` in `dir`, together with the entries that
+// other processes have saved there.
+Status SaveAutotuneMapsToFile(absl::string_view dir, const std::string &file) {
+  TF_ASSIGN_OR_RETURN(AutotuneMapsProto proto, AutotuneMapsToProto());
+  Env *env = Env::Default();
+  std::string serialized;
+  if (env->FileExists(file).ok()) {
+    // Keeps the results of the other processes. Ours win where both have one.
+    AutotuneMapsProto saved;
+    if (ReadFileToString(env, file, &serialized).ok() &&
+        saved.ParseFromString(serialized)) {
+      TF_RETURN_IF_ERROR(
+          MergeConvMap(saved.conv_map(), proto.mutable_conv_map()));
+      TF_RETURN_IF_ERROR(
+          MergeConvMap(saved.fused_conv_map(), proto.mutable_fused_conv_map()));
+    }
+  }
+  TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, &serialized));
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(string(dir)));
+  const std::string temp_file =
+      absl::StrCat(file, ".tmp.", absl::Hex(random::New64()));
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, temp_file, serialized));
+  Status status = env->RenameFile(temp_file, file);
+  if (!status.ok()) {
+    env->DeleteFile(temp_file).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Saved the autotune maps to " << file;
+  return absl::OkStatus();
+}
+
+// Saves the autotune maps to the cache file in TF_AUTOTUNE_CACHE_DIR on a
+// background thread, so that the kernels that autotune never serialize the
+// maps themselves. Saves wait for kSaveDelayMicros after the maps change to
+// batch the results of a burst of autotuning, and a pending save is done
+// when the process exits.
+class AutotuneCacheWriter {
+ public:
+  // Returns nullptr if TF_AUTOTUNE_CACHE_DIR is not set or the cache file can
+  // not be named.
+  static AutotuneCacheWriter *Get() {
+    static AutotuneCacheWriter *writer = []() -> AutotuneCacheWriter * {
+      const std::string &dir = AutotuneCacheDir();
+      if (dir.empty()) return nullptr;
+      StatusOr<std::string> file = AutotuneCacheFile(dir);
+      if (!file.ok()) {
+        LOG(WARNING) << "Failed to name the autotune cache file in " << dir
+                     << ": " << file.status();
+        return nullptr;
+      }
+      auto *writer = new AutotuneCacheWriter(dir, *std::move(file));
+      std::atexit([] { Get()->Flush(); });
+      return writer;
+    }();
+    return writer;
+  }
+
+  void MarkDirty() {
+    mutex_lock l(mu_);
+    if (dirty_) return;
+    dirty_ = true;
+    cv_.notify_one();
+  }
+
+  void Flush() {
+    {
+      mutex_lock l(mu_);
+      if (!dirty_) return;
+      dirty_ = false;
+    }
+    Save();
+  }
+
+ private:
+  static constexpr int64_t kSaveDelayMicros = 10 * 1000 * 1000;
+
+  AutotuneCacheWriter(std::string dir, std::string file)
+      : dir_(std::move(dir)), file_(std::move(file)) {
+    // Never joined: the writer lives as long as the process.
+    thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "autotune_cache_writer", [this] { Run(); }));
+  }
+
+  void Run() {
+    while (true) {
+      {
+        mutex_lock l(mu_);
+        while (!dirty_) cv_.wait(l);
+      }
+      Env::Default()->SleepForMicroseconds(kSaveDelayMicros);
+      Flush();
+    }
+  }
+
+  void Save() {
+    // Serializes the saves of the writer thread and of Flush.
+    mutex_lock l(save_mu_);
+    Status status = SaveAutotuneMapsToFile(dir_, file_);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to save the autotune maps to " << file_ << ": "
+                   << status;
+    }
+  }
+
+  const std::string dir_;
+  const std::string file_;
+  mutex mu_;
+  condition_variable cv_;
+  bool dirty_ TF_GUARDED_BY(mu_) = false;
+  mutex save_mu_;
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+Status SaveAutotuneMapsToCache(absl::string_view dir) {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  TF_ASSIGN_OR_RETURN(std::string file, AutotuneCacheFile(dir));
+  TF_RETURN_IF_ERROR(SaveAutotuneMapsToFile(dir, file));
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  return absl::OkStatus();
+}
+
+void MaybeLoadAutotuneMapsFromCache() {
+  static absl::once_flag once;
+  absl::call_once(once, [] {
+    const std::string &dir = AutotuneCacheDir();
+    if (dir.empty()) return;
+    Status status = LoadAutotuneMapsFromCache(dir);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to load the autotune maps from " << dir << ": "
+                   << status;
+    }
+  });
+}
+
+void MaybeSaveAutotuneMapsToCache() {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  if (AutotuneCacheWriter *writer = AutotuneCacheWriter::Get()) {
+    writer->MarkDirty();
+  }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+void FlushAutotuneMapsToCache() {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  if (AutotuneCacheWriter *writer = AutotuneCacheWriter::Get()) {
+    writer->Flush();
+  }
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
 void ResetAutotuneMaps() {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
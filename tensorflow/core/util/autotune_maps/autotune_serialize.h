@@ -27,6 +27,7 @@ limitations under the License.
 
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/status.h"
 
 namespace tensorflow {
@@ -40,6 +41,34 @@ Status LoadSerializedAutotuneMaps(absl::string_view s);
 // LoadSerializedAutotuneMaps.
 Status SerializeAutotuneMaps(std::string* output);
 
+// Loads the autotune maps from the cache file in `dir` for the GPUs of this
+// process, if there is one. The file is named after the versions of the GPU
+// driver and the DNN library, which the results depend on besides the GPU
+// models that the entries record.
+Status LoadAutotuneMapsFromCache(absl::string_view dir);
+
+// Saves the autotune maps to the cache file in `dir` for the GPUs of this
+// process, together with the entries that other processes have saved there.
+// The file is replaced atomically, so processes sharing `dir` never read a
+// partial file.
+Status SaveAutotuneMapsToCache(absl::string_view dir);
+
+// Calls LoadAutotuneMapsFromCache on the directory named by the
+// TF_AUTOTUNE_CACHE_DIR environment variable, if it is set. Only the first
+// call in a process loads the file; errors are logged.
+void MaybeLoadAutotuneMapsFromCache();
+
+// Records that the autotune maps have changed, if the TF_AUTOTUNE_CACHE_DIR
+// environment variable is set. A background thread then saves them to the
+// cache file in that directory, as SaveAutotuneMapsToCache does, after a delay
+// that batches the changes that follow; a pending save is also done at exit.
+// Errors are logged. Cheap enough to call after every autotuning.
+void MaybeSaveAutotuneMapsToCache();
+
+// Saves the changes recorded by MaybeSaveAutotuneMapsToCache now instead of
+// after the delay.
+void FlushAutotuneMapsToCache();
+
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
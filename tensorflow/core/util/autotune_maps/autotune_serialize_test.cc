@@ -18,8 +18,14 @@ limitations under the License.
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
+
+#include <cstdlib>
+
+#include "absl/strings/str_cat.h"
 #include "xla/stream_executor/gpu/gpu_driver.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
@@ -181,6 +187,103 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+// Tests that the cache file keeps the entries of every process that saved it.
+TEST(AutotuneSerializeTest, Cache) {
+  TF_CHECK_OK(GpuDriver::Init());
+  const std::string dir =
+      io::JoinPath(testing::TmpDir(),
+                   absl::StrCat("autotune_cache_", Env::Default()->NowMicros()));
+  ConvParameters conv_params_example_a = {
+      GetStreamExec(),
+      /*batch=*/1,
+      /*in_depths=*/1,
+      /*in=*/{{1, 1}},
+      /*data_format=*/TensorFormat::FORMAT_NCHW,
+      /*out_depths=*/1,
+      /*filter=*/{{1, 1}},
+      /*dilation=*/{{1, 1}},
+      /*stride=*/{{1, 1}},
+      /*padding=*/{{1, 1}},
+      /*dtype=*/DataType::DT_INT8,
+      /*group_count=*/1};
+  ConvParameters conv_params_example_b = {
+      GetStreamExec(),
+      /*batch=*/2,
+      /*in_depths=*/1,
+      /*in=*/{{1, 1}},
+      /*data_format=*/TensorFormat::FORMAT_NCHW,
+      /*out_depths=*/1,
+      /*filter=*/{{1, 1}},
+      /*dilation=*/{{1, 1}},
+      /*stride=*/{{1, 1}},
+      /*padding=*/{{1, 1}},
+      /*dtype=*/DataType::DT_INT8,
+      /*group_count=*/1};
+  AlgorithmDesc algorithm(/*algo_id=*/1, /*use_tensor_ops=*/true);
+  AutotuneEntry<se::dnn::ConvOp> example(algorithm, absl::nullopt);
+
+  // Empty caches load nothing.
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromCache(dir));
+  EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
+
+  // Two processes save their entries in turn.
+  ConvAutotuneMap::GetInstance()->Insert(conv_params_example_a, example);
+  TF_CHECK_OK(SaveAutotuneMapsToCache(dir));
+  ResetAutotuneMaps();
+  ConvAutotuneMap::GetInstance()->Insert(conv_params_example_b, example);
+  TF_CHECK_OK(SaveAutotuneMapsToCache(dir));
+
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromCache(dir));
+  EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 2);
+  AutotuneEntry<se::dnn::ConvOp> entry;
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params_example_a, &entry));
+  EXPECT_EQ(entry, example);
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params_example_b, &entry));
+  EXPECT_EQ(entry, example);
+}
+
+// Tests that the results of autotuning reach TF_AUTOTUNE_CACHE_DIR.
+TEST(AutotuneSerializeTest, SaveInBackground) {
+  TF_CHECK_OK(GpuDriver::Init());
+  const std::string dir = io::JoinPath(
+      testing::TmpDir(),
+      absl::StrCat("autotune_cache_env_", Env::Default()->NowMicros()));
+  setenv("TF_AUTOTUNE_CACHE_DIR", dir.c_str(), /*overwrite=*/1);
+  ConvParameters conv_params_example_a = {
+      GetStreamExec(),
+      /*batch=*/1,
+      /*in_depths=*/1,
+      /*in=*/{{1, 1}},
+      /*data_format=*/TensorFormat::FORMAT_NCHW,
+      /*out_depths=*/1,
+      /*filter=*/{{1, 1}},
+      /*dilation=*/{{1, 1}},
+      /*stride=*/{{1, 1}},
+      /*padding=*/{{1, 1}},
+      /*dtype=*/DataType::DT_INT8,
+      /*group_count=*/1};
+  AlgorithmDesc algorithm(/*algo_id=*/1, /*use_tensor_ops=*/true);
+  AutotuneEntry<se::dnn::ConvOp> example(algorithm, absl::nullopt);
+
+  ResetAutotuneMaps();
+  ConvAutotuneMap::GetInstance()->Insert(conv_params_example_a, example);
+  MaybeSaveAutotuneMapsToCache();
+  MaybeSaveAutotuneMapsToCache();
+  FlushAutotuneMapsToCache();
+
+  ResetAutotuneMaps();
+  TF_CHECK_OK(LoadAutotuneMapsFromCache(dir));
+  EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 1);
+  AutotuneEntry<se::dnn::ConvOp> entry;
+  EXPECT_TRUE(
+      ConvAutotuneMap::GetInstance()->Find(conv_params_example_a, &entry));
+  EXPECT_EQ(entry, example);
+}
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
@@ -119,6 +120,56 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Decodes the packed varints in [`begin`, `end`) and appends them to `out`.
+// Returns false if a varint is malformed or truncated.
+//
+// This avoids the per-value overhead of `CodedInputStream::ReadVarint64`:
+// `out` is resized once, after counting the values (each of which ends with a
+// byte whose top bit is clear), and runs of eight single-byte varints (e.g.
+// small ids and labels) are decoded a word at a time. If `out` is a
+// `LimitedArraySlice`, values past its end are counted but not written.
+template <typename Result>
+bool ParsePackedVarints(const uint8* begin, const uint8* end, Result* out) {
+  if (begin == end) return true;
+  if (end[-1] & 0x80) return false;
+  size_t num_values = 0;
+  for (const uint8* p = begin; p < end; ++p) num_values += (*p & 0x80) == 0;
+
+  const size_t initial_size = out->size();
+  out->resize(initial_size + num_values);
+  auto* data = out->data() + initial_size;
+  // Less than `num_values` if `out` is a `LimitedArraySlice`.
+  const size_t capacity = out->size() - initial_size;
+
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  size_t index = 0;
+  const uint8* p = begin;
+  while (p < end) {
+    uint64 word;
+    if (static_cast<size_t>(end - p) >= sizeof(word) &&
+        index + sizeof(word) <= capacity) {
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kContinuationBits) == 0) {
+        for (size_t i = 0; i < sizeof(word); ++i) data[index + i] = p[i];
+        index += sizeof(word);
+        p += sizeof(word);
+        continue;
+      }
+    }
+    uint64 value = 0;
+    for (int shift = 0;; shift += 7) {
+      // A varint is at most 10 bytes long.
+      if (shift >= 70) return false;
+      const uint8 byte = *p++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    if (index < capacity) data[index] = static_cast<int64_t>(value);
+    ++index;
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -305,15 +356,22 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        // An empty packed field may end the buffer, where there is no
+        // buffer pointer to get.
+        if (packed_length > 0) {
+          const void* packed;
+          int size;
+          if (!stream.GetDirectBufferPointer(&packed, &size) || size < 0 ||
+              static_cast<uint32>(size) < packed_length) {
+            return false;
+          }
+          const uint8* packed_begin = static_cast<const uint8*>(packed);
+          if (!ParsePackedVarints(packed_begin, packed_begin + packed_length,
+                                  int64_list) ||
+              !stream.Skip(packed_length)) {
+            return false;
+          }
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
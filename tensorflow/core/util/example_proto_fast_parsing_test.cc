@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -172,6 +174,21 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, EmptyPackedInt64sAtEnd) {
+  // The empty packed field is the last byte of the buffer.
+  TestCorrectness(string(
+      "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x0a\x00", 15));
+}
+
+TEST(FastParse, TruncatedPackedInt64s) {
+  // The packed field claims two bytes, but only one is left.
+  const string serialized(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x02\x01",
+      16);
+  Example fast_example;
+  EXPECT_FALSE(TestFastParse(serialized, &fast_example));
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
@@ -327,6 +344,55 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+// Returns an Example whose "ids" feature holds `values`, mixing runs of
+// single-byte varints with multi-byte and negative (10-byte) ones.
+static string ExampleWithPackedInt64s(std::vector<int64_t>* values) {
+  for (int i = 0; i < 20; ++i) values->push_back(i);
+  values->push_back(300);
+  for (int i = 0; i < 9; ++i) values->push_back(127 - i);
+  values->push_back(-1);
+  values->push_back(std::numeric_limits<int64_t>::max());
+  values->push_back(std::numeric_limits<int64_t>::min());
+  for (int i = 0; i < 7; ++i) values->push_back(i);
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["ids"]
+          .mutable_int64_list();
+  for (int64_t value : *values) int64_list->add_value(value);
+  return Serialize(example);
+}
+
+TEST(FastParse, PackedInt64s) {
+  std::vector<int64_t> values;
+  TestCorrectness(ExampleWithPackedInt64s(&values));
+}
+
+TEST(FastParse, DensePackedInt64s) {
+  std::vector<int64_t> values;
+  const std::vector<tstring> serialized(2, ExampleWithPackedInt64s(&values));
+  const int64_t num_values = values.size();
+
+  FastParseExampleConfig config;
+  AddDenseFeature("ids", DT_INT64, {num_values}, false, num_values, &config);
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(result.dense_values.size(), 1);
+  const auto ids = result.dense_values[0].flat<int64_t>();
+  ASSERT_EQ(ids.size(), 2 * num_values);
+  for (int64_t i = 0; i < ids.size(); ++i) {
+    EXPECT_EQ(ids(i), values[i % num_values]);
+  }
+
+  // More values than the dense shape allows is an error.
+  FastParseExampleConfig small_config;
+  AddDenseFeature("ids", DT_INT64, {num_values - 1}, false, num_values - 1,
+                  &small_config);
+  Result small_result;
+  EXPECT_FALSE(
+      FastParseExample(small_config, serialized, {}, nullptr, &small_result)
+          .ok());
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
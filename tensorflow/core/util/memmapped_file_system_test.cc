@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/test.h"
@@ -116,6 +117,46 @@ TEST(MemmappedFileSystemTest, SimpleTest) {
             memmapped_env.FileExists("bla-bla-bla").code());
 }
 
+TEST(MemmappedFileSystemTest, PageAlignedTensors) {
+  constexpr uint64 kPageSize = 4096;
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "memmapped_env_aligned_test");
+  Tensor small_tensor(DT_FLOAT, TensorShape({3}));
+  test::FillFn<float>(&small_tensor, [](int i) { return i; });
+  Tensor string_tensor(DT_STRING, TensorShape({2}));
+  test::FillValues<tstring>(&string_tensor, {"ab", "cde"});
+  MemmappedFileSystemWriter writer;
+  TF_ASSERT_OK(writer.InitializeToFile(Env::Default(), filename));
+  EXPECT_EQ(error::INVALID_ARGUMENT, writer.SetTensorAlignment(100).code());
+  TF_ASSERT_OK(writer.SetTensorAlignment(kPageSize));
+  TF_ASSERT_OK(writer.SaveTensor(small_tensor, kTensor1FileName));
+  TF_ASSERT_OK(writer.SaveTensor(string_tensor, kTensor2FileName));
+  TF_ASSERT_OK(writer.FlushAndClose());
+
+  MemmappedEnv memmapped_env(Env::Default());
+  TF_ASSERT_OK(memmapped_env.InitializeFromFile(filename));
+  std::unique_ptr<ReadOnlyMemoryRegion> region1;
+  TF_ASSERT_OK(
+      memmapped_env.NewReadOnlyMemoryRegionFromFile(kTensor1FileName, &region1));
+  std::unique_ptr<ReadOnlyMemoryRegion> region2;
+  TF_ASSERT_OK(
+      memmapped_env.NewReadOnlyMemoryRegionFromFile(kTensor2FileName, &region2));
+  // The file is mapped at a page boundary, so every tensor starts on a page.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(region1->data()) % kPageSize);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(region2->data()) % kPageSize);
+  EXPECT_EQ(small_tensor.tensor_data(),
+            StringPiece(static_cast<const char*>(region1->data()),
+                        small_tensor.TotalBytes()));
+
+  // Three offsets followed by the string bytes.
+  ASSERT_EQ(3 * sizeof(uint64) + 5, region2->length());
+  const char* data = static_cast<const char*>(region2->data());
+  EXPECT_EQ(0, core::DecodeFixed64(data));
+  EXPECT_EQ(2, core::DecodeFixed64(data + sizeof(uint64)));
+  EXPECT_EQ(5, core::DecodeFixed64(data + 2 * sizeof(uint64)));
+  EXPECT_EQ("abcde", StringPiece(data + 3 * sizeof(uint64), 5));
+}
+
 TEST(MemmappedFileSystemTest, NotInitialized) {
   MemmappedEnv memmapped_env(Env::Default());
   std::unique_ptr<ReadOnlyMemoryRegion> memory_region;
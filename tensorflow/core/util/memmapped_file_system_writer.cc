@@ -16,6 +16,8 @@ limitations under the License.
 
 #include <algorithm>
 
+#include "tensorflow/core/lib/core/coding.h"
+
 namespace tensorflow {
 
 Status MemmappedFileSystemWriter::InitializeToFile(Env* env,
@@ -27,6 +29,16 @@ Status MemmappedFileSystemWriter::InitializeToFile(Env* env,
   return status;
 }
 
+Status MemmappedFileSystemWriter::SetTensorAlignment(uint64 alignment) {
+  if (alignment == 0 || alignment % Allocator::kAllocatorAlignment != 0) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: tensor alignment ", alignment,
+        " is not a multiple of ", Allocator::kAllocatorAlignment);
+  }
+  tensor_alignment_ = alignment;
+  return absl::OkStatus();
+}
+
 Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
                                              const string& element_name) {
   if (!output_file_) {
@@ -40,13 +52,16 @@ Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
         "package prefix ", MemmappedFileSystem::kMemmappedPackagePrefix,
         " and include [A-Za-z0-9_.]");
   }
+  if (tensor.dtype() == DT_STRING) {
+    return SaveStringTensor(tensor, element_name);
+  }
   const auto tensor_data = tensor.tensor_data();
   if (tensor_data.empty()) {
     return errors::InvalidArgument(
         "MemmappedEnvWritter: saving tensor with 0 size");
   }
   // Adds pad for correct alignment after memmapping.
-  TF_RETURN_IF_ERROR(AdjustAlignment(Allocator::kAllocatorAlignment));
+  TF_RETURN_IF_ERROR(AdjustAlignment(tensor_alignment_));
   AddToDirectoryElement(element_name, tensor_data.size());
   const auto result = output_file_->Append(tensor_data);
   if (result.ok()) {
@@ -55,6 +70,32 @@ Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
   return result;
 }
 
+Status MemmappedFileSystemWriter::SaveStringTensor(const Tensor& tensor,
+                                                   const string& element_name) {
+  if (tensor.NumElements() == 0) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: saving tensor with 0 size");
+  }
+  const auto strings = tensor.flat<tstring>();
+  string offsets;
+  offsets.reserve((strings.size() + 1) * sizeof(uint64));
+  uint64 offset = 0;
+  core::PutFixed64(&offsets, offset);
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    offset += strings(i).size();
+    core::PutFixed64(&offsets, offset);
+  }
+  TF_RETURN_IF_ERROR(AdjustAlignment(tensor_alignment_));
+  AddToDirectoryElement(element_name, offsets.size() + offset);
+  TF_RETURN_IF_ERROR(output_file_->Append(offsets));
+  output_file_offset_ += offsets.size();
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    TF_RETURN_IF_ERROR(output_file_->Append(strings(i)));
+    output_file_offset_ += strings(i).size();
+  }
+  return absl::OkStatus();
+}
+
 Status MemmappedFileSystemWriter::SaveProtobuf(
     const protobuf::MessageLite& message, const string& element_name) {
   if (!output_file_) {
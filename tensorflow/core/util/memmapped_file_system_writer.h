@@ -27,11 +27,20 @@ namespace tensorflow {
 
 // A class for saving into the memmapped format that can be read by
 // MemmappedFileSystem.
+//
+// Numeric tensors are saved as their raw data. DT_STRING tensors are saved as
+// a table of num_elements + 1 little-endian uint64 offsets into the string
+// bytes that follow it, which ImmutableConst decodes without parsing.
 class MemmappedFileSystemWriter {
  public:
   MemmappedFileSystemWriter() = default;
   ~MemmappedFileSystemWriter() = default;
   Status InitializeToFile(Env* env, const string& filename);
+  // Sets the alignment of the tensors saved after this call, e.g. the page
+  // size so that every tensor starts on its own page and can be shared
+  // through the page cache by several processes mapping the same file.
+  // `alignment` must be a multiple of Allocator::kAllocatorAlignment.
+  Status SetTensorAlignment(uint64 alignment);
   Status SaveTensor(const Tensor& tensor, const string& element_name);
   Status SaveProtobuf(const protobuf::MessageLite& message,
                       const string& element_name);
@@ -40,10 +49,12 @@ class MemmappedFileSystemWriter {
 
  private:
   Status AdjustAlignment(uint64 alignment);
+  Status SaveStringTensor(const Tensor& tensor, const string& element_name);
   void AddToDirectoryElement(const string& element_name, uint64 length);
   MemmappedFileSystemDirectory directory_;
   // The current offset in the file, to support alignment.
   uint64 output_file_offset_ = 0;
+  uint64 tensor_alignment_ = Allocator::kAllocatorAlignment;
   std::unique_ptr<WritableFile> output_file_;
   MemmappedFileSystemWriter(const MemmappedFileSystemWriter&) = delete;
   void operator=(const MemmappedFileSystemWriter&) = delete;
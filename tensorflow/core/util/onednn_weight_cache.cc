@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifdef INTEL_MKL
+
+#include "tensorflow/core/util/onednn_weight_cache.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+auto* weight_cache_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/onednn/weight_cache",
+    "The number of lookups and evictions of the process-wide cache of "
+    "reordered oneDNN weights.",
+    "result");
+
+std::string MemoryDescKey(const dnnl::memory::desc& md) {
+#ifdef ENABLE_ONEDNN_V3
+  return absl::StrCat(
+      static_cast<int>(md.get_data_type()), ":",
+      absl::StrJoin(md.get_dims(), ","), ":",
+      absl::StrJoin(md.get_strides(), ","), ":",
+      absl::StrJoin(md.get_inner_blks(), ","), ":",
+      absl::StrJoin(md.get_inner_idxs(), ","));
+#else
+  // There is no way to serialize a DNNL 1.x descriptor, so its raw bytes are
+  // used, as the kernels do when they cache it.
+  return std::string(reinterpret_cast<const char*>(&md.data), sizeof(md.data));
+#endif  // ENABLE_ONEDNN_V3
+}
+
+}  // namespace
+
+OneDnnWeightCache* OneDnnWeightCache::Global() {
+  static OneDnnWeightCache* cache = [] {
+    int64_t capacity_mb = 1024;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_ONEDNN_WEIGHT_CACHE_MB",
+                                    /*default_val=*/1024, &capacity_mb));
+    return new OneDnnWeightCache(capacity_mb << 20);
+  }();
+  return cache;
+}
+
+std::string OneDnnWeightCache::MakeKey(const Tensor& weights,
+                                       const dnnl::memory::desc& target_md) {
+  const Fprint128 fingerprint = Fingerprint128(weights.tensor_data());
+  return absl::StrCat(weights.dtype(), ":", weights.shape().DebugString(), ":",
+                      fingerprint.low64, ":", fingerprint.high64, ":",
+                      MemoryDescKey(target_md));
+}
+
+std::optional<Tensor> OneDnnWeightCache::Lookup(const std::string& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    ++stats_.misses;
+    weight_cache_counter->GetCell("miss")->IncrementBy(1);
+    return std::nullopt;
+  }
+  ++stats_.hits;
+  weight_cache_counter->GetCell("hit")->IncrementBy(1);
+  lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+  return it->second.weights;
+}
+
+void OneDnnWeightCache::Insert(const std::string& key,
+                               const Tensor& reordered_weights) {
+  const int64_t bytes = reordered_weights.TotalBytes();
+  if (bytes > capacity_bytes_) return;
+  mutex_lock l(mu_);
+  if (entries_.contains(key)) return;
+  lru_.push_front(key);
+  entries_.emplace(key, Entry{reordered_weights, lru_.begin()});
+  ++stats_.entries;
+  stats_.bytes += bytes;
+  EvictIfNeeded();
+}
+
+void OneDnnWeightCache::EvictIfNeeded() {
+  while (stats_.bytes > capacity_bytes_ && !lru_.empty()) {
+    auto it = entries_.find(lru_.back());
+    stats_.bytes -= it->second.weights.TotalBytes();
+    --stats_.entries;
+    ++stats_.evictions;
+    weight_cache_counter->GetCell("eviction")->IncrementBy(1);
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+}
+
+OneDnnWeightCache::Stats OneDnnWeightCache::GetStats() const {
+  tf_shared_lock l(mu_);
+  return stats_;
+}
+
+}  // namespace tensorflow
+
+#endif  // INTEL_MKL
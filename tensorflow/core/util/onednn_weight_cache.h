@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_ONEDNN_WEIGHT_CACHE_H_
+#define TENSORFLOW_CORE_UTIL_ONEDNN_WEIGHT_CACHE_H_
+#ifdef INTEL_MKL
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "dnnl.hpp"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Process-wide cache of constant weights reordered into the layout that a
+// oneDNN primitive expects. Kernels of different sessions or models that run
+// on the same weights with the same layout share one reordered copy instead
+// of each reordering and keeping their own.
+//
+// Entries are keyed by a fingerprint of the weight contents and the target
+// memory descriptor, and are evicted least recently used first once their
+// total size exceeds the capacity. Kernels keep their own reference to the
+// tensors they look up, so eviction never frees weights that are in use.
+class OneDnnWeightCache {
+ public:
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    int64_t entries = 0;
+    int64_t bytes = 0;
+  };
+
+  // Returns the cache shared by all kernels. Its capacity is
+  // TF_ONEDNN_WEIGHT_CACHE_MB megabytes (default 1024); 0 disables it.
+  static OneDnnWeightCache* Global();
+
+  explicit OneDnnWeightCache(int64_t capacity_bytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  OneDnnWeightCache(const OneDnnWeightCache&) = delete;
+  OneDnnWeightCache& operator=(const OneDnnWeightCache&) = delete;
+
+  bool enabled() const { return capacity_bytes_ > 0; }
+
+  // Returns the key of `weights` reordered to the layout `target_md`.
+  static std::string MakeKey(const Tensor& weights,
+                             const dnnl::memory::desc& target_md);
+
+  // Returns the reordered weights cached under `key`, if any.
+  std::optional<Tensor> Lookup(const std::string& key);
+
+  // Caches `reordered_weights` under `key`. Weights larger than the capacity
+  // are not cached.
+  void Insert(const std::string& key, const Tensor& reordered_weights);
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    Tensor weights;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  void EvictIfNeeded() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t capacity_bytes_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, Entry> entries_ TF_GUARDED_BY(mu_);
+  // Keys from the most to the least recently used.
+  std::list<std::string> lru_ TF_GUARDED_BY(mu_);
+  Stats stats_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // INTEL_MKL
+#endif  // TENSORFLOW_CORE_UTIL_ONEDNN_WEIGHT_CACHE_H_
@@ -0,0 +1,90 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifdef INTEL_MKL
+
+#include "tensorflow/core/util/onednn_weight_cache.h"
+
+#include <optional>
+
+#include "dnnl.hpp"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor MakeWeights(int num_elements, float value) {
+  Tensor weights(DT_FLOAT, TensorShape({num_elements}));
+  weights.flat<float>().setConstant(value);
+  return weights;
+}
+
+TEST(OneDnnWeightCacheTest, SharesReorderedWeights) {
+  OneDnnWeightCache cache(/*capacity_bytes=*/1 << 20);
+  EXPECT_FALSE(cache.Lookup("weights").has_value());
+
+  Tensor reordered = MakeWeights(16, 1.0f);
+  cache.Insert("weights", reordered);
+  std::optional<Tensor> shared = cache.Lookup("weights");
+  ASSERT_TRUE(shared.has_value());
+  EXPECT_TRUE(shared->SharesBufferWith(reordered));
+
+  OneDnnWeightCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.entries, 1);
+  EXPECT_EQ(stats.bytes, reordered.TotalBytes());
+}
+
+TEST(OneDnnWeightCacheTest, EvictsLeastRecentlyUsed) {
+  // Room for two 64-byte tensors.
+  OneDnnWeightCache cache(/*capacity_bytes=*/128);
+  cache.Insert("a", MakeWeights(16, 1.0f));
+  cache.Insert("b", MakeWeights(16, 2.0f));
+  EXPECT_TRUE(cache.Lookup("a").has_value());
+
+  cache.Insert("c", MakeWeights(16, 3.0f));
+  EXPECT_TRUE(cache.Lookup("a").has_value());
+  EXPECT_FALSE(cache.Lookup("b").has_value());
+  EXPECT_TRUE(cache.Lookup("c").has_value());
+  EXPECT_EQ(cache.GetStats().evictions, 1);
+
+  // Weights larger than the capacity are not cached.
+  cache.Insert("d", MakeWeights(64, 4.0f));
+  EXPECT_FALSE(cache.Lookup("d").has_value());
+}
+
+TEST(OneDnnWeightCacheTest, KeyDependsOnContentsAndLayout) {
+  dnnl::memory::desc plain({4, 4}, dnnl::memory::data_type::f32,
+                           dnnl::memory::format_tag::ab);
+  dnnl::memory::desc transposed({4, 4}, dnnl::memory::data_type::f32,
+                                dnnl::memory::format_tag::ba);
+  Tensor weights = MakeWeights(16, 1.0f);
+  Tensor same_weights = MakeWeights(16, 1.0f);
+  Tensor other_weights = MakeWeights(16, 2.0f);
+
+  EXPECT_EQ(OneDnnWeightCache::MakeKey(weights, plain),
+            OneDnnWeightCache::MakeKey(same_weights, plain));
+  EXPECT_NE(OneDnnWeightCache::MakeKey(weights, plain),
+            OneDnnWeightCache::MakeKey(other_weights, plain));
+  EXPECT_NE(OneDnnWeightCache::MakeKey(weights, plain),
+            OneDnnWeightCache::MakeKey(weights, transposed));
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // INTEL_MKL
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -41,11 +45,14 @@ limitations under the License.
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/tstring.h"
@@ -65,7 +72,9 @@ namespace tensorflow {
 // Versioning of the tensor bundle format.
 const int kTensorBundleMinProducer = 0;
 const int kTensorBundleMinConsumer = 0;
-const int kTensorBundleVersion = 1;
+const int kTensorBundleVersion = 2;
+// Bundles with compressed tensors can only be read from this version.
+const int kTensorBundleCompressionMinConsumer = 2;
 
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
@@ -76,14 +85,43 @@ static const int kBufferSize = 1024 * 1024;
 const char* const kHeaderEntryKey = "";
 
 // The size threshold for multi-threaded tensor loading.
-const int64_t kLargeTensorThreshold = static_cast<int64_t>(1) << 32;
+const int64_t kLargeTensorThreshold = static_cast<int64_t>(1) << 28;
 // Maximum number of threads to load the tensor from the file.
 const int kMaxFileReadThreads = 8;
 // Minimum size of a file section handled by each thread.
-const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
+const int64_t kMinSectionSize = static_cast<int64_t>(1) << 26;
+// Maximum number of threads to copy and checksum a tensor to save.
+const int kMaxFileWriteThreads = 8;
+// Maximum size of a tensor section copied and checksummed by each thread.
+const int64_t kMaxWriteSectionSize = static_cast<int64_t>(1) << 24;
 
 namespace {
 
+// A buffer that is a view of a tensor in a memory-mapped data file. The buffer
+// keeps the mapping alive.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mmap");
+  }
+  // The mapping is read-only, so the buffer must not be forwarded to ops that
+  // write to their inputs in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -255,6 +293,98 @@ Status WriteTensor(const Tensor& val, tsl::BufferedWritableFile* out,
   return out->Append(StringPiece(buf, *bytes_written));
 }
 
+// Serializes the data bytes of the non-string tensor "val" like WriteTensor(),
+// but copies and checksums sections of it from several threads. At most
+// kMaxFileWriteThreads sections are held in memory at a time.
+//
+// Checksums all bytes written and stores it into "crc32c".
+Status WriteTensorInParallel(const Tensor& val, tsl::BufferedWritableFile* out,
+                             size_t* bytes_written, uint32* crc32c) {
+  DCHECK(DataTypeCanUseMemcpy(val.dtype()));
+  const int64_t total_bytes = val.TotalBytes();
+  const char* buf = GetBackingBuffer(val);
+  const int64_t section_size = std::max<int64_t>(
+      1, std::min(kMaxWriteSectionSize,
+                  (total_bytes + kMaxFileWriteThreads - 1) /
+                      kMaxFileWriteThreads));
+  VLOG(1) << "Appending " << total_bytes << " bytes to file in sections of "
+          << section_size << " bytes";
+
+  std::vector<string> sections(kMaxFileWriteThreads);
+  std::vector<uint32> section_crc32cs(kMaxFileWriteThreads);
+  thread::ThreadPool pool(Env::Default(), "save_large_tensor",
+                          kMaxFileWriteThreads);
+  out->reset_crc32();
+  for (int64_t round_offset = 0; round_offset < total_bytes;
+       round_offset += kMaxFileWriteThreads * section_size) {
+    const int num_sections = std::min<int64_t>(
+        kMaxFileWriteThreads,
+        (total_bytes - round_offset + section_size - 1) / section_size);
+    BlockingCounter counter(num_sections);
+    for (int i = 0; i < num_sections; ++i) {
+      pool.Schedule([&, i]() {
+        const int64_t offset = round_offset + i * section_size;
+        const int64_t size = std::min(section_size, total_bytes - offset);
+        // Like BufferedWritableFile::Append(), checksums a copy in case the
+        // tensor changes while it is written.
+        sections[i].assign(buf + offset, size);
+        section_crc32cs[i] = crc32c::Value(sections[i].data(), size);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (int i = 0; i < num_sections; ++i) {
+      TF_RETURN_IF_ERROR(out->AppendWithCrc32(sections[i], section_crc32cs[i]));
+    }
+  }
+  *bytes_written = total_bytes;
+  *crc32c = out->crc32();
+  return absl::OkStatus();
+}
+
+// Serializes the data bytes of the non-string tensor "val" as blocks of
+// "block_size" bytes compressed with snappy, and records the number of bytes
+// each block takes in "entry". Blocks that do not shrink are stored
+// uncompressed. "bytes_written" is treated in the same fashion as
+// WriteTensor(), i.e. counts the uncompressed bytes.
+//
+// Checksums the uncompressed bytes and stores it into "crc32c".
+Status WriteCompressedTensor(const Tensor& val, int64_t block_size,
+                             tsl::BufferedWritableFile* out,
+                             BundleEntryProto* entry, size_t* bytes_written,
+                             uint32* crc32c) {
+  DCHECK(DataTypeCanUseMemcpy(val.dtype()));
+  const int64_t total_bytes = val.TotalBytes();
+  const char* buf = GetBackingBuffer(val);
+  entry->set_compression_block_size(block_size);
+  *crc32c = 0;
+  string compressed;
+  for (int64_t offset = 0; offset < total_bytes; offset += block_size) {
+    const int64_t size = std::min(block_size, total_bytes - offset);
+    *crc32c = crc32c::Extend(*crc32c, buf + offset, size);
+    if (port::Snappy_Compress(buf + offset, size, &compressed) &&
+        compressed.size() < size) {
+      TF_RETURN_IF_ERROR(out->Append(compressed));
+      entry->add_compressed_block_sizes(compressed.size());
+    } else {
+      TF_RETURN_IF_ERROR(out->Append(StringPiece(buf + offset, size)));
+      entry->add_compressed_block_sizes(size);
+    }
+  }
+  *bytes_written = total_bytes;
+  return absl::OkStatus();
+}
+
+// Returns the number of bytes the tensor of "entry" takes in its data file.
+int64_t StoredSize(const BundleEntryProto& entry) {
+  if (entry.compression_block_size() <= 0) return entry.size();
+  int64_t stored_size = 0;
+  for (int64_t block_size : entry.compressed_block_sizes()) {
+    stored_size += block_size;
+  }
+  return stored_size;
+}
+
 // Serializes string tensor "val".  "bytes_written" is treated in the same
 // fashion as WriteTensor().
 //
@@ -476,6 +606,16 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
     status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
   } else if (val.dtype() == DT_VARIANT) {
     status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
+  } else if (options_.compression_block_size > 0 &&
+             DataTypeCanUseMemcpy(val.dtype())) {
+    status_ = WriteCompressedTensor(val, options_.compression_block_size,
+                                    out_.get(), entry, &data_bytes_written,
+                                    &crc32c);
+  } else if (options_.parallel_write_min_bytes > 0 &&
+             DataTypeCanUseMemcpy(val.dtype()) &&
+             val.TotalBytes() >= options_.parallel_write_min_bytes) {
+    status_ = WriteTensorInParallel(val, out_.get(), &data_bytes_written,
+                                    &crc32c);
   } else {
     status_ = WriteTensor(val, out_.get(), &data_bytes_written);
     crc32c = out_->crc32();
@@ -484,7 +624,7 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   if (status_.ok()) {
     entry->set_size(data_bytes_written);
     entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
+    size_ += StoredSize(*entry);
     status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
   }
   return status_;
@@ -564,7 +704,9 @@ Status BundleWriter::Finish() {
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
-    version->set_min_consumer(kTensorBundleMinConsumer);
+    version->set_min_consumer(options_.compression_block_size > 0
+                                  ? kTensorBundleCompressionMinConsumer
+                                  : kTensorBundleMinConsumer);
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -785,7 +927,9 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
       iter_(nullptr),
       need_to_swap_bytes_(false),
       enable_multi_threading_for_testing_(
-          options.enable_multi_threading_for_testing) {
+          options.enable_multi_threading_for_testing),
+      use_mmap_(options.use_mmap),
+      verify_mmap_crc_(options.verify_mmap_crc) {
   if (cache_ == nullptr) {
     // Make a cache for use just by this BundleReader.
     owned_cache_ = std::make_unique<BundleCache>(env);
@@ -906,6 +1050,24 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
+  if (entry.compression_block_size() > 0) {
+    TF_RETURN_IF_ERROR(GetCompressedValue(entry, ret));
+    *val = *ret;
+    if (ret != val) delete ret;
+    return absl::OkStatus();
+  }
+
+  if (use_mmap_ && DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_ && entry.size() > 0) {
+    bool mapped = false;
+    TF_RETURN_IF_ERROR(GetMappedValue(entry, ret, &mapped));
+    if (mapped) {
+      *val = *ret;
+      if (ret != val) delete ret;
+      return absl::OkStatus();
+    }
+  }
+
   // Open the data file if it has not been opened.
   io::InputBuffer* buffered_file = data_[entry.shard_id()];
   if (buffered_file == nullptr) {
@@ -919,6 +1081,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
+  bool crc32c_computed = false;
 
   if (DataTypeCanUseMemcpy(entry.dtype())) {
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
@@ -944,30 +1107,31 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
         }
 
         std::vector<Status> statuses(thread_pool_size);
+        // The checksum of each section is computed by the thread reading it,
+        // while the section is still in its cache.
+        std::vector<uint32> section_crc32cs(thread_pool_size);
         auto reader_pool = std::make_unique<thread::ThreadPool>(
             Env::Default(), "restore_large_tensor", thread_pool_size);
+        // RandomAccessFile reads are thread-safe, so all the sections are read
+        // from the file of the shard.
+        RandomAccessFile* section_reader = buffered_file->file();
 
         for (int i = 0; i < thread_pool_size; ++i) {
           reader_pool->Schedule([&, i]() {
             int64_t offset = i * section_size;
             int64_t size = i == thread_pool_size - 1 ? entry.size() - offset
                                                      : section_size;
-            std::unique_ptr<RandomAccessFile> section_reader = nullptr;
             StringPiece sp;
-            if (auto file_status = env_->NewRandomAccessFile(
-                    DataFilename(prefix_, entry.shard_id(), num_shards_),
-                    &section_reader);
-                !file_status.ok()) {
-              statuses[i] = file_status;
-              return;
-            }
-
             auto backing_buffer_current_pos = backing_buffer + offset;
             auto status = section_reader->Read(entry.offset() + offset, size,
                                                &sp, backing_buffer_current_pos);
             if (sp.data() != backing_buffer_current_pos) {
               memmove(backing_buffer_current_pos, sp.data(), size);
             }
+            if (status.ok()) {
+              section_crc32cs[i] =
+                  crc32c::Value(backing_buffer_current_pos, size);
+            }
             statuses[i] = std::move(status);
           });
         }
@@ -976,6 +1140,14 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
         for (const auto& status : statuses) {
           TF_RETURN_IF_ERROR(status);
         }
+        for (int i = 0; i < thread_pool_size; ++i) {
+          const int64_t offset = i * section_size;
+          const int64_t size = i == thread_pool_size - 1 ? entry.size() - offset
+                                                         : section_size;
+          actual_crc32c =
+              crc32c::Concat(actual_crc32c, section_crc32cs[i], size);
+        }
+        crc32c_computed = true;
       }
     } else {
       TF_RETURN_IF_ERROR(buffered_file->ReadNBytes(entry.size(), backing_buffer,
@@ -983,7 +1155,9 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
     // Note that we compute the checksum *before* byte-swapping. The checksum
     // should be on the bytes in the order they appear in the file.
-    actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    if (!crc32c_computed) {
+      actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+    }
     if (need_to_swap_bytes_) {
       TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
     }
@@ -1019,6 +1193,108 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   return absl::OkStatus();
 }
 
+Status BundleReader::GetCompressedValue(const BundleEntryProto& entry,
+                                        Tensor* val) {
+  if (!DataTypeCanUseMemcpy(entry.dtype())) {
+    return errors::DataLoss("Compressed bundle entry of type ",
+                            DataTypeString(entry.dtype()), ": key ", key());
+  }
+  RandomAccessFile* file = nullptr;
+  TF_RETURN_IF_ERROR(cache_->GetFile(
+      DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
+  const int64_t stored_size = StoredSize(entry);
+  std::unique_ptr<char[]> scratch(new char[stored_size]);
+  StringPiece stored;
+  TF_RETURN_IF_ERROR(
+      file->Read(entry.offset(), stored_size, &stored, scratch.get()));
+
+  char* backing_buffer = const_cast<char*>(val->tensor_data().data());
+  const char* block = stored.data();
+  int64_t offset = 0;
+  for (int64_t block_size : entry.compressed_block_sizes()) {
+    const int64_t size =
+        std::min(entry.compression_block_size(), entry.size() - offset);
+    size_t uncompressed_size;
+    if (size <= 0) {
+      return errors::DataLoss("Too many compressed blocks in bundle entry: key ",
+                              key());
+    } else if (block_size == size) {
+      memcpy(backing_buffer + offset, block, size);
+    } else if (!port::Snappy_GetUncompressedLength(block, block_size,
+                                                   &uncompressed_size) ||
+               uncompressed_size != size ||
+               !port::Snappy_Uncompress(block, block_size,
+                                        backing_buffer + offset)) {
+      return errors::DataLoss("Failed to decompress the block at ", offset,
+                              " of bundle entry: key ", key());
+    }
+    offset += size;
+    block += block_size;
+  }
+  if (offset != entry.size()) {
+    return errors::DataLoss("Too few compressed blocks in bundle entry: key ",
+                            key());
+  }
+
+  const uint32 actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  if (need_to_swap_bytes_) {
+    TF_RETURN_IF_ERROR(ByteSwapTensor(val));
+  }
+  return absl::OkStatus();
+}
+
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                                    bool* mapped) {
+  *mapped = false;
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, entry.shard_id(), num_shards_), &region);
+    if (!s.ok()) {
+      // The null region makes later lookups read from the shard right away.
+      VLOG(1) << "Failed to map the data file of shard " << entry.shard_id()
+              << " of " << prefix_ << ", reading it instead: " << s;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) return absl::OkStatus();
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), " is too short for the ",
+                            entry.size(), " bytes at offset ", entry.offset());
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  // Tensors must be aligned for Eigen, which the data of bundles written with
+  // a large enough `data_alignment` is.
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return absl::OkStatus();
+  }
+  if (verify_mmap_crc_) {
+    const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+          entry.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the mapped bytes ", actual_crc32c);
+    }
+  }
+  core::RefCountPtr<TensorBuffer> buf(
+      new MappedTensorBuffer(region, data, entry.size()));
+  *val = Tensor(entry.dtype(), val->shape(), std::move(buf));
+  *mapped = true;
+  return absl::OkStatus();
+}
+
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1207,6 +1483,17 @@ Status BundleReader::LookupTensorShape(StringPiece key, TensorShape* shape) {
   return LookupDtypeAndShape(key, &ignored, shape);
 }
 
+Status BundleReader::LookupCrc32c(StringPiece key, uint32* crc32c) {
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  if (entry.slices_size() > 0) {
+    return errors::InvalidArgument("Tensor ", key,
+                                   " is partitioned and has no checksum");
+  }
+  *crc32c = entry.crc32c();
+  return absl::OkStatus();
+}
+
 string BundleReader::DebugString() {
   // Format used below emulates that of TensorSliceReader::DebugString().
   string shape_str;
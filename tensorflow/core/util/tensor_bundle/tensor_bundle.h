@@ -119,6 +119,13 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Tensors of memcpy-able types of at least this many bytes are copied and
+    // checksummed by several threads before being written. 0 disables it.
+    int64_t parallel_write_min_bytes{static_cast<int64_t>(1) << 26};
+    // If positive, tensors of memcpy-able types are compressed with snappy in
+    // blocks of this many bytes. Bundles written this way cannot be read by
+    // readers older than kTensorBundleVersion 2.
+    int64_t compression_block_size{0};
   };
   BundleWriter(Env* env, absl::string_view prefix,
                const Options& options = Options());
@@ -212,6 +219,18 @@ class BundleReader {
 
     // For tests only.
     bool enable_multi_threading_for_testing = false;
+
+    // If true, maps the data files into memory, and looks up tensors of
+    // memcpy-able types as read-only views of the mapped pages instead of
+    // reading them into new buffers. The pages are then shared with the
+    // other processes that map the same files. Tensors whose data is not
+    // aligned for Eigen, e.g. because the bundle was written with a small
+    // `data_alignment`, are still read.
+    bool use_mmap = false;
+
+    // If `use_mmap` is set, whether to verify the checksums of the mapped
+    // tensors, which reads all of their pages.
+    bool verify_mmap_crc = true;
   };
   BundleReader(Env* env, absl::string_view prefix, Options options);
 
@@ -250,6 +269,12 @@ class BundleReader {
   Status LookupTensorShape(absl::string_view key,
                            TensorShape* shape) TF_MUST_USE_RESULT;
 
+  // Looks up the checksum that was stored with the tensor keyed by "key".
+  // Returns an error if "key" refers to a partitioned tensor, which has no
+  // checksum of its full contents.
+  // REQUIRES: status().ok()
+  Status LookupCrc32c(absl::string_view key, uint32* crc32c) TF_MUST_USE_RESULT;
+
   // Looks up the tensor keyed by "key".  If "key" refers to a partitioned
   // tensor, attempts to look up the full contents using all stored slices.
   //
@@ -322,6 +347,16 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Makes "val" a view of the tensor described by "entry" in its mapped data
+  // file, and sets "mapped" if it could.
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* mapped) TF_MUST_USE_RESULT;
+
+  // Reads and decompresses the tensor described by the compressed entry
+  // "entry" into "val", which has its shape.
+  Status GetCompressedValue(const BundleEntryProto& entry,
+                            Tensor* val) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -360,6 +395,12 @@ class BundleReader {
 
   bool enable_multi_threading_for_testing_ = false;
 
+  bool use_mmap_ = false;
+  bool verify_mmap_crc_ = true;
+  // The mapped data files, or null for the ones that could not be mapped.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   BundleReader(const BundleReader&) = delete;
   void operator=(const BundleReader&) = delete;
 };
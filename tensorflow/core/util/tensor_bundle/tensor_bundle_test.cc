@@ -1151,6 +1151,79 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, ParallelWrite) {
+  {
+    BundleWriter::Options opts;
+    // Writes all tensors but the strings in parallel sections.
+    opts.parallel_write_min_bytes = 1;
+    BundleWriter writer(Env::Default(), Prefix("parallel"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_100x100<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<int32>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("two")));
+    TF_EXPECT_OK(writer.Add("foo_003", Constant<double>(3.0, TensorShape({}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("parallel"));
+  TF_ASSERT_OK(reader.status());
+  // The checksums of the lookups verify the combined section checksums.
+  Expect<float>(&reader, "foo_000", Constant_100x100<float>(0));
+  Expect<int32>(&reader, "foo_001", Constant_2x3<int32>(1));
+  Expect<tstring>(&reader, "foo_002", Constant_2x3<tstring>("two"));
+  Expect<double>(&reader, "foo_003", Constant<double>(3.0, TensorShape({})));
+}
+
+TEST(TensorBundleTest, CompressedBlocks) {
+  {
+    BundleWriter::Options opts;
+    // 40000 bytes of floats are stored as 13 full blocks and a shorter one.
+    opts.compression_block_size = 3000;
+    BundleWriter writer(Env::Default(), Prefix("compressed"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_100x100<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<int32>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("two")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("compressed"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "foo_000", Constant_100x100<float>(0));
+  Expect<int32>(&reader, "foo_001", Constant_2x3<int32>(1));
+  Expect<tstring>(&reader, "foo_002", Constant_2x3<tstring>("two"));
+
+  // The constant floats compress well.
+  uint64 data_file_size;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(
+      DataFilename(Prefix("compressed"), 0, 1), &data_file_size));
+  EXPECT_LT(data_file_size, 40000);
+}
+
+TEST(TensorBundleTest, MmapLookup) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("mmap"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_100x100<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<int32>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("two")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("mmap"), options);
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "foo_000", Constant_100x100<float>(0));
+  Expect<int32>(&reader, "foo_001", Constant_2x3<int32>(1));
+  Expect<tstring>(&reader, "foo_002", Constant_2x3<tstring>("two"));
+
+  // Tensors of memcpy-able types are views of the mapping, which ops must
+  // not write to in place.
+  Tensor mapped;
+  TF_ASSERT_OK(reader.Lookup("foo_000", &mapped));
+  EXPECT_FALSE(mapped.RefCountIsOne());
+  Tensor read;
+  TF_ASSERT_OK(reader.Lookup("foo_002", &read));
+  EXPECT_TRUE(read.RefCountIsOne());
+}
+
 absl::Status CreateFile(Env* env, const std::string& fname) {
   std::unique_ptr<WritableFile> file;
   TF_RETURN_IF_ERROR(env->NewWritableFile(fname, &file));
@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/dtensor/cc/dtensor_device.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <optional>
@@ -71,6 +73,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/casts.h"
 #include "tensorflow/core/platform/errors.h"
@@ -1516,6 +1520,51 @@ StatusOr<std::unique_ptr<Graph>> SelectGraphToExecute(
   return new_graph;
 }
 
+// Converts the part of `graph` that runs `function` to a FunctionDef named
+// after `function.translated_function_name`.
+Status ExecutionFunctionToFunctionDef(
+    const std::string& doperation_name,
+    const absl::flat_hash_set<std::string>& control_ret_names,
+    const Graph& graph, TranslatedFunction& function, FunctionDef* to_run) {
+  std::string selected_call_node_name;
+  // TODO(bfontain): We should just try to call the functions directly rather
+  // than wrap
+  // Construct graph that executes only computation for `function`.
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<Graph> new_graph,
+      SelectGraphToExecute(function, graph, &selected_call_node_name));
+
+  if (VLOG_IS_ON(4) || DEBUG_DATA_DUMPER()->ShouldDump(
+                           "selected_graph", kDebugGroupDTensorGraph)) {
+    DEBUG_DATA_DUMPER()->DumpGraph("selected_graph", kDebugGroupDTensorGraph,
+                                   doperation_name, new_graph.get(),
+                                   /*func_lib_def=*/nullptr, true);
+  }
+
+  auto control_ret_node_names =
+      [&control_ret_names, &selected_call_node_name](
+          const Node* node) -> std::optional<std::string> {
+    // Add the stateful partitioned call node as a control return as we need
+    // to process any control deps inside the inner function.
+    if (control_ret_names.contains(node->name()) ||
+        node->name() == selected_call_node_name) {
+      return node->name();
+    }
+    return std::nullopt;
+  };
+
+  TF_RETURN_IF_ERROR(tensorflow::GraphToFunctionDef(
+      *new_graph, function.translated_function_name, control_ret_node_names,
+      to_run));
+
+  for (const auto& out : to_run->signature().output_arg()) {
+    function.output_dtypes.emplace_back(static_cast<TF_DataType>(out.type()));
+  }
+
+  AddDTensorFunctionAttr(*to_run);
+  return absl::OkStatus();
+}
+
 // Adds processed graph to run for each mesh computation in
 // `execution_functions` to function definition library.
 Status AddExecutionFunctionDefsToFunctionDefLibrary(
@@ -1528,22 +1577,9 @@ Status AddExecutionFunctionDefsToFunctionDefLibrary(
   for (auto* n : control_ret_nodes) {
     control_ret_names.emplace(n->name());
   }
-  for (TranslatedFunction& function : execution_functions->function_list) {
-    std::string selected_call_node_name;
-    // TODO(bfontain): We should just try to call the functions directly rather
-    // than wrap
-    // Construct graph that executes only computation for `function`.
-    TF_ASSIGN_OR_RETURN(
-        std::unique_ptr<Graph> new_graph,
-        SelectGraphToExecute(function, graph, &selected_call_node_name));
-
-    if (VLOG_IS_ON(4) || DEBUG_DATA_DUMPER()->ShouldDump(
-                             "selected_graph", kDebugGroupDTensorGraph)) {
-      DEBUG_DATA_DUMPER()->DumpGraph("selected_graph", kDebugGroupDTensorGraph,
-                                     doperation_name, new_graph.get(),
-                                     /*func_lib_def=*/nullptr, true);
-    }
-
+  std::vector<TranslatedFunction>& functions =
+      execution_functions->function_list;
+  for (TranslatedFunction& function : functions) {
     // Add unique identifier based on the function we are executing to the
     // function/graph and convert graph to functiondef.
     NameAttrList func;
@@ -1555,31 +1591,56 @@ Status AddExecutionFunctionDefsToFunctionDefLibrary(
         absl::StrCat(doperation_name, "_", func.name(), "_",
                      unique_function_number.fetch_add(1));
     function.function_name = func.name();
-    auto control_ret_node_names =
-        [&control_ret_names, &selected_call_node_name](
-            const Node* node) -> std::optional<std::string> {
-      // Add the stateful partitioned call node as a control return as we need
-      // to process any control deps inside the inner function.
-      if (control_ret_names.contains(node->name()) ||
-          node->name() == selected_call_node_name) {
-        return node->name();
+  }
+
+  // Each mesh copies and prunes the whole graph, which dominates the lowering
+  // time of large multi-mesh programs, so the meshes are processed in
+  // parallel on the inter-op threads of the eager context. The functions are
+  // still added to the library in order.
+  std::vector<FunctionDef> function_defs(functions.size());
+  std::vector<Status> statuses(functions.size());
+  auto build_function_def = [&](int i) {
+    statuses[i] = ExecutionFunctionToFunctionDef(
+        doperation_name, control_ret_names, graph, functions[i],
+        &function_defs[i]);
+  };
+  auto* eager_context =
+      llvm::dyn_cast<EagerContext>(tensorflow::unwrap(context));
+  thread::ThreadPool* thread_pool =
+      eager_context != nullptr ? eager_context->GetThreadPool() : nullptr;
+  if (functions.size() <= 1 || thread_pool == nullptr) {
+    for (int i = 0; i < functions.size(); ++i) build_function_def(i);
+  } else {
+    // The caller builds functions too, so this makes progress even when it
+    // runs on one of the inter-op threads or they are all busy. Closures
+    // which start after every function is built find no work, but still
+    // outlive this call, so they share the work state.
+    struct State {
+      explicit State(int num_functions) : pending(num_functions) {}
+      std::atomic<int> next_function{0};
+      BlockingCounter pending;
+      std::function<void(int)> build;
+    };
+    auto state = std::make_shared<State>(functions.size());
+    state->build = build_function_def;
+    auto run = [state, num_functions = static_cast<int>(functions.size())]() {
+      for (int i = state->next_function.fetch_add(1); i < num_functions;
+           i = state->next_function.fetch_add(1)) {
+        state->build(i);
+        state->pending.DecrementCount();
       }
-      return std::nullopt;
     };
-
-    tensorflow::FunctionDef to_run;
-    TF_RETURN_IF_ERROR(tensorflow::GraphToFunctionDef(
-        *new_graph, function.translated_function_name, control_ret_node_names,
-        &to_run));
-
-    for (const auto& out : to_run.signature().output_arg()) {
-      function.output_dtypes.emplace_back(static_cast<TF_DataType>(out.type()));
-    }
-
-    AddDTensorFunctionAttr(to_run);
+    const int num_tasks =
+        std::min<int>(functions.size(), thread_pool->NumThreads() + 1) - 1;
+    for (int i = 0; i < num_tasks; ++i) thread_pool->Schedule(run);
+    run();
+    state->pending.Wait();
+  }
+  for (int i = 0; i < functions.size(); ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
     TF_RETURN_IF_ERROR(
         tensorflow::unwrap(context)->AddFunctionDefWithStackTraces(
-            to_run, stack_traces));
+            function_defs[i], stack_traces));
   }
 
   return absl::OkStatus();
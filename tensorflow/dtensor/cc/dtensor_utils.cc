@@ -182,5 +182,25 @@ bool EnableMultiDeviceMode() {
       "DTENSOR_ENABLE_MULTI_DEVICE_EXPANSION", false, &multi_device_mode);
   return status.ok() && multi_device_mode;
 }
+
+bool ReportCommunicationCost() {
+  bool report_communication_cost;
+  absl::Status status =
+      tsl::ReadBoolFromEnvVar("DTENSOR_REPORT_COMMUNICATION_COST", false,
+                              &report_communication_cost);
+  return status.ok() && report_communication_cost;
+}
+
+double InterconnectBandwidthGbps() {
+  char* bandwidth_str = std::getenv("DTENSOR_INTERCONNECT_BANDWIDTH_GBPS");
+  if (bandwidth_str == nullptr) return 100.0;
+  double bandwidth;
+  if (absl::SimpleAtod(bandwidth_str, &bandwidth) && bandwidth > 0) {
+    return bandwidth;
+  }
+  LOG(WARNING) << "Invalid DTENSOR_INTERCONNECT_BANDWIDTH_GBPS, using the "
+                  "default value 100.";
+  return 100.0;
+}
 }  // namespace dtensor
 }  // namespace tensorflow
@@ -86,6 +86,14 @@ int AllReduceCombineOptimizationTopologicalDistance();
 
 // Returns whether to perform multi-device expansion.
 bool EnableMultiDeviceMode();
+
+// Returns whether to report the estimated communication cost of each function
+// after SPMD expansion.
+bool ReportCommunicationCost();
+
+// Returns the per-device interconnect bandwidth in GB/s assumed when estimating
+// the communication cost of collectives.
+double InterconnectBandwidthGbps();
 }  // namespace dtensor
 }  // namespace tensorflow
 
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdint>
 #include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
@@ -285,45 +286,15 @@ StatusOr<mlir::Value> EmitDenseToSparseToDense(
   return dense.getResult();
 }
 
-StatusOr<mlir::Value> EmitRelayout(
-    mlir::Value input, const dtensor::Layout& src_layout,
-    const dtensor::Layout& tgt_layout,
-    llvm::SmallPtrSet<mlir::Operation*, 4>* newly_created_ops) {
-  // EmitRelayout is performed by doing a split, an AllGather and another split.
-  // The first split oppertunistically splits input tensor dimension i on mesh
-  // mesh axis x if:
-  // 1.  tgt_layout contains x at position i
-  // 2.  src_layout is unsharded at position i.
-  // 3.  src_layout does not contain mesh axis x.
-  // This produces intermediate layout 1.
-  // Next an all concat is performed on any axis in the intermediate layout 1
-  // that does not agree with the sharding on the output axis.
-  // This produces intermediate layout 2.
-  // A split is performed from intermediate layout 2 to the tgt layout.
-
-  if (src_layout == tgt_layout) {
-    return input;
-  }
-
-  mlir::OpBuilder builder(input.getContext());
-  TF_RETURN_IF_ERROR(SetBuilderInsertionAfterValue(input, builder));
-  // If two layouts are the same, or the only difference is layout type, then
-  // there is no need to actually relayout data.
+StatusOr<RelayoutPlan> GetRelayoutPlan(const Layout& src_layout,
+                                       const Layout& tgt_layout,
+                                       bool allow_all_to_all) {
+  RelayoutPlan plan;
   if (src_layout.IsEquivalentIgnoringType(tgt_layout)) {
-    mlir::TF::IdentityOp op = builder.create<mlir::TF::IdentityOp>(
-        input.getLoc(), input.getType(), input);
-    if (newly_created_ops != nullptr) newly_created_ops->insert(op);
-    return op.getOutput();
+    plan.kind = RelayoutPlan::Kind::kIdentity;
+    return plan;
   }
 
-  // Save whether the input is from a SparseToDenseOp. If it is, then we will
-  // emit a DenseToSparse and a SparseToDense op.
-  bool is_sparse = IsSparseValue(input);
-  if (!mlir::isa<mlir::RankedTensorType>(input.getType()))
-    return errors::Internal(
-        "attempting to relayout a tensor that does not "
-        "have a rank");
-
   if (src_layout.mesh() != tgt_layout.mesh()) {
     return errors::Internal(
         absl::StrCat("Attempted to relayout to a different "
@@ -336,13 +307,9 @@ StatusOr<mlir::Value> EmitRelayout(
         "Attempted to relayout to a different global shape.");
   }
 
-  if (EnableAllToAllForRelayout() && !is_sparse &&
-      CanUseAllToAll(src_layout, tgt_layout)) {
-    // TODO(tmorris): support sparse case
-    TF_ASSIGN_OR_RETURN(mlir::Value all_to_all_result,
-                        EmitAllToAll(builder, input, src_layout, tgt_layout,
-                                     newly_created_ops));
-    return all_to_all_result;
+  if (allow_all_to_all && CanUseAllToAll(src_layout, tgt_layout)) {
+    plan.kind = RelayoutPlan::Kind::kAllToAll;
+    return plan;
   }
 
   absl::flat_hash_set<std::string> src_sharding_dims;
@@ -358,15 +325,10 @@ StatusOr<mlir::Value> EmitRelayout(
     else
       intermediate_specs_1[i] = src_layout.sharding_spec(i);
   }
-  TF_ASSIGN_OR_RETURN(Layout intermediate_layout_1,
+  TF_ASSIGN_OR_RETURN(plan.intermediate_layout_1,
                       Layout::GetLayout(tgt_layout.type(), intermediate_specs_1,
                                         src_layout.mesh()));
 
-  llvm::SmallPtrSet<mlir::Operation*, 4> local_newly_created_ops;
-  TF_ASSIGN_OR_RETURN(mlir::Value split_result,
-                      EmitAllScatter(builder, input, src_layout,
-                                     intermediate_layout_1, newly_created_ops));
-
   std::vector<std::string> intermediate_specs_2(src_layout.rank());
   for (int i = 0; i < src_layout.rank(); ++i) {
     if (Layout::IsShardedDimension(intermediate_specs_1[i]) &&
@@ -375,18 +337,80 @@ StatusOr<mlir::Value> EmitRelayout(
     else
       intermediate_specs_2[i] = intermediate_specs_1[i];
   }
-  TF_ASSIGN_OR_RETURN(Layout intermediate_layout_2,
+  TF_ASSIGN_OR_RETURN(plan.intermediate_layout_2,
                       Layout::GetLayout(tgt_layout.type(), intermediate_specs_2,
                                         src_layout.mesh()));
+  plan.kind = RelayoutPlan::Kind::kScatterGatherScatter;
+  return plan;
+}
+
+StatusOr<mlir::Value> EmitRelayout(
+    mlir::Value input, const dtensor::Layout& src_layout,
+    const dtensor::Layout& tgt_layout,
+    llvm::SmallPtrSet<mlir::Operation*, 4>* newly_created_ops) {
+  // EmitRelayout is performed by doing a split, an AllGather and another split.
+  // The first split oppertunistically splits input tensor dimension i on mesh
+  // mesh axis x if:
+  // 1.  tgt_layout contains x at position i
+  // 2.  src_layout is unsharded at position i.
+  // 3.  src_layout does not contain mesh axis x.
+  // This produces intermediate layout 1.
+  // Next an all concat is performed on any axis in the intermediate layout 1
+  // that does not agree with the sharding on the output axis.
+  // This produces intermediate layout 2.
+  // A split is performed from intermediate layout 2 to the tgt layout.
+
+  if (src_layout == tgt_layout) {
+    return input;
+  }
+
+  mlir::OpBuilder builder(input.getContext());
+  TF_RETURN_IF_ERROR(SetBuilderInsertionAfterValue(input, builder));
+
+  // Save whether the input is from a SparseToDenseOp. If it is, then we will
+  // emit a DenseToSparse and a SparseToDense op.
+  bool is_sparse = IsSparseValue(input);
+
+  // TODO(tmorris): support all-to-all for sparse inputs.
+  TF_ASSIGN_OR_RETURN(
+      const RelayoutPlan plan,
+      GetRelayoutPlan(src_layout, tgt_layout,
+                      /*allow_all_to_all=*/EnableAllToAllForRelayout() &&
+                          !is_sparse));
+  // If two layouts are the same, or the only difference is layout type, then
+  // there is no need to actually relayout data.
+  if (plan.kind == RelayoutPlan::Kind::kIdentity) {
+    mlir::TF::IdentityOp op = builder.create<mlir::TF::IdentityOp>(
+        input.getLoc(), input.getType(), input);
+    if (newly_created_ops != nullptr) newly_created_ops->insert(op);
+    return op.getOutput();
+  }
+
+  if (!mlir::isa<mlir::RankedTensorType>(input.getType()))
+    return errors::Internal(
+        "attempting to relayout a tensor that does not "
+        "have a rank");
+
+  if (plan.kind == RelayoutPlan::Kind::kAllToAll) {
+    TF_ASSIGN_OR_RETURN(mlir::Value all_to_all_result,
+                        EmitAllToAll(builder, input, src_layout, tgt_layout,
+                                     newly_created_ops));
+    return all_to_all_result;
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      mlir::Value split_result,
+      EmitAllScatter(builder, input, src_layout, plan.intermediate_layout_1,
+                     newly_created_ops));
 
   TF_ASSIGN_OR_RETURN(
       mlir::Value concat_result,
-      EmitAllGather(builder, split_result, intermediate_layout_1,
-                    intermediate_layout_2, newly_created_ops));
+      EmitAllGather(builder, split_result, plan.intermediate_layout_1,
+                    plan.intermediate_layout_2, newly_created_ops));
 
   auto all_scatter =
-      EmitAllScatter(builder, concat_result, intermediate_layout_2, tgt_layout,
-                     newly_created_ops);
+      EmitAllScatter(builder, concat_result, plan.intermediate_layout_2,
+                     tgt_layout, newly_created_ops);
 
   if (!is_sparse) return all_scatter;
   if (!all_scatter.ok()) return all_scatter;
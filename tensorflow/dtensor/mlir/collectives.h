@@ -51,6 +51,29 @@ StatusOr<const mlir::Value> EmitAllScatter(
     const Layout& original_layout, const Layout& desired_layout,
     llvm::SmallPtrSet<mlir::Operation*, 4>* newly_created_ops = nullptr);
 
+// The collectives EmitRelayout emits to move a value between two layouts of
+// one mesh.
+struct RelayoutPlan {
+  enum class Kind {
+    // The layouts shard the tensor identically; only an Identity is emitted.
+    kIdentity,
+    // A single all-to-all.
+    kAllToAll,
+    // A local split to `intermediate_layout_1`, an all-gather to
+    // `intermediate_layout_2` and a local split to the target layout.
+    kScatterGatherScatter,
+  };
+  Kind kind = Kind::kIdentity;
+  Layout intermediate_layout_1;
+  Layout intermediate_layout_2;
+};
+
+// Returns the plan to relayout from `src_layout` to `tgt_layout`, which must
+// be layouts of the same rank on the same mesh unless they are equivalent.
+StatusOr<RelayoutPlan> GetRelayoutPlan(const Layout& src_layout,
+                                       const Layout& tgt_layout,
+                                       bool allow_all_to_all);
+
 // Emits splits and calls EmitAllGather (once) to relayout from the src layout
 // to the tgt layout on a single mesh.
 // Shape of input is expected to be the local shape for src_layout.
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/mlir/collectives.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/dtensor/cc/dstatus.h"
+#include "tensorflow/dtensor/cc/tensor_layout.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+Layout MakeLayout(const std::string& sharding_specs) {
+  return Layout::FromString(
+             absl::StrCat("sharding_specs:", sharding_specs,
+                          ", mesh:|x=2,y=2|*CPU"))
+      .value();
+}
+
+TEST(RelayoutPlanTest, EquivalentLayoutsAreIdentity) {
+  const Layout layout = MakeLayout("x,unsharded");
+  StatusOr<RelayoutPlan> plan =
+      GetRelayoutPlan(layout, layout, /*allow_all_to_all=*/true);
+  TF_ASSERT_OK(plan.status());
+  EXPECT_EQ(plan->kind, RelayoutPlan::Kind::kIdentity);
+}
+
+TEST(RelayoutPlanTest, MovedShardingUsesAllToAll) {
+  StatusOr<RelayoutPlan> plan =
+      GetRelayoutPlan(MakeLayout("x,unsharded"), MakeLayout("unsharded,x"),
+                      /*allow_all_to_all=*/true);
+  TF_ASSERT_OK(plan.status());
+  EXPECT_EQ(plan->kind, RelayoutPlan::Kind::kAllToAll);
+}
+
+TEST(RelayoutPlanTest, MovedShardingGathersWithoutAllToAll) {
+  StatusOr<RelayoutPlan> plan =
+      GetRelayoutPlan(MakeLayout("x,unsharded"), MakeLayout("unsharded,x"),
+                      /*allow_all_to_all=*/false);
+  TF_ASSERT_OK(plan.status());
+  EXPECT_EQ(plan->kind, RelayoutPlan::Kind::kScatterGatherScatter);
+  EXPECT_EQ(plan->intermediate_layout_1.sharding_spec_strs(),
+            MakeLayout("x,unsharded").sharding_spec_strs());
+  EXPECT_EQ(plan->intermediate_layout_2.sharding_spec_strs(),
+            MakeLayout("unsharded,unsharded").sharding_spec_strs());
+}
+
+TEST(RelayoutPlanTest, NewShardingIsSplitBeforeGather) {
+  StatusOr<RelayoutPlan> plan =
+      GetRelayoutPlan(MakeLayout("x,unsharded"), MakeLayout("unsharded,y"),
+                      /*allow_all_to_all=*/true);
+  TF_ASSERT_OK(plan.status());
+  EXPECT_EQ(plan->kind, RelayoutPlan::Kind::kScatterGatherScatter);
+  EXPECT_EQ(plan->intermediate_layout_1.sharding_spec_strs(),
+            MakeLayout("x,y").sharding_spec_strs());
+  EXPECT_EQ(plan->intermediate_layout_2.sharding_spec_strs(),
+            MakeLayout("unsharded,y").sharding_spec_strs());
+}
+
+TEST(RelayoutPlanTest, RejectsDifferentRanks) {
+  EXPECT_FALSE(GetRelayoutPlan(MakeLayout("x,unsharded"), MakeLayout("x"),
+                               /*allow_all_to_all=*/true)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
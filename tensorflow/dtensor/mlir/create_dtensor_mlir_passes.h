@@ -58,6 +58,9 @@ CreateDTensorAllReduceCombineOptimization();
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
 CreateDTensorMixedPrecisionReducePass();
 
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateDTensorCommunicationCostReport();
+
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
 CreateDTensorSetDefaultSharding();
 
@@ -0,0 +1,222 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "llvm/Support/Casting.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
+#include "mlir/IR/Matchers.h"  // from @llvm-project
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/IR/Value.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "mlir/Support/LLVM.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/ir/tf_ops.h"
+#include "tensorflow/dtensor/cc/dtensor_utils.h"
+#include "tensorflow/dtensor/cc/tensor_layout.h"
+#include "tensorflow/dtensor/mlir/ir/tf_dtensor.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+namespace {
+#define GEN_PASS_DEF_DTENSORCOMMUNICATIONCOSTREPORT
+#include "tensorflow/dtensor/mlir/dtensor_passes.h.inc"
+
+// Fixed cost of launching a collective, added to the time it takes to move its
+// bytes over the interconnect.
+constexpr double kCollectiveLatencyUs = 10.0;
+
+// Estimated cost of one collective for each participating device.
+struct CollectiveCost {
+  int64_t group_size = 1;
+  int64_t bytes = 0;
+  double time_us = 0.0;
+};
+
+// Returns the size in bytes of the local tensor of `value`, or 0 if it does not
+// have a static shape.
+int64_t LocalBytes(mlir::Value value) {
+  auto type = mlir::dyn_cast<mlir::RankedTensorType>(value.getType());
+  if (!type || !type.hasStaticShape()) return 0;
+  mlir::Type element_type = type.getElementType();
+  int64_t element_bits = 0;
+  if (auto complex_type = mlir::dyn_cast<mlir::ComplexType>(element_type)) {
+    element_type = complex_type.getElementType();
+    element_bits = 2 * element_type.getIntOrFloatBitWidth();
+  } else if (element_type.isIntOrFloat()) {
+    element_bits = element_type.getIntOrFloatBitWidth();
+  }
+  return type.getNumElements() * ((element_bits + 7) / 8);
+}
+
+// Returns the number of devices exchanging shards of a tensor changing from
+// `input_layout` to `output_layout`, i.e. the product of the sizes of the mesh
+// dimensions that stop sharding a tensor dimension.
+int64_t RelayoutGroupSize(const Layout& input_layout,
+                          const Layout& output_layout) {
+  int64_t group_size = 1;
+  for (int i = 0; i < input_layout.rank() && i < output_layout.rank(); ++i) {
+    const std::string& spec = input_layout.sharding_spec(i);
+    if (Layout::IsUnshardedDimension(spec) ||
+        spec == output_layout.sharding_spec(i)) {
+      continue;
+    }
+    StatusOr<int64> dim_size = input_layout.mesh().dim_size(spec);
+    if (dim_size.ok()) group_size *= *dim_size;
+  }
+  return group_size;
+}
+
+// Returns the reduction group size from the group_assignment operand, which is
+// a [num_groups, group_size] constant.
+template <class ReduceOpType>
+int64_t ReductionGroupSize(ReduceOpType reduce_op) {
+  mlir::DenseIntElementsAttr group_assignment;
+  if (!matchPattern(reduce_op.getGroupAssignment(),
+                    m_Constant(&group_assignment)) ||
+      group_assignment.getType().getRank() != 2) {
+    return 1;
+  }
+  return group_assignment.getType().getShape()[1];
+}
+
+// Estimates the cost of a ring implementation of the collective: each device
+// sends and receives (group_size - 1) / group_size of the `full_bytes` once for
+// gathers, scatters and all-to-alls, and twice for all-reduces.
+CollectiveCost EstimateCost(int64_t group_size, int64_t full_bytes,
+                            int passes) {
+  CollectiveCost cost;
+  cost.group_size = group_size;
+  if (group_size <= 1) return cost;
+  cost.bytes = passes * full_bytes * (group_size - 1) / group_size;
+  cost.time_us = kCollectiveLatencyUs +
+                 cost.bytes / (InterconnectBandwidthGbps() * 1e3);
+  return cost;
+}
+
+// Returns the index of the function argument `value` is read from, if any.
+std::optional<int> SourceArgument(mlir::Value value) {
+  while (mlir::Operation* op = value.getDefiningOp()) {
+    if (auto identity = llvm::dyn_cast<mlir::TF::IdentityOp>(op)) {
+      value = identity.getInput();
+    } else if (auto read = llvm::dyn_cast<mlir::TF::ReadVariableOp>(op)) {
+      value = read.getResource();
+    } else {
+      return std::nullopt;
+    }
+  }
+  auto arg = mlir::dyn_cast<mlir::BlockArgument>(value);
+  if (!arg || !llvm::isa<mlir::func::FuncOp>(arg.getOwner()->getParentOp())) {
+    return std::nullopt;
+  }
+  return arg.getArgNumber();
+}
+
+// MLIR pass that estimates the communication cost of the DTensor collectives
+// generated by SPMD expansion and suggests argument layouts that avoid
+// relayouts.
+struct DTensorCommunicationCostReport
+    : public impl::DTensorCommunicationCostReportBase<
+          DTensorCommunicationCostReport> {
+  void runOnOperation() override {
+    mlir::func::FuncOp function = getOperation();
+    int num_collectives = 0;
+    int64_t total_bytes = 0;
+    double total_time_us = 0.0;
+    std::string suggestions;
+
+    auto report = [&](mlir::Operation* op, const CollectiveCost& cost,
+                      mlir::Value input,
+                      const std::optional<Layout>& output_layout) {
+      if (cost.bytes == 0) return;
+      ++num_collectives;
+      total_bytes += cost.bytes;
+      total_time_us += cost.time_us;
+      std::string message = absl::StrFormat(
+          "%s moves %d bytes per device in groups of %d (estimated %.1fus)",
+          op->getName().stripDialect().str(), cost.bytes, cost.group_size,
+          cost.time_us);
+      std::optional<int> arg = SourceArgument(input);
+      if (arg.has_value() && output_layout.has_value()) {
+        const std::string suggestion = absl::StrCat(
+            "argument ", *arg, " with layout ", output_layout->ToString());
+        absl::StrAppend(&message, "; avoidable with ", suggestion);
+        absl::StrAppend(&suggestions, "\n  ", suggestion);
+      }
+      op->emitRemark(message);
+    };
+
+    function.walk([&](mlir::Operation* op) {
+      if (auto gather = llvm::dyn_cast<mlir::TF::DTensorAllGatherOp>(op)) {
+        const Layout output_layout = gather.getOutputLayout();
+        report(op,
+               EstimateCost(
+                   RelayoutGroupSize(gather.getInputLayout(), output_layout),
+                   LocalBytes(gather.getOutput()), /*passes=*/1),
+               gather.getInput(), output_layout);
+      } else if (auto all_to_all =
+                     llvm::dyn_cast<mlir::TF::DTensorAllToAllOp>(op)) {
+        const Layout output_layout = all_to_all.getOutputLayout();
+        report(op,
+               EstimateCost(RelayoutGroupSize(all_to_all.getInputLayout(),
+                                              output_layout),
+                            LocalBytes(all_to_all.getInput()), /*passes=*/1),
+               all_to_all.getInput(), output_layout);
+      } else if (auto reduce =
+                     llvm::dyn_cast<mlir::TF::DTensorAllReduceOp>(op)) {
+        report(op,
+               EstimateCost(ReductionGroupSize(reduce),
+                            LocalBytes(reduce.getInput()), /*passes=*/2),
+               reduce.getInput(), std::nullopt);
+      } else if (auto reduce_scatter =
+                     llvm::dyn_cast<mlir::TF::DTensorReduceScatterOp>(op)) {
+        report(op,
+               EstimateCost(ReductionGroupSize(reduce_scatter),
+                            LocalBytes(reduce_scatter.getInput()),
+                            /*passes=*/1),
+               reduce_scatter.getInput(), std::nullopt);
+      }
+    });
+    if (num_collectives == 0) return;
+
+    const std::string summary = absl::StrFormat(
+        "%d collectives move %d bytes per device per step (estimated "
+        "communication time %.1fus)",
+        num_collectives, total_bytes, total_time_us);
+    function.emitRemark(summary);
+    LOG(INFO) << "DTensor communication cost of " << function.getSymName().str()
+              << ": " << summary
+              << (suggestions.empty() ? "" : ". Suggested layouts:")
+              << suggestions;
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateDTensorCommunicationCostReport() {
+  return std::make_unique<DTensorCommunicationCostReport>();
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
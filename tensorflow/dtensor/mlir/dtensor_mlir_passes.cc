@@ -226,6 +226,13 @@ void CreateDTensorMLIRPass(const mlir::TF::StandardPipelineOptions &options,
   // const only had one usage) as part of layout propagation.
   pm->addPass(mlir::createCSEPass());
 
+  // Report the estimated cost of the collectives generated by SPMD expansion,
+  // before they are optimized and lowered.
+  if (ReportCommunicationCost()) {
+    pm->addNestedPass<mlir::func::FuncOp>(
+        CreateDTensorCommunicationCostReport());
+  }
+
   // Lower the AllGather collectives. This has to happen before the all reduce
   // optimizations and AllGather may emit an AllReduce.
   pm->addPass(CreateDTensorAllGatherLoweringPass());
@@ -511,6 +511,86 @@ class MultiMeshTest(test_util.DTensorBaseTest):
     api.check_layout(output1, replicated_layout_on_a)
     api.check_layout(output2, replicated_layout_on_b)
 
+  def testMultiMeshFunctionLibrary(self):
+    device_ids = test_util.create_device_ids_array((2,))
+    cpu_mesh_a = Mesh(
+        ['x'],
+        device_ids,
+        np.ravel(device_ids).tolist(),
+        test_util.create_device_list((2,), 'CPU'),
+    )
+    cpu_mesh_b = Mesh(
+        ['y'],
+        device_ids,
+        np.ravel(device_ids).tolist(),
+        test_util.create_device_list((2,), 'CPU'),
+    )
+    replicated_layout_on_a = Layout.replicated(cpu_mesh_a, rank=1)
+    replicated_layout_on_b = Layout.replicated(cpu_mesh_b, rank=1)
+
+    @polymorphic_function.function
+    def func(t1, t2):
+      t1 = math_ops.cast(t1, dtypes.float32)
+      return t1 * t1, t2 + 1
+
+    def run_and_get_mesh_functions(size):
+      # The function of each mesh is added to the library with a unique
+      # number, in the order of the meshes.
+      a = api.copy_to_mesh(
+          np.arange(size, dtype=np.int32), replicated_layout_on_a
+      )
+      b = api.copy_to_mesh(
+          np.arange(size, dtype=np.int32), replicated_layout_on_b
+      )
+      ctx = context.context()
+      existing_names = ctx.list_function_names()
+      with ops.device_v2(api.device_name()):
+        output1, output2 = func(a, b)
+      api.check_layout(output1, replicated_layout_on_a)
+      api.check_layout(output2, replicated_layout_on_b)
+      self.assertDTensorEqual(
+          np.arange(size, dtype=np.float32) ** 2,
+          replicated_layout_on_a,
+          output1,
+      )
+      self.assertDTensorEqual(
+          np.arange(size, dtype=np.int32) + 1, replicated_layout_on_b, output2
+      )
+
+      mesh_functions = {}
+      for name in ctx.list_function_names() - existing_names:
+        function_def = ctx.get_function_def(name)
+        # DTensor sets `_XlaMustCompile` on the function of each mesh.
+        if '_XlaMustCompile' in function_def.attr:
+          self.assertEqual(name, function_def.signature.name)
+          mesh_functions[int(name.rsplit('_', 1)[1])] = function_def
+      numbers = sorted(mesh_functions)
+      self.assertLen(numbers, 2)
+      self.assertEqual(numbers, list(range(numbers[0], numbers[0] + 2)))
+      return [mesh_functions[number] for number in numbers]
+
+    # Inputs of another shape lower the program again.
+    first_functions = run_and_get_mesh_functions(4)
+    second_functions = run_and_get_mesh_functions(8)
+    self.assertNotEqual(
+        [f.signature.name for f in first_functions],
+        [f.signature.name for f in second_functions],
+    )
+    for first, second in zip(first_functions, second_functions):
+      self.assertEqual(
+          [arg.type for arg in first.signature.output_arg],
+          [arg.type for arg in second.signature.output_arg],
+      )
+      self.assertCountEqual(
+          [node.op for node in first.node_def],
+          [node.op for node in second.node_def],
+      )
+    # The meshes return different types, so the functions are not swapped.
+    self.assertNotEqual(
+        [arg.type for arg in first_functions[0].signature.output_arg],
+        [arg.type for arg in first_functions[1].signature.output_arg],
+    )
+
   def testFunctionWithMultiMeshInputOutputs(self):
     self.skipForDeviceType(
         ['CPU'],
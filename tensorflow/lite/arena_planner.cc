@@ -37,16 +37,20 @@ constexpr int32_t kScalarTensorBytes = 4;
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_all_tensors, int tensor_alignment,
-                           int subgraph_index)
+                           int subgraph_index, float arena_growth_factor)
     : context_(context),
       graph_info_(std::move(graph_info)),
-      arena_(kDefaultArenaAlignment, subgraph_index),
+      arena_(kDefaultArenaAlignment, subgraph_index, arena_growth_factor),
       has_nonpersistent_memory_(false),
       persistent_arena_(kDefaultArenaAlignment, subgraph_index),
       preserve_all_tensors_(preserve_all_tensors),
       tensor_alignment_(tensor_alignment),
       last_active_node_(kLastActiveNodeUndefined) {}
 
+void ArenaPlanner::SetOfflineOffsets(std::vector<int32_t> offsets) {
+  offline_offsets_ = std::move(offsets);
+}
+
 ArenaPlanner::~ArenaPlanner() {
   arena_.ReleaseBuffer();
   persistent_arena_.ReleaseBuffer();
@@ -156,6 +160,9 @@ bool ArenaPlanner::InputTensorCanBeShared(const TfLiteTensor& input_tensor,
 // Subgraph inputs and outputs cannot be shared.
 void ArenaPlanner::IdentifyInPlaceTensors() {
   actual_tensor_id_.clear();
+  // An input may still be read by a node running at the same time as the node
+  // overwriting it.
+  if (has_concurrent_nodes_) return;
   const int num_execution_nodes = graph_info_->num_execution_nodes();
   TfLiteTensor* tensors = graph_info_->tensors();
   for (int i = 0; i < num_execution_nodes; ++i) {
@@ -211,6 +218,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   nodes_to_tensors_.clear();
   nodes_to_tensors_.resize(
       std::max(graph_info_->num_execution_nodes(), (size_t)1), {});
+  TF_LITE_ENSURE_STATUS(CalculateStages());
 
   // Keeps track of references to each tensor.
   refcounts_.assign(num_tensors, 0);
@@ -333,6 +341,39 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   }
   // Note that graph outputs will never be scheduled for deallocation. We
   // could do that here for completeness, but it won't have any effect.
+  if (has_concurrent_nodes_) {
+    for (size_t i = 0; i < num_tensors; ++i) {
+      if (alloc_node_[i] != kNodeNotAssigned) {
+        alloc_node_[i] = stage_first_node_[alloc_node_[i]];
+      }
+      if (dealloc_node_[i] != kNodeNotAssigned) {
+        dealloc_node_[i] = stage_last_node_[dealloc_node_[i]];
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus ArenaPlanner::CalculateStages() {
+  const int num_execution_nodes = graph_info_->num_execution_nodes();
+  stage_first_node_.resize(num_execution_nodes);
+  stage_last_node_.resize(num_execution_nodes);
+  has_concurrent_nodes_ = false;
+  int first_node = 0;
+  for (int i = 1; i <= num_execution_nodes; ++i) {
+    if (i < num_execution_nodes) {
+      const int stage = graph_info_->node_stage(i);
+      const int previous_stage = graph_info_->node_stage(i - 1);
+      TF_LITE_ENSURE(context_, stage >= previous_stage);
+      if (stage == previous_stage) continue;
+    }
+    for (int j = first_node; j < i; ++j) {
+      stage_first_node_[j] = first_node;
+      stage_last_node_[j] = i - 1;
+    }
+    has_concurrent_nodes_ |= i - first_node > 1;
+    first_node = i;
+  }
   return kTfLiteOk;
 }
 
@@ -352,10 +393,14 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
+      alloc_node_[tensor_index] = has_concurrent_nodes_
+                                      ? stage_first_node_[i]
+                                      : static_cast<int32_t>(i);
       nodes_to_tensors_[i].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = has_concurrent_nodes_
+                                          ? stage_last_node_[i]
+                                          : static_cast<int32_t>(i);
       }
     }
   }
@@ -509,6 +554,9 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
+  // Whether the whole non-persistent arena is planned again, in which case
+  // the unchanged beginning of the previous plan can be reused.
+  const bool from_scratch = first_node == 0 && first_node < last_active_node_;
   if (first_node < last_active_node_) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
@@ -518,6 +566,17 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     arena_.PurgeActiveAllocs(first_node);
   }
   CreateTensorAllocationVector(tensors_allocated);
+  // Placed at the offsets planned offline, if these are valid for the current
+  // tensor sizes.
+  std::vector<bool> offline_placed;
+  if (from_scratch && !offline_offsets_.empty()) {
+    PlaceOfflineTensors(*tensors_allocated, &offline_placed);
+  }
+  // The previous plan doesn't include the tensors placed offline.
+  const bool record_plan = from_scratch && offline_placed.empty();
+  if (from_scratch && !record_plan) planned_allocs_.clear();
+  bool reusing_plan = record_plan;
+  size_t num_planned = 0;
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
@@ -541,10 +600,31 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
+      if (!offline_placed.empty() && offline_placed[tensor_index]) continue;
+      if (reusing_plan) {
+        const ArenaAllocWithUsageInterval* planned =
+            num_planned < planned_allocs_.size()
+                ? &planned_allocs_[num_planned]
+                : nullptr;
+        if (planned != nullptr && planned->tensor == tensor_index &&
+            planned->size == tensor.bytes &&
+            planned->first_node == alloc_node_[tensor_index] &&
+            planned->last_node == dealloc_node_[tensor_index]) {
+          // `Allocate` only depends on the allocs made before, which are
+          // unchanged, so it would choose the same offset again.
+          allocs_[tensor_index] = *planned;
+          ++num_planned;
+          continue;
+        }
+        planned_allocs_.resize(num_planned);
+        arena_.RestoreAllocs(planned_allocs_);
+        reusing_plan = false;
+      }
       TF_LITE_ENSURE_STATUS(
           arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
                           tensor_index, alloc_node_[tensor_index],
                           dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      if (record_plan) planned_allocs_.push_back(allocs_[tensor_index]);
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -559,10 +639,59 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
   }
+  if (reusing_plan) {
+    // Every tensor matched the previous plan.
+    planned_allocs_.resize(num_planned);
+    arena_.RestoreAllocs(planned_allocs_);
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+void ArenaPlanner::PlaceOfflineTensors(
+    const std::vector<int32_t>& tensors_to_allocate,
+    std::vector<bool>* offline_placed) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  if (offline_offsets_.size() != graph_info_->num_tensors()) return;
+  std::vector<ArenaAllocWithUsageInterval> offline_allocs;
+  for (int32_t tensor_index : tensors_to_allocate) {
+    const TfLiteTensor& tensor = tensors[tensor_index];
+    const int32_t offset = offline_offsets_[tensor_index];
+    if (tensor.allocation_type != kTfLiteArenaRw || tensor.bytes == 0 ||
+        offset < 0 || actual_tensor_id_.count(tensor_index) > 0) {
+      continue;
+    }
+    if (offset % tensor_alignment_ != 0) return;
+    offline_allocs.emplace_back();
+    ArenaAllocWithUsageInterval& alloc = offline_allocs.back();
+    alloc.offset = offset;
+    alloc.size = tensor.bytes;
+    alloc.tensor = tensor_index;
+    alloc.first_node = alloc_node_[tensor_index];
+    alloc.last_node = dealloc_node_[tensor_index];
+  }
+  if (offline_allocs.empty()) return;
+
+  // The offsets were planned for the sizes the tensors had offline, so make
+  // sure that tensors used at the same time still don't overlap.
+  std::sort(offline_allocs.begin(), offline_allocs.end());
+  for (size_t i = 0; i < offline_allocs.size(); ++i) {
+    const ArenaAllocWithUsageInterval& a = offline_allocs[i];
+    for (size_t j = i + 1; j < offline_allocs.size() &&
+                           offline_allocs[j].offset < a.offset + a.size;
+         ++j) {
+      const ArenaAllocWithUsageInterval& b = offline_allocs[j];
+      if (a.first_node <= b.last_node && b.first_node <= a.last_node) return;
+    }
+  }
+  arena_.RestoreAllocs(offline_allocs);
+  offline_placed->assign(graph_info_->num_tensors(), false);
+  for (const ArenaAllocWithUsageInterval& alloc : offline_allocs) {
+    allocs_[alloc.tensor] = alloc;
+    (*offline_placed)[alloc.tensor] = true;
+  }
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
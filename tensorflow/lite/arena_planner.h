@@ -50,10 +50,11 @@ class ArenaPlanner : public MemoryPlanner {
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. The inputs to the graph will not share
   // memory with any other tensor, effectively preserving them until the end
-  // of inference.
+  // of inference. The non-persistent arena is grown by at least
+  // `arena_growth_factor` when it has to be reallocated.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_all_tensors, int tensor_alignment,
-               int subgraph_index = 0);
+               int subgraph_index = 0, float arena_growth_factor = 1.0f);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -72,6 +73,12 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Sets the offsets of the tensors in the non-persistent arena planned
+  // offline, one per tensor, -1 for the tensors planned at runtime (see
+  // offline_memory_plan.h). The offsets are used whenever they are valid for
+  // the current tensor sizes, and the other tensors are placed around them.
+  void SetOfflineOffsets(std::vector<int32_t> offsets);
+
  private:
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
@@ -83,6 +90,10 @@ class ArenaPlanner : public MemoryPlanner {
   // Identify tensors which can share memory with another.
   void IdentifyInPlaceTensors();
 
+  // Computes the first and last node of the stage of each node (see
+  // `GraphInfo::node_stage`).
+  TfLiteStatus CalculateStages();
+
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
   TfLiteStatus Commit(bool* arena_reallocated);
@@ -104,6 +115,13 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus CalculateAllocations(int first_node, int last_node,
                                     std::vector<int32_t>* tensors_allocated);
 
+  // Places the tensors of `tensors_to_allocate` which have an offline offset
+  // in the non-persistent arena, and marks them in `offline_placed`. Does
+  // nothing if the offline offsets are not valid for the current tensor
+  // sizes.
+  void PlaceOfflineTensors(const std::vector<int32_t>& tensors_to_allocate,
+                           std::vector<bool>* offline_placed);
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int32_t tensor_index,
@@ -126,6 +144,16 @@ class ArenaPlanner : public MemoryPlanner {
   // Stores allocation data for all tensors.
   std::vector<ArenaAllocWithUsageInterval> allocs_;
 
+  // The non-persistent allocs of the last plan made from the first node, in
+  // the order they were allocated. When the arena is planned again, e.g.
+  // after an input was resized, the allocs are reused until the first tensor
+  // whose size or usage interval changed, and only the following tensors are
+  // placed again.
+  std::vector<ArenaAllocWithUsageInterval> planned_allocs_;
+
+  // Offsets planned offline, one per tensor, or empty.
+  std::vector<int32_t> offline_offsets_;
+
   // Map of Tensors allocated by each node.
   // NOLINTNEXTLINE - absl::flat_hash_set increases binary size by 106kB.
   std::vector<std::unordered_set<int32_t>> nodes_to_tensors_;
@@ -138,6 +166,16 @@ class ArenaPlanner : public MemoryPlanner {
   // the node's operation.
   std::vector<int32_t> dealloc_node_;
 
+  // First and last node of the stage of each node. Nodes of the same stage may
+  // run at the same time, so a tensor used by one of them is allocated for the
+  // whole stage.
+  std::vector<int32_t> stage_first_node_;
+  std::vector<int32_t> stage_last_node_;
+
+  // True if a stage has more than one node, in which case no tensor is shared
+  // in place.
+  bool has_concurrent_nodes_ = false;
+
   // Raw memory buffer that is allocated for all temporary and graph outputs
   // that are declared kTfLiteArenaRw.
   SimpleMemoryArena arena_;
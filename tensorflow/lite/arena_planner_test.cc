@@ -148,6 +148,12 @@ class TestGraph {
     variables_ = variables;
   }
 
+  void SetStages(const std::vector<int>& stages) { stages_ = stages; }
+
+  int stage(size_t index) const {
+    return stages_.empty() ? static_cast<int>(index) : stages_[index];
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
@@ -163,6 +169,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<int> stages_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -189,6 +196,7 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  int node_stage(size_t index) const override { return graph_->stage(index); }
 
  private:
   TestGraph* graph_;
@@ -330,6 +338,159 @@ TEST_F(ArenaPlannerTest, SimpleGraph) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, ConcurrentNodesDontShareMemory) {
+  auto make_graph = [] {
+    return TestGraph({0},
+                     {
+                         /* in, out, tmp */
+                         {{0}, {1}, {}},     // First op
+                         {{1}, {2}, {5}},    // Second op
+                         {{0}, {3}, {6}},    // Third op
+                         {{2, 3}, {4}, {}},  // Fourth op
+                     },
+                     {4});
+  };
+  auto overlap = [this](int a, int b) {
+    const TfLiteTensor& tensor_a = (*graph_->tensors())[a];
+    const TfLiteTensor& tensor_b = (*graph_->tensors())[b];
+    return GetOffset(a) < GetOffset(b) + tensor_b.bytes &&
+           GetOffset(b) < GetOffset(a) + tensor_a.bytes;
+  };
+
+  // Run in order, the third op reuses the memory of the first op's output and
+  // of the second op's temporary.
+  TestGraph sequential_graph = make_graph();
+  SetGraph(&sequential_graph);
+  Execute(0, sequential_graph.nodes().size() - 1);
+  EXPECT_TRUE(overlap(1, 3) || overlap(5, 6) || overlap(1, 6));
+
+  // When the second and third ops may run at the same time, the tensors they
+  // use must not overlap.
+  TestGraph staged_graph = make_graph();
+  staged_graph.SetStages({0, 1, 1, 2});
+  SetGraph(&staged_graph);
+  Execute(0, staged_graph.nodes().size() - 1);
+  for (int a : {1, 2, 5}) {
+    for (int b : {3, 6}) {
+      EXPECT_FALSE(overlap(a, b)) << a << " " << b;
+    }
+  }
+}
+
+TEST_F(ArenaPlannerTest, DecreasingStagesAreRejected) {
+  TestGraph graph({0}, {{{0}, {1}, {}}, {{1}, {2}, {}}}, {2});
+  graph.SetStages({1, 0});
+  context_.ReportError = ReportError;
+  planner_ = std::make_unique<ArenaPlanner>(
+      &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(&graph)),
+      /*preserve_all_tensors=*/false, kTensorAlignment);
+  EXPECT_EQ(planner_->PlanAllocations(), kTfLiteError);
+}
+
+TEST_F(ArenaPlannerTest, ReplanAfterResizeMatchesFreshPlan) {
+  auto make_graph = [] {
+    return TestGraph({0, 1},
+                     {
+                         /* in, out, tmp */
+                         {{0, 1}, {2}, {6}},    // First op
+                         {{2, 0}, {4, 5}, {}},  // Second op
+                         {{4, 5}, {3}, {7}}     // Third op
+                     },
+                     {3});
+  };
+  auto resize = [](TestGraph* graph) {
+    std::vector<TfLiteTensor>& tensors = *graph->tensors();
+    tensors[4].bytes += 100;
+    tensors[5].bytes += 100;
+    tensors[3].bytes += 100;
+  };
+  TestGraph graph = make_graph();
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+
+  ResetAllocations();
+  resize(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < graph.tensors()->size(); ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+
+  // The same graph planned by a new planner.
+  TestGraph fresh = make_graph();
+  resize(&fresh);
+  SetGraph(&fresh);
+  Execute(0, fresh.nodes().size() - 1);
+  for (int i = 0; i < fresh.tensors()->size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+
+  // Planning again without any change gives the same offsets.
+  ResetAllocations();
+  Execute(0, fresh.nodes().size() - 1);
+  for (int i = 0; i < fresh.tensors()->size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+}
+
+TEST_F(ArenaPlannerTest, UsesOfflineOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  // Tensor 3 is left to the runtime planner.
+  const std::vector<int32_t> offsets = {100, 0, 40, -1, 20, 60};
+  planner_->SetOfflineOffsets(offsets);
+  Execute(0, graph.nodes().size() - 1);
+
+  for (int i : {0, 1, 2, 4, 5}) {
+    EXPECT_EQ(GetOffset(i), offsets[i]) << "tensor " << i;
+  }
+  // Tensor 3 is placed around the tensors used at the same time.
+  for (int i : {0, 1, 4, 5}) {
+    const TfLiteTensor& tensor = (*graph.tensors())[i];
+    const TfLiteTensor& tensor_3 = (*graph.tensors())[3];
+    EXPECT_TRUE(GetOffset(3) + tensor_3.bytes <= GetOffset(i) ||
+                GetOffset(i) + tensor.bytes <= GetOffset(3))
+        << "tensor " << i;
+  }
+}
+
+TEST_F(ArenaPlannerTest, IgnoresInvalidOfflineOffsets) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  for (const std::vector<int32_t>& offsets :
+       std::vector<std::vector<int32_t>>{
+           // Tensors 4 and 5 are used at the same time but overlap.
+           {100, 0, 40, -1, 20, 24},
+           // Tensor 0 is not aligned.
+           {101, 0, 40, -1, 20, 60},
+           // The offsets are for a different graph.
+           {100, 0, 40}}) {
+    SetGraph(&graph);
+    planner_->SetOfflineOffsets(offsets);
+    Execute(0, graph.nodes().size() - 1);
+
+    // The plan of SimpleGraph.
+    EXPECT_EQ(GetOffset(5), 12);
+    EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+    EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+    EXPECT_EQ(GetOffset(2), GetOffsetAfter(4));
+    EXPECT_EQ(GetOffset(1), 4);
+  }
+}
+
 TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   TestGraph graph({0, 1},
                   {
@@ -38,6 +38,11 @@ class AsyncSignatureRunnerTest;
 //
 // Async version of SignatureRunner class for running TFLite models using
 // SignatureDef.
+//
+// Signatures that are not fully delegated to an async backend run on the CPU,
+// with `kTfLiteBufferTypeHostMemory` buffers. Their executions are queued, so
+// that applications can fill the buffers of the next task while the current
+// one runs.
 class AsyncSignatureRunner {
  public:
   // Builds the AsyncSignatureRunner given the provided signature_def and
@@ -14,10 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/core/async/async_subgraph.h"
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/async/async_kernel_internal.h"
 #include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
 #include "tensorflow/lite/core/async/task_internal.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -70,25 +72,26 @@ TfLiteAsyncKernel* AsyncSubgraph::async_kernel() const { return async_kernel_; }
 
 AsyncSubgraph::AsyncSubgraph(Subgraph* subgraph) : subgraph_(subgraph) {
   // Currently we only support one delegate and fully delegated subgraph.
+  // Other subgraphs run on the CPU.
   if (!IsFullyDelegated()) {
-    subgraph->ReportError("Model is not fully delegated by 1 backend.");
-    return;
-  }
-
-  // Ensured by `IsFullyDelegated`, there's only 1 node in execution plan.
-  auto node_index = subgraph_->execution_plan()[0];
-  TfLiteNode& node = subgraph_->nodes_and_registration_[node_index].first;
-  const TfLiteRegistration& registration =
-      subgraph_->nodes_and_registration_[node_index].second;
-  async_kernel_ = GetAsyncKernel(context(), registration, node);
-  if (!async_kernel_) {
-    subgraph->ReportError("Backend does not support asynchronous execution.");
-    return;
+    cpu_kernel_ = std::make_unique<CpuAsyncKernel>(subgraph);
+    async_kernel_ = cpu_kernel_->kernel();
+  } else {
+    // Ensured by `IsFullyDelegated`, there's only 1 node in execution plan.
+    auto node_index = subgraph_->execution_plan()[0];
+    TfLiteNode& node = subgraph_->nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        subgraph_->nodes_and_registration_[node_index].second;
+    async_kernel_ = GetAsyncKernel(context(), registration, node);
+    if (!async_kernel_) {
+      subgraph->ReportError("Backend does not support asynchronous execution.");
+      return;
+    }
+    // TODO(b/191883048): Add AsyncSubgraph as friend class of Subgraph and
+    // remove the const cast.
+    opaque_node_ =
+        reinterpret_cast<TfLiteOpaqueNode*>(const_cast<TfLiteNode*>(&node));
   }
-  // TODO(b/191883048): Add AsyncSubgraph as friend class of Subgraph and
-  // remove the const cast.
-  opaque_node_ =
-      reinterpret_cast<TfLiteOpaqueNode*>(const_cast<TfLiteNode*>(&node));
 #define POPULATE_VECTOR(io_type, accessor, dest)                          \
   {                                                                       \
     const char* const* types = nullptr;                                   \
@@ -17,10 +17,12 @@ limitations under the License.
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/async/async_kernel_internal.h"
 #include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
 #include "tensorflow/lite/core/async/interop/c/types.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -33,7 +35,8 @@ namespace async {
 class AsyncSubgraphTestPeer;
 
 // AsyncSubgraph class manages to dispatch I/O information and
-// schedule executions to underlying delegate kernels.
+// schedule executions to underlying delegate kernels. Subgraphs that are not
+// fully delegated to an async backend run on the CPU, see CpuAsyncKernel.
 // TODO(b/191883048): Currently we require either `AllocateTensors` or
 // `EnsureTensorAllocation` called to ensure the backend kernels are prepared.
 // However, we don't need to allocate the CPU memory for input / output tensors.
@@ -187,9 +190,12 @@ class AsyncSubgraph {
   std::map<TfLiteIoType, std::vector<const char*>> supported_synchronizations_;
 
   // Currently AsyncSubgraph only support fully delegated by 1 backend case.
-  // Not owned.
+  // Not owned, unless the subgraph runs on the CPU.
   mutable TfLiteAsyncKernel* async_kernel_ = nullptr;
   TfLiteOpaqueNode* opaque_node_ = nullptr;
+
+  // Set if the subgraph runs on the CPU.
+  std::unique_ptr<CpuAsyncKernel> cpu_kernel_;
 };
 
 }  // namespace async
@@ -0,0 +1,597 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#ifdef __linux__
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#ifdef __ANDROID__
+#include "tensorflow/lite/delegates/gpu/android_hardware_buffer.h"
+#endif  // __ANDROID__
+
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/logger.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace async {
+namespace {
+
+#ifdef __ANDROID__
+using ::tflite::gpu::OptionalAndroidHardwareBuffer;
+#endif  // __ANDROID__
+
+// Returns true if `attrs` names no type or `expected_type`. Otherwise sets
+// the type in `conflict`, if any.
+bool HasType(const TfLiteAttributeMap* attrs, const char* expected_type,
+             TfLiteAttributeMap* conflict) {
+  // Buffer and sync attribute maps both name their type with key 1.
+  static_assert(static_cast<int>(kTfLiteBufferAttrKeyResourceTypeName) ==
+                static_cast<int>(kTfLiteSynchronizationAttrKeyObjectTypeName));
+  const char* type = nullptr;
+  if (!attrs->impl.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &type) ||
+      strcmp(type, expected_type) == 0) {
+    return true;
+  }
+  if (conflict != nullptr) {
+    conflict->impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName, type);
+  }
+  return false;
+}
+
+// Returns the entry of `types` equal to `type`, or nullptr.
+const char* FindType(const std::vector<const char*>& types, const char* type) {
+  for (const char* supported : types) {
+    if (strcmp(supported, type) == 0) return supported;
+  }
+  return nullptr;
+}
+
+// Waits for the device accesses to a dmabuf to complete before the CPU
+// accesses it, or flushes the CPU accesses, depending on `flags`.
+TfLiteStatus SyncDmaBuf(int fd, uint64_t flags) {
+#ifdef __linux__
+  dma_buf_sync sync = {flags};
+  int result;
+  do {
+    result = ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync);
+  } while (result != 0 && (errno == EINTR || errno == EAGAIN));
+  if (result == 0) return kTfLiteOk;
+  TFLITE_LOG(TFLITE_LOG_ERROR, "Cannot sync dmabuf %d: %s.", fd,
+             strerror(errno));
+#endif  // __linux__
+  return kTfLiteError;
+}
+
+}  // namespace
+
+CpuAsyncKernel::CpuAsyncKernel(Subgraph* subgraph) : subgraph_(subgraph) {
+  supported_buffer_types_.push_back(kTfLiteBufferTypeHostMemory);
+#ifdef __ANDROID__
+  if (OptionalAndroidHardwareBuffer::Instance().Supported()) {
+    supported_buffer_types_.push_back(kTfLiteBufferTypeAHardwareBufferBlob);
+  }
+#endif  // __ANDROID__
+#ifdef __linux__
+  supported_buffer_types_.push_back(kTfLiteBufferTypeDmaBuf);
+#endif  // __linux__
+}
+
+CpuAsyncKernel::~CpuAsyncKernel() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (worker_.joinable()) worker_.join();
+  for (const auto& [handle, buffer] : buffers_) ReleaseBuffer(buffer);
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBuffer(TfLiteOpaqueContext* context,
+                                            TfLiteIoType io_type,
+                                            const TfLiteBackendBuffer* buffer,
+                                            const TfLiteAttributeMap* attrs,
+                                            TfLiteBufferHandle handle) {
+  const char* type = kTfLiteBufferTypeHostMemory;
+  attrs->impl.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &type);
+  type = FindType(supported_buffer_types_, type);
+  void* ptr = TfLiteBackendBufferGetPtr(buffer);
+  Buffer registered;
+  registered.ptr = ptr;
+  const bool has_size =
+      attrs->impl.GetAttr(kTfLiteBufferAttrKeySize, &registered.size);
+
+  if (type == kTfLiteBufferTypeHostMemory) {
+    registered.base = static_cast<uint8_t*>(ptr);
+    if (!has_size || registered.base == nullptr) {
+      TFLITE_LOG(TFLITE_LOG_ERROR,
+                 "Only sized host memory buffers can be registered.");
+      return kTfLiteError;
+    }
+#ifdef __ANDROID__
+  } else if (type == kTfLiteBufferTypeAHardwareBufferBlob) {
+    registered.type = MemoryType::kAHardwareBuffer;
+    registered.ahwb = static_cast<AHardwareBuffer*>(ptr);
+    if (registered.ahwb == nullptr) return kTfLiteError;
+    AHardwareBuffer_Desc desc;
+    OptionalAndroidHardwareBuffer::Instance().Describe(registered.ahwb, &desc);
+    if (desc.format != AHARDWAREBUFFER_FORMAT_BLOB) {
+      TFLITE_LOG(TFLITE_LOG_ERROR,
+                 "Only AHardwareBuffers of format BLOB can be registered.");
+      return kTfLiteError;
+    }
+    registered.size = desc.width;
+    OptionalAndroidHardwareBuffer::Instance().Acquire(registered.ahwb);
+#endif  // __ANDROID__
+#ifdef __linux__
+  } else if (type == kTfLiteBufferTypeDmaBuf) {
+    registered.type = MemoryType::kDmaBuf;
+    const int fd = static_cast<int>(reinterpret_cast<intptr_t>(ptr));
+    if (!has_size || registered.size == 0 || fd < 0) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Only sized dmabufs can be registered.");
+      return kTfLiteError;
+    }
+    void* mapping = mmap(nullptr, registered.size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Cannot map dmabuf %d: %s.", fd,
+                 strerror(errno));
+      return kTfLiteError;
+    }
+    registered.base = static_cast<uint8_t*>(mapping);
+    // Keeps the dmabuf open for the syncs, even if the application closes
+    // its file descriptor.
+    registered.fd = dup(fd);
+    if (registered.fd < 0) {
+      munmap(mapping, registered.size);
+      return kTfLiteError;
+    }
+#endif  // __linux__
+  } else {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Unsupported buffer type.");
+    return kTfLiteError;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_[handle] = registered;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBufferSlice(
+    TfLiteOpaqueContext* context, TfLiteBufferHandle buffer_pool,
+    const TfLiteAttributeMap* attrs, TfLiteBufferHandle handle) {
+  size_t offset = 0;
+  size_t size = 0;
+  attrs->impl.GetAttr(kTfLiteBufferAttrKeyOffset, &offset);
+  if (!attrs->impl.GetAttr(kTfLiteBufferAttrKeySize, &size)) {
+    return kTfLiteError;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto pool = buffers_.find(buffer_pool);
+  if (pool == buffers_.end() || offset > pool->second.size ||
+      size > pool->second.size - offset) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Invalid slice of buffer %d.", buffer_pool);
+    return kTfLiteError;
+  }
+  if (!HasType(attrs, TypeName(pool->second), nullptr)) return kTfLiteError;
+  Buffer slice = pool->second;
+  slice.offset += offset;
+  slice.size = size;
+  slice.is_slice = true;
+  // Slices of slices count against the buffer owning the memory.
+  if (!pool->second.is_slice) slice.parent = buffer_pool;
+  slice.num_slices = 0;
+  ++buffers_[slice.parent].num_slices;
+  buffers_[handle] = slice;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::UnregisterBuffer(TfLiteOpaqueContext* context,
+                                              TfLiteBufferHandle handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = buffers_.find(handle);
+  if (it == buffers_.end()) return kTfLiteError;
+  if (it->second.num_slices > 0) {
+    TFLITE_LOG(TFLITE_LOG_ERROR,
+               "Buffer %d still has %d slices, which must be unregistered "
+               "first.",
+               handle, it->second.num_slices);
+    return kTfLiteError;
+  }
+  if (it->second.is_slice) --buffers_[it->second.parent].num_slices;
+  ReleaseBuffer(it->second);
+  buffers_.erase(it);
+  return kTfLiteOk;
+}
+
+void CpuAsyncKernel::ReleaseBuffer(const Buffer& buffer) {
+  if (buffer.is_slice) return;
+  switch (buffer.type) {
+    case MemoryType::kHostMemory:
+      break;
+    case MemoryType::kAHardwareBuffer:
+#ifdef __ANDROID__
+      OptionalAndroidHardwareBuffer::Instance().Release(buffer.ahwb);
+#endif  // __ANDROID__
+      break;
+    case MemoryType::kDmaBuf:
+#ifdef __linux__
+      munmap(buffer.base, buffer.size);
+      if (buffer.fd >= 0) close(buffer.fd);
+#endif  // __linux__
+      break;
+  }
+}
+
+const char* CpuAsyncKernel::TypeName(const Buffer& buffer) {
+  switch (buffer.type) {
+    case MemoryType::kHostMemory:
+      return kTfLiteBufferTypeHostMemory;
+    case MemoryType::kAHardwareBuffer:
+      return kTfLiteBufferTypeAHardwareBufferBlob;
+    case MemoryType::kDmaBuf:
+      return kTfLiteBufferTypeDmaBuf;
+  }
+  return nullptr;
+}
+
+bool CpuAsyncKernel::ReconcileRestrictions(
+    const TfLiteOpaqueContext* context, const TfLiteOpaqueNode* node,
+    int tensor_index, const TfLiteAttributeMap* user_provided_attributes,
+    TfLiteAttributeMap* merged, TfLiteAttributeMap* conflict) const {
+  const char* type = ExpectedType(user_provided_attributes);
+  if (!HasType(user_provided_attributes, type, conflict)) return false;
+  merged->impl = user_provided_attributes->impl;
+  merged->impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName, type);
+  if (merged->impl.IsBufferAttributeMap()) {
+    size_t size = 0;
+    merged->impl.GetAttr(kTfLiteBufferAttrKeySize, &size);
+    size = std::max(size, subgraph_->tensor(tensor_index)->bytes);
+    merged->impl.SetAttr(kTfLiteBufferAttrKeySize, size);
+  }
+  return true;
+}
+
+TfLiteStatus CpuAsyncKernel::SetAttributes(TfLiteOpaqueContext* context,
+                                           TfLiteOpaqueNode* node,
+                                           int tensor_index,
+                                           const TfLiteAttributeMap* attrs) {
+  return HasType(attrs, ExpectedType(attrs), nullptr) ? kTfLiteOk
+                                                      : kTfLiteError;
+}
+
+const char* CpuAsyncKernel::ExpectedType(
+    const TfLiteAttributeMap* attrs) const {
+  if (attrs->impl.IsSyncAttributeMap()) return kTfLiteSyncTypeNoSyncObj;
+  // Any supported buffer type is accepted, and host memory is the default.
+  const char* type = nullptr;
+  if (attrs->impl.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &type) &&
+      FindType(supported_buffer_types_, type) != nullptr) {
+    return type;
+  }
+  return kTfLiteBufferTypeHostMemory;
+}
+
+TfLiteStatus CpuAsyncKernel::SetBufferAttributes(
+    const TfLiteBackendBuffer* buffer, const TfLiteAttributeMap* attrs) {
+  // Buffers have no attributes besides their type and size, which are fixed
+  // at registration.
+  return kTfLiteDelegateError;
+}
+
+TfLiteStatus CpuAsyncKernel::GetBufferAttributes(
+    const TfLiteBackendBuffer* buffer, TfLiteAttributeMap* attrs) {
+  const void* ptr = TfLiteBackendBufferGetPtr(buffer);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& [handle, registered] : buffers_) {
+    if (registered.is_slice) continue;
+    if (registered.ptr == ptr) {
+      attrs->impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                          TypeName(registered));
+      attrs->impl.SetAttr(kTfLiteBufferAttrKeySize, registered.size);
+      return kTfLiteOk;
+    }
+  }
+  return kTfLiteDelegateError;
+}
+
+TfLiteStatus CpuAsyncKernel::Prepare(TfLiteOpaqueContext* context,
+                                     TfLiteOpaqueNode* node) {
+  return subgraph_->AllocateTensors();
+}
+
+TfLiteStatus CpuAsyncKernel::GetBinding(TfLiteExecutionTask* task,
+                                        int tensor_index, Binding* binding) {
+  const TfLiteBufferHandle handle = task->task->GetBufferHandle(tensor_index);
+  auto it = buffers_.find(handle);
+  if (it == buffers_.end()) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "No buffer is bound to tensor %d.",
+               tensor_index);
+    return kTfLiteError;
+  }
+  binding->tensor_index = tensor_index;
+  binding->buffer = it->second;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::Eval(TfLiteOpaqueContext* context,
+                                  TfLiteOpaqueNode* node,
+                                  TfLiteExecutionTask* task) {
+  auto* execution =
+      static_cast<Execution*>(task->task->GetDelegateExecutionData(kernel()));
+  if (execution == nullptr) {
+    execution = new Execution;
+    task->task->SetDelegateExecutionData(kernel(), execution);
+  }
+
+  // Resolve the buffers now, as the task may be modified while it runs.
+  std::unique_lock<std::mutex> lock(mutex_);
+  execution->inputs.resize(subgraph_->inputs().size());
+  execution->outputs.resize(subgraph_->outputs().size());
+  for (int i = 0; i < subgraph_->inputs().size(); ++i) {
+    TF_LITE_ENSURE_STATUS(
+        GetBinding(task, subgraph_->inputs()[i], &execution->inputs[i]));
+  }
+  for (int i = 0; i < subgraph_->outputs().size(); ++i) {
+    TF_LITE_ENSURE_STATUS(
+        GetBinding(task, subgraph_->outputs()[i], &execution->outputs[i]));
+  }
+
+  execution->done = false;
+  queue_.push_back(execution);
+  if (!worker_.joinable()) {
+    worker_ = std::thread([this] { WorkerLoop(); });
+  }
+  lock.unlock();
+  cv_.notify_all();
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::Wait(TfLiteOpaqueContext* context,
+                                  TfLiteExecutionTask* task) {
+  auto* execution =
+      static_cast<Execution*>(task->task->GetDelegateExecutionData(kernel()));
+  if (execution == nullptr) return kTfLiteOk;
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [execution] { return execution->done; });
+  return execution->status;
+}
+
+TfLiteStatus CpuAsyncKernel::Finish(TfLiteOpaqueContext* context,
+                                    TfLiteExecutionTask* task) {
+  auto* execution =
+      static_cast<Execution*>(task->task->GetDelegateExecutionData(kernel()));
+  if (execution == nullptr) return kTfLiteOk;
+  Wait(context, task);
+  task->task->SetDelegateExecutionData(kernel(), nullptr);
+  delete execution;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::BeginAccess(const Buffer& buffer, bool write,
+                                         uint8_t** data) {
+  switch (buffer.type) {
+    case MemoryType::kHostMemory:
+      *data = buffer.base;
+      return kTfLiteOk;
+    case MemoryType::kAHardwareBuffer: {
+#ifdef __ANDROID__
+      void* address = nullptr;
+      const uint64_t usage =
+          AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN |
+          (write ? AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN : 0);
+      if (OptionalAndroidHardwareBuffer::Instance().Lock(
+              buffer.ahwb, usage, /*fence=*/-1, &address) != 0) {
+        TFLITE_LOG(TFLITE_LOG_ERROR, "Cannot lock AHardwareBuffer.");
+        return kTfLiteError;
+      }
+      *data = static_cast<uint8_t*>(address);
+      return kTfLiteOk;
+#else
+      return kTfLiteError;
+#endif  // __ANDROID__
+    }
+    case MemoryType::kDmaBuf:
+#ifdef __linux__
+      TF_LITE_ENSURE_STATUS(SyncDmaBuf(
+          buffer.fd, DMA_BUF_SYNC_START |
+                         (write ? DMA_BUF_SYNC_RW : DMA_BUF_SYNC_READ)));
+#endif  // __linux__
+      *data = buffer.base;
+      return kTfLiteOk;
+  }
+  return kTfLiteError;
+}
+
+void CpuAsyncKernel::EndAccess(const Buffer& buffer, bool write) {
+  switch (buffer.type) {
+    case MemoryType::kHostMemory:
+      break;
+    case MemoryType::kAHardwareBuffer:
+#ifdef __ANDROID__
+      OptionalAndroidHardwareBuffer::Instance().Unlock(buffer.ahwb,
+                                                       /*fence=*/nullptr);
+#endif  // __ANDROID__
+      break;
+    case MemoryType::kDmaBuf:
+#ifdef __linux__
+      SyncDmaBuf(buffer.fd,
+                 DMA_BUF_SYNC_END |
+                     (write ? DMA_BUF_SYNC_RW : DMA_BUF_SYNC_READ));
+#endif  // __linux__
+      break;
+  }
+}
+
+TfLiteStatus CpuAsyncKernel::BindTensor(int tensor_index, uint8_t* data,
+                                        size_t size, bool* staged) {
+  TfLiteTensor* tensor = subgraph_->tensor(tensor_index);
+  const bool can_alias = tensor->allocation_type == kTfLiteArenaRw ||
+                         tensor->allocation_type == kTfLiteArenaRwPersistent ||
+                         tensor->allocation_type == kTfLiteCustom;
+  if (can_alias &&
+      reinterpret_cast<uintptr_t>(data) % kDefaultTensorAlignment == 0) {
+    *staged = false;
+    return subgraph_->SetCustomAllocationForTensor(tensor_index, {data, size});
+  }
+  *staged = true;
+  if (tensor->allocation_type != kTfLiteCustom) return kTfLiteOk;
+  // An earlier task bound the tensor to its buffer, so it needs memory of its
+  // own again.
+  std::vector<uint8_t>& staging = staging_[tensor_index];
+  staging.resize(tensor->bytes + kDefaultTensorAlignment);
+  const size_t misalignment =
+      reinterpret_cast<uintptr_t>(staging.data()) % kDefaultTensorAlignment;
+  uint8_t* aligned = staging.data() + (kDefaultTensorAlignment - misalignment) %
+                                          kDefaultTensorAlignment;
+  return subgraph_->SetCustomAllocationForTensor(tensor_index,
+                                                 {aligned, tensor->bytes});
+}
+
+TfLiteStatus CpuAsyncKernel::Run(const Execution& execution) {
+  // The memories of the task, each mapped once even if several slices of it
+  // are bound, and whether the task writes to them.
+  struct Access {
+    const Buffer* buffer;
+    bool write;
+    uint8_t* data = nullptr;
+  };
+  std::vector<Access> accesses;
+  auto find_access = [&](const Buffer& buffer, bool write) {
+    for (int i = 0; i < accesses.size(); ++i) {
+      const Buffer& other = *accesses[i].buffer;
+      if (other.type == buffer.type && other.base == buffer.base &&
+          other.ahwb == buffer.ahwb && other.fd == buffer.fd) {
+        accesses[i].write |= write;
+        return i;
+      }
+    }
+    accesses.push_back({&buffer, write});
+    return static_cast<int>(accesses.size()) - 1;
+  };
+  std::vector<int> input_accesses;
+  std::vector<int> output_accesses;
+  for (const Binding& input : execution.inputs) {
+    input_accesses.push_back(find_access(input.buffer, /*write=*/false));
+  }
+  for (const Binding& output : execution.outputs) {
+    output_accesses.push_back(find_access(output.buffer, /*write=*/true));
+  }
+
+  TfLiteStatus status = kTfLiteOk;
+  int num_begun = 0;
+  for (; num_begun < accesses.size(); ++num_begun) {
+    Access& access = accesses[num_begun];
+    status = BeginAccess(*access.buffer, access.write, &access.data);
+    if (status != kTfLiteOk) break;
+  }
+  if (status == kTfLiteOk) {
+    std::vector<uint8_t*> input_data;
+    std::vector<uint8_t*> output_data;
+    for (int i = 0; i < execution.inputs.size(); ++i) {
+      input_data.push_back(accesses[input_accesses[i]].data +
+                           execution.inputs[i].buffer.offset);
+    }
+    for (int i = 0; i < execution.outputs.size(); ++i) {
+      output_data.push_back(accesses[output_accesses[i]].data +
+                            execution.outputs[i].buffer.offset);
+    }
+    status = RunMapped(execution, input_data, output_data);
+  }
+  for (int i = 0; i < num_begun; ++i) {
+    EndAccess(*accesses[i].buffer, accesses[i].write);
+  }
+  return status;
+}
+
+TfLiteStatus CpuAsyncKernel::RunMapped(
+    const Execution& execution, const std::vector<uint8_t*>& input_data,
+    const std::vector<uint8_t*>& output_data) {
+  std::vector<bool> input_staged(execution.inputs.size());
+  std::vector<bool> output_staged(execution.outputs.size());
+  for (int i = 0; i < execution.inputs.size(); ++i) {
+    const Binding& input = execution.inputs[i];
+    TF_LITE_ENSURE(subgraph_->context(),
+                   subgraph_->tensor(input.tensor_index)->bytes <=
+                       input.buffer.size);
+    bool staged;
+    TF_LITE_ENSURE_STATUS(BindTensor(input.tensor_index, input_data[i],
+                                     input.buffer.size, &staged));
+    input_staged[i] = staged;
+  }
+  for (int i = 0; i < execution.outputs.size(); ++i) {
+    const Binding& output = execution.outputs[i];
+    bool staged;
+    TF_LITE_ENSURE_STATUS(BindTensor(output.tensor_index, output_data[i],
+                                     output.buffer.size, &staged));
+    output_staged[i] = staged;
+  }
+  // Only verifies the sizes of the buffers, as no shape changed.
+  TF_LITE_ENSURE_STATUS(subgraph_->AllocateTensors());
+
+  for (int i = 0; i < execution.inputs.size(); ++i) {
+    if (!input_staged[i]) continue;
+    TfLiteTensor* tensor = subgraph_->tensor(execution.inputs[i].tensor_index);
+    memcpy(tensor->data.raw, input_data[i], tensor->bytes);
+  }
+  TF_LITE_ENSURE_STATUS(subgraph_->Invoke());
+  for (int i = 0; i < execution.outputs.size(); ++i) {
+    if (!output_staged[i]) continue;
+    const TfLiteTensor* tensor =
+        subgraph_->tensor(execution.outputs[i].tensor_index);
+    TF_LITE_ENSURE(subgraph_->context(),
+                   tensor->bytes <= execution.outputs[i].buffer.size);
+    memcpy(output_data[i], tensor->data.raw, tensor->bytes);
+  }
+  return kTfLiteOk;
+}
+
+void CpuAsyncKernel::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) return;
+    Execution* execution = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    const TfLiteStatus status = Run(*execution);
+    lock.lock();
+    execution->status = status;
+    execution->done = true;
+    cv_.notify_all();
+  }
+}
+
+}  // namespace async
+}  // namespace tflite
@@ -0,0 +1,195 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/async/backend_async_kernel_interface.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+
+// Declared by <android/hardware_buffer.h>, which only Android builds include.
+struct AHardwareBuffer;
+
+namespace tflite {
+namespace async {
+
+// Async kernel running a whole subgraph with the regular, synchronous, CPU
+// kernels. AsyncSubgraph uses it for subgraphs that are not fully delegated
+// to an async backend, including subgraphs partly delegated to XNNPACK.
+//
+// Inputs and outputs are bound to `kTfLiteBufferTypeHostMemory` buffers, and
+// on platforms supporting them to `kTfLiteBufferTypeAHardwareBufferBlob` and
+// `kTfLiteBufferTypeDmaBuf` buffers. `Eval` only queues the execution of a
+// task: a worker thread maps the buffers of the task, points the input and
+// output tensors at them, and invokes the subgraph. Applications can thus fill
+// the buffers of the next task while the current one runs, and pipeline as
+// many tasks as they have buffers for. Tasks run in the order they are
+// scheduled.
+//
+// Buffers are used in place when they are aligned to `kDefaultTensorAlignment`
+// and the tensor is not dynamic, so that preprocessing can write directly into
+// the memory the model reads. Other buffers are copied to and from the tensors.
+//
+// Only `kTfLiteSyncTypeNoSyncObj` is supported: input buffers must be ready
+// when the task is scheduled, and output buffers are ready when `Wait`
+// returns. Input buffers must not be modified until then either.
+class CpuAsyncKernel : public delegates::BackendAsyncKernelInterface {
+ public:
+  // `subgraph` must outlive this object.
+  explicit CpuAsyncKernel(Subgraph* subgraph);
+  ~CpuAsyncKernel() override;
+
+  TfLiteStatus RegisterBuffer(TfLiteOpaqueContext* context,
+                              TfLiteIoType io_type,
+                              const TfLiteBackendBuffer* buffer,
+                              const TfLiteAttributeMap* attrs,
+                              TfLiteBufferHandle handle) override;
+  TfLiteStatus RegisterBufferSlice(TfLiteOpaqueContext* context,
+                                   TfLiteBufferHandle buffer_pool,
+                                   const TfLiteAttributeMap* attrs,
+                                   TfLiteBufferHandle handle) override;
+  TfLiteStatus UnregisterBuffer(TfLiteOpaqueContext* context,
+                                TfLiteBufferHandle handle) override;
+
+  const std::vector<const char*>& SupportedBufferTypes(
+      TfLiteIoType io_type) const override {
+    return supported_buffer_types_;
+  }
+  const std::vector<const char*>& SupportedSynchronizations(
+      TfLiteIoType io_type) const override {
+    return supported_synchronizations_;
+  }
+
+  bool ReconcileRestrictions(const TfLiteOpaqueContext* context,
+                             const TfLiteOpaqueNode* node, int tensor_index,
+                             const TfLiteAttributeMap* user_provided_attributes,
+                             TfLiteAttributeMap* merged,
+                             TfLiteAttributeMap* conflict) const override;
+  TfLiteStatus SetAttributes(TfLiteOpaqueContext* context,
+                             TfLiteOpaqueNode* node, int tensor_index,
+                             const TfLiteAttributeMap* attrs) override;
+  TfLiteStatus SetBufferAttributes(const TfLiteBackendBuffer* buffer,
+                                   const TfLiteAttributeMap* attrs) override;
+  TfLiteStatus GetBufferAttributes(const TfLiteBackendBuffer* buffer,
+                                   TfLiteAttributeMap* attrs) override;
+
+  // Allocates the tensors of the subgraph.
+  TfLiteStatus Prepare(TfLiteOpaqueContext* context,
+                       TfLiteOpaqueNode* node) override;
+
+  TfLiteStatus Eval(TfLiteOpaqueContext* context, TfLiteOpaqueNode* node,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Wait(TfLiteOpaqueContext* context,
+                    TfLiteExecutionTask* task) override;
+  TfLiteStatus Finish(TfLiteOpaqueContext* context,
+                      TfLiteExecutionTask* task) override;
+
+ private:
+  enum class MemoryType { kHostMemory, kAHardwareBuffer, kDmaBuf };
+
+  struct Buffer {
+    MemoryType type = MemoryType::kHostMemory;
+    // The pointer of the TfLiteBackendBuffer that was registered.
+    const void* ptr = nullptr;
+    // The host memory, or the mapping of a dmabuf. AHardwareBuffers are only
+    // mapped while a task runs.
+    uint8_t* base = nullptr;
+    // Start of the buffer in `base`, or in the AHardwareBuffer.
+    size_t offset = 0;
+    size_t size = 0;
+    AHardwareBuffer* ahwb = nullptr;
+    int fd = -1;
+    // Whether this is a slice, which does not own its memory.
+    bool is_slice = false;
+    // The buffer owning the memory of a slice.
+    TfLiteBufferHandle parent = kTfLiteNullBufferHandle;
+    // The number of registered slices of a buffer, which cannot be
+    // unregistered before them.
+    int num_slices = 0;
+  };
+
+  // A buffer bound to an input or output tensor.
+  struct Binding {
+    int tensor_index;
+    Buffer buffer;
+  };
+
+  // The state of a task, stored as its delegate execution data.
+  struct Execution {
+    std::vector<Binding> inputs;
+    std::vector<Binding> outputs;
+    bool done = true;
+    TfLiteStatus status = kTfLiteOk;
+  };
+
+  static const char* TypeName(const Buffer& buffer);
+  // Returns the type of the buffers or sync objects described by `attrs`.
+  const char* ExpectedType(const TfLiteAttributeMap* attrs) const;
+  // Returns the buffer bound to `tensor_index` in `task`.
+  TfLiteStatus GetBinding(TfLiteExecutionTask* task, int tensor_index,
+                          Binding* binding);
+  // Maps the buffers of `execution`, invokes the subgraph on them and unmaps
+  // them. Runs on the worker thread.
+  TfLiteStatus Run(const Execution& execution);
+  TfLiteStatus RunMapped(const Execution& execution,
+                         const std::vector<uint8_t*>& input_data,
+                         const std::vector<uint8_t*>& output_data);
+  // Points `tensor_index` at `data`. Sets `staged` if the tensor has to be
+  // copied from or to `data` instead.
+  TfLiteStatus BindTensor(int tensor_index, uint8_t* data, size_t size,
+                          bool* staged);
+  // Makes the contents of `buffer` accessible to the CPU at `*data`, until
+  // `EndAccess` is called.
+  TfLiteStatus BeginAccess(const Buffer& buffer, bool write, uint8_t** data);
+  void EndAccess(const Buffer& buffer, bool write);
+  // Releases the memory of a registered buffer.
+  void ReleaseBuffer(const Buffer& buffer);
+  void WorkerLoop();
+
+  // Not owned.
+  Subgraph* subgraph_;
+  std::vector<const char*> supported_buffer_types_;
+  const std::vector<const char*> supported_synchronizations_ = {
+      kTfLiteSyncTypeNoSyncObj};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<TfLiteBufferHandle, Buffer> buffers_;
+  // Memory of the tensors bound to unaligned buffers, by tensor index. Only
+  // used by the worker thread.
+  std::map<int, std::vector<uint8_t>> staging_;
+  // Executions scheduled but not started yet.
+  std::deque<Execution*> queue_;
+  bool stop_ = false;
+  // Started by the first `Eval`.
+  std::thread worker_;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
@@ -0,0 +1,441 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/dma-heap.h>)
+#include <fcntl.h>
+#include <linux/dma-heap.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define TFLITE_CPU_ASYNC_KERNEL_TEST_DMA_HEAP 1
+#endif
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/async/async_subgraph.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/util.h"
+
+#ifdef __ANDROID__
+#include "tensorflow/lite/delegates/gpu/android_hardware_buffer.h"
+#endif  // __ANDROID__
+
+namespace tflite {
+namespace async {
+namespace {
+
+using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+// A host memory buffer of 3 floats, registered to an AsyncSubgraph.
+class HostBuffer {
+ public:
+  HostBuffer(AsyncSubgraph* subgraph, TfLiteIoType io_type,
+             std::vector<float> values = {0.f, 0.f, 0.f})
+      : values_(std::move(values)), buffer_(TfLiteBackendBufferCreate()) {
+    TfLiteBackendBufferSetPtr(buffer_, values_.data());
+    TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                       kTfLiteBufferTypeHostMemory);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeySize,
+                       values_.size() * sizeof(float));
+    status_ = subgraph->RegisterBuffer(io_type, buffer_, &attrs, &handle_);
+  }
+  ~HostBuffer() { TfLiteBackendBufferDelete(buffer_); }
+
+  TfLiteStatus status() const { return status_; }
+  TfLiteBufferHandle handle() const { return handle_; }
+  std::vector<float>& values() { return values_; }
+
+ private:
+  std::vector<float> values_;
+  TfLiteBackendBuffer* buffer_;
+  TfLiteBufferHandle handle_ = kTfLiteNullBufferHandle;
+  TfLiteStatus status_;
+};
+
+class CpuAsyncKernelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // out = (in0 + in1) + in1, on the CPU.
+    interpreter_ = std::make_unique<Interpreter>();
+    interpreter_->AddTensors(4);
+    interpreter_->SetInputs({0, 1});
+    interpreter_->SetOutputs({3});
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 4; ++i) {
+      interpreter_->SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {3},
+                                                 quant);
+    }
+    TfLiteRegistration* reg = ops::builtin::Register_ADD();
+    auto* params_1 = static_cast<TfLiteAddParams*>(
+        calloc(1, sizeof(TfLiteAddParams)));
+    auto* params_2 = static_cast<TfLiteAddParams*>(
+        calloc(1, sizeof(TfLiteAddParams)));
+    interpreter_->AddNodeWithParameters({0, 1}, {2}, nullptr, 0, params_1,
+                                        reg);
+    interpreter_->AddNodeWithParameters({2, 1}, {3}, nullptr, 0, params_2,
+                                        reg);
+    subgraph_ = std::make_unique<AsyncSubgraph>(interpreter_->subgraph(0));
+    ASSERT_EQ(subgraph_->Prepare(), kTfLiteOk);
+  }
+
+  // Creates a task reading `in0` and `in1`, and writing `out`.
+  TfLiteExecutionTask* CreateTask(const HostBuffer& in0, const HostBuffer& in1,
+                                  const HostBuffer& out) {
+    TfLiteExecutionTask* task = subgraph_->CreateTask();
+    task->task->SetBufferHandle(0, in0.handle());
+    task->task->SetBufferHandle(1, in1.handle());
+    task->task->SetBufferHandle(3, out.handle());
+    return task;
+  }
+
+  // Registers `ptr` as a buffer of `type` holding 3 floats, and returns its
+  // handle.
+  TfLiteBufferHandle RegisterBuffer(TfLiteIoType io_type, const char* type,
+                                    void* ptr) {
+    TfLiteBackendBuffer* buffer = TfLiteBackendBufferCreate();
+    TfLiteBackendBufferSetPtr(buffer, ptr);
+    TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName, type);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, 3 * sizeof(float));
+    TfLiteBufferHandle handle = kTfLiteNullBufferHandle;
+    EXPECT_EQ(subgraph_->RegisterBuffer(io_type, buffer, &attrs, &handle),
+              kTfLiteOk);
+    TfLiteBackendBufferDelete(buffer);
+    return handle;
+  }
+
+  // Runs a task on the buffers `in0`, `in1` and `out`, and unregisters them.
+  void InvokeAndUnregister(TfLiteBufferHandle in0, TfLiteBufferHandle in1,
+                           TfLiteBufferHandle out) {
+    TfLiteExecutionTask* task = subgraph_->CreateTask();
+    task->task->SetBufferHandle(0, in0);
+    task->task->SetBufferHandle(1, in1);
+    task->task->SetBufferHandle(3, out);
+    EXPECT_EQ(subgraph_->InvokeAsync(task), kTfLiteOk);
+    EXPECT_EQ(subgraph_->Wait(task), kTfLiteOk);
+    EXPECT_EQ(subgraph_->Finish(task), kTfLiteOk);
+    for (TfLiteBufferHandle handle : {in0, in1, out}) {
+      EXPECT_EQ(subgraph_->UnregisterBuffer(handle), kTfLiteOk);
+    }
+  }
+
+  std::unique_ptr<Interpreter> interpreter_;
+  std::unique_ptr<AsyncSubgraph> subgraph_;
+};
+
+TEST_F(CpuAsyncKernelTest, SupportsHostMemory) {
+  EXPECT_THAT(subgraph_->SupportedBufferTypes(kTfLiteIoTypeInput),
+              Contains(kTfLiteBufferTypeHostMemory));
+  EXPECT_THAT(subgraph_->SupportedSynchronizations(kTfLiteIoTypeOutput),
+              ElementsAre(kTfLiteSyncTypeNoSyncObj));
+
+  TfLiteAttributeMap user(kTfLiteAttrMapTypeBuffer);
+  TfLiteAttributeMap merged(kTfLiteAttrMapTypeBuffer);
+  ASSERT_TRUE(subgraph_->ReconcileRestrictions(0, &user, &merged, nullptr));
+  const char* type = nullptr;
+  size_t size = 0;
+  EXPECT_TRUE(merged.impl.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &type));
+  EXPECT_STREQ(type, kTfLiteBufferTypeHostMemory);
+  EXPECT_TRUE(merged.impl.GetAttr(kTfLiteBufferAttrKeySize, &size));
+  EXPECT_EQ(size, 3 * sizeof(float));
+
+  user.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName, "dma_buf");
+  TfLiteAttributeMap conflict(kTfLiteAttrMapTypeBuffer);
+  EXPECT_FALSE(subgraph_->ReconcileRestrictions(0, &user, &merged, &conflict));
+  EXPECT_TRUE(
+      conflict.impl.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &type));
+  EXPECT_EQ(subgraph_->SetAttributes(0, &user), kTfLiteError);
+}
+
+TEST_F(CpuAsyncKernelTest, InvokesAsync) {
+  HostBuffer in0(subgraph_.get(), kTfLiteIoTypeInput, {1.f, 2.f, 3.f});
+  HostBuffer in1(subgraph_.get(), kTfLiteIoTypeInput, {10.f, 20.f, 30.f});
+  HostBuffer out(subgraph_.get(), kTfLiteIoTypeOutput);
+  ASSERT_EQ(in0.status(), kTfLiteOk);
+  ASSERT_EQ(in1.status(), kTfLiteOk);
+  ASSERT_EQ(out.status(), kTfLiteOk);
+
+  TfLiteExecutionTask* task = CreateTask(in0, in1, out);
+  for (float scale : {1.f, 2.f}) {
+    for (float& value : in0.values()) value *= scale;
+    ASSERT_EQ(subgraph_->InvokeAsync(task), kTfLiteOk);
+    ASSERT_EQ(subgraph_->Wait(task), kTfLiteOk);
+  }
+  EXPECT_THAT(out.values(), ElementsAre(22.f, 44.f, 66.f));
+  EXPECT_EQ(subgraph_->Finish(task), kTfLiteOk);
+}
+
+TEST_F(CpuAsyncKernelTest, PipelinesTasks) {
+  // Frames alternate between two sets of buffers, so that the inputs of a
+  // frame are written while the previous one runs.
+  constexpr int kNumFrames = 8;
+  HostBuffer in1(subgraph_.get(), kTfLiteIoTypeInput, {0.f, 1.f, 2.f});
+  std::vector<std::unique_ptr<HostBuffer>> inputs;
+  std::vector<std::unique_ptr<HostBuffer>> outputs;
+  std::vector<TfLiteExecutionTask*> tasks;
+  for (int i = 0; i < 2; ++i) {
+    inputs.push_back(
+        std::make_unique<HostBuffer>(subgraph_.get(), kTfLiteIoTypeInput));
+    outputs.push_back(
+        std::make_unique<HostBuffer>(subgraph_.get(), kTfLiteIoTypeOutput));
+    tasks.push_back(CreateTask(*inputs[i], in1, *outputs[i]));
+  }
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    const int slot = frame % 2;
+    if (frame >= 2) {
+      ASSERT_EQ(subgraph_->Wait(tasks[slot]), kTfLiteOk);
+      const float previous = frame - 2;
+      EXPECT_THAT(outputs[slot]->values(),
+                  ElementsAre(previous, previous + 2, previous + 4));
+    }
+    inputs[slot]->values().assign(3, frame);
+    ASSERT_EQ(subgraph_->InvokeAsync(tasks[slot]), kTfLiteOk);
+  }
+  for (int slot = 0; slot < 2; ++slot) {
+    ASSERT_EQ(subgraph_->Wait(tasks[slot]), kTfLiteOk);
+    const float last = kNumFrames - 2 + slot;
+    EXPECT_THAT(outputs[slot]->values(), ElementsAre(last, last + 2, last + 4));
+    EXPECT_EQ(subgraph_->Finish(tasks[slot]), kTfLiteOk);
+  }
+}
+
+TEST_F(CpuAsyncKernelTest, RegistersSlices) {
+  HostBuffer pool(subgraph_.get(), kTfLiteIoTypeInput,
+                  {1.f, 1.f, 1.f, 2.f, 2.f, 2.f});
+  TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyOffset, 3 * sizeof(float));
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, 3 * sizeof(float));
+  TfLiteBufferHandle slice;
+  ASSERT_EQ(subgraph_->RegisterBufferSlice(pool.handle(), &attrs, &slice),
+            kTfLiteOk);
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyOffset, 4 * sizeof(float));
+  TfLiteBufferHandle too_large;
+  EXPECT_EQ(subgraph_->RegisterBufferSlice(pool.handle(), &attrs, &too_large),
+            kTfLiteError);
+
+  HostBuffer out(subgraph_.get(), kTfLiteIoTypeOutput);
+  TfLiteExecutionTask* task = CreateTask(pool, pool, out);
+  task->task->SetBufferHandle(1, slice);
+  ASSERT_EQ(subgraph_->InvokeAsync(task), kTfLiteOk);
+  ASSERT_EQ(subgraph_->Wait(task), kTfLiteOk);
+  EXPECT_THAT(out.values(), ElementsAreArray({5.f, 5.f, 5.f}));
+  EXPECT_EQ(subgraph_->Finish(task), kTfLiteOk);
+  EXPECT_EQ(subgraph_->UnregisterBuffer(slice), kTfLiteOk);
+  EXPECT_EQ(subgraph_->UnregisterBuffer(slice), kTfLiteError);
+}
+
+TEST_F(CpuAsyncKernelTest, UnregistersSlicesBeforeTheirBuffer) {
+  HostBuffer pool(subgraph_.get(), kTfLiteIoTypeInput,
+                  {1.f, 1.f, 1.f, 2.f, 2.f, 2.f});
+  TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyOffset, size_t{0});
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, 6 * sizeof(float));
+  TfLiteBufferHandle slice;
+  ASSERT_EQ(subgraph_->RegisterBufferSlice(pool.handle(), &attrs, &slice),
+            kTfLiteOk);
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyOffset, 3 * sizeof(float));
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, 3 * sizeof(float));
+  TfLiteBufferHandle slice_of_slice;
+  ASSERT_EQ(subgraph_->RegisterBufferSlice(slice, &attrs, &slice_of_slice),
+            kTfLiteOk);
+
+  // The slice of the slice is counted against the pool, so the slice itself
+  // can go first.
+  EXPECT_EQ(subgraph_->UnregisterBuffer(pool.handle()), kTfLiteError);
+  EXPECT_EQ(subgraph_->UnregisterBuffer(slice), kTfLiteOk);
+  EXPECT_EQ(subgraph_->UnregisterBuffer(pool.handle()), kTfLiteError);
+
+  HostBuffer out(subgraph_.get(), kTfLiteIoTypeOutput);
+  TfLiteExecutionTask* task = CreateTask(pool, pool, out);
+  task->task->SetBufferHandle(1, slice_of_slice);
+  ASSERT_EQ(subgraph_->InvokeAsync(task), kTfLiteOk);
+  ASSERT_EQ(subgraph_->Wait(task), kTfLiteOk);
+  EXPECT_THAT(out.values(), ElementsAreArray({5.f, 5.f, 5.f}));
+  EXPECT_EQ(subgraph_->Finish(task), kTfLiteOk);
+
+  EXPECT_EQ(subgraph_->UnregisterBuffer(slice_of_slice), kTfLiteOk);
+  EXPECT_EQ(subgraph_->UnregisterBuffer(pool.handle()), kTfLiteOk);
+}
+
+#ifdef TFLITE_CPU_ASYNC_KERNEL_TEST_DMA_HEAP
+TEST_F(CpuAsyncKernelTest, InvokesOnDmaBufs) {
+  const int heap = open("/dev/dma_heap/system", O_RDONLY | O_CLOEXEC);
+  if (heap < 0) GTEST_SKIP() << "No system DMA heap.";
+  constexpr size_t kSize = 3 * sizeof(float);
+  int fds[3];
+  float* data[3];
+  for (int i = 0; i < 3; ++i) {
+    dma_heap_allocation_data allocation = {};
+    allocation.len = kSize;
+    allocation.fd_flags = O_RDWR | O_CLOEXEC;
+    ASSERT_EQ(ioctl(heap, DMA_HEAP_IOCTL_ALLOC, &allocation), 0);
+    fds[i] = allocation.fd;
+    void* mapping =
+        mmap(nullptr, kSize, PROT_READ | PROT_WRITE, MAP_SHARED, fds[i], 0);
+    ASSERT_NE(mapping, MAP_FAILED);
+    data[i] = static_cast<float*>(mapping);
+  }
+  close(heap);
+  std::fill(data[0], data[0] + 3, 1.f);
+  std::fill(data[1], data[1] + 3, 2.f);
+  std::vector<TfLiteBufferHandle> handles;
+  for (int i = 0; i < 3; ++i) {
+    handles.push_back(RegisterBuffer(
+        i < 2 ? kTfLiteIoTypeInput : kTfLiteIoTypeOutput,
+        kTfLiteBufferTypeDmaBuf,
+        reinterpret_cast<void*>(static_cast<intptr_t>(fds[i]))));
+    // The kernel keeps its own reference to the dmabuf.
+    close(fds[i]);
+  }
+  InvokeAndUnregister(handles[0], handles[1], handles[2]);
+  EXPECT_THAT(std::vector<float>(data[2], data[2] + 3),
+              ElementsAreArray({5.f, 5.f, 5.f}));
+  for (float* mapping : data) munmap(mapping, kSize);
+}
+#endif  // TFLITE_CPU_ASYNC_KERNEL_TEST_DMA_HEAP
+
+#ifdef __ANDROID__
+TEST_F(CpuAsyncKernelTest, InvokesOnAHardwareBuffers) {
+  auto& ahwb = gpu::OptionalAndroidHardwareBuffer::Instance();
+  if (!ahwb.Supported()) GTEST_SKIP() << "No AHardwareBuffer support.";
+  EXPECT_THAT(subgraph_->SupportedBufferTypes(kTfLiteIoTypeInput),
+              Contains(kTfLiteBufferTypeAHardwareBufferBlob));
+  AHardwareBuffer_Desc desc = {};
+  desc.width = 3 * sizeof(float);
+  desc.height = 1;
+  desc.layers = 1;
+  desc.format = AHARDWAREBUFFER_FORMAT_BLOB;
+  desc.usage = AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN |
+               AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN;
+  AHardwareBuffer* buffers[3];
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(ahwb.Allocate(&desc, &buffers[i]), 0);
+    void* address = nullptr;
+    ASSERT_EQ(ahwb.Lock(buffers[i], desc.usage, /*fence=*/-1, &address), 0);
+    std::fill(static_cast<float*>(address), static_cast<float*>(address) + 3,
+              static_cast<float>(i + 1));
+    ahwb.Unlock(buffers[i], /*fence=*/nullptr);
+  }
+  std::vector<TfLiteBufferHandle> handles;
+  for (int i = 0; i < 3; ++i) {
+    handles.push_back(RegisterBuffer(
+        i < 2 ? kTfLiteIoTypeInput : kTfLiteIoTypeOutput,
+        kTfLiteBufferTypeAHardwareBufferBlob, buffers[i]));
+  }
+  InvokeAndUnregister(handles[0], handles[1], handles[2]);
+  void* address = nullptr;
+  ASSERT_EQ(ahwb.Lock(buffers[2], desc.usage, /*fence=*/-1, &address), 0);
+  const float* out = static_cast<const float*>(address);
+  EXPECT_THAT(std::vector<float>(out, out + 3),
+              ElementsAreArray({5.f, 5.f, 5.f}));
+  ahwb.Unlock(buffers[2], /*fence=*/nullptr);
+  for (AHardwareBuffer* buffer : buffers) ahwb.Release(buffer);
+}
+#endif  // __ANDROID__
+
+TEST_F(CpuAsyncKernelTest, BindsAlignedBuffersInPlace) {
+  // Buffers of 3 floats each, at offset 0 of an aligned array, or at offset 1
+  // in the unaligned case.
+  struct Buffers {
+    alignas(kDefaultTensorAlignment) float in0[4];
+    alignas(kDefaultTensorAlignment) float in1[4];
+    alignas(kDefaultTensorAlignment) float out[4];
+  };
+  auto invoke = [this](Buffers& buffers, int offset) {
+    std::vector<TfLiteBufferHandle> handles;
+    for (float* data : {buffers.in0, buffers.in1, buffers.out}) {
+      std::fill(data, data + 4, 1.f);
+      TfLiteBackendBuffer* buffer = TfLiteBackendBufferCreate();
+      TfLiteBackendBufferSetPtr(buffer, data + offset);
+      TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+      attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, 3 * sizeof(float));
+      handles.emplace_back();
+      EXPECT_EQ(subgraph_->RegisterBuffer(kTfLiteIoTypeInput, buffer, &attrs,
+                                          &handles.back()),
+                kTfLiteOk);
+      TfLiteBackendBufferDelete(buffer);
+    }
+    TfLiteExecutionTask* task = subgraph_->CreateTask();
+    task->task->SetBufferHandle(0, handles[0]);
+    task->task->SetBufferHandle(1, handles[1]);
+    task->task->SetBufferHandle(3, handles[2]);
+    EXPECT_EQ(subgraph_->InvokeAsync(task), kTfLiteOk);
+    EXPECT_EQ(subgraph_->Wait(task), kTfLiteOk);
+    EXPECT_EQ(subgraph_->Finish(task), kTfLiteOk);
+    for (TfLiteBufferHandle handle : handles) {
+      EXPECT_EQ(subgraph_->UnregisterBuffer(handle), kTfLiteOk);
+    }
+  };
+
+  Buffers aligned;
+  invoke(aligned, 0);
+  EXPECT_THAT(aligned.out, ElementsAre(3.f, 3.f, 3.f, 1.f));
+  EXPECT_EQ(interpreter_->tensor(0)->data.f, aligned.in0);
+  EXPECT_EQ(interpreter_->tensor(3)->data.f, aligned.out);
+
+  // Tensors bound in place by the previous task get memory of their own.
+  Buffers unaligned;
+  invoke(unaligned, 1);
+  EXPECT_THAT(unaligned.out, ElementsAre(1.f, 3.f, 3.f, 3.f));
+  EXPECT_NE(interpreter_->tensor(0)->data.f, aligned.in0);
+  EXPECT_NE(interpreter_->tensor(3)->data.f, aligned.out);
+}
+
+TEST_F(CpuAsyncKernelTest, RequiresBuffersForAllInputsAndOutputs) {
+  HostBuffer in0(subgraph_.get(), kTfLiteIoTypeInput);
+  HostBuffer out(subgraph_.get(), kTfLiteIoTypeOutput);
+  TfLiteExecutionTask* task = subgraph_->CreateTask();
+  task->task->SetBufferHandle(0, in0.handle());
+  task->task->SetBufferHandle(3, out.handle());
+  EXPECT_EQ(subgraph_->InvokeAsync(task), kTfLiteError);
+  EXPECT_EQ(subgraph_->Finish(task), kTfLiteOk);
+}
+
+TEST_F(CpuAsyncKernelTest, RejectsUnsizedBuffers) {
+  float value = 0.f;
+  TfLiteBackendBuffer* buffer = TfLiteBackendBufferCreate();
+  TfLiteBackendBufferSetPtr(buffer, &value);
+  TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+  TfLiteBufferHandle handle;
+  EXPECT_EQ(subgraph_->RegisterBuffer(kTfLiteIoTypeInput, buffer, &attrs,
+                                      &handle),
+            kTfLiteError);
+  TfLiteBackendBufferDelete(buffer);
+}
+
+}  // namespace
+}  // namespace async
+}  // namespace tflite
@@ -17,5 +17,8 @@ limitations under the License.
 extern "C" {
 
 const char kTfLiteSyncTypeNoSyncObj[] = "no_sync_obj";
+const char kTfLiteBufferTypeHostMemory[] = "host_memory";
+const char kTfLiteBufferTypeAHardwareBufferBlob[] = "ahardware_buffer_blob";
+const char kTfLiteBufferTypeDmaBuf[] = "dmabuf";
 
 }  // extern "C"
@@ -38,6 +38,31 @@ extern "C" {
 /// output tensor must be ready when AsyncSignatureRunner::Wait returns.
 TFL_CAPI_EXPORT extern const char kTfLiteSyncTypeNoSyncObj[];  // "no_sync_obj"
 
+/// Buffer type name of host memory.
+///
+/// The pointer stored in the TfLiteBackendBuffer is the address of the data,
+/// and its size is given by the `kTfLiteBufferAttrKeySize` attribute. This is
+/// the buffer type of subgraphs executed on the CPU by AsyncSignatureRunner.
+TFL_CAPI_EXPORT extern const char
+    kTfLiteBufferTypeHostMemory[];  // "host_memory"
+
+/// Buffer type name of Android hardware buffers of format
+/// AHARDWAREBUFFER_FORMAT_BLOB.
+///
+/// The pointer stored in the TfLiteBackendBuffer is the `AHardwareBuffer*`,
+/// and the size of the buffer is its width. The CPU reads and writes them
+/// while locked, without copies.
+TFL_CAPI_EXPORT extern const char
+    kTfLiteBufferTypeAHardwareBufferBlob[];  // "ahardware_buffer_blob"
+
+/// Buffer type name of Linux dmabufs.
+///
+/// The pointer stored in the TfLiteBackendBuffer is the file descriptor of the
+/// dmabuf, cast to `intptr_t`, and the size of the buffer is given by the
+/// `kTfLiteBufferAttrKeySize` attribute. The CPU maps them, so they must be
+/// CPU-mappable.
+TFL_CAPI_EXPORT extern const char kTfLiteBufferTypeDmaBuf[];  // "dmabuf"
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -329,6 +329,24 @@ class MallocDataAllocator : public BuiltinDataAllocator {
   void Deallocate(void* data) override { free(data); }
 };
 
+// Returns true if the builtin kernels of `op_type` read their builtin data in
+// `init`, which is called when the node is added, so that the data can't be
+// parsed lazily.
+bool ReadsBuiltinDataAtInit(BuiltinOperator op_type) {
+  switch (op_type) {
+    case BuiltinOperator_BUCKETIZE:
+    case BuiltinOperator_CALL_ONCE:
+    case BuiltinOperator_IF:
+    case BuiltinOperator_LSTM:
+    case BuiltinOperator_STABLEHLO_COMPOSITE:
+    case BuiltinOperator_VAR_HANDLE:
+    case BuiltinOperator_WHILE:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
 TfLiteStatus InterpreterBuilder::ParseNodes(
@@ -389,6 +407,22 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
                     op->large_custom_options_offset();
         init_data_size = op->large_custom_options_size();
       }
+    } else if (options_.GetDeferOpDataParsing() &&
+               !ReadsBuiltinDataAtInit(op_type)) {
+      // The flatbuffer outlives the interpreter, so the options are parsed
+      // from it when the node is first needed.
+      ErrorReporter* error_reporter = error_reporter_;
+      subgraph->AddNodeWithLazyParameters(
+          FlatBufferIntArrayToVector(op->inputs()),
+          FlatBufferIntArrayToVector(op->outputs()),
+          FlatBufferIntArrayToVector(op->intermediates()),
+          [op, op_type, error_reporter](void** builtin_data) {
+            MallocDataAllocator malloc_allocator;
+            return ParseOpData(op, op_type, error_reporter, &malloc_allocator,
+                               builtin_data);
+          },
+          registration);
+      continue;
     } else {
       MallocDataAllocator malloc_allocator;
       TF_LITE_ENSURE_STATUS(ParseOpData(op, op_type, error_reporter_,
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/lite/core/interpreter_builder.h"
 #include "tensorflow/lite/core/kernels/register.h"
 #include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/testing/util.h"
@@ -811,6 +812,36 @@ TEST(BasicFlatBufferModel, TestHandleZeroSizeConstant) {
   ASSERT_EQ(interpreter->tensor(1)->allocation_type, kTfLiteMmapRo);
 }
 
+TEST(BasicFlatBufferModel, TestDeferOpDataParsing) {
+  std::unique_ptr<tflite::FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile("tensorflow/lite/testdata/add.bin");
+  ASSERT_NE(model, nullptr);
+
+  tflite::ops::builtin::BuiltinOpResolver resolver;
+  InterpreterOptions options;
+  options.SetDeferOpDataParsing(true);
+  InterpreterBuilder builder(*model, resolver, &options);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  ASSERT_NE(interpreter, nullptr);
+  ASSERT_EQ(interpreter->nodes_size(), 2);
+  EXPECT_EQ(interpreter->node_and_registration(0)->first.builtin_data,
+            nullptr);
+
+  // The options are parsed when the nodes are prepared.
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  EXPECT_NE(interpreter->node_and_registration(0)->first.builtin_data,
+            nullptr);
+  EXPECT_NE(interpreter->node_and_registration(1)->first.builtin_data,
+            nullptr);
+
+  float* input = interpreter->typed_input_tensor<float>(0);
+  for (int i = 0; i < 8 * 8 * 3; ++i) input[i] = 1.0f;
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const float* output = interpreter->typed_output_tensor<float>(0);
+  for (int i = 0; i < 8 * 8 * 3; ++i) EXPECT_EQ(output[i], 3.0f);
+}
+
 // TODO(aselle): Add tests for serialization of builtin op data types.
 // These tests will occur with the evaluation tests of individual operators,
 // not here.
@@ -22,6 +22,7 @@ limitations under the License.
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -46,6 +47,7 @@ limitations under the License.
 #include "tensorflow/lite/logger.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/offline_memory_plan.h"
 #include "tensorflow/lite/profiling/telemetry/telemetry.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/util.h"
@@ -193,6 +195,15 @@ TfLiteStatus VerifyCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+std::vector<int> DimsVector(const TfLiteIntArray* dims) {
+  if (dims == nullptr) return {};
+  return std::vector<int>(dims->data, dims->data + dims->size);
+}
+
+// The CPU backend context of the inter-op thread running a node, or null on
+// the thread calling `Invoke`.
+thread_local TfLiteExternalContext* inter_op_cpu_backend_context = nullptr;
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -244,6 +255,10 @@ class InterpreterInfo : public GraphInfo {
     return subgraph_->variables();
   }
 
+  int node_stage(size_t index) const override {
+    return subgraph_->node_stage(index);
+  }
+
  public:
   Subgraph* subgraph_;
 };
@@ -567,6 +582,7 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
                   GetDelegateKernalName(registration), node_subsets.size());
 
   execution_plan_.clear();
+  node_stages_.clear();
 
   for (auto& node_subset : node_subsets) {
     // Subsets claimed by the delegate should have a "macro" op created, the
@@ -618,6 +634,10 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext &&
+      inter_op_cpu_backend_context != nullptr) {
+    return inter_op_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1010,7 +1030,15 @@ TfLiteStatus Subgraph::AllocateTensors() {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
-  TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  const bool use_shape_plans =
+      ShapePlanCacheSize() > 0 && delegates_applied_.empty();
+  const bool shape_plan_restored = use_shape_plans && RestoreShapePlan();
+  const TfLiteStatus prepare_status = PrepareOpsAndTensors();
+  skip_prepare_.clear();
+  TF_LITE_ENSURE_STATUS(prepare_status);
+  if (use_shape_plans && !shape_plan_restored) {
+    RecordShapePlan();
+  }
 
   state_ = kStateInvokable;
 
@@ -1082,6 +1110,7 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
     return kTfLiteError;
   }
   state_ = kStateUninvokable;
+  shape_plans_.clear();
 
   TF_LITE_ENSURE_OK(&context_, CheckTensorIndices("node inputs", inputs.data(),
                                                   inputs.size()));
@@ -1136,6 +1165,49 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
   // Copying of registration is required to support unresolved custom ops.
   node_and_reg.second = *registration;
   execution_plan_.push_back(new_node_index);
+  node_stages_.clear();
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::AddNodeWithLazyParameters(
+    const std::vector<int>& inputs, const std::vector<int>& outputs,
+    const std::vector<int>& intermediates,
+    std::function<TfLiteStatus(void** builtin_data)> parse_builtin_data,
+    const TfLiteRegistration* registration, int* node_index) {
+  // Builtin ops don't support overlapping inputs and outputs, which
+  // `AddNodeWithParameters` only checks when given builtin data.
+  TF_LITE_ENSURE_OK(&context_, CheckInputAndOutputForOverlap(
+                                   inputs.data(), inputs.size(),
+                                   outputs.data(), outputs.size()));
+  int new_node_index;
+  TF_LITE_ENSURE_OK(&context_,
+                    AddNodeWithParameters(inputs, outputs, intermediates,
+                                          /*init_data=*/nullptr,
+                                          /*init_data_size=*/0,
+                                          /*builtin_data=*/nullptr,
+                                          registration, &new_node_index));
+  if (node_index) *node_index = new_node_index;
+  if (builtin_data_parsers_.size() <= new_node_index) {
+    builtin_data_parsers_.resize(new_node_index + 1);
+  }
+  builtin_data_parsers_[new_node_index] = std::move(parse_builtin_data);
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::EnsureBuiltinDataParsed(int node_index) {
+  if (node_index >= builtin_data_parsers_.size() ||
+      !builtin_data_parsers_[node_index]) {
+    return kTfLiteOk;
+  }
+  TfLiteNode& node = nodes_and_registration_[node_index].first;
+  void* builtin_data = nullptr;
+  if (builtin_data_parsers_[node_index](&builtin_data) != kTfLiteOk) {
+    ReportOpError(&context_, node, nodes_and_registration_[node_index].second,
+                  node_index, "failed to parse builtin data");
+    return kTfLiteError;
+  }
+  node.builtin_data = builtin_data;
+  builtin_data_parsers_[node_index] = nullptr;
   return kTfLiteOk;
 }
 
@@ -1505,7 +1577,14 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     tflite::OnTfLiteOpPrepare(GetTFLiteOpName(registration), subgraph_index_,
                               node_index);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
-    const TfLiteStatus op_prepare_status = OpPrepare(registration, &node);
+    // The shapes given by the `Prepare` of a shape-stable node may have been
+    // restored from a cached plan.
+    const bool skip_prepare =
+        node_index < static_cast<int>(skip_prepare_.size()) &&
+        skip_prepare_[node_index];
+    TF_LITE_ENSURE_STATUS(EnsureBuiltinDataParsed(node_index));
+    const TfLiteStatus op_prepare_status =
+        skip_prepare ? kTfLiteOk : OpPrepare(registration, &node);
     if (op_prepare_status != kTfLiteOk) {
       ReportOpError(&context_, node, registration, node_index,
                     "failed to prepare");
@@ -1559,10 +1638,23 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
+    auto arena_planner = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
-        kDefaultTensorAlignment, subgraph_index_);
+        kDefaultTensorAlignment, subgraph_index_, ArenaGrowthFactor());
+    if (metadata_ != nullptr) {
+      auto it = metadata_->find(kOfflineMemoryAllocationMetadata);
+      if (it != metadata_->end()) {
+        arena_planner->SetOfflineOffsets(
+            ParseOfflineMemoryAllocation(it->second, subgraph_index_));
+      }
+    }
+    memory_planner_ = std::move(arena_planner);
 #endif
+    // The plan can only be reordered once every node is prepared.
+    if (next_execution_plan_index_to_prepare_ ==
+        static_cast<int>(execution_plan_.size())) {
+      PlanInterOpStages();
+    }
     memory_planner_->PlanAllocations();
   }
 
@@ -1620,6 +1712,42 @@ TfLiteStatus Subgraph::Invoke() {
   telemetry::TelemetryReportEvent(&context_, "Invoke", status);
   return status;
 }
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::InvokeImpl() {
   if (!consistent_) {
     ReportError("Invoke called on model that is not consistent.");
@@ -1640,6 +1768,14 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  if (CanInvokeInParallel()) {
+    status = InvokeInParallel();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    return status;
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1674,37 +1810,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
-    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
@@ -1842,6 +1948,7 @@ TfLiteStatus Subgraph::AddTensors(int tensors_to_add,
   if (first_new_tensor_index) *first_new_tensor_index = base_index;
   if (tensors_to_add < 0) return kTfLiteError;
   tensors_.resize(tensors_.size() + tensors_to_add);
+  shape_plans_.clear();
   for (size_t i = base_index; i < tensors_.size(); i++) {
     memset(&tensors_[i], 0, sizeof(tensors_[i]));
     tensors_[i].buffer_handle = kTfLiteNullBufferHandle;
@@ -1866,6 +1973,7 @@ TfLiteStatus Subgraph::GetNodeAndRegistration(
   auto nodes_size = nodes_and_registration_.size();
   TF_LITE_ENSURE(&context_, static_cast<size_t>(node_index) < nodes_size);
   TF_LITE_ENSURE(&context_, node != nullptr && registration != nullptr);
+  TF_LITE_ENSURE_STATUS(EnsureBuiltinDataParsed(node_index));
   auto& node_and_reg = nodes_and_registration_[node_index];
   *node = &node_and_reg.first;
   *registration = &node_and_reg.second;
@@ -1988,6 +2096,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadWrite(
   tensor.quantization = *scoped_quantization.release();
   tensor.dims_signature =
       ConvertArrayToTfLiteIntArray(ndims_signature, dims_signature);
+  shape_plans_.clear();
   return kTfLiteOk;
 }
 
@@ -1997,6 +2106,8 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  node_stages_.clear();
+  shape_plans_.clear();
   return kTfLiteOk;
 }
 
@@ -2135,6 +2246,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  node_stages_.clear();
 
   // Handling FP16 delegation (if applies).
   //
@@ -2249,6 +2361,8 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    // Every node is prepared again by `AllocateTensors`.
+    PlanInterOpStages();
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -2462,6 +2576,246 @@ void Subgraph::InitializeTensorReleaseMap() {
   }
 }
 
+bool Subgraph::IsShapeStable(const TfLiteNode& node,
+                             const TfLiteRegistration& registration) const {
+  // Kernels that keep state in `user_data` may compute more than shapes in
+  // `Prepare`.
+  if (node.user_data != nullptr || node.delegate != nullptr ||
+      registration.registration_external != nullptr) {
+    return false;
+  }
+  for (const TfLiteIntArray* tensor_indices :
+       {node.outputs, node.temporaries}) {
+    if (tensor_indices == nullptr) continue;
+    for (int i = 0; i < tensor_indices->size; ++i) {
+      const int tensor_index = tensor_indices->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      if (tensors_[tensor_index].allocation_type != kTfLiteArenaRw) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool Subgraph::RestoreShapePlan() {
+  std::vector<std::vector<int>> input_dims;
+  input_dims.reserve(inputs_.size());
+  for (int input : inputs_) {
+    if (input == kTfLiteOptionalTensor) continue;
+    input_dims.push_back(DimsVector(tensors_[input].dims));
+  }
+  auto it = std::find_if(
+      shape_plans_.begin(), shape_plans_.end(),
+      [&](const ShapePlan& plan) { return plan.input_dims == input_dims; });
+  if (it == shape_plans_.end()) return false;
+  std::rotate(shape_plans_.begin(), it, it + 1);
+  const ShapePlan& plan = shape_plans_.front();
+  for (const auto& [tensor_index, dims] : plan.tensor_dims) {
+    if (ResizeTensorImpl(&tensors_[tensor_index],
+                         ConvertVectorToTfLiteIntArray(dims)) != kTfLiteOk) {
+      // The nodes are prepared again and will report the error.
+      shape_plans_.clear();
+      return false;
+    }
+  }
+  skip_prepare_.assign(nodes_and_registration_.size(), false);
+  for (int node_index : plan.nodes) {
+    skip_prepare_[node_index] = true;
+  }
+  return true;
+}
+
+void Subgraph::RecordShapePlan() {
+  // Only a plan covering every node can be reused.
+  if (has_dynamic_tensors_ || next_execution_plan_index_to_prepare_ !=
+                                  static_cast<int>(execution_plan_.size())) {
+    return;
+  }
+  ShapePlan plan;
+  for (int input : inputs_) {
+    if (input == kTfLiteOptionalTensor) continue;
+    plan.input_dims.push_back(DimsVector(tensors_[input].dims));
+  }
+  for (int node_index : execution_plan_) {
+    const auto& [node, registration] = nodes_and_registration_[node_index];
+    if (!IsShapeStable(node, registration)) continue;
+    plan.nodes.push_back(node_index);
+    for (const TfLiteIntArray* tensor_indices :
+         {node.outputs, node.temporaries}) {
+      if (tensor_indices == nullptr) continue;
+      for (int i = 0; i < tensor_indices->size; ++i) {
+        const int tensor_index = tensor_indices->data[i];
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        plan.tensor_dims.emplace_back(tensor_index,
+                                      DimsVector(tensors_[tensor_index].dims));
+      }
+    }
+  }
+  shape_plans_.insert(shape_plans_.begin(), std::move(plan));
+  const size_t cache_size = ShapePlanCacheSize();
+  if (shape_plans_.size() > cache_size) {
+    shape_plans_.resize(cache_size);
+  }
+}
+
+void Subgraph::PlanInterOpStages() {
+  node_stages_.clear();
+  if (NumInterOpThreads() <= 1) return;
+
+  // A node runs after the last node writing one of its inputs or outputs, and
+  // after the last node reading one of its outputs. Variable inputs are
+  // written in place. Nodes which are delegated or might have side effects
+  // run alone, after every node before them.
+  const int num_nodes = static_cast<int>(execution_plan_.size());
+  std::vector<int> stages(num_nodes);
+  std::vector<int> written_stage(tensors_.size(), -1);
+  std::vector<int> read_stage(tensors_.size(), -1);
+  int first_free_stage = 0;
+  int num_stages = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    int stage = first_free_stage;
+    if (node.delegate != nullptr || node.might_have_side_effect) {
+      stage = num_stages;
+      first_free_stage = stage + 1;
+    }
+    for (int j = 0; j < node.inputs->size; ++j) {
+      const int tensor_index = node.inputs->data[j];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      stage = std::max(stage, written_stage[tensor_index] + 1);
+      if (tensors_[tensor_index].is_variable) {
+        stage = std::max(stage, read_stage[tensor_index] + 1);
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor_index = node.outputs->data[j];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      stage = std::max(stage, written_stage[tensor_index] + 1);
+      stage = std::max(stage, read_stage[tensor_index] + 1);
+    }
+    for (int j = 0; j < node.inputs->size; ++j) {
+      const int tensor_index = node.inputs->data[j];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      read_stage[tensor_index] = std::max(read_stage[tensor_index], stage);
+      if (tensors_[tensor_index].is_variable) {
+        written_stage[tensor_index] = stage;
+      }
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor_index = node.outputs->data[j];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      written_stage[tensor_index] = stage;
+    }
+    if (node.delegate != nullptr || node.might_have_side_effect) {
+      first_free_stage = stage + 1;
+    }
+    stages[i] = stage;
+    num_stages = std::max(num_stages, stage + 1);
+  }
+  // Nothing to run in parallel.
+  if (num_stages == num_nodes) return;
+
+  std::vector<int> order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return stages[a] < stages[b]; });
+  std::vector<int> execution_plan(num_nodes);
+  node_stages_.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    execution_plan[i] = execution_plan_[order[i]];
+    node_stages_[i] = stages[order[i]];
+  }
+  execution_plan_.swap(execution_plan);
+}
+
+bool Subgraph::CanInvokeInParallel() const {
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+  return false;
+#else
+  if (node_stages_.empty() || profiler_ || has_dynamic_tensors_ ||
+      next_execution_plan_index_to_prepare_ !=
+          static_cast<int>(execution_plan_.size())) {
+    return false;
+  }
+  // Dynamic temporaries are reallocated while the nodes run.
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    if (HasDynamicTensor(context_, node.temporaries, nullptr)) {
+      return false;
+    }
+  }
+  return true;
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+}
+
+TfLiteStatus Subgraph::InvokeInParallel() {
+  const int num_threads = NumInterOpThreads();
+  if (!inter_op_thread_pool_ ||
+      inter_op_thread_pool_->num_threads() != num_threads) {
+    inter_op_thread_pool_ = std::make_unique<InterOpThreadPool>(num_threads);
+    inter_op_cpu_backend_contexts_.clear();
+    for (int i = 1; i < num_threads; ++i) {
+      inter_op_cpu_backend_contexts_.push_back(
+          std::make_unique<ExternalCpuBackendContext>());
+    }
+  }
+  EnsureTensorsVectorCapacity();
+
+  std::vector<TfLiteStatus> statuses;
+  const int num_nodes = static_cast<int>(execution_plan_.size());
+  for (int first = 0; first < num_nodes;) {
+    int last = first + 1;
+    while (last < num_nodes && node_stages_[last] == node_stages_[first]) {
+      ++last;
+    }
+    for (int i = first; i < last; ++i) {
+      auto& [node, registration] = nodes_and_registration_[execution_plan_[i]];
+      TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
+      MayAllocateOpOutput(&node);
+    }
+
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+
+    statuses.assign(last - first, kTfLiteOk);
+    auto invoke_node = [&](int task, int thread) {
+      auto& [node, registration] =
+          nodes_and_registration_[execution_plan_[first + task]];
+      inter_op_cpu_backend_context =
+          thread == 0 ? nullptr
+                      : inter_op_cpu_backend_contexts_[thread - 1].get();
+      statuses[task] = OpInvoke(registration, &node);
+      inter_op_cpu_backend_context = nullptr;
+    };
+    inter_op_thread_pool_->ParallelFor(last - first, invoke_node);
+
+    for (int i = first; i < last; ++i) {
+      const int node_index = execution_plan_[i];
+      auto& [node, registration] = nodes_and_registration_[node_index];
+      if (const TfLiteStatus s = statuses[i - first]; s != kTfLiteOk) {
+        auto err = ReportOpError(&context_, node, registration, node_index,
+                                 "failed to invoke");
+        return s == kTfLiteCancelled ? s : err;
+      }
+    }
+    for (int i = first; i < last; ++i) {
+      const int node_index = execution_plan_[i];
+      MaybeReleaseDynamicTensors(nodes_and_registration_[node_index].first,
+                                 node_index);
+    }
+    first = last;
+  }
+  return kTfLiteOk;
+}
+
 void Subgraph::MaybeReleaseDynamicTensors(const TfLiteNode& node,
                                           size_t node_index) {
   if (!ShouldReleaseDynamicTensors()) return;
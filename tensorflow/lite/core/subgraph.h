@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <atomic>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -38,7 +39,9 @@ limitations under the License.
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/inter_op_thread_pool.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
@@ -119,6 +122,18 @@ class Subgraph {
                                      const TfLiteRegistration* registration,
                                      int* node_index = nullptr);
 
+  // Adds a builtin node like `AddNodeWithParameters`, but its builtin data is
+  // only produced by `parse_builtin_data` when the node is first prepared or
+  // looked up through `GetNodeAndRegistration`. The registration's `init` is
+  // called without builtin data, so ops reading it in `init` must not be
+  // added this way. Interpreter will take ownership of the parsed builtin data
+  // and destroy it with `free`.
+  TfLiteStatus AddNodeWithLazyParameters(
+      const std::vector<int>& inputs, const std::vector<int>& outputs,
+      const std::vector<int>& intermediates,
+      std::function<TfLiteStatus(void** builtin_data)> parse_builtin_data,
+      const TfLiteRegistration* registration, int* node_index = nullptr);
+
   // Adds `tensors_to_add` tensors, preserving pre-existing Tensor entries.
   // The value pointed to by `first_new_tensor_index` will be set to the
   // index of the first new tensor if `first_new_tensor_index` is non-null.
@@ -458,6 +473,32 @@ class Subgraph {
     return (options_ && options_->GetPreserveAllTensors());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Factor by which the non-persistent arena is grown when reallocated.
+  float ArenaGrowthFactor() const {
+    return options_ ? options_->GetArenaGrowthFactor() : 1.0f;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Number of input shapes for which the results of `Prepare` are kept.
+  int ShapePlanCacheSize() const {
+    return options_ ? options_->GetShapePlanCacheSize() : 0;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads used to run independent nodes at the same time.
+  int NumInterOpThreads() const {
+    return options_ ? options_->GetNumInterOpThreads() : 1;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the stage of the node at `execution_plan_index` (see
+  // `GraphInfo::node_stage`).
+  int node_stage(size_t execution_plan_index) const {
+    return node_stages_.empty() ? static_cast<int>(execution_plan_index)
+                                : node_stages_[execution_plan_index];
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // True if all intermediate dynamic tensors should be released once they are
   // not used by the model.
@@ -938,6 +979,44 @@ class Subgraph {
   // last operation that uses the tensor as input.
   void InitializeTensorReleaseMap();
 
+  // Returns true if `node` keeps no state across `Prepare`, so that the shapes
+  // `Prepare` gave to its outputs and temporaries are all it computed.
+  bool IsShapeStable(const TfLiteNode& node,
+                     const TfLiteRegistration& registration) const;
+
+  // If the shapes of the current inputs were seen before, restores the shapes
+  // of the outputs and temporaries of the shape-stable nodes, and marks these
+  // nodes so that `PrepareOpsStartingAt` does not prepare them. Returns true
+  // if the shapes were restored.
+  bool RestoreShapePlan();
+
+  // Records the shapes given by `Prepare` for the current input shapes.
+  void RecordShapePlan();
+
+  // If independent nodes may run at the same time, groups the execution plan
+  // into stages of nodes that don't depend on each other and orders the plan
+  // by stage. Otherwise clears the stages. Must be called before the memory
+  // planner plans the allocations, since the tensors used by a stage must not
+  // share memory.
+  void PlanInterOpStages();
+
+  // Returns true if the stages can be invoked in parallel: every node is
+  // prepared, no tensor is dynamic and no profiler is set.
+  bool CanInvokeInParallel() const;
+
+  // Invokes the execution plan stage by stage, running the nodes of each stage
+  // on `inter_op_thread_pool_`.
+  TfLiteStatus InvokeInParallel();
+
+  // Makes the data of the inputs of `node` readable on the CPU, and reports an
+  // error if an input lacks data.
+  TfLiteStatus EnsureNodeInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Parses the builtin data of a node added by `AddNodeWithLazyParameters`, if
+  // not done yet.
+  TfLiteStatus EnsureBuiltinDataParsed(int node_index);
+
   // May allocate dynamic tensor memory of node outputs. It's used when
   // `EnsureDynamicTensorsAreReleased` or`UseDynamicAllocationForLargeTensors`
   // API is used.
@@ -1183,6 +1262,39 @@ class Subgraph {
   // Maps tensor constant buffers used in the subgraph to a model-wide
   // identifiers.
   std::unordered_map<size_t, size_t> tensor_buffer_identifiers_;
+
+  // The results of `Prepare` for a set of input shapes.
+  struct ShapePlan {
+    std::vector<std::vector<int>> input_dims;
+    // The shape-stable nodes, whose `Prepare` is not called again.
+    std::vector<int> nodes;
+    // The shapes of their outputs and temporaries.
+    std::vector<std::pair<int, std::vector<int>>> tensor_dims;
+  };
+
+  // The cached plans, most recently used first. Holds at most
+  // `ShapePlanCacheSize()` plans, and is cleared when the graph changes.
+  std::vector<ShapePlan> shape_plans_;
+
+  // Indexed by node. Set while preparing the nodes whose shapes were restored
+  // from `shape_plans_`.
+  std::vector<bool> skip_prepare_;
+
+  // The stage of each node of the execution plan, or empty if the nodes run
+  // one at a time (see `PlanInterOpStages`).
+  std::vector<int> node_stages_;
+
+  // Runs the nodes of a stage, created on the first parallel invocation.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
+  // The CPU backend context of each thread of `inter_op_thread_pool_` but the
+  // calling one, since kernels can't share one across threads.
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      inter_op_cpu_backend_contexts_;
+
+  // Indexed by node. Parses the builtin data of the nodes added by
+  // `AddNodeWithLazyParameters` whose builtin data wasn't needed yet.
+  std::vector<std::function<TfLiteStatus(void**)>> builtin_data_parsers_;
 };
 
 }  // namespace tflite
@@ -36,9 +36,14 @@ OptionalAndroidHardwareBuffer::OptionalAndroidHardwareBuffer() {
       dlsym(dlopen_handle_, "AHardwareBuffer_describe"));
   is_supported_ = reinterpret_cast<decltype(is_supported_)>(
       dlsym(dlopen_handle_, "AHardwareBuffer_isSupported"));
+  lock_ = reinterpret_cast<decltype(lock_)>(
+      dlsym(dlopen_handle_, "AHardwareBuffer_lock"));
+  unlock_ = reinterpret_cast<decltype(unlock_)>(
+      dlsym(dlopen_handle_, "AHardwareBuffer_unlock"));
   supported_ =
       (allocate_ != nullptr && acquire_ != nullptr && release_ != nullptr &&
-       describe_ != nullptr && is_supported_ != nullptr);
+       describe_ != nullptr && is_supported_ != nullptr && lock_ != nullptr &&
+       unlock_ != nullptr);
 #else
   dlopen_handle_ = nullptr;
   allocate_ = nullptr;
@@ -46,6 +51,8 @@ OptionalAndroidHardwareBuffer::OptionalAndroidHardwareBuffer() {
   release_ = nullptr;
   describe_ = nullptr;
   is_supported_ = nullptr;
+  lock_ = nullptr;
+  unlock_ = nullptr;
   supported_ = false;
 #endif
 }
@@ -38,6 +38,16 @@ struct AHardwareBuffer_Desc {
   uint32_t rfu0;
   uint64_t rfu1;
 };
+
+// Values of the Android NDK AHardwareBuffer_Format and
+// AHardwareBuffer_UsageFlags enums used by TFLite.
+enum {
+  AHARDWAREBUFFER_FORMAT_BLOB = 0x21,
+};
+enum {
+  AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN = 3UL,
+  AHARDWAREBUFFER_USAGE_CPU_WRITE_OFTEN = 3UL << 4,
+};
 }  // extern "C"
 #endif  // __ANDROID__
 
@@ -53,6 +63,8 @@ namespace tflite::gpu {
 //   - function AHardwareBuffer_acquire
 //   - function AHardwareBuffer_release
 //   - function AHardwareBuffer_describe
+//   - function AHardwareBuffer_lock
+//   - function AHardwareBuffer_unlock
 //   - library libnativewindow.so (for the above features)
 //
 // For documentation on these features, see
@@ -105,6 +117,21 @@ class OptionalAndroidHardwareBuffer {
     return describe_(buffer, desc);
   }
 
+  // Like AHardwareBuffer_lock.
+  // Caller must check that Supported() returns true before calling this
+  // function.
+  int Lock(AHardwareBuffer* buffer, uint64_t usage, int32_t fence,
+           void** address) {
+    return lock_(buffer, usage, fence, /*rect=*/nullptr, address);
+  }
+
+  // Like AHardwareBuffer_unlock.
+  // Caller must check that Supported() returns true before calling this
+  // function.
+  int Unlock(AHardwareBuffer* buffer, int32_t* fence) {
+    return unlock_(buffer, fence);
+  }
+
  private:
   void* dlopen_handle_;
   int (*is_supported_)(const AHardwareBuffer_Desc* desc);
@@ -112,6 +139,9 @@ class OptionalAndroidHardwareBuffer {
   void (*acquire_)(AHardwareBuffer* buffer);
   void (*release_)(AHardwareBuffer* buffer);
   void (*describe_)(AHardwareBuffer* buffer, AHardwareBuffer_Desc* desc);
+  int (*lock_)(AHardwareBuffer* buffer, uint64_t usage, int32_t fence,
+               const void* rect, void** address);
+  int (*unlock_)(AHardwareBuffer* buffer, int32_t* fence);
   bool supported_;
 
   OptionalAndroidHardwareBuffer();
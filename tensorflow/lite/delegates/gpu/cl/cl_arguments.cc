@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/delegates/gpu/cl/cl_arguments.h"
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -531,95 +532,50 @@ std::string CLArguments::GetListOfArgs() {
 }
 
 absl::Status CLArguments::Bind(cl_kernel kernel, int offset) {
+  return VisitKernelArgs(
+      offset, [kernel](int index, size_t size, const void* value) {
+        const int error_code = clSetKernelArg(kernel, index, size, value);
+        if (error_code != CL_SUCCESS) {
+          return absl::UnknownError(absl::StrCat(
+              "Failed to set kernel arguments - ",
+              CLErrorCodeToString(error_code), "(at index - ", index, ")"));
+        }
+        return absl::OkStatus();
+      });
+}
+
+absl::Status CLArguments::VisitKernelArgs(
+    int offset,
+    const std::function<absl::Status(int, size_t, const void*)>& visit) {
   for (auto& t : buffers_) {
-    const int error_code =
-        clSetKernelArg(kernel, offset, sizeof(cl_mem), &t.second.memory);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(visit(offset++, sizeof(cl_mem), &t.second.memory));
   }
   for (auto& t : image_buffers_) {
-    const int error_code =
-        clSetKernelArg(kernel, offset, sizeof(cl_mem), &t.second.memory);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(visit(offset++, sizeof(cl_mem), &t.second.memory));
   }
   for (auto& t : images2d_) {
-    const int error_code =
-        clSetKernelArg(kernel, offset, sizeof(cl_mem), &t.second.memory);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(visit(offset++, sizeof(cl_mem), &t.second.memory));
   }
   for (auto& t : image2d_arrays_) {
-    const int error_code =
-        clSetKernelArg(kernel, offset, sizeof(cl_mem), &t.second.memory);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(visit(offset++, sizeof(cl_mem), &t.second.memory));
   }
   for (auto& t : images3d_) {
-    const int error_code =
-        clSetKernelArg(kernel, offset, sizeof(cl_mem), &t.second.memory);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(visit(offset++, sizeof(cl_mem), &t.second.memory));
   }
   for (auto& t : custom_memories_) {
-    const int error_code =
-        clSetKernelArg(kernel, offset, sizeof(cl_mem), &t.second.memory);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(visit(offset++, sizeof(cl_mem), &t.second.memory));
   }
   for (int i = 0; i < shared_int4s_data_.size() / 4; ++i) {
-    const int error_code = clSetKernelArg(kernel, offset, sizeof(int32_t) * 4,
-                                          &shared_int4s_data_[i * 4]);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(
+        visit(offset++, sizeof(int32_t) * 4, &shared_int4s_data_[i * 4]));
   }
   for (int i = 0; i < shared_float4s_data_.size() / 4; ++i) {
-    const int error_code = clSetKernelArg(kernel, offset, sizeof(int32_t) * 4,
-                                          &shared_float4s_data_[i * 4]);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(
+        visit(offset++, sizeof(int32_t) * 4, &shared_float4s_data_[i * 4]));
   }
   for (int i = 0; i < shared_half4s_data_.size() / 4; ++i) {
-    const int error_code = clSetKernelArg(kernel, offset, sizeof(int16_t) * 4,
-                                          &shared_half4s_data_[i * 4]);
-    if (error_code != CL_SUCCESS) {
-      return absl::UnknownError(absl::StrCat(
-          "Failed to set kernel arguments - ", CLErrorCodeToString(error_code),
-          "(at index - ", offset, ")"));
-    }
-    offset++;
+    RETURN_IF_ERROR(
+        visit(offset++, sizeof(int16_t) * 4, &shared_half4s_data_[i * 4]));
   }
   return absl::OkStatus();
 }
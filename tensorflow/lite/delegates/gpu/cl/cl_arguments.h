@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_DELEGATES_GPU_CL_CL_ARGUMENTS_H_
 #define TENSORFLOW_LITE_DELEGATES_GPU_CL_CL_ARGUMENTS_H_
 
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -52,6 +53,12 @@ class CLArguments : public ArgumentsBinder {
 
   absl::Status Bind(cl_kernel kernel, int offset = 0);
 
+  // Calls `visit` with the index, size and value of every kernel argument,
+  // with indices starting at `offset`. Bind() sets the arguments this way.
+  absl::Status VisitKernelArgs(
+      int offset,
+      const std::function<absl::Status(int, size_t, const void*)>& visit);
+
   // Compares Int, Float, Half names to values mapping with the mapping in
   // `other` and returns true if they are the same.
   bool HasEqualScalarArguments(const CLArguments& other) const;
@@ -49,12 +49,25 @@ void CLCommandBuffer::Release() {
 }
 
 absl::Status CLCommandBuffer::Init(CLCommandQueue* queue,
-                                   bool simultaneous_use) {
+                                   bool simultaneous_use,
+                                   bool mutable_dispatch) {
   cl_int errcode_ret = CL_SUCCESS;
-  std::vector<cl_command_buffer_properties_khr> properties;
+  cl_command_buffer_flags_khr flags = 0;
   if (simultaneous_use) {
+    flags |= CL_COMMAND_BUFFER_SIMULTANEOUS_USE_KHR;
+  }
+  if (mutable_dispatch) {
+#ifdef cl_khr_command_buffer_mutable_dispatch
+    flags |= CL_COMMAND_BUFFER_MUTABLE_KHR;
+#else
+    return absl::UnimplementedError(
+        "cl_khr_command_buffer_mutable_dispatch is not available.");
+#endif
+  }
+  std::vector<cl_command_buffer_properties_khr> properties;
+  if (flags != 0) {
     properties.push_back(CL_COMMAND_BUFFER_FLAGS_KHR);
-    properties.push_back(CL_COMMAND_BUFFER_SIMULTANEOUS_USE_KHR);
+    properties.push_back(flags);
   }
   properties.push_back(0);
   cl_command_buffer_properties_khr* properties_ptr =
@@ -93,6 +106,37 @@ absl::Status CLCommandBuffer::Enqueue(CLCommandQueue* queue, CLEvent* event) {
   return absl::OkStatus();
 }
 
+#ifdef cl_khr_command_buffer_mutable_dispatch
+absl::Status CLCommandBuffer::UpdateKernelArgs(
+    cl_mutable_command_khr command,
+    const std::vector<cl_mutable_dispatch_arg_khr>& args) {
+  cl_mutable_dispatch_config_khr config = {};
+  config.command = command;
+  config.num_args = args.size();
+  config.arg_list = args.data();
+#ifdef CL_STRUCTURE_TYPE_MUTABLE_BASE_CONFIG_KHR
+  config.type = CL_STRUCTURE_TYPE_MUTABLE_DISPATCH_CONFIG_KHR;
+  cl_mutable_base_config_khr base_config = {};
+  base_config.type = CL_STRUCTURE_TYPE_MUTABLE_BASE_CONFIG_KHR;
+  base_config.num_mutable_dispatch = 1;
+  base_config.mutable_dispatch_list = &config;
+  cl_int errcode_ret = clUpdateMutableCommandsKHR(cb_, &base_config);
+#else
+  const cl_command_buffer_update_type_khr config_type =
+      CL_STRUCTURE_TYPE_MUTABLE_DISPATCH_CONFIG_KHR;
+  const void* configs[] = {&config};
+  cl_int errcode_ret =
+      clUpdateMutableCommandsKHR(cb_, 1, &config_type, configs);
+#endif
+  if (errcode_ret != CL_SUCCESS) {
+    return absl::InternalError(
+        absl::StrCat("Failed clUpdateMutableCommandsKHR.",
+                     CLErrorCodeToString(errcode_ret)));
+  }
+  return absl::OkStatus();
+}
+#endif
+
 }  // namespace cl
 }  // namespace gpu
 }  // namespace tflite
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_DELEGATES_GPU_CL_CL_COMMAND_BUFFER_H_
 #define TENSORFLOW_LITE_DELEGATES_GPU_CL_CL_COMMAND_BUFFER_H_
 
+#include <vector>
+
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_event.h"
 #include "tensorflow/lite/delegates/gpu/cl/opencl_wrapper.h"
@@ -36,11 +38,21 @@ class CLCommandBuffer {
 
   ~CLCommandBuffer() { Release(); }
 
-  absl::Status Init(CLCommandQueue* queue, bool simultaneous_use = false);
+  // With mutable_dispatch, kernel commands recorded as mutable can have their
+  // arguments updated after Finalize(), see UpdateKernelArgs().
+  absl::Status Init(CLCommandQueue* queue, bool simultaneous_use = false,
+                    bool mutable_dispatch = false);
   absl::Status Finalize();
   absl::Status Enqueue(CLCommandQueue* queue, CLEvent* event = nullptr);
   cl_command_buffer_khr GetCommandBuffer() const { return cb_; }
 
+#ifdef cl_khr_command_buffer_mutable_dispatch
+  // Replaces arguments of the recorded kernel command `command`.
+  absl::Status UpdateKernelArgs(
+      cl_mutable_command_khr command,
+      const std::vector<cl_mutable_dispatch_arg_khr>& args);
+#endif
+
  private:
   void Release();
   cl_command_buffer_khr cb_ = nullptr;
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/strings/str_cat.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_arguments.h"
+#include "tensorflow/lite/delegates/gpu/cl/cl_command_buffer.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_context.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_device.h"
@@ -75,7 +76,12 @@ class ClOperation {
                            operation_->work_group_size_);
   }
 
-  absl::Status AddToCommandBuffer(cl_command_buffer_khr cb) {
+  // With a non-null `mutable_command`, the kernel arguments of the recorded
+  // command can be updated later, and its handle is returned there. That
+  // needs a command buffer created with mutable dispatch.
+  absl::Status AddToCommandBuffer(
+      cl_command_buffer_khr cb,
+      cl_mutable_command_khr* mutable_command = nullptr) {
     RETURN_IF_ERROR(cl_args_.Bind(kernel_.kernel()));
     std::array<size_t, 3> local;
     std::array<size_t, 3> global;
@@ -84,9 +90,23 @@ class ClOperation {
       global[i] =
           operation_->GetWorkGroupsCount()[i] * operation_->work_group_size_[i];
     }
+    const cl_ndrange_kernel_command_properties_khr* properties = nullptr;
+#ifdef cl_khr_command_buffer_mutable_dispatch
+    const cl_ndrange_kernel_command_properties_khr mutable_properties[] = {
+        CL_MUTABLE_DISPATCH_UPDATABLE_FIELDS_KHR,
+        CL_MUTABLE_DISPATCH_ARGUMENTS_KHR, 0};
+    if (mutable_command) {
+      properties = mutable_properties;
+    }
+#else
+    if (mutable_command) {
+      return absl::UnimplementedError(
+          "cl_khr_command_buffer_mutable_dispatch is not available.");
+    }
+#endif
     const int error_code = clCommandNDRangeKernelKHR(
-        cb, nullptr, nullptr, kernel_.kernel(), 3, nullptr, global.data(),
-        local.data(), 0, nullptr, nullptr, nullptr);
+        cb, nullptr, properties, kernel_.kernel(), 3, nullptr, global.data(),
+        local.data(), 0, nullptr, nullptr, mutable_command);
     if (error_code != CL_SUCCESS) {
       return absl::UnknownError(
           absl::StrCat("Failed to clCommandNDRangeKernelKHR - ",
@@ -95,6 +115,21 @@ class ClOperation {
     return absl::OkStatus();
   }
 
+#ifdef cl_khr_command_buffer_mutable_dispatch
+  // Updates the arguments of a command recorded with AddToCommandBuffer() to
+  // the current ones, after changes of inputs/outputs.
+  absl::Status UpdateCommandBufferArgs(CLCommandBuffer* cb,
+                                       cl_mutable_command_khr command) {
+    std::vector<cl_mutable_dispatch_arg_khr> args;
+    RETURN_IF_ERROR(cl_args_.VisitKernelArgs(
+        0, [&args](int index, size_t size, const void* value) {
+          args.push_back({static_cast<cl_uint>(index), size, value});
+          return absl::OkStatus();
+        }));
+    return cb->UpdateKernelArgs(command, args);
+  }
+#endif
+
   absl::Status AddToQueue(ProfilingCommandQueue* queue, CLEvent* event) {
     RETURN_IF_ERROR(cl_args_.Bind(kernel_.kernel()));
     return queue->CLCommandQueue::Dispatch(kernel_,
@@ -51,6 +51,7 @@ limitations under the License.
 #include "tensorflow/lite/delegates/gpu/common/task/tensor_desc.h"
 #include "tensorflow/lite/delegates/gpu/common/types.h"
 #include "tensorflow/lite/delegates/gpu/common/util.h"
+#include "tensorflow/lite/tools/logging.h"
 
 namespace tflite {
 namespace gpu {
@@ -266,6 +267,14 @@ absl::Status ClarifyWithCommandBuffer(ProfilingCommandQueue* queue,
   return absl::OkStatus();
 }
 
+bool SupportsMutableDispatch(const GpuInfo& gpu_info) {
+#ifdef cl_khr_command_buffer_mutable_dispatch
+  return gpu_info.SupportsExtension("cl_khr_command_buffer_mutable_dispatch");
+#else
+  return false;
+#endif
+}
+
 }  // namespace
 
 void InferenceContext::ExecutionHints::Init(const GpuInfo& gpu_info) {
@@ -318,11 +327,6 @@ absl::Status InferenceContext::InitFromGpuModel(
                                  &create_info, &env->context()));
 
   gpu_info_ = env->device().GetInfo();
-  if (gpu_info_.opencl_info.IsCLVK() &&
-      gpu_info_.SupportsExtension("cl_khr_command_buffer")) {
-    use_command_buffer_ = true;
-  }
-
   InitFromGpuModel(gpu_model);
 
   CreationContext creation_context;
@@ -413,6 +417,7 @@ absl::Status InferenceContext::RestoreDeserialized(
   RETURN_IF_ERROR(tflite::gpu::Decode(decoded_fb->gpu_model(), &gpu_model));
   RETURN_IF_ERROR(AllocateMemory(gpu_model, env->GetDevicePtr()->GetInfo(),
                                  create_info, &env->context()));
+  gpu_info_ = env->device().GetInfo();
   InitFromGpuModel(&gpu_model);
 
   // deserializing kernels into program_cache
@@ -475,9 +480,14 @@ void InferenceContext::InitFromGpuModel(GpuModel* gpu_model) {
   for (const auto& output : gpu_model->output_ids_and_refs) {
     output_ids_.push_back(output.first);
   }
-  if (use_command_buffer_) {
-    command_buffer_ = nullptr;
-  }
+  // Where supported, the whole inference is recorded once into a command
+  // buffer, which every AddToQueue() then enqueues, instead of enqueuing every
+  // kernel. With mutable dispatch, SetTensor() updates the recorded kernel
+  // arguments; otherwise it makes the next AddToQueue() record again.
+  use_command_buffer_ = gpu_info_.SupportsExtension("cl_khr_command_buffer");
+  use_mutable_dispatch_ =
+      use_command_buffer_ && SupportsMutableDispatch(gpu_info_);
+  command_buffer_ = nullptr;
   nodes_.resize(gpu_model->nodes.size());
   for (int i = 0; i < gpu_model->nodes.size(); ++i) {
     nodes_[i].cl_operation.Init(std::move(gpu_model->nodes[i].gpu_operation));
@@ -822,9 +832,36 @@ absl::Status InferenceContext::SetTensor(const ValueId& tensor_id,
       }
     }
   }
+  if (command_buffer_) {
+    if (!use_mutable_dispatch_) {
+      // The next AddToQueue() records the kernels with the new tensor.
+      command_buffer_ = nullptr;
+    } else if (absl::Status status =
+                   UpdateCommandBuffer(external_tensor_to_nodes_[tensor_id]);
+               !status.ok()) {
+      TFLITE_LOG(WARNING) << "Failed to update the recorded command buffer, "
+                             "it is recorded again on the next run: "
+                          << status.message();
+      command_buffer_ = nullptr;
+    }
+  }
   return absl::OkStatus();
 }
 
+absl::Status InferenceContext::UpdateCommandBuffer(
+    const std::vector<int>& node_indices) {
+#ifdef cl_khr_command_buffer_mutable_dispatch
+  for (int node_index : node_indices) {
+    RETURN_IF_ERROR(nodes_[node_index].cl_operation.UpdateCommandBufferArgs(
+        command_buffer_.get(), mutable_commands_[node_index]));
+  }
+  return absl::OkStatus();
+#else
+  return absl::UnimplementedError(
+      "cl_khr_command_buffer_mutable_dispatch is not available.");
+#endif
+}
+
 void InferenceContext::PrepareExternal() {
   for (auto& external : external_mutable_tensors_) {
     for (int i = 0; i < nodes_.size(); ++i) {
@@ -850,10 +887,20 @@ void InferenceContext::PrepareExternal() {
 
 absl::Status InferenceContext::AddCommandBufferToQueue(CLCommandQueue* queue) {
   if (command_buffer_ == nullptr) {
-    command_buffer_ = std::make_unique<CLCommandBuffer>();
-    RETURN_IF_ERROR(command_buffer_->Init(queue));
-    RETURN_IF_ERROR(AddToCommandBuffer(command_buffer_->GetCommandBuffer()));
-    RETURN_IF_ERROR(command_buffer_->Finalize());
+    auto command_buffer = std::make_unique<CLCommandBuffer>();
+    RETURN_IF_ERROR(command_buffer->Init(queue, /*simultaneous_use=*/false,
+                                         use_mutable_dispatch_));
+    if (use_mutable_dispatch_) {
+      mutable_commands_.resize(nodes_.size());
+      for (int i = 0; i < nodes_.size(); ++i) {
+        RETURN_IF_ERROR(nodes_[i].cl_operation.AddToCommandBuffer(
+            command_buffer->GetCommandBuffer(), &mutable_commands_[i]));
+      }
+    } else {
+      RETURN_IF_ERROR(AddToCommandBuffer(command_buffer->GetCommandBuffer()));
+    }
+    RETURN_IF_ERROR(command_buffer->Finalize());
+    command_buffer_ = std::move(command_buffer);
   }
   RETURN_IF_ERROR(command_buffer_->Enqueue(queue));
   return absl::OkStatus();
@@ -876,9 +923,31 @@ absl::Status InferenceContext::AddToQueue(CLCommandQueue* queue) {
     RETURN_IF_ERROR(
         queue->EnqueueEvent(&execution_hints_.prev_enqueue_start_point));
   }
+  bool enqueued = false;
   if (use_command_buffer_) {
-    RETURN_IF_ERROR(AddCommandBufferToQueue(queue));
-  } else {
+    absl::Status status = AddCommandBufferToQueue(queue);
+    if (!status.ok() && command_buffer_ == nullptr && use_mutable_dispatch_) {
+      TFLITE_LOG(WARNING) << "Failed to record a mutable command buffer, "
+                             "recording an immutable one: "
+                          << status.message();
+      use_mutable_dispatch_ = false;
+      status = AddCommandBufferToQueue(queue);
+    }
+    if (status.ok()) {
+      enqueued = true;
+    } else if (command_buffer_ == nullptr) {
+      TFLITE_LOG(WARNING) << "Failed to record a command buffer, enqueuing "
+                             "the kernels one by one from now on: "
+                          << status.message();
+      use_command_buffer_ = false;
+    } else {
+      // E.g. the recorded buffer is still pending from the previous run.
+      TFLITE_LOG(WARNING) << "Failed to enqueue the recorded command buffer, "
+                             "enqueuing the kernels one by one for this run: "
+                          << status.message();
+    }
+  }
+  if (!enqueued) {
     int counter = 0;
     for (auto& node : nodes_) {
       RETURN_IF_ERROR(node.cl_operation.AddToQueue(queue));
@@ -158,6 +158,9 @@ class InferenceContext {
                                             ProfilingInfo* result);
 
   absl::Status AddCommandBufferToQueue(CLCommandQueue* queue);
+  // Updates the recorded commands of the given nodes after changes of their
+  // inputs/outputs.
+  absl::Status UpdateCommandBuffer(const std::vector<int>& node_indices);
 
   struct ExecutionHints {
     bool need_flush = false;
@@ -208,7 +211,10 @@ class InferenceContext {
   std::unique_ptr<RecordableQueue> recordable_queue_ = nullptr;
 
   bool use_command_buffer_ = false;
+  bool use_mutable_dispatch_ = false;
   std::unique_ptr<CLCommandBuffer> command_buffer_ = nullptr;
+  // Recorded kernel command of every node, with mutable dispatch.
+  std::vector<cl_mutable_command_khr> mutable_commands_;
 
   GpuInfo gpu_info_;
 };
@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/inference_context.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/gpu/cl/cl_test.h"
+#include "tensorflow/lite/delegates/gpu/cl/tensor.h"
+#include "tensorflow/lite/delegates/gpu/common/data_type.h"
+#include "tensorflow/lite/delegates/gpu/common/gpu_model.h"
+#include "tensorflow/lite/delegates/gpu/common/model.h"
+#include "tensorflow/lite/delegates/gpu/common/operations.h"
+#include "tensorflow/lite/delegates/gpu/common/precision.h"
+#include "tensorflow/lite/delegates/gpu/common/shape.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+#include "tensorflow/lite/delegates/gpu/common/task/tensor_desc.h"
+#include "tensorflow/lite/delegates/gpu/common/tensor.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+// Runs a ReLU graph whose input is an external mutable tensor. Where the
+// device supports cl_khr_command_buffer, the inference is recorded into a
+// command buffer, which must follow the input set with SetTensor(), and fall
+// back to enqueuing the kernels when it cannot be enqueued.
+class InferenceContextTest : public OpenCLTest {
+ protected:
+  void SetUp() override {
+    OpenCLTest::SetUp();
+    Value* input = graph_.NewValue();
+    input->tensor.type = DataType::FLOAT32;
+    input->tensor.shape = shape_;
+    Value* output = graph_.NewValue();
+    output->tensor.type = DataType::FLOAT32;
+    output->tensor.shape = shape_;
+    Node* relu = graph_.NewNode();
+    relu->operation.type = ToString(OperationType::RELU);
+    relu->operation.attributes = ReLUAttributes();
+    ASSERT_OK(graph_.AddConsumer(relu->id, input->id));
+    ASSERT_OK(graph_.SetProducer(relu->id, output->id));
+    input_id_ = input->id;
+    output_id_ = output->id;
+
+    CreateGpuModelInfo create_info;
+    create_info.precision = CalculationsPrecision::F32;
+    create_info.storage_type = TensorStorageType::BUFFER;
+    input_descriptor_ = CreateHwcTensorDescriptor(
+        DataType::FLOAT32, TensorStorageType::BUFFER,
+        HWC(shape_.h, shape_.w, shape_.c));
+    create_info.external_mutable_tensors[input_id_] = input_descriptor_;
+    ASSERT_OK(context_.InitFromGraph(create_info, graph_, &env_));
+  }
+
+  // Creates an input tensor holding `values`.
+  void CreateInput(const std::vector<float>& values, Tensor* input) {
+    ASSERT_OK(CreateTensor(env_.context(), input_descriptor_, input));
+    TensorFloat32 data;
+    data.shape = shape_;
+    data.data = values;
+    TensorDescriptor descriptor_with_data = input_descriptor_;
+    descriptor_with_data.UploadData(data);
+    ASSERT_OK(input->UploadDescriptorData(descriptor_with_data, env_.queue()));
+  }
+
+  // Checks that the output is the ReLU of `values`.
+  void ExpectOutputIsReluOf(const std::vector<float>& values) {
+    ASSERT_OK(env_.queue()->WaitForCompletion());
+    TensorFloat32 output;
+    ASSERT_OK(context_.GetOutputTensor(output_id_, env_.queue(), &output));
+    std::vector<float> expected(values.size());
+    std::transform(values.begin(), values.end(), expected.begin(),
+                   [](float value) { return std::max(value, 0.0f); });
+    EXPECT_THAT(output.data, Pointwise(FloatNear(0.0f), expected));
+  }
+
+  const BHWC shape_ = BHWC(1, 2, 2, 4);
+  GraphFloat32 graph_;
+  ValueId input_id_;
+  ValueId output_id_;
+  TensorDescriptor input_descriptor_;
+  InferenceContext context_;
+};
+
+std::vector<float> Values(float start) {
+  std::vector<float> values(16);
+  for (int i = 0; i < values.size(); ++i) {
+    values[i] = start + (i % 2 == 0 ? i : -i);
+  }
+  return values;
+}
+
+TEST_F(InferenceContextTest, RunsWithTheInputSetBeforeEachRun) {
+  Tensor a, b;
+  CreateInput(Values(1.0f), &a);
+  CreateInput(Values(-2.0f), &b);
+  for (int run = 0; run < 2; ++run) {
+    ASSERT_OK(context_.SetTensor(input_id_, &a));
+    ASSERT_OK(context_.AddToQueue(env_.queue()));
+    ExpectOutputIsReluOf(Values(1.0f));
+    ASSERT_OK(context_.SetTensor(input_id_, &b));
+    ASSERT_OK(context_.AddToQueue(env_.queue()));
+    ExpectOutputIsReluOf(Values(-2.0f));
+  }
+}
+
+// A recorded command buffer is pending until it completes, and can't be
+// enqueued again before. The kernels are then enqueued one by one instead.
+TEST_F(InferenceContextTest, RunsBackToBack) {
+  Tensor input;
+  CreateInput(Values(3.0f), &input);
+  ASSERT_OK(context_.SetTensor(input_id_, &input));
+  for (int run = 0; run < 4; ++run) {
+    ASSERT_OK(context_.AddToQueue(env_.queue()));
+  }
+  ExpectOutputIsReluOf(Values(3.0f));
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
@@ -177,6 +177,10 @@ void LoadOpenCLFunctionExtensions(cl_platform_id platform_id) {
   LoadFunctionExtension(platform_id, clEnqueueCommandBufferKHR);
   LoadFunctionExtension(platform_id, clCommandNDRangeKernelKHR);
   LoadFunctionExtension(platform_id, clGetCommandBufferInfoKHR);
+#ifdef cl_khr_command_buffer_mutable_dispatch
+  // cl_khr_command_buffer_mutable_dispatch extension
+  LoadFunctionExtension(platform_id, clUpdateMutableCommandsKHR);
+#endif
 }
 
 #ifdef __WINDOWS__
@@ -439,6 +443,11 @@ PFN_clEnqueueCommandBufferKHR clEnqueueCommandBufferKHR;
 PFN_clCommandNDRangeKernelKHR clCommandNDRangeKernelKHR;
 PFN_clGetCommandBufferInfoKHR clGetCommandBufferInfoKHR;
 
+#ifdef cl_khr_command_buffer_mutable_dispatch
+// cl_khr_command_buffer_mutable_dispatch extension
+PFN_clUpdateMutableCommandsKHR clUpdateMutableCommandsKHR;
+#endif
+
 DEFINE_QCOM_FUNCTION_PTRS
 
 cl_mem CreateImage2DLegacy(cl_context context, cl_mem_flags flags,
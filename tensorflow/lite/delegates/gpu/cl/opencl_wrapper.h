@@ -561,6 +561,21 @@ typedef cl_int(CL_API_CALL *PFN_clGetCommandBufferInfoKHR)(
     cl_command_buffer_info_khr /*param_name*/, size_t /*param_value_size*/,
     void * /*param_value*/, size_t * /*param_value_size_ret*/);
 
+#ifdef cl_khr_command_buffer_mutable_dispatch
+// cl_khr_command_buffer_mutable_dispatch, whose update entry point changed
+// from a chain of base configs to an array of configs in the headers.
+#ifdef CL_STRUCTURE_TYPE_MUTABLE_BASE_CONFIG_KHR
+typedef cl_int(CL_API_CALL *PFN_clUpdateMutableCommandsKHR)(
+    cl_command_buffer_khr /*command_buffer*/,
+    const cl_mutable_base_config_khr * /*mutable_config*/);
+#else
+typedef cl_int(CL_API_CALL *PFN_clUpdateMutableCommandsKHR)(
+    cl_command_buffer_khr /*command_buffer*/, cl_uint /*num_configs*/,
+    const cl_command_buffer_update_type_khr * /*config_types*/,
+    const void ** /*configs*/);
+#endif
+#endif
+
 extern PFN_clGetPlatformIDs clGetPlatformIDs;
 extern PFN_clGetPlatformInfo clGetPlatformInfo;
 extern PFN_clGetDeviceIDs clGetDeviceIDs;
@@ -688,6 +703,11 @@ extern PFN_clEnqueueCommandBufferKHR clEnqueueCommandBufferKHR;
 extern PFN_clCommandNDRangeKernelKHR clCommandNDRangeKernelKHR;
 extern PFN_clGetCommandBufferInfoKHR clGetCommandBufferInfoKHR;
 
+#ifdef cl_khr_command_buffer_mutable_dispatch
+// cl_khr_command_buffer_mutable_dispatch extension
+extern PFN_clUpdateMutableCommandsKHR clUpdateMutableCommandsKHR;
+#endif
+
 // For convenient image creation
 // It uses clCreateImage if it available (clCreateImage available since cl 1.2)
 // otherwise it will use legacy clCreateImage2D
@@ -18,8 +18,10 @@ limitations under the License.
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/builtin_ops.h"
@@ -138,6 +140,71 @@ std::vector<int> GraphPartitionHelper::GetNodesOfFirstNLargestPartitionsImpl(
   return ops_to_replace;
 }
 
+double GraphPartitionHelper::EstimateDelegationGain(
+    const TfLiteDelegateParams& partition,
+    const PartitionCostModel& cost_model) const {
+  double gain = -cost_model.partition_overhead;
+  for (int node_index : TfLiteIntArrayView(partition.nodes_to_replace)) {
+    TfLiteNode* node;
+    TfLiteRegistration* registration;
+    if (context_->GetNodeAndRegistration(context_, node_index, &node,
+                                         &registration) != kTfLiteOk) {
+      return -std::numeric_limits<double>::infinity();
+    }
+    gain += cost_model.cpu_latency(context_, node_index, node, registration) -
+            cost_model.delegate_latency(context_, node_index, node,
+                                        registration);
+  }
+
+  size_t transferred_bytes = 0;
+  if (partition.input_tensors != nullptr) {
+    for (int tensor_index : TfLiteIntArrayView(partition.input_tensors)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      // Constant tensors are only copied once, when the delegate is prepared.
+      const TfLiteTensor& tensor = context_->tensors[tensor_index];
+      if (tensor.allocation_type == kTfLiteMmapRo) continue;
+      transferred_bytes += tensor.bytes;
+    }
+  }
+  if (partition.output_tensors != nullptr) {
+    for (int tensor_index : TfLiteIntArrayView(partition.output_tensors)) {
+      transferred_bytes += context_->tensors[tensor_index].bytes;
+    }
+  }
+  return gain - cost_model.transfer_latency_per_byte * transferred_bytes;
+}
+
+std::vector<TfLiteDelegateParams*> GraphPartitionHelper::GetPartitionsByCost(
+    const PartitionCostModel& cost_model, int n) const {
+  std::vector<std::pair<double, TfLiteDelegateParams*>> gains;
+  for (TfLiteDelegateParams* partition : partitions_) {
+    const double gain = EstimateDelegationGain(*partition, cost_model);
+    if (gain > 0) gains.emplace_back(gain, partition);
+  }
+  // Keeps the order of the partitions for equal gains.
+  std::stable_sort(gains.begin(), gains.end(),
+                   [](const auto& left, const auto& right) {
+                     return left.first > right.first;
+                   });
+
+  std::vector<TfLiteDelegateParams*> results;
+  for (int i = 0; i < std::min<int>(gains.size(), n); ++i) {
+    results.push_back(gains[i].second);
+  }
+  return results;
+}
+
+std::vector<int> GraphPartitionHelper::GetNodesOfPartitionsByCost(
+    const PartitionCostModel& cost_model, int n) const {
+  std::vector<int> ops_to_replace;
+  for (const auto p : GetPartitionsByCost(cost_model, n)) {
+    auto nodes = p->nodes_to_replace;
+    ops_to_replace.insert(ops_to_replace.end(), nodes->data,
+                          nodes->data + nodes->size);
+  }
+  return ops_to_replace;
+}
+
 TfLiteStatus GraphPartitionHelper::PrepareSupportedNodes(
     std::set<std::string>* unsupported_nodes_info, int start_node_index,
     int end_node_index) {
@@ -96,6 +96,26 @@ using IsNodeSupportedFn =
     std::function<bool(TfLiteContext*, TfLiteNode*, TfLiteRegistration*,
                        std::string* unsupported_details)>;
 
+// Estimated latencies used to choose the partitions to delegate by cost, in
+// any unit as long as all of them use the same one. They can be measured, e.g.
+// by profiling the model on the CPU and with the delegate using the benchmark
+// tool, or come from an analytical model of the device.
+struct PartitionCostModel {
+  using NodeLatencyFn = std::function<double(
+      TfLiteContext* context, int node_index, TfLiteNode* node,
+      TfLiteRegistration* registration)>;
+
+  // Latency of a node on the CPU, and in the delegate.
+  NodeLatencyFn cpu_latency;
+  NodeLatencyFn delegate_latency;
+  // Latency of copying one byte of a tensor between the CPU and the delegate,
+  // in either direction.
+  double transfer_latency_per_byte = 0;
+  // Fixed latency of each delegated partition, e.g. to dispatch its kernels
+  // and wait for their completion.
+  double partition_overhead = 0;
+};
+
 // A utility class to help model graph parition.
 // Note the class *needs* to be used in TfLiteDelegate::Prepare.
 class GraphPartitionHelper {
@@ -149,6 +169,29 @@ class GraphPartitionHelper {
     return GetNodesOfFirstNLargestPartitionsImpl(n, min_nodes_per_partition);
   }
 
+  // Returns the latency saved by delegating `partition` rather than running
+  // its nodes on the CPU, under `cost_model`. The cost of delegating includes
+  // copying the non-constant inputs and the outputs of the partition. The
+  // result is negative if the partition is faster on the CPU.
+  double EstimateDelegationGain(const TfLiteDelegateParams& partition,
+                                const PartitionCostModel& cost_model) const;
+
+  // Returns the partitions that are faster delegated than on the CPU under
+  // `cost_model`, at most `n` of them, ranked by the latency they save.
+  // Partitions only exchange tensors through the CPU, so their gains add up,
+  // and this choice minimizes the total estimated latency. Unlike
+  // GetFirstNLargestPartitions, small but expensive partitions are preferred
+  // over large but cheap ones, and partitions not worth their transfers are
+  // left to the CPU.
+  std::vector<TfLiteDelegateParams*> GetPartitionsByCost(
+      const PartitionCostModel& cost_model,
+      int n = std::numeric_limits<int>::max()) const;
+
+  // Returns the node indices of the partitions from GetPartitionsByCost.
+  std::vector<int> GetNodesOfPartitionsByCost(
+      const PartitionCostModel& cost_model,
+      int n = std::numeric_limits<int>::max()) const;
+
   int num_total_nodes() const { return num_total_nodes_; }
   int num_supported_nodes() const { return num_supported_nodes_; }
   int num_partitions() const { return partitions_.size(); }
@@ -98,9 +98,15 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context,
   delegates::GraphPartitionHelper helper(context, node_supported_fn);
   TF_LITE_ENSURE_STATUS(helper.Partition(nullptr));
 
-  std::vector<int> supported_nodes = helper.GetNodesOfFirstNLargestPartitions(
-      delegate_options.max_delegated_partitions,
-      delegate_options.min_nodes_per_partition);
+  const delegates::PartitionCostModel& cost_model =
+      delegate_options.partition_cost_model;
+  std::vector<int> supported_nodes =
+      cost_model.cpu_latency && cost_model.delegate_latency
+          ? helper.GetNodesOfPartitionsByCost(
+                cost_model, delegate_options.max_delegated_partitions)
+          : helper.GetNodesOfFirstNLargestPartitions(
+                delegate_options.max_delegated_partitions,
+                delegate_options.min_nodes_per_partition);
 
   TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                        "%s delegate: %d nodes delegated out of %d nodes with "
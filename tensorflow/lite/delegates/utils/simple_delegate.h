@@ -35,6 +35,7 @@ limitations under the License.
 #include <utility>
 
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/utils.h"
 
 namespace tflite {
 
@@ -86,6 +87,12 @@ class SimpleDelegateInterface {
     // The minimum number of nodes allowed in a delegated graph, values <=0
     // means unlimited.
     int min_nodes_per_partition = 0;
+
+    // If its latencies are set, the delegated partitions are the ones that
+    // save latency under this model, ranked by the latency they save (see
+    // GraphPartitionHelper::GetPartitionsByCost), instead of the largest
+    // ones. `min_nodes_per_partition` is then ignored.
+    delegates::PartitionCostModel partition_cost_model;
   };
 
   virtual ~SimpleDelegateInterface() = default;
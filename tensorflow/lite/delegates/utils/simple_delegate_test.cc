@@ -21,7 +21,9 @@ limitations under the License.
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/delegates/utils.h"
 #include "tensorflow/lite/delegates/utils/dummy_delegate/dummy_delegate.h"
+#include "tensorflow/lite/delegates/utils/simple_delegate.h"
 #include "tensorflow/lite/interpreter.h"
 
 namespace tflite {
@@ -126,5 +128,85 @@ TEST_F(TestDelegate, DelegateFailedInit) {
   ASSERT_EQ(kTfLiteDelegateError,
             interpreter_->ModifyGraphWithDelegate(std::move(delegate)));
 }
+
+// Delegates ADD nodes, choosing the partitions with a cost model. Its kernels
+// do nothing.
+class CostModelDelegate : public SimpleDelegateInterface {
+ public:
+  explicit CostModelDelegate(delegates::PartitionCostModel cost_model)
+      : cost_model_(std::move(cost_model)) {}
+
+  bool IsNodeSupportedByDelegate(const TfLiteRegistration* registration,
+                                 const TfLiteNode* node,
+                                 TfLiteContext* context) const override {
+    return registration->builtin_code == kTfLiteBuiltinAdd;
+  }
+  TfLiteStatus Initialize(TfLiteContext* context) override { return kTfLiteOk; }
+  const char* Name() const override { return "CostModelDelegate"; }
+  std::unique_ptr<SimpleDelegateKernelInterface>
+  CreateDelegateKernelInterface() override {
+    return std::make_unique<Kernel>();
+  }
+  SimpleDelegateInterface::Options DelegateOptions() const override {
+    SimpleDelegateInterface::Options options;
+    options.partition_cost_model = cost_model_;
+    return options;
+  }
+
+ private:
+  class Kernel : public SimpleDelegateKernelInterface {
+    TfLiteStatus Init(TfLiteContext* context,
+                      const TfLiteDelegateParams* params) override {
+      return kTfLiteOk;
+    }
+    TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) override {
+      return kTfLiteOk;
+    }
+    TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) override {
+      return kTfLiteOk;
+    }
+  };
+
+  const delegates::PartitionCostModel cost_model_;
+};
+
+// Each node takes `cpu_latency` on the CPU and 1 in the delegate, and each
+// partition adds `partition_overhead`.
+delegates::PartitionCostModel ConstantCostModel(double cpu_latency,
+                                                double partition_overhead) {
+  delegates::PartitionCostModel cost_model;
+  cost_model.cpu_latency = [cpu_latency](TfLiteContext*, int, TfLiteNode*,
+                                         TfLiteRegistration*) {
+    return cpu_latency;
+  };
+  cost_model.delegate_latency = [](TfLiteContext*, int, TfLiteNode*,
+                                   TfLiteRegistration*) { return 1.0; };
+  cost_model.partition_overhead = partition_overhead;
+  return cost_model;
+}
+
+TEST_F(TestDelegate, DelegatesPartitionsThatSaveLatency) {
+  // The three nodes save 3 units delegated, more than the overhead.
+  auto delegate = TfLiteDelegateFactory::Create(
+      std::make_unique<CostModelDelegate>(ConstantCostModel(
+          /*cpu_latency=*/2, /*partition_overhead=*/2)));
+  ASSERT_EQ(kTfLiteOk,
+            interpreter_->ModifyGraphWithDelegate(std::move(delegate)));
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  const auto* node_and_reg =
+      interpreter_->node_and_registration(interpreter_->execution_plan()[0]);
+  EXPECT_STREQ("CostModelDelegate", node_and_reg->second.custom_name);
+}
+
+TEST_F(TestDelegate, KeepsPartitionsNotWorthTheirOverheadOnCpu) {
+  // The three nodes save 3 units delegated, less than the overhead.
+  auto delegate = TfLiteDelegateFactory::Create(
+      std::make_unique<CostModelDelegate>(ConstantCostModel(
+          /*cpu_latency=*/2, /*partition_overhead=*/4)));
+  ASSERT_EQ(kTfLiteOk,
+            interpreter_->ModifyGraphWithDelegate(std::move(delegate)));
+  EXPECT_EQ(interpreter_->execution_plan().size(), 3);
+}
+
 }  // namespace
 }  // namespace tflite
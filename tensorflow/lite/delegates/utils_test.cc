@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/lite/array.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
 
@@ -252,6 +253,82 @@ TEST(GraphPartitionHelper, CheckPartitions) {
   EXPECT_THAT(nodes, testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
 }
 
+// Node i takes i units on the CPU and 1 unit in the delegate.
+PartitionCostModel NodeIndexCostModel() {
+  PartitionCostModel cost_model;
+  cost_model.cpu_latency = [](TfLiteContext*, int node_index, TfLiteNode*,
+                              TfLiteRegistration*) { return node_index; };
+  cost_model.delegate_latency = [](TfLiteContext*, int, TfLiteNode*,
+                                   TfLiteRegistration*) { return 1.0; };
+  return cost_model;
+}
+
+TEST(GraphPartitionHelper, CheckPartitionsByCost) {
+  // The mocked TfLiteContext has 4 partitions: {1}, {0,3,7,8}, {2,4,9}, {5,6},
+  // which save 0, 14, 12 and 9 units when delegated.
+  MockTfLiteContext mocked_context;
+  GraphPartitionHelper helper(&mocked_context, IsNodeSupported);
+  EXPECT_EQ(kTfLiteOk, helper.Partition(nullptr));
+  PartitionCostModel cost_model = NodeIndexCostModel();
+
+  EXPECT_THAT(helper.GetNodesOfPartitionsByCost(cost_model),
+              testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9, 5, 6}));
+  EXPECT_THAT(helper.GetNodesOfPartitionsByCost(cost_model, 1),
+              testing::ElementsAreArray({0, 3, 7, 8}));
+
+  // With the overhead, only the first two partitions are worth delegating.
+  cost_model.partition_overhead = 10;
+  auto partitions = helper.GetPartitionsByCost(cost_model);
+  EXPECT_EQ(2, partitions.size());
+  EXPECT_DOUBLE_EQ(4, helper.EstimateDelegationGain(*partitions[0], cost_model));
+  EXPECT_DOUBLE_EQ(2, helper.EstimateDelegationGain(*partitions[1], cost_model));
+  EXPECT_THAT(GetNodesToReplaceFromPartitions(partitions),
+              testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
+
+  // Delegating the smaller {2,4,9} saves more than {0,3,7,8} when the CPU is
+  // slow at some of its nodes.
+  cost_model.partition_overhead = 0;
+  cost_model.cpu_latency = [](TfLiteContext*, int node_index, TfLiteNode*,
+                              TfLiteRegistration*) {
+    return node_index == 2 || node_index == 4 ? 20.0 : 2.0;
+  };
+  EXPECT_THAT(helper.GetNodesOfPartitionsByCost(cost_model, 1),
+              testing::ElementsAreArray({2, 4, 9}));
+}
+
+TEST(GraphPartitionHelper, CheckDelegationGainWithTransfers) {
+  MockTfLiteContext mocked_context;
+  TfLiteTensor tensors[4] = {};
+  tensors[0].bytes = 100;
+  tensors[0].allocation_type = kTfLiteArenaRw;
+  // A constant input, which is not transferred on each invocation.
+  tensors[1].bytes = 1000;
+  tensors[1].allocation_type = kTfLiteMmapRo;
+  tensors[2].bytes = 50;
+  tensors[2].allocation_type = kTfLiteArenaRw;
+  tensors[3].bytes = 10;
+  tensors[3].allocation_type = kTfLiteArenaRw;
+  mocked_context.tensors = tensors;
+  mocked_context.tensors_size = 4;
+  GraphPartitionHelper helper(&mocked_context, IsNodeSupported);
+
+  IntArrayUniquePtr nodes = BuildTfLiteArray<int>({2, 4, 9});
+  IntArrayUniquePtr inputs =
+      BuildTfLiteArray<int>({0, 1, kTfLiteOptionalTensor});
+  IntArrayUniquePtr outputs = BuildTfLiteArray<int>({2, 3});
+  TfLiteDelegateParams partition{};
+  partition.nodes_to_replace = nodes.get();
+  partition.input_tensors = inputs.get();
+  partition.output_tensors = outputs.get();
+
+  PartitionCostModel cost_model = NodeIndexCostModel();
+  cost_model.transfer_latency_per_byte = 0.1;
+  // Saves 12 units of compute, and transfers 160 bytes.
+  EXPECT_DOUBLE_EQ(-4, helper.EstimateDelegationGain(partition, cost_model));
+  cost_model.transfer_latency_per_byte = 0.05;
+  EXPECT_DOUBLE_EQ(4, helper.EstimateDelegationGain(partition, cost_model));
+}
+
 TfLiteStatus ErrorGetExecutionPlan(TfLiteContext* context,
                                    TfLiteIntArray** execution_plan) {
   return kTfLiteError;
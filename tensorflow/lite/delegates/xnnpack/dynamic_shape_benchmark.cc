@@ -0,0 +1,212 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares the cost of a change of input shape when the XNNPACK delegate
+// reshapes its runtime, with the cost of creating the delegated interpreter
+// again, for a transformer-like feed-forward block over a variable number of
+// tokens.
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+constexpr int32_t kChannels = 256;
+constexpr int32_t kHiddenChannels = 4 * kChannels;
+
+using DelegatePtr =
+    std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>;
+
+// Builds a model computing FC(FC(input)) on an input of shape
+// [1, tokens, kChannels], with kHiddenChannels channels in between.
+std::vector<char> CreateFeedForwardModel() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+  flatbuffers::FlatBufferBuilder builder;
+  const std::array<flatbuffers::Offset<OperatorCode>, 1> operator_codes{
+      {CreateOperatorCode(builder, BuiltinOperator_FULLY_CONNECTED)}};
+
+  std::vector<flatbuffers::Offset<Buffer>> buffers{
+      {CreateBuffer(builder, builder.CreateVector({}))}};
+  auto add_weights = [&](int32_t size) {
+    std::vector<float> data(size);
+    for (float& value : data) value = dist(rng);
+    buffers.push_back(CreateBuffer(
+        builder,
+        builder.CreateVector(reinterpret_cast<const uint8_t*>(data.data()),
+                             sizeof(float) * data.size())));
+    return static_cast<uint32_t>(buffers.size() - 1);
+  };
+
+  std::vector<flatbuffers::Offset<Tensor>> tensors;
+  auto add_tensor = [&](const std::vector<int32_t>& shape, uint32_t buffer) {
+    tensors.push_back(CreateTensor(builder, builder.CreateVector(shape),
+                                   TensorType_FLOAT32, buffer));
+    return static_cast<int32_t>(tensors.size() - 1);
+  };
+  const int32_t input = add_tensor({1, 1, kChannels}, 0);
+  const int32_t filter_1 =
+      add_tensor({kHiddenChannels, kChannels},
+                 add_weights(kHiddenChannels * kChannels));
+  const int32_t bias_1 =
+      add_tensor({kHiddenChannels}, add_weights(kHiddenChannels));
+  const int32_t hidden = add_tensor({1, 1, kHiddenChannels}, 0);
+  const int32_t filter_2 =
+      add_tensor({kChannels, kHiddenChannels},
+                 add_weights(kChannels * kHiddenChannels));
+  const int32_t bias_2 = add_tensor({kChannels}, add_weights(kChannels));
+  const int32_t output = add_tensor({1, 1, kChannels}, 0);
+
+  std::vector<flatbuffers::Offset<Operator>> operators;
+  auto add_fully_connected = [&](int32_t input, int32_t filter, int32_t bias,
+                                 int32_t output,
+                                 ActivationFunctionType activation) {
+    const std::array<int32_t, 3> op_inputs{{input, filter, bias}};
+    const std::array<int32_t, 1> op_outputs{{output}};
+    operators.push_back(CreateOperator(
+        builder, /*opcode_index=*/0,
+        builder.CreateVector<int32_t>(op_inputs.data(), op_inputs.size()),
+        builder.CreateVector<int32_t>(op_outputs.data(), op_outputs.size()),
+        BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder, activation,
+                                    FullyConnectedOptionsWeightsFormat_DEFAULT,
+                                    /*keep_num_dims=*/true)
+            .Union()));
+  };
+  add_fully_connected(input, filter_1, bias_1, hidden,
+                      ActivationFunctionType_RELU);
+  add_fully_connected(hidden, filter_2, bias_2, output,
+                      ActivationFunctionType_NONE);
+
+  const std::array<int32_t, 1> subgraph_inputs{{input}};
+  const std::array<int32_t, 1> subgraph_outputs{{output}};
+  const flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors.data(), tensors.size()),
+      builder.CreateVector<int32_t>(subgraph_inputs.data(),
+                                    subgraph_inputs.size()),
+      builder.CreateVector<int32_t>(subgraph_outputs.data(),
+                                    subgraph_outputs.size()),
+      builder.CreateVector(operators.data(), operators.size()));
+  builder.Finish(CreateModel(
+      builder, TFLITE_SCHEMA_VERSION,
+      builder.CreateVector(operator_codes.data(), operator_codes.size()),
+      builder.CreateVector(&subgraph, 1),
+      builder.CreateString("Feed-forward model"),
+      builder.CreateVector(buffers.data(), buffers.size())));
+  return std::vector<char>(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+}
+
+DelegatePtr CreateDelegate() {
+  TfLiteXNNPackDelegateOptions options = TfLiteXNNPackDelegateOptionsDefault();
+  options.num_threads = 1;
+  options.flags |= TFLITE_XNNPACK_DELEGATE_FLAG_ENABLE_SUBGRAPH_RESHAPING;
+  return DelegatePtr(TfLiteXNNPackDelegateCreate(&options),
+                     TfLiteXNNPackDelegateDelete);
+}
+
+// Creates an interpreter for `model` delegated to `delegate`, with `tokens`
+// input tokens.
+std::unique_ptr<Interpreter> CreateInterpreter(const std::vector<char>& model,
+                                               TfLiteDelegate* delegate,
+                                               int tokens) {
+  std::unique_ptr<Interpreter> interpreter;
+  CHECK_EQ(InterpreterBuilder(
+               GetModel(model.data()),
+               ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+               &interpreter),
+           kTfLiteOk);
+  CHECK_EQ(interpreter->ResizeInputTensor(interpreter->inputs()[0],
+                                          {1, tokens, kChannels}),
+           kTfLiteOk);
+  CHECK_EQ(interpreter->ModifyGraphWithDelegate(delegate), kTfLiteOk);
+  CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  return interpreter;
+}
+
+// The number of tokens alternates between the argument and half of it, so
+// that every iteration changes the input shape.
+int Tokens(const benchmark::State& state, int64_t iteration) {
+  const int tokens = state.range(0);
+  return iteration % 2 == 0 ? tokens : tokens / 2;
+}
+
+// Reference: invokes with a fixed shape.
+void BM_FixedShape(benchmark::State& state) {
+  const std::vector<char> model = CreateFeedForwardModel();
+  DelegatePtr delegate = CreateDelegate();
+  std::unique_ptr<Interpreter> interpreter =
+      CreateInterpreter(model, delegate.get(), state.range(0));
+  for (auto _ : state) {
+    CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
+  }
+}
+
+// Changes the shape of the existing interpreter, which reshapes the XNNPACK
+// runtime and reallocates its workspace.
+void BM_ReshapeRuntime(benchmark::State& state) {
+  const std::vector<char> model = CreateFeedForwardModel();
+  DelegatePtr delegate = CreateDelegate();
+  std::unique_ptr<Interpreter> interpreter =
+      CreateInterpreter(model, delegate.get(), Tokens(state, 1));
+  int64_t iteration = 0;
+  for (auto _ : state) {
+    CHECK_EQ(interpreter->ResizeInputTensor(
+                 interpreter->inputs()[0],
+                 {1, Tokens(state, iteration++), kChannels}),
+             kTfLiteOk);
+    CHECK_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+    CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
+  }
+}
+
+// Creates the delegate and the interpreter again for each shape, which creates
+// a new XNNPACK runtime and packs the weights again.
+void BM_RecreateRuntime(benchmark::State& state) {
+  const std::vector<char> model = CreateFeedForwardModel();
+  int64_t iteration = 0;
+  for (auto _ : state) {
+    DelegatePtr delegate = CreateDelegate();
+    std::unique_ptr<Interpreter> interpreter =
+        CreateInterpreter(model, delegate.get(), Tokens(state, iteration++));
+    CHECK_EQ(interpreter->Invoke(), kTfLiteOk);
+  }
+}
+
+BENCHMARK(BM_FixedShape)->RangeMultiplier(4)->Range(8, 512);
+BENCHMARK(BM_ReshapeRuntime)->RangeMultiplier(4)->Range(8, 512);
+BENCHMARK(BM_RecreateRuntime)->RangeMultiplier(4)->Range(8, 512);
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
+
+BENCHMARK_MAIN();
@@ -0,0 +1,175 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "tensorflow/compiler/mlir/lite/schema/schema_conversion_utils.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+constexpr int32_t kChannels = 4;
+
+// Builds a model with two inputs and two outputs:
+// - ADD(input, input) of shape [1, tokens, kChannels], which is delegated;
+// - SHAPE(other_input), which XNNPACK does not support and stays on the CPU.
+// Resizing `other_input` makes TFLite prepare the delegate kernel again while
+// the shape of its input stays the same.
+std::vector<char> BuildModel() {
+  flatbuffers::FlatBufferBuilder builder;
+  const std::array<flatbuffers::Offset<OperatorCode>, 2> operator_codes{
+      {CreateOperatorCode(builder, BuiltinOperator_ADD),
+       CreateOperatorCode(builder, BuiltinOperator_SHAPE)}};
+  const std::array<flatbuffers::Offset<Buffer>, 1> buffers{
+      {CreateBuffer(builder, builder.CreateVector({}))}};
+
+  const std::vector<int32_t> input_shape{1, 1, kChannels};
+  const std::vector<int32_t> other_input_shape{1};
+  const std::vector<int32_t> shape_shape{1};
+  const std::array<flatbuffers::Offset<Tensor>, 4> tensors{{
+      CreateTensor(builder, builder.CreateVector(input_shape),
+                   TensorType_FLOAT32),
+      CreateTensor(builder, builder.CreateVector(input_shape),
+                   TensorType_FLOAT32),
+      CreateTensor(builder, builder.CreateVector(other_input_shape),
+                   TensorType_FLOAT32),
+      CreateTensor(builder, builder.CreateVector(shape_shape),
+                   TensorType_INT32),
+  }};
+
+  const std::array<int32_t, 2> add_inputs{{0, 0}};
+  const std::array<int32_t, 1> add_outputs{{1}};
+  const std::array<int32_t, 1> shape_inputs{{2}};
+  const std::array<int32_t, 1> shape_outputs{{3}};
+  const std::array<flatbuffers::Offset<Operator>, 2> operators{{
+      CreateOperator(
+          builder, /*opcode_index=*/0,
+          builder.CreateVector<int32_t>(add_inputs.data(), add_inputs.size()),
+          builder.CreateVector<int32_t>(add_outputs.data(),
+                                        add_outputs.size()),
+          BuiltinOptions_AddOptions, CreateAddOptions(builder).Union()),
+      CreateOperator(
+          builder, /*opcode_index=*/1,
+          builder.CreateVector<int32_t>(shape_inputs.data(),
+                                        shape_inputs.size()),
+          builder.CreateVector<int32_t>(shape_outputs.data(),
+                                        shape_outputs.size()),
+          BuiltinOptions_ShapeOptions,
+          CreateShapeOptions(builder, TensorType_INT32).Union()),
+  }};
+
+  const std::array<int32_t, 2> subgraph_inputs{{0, 2}};
+  const std::array<int32_t, 2> subgraph_outputs{{1, 3}};
+  const flatbuffers::Offset<SubGraph> subgraph = CreateSubGraph(
+      builder, builder.CreateVector(tensors.data(), tensors.size()),
+      builder.CreateVector<int32_t>(subgraph_inputs.data(),
+                                    subgraph_inputs.size()),
+      builder.CreateVector<int32_t>(subgraph_outputs.data(),
+                                    subgraph_outputs.size()),
+      builder.CreateVector(operators.data(), operators.size()));
+  builder.Finish(CreateModel(
+      builder, TFLITE_SCHEMA_VERSION,
+      builder.CreateVector(operator_codes.data(), operator_codes.size()),
+      builder.CreateVector(&subgraph, 1),
+      builder.CreateString("Subgraph reshaping model"),
+      builder.CreateVector(buffers.data(), buffers.size())));
+  return std::vector<char>(builder.GetBufferPointer(),
+                           builder.GetBufferPointer() + builder.GetSize());
+}
+
+// Fills the input with `tokens` tokens, invokes the interpreter and checks
+// the output of the delegated ADD.
+void InvokeAndCheck(Interpreter* interpreter, int tokens) {
+  const int size = tokens * kChannels;
+  float* input = interpreter->typed_input_tensor<float>(0);
+  for (int i = 0; i < size; ++i) {
+    input[i] = static_cast<float>(i) - 0.5f * size;
+  }
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+
+  const TfLiteTensor* output = interpreter->output_tensor(0);
+  ASSERT_EQ(output->dims->size, 3);
+  EXPECT_EQ(output->dims->data[0], 1);
+  EXPECT_EQ(output->dims->data[1], tokens);
+  EXPECT_EQ(output->dims->data[2], kChannels);
+  const float* output_data = interpreter->typed_output_tensor<float>(0);
+  for (int i = 0; i < size; ++i) {
+    EXPECT_EQ(output_data[i], 2.0f * input[i]) << "at index " << i;
+  }
+}
+
+TEST(SubgraphReshaping, PrepareWithSameShapeThenResize) {
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.flags |=
+      TFLITE_XNNPACK_DELEGATE_FLAG_ENABLE_SUBGRAPH_RESHAPING;
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+                       TfLiteXNNPackDelegateDelete);
+
+  const std::vector<char> buffer = BuildModel();
+  const Model* model = GetModel(buffer.data());
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(
+          model,
+          ::tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates())(
+          &interpreter),
+      kTfLiteOk);
+  ASSERT_TRUE(interpreter);
+  ASSERT_EQ(interpreter->ModifyGraphWithDelegate(xnnpack_delegate.get()),
+            kTfLiteOk);
+  // Only the ADD is delegated.
+  ASSERT_EQ(interpreter->execution_plan().size(), 2);
+
+  ASSERT_EQ(interpreter->ResizeInputTensor(interpreter->inputs()[0],
+                                           {1, 3, kChannels}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  InvokeAndCheck(interpreter.get(), 3);
+
+  // Prepares the delegate kernel again with the same input shape.
+  ASSERT_EQ(interpreter->ResizeInputTensor(interpreter->inputs()[1], {5}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  InvokeAndCheck(interpreter.get(), 3);
+  EXPECT_EQ(interpreter->typed_output_tensor<int32_t>(1)[0], 5);
+
+  // Then changes the input shape, and back.
+  for (int tokens : {7, 1, 3}) {
+    ASSERT_EQ(interpreter->ResizeInputTensor(interpreter->inputs()[0],
+                                             {1, tokens, kChannels}),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+    InvokeAndCheck(interpreter.get(), tokens);
+  }
+}
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
@@ -1174,8 +1174,14 @@ class Subgraph {
       }
     }
 
-    if (enable_subgraph_reshaping) {
+    // TFLite prepares the delegate kernel again whenever a tensor before it is
+    // resized, or on every invoke after a dynamic tensor, even if its inputs
+    // keep their shapes. Reshaping the runtime, and setting it up again, is
+    // then wasted.
+    if (enable_subgraph_reshaping && InputShapesChanged(context)) {
       xnn_status status = xnn_status_invalid_state;
+      // Forces a reshape on the next call if this one fails.
+      input_shapes_.clear();
       for (int i = 0; i < inputs_.size(); ++i) {
         const TfLiteTensor* tensor = &context->tensors[inputs_[i]];
         const int dims_count = NumDimensions(tensor);
@@ -1223,10 +1229,28 @@ class Subgraph {
           return kTfLiteError;
         }
       }
+      for (int input : inputs_) {
+        const TfLiteIntArray* dims = context->tensors[input].dims;
+        input_shapes_.emplace_back(dims->data, dims->data + dims->size);
+      }
     }
     return kTfLiteOk;
   }
 
+  // Returns whether the shapes of the inputs differ from the ones the runtime
+  // was last reshaped for.
+  bool InputShapesChanged(const TfLiteContext* context) const {
+    if (input_shapes_.size() != inputs_.size()) return true;
+    for (int i = 0; i < inputs_.size(); ++i) {
+      const TfLiteIntArray* dims = context->tensors[inputs_[i]].dims;
+      if (!std::equal(input_shapes_[i].begin(), input_shapes_[i].end(),
+                      dims->data, dims->data + dims->size)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   TfLiteStatus Invoke(TfLiteContext* context, bool enable_subgraph_reshaping,
                       Delegate* delegate) {
     std::lock_guard<std::mutex> lock(delegate->workspace_mutex_);
@@ -7559,6 +7583,9 @@ class Subgraph {
   // Mapping from TFLite Tensor IDs for tensors in the delegated subgraph to
   // the XNNPACK ID.
   std::unordered_map<int, uint32_t> tflite_tensor_to_xnnpack_;
+  // The shapes of `inputs_` when the runtime was last reshaped, or empty if it
+  // was not reshaped yet.
+  std::vector<std::vector<int>> input_shapes_;
   // Memory location to use for 0-size external tensors, as TFLite init their
   // data pointer to nullptr, and XNNPACK requires valid data pointers.
   char dummy_data_{0};
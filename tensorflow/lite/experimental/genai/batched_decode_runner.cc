@@ -0,0 +1,416 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/genai/batched_decode_runner.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/signature_runner.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace genai {
+namespace {
+
+int NumElements(const TfLiteTensor* tensor) {
+  int num_elements = 1;
+  for (int i = 0; i < tensor->dims->size; ++i) {
+    num_elements *= tensor->dims->data[i];
+  }
+  return num_elements;
+}
+
+}  // namespace
+
+KVCacheBlockPool::KVCacheBlockPool(int num_blocks, int block_size,
+                                   int num_caches, int entry_size)
+    : block_size_(block_size),
+      num_caches_(num_caches),
+      entry_size_(entry_size),
+      data_(static_cast<size_t>(num_blocks) * num_caches * block_size *
+            entry_size) {
+  // Hand out the lowest blocks first.
+  for (int block = num_blocks - 1; block >= 0; --block) {
+    free_blocks_.push_back(block);
+  }
+}
+
+int KVCacheBlockPool::Allocate() {
+  if (free_blocks_.empty()) return -1;
+  const int block = free_blocks_.back();
+  free_blocks_.pop_back();
+  return block;
+}
+
+void KVCacheBlockPool::Free(int block) { free_blocks_.push_back(block); }
+
+BatchedDecodeRunner::BatchedDecodeRunner(SignatureRunner* runner,
+                                         Options options)
+    : runner_(runner), options_(std::move(options)) {}
+
+BatchedDecodeRunner::~BatchedDecodeRunner() = default;
+
+TfLiteStatus BatchedDecodeRunner::Init() {
+  if (!caches_.empty()) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "BatchedDecodeRunner is initialized.");
+    return kTfLiteError;
+  }
+  if (options_.kv_cache_inputs.empty() ||
+      options_.kv_cache_inputs.size() != options_.kv_cache_outputs.size()) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Expected as many KV cache inputs as outputs, got %zu and "
+                    "%zu.",
+                    options_.kv_cache_inputs.size(),
+                    options_.kv_cache_outputs.size());
+    return kTfLiteError;
+  }
+  if (options_.block_size <= 0 || options_.num_blocks <= 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Invalid KV cache pool of %d blocks of %d.",
+                    options_.num_blocks, options_.block_size);
+    return kTfLiteError;
+  }
+
+  // All the caches must be (B, S, N, H) float tensors of the same shape.
+  for (const std::string& name : options_.kv_cache_inputs) {
+    const TfLiteTensor* cache = runner_->input_tensor(name.c_str());
+    if (cache == nullptr || cache->type != kTfLiteFloat32 ||
+        cache->dims->size != 4) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "KV cache '%s' is not a float input of rank 4.",
+                      name.c_str());
+      return kTfLiteError;
+    }
+    const int entry_size = cache->dims->data[2] * cache->dims->data[3];
+    if (batch_size_ == 0) {
+      batch_size_ = cache->dims->data[0];
+      cache_size_ = cache->dims->data[1];
+      entry_size_ = entry_size;
+    } else if (cache->dims->data[0] != batch_size_ ||
+               cache->dims->data[1] != cache_size_ ||
+               entry_size != entry_size_) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "KV cache '%s' does not match the shape of the others.",
+                      name.c_str());
+      return kTfLiteError;
+    }
+  }
+  if (batch_size_ <= 0 || cache_size_ <= 0 || entry_size_ <= 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "KV caches are empty.");
+    return kTfLiteError;
+  }
+
+  const TfLiteTensor* tokens =
+      runner_->input_tensor(options_.tokens_input.c_str());
+  if (tokens == nullptr || tokens->type != kTfLiteInt32 ||
+      NumElements(tokens) != batch_size_) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Input '%s' must hold %d int32 tokens.",
+                    options_.tokens_input.c_str(), batch_size_);
+    return kTfLiteError;
+  }
+  const TfLiteTensor* positions =
+      runner_->input_tensor(options_.positions_input.c_str());
+  if (positions == nullptr || positions->type != kTfLiteInt64 ||
+      NumElements(positions) != batch_size_) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Input '%s' must hold %d int64 positions.",
+                    options_.positions_input.c_str(), batch_size_);
+    return kTfLiteError;
+  }
+  if (!options_.attention_mask_input.empty()) {
+    const TfLiteTensor* mask =
+        runner_->input_tensor(options_.attention_mask_input.c_str());
+    if (mask == nullptr || mask->type != kTfLiteFloat32 ||
+        NumElements(mask) != batch_size_ * cache_size_) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Input '%s' must hold a float mask of %d positions for "
+                      "each of the %d batch entries.",
+                      options_.attention_mask_input.c_str(), cache_size_,
+                      batch_size_);
+      return kTfLiteError;
+    }
+  }
+
+  // Bind each cache input and its output to the same buffer, which
+  // `odml.update_external_kv_cache` then updates in place.
+  const size_t cache_elements =
+      static_cast<size_t>(batch_size_) * cache_size_ * entry_size_;
+  for (int i = 0; i < options_.kv_cache_inputs.size(); ++i) {
+    // Padded so that the cache can start at an aligned address.
+    cache_buffers_.emplace_back(
+        cache_elements + kDefaultTensorAlignment / sizeof(float), 0.0f);
+    const uintptr_t address =
+        reinterpret_cast<uintptr_t>(cache_buffers_.back().data());
+    float* cache = reinterpret_cast<float*>(
+        (address + kDefaultTensorAlignment - 1) / kDefaultTensorAlignment *
+        kDefaultTensorAlignment);
+    caches_.push_back(cache);
+    const TfLiteCustomAllocation allocation = {cache,
+                                               cache_elements * sizeof(float)};
+    TF_LITE_ENSURE_STATUS(runner_->SetCustomAllocationForInputTensor(
+        options_.kv_cache_inputs[i].c_str(), allocation));
+    TF_LITE_ENSURE_STATUS(runner_->SetCustomAllocationForOutputTensor(
+        options_.kv_cache_outputs[i].c_str(), allocation));
+  }
+  TF_LITE_ENSURE_STATUS(runner_->AllocateTensors());
+
+  const TfLiteTensor* logits =
+      runner_->output_tensor(options_.logits_output.c_str());
+  if (logits == nullptr || logits->type != kTfLiteFloat32 ||
+      logits->dims->size == 0 || logits->dims->data[0] != batch_size_) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Output '%s' must be float logits for each of the %d "
+                    "batch entries.",
+                    options_.logits_output.c_str(), batch_size_);
+    return kTfLiteError;
+  }
+
+  pool_ = std::make_unique<KVCacheBlockPool>(
+      options_.num_blocks, options_.block_size, caches_.size(), entry_size_);
+  slot_owners_.assign(batch_size_, -1);
+  return kTfLiteOk;
+}
+
+TfLiteStatus BatchedDecodeRunner::AddSequence(int id) {
+  if (pool_ == nullptr || !sequences_.emplace(id, Sequence()).second) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Cannot add sequence %d.", id);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+void BatchedDecodeRunner::RemoveSequence(int id) {
+  auto it = sequences_.find(id);
+  if (it == sequences_.end()) return;
+  for (int block : it->second.blocks) {
+    pool_->Free(block);
+  }
+  std::replace(slot_owners_.begin(), slot_owners_.end(), id, -1);
+  pending_.erase(std::remove(pending_.begin(), pending_.end(), id),
+                 pending_.end());
+  sequences_.erase(it);
+}
+
+TfLiteStatus BatchedDecodeRunner::Enqueue(int id, int32_t token) {
+  auto it = sequences_.find(id);
+  if (it == sequences_.end()) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Unknown sequence %d.", id);
+    return kTfLiteError;
+  }
+  Sequence& sequence = it->second;
+  if (sequence.has_pending_token) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Sequence %d already has a pending token.", id);
+    return kTfLiteError;
+  }
+  sequence.pending_token = token;
+  sequence.has_pending_token = true;
+  pending_.push_back(id);
+  return kTfLiteOk;
+}
+
+void BatchedDecodeRunner::Evict(int id, std::vector<int>* evicted) {
+  RemoveSequence(id);
+  evicted->push_back(id);
+}
+
+bool BatchedDecodeRunner::EvictForBlock(const std::vector<int>& batch,
+                                        std::vector<int>* evicted) {
+  int victim = -1;
+  int64_t victim_step = std::numeric_limits<int64_t>::max();
+  for (const auto& [id, sequence] : sequences_) {
+    if (sequence.blocks.empty() || sequence.last_step >= victim_step ||
+        std::find(batch.begin(), batch.end(), id) != batch.end()) {
+      continue;
+    }
+    victim = id;
+    victim_step = sequence.last_step;
+  }
+  if (victim == -1) return false;
+  Evict(victim, evicted);
+  return true;
+}
+
+void BatchedDecodeRunner::LoadSlot(int slot, const Sequence& sequence) {
+  const int block_size = pool_->block_size();
+  for (int cache = 0; cache < caches_.size(); ++cache) {
+    for (int position = 0; position < sequence.length;
+         position += block_size) {
+      const int num_entries = std::min(block_size, sequence.length - position);
+      memcpy(slot_entry(cache, slot, position),
+             pool_->entry(sequence.blocks[position / block_size], cache, 0),
+             static_cast<size_t>(num_entries) * entry_size_ * sizeof(float));
+    }
+    memset(slot_entry(cache, slot, sequence.length), 0,
+           static_cast<size_t>(cache_size_ - sequence.length) * entry_size_ *
+               sizeof(float));
+  }
+}
+
+int BatchedDecodeRunner::AssignSlot(int id, std::vector<bool>* taken) {
+  // Prefer the entry already holding the cache of `id`, then an idle one, then
+  // the one whose owner stepped least recently.
+  int best_slot = -1;
+  int64_t best_step = std::numeric_limits<int64_t>::max();
+  for (int slot = 0; slot < batch_size_; ++slot) {
+    if ((*taken)[slot]) continue;
+    const int owner = slot_owners_[slot];
+    if (owner == id) {
+      best_slot = slot;
+      break;
+    }
+    const int64_t step =
+        owner == -1 ? -1 : sequences_.at(owner).last_step;
+    if (step < best_step) {
+      best_slot = slot;
+      best_step = step;
+    }
+  }
+  (*taken)[best_slot] = true;
+  if (slot_owners_[best_slot] != id) {
+    slot_owners_[best_slot] = id;
+    LoadSlot(best_slot, sequences_.at(id));
+  }
+  return best_slot;
+}
+
+TfLiteStatus BatchedDecodeRunner::Step(std::vector<int>* stepped,
+                                       std::vector<int>* evicted) {
+  stepped->clear();
+  evicted->clear();
+  if (pool_ == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "BatchedDecodeRunner is not initialized.");
+    return kTfLiteError;
+  }
+
+  // Admit the oldest pending tokens, making room for their entries.
+  std::vector<int> batch;
+  while (!pending_.empty() && batch.size() < batch_size_) {
+    const int id = pending_.front();
+    pending_.pop_front();
+    Sequence& sequence = sequences_.at(id);
+    if (sequence.length == cache_size_) {
+      Evict(id, evicted);
+      continue;
+    }
+    batch.push_back(id);
+    if (sequence.length % pool_->block_size() != 0) continue;
+    int block = pool_->Allocate();
+    while (block == -1 && EvictForBlock(batch, evicted)) {
+      block = pool_->Allocate();
+    }
+    if (block == -1) {
+      batch.pop_back();
+      Evict(id, evicted);
+      continue;
+    }
+    sequence.blocks.push_back(block);
+  }
+  if (batch.empty()) return kTfLiteOk;
+
+  // Keep the sequences that ran in the previous step on their batch entries,
+  // so that only the others are copied in from the pool.
+  std::vector<int> slots(batch.size(), -1);
+  std::vector<bool> taken(batch_size_, false);
+  for (int i = 0; i < batch.size(); ++i) {
+    auto owner = std::find(slot_owners_.begin(), slot_owners_.end(), batch[i]);
+    if (owner != slot_owners_.end()) {
+      slots[i] = owner - slot_owners_.begin();
+      taken[slots[i]] = true;
+    }
+  }
+  for (int i = 0; i < batch.size(); ++i) {
+    if (slots[i] == -1) slots[i] = AssignSlot(batch[i], &taken);
+  }
+
+  // Idle entries write at the next position of their owner, which is
+  // overwritten before the owner attends to it, or at the last one of a full
+  // sequence, which never runs again.
+  int32_t* tokens =
+      runner_->input_tensor(options_.tokens_input.c_str())->data.i32;
+  int64_t* positions =
+      runner_->input_tensor(options_.positions_input.c_str())->data.i64;
+  for (int slot = 0; slot < batch_size_; ++slot) {
+    const int owner = slot_owners_[slot];
+    tokens[slot] = 0;
+    positions[slot] =
+        owner == -1 ? 0
+                    : std::min(sequences_.at(owner).length, cache_size_ - 1);
+  }
+  for (int i = 0; i < batch.size(); ++i) {
+    tokens[slots[i]] = sequences_.at(batch[i]).pending_token;
+  }
+  if (!options_.attention_mask_input.empty()) {
+    float* mask =
+        runner_->input_tensor(options_.attention_mask_input.c_str())->data.f;
+    for (int slot = 0; slot < batch_size_; ++slot) {
+      float* row = mask + static_cast<size_t>(slot) * cache_size_;
+      const int num_visible = positions[slot] + 1;
+      std::fill(row, row + num_visible, 0.0f);
+      std::fill(row + num_visible, row + cache_size_,
+                std::numeric_limits<float>::lowest());
+    }
+  }
+
+  TF_LITE_ENSURE_STATUS(runner_->Invoke());
+
+  // Save the new entries to the pool, which holds the whole cache of each
+  // sequence, so that batch entries can be reassigned in any later step.
+  const TfLiteTensor* logits =
+      runner_->output_tensor(options_.logits_output.c_str());
+  const int num_logits = NumElements(logits) / batch_size_;
+  const int block_size = pool_->block_size();
+  for (int i = 0; i < batch.size(); ++i) {
+    Sequence& sequence = sequences_.at(batch[i]);
+    const int position = sequence.length;
+    const int block = sequence.blocks[position / block_size];
+    for (int cache = 0; cache < caches_.size(); ++cache) {
+      memcpy(pool_->entry(block, cache, position % block_size),
+             slot_entry(cache, slots[i], position),
+             static_cast<size_t>(entry_size_) * sizeof(float));
+    }
+    ++sequence.length;
+    sequence.has_pending_token = false;
+    sequence.last_step = num_steps_;
+    const float* row = logits->data.f + static_cast<size_t>(slots[i]) *
+                                            num_logits;
+    sequence.logits.assign(row, row + num_logits);
+    stepped->push_back(batch[i]);
+  }
+  ++num_steps_;
+  return kTfLiteOk;
+}
+
+int BatchedDecodeRunner::sequence_length(int id) const {
+  auto it = sequences_.find(id);
+  return it == sequences_.end() ? 0 : it->second.length;
+}
+
+const std::vector<float>& BatchedDecodeRunner::logits(int id) const {
+  static const std::vector<float>* const kNoLogits = new std::vector<float>();
+  auto it = sequences_.find(id);
+  return it == sequences_.end() ? *kNoLogits : it->second.logits;
+}
+
+}  // namespace genai
+}  // namespace tflite
@@ -0,0 +1,178 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_GENAI_BATCHED_DECODE_RUNNER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_GENAI_BATCHED_DECODE_RUNNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+namespace genai {
+
+// A pool of fixed-size blocks of KV cache entries, shared by all the sequences
+// of a BatchedDecodeRunner. A block holds `block_size` consecutive positions of
+// each of the `num_caches` caches of the model.
+class KVCacheBlockPool {
+ public:
+  KVCacheBlockPool(int num_blocks, int block_size, int num_caches,
+                   int entry_size);
+
+  // Returns the index of a free block, or -1 if there is none.
+  int Allocate();
+  void Free(int block);
+
+  // Returns the entry of cache `cache` at `offset` in `block`.
+  float* entry(int block, int cache, int offset) {
+    return data_.data() +
+           ((static_cast<size_t>(block) * num_caches_ + cache) * block_size_ +
+            offset) *
+               entry_size_;
+  }
+
+  int block_size() const { return block_size_; }
+  int num_free_blocks() const { return free_blocks_.size(); }
+
+ private:
+  const int block_size_;
+  const int num_caches_;
+  const int entry_size_;
+  std::vector<float> data_;
+  std::vector<int> free_blocks_;
+};
+
+// Runs the decode signature of a generative model for many sequences at once.
+//
+// The signature processes one token for each of its B batch entries, and
+// reads and updates KV caches of shape (B, S, N, H) through
+// `odml.update_external_kv_cache`. The runner binds these caches to buffers of
+// its own, and keeps the entries of all the live sequences in a
+// KVCacheBlockPool, so that the number of live sequences is bounded by the size
+// of the pool rather than by B. Each `Step` batches up to B of the sequences
+// with a pending token into one invocation. A sequence keeps its batch entry
+// while it keeps stepping, so that its cache is only copied in from the pool
+// when it takes over the entry of another sequence.
+//
+// When the pool runs out of blocks, the sequence that stepped least recently
+// outside of the current batch is evicted, and its cache freed. Sequences that
+// reach S positions are evicted as well. Evicted sequences are reported by
+// `Step` and must be added again to continue.
+//
+// This class is not thread-safe.
+class BatchedDecodeRunner {
+ public:
+  struct Options {
+    // int32 input with B elements, the token of each batch entry.
+    std::string tokens_input = "tokens";
+    // int64 input of shape (B, 1), the position of each token.
+    std::string positions_input = "input_pos";
+    // Optional float input whose last dimension is S, set to 0 for the
+    // positions a token may attend to and to the lowest float otherwise.
+    std::string attention_mask_input;
+    // float output whose first dimension is B.
+    std::string logits_output = "logits";
+    // The KV cache inputs of the signature, and the outputs holding their
+    // updated values, in the same order.
+    std::vector<std::string> kv_cache_inputs;
+    std::vector<std::string> kv_cache_outputs;
+    // The number of positions per block, and the number of blocks of the pool.
+    int block_size = 16;
+    int num_blocks = 0;
+  };
+
+  // `runner` must outlive this object, and must not be used by others.
+  BatchedDecodeRunner(SignatureRunner* runner, Options options);
+  ~BatchedDecodeRunner();
+
+  // Checks the signature, binds the KV caches and allocates the tensors.
+  TfLiteStatus Init();
+
+  int batch_size() const { return batch_size_; }
+  int max_sequence_length() const { return cache_size_; }
+  int num_free_blocks() const {
+    return pool_ ? pool_->num_free_blocks() : 0;
+  }
+
+  // Adds an empty sequence.
+  TfLiteStatus AddSequence(int id);
+  // Removes a sequence and frees its cache.
+  void RemoveSequence(int id);
+  // Sets the next token of a sequence, to be processed by a later `Step`.
+  TfLiteStatus Enqueue(int id, int32_t token);
+
+  // Processes the pending tokens of up to `batch_size()` sequences, in the
+  // order they were enqueued. Returns the ids of these sequences in `stepped`,
+  // and those of the sequences evicted before the invocation in `evicted`.
+  TfLiteStatus Step(std::vector<int>* stepped, std::vector<int>* evicted);
+
+  // Returns the number of tokens processed for a sequence.
+  int sequence_length(int id) const;
+  // Returns the logits of the last token processed for a sequence.
+  const std::vector<float>& logits(int id) const;
+
+ private:
+  struct Sequence {
+    std::vector<int> blocks;
+    int length = 0;
+    int32_t pending_token = 0;
+    bool has_pending_token = false;
+    // The step at which the sequence last ran, to pick eviction victims.
+    int64_t last_step = -1;
+    std::vector<float> logits;
+  };
+
+  void Evict(int id, std::vector<int>* evicted);
+  // Evicts a sequence outside of `batch` to free a block. Returns false if
+  // there is none.
+  bool EvictForBlock(const std::vector<int>& batch, std::vector<int>* evicted);
+  // Returns the batch entry of `id` for this step, copying its cache in from
+  // the pool if another sequence holds it. `taken` marks the entries already
+  // used by this step.
+  int AssignSlot(int id, std::vector<bool>* taken);
+  void LoadSlot(int slot, const Sequence& sequence);
+  float* slot_entry(int cache, int slot, int position) {
+    return caches_[cache] +
+           (static_cast<size_t>(slot) * cache_size_ + position) * entry_size_;
+  }
+
+  SignatureRunner* runner_;
+  Options options_;
+  int batch_size_ = 0;
+  int cache_size_ = 0;
+  int entry_size_ = 0;
+  std::unique_ptr<KVCacheBlockPool> pool_;
+  // The buffers bound to each KV cache, of shape (B, S, N, H), and the
+  // storage they are aligned in.
+  std::vector<float*> caches_;
+  std::vector<std::vector<float>> cache_buffers_;
+  // The sequence whose cache is held by each batch entry, or -1.
+  std::vector<int> slot_owners_;
+  std::map<int, Sequence> sequences_;
+  // Ids of the sequences with a pending token, in enqueue order.
+  std::deque<int> pending_;
+  int64_t num_steps_ = 0;
+};
+
+}  // namespace genai
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_GENAI_BATCHED_DECODE_RUNNER_H_
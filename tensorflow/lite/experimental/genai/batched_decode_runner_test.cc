@@ -0,0 +1,223 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/genai/batched_decode_runner.h"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace tflite {
+namespace genai {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr int kBatchSize = 2;
+constexpr int kCacheSize = 4;
+
+// Writes each token, as a float, to the (B, 1, 1, 1) slice of the KV caches.
+TfLiteStatus TokensToSliceEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* tokens = &context->tensors[node->inputs->data[0]];
+  TfLiteTensor* slice = &context->tensors[node->outputs->data[0]];
+  for (int b = 0; b < kBatchSize; ++b) {
+    slice->data.f[b] = tokens->data.i32[b];
+  }
+  return kTfLiteOk;
+}
+
+// Sums each (S, 1, 1) batch entry of a cache, so that the logits of a sequence
+// are the sum of the tokens fed to it.
+TfLiteStatus SumCacheEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* cache = &context->tensors[node->inputs->data[0]];
+  TfLiteTensor* sum = &context->tensors[node->outputs->data[0]];
+  for (int b = 0; b < kBatchSize; ++b) {
+    sum->data.f[b] = 0;
+    for (int s = 0; s < kCacheSize; ++s) {
+      sum->data.f[b] += cache->data.f[b * kCacheSize + s];
+    }
+  }
+  return kTfLiteOk;
+}
+
+// Builds a decode model for `kBatchSize` sequences of up to `kCacheSize`
+// tokens, whose logits are the sums of the K cache.
+void BuildModel(Interpreter* interpreter) {
+  static TfLiteRegistration tokens_to_slice = {nullptr, nullptr, nullptr,
+                                               TokensToSliceEval};
+  static TfLiteRegistration sum_cache = {nullptr, nullptr, nullptr,
+                                         SumCacheEval};
+  enum { kTokens, kPos, kKCache, kVCache, kSlice, kKOut, kVOut, kLogits };
+  ASSERT_EQ(interpreter->AddTensors(8), kTfLiteOk);
+  ASSERT_EQ(interpreter->SetInputs({kTokens, kPos, kKCache, kVCache}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->SetOutputs({kLogits, kKOut, kVOut}), kTfLiteOk);
+  const std::vector<int> cache_shape = {kBatchSize, kCacheSize, 1, 1};
+  TfLiteQuantizationParams quant = {};
+  interpreter->SetTensorParametersReadWrite(kTokens, kTfLiteInt32, "tokens",
+                                            {kBatchSize}, quant);
+  interpreter->SetTensorParametersReadWrite(kPos, kTfLiteInt64, "input_pos",
+                                            {kBatchSize, 1}, quant);
+  interpreter->SetTensorParametersReadWrite(kKCache, kTfLiteFloat32, "k_cache",
+                                            cache_shape, quant);
+  interpreter->SetTensorParametersReadWrite(kVCache, kTfLiteFloat32, "v_cache",
+                                            cache_shape, quant);
+  interpreter->SetTensorParametersReadWrite(kSlice, kTfLiteFloat32, "slice",
+                                            {kBatchSize, 1, 1, 1}, quant);
+  interpreter->SetTensorParametersReadWrite(kKOut, kTfLiteFloat32, "k_out",
+                                            cache_shape, quant);
+  interpreter->SetTensorParametersReadWrite(kVOut, kTfLiteFloat32, "v_out",
+                                            cache_shape, quant);
+  interpreter->SetTensorParametersReadWrite(kLogits, kTfLiteFloat32, "logits",
+                                            {kBatchSize, 1}, quant);
+  ASSERT_EQ(interpreter->AddNodeWithParameters({kTokens}, {kSlice}, nullptr, 0,
+                                               nullptr, &tokens_to_slice),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->AddNodeWithParameters(
+                {kKCache, kVCache, kPos, kSlice, kSlice}, {kKOut, kVOut},
+                nullptr, 0, nullptr,
+                ops::custom::Register_EXTERNAL_KV_CACHE()),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter->AddNodeWithParameters({kKOut}, {kLogits}, nullptr, 0,
+                                               nullptr, &sum_cache),
+            kTfLiteOk);
+}
+
+class BatchedDecodeRunnerTest : public ::testing::Test {
+ protected:
+  void Init(int block_size, int num_blocks) {
+    BuildModel(&interpreter_);
+    BatchedDecodeRunner::Options options;
+    options.kv_cache_inputs = {"k_cache", "v_cache"};
+    options.kv_cache_outputs = {"k_out", "v_out"};
+    options.block_size = block_size;
+    options.num_blocks = num_blocks;
+    runner_ = std::make_unique<BatchedDecodeRunner>(
+        interpreter_.GetSignatureRunner(nullptr), options);
+    ASSERT_EQ(runner_->Init(), kTfLiteOk);
+  }
+
+  Interpreter interpreter_;
+  std::unique_ptr<BatchedDecodeRunner> runner_;
+  std::vector<int> stepped_;
+  std::vector<int> evicted_;
+};
+
+TEST_F(BatchedDecodeRunnerTest, BatchesMoreSequencesThanEntries) {
+  Init(/*block_size=*/2, /*num_blocks=*/6);
+  EXPECT_EQ(runner_->batch_size(), kBatchSize);
+  EXPECT_EQ(runner_->max_sequence_length(), kCacheSize);
+
+  // Three sequences take turns on the two batch entries.
+  std::map<int, float> sums;
+  for (int id : {1, 2, 3}) {
+    ASSERT_EQ(runner_->AddSequence(id), kTfLiteOk);
+  }
+  for (int token = 1; token <= 3; ++token) {
+    for (int id : {1, 2, 3}) {
+      ASSERT_EQ(runner_->Enqueue(id, token * id), kTfLiteOk);
+      sums[id] += token * id;
+    }
+    ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+    EXPECT_EQ(stepped_.size(), kBatchSize);
+    ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+    EXPECT_EQ(stepped_.size(), 1);
+    EXPECT_THAT(evicted_, IsEmpty());
+    for (int id : {1, 2, 3}) {
+      EXPECT_EQ(runner_->sequence_length(id), token);
+      EXPECT_THAT(runner_->logits(id), ElementsAre(sums[id]));
+    }
+  }
+  EXPECT_EQ(runner_->num_free_blocks(), 0);
+
+  runner_->RemoveSequence(2);
+  EXPECT_EQ(runner_->num_free_blocks(), 2);
+  EXPECT_THAT(runner_->logits(2), IsEmpty());
+}
+
+TEST_F(BatchedDecodeRunnerTest, StepsInEnqueueOrder) {
+  Init(/*block_size=*/2, /*num_blocks=*/6);
+  for (int id : {1, 2, 3}) {
+    ASSERT_EQ(runner_->AddSequence(id), kTfLiteOk);
+  }
+  ASSERT_EQ(runner_->Enqueue(3, 1), kTfLiteOk);
+  ASSERT_EQ(runner_->Enqueue(1, 1), kTfLiteOk);
+  EXPECT_NE(runner_->Enqueue(1, 2), kTfLiteOk);
+  ASSERT_EQ(runner_->Enqueue(2, 1), kTfLiteOk);
+  ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+  EXPECT_THAT(stepped_, ElementsAre(3, 1));
+  ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+  EXPECT_THAT(stepped_, ElementsAre(2));
+  ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+  EXPECT_THAT(stepped_, IsEmpty());
+}
+
+TEST_F(BatchedDecodeRunnerTest, EvictsLeastRecentlySteppedSequence) {
+  Init(/*block_size=*/2, /*num_blocks=*/2);
+  for (int id : {1, 2, 3}) {
+    ASSERT_EQ(runner_->AddSequence(id), kTfLiteOk);
+    ASSERT_EQ(runner_->Enqueue(id, id), kTfLiteOk);
+    ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+    EXPECT_THAT(stepped_, ElementsAre(id));
+  }
+  // Sequence 3 took the block of sequence 1.
+  EXPECT_THAT(evicted_, ElementsAre(1));
+  EXPECT_EQ(runner_->sequence_length(1), 0);
+  EXPECT_NE(runner_->Enqueue(1, 1), kTfLiteOk);
+
+  // Sequences 2 and 3 continue within their blocks.
+  ASSERT_EQ(runner_->Enqueue(2, 10), kTfLiteOk);
+  ASSERT_EQ(runner_->Enqueue(3, 10), kTfLiteOk);
+  ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+  EXPECT_THAT(stepped_, ElementsAre(2, 3));
+  EXPECT_THAT(evicted_, IsEmpty());
+  EXPECT_THAT(runner_->logits(2), ElementsAre(12));
+  EXPECT_THAT(runner_->logits(3), ElementsAre(13));
+
+  // Both need a new block, so the first one admitted takes the blocks of the
+  // other.
+  ASSERT_EQ(runner_->Enqueue(2, 1), kTfLiteOk);
+  ASSERT_EQ(runner_->Enqueue(3, 1), kTfLiteOk);
+  ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+  EXPECT_THAT(evicted_, ElementsAre(3));
+  EXPECT_THAT(stepped_, ElementsAre(2));
+  EXPECT_THAT(runner_->logits(2), ElementsAre(13));
+  EXPECT_EQ(runner_->num_free_blocks(), 0);
+}
+
+TEST_F(BatchedDecodeRunnerTest, EvictsFullSequences) {
+  Init(/*block_size=*/4, /*num_blocks=*/2);
+  ASSERT_EQ(runner_->AddSequence(1), kTfLiteOk);
+  for (int i = 0; i < kCacheSize; ++i) {
+    ASSERT_EQ(runner_->Enqueue(1, 1), kTfLiteOk);
+    ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+  }
+  EXPECT_THAT(runner_->logits(1), ElementsAre(kCacheSize));
+  ASSERT_EQ(runner_->Enqueue(1, 1), kTfLiteOk);
+  ASSERT_EQ(runner_->Step(&stepped_, &evicted_), kTfLiteOk);
+  EXPECT_THAT(stepped_, IsEmpty());
+  EXPECT_THAT(evicted_, ElementsAre(1));
+  EXPECT_EQ(runner_->num_free_blocks(), 2);
+}
+
+}  // namespace
+}  // namespace genai
+}  // namespace tflite
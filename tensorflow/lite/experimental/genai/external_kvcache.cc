@@ -77,12 +77,19 @@ TfLiteStatus ExternalKVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   // Support only (B, S, N, H) for now.
   TF_LITE_ENSURE(context, NumDimensions(k_slice) == kRequiredNumDimensions);
   TF_LITE_ENSURE(context, NumDimensions(k_cache) == kRequiredNumDimensions);
-  // Ensure Positions correspond to KV sequence length.
-  TF_LITE_ENSURE(context, NumDimensions(position) == 1);
-  TF_LITE_ENSURE(context, GetTensorShape(position).Dims(0) ==
-                              GetTensorShape(k_slice).Dims(1));
-  // Enforce Batch == 1 for now.
-  TF_LITE_ENSURE(context, GetTensorShape(k_slice).Dims(0) == 1);
+  TF_LITE_ENSURE(context, GetTensorShape(k_slice).Dims(0) ==
+                              GetTensorShape(k_cache).Dims(0));
+  // Ensure Positions correspond to KV sequence length. Positions are either
+  // shared by the whole batch, (S), or given for each batch entry, (B, S).
+  TF_LITE_ENSURE(context,
+                 NumDimensions(position) == 1 || NumDimensions(position) == 2);
+  TF_LITE_ENSURE(context,
+                 GetTensorShape(position).Dims(NumDimensions(position) - 1) ==
+                     GetTensorShape(k_slice).Dims(1));
+  if (NumDimensions(position) == 2) {
+    TF_LITE_ENSURE(context, GetTensorShape(position).Dims(0) ==
+                                GetTensorShape(k_slice).Dims(0));
+  }
 
   return kTfLiteOk;
 }
@@ -123,32 +130,44 @@ TfLiteStatus ExternalKVCacheEval(TfLiteContext* context, TfLiteNode* node) {
     memcpy(updated_v_cache->data.data, v_cache->data.data, v_cache->bytes);
   }
 
-  // Copy the new slice to the updated cache.
+  // Copy the new slices of each batch entry to the updated cache.
   const int32_t elements_in_one_entry =
       GetTensorShape(k_cache).Dims(2) * GetTensorShape(k_cache).Dims(3);
+  const int32_t batch_size = GetTensorShape(k_cache).Dims(0);
   const int32_t cache_size = GetTensorShape(k_cache).Dims(1);
-  int32_t last_update_position = -1;
-  for (int i = 0; i < position->bytes / sizeof(int64_t); ++i) {
-    const int32_t update_position = static_cast<int32_t>(position->data.i64[i]);
-    // We are making the assumption that the positions are in increasing order
-    // and a decrease or equal value shows exhaustion of update slices.
-    // This assumption can be relaxed once we switch to dynamic shapes.
-    if (update_position < last_update_position) {
-      break;
+  const int32_t num_slices = GetTensorShape(k_slice).Dims(1);
+  const bool batched_positions = NumDimensions(position) == 2;
+  for (int b = 0; b < batch_size; ++b) {
+    const int64_t* positions =
+        position->data.i64 + (batched_positions ? b * num_slices : 0);
+    const int32_t batch_cache_offset = b * cache_size * elements_in_one_entry;
+    const int32_t batch_update_offset = b * num_slices * elements_in_one_entry;
+    int32_t last_update_position = -1;
+    for (int i = 0; i < num_slices; ++i) {
+      const int32_t update_position = static_cast<int32_t>(positions[i]);
+      // We are making the assumption that the positions are in increasing
+      // order and a decrease or equal value shows exhaustion of update slices.
+      // This assumption can be relaxed once we switch to dynamic shapes.
+      if (update_position < last_update_position) {
+        break;
+      }
+      last_update_position = update_position;
+      TF_LITE_ENSURE(context, update_position >= 0);
+      TF_LITE_ENSURE(context, update_position < cache_size);
+      const int32_t cache_offset =
+          batch_cache_offset + update_position * elements_in_one_entry;
+      const int32_t update_offset =
+          batch_update_offset + i * elements_in_one_entry;
+      TF_LITE_ENSURE(context,
+                     (cache_offset + elements_in_one_entry) * sizeof(float) <=
+                         k_cache->bytes);
+      memcpy(updated_k_cache->data.f + cache_offset,
+             k_slice->data.f + update_offset,
+             elements_in_one_entry * sizeof(float));
+      memcpy(updated_v_cache->data.f + cache_offset,
+             v_slice->data.f + update_offset,
+             elements_in_one_entry * sizeof(float));
     }
-    last_update_position = update_position;
-    TF_LITE_ENSURE(context, update_position < cache_size);
-    const int32_t cache_offset = update_position * elements_in_one_entry;
-    const int32_t update_offset = i * elements_in_one_entry;
-    TF_LITE_ENSURE(context,
-                   (cache_offset + elements_in_one_entry) * sizeof(float) <=
-                       k_cache->bytes);
-    memcpy(updated_k_cache->data.f + cache_offset,
-           k_slice->data.f + update_offset,
-           elements_in_one_entry * sizeof(float));
-    memcpy(updated_v_cache->data.f + cache_offset,
-           v_slice->data.f + update_offset,
-           elements_in_one_entry * sizeof(float));
   }
 
   return kTfLiteOk;
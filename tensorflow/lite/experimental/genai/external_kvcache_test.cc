@@ -271,6 +271,22 @@ TEST_P(EKVCacheTest, FailsOnOutOfBoundPosition) {
             kTfLiteError);
 }
 
+TEST_P(EKVCacheTest, BatchedPositionsUpdateTest) {
+  ExternalKVSingleOpModel m(
+      {TensorType_FLOAT32, {2, 3, 1, 2}}, {TensorType_FLOAT32, {2, 3, 1, 2}},
+      {TensorType_INT64, {2, 1}}, {TensorType_FLOAT32, {2, 1, 1, 2}},
+      {TensorType_FLOAT32, {2, 1, 1, 2}}, GetParam());
+  ASSERT_EQ(m.Run(/*position=*/{0, 2}, /*k_slice=*/{1, 1, 2, 2},
+                  /*v_slice=*/{5, 5, 6, 6}),
+            kTfLiteOk);
+
+  std::vector<float> k = m.GetKCache();
+  ASSERT_THAT(k, ElementsAreArray({1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2}));
+
+  std::vector<float> v = m.GetVCache();
+  ASSERT_THAT(v, ElementsAreArray({5, 5, 0, 0, 0, 0, 0, 0, 0, 0, 6, 6}));
+}
+
 INSTANTIATE_TEST_SUITE_P(EKVCacheTest, EKVCacheTest,
                          testing::Values(TestType::kSharedKV,
                                          TestType::kPingPongKV));
@@ -0,0 +1,202 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_FLAT_HASH_INDEX_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_FLAT_HASH_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace tflite {
+namespace resource {
+namespace internal {
+
+// An open-addressed hash index from keys to entry numbers, for tables that
+// store their keys and values in arrays. The index only holds the entry
+// numbers, so the keys are compared through a callback.
+//
+// Slots are grouped by 16, with one control byte per slot holding either
+// kEmpty or 7 bits of the hash of the slot's key. A probe loads the 16 control
+// bytes of a group at once and compares them against the hash bits with SIMD,
+// so most mismatches are rejected without touching the keys. Entries cannot be
+// erased, which keeps a group without empty slots a valid end of the probe.
+class FlatHashIndex {
+ public:
+  static constexpr int kGroupWidth = 16;
+
+  // Clears the index and sizes it to hold `num_entries` entries.
+  void Reset(int num_entries) {
+    // Keeps the load factor at most 7/8.
+    const size_t min_slots = static_cast<size_t>(num_entries) * 8 / 7 + 1;
+    size_t num_groups = 1;
+    while (num_groups * kGroupWidth < min_slots) num_groups *= 2;
+    group_mask_ = num_groups - 1;
+    control_.assign(num_groups * kGroupWidth, kEmpty);
+    entries_.assign(num_groups * kGroupWidth, -1);
+  }
+
+  // Returns the entry whose key has the given hash and satisfies `equal`, a
+  // callable taking an entry number, or -1 if there is none.
+  template <typename Equal>
+  int32_t Find(uint64_t hash, Equal equal) const {
+    const uint8_t tag = HashTag(hash);
+    size_t group = HashGroup(hash);
+    for (size_t step = 1;; ++step) {
+      const uint8_t* control = control_.data() + group * kGroupWidth;
+      for (uint64_t match = MatchGroup(control, tag); match != 0;
+           match &= match - 1) {
+        const int32_t entry = entries_[group * kGroupWidth + LowestLane(match)];
+        if (equal(entry)) return entry;
+      }
+      if (MatchGroup(control, kEmpty) != 0) return -1;
+      group = (group + step) & group_mask_;
+    }
+  }
+
+  // Adds `entry` with the given hash, unless an entry satisfying `equal` is
+  // already there. Returns whether the entry was added. The index must have
+  // been Reset() for at least as many entries as are added.
+  template <typename Equal>
+  bool Insert(uint64_t hash, int32_t entry, Equal equal) {
+    const uint8_t tag = HashTag(hash);
+    size_t group = HashGroup(hash);
+    for (size_t step = 1;; ++step) {
+      uint8_t* control = control_.data() + group * kGroupWidth;
+      for (uint64_t match = MatchGroup(control, tag); match != 0;
+           match &= match - 1) {
+        if (equal(entries_[group * kGroupWidth + LowestLane(match)])) {
+          return false;
+        }
+      }
+      const uint64_t empty = MatchGroup(control, kEmpty);
+      if (empty != 0) {
+        const int lane = LowestLane(empty);
+        control[lane] = tag;
+        entries_[group * kGroupWidth + lane] = entry;
+        return true;
+      }
+      group = (group + step) & group_mask_;
+    }
+  }
+
+  // Starts loading the first group probed for the given hash into the cache,
+  // so that a batch of lookups can overlap their cache misses.
+  void Prefetch(uint64_t hash) const {
+#ifdef __GNUC__
+    const size_t slot = HashGroup(hash) * kGroupWidth;
+    __builtin_prefetch(control_.data() + slot, /*rw=*/0, /*locality=*/3);
+    __builtin_prefetch(entries_.data() + slot, /*rw=*/0, /*locality=*/3);
+#else
+    (void)hash;
+#endif
+  }
+
+  size_t GetMemoryUsage() const {
+    return control_.size() * sizeof(uint8_t) +
+           entries_.size() * sizeof(int32_t);
+  }
+
+ private:
+  static constexpr uint8_t kEmpty = 0x80;
+
+  static uint8_t HashTag(uint64_t hash) { return hash & 0x7f; }
+  size_t HashGroup(uint64_t hash) const { return (hash >> 7) & group_mask_; }
+
+  // Returns a mask with one bit set for each of the kGroupWidth control bytes
+  // at `control` that equals `value`. LowestLane() maps the lowest set bit
+  // back to the slot in the group.
+#if defined(__SSE2__)
+  static uint64_t MatchGroup(const uint8_t* control, uint8_t value) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value)))));
+  }
+  static constexpr int kLaneShift = 0;
+#elif defined(__ARM_NEON)
+  static uint64_t MatchGroup(const uint8_t* control, uint8_t value) {
+    const uint8x16_t equal = vceqq_u8(vld1q_u8(control), vdupq_n_u8(value));
+    // Narrows each byte of the comparison to a nibble, and keeps one bit of it.
+    const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(equal), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) &
+           0x8888888888888888ull;
+  }
+  static constexpr int kLaneShift = 2;
+#else
+  static uint64_t MatchGroup(const uint8_t* control, uint8_t value) {
+    uint64_t mask = 0;
+    for (int i = 0; i < kGroupWidth; ++i) {
+      mask |= static_cast<uint64_t>(control[i] == value) << i;
+    }
+    return mask;
+  }
+  static constexpr int kLaneShift = 0;
+#endif
+
+  static int LowestLane(uint64_t mask) {
+#ifdef __GNUC__
+    return __builtin_ctzll(mask) >> kLaneShift;
+#else
+    int bit = 0;
+    while ((mask & 1) == 0) {
+      mask >>= 1;
+      ++bit;
+    }
+    return bit >> kLaneShift;
+#endif
+  }
+
+  std::vector<uint8_t> control_ = std::vector<uint8_t>(kGroupWidth, kEmpty);
+  std::vector<int32_t> entries_ = std::vector<int32_t>(kGroupWidth, -1);
+  size_t group_mask_ = 0;
+};
+
+// Mixes all bits of `key` into the returned hash.
+inline uint64_t HashInt64(int64_t key) {
+  uint64_t hash = static_cast<uint64_t>(key);
+  hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+  hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+  return hash ^ (hash >> 31);
+}
+
+// Hashes the `len` bytes at `data`, eight at a time.
+inline uint64_t HashBytes(const char* data, size_t len) {
+  uint64_t hash = len * 0x9e3779b97f4a7c15ull;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t chunk;
+    std::memcpy(&chunk, data + i, sizeof(chunk));
+    hash = (hash ^ HashInt64(chunk)) * 0x9e3779b97f4a7c15ull;
+  }
+  if (i < len) {
+    uint64_t chunk = 0;
+    std::memcpy(&chunk, data + i, len - i);
+    hash = (hash ^ HashInt64(chunk)) * 0x9e3779b97f4a7c15ull;
+  }
+  return HashInt64(hash);
+}
+
+}  // namespace internal
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_FLAT_HASH_INDEX_H_
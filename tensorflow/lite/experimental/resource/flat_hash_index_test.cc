@@ -0,0 +1,90 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/flat_hash_index.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace resource {
+namespace internal {
+namespace {
+
+TEST(FlatHashIndexTest, FindsInsertedInt64Keys) {
+  // Keys that only differ in their high bits, and keys that are consecutive.
+  std::vector<int64_t> keys;
+  for (int64_t i = 1; i <= 1000; ++i) keys.push_back(i << 40);
+  for (int64_t i = 0; i < 1000; ++i) keys.push_back(i);
+
+  FlatHashIndex index;
+  index.Reset(keys.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    auto equal = [&](int32_t entry) { return keys[entry] == keys[i]; };
+    EXPECT_TRUE(index.Insert(HashInt64(keys[i]), i, equal));
+  }
+
+  for (int i = 0; i < keys.size(); ++i) {
+    auto equal = [&](int32_t entry) { return keys[entry] == keys[i]; };
+    EXPECT_EQ(index.Find(HashInt64(keys[i]), equal), i);
+  }
+  const int64_t missing = -7;
+  EXPECT_EQ(index.Find(HashInt64(missing),
+                       [&](int32_t entry) { return keys[entry] == missing; }),
+            -1);
+}
+
+TEST(FlatHashIndexTest, KeepsFirstOfRepeatedKeys) {
+  const std::vector<std::string> keys = {"a", "bb", "a", "", "bb", ""};
+  auto hash = [](const std::string& key) {
+    return HashBytes(key.data(), key.size());
+  };
+
+  FlatHashIndex index;
+  index.Reset(keys.size());
+  std::vector<bool> inserted;
+  for (int i = 0; i < keys.size(); ++i) {
+    auto equal = [&](int32_t entry) { return keys[entry] == keys[i]; };
+    inserted.push_back(index.Insert(hash(keys[i]), i, equal));
+  }
+  EXPECT_EQ(inserted,
+            std::vector<bool>({true, true, false, true, false, false}));
+
+  for (const std::string& key : {"a", "bb", ""}) {
+    auto equal = [&](int32_t entry) { return keys[entry] == key; };
+    const int32_t entry = index.Find(hash(key), equal);
+    ASSERT_GE(entry, 0);
+    EXPECT_EQ(keys[entry], key);
+    EXPECT_LT(entry, 4);
+  }
+  const std::string missing = "abc";
+  EXPECT_EQ(index.Find(hash(missing),
+                       [&](int32_t entry) { return keys[entry] == missing; }),
+            -1);
+}
+
+TEST(FlatHashIndexTest, EmptyIndexFindsNothing) {
+  FlatHashIndex index;
+  EXPECT_EQ(index.Find(HashInt64(1), [](int32_t) { return true; }), -1);
+  index.Reset(0);
+  EXPECT_EQ(index.Find(HashInt64(1), [](int32_t) { return true; }), -1);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace resource
+}  // namespace tflite
@@ -100,6 +100,9 @@ class TensorWriter<std::string> {
     buf_.AddString(value.data(), value.length());
   }
 
+  // Queues the given string reference to the buffer, as SetData() above.
+  void SetData(int index, const StringRef& value) { buf_.AddString(value); }
+
   // Commit updates. The stored data in DynamicBuffer will be written into the
   // tensor storage.
   void Commit() { buf_.WriteToTensor(values_, nullptr); }
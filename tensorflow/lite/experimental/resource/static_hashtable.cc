@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/resource/static_hashtable.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -42,17 +44,27 @@ TfLiteStatus StaticHashtable<KeyType, ValueType>::Lookup(
   const int size =
       MatchingFlatSize(GetTensorShape(keys), GetTensorShape(values));
 
-  auto key_tensor_reader = TensorReader<KeyType>(keys);
   auto value_tensor_writer = TensorWriter<ValueType>(values);
-  auto default_value_tensor_reader = TensorReader<ValueType>(default_value);
-  ValueType first_default_value = default_value_tensor_reader.GetData(0);
-
-  for (int i = 0; i < size; ++i) {
-    auto result = map_.find(key_tensor_reader.GetData(i));
-    if (result != map_.end()) {
-      value_tensor_writer.SetData(i, result->second);
-    } else {
-      value_tensor_writer.SetData(i, first_default_value);
+  const typename Value::Type first_default_value = Value::Get(default_value, 0);
+
+  // Hashes a batch of keys and prefetches their groups before probing any of
+  // them, so that the cache misses of the batch overlap.
+  constexpr int kLookupBatchSize = 16;
+  uint64_t hashes[kLookupBatchSize];
+  for (int start = 0; start < size; start += kLookupBatchSize) {
+    const int batch_size = std::min(kLookupBatchSize, size - start);
+    for (int i = 0; i < batch_size; ++i) {
+      hashes[i] = Key::Hash(Key::Get(keys, start + i));
+      index_.Prefetch(hashes[i]);
+    }
+    for (int i = 0; i < batch_size; ++i) {
+      const typename Key::Type key = Key::Get(keys, start + i);
+      const int32_t entry = index_.Find(hashes[i], [&](int32_t entry) {
+        return Key::Equal(keys_[entry], key);
+      });
+      typename Value::Type value =
+          entry >= 0 ? values_[entry] : first_default_value;
+      value_tensor_writer.SetData(start + i, value);
     }
   }
 
@@ -78,16 +90,31 @@ TfLiteStatus StaticHashtable<KeyType, ValueType>::Import(
   const int size =
       MatchingFlatSize(GetTensorShape(keys), GetTensorShape(values));
 
-  auto key_tensor_reader = TensorReader<KeyType>(keys);
-  auto value_tensor_writer = TensorReader<ValueType>(values);
+  Key::Import(keys, size, &keys_, &key_storage_);
+  Value::Import(values, size, &values_, &value_storage_);
+  if (key_storage_) storage_bytes_ += keys->bytes;
+  if (value_storage_) storage_bytes_ += values->bytes;
+
+  index_.Reset(size);
   for (int i = 0; i < size; ++i) {
-    map_.insert({key_tensor_reader.GetData(i), value_tensor_writer.GetData(i)});
+    const bool inserted =
+        index_.Insert(Key::Hash(keys_[i]), i, [&](int32_t entry) {
+          return Key::Equal(keys_[entry], keys_[i]);
+        });
+    if (inserted) ++size_;
   }
 
   is_initialized_ = true;
   return kTfLiteOk;
 }
 
+template <typename KeyType, typename ValueType>
+size_t StaticHashtable<KeyType, ValueType>::GetMemoryUsage() {
+  return keys_.size() * sizeof(typename Key::Type) +
+         values_.size() * sizeof(typename Value::Type) + storage_bytes_ +
+         index_.GetMemoryUsage();
+}
+
 LookupInterface* CreateStaticHashtable(TfLiteType key_type,
                                        TfLiteType value_type) {
   if (key_type == kTfLiteInt64 && value_type == kTfLiteString) {
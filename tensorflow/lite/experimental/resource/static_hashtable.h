@@ -15,9 +15,14 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_STATIC_HASHTABLE_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_STATIC_HASHTABLE_H_
 
-#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/flat_hash_index.h"
 #include "tensorflow/lite/experimental/resource/lookup_interfaces.h"
 #include "tensorflow/lite/experimental/resource/lookup_util.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
@@ -28,8 +33,64 @@ namespace tflite {
 namespace resource {
 namespace internal {
 
+// How StaticHashtable stores keys and values of type T. Numbers are stored as
+// is, and strings as references into the string data of the imported tensor.
+template <typename T>
+struct HashtableEntry {
+  using Type = T;
+
+  static Type Get(const TfLiteTensor* tensor, int index) {
+    return GetTensorData<T>(tensor)[index];
+  }
+  static uint64_t Hash(Type value) { return HashInt64(value); }
+  static bool Equal(Type a, Type b) { return a == b; }
+
+  // Reads the first `size` values of `tensor` into `entries`.
+  static void Import(const TfLiteTensor* tensor, int size,
+                     std::vector<Type>* entries,
+                     std::unique_ptr<char[]>* storage) {
+    const T* data = GetTensorData<T>(tensor);
+    entries->assign(data, data + size);
+  }
+};
+
+template <>
+struct HashtableEntry<std::string> {
+  using Type = StringRef;
+
+  static Type Get(const TfLiteTensor* tensor, int index) {
+    return GetString(tensor, index);
+  }
+  static uint64_t Hash(Type value) { return HashBytes(value.str, value.len); }
+  static bool Equal(Type a, Type b) {
+    return a.len == b.len && std::memcmp(a.str, b.str, a.len) == 0;
+  }
+
+  // Reads the first `size` strings of `tensor` into `entries`. The strings of
+  // read-only tensors, which live in the model, are referenced in place.
+  // Otherwise the string data of the tensor is copied once into `storage`.
+  static void Import(const TfLiteTensor* tensor, int size,
+                     std::vector<Type>* entries,
+                     std::unique_ptr<char[]>* storage) {
+    const char* data = tensor->data.raw_const;
+    if (tensor->allocation_type != kTfLiteMmapRo) {
+      storage->reset(new char[tensor->bytes]);
+      std::memcpy(storage->get(), data, tensor->bytes);
+      data = storage->get();
+    }
+    entries->resize(size);
+    for (int i = 0; i < size; ++i) {
+      const StringRef ref = GetString(tensor, i);
+      (*entries)[i] = {data + (ref.str - tensor->data.raw_const), ref.len};
+    }
+  }
+};
+
 // A static hash table class. This hash table allows initialization one time in
 // its life cycle. This hash table implements Tensorflow core's HashTableV2 op.
+//
+// Keys and values are kept in arrays in import order, and found through a
+// FlatHashIndex, so an import does no allocation per key.
 template <typename KeyType, typename ValueType>
 class StaticHashtable : public tflite::resource::LookupInterface {
  public:
@@ -44,12 +105,13 @@ class StaticHashtable : public tflite::resource::LookupInterface {
                       TfLiteTensor* values,
                       const TfLiteTensor* default_value) override;
 
-  // Inserts the given key and value tensor data into the hash table.
+  // Inserts the given key and value tensor data into the hash table. When keys
+  // repeat, the first value is kept.
   TfLiteStatus Import(TfLiteContext* context, const TfLiteTensor* keys,
                       const TfLiteTensor* values) override;
 
   // Returns the item size of the hash table.
-  size_t Size() override { return map_.size(); }
+  size_t Size() override { return size_; }
 
   TfLiteType GetKeyType() const override { return key_type_; }
   TfLiteType GetValueType() const override { return value_type_; }
@@ -65,13 +127,23 @@ class StaticHashtable : public tflite::resource::LookupInterface {
   // Returns true if the hash table is initialized.
   bool IsInitialized() override { return is_initialized_; }
 
-  size_t GetMemoryUsage() override { return map_.size() * sizeof(ValueType); }
+  size_t GetMemoryUsage() override;
 
  private:
+  using Key = HashtableEntry<KeyType>;
+  using Value = HashtableEntry<ValueType>;
+
   TfLiteType key_type_;
   TfLiteType value_type_;
 
-  std::unordered_map<KeyType, ValueType> map_;
+  std::vector<typename Key::Type> keys_;
+  std::vector<typename Value::Type> values_;
+  // Copies of the string data of imported tensors that are not read-only.
+  std::unique_ptr<char[]> key_storage_;
+  std::unique_ptr<char[]> value_storage_;
+  size_t storage_bytes_ = 0;
+  FlatHashIndex index_;
+  size_t size_ = 0;
   bool is_initialized_ = false;
 };
 
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_EXPERIMENTAL_SHLO_OPS_BINARY_ELEMENTWISE_H_
 
 #include "tensorflow/lite/experimental/shlo/data_type.h"
+#include "tensorflow/lite/experimental/shlo/ops/util.h"
 #include "tensorflow/lite/experimental/shlo/quantize.h"
 #include "tensorflow/lite/experimental/shlo/quantized_tensor_element_type.h"
 #include "tensorflow/lite/experimental/shlo/shape.h"
@@ -26,6 +27,40 @@ namespace shlo_ref {
 
 namespace detail {
 
+// Applies `func` to one block of elements. The output must not overlap the
+// operands, which lets the compiler vectorize the loop without emitting run
+// time aliasing checks.
+template <class T, class F>
+void ApplyBinaryToBlock(F& func, const T* __restrict lhs_data,
+                        const T* __restrict rhs_data,
+                        T* __restrict output_data) {
+  for (DimensionSize i = 0; i < kElementwiseBlockSize; ++i) {
+    output_data[i] = static_cast<T>(func(lhs_data[i], rhs_data[i]));
+  }
+}
+
+// Applies `func` to each pair of `lhs` and `rhs` elements and writes the
+// results to `output`, which may be one of the operands.
+template <DataType data_type, class F>
+void ApplyBinary(F& func, const Tensor& lhs, const Tensor& rhs,
+                 Tensor& output) {
+  using T = StorageType<data_type>;
+  const T* lhs_data = lhs.GetDataAs<data_type>();
+  const T* rhs_data = rhs.GetDataAs<data_type>();
+  T* output_data = output.GetDataAs<data_type>();
+  const DimensionSize num_elements = lhs.NumElements();
+  DimensionSize i = 0;
+  if (!DataOverlaps(lhs, output) && !DataOverlaps(rhs, output)) {
+    for (; i + kElementwiseBlockSize <= num_elements;
+         i += kElementwiseBlockSize) {
+      ApplyBinaryToBlock(func, lhs_data + i, rhs_data + i, output_data + i);
+    }
+  }
+  for (; i < num_elements; ++i) {
+    output_data[i] = static_cast<T>(func(lhs_data[i], rhs_data[i]));
+  }
+}
+
 template <DataType storage_type, DataType expressed_type, typename F>
 void DequantizeOpQuantizePerTensor(F&& func, const Tensor& lhs,
                                    const Tensor& rhs, Tensor& output) {
@@ -63,15 +98,7 @@ void DequantizeOpQuantizePerTensor(F&& func, const Tensor& lhs,
 template <DataType data_type, class F>
 void EvaluateNoQuantization(F&& func, const Tensor& lhs, const Tensor& rhs,
                             Tensor& output) {
-  using T = StorageType<data_type>;
-  const T* lhs_data = lhs.GetDataAs<data_type>();
-  const T* rhs_data = rhs.GetDataAs<data_type>();
-  T* output_data = output.GetDataAs<data_type>();
-  const DimensionSize num_elements = lhs.NumElements();
-  for (DimensionSize i = 0; i < num_elements;
-       ++i, ++output_data, ++lhs_data, ++rhs_data) {
-    *output_data = static_cast<T>(func(*lhs_data, *rhs_data));
-  }
+  ApplyBinary<data_type>(func, lhs, rhs, output);
 }
 
 }  // namespace detail
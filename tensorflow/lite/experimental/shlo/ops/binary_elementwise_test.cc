@@ -18,6 +18,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "tensorflow/lite/experimental/shlo/ops/test_util.h"
+#include "tensorflow/lite/experimental/shlo/ops/util.h"
 #include "tensorflow/lite/experimental/shlo/quantized_tensor_element_type.h"
 #include "tensorflow/lite/experimental/shlo/shape.h"
 #include "tensorflow/lite/experimental/shlo/tensor.h"
@@ -68,6 +69,39 @@ TYPED_TEST(EvaluateNoQuantizationTest, ArithmeticTensorsWithTestOp) {
   EXPECT_THAT(output_data, ElementsAreArray(expected_data));
 }
 
+TYPED_TEST(EvaluateNoQuantizationTest, SeveralBlocksAndInPlace) {
+  using StorageT = typename TypeParam::StorageT;
+
+  // Three full blocks and a partial one.
+  const Shape shape({3, kElementwiseBlockSize + 5});
+  Vector<StorageT> lhs_data =
+      RandomBuffer<TypeParam::kStorage>(shape, /*min=*/-5, /*max=*/5);
+  Vector<StorageT> rhs_data =
+      RandomBuffer<TypeParam::kStorage>(shape, /*min=*/-5, /*max=*/5);
+  Vector<StorageT> output_data(shape.NumElements());
+
+  Tensor lhs_tensor{
+      .type = TensorType{.shape = shape, .element_type = TypeParam::kStorage},
+      .data = lhs_data.data()};
+  Tensor rhs_tensor{
+      .type = TensorType{.shape = shape, .element_type = TypeParam::kStorage},
+      .data = rhs_data.data()};
+  Tensor output_tensor{
+      .type = TensorType{.shape = shape, .element_type = TypeParam::kStorage},
+      .data = output_data.data()};
+
+  Vector<StorageT> expected_data(shape.NumElements());
+  absl::c_transform(lhs_data, rhs_data, expected_data.begin(), TestOp());
+
+  detail::EvaluateNoQuantization<TypeParam::kStorage>(
+      TestOp(), lhs_tensor, rhs_tensor, output_tensor);
+  EXPECT_THAT(output_data, ElementsAreArray(expected_data));
+
+  detail::EvaluateNoQuantization<TypeParam::kStorage>(TestOp(), lhs_tensor,
+                                                      rhs_tensor, lhs_tensor);
+  EXPECT_THAT(lhs_data, ElementsAreArray(expected_data));
+}
+
 template <class T>
 struct DequantizeOpQuantizePerTensor : ::testing::Test {};
 
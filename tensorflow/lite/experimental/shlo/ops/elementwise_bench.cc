@@ -0,0 +1,171 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstddef>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "tensorflow/lite/experimental/shlo/data_type.h"
+#include "tensorflow/lite/experimental/shlo/ops/benchmark_util.h"
+#include "tensorflow/lite/experimental/shlo/ops/multiply.h"
+#include "tensorflow/lite/experimental/shlo/ops/negate.h"
+#include "tensorflow/lite/experimental/shlo/shape.h"
+#include "tensorflow/lite/experimental/shlo/tensor.h"
+#include "tensorflow/lite/experimental/shlo/tensor_with_data.h"
+
+// Compares the elementwise ops with the element by element loops that they
+// used before processing their data in blocks.
+
+namespace shlo_ref {
+namespace {
+
+template <DataType data_type>
+void BM_Multiply(benchmark::State& state) {
+  const DimensionSize num_elements = state.range(0);
+  const Shape shape({num_elements});
+
+  auto lhs_values = GenerateRandomVector<data_type>(num_elements);
+  auto rhs_values = GenerateRandomVector<data_type>(num_elements);
+  auto lhs = TensorWithData::Create<data_type>(shape, lhs_values);
+  auto rhs = TensorWithData::Create<data_type>(shape, rhs_values);
+
+  Tensor result =
+      Tensor{.type = TensorType{.shape = shape, .element_type = data_type}};
+  MultiplyOp op = Create(MultiplyOp::Attributes{});
+  ABSL_CHECK_OK(Prepare(op, lhs.tensor(), rhs.tensor(), result));
+
+  std::vector<std::byte> result_values(result.SizeInBytes());
+  result.data = result_values.data();
+
+  for (auto _ : state) {
+    ABSL_CHECK_OK(Evaluate(op, lhs.tensor(), rhs.tensor(), result));
+  }
+}
+
+template <DataType data_type>
+void BM_MultiplyElementByElement(benchmark::State& state) {
+  using T = StorageType<data_type>;
+  const DimensionSize num_elements = state.range(0);
+
+  const std::vector<T> lhs = GenerateRandomVector<data_type>(num_elements);
+  const std::vector<T> rhs = GenerateRandomVector<data_type>(num_elements);
+  std::vector<T> result(num_elements);
+
+  for (auto _ : state) {
+    const T* lhs_data = lhs.data();
+    const T* rhs_data = rhs.data();
+    T* result_data = result.data();
+    for (DimensionSize i = 0; i < num_elements;
+         ++i, ++lhs_data, ++rhs_data, ++result_data) {
+      *result_data = static_cast<T>(*lhs_data * *rhs_data);
+    }
+    benchmark::DoNotOptimize(result.data());
+  }
+}
+
+template <DataType data_type>
+void BM_Negate(benchmark::State& state) {
+  const DimensionSize num_elements = state.range(0);
+  const Shape shape({num_elements});
+
+  auto operand_values = GenerateRandomVector<data_type>(num_elements);
+  auto operand = TensorWithData::Create<data_type>(shape, operand_values);
+
+  Tensor result =
+      Tensor{.type = TensorType{.shape = shape, .element_type = data_type}};
+  NegateOp op = Create(NegateOp::Attributes{});
+  ABSL_CHECK_OK(Prepare(op, operand.tensor(), result));
+
+  std::vector<std::byte> result_values(result.SizeInBytes());
+  result.data = result_values.data();
+
+  for (auto _ : state) {
+    ABSL_CHECK_OK(Evaluate(op, operand.tensor(), result));
+  }
+}
+
+template <DataType data_type>
+void BM_NegateElementByElement(benchmark::State& state) {
+  using T = StorageType<data_type>;
+  const DimensionSize num_elements = state.range(0);
+
+  const std::vector<T> operand = GenerateRandomVector<data_type>(num_elements);
+  std::vector<T> result(num_elements);
+
+  for (auto _ : state) {
+    const T* operand_data = operand.data();
+    T* result_data = result.data();
+    for (DimensionSize i = 0; i < num_elements;
+         ++i, ++operand_data, ++result_data) {
+      *result_data = static_cast<T>(-*operand_data);
+    }
+    benchmark::DoNotOptimize(result.data());
+  }
+}
+
+BENCHMARK(BM_Multiply<DataType::kSI8>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_MultiplyElementByElement<DataType::kSI8>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_Multiply<DataType::kSI32>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_MultiplyElementByElement<DataType::kSI32>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_Multiply<DataType::kBF16>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_MultiplyElementByElement<DataType::kBF16>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_Multiply<DataType::kF16>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_MultiplyElementByElement<DataType::kF16>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_Multiply<DataType::kF32>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_MultiplyElementByElement<DataType::kF32>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+
+BENCHMARK(BM_Negate<DataType::kSI8>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_NegateElementByElement<DataType::kSI8>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_Negate<DataType::kBF16>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_NegateElementByElement<DataType::kBF16>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_Negate<DataType::kF32>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+BENCHMARK(BM_NegateElementByElement<DataType::kF32>)
+    ->RangeMultiplier(2)
+    ->Range(KiB(8), KiB(64));
+
+}  // namespace
+}  // namespace shlo_ref
+
+BENCHMARK_MAIN();
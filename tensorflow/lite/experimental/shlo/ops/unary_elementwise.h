@@ -18,7 +18,6 @@ limitations under the License.
 
 #include <cstddef>
 
-#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/experimental/shlo/data_type.h"
@@ -101,6 +100,37 @@ void DequantizeOpQuantizePerAxis(F&& func, const Tensor& input,
       /*depth=*/0, /*quantization_index=*/0);
 }
 
+// Applies `func` to one block of elements. As the output does not overlap the
+// input, the compiler can vectorize the loop without checking at run time
+// whether a store changes the input.
+template <class T, class F>
+void ApplyUnaryToBlock(F& func, const T* __restrict input_data,
+                       T* __restrict output_data) {
+  for (DimensionSize i = 0; i < kElementwiseBlockSize; ++i) {
+    output_data[i] = func(input_data[i]);
+  }
+}
+
+// Applies `func` to each `input` element and writes the results to `output`,
+// which may be the input.
+template <DataType data_type, class F>
+void ApplyUnary(F& func, const Tensor& input, Tensor& output) {
+  using T = StorageType<data_type>;
+  const T* input_data = input.GetDataAs<data_type>();
+  T* output_data = output.GetDataAs<data_type>();
+  const DimensionSize num_elements = input.NumElements();
+  DimensionSize i = 0;
+  if (!DataOverlaps(input, output)) {
+    for (; i + kElementwiseBlockSize <= num_elements;
+         i += kElementwiseBlockSize) {
+      ApplyUnaryToBlock(func, input_data + i, output_data + i);
+    }
+  }
+  for (; i < num_elements; ++i) {
+    output_data[i] = func(input_data[i]);
+  }
+}
+
 template <DataType storage_type, DataType expressed_type, typename F>
 void DequantizeOpQuantizePerTensor(F& func, const Tensor& input,
                                    Tensor& output) {
@@ -130,8 +160,7 @@ void DequantizeOpQuantizePerTensor(F& func, const Tensor& input,
 
 template <DataType data_type, class F>
 void EvaluateNoQuantization(F&& func, const Tensor& input, Tensor& output) {
-  absl::c_transform(input.Flat<data_type>(), output.GetDataAs<data_type>(),
-                    static_cast<F&&>(func));
+  ApplyUnary<data_type>(func, input, output);
 }
 
 }  // namespace detail
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "tensorflow/lite/experimental/shlo/data_type.h"
 #include "tensorflow/lite/experimental/shlo/ops/test_util.h"
+#include "tensorflow/lite/experimental/shlo/ops/util.h"
 #include "tensorflow/lite/experimental/shlo/quantized_tensor_element_type.h"
 #include "tensorflow/lite/experimental/shlo/shape.h"
 #include "tensorflow/lite/experimental/shlo/status_matcher.h"
@@ -76,6 +77,33 @@ TYPED_TEST(UnaryElementWiseTest, NonQuantizedWithAbs) {
   EXPECT_THAT(output_data, ElementsAreArray(expected_data));
 }
 
+TYPED_TEST(UnaryElementWiseTest, NonQuantizedSeveralBlocksAndInPlace) {
+  using StorageT = typename TypeParam::StorageT;
+
+  // Three full blocks and a partial one.
+  const Shape shape({3, kElementwiseBlockSize + 5});
+  Vector<StorageT> input_data = RandomBuffer<TypeParam::kStorage>(shape);
+  Vector<StorageT> output_data(shape.NumElements());
+
+  Tensor input_tensor{
+      .type = TensorType{.shape = shape, .element_type = TypeParam::kStorage},
+      .data = input_data.data()};
+  Tensor output_tensor{
+      .type = TensorType{.shape = shape, .element_type = TypeParam::kStorage},
+      .data = output_data.data()};
+
+  Vector<StorageT> expected_data(shape.NumElements());
+  absl::c_transform(input_data, expected_data.begin(), Abs());
+
+  auto op = Create(UnaryElementwiseOp<Abs>::Attributes{}, Abs());
+  ASSERT_OK(Prepare(op, input_tensor, output_tensor));
+  ASSERT_OK(Evaluate(op, input_tensor, output_tensor));
+  EXPECT_THAT(output_data, ElementsAreArray(expected_data));
+
+  ASSERT_OK(Evaluate(op, input_tensor, input_tensor));
+  EXPECT_THAT(input_data, ElementsAreArray(expected_data));
+}
+
 template <class T>
 struct QuantizedUnaryElementWiseTest : ::testing::Test {};
 
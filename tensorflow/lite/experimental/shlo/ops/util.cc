@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/experimental/shlo/ops/util.h"
 
+#include <cstdint>
 #include <string>
 #include <variant>
 
@@ -96,4 +97,11 @@ absl::Status CheckSameBaselineType(CheckCtx ctx, const Tensor& tensor1,
   return absl::OkStatus();
 }
 
+bool DataOverlaps(const Tensor& tensor1, const Tensor& tensor2) {
+  const uintptr_t begin1 = reinterpret_cast<uintptr_t>(tensor1.data);
+  const uintptr_t begin2 = reinterpret_cast<uintptr_t>(tensor2.data);
+  return begin1 < begin2 + tensor2.SizeInBytes() &&
+         begin2 < begin1 + tensor1.SizeInBytes();
+}
+
 }  // namespace shlo_ref
@@ -28,6 +28,12 @@ namespace shlo_ref {
     return s;                             \
   }
 
+// Elementwise kernels process their data in blocks of this many elements. The
+// fixed trip count lets the compiler vectorize the loop over a block without
+// a remainder loop, which it also does at optimization levels that leave loops
+// over a run time number of elements scalar.
+inline constexpr DimensionSize kElementwiseBlockSize = 64;
+
 // Propagates the input shape to the output shape.
 //
 // If the output shape is already populated, checks that is it compatible with
@@ -96,6 +102,12 @@ bool IsQuantizedPerAxisTensor(const Tensor& tensor);
 absl::Status CheckSameBaselineType(CheckCtx ctx, const Tensor& tensor1,
                                    const Tensor& tensor2);
 
+// Returns true if the data buffers of `tensor1` and `tensor2` overlap.
+//
+// Kernels that write to a tensor whose buffer does not overlap their inputs
+// can access them through `__restrict` pointers.
+bool DataOverlaps(const Tensor& tensor1, const Tensor& tensor2);
+
 }  // namespace shlo_ref
 
 #endif  // TENSORFLOW_LITE_EXPERIMENTAL_SHLO_OPS_UTIL_H_
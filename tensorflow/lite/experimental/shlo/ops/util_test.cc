@@ -14,11 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/experimental/shlo/ops/util.h"
 
+#include <vector>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
+#include "tensorflow/lite/experimental/shlo/data_type.h"
 #include "tensorflow/lite/experimental/shlo/shape.h"
 #include "tensorflow/lite/experimental/shlo/status_matcher.h"
+#include "tensorflow/lite/experimental/shlo/tensor.h"
 
 using testing::ElementsAreArray;
 
@@ -46,5 +50,25 @@ TEST(UtilTest, PropagateToIncompatibleShapeFails) {
   EXPECT_THAT(output_shape.Dimensions(), ElementsAreArray({2, 3, 4, 6}));
 }
 
+TEST(UtilTest, DataOverlaps) {
+  std::vector<float> buffer(10);
+  const Shape shape({4});
+  Tensor first{
+      .type = TensorType{.shape = shape, .element_type = DataType::kF32},
+      .data = buffer.data()};
+  Tensor second{
+      .type = TensorType{.shape = shape, .element_type = DataType::kF32},
+      .data = buffer.data() + 3};
+  Tensor third{
+      .type = TensorType{.shape = shape, .element_type = DataType::kF32},
+      .data = buffer.data() + 4};
+
+  EXPECT_TRUE(DataOverlaps(first, first));
+  EXPECT_TRUE(DataOverlaps(first, second));
+  EXPECT_TRUE(DataOverlaps(second, first));
+  EXPECT_FALSE(DataOverlaps(first, third));
+  EXPECT_FALSE(DataOverlaps(third, first));
+}
+
 }  // namespace
 }  // namespace shlo_ref
@@ -70,6 +70,13 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the stage of a node given its index in the execution plan. Nodes
+  // of the same stage may be executed at the same time, so stages must not
+  // decrease along the execution plan. By default each node is its own stage.
+  virtual int node_stage(size_t index) const {
+    return static_cast<int>(index);
+  }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
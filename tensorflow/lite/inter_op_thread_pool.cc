@@ -0,0 +1,84 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/inter_op_thread_pool.h"
+
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+namespace tflite {
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int thread = 1; thread < num_threads; ++thread) {
+    workers_.emplace_back([this, thread] { WorkerLoop(thread); });
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void InterOpThreadPool::ParallelFor(
+    int num_tasks, const std::function<void(int task, int thread)>& task) {
+  if (num_tasks <= 0) return;
+  if (workers_.empty() || num_tasks == 1) {
+    for (int i = 0; i < num_tasks; ++i) task(i, 0);
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_ = &task;
+  num_tasks_ = num_tasks;
+  next_task_ = 0;
+  num_pending_ = num_tasks;
+  ++generation_;
+  work_available_.notify_all();
+  RunTasks(lock, 0);
+  work_done_.wait(lock, [this] { return num_pending_ == 0; });
+  task_ = nullptr;
+}
+
+void InterOpThreadPool::WorkerLoop(int thread) {
+  int generation = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_available_.wait(
+        lock, [&] { return stop_ || generation_ != generation; });
+    if (stop_) return;
+    generation = generation_;
+    RunTasks(lock, thread);
+  }
+}
+
+void InterOpThreadPool::RunTasks(std::unique_lock<std::mutex>& lock,
+                                 int thread) {
+  while (next_task_ < num_tasks_) {
+    const int i = next_task_++;
+    const std::function<void(int, int)>& task = *task_;
+    lock.unlock();
+    task(i, thread);
+    lock.lock();
+    if (--num_pending_ == 0) work_done_.notify_all();
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,68 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A fixed set of threads used to run independent nodes of a subgraph at the
+// same time. The calling thread takes part in the work, so a pool of
+// `num_threads` threads starts `num_threads - 1` workers.
+class InterOpThreadPool {
+ public:
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+
+  // Calls `task(i, thread)` for each i in [0, num_tasks), and returns once all
+  // the calls have returned. `thread` is in [0, num_threads()) and identifies
+  // the thread making the call, 0 being the calling thread. Not reentrant.
+  void ParallelFor(int num_tasks,
+                   const std::function<void(int task, int thread)>& task);
+
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+ private:
+  void WorkerLoop(int thread);
+
+  // Runs the tasks of the current batch not yet taken by another thread.
+  // Must be called with `mutex_` held.
+  void RunTasks(std::unique_lock<std::mutex>& lock, int thread);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+
+  // The current batch, guarded by `mutex_`.
+  const std::function<void(int, int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int num_pending_ = 0;
+  // Incremented for each batch, so that workers join each batch once.
+  int generation_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTER_OP_THREAD_POOL_H_
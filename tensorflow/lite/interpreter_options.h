@@ -103,12 +103,116 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  // Sets the factor by which the non-persistent arena is grown when it has to
+  // be reallocated, e.g. after `ResizeInputTensor`. A value larger than 1
+  // reserves extra memory so that later growth does not reallocate the arena.
+  // Values smaller than 1 are treated as 1.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetArenaGrowthFactor(float value) {
+    experimental_arena_growth_factor_ = value < 1.0f ? 1.0f : value;
+  }
+
+  // Returns the factor by which the non-persistent arena is grown.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  float GetArenaGrowthFactor() const {
+    return experimental_arena_growth_factor_;
+  }
+
+  // Sets the number of input shapes for which the results of `Prepare` are
+  // kept. When `AllocateTensors` is called again with input shapes seen
+  // before, the output and temporary shapes of ops that keep no state across
+  // `Prepare` are restored instead of calling their `Prepare` again.
+  // 0, the default, disables the cache.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetShapePlanCacheSize(int value) {
+    experimental_shape_plan_cache_size_ = value;
+  }
+
+  // Returns the number of input shapes for which the results of `Prepare` are
+  // kept.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  int GetShapePlanCacheSize() const {
+    return experimental_shape_plan_cache_size_;
+  }
+
+  // Sets the number of threads used to run independent nodes of a subgraph at
+  // the same time. The nodes are grouped into stages of nodes that don't
+  // depend on each other, and the nodes of a stage run in parallel. Tensors
+  // used by a stage don't share memory, so the arena may grow. Stages are only
+  // run in parallel when no tensor is dynamic and no profiler is set; nodes
+  // that are delegated, use resources or invoke other subgraphs run alone.
+  // Each thread uses its own CPU backend context. 1, the default, runs nodes
+  // one at a time.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetNumInterOpThreads(int value) {
+    experimental_num_inter_op_threads_ = value < 1 ? 1 : value;
+  }
+
+  // Returns the number of threads used to run independent nodes.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  int GetNumInterOpThreads() const {
+    return experimental_num_inter_op_threads_;
+  }
+
+  // If set to `true`, kernels share the buffers they derive from constant
+  // weights during `Prepare`, such as the transposed filter of float CONV_2D or
+  // the unpacked int4 filter of FULLY_CONNECTED, with every interpreter of the
+  // process using identical weights. Running several interpreters of one model
+  // then holds one copy of these buffers instead of one per interpreter.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetShareRepackedWeights(bool value) {
+    experimental_share_repacked_weights_ = value;
+  }
+
+  // If `true`, kernels share the buffers they derive from constant weights
+  // across interpreters.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  bool GetShareRepackedWeights() const {
+    return experimental_share_repacked_weights_;
+  }
+
+  // If set to `true`, `InterpreterBuilder` doesn't parse the builtin options of
+  // each op when building the interpreter. The options of a node are parsed
+  // when it is first prepared, or when it is looked up through
+  // `TfLiteContext::GetNodeAndRegistration`, e.g. by a delegate. This shortens
+  // the time to build interpreters of models with many ops. Until then,
+  // `Interpreter::node_and_registration` returns nodes without builtin data.
+  // Ops whose builtin kernels read their options in `init`, such as WHILE, are
+  // still parsed when building, but custom kernels registered for other
+  // builtin ops must not read them in `init`.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetDeferOpDataParsing(bool value) {
+    experimental_defer_op_data_parsing_ = value;
+  }
+
+  // If `true`, the builtin options of ops are parsed when nodes are first
+  // prepared rather than when the interpreter is built.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  bool GetDeferOpDataParsing() const {
+    return experimental_defer_op_data_parsing_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  float experimental_arena_growth_factor_ = 1.0f;
+  int experimental_shape_plan_cache_size_ = 0;
+  int experimental_num_inter_op_threads_ = 1;
+  bool experimental_share_repacked_weights_ = false;
+  bool experimental_defer_op_data_parsing_ = false;
 };
 
 }  // namespace tflite
@@ -1129,6 +1129,160 @@ TEST(BasicInterpreter, ReleaseDynamicTensors) {
   ASSERT_EQ(interpreter.tensor(3)->bytes, sizeof(float) * 6 * 6);
 }
 
+int num_stateless_prepares = 0;
+
+TEST(BasicInterpreter, ShapePlanCacheSkipsStatelessPrepare) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {1}, quantized),
+              kTfLiteOk);
+  }
+  // Doubles the size of its input, and keeps no state.
+  TfLiteRegistration stateless = {nullptr, nullptr, nullptr, nullptr};
+  stateless.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++num_stateless_prepares;
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    TfLiteIntArray* new_size = TfLiteIntArrayCreate(1);
+    new_size->data[0] = 2 * input->dims->data[0];
+    return context->ResizeTensor(context, output, new_size);
+  };
+  TfLiteRegistration passthrough = GetPassthroughOpRegistration();
+  ASSERT_EQ(interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr,
+                                              &stateless),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr,
+                                              &passthrough),
+            kTfLiteOk);
+  InterpreterOptions options;
+  options.SetShapePlanCacheSize(2);
+  interpreter.ApplyOptions(&options);
+
+  num_stateless_prepares = 0;
+  for (int size : {2, 3, 2, 3}) {
+    ASSERT_EQ(interpreter.ResizeInputTensor(0, {size}), kTfLiteOk);
+    ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+    ASSERT_EQ(interpreter.tensor(1)->dims->data[0], 2 * size);
+    EXPECT_EQ(interpreter.tensor(2)->dims->data[0], 2 * size);
+    EXPECT_EQ(interpreter.tensor(2)->bytes, 2 * size * sizeof(float));
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  }
+  // The shapes seen before were restored.
+  EXPECT_EQ(num_stateless_prepares, 2);
+
+  // Inputs of a new shape are prepared, and evict the least recently used.
+  for (int size : {4, 2}) {
+    ASSERT_EQ(interpreter.ResizeInputTensor(0, {size}), kTfLiteOk);
+    ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+    EXPECT_EQ(interpreter.tensor(2)->dims->data[0], 2 * size);
+  }
+  EXPECT_EQ(num_stateless_prepares, 4);
+}
+
+// Sums its inputs, which all have the shape of the first one, plus one.
+TfLiteRegistration GetSumPlusOneOpRegistration() {
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    const int num_elements = NumElements(output);
+    for (int i = 0; i < num_elements; ++i) {
+      output->data.f[i] = 1.0f;
+    }
+    for (int j = 0; j < node->inputs->size; ++j) {
+      const TfLiteTensor* input;
+      TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, j, &input));
+      for (int i = 0; i < num_elements; ++i) {
+        output->data.f[i] += input->data.f[i];
+      }
+    }
+    return kTfLiteOk;
+  };
+  return reg;
+}
+
+TEST(BasicInterpreter, InterOpThreadsRunIndependentNodesInParallel) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(5), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({4}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {256}, quantized),
+              kTfLiteOk);
+  }
+  // Two branches, 0 -> 1 -> 2 and 0 -> 3, joined into 4.
+  TfLiteRegistration reg = GetSumPlusOneOpRegistration();
+  for (const auto& [inputs, output] :
+       std::vector<std::pair<std::vector<int>, int>>{
+           {{0}, 1}, {{1}, 2}, {{0}, 3}, {{2, 3}, 4}}) {
+    ASSERT_EQ(interpreter.AddNodeWithParameters(inputs, {output}, nullptr, 0,
+                                                nullptr, &reg),
+              kTfLiteOk);
+  }
+  InterpreterOptions options;
+  options.SetNumInterOpThreads(2);
+  interpreter.ApplyOptions(&options);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The plan is ordered by stage: the first and third nodes run together.
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 2, 1, 3}));
+  // Tensors used by the same stage don't share memory.
+  EXPECT_NE(interpreter.tensor(1)->data.raw, interpreter.tensor(3)->data.raw);
+
+  for (int run = 0; run < 3; ++run) {
+    for (int i = 0; i < 256; ++i) {
+      interpreter.typed_tensor<float>(0)[i] = i + run;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int i = 0; i < 256; ++i) {
+      // (x + 2) + (x + 1) + 1
+      ASSERT_EQ(interpreter.typed_tensor<float>(4)[i], 2 * (i + run) + 4);
+    }
+  }
+}
+
+TEST(BasicInterpreter, InterOpThreadsKeepPlanByDefault) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(4), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2, 3}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {4}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg = GetSumPlusOneOpRegistration();
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 1, 2}));
+}
+
 TEST(InterpreterTensorsCapacityTest, TestWithinHeadroom) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(Interpreter::kTensorsReservedCapacity),
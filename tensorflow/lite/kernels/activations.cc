@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/cppmath.h"
 #include "tensorflow/lite/kernels/internal/optimized/integer_ops/leaky_relu.h"
 #include "tensorflow/lite/kernels/internal/optimized/integer_ops/lut.h"
+#include "tensorflow/lite/kernels/internal/optimized/integer_ops/softmax.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/binary_function.h"
@@ -1303,9 +1304,15 @@ TfLiteStatus SoftmaxQuantized<int16, int16>(TfLiteContext* context,
                                             SoftmaxOpData* data,
                                             KernelType kernel_type) {
   if (NumDimensions(input) >= 1 && NumDimensions(input) <= 4) {
-    reference_ops::SoftmaxInt16(
-        data->params, GetTensorShape(input), GetTensorData<int16_t>(input),
-        GetTensorShape(output), GetTensorData<int16_t>(output));
+    if (kernel_type == kReference) {
+      reference_ops::SoftmaxInt16(
+          data->params, GetTensorShape(input), GetTensorData<int16_t>(input),
+          GetTensorShape(output), GetTensorData<int16_t>(output));
+    } else {
+      optimized_integer_ops::SoftmaxInt16(
+          data->params, GetTensorShape(input), GetTensorData<int16_t>(input),
+          GetTensorShape(output), GetTensorData<int16_t>(output));
+    }
     return kTfLiteOk;
   } else {
     TF_LITE_KERNEL_LOG(context,
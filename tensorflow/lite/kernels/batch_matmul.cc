@@ -19,12 +19,14 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/optimized/4bit/int4_weights.h"
 #include "tensorflow/lite/kernels/internal/optimized/batch_matmul.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
@@ -131,9 +133,10 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
   TfLiteIntArrayFree(node->temporaries);
   // For "hybrid" quantization, we impose the constraint that the LHS
   // is float (typically an activation from a prior layer) and the RHS
-  // is quantized int8.
+  // is quantized int8 or int4.
   bool is_hybrid =
-      (op_context->lhs->type == kTfLiteFloat32 && rhs->type == kTfLiteInt8);
+      (op_context->lhs->type == kTfLiteFloat32 &&
+       (rhs->type == kTfLiteInt8 || rhs->type == kTfLiteInt4));
   if (is_hybrid) {
     node->temporaries = TfLiteIntArrayCreate(kNumTempTensorsForAdjoints +
                                              kNumTempTensorsForHybrid);
@@ -221,7 +224,7 @@ TfLiteStatus InitializeTemporaries(TfLiteContext* context, TfLiteNode* node,
     TfLiteTensor* input_quantized;
     TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/2,
                                                 &input_quantized));
-    input_quantized->type = op_context->rhs->type;
+    input_quantized->type = kTfLiteInt8;
     input_quantized->allocation_type = kTfLiteArenaRw;
 
     TfLiteIntArray* input_quantized_size =
@@ -344,11 +347,13 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                               lhs_data->type == kTfLiteInt16);
   TF_LITE_ENSURE(context, rhs_data->type == kTfLiteFloat32 ||
                               rhs_data->type == kTfLiteInt8 ||
-                              rhs_data->type == kTfLiteInt16);
-  // Either we have a hybrid quantization with a float32 and an int8 input,
-  // otherwise both inputs should be of the same type.
+                              rhs_data->type == kTfLiteInt16 ||
+                              rhs_data->type == kTfLiteInt4);
+  // Either we have a hybrid quantization with a float32 and an int8 or int4
+  // input, otherwise both inputs should be of the same type.
   TF_LITE_ENSURE(context, (lhs_data->type == kTfLiteFloat32 &&
-                           rhs_data->type == kTfLiteInt8) ||
+                           (rhs_data->type == kTfLiteInt8 ||
+                            rhs_data->type == kTfLiteInt4)) ||
                               lhs_data->type == rhs_data->type);
   // Support dimensions between 2 and 5, inclusive.
   TF_LITE_ENSURE(context, NumDimensions(lhs_data) >= 2);
@@ -381,6 +386,26 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                             : extended_rhs_shape.Dims(output_rank - 2);
 
   TF_LITE_ENSURE_EQ(context, accum_dim_lhs, accum_dim_rhs);
+
+  if (rhs_data->type == kTfLiteInt4) {
+    // The int4 kernels need every row of the transposed RHS to start on a
+    // byte.
+    TF_LITE_ENSURE_MSG(context, accum_dim_rhs % 2 == 0,
+                       "Int4 BatchMatMul needs an even accumulation depth.");
+    if (rhs_data->quantization.type == kTfLiteAffineQuantization) {
+      const auto* qparams = static_cast<const TfLiteAffineQuantization*>(
+          rhs_data->quantization.params);
+      TF_LITE_ENSURE(context, qparams->scale != nullptr);
+      if (qparams->scale->size > 1) {
+        // Per-channel scales are along the output columns of the RHS.
+        const int num_units_dim = adj_y ? rhs_rank - 2 : rhs_rank - 1;
+        TF_LITE_ENSURE_EQ(context, qparams->quantized_dimension,
+                          num_units_dim);
+        TF_LITE_ENSURE_EQ(context, qparams->scale->size,
+                          SizeOfDimension(rhs_data, num_units_dim));
+      }
+    }
+  }
   TfLiteStatus status =
       ResizeOutputTensor(context, extended_lhs_shape, extended_rhs_shape, adj_x,
                          adj_y, output_rank, output);
@@ -407,6 +432,36 @@ void TransposeRowsColumnsImpl(const TfLiteTensor* tensor_in,
   optimized_ops::Transpose(params, shape, input, transposed_shape, output);
 }
 
+// Transposes the last two dimensions of an int4 tensor, whose values are
+// packed two per byte.
+void TransposeRowsColumnsInt4(const TfLiteTensor* tensor_in,
+                              TfLiteTensor* tensor_out) {
+  const RuntimeShape shape = GetTensorShape(tensor_in);
+  const int rank = shape.DimensionsCount();
+  const int rows = shape.Dims(rank - 2);
+  const int cols = shape.Dims(rank - 1);
+  int num_matrices = 1;
+  for (int i = 0; i < rank - 2; ++i) {
+    num_matrices *= shape.Dims(i);
+  }
+  const int8_t* input = GetTensorData<int8_t>(tensor_in);
+  int8_t* output = GetTensorData<int8_t>(tensor_out);
+  std::memset(output, 0, tensor_out->bytes);
+  for (int m = 0; m < num_matrices; ++m) {
+    for (int r = 0; r < rows; ++r) {
+      for (int c = 0; c < cols; ++c) {
+        const int64_t in_index =
+            (static_cast<int64_t>(m) * rows + r) * cols + c;
+        const int64_t out_index =
+            (static_cast<int64_t>(m) * cols + c) * rows + r;
+        const uint8_t byte = static_cast<uint8_t>(input[in_index / 2]);
+        const uint8_t nibble = (byte >> (4 * (in_index % 2))) & 0x0F;
+        output[out_index / 2] |= nibble << (4 * (out_index % 2));
+      }
+    }
+  }
+}
+
 TfLiteStatus TransposeRowsColumns(TfLiteContext* context,
                                   const TfLiteTensor* tensor_in,
                                   TfLiteTensor* tensor_out) {
@@ -425,9 +480,13 @@ TfLiteStatus TransposeRowsColumns(TfLiteContext* context,
         tensor_in, GetTensorData<int16_t>(tensor_in), tensor_out,
         GetTensorData<int16_t>(tensor_out));
     return kTfLiteOk;
+  } else if (tensor_in->type == kTfLiteInt4) {
+    TransposeRowsColumnsInt4(tensor_in, tensor_out);
+    return kTfLiteOk;
   } else {
-    TF_LITE_KERNEL_LOG(
-        context, "Can only transpose tensors with float, int8 or int16 type.");
+    TF_LITE_KERNEL_LOG(context,
+                       "Can only transpose tensors with float, int8, int16 or "
+                       "int4 type.");
     return kTfLiteError;
   }
 }
@@ -440,6 +499,82 @@ RuntimeShape SwapRowColumnDims(const RuntimeShape& shape) {
   return swapped_shape;
 }
 
+// Same as the hybrid reference_ops::BatchMatMul, but with an int4 LHS (the
+// weights), multiplied without unpacking it to memory. `input_offset` may be
+// null for symmetrically quantized inputs, and `per_channel_scale` null if the
+// scale of the weights is already in `scaling_factors`.
+void BatchMatMulInt4(const RuntimeShape& lhs_shape, const int8_t* lhs_data,
+                     const RuntimeShape& rhs_shape, const int8_t* rhs_data,
+                     const float* scaling_factors, const int32_t* input_offset,
+                     int32_t* row_sums, const float* per_channel_scale,
+                     const RuntimeShape& output_shape, float* output_data,
+                     bool* compute_row_sums) {
+  using reference_ops::batch_matmul::broadcast_dim;
+  using reference_ops::batch_matmul::extent;
+  const RuntimeShape extended_lhs_shape =
+      RuntimeShape::ExtendedShape(5, lhs_shape);
+  const RuntimeShape extended_rhs_shape =
+      RuntimeShape::ExtendedShape(5, rhs_shape);
+
+  const int batch_dim0 = broadcast_dim(
+      extended_lhs_shape.Dims(0), extended_rhs_shape.Dims(0));
+  const int batch_dim1 = broadcast_dim(
+      extended_lhs_shape.Dims(1), extended_rhs_shape.Dims(1));
+  const int batch_dim2 = broadcast_dim(
+      extended_lhs_shape.Dims(2), extended_rhs_shape.Dims(2));
+
+  const int lhs_ext0 = extent(extended_lhs_shape, 0);
+  const int lhs_ext1 = extent(extended_lhs_shape, 1);
+  const int lhs_ext2 = extent(extended_lhs_shape, 2);
+  const int rhs_ext0 = extent(extended_rhs_shape, 0);
+  const int rhs_ext1 = extent(extended_rhs_shape, 1);
+  const int rhs_ext2 = extent(extended_rhs_shape, 2);
+
+  const int lhs_rows = extended_lhs_shape.Dims(3);
+  const int rhs_cols = extended_rhs_shape.Dims(4);
+  const int accum_depth = extended_lhs_shape.Dims(4);
+
+  const int ioff_ext0 = rhs_ext0 == 0 ? 0 : rhs_cols;
+  const int ioff_ext1 = rhs_ext1 == 0 ? 0 : rhs_cols;
+  const int ioff_ext2 = rhs_ext2 == 0 ? 0 : rhs_cols;
+  const int woff_ext0 = lhs_ext0 == 0 ? 0 : lhs_rows;
+  const int woff_ext1 = lhs_ext1 == 0 ? 0 : lhs_rows;
+  const int woff_ext2 = lhs_ext2 == 0 ? 0 : lhs_rows;
+
+  if (input_offset != nullptr && *compute_row_sums) {
+    int num_weights_matrices = 1;
+    for (int i = 0; i < extended_lhs_shape.DimensionsCount() - 2; ++i) {
+      num_weights_matrices *= extended_lhs_shape.Dims(i);
+    }
+    optimized_4bit::Int4RowSums(lhs_data, num_weights_matrices * lhs_rows,
+                                accum_depth, row_sums);
+    *compute_row_sums = false;
+  }
+
+  // The accumulation depth is even, so every matrix of the LHS starts on a
+  // byte, at half of its element offset.
+  for (int b0 = 0; b0 < batch_dim0; ++b0) {
+    for (int b1 = 0; b1 < batch_dim1; ++b1) {
+      for (int b2 = 0; b2 < batch_dim2; ++b2) {
+        const int8_t* lhs_ptr =
+            lhs_data + (b0 * lhs_ext0 + b1 * lhs_ext1 + b2 * lhs_ext2) / 2;
+        const int8_t* rhs_ptr =
+            rhs_data + b0 * rhs_ext0 + b1 * rhs_ext1 + b2 * rhs_ext2;
+        const int ioff_index = b0 * ioff_ext0 + b1 * ioff_ext1 + b2 * ioff_ext2;
+        const int woff_index = b0 * woff_ext0 + b1 * woff_ext1 + b2 * woff_ext2;
+        float* out_ptr = output_data + ((b0 * batch_dim1 * batch_dim2) +
+                                        b1 * batch_dim2 + b2) *
+                                           lhs_rows * rhs_cols;
+        optimized_4bit::Int4MatrixBatchVectorMultiplyAccumulate(
+            lhs_ptr, lhs_rows, accum_depth, rhs_ptr,
+            scaling_factors + ioff_index, rhs_cols, per_channel_scale,
+            input_offset == nullptr ? nullptr : input_offset + ioff_index,
+            row_sums + woff_index, out_ptr);
+      }
+    }
+  }
+}
+
 TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
                         const RuntimeShape& input_shape,
                         const TfLiteTensor* input,
@@ -481,9 +616,23 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
                                     input_size, quant_data, scaling_factors_ptr,
                                     input_offset_ptr,
                                     params->asymmetric_quantize_inputs);
-  for (int b = 0; b < num_batches_to_quantize; ++b) {
-    // Incorporate scaling of the filter.
-    scaling_factors_ptr[b] *= filter->params.scale;
+  // `filter` may be the transposed temporary, which only has the per-tensor
+  // scale. Per-channel scales of int4 filters are applied by the int4 kernel.
+  const float* per_channel_scale = nullptr;
+  const TfLiteTensor* rhs = GetInput(context, node, kInputRHSTensor);
+  if (filter->type == kTfLiteInt4 &&
+      rhs->quantization.type == kTfLiteAffineQuantization) {
+    const auto* qparams = static_cast<const TfLiteAffineQuantization*>(
+        rhs->quantization.params);
+    if (qparams->scale->size > 1) {
+      per_channel_scale = qparams->scale->data;
+    }
+  }
+  if (per_channel_scale == nullptr) {
+    for (int b = 0; b < num_batches_to_quantize; ++b) {
+      // Incorporate scaling of the filter.
+      scaling_factors_ptr[b] *= filter->params.scale;
+    }
   }
 
   RuntimeShape output_shape = GetTensorShape(output);
@@ -492,10 +641,21 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node, OpData* data,
     output_size *= output_shape.Dims(i);
   }
   std::fill_n(GetTensorData<float>(output), output_size, 0.0f);
-  reference_ops::BatchMatMul(
-      filter_shape, filter_data, input_shape, quant_data, scaling_factors_ptr,
-      input_offset_ptr, row_sums_ptr, GetTensorShape(output),
-      GetTensorData<float>(output), &(data->compute_row_sums));
+  if (filter->type == kTfLiteInt4) {
+    if (!IsConstantTensor(rhs)) {
+      data->compute_row_sums = true;
+    }
+    BatchMatMulInt4(
+        filter_shape, filter_data, input_shape, quant_data, scaling_factors_ptr,
+        params->asymmetric_quantize_inputs ? input_offset_ptr : nullptr,
+        row_sums_ptr, per_channel_scale, GetTensorShape(output),
+        GetTensorData<float>(output), &(data->compute_row_sums));
+  } else {
+    reference_ops::BatchMatMul(
+        filter_shape, filter_data, input_shape, quant_data, scaling_factors_ptr,
+        input_offset_ptr, row_sums_ptr, GetTensorShape(output),
+        GetTensorData<float>(output), &(data->compute_row_sums));
+  }
 
   return kTfLiteOk;
 }
@@ -612,7 +772,8 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                            const RuntimeShape& rhs_shape,
                            const TfLiteTensor* rhs, TfLiteTensor* output,
                            bool transpose_lhs) {
-  if (lhs->type == kTfLiteFloat32 && rhs->type == kTfLiteInt8) {
+  if (lhs->type == kTfLiteFloat32 &&
+      (rhs->type == kTfLiteInt8 || rhs->type == kTfLiteInt4)) {
     TfLiteTensor* input_quantized;
     TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, /*index=*/2,
                                                 &input_quantized));
@@ -660,7 +821,8 @@ TfLiteTensor* GetTempRhs(TfLiteContext* context, TfLiteNode* node,
     return nullptr;
   }
 
-  if (rhs->type == kTfLiteInt8 || rhs->type == kTfLiteInt16) {
+  if (rhs->type == kTfLiteInt8 || rhs->type == kTfLiteInt16 ||
+      rhs->type == kTfLiteInt4) {
     // Get the quantization params from the RHS tensor.
     transposed_rhs->params.scale = rhs->params.scale;
     transposed_rhs->params.zero_point = rhs->params.zero_point;
@@ -738,7 +900,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   lhs_dims_count = orig_lhs_shape.DimensionsCount();
   const TfLiteTensor* rhs_tensor = rhs;
   bool implicit_transpose_possible = true;
-  if ((lhs->type == kTfLiteFloat32 && rhs->type == kTfLiteInt8) ||
+  if ((lhs->type == kTfLiteFloat32 &&
+       (rhs->type == kTfLiteInt8 || rhs->type == kTfLiteInt4)) ||
       kernel_type == kReference || rhs->type == kTfLiteInt16) {
     implicit_transpose_possible = false;
   }
@@ -780,6 +943,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                                    GetTensorData<float>(output));
       }
       break;
+    case kTfLiteInt4:
     case kTfLiteInt8:
     case kTfLiteInt16:
       EvalQuantized<kernel_type>(context, node, op_data, lhs_shape, lhs_tensor,
@@ -463,6 +463,16 @@ class HybridBatchMatMulOpModel : public SingleOpModel {
     AllocateAndDelegate(true);
   }
 
+  void SetSignedWeights4Bit(const std::vector<float>& f) {
+    SignedSymmetricQuantizeAndPopulate4Bit(rhs_id_, f);
+    AllocateAndDelegate(true);
+  }
+
+  void SetPerChannelSignedWeights(const std::vector<float>& f) {
+    PerChannelSymmetricQuantizeAndPopulate(rhs_id_, f);
+    AllocateAndDelegate(true);
+  }
+
   void SetInput(const std::vector<float>& f) { PopulateTensor(lhs_id_, f); }
   std::vector<float> GetOutput() { return ExtractVector<float>(output_id_); }
   std::vector<int> GetOutputShape() { return GetTensorShape(output_id_); }
@@ -834,6 +844,30 @@ TEST_P(HybridAsymmetricBatchMatMulOpTest, QuantizedInt8BroadcastInputs) {
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 2, 3}));
 }
 
+TEST_P(HybridAsymmetricBatchMatMulOpTest, SimpleTestQuantizedInt4) {
+  HybridBatchMatMulOpModel m(
+      /*units=*/3, /*batches=*/2,
+      /*lhs=*/{TensorType_FLOAT32, {2, 10}},
+      /*rhs=*/{TensorType_INT4, {10, 3}, 0, 0, 1.0, 0});
+
+  m.SetSignedWeights4Bit({
+      1, 1, 1, 2, 2, 2, 3, 3, 3, 4,  4,  4,  5,  5,  5,
+      6, 6, 6, 7, 7, 7, -1, -1, -1, -2, -2, -2, -3, -3, -3,
+  });
+
+  m.SetInput({
+      11, 12, 13, 14, 15, 16, 17, 18,  -19, -20,  // batch 1, 0
+      11, 12, 13, 14, 15, 16, 17, -18, 19,  -20,  // batch 1, 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                 {500, 500, 500, 460, 460, 460},
+                                 /*max_abs_error=*/3.f)));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 3}));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     HybridAsymmetricBatchMatMulOpTest, HybridAsymmetricBatchMatMulOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
@@ -999,6 +1033,94 @@ TEST_P(HybridSymmetricBatchMatMulOpTest, QuantizedInt8BroadcastInputs) {
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 2, 3}));
 }
 
+// Returns integer inputs of magnitude at most 127, including 127, so that
+// their symmetric quantization is exact.
+std::vector<float> ExactlyQuantizableInputs(int batches, int input_size) {
+  std::vector<float> inputs(batches * input_size);
+  for (int b = 0; b < batches; ++b) {
+    for (int i = 0; i < input_size; ++i) {
+      inputs[b * input_size + i] =
+          i == 0 ? 127 : (i * 37 + b * 11) % 255 - 127;
+    }
+  }
+  return inputs;
+}
+
+TEST_P(HybridSymmetricBatchMatMulOpTest, QuantizedInt4BroadcastWeights) {
+  // 40 values per row exercise both the vectorized and the scalar part of the
+  // int4 kernel, and 3 * 2 input vectors a full and a partial group of
+  // vectors.
+  constexpr int kInputSize = 40;
+  constexpr int kUnits = 4;
+  HybridBatchMatMulOpModel m(
+      /*units=*/kUnits, /*batches=*/6,
+      /*lhs=*/{TensorType_FLOAT32, {2, 3, kInputSize}},
+      /*rhs=*/{TensorType_INT4, {kInputSize, kUnits}, 0, 0, 0.5, 0},
+      /*output=*/{TensorType_FLOAT32}, /*asymmetric_quantize_inputs=*/false);
+
+  std::vector<float> weights(kInputSize * kUnits);
+  for (int i = 0; i < kInputSize; ++i) {
+    for (int u = 0; u < kUnits; ++u) {
+      weights[i * kUnits + u] = 0.5f * ((i + 3 * u) % 15 - 7);
+    }
+  }
+  m.SetSignedWeights4Bit(weights);
+  const std::vector<float> inputs = ExactlyQuantizableInputs(6, kInputSize);
+  m.SetInput(inputs);
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected(6 * kUnits, 0.0f);
+  for (int b = 0; b < 6; ++b) {
+    for (int u = 0; u < kUnits; ++u) {
+      for (int i = 0; i < kInputSize; ++i) {
+        expected[b * kUnits + u] +=
+            inputs[b * kInputSize + i] * weights[i * kUnits + u];
+      }
+    }
+  }
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, 3, kUnits}));
+}
+
+TEST_P(HybridSymmetricBatchMatMulOpTest, PerChannelQuantizedInt4AdjRHS) {
+  constexpr int kInputSize = 64;
+  constexpr int kUnits = 3;
+  const std::vector<float> scales = {0.5, 0.25, 1.0};
+  HybridBatchMatMulOpModel m(
+      /*units=*/kUnits, /*batches=*/2,
+      /*lhs=*/{TensorType_FLOAT32, {2, kInputSize}},
+      /*rhs=*/
+      {TensorType_INT4, {kUnits, kInputSize}, 0, 0, 0, 0, true, scales,
+       std::vector<int64_t>(kUnits, 0), /*channel_index=*/0},
+      /*output=*/{TensorType_FLOAT32}, /*asymmetric_quantize_inputs=*/false,
+      /*adj_x=*/false, /*adj_y=*/true);
+
+  std::vector<float> weights(kUnits * kInputSize);
+  for (int u = 0; u < kUnits; ++u) {
+    for (int i = 0; i < kInputSize; ++i) {
+      weights[u * kInputSize + i] = scales[u] * ((i + u) % 15 - 7);
+    }
+  }
+  m.SetPerChannelSignedWeights(weights);
+  const std::vector<float> inputs = ExactlyQuantizableInputs(2, kInputSize);
+  m.SetInput(inputs);
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected(2 * kUnits, 0.0f);
+  for (int b = 0; b < 2; ++b) {
+    for (int u = 0; u < kUnits; ++u) {
+      for (int i = 0; i < kInputSize; ++i) {
+        expected[b * kUnits + u] +=
+            inputs[b * kInputSize + i] * weights[u * kInputSize + i];
+      }
+    }
+  }
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({2, kUnits}));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     HybridSymmetricBatchMatMulOpTest, HybridSymmetricBatchMatMulOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
@@ -46,6 +46,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/kernels/padding.h"
+#include "tensorflow/lite/kernels/repacked_weights_cache.h"
 #include "tensorflow/lite/util.h"
 
 namespace tflite {
@@ -109,6 +110,10 @@ struct OpData {
 
   bool need_hwcn_weights = false;
   bool have_weights_been_transposed = false;
+  // If true, the transposed weights are taken from the RepackedWeightsCache
+  // into `shared_hwcn_weights` instead of the `hwcn_weights` temporary.
+  bool share_hwcn_weights = false;
+  std::shared_ptr<const RepackedWeightsCache::Buffer> shared_hwcn_weights;
   bool need_im2col = false;
   // If it's true, it means im2col is needed but gets disabled because the
   // temporary im2col tensor requires too much memory (i.e.
@@ -158,11 +163,8 @@ void Free(TfLiteContext* context, void* buffer) {
 // Naive implementation of transpose for floats. Could be optimized to be more
 // cache friendly, but for now it's a one-time cost on first run, and we would
 // prefer to remove the need to do this at all eventually.
-void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
-  const int rows = output->dims->data[1];
-  const int cols = output->dims->data[0];
-  const float* input_data = GetTensorData<float>(input);
-  float* output_data = GetTensorData<float>(output);
+void TransposeFloatTensor(const float* input_data, int rows, int cols,
+                          float* output_data) {
   for (int i = 0; i < rows; ++i) {
     for (int j = 0; j < cols; ++j) {
       const float in_value = input_data[i * cols + j];
@@ -171,6 +173,11 @@ void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
   }
 }
 
+void TransposeFloatTensor(const TfLiteTensor* input, TfLiteTensor* output) {
+  TransposeFloatTensor(GetTensorData<float>(input), output->dims->data[1],
+                       output->dims->data[0], GetTensorData<float>(output));
+}
+
 // Check if im2col needs to be allocated, as some version of optimized Conv dont
 // use it. If any change is supporting im2col in any of the Conv versions, then
 // it should be updated here as well
@@ -243,6 +250,11 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
   // we're running with that data type.
   data->need_hwcn_weights =
       input->type == kTfLiteFloat32 && data->supports_multithreaded_kernel;
+  // Constant weights are transposed once for all the interpreters sharing
+  // repacked weights, so they don't need a temporary of their own.
+  data->share_hwcn_weights =
+      data->need_hwcn_weights && IsConstantTensor(filter) &&
+      RepackedWeightsCache::GetFromContext(context) != nullptr;
 
   // We don't always need to allocate im2col. It is only used in some versions
   // of the optimized Conv. This test just mimics something that happens inside
@@ -270,7 +282,7 @@ static TfLiteStatus AllocateTemporaryTensorsIfRequired(
     }
     ++temporaries_count;
   }
-  if (data->need_hwcn_weights) {
+  if (data->need_hwcn_weights && !data->share_hwcn_weights) {
     data->hwcn_weights_index = temporaries_count;
     if (data->hwcn_weights_id == kTensorNotAllocated) {
       context->AddTensors(context, 1, &data->hwcn_weights_id);
@@ -527,7 +539,21 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     if (im2col_status != kTfLiteOk) return im2col_status;
   }
 
-  if (data->need_hwcn_weights) {
+  if (data->share_hwcn_weights) {
+    const int rows = channels_out;
+    const int cols = filter_height * filter_width * channels_in;
+    data->shared_hwcn_weights =
+        RepackedWeightsCache::GetFromContext(context)->GetOrRepack(
+            "conv_hwcn_float", *filter, filter->bytes, [&](uint8_t* output) {
+              TransposeFloatTensor(GetTensorData<float>(filter), rows, cols,
+                                   reinterpret_cast<float*>(output));
+            });
+    data->have_weights_been_transposed = true;
+  } else {
+    data->shared_hwcn_weights.reset();
+  }
+
+  if (data->need_hwcn_weights && !data->share_hwcn_weights) {
     node->temporaries->data[data->hwcn_weights_index] = data->hwcn_weights_id;
     TfLiteIntArray* hwcn_weights_size = TfLiteIntArrayCreate(2);
 
@@ -978,7 +1004,10 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
     case kMultithreadOptimized: {
 #if defined(TFLITE_WITH_MULTITHREADED_EIGEN)
       const float* filter_data;
-      if (data->need_hwcn_weights) {
+      if (data->share_hwcn_weights) {
+        filter_data =
+            reinterpret_cast<const float*>(data->shared_hwcn_weights->data());
+      } else if (data->need_hwcn_weights) {
         filter_data = GetTensorData<float>(hwcn_weights);
       } else {
         filter_data = GetTensorData<float>(filter);
@@ -1210,7 +1239,7 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
           ? &context->tensors[node->temporaries->data[data->im2col_index]]
           : nullptr;
   TfLiteTensor* hwcn_weights =
-      data->need_hwcn_weights
+      data->need_hwcn_weights && !data->share_hwcn_weights
           ? &context->tensors[node->temporaries->data[data->hwcn_weights_index]]
           : nullptr;
 
@@ -35,6 +35,7 @@ limitations under the License.
 
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/4bit/int4_weights.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
@@ -164,15 +165,9 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
       }
 
       if (value->type == kTfLiteInt4) {
-        for (int j = 0; j < col_size; j++) {
-          int i8_idx = j + idx * col_size;
-          int i4_idx = i8_idx / 2;
-          bool even = i8_idx % 2 == 0;
-          int8_t i4_val = value_ptr[i4_idx];
-          int8_t i8_val =
-              even ? static_cast<int8_t>(i4_val << 4) >> 4 : i4_val >> 4;
-          output_ptr[j + i * col_size] = i8_val * scaling_factor;
-        }
+        optimized_4bit::DequantizeInt4(
+            value_ptr, static_cast<int64_t>(idx) * col_size, col_size,
+            static_cast<float>(scaling_factor), output_ptr + i * col_size);
       } else {
         for (int j = 0; j < col_size; j++) {
           output_ptr[j + i * col_size] =
@@ -134,7 +134,7 @@ class PerAxisHybridEmbeddingLookupOpModel : public BaseEmbeddingLookupOpModel {
                                    TensorType_FLOAT32,
                                    per_channel_quantization_scales) {}
 
-  void SetSignedWeight(std::initializer_list<float> data) {
+  void SetSignedWeight(const std::vector<float>& data) {
     PerChannelSymmetricQuantizeAndPopulate(weight_, data);
   }
 };
@@ -456,5 +456,32 @@ TEST(PerAxisHybridEmbeddingLookupHybridOpTest, PerAxisSimple4DTestInt4) {
           kTestTolerance)));
 }
 
+TEST(PerAxisHybridEmbeddingLookupHybridOpTest, PerAxisOddRowSizeTestInt4) {
+  // Rows of 35 values start on either half of a byte, and span a vectorized
+  // step of the int4 dequantization.
+  constexpr int kRowSize = 35;
+  const std::vector<float> scales = {0.1, 0.2, 0.3};
+  PerAxisHybridEmbeddingLookupOpModel m({4}, {3, kRowSize}, scales,
+                                        TensorType_INT4);
+  m.SetInput({1, 0, 2, 1});
+  std::vector<float> weights;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < kRowSize; ++j) {
+      weights.push_back(scales[i] * ((i + j) % 15 - 7));
+    }
+  }
+  m.SetSignedWeight(weights);
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected;
+  for (int row : {1, 0, 2, 1}) {
+    expected.insert(expected.end(), weights.begin() + row * kRowSize,
+                    weights.begin() + (row + 1) * kRowSize);
+  }
+  EXPECT_THAT(m.GetOutput<float>(),
+              ElementsAreArray(ArrayFloatNear(expected, kTestTolerance)));
+}
+
 }  // namespace
 }  // namespace tflite
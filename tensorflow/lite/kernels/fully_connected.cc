@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
@@ -36,6 +37,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/repacked_weights_cache.h"
 #include "tensorflow/lite/minimal_logging.h"
 
 #ifdef TFLITE_HAVE_CPUINFO
@@ -65,6 +67,56 @@ bool SupportedSparsityFormat(const TfLiteSparsity& sparsity) {
 static const int kDimMetadataSizeRandomSparse = 2;
 static const int kDimMetadataSizeBlockSparse = 3;
 
+bool IsBlockSparse(const TfLiteSparsity& sparsity, int block_size) {
+  return sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
+         sparsity.dim_metadata[2].dense_size == block_size;
+}
+
+// Packs the values of a random sparse filter of shape [m_rows, m_cols] into the
+// format of tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4 if each
+// group of 4 columns starting at a multiple of 4 has at most 2 nonzero values.
+// Returns false if it does not, or if less than half of the packed values would
+// be nonzero, in which case the random sparse kernel is used.
+template <typename T>
+bool PackSparse2of4Filter(const TfLiteSparsity& sparsity, const T* filter_data,
+                          int m_rows, int m_cols, std::vector<T>* values,
+                          std::vector<uint8_t>* offsets) {
+  values->clear();
+  offsets->clear();
+  if (sparsity.dim_metadata_size != kDimMetadataSizeRandomSparse ||
+      !SupportedSparsityFormat(sparsity) ||
+      sparsity.dim_metadata[0].dense_size != m_rows || m_cols % 4 != 0 ||
+      sparsity.dim_metadata[1].array_segments->size != m_rows + 1) {
+    return false;
+  }
+  const int* segments = sparsity.dim_metadata[1].array_segments->data;
+  const int* indices = sparsity.dim_metadata[1].array_indices->data;
+  const int num_groups = m_cols / 4;
+  const int packed_size = m_rows * num_groups * 2;
+  if (2 * segments[m_rows] < packed_size) return false;
+
+  // Padding values are zero, so their offsets do not matter.
+  std::vector<T> packed_values(packed_size, 0);
+  std::vector<uint8_t> packed_offsets(m_rows * num_groups, 0);
+  std::vector<uint8_t> group_sizes(num_groups);
+  for (int row = 0; row < m_rows; ++row) {
+    std::fill(group_sizes.begin(), group_sizes.end(), 0);
+    if (segments[row] > segments[row + 1]) return false;
+    for (int i = segments[row]; i < segments[row + 1]; ++i) {
+      const int col = indices[i];
+      if (col < 0 || col >= m_cols) return false;
+      const int group = col / 4;
+      const int slot = group_sizes[group]++;
+      if (slot >= 2) return false;
+      packed_values[(row * num_groups + group) * 2 + slot] = filter_data[i];
+      packed_offsets[row * num_groups + group] |= (col % 4) << (2 * slot);
+    }
+  }
+  *values = std::move(packed_values);
+  *offsets = std::move(packed_offsets);
+  return true;
+}
+
 TfLiteStatus CreateLedgerTensor(const TfLiteSparsity* sparsity,
                                 TfLiteContext* context, TfLiteTensor* ledger) {
   TF_LITE_ENSURE(context, sparsity != nullptr);
@@ -157,9 +209,18 @@ struct OpData {
   bool compute_row_sums = false;
   // Only used for sparse hybrid fully connected kernels.
   bool ledger_initialized;
+  // Whether a constant random sparse filter is packed in the 2:4 sparse format
+  // in `sparse_2of4_*`.
+  bool is_sparse_2of4 = false;
+  std::vector<float> sparse_2of4_float_values;
+  std::vector<int8_t> sparse_2of4_int8_values;
+  std::vector<uint8_t> sparse_2of4_offsets;
   // Used for 4bit hybrid
   std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
   TfLiteType quantized_bias_type = kTfLiteNoType;
+  // The unpacked values of a constant int4 filter, shared with other
+  // interpreters through the RepackedWeightsCache.
+  std::shared_ptr<const RepackedWeightsCache::Buffer> shared_unpacked_filter;
 };
 
 constexpr int kInputTensor = 0;
@@ -514,7 +575,9 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
       (input->type == kTfLiteFloat32 &&
        (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8 ||
         filter->type == kTfLiteInt4));
-  const bool is_sparse = filter->sparsity != nullptr;
+  // The sparse hybrid kernel needs a ledger for filters with 1x16 blocks only.
+  const bool has_ledger = filter->sparsity != nullptr &&
+                          IsBlockSparse(*filter->sparsity, /*block_size=*/16);
   if (is_hybrid) {
     // Use optimized implementation for 4bit
     if (filter->type == kTfLiteInt4 && kernel_type == kGenericOptimized &&
@@ -544,7 +607,7 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
     }
     TfLiteIntArrayFree(node->temporaries);
     data->compute_row_sums = true;
-    if (is_sparse) {
+    if (has_ledger) {
       node->temporaries = TfLiteIntArrayCreate(6);
     } else {
       node->temporaries = TfLiteIntArrayCreate(5);
@@ -618,7 +681,7 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
           context, context->ResizeTensor(context, row_sums, row_sums_size));
     }
 
-    if (is_sparse) {
+    if (has_ledger) {
       data->ledger_initialized = false;
       node->temporaries->data[5] = data->scratch_tensor_index + 5;
       TfLiteTensor* filter_ledger =
@@ -664,7 +727,45 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
         kTfLiteOk == VerifyQuantizationZeroPoint(filter, /*expected_value=*/0),
         "Unsupported filter quantization zero-point value.");
   }
-  return PrepareImpl(context, node, kernel_type);
+  TF_LITE_ENSURE_OK(context, PrepareImpl(context, node, kernel_type));
+
+  // Unpack constant int4 filters once for all the interpreters sharing
+  // repacked weights, rather than on every Eval. The optimized 4bit hybrid
+  // kernel packs the filter itself.
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+  RepackedWeightsCache* cache = RepackedWeightsCache::GetFromContext(context);
+  if (cache && filter->type == kTfLiteInt4 && IsConstantTensor(filter) &&
+      filter->sparsity == nullptr && !data->op_data_4bit) {
+    const int num_elements = NumElements(filter);
+    data->shared_unpacked_filter = cache->GetOrRepack(
+        "fully_connected_unpacked_int4", *filter, num_elements,
+        [&](uint8_t* output) {
+          tensor_utils::UnpackDenseInt4IntoInt8(
+              GetTensorData<int8_t>(filter), num_elements,
+              reinterpret_cast<int8_t*>(output));
+        });
+  } else {
+    data->shared_unpacked_filter.reset();
+  }
+
+  // Repack constant random sparse filters with at most 2 nonzero values in
+  // each group of 4 columns for the 2:4 sparse kernels. The reference float
+  // kernel reads the sparse filter directly.
+  if (filter->sparsity != nullptr && IsConstantTensor(filter) &&
+      !data->is_sparse_2of4 && NumDimensions(filter) == 2) {
+    const int m_rows = filter->dims->data[0];
+    const int m_cols = filter->dims->data[1];
+    if (filter->type == kTfLiteFloat32 && kernel_type == kGenericOptimized) {
+      data->is_sparse_2of4 = PackSparse2of4Filter(
+          *filter->sparsity, GetTensorData<float>(filter), m_rows, m_cols,
+          &data->sparse_2of4_float_values, &data->sparse_2of4_offsets);
+    } else if (filter->type == kTfLiteInt8) {
+      data->is_sparse_2of4 = PackSparse2of4Filter(
+          *filter->sparsity, GetTensorData<int8_t>(filter), m_rows, m_cols,
+          &data->sparse_2of4_int8_values, &data->sparse_2of4_offsets);
+    }
+  }
+  return kTfLiteOk;
 }
 
 TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
@@ -702,6 +803,27 @@ TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Returns the int8 values of `filter`. Int4 values are taken from the shared
+// unpacked filter if there is one, and otherwise unpacked into
+// `unpacked_filter_data`.
+const int8_t* GetInt8FilterData(
+    const OpData* data, const TfLiteTensor* filter,
+    std::unique_ptr<int8_t[]>* unpacked_filter_data) {
+  if (filter->type != kTfLiteInt4) {
+    return GetTensorData<int8_t>(filter);
+  }
+  if (data->shared_unpacked_filter) {
+    return reinterpret_cast<const int8_t*>(
+        data->shared_unpacked_filter->data());
+  }
+  const size_t bytes_unpacked = filter->bytes * 2;
+  *unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
+  tflite::tensor_utils::UnpackDenseInt4IntoInt8(
+      GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
+      unpacked_filter_data->get());
+  return unpacked_filter_data->get();
+}
+
 TfLiteStatus EvalHybridDense(
     TfLiteContext* context, TfLiteNode* node,
     TfLiteFullyConnectedParams* params, OpData* data, const TfLiteTensor* input,
@@ -745,18 +867,9 @@ TfLiteStatus EvalHybridDense(
     row_sums_ptr = GetTensorData<int32_t>(row_sums);
   }
   int8_t* quant_data = GetTensorData<int8_t>(input_quantized);
-  const int8_t* filter_data = nullptr;
-  std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
-  if (filter->type == kTfLiteInt4) {
-    const size_t bytes_unpacked = filter->bytes * 2;
-    unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
-    tflite::tensor_utils::UnpackDenseInt4IntoInt8(
-        GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
-        unpacked_filter_data.get());
-    filter_data = unpacked_filter_data.get();
-  } else {
-    filter_data = GetTensorData<int8_t>(filter);
-  }
+  std::unique_ptr<int8_t[]> unpacked_filter_data;
+  const int8_t* filter_data =
+      GetInt8FilterData(data, filter, &unpacked_filter_data);
   const float* input_ptr = GetTensorData<float>(input);
   tensor_utils::BatchQuantizeFloats(
       input_ptr, batch_size, input_size, quant_data, scaling_factors_ptr,
@@ -885,11 +998,19 @@ void EvalSparseHybridImpl(TfLiteContext* context, TfLiteNode* node,
   }
 
   // Compute output += weight * quantized_input
-  TfLiteTensor* filter_ledger = &context->tensors[node->temporaries->data[5]];
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate(
-      GetTensorData<int8_t>(filter), GetTensorData<uint8_t>(filter_ledger),
-      output_depth, input_depth, quant_data, scaling_factors_ptr, batch_size,
-      per_thread_output, per_channel_scale_ptr);
+  if (data->is_sparse_2of4) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4(
+        data->sparse_2of4_int8_values.data(), data->sparse_2of4_offsets.data(),
+        output_depth, input_depth, quant_data, scaling_factors_ptr, batch_size,
+        per_thread_output, per_channel_scale_ptr);
+  } else {
+    TfLiteTensor* filter_ledger =
+        &context->tensors[node->temporaries->data[5]];
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate(
+        GetTensorData<int8_t>(filter), GetTensorData<uint8_t>(filter_ledger),
+        output_depth, input_depth, quant_data, scaling_factors_ptr, batch_size,
+        per_thread_output, per_channel_scale_ptr);
+  }
 
   // Apply activation function to floats.
   tensor_utils::ApplyActivationToVector(per_thread_output,
@@ -1056,11 +1177,21 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
                            row_sums, input_offsets, output);
   }
 
-  TfLiteTensor* filter_ledger = &context->tensors[node->temporaries->data[5]];
-  if (!data->ledger_initialized) {
-    PopulateLedgerData(filter->sparsity, context,
-                       GetTensorData<uint8_t>(filter_ledger));
-    data->ledger_initialized = true;
+  // Sparse filters are either packed in the 2:4 sparse format, or made of
+  // 1x16 blocks indexed by the ledger.
+  TfLiteTensor* filter_ledger = nullptr;
+  if (!data->is_sparse_2of4) {
+    if (!IsBlockSparse(*filter->sparsity, /*block_size=*/16)) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Unsupported sparse fully-connected weight format.");
+      return kTfLiteError;
+    }
+    filter_ledger = &context->tensors[node->temporaries->data[5]];
+    if (!data->ledger_initialized) {
+      PopulateLedgerData(filter->sparsity, context,
+                         GetTensorData<uint8_t>(filter_ledger));
+      data->ledger_initialized = true;
+    }
   }
 
   // The multi-threaded kernel slices the workload along the batch dimension. If
@@ -1072,7 +1203,16 @@ TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
   const int batches =
       FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
   const int thread_count = std::max(1, std::min(batches, max_threads));
-  if (params->asymmetric_quantize_inputs && data->compute_row_sums) {
+  if (params->asymmetric_quantize_inputs && data->compute_row_sums &&
+      data->is_sparse_2of4) {
+    // Precompute row sums. Padding values of the 2:4 format are zero.
+    const int output_depth = filter->dims->data[0];
+    const int packed_depth = filter->dims->data[1] / 2;
+    tensor_utils::ReductionSumVector(data->sparse_2of4_int8_values.data(),
+                                     GetTensorData<int32_t>(row_sums),
+                                     output_depth, packed_depth);
+    data->compute_row_sums = false;
+  } else if (params->asymmetric_quantize_inputs && data->compute_row_sums) {
     // Precompute row sums.
     static const int kBlockSize = 16;
     const uint8_t* ledger_ptr = GetTensorData<uint8_t>(filter_ledger);
@@ -1129,19 +1269,9 @@ void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
   op_params.lhs_cacheable = IsConstantTensor(filter);
   op_params.rhs_cacheable = IsConstantTensor(input);
 
-  const int8_t* filter_data;
-  std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
-
-  if (filter->type == kTfLiteInt4) {
-    const size_t bytes_unpacked = filter->bytes * 2;
-    unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
-    tflite::tensor_utils::UnpackDenseInt4IntoInt8(
-        GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
-        unpacked_filter_data.get());
-    filter_data = unpacked_filter_data.get();
-  } else {
-    filter_data = GetTensorData<int8>(filter);
-  }
+  std::unique_ptr<int8_t[]> unpacked_filter_data;
+  const int8_t* filter_data =
+      GetInt8FilterData(data, filter, &unpacked_filter_data);
 
   if (kernel_type == kReference) {
     reference_integer_ops::FullyConnected(
@@ -1171,19 +1301,9 @@ void FullyConnectedInt16(const OpData* data, const TfLiteTensor* input,
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
 
-  const int8_t* filter_data;
-  std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
-
-  if (filter->type == kTfLiteInt4) {
-    const size_t bytes_unpacked = filter->bytes * 2;
-    unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
-    tflite::tensor_utils::UnpackDenseInt4IntoInt8(
-        GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
-        unpacked_filter_data.get());
-    filter_data = unpacked_filter_data.get();
-  } else {
-    filter_data = GetTensorData<int8>(filter);
-  }
+  std::unique_ptr<int8_t[]> unpacked_filter_data;
+  const int8_t* filter_data =
+      GetInt8FilterData(data, filter, &unpacked_filter_data);
 
   if (data->quantized_bias_type == kTfLiteInt32) {
     reference_integer_ops::FullyConnected(
@@ -1250,18 +1370,9 @@ void FullyConnectedPerChannelInt16(const OpData* data,
   op_params.quantized_activation_min = data->output_activation_min;
   op_params.quantized_activation_max = data->output_activation_max;
 
-  const int8_t* filter_data;
-  std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
-  if (filter->type == kTfLiteInt4) {
-    const size_t bytes_unpacked = filter->bytes * 2;
-    unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
-    tflite::tensor_utils::UnpackDenseInt4IntoInt8(
-        GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
-        unpacked_filter_data.get());
-    filter_data = unpacked_filter_data.get();
-  } else {
-    filter_data = GetTensorData<int8>(filter);
-  }
+  std::unique_ptr<int8_t[]> unpacked_filter_data;
+  const int8_t* filter_data =
+      GetInt8FilterData(data, filter, &unpacked_filter_data);
 
   if (data->quantized_bias_type == kTfLiteInt32) {
     reference_integer_ops::FullyConnectedPerChannel(
@@ -1399,8 +1510,18 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
           }
           // Int4 support for sparse filter tensor is currently not supported
           TF_LITE_ENSURE(context, filter->type != kTfLiteInt4);
-          if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-              sparsity.dim_metadata[2].dense_size == 16) {
+          if (data->is_sparse_2of4) {
+            // Random sparse packed in the 2:4 sparse format.
+            optimized_ops::FullyConnectedSparseWeight2of4(
+                op_params, input_shape, GetTensorData<int8_t>(input),
+                filter_shape, data->sparse_2of4_int8_values.data(),
+                data->sparse_2of4_offsets.data(),
+                data->per_channel_output_multiplier.data(),
+                data->per_channel_output_shift.data(), bias_shape,
+                GetTensorData<int32_t>(bias), output_shape,
+                GetTensorData<int8_t>(output),
+                CpuBackendContext::GetFromContext(context));
+          } else if (IsBlockSparse(sparsity, /*block_size=*/16)) {
             // Block sparse with block size of 1x16.
             optimized_ops::FullyConnectedSparseWeight1x16(
                 sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
@@ -1410,6 +1531,16 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                 GetTensorData<int32_t>(bias), output_shape,
                 GetTensorData<int8_t>(output),
                 CpuBackendContext::GetFromContext(context));
+          } else if (IsBlockSparse(sparsity, /*block_size=*/4)) {
+            // Block sparse with block size of 1x4.
+            optimized_ops::FullyConnectedSparseWeight1x4(
+                sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
+                filter_shape, GetTensorData<int8_t>(filter),
+                data->per_channel_output_multiplier.data(),
+                data->per_channel_output_shift.data(), bias_shape,
+                GetTensorData<int32_t>(bias), output_shape,
+                GetTensorData<int8_t>(output),
+                CpuBackendContext::GetFromContext(context));
           } else {
             TF_LITE_KERNEL_LOG(
                 context, "Unsupported sparse fully-connected weight format.");
@@ -1584,7 +1715,16 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
         return kTfLiteError;
       }
 
-      if (sparsity.dim_metadata_size == kDimMetadataSizeRandomSparse) {
+      if (data->is_sparse_2of4) {
+        // Random sparse packed in the 2:4 sparse format.
+        optimized_ops::FullyConnectedSparseWeight2of4(
+            op_params, input_shape, GetTensorData<float>(input), filter_shape,
+            data->sparse_2of4_float_values.data(),
+            data->sparse_2of4_offsets.data(), bias_shape,
+            GetTensorData<float>(bias), output_shape,
+            GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
+      } else if (sparsity.dim_metadata_size == kDimMetadataSizeRandomSparse) {
         // Random sparse.
         optimized_ops::FullyConnectedSparseWeight(
             sparsity, op_params,                         // Disable formatting
@@ -1592,8 +1732,7 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             filter_shape, GetTensorData<float>(filter),  // Disable formatting
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output));
-      } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-                 sparsity.dim_metadata[2].dense_size == 4) {
+      } else if (IsBlockSparse(sparsity, /*block_size=*/4)) {
         // Block sparse with block size of 1x4.
         optimized_ops::FullyConnectedSparseWeight1x4(
             sparsity, op_params,                         // Disable formatting
@@ -1602,6 +1741,15 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (IsBlockSparse(sparsity, /*block_size=*/16)) {
+        // Block sparse with block size of 1x16.
+        optimized_ops::FullyConnectedSparseWeight1x16(
+            sparsity, op_params,                         // Disable formatting
+            input_shape, GetTensorData<float>(input),    // Disable formatting
+            filter_shape, GetTensorData<float>(filter),  // Disable formatting
+            bias_shape, GetTensorData<float>(bias),      // Disable formatting
+            output_shape, GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
@@ -2105,6 +2105,74 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
   }
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple1x16Test) {
+  std::vector<float> weight_data(3 * 32, 0);
+  for (int c = 0; c < 16; ++c) {
+    weight_data[c] = c + 1;            // u = 0, first block
+    weight_data[32 + 16 + c] = c - 8;  // u = 1, second block
+    weight_data[64 + c] = 1;           // u = 2, first block
+    weight_data[64 + 16 + c] = -1;     // u = 2, second block
+  }
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {3, 32};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {16};
+  SparseFullyConnectedOpModel<float> m(GetRegistration(),
+                                       /*units=*/3, /*batches=*/2,
+                                       /*input=*/{TensorType_FLOAT32, {2, 32}},
+                                       weight, weight_data);
+  m.SetBias({1, 2, 3});
+
+  std::vector<float> input(2 * 32);
+  for (int c = 0; c < 32; ++c) {
+    input[c] = 1;               // b = 0
+    input[32 + c] = c % 4 - 1;  // b = 1
+  }
+  m.SetInput(input);
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(137, 0, 3, 89, 18, 3));
+}
+
+// At most 2 nonzero values in each group of 4 columns, which the kernel packs
+// in the 2:4 sparse format.
+TEST_P(SparseFullyConnectedOpTest, Simple2of4Test) {
+  std::initializer_list<float> weight_data = {
+      1, 0,  2,  0, 0, 3,  0, 4,  5, 6,  // u = 0
+      0, 0,  0,  0, 7, 8,  -1, 0, 0, 2,  // u = 0
+      0, 0,  -1, 1, 2, 0,  0, -2, 0, 0,  // u = 1
+      3, 0,  1,  0, 0, 0,  0, -3, 1, 0,  // u = 1
+      1, -1, 0,  0, 0, 0,  1, -1, 0, 1,  // u = 2
+      0, -1, 2,  0, -2, 0, 0, 0,  1, 1,  // u = 2
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {3, 20};
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  SparseFullyConnectedOpModel<float> m(
+      GetRegistration(), /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_FLOAT32, {2, 20}}, weight, weight_data);
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1,  2, 3,  4, 5,  6, 7,  8, 9,  10, 11,  12, 13,  14, 15,  16, 17,  18,
+      19, 20,  // b = 0
+      1,  -2, 3, -4, 5, -6, 7, -8, 9, -10, 11, -12, 13, -14, 15, -16, 17, -18,
+      19, -20,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(419, 8, 34, 0, 140, 18));
+}
+
 TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid1x16Test) {
   std::initializer_list<float> weight_data = {
       /* 1st row */
@@ -2283,6 +2351,48 @@ TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid1x16PerChannelTest) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
                                  {10.9061, 2, 25.0938, 0, 2, 20.9691}, 1e-3)));
 }
+
+TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid2of4Test) {
+  std::initializer_list<float> weight_data = {
+      1.1,  0.0,  2.2,  0.0, 0.0,  3.3,  0.0, -4.4,  // u = 0
+      5.5,  0.0,  0.0,  6.6, 0.0,  7.7,  -8.8, 0.0,  // u = 0
+      0.0,  -1.1, 0.0,  2.2, -3.3, 0.0,  4.4, 0.0,   // u = 1
+      0.0,  -5.5, 6.6,  0.0, 7.7,  0.0,  0.0, -8.8,  // u = 1
+      1.1,  1.1,  0.0,  0.0, 0.0,  0.0,  2.2, 2.2,   // u = 2
+      3.3,  3.3,  0.0,  0.0, 0.0,  0.0,  4.4, 4.4,   // u = 2
+      -1.1, 0.0,  0.0,  1.1, 0.0,  -2.2, 2.2, 0.0,   // u = 3
+      0.0,  0.0,  -3.3, 3.3, 4.4,  -4.4, 0.0, 0.0,   // u = 3
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {4, 16};
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  SparseFullyConnectedOpModel<float> m(
+      GetRegistration(),
+      /*units=*/4, /*batches=*/2,
+      /*input=*/{TensorType_FLOAT32, {2, 16}}, weight, weight_data,
+      /*output=*/{TensorType_FLOAT32},
+      /*bias_tensor_optional=*/false, /*num_threads)=*/1,
+      /*symmetric_quantize_weights=*/true,
+      /*asymmetric_quantize_inputs=*/GetParam().asymmetric_quantize_input);
+  m.SetBias({1, 2, 3, 4});
+  m.SetInput({
+      1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0,  -1.0,
+      1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0,  -1.0,  // b = 0
+      2.5, 0.0,  -2.1, 0.0, 3.0, 0.0,  -1.3, 0.0,
+      1.3, 0.0,  -1.1, 0.0, 2.0, 0.0,  -1.7, 0.0,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 4));
+  // The float results, up to the quantization error of the weights and inputs.
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {0, 30.6, 3.0, 8.4, 21.24, 0, 0, 10.82}, 0.15)));
+}
+
 // TODO(b/148391360): Add tests for unsupported sparsity format.
 // TEST_P(SparseFullyConnectedOpTest, TestUnsupportedSparsityFormat)
 
@@ -2466,6 +2576,64 @@ TEST_P(SparseQuantizedFullyConnectedOpTest,
   EXPECT_THAT(m.GetOutput(), ElementsAre(11, 1, 25, 0, 1, 21));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x4Test) {
+  std::vector<float> weight_data = {
+      1,  2, 3,  4, 0, 0,  0, 0,  -1, -2, -3, -4,  // u = 0
+      0,  0, 0,  0, 1, 1,  1, 1,  0,  0,  0,  0,   // u = 1
+      -1, 2, -1, 2, 2, -1, 2, -1, 0,  0,  0,  0,   // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 12}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {4};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(),
+      /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 12}, 0, 0, 1}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,  // b = 0
+      4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(1, 12, 13, 1, 12, 13));
+}
+
+// At most 2 nonzero values in each group of 4 columns, which the kernel packs
+// in the 2:4 sparse format.
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple2of4Test) {
+  std::vector<float> weight_data = {
+      1, 0,  2,  0, 0, 3, 0, -4, 1, 0, 0, 1,  0, 2, 2,  0,  // u = 0
+      0, 0,  -1, 1, 2, 0, 0, -2, 0, 0, 3, 0,  1, 0, 0,  0,  // u = 1
+      1, -1, 0,  0, 0, 0, 1, -1, 0, 1, 0, -1, 2, 0, -2, 0,  // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 16}, 0, 0, 1};
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(),
+      /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 16}, 0, 0, 1}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,  // b = 0
+      4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(13, 7, 0, 29, 17, 11));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     SparseQuantizedFullyConnectedOpTest, SparseQuantizedFullyConnectedOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMapNoPie)));
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/internal/optimized/4bit/int4_weights.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -74,8 +76,14 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       return kTfLiteError;
   }
 
-  // Assign to output the input type.
-  output->type = input->type;
+  // Int4 inputs, e.g. weight-only quantized embedding tables, can be
+  // dequantized to a float32 output. Otherwise, assign to output the input
+  // type.
+  const bool dequantize_int4 =
+      input->type == kTfLiteInt4 && output->type == kTfLiteFloat32;
+  if (!dequantize_int4) {
+    output->type = input->type;
+  }
 
   // Check conditions for different types.
   switch (input->type) {
@@ -104,6 +112,20 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   }
   TF_LITE_ENSURE(context, 0 <= axis && axis < NumDimensions(input));
 
+  if (dequantize_int4 &&
+      input->quantization.type == kTfLiteAffineQuantization) {
+    const auto* qparams = static_cast<const TfLiteAffineQuantization*>(
+        input->quantization.params);
+    TF_LITE_ENSURE(context, qparams->scale != nullptr);
+    if (qparams->scale->size > 1) {
+      // Per-channel scales are only supported along the gathered axis, so
+      // that each gathered slice has a single scale.
+      TF_LITE_ENSURE_EQ(context, qparams->quantized_dimension, axis);
+      TF_LITE_ENSURE_EQ(context, qparams->scale->size,
+                        SizeOfDimension(input, axis));
+    }
+  }
+
   int batch_dims = params->batch_dims;
   // batch_dims should be in range: [-rank(positions), rank(positions)].
   // Negative batch_dims is added with rank of positions.
@@ -164,7 +186,80 @@ TfLiteStatus Gather(TfLiteContext* context, const TfLiteGatherParams& params,
       op_params, GetTensorShape(input), GetTensorData<InputT>(input),
       GetTensorShape(positions), GetTensorData<PositionsT>(positions),
       GetTensorShape(output), GetTensorData<InputT>(output),
-      (input->type == kTfLiteInt4));
+      (input->type == kTfLiteInt4),
+      CpuBackendContext::GetFromContext(context));
+}
+
+// Gathers the slices of an int4 input, dequantized to float32 with a
+// per-tensor scale or per-channel scales along the gathered axis.
+template <typename PositionsT>
+TfLiteStatus GatherDequantizeInt4(TfLiteContext* context,
+                                  const TfLiteGatherParams& params,
+                                  const TfLiteTensor* input,
+                                  const TfLiteTensor* positions,
+                                  TfLiteTensor* output) {
+  const RuntimeShape input_shape = GetTensorShape(input);
+  const RuntimeShape positions_shape = GetTensorShape(positions);
+  int axis = params.axis;
+  if (axis < 0) {
+    axis += input_shape.DimensionsCount();
+  }
+  int batch_dims = params.batch_dims;
+  if (batch_dims < 0) {
+    batch_dims += positions_shape.DimensionsCount();
+  }
+
+  const TfLiteFloatArray* scales = nullptr;
+  if (input->quantization.type == kTfLiteAffineQuantization) {
+    scales = static_cast<const TfLiteAffineQuantization*>(
+                 input->quantization.params)
+                 ->scale;
+  }
+  const bool per_channel = scales != nullptr && scales->size > 1;
+  const float scale = scales != nullptr ? scales->data[0] : input->params.scale;
+
+  const int axis_size = input_shape.Dims(axis);
+  int batch_size = 1;
+  for (int i = 0; i < batch_dims; ++i) {
+    batch_size *= input_shape.Dims(i);
+  }
+  int outer_size = 1;
+  for (int i = batch_dims; i < axis; ++i) {
+    outer_size *= input_shape.Dims(i);
+  }
+  int inner_size = 1;
+  for (int i = axis + 1; i < input_shape.DimensionsCount(); ++i) {
+    inner_size *= input_shape.Dims(i);
+  }
+  int coord_size = 1;
+  for (int i = batch_dims; i < positions_shape.DimensionsCount(); ++i) {
+    coord_size *= positions_shape.Dims(i);
+  }
+
+  const int8_t* input_data = GetTensorData<int8_t>(input);
+  const PositionsT* indexes = GetTensorData<PositionsT>(positions);
+  float* output_data = GetTensorData<float>(output);
+  for (int batch = 0; batch < batch_size; ++batch) {
+    for (int outer = 0; outer < outer_size; ++outer) {
+      for (int i = 0; i < coord_size; ++i) {
+        const PositionsT index = indexes[batch * coord_size + i];
+        TF_LITE_ENSURE(context, index >= 0 && index < axis_size);
+        const int64_t from_pos =
+            (static_cast<int64_t>((batch * outer_size) + outer) * axis_size +
+             index) *
+            inner_size;
+        optimized_4bit::DequantizeInt4(
+            input_data, from_pos, inner_size,
+            per_channel ? scales->data[index] : scale,
+            output_data +
+                (static_cast<int64_t>((batch * outer_size) + outer) *
+                     coord_size +
+                 i) *
+                    inner_size);
+      }
+    }
+  }
+  return kTfLiteOk;
 }
 
 template <typename PositionT>
@@ -218,7 +313,11 @@ TfLiteStatus DispatchEvalInputType(TfLiteContext* const context,
     case kTfLiteUInt8:
       return Gather<uint8_t, PosT>(context, *params, input, positions, output);
     case kTfLiteInt4:
-      // fallthrough
+      if (output->type == kTfLiteFloat32) {
+        return GatherDequantizeInt4<PosT>(context, *params, input, positions,
+                                          output);
+      }
+      return Gather<int8_t, PosT>(context, *params, input, positions, output);
     case kTfLiteInt8:
       return Gather<int8_t, PosT>(context, *params, input, positions, output);
     case kTfLiteInt16:
@@ -35,7 +35,7 @@ class GatherOpModel : public SingleOpModel {
   GatherOpModel(const TensorData& input, const TensorData& positions,
                 bool constant_tensor, const std::vector<InputType>& input_data,
                 const std::vector<PositionsType>& positions_data, int axis = 0,
-                int batch_dims = 0) {
+                int batch_dims = 0, int num_threads = -1) {
     if (constant_tensor) {
       input_ = AddConstInput(input, input_data);
       positions_ = AddConstInput(positions, positions_data);
@@ -46,7 +46,9 @@ class GatherOpModel : public SingleOpModel {
     output_ = AddOutput(input.type);
     SetBuiltinOp(BuiltinOperator_GATHER, BuiltinOptions_GatherOptions,
                  CreateGatherOptions(builder_, axis, batch_dims).Union());
-    BuildInterpreter({GetShape(input_), GetShape(positions_)});
+    BuildInterpreter({GetShape(input_), GetShape(positions_)}, num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
     if (!constant_tensor) {
       if (input.type == TensorType_INT4) {
         SetInputInt4(input_, input_data,
@@ -118,6 +120,41 @@ class GatherOpModel : public SingleOpModel {
   int output_;
 };
 
+// Gathers from an int4 input dequantized to a float32 output, with a scale
+// per slice along `axis` or a single scale.
+class DequantizeInt4GatherOpModel : public SingleOpModel {
+ public:
+  DequantizeInt4GatherOpModel(std::initializer_list<int> input_shape,
+                              const std::vector<float>& scales,
+                              std::initializer_list<int> positions_shape,
+                              int axis) {
+    input_ = AddInput({TensorType_INT4, input_shape, 0, 0, 0, 0, true, scales,
+                       std::vector<int64_t>(scales.size(), 0), axis});
+    positions_ = AddInput(TensorType_INT32);
+    output_ = AddOutput(TensorType_FLOAT32);
+    SetBuiltinOp(BuiltinOperator_GATHER, BuiltinOptions_GatherOptions,
+                 CreateGatherOptions(builder_, axis, 0).Union());
+    BuildInterpreter({input_shape, positions_shape});
+  }
+
+  void SetInput(const std::vector<float>& data) {
+    PerChannelSymmetricQuantizeAndPopulate(input_, data);
+  }
+
+  void SetPositions(const std::vector<int32_t>& data) {
+    PopulateTensor<int32_t>(positions_, data);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int positions_;
+  int output_;
+};
+
 struct GatherOpTest : public testing::TestWithParam<bool> {};
 
 INSTANTIATE_TEST_SUITE_P(ConstantTensor, GatherOpTest, testing::Bool());
@@ -388,6 +425,48 @@ TEST_P(GatherOpTest, BatchDimsEqualIndexDims) {
   EXPECT_THAT(m.GetOutput(), ElementsAreArray({1, 5, 10, 16, 21, 25, 30, 36}));
 }
 
+// Gathers enough data to be split between threads.
+TEST_P(GatherOpTest, MultithreadedBatchDims1) {
+  bool constant_tensor = GetParam();
+  constexpr int kBatches = 2, kOuter = 3, kAxis = 100, kInner = 64;
+  constexpr int kCoords = 50;
+  std::vector<float> input(kBatches * kOuter * kAxis * kInner);
+  for (int i = 0; i < input.size(); ++i) input[i] = i;
+  std::vector<int32_t> positions(kBatches * kCoords);
+  for (int i = 0; i < positions.size(); ++i) positions[i] = (i * 37) % kAxis;
+  GatherOpModel<float, int32_t> m(
+      {TensorType_FLOAT32, {kBatches, kOuter, kAxis, kInner}},
+      {TensorType_INT32, {kBatches, kCoords}}, constant_tensor, input,
+      positions, /*axis=*/2, /*batch_dims=*/1, /*num_threads=*/4);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected;
+  for (int b = 0; b < kBatches; ++b) {
+    for (int o = 0; o < kOuter; ++o) {
+      for (int c = 0; c < kCoords; ++c) {
+        const int row = (b * kOuter + o) * kAxis + positions[b * kCoords + c];
+        expected.insert(expected.end(), input.begin() + row * kInner,
+                        input.begin() + (row + 1) * kInner);
+      }
+    }
+  }
+  ASSERT_THAT(m.GetOutputShape(),
+              ElementsAreArray({kBatches, kOuter, kCoords, kInner}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(expected));
+}
+
+TEST(GatherOpTest, MultithreadedErrorOnOutOfBounds) {
+  constexpr int kAxis = 1000, kInner = 64, kCoords = 500;
+  std::vector<float> input(kAxis * kInner);
+  std::vector<int32_t> positions(kCoords, 1);
+  positions.back() = kAxis;
+  GatherOpModel<float, int32_t> m(
+      {TensorType_FLOAT32, {kAxis, kInner}}, {TensorType_INT32, {kCoords}},
+      /*constant_tensor=*/false, input, positions, /*axis=*/0,
+      /*batch_dims=*/0, /*num_threads=*/4);
+  EXPECT_EQ(m.Invoke(), kTfLiteError);
+}
+
 TEST_P(GatherOpTest, ErrorOnOutOfBoundsTooLarge) {
   bool constant_tensor = GetParam();
   if (constant_tensor) {
@@ -462,5 +541,42 @@ TEST(GatherOpTest, BatchDims1Int4) {
                    -5, -6, -7, -8, 4, 5, 6, 7, 4, 5, 6, 7, -5, -6, -7, -8}));
 }
 
+TEST(GatherOpTest, DequantizeInt4PerChannel) {
+  // Slices of 3 values start on either half of a byte.
+  DequantizeInt4GatherOpModel m({3, 2, 3}, {0.5, 0.25}, {2}, /*axis=*/1);
+  m.SetInput({-3.5, -3.0, -2.5, -1.5, -1.25, -1.0,   //
+              -1.0, -0.5, 0.0,  -0.75, -0.5, -0.25,  //
+              0.5,  1.0,  1.5,  0.0,   0.25, 0.5});
+  m.SetPositions({1, 0});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({3, 2, 3}));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-1.5, -1.25, -1.0, -3.5, -3.0, -2.5,  //
+                   -0.75, -0.5, -0.25, -1.0, -0.5, 0.0,  //
+                   0.0, 0.25, 0.5, 0.5, 1.0, 1.5})));
+}
+
+TEST(GatherOpTest, DequantizeInt4PerTensor) {
+  constexpr int kRowSize = 40;
+  DequantizeInt4GatherOpModel m({4, kRowSize}, {0.125}, {3}, /*axis=*/0);
+  std::vector<float> input;
+  for (int i = 0; i < 4 * kRowSize; ++i) {
+    input.push_back(0.125f * (i % 15 - 7));
+  }
+  m.SetInput(input);
+  m.SetPositions({3, 0, 2});
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected;
+  for (int row : {3, 0, 2}) {
+    expected.insert(expected.end(), input.begin() + row * kRowSize,
+                    input.begin() + (row + 1) * kRowSize);
+  }
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({3, kRowSize}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+}
+
 }  // namespace
 }  // namespace tflite
@@ -0,0 +1,318 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/optimized/4bit/int4_weights.h"
+
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "tensorflow/lite/kernels/internal/optimized/4bit/fully_connected_common.h"
+
+namespace tflite {
+namespace optimized_4bit {
+namespace {
+
+// Number of int4 values unpacked at once, from 16 bytes.
+constexpr int kInt4ValuesPerStep = 32;
+// Number of vectors multiplied with each unpacked step of a row.
+constexpr int kMaxBatchesPerStep = 4;
+
+#if defined(__AVX2__)
+
+// Unpacks the 32 int4 values of `packed` to int8, in order, to `first` and
+// `second`.
+inline void UnpackInt4x32(__m128i packed, __m128i* first, __m128i* second) {
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  const __m128i sign = _mm_set1_epi8(0x08);
+  __m128i lower_values = _mm_and_si128(packed, mask);
+  __m128i upper_values = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+  // Sign extends the 4 bit values.
+  lower_values = _mm_sub_epi8(_mm_xor_si128(lower_values, sign), sign);
+  upper_values = _mm_sub_epi8(_mm_xor_si128(upper_values, sign), sign);
+  *first = _mm_unpacklo_epi8(lower_values, upper_values);
+  *second = _mm_unpackhi_epi8(lower_values, upper_values);
+}
+
+inline int32_t ReduceInt32x8(__m256i acc) {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+// Computes the dot products of the vectorizable prefix of `row` with
+// kBatches vectors, and returns the number of columns processed.
+template <int kBatches>
+int RowDotProductsPrefix(const int8_t* row, int m_cols, const int8_t* vectors,
+                         int32_t* dot_products) {
+  __m256i acc[kBatches];
+  for (int b = 0; b < kBatches; ++b) {
+    acc[b] = _mm256_setzero_si256();
+  }
+  int col = 0;
+  for (; col + kInt4ValuesPerStep <= m_cols; col += kInt4ValuesPerStep) {
+    __m128i first, second;
+    UnpackInt4x32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + col / 2)),
+        &first, &second);
+    const __m256i weights0 = _mm256_cvtepi8_epi16(first);
+    const __m256i weights1 = _mm256_cvtepi8_epi16(second);
+    for (int b = 0; b < kBatches; ++b) {
+      const int8_t* vector = vectors + b * m_cols + col;
+      const __m256i vector0 = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(vector)));
+      const __m256i vector1 = _mm256_cvtepi8_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(vector + 16)));
+      acc[b] = _mm256_add_epi32(
+          acc[b], _mm256_add_epi32(_mm256_madd_epi16(weights0, vector0),
+                                   _mm256_madd_epi16(weights1, vector1)));
+    }
+  }
+  for (int b = 0; b < kBatches; ++b) {
+    dot_products[b] = ReduceInt32x8(acc[b]);
+  }
+  return col;
+}
+
+// Dequantizes the vectorizable prefix of `num_elements` int4 values starting
+// on a byte, and returns the number of values processed.
+int DequantizeInt4Prefix(const int8_t* packed_data, int num_elements,
+                         float scale, float* output) {
+  const __m256 scale_values = _mm256_set1_ps(scale);
+  int i = 0;
+  for (; i + kInt4ValuesPerStep <= num_elements; i += kInt4ValuesPerStep) {
+    __m128i halves[2];
+    UnpackInt4x32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(packed_data + i / 2)),
+        &halves[0], &halves[1]);
+    for (int h = 0; h < 2; ++h) {
+      const __m128i values[2] = {halves[h], _mm_srli_si128(halves[h], 8)};
+      for (int k = 0; k < 2; ++k) {
+        _mm256_storeu_ps(
+            output + i + h * 16 + k * 8,
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(values[k])),
+                          scale_values));
+      }
+    }
+  }
+  return i;
+}
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+// Unpacks the 32 int4 values of `packed` to int8, in order.
+inline int8x16x2_t UnpackInt4x32(int8x16_t packed) {
+  const int8x16_t lower_values = vshrq_n_s8(vshlq_n_s8(packed, 4), 4);
+  const int8x16_t upper_values = vshrq_n_s8(packed, 4);
+  return vzipq_s8(lower_values, upper_values);
+}
+
+inline int32_t ReduceInt32x4(int32x4_t acc) {
+#ifdef __aarch64__
+  return vaddvq_s32(acc);
+#else
+  const int64x2_t sum = vpaddlq_s32(acc);
+  return static_cast<int32_t>(vgetq_lane_s64(sum, 0) +
+                              vgetq_lane_s64(sum, 1));
+#endif
+}
+
+template <int kBatches>
+int RowDotProductsPrefix(const int8_t* row, int m_cols, const int8_t* vectors,
+                         int32_t* dot_products) {
+  int32x4_t acc[kBatches];
+  for (int b = 0; b < kBatches; ++b) {
+    acc[b] = vdupq_n_s32(0);
+  }
+  int col = 0;
+  for (; col + kInt4ValuesPerStep <= m_cols; col += kInt4ValuesPerStep) {
+    const int8x16x2_t weights = UnpackInt4x32(vld1q_s8(row + col / 2));
+    for (int b = 0; b < kBatches; ++b) {
+      const int8_t* vector = vectors + b * m_cols + col;
+      const int8x16_t vector0 = vld1q_s8(vector);
+      const int8x16_t vector1 = vld1q_s8(vector + 16);
+      // Each int16 lane sums 4 products of at most 8 * 128, so it can't
+      // overflow.
+      int16x8_t products =
+          vmull_s8(vget_low_s8(weights.val[0]), vget_low_s8(vector0));
+      products = vmlal_s8(products, vget_high_s8(weights.val[0]),
+                          vget_high_s8(vector0));
+      products = vmlal_s8(products, vget_low_s8(weights.val[1]),
+                          vget_low_s8(vector1));
+      products = vmlal_s8(products, vget_high_s8(weights.val[1]),
+                          vget_high_s8(vector1));
+      acc[b] = vpadalq_s16(acc[b], products);
+    }
+  }
+  for (int b = 0; b < kBatches; ++b) {
+    dot_products[b] = ReduceInt32x4(acc[b]);
+  }
+  return col;
+}
+
+int DequantizeInt4Prefix(const int8_t* packed_data, int num_elements,
+                         float scale, float* output) {
+  const float32x4_t scale_values = vdupq_n_f32(scale);
+  int i = 0;
+  for (; i + kInt4ValuesPerStep <= num_elements; i += kInt4ValuesPerStep) {
+    const int8x16x2_t values = UnpackInt4x32(vld1q_s8(packed_data + i / 2));
+    for (int h = 0; h < 2; ++h) {
+      const int16x8_t values_s16[2] = {vmovl_s8(vget_low_s8(values.val[h])),
+                                       vmovl_s8(vget_high_s8(values.val[h]))};
+      for (int k = 0; k < 2; ++k) {
+        float* dst = output + i + h * 16 + k * 8;
+        vst1q_f32(dst, vmulq_f32(vcvtq_f32_s32(vmovl_s16(
+                                     vget_low_s16(values_s16[k]))),
+                                 scale_values));
+        vst1q_f32(dst + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(
+                                         vget_high_s16(values_s16[k]))),
+                                     scale_values));
+      }
+    }
+  }
+  return i;
+}
+
+#else
+
+template <int kBatches>
+int RowDotProductsPrefix(const int8_t* row, int m_cols, const int8_t* vectors,
+                         int32_t* dot_products) {
+  for (int b = 0; b < kBatches; ++b) {
+    dot_products[b] = 0;
+  }
+  return 0;
+}
+
+int DequantizeInt4Prefix(const int8_t* packed_data, int num_elements,
+                         float scale, float* output) {
+  return 0;
+}
+
+#endif
+
+template <int kBatches>
+void RowDotProducts(const int8_t* row, int m_cols, const int8_t* vectors,
+                    int32_t* dot_products) {
+  int col = RowDotProductsPrefix<kBatches>(row, m_cols, vectors, dot_products);
+  for (; col < m_cols; col += 2) {
+    const int8_t weight0 = lower(row[col / 2]);
+    const int8_t weight1 = upper(row[col / 2]);
+    for (int b = 0; b < kBatches; ++b) {
+      const int8_t* vector = vectors + b * m_cols + col;
+      dot_products[b] += weight0 * vector[0] + weight1 * vector[1];
+    }
+  }
+}
+
+// Multiplies the matrix with the kBatches vectors starting at `batch`.
+template <int kBatches>
+void MatrixBatchesMultiplyAccumulate(
+    const int8_t* packed_matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int batch, const float* per_channel_scale,
+    const int32_t* input_offsets, const int32_t* row_sums, float* result) {
+  const int8_t* batch_vectors = vectors + batch * m_cols;
+  for (int row = 0; row < m_rows; ++row) {
+    int32_t dot_products[kBatches];
+    RowDotProducts<kBatches>(
+        packed_matrix + static_cast<int64_t>(row) * (m_cols / 2), m_cols,
+                             batch_vectors, dot_products);
+    const float row_scale = per_channel_scale ? per_channel_scale[row] : 1.0f;
+    for (int b = 0; b < kBatches; ++b) {
+      int32_t dot_product = dot_products[b];
+      if (input_offsets) {
+        dot_product -= input_offsets[batch + b] * row_sums[row];
+      }
+      result[(batch + b) * m_rows + row] +=
+          dot_product * scaling_factors[batch + b] * row_scale;
+    }
+  }
+}
+
+}  // namespace
+
+void DequantizeInt4(const int8_t* packed_data, int64_t start,
+                    int num_elements, float scale, float* output) {
+  int i = 0;
+  if (start % 2 != 0 && num_elements > 0) {
+    output[i++] = upper(packed_data[start / 2]) * scale;
+  }
+  // The element `i` is now the lower nibble of a byte.
+  const int8_t* bytes = packed_data + (start + i) / 2;
+  const int prefix =
+      DequantizeInt4Prefix(bytes, num_elements - i, scale, output + i);
+  bytes += prefix / 2;
+  i += prefix;
+  for (; i + 1 < num_elements; i += 2, ++bytes) {
+    output[i] = lower(*bytes) * scale;
+    output[i + 1] = upper(*bytes) * scale;
+  }
+  if (i < num_elements) {
+    output[i] = lower(*bytes) * scale;
+  }
+}
+
+void Int4RowSums(const int8_t* packed_matrix, int m_rows, int m_cols,
+                 int32_t* row_sums) {
+  for (int row = 0; row < m_rows; ++row) {
+    const int8_t* packed_row =
+        packed_matrix + static_cast<int64_t>(row) * (m_cols / 2);
+    int32_t sum = 0;
+    for (int i = 0; i < m_cols / 2; ++i) {
+      sum += lower(packed_row[i]) + upper(packed_row[i]);
+    }
+    row_sums[row] = sum;
+  }
+}
+
+void Int4MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* packed_matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, const float* per_channel_scale,
+    const int32_t* input_offsets, const int32_t* row_sums, float* result) {
+  int batch = 0;
+  for (; batch + kMaxBatchesPerStep <= n_batch; batch += kMaxBatchesPerStep) {
+    MatrixBatchesMultiplyAccumulate<kMaxBatchesPerStep>(
+        packed_matrix, m_rows, m_cols, vectors, scaling_factors, batch,
+        per_channel_scale, input_offsets, row_sums, result);
+  }
+  switch (n_batch - batch) {
+    case 3:
+      MatrixBatchesMultiplyAccumulate<3>(
+          packed_matrix, m_rows, m_cols, vectors, scaling_factors, batch,
+          per_channel_scale, input_offsets, row_sums, result);
+      break;
+    case 2:
+      MatrixBatchesMultiplyAccumulate<2>(
+          packed_matrix, m_rows, m_cols, vectors, scaling_factors, batch,
+          per_channel_scale, input_offsets, row_sums, result);
+      break;
+    case 1:
+      MatrixBatchesMultiplyAccumulate<1>(
+          packed_matrix, m_rows, m_cols, vectors, scaling_factors, batch,
+          per_channel_scale, input_offsets, row_sums, result);
+      break;
+    default:
+      break;
+  }
+}
+
+}  // namespace optimized_4bit
+}  // namespace tflite
@@ -0,0 +1,56 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_4BIT_INT4_WEIGHTS_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_4BIT_INT4_WEIGHTS_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace optimized_4bit {
+
+// Kernels for weight-only int4 quantized tensors, in the dense layout of
+// kTfLiteInt4 tensors: two signed int4 values per byte, the element with the
+// even index in the lower nibble. Unlike the FullyConnected kernels of
+// fully_connected_4bit.h, they work on the tensor data as is, without a
+// prepacked copy, so the weights are only read as int4.
+
+// Writes `scale` * value of the `num_elements` int4 values of `packed_data`
+// starting at the element `start` to `output`.
+void DequantizeInt4(const int8_t* packed_data, int64_t start,
+                    int num_elements, float scale, float* output);
+
+// Writes the sum of each row of the m_rows x m_cols int4 matrix
+// `packed_matrix` to `row_sums`. m_cols must be even.
+void Int4RowSums(const int8_t* packed_matrix, int m_rows, int m_cols,
+                 int32_t* row_sums);
+
+// Multiplies the m_rows x m_cols int4 matrix `packed_matrix` with the n_batch
+// int8 vectors of size m_cols in `vectors`, and accumulates into `result`:
+//   result[b * m_rows + r] += scaling_factors[b] * per_channel_scale[r] *
+//       (dot(row r, vector b) - input_offsets[b] * row_sums[r])
+// The rows are unpacked to int8 in registers, once for up to 4 vectors.
+// per_channel_scale may be null for a scale of 1, and input_offsets and
+// row_sums may be null for symmetrically quantized vectors. m_cols must be
+// even, so that every row starts on a byte.
+void Int4MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* packed_matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, const float* per_channel_scale,
+    const int32_t* input_offsets, const int32_t* row_sums, float* result);
+
+}  // namespace optimized_4bit
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_4BIT_INT4_WEIGHTS_H_
@@ -19,6 +19,8 @@ limitations under the License.
 
 #include <immintrin.h>
 
+#include <cstdint>
+#include <cstring>
 #include <limits>
 
 #include "tensorflow/lite/kernels/internal/compatibility.h"
@@ -30,8 +32,10 @@ static inline void mm_storeu_si64(void *dst, __m128i v) {
 #if (defined __clang__) || (defined _MSC_VER)
   _mm_storeu_si64(dst, v);
 #else
-  // GCC 9 lacks support for _mm_storeu_si64.
-  *static_cast<std::int64_t *>(dst) = _mm_extract_epi64(v, 0);
+  // GCC 9 lacks support for _mm_storeu_si64. The destination may be
+  // unaligned, so the value is copied rather than stored through an int64_t.
+  const std::int64_t value = _mm_extract_epi64(v, 0);
+  std::memcpy(dst, &value, sizeof(value));
 #endif
 }
 
@@ -84,6 +88,14 @@ static inline __m256i rounding_right_shift(const __m256i &value,
       mask_num_plus_nudge_overflow);
 }
 
+// Arithmetic right shift of the 64-bit lanes of `value`, which AVX2 lacks.
+static inline __m256i mm256_sra_epi64(const __m256i &value, int right_shift) {
+  const __m256i sign = _mm256_cmpgt_epi64(_mm256_setzero_si256(), value);
+  const __m256i shifted = _mm256_srl_epi64(_mm256_xor_si256(value, sign),
+                                           _mm_cvtsi32_si128(right_shift));
+  return _mm256_xor_si256(shifted, sign);
+}
+
 inline void CastInt32ToInt16AndStore(int16 *dst, const __m256i v) {
   // As _mm256_cvtepi32_epi16 is not supported in AVX2, use the below repack.
   // Select bytes 0, 1, 4, 5, 8, 9, 12, 13 within each lane, effectively
@@ -153,6 +165,82 @@ inline __m256i MultiplyByQuantizedMultiplier(const __m256i &value,
 
   return rounding_right_shift(result, positive_right_shift);
 }
+
+// Unlike MultiplyByQuantizedMultiplier() above, which truncates the product,
+// gives the same results as the scalar MultiplyByQuantizedMultiplier() in
+// common.cc, in both the single and the double rounding modes. The multiplier
+// must be non-negative.
+inline __m256i MultiplyByQuantizedMultiplierExact(const __m256i &value,
+                                                  const int32_t multiplier,
+                                                  const int shift) {
+  TFLITE_DCHECK_GE(multiplier, 0);
+  const __m256i multiplier_v = _mm256_set1_epi64x(multiplier);
+  // _mm256_mul_epi32 multiplies the even lanes, so the odd lanes are moved
+  // down to be multiplied separately.
+#if TFLITE_SINGLE_ROUNDING
+  TFLITE_DCHECK(shift >= -31 && shift <= 30);
+  const int total_shift = 31 - shift;
+  const __m256i round = _mm256_set1_epi64x(int64_t{1} << (total_shift - 1));
+  __m256i even =
+      _mm256_add_epi64(_mm256_mul_epi32(value, multiplier_v), round);
+  __m256i odd = _mm256_add_epi64(
+      _mm256_mul_epi32(_mm256_srli_epi64(value, 32), multiplier_v), round);
+  even = mm256_sra_epi64(even, total_shift);
+  odd = mm256_sra_epi64(odd, total_shift);
+  return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+#else
+  const int left_shift = shift > 0 ? shift : 0;
+  const int right_shift = shift > 0 ? 0 : -shift;
+  const __m256i shifted_value =
+      _mm256_sll_epi32(value, _mm_cvtsi32_si128(left_shift));
+  // SaturatingRoundingDoublingHighMul(), which cannot saturate with a
+  // non-negative multiplier. Its rounding of the doubled product away from
+  // zero is the same as adding 1 << 30 and flooring, and only the low 32 bits
+  // of the shifted product are kept, so a logical shift is enough.
+  const __m256i nudge = _mm256_set1_epi64x(int64_t{1} << 30);
+  __m256i even =
+      _mm256_add_epi64(_mm256_mul_epi32(shifted_value, multiplier_v), nudge);
+  __m256i odd = _mm256_add_epi64(
+      _mm256_mul_epi32(_mm256_srli_epi64(shifted_value, 32), multiplier_v),
+      nudge);
+  even = _mm256_srli_epi64(even, 31);
+  odd = _mm256_srli_epi64(odd, 31);
+  __m256i result = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+  if (right_shift == 0) {
+    return result;
+  }
+  // RoundingDivideByPOT(), where the comparison masks are -1 when true.
+  const int32_t mask = static_cast<int32_t>((int64_t{1} << right_shift) - 1);
+  const __m256i remainder = _mm256_and_si256(result, _mm256_set1_epi32(mask));
+  const __m256i threshold = _mm256_sub_epi32(_mm256_set1_epi32(mask >> 1),
+                                             _mm256_srai_epi32(result, 31));
+  result = _mm256_sra_epi32(result, _mm_cvtsi32_si128(right_shift));
+  return _mm256_sub_epi32(result, _mm256_cmpgt_epi32(remainder, threshold));
+#endif
+}
+
+// Looks the 32-bit lanes of `value`, which must be int16 values, up in a
+// 513-entry LUT with the same interpolation as LUTLookup() in common.h, and
+// returns the int16 results sign-extended to 32 bits.
+inline __m256i LUTLookupInt16(const __m256i &value, const int16_t *lut) {
+  const __m256i index =
+      _mm256_add_epi32(_mm256_srai_epi32(value, 7), _mm256_set1_epi32(256));
+  const __m256i offset = _mm256_and_si256(value, _mm256_set1_epi32(0x7f));
+  // Each gathered word holds lut[index] in its low half and lut[index + 1] in
+  // its high half.
+  const __m256i pairs =
+      _mm256_i32gather_epi32(reinterpret_cast<const int *>(lut), index, 2);
+  const __m256i base = _mm256_srai_epi32(_mm256_slli_epi32(pairs, 16), 16);
+  const __m256i next = _mm256_srai_epi32(pairs, 16);
+  __m256i slope = _mm256_sub_epi32(next, base);
+  slope = _mm256_srai_epi32(_mm256_slli_epi32(slope, 16), 16);
+  const __m256i delta = _mm256_srai_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(slope, offset),
+                       _mm256_set1_epi32(64)),
+      7);
+  const __m256i result = _mm256_add_epi32(base, delta);
+  return _mm256_srai_epi32(_mm256_slli_epi32(result, 16), 16);
+}
 }  // namespace avx2_utils
 }  // namespace tflite
 
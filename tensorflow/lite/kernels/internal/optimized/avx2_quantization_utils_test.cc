@@ -131,6 +131,44 @@ TEST(MultiplyByQuantizedMultiplierTest, VectorNegativeLeftShiftTest) {
   CompareWithReferenceValue(values, result);
 }
 
+TEST(MultiplyByQuantizedMultiplierExactTest, MatchesScalarRounding) {
+  // Values whose products land on and around the rounding midpoints.
+  const std::vector<int32_t> values = {-65535, -32769, -3,    -1,
+                                       0,      1,      32767, 65535};
+  const __m256i src_vector = FillVectorWithInt32(values);
+  for (const int32_t multiplier : {1 << 30, 1073741823, 1518500250}) {
+    for (int shift = -31; shift <= 14; ++shift) {
+      const __m256i result =
+          MultiplyByQuantizedMultiplierExact(src_vector, multiplier, shift);
+      int32_t result_values[8];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(result_values), result);
+      for (int i = 0; i < values.size(); i++) {
+        EXPECT_EQ(result_values[i], tflite::MultiplyByQuantizedMultiplier(
+                                        values[i], multiplier, shift))
+            << "value " << values[i] << " shift " << shift;
+      }
+    }
+  }
+}
+
+TEST(LUTLookupInt16Test, MatchesScalarLookup) {
+  int16_t lut[513];
+  for (int i = 0; i < 513; ++i) {
+    lut[i] = static_cast<int16_t>((i * 97) % 65536 - 32768);
+  }
+  for (int32_t start = -32768; start < 32768; start += 8) {
+    const __m256i values = _mm256_add_epi32(
+        _mm256_set1_epi32(start), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    int32_t result_values[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result_values),
+                        LUTLookupInt16(values, lut));
+    for (int i = 0; i < 8; ++i) {
+      ASSERT_EQ(result_values[i],
+                tflite::LUTLookup(static_cast<int16_t>(start + i), lut));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace avx2_utils
 }  // namespace tflite
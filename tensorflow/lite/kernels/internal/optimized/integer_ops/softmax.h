@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_SOFTMAX_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_SOFTMAX_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/avx2_quantization_utils.h"
+#include "tensorflow/lite/kernels/internal/reference/softmax.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_integer_ops {
+
+// Quantized softmax with int16_t input and output, which gives the same
+// results as reference_ops::SoftmaxInt16. With AVX2, the exp() and 1/(1 + x)
+// LUTs are looked up 8 values at a time with gathers.
+inline void SoftmaxInt16(const SoftmaxParams& params,
+                         const RuntimeShape& input_shape,
+                         const int16_t* input_data,
+                         const RuntimeShape& output_shape,
+                         int16_t* output_data) {
+  const int trailing_dim = input_shape.DimensionsCount() - 1;
+  const int outer_size =
+      MatchingFlatSizeSkipDim(input_shape, trailing_dim, output_shape);
+  const int depth =
+      MatchingDim(input_shape, trailing_dim, output_shape, trailing_dim);
+
+  for (int i = 0; i < outer_size; ++i) {
+    const int16_t* input_row = input_data + i * depth;
+    int16_t* output_row = output_data + i * depth;
+
+    // Find the largest element
+    int16_t max_in_row = std::numeric_limits<int16_t>::min();
+    int c = 0;
+#ifdef __AVX2__
+    if (depth >= 16) {
+      __m256i max_v = _mm256_set1_epi16(max_in_row);
+      for (; c <= depth - 16; c += 16) {
+        max_v = _mm256_max_epi16(
+            max_v, _mm256_loadu_si256(
+                       reinterpret_cast<const __m256i*>(input_row + c)));
+      }
+      __m128i max_x = _mm_max_epi16(_mm256_castsi256_si128(max_v),
+                                    _mm256_extracti128_si256(max_v, 1));
+      max_x = _mm_max_epi16(max_x, _mm_shuffle_epi32(max_x, 0x4e));
+      max_x = _mm_max_epi16(max_x, _mm_shuffle_epi32(max_x, 0xb1));
+      max_x = _mm_max_epi16(max_x, _mm_shufflelo_epi16(max_x, 0xb1));
+      max_in_row = static_cast<int16_t>(_mm_extract_epi16(max_x, 0));
+    }
+#endif  // __AVX2__
+    for (; c < depth; ++c) {
+      max_in_row = std::max(max_in_row, input_row[c]);
+    }
+
+    // Computes the exp values and their sum, caching the exp values in the
+    // output row as reference_ops::SoftmaxInt16 does.
+    int32_t sum_of_exps = 0;  // Q16.15 fixed point format.
+    c = 0;
+#ifdef __AVX2__
+    const __m256i max_in_row_v = _mm256_set1_epi32(max_in_row);
+    const __m256i exp_lut_offset = _mm256_set1_epi32(32767);
+    const __m256i clamp_min_v = _mm256_set1_epi32(-32768);
+    const __m256i clamp_max_v = _mm256_set1_epi32(32767);
+    __m256i sum_of_exps_v = _mm256_setzero_si256();
+    for (; c <= depth - 8; c += 8) {
+      const __m256i input = _mm256_cvtepi16_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(input_row + c)));
+      __m256i scaled_diff = avx2_utils::MultiplyByQuantizedMultiplierExact(
+          _mm256_sub_epi32(input, max_in_row_v), params.input_multiplier,
+          params.input_left_shift);
+      scaled_diff = _mm256_add_epi32(scaled_diff, exp_lut_offset);
+      scaled_diff = _mm256_min_epi32(scaled_diff, clamp_max_v);
+      scaled_diff = _mm256_max_epi32(scaled_diff, clamp_min_v);
+      const __m256i exp_result =
+          avx2_utils::LUTLookupInt16(scaled_diff, params.exp_lut);
+      sum_of_exps_v = _mm256_add_epi32(sum_of_exps_v, exp_result);
+      avx2_utils::CastInt32ToInt16AndStore(output_row + c, exp_result);
+    }
+    __m128i sum_x = _mm_add_epi32(_mm256_castsi256_si128(sum_of_exps_v),
+                                  _mm256_extracti128_si256(sum_of_exps_v, 1));
+    sum_x = _mm_add_epi32(sum_x, _mm_shuffle_epi32(sum_x, 0x4e));
+    sum_x = _mm_add_epi32(sum_x, _mm_shuffle_epi32(sum_x, 0xb1));
+    sum_of_exps = _mm_cvtsi128_si32(sum_x);
+#endif  // __AVX2__
+    for (; c < depth; ++c) {
+      output_row[c] = reference_ops::SoftMaxCalculateExp(
+          params, input_data, depth, max_in_row, i, c);
+      sum_of_exps += output_row[c];
+    }
+
+    // Compute the reciprocal 1/sum_of_exps
+    uint8_t headroom_plus_one =
+        CountLeadingZeros(static_cast<uint32_t>(sum_of_exps));
+    int32_t shifted_sum =
+        ((static_cast<int64_t>(sum_of_exps) << (headroom_plus_one - 1)) +
+         (1 << 13)) >>
+        14;
+    // since the LUT computes 1/(1 + x) we need to first compute x = (sum - 1).
+    // also, the LUT expects a symmetrical input, so we must also recenter x
+    // from [0, 65535] to [-32768, 32767].
+    int32_t sym_shifted_sum = shifted_sum + (-((1 << 15) + (1 << 16)));
+    int16_t sat_sym_shifted_sum = static_cast<int16_t>(
+        std::min(std::max(sym_shifted_sum, static_cast<int32_t>(-32768)),
+                 static_cast<int32_t>(32767)));
+    // apply 1/(1 + x) LUT activation function
+    int16_t reciprocal_scale_Q015 =
+        LUTLookup(sat_sym_shifted_sum, params.one_over_one_plus_x_lut);
+
+    // Rescale the exp_result with reciprocal
+    // range of output is [0, 32767] correspond to [0.0, 1.0]
+    const int right_shift = 31 - headroom_plus_one;
+    const int64_t round = static_cast<int64_t>(1) << (right_shift - 1);
+    c = 0;
+#ifdef __AVX2__
+    // Both factors are Q0.15 and the shift is at most 30, so the rounded
+    // product fits in 32 bits.
+    const __m256i reciprocal_scale_v = _mm256_set1_epi32(reciprocal_scale_Q015);
+    const __m256i round_v = _mm256_set1_epi32(static_cast<int32_t>(round));
+    const __m128i right_shift_v = _mm_cvtsi32_si128(right_shift);
+    const __m256i zeros = _mm256_setzero_si256();
+    for (; c <= depth - 8; c += 8) {
+      const __m256i exp_result = _mm256_cvtepi16_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(output_row + c)));
+      __m256i result = _mm256_add_epi32(
+          _mm256_mullo_epi32(exp_result, reciprocal_scale_v), round_v);
+      result = _mm256_sra_epi32(result, right_shift_v);
+      result = _mm256_min_epi32(result, clamp_max_v);
+      result = _mm256_max_epi32(result, zeros);
+      avx2_utils::CastInt32ToInt16AndStore(output_row + c, result);
+    }
+#endif  // __AVX2__
+    for (; c < depth; ++c) {
+      int32_t result = (static_cast<int64_t>(output_row[c]) *
+                            static_cast<int64_t>(reciprocal_scale_Q015) +
+                        round) >>
+                       right_shift;
+      output_row[c] = static_cast<int16_t>(
+          std::min(std::max(result, static_cast<int32_t>(0)),
+                   static_cast<int32_t>(32767)));
+    }
+  }
+}
+
+}  // namespace optimized_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_SOFTMAX_H_
@@ -2040,6 +2040,202 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kNeonVectorsPerBlock = 4;
+  constexpr int kBlockSize = kNeonVectorsPerBlock * kFloatValuesPerNeonVector;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    for (int row = 0; row < m_rows; row++) {
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      const float* vector_in_batch = vector + batch * m_cols;
+
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        const float* vector_block_in_batch_ptr =
+            vector_in_batch + indices[i] * kBlockSize;
+        for (int c = 0; c < kNeonVectorsPerBlock; c++) {
+          // Load 4 float values from the vector and matrix row.
+          float32x4_t vector_f32x4 = vld1q_f32(vector_block_in_batch_ptr);
+          float32x4_t matrix_f32x4 = vld1q_f32(matrix_ptr);
+          // Multiply the vector and matrix row and add to accumulator.
+          acc_32x4 = vmlaq_f32(acc_32x4, matrix_f32x4, vector_f32x4);
+          matrix_ptr += kFloatValuesPerNeonVector;
+          vector_block_in_batch_ptr += kFloatValuesPerNeonVector;
+        }
+      }
+      result[batch * m_rows + row] += AccumulateNeonLane(acc_32x4);
+    }
+  }
+}
+
+namespace {
+
+// The number of columns of a group of a 2:4 sparse matrix, and the number of
+// values stored per group.
+constexpr int k2of4GroupSize = 4;
+constexpr int k2of4ValuesPerGroup = 2;
+
+// Loads the 8 values of `vector_ptr` multiplied by the 4 groups of a 2:4
+// sparse matrix starting at `offsets_ptr`.
+inline int8x8_t Gather2of4Int8x8(const int8_t* vector_ptr,
+                                 const uint8_t* offsets_ptr) {
+  int8x8_t v_s8x8 = vdup_n_s8(0);
+  v_s8x8 = vld1_lane_s8(vector_ptr + (offsets_ptr[0] & 3), v_s8x8, 0);
+  v_s8x8 = vld1_lane_s8(vector_ptr + (offsets_ptr[0] >> 2 & 3), v_s8x8, 1);
+  v_s8x8 = vld1_lane_s8(vector_ptr + 4 + (offsets_ptr[1] & 3), v_s8x8, 2);
+  v_s8x8 = vld1_lane_s8(vector_ptr + 4 + (offsets_ptr[1] >> 2 & 3), v_s8x8, 3);
+  v_s8x8 = vld1_lane_s8(vector_ptr + 8 + (offsets_ptr[2] & 3), v_s8x8, 4);
+  v_s8x8 = vld1_lane_s8(vector_ptr + 8 + (offsets_ptr[2] >> 2 & 3), v_s8x8, 5);
+  v_s8x8 = vld1_lane_s8(vector_ptr + 12 + (offsets_ptr[3] & 3), v_s8x8, 6);
+  v_s8x8 =
+      vld1_lane_s8(vector_ptr + 12 + (offsets_ptr[3] >> 2 & 3), v_s8x8, 7);
+  return v_s8x8;
+}
+
+// Returns the dot product of a row of a 2:4 sparse int8 matrix with a vector,
+// and the sum of the values of the row in `row_sum`.
+inline int32_t Sparse2of4RowDotProduct(const int8_t* matrix_ptr,
+                                       const uint8_t* offsets_ptr,
+                                       const int8_t* vector_ptr,
+                                       int num_groups, int32_t* row_sum) {
+  constexpr int kGroupsPerNeonVector = 4;
+  int32x4_t dotprod_32x4 = vmovq_n_s32(0);
+  int32x4_t row_sum_32x4 = vmovq_n_s32(0);
+  int g = 0;
+  for (; g + kGroupsPerNeonVector <= num_groups;
+       g += kGroupsPerNeonVector) {
+    const int8x8_t vector_s8x8 = Gather2of4Int8x8(vector_ptr, offsets_ptr);
+    const int8x8_t matrix_s8x8 = vld1_s8(matrix_ptr);
+    dotprod_32x4 =
+        vpadalq_s16(dotprod_32x4, vmull_s8(matrix_s8x8, vector_s8x8));
+    row_sum_32x4 = vpadalq_s16(row_sum_32x4, vmovl_s8(matrix_s8x8));
+    matrix_ptr += kGroupsPerNeonVector * k2of4ValuesPerGroup;
+    offsets_ptr += kGroupsPerNeonVector;
+    vector_ptr += kGroupsPerNeonVector * k2of4GroupSize;
+  }
+  int32_t dotprod = AccumulateNeonLane(dotprod_32x4);
+  *row_sum = AccumulateNeonLane(row_sum_32x4);
+  for (; g < num_groups; ++g) {
+    dotprod += matrix_ptr[0] * vector_ptr[*offsets_ptr & 3];
+    dotprod += matrix_ptr[1] * vector_ptr[*offsets_ptr >> 2 & 3];
+    *row_sum += matrix_ptr[0] + matrix_ptr[1];
+    matrix_ptr += k2of4ValuesPerGroup;
+    ++offsets_ptr;
+    vector_ptr += k2of4GroupSize;
+  }
+  return dotprod;
+}
+
+}  // namespace
+
+void NeonSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result) {
+  // Two groups fill a NEON vector.
+  constexpr int kGroupsPerNeonVector = 2;
+  TFLITE_DCHECK_EQ(m_cols % k2of4GroupSize, 0);
+  const int num_groups = m_cols / k2of4GroupSize;
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const uint8_t* offsets_ptr = offsets;
+    for (int row = 0; row < m_rows; row++) {
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      const float* vector_ptr = vector + batch * m_cols;
+      int g = 0;
+      for (; g + kGroupsPerNeonVector <= num_groups;
+           g += kGroupsPerNeonVector) {
+        // Gather the 4 values of the vector multiplied by the 2 groups.
+        float32x4_t vector_f32x4 = vmovq_n_f32(0.0);
+        vector_f32x4 =
+            vld1q_lane_f32(vector_ptr + (offsets_ptr[0] & 3), vector_f32x4, 0);
+        vector_f32x4 = vld1q_lane_f32(vector_ptr + (offsets_ptr[0] >> 2 & 3),
+                                      vector_f32x4, 1);
+        vector_f32x4 = vld1q_lane_f32(vector_ptr + 4 + (offsets_ptr[1] & 3),
+                                      vector_f32x4, 2);
+        vector_f32x4 = vld1q_lane_f32(
+            vector_ptr + 4 + (offsets_ptr[1] >> 2 & 3), vector_f32x4, 3);
+        float32x4_t matrix_f32x4 = vld1q_f32(matrix_ptr);
+        acc_32x4 = vmlaq_f32(acc_32x4, matrix_f32x4, vector_f32x4);
+        matrix_ptr += kGroupsPerNeonVector * k2of4ValuesPerGroup;
+        offsets_ptr += kGroupsPerNeonVector;
+        vector_ptr += kGroupsPerNeonVector * k2of4GroupSize;
+      }
+      float dot_prod = AccumulateNeonLane(acc_32x4);
+      for (; g < num_groups; ++g) {
+        dot_prod += matrix_ptr[0] * vector_ptr[*offsets_ptr & 3];
+        dot_prod += matrix_ptr[1] * vector_ptr[*offsets_ptr >> 2 & 3];
+        matrix_ptr += k2of4ValuesPerGroup;
+        ++offsets_ptr;
+        vector_ptr += k2of4GroupSize;
+      }
+      result[batch * m_rows + row] += dot_prod;
+    }
+  }
+}
+
+void NeonSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % k2of4GroupSize, 0);
+  const int num_groups = m_cols / k2of4GroupSize;
+  const int row_stride = num_groups * k2of4ValuesPerGroup;
+
+  for (int batch = 0; batch < n_batch; ++batch) {
+    for (int row = 0; row < m_rows; ++row) {
+      int32_t matrix_row_sum;
+      int32_t acc = Sparse2of4RowDotProduct(
+          matrix + row * row_stride, offsets + row * num_groups,
+          vector + batch * m_cols, num_groups, &matrix_row_sum);
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      acc = acc + bias_value + input_offset * matrix_row_sum;
+      acc = MultiplyByQuantizedMultiplier(
+          acc, per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      acc += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              acc, output_activation_min, output_activation_max));
+    }
+  }
+}
+
+void NeonSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vectors,
+    const float* __restrict__ scaling_factors, int n_batch,
+    float* __restrict__ result, const float* per_channel_scale) {
+  TFLITE_DCHECK_EQ(m_cols % k2of4GroupSize, 0);
+  const int num_groups = m_cols / k2of4GroupSize;
+  const int row_stride = num_groups * k2of4ValuesPerGroup;
+
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const float batch_scaling_factor = scaling_factors[batch];
+    for (int row = 0; row < m_rows; ++row) {
+      int32_t matrix_row_sum;
+      const int32_t dotprod = Sparse2of4RowDotProduct(
+          matrix + row * row_stride, offsets + row * num_groups, vectors,
+          num_groups, &matrix_row_sum);
+      float scaling_factor = batch_scaling_factor;
+      if (per_channel_scale) {
+        scaling_factor *= per_channel_scale[row];
+      }
+      result[batch * m_rows + row] += dotprod * scaling_factor;
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
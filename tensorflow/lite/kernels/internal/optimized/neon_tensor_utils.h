@@ -71,6 +71,22 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
                    segments, indices, m_rows, m_cols, vector, n_batch, result);
 }
 
+void SparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate1x16, matrix,
+                   segments, indices, m_rows, m_cols, vector, n_batch, result);
+}
+
+void SparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result) {
+  NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate2of4, matrix,
+                   offsets, m_rows, m_cols, vector, n_batch, result);
+}
+
 void SparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
@@ -95,6 +111,38 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x16(
                    output_activation_min, output_activation_max, result);
 }
 
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+      matrix, segments, indices, m_rows, m_cols, vector, bias_vector, n_batch,
+      input_offset, output_multiplier, output_shift, per_channel_scale,
+      per_channel_shift, output_offset, output_activation_min,
+      output_activation_max, result);
+}
+
+void SparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate2of4, matrix,
+                   offsets, m_rows, m_cols, vector, bias_vector, n_batch,
+                   input_offset, output_multiplier, output_shift,
+                   per_channel_scale, per_channel_shift, output_offset,
+                   output_activation_min, output_activation_max, result);
+}
+
 void SparseMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ matrix, const uint8_t* ledger, const int m_rows,
     const int m_cols, const int8_t* __restrict__ vectors,
@@ -105,6 +153,16 @@ void SparseMatrixBatchVectorMultiplyAccumulate(
                    per_channel_scale);
 }
 
+void SparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vectors,
+    const float* __restrict__ scaling_factors, int n_batch,
+    float* __restrict__ result, const float* per_channel_scale) {
+  NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate2of4, matrix,
+                   offsets, m_rows, m_cols, vectors, scaling_factors, n_batch,
+                   result, per_channel_scale);
+}
+
 void MatrixBatchVectorMultiplyAccumulate(
     const int8_t* input, const int32_t* bias,
     const int8_t* input_to_gate_weights, int32_t multiplier, int32_t shift,
@@ -108,6 +108,16 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result);
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
+void NeonSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result);
+
 // Multiply a matrix by a batch vector, and store results in a batch-size
 // vector. Sparse version.
 void NeonSparseMatrixBatchVectorMultiplyAccumulate(
@@ -127,6 +137,17 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int32_t output_activation_min, const int32_t output_activation_max,
     int8_t* __restrict__ result);
 
+// Same as above, but the matrix is stored in the packed 2:4 sparse format.
+void NeonSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result);
+
 // Matrix multiplication for quantized values using symmetric quantization.
 // Sparse version.
 void NeonSparseMatrixBatchVectorMultiplyAccumulate(
@@ -135,6 +156,12 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate(
     const float* scaling_factors, int n_batch, float* __restrict__ result,
     const float* per_channel_scale);
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vectors,
+    const float* __restrict__ scaling_factors, int n_batch,
+    float* __restrict__ result, const float* per_channel_scale);
+
 // Dot product of two vectors.
 float NeonVectorVectorDotProduct(const float* vector1, const float* vector2,
                                  int v_size);
@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
@@ -20,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/internal/optimized/4bit/int4_weights.h"
 #include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
 
 namespace tflite {
@@ -555,5 +558,84 @@ INSTANTIATE_TEST_SUITE_P(
           std::make_tuple(4, 16, 32, 64),
 #endif
     }));
+
+// Packs int4 `values` densely, the element with the even index in the lower
+// nibble.
+std::vector<int8_t> PackInt4(const std::vector<int8_t>& values) {
+  std::vector<int8_t> packed((values.size() + 1) / 2, 0);
+  for (size_t i = 0; i < values.size(); ++i) {
+    packed[i / 2] |= (static_cast<uint8_t>(values[i]) & UINT8_C(15))
+                     << (4 * (i % 2));
+  }
+  return packed;
+}
+
+class Int4MatrixBatchVectorTests
+    : public ::testing::TestWithParam<::testing::tuple<int, int, int, bool>> {
+};
+
+TEST_P(Int4MatrixBatchVectorTests, Int4MatrixBatchVectorTests) {
+  const int m_rows = std::get<0>(GetParam());
+  const int m_cols = std::get<1>(GetParam());
+  const int n_batch = std::get<2>(GetParam());
+  const bool asymmetric = std::get<3>(GetParam());
+  std::uniform_int_distribution<int32_t> int8_dist(-128, 127);
+
+  std::vector<int8_t> matrix(m_rows * m_cols);
+  for (int8_t& value : matrix) value = int_dist(random_engine) - 1;
+  std::vector<int8_t> vectors(n_batch * m_cols);
+  for (int8_t& value : vectors) value = int8_dist(random_engine);
+  std::vector<float> scaling_factors(n_batch);
+  std::vector<int32_t> input_offsets(n_batch);
+  for (int b = 0; b < n_batch; ++b) {
+    scaling_factors[b] = real_dist(random_engine);
+    input_offsets[b] = int_dist(random_engine);
+  }
+  std::vector<float> per_channel_scale(m_rows);
+  for (float& scale : per_channel_scale) scale = real_dist(random_engine);
+
+  const std::vector<int8_t> packed = PackInt4(matrix);
+  std::vector<int32_t> row_sums(m_rows);
+  optimized_4bit::Int4RowSums(packed.data(), m_rows, m_cols, row_sums.data());
+  std::vector<float> result(n_batch * m_rows, 1.0f);
+  optimized_4bit::Int4MatrixBatchVectorMultiplyAccumulate(
+      packed.data(), m_rows, m_cols, vectors.data(), scaling_factors.data(),
+      n_batch, per_channel_scale.data(),
+      asymmetric ? input_offsets.data() : nullptr,
+      asymmetric ? row_sums.data() : nullptr, result.data());
+
+  for (int r = 0; r < m_rows; ++r) {
+    int32_t row_sum = 0;
+    for (int c = 0; c < m_cols; ++c) row_sum += matrix[r * m_cols + c];
+    EXPECT_EQ(row_sums[r], row_sum);
+    for (int b = 0; b < n_batch; ++b) {
+      int32_t dot_product = 0;
+      for (int c = 0; c < m_cols; ++c) {
+        dot_product += matrix[r * m_cols + c] * vectors[b * m_cols + c];
+      }
+      if (asymmetric) dot_product -= input_offsets[b] * row_sum;
+      const float expected =
+          1.0f + dot_product * scaling_factors[b] * per_channel_scale[r];
+      EXPECT_NEAR(result[b * m_rows + r], expected,
+                  1e-5f * std::max(1.0f, std::abs(expected)));
+    }
+  }
+
+  // Dequantizes a range starting on the upper half of a byte.
+  const int start = m_cols - 1;
+  const int num_elements = m_rows * m_cols - start;
+  std::vector<float> dequantized(num_elements);
+  optimized_4bit::DequantizeInt4(packed.data(), start, num_elements, 0.5f,
+                                 dequantized.data());
+  for (int i = 0; i < num_elements; ++i) {
+    EXPECT_EQ(dequantized[i], 0.5f * matrix[start + i]);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Int4MatrixBatchVectorTests, Int4MatrixBatchVectorTests,
+    ::testing::Combine(::testing::Values(1, 5), ::testing::Values(2, 32, 70),
+                       ::testing::Values(1, 4, 7), ::testing::Bool()));
+
 }  // namespace
 }  // namespace tflite
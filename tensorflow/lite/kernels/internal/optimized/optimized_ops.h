@@ -20,8 +20,10 @@ limitations under the License.
 #include <sys/types.h>
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <tuple>
@@ -49,6 +51,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/cppmath.h"
+#include "tensorflow/lite/kernels/internal/optimized/avx2_quantization_utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/im2col_utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops_utils.h"
@@ -3499,6 +3502,59 @@ inline int32_t QuantizeSoftmaxOutput<uint8_t>(float prob_rescaled,
 }
 #endif
 
+#ifdef __AVX2__
+inline __m256i LoadSoftmaxInputAsInt32(const int8_t* input_data) {
+  return _mm256_cvtepi8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input_data)));
+}
+
+inline __m256i LoadSoftmaxInputAsInt32(const uint8_t* input_data) {
+  return _mm256_cvtepu8_epi32(
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(input_data)));
+}
+
+// Vector version of QuantizeSoftmaxOutput, which rounds the non-negative
+// probabilities half away from zero as std::round does.
+template <typename T>
+inline __m256i QuantizeSoftmaxOutput(__m256 prob_rescaled, __m256i zero_point) {
+  const __m256 prob_floor = _mm256_floor_ps(prob_rescaled);
+  const __m256 round_up = _mm256_cmp_ps(
+      _mm256_sub_ps(prob_rescaled, prob_floor), _mm256_set1_ps(0.5f),
+      _CMP_GE_OQ);
+  const __m256 prob_rnd = _mm256_add_ps(
+      prob_floor, _mm256_and_ps(round_up, _mm256_set1_ps(1.0f)));
+  return _mm256_add_epi32(_mm256_cvttps_epi32(prob_rnd), zero_point);
+}
+
+template <>
+inline __m256i QuantizeSoftmaxOutput<uint8_t>(__m256 prob_rescaled,
+                                              __m256i zero_point) {
+  return _mm256_add_epi32(
+      _mm256_cvttps_epi32(_mm256_add_ps(prob_rescaled, _mm256_set1_ps(0.5f))),
+      zero_point);
+}
+
+// Stores the 32-bit lanes of `v`, which are in the range of the output type.
+inline void StoreSoftmaxOutput(int16_t* dst, __m256i v) {
+  avx2_utils::CastInt32ToInt16AndStore(dst, v);
+}
+
+template <typename T>
+inline void StoreSoftmaxOutput(T* dst, __m256i v) {
+  static_assert(sizeof(T) == 1, "");
+  // Selects the low byte of each 32-bit lane within each 128-bit half.
+  const __m256i repack_perm = _mm256_setr_epi8(
+      0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8,
+      12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i shuffled_v = _mm256_shuffle_epi8(v, repack_perm);
+  const int32_t low = _mm_cvtsi128_si32(_mm256_castsi256_si128(shuffled_v));
+  const int32_t high =
+      _mm_cvtsi128_si32(_mm256_extracti128_si256(shuffled_v, 1));
+  memcpy(dst, &low, sizeof(low));
+  memcpy(dst + 4, &high, sizeof(high));
+}
+#endif  // __AVX2__
+
 inline void PopulateSoftmaxLookupTable(SoftmaxParams* data, float input_scale,
                                        float beta) {
   const float scale = -input_scale * beta;
@@ -3522,22 +3578,71 @@ inline void Softmax(const SoftmaxParams& params,
   const int32_t clamp_min = std::numeric_limits<Out>::min();
   for (int i = 0; i < excluding_last_dim; ++i) {
     int32_t max_val = std::numeric_limits<In>::min();
+    int j = 0;
+#ifdef __AVX2__
+    // The table is looked up with 8-lane gathers. A 256-entry table does not
+    // fit in byte shuffles, unlike the 16-bit split tables of SoftmaxInt8LUT.
+    __m256i max_val_v = _mm256_set1_epi32(max_val);
+    for (; j <= last_dim - 8; j += 8) {
+      max_val_v =
+          _mm256_max_epi32(max_val_v, LoadSoftmaxInputAsInt32(input_data + j));
+    }
+    __m128i max_val_x = _mm_max_epi32(_mm256_castsi256_si128(max_val_v),
+                                      _mm256_extracti128_si256(max_val_v, 1));
+    max_val_x = _mm_max_epi32(max_val_x, _mm_shuffle_epi32(max_val_x, 0x4e));
+    max_val_x = _mm_max_epi32(max_val_x, _mm_shuffle_epi32(max_val_x, 0xb1));
+    max_val = _mm_cvtsi128_si32(max_val_x);
+#endif  // __AVX2__
     // Find max quantized value.
-    for (int j = 0; j < last_dim; ++j) {
+    for (; j < last_dim; ++j) {
       max_val = std::max(max_val, static_cast<int32_t>(input_data[j]));
     }
 
     float sum_exp = 0.0f;
     const int32_t max_uint8 = std::numeric_limits<uint8_t>::max();
     const float* table_offset = &params.table[max_uint8 - max_val];
+    j = 0;
+#ifdef __AVX2__
+    __m256 sum_exp_v = _mm256_setzero_ps();
+    for (; j <= last_dim - 8; j += 8) {
+      sum_exp_v = _mm256_add_ps(
+          sum_exp_v, _mm256_i32gather_ps(
+                         table_offset, LoadSoftmaxInputAsInt32(input_data + j),
+                         sizeof(float)));
+    }
+    __m128 sum_exp_x = _mm_add_ps(_mm256_castps256_ps128(sum_exp_v),
+                                  _mm256_extractf128_ps(sum_exp_v, 1));
+    sum_exp_x = _mm_add_ps(sum_exp_x, _mm_movehl_ps(sum_exp_x, sum_exp_x));
+    sum_exp_x = _mm_add_ss(sum_exp_x, _mm_movehdup_ps(sum_exp_x));
+    sum_exp = _mm_cvtss_f32(sum_exp_x);
+#endif  // __AVX2__
     // Calculate normalizer sum(exp(x)).
-    for (int j = 0; j < last_dim; ++j) {
+    for (; j < last_dim; ++j) {
       sum_exp += table_offset[input_data[j]];
     }
 
     const float inv_sum_exp = 1.0f / (sum_exp * params.scale);
+    j = 0;
+#ifdef __AVX2__
+    const __m256 inv_sum_exp_v = _mm256_set1_ps(inv_sum_exp);
+    const __m256i zero_point_v = _mm256_set1_epi32(params.zero_point);
+    const __m256i clamp_max_v = _mm256_set1_epi32(clamp_max);
+    const __m256i clamp_min_v = _mm256_set1_epi32(clamp_min);
+    for (; j <= last_dim - 8; j += 8) {
+      const __m256 prob_rescaled = _mm256_mul_ps(
+          _mm256_i32gather_ps(table_offset,
+                              LoadSoftmaxInputAsInt32(input_data + j),
+                              sizeof(float)),
+          inv_sum_exp_v);
+      __m256i prob_quantized =
+          QuantizeSoftmaxOutput<Out>(prob_rescaled, zero_point_v);
+      prob_quantized = _mm256_min_epi32(prob_quantized, clamp_max_v);
+      prob_quantized = _mm256_max_epi32(prob_quantized, clamp_min_v);
+      StoreSoftmaxOutput(output_data + j, prob_quantized);
+    }
+#endif  // __AVX2__
     // Normalize and quantize probabilities.
-    for (int j = 0; j < last_dim; ++j) {
+    for (; j < last_dim; ++j) {
       const float prob_rescaled = table_offset[input_data[j]] * inv_sum_exp;
       const int32_t prob_quantized =
           QuantizeSoftmaxOutput<Out>(prob_rescaled, params.zero_point);
@@ -7087,12 +7192,146 @@ inline void Logistic16bitPrecision(const LogisticParams& params,
   }
 }
 
+// Copies the slices in [start, end) of a Gather whose input has
+// `num_batches` x `outer_size` x `axis_size` slices of `inner_size` elements,
+// and whose output has `num_batches` x `outer_size` x `coord_size` slices.
+template <typename T, typename CoordsT>
+struct GatherWorkerTask : cpu_backend_threadpool::Task {
+  GatherWorkerTask(const T* input_data, const CoordsT* coords_data,
+                   T* output_data, int outer_size, int axis_size,
+                   int inner_size, int coord_size, int flat_size, int start,
+                   int end)
+      : input_data(input_data),
+        coords_data(coords_data),
+        output_data(output_data),
+        outer_size(outer_size),
+        axis_size(axis_size),
+        inner_size(inner_size),
+        coord_size(coord_size),
+        flat_size(flat_size),
+        start(start),
+        end(end) {}
+
+  void Run() override {
+    for (int slice = start; slice < end; ++slice) {
+      // The output slice is at ((batch * outer_size) + outer) * coord_size + i.
+      const int batch_outer = slice / coord_size;
+      const int batch = batch_outer / outer_size;
+      const int i = slice - batch_outer * coord_size;
+      const int64_t from_pos =
+          (static_cast<int64_t>(batch_outer) * axis_size +
+           coords_data[batch * coord_size + i]) *
+          inner_size;
+      if (from_pos < 0 || from_pos + inner_size > flat_size) {
+        status = kTfLiteError;
+        return;
+      }
+      std::memcpy(output_data + static_cast<int64_t>(slice) * inner_size,
+                  input_data + from_pos, sizeof(T) * inner_size);
+    }
+  }
+
+  TfLiteStatus status = kTfLiteOk;
+
+ private:
+  const T* input_data;
+  const CoordsT* coords_data;
+  T* output_data;
+  int outer_size;
+  int axis_size;
+  int inner_size;
+  int coord_size;
+  int flat_size;
+  int start;
+  int end;
+};
+
+// Same as reference_ops::Gather, but splits the slices between the threads of
+// `cpu_backend_context` when there is enough data to move.
+template <typename T, typename CoordsT>
+inline TfLiteStatus Gather(const tflite::GatherParams& op_params,
+                           const RuntimeShape& input_shape, const T* input_data,
+                           const RuntimeShape& coords_shape,
+                           const CoordsT* coords_data,
+                           const RuntimeShape& output_shape, T* output_data,
+                           bool int4_input,
+                           CpuBackendContext* cpu_backend_context) {
+  int axis = op_params.axis;
+  if (axis < 0) {
+    axis += input_shape.DimensionsCount();
+  }
+  int batch_dims = op_params.batch_dims;
+  if (batch_dims < 0) {
+    batch_dims += coords_shape.DimensionsCount();
+  }
+  int num_batches = 1;
+  for (int i = 0; i < batch_dims; ++i) {
+    num_batches *= input_shape.Dims(i);
+  }
+  int outer_size = 1;
+  for (int i = batch_dims; i < axis; ++i) {
+    outer_size *= input_shape.Dims(i);
+  }
+  int inner_size = 1;
+  for (int i = axis + 1; i < input_shape.DimensionsCount(); ++i) {
+    inner_size *= input_shape.Dims(i);
+  }
+  if (int4_input) {
+    inner_size /= 2;
+  }
+  int coord_size = 1;
+  for (int i = batch_dims; i < coords_shape.DimensionsCount(); ++i) {
+    coord_size *= coords_shape.Dims(i);
+  }
+  const int num_slices = num_batches * outer_size * coord_size;
+
+  constexpr int kMinBytesPerThread = 16 * 1024;
+  const int64_t total_bytes =
+      static_cast<int64_t>(num_slices) * inner_size * sizeof(T);
+  int thread_count = static_cast<int>(std::min<int64_t>(
+      total_bytes / kMinBytesPerThread, static_cast<int64_t>(num_slices)));
+  if (cpu_backend_context != nullptr) {
+    thread_count =
+        std::min(thread_count, cpu_backend_context->max_num_threads());
+  } else {
+    thread_count = 1;
+  }
+  if (thread_count <= 1) {
+    return reference_ops::Gather(op_params, input_shape, input_data,
+                                 coords_shape, coords_data, output_shape,
+                                 output_data, int4_input);
+  }
+
+  ruy::profiler::ScopeLabel label("Gather/multithreaded");
+  TFLITE_DCHECK_GE(axis, batch_dims);
+  std::vector<GatherWorkerTask<T, CoordsT>> tasks;
+  tasks.reserve(thread_count);
+  int start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    // Try to distribute the tasks as even as possible.
+    const int end = start + (num_slices - start) / (thread_count - i);
+    tasks.emplace_back(input_data, coords_data, output_data, outer_size,
+                       input_shape.Dims(axis), inner_size, coord_size,
+                       input_shape.FlatSize(), start, end);
+    start = end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+  for (const auto& task : tasks) {
+    if (task.status != kTfLiteOk) return task.status;
+  }
+  return kTfLiteOk;
+}
+
 // Transpose2D only deals with typical 2D matrix transpose ops.
 // Perform transpose by transposing 4x4 blocks of the input, proceeding from
 // left to right (down the rows) of the input, and then from top to bottom.
+// Only the input rows in [start_row, end_row) are transposed, which lets
+// threads share the work.
 template <typename T>
 inline void Transpose2D(const RuntimeShape& input_shape, const T* input_data,
-                        const RuntimeShape& output_shape, T* output_data) {
+                        const RuntimeShape& output_shape, T* output_data,
+                        int start_row, int end_row) {
   TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 2);
   TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 2);
 
@@ -7101,10 +7340,10 @@ inline void Transpose2D(const RuntimeShape& input_shape, const T* input_data,
   const int kLines = 4;
   const int kSkipSize = (kLines - 1) * d1;
 
-  const T* input = input_data;
+  const T* input = input_data + start_row * d1;
 
-  int i = 0;
-  for (; i <= d0 - kLines; i += kLines) {
+  int i = start_row;
+  for (; i <= end_row - kLines; i += kLines) {
     T* output = output_data + i;
 
     const T* input_ptr = input;
@@ -7176,7 +7415,7 @@ inline void Transpose2D(const RuntimeShape& input_shape, const T* input_data,
       input += (d1 - j) + kSkipSize;
     }
   }
-  for (; i < d0; ++i) {
+  for (; i < end_row; ++i) {
     T* output = output_data + i;
     for (int j = 0; j < d1; ++j) {
       *output = *input;
@@ -7189,8 +7428,8 @@ inline void Transpose2D(const RuntimeShape& input_shape, const T* input_data,
 template <>
 inline void Transpose2D(const RuntimeShape& input_shape,
                         const int32_t* input_data,
-                        const RuntimeShape& output_shape,
-                        int32_t* output_data) {
+                        const RuntimeShape& output_shape, int32_t* output_data,
+                        int start_row, int end_row) {
   TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 2);
   TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 2);
 
@@ -7201,11 +7440,11 @@ inline void Transpose2D(const RuntimeShape& input_shape,
   const int kSkipSize = (kLines - 1) * d1;
 #endif
 
-  const int32_t* input = input_data;
+  const int32_t* input = input_data + start_row * d1;
 
-  int i = 0;
+  int i = start_row;
 #ifdef USE_NEON
-  for (; i <= d0 - kLines; i += kLines) {
+  for (; i <= end_row - kLines; i += kLines) {
     int32_t* output = output_data + i;
 
     const int32_t* input_ptr = input;
@@ -7255,7 +7494,7 @@ inline void Transpose2D(const RuntimeShape& input_shape,
     }
   }
 #endif
-  for (; i < d0; ++i) {
+  for (; i < end_row; ++i) {
     int32_t* output = output_data + i;
     for (int j = 0; j < d1; ++j) {
       *output = *input;
@@ -7265,12 +7504,22 @@ inline void Transpose2D(const RuntimeShape& input_shape,
   }
 }
 
+template <typename T>
+inline void Transpose2D(const RuntimeShape& input_shape, const T* input_data,
+                        const RuntimeShape& output_shape, T* output_data) {
+  Transpose2D(input_shape, input_data, output_shape, output_data,
+              /*start_row=*/0, /*end_row=*/input_shape.Dims(0));
+}
+
 // TODO(b/173718660): see if we can reduce the number
 // of lines of code in branching without affecting latency.
+//
+// Only the rows of the first output dimension in [start, end) are written.
 template <typename T>
 inline void Transpose3D(const TransposeParams& params,
                         const RuntimeShape& input_shape, const T* input_data,
-                        const RuntimeShape& output_shape, T* output_data) {
+                        const RuntimeShape& output_shape, T* output_data,
+                        int start, int end) {
   int s2, s3;
   s2 = input_shape.Dims(1);
   s3 = input_shape.Dims(2);
@@ -7305,7 +7554,7 @@ inline void Transpose3D(const TransposeParams& params,
   o_s[1] = input_shape.Dims(params.perm[1]);
   o_s[2] = input_shape.Dims(params.perm[2]);
 
-  for (int i1 = 0; i1 < o_s[0]; ++i1) {
+  for (int i1 = start; i1 < end; ++i1) {
     for (int i2 = 0; i2 < o_s[1]; ++i2) {
       for (int i3 = 0; i3 < o_s[2]; ++i3) {
         const int i = i1 * p1 + i2 * p2 + i3 * p3;
@@ -7316,17 +7565,69 @@ inline void Transpose3D(const TransposeParams& params,
   }
 }
 
+template <typename T>
+inline void Transpose3D(const TransposeParams& params,
+                        const RuntimeShape& input_shape, const T* input_data,
+                        const RuntimeShape& output_shape, T* output_data) {
+  Transpose3D(params, input_shape, input_data, output_shape, output_data,
+              /*start=*/0, /*end=*/input_shape.Dims(params.perm[0]));
+}
+
+// Runs the reference transpose on the rows of the first output dimension in
+// [start, end).
+template <typename T>
+void TransposeReferenceRows(const TransposeParams& params,
+                            const RuntimeShape& input_shape,
+                            const T* input_data,
+                            const RuntimeShape& output_shape, T* output_data,
+                            int start, int end) {
+  using StorageType =
+      typename reference_ops::transpose_internal::TransposeStorageType<
+          sizeof(T)>::type;
+  const int dims = input_shape.DimensionsCount();
+  std::array<int, kTransposeMaxDimensions> input_stride, output_stride;
+  reference_ops::transpose_internal::SetupTransposeStrides(
+      input_stride, input_shape.DimsData(), dims);
+  reference_ops::transpose_internal::SetupTransposeStrides(
+      output_stride, output_shape.DimsData(), dims);
+  std::array<int32_t, kTransposeMaxDimensions> rows_shape;
+  std::copy_n(output_shape.DimsData(), dims, rows_shape.begin());
+  rows_shape[0] = end - start;
+  reference_ops::transpose_internal::TransposeImpl(
+      0, dims, &params.perm[0],
+      reinterpret_cast<const StorageType*>(input_data) +
+          start * input_stride[params.perm[0]],
+      input_stride.data(),
+      reinterpret_cast<StorageType*>(output_data) + start * output_stride[0],
+      output_stride.data(), rows_shape.data());
+}
+
+// Returns the number of rows TransposeImpl splits the transpose into: the
+// input rows for a 2D transpose, otherwise the rows of the first output
+// dimension.
+inline int TransposeImplRows(const TransposeParams& params,
+                             const RuntimeShape& input_shape) {
+  int dim0, dim1;
+  if (transpose_utils::IsTranspose2DApplicable(params, input_shape, &dim0,
+                                               &dim1)) {
+    return dim0;
+  }
+  return input_shape.Dims(params.perm[0]);
+}
+
+// Transposes the rows in [start, end), as counted by TransposeImplRows().
 template <typename T>
 void TransposeImpl(const TransposeParams& params,
                    const RuntimeShape& input_shape, const T* input_data,
-                   const RuntimeShape& output_shape, T* output_data) {
+                   const RuntimeShape& output_shape, T* output_data, int start,
+                   int end) {
   const int dims_cnt = input_shape.DimensionsCount();
 
   int dim0, dim1;
   if (transpose_utils::IsTranspose2DApplicable(params, input_shape, &dim0,
                                                &dim1)) {
     Transpose2D(RuntimeShape({dim0, dim1}), input_data,
-                RuntimeShape({dim1, dim0}), output_data);
+                RuntimeShape({dim1, dim0}), output_data, start, end);
     return;
   }
 
@@ -7341,20 +7642,138 @@ void TransposeImpl(const TransposeParams& params,
   // (e.g. model used in beam search for seq2seq) but is in others.
   // Consider tradeoffs.
   if (dims_cnt == 3) {
-    Transpose3D(params, input_shape, input_data, output_shape, output_data);
+    Transpose3D(params, input_shape, input_data, output_shape, output_data,
+                start, end);
     return;
   }
 
   // Reroute to the reference version if an optimized method for the given data
   // is not available.
-  reference_ops::Transpose<T>(params, input_shape, input_data, output_shape,
-                              output_data);
+  TransposeReferenceRows(params, input_shape, input_data, output_shape,
+                         output_data, start, end);
+}
+
+template <typename T>
+void TransposeImpl(const TransposeParams& params,
+                   const RuntimeShape& input_shape, const T* input_data,
+                   const RuntimeShape& output_shape, T* output_data) {
+  TransposeImpl(params, input_shape, input_data, output_shape, output_data,
+                /*start=*/0, /*end=*/TransposeImplRows(params, input_shape));
 }
 
+// Transposes the blocks of rows in [start_block, end_block) of a batch of
+// transposes that each have `blocks_per_batch` blocks of `rows_per_block`
+// rows.
+template <typename T>
+struct TransposeWorkerTask : cpu_backend_threadpool::Task {
+  TransposeWorkerTask(const TransposeParams& params,
+                      const RuntimeShape& input_shape, const T* input_data,
+                      const RuntimeShape& output_shape, T* output_data,
+                      int batch_stride, int rows, int rows_per_block,
+                      int start_block, int end_block)
+      : params(params),
+        input_shape(input_shape),
+        input_data(input_data),
+        output_shape(output_shape),
+        output_data(output_data),
+        batch_stride(batch_stride),
+        rows(rows),
+        rows_per_block(rows_per_block),
+        start_block(start_block),
+        end_block(end_block) {}
+
+  void Run() override {
+    const int blocks_per_batch = (rows + rows_per_block - 1) / rows_per_block;
+    int block = start_block;
+    while (block < end_block) {
+      const int batch = block / blocks_per_batch;
+      const int first_block = block - batch * blocks_per_batch;
+      const int last_block =
+          std::min(end_block - batch * blocks_per_batch, blocks_per_batch);
+      TransposeImpl(params, input_shape, input_data + batch * batch_stride,
+                    output_shape, output_data + batch * batch_stride,
+                    first_block * rows_per_block,
+                    std::min(last_block * rows_per_block, rows));
+      block = (batch + 1) * blocks_per_batch;
+    }
+  }
+
+ private:
+  const TransposeParams& params;
+  const RuntimeShape& input_shape;
+  const T* input_data;
+  const RuntimeShape& output_shape;
+  T* output_data;
+  int batch_stride;
+  int rows;
+  int rows_per_block;
+  int start_block;
+  int end_block;
+};
+
+// Runs `num_batches` transposes spaced by `batch_stride` elements, splitting
+// them by rows between the threads of `cpu_backend_context` when there is
+// enough data to move.
+template <typename T>
+void TransposeBatches(const TransposeParams& params,
+                      const RuntimeShape& input_shape, const T* input_data,
+                      const RuntimeShape& output_shape, T* output_data,
+                      int num_batches, int batch_stride,
+                      CpuBackendContext* cpu_backend_context) {
+  const int rows = TransposeImplRows(params, input_shape);
+  // A 2D transpose writes a column of the output per input row, so the blocks
+  // of rows span whole cache lines of the output to avoid false sharing.
+  int dim0, dim1;
+  const int rows_per_block =
+      transpose_utils::IsTranspose2DApplicable(params, input_shape, &dim0,
+                                               &dim1)
+          ? std::max<int>(4, 64 / sizeof(T))
+          : 1;
+  const int blocks_per_batch = (rows + rows_per_block - 1) / rows_per_block;
+  const int num_blocks = num_batches * blocks_per_batch;
+
+  constexpr int kMinBytesPerThread = 16 * 1024;
+  const int64_t total_bytes =
+      static_cast<int64_t>(num_batches) * batch_stride * sizeof(T);
+  int thread_count = static_cast<int>(std::min<int64_t>(
+      total_bytes / kMinBytesPerThread, static_cast<int64_t>(num_blocks)));
+  if (cpu_backend_context != nullptr) {
+    thread_count =
+        std::min(thread_count, cpu_backend_context->max_num_threads());
+  } else {
+    thread_count = 1;
+  }
+  if (thread_count <= 1) {
+    for (int batch = 0; batch < num_batches; ++batch) {
+      TransposeImpl<T>(params, input_shape, input_data + batch * batch_stride,
+                       output_shape, output_data + batch * batch_stride);
+    }
+    return;
+  }
+
+  std::vector<TransposeWorkerTask<T>> tasks;
+  tasks.reserve(thread_count);
+  int start_block = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    // Try to distribute the tasks as even as possible.
+    const int end_block =
+        start_block + (num_blocks - start_block) / (thread_count - i);
+    tasks.emplace_back(params, input_shape, input_data, output_shape,
+                       output_data, batch_stride, rows, rows_per_block,
+                       start_block, end_block);
+    start_block = end_block;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+// When `cpu_backend_context` is set, large transposes are split between its
+// threads.
 template <typename T, int N = 6>
 void Transpose(const TransposeParams& unshrinked_params,
                const RuntimeShape& unshrinked_input_shape, const T* input_data,
-               const RuntimeShape& unshrinked_output_shape, T* output_data) {
+               const RuntimeShape& unshrinked_output_shape, T* output_data,
+               CpuBackendContext* cpu_backend_context = nullptr) {
   ruy::profiler::ScopeLabel label("Transpose");
 
   const int output_size = unshrinked_output_shape.DimensionsCount();
@@ -7397,17 +7816,18 @@ void Transpose(const TransposeParams& unshrinked_params,
         &non_flatten_params);
     TFLITE_DCHECK_NE(non_flatten_params.perm[0], 0);
 
-    for (int i = 0; i < total_size; i += non_flatten_size) {
-      TransposeImpl<T>(non_flatten_params, non_flatten_input_shape,
-                       input_data + i, non_flatten_output_shape,
-                       output_data + i);
-    }
+    const int num_batches =
+        non_flatten_size == 0 ? 0 : total_size / non_flatten_size;
+    TransposeBatches<T>(non_flatten_params, non_flatten_input_shape,
+                        input_data, non_flatten_output_shape, output_data,
+                        num_batches, non_flatten_size, cpu_backend_context);
     return;
   }
 
   // Call non-flattened case.
-  TransposeImpl<T>(shrinked_params, shrinked_input_shape, input_data,
-                   shrinked_output_shape, output_data);
+  TransposeBatches<T>(shrinked_params, shrinked_input_shape, input_data,
+                      shrinked_output_shape, output_data, /*num_batches=*/1,
+                      shrinked_input_shape.FlatSize(), cpu_backend_context);
 }
 
 // Assume input1 & input2 have the same scale & zero point.
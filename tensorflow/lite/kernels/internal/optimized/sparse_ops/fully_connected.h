@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <vector>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/core/c/common.h"
@@ -77,7 +79,27 @@ inline void FullyConnectedSparseWeight(
   }
 }
 
-inline void FullyConnectedSparseWeight1x16Impl(
+// Adds the bias to the output batches [thread_start, thread_end) and clamps
+// them to the activation range.
+inline void AddBiasAndApplyActivation(const FullyConnectedParams& params,
+                                      const float* bias_data, int output_depth,
+                                      int thread_start, int thread_end,
+                                      float* output_data) {
+  ruy::profiler::ScopeLabel activation_label("activation function");
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+  for (int b = thread_start; b < thread_end; ++b) {
+    for (int i = 0; i < output_depth; ++i) {
+      float total = output_data[b * output_depth + i];
+      const float bias_value = bias_data ? bias_data[i] : 0;
+      output_data[b * output_depth + i] = ActivationFunctionWithMinMax(
+          total + bias_value, output_activation_min, output_activation_max);
+    }
+  }
+}
+
+template <int kBlockSize>
+inline void FullyConnectedSparseWeight1xNImpl(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const int8_t* input_data,
     const RuntimeShape& weights_shape, const int8_t* weights_data,
@@ -85,8 +107,11 @@ inline void FullyConnectedSparseWeight1x16Impl(
     const RuntimeShape& bias_shape, const int32_t* bias_data,
     const RuntimeShape& output_shape, int8_t* output_data, int thread_start,
     int thread_end, const CpuBackendContext& cpu_backend_context) {
+  static_assert(kBlockSize == 4 || kBlockSize == 16,
+                "Only 1x4 and 1x16 blocks are supported.");
   ruy::profiler::ScopeLabel label("FullyConnected");
-  ruy::profiler::ScopeLabel inner_label("1x16 Block Sparse");
+  ruy::profiler::ScopeLabel inner_label(
+      kBlockSize == 4 ? "1x4 Block Sparse" : "1x16 Block Sparse");
 
   const int input_dims_count = input_shape.DimensionsCount();
   const int output_dims_count = output_shape.DimensionsCount();
@@ -106,25 +131,38 @@ inline void FullyConnectedSparseWeight1x16Impl(
   const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
   const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
 
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
-      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
-      weights_shape.Dims(1), input_data + thread_start * input_depth, bias_data,
-      batches, input_offset, output_multiplier, output_shift, per_channel_scale,
-      per_channel_shift, output_offset, output_activation_min,
-      output_activation_max, output_data + thread_start * output_depth);
+  if (kBlockSize == 4) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        bias_data, batches, input_offset, output_multiplier, output_shift,
+        per_channel_scale, per_channel_shift, output_offset,
+        output_activation_min, output_activation_max,
+        output_data + thread_start * output_depth);
+  } else {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        bias_data, batches, input_offset, output_multiplier, output_shift,
+        per_channel_scale, per_channel_shift, output_offset,
+        output_activation_min, output_activation_max,
+        output_data + thread_start * output_depth);
+  }
 }
 
-inline void FullyConnectedSparseWeight1x4Impl(
+template <int kBlockSize>
+inline void FullyConnectedSparseWeight1xNImpl(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
     const RuntimeShape& weights_shape, const float* weights_data,
     const RuntimeShape& bias_shape, const float* bias_data,
     const RuntimeShape& output_shape, float* output_data, int thread_start,
     int thread_end, const CpuBackendContext& cpu_backend_context) {
+  static_assert(kBlockSize == 4 || kBlockSize == 16,
+                "Only 1x4 and 1x16 blocks are supported.");
   ruy::profiler::ScopeLabel label("FullyConnected");
-  ruy::profiler::ScopeLabel inner_label("1x4 Block Sparse");
-  const float output_activation_min = params.float_activation_min;
-  const float output_activation_max = params.float_activation_max;
+  ruy::profiler::ScopeLabel inner_label(
+      kBlockSize == 4 ? "1x4 Block Sparse" : "1x16 Block Sparse");
 
   const int input_dims_count = input_shape.DimensionsCount();
   const int output_dims_count = output_shape.DimensionsCount();
@@ -137,24 +175,25 @@ inline void FullyConnectedSparseWeight1x4Impl(
   const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
   const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
 
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
-      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
-      weights_shape.Dims(1), input_data + thread_start * input_depth, batches,
-      output_data + thread_start * output_depth);
-
-  ruy::profiler::ScopeLabel activation_label("activation function");
-  for (int b = thread_start; b < thread_end; ++b) {
-    for (int i = 0; i < output_depth; ++i) {
-      float total = output_data[b * output_depth + i];
-      const float bias_value = bias_data ? bias_data[i] : 0;
-      output_data[b * output_depth + i] = ActivationFunctionWithMinMax(
-          total + bias_value, output_activation_min, output_activation_max);
-    }
+  if (kBlockSize == 4) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        batches, output_data + thread_start * output_depth);
+  } else {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        batches, output_data + thread_start * output_depth);
   }
+
+  AddBiasAndApplyActivation(params, bias_data, output_depth, thread_start,
+                            thread_end, output_data);
 }
 
-struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
-  FullyConnectedSparseWeight1x4Task(
+template <int kBlockSize>
+struct FullyConnectedSparseWeight1xNTask : cpu_backend_threadpool::Task {
+  FullyConnectedSparseWeight1xNTask(
       const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
       const RuntimeShape& input_shape, const float* input_data,
       const RuntimeShape& weights_shape, const float* weights_data,
@@ -176,7 +215,7 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
         cpu_backend_context(cpu_backend_context_x) {}
 
   void Run() override {
-    FullyConnectedSparseWeight1x4Impl(
+    FullyConnectedSparseWeight1xNImpl<kBlockSize>(
         sparsity, params, input_shape, input_data, weights_shape, weights_data,
         bias_shape, bias_data, output_shape, output_data, thread_start,
         thread_end, cpu_backend_context);
@@ -198,6 +237,81 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
   const CpuBackendContext& cpu_backend_context;
 };
 
+// `weights_values` and `weights_offsets` hold the weights in the packed 2:4
+// sparse format of tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4.
+inline void FullyConnectedSparseWeight2of4Impl(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const float* input_data, const RuntimeShape& weights_shape,
+    const float* weights_values, const uint8_t* weights_offsets,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data, int thread_start,
+    int thread_end, const CpuBackendContext& cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("2:4 Sparse");
+
+  const int input_dims_count = input_shape.DimensionsCount();
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = thread_end - thread_start;
+  const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
+                                      input_shape, input_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4(
+      weights_values, weights_offsets, output_depth, input_depth,
+      input_data + thread_start * input_depth, batches,
+      output_data + thread_start * output_depth);
+
+  AddBiasAndApplyActivation(params, bias_data, output_depth, thread_start,
+                            thread_end, output_data);
+}
+
+struct FullyConnectedSparseWeight2of4Task : cpu_backend_threadpool::Task {
+  FullyConnectedSparseWeight2of4Task(
+      const FullyConnectedParams& params, const RuntimeShape& input_shape,
+      const float* input_data, const RuntimeShape& weights_shape,
+      const float* weights_values, const uint8_t* weights_offsets,
+      const RuntimeShape& bias_shape, const float* bias_data,
+      const RuntimeShape& output_shape, float* output_data, int thread_start,
+      int thread_end, const CpuBackendContext& cpu_backend_context_x)
+      : params(params),
+        input_shape(input_shape),
+        input_data(input_data),
+        weights_shape(weights_shape),
+        weights_values(weights_values),
+        weights_offsets(weights_offsets),
+        bias_shape(bias_shape),
+        bias_data(bias_data),
+        output_shape(output_shape),
+        output_data(output_data),
+        thread_start(thread_start),
+        thread_end(thread_end),
+        cpu_backend_context(cpu_backend_context_x) {}
+
+  void Run() override {
+    FullyConnectedSparseWeight2of4Impl(
+        params, input_shape, input_data, weights_shape, weights_values,
+        weights_offsets, bias_shape, bias_data, output_shape, output_data,
+        thread_start, thread_end, cpu_backend_context);
+  }
+
+ private:
+  const FullyConnectedParams& params;
+  const RuntimeShape& input_shape;
+  const float* input_data;
+  const RuntimeShape& weights_shape;
+  const float* weights_values;
+  const uint8_t* weights_offsets;
+  const RuntimeShape& bias_shape;
+  const float* bias_data;
+  const RuntimeShape& output_shape;
+  float* output_data;
+  int thread_start;
+  int thread_end;
+  const CpuBackendContext& cpu_backend_context;
+};
+
 inline void FullyConnectedSparseWeight1x16(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const int8_t* input_data,
@@ -213,17 +327,68 @@ inline void FullyConnectedSparseWeight1x16(
       FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
 
   // TODO(b/220851507): Add multi-thread support for quantized sparse kernel.
-  return FullyConnectedSparseWeight1x16Impl(
+  return FullyConnectedSparseWeight1xNImpl<16>(
+      sparsity, params, input_shape, input_data, weights_shape, weights_data,
+      per_channel_scale, per_channel_shift, bias_shape, bias_data, output_shape,
+      output_data, 0, batches, *cpu_backend_context);
+}
+
+inline void FullyConnectedSparseWeight1x4(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const int32_t* per_channel_scale, const int32_t* per_channel_shift,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int output_elements = output_shape.FlatSize();
+  memset(output_data, 0, output_elements * sizeof(int8_t));
+
+  const int batches =
+      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+
+  return FullyConnectedSparseWeight1xNImpl<4>(
       sparsity, params, input_shape, input_data, weights_shape, weights_data,
       per_channel_scale, per_channel_shift, bias_shape, bias_data, output_shape,
       output_data, 0, batches, *cpu_backend_context);
 }
 
+// `weights_values` and `weights_offsets` hold the weights in the packed 2:4
+// sparse format of tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4.
+inline void FullyConnectedSparseWeight2of4(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& weights_shape,
+    const int8_t* weights_values, const uint8_t* weights_offsets,
+    const int32_t* per_channel_scale, const int32_t* per_channel_shift,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("2:4 Sparse");
+
+  const int input_dims_count = input_shape.DimensionsCount();
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
+                                      input_shape, input_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+
+  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate2of4(
+      weights_values, weights_offsets, output_depth, input_depth, input_data,
+      bias_data, batches, params.input_offset, params.output_multiplier,
+      params.output_shift, per_channel_scale, per_channel_shift,
+      params.output_offset, params.quantized_activation_min,
+      params.quantized_activation_max, output_data);
+}
+
 // The multi-threaded kernel slices the workload along the batch dimension. If
 // there's not enough batches of data, the number of threads used is equal to
 // the batch size. We can improve this later with slicing along the row
 // dimension of the weight.
-inline void FullyConnectedSparseWeight1x4(
+template <int kBlockSize>
+inline void FullyConnectedSparseWeight1xN(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
     const RuntimeShape& weights_shape, const float* weights_data,
@@ -238,12 +403,12 @@ inline void FullyConnectedSparseWeight1x4(
       FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
   const int thread_count = std::max(1, std::min(batches, max_threads));
   if (thread_count == 1) {
-    return FullyConnectedSparseWeight1x4Impl(
+    return FullyConnectedSparseWeight1xNImpl<kBlockSize>(
         sparsity, params, input_shape, input_data, weights_shape, weights_data,
         bias_shape, bias_data, output_shape, output_data, 0, batches,
         *cpu_backend_context);
   }
-  std::vector<FullyConnectedSparseWeight1x4Task> tasks;
+  std::vector<FullyConnectedSparseWeight1xNTask<kBlockSize>> tasks;
   tasks.reserve(thread_count);
   int thread_start = 0;
   for (int i = 0; i < thread_count; ++i) {
@@ -263,6 +428,71 @@ inline void FullyConnectedSparseWeight1x4(
                                   cpu_backend_context);
 }
 
+inline void FullyConnectedSparseWeight1x4(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeight1xN<4>(sparsity, params, input_shape, input_data,
+                                   weights_shape, weights_data, bias_shape,
+                                   bias_data, output_shape, output_data,
+                                   cpu_backend_context);
+}
+
+inline void FullyConnectedSparseWeight1x16(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const RuntimeShape& weights_shape, const float* weights_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  FullyConnectedSparseWeight1xN<16>(sparsity, params, input_shape, input_data,
+                                    weights_shape, weights_data, bias_shape,
+                                    bias_data, output_shape, output_data,
+                                    cpu_backend_context);
+}
+
+// Same as FullyConnectedSparseWeight1xN, but with the weights in the packed 2:4
+// sparse format.
+inline void FullyConnectedSparseWeight2of4(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const float* input_data, const RuntimeShape& weights_shape,
+    const float* weights_values, const uint8_t* weights_offsets,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int output_elements = output_shape.FlatSize();
+  memset(output_data, 0, output_elements * sizeof(float));
+
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int batches =
+      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+  const int thread_count = std::max(1, std::min(batches, max_threads));
+  if (thread_count == 1) {
+    return FullyConnectedSparseWeight2of4Impl(
+        params, input_shape, input_data, weights_shape, weights_values,
+        weights_offsets, bias_shape, bias_data, output_shape, output_data, 0,
+        batches, *cpu_backend_context);
+  }
+  std::vector<FullyConnectedSparseWeight2of4Task> tasks;
+  tasks.reserve(thread_count);
+  int thread_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int thread_end = thread_start + batches / thread_count;
+    if (i < batches % thread_count) thread_end++;
+
+    tasks.emplace_back(params, input_shape, input_data, weights_shape,
+                       weights_values, weights_offsets, bias_shape, bias_data,
+                       output_shape, output_data, thread_start, thread_end,
+                       *cpu_backend_context);
+    thread_start = thread_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 #endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_FULLY_CONNECTED_H_
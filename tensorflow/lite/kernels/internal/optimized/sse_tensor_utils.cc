@@ -28,11 +28,13 @@ limitations under the License.
 #endif
 
 #include <cstdint>
+#include <cstring>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
 namespace tflite {
@@ -291,6 +293,238 @@ void Avx2MatrixBatchVectorMultiplyAccumulateImpl(
   }  // for batch
 }
 
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate1x4Impl(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      __m128 acc_32x4 = _mm_setzero_ps();
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        __m128 vector_f32x4 =
+            _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize);
+        __m128 matrix_f32x4 = _mm_loadu_ps(matrix_ptr);
+        acc_32x4 = _mm_add_ps(acc_32x4, _mm_mul_ps(vector_f32x4, matrix_f32x4));
+        matrix_ptr += kBlockSize;
+      }
+      result[batch * m_rows + row] += ReduceFloat32x4(acc_32x4);
+    }
+  }
+}
+
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate1x16Impl(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kBlockSize = 2 * kFloatValuesPerAvx2Vector;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      // Two accumulators to hide the latency of the additions.
+      __m256 acc0_32x8 = _mm256_setzero_ps();
+      __m256 acc1_32x8 = _mm256_setzero_ps();
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        const float* vector_block_ptr =
+            vector_in_batch + indices[i] * kBlockSize;
+        acc0_32x8 = _mm256_add_ps(
+            acc0_32x8, _mm256_mul_ps(_mm256_loadu_ps(vector_block_ptr),
+                                     _mm256_loadu_ps(matrix_ptr)));
+        acc1_32x8 = _mm256_add_ps(
+            acc1_32x8,
+            _mm256_mul_ps(
+                _mm256_loadu_ps(vector_block_ptr + kFloatValuesPerAvx2Vector),
+                _mm256_loadu_ps(matrix_ptr + kFloatValuesPerAvx2Vector)));
+        matrix_ptr += kBlockSize;
+      }
+      result[batch * m_rows + row] +=
+          ReduceFloat32x8(_mm256_add_ps(acc0_32x8, acc1_32x8));
+    }
+  }
+}
+
+namespace {
+
+// The number of columns of a group of a 2:4 sparse matrix, and the number of
+// values stored per group.
+constexpr int k2of4GroupSize = 4;
+constexpr int k2of4ValuesPerGroup = 2;
+// The number of groups whose values fill an AVX2 vector of 8 int32 or float.
+constexpr int k2of4GroupsPerAvx2Vector = 4;
+
+// Returns the column indices, relative to the first group, of the 8 values of
+// the 4 groups of a 2:4 sparse matrix starting at `offsets_ptr`.
+inline __m256i Load2of4ColumnIndices(const uint8_t* offsets_ptr) {
+  int32_t offsets_4x8;
+  memcpy(&offsets_4x8, offsets_ptr, sizeof(offsets_4x8));
+  // [o0, o0, o1, o1, o2, o2, o3, o3], each widened to 32 bits.
+  const __m256i offsets_32x8 = _mm256_cvtepu8_epi32(_mm_shuffle_epi8(
+      _mm_cvtsi32_si128(offsets_4x8),
+      _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, 0, 0, 0, 0, 0, 0, 0, 0)));
+  // Even values use bits 0-1 of the offsets, odd values use bits 2-3.
+  const __m256i shifts_32x8 = _mm256_setr_epi32(0, 2, 0, 2, 0, 2, 0, 2);
+  const __m256i columns_32x8 = _mm256_and_si256(
+      _mm256_srlv_epi32(offsets_32x8, shifts_32x8), _mm256_set1_epi32(3));
+  return _mm256_add_epi32(columns_32x8,
+                          _mm256_setr_epi32(0, 0, 4, 4, 8, 8, 12, 12));
+}
+
+// Returns the dot product of a row of a 2:4 sparse int8 matrix with a vector,
+// and the sum of the values of the row in `row_sum`.
+inline int32_t Avx2Sparse2of4RowDotProduct(const int8_t* matrix_ptr,
+                                           const uint8_t* offsets_ptr,
+                                           const int8_t* vector_ptr,
+                                           int num_groups, int32_t* row_sum) {
+  // The 32-bit words holding the values of the vector start at the first
+  // column of their group, so that gathering them never reads past the group.
+  const __m256i group_starts_32x8 =
+      _mm256_setr_epi32(0, 0, 4, 4, 8, 8, 12, 12);
+  __m256i dotprod_32x8 = _mm256_setzero_si256();
+  __m256i row_sum_32x8 = _mm256_setzero_si256();
+  int g = 0;
+  for (; g + k2of4GroupsPerAvx2Vector <= num_groups;
+       g += k2of4GroupsPerAvx2Vector) {
+    const __m256i columns_32x8 = _mm256_sub_epi32(
+        Load2of4ColumnIndices(offsets_ptr), group_starts_32x8);
+    const __m256i words_32x8 = _mm256_i32gather_epi32(
+        reinterpret_cast<const int*>(vector_ptr), group_starts_32x8, 1);
+    // Sign-extends byte `columns` of each word.
+    const __m256i vector_32x8 = _mm256_srai_epi32(
+        _mm256_sllv_epi32(
+            words_32x8,
+            _mm256_sub_epi32(_mm256_set1_epi32(24),
+                             _mm256_slli_epi32(columns_32x8, 3))),
+        24);
+    const __m256i matrix_32x8 = _mm256_cvtepi8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(matrix_ptr)));
+    dotprod_32x8 = _mm256_add_epi32(
+        dotprod_32x8, _mm256_mullo_epi32(matrix_32x8, vector_32x8));
+    row_sum_32x8 = _mm256_add_epi32(row_sum_32x8, matrix_32x8);
+    matrix_ptr += k2of4GroupsPerAvx2Vector * k2of4ValuesPerGroup;
+    offsets_ptr += k2of4GroupsPerAvx2Vector;
+    vector_ptr += k2of4GroupsPerAvx2Vector * k2of4GroupSize;
+  }
+  int32_t dotprod = ReduceInt32x4(
+      _mm_add_epi32(_mm256_castsi256_si128(dotprod_32x8),
+                    _mm256_extracti128_si256(dotprod_32x8, 1)));
+  *row_sum = ReduceInt32x4(
+      _mm_add_epi32(_mm256_castsi256_si128(row_sum_32x8),
+                    _mm256_extracti128_si256(row_sum_32x8, 1)));
+  for (; g < num_groups; ++g) {
+    dotprod += matrix_ptr[0] * vector_ptr[*offsets_ptr & 3];
+    dotprod += matrix_ptr[1] * vector_ptr[*offsets_ptr >> 2 & 3];
+    *row_sum += matrix_ptr[0] + matrix_ptr[1];
+    matrix_ptr += k2of4ValuesPerGroup;
+    ++offsets_ptr;
+    vector_ptr += k2of4GroupSize;
+  }
+  return dotprod;
+}
+
+}  // namespace
+
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate2of4Impl(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % k2of4GroupSize, 0);
+  const int num_groups = m_cols / k2of4GroupSize;
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const uint8_t* offsets_ptr = offsets;
+    for (int row = 0; row < m_rows; row++) {
+      __m256 acc_32x8 = _mm256_setzero_ps();
+      const float* vector_ptr = vector + batch * m_cols;
+      int g = 0;
+      for (; g + k2of4GroupsPerAvx2Vector <= num_groups;
+           g += k2of4GroupsPerAvx2Vector) {
+        const __m256 vector_f32x8 = _mm256_i32gather_ps(
+            vector_ptr, Load2of4ColumnIndices(offsets_ptr), sizeof(float));
+        const __m256 matrix_f32x8 = _mm256_loadu_ps(matrix_ptr);
+        acc_32x8 =
+            _mm256_add_ps(acc_32x8, _mm256_mul_ps(vector_f32x8, matrix_f32x8));
+        matrix_ptr += k2of4GroupsPerAvx2Vector * k2of4ValuesPerGroup;
+        offsets_ptr += k2of4GroupsPerAvx2Vector;
+        vector_ptr += k2of4GroupsPerAvx2Vector * k2of4GroupSize;
+      }
+      float dot_prod = ReduceFloat32x8(acc_32x8);
+      for (; g < num_groups; ++g) {
+        dot_prod += matrix_ptr[0] * vector_ptr[*offsets_ptr & 3];
+        dot_prod += matrix_ptr[1] * vector_ptr[*offsets_ptr >> 2 & 3];
+        matrix_ptr += k2of4ValuesPerGroup;
+        ++offsets_ptr;
+        vector_ptr += k2of4GroupSize;
+      }
+      result[batch * m_rows + row] += dot_prod;
+    }
+  }
+}
+
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate2of4Impl(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % k2of4GroupSize, 0);
+  const int num_groups = m_cols / k2of4GroupSize;
+  const int row_stride = num_groups * k2of4ValuesPerGroup;
+
+  for (int batch = 0; batch < n_batch; ++batch) {
+    for (int row = 0; row < m_rows; ++row) {
+      int32_t matrix_row_sum;
+      int32_t acc = Avx2Sparse2of4RowDotProduct(
+          matrix + row * row_stride, offsets + row * num_groups,
+          vector + batch * m_cols, num_groups, &matrix_row_sum);
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      acc = acc + bias_value + input_offset * matrix_row_sum;
+      acc = MultiplyByQuantizedMultiplier(
+          acc, per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      acc += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              acc, output_activation_min, output_activation_max));
+    }
+  }
+}
+
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate2of4Impl(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vectors,
+    const float* __restrict__ scaling_factors, int n_batch,
+    float* __restrict__ result, const float* per_channel_scale) {
+  TFLITE_DCHECK_EQ(m_cols % k2of4GroupSize, 0);
+  const int num_groups = m_cols / k2of4GroupSize;
+  const int row_stride = num_groups * k2of4ValuesPerGroup;
+
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const float batch_scaling_factor = scaling_factors[batch];
+    for (int row = 0; row < m_rows; ++row) {
+      int32_t matrix_row_sum;
+      const int32_t dotprod = Avx2Sparse2of4RowDotProduct(
+          matrix + row * row_stride, offsets + row * num_groups, vectors,
+          num_groups, &matrix_row_sum);
+      float scaling_factor = batch_scaling_factor;
+      if (per_channel_scale) {
+        scaling_factor *= per_channel_scale[row];
+      }
+      result[batch * m_rows + row] += dotprod * scaling_factor;
+    }
+  }
+}
+
 #endif  // __AVX2__
 
 void SseMatrixBatchVectorMultiplyAccumulateImpl(
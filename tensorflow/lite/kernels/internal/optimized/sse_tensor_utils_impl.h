@@ -40,6 +40,45 @@ void Avx2MatrixBatchVectorMultiplyAccumulateImpl(
     float* __restrict__ result, const float* per_channel_scale,
     const int32_t* input_offset, int32_t* scratch, int32_t* row_sums,
     bool* compute_row_sums, CpuBackendContext* context);
+
+// Matrix multiplication for float values, with the matrix stored in the 1x4
+// block sparse format.
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate1x4Impl(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
+// Same as above, but with the 1x16 block sparse format.
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate1x16Impl(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
+// Same as above, but with the packed 2:4 sparse format.
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate2of4Impl(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result);
+
+// Matrix multiplication for quantized values using asymmetric quantization,
+// with the matrix stored in the packed 2:4 sparse format.
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate2of4Impl(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result);
+
+// Matrix multiplication for quantized values using symmetric quantization,
+// with the matrix stored in the packed 2:4 sparse format.
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate2of4Impl(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vectors,
+    const float* __restrict__ scaling_factors, int n_batch,
+    float* __restrict__ result, const float* per_channel_scale);
 #endif  // defined(__AVX2__)
 
 #ifdef __SSSE3__
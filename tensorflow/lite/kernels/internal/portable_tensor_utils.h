@@ -193,6 +193,28 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result);
 
+// Same as the function above, but with block pattern 1x16.
+// This function assumes that m_cols is a multiple of 16.
+void SparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
+// Same as the function above, but the matrix has 2:4 structured sparsity: each
+// group of 4 consecutive columns of a row holds at most 2 non-zero values. The
+// matrix is stored in a packed format which consists of two arrays:
+//   1. A matrix array stores 2 values per group, i.e. m_cols / 2 values per
+//      row, in row major. Groups with less than 2 non-zero values are padded
+//      with zeros.
+//   2. An offsets array stores one byte per group. Bits 0-1 and 2-3 of the
+//      byte are the column offsets, within the group, of the first and of the
+//      second value of the group.
+// This function assumes that m_cols is a multiple of 4.
+void SparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result);
+
 // Same as the function above, but the matrix is stored in block compressed
 // sparse row format with block pattern 1x16 which consists of two arrays:
 //   1. A matrix array stores non-zero blocks of the matrix in row major.
@@ -262,6 +284,41 @@ void SparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ scaling_factors, int n_batch,
     float* __restrict__ result, const float* per_channel_scale = nullptr);
 
+// Same as the function above, but the matrix has 2:4 structured sparsity and
+// is stored in the packed format of the float
+// SparseMatrixBatchVectorMultiplyAccumulate2of4.
+void SparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vectors,
+    const float* __restrict__ scaling_factors, int n_batch,
+    float* __restrict__ result, const float* per_channel_scale = nullptr);
+
+// Same as the int8 SparseMatrixBatchVectorMultiplyAccumulate1x16 above, but
+// with block pattern 1x4.
+// This function assumes that m_cols is a multiple of 4.
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result);
+
+// Same as the int8 SparseMatrixBatchVectorMultiplyAccumulate1x16 above, but
+// the matrix has 2:4 structured sparsity and is stored in the packed format of
+// the float SparseMatrixBatchVectorMultiplyAccumulate2of4.
+void SparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result);
+
 // Same as the above 8, 8, 8 integer matmul except for the presence of zero
 // point and non-accumulative.
 // TODO(b/148688698): remove this function by folding zero point calculation in
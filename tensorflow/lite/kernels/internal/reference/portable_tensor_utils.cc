@@ -205,11 +205,13 @@ void PortableMatrixBatchVectorMultiplyAccumulate(
   }  // for batch
 }
 
-void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+namespace {
+
+template <int kBlockSize>
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1xN(
     const float* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
-  const int kBlockSize = 4;
   TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
   for (int batch = 0; batch < n_batch; batch++) {
     const float* matrix_ptr = matrix;
@@ -229,7 +231,8 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
-void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
+template <int kBlockSize>
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1xN(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
@@ -238,7 +241,6 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int32_t* per_channel_shift, const int32_t output_offset,
     const int32_t output_activation_min, const int32_t output_activation_max,
     int8_t* __restrict__ result) {
-  const int kBlockSize = 16;
   TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
   for (int batch = 0; batch < n_batch; ++batch) {
     const int8_t* matrix_ptr = matrix;
@@ -267,6 +269,149 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
   }
 }
 
+}  // namespace
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  PortableSparseMatrixBatchVectorMultiplyAccumulate1xN<4>(
+      matrix, segments, indices, m_rows, m_cols, vector, n_batch, result);
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  PortableSparseMatrixBatchVectorMultiplyAccumulate1xN<16>(
+      matrix, segments, indices, m_rows, m_cols, vector, n_batch, result);
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  PortableSparseMatrixBatchVectorMultiplyAccumulate1xN<4>(
+      matrix, segments, indices, m_rows, m_cols, vector, bias_vector, n_batch,
+      input_offset, output_multiplier, output_shift, per_channel_scale,
+      per_channel_shift, output_offset, output_activation_min,
+      output_activation_max, result);
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  PortableSparseMatrixBatchVectorMultiplyAccumulate1xN<16>(
+      matrix, segments, indices, m_rows, m_cols, vector, bias_vector, n_batch,
+      input_offset, output_multiplier, output_shift, per_channel_scale,
+      per_channel_shift, output_offset, output_activation_min,
+      output_activation_max, result);
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const float* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
+    float* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % 4, 0);
+  const int num_groups = m_cols / 4;
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const float* matrix_ptr = matrix;
+    const uint8_t* offsets_ptr = offsets;
+    for (int row = 0; row < m_rows; ++row) {
+      float dot_prod = 0.0f;
+      const float* vector_group_ptr = vector + batch * m_cols;
+      for (int g = 0; g < num_groups; ++g) {
+        const uint8_t group_offsets = *offsets_ptr++;
+        dot_prod += matrix_ptr[0] * vector_group_ptr[group_offsets & 3];
+        dot_prod += matrix_ptr[1] * vector_group_ptr[(group_offsets >> 2) & 3];
+        matrix_ptr += 2;
+        vector_group_ptr += 4;
+      }
+      result[batch * m_rows + row] += dot_prod;
+    }
+  }
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vector,
+    const int32_t* __restrict__ bias_vector, int n_batch,
+    const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % 4, 0);
+  const int num_groups = m_cols / 4;
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* matrix_ptr = matrix;
+    const uint8_t* offsets_ptr = offsets;
+    for (int row = 0; row < m_rows; ++row) {
+      int32_t dot_prod = 0;
+      const int8_t* vector_group_ptr = vector + batch * m_cols;
+      for (int g = 0; g < num_groups; ++g) {
+        const uint8_t group_offsets = *offsets_ptr++;
+        dot_prod += matrix_ptr[0] *
+                    (vector_group_ptr[group_offsets & 3] + input_offset);
+        dot_prod += matrix_ptr[1] *
+                    (vector_group_ptr[(group_offsets >> 2) & 3] + input_offset);
+        matrix_ptr += 2;
+        vector_group_ptr += 4;
+      }
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      dot_prod = MultiplyByQuantizedMultiplier(
+          dot_prod + bias_value,
+          per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      dot_prod += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              dot_prod, output_activation_min, output_activation_max));
+    }
+  }
+}
+
+void PortableSparseMatrixBatchVectorMultiplyAccumulate2of4(
+    const int8_t* __restrict__ matrix, const uint8_t* __restrict__ offsets,
+    int m_rows, int m_cols, const int8_t* __restrict__ vectors,
+    const float* __restrict__ scaling_factors, int n_batch,
+    float* __restrict__ result, const float* per_channel_scale) {
+  TFLITE_DCHECK_EQ(m_cols % 4, 0);
+  const int num_groups = m_cols / 4;
+  for (int batch = 0; batch < n_batch; ++batch, vectors += m_cols) {
+    const float batch_scaling_factor = scaling_factors[batch];
+    const int8_t* matrix_ptr = matrix;
+    const uint8_t* offsets_ptr = offsets;
+    for (int row = 0; row < m_rows; ++row) {
+      int32_t dotprod = 0;
+      const int8_t* vector_group_ptr = vectors;
+      for (int g = 0; g < num_groups; ++g) {
+        const uint8_t group_offsets = *offsets_ptr++;
+        dotprod += matrix_ptr[0] * vector_group_ptr[group_offsets & 3];
+        dotprod += matrix_ptr[1] * vector_group_ptr[(group_offsets >> 2) & 3];
+        matrix_ptr += 2;
+        vector_group_ptr += 4;
+      }
+      float scaling_factor = batch_scaling_factor;
+      if (per_channel_scale) {
+        scaling_factor *= per_channel_scale[row];
+      }
+      result[batch * m_rows + row] += dotprod * scaling_factor;
+    }
+  }
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
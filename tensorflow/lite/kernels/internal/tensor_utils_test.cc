@@ -1557,6 +1557,45 @@ TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulateTest) {
               ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
 }
 
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate2of4Test) {
+  const int kRow = 3;
+  const int kCol = 12;
+  const int kBatch = 2;
+  /* clang-format off */
+  float matrix[kRow * kCol] = {
+      1.5, 0.0, -2.0, 0.0, 0.0, 0.0, 0.0, 3.0, 0.0, 4.5, 0.5, 0.0,
+      0.0, 0.0, 0.0, 0.0, -1.0, 2.5, 0.0, 0.0, 0.0, 0.0, 0.0, -3.5,
+      0.0, 2.0, 0.0, 1.0, 0.0, -0.5, 0.0, 2.0, 6.0, 0.0, 0.0, 0.0};
+
+  // Packed 2:4 format of the above matrix.
+  float matrix_values[kRow * kCol / 2] = {
+      1.5, -2.0, 0.0, 3.0, 4.5, 0.5,
+      0.0, 0.0, -1.0, 2.5, 0.0, -3.5,
+      2.0, 1.0, -0.5, 2.0, 6.0, 0.0};
+  uint8_t offsets[kRow * kCol / 4] = {
+      0 | 2 << 2, 0 | 3 << 2, 1 | 2 << 2,  // 1st row
+      0 | 1 << 2, 0 | 1 << 2, 0 | 3 << 2,  // 2nd row
+      1 | 3 << 2, 1 | 3 << 2, 0 | 1 << 2,  // 3rd row
+  };
+
+  float vector[kBatch * kCol] = {
+      1.0, -1.0, 2.0, 0.5, -0.5, 3.0, 1.5, -2.0, 0.25, 1.0, -1.0, 2.0,
+      -2.0, 0.5, 1.0, -1.5, 2.0, 0.0, -1.0, 1.0, 3.0, -0.5, 0.5, 1.5};
+  /* clang-format on */
+
+  std::vector<float> dense_output(kRow * kBatch, 0.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix, kRow, kCol, vector, kBatch,
+                                      dense_output.data());
+
+  std::vector<float> sparse_output(kRow * kBatch, 0.0);
+  SparseMatrixBatchVectorMultiplyAccumulate2of4(matrix_values, offsets, kRow,
+                                                kCol, vector, kBatch,
+                                                sparse_output.data());
+
+  EXPECT_THAT(sparse_output,
+              ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
+}
+
 #ifdef __ANDROID__
 TEST(uKernels,
      SparseMatrixBatchVectorMultiplyAccumulateSymmetricQuantizedTest) {
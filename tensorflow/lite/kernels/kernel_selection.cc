@@ -0,0 +1,254 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/kernel_selection.h"
+
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace ops {
+namespace builtin {
+
+TfLiteRegistration* Register_ADD_REF();
+TfLiteRegistration* Register_ADD_GENERIC_OPT();
+TfLiteRegistration* Register_ADD_NEON_OPT();
+TfLiteRegistration* Register_SUB_REF();
+TfLiteRegistration* Register_SUB_GENERIC_OPT();
+TfLiteRegistration* Register_SUB_NEON_OPT();
+TfLiteRegistration* Register_MUL_REF();
+TfLiteRegistration* Register_MUL_GENERIC_OPT();
+TfLiteRegistration* Register_MUL_NEON_OPT();
+TfLiteRegistration* Register_AVERAGE_POOL_REF();
+TfLiteRegistration* Register_AVERAGE_POOL_GENERIC_OPT();
+TfLiteRegistration* Register_MAX_POOL_REF();
+TfLiteRegistration* Register_MAX_POOL_GENERIC_OPT();
+TfLiteRegistration* Register_L2_POOL_REF();
+TfLiteRegistration* Register_L2_POOL_GENERIC_OPT();
+TfLiteRegistration* Register_CONVOLUTION_REF();
+TfLiteRegistration* Register_CONVOLUTION_GENERIC_OPT();
+TfLiteRegistration* Register_CONVOLUTION_MULTITHREADED_OPT();
+TfLiteRegistration* Register_DEPTHWISE_CONVOLUTION_REF();
+TfLiteRegistration* Register_DEPTHWISE_CONVOLUTION_GENERIC_OPT();
+TfLiteRegistration* Register_DEPTHWISE_CONVOLUTION_NEON_OPT();
+TfLiteRegistration* Register_FULLY_CONNECTED_REF();
+TfLiteRegistration* Register_FULLY_CONNECTED_GENERIC_OPT();
+TfLiteRegistration* Register_FULLY_CONNECTED_PIE();
+TfLiteRegistration* Register_TRANSPOSECONV_REF();
+TfLiteRegistration* Register_TRANSPOSECONV_GENERIC_OPT();
+TfLiteRegistration* Register_BATCH_MATMUL_REF();
+TfLiteRegistration* Register_BATCH_MATMUL_GENERIC_OPTIMIZED();
+TfLiteRegistration* Register_CONCATENATION_REF();
+TfLiteRegistration* Register_CONCATENATION_GENERIC_OPT();
+TfLiteRegistration* Register_TANH_REF();
+TfLiteRegistration* Register_TANH_GENERIC_OPT();
+TfLiteRegistration* Register_TANH_FIXED_POINT_OPT();
+TfLiteRegistration* Register_LOGISTIC_REF();
+TfLiteRegistration* Register_LOGISTIC_GENERIC_OPT();
+TfLiteRegistration* Register_LOGISTIC_FIXED_POINT_OPT();
+TfLiteRegistration* Register_SOFTMAX_REF();
+TfLiteRegistration* Register_MEAN_REF();
+TfLiteRegistration* Register_MEAN_OPT();
+TfLiteRegistration* Register_SUM_REF();
+TfLiteRegistration* Register_SUM_OPT();
+TfLiteRegistration* Register_REDUCE_PROD_REF();
+TfLiteRegistration* Register_REDUCE_PROD_OPT();
+TfLiteRegistration* Register_REDUCE_MAX_REF();
+TfLiteRegistration* Register_REDUCE_MAX_OPT();
+TfLiteRegistration* Register_REDUCE_MIN_REF();
+TfLiteRegistration* Register_REDUCE_MIN_OPT();
+
+namespace {
+
+const std::map<BuiltinOperator, std::vector<KernelVariant>>&
+GetKernelVariantMap() {
+  static const auto* const kVariants =
+      new std::map<BuiltinOperator, std::vector<KernelVariant>>{
+          {BuiltinOperator_ADD,
+           {{"reference", Register_ADD_REF},
+            {"generic_optimized", Register_ADD_GENERIC_OPT},
+            {"neon_optimized", Register_ADD_NEON_OPT}}},
+          {BuiltinOperator_SUB,
+           {{"reference", Register_SUB_REF},
+            {"generic_optimized", Register_SUB_GENERIC_OPT},
+            {"neon_optimized", Register_SUB_NEON_OPT}}},
+          {BuiltinOperator_MUL,
+           {{"reference", Register_MUL_REF},
+            {"generic_optimized", Register_MUL_GENERIC_OPT},
+            {"neon_optimized", Register_MUL_NEON_OPT}}},
+          {BuiltinOperator_AVERAGE_POOL_2D,
+           {{"reference", Register_AVERAGE_POOL_REF},
+            {"generic_optimized", Register_AVERAGE_POOL_GENERIC_OPT}}},
+          {BuiltinOperator_MAX_POOL_2D,
+           {{"reference", Register_MAX_POOL_REF},
+            {"generic_optimized", Register_MAX_POOL_GENERIC_OPT}}},
+          {BuiltinOperator_L2_POOL_2D,
+           {{"reference", Register_L2_POOL_REF},
+            {"generic_optimized", Register_L2_POOL_GENERIC_OPT}}},
+          {BuiltinOperator_CONV_2D,
+           {{"reference", Register_CONVOLUTION_REF},
+            {"generic_optimized", Register_CONVOLUTION_GENERIC_OPT},
+            // Falls back to generic_optimized when built with ruy.
+            {"multithreaded_optimized",
+             Register_CONVOLUTION_MULTITHREADED_OPT}}},
+          {BuiltinOperator_DEPTHWISE_CONV_2D,
+           {{"reference", Register_DEPTHWISE_CONVOLUTION_REF},
+            {"generic_optimized", Register_DEPTHWISE_CONVOLUTION_GENERIC_OPT},
+            {"neon_optimized", Register_DEPTHWISE_CONVOLUTION_NEON_OPT}}},
+          {BuiltinOperator_FULLY_CONNECTED,
+           {{"reference", Register_FULLY_CONNECTED_REF},
+            {"generic_optimized", Register_FULLY_CONNECTED_GENERIC_OPT},
+            {"pie", Register_FULLY_CONNECTED_PIE}}},
+          {BuiltinOperator_TRANSPOSE_CONV,
+           {{"reference", Register_TRANSPOSECONV_REF},
+            {"generic_optimized", Register_TRANSPOSECONV_GENERIC_OPT}}},
+          {BuiltinOperator_BATCH_MATMUL,
+           {{"reference", Register_BATCH_MATMUL_REF},
+            {"generic_optimized", Register_BATCH_MATMUL_GENERIC_OPTIMIZED}}},
+          {BuiltinOperator_CONCATENATION,
+           {{"reference", Register_CONCATENATION_REF},
+            {"generic_optimized", Register_CONCATENATION_GENERIC_OPT}}},
+          {BuiltinOperator_TANH,
+           {{"reference", Register_TANH_REF},
+            {"generic_optimized", Register_TANH_GENERIC_OPT},
+            {"fixed_point_optimized", Register_TANH_FIXED_POINT_OPT}}},
+          {BuiltinOperator_LOGISTIC,
+           {{"reference", Register_LOGISTIC_REF},
+            {"generic_optimized", Register_LOGISTIC_GENERIC_OPT},
+            {"fixed_point_optimized", Register_LOGISTIC_FIXED_POINT_OPT}}},
+          {BuiltinOperator_SOFTMAX, {{"reference", Register_SOFTMAX_REF}}},
+          {BuiltinOperator_MEAN,
+           {{"reference", Register_MEAN_REF},
+            {"optimized", Register_MEAN_OPT}}},
+          {BuiltinOperator_SUM,
+           {{"reference", Register_SUM_REF},
+            {"optimized", Register_SUM_OPT}}},
+          {BuiltinOperator_REDUCE_PROD,
+           {{"reference", Register_REDUCE_PROD_REF},
+            {"optimized", Register_REDUCE_PROD_OPT}}},
+          {BuiltinOperator_REDUCE_MAX,
+           {{"reference", Register_REDUCE_MAX_REF},
+            {"optimized", Register_REDUCE_MAX_OPT}}},
+          {BuiltinOperator_REDUCE_MIN,
+           {{"reference", Register_REDUCE_MIN_REF},
+            {"optimized", Register_REDUCE_MIN_OPT}}},
+      };
+  return *kVariants;
+}
+
+bool ParseBuiltinOperator(const std::string& name, BuiltinOperator* op) {
+  for (BuiltinOperator value : EnumValuesBuiltinOperator()) {
+    if (name == EnumNameBuiltinOperator(value)) {
+      *op = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+const std::vector<KernelVariant>& GetKernelVariants(BuiltinOperator op) {
+  static const auto* const kNoVariants = new std::vector<KernelVariant>();
+  const auto& variants = GetKernelVariantMap();
+  const auto it = variants.find(op);
+  return it == variants.end() ? *kNoVariants : it->second;
+}
+
+TfLiteRegistration* FindKernelVariant(BuiltinOperator op,
+                                      const std::string& name) {
+  for (const KernelVariant& variant : GetKernelVariants(op)) {
+    if (name == variant.name) return variant.registration();
+  }
+  return nullptr;
+}
+
+TfLiteStatus ParseKernelSelection(const std::string& table,
+                                  KernelSelection* selection) {
+  std::istringstream lines(table);
+  std::string line;
+  int line_number = 0;
+  while (std::getline(lines, line)) {
+    ++line_number;
+    std::istringstream fields(line);
+    std::string op_name, variant_name, extra;
+    if (!(fields >> op_name) || op_name[0] == '#') continue;
+    BuiltinOperator op;
+    if (!(fields >> variant_name) || (fields >> extra) ||
+        !ParseBuiltinOperator(op_name, &op)) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Invalid kernel selection at line %d: '%s'.",
+                      line_number, line.c_str());
+      return kTfLiteError;
+    }
+    if (variant_name != kDefaultKernelVariant &&
+        FindKernelVariant(op, variant_name) == nullptr) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Unknown kernel variant '%s' of %s at line %d.",
+                      variant_name.c_str(), op_name.c_str(), line_number);
+      return kTfLiteError;
+    }
+    (*selection)[op] = variant_name;
+  }
+  return kTfLiteOk;
+}
+
+std::string KernelSelectionToString(const KernelSelection& selection) {
+  std::ostringstream table;
+  for (const auto& [op, variant_name] : selection) {
+    table << EnumNameBuiltinOperator(op) << " " << variant_name << "\n";
+  }
+  return table.str();
+}
+
+KernelSelectionOpResolver::KernelSelectionOpResolver(
+    const KernelSelection& selection)
+    : KernelSelectionOpResolver(std::make_unique<BuiltinOpResolver>(),
+                                selection) {}
+
+KernelSelectionOpResolver::KernelSelectionOpResolver(
+    std::unique_ptr<OpResolver> base, const KernelSelection& selection)
+    : base_(std::move(base)) {
+  ChainOpResolver(base_.get());
+  delegate_creators_ = base_->GetDelegateCreators();
+  opaque_delegate_creators_ = base_->GetOpaqueDelegateCreators();
+  for (const auto& [op, variant_name] : selection) {
+    if (variant_name == kDefaultKernelVariant) continue;
+    TfLiteRegistration* registration = FindKernelVariant(op, variant_name);
+    if (registration == nullptr) {
+      TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                      "Ignoring unknown kernel variant '%s' of %s.",
+                      variant_name.c_str(), EnumNameBuiltinOperator(op));
+      continue;
+    }
+    for (int version = 1; base_->FindOp(op, version) != nullptr; ++version) {
+      AddBuiltin(op, registration, version);
+    }
+  }
+}
+
+}  // namespace builtin
+}  // namespace ops
+}  // namespace tflite
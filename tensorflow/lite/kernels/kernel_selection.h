@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_KERNEL_SELECTION_H_
+#define TENSORFLOW_LITE_KERNELS_KERNEL_SELECTION_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace ops {
+namespace builtin {
+
+// An alternative CPU implementation of a builtin operator, e.g. its reference
+// kernel.
+struct KernelVariant {
+  // E.g. "reference" or "generic_optimized".
+  const char* name;
+  TfLiteRegistration* (*registration)();
+};
+
+// The name of the kernel that BuiltinOpResolver uses for an op. It is a valid
+// variant of every op.
+inline constexpr char kDefaultKernelVariant[] = "default";
+
+// Returns the kernel variants of `op`, besides the default one. Empty if the
+// op has a single implementation.
+const std::vector<KernelVariant>& GetKernelVariants(BuiltinOperator op);
+
+// Returns the registration of the kernel variant `name` of `op`, or nullptr if
+// there is no such variant. Returns nullptr for `kDefaultKernelVariant` too.
+TfLiteRegistration* FindKernelVariant(BuiltinOperator op,
+                                      const std::string& name);
+
+// The name of the kernel variant to use for each op. Ops that are not listed
+// use their default kernel.
+using KernelSelection = std::map<BuiltinOperator, std::string>;
+
+// Parses a kernel selection table. Each line of the table holds the name of
+// a builtin op and the name of one of its kernel variants, separated by
+// spaces, e.g. "CONV_2D generic_optimized". Empty lines and lines starting with
+// '#' are ignored.
+TfLiteStatus ParseKernelSelection(const std::string& table,
+                                  KernelSelection* selection);
+
+// Returns the table of `selection`, in the format of ParseKernelSelection.
+std::string KernelSelectionToString(const KernelSelection& selection);
+
+// Op resolver using the kernel variants of a KernelSelection, e.g. one written
+// by the kernel selection tuner of the benchmark tool.
+//
+// Ops are resolved by a base resolver, except for the selected ops, which are
+// resolved to the selected kernel variant for every version the base resolver
+// supports. The delegates of the base resolver are applied as usual, so that
+// the selected kernels only run the nodes that are not delegated.
+class KernelSelectionOpResolver : public MutableOpResolver {
+ public:
+  // Uses BuiltinOpResolver as the base resolver.
+  explicit KernelSelectionOpResolver(const KernelSelection& selection);
+  KernelSelectionOpResolver(std::unique_ptr<OpResolver> base,
+                            const KernelSelection& selection);
+
+ private:
+  std::unique_ptr<OpResolver> base_;
+};
+
+}  // namespace builtin
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_KERNEL_SELECTION_H_
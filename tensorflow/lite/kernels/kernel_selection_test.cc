@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/kernel_selection.h"
+
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace ops {
+namespace builtin {
+namespace {
+
+TEST(KernelSelectionTest, GetKernelVariants) {
+  EXPECT_FALSE(GetKernelVariants(BuiltinOperator_CONV_2D).empty());
+  EXPECT_TRUE(GetKernelVariants(BuiltinOperator_RESHAPE).empty());
+  EXPECT_NE(nullptr, FindKernelVariant(BuiltinOperator_CONV_2D, "reference"));
+  EXPECT_EQ(nullptr,
+            FindKernelVariant(BuiltinOperator_CONV_2D, kDefaultKernelVariant));
+  EXPECT_EQ(nullptr, FindKernelVariant(BuiltinOperator_CONV_2D, "unknown"));
+}
+
+TEST(KernelSelectionTest, ParseAndPrint) {
+  KernelSelection selection;
+  ASSERT_EQ(kTfLiteOk, ParseKernelSelection("# Comment.\n"
+                                            "\n"
+                                            "CONV_2D reference\n"
+                                            "  ADD   default\n",
+                                            &selection));
+  ASSERT_EQ(2, selection.size());
+  EXPECT_EQ("reference", selection[BuiltinOperator_CONV_2D]);
+  EXPECT_EQ(kDefaultKernelVariant, selection[BuiltinOperator_ADD]);
+  EXPECT_EQ("ADD default\nCONV_2D reference\n",
+            KernelSelectionToString(selection));
+}
+
+TEST(KernelSelectionTest, ParseErrors) {
+  KernelSelection selection;
+  EXPECT_EQ(kTfLiteError, ParseKernelSelection("CONV_2D", &selection));
+  EXPECT_EQ(kTfLiteError,
+            ParseKernelSelection("CONV_3X3 reference", &selection));
+  EXPECT_EQ(kTfLiteError, ParseKernelSelection("CONV_2D unknown", &selection));
+  EXPECT_EQ(kTfLiteError,
+            ParseKernelSelection("CONV_2D reference more", &selection));
+  EXPECT_EQ(kTfLiteError,
+            ParseKernelSelection("RESHAPE reference", &selection));
+}
+
+TEST(KernelSelectionTest, OpResolver) {
+  KernelSelection selection;
+  selection[BuiltinOperator_CONV_2D] = "reference";
+  selection[BuiltinOperator_ADD] = kDefaultKernelVariant;
+  KernelSelectionOpResolver resolver(selection);
+  BuiltinOpResolver builtin;
+
+  const TfLiteRegistration* reference =
+      FindKernelVariant(BuiltinOperator_CONV_2D, "reference");
+  for (int version = 1; builtin.FindOp(BuiltinOperator_CONV_2D, version);
+       ++version) {
+    const TfLiteRegistration* conv =
+        resolver.FindOp(BuiltinOperator_CONV_2D, version);
+    ASSERT_NE(nullptr, conv);
+    EXPECT_EQ(reference->invoke, conv->invoke);
+    EXPECT_EQ(version, conv->version);
+  }
+  EXPECT_EQ(builtin.FindOp(BuiltinOperator_ADD, 1)->invoke,
+            resolver.FindOp(BuiltinOperator_ADD, 1)->invoke);
+  EXPECT_EQ(nullptr, resolver.FindOp(BuiltinOperator_CONV_2D, 1000));
+  EXPECT_EQ(builtin.GetDelegateCreators().size(),
+            resolver.GetDelegateCreators().size());
+}
+
+}  // namespace
+}  // namespace builtin
+}  // namespace ops
+}  // namespace tflite
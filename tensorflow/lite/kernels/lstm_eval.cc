@@ -293,6 +293,47 @@ void UpdateLstmCellFloat(int n_batch, int n_cell, float* cell_state,
   }
 }
 
+// Projects the output of an LSTM step, output_gate .* activate(cell_state),
+// to the output state. See CalculateLstmOutputFloat.
+//
+// Parameters:
+//  - n_batch, n_cell, n_output: sizes of vectors.
+//  - hidden: input vector, size n_batch*n_cell.
+//  - projection_weights, projection_bias: constant inputs, describing
+//      projection matrix and bias.
+//  - proj_clip: if > 0, clip the output of the projection.
+//  - output_state: output vector, size n_batch*n_output. Must be contigous.
+//  - projection_bias_scratch: scratch area to store projection_bias. Size
+//  n_batch*n_cell.
+//  - context: the CpuBackendContext for use with matrix multiplications.
+void ProjectLstmOutputFloat(int n_batch, int n_cell, int n_output,
+                            const float* hidden,
+                            const float* projection_weights,
+                            const float* projection_bias,
+                            const float proj_clip, float* output_state,
+                            float* projection_bias_scratch,
+                            CpuBackendContext* context) {
+  const bool use_projection = (projection_weights != nullptr);
+  const bool use_projection_bias = (projection_bias != nullptr);
+
+  if (use_projection) {
+    if (use_projection_bias) {
+      tensor_utils::VectorBatchVectorAssign(projection_bias, n_output, n_batch,
+                                            projection_bias_scratch);
+    } else {
+      std::fill_n(projection_bias_scratch, n_batch * n_output, 0.0f);
+    }
+    MatrixBatchVectorMultiplyAccumulate(projection_weights, hidden,
+                                        projection_bias_scratch, output_state,
+                                        n_output, n_cell, n_batch, context);
+    if (proj_clip > 0.0f) {
+      tensor_utils::CwiseClipping(output_state, n_batch * n_output, proj_clip);
+    }
+  } else {
+    std::copy_n(hidden, n_batch * n_output, output_state);
+  }
+}
+
 // Calculates the output state tensor of an LSTM step.
 //
 // Implements the following formula:
@@ -329,26 +370,9 @@ void CalculateLstmOutputFloat(int n_batch, int n_cell, int n_output,
                                         activation, scratch);
   tensor_utils::VectorVectorCwiseProduct(output_gate, scratch, n_batch * n_cell,
                                          scratch);
-
-  const bool use_projection = (projection_weights != nullptr);
-  const bool use_projection_bias = (projection_bias != nullptr);
-
-  if (use_projection) {
-    if (use_projection_bias) {
-      tensor_utils::VectorBatchVectorAssign(projection_bias, n_output, n_batch,
-                                            projection_bias_scratch);
-    } else {
-      std::fill_n(projection_bias_scratch, n_batch * n_output, 0.0f);
-    }
-    MatrixBatchVectorMultiplyAccumulate(projection_weights, scratch,
-                                        projection_bias_scratch, output_state,
-                                        n_output, n_cell, n_batch, context);
-    if (proj_clip > 0.0f) {
-      tensor_utils::CwiseClipping(output_state, n_batch * n_output, proj_clip);
-    }
-  } else {
-    std::copy_n(scratch, n_batch * n_output, output_state);
-  }
+  ProjectLstmOutputFloat(n_batch, n_cell, n_output, scratch, projection_weights,
+                         projection_bias, proj_clip, output_state,
+                         projection_bias_scratch, context);
 }
 // LINT.ThenChange(../tools/optimize/calibration/builtin_logging_ops/lstm.cc,\
 //                 ../experimental/kernels/fp16/lstm_eval.cc)
@@ -478,38 +502,23 @@ void CalculateLstmGateHybrid(
                                         gate);
 }
 
-// Calculates the output state tensor of an LSTM step. See Float version too.
+// Projects the output of an LSTM step to the output state, hybrid version.
+// See ProjectLstmOutputFloat and CalculateLstmOutputHybrid.
 //
 // Parameters:
-//  - n_batch: batches: the number of distinct vectors in each array.
-//  - n_cell, n_output: sizes of vectors.
-//  - cell_state, output_gate: input vectors, size n_batch*n_cell.
-//  - projection_weights, projection_weights_scale, projection_bias:
-//      constant inputs, describing projection matrix and bias.
-//  - proj_clip: if > 0, clip the output of the projection.
-//  - output_state: output vector, size n_batch*n_output. Must be contigous.
-//  - asymmetric_quantize_inputs: parameter to control quantization.
-//  - projection_weights_row_sums, compute_row_sums, context: Data for optimized
-//      MatrixBatchVectorMultiplyAccumulate.
-//  - scratch0: scratch area of size n_batch*n_cell
+//  - hidden: input vector, size n_batch*n_cell.
 //  - scratch1: scratch area of size n_batch*n_cell
 //  - scratch2: scratch area of size n_batch
 //  - scratch3: scratch area of size n_batch
 //  - scratch4: scratch area used by MatrixBatchVectorMultiplyAccumulate
-void CalculateLstmOutputHybrid(
-    int n_batch, int n_cell, int n_output, const float* cell_state,
-    const float* output_gate, TfLiteFusedActivation activation,
+void ProjectLstmOutputHybrid(
+    int n_batch, int n_cell, int n_output, const float* hidden,
     const int8_t* projection_weights, const uint8_t* projection_weights_ledger,
     float projection_weights_scale, const float* projection_bias,
     const float proj_clip, float* output_state, bool asymmetric_quantize_inputs,
     int32_t* projection_weights_row_sums, bool* compute_row_sums,
-    CpuBackendContext* context, float* scratch0, int8_t* scratch1,
-    float* scratch2, int32_t* scratch3, int32_t* scratch4) {
-  tensor_utils::ApplyActivationToVector(cell_state, n_batch * n_cell,
-                                        activation, scratch0);
-  tensor_utils::VectorVectorCwiseProduct(output_gate, scratch0,
-                                         n_batch * n_cell, scratch0);
-
+    CpuBackendContext* context, int8_t* scratch1, float* scratch2,
+    int32_t* scratch3, int32_t* scratch4) {
   const bool use_projection = (projection_weights != nullptr);
   const bool use_projection_bias = (projection_bias != nullptr);
 
@@ -520,9 +529,9 @@ void CalculateLstmOutputHybrid(
     } else {
       std::fill_n(output_state, n_batch * n_output, 0.0f);
     }
-    if (!tensor_utils::IsZeroVector(scratch0, n_batch * n_cell)) {
+    if (!tensor_utils::IsZeroVector(hidden, n_batch * n_cell)) {
       // Save quantization and matmul computation for all zero output.
-      tensor_utils::BatchQuantizeFloats(scratch0, n_batch, n_cell, scratch1,
+      tensor_utils::BatchQuantizeFloats(hidden, n_batch, n_cell, scratch1,
                                         scratch2, scratch3,
                                         asymmetric_quantize_inputs);
       if (projection_weights_ledger != nullptr) {
@@ -545,10 +554,49 @@ void CalculateLstmOutputHybrid(
       tensor_utils::CwiseClipping(output_state, n_batch * n_output, proj_clip);
     }
   } else {
-    std::copy_n(scratch0, n_batch * n_output, output_state);
+    std::copy_n(hidden, n_batch * n_output, output_state);
   }
 }
 
+// Calculates the output state tensor of an LSTM step. See Float version too.
+//
+// Parameters:
+//  - n_batch: batches: the number of distinct vectors in each array.
+//  - n_cell, n_output: sizes of vectors.
+//  - cell_state, output_gate: input vectors, size n_batch*n_cell.
+//  - projection_weights, projection_weights_scale, projection_bias:
+//      constant inputs, describing projection matrix and bias.
+//  - proj_clip: if > 0, clip the output of the projection.
+//  - output_state: output vector, size n_batch*n_output. Must be contigous.
+//  - asymmetric_quantize_inputs: parameter to control quantization.
+//  - projection_weights_row_sums, compute_row_sums, context: Data for optimized
+//      MatrixBatchVectorMultiplyAccumulate.
+//  - scratch0: scratch area of size n_batch*n_cell
+//  - scratch1: scratch area of size n_batch*n_cell
+//  - scratch2: scratch area of size n_batch
+//  - scratch3: scratch area of size n_batch
+//  - scratch4: scratch area used by MatrixBatchVectorMultiplyAccumulate
+void CalculateLstmOutputHybrid(
+    int n_batch, int n_cell, int n_output, const float* cell_state,
+    const float* output_gate, TfLiteFusedActivation activation,
+    const int8_t* projection_weights, const uint8_t* projection_weights_ledger,
+    float projection_weights_scale, const float* projection_bias,
+    const float proj_clip, float* output_state, bool asymmetric_quantize_inputs,
+    int32_t* projection_weights_row_sums, bool* compute_row_sums,
+    CpuBackendContext* context, float* scratch0, int8_t* scratch1,
+    float* scratch2, int32_t* scratch3, int32_t* scratch4) {
+  tensor_utils::ApplyActivationToVector(cell_state, n_batch * n_cell,
+                                        activation, scratch0);
+  tensor_utils::VectorVectorCwiseProduct(output_gate, scratch0,
+                                         n_batch * n_cell, scratch0);
+  ProjectLstmOutputHybrid(
+      n_batch, n_cell, n_output, scratch0, projection_weights,
+      projection_weights_ledger, projection_weights_scale, projection_bias,
+      proj_clip, output_state, asymmetric_quantize_inputs,
+      projection_weights_row_sums, compute_row_sums, context, scratch1,
+      scratch2, scratch3, scratch4);
+}
+
 // Calculates a single LSTM gate, int8x8_16 version.
 // Implements the same functionality as CalculateLstmGateFloat.
 void CalculateLstmGateInteger8x8_16(
@@ -661,6 +709,35 @@ void UpdateLstmCellInteger(int n_batch, int n_cell, int16_t* cell_state,
   }
 }
 
+// Projects the output of an LSTM step to the output state, int8x8_16
+// version. The hidden state must be quantized with a zero point of -hidden_zp.
+//
+// Parameters:
+//  - hidden: input vector, size n_batch*n_cell.
+//  - projection_weights, proj_scale_[a|b], projection_bias:
+//      constant inputs, describing projection matrix and bias.
+//  - output_state_zp: zero point of output_state.
+//  - quantized_proj_clip: if > 0, clip the output of the projection.
+//  - output_state: output vector, size n_batch*n_output. Must be contigous.
+//  - scratch: scratch area used by MatrixBatchVectorMultiplyAccumulate
+void ProjectLstmOutputInteger8x8_16(
+    int n_batch, int n_cell, int n_output, const int8_t* hidden,
+    const int8_t* projection_weights, int32_t proj_scale_a,
+    int32_t proj_scale_b, const int32_t* projection_bias,
+    int32_t output_state_zp, int8_t quantized_proj_clip, int8_t* output_state,
+    CpuBackendContext* context, int32_t* scratch) {
+  // Note: no bias like in float/hybrid
+  std::fill_n(output_state, n_batch * n_output, 0);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      hidden, projection_bias, projection_weights, proj_scale_a, proj_scale_b,
+      n_batch, n_cell, n_output, output_state_zp, scratch, output_state,
+      context);
+  if (quantized_proj_clip > 0) {
+    tensor_utils::CwiseClipping(output_state, n_batch * n_output,
+                                quantized_proj_clip);
+  }
+}
+
 // Calculates the output state tensor of an LSTM step. See Float and hybrid
 // versions as well.
 //
@@ -699,16 +776,10 @@ void CalculateLstmOutputInteger8x8_16(
     tensor_utils::CwiseMul(output_gate, scratch0, hidden_scale_a,
                            hidden_scale_b, n_batch, n_cell, -hidden_zp,
                            scratch1);
-    // Note: no bias like in float/hybrid
-    std::fill_n(output_state, n_batch * n_output, 0);
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        scratch1, projection_bias, projection_weights, proj_scale_a,
-        proj_scale_b, n_batch, n_cell, n_output, output_state_zp, scratch2,
-        output_state, context);
-    if (quantized_proj_clip > 0) {
-      tensor_utils::CwiseClipping(output_state, n_batch * n_output,
-                                  quantized_proj_clip);
-    }
+    ProjectLstmOutputInteger8x8_16(
+        n_batch, n_cell, n_output, scratch1, projection_weights, proj_scale_a,
+        proj_scale_b, projection_bias, output_state_zp, quantized_proj_clip,
+        output_state, context, scratch2);
   } else {
     tensor_utils::CwiseMul(output_gate, scratch0, hidden_scale_a,
                            hidden_scale_b, n_batch, n_cell, hidden_zp,
@@ -716,6 +787,263 @@ void CalculateLstmOutputInteger8x8_16(
   }
 }
 
+// Fused LSTM step kernels.
+//
+// For small batches, the gate buffers of a step are larger than the work done
+// per element, and the unfused step makes a pass over them for each gate
+// matmul, activation and elementwise product. The fused step instead computes
+// the four gates for a block of cells, as matmuls of the rows of the block of
+// each gate weight matrix, and then updates the cell and hidden state of the
+// block while its gates are still in the L1 cache. The block of each gate is
+// stored at gate_scratch + row_start * n_batch, laid out as
+// [n_batch][n_rows].
+//
+// The whole gate vector is needed for layer normalization, so the fused step is
+// only used without layer norm, and without peephole, diagonal recurrent or
+// sparse weights.
+
+// Number of cells of a block of the fused LSTM step.
+constexpr int kFusedLstmBlockCells = 64;
+// Largest batch of the fused LSTM step. Larger batches reuse the weights for
+// more vectors with full size matmuls.
+constexpr int kFusedLstmMaxBatch = 4;
+
+// Returns the number of rows of the block of cells starting at row_start.
+inline int FusedLstmBlockRows(int row_start, int n_cell) {
+  return std::min(kFusedLstmBlockCells, n_cell - row_start);
+}
+
+// Calculates the block of rows [row_start, row_start + n_rows) of a single
+// LSTM gate, for the fused LSTM step. See CalculateLstmGateFloat.
+//
+// The weights are row-major, so the rows of a block are contiguous.
+// Output vector:
+//   gate                      | n_batch * n_rows     |
+void CalculateLstmGateBlockFloat(
+    const float* input, const float* input_to_gate_weights,
+    const float* aux_input, const float* aux_input_to_gate_weights,
+    const float* output_state, const float* recurrent_to_gate_weights,
+    const float* gate_bias, const int row_start, const int n_rows,
+    const int n_batch, const int n_input, const int n_aux_input,
+    const int n_output, const TfLiteFusedActivation activation, float* gate,
+    const bool is_input_all_zeros, const bool is_aux_input_all_zeros) {
+  for (int b = 0; b < n_batch; ++b) {
+    std::copy_n(gate_bias + row_start, n_rows, gate + b * n_rows);
+  }
+  if (!is_input_all_zeros) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_gate_weights + row_start * n_input, n_rows, n_input, input,
+        n_batch, gate);
+  }
+  if (!is_aux_input_all_zeros) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        aux_input_to_gate_weights + row_start * n_aux_input, n_rows,
+        n_aux_input, aux_input, n_batch, gate);
+  }
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      recurrent_to_gate_weights + row_start * n_output, n_rows, n_output,
+      output_state, n_batch, gate);
+  tensor_utils::ApplyActivationToVector(gate, n_batch * n_rows, activation,
+                                        gate);
+}
+
+// Calculates the block of rows [row_start, row_start + n_rows) of a single
+// LSTM gate, hybrid version. See CalculateLstmGateBlockFloat and
+// CalculateLstmGateHybrid.
+void CalculateLstmGateBlockHybrid(
+    // Input and weights
+    const int8_t* input, const float* input_sf, const int32_t* input_zp,
+    const int8_t* input_to_gate_weights,
+    const float input_to_gate_weights_scale, int32_t* input_to_gate_row_sums,
+    // Aux input and weights
+    const int8_t* aux_input, const float* aux_input_sf,
+    const int32_t* aux_input_zp, const int8_t* aux_input_to_gate_weights,
+    const float aux_input_to_gate_weights_scale,
+    int32_t* aux_input_to_gate_row_sums,
+    // Output state and weights
+    const int8_t* output_state, const float* output_state_sf,
+    const int32_t* output_state_zp, const int8_t* recurrent_to_gate_weights,
+    const float recurrent_to_gate_weights_scale,
+    int32_t* recurrent_to_gate_row_sums,
+    // Gate bias
+    const float* gate_bias,
+    // Array sizes
+    const int row_start, const int n_rows, const int n_batch,
+    const int n_input, const int n_aux_input, const int n_output,
+    const TfLiteFusedActivation activation,
+    // Output
+    float* gate,
+    // Parameters for performance optimizations
+    const bool is_input_all_zeros, const bool is_aux_input_all_zeros,
+    const bool is_output_state_all_zeros, bool* compute_row_sums,
+    CpuBackendContext* context,
+    // Scratch arrays
+    float* scratch0,  // size: n_batch
+    int32_t* accum_scratch) {
+  // The row sums are only used, and computed before the step, with
+  // asymmetrically quantized inputs.
+  auto block_row_sums = [row_start](int32_t* row_sums) {
+    return row_sums == nullptr ? nullptr : row_sums + row_start;
+  };
+  for (int b = 0; b < n_batch; ++b) {
+    std::copy_n(gate_bias + row_start, n_rows, gate + b * n_rows);
+  }
+  if (!is_input_all_zeros) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_gate_weights + row_start * n_input, n_rows, n_input, input,
+        input_to_gate_weights_scale, input_sf, n_batch, gate,
+        /*per_channel_scale=*/nullptr, input_zp, accum_scratch,
+        block_row_sums(input_to_gate_row_sums), compute_row_sums, scratch0,
+        context);
+  }
+  if (!is_aux_input_all_zeros) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        aux_input_to_gate_weights + row_start * n_aux_input, n_rows,
+        n_aux_input, aux_input, aux_input_to_gate_weights_scale, aux_input_sf,
+        n_batch, gate, /*per_channel_scale=*/nullptr, aux_input_zp,
+        accum_scratch, block_row_sums(aux_input_to_gate_row_sums),
+        compute_row_sums, scratch0, context);
+  }
+  if (!is_output_state_all_zeros) {
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        recurrent_to_gate_weights + row_start * n_output, n_rows, n_output,
+        output_state, recurrent_to_gate_weights_scale, output_state_sf,
+        n_batch, gate, /*per_channel_scale=*/nullptr, output_state_zp,
+        accum_scratch, block_row_sums(recurrent_to_gate_row_sums),
+        compute_row_sums, scratch0, context);
+  }
+  tensor_utils::ApplyActivationToVector(gate, n_batch * n_rows, activation,
+                                        gate);
+}
+
+// Updates the cell state and computes the hidden state, output_gate .*
+// activate(cell_state), of a block of cells of the fused LSTM step. Used by
+// both float and hybrid LSTM versions. See UpdateLstmCellFloat and
+// CalculateLstmOutputFloat.
+//
+// Parameters:
+//  - n_batch, n_cell, n_rows: sizes of vectors.
+//  - cell_state: input/output, the first cell of the block in the cell state
+//      of size n_batch*n_cell.
+//  - input_gate, forget_gate, output_gate: input vectors, size n_batch*n_rows.
+//  - cell_gate: input/scratch vector, size n_batch*n_rows.
+//  - use_cifg: use 1-forget_gate instead of input_gate.
+//  - clip: if > 0, clip the resulting cell state to [-clip, +clip].
+//  - hidden: output, the first cell of the block in the hidden state of size
+//      n_batch*n_cell.
+void UpdateLstmCellBlockFloat(int n_batch, int n_cell, int n_rows,
+                              float* cell_state, const float* input_gate,
+                              const float* forget_gate, float* cell_gate,
+                              const float* output_gate, bool use_cifg,
+                              float clip, TfLiteFusedActivation activation,
+                              float* hidden) {
+  for (int b = 0; b < n_batch; ++b) {
+    float* cell_state_row = cell_state + b * n_cell;
+    for (int i = b * n_rows, c = 0; c < n_rows; ++i, ++c) {
+      const float input_gate_value =
+          use_cifg ? 1.0f - forget_gate[i] : input_gate[i];
+      float cell = forget_gate[i] * cell_state_row[c] +
+                   input_gate_value * cell_gate[i];
+      if (clip > 0.0f) {
+        cell = std::min(std::max(cell, -clip), clip);
+      }
+      cell_state_row[c] = cell;
+      // The cell gate is not needed anymore, store the new cell state there to
+      // activate it in place.
+      cell_gate[i] = cell;
+    }
+  }
+  tensor_utils::ApplyActivationToVector(cell_gate, n_batch * n_rows,
+                                        activation, cell_gate);
+  for (int b = 0; b < n_batch; ++b) {
+    tensor_utils::VectorVectorCwiseProduct(output_gate + b * n_rows,
+                                           cell_gate + b * n_rows, n_rows,
+                                           hidden + b * n_cell);
+  }
+}
+
+// Calculates the block of rows [row_start, row_start + n_rows) of a single
+// LSTM gate, int8x8_16 version. See CalculateLstmGateBlockFloat and
+// CalculateLstmGateInteger8x8_16.
+void CalculateLstmGateBlockInteger8x8_16(
+    // Input and weights
+    const int8_t* input, const int8_t* input_to_gate_weights,
+    const int32_t* input_to_gate_bias, const int32_t input_to_gate_scale_a,
+    const int32_t input_to_gate_scale_b,
+    // Output state and weights
+    const int8_t* output_state, const int8_t* recurrent_to_gate_weights,
+    const int32_t* recurrent_to_gate_bias,
+    const int32_t recurrent_to_gate_scale_a,
+    const int32_t recurrent_to_gate_scale_b,
+    // Array sizes
+    const int row_start, const int n_rows, const int n_batch,
+    const int n_input, const int n_output,
+    const TfLiteFusedActivation activation,
+    // Output
+    int16_t* gate,
+    // Parameters for performance optimizations
+    CpuBackendContext* context,
+    // Scratch arrays
+    int32_t* scratch5) {
+  std::fill_n(gate, n_batch * n_rows, 0);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      input, input_to_gate_bias + row_start,
+      input_to_gate_weights + row_start * n_input, input_to_gate_scale_a,
+      input_to_gate_scale_b, n_batch, n_input, n_rows, 0, scratch5, gate,
+      context);
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      output_state, recurrent_to_gate_bias + row_start,
+      recurrent_to_gate_weights + row_start * n_output,
+      recurrent_to_gate_scale_a, recurrent_to_gate_scale_b, n_batch, n_output,
+      n_rows, 0, scratch5, gate, context);
+  switch (activation) {
+    case kTfLiteActSigmoid:
+      tensor_utils::ApplySigmoid(gate, n_batch, n_rows, gate);
+      break;
+    case kTfLiteActTanh:
+      tensor_utils::ApplyTanh(3, gate, n_batch, n_rows, gate);
+      break;
+    default:
+      // Only Sigmoid or Tanh is used.
+      TFLITE_ASSERT_FALSE;
+  }
+}
+
+// Updates the cell state and computes the hidden state of a block of cells of
+// the fused LSTM step, int8x8_16 version. See UpdateLstmCellBlockFloat,
+// UpdateLstmCellInteger and CalculateLstmOutputInteger8x8_16.
+//
+// Parameters:
+//  - cell_state: input/output, the first cell of the block in the cell state
+//      of size n_batch*n_cell.
+//  - input_gate, output_gate: input vectors, size n_batch*n_rows.
+//  - forget_gate, cell_gate: input/scratch vectors, size n_batch*n_rows.
+//  - hidden_zp: zero point of hidden, -hidden_zp if the hidden state is
+//      projected.
+//  - hidden: output, the first cell of the block in the hidden state of size
+//      n_batch*n_cell.
+void UpdateLstmCellBlockInteger8x8_16(
+    int n_batch, int n_cell, int n_rows, int16_t* cell_state,
+    int32_t cell_state_scale, const int16_t* input_gate, int16_t* forget_gate,
+    int16_t* cell_gate, const int16_t* output_gate, bool use_cifg,
+    int16_t clip, int32_t hidden_scale_a, int32_t hidden_scale_b,
+    int32_t hidden_zp, int8_t* hidden) {
+  for (int b = 0; b < n_batch; ++b) {
+    int16_t* cell_state_row = cell_state + b * n_cell;
+    int16_t* cell_gate_row = cell_gate + b * n_rows;
+    UpdateLstmCellInteger(
+        /*n_batch=*/1, n_rows, cell_state_row, cell_state_scale,
+        use_cifg ? nullptr : input_gate + b * n_rows, forget_gate + b * n_rows,
+        cell_gate_row, use_cifg, clip);
+    // Note: unlike float/hybrid, the activation is always Tanh.
+    tensor_utils::ApplyTanh(15 + cell_state_scale, cell_state_row,
+                            /*n_batch=*/1, n_rows, cell_gate_row);
+    tensor_utils::CwiseMul(output_gate + b * n_rows, cell_gate_row,
+                           hidden_scale_a, hidden_scale_b, /*n_batch=*/1,
+                           n_rows, hidden_zp, hidden + b * n_cell);
+  }
+}
+
 // Calculates a single LSTM gate, int8x8_8 version.
 // Implements the same functionality as CalculateLstmGateFloat.
 void CalculateLstmGateInteger8x8_8(
@@ -925,6 +1253,77 @@ inline void LstmStepFloat(
       (aux_input_ptr == nullptr ||
        tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input));
 
+  const bool use_fused_step =
+      n_batch <= kFusedLstmMaxBatch &&
+      input_layer_norm_coefficients_ptr == nullptr &&
+      forget_layer_norm_coefficients_ptr == nullptr &&
+      cell_layer_norm_coefficients_ptr == nullptr &&
+      output_layer_norm_coefficients_ptr == nullptr &&
+      cell_to_forget_weights_ptr == nullptr &&
+      cell_to_output_weights_ptr == nullptr &&
+      (use_cifg || cell_to_input_weights_ptr == nullptr) &&
+      !recurrent_to_input_is_diag && !recurrent_to_forget_is_diag &&
+      !recurrent_to_cell_is_diag && !recurrent_to_output_is_diag;
+  if (use_fused_step) {
+    // The output state is read by every block, so the hidden state is stored
+    // in the accumulation scratch buffer until the last block is done.
+    float* hidden = accumulation_scratch_buffer;
+    for (int row_start = 0; row_start < n_cell;
+         row_start += kFusedLstmBlockCells) {
+      const int n_rows = FusedLstmBlockRows(row_start, n_cell);
+      const int block_offset = row_start * n_batch;
+      float* input_gate =
+          use_cifg ? nullptr : input_gate_scratch + block_offset;
+      float* forget_gate = forget_gate_scratch + block_offset;
+      float* cell_gate = cell_gate_scratch + block_offset;
+      float* output_gate = output_gate_scratch + block_offset;
+      if (!use_cifg) {
+        CalculateLstmGateBlockFloat(
+            input_ptr, input_to_input_weights_ptr, aux_input_ptr,
+            aux_input_to_input_weights_ptr, output_state_ptr,
+            recurrent_to_input_weights_ptr, input_gate_bias_ptr, row_start,
+            n_rows, n_batch, n_input, n_aux_input, n_output,
+            /*activation=*/kTfLiteActSigmoid, input_gate, is_input_all_zeros,
+            is_aux_input_all_zeros);
+      }
+      CalculateLstmGateBlockFloat(
+          input_ptr, input_to_forget_weights_ptr, aux_input_ptr,
+          aux_input_to_forget_weights_ptr, output_state_ptr,
+          recurrent_to_forget_weights_ptr, forget_gate_bias_ptr, row_start,
+          n_rows, n_batch, n_input, n_aux_input, n_output,
+          /*activation=*/kTfLiteActSigmoid, forget_gate, is_input_all_zeros,
+          is_aux_input_all_zeros);
+      CalculateLstmGateBlockFloat(
+          input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
+          aux_input_to_cell_weights_ptr, output_state_ptr,
+          recurrent_to_cell_weights_ptr, cell_gate_bias_ptr, row_start, n_rows,
+          n_batch, n_input, n_aux_input, n_output, params->activation,
+          cell_gate, is_input_all_zeros, is_aux_input_all_zeros);
+      CalculateLstmGateBlockFloat(
+          input_ptr, input_to_output_weights_ptr, aux_input_ptr,
+          aux_input_to_output_weights_ptr, output_state_ptr,
+          recurrent_to_output_weights_ptr, output_gate_bias_ptr, row_start,
+          n_rows, n_batch, n_input, n_aux_input, n_output,
+          /*activation=*/kTfLiteActSigmoid, output_gate, is_input_all_zeros,
+          is_aux_input_all_zeros);
+      UpdateLstmCellBlockFloat(n_batch, n_cell, n_rows,
+                               cell_state_ptr + row_start, input_gate,
+                               forget_gate, cell_gate, output_gate, use_cifg,
+                               params->cell_clip, params->activation,
+                               hidden + row_start);
+    }
+    // The cell gate scratch buffer is free after the last block.
+    ProjectLstmOutputFloat(n_batch, n_cell, n_output, hidden,
+                           projection_weights_ptr, projection_bias_ptr,
+                           params->proj_clip, output_state_ptr,
+                           cell_gate_scratch, context);
+    for (int b = 0; b < n_batch; b++) {
+      std::copy_n(output_state_ptr + b * n_output, n_output,
+                  output_ptr + b * output_batch_leading_dim);
+    }
+    return;
+  }
+
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
     CalculateLstmGateFloat(
@@ -1056,6 +1455,8 @@ inline void LstmStepFloat(
 //   quantized_input_ptr (same size as input_ptr)
 //   quantized_output_state_ptr (same size as output_state_ptr)
 //   quantized_output_scratch (same size as cell_state_ptr)
+// Temporary pre-allocated storage for the hidden state of the fused step:
+//   scratch4 (same size as cell_state_ptr)
 // Temporary pre-allocated storage for recovered values:
 //   recovered_cell_weights (same size as cell_to_*_weights)
 //
@@ -1117,7 +1518,8 @@ inline void LstmStepHybrid(
     const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
     int n_aux_input, int n_output, int output_batch_leading_dim,
     float* scratch0, float* scratch1, float* scratch2, float* scratch3,
-    float* input_sf, float* aux_input_sf, float* output_state_sf,
+    float* scratch4, float* input_sf, float* aux_input_sf,
+    float* output_state_sf,
     float* scaling_factors_scratch, float* recovered_cell_weights,
     int8_t* quantized_input_ptr, int8_t* quantized_aux_input_ptr,
     int8_t* quantized_output_state_ptr, int8_t* quantized_output_scratch,
@@ -1231,6 +1633,112 @@ inline void LstmStepHybrid(
         output_state_ptr, n_batch, n_output, quantized_output_state_ptr,
         output_state_sf, output_state_zp, asymmetric_quantize_inputs);
   }
+
+  const bool use_fused_step =
+      n_batch <= kFusedLstmMaxBatch &&
+      input_layer_norm_coefficients_ptr == nullptr &&
+      forget_layer_norm_coefficients_ptr == nullptr &&
+      cell_layer_norm_coefficients_ptr == nullptr &&
+      output_layer_norm_coefficients_ptr == nullptr &&
+      cell_to_forget_weights_ptr == nullptr &&
+      cell_to_output_weights_ptr == nullptr &&
+      (use_cifg || cell_to_input_weights_ptr == nullptr) &&
+      input_to_forget_weights_ledger_ptr == nullptr &&
+      input_to_cell_weights_ledger_ptr == nullptr &&
+      input_to_output_weights_ledger_ptr == nullptr &&
+      (use_cifg || input_to_input_weights_ledger_ptr == nullptr) &&
+      recurrent_to_forget_weights_ledger_ptr == nullptr &&
+      recurrent_to_cell_weights_ledger_ptr == nullptr &&
+      recurrent_to_output_weights_ledger_ptr == nullptr &&
+      (use_cifg || recurrent_to_input_weights_ledger_ptr == nullptr) &&
+      !recurrent_to_input_is_diag && !recurrent_to_forget_is_diag &&
+      !recurrent_to_cell_is_diag && !recurrent_to_output_is_diag;
+  if (use_fused_step) {
+    // The recurrent matmuls read the quantized output state, but the hidden
+    // state is stored in scratch4 as the projection may change its size.
+    float* hidden = scratch4;
+    for (int row_start = 0; row_start < n_cell;
+         row_start += kFusedLstmBlockCells) {
+      const int n_rows = FusedLstmBlockRows(row_start, n_cell);
+      const int block_offset = row_start * n_batch;
+      float* input_gate =
+          use_cifg ? nullptr : input_gate_scratch + block_offset;
+      float* forget_gate = forget_gate_scratch + block_offset;
+      float* cell_gate = cell_gate_scratch + block_offset;
+      float* output_gate = output_gate_scratch + block_offset;
+      if (!use_cifg) {
+        CalculateLstmGateBlockHybrid(
+            quantized_input_ptr, input_sf, input_zp,
+            input_to_input_weights_ptr, input_to_input_weights_scale,
+            input_to_input_row_sums, quantized_aux_input_ptr, aux_input_sf,
+            aux_input_zp, aux_input_to_input_weights_ptr,
+            aux_input_to_input_weights_scale, aux_input_to_input_row_sums,
+            quantized_output_state_ptr, output_state_sf, output_state_zp,
+            recurrent_to_input_weights_ptr, recurrent_to_input_weights_scale,
+            recurrent_to_input_row_sums, input_gate_bias_ptr, row_start,
+            n_rows, n_batch, n_input, n_aux_input, n_output, kTfLiteActSigmoid,
+            input_gate, is_input_all_zeros, is_aux_input_all_zeros,
+            is_output_state_all_zeros, compute_row_sums, context,
+            scaling_factors_scratch, accum_scratch_ptr);
+      }
+      CalculateLstmGateBlockHybrid(
+          quantized_input_ptr, input_sf, input_zp, input_to_forget_weights_ptr,
+          input_to_forget_weights_scale, input_to_forget_row_sums,
+          quantized_aux_input_ptr, aux_input_sf, aux_input_zp,
+          aux_input_to_forget_weights_ptr, aux_input_to_forget_weights_scale,
+          aux_input_to_forget_row_sums, quantized_output_state_ptr,
+          output_state_sf, output_state_zp, recurrent_to_forget_weights_ptr,
+          recurrent_to_forget_weights_scale, recurrent_to_forget_row_sums,
+          forget_gate_bias_ptr, row_start, n_rows, n_batch, n_input,
+          n_aux_input, n_output, kTfLiteActSigmoid, forget_gate,
+          is_input_all_zeros, is_aux_input_all_zeros,
+          is_output_state_all_zeros, compute_row_sums, context,
+          scaling_factors_scratch, accum_scratch_ptr);
+      CalculateLstmGateBlockHybrid(
+          quantized_input_ptr, input_sf, input_zp, input_to_cell_weights_ptr,
+          input_to_cell_weights_scale, input_to_cell_row_sums,
+          quantized_aux_input_ptr, aux_input_sf, aux_input_zp,
+          aux_input_to_cell_weights_ptr, aux_input_to_cell_weights_scale,
+          aux_input_to_cell_row_sums, quantized_output_state_ptr,
+          output_state_sf, output_state_zp, recurrent_to_cell_weights_ptr,
+          recurrent_to_cell_weights_scale, recurrent_to_cell_row_sums,
+          cell_gate_bias_ptr, row_start, n_rows, n_batch, n_input, n_aux_input,
+          n_output, params->activation, cell_gate, is_input_all_zeros,
+          is_aux_input_all_zeros, is_output_state_all_zeros, compute_row_sums,
+          context, scaling_factors_scratch, accum_scratch_ptr);
+      CalculateLstmGateBlockHybrid(
+          quantized_input_ptr, input_sf, input_zp, input_to_output_weights_ptr,
+          input_to_output_weights_scale, input_to_output_row_sums,
+          quantized_aux_input_ptr, aux_input_sf, aux_input_zp,
+          aux_input_to_output_weights_ptr, aux_input_to_output_weights_scale,
+          aux_input_to_output_row_sums, quantized_output_state_ptr,
+          output_state_sf, output_state_zp, recurrent_to_output_weights_ptr,
+          recurrent_to_output_weights_scale, recurrent_to_output_row_sums,
+          output_gate_bias_ptr, row_start, n_rows, n_batch, n_input,
+          n_aux_input, n_output, kTfLiteActSigmoid, output_gate,
+          is_input_all_zeros, is_aux_input_all_zeros,
+          is_output_state_all_zeros, compute_row_sums, context,
+          scaling_factors_scratch, accum_scratch_ptr);
+      UpdateLstmCellBlockFloat(n_batch, n_cell, n_rows,
+                               cell_state_ptr + row_start, input_gate,
+                               forget_gate, cell_gate, output_gate, use_cifg,
+                               params->cell_clip, params->activation,
+                               hidden + row_start);
+    }
+    ProjectLstmOutputHybrid(
+        n_batch, n_cell, n_output, hidden, projection_weights_ptr,
+        projection_weights_ledger_ptr, projection_weights_scale,
+        projection_bias_ptr, params->proj_clip, output_state_ptr,
+        asymmetric_quantize_inputs, projection_weights_row_sums,
+        compute_row_sums, context, quantized_output_scratch, input_sf,
+        input_zp, accum_scratch_ptr);
+    for (int b = 0; b < n_batch; b++) {
+      std::copy_n(output_state_ptr + b * n_output, n_output,
+                  output_ptr + b * output_batch_leading_dim);
+    }
+    return;
+  }
+
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
     CalculateLstmGateHybrid(
@@ -1507,6 +2015,85 @@ inline void LstmStepInteger8x8_16(
   if (use_projection) {
     TFLITE_DCHECK(projection_effective_bias);
   }
+
+  const bool use_fused_step =
+      n_batch <= kFusedLstmMaxBatch &&
+      layer_norm_input_weight_ptr == nullptr &&
+      layer_norm_forget_weight_ptr == nullptr &&
+      layer_norm_cell_weight_ptr == nullptr &&
+      layer_norm_output_weight_ptr == nullptr &&
+      cell_to_forget_weight_ptr == nullptr &&
+      cell_to_output_weight_ptr == nullptr &&
+      (use_cifg || cell_to_input_weight_ptr == nullptr);
+  if (use_fused_step) {
+    // The output state is read by every block, so the hidden state is stored
+    // in scratch4 until the last block is done.
+    int8_t* hidden = scratch4;
+    for (int row_start = 0; row_start < n_cell;
+         row_start += kFusedLstmBlockCells) {
+      const int n_rows = FusedLstmBlockRows(row_start, n_cell);
+      const int block_offset = row_start * n_batch;
+      int16_t* input_gate = input_gate_scratch + block_offset;
+      int16_t* forget_gate = forget_gate_scratch + block_offset;
+      int16_t* cell_gate = cell_gate_scratch + block_offset;
+      int16_t* output_gate = output_gate_scratch + block_offset;
+      if (!use_cifg) {
+        CalculateLstmGateBlockInteger8x8_16(
+            input_ptr, input_to_input_weight_ptr, input_to_input_effective_bias,
+            effective_input_to_input_scale_a, effective_input_to_input_scale_b,
+            output_state_ptr, recurrent_to_input_weight_ptr,
+            recurrent_to_input_effective_bias,
+            effective_recurrent_to_input_scale_a,
+            effective_recurrent_to_input_scale_b, row_start, n_rows, n_batch,
+            n_input, n_output, kTfLiteActSigmoid, input_gate, context,
+            scratch5);
+      }
+      CalculateLstmGateBlockInteger8x8_16(
+          input_ptr, input_to_forget_weight_ptr, input_to_forget_effective_bias,
+          effective_input_to_forget_scale_a, effective_input_to_forget_scale_b,
+          output_state_ptr, recurrent_to_forget_weight_ptr,
+          recurrent_to_forget_effective_bias,
+          effective_recurrent_to_forget_scale_a,
+          effective_recurrent_to_forget_scale_b, row_start, n_rows, n_batch,
+          n_input, n_output, kTfLiteActSigmoid, forget_gate, context,
+          scratch5);
+      CalculateLstmGateBlockInteger8x8_16(
+          input_ptr, input_to_cell_weight_ptr, input_to_cell_effective_bias,
+          effective_input_to_cell_scale_a, effective_input_to_cell_scale_b,
+          output_state_ptr, recurrent_to_cell_weight_ptr,
+          recurrent_to_cell_effective_bias, effective_recurrent_to_cell_scale_a,
+          effective_recurrent_to_cell_scale_b, row_start, n_rows, n_batch,
+          n_input, n_output, kTfLiteActTanh, cell_gate, context, scratch5);
+      CalculateLstmGateBlockInteger8x8_16(
+          input_ptr, input_to_output_weight_ptr, input_to_output_effective_bias,
+          effective_input_to_output_scale_a, effective_input_to_output_scale_b,
+          output_state_ptr, recurrent_to_output_weight_ptr,
+          recurrent_to_output_effective_bias,
+          effective_recurrent_to_output_scale_a,
+          effective_recurrent_to_output_scale_b, row_start, n_rows, n_batch,
+          n_input, n_output, kTfLiteActSigmoid, output_gate, context,
+          scratch5);
+      // b/246629213 the projection operation assumes -hidden_zp in CwiseMul
+      UpdateLstmCellBlockInteger8x8_16(
+          n_batch, n_cell, n_rows, cell_state_ptr + row_start,
+          cell_state_scale, input_gate, forget_gate, cell_gate, output_gate,
+          use_cifg, quantized_cell_clip, effective_hidden_scale_a,
+          effective_hidden_scale_b, use_projection ? -hidden_zp : hidden_zp,
+          hidden + row_start);
+    }
+    if (use_projection) {
+      ProjectLstmOutputInteger8x8_16(
+          n_batch, n_cell, n_output, hidden, projection_weight_ptr,
+          effective_proj_scale_a, effective_proj_scale_b,
+          projection_effective_bias, output_state_zp, quantized_proj_clip,
+          output_state_ptr, context, scratch5);
+    } else {
+      std::copy_n(hidden, n_batch * n_output, output_state_ptr);
+    }
+    std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
+    return;
+  }
+
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
     CalculateLstmGateInteger8x8_16(
@@ -2058,15 +2645,18 @@ TfLiteStatus EvalHybrid(
   float* cell_gate_scratch = nullptr;
   float* forget_gate_scratch = nullptr;
   float* output_gate_scratch = nullptr;
+  float* hidden_scratch = nullptr;
   if (use_cifg) {
     cell_gate_scratch = scratch_buffer_ptr;
     forget_gate_scratch = scratch_buffer_ptr + n_cell * n_batch;
     output_gate_scratch = scratch_buffer_ptr + 2 * n_cell * n_batch;
+    hidden_scratch = scratch_buffer_ptr + 3 * n_cell * n_batch;
   } else {
     input_gate_scratch = scratch_buffer_ptr;
     cell_gate_scratch = scratch_buffer_ptr + n_cell * n_batch;
     forget_gate_scratch = scratch_buffer_ptr + 2 * n_cell * n_batch;
     output_gate_scratch = scratch_buffer_ptr + 3 * n_cell * n_batch;
+    hidden_scratch = scratch_buffer_ptr + 4 * n_cell * n_batch;
   }
 
   const int output_batch_leading_dim =
@@ -2155,7 +2745,7 @@ TfLiteStatus EvalHybrid(
           GetTensorData<float>(projection_bias), params, n_batch, n_cell,
           n_input, aux_input_size, n_output, output_batch_leading_dim,
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
-          output_gate_scratch, GetTensorData<float>(input_sf),
+          output_gate_scratch, hidden_scratch, GetTensorData<float>(input_sf),
           GetTensorData<float>(aux_input_sf),
           GetTensorData<float>(output_state_sf),
           GetTensorData<float>(prod_scaling_factors),
@@ -2259,7 +2849,8 @@ TfLiteStatus EvalHybrid(
             /*n_batch=*/1, n_cell, n_input, aux_input_size, n_output,
             output_batch_leading_dim, input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
-            output_gate_scratch_ptr, GetTensorData<float>(input_sf),
+            output_gate_scratch_ptr, hidden_scratch,
+            GetTensorData<float>(input_sf),
             GetTensorData<float>(aux_input_sf),
             GetTensorData<float>(output_state_sf),
             GetTensorData<float>(prod_scaling_factors),
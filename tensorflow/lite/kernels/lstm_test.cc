@@ -19,6 +19,8 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <cmath>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -1309,6 +1311,79 @@ TEST_P(LstmOpTest, Cifg_Peephole_Projection_LayerNorm) {
   VerifyGoldens(&lstm, tolerance_per_type->at(weight_type));
 }
 
+// With a single batch the kernel runs the fused step, which computes the gates
+// a block of cells at a time. Checks it against the regular step, run on a
+// larger batch of copies of the same input, with a cell count that does not
+// divide into whole blocks.
+TEST_P(LstmOpTest, NoCifg_NoPeephole_Projection_NoLayerNorm_FusedStep) {
+  const int n_input = 3;
+  const int n_cell = 100;
+  const int n_output = 24;
+  const int n_steps = 3;
+  const int n_reference_batch = 5;
+
+  TensorType weight_type;
+  bool model_has_legacy_20_inputs;
+  bool asymmetric_quantize_inputs;
+  std::tie(weight_type, model_has_legacy_20_inputs,
+           asymmetric_quantize_inputs) = GetParam();
+
+  // TODO(b/158205028): Fix this test if using NN-API.
+  if (SingleOpModel::GetForceUseNnapi() && weight_type == TensorType_UINT8) {
+    return;
+  }
+
+  int seed = 0;
+  auto values = [&seed](int size, float scale) {
+    std::vector<float> result(size);
+    for (float& value : result) value = scale * std::sin(0.7f * ++seed);
+    return result;
+  };
+  input_to_input_weights_ = values(n_cell * n_input, 0.5f);
+  input_to_forget_weights_ = values(n_cell * n_input, 0.5f);
+  input_to_cell_weights_ = values(n_cell * n_input, 0.5f);
+  input_to_output_weights_ = values(n_cell * n_input, 0.5f);
+  recurrent_to_input_weights_ = values(n_cell * n_output, 0.2f);
+  recurrent_to_forget_weights_ = values(n_cell * n_output, 0.2f);
+  recurrent_to_cell_weights_ = values(n_cell * n_output, 0.2f);
+  recurrent_to_output_weights_ = values(n_cell * n_output, 0.2f);
+  input_gate_bias_ = values(n_cell, 0.1f);
+  forget_gate_bias_ = values(n_cell, 0.1f);
+  cell_gate_bias_ = values(n_cell, 0.1f);
+  output_gate_bias_ = values(n_cell, 0.1f);
+  projection_weights_ = values(n_output * n_cell, 0.1f);
+
+  std::vector<std::vector<float>> inputs;
+  for (int i = 0; i < n_steps; ++i) inputs.push_back(values(n_input, 1.0f));
+
+  LSTMOpModel reference(n_reference_batch, n_input, n_cell, n_output,
+                        /*use_cifg=*/false, /*use_peephole=*/false,
+                        /*use_projection_weights=*/true,
+                        /*use_projection_bias=*/false, weight_type,
+                        model_has_legacy_20_inputs,
+                        /*is_layer_norm=*/false, asymmetric_quantize_inputs);
+  SetAllWeightsAndBiases(&reference);
+  reference.ApplyDelegate();
+  for (const std::vector<float>& input : inputs) {
+    for (int b = 0; b < n_reference_batch; ++b) {
+      reference.SetInput(b * n_input, input.data(), input.data() + n_input);
+    }
+    ASSERT_EQ(reference.Invoke(), kTfLiteOk);
+    const std::vector<float> output = reference.GetOutput();
+    lstm_input_.push_back({input});
+    lstm_golden_output_.push_back(
+        {std::vector<float>(output.begin(), output.begin() + n_output)});
+  }
+
+  LSTMOpModel lstm(/*n_batch=*/1, n_input, n_cell, n_output,
+                   /*use_cifg=*/false, /*use_peephole=*/false,
+                   /*use_projection_weights=*/true,
+                   /*use_projection_bias=*/false, weight_type,
+                   model_has_legacy_20_inputs,
+                   /*is_layer_norm=*/false, asymmetric_quantize_inputs);
+  VerifyGoldens(&lstm, 1e-5f);
+}
+
 class LSTMIntegerOpModel : public SingleOpModel {
  public:
   LSTMIntegerOpModel(int n_batch, int n_input, int n_cell, int n_output,
@@ -2095,6 +2170,135 @@ TEST(IntegerLstmOpTest, Cifg_NoPeephole_Projection_LayerNorm_8x8_8) {
   }
 }
 
+// With a single batch the integer kernel runs the fused step, which computes
+// the gates a block of cells at a time. Checks that it matches the regular
+// step, run on a larger batch of copies of the same input, with a cell count
+// that does not divide into whole blocks.
+TEST(IntegerLstmOpTest, NoCifg_NoPeephole_Projection_NoLayerNorm_FusedStep) {
+  const int n_input = 3;
+  const int n_cell = 100;
+  const int n_output = 24;
+  const int n_steps = 3;
+  const int n_reference_batch = 5;
+
+  int seed = 0;
+  auto values = [&seed](int size, float scale) {
+    std::vector<float> result(size);
+    for (float& value : result) value = scale * std::sin(0.7f * ++seed);
+    return result;
+  };
+  const std::vector<float> input_to_input_weights =
+      values(n_cell * n_input, 0.5f);
+  const std::vector<float> input_to_forget_weights =
+      values(n_cell * n_input, 0.5f);
+  const std::vector<float> input_to_cell_weights =
+      values(n_cell * n_input, 0.5f);
+  const std::vector<float> input_to_output_weights =
+      values(n_cell * n_input, 0.5f);
+  const std::vector<float> recurrent_to_input_weights =
+      values(n_cell * n_output, 0.2f);
+  const std::vector<float> recurrent_to_forget_weights =
+      values(n_cell * n_output, 0.2f);
+  const std::vector<float> recurrent_to_cell_weights =
+      values(n_cell * n_output, 0.2f);
+  const std::vector<float> recurrent_to_output_weights =
+      values(n_cell * n_output, 0.2f);
+  const std::vector<float> input_gate_bias = values(n_cell, 0.1f);
+  const std::vector<float> forget_gate_bias = values(n_cell, 0.1f);
+  const std::vector<float> cell_gate_bias = values(n_cell, 0.1f);
+  const std::vector<float> output_gate_bias = values(n_cell, 0.1f);
+  const std::vector<float> projection_weights = values(n_output * n_cell, 0.1f);
+
+  // Input ranges.
+  const std::vector<std::pair<float, float>> ranges = {
+      {-1.0, 127.0 / 128},  // input tensor
+      {-1.0, 1.0},          // input_to_input_weight tensor
+      {-1.0, 1.0},          // input_to_forget_weight tensor
+      {-1.0, 1.0},          // input_to_cell_weight tensor
+      {-1.0, 1.0},          // input_to_output_weight tensor
+
+      {-1.0, 1.0},  // recurrent_to_input_weight tensor
+      {-1.0, 1.0},  // recurrent_to_forget_weight tensor
+      {-1.0, 1.0},  // recurrent_to_cell_weight tensor
+      {-1.0, 1.0},  // recurrent_to_output_weight tensor
+
+      {-1, 1},  // cell_to_input_weight tensor
+      {-1, 1},  // cell_to_forget_weight tensor
+      {-1, 1},  // cell_to_output_weight tensor
+
+      {-100, 100},  // input_gate_bias tensor
+      {-100, 100},  // forget_gate_bias tensor
+      {-100, 100},  // cell_gate_bias tensor
+      {-100, 100},  // output_gate_bias tensor
+
+      {-0.5, 0.5},  // projection_weight tensor
+      {-1, 1},      // projection_bias tensor
+
+      {-1.0, 32767.0 / 32768},  // output_state tensor
+      {-1, 1},                  // cell_state tensor
+
+      {-1.00001, 1.0},  // input_layer_norm_coefficient tensor
+      {-1.00001, 1.0},  // forget_layer_norm_coefficient tensor
+      {-1.00001, 1.0},  // cell_layer_norm_coefficient tensor
+      {-1.00001, 1.0},  // output_layer_norm_coefficient tensor
+      // Output scale is the same as output_state scale and only output_state
+      // scale is used in the op, so this is only provided for clarity.
+      {-1.0, 32767.0 / 32768},  // output tensor.
+  };
+
+  // The scale and zero point of intermediate tensors. Without layer norm,
+  // only the last one, the hidden state, is used.
+  std::vector<std::pair<float, int>> intermediates = {
+      {0.007059, 0}, {0.007812, 0}, {0.007059, 0}, {0.007812, 0}, {0.007, 0}};
+
+  auto create_model = [&](int n_batch) {
+    auto lstm = std::make_unique<LSTMIntegerOpModel>(
+        n_batch, n_input, n_cell, n_output,
+        /*use_cifg=*/false, /*use_peephole=*/false,
+        /*use_projection_weights=*/true,
+        /*use_projection_bias=*/false,
+        /*use_layer_norm=*/false,
+        /*use_8x8_8_implementation=*/false, ranges, intermediates);
+    lstm->PerformAllocateAndDelegate();
+    lstm->SetInputToInputWeights(input_to_input_weights);
+    lstm->SetInputToCellWeights(input_to_cell_weights);
+    lstm->SetInputToForgetWeights(input_to_forget_weights);
+    lstm->SetInputToOutputWeights(input_to_output_weights);
+    lstm->SetInputGateBias(input_gate_bias);
+    lstm->SetCellBias(cell_gate_bias);
+    lstm->SetForgetGateBias(forget_gate_bias);
+    lstm->SetOutputGateBias(output_gate_bias);
+    lstm->SetRecurrentToInputWeights(recurrent_to_input_weights);
+    lstm->SetRecurrentToCellWeights(recurrent_to_cell_weights);
+    lstm->SetRecurrentToForgetWeights(recurrent_to_forget_weights);
+    lstm->SetRecurrentToOutputWeights(recurrent_to_output_weights);
+    lstm->SetProjectionWeights(projection_weights);
+    return lstm;
+  };
+  std::unique_ptr<LSTMIntegerOpModel> reference =
+      create_model(n_reference_batch);
+  std::unique_ptr<LSTMIntegerOpModel> lstm = create_model(/*n_batch=*/1);
+
+  for (int i = 0; i < n_steps; ++i) {
+    const std::vector<float> input = values(n_input, 0.9f);
+    std::vector<float> reference_input;
+    for (int b = 0; b < n_reference_batch; ++b) {
+      reference_input.insert(reference_input.end(), input.begin(),
+                             input.end());
+    }
+    reference->SetInput(reference_input);
+    ASSERT_EQ(reference->Invoke(), kTfLiteOk);
+    const std::vector<int8_t> reference_output = reference->GetOutput();
+
+    lstm->SetInput(input);
+    ASSERT_EQ(lstm->Invoke(), kTfLiteOk);
+    // Both steps use the same integer arithmetic for each cell.
+    EXPECT_THAT(lstm->GetOutput(),
+                ElementsAreArray(reference_output.begin(),
+                                 reference_output.begin() + n_output));
+  }
+}
+
 #if GTEST_HAS_DEATH_TEST
 TEST(LstmOpTest, InvalidTypes) {
   const int n_batch = 1;
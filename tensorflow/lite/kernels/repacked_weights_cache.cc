@@ -0,0 +1,218 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/repacked_weights_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <string_view>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/interpreter_options.h"
+
+namespace tflite {
+namespace {
+
+template <typename T>
+void AppendValue(const T& value, std::string* key) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Two independent 64-bit hashes of the contents, so that weights that differ
+// are practically never given the same key.
+uint64_t Fnv1aHash(std::string_view bytes) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char c : bytes) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Hashes at most kNumSamples chunks of kSampleSize bytes spread over the
+// contents, including their first and last bytes.
+constexpr size_t kNumSamples = 16;
+constexpr size_t kSampleSize = 16;
+
+uint64_t SampleHash(std::string_view contents) {
+  if (contents.size() <= kNumSamples * kSampleSize) {
+    return Fnv1aHash(contents);
+  }
+  const size_t stride = (contents.size() - kSampleSize) / (kNumSamples - 1);
+  uint64_t hash = 0;
+  for (size_t i = 0; i < kNumSamples; ++i) {
+    hash = hash * 31 + Fnv1aHash(contents.substr(i * stride, kSampleSize));
+  }
+  return hash;
+}
+
+// The kind, type, shape and sizes that both keys start with.
+std::string MakeKeyPrefix(const char* kind, const TfLiteTensor& weights,
+                          size_t size) {
+  std::string key(kind);
+  key.push_back('\0');
+  AppendValue(weights.type, &key);
+  AppendValue(size, &key);
+  AppendValue(weights.bytes, &key);
+  const int num_dims = weights.dims ? weights.dims->size : 0;
+  AppendValue(num_dims, &key);
+  for (int i = 0; i < num_dims; ++i) {
+    AppendValue(weights.dims->data[i], &key);
+  }
+  return key;
+}
+
+// Identifies the weights by the model allocation they belong to and their
+// address, without reading them.
+std::string MakeIdentityKey(const char* kind, const TfLiteTensor& weights,
+                            size_t size) {
+  std::string key = MakeKeyPrefix(kind, weights, size);
+  AppendValue(weights.allocation, &key);
+  AppendValue(weights.data.raw_const, &key);
+  return key;
+}
+
+std::string MakeContentsKey(const char* kind, const TfLiteTensor& weights,
+                            size_t size) {
+  const std::string_view contents(weights.data.raw_const, weights.bytes);
+  std::string key = MakeKeyPrefix(kind, weights, size);
+  AppendValue(static_cast<uint64_t>(std::hash<std::string_view>()(contents)),
+              &key);
+  AppendValue(Fnv1aHash(contents), &key);
+  return key;
+}
+
+}  // namespace
+
+RepackedWeightsCache* RepackedWeightsCache::GetFromContext(
+    const TfLiteContext* context) {
+  if (context && context->impl_) {
+    const InterpreterOptions* options =
+        reinterpret_cast<Subgraph*>(context->impl_)->GetOptions();
+    if (options && options->GetShareRepackedWeights()) {
+      return Get();
+    }
+  }
+  return nullptr;
+}
+
+RepackedWeightsCache* RepackedWeightsCache::Get() {
+  // Never destroyed, as buffers may outlive static destruction.
+  static RepackedWeightsCache* const cache = new RepackedWeightsCache;
+  return cache;
+}
+
+std::shared_ptr<const RepackedWeightsCache::Buffer>
+RepackedWeightsCache::GetOrRepack(
+    const char* kind, const TfLiteTensor& weights, size_t size,
+    const std::function<void(uint8_t* data)>& repack) {
+  const std::string identity_key = MakeIdentityKey(kind, weights, size);
+  const uint64_t sample_hash =
+      SampleHash(std::string_view(weights.data.raw_const, weights.bytes));
+  if (std::shared_ptr<const Buffer> buffer =
+          FindByIdentity(identity_key, sample_hash)) {
+    return buffer;
+  }
+
+  const std::string key = MakeContentsKey(kind, weights, size);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_content_hashes_;
+    auto it = buffers_.find(key);
+    if (it != buffers_.end()) {
+      if (std::shared_ptr<const Buffer> buffer = it->second.buffer.lock()) {
+        AddIdentity(key, identity_key, sample_hash);
+        return buffer;
+      }
+    }
+  }
+
+  // Repack without holding the lock, as it may take a while. If another
+  // thread repacked the same weights meanwhile, its buffer is used instead.
+  auto* new_buffer = new Buffer(size);
+  repack(new_buffer->data());
+  std::shared_ptr<const Buffer> buffer(new_buffer,
+                                       [this, key](const Buffer* buffer) {
+                                         delete buffer;
+                                         Release(key);
+                                       });
+  std::lock_guard<std::mutex> lock(mutex_);
+  AddIdentity(key, identity_key, sample_hash);
+  Entry& entry = buffers_[key];
+  if (std::shared_ptr<const Buffer> existing = entry.buffer.lock()) {
+    return existing;
+  }
+  entry.buffer = buffer;
+  return buffer;
+}
+
+std::shared_ptr<const RepackedWeightsCache::Buffer>
+RepackedWeightsCache::FindByIdentity(const std::string& identity_key,
+                                     uint64_t sample_hash) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto identity = identities_.find(identity_key);
+  if (identity == identities_.end() ||
+      identity->second.sample_hash != sample_hash) {
+    return nullptr;
+  }
+  auto it = buffers_.find(identity->second.contents_key);
+  if (it == buffers_.end()) return nullptr;
+  return it->second.buffer.lock();
+}
+
+void RepackedWeightsCache::AddIdentity(const std::string& contents_key,
+                                       const std::string& identity_key,
+                                       uint64_t sample_hash) {
+  Identity& identity = identities_[identity_key];
+  identity.sample_hash = sample_hash;
+  if (identity.contents_key == contents_key) return;
+  identity.contents_key = contents_key;
+  buffers_[contents_key].identities.push_back(identity_key);
+}
+
+size_t RepackedWeightsCache::NumBuffers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t num_buffers = 0;
+  for (const auto& entry : buffers_) {
+    if (!entry.second.buffer.expired()) ++num_buffers;
+  }
+  return num_buffers;
+}
+
+size_t RepackedWeightsCache::NumContentHashes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_content_hashes_;
+}
+
+void RepackedWeightsCache::Release(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = buffers_.find(key);
+  if (it == buffers_.end() || !it->second.buffer.expired()) return;
+  // Forgets the identities of the weights, unless they were since found to
+  // have other contents.
+  for (const std::string& identity_key : it->second.identities) {
+    auto identity = identities_.find(identity_key);
+    if (identity != identities_.end() &&
+        identity->second.contents_key == key) {
+      identities_.erase(identity);
+    }
+  }
+  buffers_.erase(it);
+}
+
+}  // namespace tflite
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_REPACKED_WEIGHTS_CACHE_H_
+#define TENSORFLOW_LITE_KERNELS_REPACKED_WEIGHTS_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+
+// Buffers that kernels derive from constant weights during `Prepare`, e.g. a
+// transposed or unpacked filter. The cache is process-wide and keyed by the
+// contents of the weights, so that interpreters running the same model, on
+// any thread, hold a single copy of each buffer. A buffer is freed when the
+// last kernel using it releases it.
+//
+// Weights are first looked up by their identity: the model allocation they
+// belong to, their address and size. Their contents are only hashed when
+// their identity is not known yet, e.g. on the first `Prepare` of a model, so
+// that preparing again, or preparing another interpreter of the same model,
+// doesn't read the whole weights again.
+class RepackedWeightsCache {
+ public:
+  using Buffer = std::vector<uint8_t>;
+
+  // Returns the process-wide cache if the interpreter owning `context` shares
+  // repacked weights (see `InterpreterOptions::SetShareRepackedWeights`), and
+  // nullptr otherwise.
+  static RepackedWeightsCache* GetFromContext(const TfLiteContext* context);
+
+  // Returns the process-wide cache.
+  static RepackedWeightsCache* Get();
+
+  // Returns the `size` bytes that `repack` writes when given the constant
+  // tensor `weights`. `kind` names the repacking, e.g. "conv_hwcn", and must
+  // change whenever the layout written by `repack` does. The buffer is shared
+  // with every caller passing the same `kind`, `size` and weights of identical
+  // type, shape and contents.
+  std::shared_ptr<const Buffer> GetOrRepack(
+      const char* kind, const TfLiteTensor& weights, size_t size,
+      const std::function<void(uint8_t* data)>& repack);
+
+  // Returns the number of buffers currently alive.
+  size_t NumBuffers() const;
+
+  // Returns the number of times the contents of weights were hashed, for
+  // tests.
+  size_t NumContentHashes() const;
+
+ private:
+  struct Entry {
+    std::weak_ptr<const Buffer> buffer;
+    // Identity keys of the weights known to have these contents.
+    std::vector<std::string> identities;
+  };
+
+  // Weights known by their identity.
+  struct Identity {
+    // Key of the contents of the weights in `buffers_`.
+    std::string contents_key;
+    // Hash of a sample of the contents, which catches weights replaced at
+    // the same address.
+    uint64_t sample_hash;
+  };
+
+  RepackedWeightsCache() = default;
+
+  // Returns the buffer of the weights with `identity_key` if it is alive and
+  // their sample still hashes to `sample_hash`, and nullptr otherwise.
+  std::shared_ptr<const Buffer> FindByIdentity(const std::string& identity_key,
+                                               uint64_t sample_hash) const;
+
+  // Records that the weights with `identity_key` have the contents of
+  // `contents_key`.
+  void AddIdentity(const std::string& contents_key,
+                   const std::string& identity_key, uint64_t sample_hash);
+
+  // Forgets `key` unless it was repacked again since its buffer expired.
+  void Release(const std::string& key);
+
+  mutable std::mutex mutex_;
+  // Buffers by the contents of their weights.
+  std::unordered_map<std::string, Entry> buffers_;
+  std::unordered_map<std::string, Identity> identities_;
+  size_t num_content_hashes_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_REPACKED_WEIGHTS_CACHE_H_
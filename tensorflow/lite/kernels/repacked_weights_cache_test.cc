@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/repacked_weights_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace {
+
+// A constant float tensor of shape [values.size()] viewing `values`, which
+// belongs to the model allocation `model`.
+class Weights {
+ public:
+  explicit Weights(std::vector<float> values, const void* model = nullptr)
+      : values_(std::move(values)), dims_(TfLiteIntArrayCreate(1)) {
+    dims_->data[0] = values_.size();
+    tensor_.type = kTfLiteFloat32;
+    tensor_.allocation_type = kTfLiteMmapRo;
+    tensor_.dims = dims_;
+    tensor_.data.raw = reinterpret_cast<char*>(values_.data());
+    tensor_.bytes = values_.size() * sizeof(float);
+    tensor_.allocation = model;
+  }
+  ~Weights() { TfLiteIntArrayFree(dims_); }
+
+  const TfLiteTensor& tensor() const { return tensor_; }
+  std::vector<float>& values() { return values_; }
+
+ private:
+  std::vector<float> values_;
+  TfLiteIntArray* dims_;
+  TfLiteTensor tensor_ = {};
+};
+
+// Repacks weights by negating them, counting the calls.
+std::shared_ptr<const RepackedWeightsCache::Buffer> Negate(
+    const char* kind, const Weights& weights, int* num_calls) {
+  const TfLiteTensor& tensor = weights.tensor();
+  return RepackedWeightsCache::Get()->GetOrRepack(
+      kind, tensor, tensor.bytes, [&](uint8_t* data) {
+        ++*num_calls;
+        const float* input = reinterpret_cast<const float*>(tensor.data.raw);
+        float* output = reinterpret_cast<float*>(data);
+        for (int i = 0; i < tensor.dims->data[0]; ++i) output[i] = -input[i];
+      });
+}
+
+TEST(RepackedWeightsCacheTest, SharesIdenticalWeights) {
+  Weights a({1.f, 2.f, 3.f});
+  Weights b({1.f, 2.f, 3.f});
+  int num_calls = 0;
+  auto buffer_a = Negate("negate", a, &num_calls);
+  auto buffer_b = Negate("negate", b, &num_calls);
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_EQ(buffer_a.get(), buffer_b.get());
+  const float* values = reinterpret_cast<const float*>(buffer_a->data());
+  EXPECT_EQ(values[0], -1.f);
+  EXPECT_EQ(values[2], -3.f);
+  EXPECT_EQ(RepackedWeightsCache::Get()->NumBuffers(), 1);
+}
+
+TEST(RepackedWeightsCacheTest, DistinguishesKindAndContents) {
+  Weights a({1.f, 2.f, 3.f});
+  Weights b({1.f, 2.f, 4.f});
+  int num_calls = 0;
+  auto buffer_a = Negate("negate", a, &num_calls);
+  auto buffer_b = Negate("negate", b, &num_calls);
+  auto buffer_c = Negate("negate_v2", a, &num_calls);
+  EXPECT_EQ(num_calls, 3);
+  EXPECT_NE(buffer_a.get(), buffer_b.get());
+  EXPECT_NE(buffer_a.get(), buffer_c.get());
+  EXPECT_EQ(RepackedWeightsCache::Get()->NumBuffers(), 3);
+}
+
+TEST(RepackedWeightsCacheTest, ReleasesUnusedBuffers) {
+  Weights weights({1.f, 2.f});
+  int num_calls = 0;
+  auto buffer = Negate("negate", weights, &num_calls);
+  EXPECT_EQ(RepackedWeightsCache::Get()->NumBuffers(), 1);
+  buffer.reset();
+  EXPECT_EQ(RepackedWeightsCache::Get()->NumBuffers(), 0);
+  buffer = Negate("negate", weights, &num_calls);
+  EXPECT_EQ(num_calls, 2);
+}
+
+TEST(RepackedWeightsCacheTest, HashesWeightsOnlyOnce) {
+  const int model = 0;
+  Weights weights(std::vector<float>(1000, 1.f), &model);
+  RepackedWeightsCache* cache = RepackedWeightsCache::Get();
+  const size_t num_hashes = cache->NumContentHashes();
+  int num_calls = 0;
+  auto buffer = Negate("negate", weights, &num_calls);
+  auto same_buffer = Negate("negate", weights, &num_calls);
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_EQ(buffer.get(), same_buffer.get());
+  EXPECT_EQ(cache->NumContentHashes(), num_hashes + 1);
+
+  // The same contents in another model are hashed and shared.
+  const int other_model = 0;
+  Weights other_weights(weights.values(), &other_model);
+  auto other_buffer = Negate("negate", other_weights, &num_calls);
+  EXPECT_EQ(num_calls, 1);
+  EXPECT_EQ(buffer.get(), other_buffer.get());
+  EXPECT_EQ(cache->NumContentHashes(), num_hashes + 2);
+  other_buffer = Negate("negate", other_weights, &num_calls);
+  EXPECT_EQ(cache->NumContentHashes(), num_hashes + 2);
+}
+
+TEST(RepackedWeightsCacheTest, RehashesWeightsReplacedInPlace) {
+  const int model = 0;
+  Weights weights({1.f, 2.f, 3.f}, &model);
+  int num_calls = 0;
+  auto buffer = Negate("negate", weights, &num_calls);
+  weights.values()[1] = 5.f;
+  auto new_buffer = Negate("negate", weights, &num_calls);
+  EXPECT_EQ(num_calls, 2);
+  EXPECT_NE(buffer.get(), new_buffer.get());
+  EXPECT_EQ(reinterpret_cast<const float*>(new_buffer->data())[1], -5.f);
+}
+
+TEST(RepackedWeightsCacheTest, DisabledWithoutInterpreter) {
+  TfLiteContext context = {};
+  EXPECT_EQ(RepackedWeightsCache::GetFromContext(&context), nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -112,10 +112,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const int size = op_context.perm->dims->data[0];
   TransposeParams params;
   params.perm_count = size;
-#ifdef TFLITE_KERNEL_USE_XNNPACK
-  xnn_status status;
   CpuBackendContext* cpu_backend_context =
       CpuBackendContext::GetFromContext(context);
+#ifdef TFLITE_KERNEL_USE_XNNPACK
+  xnn_status status;
   pthreadpool_t threadpool = cpu_backend_context->get_xnnpack_threadpool();
   std::array<size_t, kTransposeMaxDimensions> xnn_input_shape;
   std::array<size_t, kTransposeMaxDimensions> xnn_perm;
@@ -140,6 +140,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                   GetTensorData<scalar>(op_context.input),  \
                   GetTensorShape(op_context.output),        \
                   GetTensorData<scalar>(op_context.output))
+#define TF_LITE_OPTIMIZED_TRANSPOSE(scalar)                          \
+  optimized_ops::Transpose(params, GetTensorShape(op_context.input), \
+                           GetTensorData<scalar>(op_context.input),  \
+                           GetTensorShape(op_context.output),        \
+                           GetTensorData<scalar>(op_context.output), \
+                           cpu_backend_context)
 
   // Transpose kernel only does rearranging values not numeric evaluations on
   // each cell. It's safe to implement per size of scalar type and this trick
@@ -162,7 +168,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           TF_LITE_TRANSPOSE(reference_ops, int32_t);
         }
 #else   // TFLITE_KERNEL_USE_XNNPACK
-        TF_LITE_TRANSPOSE(optimized_ops, int32_t);
+        TF_LITE_OPTIMIZED_TRANSPOSE(int32_t);
 #endif  // TFLITE_KERNEL_USE_XNNPACK
       } else {
         TF_LITE_TRANSPOSE(reference_ops, int32_t);
@@ -191,7 +197,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           TF_LITE_TRANSPOSE(reference_ops, int8_t);
         }
 #else   // TFLITE_KERNEL_USE_XNNPACK
-        TF_LITE_TRANSPOSE(optimized_ops, int8_t);
+        TF_LITE_OPTIMIZED_TRANSPOSE(int8_t);
 #endif  // TFLITE_KERNEL_USE_XNNPACK
       } else {
         TF_LITE_TRANSPOSE(reference_ops, int8_t);
@@ -213,7 +219,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           TF_LITE_TRANSPOSE(reference_ops, int8_t);
         }
 #else   // TFLITE_KERNEL_USE_XNNPACK
-        TF_LITE_TRANSPOSE(optimized_ops, int16_t);
+        TF_LITE_OPTIMIZED_TRANSPOSE(int16_t);
 #endif  // TFLITE_KERNEL_USE_XNNPACK
       } else {
         TF_LITE_TRANSPOSE(reference_ops, int16_t);
@@ -228,6 +234,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                          TfLiteTypeGetName(op_context.input->type));
       return kTfLiteError;
   }
+#undef TF_LITE_OPTIMIZED_TRANSPOSE
 #undef TF_LITE_TRANSPOSE
 
   return kTfLiteOk;
@@ -39,6 +39,10 @@ class TransposeOpModel : public SingleOpModel {
     PopulateTensor<float>(input_, data);
   }
 
+  void SetInput(const std::vector<float>& data) {
+    PopulateTensor<float>(input_, data);
+  }
+
   void SetPerm(std::initializer_list<int> data) {
     PopulateTensor<int>(perm_, data);
   }
@@ -62,13 +66,15 @@ class TransposeOpConstModel : public TransposeOpModel {
  public:
   TransposeOpConstModel(std::initializer_list<int> input_shape,
                         std::initializer_list<int> perm_shape,
-                        std::initializer_list<int> perm) {
+                        std::initializer_list<int> perm, int num_threads = -1) {
     input_ = AddInput({TensorType_FLOAT32, input_shape});
     perm_ = AddConstInput(TensorType_INT32, perm, perm_shape);
     output_ = AddOutput(TensorType_FLOAT32);
     SetBuiltinOp(BuiltinOperator_TRANSPOSE, BuiltinOptions_TransposeOptions,
                  CreateTransposeOptions(builder_).Union());
-    BuildInterpreter({input_shape});
+    BuildInterpreter({input_shape}, num_threads,
+                     /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/true);
   }
 };
 
@@ -376,6 +382,48 @@ TEST(TransposeTest, 5DDividedIntoTwo2DsThird) {
   EXPECT_EQ(m.GetOutput(), out);
 }
 
+// Returns the values 0 to size - 1.
+std::vector<float> Iota(int size) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) values[i] = i;
+  return values;
+}
+
+// The following transposes are large enough to be split between threads.
+TEST(TransposeTest, Multithreaded2D) {
+  // The rows are not a multiple of the rows given to each thread.
+  TransposeOpConstModel m({130, 160}, {2}, {1, 0}, /*num_threads=*/4);
+  m.SetInput(Iota(130 * 160));
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(RunTestPermutation<float>({130, 160}, {1, 0})));
+}
+
+TEST(TransposeTest, MultithreadedFlatten) {
+  TransposeOpConstModel m({8, 130, 20}, {3}, {0, 2, 1}, /*num_threads=*/4);
+  m.SetInput(Iota(8 * 130 * 20));
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(RunTestPermutation<float>(
+                                 {8, 130, 20}, {0, 2, 1})));
+}
+
+TEST(TransposeTest, Multithreaded3D) {
+  TransposeOpConstModel m({24, 40, 32}, {3}, {2, 1, 0}, /*num_threads=*/4);
+  m.SetInput(Iota(24 * 40 * 32));
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(RunTestPermutation<float>(
+                                 {24, 40, 32}, {2, 1, 0})));
+}
+
+TEST(TransposeTest, Multithreaded4D) {
+  TransposeOpConstModel m({8, 20, 12, 16}, {4}, {3, 2, 0, 1},
+                          /*num_threads=*/4);
+  m.SetInput(Iota(8 * 20 * 12 * 16));
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(RunTestPermutation<float>(
+                                 {8, 20, 12, 16}, {3, 2, 0, 1})));
+}
+
 #if GTEST_HAS_DEATH_TEST
 TEST(TransposeTest, Test7DInputTensor) {
   EXPECT_DEATH(
@@ -0,0 +1,185 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/offline_memory_plan.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+namespace {
+
+constexpr int32_t kOfflineMemoryAllocationVersion = 1;
+constexpr size_t kHeaderSize = 3;
+
+int64_t Lifetime(const ArenaAllocWithUsageInterval& alloc) {
+  return static_cast<int64_t>(alloc.last_node) - alloc.first_node + 1;
+}
+
+// Returns the largest total size of the tensors used by one node, which no
+// assignment of offsets can go below.
+size_t LowerBound(const std::vector<ArenaAllocWithUsageInterval>& allocs) {
+  // Pairs of node and change of the used size at that node, with the
+  // releases sorted before the acquisitions of the same node.
+  std::vector<std::pair<int64_t, int64_t>> events;
+  events.reserve(2 * allocs.size());
+  for (const auto& alloc : allocs) {
+    const int64_t size = static_cast<int64_t>(alloc.size);
+    events.emplace_back(alloc.first_node, size);
+    events.emplace_back(static_cast<int64_t>(alloc.last_node) + 1, -size);
+  }
+  std::sort(events.begin(), events.end());
+  int64_t used = 0;
+  int64_t max_used = 0;
+  for (const auto& event : events) {
+    used += event.second;
+    max_used = std::max(max_used, used);
+  }
+  return static_cast<size_t>(max_used);
+}
+
+// Places the tensors in the order of `order` with the best-fit policy of
+// `SimpleMemoryArena`. Returns the size of the arena.
+TfLiteStatus PlaceInOrder(
+    TfLiteContext* context,
+    const std::vector<ArenaAllocWithUsageInterval>& allocs,
+    const std::vector<int>& order, size_t alignment,
+    std::vector<ArenaAllocWithUsageInterval>* placed, size_t* arena_size) {
+  SimpleMemoryArena arena(alignment);
+  placed->assign(allocs.size(), ArenaAllocWithUsageInterval());
+  *arena_size = 0;
+  for (int i : order) {
+    const auto& alloc = allocs[i];
+    TF_LITE_ENSURE_STATUS(arena.Allocate(context, alignment, alloc.size,
+                                         alloc.tensor, alloc.first_node,
+                                         alloc.last_node, &(*placed)[i]));
+    *arena_size = std::max(*arena_size, (*placed)[i].offset + alloc.size);
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+std::vector<int32_t> ParseOfflineMemoryAllocation(const std::string& buffer,
+                                                  int subgraph_index) {
+  if (buffer.size() % sizeof(int32_t) != 0 ||
+      buffer.size() < kHeaderSize * sizeof(int32_t)) {
+    return {};
+  }
+  std::vector<int32_t> words(buffer.size() / sizeof(int32_t));
+  std::memcpy(words.data(), buffer.data(), buffer.size());
+  if (words[0] != kOfflineMemoryAllocationVersion ||
+      words[1] != subgraph_index || words[2] < 0 ||
+      static_cast<size_t>(words[2]) != words.size() - kHeaderSize) {
+    return {};
+  }
+  return std::vector<int32_t>(words.begin() + kHeaderSize, words.end());
+}
+
+std::string SerializeOfflineMemoryAllocation(
+    int subgraph_index, const std::vector<int32_t>& offsets) {
+  std::vector<int32_t> words = {kOfflineMemoryAllocationVersion,
+                                subgraph_index,
+                                static_cast<int32_t>(offsets.size())};
+  words.insert(words.end(), offsets.begin(), offsets.end());
+  return std::string(reinterpret_cast<const char*>(words.data()),
+                     words.size() * sizeof(int32_t));
+}
+
+TfLiteStatus PlanOfflineMemoryAllocation(
+    TfLiteContext* context,
+    const std::vector<ArenaAllocWithUsageInterval>& allocs, size_t num_tensors,
+    size_t alignment, std::vector<int32_t>* offsets, size_t* arena_size) {
+  for (const auto& alloc : allocs) {
+    TF_LITE_ENSURE(context, alloc.tensor >= 0 &&
+                                static_cast<size_t>(alloc.tensor) < num_tensors);
+  }
+  // Each comparator breaks ties by tensor index, so that the plan is
+  // deterministic.
+  using Compare = bool (*)(const ArenaAllocWithUsageInterval&,
+                           const ArenaAllocWithUsageInterval&);
+  const Compare kOrders[] = {
+      // Largest first, as the runtime planner does.
+      [](const ArenaAllocWithUsageInterval& a,
+         const ArenaAllocWithUsageInterval& b) {
+        if (a.size != b.size) return a.size > b.size;
+        if (a.first_node != b.first_node) return a.first_node < b.first_node;
+        return a.tensor < b.tensor;
+      },
+      // Largest size times lifetime first.
+      [](const ArenaAllocWithUsageInterval& a,
+         const ArenaAllocWithUsageInterval& b) {
+        const double area_a = static_cast<double>(a.size) * Lifetime(a);
+        const double area_b = static_cast<double>(b.size) * Lifetime(b);
+        if (area_a != area_b) return area_a > area_b;
+        return a.tensor < b.tensor;
+      },
+      // Longest lived first.
+      [](const ArenaAllocWithUsageInterval& a,
+         const ArenaAllocWithUsageInterval& b) {
+        if (Lifetime(a) != Lifetime(b)) return Lifetime(a) > Lifetime(b);
+        if (a.size != b.size) return a.size > b.size;
+        return a.tensor < b.tensor;
+      },
+      // In execution order.
+      [](const ArenaAllocWithUsageInterval& a,
+         const ArenaAllocWithUsageInterval& b) {
+        if (a.first_node != b.first_node) return a.first_node < b.first_node;
+        if (a.size != b.size) return a.size > b.size;
+        return a.tensor < b.tensor;
+      },
+  };
+
+  const size_t lower_bound = LowerBound(allocs);
+  std::vector<ArenaAllocWithUsageInterval> best;
+  size_t best_size = std::numeric_limits<size_t>::max();
+  std::vector<ArenaAllocWithUsageInterval> placed;
+  std::vector<int> order(allocs.size());
+  for (const Compare compare : kOrders) {
+    for (int i = 0; i < static_cast<int>(order.size()); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return compare(allocs[a], allocs[b]); });
+    size_t size;
+    TF_LITE_ENSURE_STATUS(
+        PlaceInOrder(context, allocs, order, alignment, &placed, &size));
+    if (size < best_size) {
+      best_size = size;
+      best.swap(placed);
+    }
+    if (best_size <= lower_bound) break;
+  }
+
+  TF_LITE_ENSURE(context, best_size <= static_cast<size_t>(
+                                           std::numeric_limits<int32_t>::max()));
+  offsets->assign(num_tensors, -1);
+  for (const auto& alloc : best) {
+    if (alloc.size > 0) {
+      (*offsets)[alloc.tensor] = static_cast<int32_t>(alloc.offset);
+    }
+  }
+  *arena_size = best_size;
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,66 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_OFFLINE_MEMORY_PLAN_H_
+#define TENSORFLOW_LITE_OFFLINE_MEMORY_PLAN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+
+// Name of the model metadata buffer holding the arena offsets planned when
+// the model was converted.
+//
+// The buffer is an array of little-endian int32 values:
+//   [0]: version of the format, currently 1.
+//   [1]: index of the subgraph the offsets are for.
+//   [2]: number of offsets N, which must be the number of tensors of the
+//        subgraph.
+//   [3, 3 + N): offset of each tensor in the non-persistent arena, or -1 if
+//        the tensor is planned at runtime.
+constexpr char kOfflineMemoryAllocationMetadata[] = "OfflineMemoryAllocation";
+
+// Returns the offsets for `subgraph_index` stored in `buffer`, or an empty
+// vector if `buffer` is malformed or is for another subgraph.
+std::vector<int32_t> ParseOfflineMemoryAllocation(const std::string& buffer,
+                                                  int subgraph_index);
+
+// Returns the metadata buffer holding `offsets` for `subgraph_index`.
+std::string SerializeOfflineMemoryAllocation(
+    int subgraph_index, const std::vector<int32_t>& offsets);
+
+// Assigns offsets to the tensors of `allocs`, which give the size and usage
+// interval of each tensor, so that tensors used at the same time don't
+// overlap. Unlike the runtime planner, which places the tensors once in
+// decreasing size order, this tries several orders and keeps the smallest
+// arena, stopping early when it reaches the lower bound given by the largest
+// total size of the tensors used by one node. Meant to be run offline, when
+// its cost is paid once.
+//
+// Returns one offset per tensor of the subgraph, -1 for the tensors not in
+// `allocs`, and the size of the arena in `arena_size`.
+TfLiteStatus PlanOfflineMemoryAllocation(
+    TfLiteContext* context,
+    const std::vector<ArenaAllocWithUsageInterval>& allocs, size_t num_tensors,
+    size_t alignment, std::vector<int32_t>* offsets, size_t* arena_size);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_OFFLINE_MEMORY_PLAN_H_
@@ -0,0 +1,105 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/offline_memory_plan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+namespace {
+
+void ReportError(TfLiteContext* context, const char* format, ...) {}
+
+ArenaAllocWithUsageInterval Alloc(int32_t tensor, size_t size,
+                                  int32_t first_node, int32_t last_node) {
+  ArenaAllocWithUsageInterval alloc;
+  alloc.tensor = tensor;
+  alloc.size = size;
+  alloc.first_node = first_node;
+  alloc.last_node = last_node;
+  return alloc;
+}
+
+TEST(OfflineMemoryPlanTest, SerializeAndParse) {
+  const std::vector<int32_t> offsets = {0, -1, 64, 128};
+  const std::string buffer = SerializeOfflineMemoryAllocation(2, offsets);
+  EXPECT_EQ(ParseOfflineMemoryAllocation(buffer, 2), offsets);
+  // Offsets for another subgraph are ignored.
+  EXPECT_TRUE(ParseOfflineMemoryAllocation(buffer, 0).empty());
+}
+
+TEST(OfflineMemoryPlanTest, ParseMalformedBuffer) {
+  const std::string buffer = SerializeOfflineMemoryAllocation(0, {0, 64});
+  EXPECT_TRUE(ParseOfflineMemoryAllocation("", 0).empty());
+  EXPECT_TRUE(
+      ParseOfflineMemoryAllocation(buffer.substr(0, buffer.size() - 1), 0)
+          .empty());
+  EXPECT_TRUE(
+      ParseOfflineMemoryAllocation(buffer.substr(0, buffer.size() - 4), 0)
+          .empty());
+}
+
+TEST(OfflineMemoryPlanTest, BeatsLargestFirst) {
+  TfLiteContext context;
+  // Placing the largest tensors first leaves tensor 0 no room next to tensor
+  // 3, which needs 256 bytes. Placing the long-lived tensors first reaches the
+  // lower bound of 224 bytes, used at node 2.
+  const std::vector<ArenaAllocWithUsageInterval> allocs = {
+      Alloc(0, 64, 2, 3),
+      Alloc(1, 96, 1, 1),
+      Alloc(2, 96, 1, 3),
+      Alloc(3, 64, 2, 2),
+  };
+  std::vector<int32_t> offsets;
+  size_t arena_size;
+  ASSERT_EQ(PlanOfflineMemoryAllocation(&context, allocs, 5, 32, &offsets,
+                                        &arena_size),
+            kTfLiteOk);
+  ASSERT_EQ(offsets.size(), 5);
+  EXPECT_EQ(offsets[4], -1);
+  EXPECT_EQ(arena_size, 224);
+  // Tensors used at the same time don't overlap.
+  for (const auto& a : allocs) {
+    for (const auto& b : allocs) {
+      if (a.tensor >= b.tensor || a.last_node < b.first_node ||
+          b.last_node < a.first_node) {
+        continue;
+      }
+      const int32_t a_offset = offsets[a.tensor];
+      const int32_t b_offset = offsets[b.tensor];
+      EXPECT_TRUE(a_offset + a.size <= b_offset ||
+                  b_offset + b.size <= a_offset);
+    }
+  }
+}
+
+TEST(OfflineMemoryPlanTest, RejectsOutOfRangeTensor) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  std::vector<int32_t> offsets;
+  size_t arena_size;
+  EXPECT_EQ(PlanOfflineMemoryAllocation(&context, {Alloc(3, 32, 0, 0)}, 2, 32,
+                                        &offsets, &arena_size),
+            kTfLiteError);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -16,9 +16,12 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_BUFFERED_PROFILER_H_
 
 #include <cstdint>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 
 namespace tflite {
@@ -116,6 +119,17 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  // Records the CPU hardware counters of the calling thread for each operator
+  // invoke event. Returns false, and leaves them disabled, if the platform
+  // does not support hardware counters. See HardwareCounters for details.
+  bool EnableHardwareCounters() {
+    auto hardware_counters = std::make_unique<HardwareCounters>();
+    if (!hardware_counters->IsSupported()) return false;
+    hardware_counters_ = std::move(hardware_counters);
+    buffer_.SetHardwareCounters(hardware_counters_.get());
+    return true;
+  }
+
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
@@ -135,6 +149,7 @@ class BufferedProfiler : public tflite::Profiler {
 
  private:
   ProfileBuffer* GetProfileBuffer() { return &buffer_; }
+  std::unique_ptr<HardwareCounters> hardware_counters_;
   ProfileBuffer buffer_;
   const uint64_t supported_event_types_;
 };
@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace tflite {
+namespace profiling {
+
+#ifdef __linux__
+namespace {
+
+int OpenCounter(uint32_t type, uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // The leader starts disabled, and enables the whole group at once.
+  attr.disabled = group_fd < 0 ? 1 : 0;
+  // Counting the kernel or the hypervisor typically requires privileges.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, /*pid=*/0,
+                                  /*cpu=*/-1, group_fd, /*flags=*/0));
+}
+
+}  // namespace
+
+HardwareCounters::HardwareCounters() {
+  struct {
+    uint32_t type;
+    uint64_t config;
+  } const events[kNumCounters] = {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                               (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+  };
+  for (int i = 0; i < kNumCounters; ++i) {
+    positions_[i] = -1;
+    fds_[i] = -1;
+  }
+  group_fd_ = OpenCounter(events[kCycles].type, events[kCycles].config, -1);
+  if (group_fd_ < 0) {
+    group_fd_ = -1;
+    return;
+  }
+  fds_[kCycles] = group_fd_;
+  positions_[kCycles] = num_opened_++;
+  for (int i = kCycles + 1; i < kNumCounters; ++i) {
+    fds_[i] = OpenCounter(events[i].type, events[i].config, group_fd_);
+    if (fds_[i] < 0) {
+      fds_[i] = -1;
+    } else {
+      positions_[i] = num_opened_++;
+    }
+  }
+  ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+HardwareCounters::~HardwareCounters() {
+  for (int i = 0; i < kNumCounters; ++i) {
+    if (fds_[i] >= 0) close(fds_[i]);
+  }
+}
+
+HardwareCounterValues HardwareCounters::Read() const {
+  HardwareCounterValues result;
+  if (group_fd_ < 0) return result;
+  // With PERF_FORMAT_GROUP, the leader reads the number of counters followed
+  // by their values, in the order they were added to the group.
+  uint64_t data[1 + kNumCounters];
+  const ssize_t size = sizeof(uint64_t) * (1 + num_opened_);
+  if (read(group_fd_, data, size) != size) return result;
+  const auto value = [&](int counter) -> uint64_t {
+    return positions_[counter] < 0 ? 0 : data[1 + positions_[counter]];
+  };
+  result.cycles = value(kCycles);
+  result.instructions = value(kInstructions);
+  result.l1d_read_misses = value(kL1dReadMisses);
+  result.llc_misses = value(kLlcMisses);
+  return result;
+}
+
+#else  // __linux__
+
+HardwareCounters::HardwareCounters() {
+  for (int i = 0; i < kNumCounters; ++i) {
+    positions_[i] = -1;
+    fds_[i] = -1;
+  }
+}
+
+HardwareCounters::~HardwareCounters() {}
+
+HardwareCounterValues HardwareCounters::Read() const {
+  return HardwareCounterValues();
+}
+
+#endif  // __linux__
+
+}  // namespace profiling
+}  // namespace tflite
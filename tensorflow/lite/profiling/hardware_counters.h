@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace profiling {
+
+// Values of the CPU hardware counters. Counters that are not available on the
+// platform read as 0.
+struct HardwareCounterValues {
+  // CPU cycles.
+  uint64_t cycles = 0;
+  // Retired instructions.
+  uint64_t instructions = 0;
+  // Level 1 data cache read misses.
+  uint64_t l1d_read_misses = 0;
+  // Last level cache misses.
+  uint64_t llc_misses = 0;
+
+  HardwareCounterValues operator-(const HardwareCounterValues& obj) const {
+    HardwareCounterValues res;
+    res.cycles = cycles - obj.cycles;
+    res.instructions = instructions - obj.instructions;
+    res.l1d_read_misses = l1d_read_misses - obj.l1d_read_misses;
+    res.llc_misses = llc_misses - obj.llc_misses;
+    return res;
+  }
+};
+
+// CPU hardware counters of the calling thread, read through `perf_event_open`
+// on Linux and Android.
+//
+// The counters only count user space events of the thread that created this
+// object: the work that an op offloads to other threads, e.g. to the ruy or
+// XNNPack thread pools, is not accounted for. Running with a single thread
+// gives the most meaningful per-op numbers.
+//
+// Counters may be unavailable if the kernel does not expose them to the
+// process (see /proc/sys/kernel/perf_event_paranoid), or if the CPU has no
+// such event. `IsSupported` returns false if no counter is available.
+class HardwareCounters {
+ public:
+  HardwareCounters();
+  ~HardwareCounters();
+
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  // Returns whether the CPU cycles, at least, are counted.
+  bool IsSupported() const { return group_fd_ >= 0; }
+
+  // Returns the current values of the counters, counted since this object was
+  // created.
+  HardwareCounterValues Read() const;
+
+ private:
+  enum Counter {
+    kCycles,
+    kInstructions,
+    kL1dReadMisses,
+    kLlcMisses,
+    kNumCounters
+  };
+
+  // The file descriptor of the group leader, which counts the cycles, or -1.
+  int group_fd_ = -1;
+  // For each counter, its position in the group, or -1 if not available.
+  int positions_[kNumCounters];
+  int fds_[kNumCounters];
+  int num_opened_ = 0;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
@@ -0,0 +1,68 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+TEST(HardwareCounterValuesTest, Sub) {
+  HardwareCounterValues begin, end;
+  begin.cycles = 100;
+  begin.instructions = 50;
+  begin.l1d_read_misses = 5;
+  begin.llc_misses = 1;
+  end.cycles = 300;
+  end.instructions = 250;
+  end.l1d_read_misses = 15;
+  end.llc_misses = 4;
+
+  const HardwareCounterValues delta = end - begin;
+  EXPECT_EQ(200, delta.cycles);
+  EXPECT_EQ(200, delta.instructions);
+  EXPECT_EQ(10, delta.l1d_read_misses);
+  EXPECT_EQ(3, delta.llc_misses);
+}
+
+TEST(HardwareCountersTest, Read) {
+  HardwareCounters counters;
+#ifndef __linux__
+  EXPECT_FALSE(counters.IsSupported());
+#endif
+  if (!counters.IsSupported()) {
+    // Counters are typically not accessible in sandboxes and virtual machines.
+    const HardwareCounterValues values = counters.Read();
+    EXPECT_EQ(0, values.cycles);
+    EXPECT_EQ(0, values.instructions);
+    GTEST_SKIP() << "Hardware counters are not supported.";
+  }
+
+  const HardwareCounterValues begin = counters.Read();
+  volatile int64_t sum = 0;
+  for (int i = 0; i < 100000; ++i) sum += i;
+  const HardwareCounterValues end = counters.Read();
+  EXPECT_GT(end.cycles, begin.cycles);
+  EXPECT_GE(end.instructions, begin.instructions);
+  EXPECT_GE(end.l1d_read_misses, begin.l1d_read_misses);
+  EXPECT_GE(end.llc_misses, begin.llc_misses);
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
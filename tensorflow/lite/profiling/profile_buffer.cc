@@ -47,6 +47,12 @@ uint32_t ProfileBuffer::BeginEvent(const char* tag,
   if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
     event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
   }
+  event_buffer_[index].has_hardware_counters =
+      ShouldRecordHardwareCounters(event_type);
+  if (event_buffer_[index].has_hardware_counters) {
+    // Read last so that the bookkeeping above is not counted.
+    event_buffer_[index].begin_hardware_counters = hardware_counters_->Read();
+  }
   current_index_++;
   return index;
 }
@@ -65,6 +71,14 @@ void ProfileBuffer::EndEvent(uint32_t event_handle,
   }
 
   int event_index = event_handle % max_size;
+  if (event_buffer_[event_index].has_hardware_counters) {
+    if (hardware_counters_ != nullptr) {
+      event_buffer_[event_index].end_hardware_counters =
+          hardware_counters_->Read();
+    } else {
+      event_buffer_[event_index].has_hardware_counters = false;
+    }
+  }
   event_buffer_[event_index].elapsed_time =
       time::NowMicros() - event_buffer_[event_index].begin_timestamp_us;
   if (event_buffer_[event_index].event_type !=
@@ -109,6 +123,7 @@ void ProfileBuffer::AddEvent(const char* tag,
   event_buffer_[index].extra_event_metadata = event_metadata2;
   event_buffer_[index].begin_timestamp_us = 0;
   event_buffer_[index].elapsed_time = elapsed_time;
+  event_buffer_[index].has_hardware_counters = false;
   current_index_++;
 }
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 
@@ -50,6 +51,14 @@ struct ProfileEvent {
   // The memory usage when the event ends.
   memory::MemoryUsage end_mem_usage;
 
+  // Whether the hardware counters below were recorded for this event. See
+  // ProfileBuffer::SetHardwareCounters.
+  bool has_hardware_counters;
+  // The hardware counters when the event begins.
+  HardwareCounterValues begin_hardware_counters;
+  // The hardware counters when the event ends.
+  HardwareCounterValues end_hardware_counters;
+
   // The field containing the type of event. This must be one of the event types
   // in EventType.
   EventType event_type;
@@ -71,7 +80,8 @@ class ProfileBuffer {
       : enabled_(enabled),
         current_index_(0),
         event_buffer_(max_num_entries),
-        allow_dynamic_expansion_(allow_dynamic_expansion) {}
+        allow_dynamic_expansion_(allow_dynamic_expansion),
+        hardware_counters_(nullptr) {}
 
   // Adds an event to the buffer with begin timestamp set to the current
   // timestamp. Returns a handle to event that can be used to call EndEvent. If
@@ -83,6 +93,13 @@ class ProfileBuffer {
   // Sets the enabled state of buffer to |enabled|
   void SetEnabled(bool enabled) { enabled_ = enabled; }
 
+  // Records |hardware_counters| at the beginning and the end of operator invoke
+  // events, if not null. |hardware_counters| must outlive the buffer, or be
+  // reset before it is destroyed.
+  void SetHardwareCounters(const HardwareCounters* hardware_counters) {
+    hardware_counters_ = hardware_counters;
+  }
+
   // Sets the end timestamp for event for the handle to current time.
   // If the buffer is disabled or previous event has been overwritten this
   // operation has not effect.
@@ -115,10 +132,19 @@ class ProfileBuffer {
   // the 2nd element refers to whether the buffer reaches its allowed capacity.
   std::pair<int, bool> GetNextEntryIndex();
 
+  // Returns whether hardware counters are recorded for |event_type|.
+  bool ShouldRecordHardwareCounters(ProfileEvent::EventType event_type) const {
+    using EventType = ProfileEvent::EventType;
+    return hardware_counters_ != nullptr &&
+           (event_type == EventType::OPERATOR_INVOKE_EVENT ||
+            event_type == EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT);
+  }
+
   bool enabled_;
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
   const bool allow_dynamic_expansion_;
+  const HardwareCounters* hardware_counters_;
 };
 
 }  // namespace profiling
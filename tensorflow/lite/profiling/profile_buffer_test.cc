@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "tensorflow/lite/profiling/hardware_counters.h"
 
 namespace tflite {
 namespace profiling {
@@ -137,6 +138,34 @@ TEST(ProfileBufferTest, Enable) {
   EXPECT_EQ(1, buffer.Size());
 }
 
+TEST(ProfileBufferTest, HardwareCounters) {
+  HardwareCounters hardware_counters;
+  ProfileBuffer buffer(/*max_size*/ 10, /*enabled*/ true);
+  buffer.SetHardwareCounters(&hardware_counters);
+  auto op_handle =
+      buffer.BeginEvent("op", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT,
+                        /*event_metadata1*/ 1, /*event_metadata2*/ 0);
+  auto default_handle =
+      buffer.BeginEvent("hello", ProfileEvent::EventType::DEFAULT,
+                        /*event_metadata1*/ 42, /*event_metadata2*/ 0);
+  buffer.EndEvent(default_handle);
+  buffer.EndEvent(op_handle);
+  buffer.AddEvent("added", ProfileEvent::EventType::OPERATOR_INVOKE_EVENT,
+                  /*elapsed_time*/ 10, /*event_metadata1*/ 2,
+                  /*event_metadata2*/ 0);
+  buffer.SetHardwareCounters(nullptr);
+
+  auto events = GetProfileEvents(buffer);
+  ASSERT_EQ(3, events.size());
+  EXPECT_TRUE(events[0]->has_hardware_counters);
+  EXPECT_GE(events[0]->end_hardware_counters.cycles,
+            events[0]->begin_hardware_counters.cycles);
+  EXPECT_GE(events[0]->end_hardware_counters.instructions,
+            events[0]->begin_hardware_counters.instructions);
+  EXPECT_FALSE(events[1]->has_hardware_counters);
+  EXPECT_FALSE(events[2]->has_hardware_counters);
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
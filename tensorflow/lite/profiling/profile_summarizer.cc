@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
@@ -92,6 +93,16 @@ OperatorDetails GetOperatorDetails(const tflite::Interpreter& interpreter,
   return details;
 }
 
+void UpdateHardwareCounterStats(const ProfileEvent& event,
+                                HardwareCounterStats* stats) {
+  const HardwareCounterValues values =
+      event.end_hardware_counters - event.begin_hardware_counters;
+  stats->cycles.UpdateStat(values.cycles);
+  stats->instructions.UpdateStat(values.instructions);
+  stats->l1d_read_misses.UpdateStat(values.l1d_read_misses);
+  stats->llc_misses.UpdateStat(values.llc_misses);
+}
+
 }  // namespace
 
 ProfileSummarizer::ProfileSummarizer(
@@ -144,6 +155,11 @@ void ProfileSummarizer::ProcessProfiles(
 
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, node_exec_time, 0 /*memory */);
+      if (event->has_hardware_counters) {
+        UpdateHardwareCounterStats(
+            *event,
+            &hardware_counter_stats_map_[subgraph_index][node_name_in_stats]);
+      }
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
@@ -169,6 +185,11 @@ void ProfileSummarizer::ProcessProfiles(
 
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, node_exec_time, 0 /*memory */);
+      if (event->has_hardware_counters) {
+        UpdateHardwareCounterStats(
+            *event,
+            &hardware_counter_stats_map_[subgraph_index][node_name_in_stats]);
+      }
     } else {
       // Note: a different stats_calculator could be used to record
       // non-op-invoke events so that these could be separated from
@@ -46,7 +46,8 @@ class ProfileSummarizer {
   // summary_formatter_.
   std::string GetOutputString() {
     return summary_formatter_->GetOutputString(
-        stats_calculator_map_, *delegate_stats_calculator_, subgraph_name_map_);
+        stats_calculator_map_, *delegate_stats_calculator_, subgraph_name_map_,
+        hardware_counter_stats_map_);
   }
 
   std::string GetShortSummary() {
@@ -71,6 +72,9 @@ class ProfileSummarizer {
 
   std::unique_ptr<tensorflow::StatsCalculator> delegate_stats_calculator_;
 
+  // Hardware counters of the operators, if recorded.
+  HardwareCounterStatsMap hardware_counter_stats_map_;
+
   // Summary formatter for customized output formats.
   std::shared_ptr<ProfileSummaryFormatter> summary_formatter_;
 
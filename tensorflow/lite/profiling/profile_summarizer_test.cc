@@ -149,6 +149,26 @@ TEST(ProfileSummarizerTest, InterpreterPlusProfilingDetails) {
       << output;
 }
 
+TEST(ProfileSummarizerTest, InterpreterPlusHardwareCounters) {
+  BufferedProfiler profiler(1024);
+  if (!profiler.EnableHardwareCounters()) {
+    GTEST_SKIP() << "Hardware counters are not supported.";
+  }
+  SimpleOpModel m;
+  m.Init(RegisterSimpleOp);
+  auto interpreter = m.GetInterpreter();
+  interpreter->SetProfiler(&profiler);
+  profiler.StartProfiling();
+  m.SetInputs(1, 2);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  profiler.StopProfiling();
+  ProfileSummarizer summarizer;
+  summarizer.ProcessProfiles(profiler.GetProfileEvents(), *interpreter);
+  auto output = summarizer.GetOutputString();
+  ASSERT_TRUE(output.find("Hardware counters per op") != std::string::npos)
+      << output;
+}
+
 // A simple test that performs `ADD` if condition is true, and `MUL` otherwise.
 // The computation is: `cond ? a + b : a * b`.
 class ProfileSummarizerIfOpTest : public subgraph_test_util::ControlFlowOpTest {
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <ios>
@@ -34,15 +35,63 @@ limitations under the License.
 
 namespace tflite {
 namespace profiling {
+namespace {
+
+void SetOpProfilingStat(const tensorflow::Stat<int64_t>& stat,
+                        OpProfilingStat* const op_profiling_stat) {
+  op_profiling_stat->set_first(stat.first());
+  op_profiling_stat->set_last(stat.newest());
+  op_profiling_stat->set_avg(stat.avg());
+  op_profiling_stat->set_stddev(stat.std_deviation());
+  op_profiling_stat->set_variance(stat.variance());
+  op_profiling_stat->set_min(stat.min());
+  op_profiling_stat->set_max(stat.max());
+  op_profiling_stat->set_sum(stat.sum());
+  op_profiling_stat->set_count(stat.count());
+}
+
+// Returns the details of `stats_calculator` with hardware counters, in run
+// order.
+std::vector<std::pair<const tensorflow::StatsCalculator::Detail*,
+                      const HardwareCounterStats*>>
+GetHardwareCounterDetails(
+    const std::map<std::string, tensorflow::StatsCalculator::Detail>& details,
+    const std::map<std::string, HardwareCounterStats>& hardware_counter_stats) {
+  std::vector<std::pair<const tensorflow::StatsCalculator::Detail*,
+                        const HardwareCounterStats*>>
+      result;
+  for (const auto& [name, stats] : hardware_counter_stats) {
+    const auto detail = details.find(name);
+    if (detail != details.end()) {
+      result.emplace_back(&detail->second, &stats);
+    }
+  }
+  std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) {
+    return a.first->run_order < b.first->run_order;
+  });
+  return result;
+}
+
+}  // namespace
 
 std::string ProfileSummaryDefaultFormatter::GetOutputString(
     const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
         stats_calculator_map,
     const tensorflow::StatsCalculator& delegate_stats_calculator,
     const std::map<uint32_t, std::string>& subgraph_name_map) const {
+  return GetOutputString(stats_calculator_map, delegate_stats_calculator,
+                         subgraph_name_map, HardwareCounterStatsMap());
+}
+
+std::string ProfileSummaryDefaultFormatter::GetOutputString(
+    const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
+        stats_calculator_map,
+    const tensorflow::StatsCalculator& delegate_stats_calculator,
+    const std::map<uint32_t, std::string>& subgraph_name_map,
+    const HardwareCounterStatsMap& hardware_counter_stats_map) const {
   return GenerateReport("profile", /*include_output_string*/ true,
                         stats_calculator_map, delegate_stats_calculator,
-                        subgraph_name_map);
+                        subgraph_name_map, hardware_counter_stats_map);
 }
 
 std::string ProfileSummaryDefaultFormatter::GetShortSummary(
@@ -52,7 +101,7 @@ std::string ProfileSummaryDefaultFormatter::GetShortSummary(
     const std::map<uint32_t, std::string>& subgraph_name_map) const {
   return GenerateReport("summary", /*include_output_string*/ false,
                         stats_calculator_map, delegate_stats_calculator,
-                        subgraph_name_map);
+                        subgraph_name_map, HardwareCounterStatsMap());
 }
 
 std::string ProfileSummaryDefaultFormatter::GenerateReport(
@@ -60,7 +109,8 @@ std::string ProfileSummaryDefaultFormatter::GenerateReport(
     const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
         stats_calculator_map,
     const tensorflow::StatsCalculator& delegate_stats_calculator,
-    const std::map<uint32_t, std::string>& subgraph_name_map) const {
+    const std::map<uint32_t, std::string>& subgraph_name_map,
+    const HardwareCounterStatsMap& hardware_counter_stats_map) const {
   std::stringstream stream;
   bool has_non_primary_graph =
       (stats_calculator_map.size() - stats_calculator_map.count(0)) > 0;
@@ -84,6 +134,12 @@ std::string ProfileSummaryDefaultFormatter::GenerateReport(
     }
     if (include_output_string) {
       stream << subgraph_stats->GetOutputString();
+      const auto hardware_counter_stats =
+          hardware_counter_stats_map.find(subgraph_index);
+      if (hardware_counter_stats != hardware_counter_stats_map.end()) {
+        stream << GenerateHardwareCounterReport(*subgraph_stats,
+                                                hardware_counter_stats->second);
+      }
     }
     if (subgraph_index != 0) {
       stream << "Subgraph (index: " << subgraph_index
@@ -103,6 +159,56 @@ std::string ProfileSummaryDefaultFormatter::GenerateReport(
   return stream.str();
 }
 
+std::string ProfileSummaryDefaultFormatter::GenerateHardwareCounterReport(
+    const tensorflow::StatsCalculator& stats_calculator,
+    const std::map<std::string, HardwareCounterStats>& hardware_counter_stats)
+    const {
+  const bool format_as_csv = GetStatSummarizerOptions().format_as_csv;
+  const auto details = stats_calculator.GetDetails();
+  std::stringstream stream;
+  stream << "============================== Hardware counters per op "
+            "=============================="
+         << std::endl;
+  if (format_as_csv) {
+    stream << "node type, avg cycles, avg instructions, IPC, "
+              "avg L1D read misses, avg LLC misses, name"
+           << std::endl;
+  } else {
+    stream << std::setw(24) << std::left << "[node type]" << std::setw(14)
+           << std::right << "[avg cycles]" << std::setw(14) << "[avg instrs]"
+           << std::setw(8) << "[IPC]" << std::setw(18) << "[avg L1D misses]"
+           << std::setw(18) << "[avg LLC misses]"
+           << "\t[Name]" << std::endl;
+  }
+  stream << std::setprecision(3);
+  for (const auto& [detail, stats] :
+       GetHardwareCounterDetails(details, hardware_counter_stats)) {
+    const int64_t cycles = stats->cycles.avg();
+    const int64_t instructions = stats->instructions.avg();
+    const int64_t l1d_read_misses = stats->l1d_read_misses.avg();
+    const int64_t llc_misses = stats->llc_misses.avg();
+    const double ipc = stats->cycles.sum() == 0
+                           ? 0.0
+                           : static_cast<double>(stats->instructions.sum()) /
+                                 stats->cycles.sum();
+    if (format_as_csv) {
+      std::string name(detail->name);
+      std::replace(name.begin(), name.end(), ',', '\t');
+      stream << detail->type << ", " << cycles << ", " << instructions << ", "
+             << ipc << ", " << l1d_read_misses << ", " << llc_misses << ", "
+             << name << std::endl;
+    } else {
+      stream << std::setw(24) << std::left << detail->type << std::right
+             << std::setw(14) << cycles << std::setw(14) << instructions
+             << std::setw(8) << ipc << std::setw(18) << l1d_read_misses
+             << std::setw(18) << llc_misses << "\t" << detail->name
+             << std::endl;
+    }
+  }
+  stream << std::endl;
+  return stream.str();
+}
+
 void ProfileSummaryDefaultFormatter::HandleOutput(
     const std::string& init_output, const std::string& run_output,
     std::string output_file_path) const {
@@ -208,6 +314,7 @@ void ProfileSummaryProtoFormatter::GenerateOpProfileDataFromDetail(
 void ProfileSummaryProtoFormatter::GenerateSubGraphProfilingData(
     const tensorflow::StatsCalculator* stats_calculator, int subgraph_index,
     const std::map<uint32_t, std::string>& subgraph_name_map,
+    const HardwareCounterStatsMap& hardware_counter_stats_map,
     SubGraphProfilingData* const sub_graph_profiling_data) const {
   sub_graph_profiling_data->set_subgraph_index(subgraph_index);
 
@@ -223,6 +330,30 @@ void ProfileSummaryProtoFormatter::GenerateSubGraphProfilingData(
         sub_graph_profiling_data->add_per_op_profiles();
     GenerateOpProfileDataFromDetail(&detail, stats_calculator, op_profile_data);
   }
+
+  const auto hardware_counter_stats =
+      hardware_counter_stats_map.find(subgraph_index);
+  if (hardware_counter_stats == hardware_counter_stats_map.end()) {
+    return;
+  }
+  for (OpProfileData& op_profile_data :
+       *sub_graph_profiling_data->mutable_per_op_profiles()) {
+    const auto stats =
+        hardware_counter_stats->second.find(op_profile_data.name());
+    if (stats == hardware_counter_stats->second.end()) {
+      continue;
+    }
+    OpHardwareCounterData* const hardware_counters =
+        op_profile_data.mutable_hardware_counters();
+    SetOpProfilingStat(stats->second.cycles,
+                       hardware_counters->mutable_cpu_cycles());
+    SetOpProfilingStat(stats->second.instructions,
+                       hardware_counters->mutable_instructions());
+    SetOpProfilingStat(stats->second.l1d_read_misses,
+                       hardware_counters->mutable_l1d_read_misses());
+    SetOpProfilingStat(stats->second.llc_misses,
+                       hardware_counters->mutable_llc_misses());
+  }
 }
 
 void ProfileSummaryProtoFormatter::GenerateDelegateProfilingData(
@@ -250,6 +381,16 @@ std::string ProfileSummaryProtoFormatter::GetOutputString(
         stats_calculator_map,
     const tensorflow::StatsCalculator& delegate_stats_calculator,
     const std::map<uint32_t, std::string>& subgraph_name_map) const {
+  return GetOutputString(stats_calculator_map, delegate_stats_calculator,
+                         subgraph_name_map, HardwareCounterStatsMap());
+}
+
+std::string ProfileSummaryProtoFormatter::GetOutputString(
+    const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
+        stats_calculator_map,
+    const tensorflow::StatsCalculator& delegate_stats_calculator,
+    const std::map<uint32_t, std::string>& subgraph_name_map,
+    const HardwareCounterStatsMap& hardware_counter_stats_map) const {
   ModelProfilingData model_profiling_data;
   for (const auto& stats_calc : stats_calculator_map) {
     auto subgraph_index = stats_calc.first;
@@ -257,7 +398,8 @@ std::string ProfileSummaryProtoFormatter::GetOutputString(
     SubGraphProfilingData* const sub_graph_profiling_data =
         model_profiling_data.add_subgraph_profiles();
     GenerateSubGraphProfilingData(subgraph_stats, subgraph_index,
-                                  subgraph_name_map, sub_graph_profiling_data);
+                                  subgraph_name_map, hardware_counter_stats_map,
+                                  sub_graph_profiling_data);
   }
 
   if (delegate_stats_calculator.num_runs() > 0) {
@@ -33,6 +33,19 @@ limitations under the License.
 namespace tflite {
 namespace profiling {
 
+// The hardware counters of an operator, accumulated over its invocations.
+struct HardwareCounterStats {
+  tensorflow::Stat<int64_t> cycles;
+  tensorflow::Stat<int64_t> instructions;
+  tensorflow::Stat<int64_t> l1d_read_misses;
+  tensorflow::Stat<int64_t> llc_misses;
+};
+
+// Hardware counter stats per subgraph index, then per node name in the
+// StatsCalculator of the subgraph.
+using HardwareCounterStatsMap =
+    std::map<uint32_t, std::map<std::string, HardwareCounterStats>>;
+
 // Formats the profile summary in a certain way.
 class ProfileSummaryFormatter {
  public:
@@ -45,6 +58,17 @@ class ProfileSummaryFormatter {
           stats_calculator_map,
       const tensorflow::StatsCalculator& delegate_stats_calculator,
       const std::map<uint32_t, std::string>& subgraph_name_map) const = 0;
+  // Same as above, also detailing the hardware counters recorded per operator.
+  // Formatters that do not support hardware counters ignore them.
+  virtual std::string GetOutputString(
+      const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
+          stats_calculator_map,
+      const tensorflow::StatsCalculator& delegate_stats_calculator,
+      const std::map<uint32_t, std::string>& subgraph_name_map,
+      const HardwareCounterStatsMap& hardware_counter_stats_map) const {
+    return GetOutputString(stats_calculator_map, delegate_stats_calculator,
+                           subgraph_name_map);
+  }
   // Returns a string detailing the short summary of the accumulated runtime
   // stats in StatsCalculator of ProfileSummarizer.
   virtual std::string GetShortSummary(
@@ -68,6 +92,12 @@ class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
           stats_calculator_map,
       const tensorflow::StatsCalculator& delegate_stats_calculator,
       const std::map<uint32_t, std::string>& subgraph_name_map) const override;
+  std::string GetOutputString(
+      const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
+          stats_calculator_map,
+      const tensorflow::StatsCalculator& delegate_stats_calculator,
+      const std::map<uint32_t, std::string>& subgraph_name_map,
+      const HardwareCounterStatsMap& hardware_counter_stats_map) const override;
   std::string GetShortSummary(
       const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
           stats_calculator_map,
@@ -84,7 +114,13 @@ class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
       const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
           stats_calculator_map,
       const tensorflow::StatsCalculator& delegate_stats_calculator,
-      const std::map<uint32_t, std::string>& subgraph_name_map) const;
+      const std::map<uint32_t, std::string>& subgraph_name_map,
+      const HardwareCounterStatsMap& hardware_counter_stats_map) const;
+  // Returns the hardware counters of the ops of a subgraph, in run order.
+  std::string GenerateHardwareCounterReport(
+      const tensorflow::StatsCalculator& stats_calculator,
+      const std::map<std::string, HardwareCounterStats>& hardware_counter_stats)
+      const;
   void WriteOutput(const std::string& header, const std::string& data,
                    std::ostream* stream) const {
     (*stream) << header << std::endl;
@@ -105,6 +141,12 @@ class ProfileSummaryProtoFormatter : public ProfileSummaryFormatter {
           stats_calculator_map,
       const tensorflow::StatsCalculator& delegate_stats_calculator,
       const std::map<uint32_t, std::string>& subgraph_name_map) const override;
+  std::string GetOutputString(
+      const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
+          stats_calculator_map,
+      const tensorflow::StatsCalculator& delegate_stats_calculator,
+      const std::map<uint32_t, std::string>& subgraph_name_map,
+      const HardwareCounterStatsMap& hardware_counter_stats_map) const override;
   std::string GetShortSummary(
       const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
           stats_calculator_map,
@@ -125,6 +167,7 @@ class ProfileSummaryProtoFormatter : public ProfileSummaryFormatter {
   void GenerateSubGraphProfilingData(
       const tensorflow::StatsCalculator* stats_calculator, int subgraph_index,
       const std::map<uint32_t, std::string>& subgraph_name_map,
+      const HardwareCounterStatsMap& hardware_counter_stats_map,
       SubGraphProfilingData* sub_graph_profiling_data) const;
 
   void GenerateDelegateProfilingData(
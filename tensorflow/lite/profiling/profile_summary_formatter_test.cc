@@ -48,6 +48,22 @@ bool AreOpProfilingStatEqual(const OpProfilingStat& op_profiling_stat_1,
 }
 // LINT.ThenChange(//tensorflow/lite/profiling/proto/profiling_info.proto:OpProfilingStat)
 
+// LINT.IfChange(OpHardwareCounterDataComparator)
+bool AreOpHardwareCounterDataEqual(
+    const OpHardwareCounterData& op_hardware_counter_data_1,
+    const OpHardwareCounterData& op_hardware_counter_data_2) {
+  return AreOpProfilingStatEqual(op_hardware_counter_data_1.cpu_cycles(),
+                                 op_hardware_counter_data_2.cpu_cycles()) &&
+         AreOpProfilingStatEqual(op_hardware_counter_data_1.instructions(),
+                                 op_hardware_counter_data_2.instructions()) &&
+         AreOpProfilingStatEqual(
+             op_hardware_counter_data_1.l1d_read_misses(),
+             op_hardware_counter_data_2.l1d_read_misses()) &&
+         AreOpProfilingStatEqual(op_hardware_counter_data_1.llc_misses(),
+                                 op_hardware_counter_data_2.llc_misses());
+}
+// LINT.ThenChange(//tensorflow/lite/profiling/proto/profiling_info.proto:OpHardwareCounterData)
+
 // LINT.IfChange(OpProfileDataComparator)
 bool AreOpProfileDataEqual(const OpProfileData& op_profile_data_1,
                            const OpProfileData& op_profile_data_2) {
@@ -62,7 +78,11 @@ bool AreOpProfileDataEqual(const OpProfileData& op_profile_data_1,
          AreOpProfilingStatEqual(op_profile_data_1.inference_microseconds(),
                                  op_profile_data_2.inference_microseconds()) &&
          (AreOpProfilingStatEqual(op_profile_data_1.mem_kb(),
-                                  op_profile_data_2.mem_kb()));
+                                  op_profile_data_2.mem_kb())) &&
+         op_profile_data_1.has_hardware_counters() ==
+             op_profile_data_2.has_hardware_counters() &&
+         AreOpHardwareCounterDataEqual(op_profile_data_1.hardware_counters(),
+                                       op_profile_data_2.hardware_counters());
 }
 // LINT.ThenChange(//tensorflow/lite/profiling/proto/profiling_info.proto:OpProfileData)
 
@@ -525,6 +545,116 @@ TEST(SummaryWriterTest, DelegationShortSummary) {
   ASSERT_TRUE(absl::StrContains(output, "Delegate internal"));
 }
 
+TEST(SummaryWriterTest, HardwareCounterOutputStringForCSV) {
+  ProfileSummaryCSVFormatter writer;
+  std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>
+      stats_calculator_map;
+  stats_calculator_map[0] = std::make_unique<tensorflow::StatsCalculator>(
+      writer.GetStatSummarizerOptions());
+  stats_calculator_map[0]->AddNodeStats("[out]:1", "Reshape", 1, 10, 0);
+  stats_calculator_map[0]->AddNodeStats("[out]:0", "Convolution", 0, 20, 0);
+  stats_calculator_map[0]->UpdateRunTotalUs(30);
+  HardwareCounterStatsMap hardware_counter_stats_map;
+  for (const char* name : {"[out]:0", "[out]:1"}) {
+    HardwareCounterStats& stats = hardware_counter_stats_map[0][name];
+    stats.cycles.UpdateStat(1000);
+    stats.cycles.UpdateStat(3000);
+    stats.instructions.UpdateStat(4000);
+    stats.l1d_read_misses.UpdateStat(30);
+    stats.llc_misses.UpdateStat(2);
+  }
+
+  std::string output = writer.GetOutputString(
+      stats_calculator_map,
+      tensorflow::StatsCalculator(writer.GetStatSummarizerOptions()), {},
+      hardware_counter_stats_map);
+  ASSERT_TRUE(absl::StrContains(output, "Hardware counters per op"));
+  ASSERT_TRUE(absl::StrContains(
+      output,
+      "Convolution, 2000, 4000, 1, 30, 2, [out]:0\n"
+      "Reshape, 2000, 4000, 1, 30, 2, [out]:1\n"));
+
+  // Hardware counters are not part of the short summary.
+  output = writer.GetShortSummary(
+      stats_calculator_map,
+      tensorflow::StatsCalculator(writer.GetStatSummarizerOptions()), {});
+  ASSERT_TRUE(!absl::StrContains(output, "Hardware counters per op"));
+}
+
+TEST(SummaryWriterTest, HardwareCounterOutputStringForProto) {
+  ProfileSummaryProtoFormatter writer;
+  std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>
+      stats_calculator_map;
+  stats_calculator_map[0] = std::make_unique<tensorflow::StatsCalculator>(
+      writer.GetStatSummarizerOptions());
+  stats_calculator_map[0]->AddNodeStats("Kernel 1", "Convolution", 1, 10, 0);
+  stats_calculator_map[0]->AddNodeStats("Kernel 2", "Reshape", 2, 15, 0);
+  stats_calculator_map[0]->UpdateRunTotalUs(25);
+  HardwareCounterStatsMap hardware_counter_stats_map;
+  HardwareCounterStats& stats = hardware_counter_stats_map[0]["Kernel 1"];
+  stats.cycles.UpdateStat(1000);
+  stats.cycles.UpdateStat(3000);
+  stats.instructions.UpdateStat(4000);
+  stats.l1d_read_misses.UpdateStat(30);
+  stats.llc_misses.UpdateStat(2);
+
+  std::string output = writer.GetOutputString(
+      stats_calculator_map,
+      tensorflow::StatsCalculator(writer.GetStatSummarizerOptions()),
+      {{0, "Primary graph"}}, hardware_counter_stats_map);
+  ModelProfilingData model_profiling_data;
+  ASSERT_TRUE(model_profiling_data.ParseFromString(output));
+  ASSERT_EQ(model_profiling_data.subgraph_profiles().size(), 1);
+  const SubGraphProfilingData& subgraph_profile =
+      model_profiling_data.subgraph_profiles(0);
+  ASSERT_EQ(subgraph_profile.per_op_profiles().size(), 2);
+  ASSERT_EQ(subgraph_profile.per_op_profiles(0).name(), "Kernel 1");
+  ASSERT_TRUE(subgraph_profile.per_op_profiles(0).has_hardware_counters());
+  ASSERT_FALSE(subgraph_profile.per_op_profiles(1).has_hardware_counters());
+
+  OpHardwareCounterData expected;
+  OpProfilingStat* cycles = expected.mutable_cpu_cycles();
+  cycles->set_first(1000);
+  cycles->set_last(3000);
+  cycles->set_avg(2000);
+  cycles->set_stddev(1000);
+  cycles->set_variance(1000000);
+  cycles->set_min(1000);
+  cycles->set_max(3000);
+  cycles->set_sum(4000);
+  cycles->set_count(2);
+  for (OpProfilingStat* stat :
+       {expected.mutable_instructions(), expected.mutable_l1d_read_misses(),
+        expected.mutable_llc_misses()}) {
+    stat->set_count(1);
+    stat->set_stddev(0);
+    stat->set_variance(0);
+  }
+  OpProfilingStat* instructions = expected.mutable_instructions();
+  instructions->set_first(4000);
+  instructions->set_last(4000);
+  instructions->set_avg(4000);
+  instructions->set_min(4000);
+  instructions->set_max(4000);
+  instructions->set_sum(4000);
+  OpProfilingStat* l1d_read_misses = expected.mutable_l1d_read_misses();
+  l1d_read_misses->set_first(30);
+  l1d_read_misses->set_last(30);
+  l1d_read_misses->set_avg(30);
+  l1d_read_misses->set_min(30);
+  l1d_read_misses->set_max(30);
+  l1d_read_misses->set_sum(30);
+  OpProfilingStat* llc_misses = expected.mutable_llc_misses();
+  llc_misses->set_first(2);
+  llc_misses->set_last(2);
+  llc_misses->set_avg(2);
+  llc_misses->set_min(2);
+  llc_misses->set_max(2);
+  llc_misses->set_sum(2);
+  EXPECT_TRUE(AreOpHardwareCounterDataEqual(
+      subgraph_profile.per_op_profiles(0).hardware_counters(), expected));
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
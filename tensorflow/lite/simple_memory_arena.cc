@@ -284,11 +284,28 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::RestoreAllocs(
+    const std::vector<ArenaAllocWithUsageInterval>& allocs) {
+  for (const auto& alloc : allocs) {
+    if (alloc.size == 0) continue;
+    high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+    active_allocs_.push_back(alloc);
+  }
+  // Keeps the order of equal offsets that `Allocate` would have produced.
+  std::stable_sort(active_allocs_.begin(), active_allocs_.end());
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
   // based, they will remain valid in the new memory block.
-  *arena_reallocated = underlying_buffer_.Resize(high_water_mark_);
+  size_t new_size = high_water_mark_;
+  const size_t current_size = underlying_buffer_.GetSize();
+  if (growth_factor_ > 1.0f && current_size > 0 && new_size > current_size) {
+    new_size = std::max(
+        new_size, static_cast<size_t>(current_size * growth_factor_));
+  }
+  *arena_reallocated = underlying_buffer_.Resize(new_size);
   committed_ = true;
   return kTfLiteOk;
 }
@@ -107,9 +107,14 @@ class ResizableAlignedBuffer {
 // zero-sized allocations are explicitly allowed, and will resolve to null.
 class SimpleMemoryArena {
  public:
-  explicit SimpleMemoryArena(size_t arena_alignment, int subgraph_index = 0)
+  // When the committed buffer has to grow, it is grown to at least
+  // `growth_factor` times its current size, so that later growth is less
+  // likely to reallocate it.
+  explicit SimpleMemoryArena(size_t arena_alignment, int subgraph_index = 0,
+                             float growth_factor = 1.0f)
       : committed_(false),
         high_water_mark_(0),
+        growth_factor_(growth_factor),
         underlying_buffer_(arena_alignment, subgraph_index),
         active_allocs_() {}
 
@@ -142,6 +147,11 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Adds allocs computed by earlier calls to `Allocate` with the same
+  // arguments, in the same order, since the last `ResetAllocs`. This gives the
+  // same result as repeating these calls without searching for gaps again.
+  void RestoreAllocs(const std::vector<ArenaAllocWithUsageInterval>& allocs);
+
   TfLiteStatus Commit(bool* arena_reallocated);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
@@ -184,6 +194,7 @@ class SimpleMemoryArena {
  private:
   bool committed_;
   size_t high_water_mark_;
+  float growth_factor_;
   ResizableAlignedBuffer underlying_buffer_;
   std::vector<ArenaAllocWithUsageInterval> active_allocs_;
 };
@@ -121,6 +121,59 @@ TEST(SimpleMemoryArenaTest, TestClearPlan) {
   EXPECT_EQ(allocs[8].offset, 8192);
 }
 
+TEST(SimpleMemoryArenaTest, RestoreAllocs) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64);
+  ArenaAllocWithUsageInterval allocs[6];
+
+  arena.Allocate(&context, 32, 2047, 0, 1, 3, &allocs[0]);
+  arena.Allocate(&context, 32, 2047, 1, 2, 5, &allocs[1]);
+  arena.Allocate(&context, 32, 0, 2, 3, 6, &allocs[2]);
+
+  // Restoring the first allocs places the following ones as before.
+  SimpleMemoryArena restored(64);
+  restored.RestoreAllocs({allocs[0], allocs[1], allocs[2]});
+  arena.Allocate(&context, 32, 2047, 3, 3, 6, &allocs[3]);
+  restored.Allocate(&context, 32, 2047, 3, 3, 6, &allocs[4]);
+  EXPECT_EQ(allocs[3].offset, 4096);
+  EXPECT_EQ(allocs[4].offset, allocs[3].offset);
+
+  bool reallocated = false;
+  ASSERT_EQ(restored.Commit(&reallocated), kTfLiteOk);
+  EXPECT_EQ(restored.GetBufferSize(), 4096 + 2047);
+}
+
+TEST(SimpleMemoryArenaTest, GrowthFactor) {
+  TfLiteContext context;
+  SimpleMemoryArena arena(64, /*subgraph_index=*/0, /*growth_factor=*/2.0f);
+  ArenaAllocWithUsageInterval alloc;
+  bool reallocated = false;
+
+  // The first commit allocates what is needed.
+  arena.Allocate(&context, 32, 1024, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_EQ(arena.GetBufferSize(), 1024);
+
+  // Growing reserves twice the previous size.
+  arena.ClearPlan();
+  arena.Allocate(&context, 32, 1100, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_EQ(arena.GetBufferSize(), 2048);
+
+  // So growing again within the reserve does not reallocate.
+  arena.ClearPlan();
+  arena.Allocate(&context, 32, 2000, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_FALSE(reallocated);
+  EXPECT_EQ(arena.GetBufferSize(), 2048);
+
+  // Unless the growth is larger than the factor.
+  arena.ClearPlan();
+  arena.Allocate(&context, 32, 8192, 0, 0, 2, &alloc);
+  ASSERT_EQ(arena.Commit(&reallocated), kTfLiteOk);
+  EXPECT_EQ(arena.GetBufferSize(), 8192);
+}
+
 TEST(SimpleMemoryArenaTest, TestPurgeAllocs) {
   TfLiteContext context;
   context.ReportError = ReportError;
@@ -0,0 +1,331 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_model.h"
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Holds back the measured runs of all instances until every instance is ready.
+class StartBarrier {
+ public:
+  explicit StartBarrier(int num_instances) : num_pending_(num_instances) {}
+
+  void ArriveAndWait() {
+    std::unique_lock<std::mutex> lock(mu_);
+    if (--num_pending_ == 0) {
+      cv_.notify_all();
+      return;
+    }
+    cv_.wait(lock, [this] { return num_pending_ <= 0; });
+  }
+
+  // Called by instances that fail before reaching the barrier.
+  void Arrive() {
+    std::unique_lock<std::mutex> lock(mu_);
+    if (--num_pending_ == 0) cv_.notify_all();
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  int num_pending_;
+};
+
+// Records the latency of every measured run of one instance.
+class ConcurrentRunListener : public BenchmarkListener {
+ public:
+  explicit ConcurrentRunListener(StartBarrier* barrier) : barrier_(barrier) {}
+
+  void OnBenchmarkStart(const BenchmarkParams& params) override {
+    arrived_ = true;
+    barrier_->ArriveAndWait();
+  }
+
+  void OnSingleRunStart(RunType run_type) override {
+    measuring_ = run_type == REGULAR;
+    run_start_us_ = profiling::time::NowMicros();
+    if (measuring_ && first_start_us_ == 0) first_start_us_ = run_start_us_;
+  }
+
+  void OnSingleRunEnd() override {
+    if (!measuring_) return;
+    last_end_us_ = profiling::time::NowMicros();
+    latencies_us_.push_back(last_end_us_ - run_start_us_);
+  }
+
+  void ArriveIfNeeded() {
+    if (!arrived_) barrier_->Arrive();
+  }
+
+  std::vector<int64_t>* latencies_us() { return &latencies_us_; }
+  int64_t first_start_us() const { return first_start_us_; }
+  int64_t last_end_us() const { return last_end_us_; }
+
+ private:
+  StartBarrier* const barrier_;
+  bool arrived_ = false;
+  bool measuring_ = false;
+  int64_t run_start_us_ = 0;
+  int64_t first_start_us_ = 0;
+  int64_t last_end_us_ = 0;
+  std::vector<int64_t> latencies_us_;
+};
+
+// Pins the calling thread to `cpus`. Threads created afterwards by the
+// interpreter, e.g. its CPU backend pool, inherit the affinity.
+bool SetCurrentThreadAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__) || defined(__ANDROID__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted_values,
+                   double fraction) {
+  if (sorted_values.empty()) return 0;
+  const size_t index = std::min(
+      sorted_values.size() - 1,
+      static_cast<size_t>(fraction * sorted_values.size()));
+  return sorted_values[index];
+}
+
+}  // namespace
+
+bool ParseCpuList(const std::string& cpu_list, std::vector<int>* cpus) {
+  std::vector<std::string> ranges;
+  if (!util::SplitAndParse(cpu_list, ',', &ranges)) return false;
+  for (const std::string& range : ranges) {
+    int first, last;
+    char dash;
+    std::istringstream input(range);
+    if (!(input >> first)) return false;
+    last = first;
+    if (input >> dash) {
+      if (dash != '-' || !(input >> last)) return false;
+    }
+    if (first < 0 || last < first) return false;
+    for (int cpu = first; cpu <= last; ++cpu) cpus->push_back(cpu);
+  }
+  return !cpus->empty();
+}
+
+BenchmarkMultiModel::BenchmarkMultiModel() : params_(DefaultParams()) {}
+
+BenchmarkParams BenchmarkMultiModel::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("graphs", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("num_instances", BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("run_frequencies", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("cpu_affinity", BenchmarkParam::Create<std::string>(""));
+  return params;
+}
+
+std::vector<Flag> BenchmarkMultiModel::GetFlags() {
+  return {
+      CreateFlag<std::string>(
+          "graphs", &params_,
+          "A comma-separated list of models to run concurrently. All other "
+          "single-model flags apply to every model."),
+      CreateFlag<int32_t>("num_instances", &params_,
+                          "Number of concurrent instances of each model."),
+      CreateFlag<std::string>(
+          "run_frequencies", &params_,
+          "A comma-separated list of the arrival rates of each model in runs "
+          "per second, overriding --run_frequency. Each instance of a model "
+          "runs at this rate."),
+      CreateFlag<std::string>(
+          "cpu_affinity", &params_,
+          "A ';'-separated list of CPU lists, e.g. '0-3;4-7', assigned to the "
+          "instances in turn. Each instance and the threads of its "
+          "interpreter are pinned to its CPU list. Linux and Android only."),
+  };
+}
+
+TfLiteStatus BenchmarkMultiModel::ParseFlags(int* argc, char** argv) {
+  auto flag_list = GetFlags();
+  const bool parse_result =
+      Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
+  if (!parse_result) {
+    std::string usage = Flags::Usage(argv[0], flag_list);
+    TFLITE_LOG(ERROR) << usage;
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkMultiModel::Run(int argc, char** argv) {
+  TF_LITE_ENSURE_STATUS(ParseFlags(&argc, argv));
+
+  std::vector<std::string> graphs;
+  std::vector<float> run_frequencies;
+  std::vector<std::string> cpu_lists;
+  if (!util::SplitAndParse(params_.Get<std::string>("graphs"), ',', &graphs) ||
+      graphs.empty()) {
+    TFLITE_LOG(ERROR) << "--graphs must list at least one model.";
+    return kTfLiteError;
+  }
+  if (!util::SplitAndParse(params_.Get<std::string>("run_frequencies"), ',',
+                           &run_frequencies) ||
+      (!run_frequencies.empty() && run_frequencies.size() != graphs.size())) {
+    TFLITE_LOG(ERROR) << "--run_frequencies must have one rate per model.";
+    return kTfLiteError;
+  }
+  util::SplitAndParse(params_.Get<std::string>("cpu_affinity"), ';',
+                      &cpu_lists);
+  std::vector<std::vector<int>> cpu_sets(cpu_lists.size());
+  for (size_t i = 0; i < cpu_lists.size(); ++i) {
+    if (!ParseCpuList(cpu_lists[i], &cpu_sets[i])) {
+      TFLITE_LOG(ERROR) << "Invalid CPU list in --cpu_affinity: "
+                        << cpu_lists[i];
+      return kTfLiteError;
+    }
+  }
+  const int num_instances = params_.Get<int32_t>("num_instances");
+  if (num_instances < 1) {
+    TFLITE_LOG(ERROR) << "--num_instances must be positive.";
+    return kTfLiteError;
+  }
+
+  // Every instance parses the remaining single-model flags on its own copy of
+  // argv, since parsing removes the flags it recognizes.
+  struct Instance {
+    std::string graph;
+    int index;
+    std::unique_ptr<BenchmarkTfLiteModel> model;
+    std::unique_ptr<ConcurrentRunListener> listener;
+    TfLiteStatus status = kTfLiteOk;
+  };
+  const int total_instances = graphs.size() * num_instances;
+  StartBarrier barrier(total_instances);
+  std::vector<Instance> instances(total_instances);
+  for (int i = 0; i < total_instances; ++i) {
+    Instance& instance = instances[i];
+    const int graph_index = i / num_instances;
+    instance.graph = graphs[graph_index];
+    instance.index = i % num_instances;
+    instance.model = std::make_unique<BenchmarkTfLiteModel>();
+    std::vector<char*> instance_argv(argv, argv + argc);
+    int instance_argc = argc;
+    TF_LITE_ENSURE_STATUS(
+        instance.model->ParseFlags(&instance_argc, instance_argv.data()));
+    BenchmarkParams* params = instance.model->mutable_params();
+    params->Set<std::string>("graph", instance.graph);
+    if (!run_frequencies.empty()) {
+      params->Set<float>("run_frequency", run_frequencies[graph_index]);
+    }
+    instance.listener = std::make_unique<ConcurrentRunListener>(&barrier);
+    instance.model->AddListener(instance.listener.get());
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(total_instances);
+  for (int i = 0; i < total_instances; ++i) {
+    threads.emplace_back([&, i] {
+      Instance& instance = instances[i];
+      if (!cpu_sets.empty() &&
+          !SetCurrentThreadAffinity(cpu_sets[i % cpu_sets.size()])) {
+        TFLITE_LOG(WARN) << "Failed to set the CPU affinity of instance "
+                         << instance.index << " of " << instance.graph;
+      }
+      instance.status = instance.model->Run();
+      instance.listener->ArriveIfNeeded();
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  TfLiteStatus status = kTfLiteOk;
+  int64_t total_runs = 0;
+  int64_t start_us = std::numeric_limits<int64_t>::max();
+  int64_t end_us = 0;
+  results_.clear();
+  for (Instance& instance : instances) {
+    if (instance.status != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Instance " << instance.index << " of "
+                        << instance.graph << " failed.";
+      status = kTfLiteError;
+      continue;
+    }
+    std::vector<int64_t>& latencies = *instance.listener->latencies_us();
+    if (latencies.empty()) continue;
+    std::sort(latencies.begin(), latencies.end());
+    InstanceResult result;
+    result.graph = instance.graph;
+    result.instance = instance.index;
+    result.num_runs = latencies.size();
+    int64_t sum_us = 0;
+    for (int64_t latency : latencies) sum_us += latency;
+    result.avg_us = static_cast<double>(sum_us) / latencies.size();
+    result.p50_us = Percentile(latencies, 0.5);
+    result.p90_us = Percentile(latencies, 0.9);
+    result.p99_us = Percentile(latencies, 0.99);
+    const int64_t elapsed_us = instance.listener->last_end_us() -
+                               instance.listener->first_start_us();
+    if (elapsed_us > 0) {
+      result.runs_per_second = 1e6 * latencies.size() / elapsed_us;
+    }
+    total_runs += latencies.size();
+    start_us = std::min(start_us, instance.listener->first_start_us());
+    end_us = std::max(end_us, instance.listener->last_end_us());
+    results_.push_back(result);
+  }
+  total_runs_per_second_ =
+      end_us > start_us ? 1e6 * total_runs / (end_us - start_us) : 0.0;
+
+  TFLITE_LOG(INFO) << "Concurrent benchmark of " << total_instances
+                   << " instances:";
+  for (const InstanceResult& result : results_) {
+    TFLITE_LOG(INFO) << result.graph << " #" << result.instance << ": "
+                     << result.num_runs << " runs, avg " << result.avg_us
+                     << "us, p50 " << result.p50_us << "us, p90 "
+                     << result.p90_us << "us, p99 " << result.p99_us
+                     << "us, " << result.runs_per_second << " runs/s";
+  }
+  TFLITE_LOG(INFO) << "Total throughput: " << total_runs_per_second_
+                   << " runs/s";
+  return status;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Benchmarks several models, or several instances of one model, running
+// concurrently on one host, so that their interference through shared caches,
+// memory bandwidth and oversubscribed threads shows up in the results.
+//
+// Every instance is a 'BenchmarkTfLiteModel' that runs on its own thread and
+// takes all the usual single-model flags. The measured runs of all instances
+// start together once every instance is initialized and warmed up.
+class BenchmarkMultiModel {
+ public:
+  // Latency and throughput of the measured runs of one instance.
+  struct InstanceResult {
+    std::string graph;
+    int instance = 0;
+    int64_t num_runs = 0;
+    double avg_us = 0.0;
+    int64_t p50_us = 0;
+    int64_t p90_us = 0;
+    int64_t p99_us = 0;
+    double runs_per_second = 0.0;
+  };
+
+  BenchmarkMultiModel();
+  virtual ~BenchmarkMultiModel() = default;
+
+  TfLiteStatus Run(int argc, char** argv);
+
+  const std::vector<InstanceResult>& results() const { return results_; }
+  // Measured runs of all instances per second of the concurrent phase.
+  double total_runs_per_second() const { return total_runs_per_second_; }
+
+ protected:
+  static BenchmarkParams DefaultParams();
+
+  // Unparsable flags will remain in 'argv' in the original order and 'argc'
+  // will be updated accordingly.
+  TfLiteStatus ParseFlags(int* argc, char** argv);
+  virtual std::vector<Flag> GetFlags();
+
+  BenchmarkParams params_;
+
+ private:
+  std::vector<InstanceResult> results_;
+  double total_runs_per_second_ = 0.0;
+};
+
+// Parses a CPU list such as "0-3,6" into the CPU indices it contains. Returns
+// false if the list is malformed.
+bool ParseCpuList(const std::string& cpu_list, std::vector<int>* cpus);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTI_MODEL_H_
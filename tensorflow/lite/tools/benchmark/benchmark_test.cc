@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_multi_model.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_performance_options.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
@@ -546,6 +547,44 @@ TEST(BenchmarkTest, RunWithUseCaching) {
   EXPECT_EQ(kTfLiteOk, status);
 }
 
+TEST(BenchmarkTest, MultiModelRunsInstancesConcurrently) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  ASSERT_THAT(g_int8_model_path, testing::NotNull());
+  BenchmarkMultiModel benchmark;
+  ScopedCommandlineArgs scoped_argv(
+      {"--graphs=" + *g_fp32_model_path + "," + *g_int8_model_path,
+       "--num_instances=2", "--num_runs=10", "--min_secs=0",
+       "--warmup_runs=1", "--num_threads=1"});
+  EXPECT_EQ(kTfLiteOk, benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+  ASSERT_EQ(4, benchmark.results().size());
+  for (const auto& result : benchmark.results()) {
+    EXPECT_GE(result.num_runs, 10);
+    EXPECT_LE(result.p50_us, result.p99_us);
+  }
+  EXPECT_EQ(*g_fp32_model_path, benchmark.results()[0].graph);
+  EXPECT_EQ(*g_int8_model_path, benchmark.results()[3].graph);
+  EXPECT_GT(benchmark.total_runs_per_second(), 0);
+}
+
+TEST(BenchmarkTest, MultiModelRejectsMismatchedRunFrequencies) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  BenchmarkMultiModel benchmark;
+  ScopedCommandlineArgs scoped_argv(
+      {"--graphs=" + *g_fp32_model_path, "--run_frequencies=10,20"});
+  EXPECT_EQ(kTfLiteError,
+            benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+}
+
+TEST(BenchmarkTest, ParseCpuList) {
+  std::vector<int> cpus;
+  EXPECT_TRUE(ParseCpuList("0-2,5", &cpus));
+  EXPECT_THAT(cpus, testing::ElementsAre(0, 1, 2, 5));
+  cpus.clear();
+  EXPECT_FALSE(ParseCpuList("3-1", &cpus));
+  cpus.clear();
+  EXPECT_FALSE(ParseCpuList("a", &cpus));
+}
+
 class MaxDurationWorksTestListener : public BenchmarkListener {
   void OnBenchmarkEnd(const BenchmarkResults& results) override {
     const int64_t num_actual_runs = results.inference_time_us().count();
@@ -50,11 +50,13 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/kernel_selection.h"
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/optional_debug_tools.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/benchmark/kernel_selection_tuner.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
 #include "tensorflow/lite/tools/logging.h"
@@ -570,6 +572,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("enable_op_hardware_counters",
+                          BenchmarkParam::Create<bool>(false));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -583,6 +587,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("enable_builtin_cast_constant_cache",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("kernel_selection_file",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("kernel_selection_tuning_output_file",
+                          BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("output_filepath",
                           BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("output_proto_filepath",
@@ -667,6 +675,10 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
                               "op_profiling_output_mode instead] File path to "
                               "export profile data as CSV, if not set "
                               "prints to stdout."),
+      CreateFlag<bool>("enable_op_hardware_counters", &params_,
+                       "record the CPU cycles, instructions and cache misses "
+                       "of each op when op profiling is enabled. Only "
+                       "supported on Linux and Android."),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -688,6 +700,15 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "enable_builtin_cast_constant_cache", &params_,
           "Cache the output of the builtin cast operation when its input "
           "is a constant tensor."),
+      CreateFlag<std::string>(
+          "kernel_selection_file", &params_,
+          "File holding the CPU kernel variant to use for each op, e.g. as "
+          "written by --kernel_selection_tuning_output_file."),
+      CreateFlag<std::string>(
+          "kernel_selection_tuning_output_file", &params_,
+          "If set, times the CPU kernel variants of the ops of the model "
+          "before benchmarking, writes the fastest variant of each op to this "
+          "file, and benchmarks the model with them."),
       CreateFlag<std::string>(
           "output_filepath", &params_,
           "File path to export outputs layer as binary data."),
@@ -758,6 +779,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(bool, "enable_op_hardware_counters",
+                      "Enable op hardware counters", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -770,6 +793,10 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Disable delegate clustering", verbose);
   LOG_BENCHMARK_PARAM(bool, "enable_builtin_cast_constant_cache",
                       "Constant CAST output cache", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "kernel_selection_file",
+                      "Kernel selection file", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "kernel_selection_tuning_output_file",
+                      "Kernel selection tuning output file", verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_filepath",
                       "File path to export outputs layer to", verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_proto_filepath",
@@ -985,8 +1012,44 @@ TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
   return kTfLiteOk;
 }
 
+TfLiteStatus BenchmarkTfLiteModel::InitKernelSelection() {
+  const std::string tuning_output_file =
+      params_.Get<std::string>("kernel_selection_tuning_output_file");
+  if (!tuning_output_file.empty()) {
+    KernelSelectionTuner::Options options;
+    options.num_threads = params_.Get<int32_t>("num_threads");
+    KernelSelectionTuner tuner(
+        *model_, [this]() { return GetOpResolver(); }, options);
+    TF_LITE_ENSURE_STATUS(tuner.Tune(&kernel_selection_));
+    std::ofstream ofs(tuning_output_file, std::ofstream::out);
+    if (!ofs) {
+      TFLITE_LOG(ERROR) << "Failed to open " << tuning_output_file;
+      return kTfLiteError;
+    }
+    ofs << tuner.ToString(kernel_selection_);
+    TFLITE_LOG(INFO) << "Wrote the kernel selection to " << tuning_output_file;
+    return kTfLiteOk;
+  }
+
+  const std::string selection_file =
+      params_.Get<std::string>("kernel_selection_file");
+  if (selection_file.empty()) return kTfLiteOk;
+  std::ifstream ifs(selection_file);
+  if (!ifs) {
+    TFLITE_LOG(ERROR) << "Failed to open " << selection_file;
+    return kTfLiteError;
+  }
+  std::stringstream table;
+  table << ifs.rdbuf();
+  return ops::builtin::ParseKernelSelection(table.str(), &kernel_selection_);
+}
+
 TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
   auto resolver = GetOpResolver();
+  if (!kernel_selection_.empty()) {
+    resolver = std::make_unique<ops::builtin::KernelSelectionOpResolver>(
+        std::move(resolver), kernel_selection_);
+  }
   const int32_t num_threads = params_.Get<int32_t>("num_threads");
   const bool use_caching = params_.Get<bool>("use_caching");
 
@@ -1029,6 +1092,7 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
 
 TfLiteStatus BenchmarkTfLiteModel::Init() {
   TF_LITE_ENSURE_STATUS(LoadModel());
+  TF_LITE_ENSURE_STATUS(InitKernelSelection());
   TF_LITE_ENSURE_STATUS(InitInterpreter());
 
   if (params_.Get<bool>("list_signatures")) {
@@ -1254,7 +1318,8 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
       params_.Get<bool>("allow_dynamic_profiling_buffer_increase"),
       params_.Get<std::string>("op_profiling_output_file"),
       CreateProfileSummaryFormatter(
-          params_.Get<std::string>("op_profiling_output_mode"))));
+          params_.Get<std::string>("op_profiling_output_mode")),
+      params_.Get<bool>("enable_op_hardware_counters")));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() {
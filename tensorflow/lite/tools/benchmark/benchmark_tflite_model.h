@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "tensorflow/lite/core/model.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/kernels/kernel_selection.h"
 #include "tensorflow/lite/profiling/profiler.h"
 #include "tensorflow/lite/signature_runner.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -183,6 +184,9 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   // Allow subclass to initialize a customized tflite interpreter.
   virtual TfLiteStatus InitInterpreter();
 
+  // Reads or tunes the kernel selection that InitInterpreter applies, if any.
+  TfLiteStatus InitKernelSelection();
+
   // Create a BenchmarkListener that's specifically for TFLite profiling if
   // necessary.
   virtual std::unique_ptr<BenchmarkListener> MayCreateProfilingListener() const;
@@ -198,6 +202,7 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::unique_ptr<tflite::Interpreter> interpreter_;
   std::unique_ptr<BenchmarkInterpreterRunner> interpreter_runner_;
   std::unique_ptr<tflite::ExternalCpuBackendContext> external_context_;
+  ops::builtin::KernelSelection kernel_selection_;
 
  private:
   utils::InputTensorData CreateRandomTensorData(
@@ -0,0 +1,199 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/kernel_selection_tuner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/kernel_selection.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+
+using ops::builtin::GetKernelVariants;
+using ops::builtin::kDefaultKernelVariant;
+using ops::builtin::KernelSelection;
+using ops::builtin::KernelSelectionOpResolver;
+using ops::builtin::KernelVariant;
+
+KernelSelectionTuner::KernelSelectionTuner(
+    const FlatBufferModel& model,
+    std::function<std::unique_ptr<OpResolver>()> create_base_resolver,
+    const Options& options)
+    : model_(model),
+      create_base_resolver_(std::move(create_base_resolver)),
+      options_(options) {}
+
+TfLiteStatus KernelSelectionTuner::TimeNodes(
+    const KernelSelection& selection) {
+  KernelSelectionOpResolver resolver(create_base_resolver_(), selection);
+  // Declared before the interpreter, which must not outlive it.
+  std::unique_ptr<profiling::BufferedProfiler> profiler;
+  std::unique_ptr<Interpreter> interpreter;
+  InterpreterBuilder builder(model_, resolver);
+  if (builder.SetNumThreads(options_.num_threads) != kTfLiteOk ||
+      builder(&interpreter) != kTfLiteOk || !interpreter ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to initialize the interpreter for tuning.";
+    return kTfLiteError;
+  }
+  for (int input : interpreter->inputs()) {
+    TfLiteTensor* tensor = interpreter->tensor(input);
+    if (tensor->type != kTfLiteString && tensor->data.raw != nullptr) {
+      std::memset(tensor->data.raw, 0, tensor->bytes);
+    }
+  }
+
+  if (node_timings_.empty()) {
+    // Delegated nodes are replaced by delegate kernels in the execution plan.
+    for (int i = 0; i < interpreter->subgraphs_size(); ++i) {
+      Subgraph* subgraph = interpreter->subgraph(i);
+      for (int node_index : subgraph->execution_plan()) {
+        const auto op = static_cast<BuiltinOperator>(
+            subgraph->node_and_registration(node_index)->second.builtin_code);
+        if (!GetKernelVariants(op).empty()) {
+          node_timings_.push_back({i, node_index, op, {}});
+        }
+      }
+    }
+  }
+
+  int total_nodes = 0;
+  for (int i = 0; i < interpreter->subgraphs_size(); ++i) {
+    total_nodes += static_cast<int>(interpreter->subgraph(i)->nodes_size());
+  }
+  profiler = std::make_unique<profiling::BufferedProfiler>(
+      total_nodes * options_.num_runs,
+      /*allow_dynamic_buffer_increase=*/true);
+  interpreter->SetProfiler(profiler.get());
+  for (int i = 0; i < options_.num_warmup_runs; ++i) {
+    TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+  }
+  profiler->StartProfiling();
+  for (int i = 0; i < options_.num_runs; ++i) {
+    TF_LITE_ENSURE_STATUS(interpreter->Invoke());
+  }
+  profiler->StopProfiling();
+
+  // Indexed by the subgraph index and the node index.
+  std::map<std::pair<int64_t, int64_t>, uint64_t> total_time_us;
+  for (const profiling::ProfileEvent* event : profiler->GetProfileEvents()) {
+    if (event->event_type ==
+        profiling::ProfileEvent::EventType::OPERATOR_INVOKE_EVENT) {
+      total_time_us[{event->extra_event_metadata, event->event_metadata}] +=
+          event->elapsed_time;
+    }
+  }
+  interpreter->SetProfiler(nullptr);
+
+  for (NodeKernelTimings& timings : node_timings_) {
+    const auto it = total_time_us.find(
+        {timings.subgraph_index, timings.node_index});
+    // Nodes of subgraphs that are not run, e.g. the untaken branch of an IF.
+    if (it == total_time_us.end()) continue;
+    const auto selected = selection.find(timings.op);
+    if (selected == selection.end() && !selection.empty()) continue;
+    const std::string& variant_name =
+        selected == selection.end() ? kDefaultKernelVariant : selected->second;
+    timings.average_time_us[variant_name] =
+        static_cast<double>(it->second) / options_.num_runs;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus KernelSelectionTuner::Tune(KernelSelection* selection) {
+  node_timings_.clear();
+  TF_LITE_ENSURE_STATUS(TimeNodes(KernelSelection()));
+
+  // Nodes are timed independently, so each run times one variant of every op
+  // at once, instead of one variant of one op.
+  std::map<BuiltinOperator, const std::vector<KernelVariant>*> tuned_ops;
+  size_t max_num_variants = 0;
+  for (const NodeKernelTimings& timings : node_timings_) {
+    const auto& variants = GetKernelVariants(timings.op);
+    tuned_ops[timings.op] = &variants;
+    max_num_variants = std::max(max_num_variants, variants.size());
+  }
+  for (size_t i = 0; i < max_num_variants; ++i) {
+    KernelSelection variant_selection;
+    for (const auto& [op, variants] : tuned_ops) {
+      if (i < variants->size()) variant_selection[op] = (*variants)[i].name;
+    }
+    if (TimeNodes(variant_selection) == kTfLiteOk) continue;
+    // Some variants do not support every node, e.g. their input types. Time
+    // the ops one by one to skip only the unsupported variants.
+    for (const auto& [op, variant_name] : variant_selection) {
+      if (TimeNodes({{op, variant_name}}) != kTfLiteOk) {
+        TFLITE_LOG(WARN) << "Skipping kernel variant " << variant_name
+                         << " of " << EnumNameBuiltinOperator(op) << ".";
+      }
+    }
+  }
+
+  std::map<BuiltinOperator, std::map<std::string, double>> op_time_us;
+  for (const NodeKernelTimings& timings : node_timings_) {
+    for (const auto& [variant_name, time_us] : timings.average_time_us) {
+      op_time_us[timings.op][variant_name] += time_us;
+    }
+  }
+  for (const auto& [op, variant_times] : op_time_us) {
+    const std::string* fastest = nullptr;
+    double fastest_time_us = 0;
+    for (const auto& [variant_name, time_us] : variant_times) {
+      if (fastest == nullptr || time_us < fastest_time_us) {
+        fastest = &variant_name;
+        fastest_time_us = time_us;
+      }
+    }
+    (*selection)[op] = *fastest;
+  }
+  return kTfLiteOk;
+}
+
+std::string KernelSelectionTuner::ToString(
+    const KernelSelection& selection) const {
+  std::ostringstream table;
+  table << "# Kernel selection tuned with num_threads="
+        << options_.num_threads << ". Average time per node:\n";
+  for (const NodeKernelTimings& timings : node_timings_) {
+    table << "# " << EnumNameBuiltinOperator(timings.op) << " node "
+          << timings.node_index << " (subgraph " << timings.subgraph_index
+          << "):";
+    for (const auto& [variant_name, time_us] : timings.average_time_us) {
+      table << " " << variant_name << "=" << time_us << "us";
+    }
+    table << "\n";
+  }
+  table << ops::builtin::KernelSelectionToString(selection);
+  return table.str();
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_KERNEL_SELECTION_TUNER_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_KERNEL_SELECTION_TUNER_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/kernels/kernel_selection.h"
+#include "tensorflow/lite/op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Average execution time of a node with each kernel variant of its op.
+struct NodeKernelTimings {
+  int subgraph_index;
+  int node_index;
+  BuiltinOperator op;
+  // Indexed by the name of the kernel variant, including
+  // `kDefaultKernelVariant`.
+  std::map<std::string, double> average_time_us;
+};
+
+// Times the kernel variants of the ops of a model on the current device, and
+// selects the fastest variant of each op.
+//
+// Each node whose op has kernel variants is timed with every variant, by
+// profiling a few runs of the model with zero-filled inputs. An op resolver
+// can only choose one kernel per op, so the variant selected for an op is the
+// one minimizing the total time of all the nodes of this op. Nodes that are
+// delegated, e.g. to XNNPack, are not tuned.
+class KernelSelectionTuner {
+ public:
+  struct Options {
+    int num_threads = -1;
+    int num_warmup_runs = 1;
+    int num_runs = 10;
+  };
+
+  // `create_base_resolver` creates the op resolver the selection applies to.
+  KernelSelectionTuner(
+      const FlatBufferModel& model,
+      std::function<std::unique_ptr<OpResolver>()> create_base_resolver,
+      const Options& options);
+
+  // Times the kernel variants, and selects the fastest variant of each op into
+  // `selection`.
+  TfLiteStatus Tune(ops::builtin::KernelSelection* selection);
+
+  // The timings of the last call to `Tune`.
+  const std::vector<NodeKernelTimings>& node_timings() const {
+    return node_timings_;
+  }
+
+  // Returns the table of `selection`, in the format of
+  // `ops::builtin::ParseKernelSelection`, with the timings of each node as
+  // comments.
+  std::string ToString(const ops::builtin::KernelSelection& selection) const;
+
+ private:
+  // Runs the model with the kernel variants of `selection`, and records the
+  // average execution time of the nodes of the selected ops in
+  // `node_timings_`. If `node_timings_` is empty, it is first filled with the
+  // nodes to tune.
+  TfLiteStatus TimeNodes(const ops::builtin::KernelSelection& selection);
+
+  const FlatBufferModel& model_;
+  std::function<std::unique_ptr<OpResolver>()> create_base_resolver_;
+  const Options options_;
+  std::vector<NodeKernelTimings> node_timings_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_KERNEL_SELECTION_TUNER_H_
@@ -31,7 +31,8 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_initial_entries,
     bool allow_dynamic_buffer_increase, const std::string& output_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    bool enable_hardware_counters)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       output_file_path_(output_file_path),
@@ -40,6 +41,10 @@ ProfilingListener::ProfilingListener(
       summarizer_formatter_(summarizer_formatter) {
   TFLITE_TOOLS_CHECK(interpreter);
   interpreter_->SetProfiler(&profiler_);
+  if (enable_hardware_counters && !profiler_.EnableHardwareCounters()) {
+    TFLITE_LOG(WARN) << "Hardware counters are not supported on this "
+                        "platform, or not accessible to this process.";
+  }
 
   // We start profiling here in order to catch events that are recorded during
   // the benchmark run preparation stage where TFLite interpreter is
@@ -29,7 +29,9 @@ limitations under the License.
 namespace tflite {
 namespace benchmark {
 
-// Dumps profiling events if profiling is enabled.
+// Dumps profiling events if profiling is enabled. If
+// `enable_hardware_counters` is true, the CPU hardware counters of each op are
+// dumped too, on platforms supporting them.
 class ProfilingListener : public BenchmarkListener {
  public:
   ProfilingListener(
@@ -37,7 +39,8 @@ class ProfilingListener : public BenchmarkListener {
       bool allow_dynamic_buffer_increase,
       const std::string& output_file_path = "",
       std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
-          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>(),
+      bool enable_hardware_counters = false);
 
   void OnBenchmarkStart(const BenchmarkParams& params) override;
 
@@ -0,0 +1,70 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Binary adding an offline memory plan to a TFLite flatbuffer, see
+// planning_lib.h.
+#include <cstddef>
+#include <fstream>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/offline_memory_plan/planning_lib.h"
+
+namespace tflite {
+
+using ::flatbuffers::FlatBufferBuilder;
+
+constexpr char kInputFlatbufferFlag[] = "input_flatbuffer";
+constexpr char kOutputFlatbufferFlag[] = "output_flatbuffer";
+
+int Main(int argc, char* argv[]) {
+  std::string input_flatbuffer_path;
+  std::string output_flatbuffer_path;
+
+  std::vector<Flag> flag_list = {
+      tflite::Flag::CreateFlag(kInputFlatbufferFlag, &input_flatbuffer_path,
+                               "Path to input TFLite flatbuffer."),
+      tflite::Flag::CreateFlag(kOutputFlatbufferFlag, &output_flatbuffer_path,
+                               "Path to output TFLite flatbuffer."),
+  };
+  Flags::Parse(&argc, const_cast<const char**>(argv), flag_list);
+
+  auto input_model =
+      FlatBufferModel::BuildFromFile(input_flatbuffer_path.c_str());
+  if (!input_model) return 1;
+
+  FlatBufferBuilder builder(/*initial_size=*/10240);
+  size_t arena_size = 0;
+  if (AddOfflineMemoryPlanToFlatbuffer(input_model->GetModel(), &builder,
+                                       &arena_size) != kTfLiteOk) {
+    return 1;
+  }
+  LOG(INFO) << "Planned arena size (KB): " << arena_size / 1000.0;
+
+  std::ofstream output_file_stream(output_flatbuffer_path, std::ios::binary);
+  output_file_stream.write(
+      reinterpret_cast<const char*>(builder.GetBufferPointer()),
+      builder.GetSize());
+  output_file_stream.close();
+  return output_file_stream ? 0 : 1;
+}
+
+}  // namespace tflite
+
+int main(int argc, char* argv[]) { return tflite::Main(argc, argv); }
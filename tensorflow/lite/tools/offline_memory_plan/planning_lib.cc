@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/offline_memory_plan/planning_lib.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "tensorflow/lite/context_util.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/offline_memory_plan.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace {
+
+// Returns the size and usage interval of the tensors of the primary subgraph
+// of `interpreter` that are placed in the non-persistent arena. Like
+// ArenaPlanner, keeps the graph inputs, outputs and variables for the whole
+// graph.
+std::vector<ArenaAllocWithUsageInterval> GetArenaTensors(
+    const Interpreter& interpreter) {
+  const std::vector<int>& execution_plan = interpreter.execution_plan();
+  const int num_nodes = static_cast<int>(execution_plan.size());
+  const int last_node = std::max(num_nodes - 1, 0);
+  std::vector<int> first_use(interpreter.tensors_size(), -1);
+  std::vector<int> last_use(interpreter.tensors_size(), -1);
+  auto use = [&](int node, int tensor_index) {
+    if (tensor_index == kTfLiteOptionalTensor) return;
+    if (first_use[tensor_index] < 0) first_use[tensor_index] = node;
+    last_use[tensor_index] = std::max(last_use[tensor_index], node);
+  };
+  for (const std::vector<int>* tensors :
+       {&interpreter.inputs(), &interpreter.variables()}) {
+    for (int tensor_index : *tensors) {
+      use(0, tensor_index);
+      use(last_node, tensor_index);
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node =
+        interpreter.node_and_registration(execution_plan[i])->first;
+    for (const TfLiteIntArray* tensors :
+         {node.inputs, node.outputs, node.temporaries}) {
+      if (tensors == nullptr) continue;
+      for (int tensor_index : TfLiteIntArrayView(tensors)) {
+        use(i, tensor_index);
+      }
+    }
+  }
+  for (int tensor_index : interpreter.outputs()) use(last_node, tensor_index);
+
+  std::vector<ArenaAllocWithUsageInterval> allocs;
+  for (int i = 0; i < static_cast<int>(interpreter.tensors_size()); ++i) {
+    const TfLiteTensor* tensor = interpreter.tensor(i);
+    if (first_use[i] < 0 || tensor->allocation_type != kTfLiteArenaRw ||
+        tensor->bytes == 0) {
+      continue;
+    }
+    allocs.emplace_back();
+    ArenaAllocWithUsageInterval& alloc = allocs.back();
+    alloc.size = tensor->bytes;
+    alloc.tensor = i;
+    alloc.first_node = first_use[i];
+    alloc.last_node = last_use[i];
+  }
+  return allocs;
+}
+
+}  // namespace
+
+TfLiteStatus AddOfflineMemoryPlanToFlatbuffer(
+    const Model* input_model, flatbuffers::FlatBufferBuilder* new_model_builder,
+    size_t* arena_size) {
+  if (input_model == nullptr || new_model_builder == nullptr) {
+    return kTfLiteError;
+  }
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  if (InterpreterBuilder(input_model, resolver)(&interpreter) != kTfLiteOk ||
+      interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Cannot prepare the model for planning.");
+    return kTfLiteError;
+  }
+
+  std::vector<int32_t> offsets;
+  size_t planned_arena_size = 0;
+  TF_LITE_ENSURE_STATUS(PlanOfflineMemoryAllocation(
+      interpreter->primary_subgraph().context(), GetArenaTensors(*interpreter),
+      interpreter->tensors_size(), kDefaultTensorAlignment, &offsets,
+      &planned_arena_size));
+  if (arena_size != nullptr) *arena_size = planned_arena_size;
+  const std::string plan =
+      SerializeOfflineMemoryAllocation(/*subgraph_index=*/0, offsets);
+
+  auto model = std::make_unique<ModelT>();
+  input_model->UnPackTo(model.get(), nullptr);
+  auto buffer = std::make_unique<BufferT>();
+  buffer->data.assign(plan.begin(), plan.end());
+  const auto existing =
+      std::find_if(model->metadata.begin(), model->metadata.end(),
+                   [](const std::unique_ptr<MetadataT>& metadata) {
+                     return metadata->name == kOfflineMemoryAllocationMetadata;
+                   });
+  if (existing != model->metadata.end()) {
+    model->buffers[(*existing)->buffer] = std::move(buffer);
+  } else {
+    auto metadata = std::make_unique<MetadataT>();
+    metadata->name = kOfflineMemoryAllocationMetadata;
+    metadata->buffer = model->buffers.size();
+    model->buffers.push_back(std::move(buffer));
+    model->metadata.push_back(std::move(metadata));
+  }
+  FinishModelBuffer(*new_model_builder,
+                    Model::Pack(*new_model_builder, model.get()));
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
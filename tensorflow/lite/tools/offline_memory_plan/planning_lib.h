@@ -0,0 +1,43 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLAN_PLANNING_LIB_H_
+#define TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLAN_PLANNING_LIB_H_
+
+#include <cstddef>
+
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+// Plans the non-persistent arena of the primary subgraph of `input_model`
+// with PlanOfflineMemoryAllocation, for the tensor sizes the model gives, and
+// builds into `new_model_builder` the model with the planned offsets in its
+// kOfflineMemoryAllocationMetadata buffer, which replaces any existing one.
+// ArenaPlanner then places the tensors at these offsets when the model is
+// loaded. Sets the size of the planned arena in `arena_size`, if not null.
+//
+// The graph is planned as it runs without delegates. The tensors that the
+// runtime planner shares in place are planned apart, which keeps the plan
+// valid at the cost of some of its size.
+// NOTE: This only plans the primary subgraph.
+TfLiteStatus AddOfflineMemoryPlanToFlatbuffer(
+    const Model* input_model, flatbuffers::FlatBufferBuilder* new_model_builder,
+    size_t* arena_size = nullptr);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OFFLINE_MEMORY_PLAN_PLANNING_LIB_H_
@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/offline_memory_plan/planning_lib.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/offline_memory_plan.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+// add.bin computes output = (input + input) + input, with the first sum in
+// tensor 0, the input in tensor 1 and the output in tensor 2.
+constexpr char kModelPath[] = "tensorflow/lite/testdata/add.bin";
+
+// Returns the offline memory plan stored in `model`, or an empty vector.
+std::vector<int32_t> GetPlan(const Model* model) {
+  if (model->metadata() == nullptr) return {};
+  for (const Metadata* metadata : *model->metadata()) {
+    if (metadata->name()->str() != kOfflineMemoryAllocationMetadata) continue;
+    const auto* data = model->buffers()->Get(metadata->buffer())->data();
+    return ParseOfflineMemoryAllocation(
+        std::string(reinterpret_cast<const char*>(data->data()), data->size()),
+        /*subgraph_index=*/0);
+  }
+  return {};
+}
+
+TEST(OfflineMemoryPlanningTest, PlacesTensorsAtPlannedOffsets) {
+  auto input_model = FlatBufferModel::BuildFromFile(kModelPath);
+  ASSERT_NE(input_model, nullptr);
+  flatbuffers::FlatBufferBuilder builder;
+  size_t arena_size = 0;
+  ASSERT_EQ(AddOfflineMemoryPlanToFlatbuffer(input_model->GetModel(), &builder,
+                                             &arena_size),
+            kTfLiteOk);
+  const Model* model = GetModel(builder.GetBufferPointer());
+  const std::vector<int32_t> offsets = GetPlan(model);
+  ASSERT_EQ(offsets.size(), 3);
+  // The three tensors of 1x8x8x3 floats are all live during the second ADD.
+  EXPECT_EQ(arena_size, 3 * 768);
+  for (int32_t offset : offsets) EXPECT_GE(offset, 0);
+
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(model, resolver)(&interpreter), kTfLiteOk);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  // The output may share the memory of the first sum in place, so only the
+  // input and the first sum are sure to be at their planned offsets.
+  const TfLiteTensor* sum = interpreter->tensor(0);
+  const TfLiteTensor* input = interpreter->tensor(1);
+  EXPECT_EQ(sum->data.raw - input->data.raw, offsets[0] - offsets[1]);
+
+  float* values = interpreter->typed_input_tensor<float>(0);
+  for (int i = 0; i < 192; ++i) values[i] = i;
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  for (int i = 0; i < 192; ++i) {
+    EXPECT_EQ(interpreter->typed_output_tensor<float>(0)[i], 3.f * i);
+  }
+}
+
+TEST(OfflineMemoryPlanningTest, ReplacesExistingPlan) {
+  auto input_model = FlatBufferModel::BuildFromFile(kModelPath);
+  ASSERT_NE(input_model, nullptr);
+  flatbuffers::FlatBufferBuilder builder;
+  ASSERT_EQ(AddOfflineMemoryPlanToFlatbuffer(input_model->GetModel(), &builder),
+            kTfLiteOk);
+  flatbuffers::FlatBufferBuilder replanned_builder;
+  ASSERT_EQ(AddOfflineMemoryPlanToFlatbuffer(
+                GetModel(builder.GetBufferPointer()), &replanned_builder),
+            kTfLiteOk);
+  const Model* model = GetModel(replanned_builder.GetBufferPointer());
+  const Model* original = input_model->GetModel();
+  ASSERT_NE(model->metadata(), nullptr);
+  EXPECT_EQ(model->metadata()->size(),
+            (original->metadata() ? original->metadata()->size() : 0) + 1);
+  EXPECT_EQ(model->buffers()->size(), original->buffers()->size() + 1);
+  EXPECT_EQ(GetPlan(model), GetPlan(GetModel(builder.GetBufferPointer())));
+}
+
+TEST(OfflineMemoryPlanningTest, RejectsNullModel) {
+  flatbuffers::FlatBufferBuilder builder;
+  EXPECT_EQ(AddOfflineMemoryPlanToFlatbuffer(nullptr, &builder), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -348,6 +348,7 @@ def TFE_Py_VariableWatcherRemove(arg0: object) -> None: ...
 def TFE_Py_VariableWatcherVariableAccessed(arg0: object) -> None: ...
 def TFE_Py_VariableWatcherWatchedVariables(arg0: object) -> object: ...
 def TFE_ReportErrorToCluster(arg0: object, arg1: int, arg2: str) -> None: ...
+def TFE_ResetCollectiveOps(arg0: object) -> None: ...
 def TFE_ResetMemoryStats(arg0: object, arg1: str) -> None: ...
 def TFE_SetLogicalCpuDevices(arg0: object, arg1: int, arg2: str) -> None: ...
 def TFE_ToDlpackCapsule(arg0: object): ...
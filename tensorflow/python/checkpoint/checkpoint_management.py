@@ -33,6 +33,7 @@ from tensorflow.python.ops import variable_scope
 from tensorflow.python.platform import tf_logging as logging
 from tensorflow.python.training import training_util
 from tensorflow.python.training.checkpoint_state_pb2 import CheckpointState
+from tensorflow.python.util import _pywrap_async_checkpoint_writer
 from tensorflow.python.util import compat
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
@@ -817,6 +818,9 @@ class CheckpointManager(object):
     prefix = "%s-%d" % (self._prefix, checkpoint_number)
 
     def _record_and_sweep_state(save_path):
+      # With TF_ASYNC_CHECKPOINT_THREADS set, SaveV2 may still be writing the
+      # checkpoint, which is only recorded once it is written.
+      _pywrap_async_checkpoint_writer.wait_for_writes()
       timestamp = time.time()
       # If this is an overwritten checkpoint we were previously tracking, delete
       # and reinsert it to make sure it goes to the end of the queue.
@@ -169,6 +169,7 @@ class OptionsTest(test_base.DatasetTestBase, parameterized.TestCase):
     options.framework_type = ["TFDS", "TfGrain"]
     options.threading.max_intra_op_parallelism = 30
     options.threading.private_threadpool_size = 40
+    options.threading.numa_node = 1
     pb = options._to_proto()
     result = options_lib.Options()
     result._from_proto(pb)
@@ -1093,7 +1093,7 @@ class Context:
     This is intended to be used when a peer failure is detected, which allows
     the user to handle the case instead of hanging. This aborts all on-going
     collectives. After all subsequent collectives error immediately, and you
-    need to reset_context() to use collectives again.
+    need to reset_collective_ops() or reset_context() to use collectives again.
 
     Args:
       code: a `tf.errors` error code.
@@ -1102,6 +1102,20 @@ class Context:
     self.ensure_initialized()
     pywrap_tfe.TFE_AbortCollectiveOps(self._handle, code, message)
 
+  def reset_collective_ops(self):
+    """Makes collective ops usable again after they were aborted.
+
+    Collective groups are formed again by the next collectives, so they can
+    include replacements of failed tasks. This must be called once the aborted
+    collectives returned, and by all the tasks of a group before any of them
+    runs collectives again.
+
+    Raises:
+      tf.errors.FailedPreconditionError: when collective ops are not aborted.
+    """
+    self.ensure_initialized()
+    pywrap_tfe.TFE_ResetCollectiveOps(self._handle)
+
   def check_collective_ops_peer_health(self, task, timeout_in_ms):
     """Check collective peer health.
 
@@ -1366,6 +1380,7 @@ class Context:
     rewriter_bool("disable_meta_optimizer")
     rewriter_toggle("auto_mixed_precision_onednn_bfloat16")
     rewriter_toggle("auto_mixed_precision_mkl")
+    rewriter_toggle("collective_bucketing")
     nodes = self._optimizer_experimental_options.get("min_graph_nodes", None)
     if nodes is not None:
       config.graph_options.rewrite_options.min_graph_nodes = nodes
@@ -2183,6 +2198,7 @@ class Context:
     rewriter_bool("disable_meta_optimizer")
     rewriter_toggle("auto_mixed_precision_onednn_bfloat16")
     rewriter_toggle("auto_mixed_precision_mkl")
+    rewriter_toggle("collective_bucketing")
 
     if rewrite_options.min_graph_nodes != 0:
       options["min_graph_nodes"] = rewrite_options.min_graph_nodes
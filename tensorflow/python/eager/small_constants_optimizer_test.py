@@ -22,6 +22,7 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
 from tensorflow.python.platform import test
 
 
@@ -169,6 +170,27 @@ class FunctionTest(test.TestCase):
     # Specially the kokoro machines seems to run much slower.
     self.assertLess(opt_benchmark * 5, benchmark)
 
+  @test_util.run_v2_only
+  def test_small_constants_optimization_specializes_int_inputs(self):
+    @polymorphic_function.function(
+        experimental_attributes={'runtime_constant_optimization': True}
+    )
+    def func(x, shape, multiples):
+      return array_ops.tile(array_ops.reshape(x, shape), multiples)
+
+    with ops.device_v2('CPU'):
+      x = constant_op.constant([1, 2, 3, 4, 5, 6])
+      # Calls with more distinct shapes than there are specialized variants
+      # still run the generic function.
+      for rows in [1, 2, 3, 6] * 3:
+        for times in range(1, 4):
+          shape = constant_op.constant([rows, -1])
+          multiples = constant_op.constant([times, 1])
+          self.assertAllEqual(
+              func(x, shape, multiples),
+              array_ops.tile(array_ops.reshape(x, shape), multiples),
+          )
+
 
 if __name__ == '__main__':
   ops.enable_eager_execution()
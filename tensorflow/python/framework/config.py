@@ -245,6 +245,8 @@ def set_optimizer_experimental_options(options):
         GPUs and above; and on CPUs with AMX FP16 support. Without the use of
         loss scaling, this can cause numerical underflow (see
         `keras.mixed_precision.experimental.LossScaleOptimizer`).
+      - collective_bucketing: Pack small collective reductions into buckets
+        and issue one reduction per bucket. Off by default.
       - disable_meta_optimizer: Disable the entire meta optimizer.
       - min_graph_nodes: The minimum number of nodes in a graph to optimizer.
         For smaller graphs, optimization is skipped.
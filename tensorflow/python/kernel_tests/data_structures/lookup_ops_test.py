@@ -2275,6 +2275,62 @@ class DenseHashTableOpTest(test.TestCase):
     result = self.evaluate(output)
     self.assertAllEqual([-1, 51, 52, 53, -1, 54, 55, 56, -1], result)
 
+  def testReinsertAfterRemovingCollidingKey(self, is_anonymous):
+    if is_anonymous and not tf2.enabled():
+      self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
+    # 3 and 11 start probing at the same bucket of a table with 8 buckets.
+    table = lookup_ops.DenseHashTable(
+        dtypes.int64,
+        dtypes.int64,
+        default_value=-1,
+        empty_key=0,
+        deleted_key=-1,
+        initial_num_buckets=8,
+        experimental_is_anonymous=is_anonymous)
+    self.evaluate(
+        table.insert(
+            constant_op.constant([3, 11], dtypes.int64),
+            constant_op.constant([30, 110], dtypes.int64)))
+    self.evaluate(table.remove(constant_op.constant([3], dtypes.int64)))
+
+    # Updates 11 in place rather than adding it again in the bucket of 3.
+    self.evaluate(
+        table.insert(
+            constant_op.constant([11], dtypes.int64),
+            constant_op.constant([111], dtypes.int64)))
+    self.assertAllEqual(1, self.evaluate(table.size()))
+    output = table.lookup(constant_op.constant([3, 11], dtypes.int64))
+    self.assertAllEqual([-1, 111], self.evaluate(output))
+
+    self.evaluate(table.remove(constant_op.constant([11], dtypes.int64)))
+    self.assertAllEqual(0, self.evaluate(table.size()))
+    output = table.lookup(constant_op.constant([3, 11], dtypes.int64))
+    self.assertAllEqual([-1, -1], self.evaluate(output))
+
+  def testLookupManyKeys(self, is_anonymous):
+    if is_anonymous and not tf2.enabled():
+      self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
+    # Multiples of 64 all start probing at the same bucket until the table
+    # grows.
+    keys = np.arange(1, 101, dtype=np.int64) * 64
+    table = lookup_ops.DenseHashTable(
+        dtypes.int64,
+        dtypes.int64,
+        default_value=-1,
+        empty_key=0,
+        deleted_key=-1,
+        initial_num_buckets=64,
+        experimental_is_anonymous=is_anonymous)
+    self.evaluate(table.insert(keys, keys + 1))
+    self.evaluate(table.remove(keys[::3]))
+    self.assertAllEqual(66, self.evaluate(table.size()))
+
+    lookup_keys = np.concatenate([keys, keys + 1])
+    expected = np.where(np.arange(100) % 3 == 0, -1, keys + 1)
+    expected = np.concatenate([expected, np.full(100, -1)])
+    output = table.lookup(lookup_keys)
+    self.assertAllEqual(expected, self.evaluate(output))
+
   def testCustomEmptyKey(self, is_anonymous):
     if is_anonymous and not tf2.enabled():
       self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
@@ -1523,6 +1523,70 @@ class CSRSparseMatrixOpsBenchmark(test.Benchmark):
                 },
                 min_iters=10)
 
+  def benchmark_sparse_matrix_mat_mul_cpu(self):
+    # A graph adjacency matrix times node features, as in graph neural
+    # networks. Row lengths follow a power law, so a few rows hold most of the
+    # nonzeros.
+    num_nodes = 16384
+    mean_degree = 16
+    seed = 42
+
+    rng = np.random.RandomState(seed)
+    degrees = np.minimum(rng.zipf(2.0, size=num_nodes), num_nodes)
+    degrees = np.maximum(
+        1, degrees * mean_degree * num_nodes // np.sum(degrees))
+    degrees = np.minimum(degrees, num_nodes)
+    rows = np.repeat(np.arange(num_nodes), degrees)
+    cols = np.concatenate(
+        [rng.choice(num_nodes, size=d, replace=False) for d in degrees])
+    indices = np.stack([rows, cols], axis=1).astype(np.int64)
+    values = rng.uniform(size=len(rows)).astype(np.float32)
+
+    for num_features in [64, 128, 256, 512]:
+      for num_threads in [1, 4, 8]:
+        with ops.Graph().as_default(), ops.device(CPU):
+          random_seed.set_random_seed(seed)
+          a_st = sparse_ops.sparse_reorder(
+              sparse_tensor.SparseTensor(indices, values,
+                                         [num_nodes, num_nodes]))
+          a_sm = sparse_csr_matrix_ops.sparse_tensor_to_csr_sparse_matrix(
+              a_st.indices, a_st.values, a_st.dense_shape)
+          with ops.name_scope("a_sm_var"):
+            a_sm_var = variable_scope.get_variable(
+                "sm", initializer=a_sm, use_resource=True)
+            a_sm_var_v = a_sm_var.read_value()
+          x = random_ops.random_normal([num_nodes, num_features],
+                                       dtype=dtypes.float32)
+          with ops.name_scope("x"):
+            x_var = variable_scope.get_variable(
+                "x", initializer=x, use_resource=True)
+            x_var_v = x_var.read_value()
+          ax_sparse_matrix = sparse_csr_matrix_ops.sparse_matrix_mat_mul(
+              a_sm_var_v, x_var_v)
+          ax_sparse_tensor = sparse_ops.sparse_tensor_dense_matmul(
+              a_st, x_var_v)
+
+          with session.Session(
+              config=config_pb2.ConfigProto(
+                  intra_op_parallelism_threads=num_threads)) as sess:
+            self.evaluate([a_sm_var.initializer, x_var.initializer])
+            name_template = "mat_mul_cpu_%s_A_%d_features_%d_threads_%d"
+            extras = {"num_nonzero": len(rows)}
+            self.run_op_benchmark(
+                sess,
+                ax_sparse_matrix.op,
+                name=name_template %
+                ("sparse_matrix", num_nodes, num_features, num_threads),
+                extras=extras,
+                min_iters=10)
+            self.run_op_benchmark(
+                sess,
+                ax_sparse_tensor.op,
+                name=name_template %
+                ("sparse_tensor", num_nodes, num_features, num_threads),
+                extras=extras,
+                min_iters=10)
+
   def benchmark_sparse_matrix_sparse_matmul(self):
     density = 0.05
     # pylint: disable=g-long-lambda
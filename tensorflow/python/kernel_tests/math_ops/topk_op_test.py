@@ -195,6 +195,28 @@ class TopKTest(test.TestCase):
       values = -np.sort(-inputs, axis=1)[:, :k]
       self._validateTopK(inputs, k, values, indices)
 
+  def testLongRowsStableSort(self):
+    # Long enough rows for k to be selected by filtering, split between
+    # threads, with many ties across the splits.
+    b = 3
+    n = 100000
+    for k in [2, 100]:
+      inputs = np.random.randint(0, 100, size=(b, n)).astype(np.int32)
+      indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+      self._validateTopK(inputs, k, values, indices, sorted=False)
+
+  def testLongRowsTopK(self):
+    b = 2
+    n = 70000
+    k = 100
+    inputs = np.random.permutation(
+        np.linspace(-100, 100, b * n, dtype=np.float32)).reshape(b, n)
+    indices = np.argsort(-inputs, axis=1)[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
   def testTopAll(self):
     inputs = [[0.1, 0.3, 0.2, 0.4], [0.1, 0.3, 0.3, 0.2]]
     self._validateTopK(inputs, 4, [[0.4, 0.3, 0.2, 0.1], [0.3, 0.3, 0.2, 0.1]],
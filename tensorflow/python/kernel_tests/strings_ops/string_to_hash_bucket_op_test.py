@@ -45,6 +45,17 @@ class StringToHashBucketOpTest(test.TestCase):
       # Fingerprint64('d') -> 4470636696479570465 -> mod 10 -> 5
       self.assertAllEqual([9, 2, 2, 5], result)
 
+  @test_util.run_deprecated_v1
+  def testStringToHashBucketsFastLargeBatch(self):
+    with self.cached_session():
+      input_string = array_ops.placeholder(dtypes.string)
+      output = string_ops.string_to_hash_bucket_fast(input_string, 10)
+      # Large enough to be split between threads.
+      result = output.eval(
+          feed_dict={input_string: ['a', 'b', 'c', 'd'] * 10000})
+
+      self.assertAllEqual([9, 2, 2, 5] * 10000, result)
+
   @test_util.run_deprecated_v1
   def testStringToOneHashBucketLegacyHash(self):
     with self.cached_session():
@@ -500,6 +500,45 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
     self.evaluate(variables.global_variables_initializer())
     self.assertAllEqual(self.evaluate(grads.values), [[1., 1.], [1., 1.]])
 
+  @test_util.run_in_graph_and_eager_modes
+  def testGradientGatherSparseSegmentSumIndexedSlices(self):
+    v = resource_variable_ops.ResourceVariable(
+        np.random.uniform(size=[4, 2]), dtype=dtypes.float32)
+
+    with backprop.GradientTape() as tape:
+      l = array_ops.gather(v, [3, 1, 3])
+      l = math_ops.sparse_segment_sum(
+          l, [0, 2, 1], [0, 0, 1], sparse_gradient=True)
+      l = math_ops.reduce_sum(l)
+
+    grads = tape.gradient(l, v)
+    self.evaluate(variables.global_variables_initializer())
+    self.assertIsInstance(grads, indexed_slices.IndexedSlices)
+    self.assertAllEqual(self.evaluate(grads.indices), [3, 1, 3])
+    self.assertAllEqual(
+        self.evaluate(grads.values), [[1., 1.], [1., 1.], [1., 1.]])
+    self.assertAllEqual(
+        self.evaluate(ops.convert_to_tensor(grads)),
+        [[0., 0.], [1., 1.], [0., 0.], [2., 2.]])
+
+  @test_util.run_in_graph_and_eager_modes
+  def testGradientGatherMatrixIndicesIndexedSlices(self):
+    v = resource_variable_ops.ResourceVariable(
+        np.random.uniform(size=[4, 2]), dtype=dtypes.float32)
+
+    with backprop.GradientTape() as tape:
+      l = array_ops.gather(v, [[3, 1], [0, 3]])
+      l = array_ops.gather(l, [1, 1])
+      l = math_ops.reduce_sum(l)
+
+    grads = tape.gradient(l, v)
+    self.evaluate(variables.global_variables_initializer())
+    self.assertIsInstance(grads, indexed_slices.IndexedSlices)
+    self.assertAllEqual(self.evaluate(grads.indices), [0, 3, 0, 3])
+    self.assertAllEqual(
+        self.evaluate(ops.convert_to_tensor(grads)),
+        [[2., 2.], [0., 0.], [0., 0.], [2., 2.]])
+
   @test_util.run_in_graph_and_eager_modes
   def testGradientCompositeVariable(self):
     composite_variable = CompositeVariable(
@@ -118,7 +118,9 @@ def all_reduce_v2(t,
       value.  Can be 'Id' for no operation.
     communication_hint: preferred collective communication.  The implementation
       may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      `nccl`.  A `:<compression>` suffix, e.g. `ring:bf16` or `ring:topk=0.01`,
+      sends the partial sums of a float `Add` reduction on CPU in compressed
+      form, with error feedback.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -2536,6 +2536,19 @@ def _GatherGrad(op, grad):
   handle = op.inputs[0]
   indices = op.inputs[1]
   params_shape = variable_shape(handle)
+  if (isinstance(grad, indexed_slices.IndexedSlices) and
+      op.get_attr("batch_dims") == 0 and indices.shape.rank is not None and
+      indices.shape.rank >= 1):
+    # A sparse gradient of the gathered rows, e.g. from a SparseSegmentSum
+    # with sparse_gradient=True, only needs its indices mapped to rows of the
+    # variable, without materializing the gradient of all gathered rows. Each
+    # slice covers the rows of the variable in one entry of `indices`.
+    indices = array_ops.reshape(array_ops.gather(indices, grad.indices), [-1])
+    values_shape = array_ops.concat(
+        [array_ops.shape(indices), params_shape[1:]], 0)
+    return (indexed_slices.IndexedSlices(
+        array_ops.reshape(grad.values, values_shape), indices,
+        params_shape), None)
   size = array_ops.expand_dims(array_ops.size(indices), 0)
   values_shape = array_ops.concat([size, params_shape[1:]], 0)
   values = array_ops.reshape(grad, values_shape)
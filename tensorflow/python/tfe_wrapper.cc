@@ -1489,6 +1489,12 @@ PYBIND11_MODULE(_pywrap_tfe, m) {
     TF_SetStatus(status.get(), static_cast<TF_Code>(code), message);
     TFE_AbortCollectiveOps(tensorflow::InputTFE_Context(ctx), status.get());
   });
+  m.def("TFE_ResetCollectiveOps", [](const py::handle& ctx) {
+    tensorflow::Safe_TF_StatusPtr status =
+        tensorflow::make_safe(TF_NewStatus());
+    TFE_ResetCollectiveOps(tensorflow::InputTFE_Context(ctx), status.get());
+    tensorflow::MaybeRaiseRegisteredFromTFStatus(status.get());
+  });
   m.def("TFE_CollectiveOpsCheckPeerHealth",
         [](const py::handle& ctx, const char* task, int64_t timeout_in_ms) {
           tensorflow::Safe_TF_StatusPtr status =
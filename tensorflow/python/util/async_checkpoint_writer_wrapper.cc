@@ -0,0 +1,30 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "absl/status/status.h"
+#include "pybind11/pybind11.h"  // from @pybind11
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+#include "tensorflow/python/lib/core/pybind11_status.h"
+
+PYBIND11_MODULE(_pywrap_async_checkpoint_writer, m) {
+  m.def("wait_for_writes", [] {
+    absl::Status status;
+    {
+      pybind11::gil_scoped_release release;
+      status = tensorflow::checkpoint::WaitForAsyncCheckpointWrites();
+    }
+    tensorflow::MaybeRaiseFromStatus(status);
+  });
+}
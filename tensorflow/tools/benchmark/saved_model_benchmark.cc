@@ -0,0 +1,564 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary that loads a SavedModel signature with either DirectSession or
+// TFRT, drives it with synthetic open-loop load from several concurrent
+// clients and reports tail latency.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numbers.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/tfrt/runtime/runtime.h"
+#include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
+#include "tensorflow/core/tfrt/saved_model/saved_model.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+#include "tfrt/host_context/concurrent_work_queue.h"  // from @tf_runtime
+
+namespace tensorflow {
+namespace benchmark_model {
+
+namespace {
+
+// Signature inputs and outputs sorted by key, so feeds and fetches have a
+// deterministic order.
+std::map<string, TensorInfo> SortedTensorInfos(
+    const google::protobuf::Map<string, TensorInfo>& infos) {
+  return std::map<string, TensorInfo>(infos.begin(), infos.end());
+}
+
+class DirectSessionSignatureRunner : public SignatureRunner {
+ public:
+  DirectSessionSignatureRunner(std::unique_ptr<SavedModelBundle> bundle,
+                               SignatureDef signature)
+      : SignatureRunner(std::move(signature)), bundle_(std::move(bundle)) {}
+
+  Status Run(const SignatureFeeds& feeds,
+             std::vector<Tensor>* outputs) override {
+    return bundle_->session->Run(feeds, output_names_, {}, outputs);
+  }
+
+ private:
+  std::unique_ptr<SavedModelBundle> bundle_;
+};
+
+class TfrtSignatureRunner : public SignatureRunner {
+ public:
+  TfrtSignatureRunner(std::unique_ptr<tfrt_stub::Runtime> runtime,
+                      std::unique_ptr<tfrt_stub::SavedModel> saved_model,
+                      SignatureDef signature)
+      : SignatureRunner(std::move(signature)),
+        runtime_(std::move(runtime)),
+        saved_model_(std::move(saved_model)) {}
+
+  // Feeds by tensor name rather than through SavedModel::Run() so sparse
+  // inputs, which the signature path does not accept, can be benchmarked too.
+  Status Run(const SignatureFeeds& feeds,
+             std::vector<Tensor>* outputs) override {
+    return saved_model_->RunByTensorNames(tfrt_stub::SavedModel::RunOptions(),
+                                          feeds, output_names_,
+                                          /*target_node_names=*/{}, outputs);
+  }
+
+ private:
+  // The runtime must outlive the SavedModel loaded with it.
+  std::unique_ptr<tfrt_stub::Runtime> runtime_;
+  std::unique_ptr<tfrt_stub::SavedModel> saved_model_;
+};
+
+absl::StatusOr<SignatureDef> FindSignature(const MetaGraphDef& meta_graph_def,
+                                           const string& name) {
+  const auto it = meta_graph_def.signature_def().find(name);
+  if (it == meta_graph_def.signature_def().end()) {
+    return errors::NotFound("SavedModel has no signature named '", name, "'");
+  }
+  return it->second;
+}
+
+template <typename T>
+T SampleFrom(const std::vector<T>& values, std::mt19937_64* rng) {
+  std::uniform_int_distribution<size_t> index(0, values.size() - 1);
+  return values[index(*rng)];
+}
+
+// Resolves the shape of an input, sampling its unknown dimensions. Inputs of
+// unknown rank are treated as vectors with an unknown batch dimension.
+TensorShape ResolveShape(const TensorShapeProto& shape_proto,
+                         int64_t batch_size,
+                         const InputGenerationOptions& options,
+                         std::mt19937_64* rng) {
+  TensorShape shape;
+  if (shape_proto.unknown_rank()) {
+    shape.AddDim(batch_size);
+    return shape;
+  }
+  for (int i = 0; i < shape_proto.dim_size(); ++i) {
+    const int64_t size = shape_proto.dim(i).size();
+    if (size >= 0) {
+      shape.AddDim(size);
+    } else if (i == 0) {
+      shape.AddDim(batch_size);
+    } else {
+      shape.AddDim(SampleFrom(options.dynamic_dim_sizes, rng));
+    }
+  }
+  return shape;
+}
+
+// Fills `tensor` with random values.
+Status FillRandom(const InputGenerationOptions& options, std::mt19937_64* rng,
+                  Tensor* tensor) {
+  std::uniform_real_distribution<double> real(0.0, 1.0);
+  std::uniform_int_distribution<int64_t> integer(
+      0, std::max<int64_t>(options.max_int_value, 1) - 1);
+  const int64_t n = tensor->NumElements();
+  switch (tensor->dtype()) {
+    case DT_FLOAT: {
+      auto flat = tensor->flat<float>();
+      for (int64_t i = 0; i < n; ++i) flat(i) = real(*rng);
+      break;
+    }
+    case DT_DOUBLE: {
+      auto flat = tensor->flat<double>();
+      for (int64_t i = 0; i < n; ++i) flat(i) = real(*rng);
+      break;
+    }
+    case DT_INT32: {
+      auto flat = tensor->flat<int32>();
+      for (int64_t i = 0; i < n; ++i) flat(i) = integer(*rng);
+      break;
+    }
+    case DT_INT64: {
+      auto flat = tensor->flat<int64_t>();
+      for (int64_t i = 0; i < n; ++i) flat(i) = integer(*rng);
+      break;
+    }
+    case DT_BOOL: {
+      auto flat = tensor->flat<bool>();
+      for (int64_t i = 0; i < n; ++i) flat(i) = real(*rng) < 0.5;
+      break;
+    }
+    case DT_STRING: {
+      auto flat = tensor->flat<tstring>();
+      for (int64_t i = 0; i < n; ++i) flat(i) = strings::StrCat(integer(*rng));
+      break;
+    }
+    default:
+      return errors::Unimplemented("Cannot generate inputs of type ",
+                                   DataTypeString(tensor->dtype()));
+  }
+  return absl::OkStatus();
+}
+
+// Appends the indices, values and dense shape of a random COO sparse tensor.
+Status AppendSparseFeeds(const TensorInfo& info, const TensorShape& shape,
+                         const InputGenerationOptions& options,
+                         std::mt19937_64* rng, SignatureFeeds* feeds) {
+  std::bernoulli_distribution present(options.sparse_density);
+  std::vector<int64_t> positions;
+  for (int64_t i = 0; i < shape.num_elements(); ++i) {
+    if (present(*rng)) positions.push_back(i);
+  }
+  const int rank = shape.dims();
+  Tensor indices(DT_INT64, TensorShape({static_cast<int64_t>(positions.size()),
+                                        static_cast<int64_t>(rank)}));
+  auto indices_matrix = indices.matrix<int64_t>();
+  for (size_t row = 0; row < positions.size(); ++row) {
+    int64_t remainder = positions[row];
+    for (int d = rank - 1; d >= 0; --d) {
+      indices_matrix(row, d) = remainder % shape.dim_size(d);
+      remainder /= shape.dim_size(d);
+    }
+  }
+  Tensor values(info.dtype(),
+                TensorShape({static_cast<int64_t>(positions.size())}));
+  TF_RETURN_IF_ERROR(FillRandom(options, rng, &values));
+  Tensor dense_shape(DT_INT64, TensorShape({rank}));
+  for (int d = 0; d < rank; ++d) {
+    dense_shape.vec<int64_t>()(d) = shape.dim_size(d);
+  }
+
+  const TensorInfo::CooSparse& coo = info.coo_sparse();
+  feeds->emplace_back(coo.indices_tensor_name(), std::move(indices));
+  feeds->emplace_back(coo.values_tensor_name(), std::move(values));
+  feeds->emplace_back(coo.dense_shape_tensor_name(), std::move(dense_shape));
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+SignatureRunner::SignatureRunner(SignatureDef signature)
+    : signature_(std::move(signature)) {
+  for (const auto& output : SortedTensorInfos(signature_.outputs())) {
+    const TensorInfo& info = output.second;
+    if (info.has_coo_sparse()) {
+      output_names_.push_back(info.coo_sparse().indices_tensor_name());
+      output_names_.push_back(info.coo_sparse().values_tensor_name());
+      output_names_.push_back(info.coo_sparse().dense_shape_tensor_name());
+    } else {
+      output_names_.push_back(info.name());
+    }
+  }
+}
+
+absl::StatusOr<std::unique_ptr<SignatureRunner>> SignatureRunner::Create(
+    const SavedModelLoadOptions& options) {
+  if (options.runtime == SavedModelRuntime::kDirectSession) {
+    SessionOptions session_options;
+    if (options.num_threads != -1) {
+      session_options.config.set_intra_op_parallelism_threads(
+          options.num_threads);
+      session_options.config.set_inter_op_parallelism_threads(
+          options.num_threads);
+    }
+    auto bundle = std::make_unique<SavedModelBundle>();
+    TF_RETURN_IF_ERROR(LoadSavedModel(session_options, RunOptions(),
+                                      options.export_dir, options.tags,
+                                      bundle.get()));
+    TF_ASSIGN_OR_RETURN(
+        SignatureDef signature,
+        FindSignature(bundle->meta_graph_def, options.signature));
+    return std::unique_ptr<SignatureRunner>(new DirectSessionSignatureRunner(
+        std::move(bundle), std::move(signature)));
+  }
+
+  const int num_threads =
+      options.num_threads > 0 ? options.num_threads : port::MaxParallelism();
+  std::unique_ptr<tfrt_stub::Runtime> runtime =
+      tfrt_stub::Runtime::Create(tfrt_stub::WrapDefaultWorkQueue(
+          tfrt::CreateMultiThreadedWorkQueue(num_threads, num_threads)));
+  tfrt_stub::SavedModel::Options saved_model_options(runtime.get());
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<tfrt_stub::SavedModel> saved_model,
+      tfrt_stub::SavedModelImpl::LoadSavedModel(
+          saved_model_options, options.export_dir, options.tags));
+  TF_ASSIGN_OR_RETURN(
+      SignatureDef signature,
+      FindSignature(saved_model->GetMetaGraphDef(), options.signature));
+  return std::unique_ptr<SignatureRunner>(new TfrtSignatureRunner(
+      std::move(runtime), std::move(saved_model), std::move(signature)));
+}
+
+absl::StatusOr<SignatureFeeds> GenerateSignatureFeeds(
+    const SignatureDef& signature, const InputGenerationOptions& options,
+    std::mt19937_64* rng) {
+  if (options.batch_sizes.empty() || options.dynamic_dim_sizes.empty()) {
+    return errors::InvalidArgument(
+        "batch_sizes and dynamic_dim_sizes must not be empty");
+  }
+  const int64_t batch_size = SampleFrom(options.batch_sizes, rng);
+  SignatureFeeds feeds;
+  for (const auto& input : SortedTensorInfos(signature.inputs())) {
+    const TensorInfo& info = input.second;
+    const TensorShape shape =
+        ResolveShape(info.tensor_shape(), batch_size, options, rng);
+    if (info.has_coo_sparse()) {
+      TF_RETURN_IF_ERROR(AppendSparseFeeds(info, shape, options, rng, &feeds));
+    } else if (info.has_composite_tensor()) {
+      return errors::Unimplemented("Input '", input.first,
+                                   "' is a composite tensor, which cannot be "
+                                   "generated");
+    } else {
+      Tensor tensor(info.dtype(), shape);
+      TF_RETURN_IF_ERROR(FillRandom(options, rng, &tensor));
+      feeds.emplace_back(info.name(), std::move(tensor));
+    }
+  }
+  return feeds;
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted_values,
+                   double percentile) {
+  if (sorted_values.empty()) return 0;
+  const double rank =
+      std::ceil(percentile / 100.0 * sorted_values.size()) - 1;
+  const size_t index = std::min<size_t>(
+      static_cast<size_t>(std::max(rank, 0.0)), sorted_values.size() - 1);
+  return sorted_values[index];
+}
+
+absl::StatusOr<LoadTestResult> RunLoadTest(
+    SignatureRunner* runner, const InputGenerationOptions& input_options,
+    const LoadTestOptions& options) {
+  if (options.num_clients <= 0 || options.num_distinct_requests <= 0) {
+    return errors::InvalidArgument(
+        "num_clients and num_distinct_requests must be positive");
+  }
+  std::mt19937_64 rng(options.seed);
+  std::vector<SignatureFeeds> requests;
+  requests.reserve(options.num_distinct_requests);
+  for (int i = 0; i < options.num_distinct_requests; ++i) {
+    TF_ASSIGN_OR_RETURN(
+        SignatureFeeds feeds,
+        GenerateSignatureFeeds(runner->signature(), input_options, &rng));
+    requests.push_back(std::move(feeds));
+  }
+
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < options.warmup_requests; ++i) {
+    TF_RETURN_IF_ERROR(runner->Run(requests[i % requests.size()], &outputs));
+  }
+
+  Env* env = Env::Default();
+  const double client_qps = options.target_qps / options.num_clients;
+  const int64_t start_us = env->NowMicros();
+  const int64_t end_us =
+      start_us + static_cast<int64_t>(options.duration_s * 1e6);
+  std::vector<std::vector<int64_t>> latencies(options.num_clients);
+  std::atomic<int64_t> num_errors(0);
+  mutex status_mu;
+  Status first_error;
+  {
+    thread::ThreadPool clients(env, "saved_model_benchmark_client",
+                               options.num_clients);
+    for (int c = 0; c < options.num_clients; ++c) {
+      clients.Schedule([&, c]() {
+        std::mt19937_64 client_rng(options.seed + c + 1);
+        std::exponential_distribution<double> poisson(
+            client_qps > 0 ? client_qps : 1.0);
+        // Stagger the fixed-interval schedules of the clients.
+        double next_arrival_s =
+            client_qps > 0 && !options.poisson_arrivals
+                ? static_cast<double>(c) / options.num_clients / client_qps
+                : 0.0;
+        std::vector<Tensor> client_outputs;
+        for (int64_t i = c;; i += options.num_clients) {
+          int64_t scheduled_us = env->NowMicros();
+          if (client_qps > 0) {
+            next_arrival_s += options.poisson_arrivals ? poisson(client_rng)
+                                                       : 1.0 / client_qps;
+            scheduled_us =
+                start_us + static_cast<int64_t>(next_arrival_s * 1e6);
+            const int64_t now_us = env->NowMicros();
+            if (scheduled_us > now_us) {
+              env->SleepForMicroseconds(scheduled_us - now_us);
+            }
+          }
+          if (scheduled_us >= end_us) break;
+          Status s = runner->Run(requests[i % requests.size()],
+                                 &client_outputs);
+          latencies[c].push_back(env->NowMicros() - scheduled_us);
+          if (!s.ok()) {
+            num_errors.fetch_add(1);
+            mutex_lock l(status_mu);
+            if (first_error.ok()) first_error = s;
+          }
+        }
+      });
+    }
+  }
+
+  LoadTestResult result;
+  result.elapsed_s = (env->NowMicros() - start_us) / 1e6;
+  std::vector<int64_t> all_latencies;
+  for (const auto& client_latencies : latencies) {
+    all_latencies.insert(all_latencies.end(), client_latencies.begin(),
+                         client_latencies.end());
+  }
+  std::sort(all_latencies.begin(), all_latencies.end());
+  result.num_requests = all_latencies.size();
+  result.num_errors = num_errors.load();
+  if (result.num_requests == result.num_errors && !first_error.ok()) {
+    return first_error;
+  }
+  if (result.num_errors > 0) {
+    LOG(WARNING) << result.num_errors
+                 << " requests failed, first error: " << first_error;
+  }
+  if (result.elapsed_s > 0) {
+    result.achieved_qps = result.num_requests / result.elapsed_s;
+  }
+  if (!all_latencies.empty()) {
+    int64_t total_us = 0;
+    for (int64_t latency : all_latencies) total_us += latency;
+    result.mean_us = total_us / static_cast<int64_t>(all_latencies.size());
+    result.max_us = all_latencies.back();
+  }
+  result.p50_us = Percentile(all_latencies, 50);
+  result.p90_us = Percentile(all_latencies, 90);
+  result.p99_us = Percentile(all_latencies, 99);
+  result.p999_us = Percentile(all_latencies, 99.9);
+  return result;
+}
+
+string FormatLoadTestResult(const LoadTestResult& result) {
+  return absl::StrFormat(
+      "requests=%d errors=%d elapsed=%.2fs qps=%.1f\n"
+      "latency (us): mean=%d p50=%d p90=%d p99=%d p999=%d max=%d",
+      result.num_requests, result.num_errors, result.elapsed_s,
+      result.achieved_qps, result.mean_us, result.p50_us, result.p90_us,
+      result.p99_us, result.p999_us, result.max_us);
+}
+
+namespace {
+
+bool ParseSizes(const string& text, std::vector<int64_t>* sizes) {
+  sizes->clear();
+  for (const string& item : str_util::Split(text, ',', str_util::SkipEmpty())) {
+    int64_t size;
+    if (!strings::safe_strto64(item, &size) || size < 0) return false;
+    sizes->push_back(size);
+  }
+  return !sizes->empty();
+}
+
+}  // namespace
+
+int SavedModelBenchmarkMain(int argc, char** argv) {
+  SavedModelLoadOptions load_options;
+  InputGenerationOptions input_options;
+  LoadTestOptions test_options;
+  string tags_string = "serve";
+  string runtime_string = "direct_session";
+  string batch_sizes_string = "1";
+  string dynamic_dim_sizes_string = "1";
+  string arrival_string = "poisson";
+  float target_qps = 0.0f;
+  float duration_s = 10.0f;
+  int64_t seed = 0;
+
+  std::vector<Flag> flag_list = {
+      Flag("saved_model_dir", &load_options.export_dir,
+           "SavedModel directory"),
+      Flag("tags", &tags_string, "comma-separated MetaGraphDef tags"),
+      Flag("signature", &load_options.signature, "signature to benchmark"),
+      Flag("runtime", &runtime_string, "direct_session or tfrt"),
+      Flag("num_threads", &load_options.num_threads,
+           "number of runtime threads, -1 for the default"),
+      Flag("batch_sizes", &batch_sizes_string,
+           "comma-separated sizes sampled for unknown batch dimensions"),
+      Flag("dynamic_dim_sizes", &dynamic_dim_sizes_string,
+           "comma-separated sizes sampled for other unknown dimensions"),
+      Flag("sparse_density", &input_options.sparse_density,
+           "fraction of present elements in sparse inputs"),
+      Flag("max_int_value", &input_options.max_int_value,
+           "integer inputs are drawn from [0, max_int_value)"),
+      Flag("num_distinct_requests", &test_options.num_distinct_requests,
+           "number of distinct generated requests"),
+      Flag("target_qps", &target_qps,
+           "aggregate request rate, or 0 to run back-to-back"),
+      Flag("num_clients", &test_options.num_clients,
+           "number of concurrent clients"),
+      Flag("arrival", &arrival_string,
+           "poisson or uniform request inter-arrival times"),
+      Flag("duration", &duration_s, "seconds of measured load"),
+      Flag("warmup_requests", &test_options.warmup_requests,
+           "requests to run before measuring"),
+      Flag("seed", &seed, "random seed for inputs and arrivals"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+  if (load_options.export_dir.empty()) {
+    LOG(ERROR) << "--saved_model_dir is required\n" << usage;
+    return -1;
+  }
+  if (runtime_string == "direct_session") {
+    load_options.runtime = SavedModelRuntime::kDirectSession;
+  } else if (runtime_string == "tfrt") {
+    load_options.runtime = SavedModelRuntime::kTfrt;
+  } else {
+    LOG(ERROR) << "Unknown --runtime=" << runtime_string;
+    return -1;
+  }
+  if (arrival_string != "poisson" && arrival_string != "uniform") {
+    LOG(ERROR) << "Unknown --arrival=" << arrival_string;
+    return -1;
+  }
+  test_options.poisson_arrivals = arrival_string == "poisson";
+  test_options.target_qps = target_qps;
+  test_options.duration_s = duration_s;
+  test_options.seed = seed;
+  if (!ParseSizes(batch_sizes_string, &input_options.batch_sizes) ||
+      !ParseSizes(dynamic_dim_sizes_string,
+                  &input_options.dynamic_dim_sizes)) {
+    LOG(ERROR) << "--batch_sizes and --dynamic_dim_sizes must be "
+               << "comma-separated lists of sizes";
+    return -1;
+  }
+  load_options.tags.clear();
+  for (const string& tag :
+       str_util::Split(tags_string, ',', str_util::SkipEmpty())) {
+    load_options.tags.insert(tag);
+  }
+
+  LOG(INFO) << "SavedModel: [" << load_options.export_dir << "]";
+  LOG(INFO) << "Signature: [" << load_options.signature << "]";
+  LOG(INFO) << "Runtime: [" << runtime_string << "]";
+  LOG(INFO) << "Target QPS: [" << test_options.target_qps << "]";
+  LOG(INFO) << "Num clients: [" << test_options.num_clients << "]";
+
+  const int64_t load_start_us = Env::Default()->NowMicros();
+  absl::StatusOr<std::unique_ptr<SignatureRunner>> runner =
+      SignatureRunner::Create(load_options);
+  if (!runner.ok()) {
+    LOG(ERROR) << "Could not load SavedModel: " << runner.status();
+    return -1;
+  }
+  LOG(INFO) << "Loaded SavedModel in "
+            << (Env::Default()->NowMicros() - load_start_us) / 1e6 << "s";
+
+  absl::StatusOr<LoadTestResult> result =
+      RunLoadTest(runner->get(), input_options, test_options);
+  if (!result.ok()) {
+    LOG(ERROR) << "Load test failed: " << result.status();
+    return -1;
+  }
+  LOG(INFO) << FormatLoadTestResult(*result);
+  return 0;
+}
+
+}  // namespace benchmark_model
+}  // namespace tensorflow
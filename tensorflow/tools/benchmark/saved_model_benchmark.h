@@ -0,0 +1,143 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+
+// Runtime used to execute the SavedModel signature.
+enum class SavedModelRuntime { kDirectSession, kTfrt };
+
+struct SavedModelLoadOptions {
+  string export_dir;
+  std::unordered_set<string> tags = {"serve"};
+  string signature = "serving_default";
+  SavedModelRuntime runtime = SavedModelRuntime::kDirectSession;
+  // Number of intra-op and inter-op threads, or -1 for the runtime default.
+  int num_threads = -1;
+};
+
+// A request to a signature, as (tensor name, tensor) feeds.
+using SignatureFeeds = std::vector<std::pair<string, Tensor>>;
+
+// Runs one signature of a loaded SavedModel. Run() may be called concurrently.
+class SignatureRunner {
+ public:
+  virtual ~SignatureRunner() = default;
+
+  // Loads the SavedModel described by `options` with the selected runtime.
+  static absl::StatusOr<std::unique_ptr<SignatureRunner>> Create(
+      const SavedModelLoadOptions& options);
+
+  const SignatureDef& signature() const { return signature_; }
+
+  // Runs the signature on `feeds` and fetches all of its outputs.
+  virtual Status Run(const SignatureFeeds& feeds,
+                     std::vector<Tensor>* outputs) = 0;
+
+ protected:
+  explicit SignatureRunner(SignatureDef signature);
+
+  const SignatureDef signature_;
+  std::vector<string> output_names_;
+};
+
+// Controls how synthetic inputs are generated from the signature's TensorInfo.
+struct InputGenerationOptions {
+  // Sizes sampled uniformly for an unknown leading (batch) dimension. All
+  // inputs of one request share the sampled batch size.
+  std::vector<int64_t> batch_sizes = {1};
+  // Sizes sampled uniformly for any other unknown dimension.
+  std::vector<int64_t> dynamic_dim_sizes = {1};
+  // Probability that an element of a sparse (COO) input is present.
+  float sparse_density = 0.1f;
+  // Integer inputs, e.g. ids, are drawn from [0, max_int_value).
+  int64_t max_int_value = 100;
+};
+
+// Generates the feeds for one request to `signature`. Dense inputs get random
+// values; COO sparse inputs get random indices in row-major order with
+// matching values and dense shape.
+absl::StatusOr<SignatureFeeds> GenerateSignatureFeeds(
+    const SignatureDef& signature, const InputGenerationOptions& options,
+    std::mt19937_64* rng);
+
+struct LoadTestOptions {
+  // Aggregate request rate over all clients. If not positive, every client
+  // issues requests back-to-back (closed loop).
+  double target_qps = 0.0;
+  int num_clients = 1;
+  // Draw inter-arrival times from an exponential distribution instead of a
+  // fixed interval.
+  bool poisson_arrivals = true;
+  double duration_s = 10.0;
+  int warmup_requests = 10;
+  // Number of distinct generated requests cycled through by the clients, so
+  // input generation is not part of the measured latency.
+  int num_distinct_requests = 64;
+  uint64_t seed = 0;
+};
+
+struct LoadTestResult {
+  int64_t num_requests = 0;
+  int64_t num_errors = 0;
+  double elapsed_s = 0.0;
+  double achieved_qps = 0.0;
+  int64_t mean_us = 0;
+  int64_t p50_us = 0;
+  int64_t p90_us = 0;
+  int64_t p99_us = 0;
+  int64_t p999_us = 0;
+  int64_t max_us = 0;
+};
+
+// Returns the nearest-rank `percentile` (in [0, 100]) of `sorted_values`.
+int64_t Percentile(const std::vector<int64_t>& sorted_values,
+                   double percentile);
+
+// Drives `runner` with open-loop load. With a target QPS, each client follows
+// its own arrival schedule and latency is measured from the scheduled arrival
+// time, so time spent waiting behind a slow request is counted instead of
+// being hidden by coordinated omission.
+absl::StatusOr<LoadTestResult> RunLoadTest(
+    SignatureRunner* runner, const InputGenerationOptions& input_options,
+    const LoadTestOptions& options);
+
+// Formats `result` as a human readable summary.
+string FormatLoadTestResult(const LoadTestResult& result);
+
+// Handles all setup and argument parsing of the saved_model_benchmark binary.
+int SavedModelBenchmarkMain(int argc, char** argv);
+
+}  // namespace benchmark_model
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
@@ -0,0 +1,149 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+namespace {
+
+constexpr char kHalfPlusTwo[] =
+    "cc/saved_model/testdata/half_plus_two/00000123";
+
+TEST(SavedModelBenchmarkTest, Percentile) {
+  std::vector<int64_t> values;
+  for (int i = 1; i <= 1000; ++i) values.push_back(i);
+  EXPECT_EQ(Percentile(values, 50), 500);
+  EXPECT_EQ(Percentile(values, 99), 990);
+  EXPECT_EQ(Percentile(values, 99.9), 999);
+  EXPECT_EQ(Percentile(values, 100), 1000);
+  EXPECT_EQ(Percentile({}, 50), 0);
+}
+
+TEST(SavedModelBenchmarkTest, GeneratesDenseAndSparseFeeds) {
+  SignatureDef signature;
+  TensorInfo& dense = (*signature.mutable_inputs())["dense"];
+  dense.set_name("dense:0");
+  dense.set_dtype(DT_FLOAT);
+  dense.mutable_tensor_shape()->add_dim()->set_size(-1);
+  dense.mutable_tensor_shape()->add_dim()->set_size(-1);
+  dense.mutable_tensor_shape()->add_dim()->set_size(3);
+  TensorInfo& ids = (*signature.mutable_inputs())["ids"];
+  ids.set_dtype(DT_INT64);
+  ids.mutable_coo_sparse()->set_indices_tensor_name("ids/indices:0");
+  ids.mutable_coo_sparse()->set_values_tensor_name("ids/values:0");
+  ids.mutable_coo_sparse()->set_dense_shape_tensor_name("ids/shape:0");
+  ids.mutable_tensor_shape()->add_dim()->set_size(-1);
+  ids.mutable_tensor_shape()->add_dim()->set_size(50);
+
+  InputGenerationOptions options;
+  options.batch_sizes = {4};
+  options.dynamic_dim_sizes = {7};
+  options.sparse_density = 0.5f;
+  options.max_int_value = 10;
+  std::mt19937_64 rng(0);
+  TF_ASSERT_OK_AND_ASSIGN(SignatureFeeds feeds,
+                          GenerateSignatureFeeds(signature, options, &rng));
+
+  ASSERT_EQ(feeds.size(), 4);
+  EXPECT_EQ(feeds[0].first, "dense:0");
+  EXPECT_EQ(feeds[0].second.shape(), TensorShape({4, 7, 3}));
+  EXPECT_EQ(feeds[1].first, "ids/indices:0");
+  EXPECT_EQ(feeds[2].first, "ids/values:0");
+  EXPECT_EQ(feeds[3].first, "ids/shape:0");
+
+  const Tensor& indices = feeds[1].second;
+  const Tensor& values = feeds[2].second;
+  ASSERT_EQ(indices.dim_size(1), 2);
+  EXPECT_EQ(indices.dim_size(0), values.NumElements());
+  EXPECT_GT(values.NumElements(), 0);
+  EXPECT_LT(values.NumElements(), 200);
+  int64_t previous = -1;
+  for (int64_t i = 0; i < indices.dim_size(0); ++i) {
+    const int64_t row = indices.matrix<int64_t>()(i, 0);
+    const int64_t col = indices.matrix<int64_t>()(i, 1);
+    EXPECT_LT(row, 4);
+    EXPECT_LT(col, 50);
+    EXPECT_GT(row * 50 + col, previous);
+    previous = row * 50 + col;
+    EXPECT_LT(values.vec<int64_t>()(i), 10);
+  }
+  EXPECT_EQ(feeds[3].second.vec<int64_t>()(0), 4);
+  EXPECT_EQ(feeds[3].second.vec<int64_t>()(1), 50);
+}
+
+TEST(SavedModelBenchmarkTest, MissingSignature) {
+  SavedModelLoadOptions options;
+  options.export_dir = io::JoinPath(testing::TensorFlowSrcRoot(), kHalfPlusTwo);
+  options.signature = "does_not_exist";
+  EXPECT_FALSE(SignatureRunner::Create(options).ok());
+}
+
+TEST(SavedModelBenchmarkTest, OpenLoopLoadTest) {
+  SavedModelLoadOptions options;
+  options.export_dir = io::JoinPath(testing::TensorFlowSrcRoot(), kHalfPlusTwo);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SignatureRunner> runner,
+                          SignatureRunner::Create(options));
+
+  InputGenerationOptions input_options;
+  input_options.batch_sizes = {1, 8, 32};
+  LoadTestOptions test_options;
+  test_options.target_qps = 200;
+  test_options.num_clients = 2;
+  test_options.duration_s = 0.5;
+  test_options.num_distinct_requests = 4;
+  TF_ASSERT_OK_AND_ASSIGN(
+      LoadTestResult result,
+      RunLoadTest(runner.get(), input_options, test_options));
+
+  EXPECT_GT(result.num_requests, 0);
+  EXPECT_EQ(result.num_errors, 0);
+  EXPECT_LE(result.p50_us, result.p99_us);
+  EXPECT_LE(result.p99_us, result.p999_us);
+  EXPECT_LE(result.p999_us, result.max_us);
+  EXPECT_FALSE(FormatLoadTestResult(result).empty());
+}
+
+TEST(SavedModelBenchmarkTest, ClosedLoopLoadTest) {
+  SavedModelLoadOptions options;
+  options.export_dir = io::JoinPath(testing::TensorFlowSrcRoot(), kHalfPlusTwo);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SignatureRunner> runner,
+                          SignatureRunner::Create(options));
+
+  LoadTestOptions test_options;
+  test_options.duration_s = 0.2;
+  TF_ASSERT_OK_AND_ASSIGN(
+      LoadTestResult result,
+      RunLoadTest(runner.get(), InputGenerationOptions(), test_options));
+  EXPECT_GT(result.num_requests, 0);
+  EXPECT_GT(result.achieved_qps, 0);
+}
+
+}  // namespace
+}  // namespace benchmark_model
+}  // namespace tensorflow
@@ -0,0 +1,62 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Compares benchmark results against a baseline and reports regressions.
+
+Takes TestResults files written by tf_cc_logged_benchmark and
+tf_py_logged_benchmark targets, e.g.
+
+  compare_benchmarks --baseline=base1.json,base2.json --candidate=new.json
+
+and exits with a non-zero status if any benchmark regressed.
+"""
+
+import sys
+
+from absl import app
+from absl import flags
+
+from tensorflow.tools.test import compare_benchmarks_lib
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_list("baseline", [],
+                  "TestResults files of one or more baseline runs.")
+flags.DEFINE_string("candidate", "", "TestResults file of the run to check.")
+flags.DEFINE_float("threshold", 0.1,
+                   "Minimum relative slowdown reported as a regression.")
+
+
+def main(unused_args):
+  if not FLAGS.baseline or not FLAGS.candidate:
+    raise app.UsageError("--baseline and --candidate are required.")
+  baseline_runs = [
+      compare_benchmarks_lib.wall_times(
+          compare_benchmarks_lib.load_test_results(path))
+      for path in FLAGS.baseline
+  ]
+  candidate = compare_benchmarks_lib.wall_times(
+      compare_benchmarks_lib.load_test_results(FLAGS.candidate))
+  regressions = compare_benchmarks_lib.find_regressions(
+      baseline_runs, candidate, threshold=FLAGS.threshold)
+  for regression in regressions:
+    print(compare_benchmarks_lib.format_regression(regression))
+  if regressions:
+    print("%d of %d benchmarks regressed." % (len(regressions), len(candidate)))
+    sys.exit(1)
+  print("No regressions in %d benchmarks." % len(candidate))
+
+
+if __name__ == "__main__":
+  app.run(main)
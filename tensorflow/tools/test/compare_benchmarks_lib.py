@@ -0,0 +1,92 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Library for comparing benchmark results against a baseline."""
+
+import collections
+import statistics
+
+from google.protobuf import json_format
+from google.protobuf import text_format
+from tensorflow.core.util import test_log_pb2
+from tensorflow.python.platform import gfile
+
+# A benchmark whose wall time regressed relative to the baseline.
+Regression = collections.namedtuple(
+    "Regression", ["name", "baseline_wall_time", "wall_time", "threshold"])
+
+
+def load_test_results(path):
+  """Reads a TestResults proto written by run_and_gather_logs.
+
+  Args:
+    path: Path to a JSON or text format TestResults proto.
+
+  Returns:
+    A test_log_pb2.TestResults.
+  """
+  contents = gfile.GFile(path, "r").read()
+  test_results = test_log_pb2.TestResults()
+  if contents.lstrip().startswith("{"):
+    json_format.Parse(contents, test_results)
+  else:
+    text_format.Parse(contents, test_results)
+  return test_results
+
+
+def wall_times(test_results):
+  """Returns a dict from benchmark name to per-iteration wall time."""
+  return {
+      entry.name: entry.wall_time
+      for entry in test_results.entries.entry
+      if entry.wall_time > 0
+  }
+
+
+def find_regressions(baseline_runs, candidate, threshold=0.1):
+  """Compares candidate wall times against one or more baseline runs.
+
+  A benchmark regresses when its wall time exceeds the median baseline wall
+  time by more than `threshold`, or by more than twice the relative spread of
+  the baseline runs when that is larger, so that noisy benchmarks need a
+  bigger slowdown before they are flagged.
+
+  Args:
+    baseline_runs: List of dicts from benchmark name to wall time.
+    candidate: Dict from benchmark name to wall time.
+    threshold: Minimum relative slowdown reported as a regression.
+
+  Returns:
+    A list of Regression, sorted by name. Benchmarks missing from either side
+    are ignored.
+  """
+  regressions = []
+  for name in sorted(candidate):
+    baseline = [run[name] for run in baseline_runs if name in run]
+    if not baseline:
+      continue
+    median = statistics.median(baseline)
+    noise = (max(baseline) - min(baseline)) / median
+    allowed = max(threshold, 2 * noise)
+    if candidate[name] > median * (1 + allowed):
+      regressions.append(Regression(name, median, candidate[name], allowed))
+  return regressions
+
+
+def format_regression(regression):
+  """Returns a one-line human readable description of `regression`."""
+  return "%s: %.3gs -> %.3gs (+%.1f%%, allowed +%.1f%%)" % (
+      regression.name, regression.baseline_wall_time, regression.wall_time,
+      100 * (regression.wall_time / regression.baseline_wall_time - 1),
+      100 * regression.threshold)
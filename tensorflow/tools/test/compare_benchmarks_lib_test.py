@@ -0,0 +1,55 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for compare_benchmarks_lib."""
+
+import os
+
+from google.protobuf import json_format
+from tensorflow.core.util import test_log_pb2
+from tensorflow.python.platform import test
+from tensorflow.tools.test import compare_benchmarks_lib
+
+
+class CompareBenchmarksLibTest(test.TestCase):
+
+  def testLoadsJsonTestResults(self):
+    test_results = test_log_pb2.TestResults()
+    entry = test_results.entries.entry.add()
+    entry.name = "BM_Hot_MatMul_cpu_float_1024_1024_1024"
+    entry.wall_time = 0.5
+    path = os.path.join(self.get_temp_dir(), "results.json")
+    with open(path, "w") as f:
+      f.write(json_format.MessageToJson(test_results))
+    self.assertEqual(
+        {"BM_Hot_MatMul_cpu_float_1024_1024_1024": 0.5},
+        compare_benchmarks_lib.wall_times(
+            compare_benchmarks_lib.load_test_results(path)))
+
+  def testFindsRegressions(self):
+    baseline = [{"fast": 1.0, "slow": 1.0}]
+    candidate = {"fast": 1.05, "slow": 1.5, "new": 3.0}
+    regressions = compare_benchmarks_lib.find_regressions(baseline, candidate)
+    self.assertEqual(["slow"], [r.name for r in regressions])
+
+  def testNoisyBaselineRaisesThreshold(self):
+    baseline = [{"noisy": 0.9}, {"noisy": 1.0}, {"noisy": 1.1}]
+    self.assertEmpty(
+        compare_benchmarks_lib.find_regressions(baseline, {"noisy": 1.3}))
+    self.assertLen(
+        compare_benchmarks_lib.find_regressions(baseline, {"noisy": 1.5}), 1)
+
+
+if __name__ == "__main__":
+  test.main()
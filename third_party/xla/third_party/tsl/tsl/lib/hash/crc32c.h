@@ -42,6 +42,15 @@ extern uint32 Extend(uint32 init_crc, const absl::Cord& cord);
 // Return the crc32c of data[0,n-1]
 inline uint32 Value(const char* data, size_t n) { return Extend(0, data, n); }
 
+// Return the crc32c of concat(A, B) where lhs_crc is the crc32c of A and
+// rhs_crc is the crc32c of B, which is rhs_len bytes long. This lets the
+// crc32c of a buffer be computed from the crc32c of its parts.
+inline uint32 Concat(uint32 lhs_crc, uint32 rhs_crc, size_t rhs_len) {
+  return static_cast<uint32>(
+      absl::ConcatCrc32c(static_cast<absl::crc32c_t>(lhs_crc),
+                         static_cast<absl::crc32c_t>(rhs_crc), rhs_len));
+}
+
 #if defined(TF_CORD_SUPPORT)
 inline uint32 Value(const absl::Cord& cord) { return Extend(0, cord); }
 #endif
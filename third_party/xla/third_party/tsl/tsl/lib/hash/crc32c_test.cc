@@ -67,6 +67,11 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, Concat) {
+  ASSERT_EQ(Value("hello world", 11),
+            Concat(Value("hello ", 6), Value("world", 5), 5));
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
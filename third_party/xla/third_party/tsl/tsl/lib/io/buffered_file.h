@@ -61,6 +61,19 @@ class BufferedWritableFile : public WritableFile {
     return absl::OkStatus();
   }
 
+  // Appends `str_data`, whose crc32c was computed by the caller, without
+  // copying it to the buffer. The caller must not modify `str_data` while it
+  // is appended.
+  absl::Status AppendWithCrc32(StringPiece str_data, uint32_t str_crc32) {
+    if (buffer_pos_ > 0) {
+      TF_RETURN_IF_ERROR(file_->Append(StringPiece(&buffer_[0], buffer_pos_)));
+      buffer_pos_ = 0;
+    }
+    TF_RETURN_IF_ERROR(file_->Append(str_data));
+    crc32_ = crc32c::Concat(crc32_, str_crc32, str_data.size());
+    return absl::OkStatus();
+  }
+
   absl::Status Append(const absl::Cord& data) override {
     for (absl::string_view fragment : data.Chunks()) {
       TF_RETURN_IF_ERROR(Append(fragment));
@@ -46,6 +46,24 @@ TEST(BufferedInputStream, Tell) {
   EXPECT_EQ(position, 9);
 }
 
+TEST(BufferedWritableFile, AppendWithCrc32) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  std::unique_ptr<WritableFile> write_file;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &write_file));
+  BufferedWritableFile file(std::move(write_file), 8);
+  TF_ASSERT_OK(file.Append("foo"));
+  TF_ASSERT_OK(file.AppendWithCrc32("barbaz", crc32c::Value("barbaz", 6)));
+  TF_ASSERT_OK(file.Append("qux"));
+  EXPECT_EQ(file.crc32(), crc32c::Value("foobarbazqux", 12));
+  TF_ASSERT_OK(file.Close());
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &contents));
+  EXPECT_EQ(contents, "foobarbazqux");
+}
+
 }  // anonymous namespace
 }  // namespace io
 }  // namespace tsl
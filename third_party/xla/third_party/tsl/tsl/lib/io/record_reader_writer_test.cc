@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/coding.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
@@ -343,6 +344,112 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestParallelGzip) {
+  Env* env = Env::Default();
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_parallel_gzip_test";
+  std::vector<string> records;
+  for (int i = 0; i < 1000; ++i) {
+    records.push_back(strings::StrCat("record_", i, string(i % 37, 'x')));
+  }
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriterOptions options =
+        io::RecordWriterOptions::CreateRecordWriterOptions("GZIP");
+    options.num_compression_threads = 4;
+    options.parallel_compression_block_size = 1000;
+    io::RecordWriter writer(file.get(), options);
+    for (size_t i = 0; i < records.size(); ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(records[i]));
+      // A flush compresses a partial block.
+      if (i == 500) TF_EXPECT_OK(writer.Flush());
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+
+  {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReader reader(
+        read_file.get(),
+        io::RecordReaderOptions::CreateRecordReaderOptions("GZIP"));
+    uint64 offset = 0;
+    tstring record;
+    for (const string& expected : records) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(expected, record);
+    }
+    EXPECT_TRUE(absl::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = fname + ".index";
+  const std::vector<string> records = {"abc", "", "defghij"};
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+
+    io::RecordWriterOptions options;
+    options.index_dest = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    TF_CHECK_OK(index_file->Close());
+  }
+
+  string index;
+  TF_CHECK_OK(ReadFileToString(env, index_fname, &index));
+  ASSERT_EQ(index.size(), io::RecordWriter::kIndexMagicSize +
+                              records.size() * sizeof(uint64));
+  EXPECT_EQ(index.substr(0, io::RecordWriter::kIndexMagicSize),
+            io::RecordWriter::kIndexMagic);
+
+  // Reads the records in reverse order, seeking to each indexed offset.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  for (int i = records.size() - 1; i >= 0; --i) {
+    uint64 offset = core::DecodeFixed64(
+        index.data() + io::RecordWriter::kIndexMagicSize + i * sizeof(uint64));
+    tstring record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[i], record);
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndexIgnoredWhenCompressed) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zlib_index_test";
+  string index_fname = fname + ".index";
+
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+  {
+    io::RecordWriterOptions options;
+    options.compression_type = io::RecordWriterOptions::ZLIB_COMPRESSION;
+    options.index_dest = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_CHECK_OK(writer.Close());
+  }
+  TF_CHECK_OK(index_file->Close());
+  EXPECT_EQ(GetFileSize(index_fname), 0);
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -59,13 +59,28 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 
 RecordWriter::RecordWriter(WritableFile* dest,
                            const RecordWriterOptions& options)
-    : dest_(dest), options_(options) {
+    : dest_(dest), options_(options), index_dest_(options.index_dest) {
+  if (index_dest_ != nullptr &&
+      options.compression_type != RecordWriterOptions::NONE) {
+    LOG(WARNING) << "Compressed records cannot be indexed; no index will be "
+                 << "written.";
+    index_dest_ = nullptr;
+  }
 #if defined(IS_SLIM_BUILD)
   if (options.compression_type != RecordWriterOptions::NONE) {
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
   }
 #else
-  if (IsZlibCompressed(options)) {
+  if (IsZlibCompressed(options) && options.num_compression_threads > 1 &&
+      options.zlib_options.window_bits == MAX_WBITS + 16) {
+    dest_ = new ParallelZlibOutputBuffer(
+        dest, options.parallel_compression_block_size,
+        options.num_compression_threads, options.zlib_options);
+  } else if (IsZlibCompressed(options)) {
+    if (options.num_compression_threads > 1) {
+      LOG(WARNING) << "Parallel compression requires GZIP framing; records "
+                   << "will be compressed on the writer thread.";
+    }
     ZlibOutputBuffer* zlib_output_buffer = new ZlibOutputBuffer(
         dest, options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options);
@@ -110,6 +125,7 @@ absl::Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[kFooterSize];
   PopulateHeader(header, data.data(), data.size());
   PopulateFooter(footer, data.data(), data.size());
+  TF_RETURN_IF_ERROR(IndexRecord(data.size()));
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
@@ -130,14 +146,35 @@ absl::Status RecordWriter::WriteRecord(const absl::Cord& data) {
   char footer[kFooterSize];
   PopulateHeader(header, data);
   PopulateFooter(footer, data);
+  TF_RETURN_IF_ERROR(IndexRecord(data.size()));
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
   return dest_->Append(StringPiece(footer, sizeof(footer)));
 }
 #endif
 
+absl::Status RecordWriter::IndexRecord(size_t n) {
+  if (index_dest_ == nullptr) return absl::OkStatus();
+  TF_RETURN_IF_ERROR(MaybeWriteIndexMagic());
+  char entry[sizeof(uint64)];
+  core::EncodeFixed64(entry, offset_);
+  TF_RETURN_IF_ERROR(index_dest_->Append(StringPiece(entry, sizeof(entry))));
+  offset_ += kHeaderSize + n + kFooterSize;
+  return absl::OkStatus();
+}
+
+absl::Status RecordWriter::MaybeWriteIndexMagic() {
+  if (index_dest_ == nullptr || wrote_index_magic_) return absl::OkStatus();
+  TF_RETURN_IF_ERROR(
+      index_dest_->Append(StringPiece(kIndexMagic, kIndexMagicSize)));
+  wrote_index_magic_ = true;
+  return absl::OkStatus();
+}
+
 absl::Status RecordWriter::Close() {
   if (dest_ == nullptr) return absl::OkStatus();
+  // Writes the header of the index of an empty file.
+  TF_RETURN_IF_ERROR(MaybeWriteIndexMagic());
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
     absl::Status s = dest_->Close();
     delete dest_;
@@ -152,6 +189,9 @@ absl::Status RecordWriter::Flush() {
     return absl::Status(absl::StatusCode::kFailedPrecondition,
                         "Writer not initialized or previously closed");
   }
+  if (index_dest_ != nullptr) {
+    TF_RETURN_IF_ERROR(index_dest_->Flush());
+  }
   return dest_->Flush();
 }
 
@@ -52,7 +52,20 @@ struct RecordWriterOptions {
   // Options specific to compression.
   io::ZlibCompressionOptions zlib_options;
   io::SnappyCompressionOptions snappy_options;
+
+  // If greater than 1 and the records are GZIP compressed, the output is
+  // split into blocks of `parallel_compression_block_size` bytes that are
+  // compressed as independent gzip members on this many threads. Readers
+  // decompress the concatenated members like any other GZIP file.
+  int num_compression_threads = 1;
+  int64_t parallel_compression_block_size = 1 << 20;
 #endif  // IS_SLIM_BUILD
+
+  // If set and `compression_type` is `NONE`, the writer also writes an index
+  // of the records to this file (see `RecordWriter::kIndexMagic`), so that
+  // readers can seek to any record. "*index_dest" must be initially empty and
+  // must remain live while the writer is in use.
+  WritableFile* index_dest = nullptr;
 };
 
 class RecordWriter {
@@ -65,6 +78,12 @@ class RecordWriter {
   static constexpr size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
   static constexpr size_t kFooterSize = sizeof(uint32);
 
+  // Format of a record index:
+  //  byte      magic[kIndexMagicSize]
+  //  uint64    offset of each record, in order
+  static constexpr char kIndexMagic[] = "TFRIDX01";
+  static constexpr size_t kIndexMagicSize = sizeof(kIndexMagic) - 1;
+
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
@@ -111,8 +130,17 @@ class RecordWriter {
 #endif
 
  private:
+  // Appends the offset of the next record to the index, if any, and advances
+  // the offset past a record of `n` bytes.
+  absl::Status IndexRecord(size_t n);
+  // Writes the index header if it has not been written yet.
+  absl::Status MaybeWriteIndexMagic();
+
   WritableFile* dest_;
   RecordWriterOptions options_;
+  WritableFile* index_dest_;
+  bool wrote_index_magic_ = false;
+  uint64 offset_ = 0;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
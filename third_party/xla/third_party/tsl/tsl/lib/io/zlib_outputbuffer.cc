@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tsl/lib/io/zlib_outputbuffer.h"
 
+#include <algorithm>
+
 #include "tsl/platform/errors.h"
 
 namespace tsl {
@@ -242,5 +244,134 @@ absl::Status ZlibOutputBuffer::Tell(int64_t* position) {
   return file_->Tell(position);
 }
 
+namespace {
+
+// Compresses `input` into `output` as a single complete zlib stream, i.e. a
+// gzip member when `options` use gzip framing.
+absl::Status DeflateBlock(StringPiece input,
+                          const ZlibCompressionOptions& options,
+                          std::string* output) {
+  z_stream stream = {};
+  int error = deflateInit2(&stream, options.compression_level,
+                           options.compression_method, options.window_bits,
+                           options.mem_level, options.compression_strategy);
+  if (error != Z_OK) {
+    return errors::InvalidArgument("deflateInit failed with status", error);
+  }
+  output->resize(deflateBound(&stream, input.size()));
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  stream.avail_out = output->size();
+  error = deflate(&stream, Z_FINISH);
+  output->resize(stream.total_out);
+  deflateEnd(&stream);
+  if (error != Z_STREAM_END) {
+    return errors::DataLoss("deflate() failed with error ", error);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+ParallelZlibOutputBuffer::ParallelZlibOutputBuffer(
+    WritableFile* file, int64_t block_bytes, int num_threads,
+    const ZlibCompressionOptions& zlib_options)
+    : file_(file),
+      block_bytes_(block_bytes),
+      max_pending_blocks_(2 * num_threads),
+      zlib_options_(zlib_options),
+      thread_pool_(Env::Default(), "parallel_zlib_output", num_threads) {
+  DCHECK_GT(block_bytes, 0);
+  DCHECK_EQ(zlib_options.window_bits, MAX_WBITS + 16)
+      << "Parallel compression requires gzip framing";
+}
+
+ParallelZlibOutputBuffer::~ParallelZlibOutputBuffer() {
+  if (!closed_ && !pending_blocks_.empty()) {
+    LOG(WARNING) << "ParallelZlibOutputBuffer::Close() not called. Possible "
+                    "data loss";
+  }
+}
+
+absl::Status ParallelZlibOutputBuffer::Append(StringPiece data) {
+  if (closed_) {
+    return errors::FailedPrecondition("Append called on a closed buffer");
+  }
+  while (!data.empty()) {
+    const size_t n =
+        std::min<size_t>(data.size(), block_bytes_ - current_block_.size());
+    current_block_.append(data.data(), n);
+    data.remove_prefix(n);
+    if (current_block_.size() == static_cast<size_t>(block_bytes_)) {
+      CompressCurrentBlock();
+      TF_RETURN_IF_ERROR(WriteBlocks(max_pending_blocks_));
+    }
+  }
+  return absl::OkStatus();
+}
+
+void ParallelZlibOutputBuffer::CompressCurrentBlock() {
+  if (current_block_.empty()) return;
+  auto block = std::make_shared<Block>();
+  block->data = std::move(current_block_);
+  current_block_.clear();
+  pending_blocks_.push_back(block);
+  thread_pool_.Schedule([this, block] {
+    std::string output;
+    absl::Status s = DeflateBlock(block->data, zlib_options_, &output);
+    mutex_lock l(mu_);
+    block->data = std::move(output);
+    block->status = s;
+    block->done = true;
+    block_done_.notify_all();
+  });
+}
+
+absl::Status ParallelZlibOutputBuffer::WriteBlocks(size_t max_pending) {
+  while (pending_blocks_.size() > max_pending) {
+    std::shared_ptr<Block> block = pending_blocks_.front();
+    {
+      mutex_lock l(mu_);
+      while (!block->done) block_done_.wait(l);
+    }
+    pending_blocks_.pop_front();
+    TF_RETURN_IF_ERROR(block->status);
+    TF_RETURN_IF_ERROR(file_->Append(block->data));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ParallelZlibOutputBuffer::Flush() {
+  if (closed_) {
+    return errors::FailedPrecondition("Flush called on a closed buffer");
+  }
+  CompressCurrentBlock();
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  return file_->Flush();
+}
+
+absl::Status ParallelZlibOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+absl::Status ParallelZlibOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+absl::Status ParallelZlibOutputBuffer::Close() {
+  if (closed_) return absl::OkStatus();
+  CompressCurrentBlock();
+  absl::Status s = WriteBlocks(0);
+  closed_ = true;
+  return s;
+}
+
+absl::Status ParallelZlibOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
 }  // namespace io
 }  // namespace tsl
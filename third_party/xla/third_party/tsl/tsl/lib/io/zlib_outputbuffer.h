@@ -18,14 +18,18 @@ limitations under the License.
 
 #include <zlib.h>
 
+#include <deque>
+#include <memory>
 #include <string>
 
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/macros.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -153,6 +157,82 @@ class ZlibOutputBuffer : public WritableFile {
   void operator=(const ZlibOutputBuffer&) = delete;
 };
 
+// Writes gzip compressed output like ZlibOutputBuffer, but splits the input
+// into blocks of `block_bytes` that are compressed as independent gzip members
+// on `num_threads` threads and appended to `file` in order. The concatenated
+// members form a valid gzip file that ZlibInputStream reads like any other,
+// at a small cost in compression ratio since blocks share no history.
+//
+// `zlib_options` must use gzip framing, i.e. window_bits of 16 + MAX_WBITS.
+// A given instance is NOT safe for concurrent use by multiple threads.
+class ParallelZlibOutputBuffer : public WritableFile {
+ public:
+  // Does not take ownership of `file`.
+  ParallelZlibOutputBuffer(WritableFile* file, int64_t block_bytes,
+                           int num_threads,
+                           const ZlibCompressionOptions& zlib_options);
+
+  // Waits for the blocks being compressed, but does not write them.
+  ~ParallelZlibOutputBuffer() override;
+
+  // Adds `data` to the current block, which is handed to a compression thread
+  // once it holds `block_bytes`. Blocks until the oldest block is written if
+  // too many are in flight.
+  absl::Status Append(StringPiece data) override;
+
+  // Compresses the current block even if it is not full and writes all
+  // blocks to file.
+  absl::Status Flush() override;
+
+  // Writes all output to file. Any further calls to `Append()` or `Flush()`
+  // will fail.
+  absl::Status Close() override;
+
+  // Returns the name of the underlying file.
+  absl::Status Name(StringPiece* result) const override;
+
+  // Writes all output to file and syncs it.
+  absl::Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  absl::Status Tell(int64_t* position) override;
+
+ private:
+  // A block of input and, once `done`, its compressed output.
+  struct Block {
+    std::string data;
+    absl::Status status;
+    bool done = false;
+  };
+
+  // Hands the current block, if not empty, to a compression thread.
+  void CompressCurrentBlock();
+
+  // Writes the compressed blocks to file in order, until at most
+  // `max_pending` remain in flight.
+  absl::Status WriteBlocks(size_t max_pending);
+
+  WritableFile* file_;  // Not owned
+  const int64_t block_bytes_;
+  const size_t max_pending_blocks_;
+  ZlibCompressionOptions const zlib_options_;
+  bool closed_ = false;
+
+  std::string current_block_;
+  // Blocks handed to compression threads, in file order.
+  std::deque<std::shared_ptr<Block>> pending_blocks_;
+  mutex mu_;
+  condition_variable block_done_;
+
+  // Declared last so that its destructor waits for the compression threads
+  // before the members they use are destroyed.
+  thread::ThreadPool thread_pool_;
+
+  ParallelZlibOutputBuffer(const ParallelZlibOutputBuffer&) = delete;
+  void operator=(const ParallelZlibOutputBuffer&) = delete;
+};
+
 }  // namespace io
 }  // namespace tsl
 
@@ -69,6 +69,27 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that generating samples in batches produces the same
+// samples as generating them one at a time, including for partial batches.
+TEST(PhiloxRandomTest, GenerateBatchMatchTest) {
+  constexpr int count = 4 * PhiloxRandom::kBatchSize + 3;
+
+  uint64 test_seed = GetTestSeed();
+  PhiloxRandom gen1(test_seed);
+  PhiloxRandom gen2(test_seed);
+  std::vector<PhiloxRandom::ResultType> batched(count);
+  gen1.GenerateBatch(&batched[0], count);
+
+  for (int i = 0; i < count; ++i) {
+    const PhiloxRandom::ResultType expected = gen2();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(batched[i][j], expected[j]);
+    }
+  }
+  // Both generators end up at the same position.
+  ASSERT_EQ(gen1()[0], gen2()[0]);
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -56,6 +57,7 @@ limitations under the License.
 #include "tsl/platform/str_util.h"
 #include "tsl/platform/stringprintf.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/traceme.h"
 
 #ifdef _WIN32
@@ -163,6 +165,20 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // objects.
 constexpr char kComposeAppend[] = "compose";
 
+// The environment variable that enables parallel composite uploads of new
+// files: the data is uploaded in parts of at least this size (in MB) while the
+// file is being written, and the parts are composed into the file on
+// flush/close. This is disabled by default, as failed uploads may strand
+// temporary objects.
+constexpr char kCompositeUploadPartSize[] = "GCS_COMPOSITE_UPLOAD_PART_SIZE_MB";
+// The environment variable that sets the maximum number of parts of a file
+// uploaded concurrently.
+constexpr char kCompositeUploadParallelism[] =
+    "GCS_COMPOSITE_UPLOAD_PARALLELISM";
+constexpr int kDefaultCompositeUploadParallelism = 8;
+// The maximum number of source objects of a GCS compose request.
+constexpr size_t kMaxComposeSources = 32;
+
 absl::Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return absl::OkStatus();
@@ -466,6 +482,11 @@ typedef std::function<absl::Status(const string& fname, const string& bucket,
 ///
 /// Since GCS objects are immutable, this implementation writes to a local
 /// tmp file and copies it to GCS on flush/close.
+///
+/// With parallel composite uploads, the tmp file is instead uploaded to a
+/// temporary part object in the background whenever it reaches the part size,
+/// and a new tmp file is started. On flush/close the parts are composed into
+/// the object and deleted.
 class GcsWritableFile : public WritableFile {
  public:
   GcsWritableFile(const string& bucket, const string& object,
@@ -475,7 +496,9 @@ class GcsWritableFile : public WritableFile {
                   RetryConfig retry_config, bool compose_append,
                   SessionCreator session_creator,
                   ObjectUploader object_uploader, StatusPoller status_poller,
-                  GenerationGetter generation_getter)
+                  GenerationGetter generation_getter,
+                  uint64 composite_upload_part_size = 0,
+                  int composite_upload_parallelism = 1)
       : bucket_(bucket),
         object_(object),
         filesystem_(filesystem),
@@ -488,9 +511,15 @@ class GcsWritableFile : public WritableFile {
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
-        generation_getter_(std::move(generation_getter)) {
+        generation_getter_(std::move(generation_getter)),
+        part_size_(composite_upload_part_size),
+        max_pending_parts_(2 * composite_upload_parallelism) {
     // TODO: to make it safer, outfile_ should be constructed from an FD
     VLOG(3) << "GcsWritableFile: " << GetGcsPath();
+    if (part_size_ > 0) {
+      part_upload_pool_ = std::make_unique<thread::ThreadPool>(
+          Env::Default(), "gcs_composite_upload", composite_upload_parallelism);
+    }
     if (GetTmpFilename(&tmp_content_filename_).ok()) {
       outfile_.open(tmp_content_filename_,
                     std::ofstream::binary | std::ofstream::app);
@@ -522,7 +551,9 @@ class GcsWritableFile : public WritableFile {
         session_creator_(std::move(session_creator)),
         object_uploader_(std::move(object_uploader)),
         status_poller_(std::move(status_poller)),
-        generation_getter_(std::move(generation_getter)) {
+        generation_getter_(std::move(generation_getter)),
+        part_size_(0),
+        max_pending_parts_(0) {
     VLOG(3) << "GcsWritableFile: " << GetGcsPath() << "with existing file "
             << tmp_content_filename;
     tmp_content_filename_ = tmp_content_filename;
@@ -544,6 +575,13 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not append to the internal temporary file.");
     }
+    if (part_size_ > 0) {
+      uint64 size;
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&size));
+      if (size >= part_size_) {
+        return StartPartUpload();
+      }
+    }
     return absl::OkStatus();
   }
 
@@ -588,6 +626,7 @@ class GcsWritableFile : public WritableFile {
     if (*position == -1) {
       return errors::Internal("tellp on the internal temporary file failed");
     }
+    *position += uploaded_offset_;
     return absl::OkStatus();
   }
 
@@ -599,6 +638,9 @@ class GcsWritableFile : public WritableFile {
   /// resumable API documentation. When the whole upload needs to be
   /// restarted, Sync() returns UNAVAILABLE and relies on RetryingFileSystem.
   absl::Status SyncImpl() {
+    if (uploaded_offset_ > 0 || !part_objects_.empty()) {
+      return SyncParts();
+    }
     outfile_.flush();
     if (!outfile_.good()) {
       return errors::Internal(
@@ -659,10 +701,184 @@ class GcsWritableFile : public WritableFile {
         TF_RETURN_IF_ERROR(AppendObject(object_to_upload));
       }
       TF_RETURN_IF_ERROR(GetCurrentFileSize(&start_offset_));
+      if (part_size_ > 0) {
+        // Later parts are composed at the end of the uploaded object.
+        TF_RETURN_IF_ERROR(StartNewTmpFile());
+        uploaded_offset_ = start_offset_;
+        object_exists_ = true;
+      }
     }
     return upload_status;
   }
 
+  /// Replaces the internal temporary file with a new, empty one.
+  absl::Status StartNewTmpFile() {
+    outfile_.close();
+    std::remove(tmp_content_filename_.c_str());
+    TF_RETURN_IF_ERROR(GetTmpFilename(&tmp_content_filename_));
+    outfile_.open(tmp_content_filename_,
+                  std::ofstream::binary | std::ofstream::app);
+    return CheckWritable();
+  }
+
+  /// Uploads the internal temporary file to the next part object in the
+  /// background, and starts a new temporary file for the following data.
+  absl::Status StartPartUpload() {
+    uint64 size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&size));
+    outfile_.close();
+    if (!outfile_.good()) {
+      return errors::Internal(
+          "Could not write to the internal temporary file.");
+    }
+    const string part_object = strings::StrCat(
+        io::Dirname(object_), "/.tmpparts/", io::Basename(object_), ".",
+        part_objects_.size());
+    part_objects_.push_back(part_object);
+    const string part_filename = tmp_content_filename_;
+    {
+      // Bound the number of parts waiting on the local disk.
+      mutex_lock l(parts_mu_);
+      while (pending_parts_ >= max_pending_parts_) {
+        parts_cv_.wait(l);
+      }
+      ++pending_parts_;
+    }
+    part_upload_pool_->Schedule([this, part_object, part_filename, size] {
+      absl::Status status = UploadPart(part_object, part_filename, size);
+      std::remove(part_filename.c_str());
+      mutex_lock l(parts_mu_);
+      parts_status_.Update(status);
+      --pending_parts_;
+      parts_cv_.notify_all();
+    });
+    uploaded_offset_ += size;
+    TF_RETURN_IF_ERROR(GetTmpFilename(&tmp_content_filename_));
+    outfile_.open(tmp_content_filename_,
+                  std::ofstream::binary | std::ofstream::app);
+    return CheckWritable();
+  }
+
+  /// Uploads the file `filename` of `size` bytes to `part_object`.
+  absl::Status UploadPart(const string& part_object, const string& filename,
+                          uint64 size) {
+    const string part_path = GetGcsPathWithObject(part_object);
+    UploadSessionHandle session_handle;
+    TF_RETURN_IF_ERROR(session_creator_(0, part_object, bucket_, size,
+                                        part_path, &session_handle));
+    uint64 already_uploaded = 0;
+    bool first_attempt = true;
+    return RetryingUtils::CallWithRetries(
+        [&]() {
+          if (session_handle.resumable && !first_attempt) {
+            bool completed;
+            TF_RETURN_IF_ERROR(status_poller_(session_handle.session_uri, size,
+                                              part_path, &completed,
+                                              &already_uploaded));
+            if (completed) {
+              return absl::OkStatus();
+            }
+          }
+          first_attempt = false;
+          return object_uploader_(session_handle.session_uri, 0,
+                                  already_uploaded, filename, size, part_path);
+        },
+        retry_config_);
+  }
+
+  /// Uploads the remaining data as a last part, waits for all the parts to be
+  /// uploaded and composes them at the end of the object. The part objects are
+  /// deleted whether or not this succeeds.
+  absl::Status SyncParts() {
+    absl::Status status = absl::OkStatus();
+    uint64 size;
+    TF_RETURN_IF_ERROR(GetCurrentFileSize(&size));
+    if (size > 0) {
+      status = StartPartUpload();
+    }
+    {
+      mutex_lock l(parts_mu_);
+      while (pending_parts_ > 0) {
+        parts_cv_.wait(l);
+      }
+      status.Update(parts_status_);
+    }
+    if (status.ok()) {
+      status = ComposeParts();
+    }
+    for (const string& part_object : part_objects_) {
+      const string part_path = GetGcsPathWithObject(part_object);
+      absl::Status delete_status = RetryingUtils::DeleteWithRetries(
+          [&part_path, this]() {
+            return filesystem_->DeleteFile(part_path, nullptr);
+          },
+          retry_config_);
+      if (!delete_status.ok()) {
+        LOG(WARNING) << "Failed to delete " << part_path << ": "
+                     << delete_status;
+      }
+    }
+    part_objects_.clear();
+    if (status.ok()) {
+      file_cache_erase_();
+      object_exists_ = true;
+    }
+    return status;
+  }
+
+  /// Composes the part objects, in order, at the end of the object. GCS limits
+  /// the number of sources of a compose request, so more parts are composed
+  /// with several requests.
+  absl::Status ComposeParts() {
+    size_t next_part = 0;
+    while (next_part < part_objects_.size()) {
+      std::vector<string> sources;
+      if (object_exists_) {
+        sources.push_back(object_);
+      }
+      while (sources.size() < kMaxComposeSources &&
+             next_part < part_objects_.size()) {
+        sources.push_back(part_objects_[next_part++]);
+      }
+      TF_RETURN_IF_ERROR(ComposeObjects(sources));
+      object_exists_ = true;
+    }
+    return absl::OkStatus();
+  }
+
+  /// Replaces the object with the concatenation of the `sources` objects.
+  absl::Status ComposeObjects(const std::vector<string>& sources) {
+    VLOG(3) << "ComposeObjects: " << sources.size() << " objects to "
+            << GetGcsPath();
+    return RetryingUtils::CallWithRetries(
+        [&sources, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(object_),
+                                          "/compose"));
+
+          std::vector<string> source_objects;
+          source_objects.reserve(sources.size());
+          for (const string& source : sources) {
+            source_objects.push_back(
+                strings::StrCat("{'name': '", source, "'}"));
+          }
+          const string request_body =
+              strings::StrCat("{'sourceObjects': [",
+                              absl::StrJoin(source_objects, ","), "]}");
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ", GetGcsPath());
+          return absl::OkStatus();
+        },
+        retry_config_);
+  }
+
   absl::Status CheckWritable() const {
     if (!outfile_.is_open()) {
       return errors::FailedPrecondition(
@@ -783,6 +999,24 @@ class GcsWritableFile : public WritableFile {
   const ObjectUploader object_uploader_;
   const StatusPoller status_poller_;
   const GenerationGetter generation_getter_;
+  // Parallel composite uploads are enabled if part_size_ is positive.
+  const uint64 part_size_;
+  const int max_pending_parts_;
+  // The number of bytes written before the internal temporary file, which are
+  // either in the object or in part objects.
+  uint64 uploaded_offset_ = 0;
+  // Whether the object holds the data composed by previous syncs.
+  bool object_exists_ = false;
+  // The part objects started since the last sync, in order.
+  std::vector<string> part_objects_;
+  mutex parts_mu_;
+  condition_variable parts_cv_;
+  int pending_parts_ TF_GUARDED_BY(parts_mu_) = 0;
+  // The first error of a part upload since the last sync.
+  absl::Status parts_status_ TF_GUARDED_BY(parts_mu_);
+  // Destroyed first, so that pending part uploads finish before the members
+  // they use are destroyed.
+  std::unique_ptr<thread::ThreadPool> part_upload_pool_;
 };
 
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
@@ -851,12 +1085,17 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kReadAheadBlocks, strings::safe_strtou64, &value)) {
+    read_ahead_blocks_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "read ahead blocks = " << read_ahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -978,6 +1217,15 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
     compose_append_ = false;
   }
 
+  uint64 composite_upload_part_size_mb = 0;
+  GetEnvVar(kCompositeUploadPartSize, strings::safe_strtou64,
+            &composite_upload_part_size_mb);
+  int64_t composite_upload_parallelism = kDefaultCompositeUploadParallelism;
+  GetEnvVar(kCompositeUploadParallelism, strings::safe_strto64,
+            &composite_upload_parallelism);
+  SetCompositeUploadOptions(composite_upload_part_size_mb * 1024 * 1024,
+                            composite_upload_parallelism);
+
   retry_config_ = GetGcsRetryConfig();
 }
 
@@ -1077,6 +1325,12 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
   }
 }
 
+void GcsFileSystem::SetCompositeUploadOptions(uint64 part_size,
+                                              int parallelism) {
+  composite_upload_part_size_ = part_size;
+  composite_upload_parallelism_ = std::max(parallelism, 1);
+}
+
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
@@ -1086,7 +1340,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), read_ahead_blocks_));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -1353,7 +1608,8 @@ absl::Status GcsFileSystem::NewWritableFile(
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
       compose_append_, session_creator, object_uploader, status_poller,
-      generation_getter));
+      generation_getter, composite_upload_part_size_,
+      composite_upload_parallelism_));
   return absl::OkStatus();
 }
 
@@ -62,6 +62,10 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the number of blocks fetched concurrently
+// ahead of sequential reads through the block cache. Read ahead is disabled by
+// default.
+constexpr char kReadAheadBlocks[] = "GCS_READ_CACHE_READ_AHEAD_BLOCKS";
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -290,6 +294,14 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Configures parallel composite uploads of new writable files.
+  ///
+  /// If `part_size` is positive, the data appended to a new writable file is
+  /// uploaded in parts of at least `part_size` bytes, up to `parallelism` of
+  /// them concurrently, while the file is being written. The parts are composed
+  /// into the file on flush/close.
+  void SetCompositeUploadOptions(uint64 part_size, int parallelism);
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -423,6 +435,9 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The number of blocks the block cache fetches ahead of sequential reads.
+  size_t read_ahead_blocks_ = 0;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -443,6 +458,8 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<BucketLocationCache> bucket_location_cache_;
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
+  uint64 composite_upload_part_size_ = 0;
+  int composite_upload_parallelism_ = 1;
 
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
@@ -1331,6 +1331,86 @@ TEST(GcsFileSystemTest, NewWritableFile_NoObjectName) {
       fs.NewWritableFile("gs://bucket/", nullptr, &file)));
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_CompositeUpload) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpparts%2Fwriteable.txt.0\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 9\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location0"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location0\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-8/9\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: content1,\n",
+                           ""),
+       new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2F.tmpparts%2Fwriteable.txt.1\n"
+           "Auth Token: fake_token\n"
+           "Header X-Upload-Content-Length: 8\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location1"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location1\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-7/8\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: content2\n",
+                           ""),
+       // Compose the parts into the object.
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2Fwriteable.txt/compose\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Header content-type: application/json\n"
+                           "Post body: {'sourceObjects': [{'name': "
+                           "'path/.tmpparts/writeable.txt.0'},{'name': "
+                           "'path/.tmpparts/writeable.txt.1'}]}\n",
+                           ""),
+       // Delete the part objects.
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpparts%2Fwriteable.txt.0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: "
+                           "https://www.googleapis.com/storage/v1/b/bucket/o/"
+                           "path%2F.tmpparts%2Fwriteable.txt.1\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // Upload one part at a time, so that the requests are made in order.
+  fs.SetCompositeUploadOptions(8 /* part size */, 1 /* parallelism */);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/path/writeable.txt", nullptr, &file));
+  TF_EXPECT_OK(file->Append("content1,"));
+  TF_EXPECT_OK(file->Append("content2"));
+  int64_t pos;
+  TF_EXPECT_OK(file->Tell(&pos));
+  EXPECT_EQ(17, pos);
+  TF_EXPECT_OK(file->Close());
+}
+
 TEST(GcsFileSystemTest, NewAppendableFile) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
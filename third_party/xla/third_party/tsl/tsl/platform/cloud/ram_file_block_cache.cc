@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "tsl/platform/env.h"
@@ -41,13 +43,18 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
       if (cache_stats_ != nullptr) {
         cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
       }
+      entry->second->read_ahead = false;
       return entry->second;
     } else {
       // Remove the stale block and continue.
       RemoveFile_Locked(key.first);
     }
   }
+  return Insert(key);
+}
 
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -84,12 +91,19 @@ absl::Status RamFileBlockCache::UpdateLRU(const Key& key,
   // Check for inconsistent state. If there is a block later in the same file
   // in the cache, and our current block is not block size, this likely means
   // we have inconsistent state within the cache. Note: it's possible some
-  // incomplete reads may still go undetected.
+  // incomplete reads may still go undetected. Blocks read ahead past the end of
+  // the file are expected, and are removed instead.
   if (block->data.size() < block_size_) {
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
-    auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    auto begin = block_map_.upper_bound(key);
+    auto end = block_map_.upper_bound(fmax);
+    for (auto it = begin; it != end; ++it) {
+      if (!it->second->read_ahead) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
+    }
+    while (begin != end) {
+      RemoveBlock(begin++);
     }
   }
 
@@ -185,6 +199,7 @@ absl::Status RamFileBlockCache::Read(const string& filename, size_t offset,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  MaybeReadAhead(filename, offset, n, finish);
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
@@ -230,6 +245,43 @@ absl::Status RamFileBlockCache::Read(const string& filename, size_t offset,
   return absl::OkStatus();
 }
 
+void RamFileBlockCache::MaybeReadAhead(const string& filename, size_t offset,
+                                       size_t n, size_t read_end) {
+  if (read_ahead_pool_ == nullptr) {
+    return;
+  }
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> blocks;
+  {
+    mutex_lock lock(mu_);
+    auto [it, inserted] = read_end_map_.try_emplace(filename, offset + n);
+    const bool sequential = !inserted && it->second == offset;
+    it->second = offset + n;
+    if (!sequential) {
+      return;
+    }
+    for (size_t i = 0; i < read_ahead_blocks_; ++i) {
+      Key key = std::make_pair(filename, read_end + i * block_size_);
+      if (block_map_.find(key) != block_map_.end()) {
+        continue;
+      }
+      std::shared_ptr<Block> block = Insert(key);
+      block->read_ahead = true;
+      blocks.emplace_back(std::move(key), std::move(block));
+    }
+  }
+  // Fetch the blocks concurrently. A read of a block that is still being
+  // fetched waits for the fetch to finish, and a failed fetch is retried by the
+  // next read of the block.
+  for (auto& [key, block] : blocks) {
+    read_ahead_pool_->Schedule([this, key = std::move(key),
+                                block = std::move(block)] {
+      if (MaybeFetch(key, block).ok()) {
+        UpdateLRU(key, block).IgnoreError();
+      }
+    });
+  }
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64_t file_signature) {
   mutex_lock lock(mu_);
@@ -274,6 +326,7 @@ void RamFileBlockCache::Flush() {
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  read_end_map_.clear();
   cache_size_ = 0;
 }
 
@@ -283,6 +336,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  read_end_map_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
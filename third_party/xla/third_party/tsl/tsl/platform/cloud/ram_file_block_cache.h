@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -50,22 +52,38 @@ class RamFileBlockCache : public FileBlockCache {
                                      size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// If `read_ahead_blocks` is positive, a read that continues where the
+  /// previous read of the same file ended fetches up to that many of the
+  /// following blocks concurrently in the background. The read ahead is
+  /// limited to half of the cache so that it does not evict the blocks being
+  /// read.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t read_ahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
+        read_ahead_blocks_(block_size > 0 ? std::min(read_ahead_blocks,
+                                                     max_bytes / block_size / 2)
+                                          : 0),
         block_fetcher_(block_fetcher),
         env_(env) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (read_ahead_blocks_ > 0) {
+      read_ahead_pool_ = std::make_unique<thread::ThreadPool>(
+          env_, "TF_read_ahead_FBC", read_ahead_blocks_);
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Destroying read_ahead_pool_ will block until the pending read aheads
+    // finish.
+    read_ahead_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -109,6 +127,7 @@ class RamFileBlockCache : public FileBlockCache {
   size_t block_size() const override { return block_size_; }
   size_t max_bytes() const override { return max_bytes_; }
   uint64 max_staleness() const override { return max_staleness_; }
+  size_t read_ahead_blocks() const { return read_ahead_blocks_; }
 
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
@@ -127,6 +146,8 @@ class RamFileBlockCache : public FileBlockCache {
   const size_t max_bytes_;
   /// The maximum staleness of any block in the LRU cache, in seconds.
   const uint64 max_staleness_;
+  /// The maximum number of blocks fetched ahead of a sequential read.
+  const size_t read_ahead_blocks_;
   /// The callback to read a block from the underlying filesystem.
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
@@ -158,8 +179,8 @@ class RamFileBlockCache : public FileBlockCache {
   /// was cached, a coordination lock, and state & condition variables.
   ///
   /// Thread safety:
-  /// The iterator and timestamp fields should only be accessed while holding
-  /// the block-cache-wide mu_ instance variable. The state variable should only
+  /// The iterator, timestamp and read_ahead fields should only be accessed
+  /// while holding the block-cache-wide mu_ instance variable. The state variable should only
   /// be accessed while holding the Block's mu lock. The data vector should only
   /// be accessed after state == FINISHED, and it should never be modified.
   ///
@@ -175,6 +196,8 @@ class RamFileBlockCache : public FileBlockCache {
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// Whether the block was added by a read ahead and has not been read yet.
+    bool read_ahead = false;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -197,6 +220,16 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
 
+  /// Insert a new empty block for `key` in the block cache.
+  std::shared_ptr<Block> Insert(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// If the read of `n` bytes at `offset` continues the previous read of
+  /// `filename`, schedule fetching the blocks following `read_end`, the
+  /// block-aligned end of the read.
+  void MaybeReadAhead(const string& filename, size_t offset, size_t n,
+                      size_t read_end) TF_LOCKS_EXCLUDED(mu_);
+
   absl::Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
@@ -218,6 +251,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// The cache pruning thread that removes files with expired blocks.
   std::unique_ptr<Thread> pruning_thread_;
 
+  /// The threads fetching blocks ahead of sequential reads.
+  std::unique_ptr<thread::ThreadPool> read_ahead_pool_;
+
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
@@ -243,6 +279,10 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  // A filename->offset map of where the last read of each file ended, used to
+  // detect sequential reads when read ahead is enabled.
+  std::map<string, size_t> read_end_map_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tsl
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
+#include <set>
 
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/cloud/now_seconds_env.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/notification.h"
 #include "tsl/platform/test.h"
 
@@ -566,5 +569,54 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, ReadAhead) {
+  const size_t block_size = 16;
+  const size_t file_size = 3 * block_size + 8;
+  mutex mu;
+  std::set<size_t> fetched_offsets;
+  Notification fetched_last_block;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      if (fetched_offsets.insert(offset).second &&
+          offset == 3 * block_size) {
+        fetched_last_block.Notify();
+      }
+    }
+    const size_t bytes = offset < file_size ? std::min(n, file_size - offset)
+                                            : 0;
+    memset(buffer, 'x', bytes);
+    *bytes_transferred = bytes;
+    return absl::OkStatus();
+  };
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                          Env::Default(), /*read_ahead_blocks=*/2);
+  EXPECT_EQ(cache.read_ahead_blocks(), 2);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+  // The second read continues the first one, so the following two blocks are
+  // fetched in the background.
+  EXPECT_TRUE(WaitForNotificationWithTimeout(&fetched_last_block, 10000000));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 2 * block_size, block_size, &out));
+  EXPECT_EQ(out, std::vector<char>(block_size, 'x'));
+  // Blocks read ahead past the end of the file do not make the partial last
+  // block inconsistent.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 3 * block_size, block_size, &out));
+  EXPECT_EQ(out, std::vector<char>(file_size - 3 * block_size, 'x'));
+}
+
+TEST(RamFileBlockCacheTest, ReadAheadIsLimitedByCacheSize) {
+  auto fetcher = [](const string& filename, size_t offset, size_t n,
+                    char* buffer, size_t* bytes_transferred) {
+    return absl::OkStatus();
+  };
+  RamFileBlockCache cache1(16, 64, 0, fetcher, Env::Default(), 8);
+  EXPECT_EQ(cache1.read_ahead_blocks(), 2);
+  RamFileBlockCache cache2(16, 0, 0, fetcher, Env::Default(), 8);
+  EXPECT_EQ(cache2.read_ahead_blocks(), 0);
+}
+
 }  // namespace
 }  // namespace tsl
@@ -0,0 +1,166 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/mutex_contention.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tsl/platform/env_time.h"
+#include "tsl/platform/mutex.h"
+
+namespace tsl {
+namespace {
+
+int SamplePeriodFromEnv() {
+  const char* value = std::getenv("TF_MUTEX_CONTENTION_SAMPLE_PERIOD");
+  if (value == nullptr) return 0;
+  return std::max(0, static_cast<int>(std::strtol(value, nullptr, 10)));
+}
+
+struct SiteRegistry {
+  mutex mu;
+  std::vector<MutexContentionSite*> sites TF_GUARDED_BY(mu);
+};
+
+SiteRegistry& GetSiteRegistry() {
+  static SiteRegistry* registry = new SiteRegistry();
+  return *registry;
+}
+
+void UpdateMax(std::atomic<int64_t>& max, int64_t value) {
+  int64_t current = max.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value,
+                                    std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+namespace internal {
+
+std::atomic<int> mutex_contention_sample_period{SamplePeriodFromEnv()};
+
+void LockAndRecord(mutex& mu, MutexContentionSite& site, int64_t weight)
+    TF_NO_THREAD_SAFETY_ANALYSIS {
+  if (mu.try_lock()) {
+    site.RecordAcquisition(weight);
+    return;
+  }
+  const uint64_t start_ns = EnvTime::NowNanos();
+  mu.lock();
+  site.RecordContendedAcquisition(weight, EnvTime::NowNanos() - start_ns);
+}
+
+void LockSharedAndRecord(mutex& mu, MutexContentionSite& site, int64_t weight)
+    TF_NO_THREAD_SAFETY_ANALYSIS {
+  if (mu.try_lock_shared()) {
+    site.RecordAcquisition(weight);
+    return;
+  }
+  const uint64_t start_ns = EnvTime::NowNanos();
+  mu.lock_shared();
+  site.RecordContendedAcquisition(weight, EnvTime::NowNanos() - start_ns);
+}
+
+}  // namespace internal
+
+MutexContentionSite::MutexContentionSite(const char* name) : name_(name) {
+  SiteRegistry& registry = GetSiteRegistry();
+  mutex_lock l(registry.mu);
+  registry.sites.push_back(this);
+}
+
+void MutexContentionSite::RecordAcquisition(int64_t weight) {
+  acquisitions_.fetch_add(weight, std::memory_order_relaxed);
+}
+
+void MutexContentionSite::RecordContendedAcquisition(int64_t weight,
+                                                     int64_t wait_ns) {
+  acquisitions_.fetch_add(weight, std::memory_order_relaxed);
+  contended_acquisitions_.fetch_add(weight, std::memory_order_relaxed);
+  total_wait_ns_.fetch_add(weight * wait_ns, std::memory_order_relaxed);
+  UpdateMax(max_wait_ns_, wait_ns);
+}
+
+MutexContentionStats MutexContentionSite::stats() const {
+  MutexContentionStats stats;
+  stats.name = name_;
+  stats.acquisitions = acquisitions_.load(std::memory_order_relaxed);
+  stats.contended_acquisitions =
+      contended_acquisitions_.load(std::memory_order_relaxed);
+  stats.total_wait_ns = total_wait_ns_.load(std::memory_order_relaxed);
+  stats.max_wait_ns = max_wait_ns_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void MutexContentionSite::Reset() {
+  acquisitions_.store(0, std::memory_order_relaxed);
+  contended_acquisitions_.store(0, std::memory_order_relaxed);
+  total_wait_ns_.store(0, std::memory_order_relaxed);
+  max_wait_ns_.store(0, std::memory_order_relaxed);
+}
+
+void SetMutexContentionSamplePeriod(int period) {
+  internal::mutex_contention_sample_period.store(std::max(0, period),
+                                                 std::memory_order_relaxed);
+}
+
+int GetMutexContentionSamplePeriod() {
+  return internal::mutex_contention_sample_period.load(
+      std::memory_order_relaxed);
+}
+
+std::vector<MutexContentionStats> GetMutexContentionStats() {
+  std::map<std::string, MutexContentionStats> by_name;
+  {
+    SiteRegistry& registry = GetSiteRegistry();
+    mutex_lock l(registry.mu);
+    for (const MutexContentionSite* site : registry.sites) {
+      const MutexContentionStats site_stats = site->stats();
+      MutexContentionStats& merged = by_name[site_stats.name];
+      merged.name = site_stats.name;
+      merged.acquisitions += site_stats.acquisitions;
+      merged.contended_acquisitions += site_stats.contended_acquisitions;
+      merged.total_wait_ns += site_stats.total_wait_ns;
+      merged.max_wait_ns =
+          std::max(merged.max_wait_ns, site_stats.max_wait_ns);
+    }
+  }
+  std::vector<MutexContentionStats> result;
+  result.reserve(by_name.size());
+  for (auto& entry : by_name) result.push_back(std::move(entry.second));
+  std::stable_sort(result.begin(), result.end(),
+                   [](const MutexContentionStats& a,
+                      const MutexContentionStats& b) {
+                     return a.total_wait_ns > b.total_wait_ns;
+                   });
+  return result;
+}
+
+void ResetMutexContentionStats() {
+  SiteRegistry& registry = GetSiteRegistry();
+  mutex_lock l(registry.mu);
+  for (MutexContentionSite* site : registry.sites) site->Reset();
+}
+
+}  // namespace tsl
@@ -0,0 +1,182 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_MUTEX_CONTENTION_H_
+#define TENSORFLOW_TSL_PLATFORM_MUTEX_CONTENTION_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+
+// Optional contention profiling for tsl::mutex.
+//
+// Hot call sites are tagged with a named MutexContentionSite and acquire their
+// mutex through profiled_mutex_lock, profiled_shared_lock or LockProfiled().
+// While profiling is disabled (the default) these cost one relaxed atomic load
+// over a plain lock. When it is enabled, one in every `sample_period`
+// acquisitions per thread first tries the lock; if that fails, the blocking
+// wait is timed and attributed to the site. No stacks are captured.
+//
+// Profiling is enabled with SetMutexContentionSamplePeriod() or the
+// TF_MUTEX_CONTENTION_SAMPLE_PERIOD environment variable.
+//
+// Example:
+//   TSL_MUTEX_CONTENTION_SITE(cache_contention_site, "MyCache");
+//   ...
+//   tsl::profiled_mutex_lock l(mu_, cache_contention_site());
+
+namespace tsl {
+
+// Estimated contention of one site. Counts and wait times are sampled values
+// scaled by the sample period in effect when they were recorded.
+struct MutexContentionStats {
+  std::string name;
+  int64_t acquisitions = 0;
+  int64_t contended_acquisitions = 0;
+  int64_t total_wait_ns = 0;
+  int64_t max_wait_ns = 0;
+};
+
+// A named call site whose acquisitions are profiled. Sites are registered on
+// construction and must never be destroyed; declare them with
+// TSL_MUTEX_CONTENTION_SITE, and only sites that were used are reported.
+class MutexContentionSite {
+ public:
+  explicit MutexContentionSite(const char* name);
+
+  MutexContentionSite(const MutexContentionSite&) = delete;
+  MutexContentionSite& operator=(const MutexContentionSite&) = delete;
+
+  const char* name() const { return name_; }
+
+  void RecordAcquisition(int64_t weight);
+  void RecordContendedAcquisition(int64_t weight, int64_t wait_ns);
+
+  MutexContentionStats stats() const;
+  void Reset();
+
+ private:
+  const char* const name_;
+  std::atomic<int64_t> acquisitions_{0};
+  std::atomic<int64_t> contended_acquisitions_{0};
+  std::atomic<int64_t> total_wait_ns_{0};
+  std::atomic<int64_t> max_wait_ns_{0};
+};
+
+// Profiles one in every `period` acquisitions on each thread; 0 disables
+// profiling.
+void SetMutexContentionSamplePeriod(int period);
+int GetMutexContentionSamplePeriod();
+
+// Returns the stats of all sites, merged by name and sorted by decreasing
+// total wait time.
+std::vector<MutexContentionStats> GetMutexContentionStats();
+
+// Clears the stats of all sites.
+void ResetMutexContentionStats();
+
+namespace internal {
+
+extern std::atomic<int> mutex_contention_sample_period;
+
+// Returns the weight of the current acquisition if it should be profiled, or 0.
+inline int64_t SampleMutexAcquisition() {
+  const int period =
+      mutex_contention_sample_period.load(std::memory_order_relaxed);
+  if (period <= 0) return 0;
+  if (period == 1) return 1;
+  thread_local uint32_t counter = 0;
+  return ++counter % period == 0 ? period : 0;
+}
+
+void LockAndRecord(mutex& mu, MutexContentionSite& site, int64_t weight);
+void LockSharedAndRecord(mutex& mu, MutexContentionSite& site, int64_t weight);
+
+}  // namespace internal
+
+// Acquires `mu` exclusively, attributing any sampled wait to `site`.
+inline void LockProfiled(mutex& mu, MutexContentionSite& site)
+    TF_EXCLUSIVE_LOCK_FUNCTION(mu) TF_NO_THREAD_SAFETY_ANALYSIS {
+  const int64_t weight = internal::SampleMutexAcquisition();
+  if (weight == 0) {
+    mu.lock();
+  } else {
+    internal::LockAndRecord(mu, site, weight);
+  }
+}
+
+// Acquires `mu` in shared mode, attributing any sampled wait to `site`.
+inline void LockSharedProfiled(mutex& mu, MutexContentionSite& site)
+    TF_SHARED_LOCK_FUNCTION(mu) TF_NO_THREAD_SAFETY_ANALYSIS {
+  const int64_t weight = internal::SampleMutexAcquisition();
+  if (weight == 0) {
+    mu.lock_shared();
+  } else {
+    internal::LockSharedAndRecord(mu, site, weight);
+  }
+}
+
+// Like mutex_lock, but profiles the acquisition against `site`.
+class TF_SCOPED_LOCKABLE profiled_mutex_lock {
+ public:
+  profiled_mutex_lock(mutex& mu, MutexContentionSite& site)
+      TF_EXCLUSIVE_LOCK_FUNCTION(mu)
+      : mu_(&mu) {
+    LockProfiled(mu, site);
+  }
+  ~profiled_mutex_lock() TF_UNLOCK_FUNCTION() { mu_->unlock(); }
+
+  profiled_mutex_lock(const profiled_mutex_lock&) = delete;
+  profiled_mutex_lock& operator=(const profiled_mutex_lock&) = delete;
+
+ private:
+  mutex* const mu_;
+};
+
+// Like tf_shared_lock, but profiles the acquisition against `site`.
+class TF_SCOPED_LOCKABLE profiled_shared_lock {
+ public:
+  profiled_shared_lock(mutex& mu, MutexContentionSite& site)
+      TF_SHARED_LOCK_FUNCTION(mu)
+      : mu_(&mu) {
+    LockSharedProfiled(mu, site);
+  }
+  ~profiled_shared_lock() TF_UNLOCK_FUNCTION() { mu_->unlock_shared(); }
+
+  profiled_shared_lock(const profiled_shared_lock&) = delete;
+  profiled_shared_lock& operator=(const profiled_shared_lock&) = delete;
+
+ private:
+  mutex* const mu_;
+};
+
+}  // namespace tsl
+
+// Defines a function `var()` returning a never-destroyed MutexContentionSite
+// named `name`. The site is a function-local static created on first use, so
+// that it can be used by allocators and rendezvous during static
+// initialization.
+#define TSL_MUTEX_CONTENTION_SITE(var, name)              \
+  static ::tsl::MutexContentionSite& var() {              \
+    static ::tsl::MutexContentionSite* const site =       \
+        new ::tsl::MutexContentionSite(name);             \
+    return *site;                                         \
+  }
+
+#endif  // TENSORFLOW_TSL_PLATFORM_MUTEX_CONTENTION_H_
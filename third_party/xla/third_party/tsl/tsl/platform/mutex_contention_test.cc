@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/mutex_contention.h"
+
+#include <atomic>
+#include <memory>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+TSL_MUTEX_CONTENTION_SITE(test_site, "MutexContentionTest");
+TSL_MUTEX_CONTENTION_SITE(other_test_site, "MutexContentionTest");
+
+// Acquires a profiled lock during static initialization, before the site,
+// defined below, would be constructed if it were a namespace-scope object.
+static MutexContentionSite& static_init_site();
+bool LockDuringStaticInit() {
+  static mutex* mu = new mutex;
+  profiled_mutex_lock l(*mu, static_init_site());
+  return true;
+}
+const bool locked_during_static_init = LockDuringStaticInit();
+TSL_MUTEX_CONTENTION_SITE(static_init_site, "MutexContentionTest.StaticInit");
+
+MutexContentionStats FindStats(const char* name) {
+  for (const MutexContentionStats& stats : GetMutexContentionStats()) {
+    if (stats.name == name) return stats;
+  }
+  return MutexContentionStats();
+}
+
+class MutexContentionTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ResetMutexContentionStats(); }
+  void TearDown() override { SetMutexContentionSamplePeriod(0); }
+};
+
+TEST_F(MutexContentionTest, DisabledByDefault) {
+  mutex mu;
+  { profiled_mutex_lock l(mu, test_site()); }
+  { profiled_shared_lock l(mu, test_site()); }
+  EXPECT_EQ(FindStats("MutexContentionTest").acquisitions, 0);
+}
+
+TEST_F(MutexContentionTest, UsableDuringStaticInitialization) {
+  EXPECT_TRUE(locked_during_static_init);
+  EXPECT_STREQ(static_init_site().name(), "MutexContentionTest.StaticInit");
+}
+
+TEST_F(MutexContentionTest, CountsUncontendedAcquisitions) {
+  SetMutexContentionSamplePeriod(1);
+  mutex mu;
+  { profiled_mutex_lock l(mu, test_site()); }
+  { profiled_shared_lock l(mu, other_test_site()); }
+  LockProfiled(mu, test_site());
+  mu.unlock();
+
+  const MutexContentionStats stats = FindStats("MutexContentionTest");
+  EXPECT_EQ(stats.acquisitions, 3);
+  EXPECT_EQ(stats.contended_acquisitions, 0);
+  EXPECT_EQ(stats.total_wait_ns, 0);
+}
+
+TEST_F(MutexContentionTest, RecordsContendedWait) {
+  SetMutexContentionSamplePeriod(1);
+  mutex mu;
+  std::atomic<bool> waiting(false);
+  mu.lock();
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "waiter", [&]() {
+        waiting = true;
+        profiled_mutex_lock l(mu, test_site());
+      }));
+  while (!waiting) {
+    Env::Default()->SleepForMicroseconds(100);
+  }
+  Env::Default()->SleepForMicroseconds(20000);
+  mu.unlock();
+  thread.reset();
+
+  const MutexContentionStats stats = FindStats("MutexContentionTest");
+  EXPECT_EQ(stats.acquisitions, 1);
+  EXPECT_EQ(stats.contended_acquisitions, 1);
+  EXPECT_GT(stats.total_wait_ns, 0);
+  EXPECT_EQ(stats.max_wait_ns, stats.total_wait_ns);
+}
+
+TEST_F(MutexContentionTest, SampledAcquisitionsAreScaled) {
+  SetMutexContentionSamplePeriod(4);
+  mutex mu;
+  for (int i = 0; i < 100; ++i) {
+    profiled_mutex_lock l(mu, test_site());
+  }
+  EXPECT_EQ(FindStats("MutexContentionTest").acquisitions, 100);
+}
+
+}  // namespace
+}  // namespace tsl
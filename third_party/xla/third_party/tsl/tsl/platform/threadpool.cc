@@ -22,10 +22,12 @@ limitations under the License.
 #include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/context.h"
 #include "tsl/platform/denormal.h"
+#include "tsl/platform/env_time.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/numa.h"
 #include "tsl/platform/setround.h"
+#include "tsl/platform/threadpool_metrics.h"
 #include "tsl/platform/tracing.h"
 
 #ifdef DNNL_AARCH64_USE_ACL
@@ -44,12 +46,23 @@ namespace tsl {
 
 namespace thread {
 
+namespace {
+// The environment of the pool the current thread is a worker of, if any. Its
+// address identifies the worker when detecting stolen tasks.
+thread_local const EigenEnvironment* current_worker_env = nullptr;
+}  // namespace
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // Weight of the task in the pool metrics, or 0 if it is not sampled.
+    int64_t sample_weight;
+    uint64 schedule_ns;
+    // The worker that scheduled the task, or nullptr for external threads.
+    const void* scheduling_worker;
   };
   struct Task {
     std::unique_ptr<TaskImpl> f;
@@ -58,13 +71,18 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  ThreadPoolMetrics* const metrics_;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name, ThreadPoolMetrics* metrics)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        metrics_(metrics) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
     return env_->StartThread(thread_options_, name_, [=]() {
+      current_worker_env = this;
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
       // Set the processor rounding mode to ROUND TO NEAREST.
@@ -82,11 +100,22 @@ struct EigenEnvironment {
       id = tracing::GetUniqueArg();
       tracing::RecordEvent(tracing::EventCategory::kScheduleClosure, id);
     }
+    const int64_t sample_weight = internal::SampleScheduledTask();
+    uint64 schedule_ns = 0;
+    const void* scheduling_worker = nullptr;
+    if (sample_weight > 0) {
+      metrics_->RecordScheduled(sample_weight);
+      schedule_ns = EnvTime::NowNanos();
+      if (current_worker_env == this) scheduling_worker = &current_worker_env;
+    }
     return Task{
         std::unique_ptr<TaskImpl>(new TaskImpl{
             std::move(f),
             Context(ContextKind::kThread),
             id,
+            sample_weight,
+            schedule_ns,
+            scheduling_worker,
         }),
     };
   }
@@ -95,7 +124,17 @@ struct EigenEnvironment {
     WithContext wc(t.f->context);
     tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                  t.f->trace_id);
+    if (t.f->sample_weight == 0) {
+      t.f->f();
+      return;
+    }
+    const uint64 start_ns = EnvTime::NowNanos();
+    metrics_->RecordStarted(t.f->sample_weight, start_ns - t.f->schedule_ns,
+                            t.f->scheduling_worker != nullptr &&
+                                t.f->scheduling_worker != &current_worker_env);
     t.f->f();
+    metrics_->RecordFinished(t.f->sample_weight,
+                             EnvTime::NowNanos() - start_ns);
   }
 };
 
@@ -125,9 +164,11 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
   if (num_threads < 1) num_threads = 1;
 #endif  // TENSORFLOW_THREADSCALING_EXPERIMENTAL
 
+  metrics_ = ThreadPoolMetrics::Get(name);
+  metrics_->AddThreads(num_threads);
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      EigenEnvironment(env, thread_options, "tf_" + name, metrics_)));
   underlying_threadpool_ = eigen_threadpool_.get();
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
                                                        num_threads, allocator));
@@ -139,7 +180,9 @@ ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
       underlying_threadpool_, underlying_threadpool_->NumThreads(), nullptr));
 }
 
-ThreadPool::~ThreadPool() {}
+ThreadPool::~ThreadPool() {
+  if (metrics_ != nullptr) metrics_->AddThreads(-NumThreads());
+}
 
 void ThreadPool::Schedule(std::function<void()> fn) {
   CHECK(fn != nullptr);
@@ -38,6 +38,7 @@ namespace tsl {
 namespace thread {
 
 struct EigenEnvironment;
+class ThreadPoolMetrics;
 
 class ThreadPool {
  public:
@@ -235,6 +236,9 @@ class ThreadPool {
   // user_threadpool is not in the constructor.
   std::unique_ptr<Eigen::ThreadPoolTempl<EigenEnvironment>> eigen_threadpool_;
   std::unique_ptr<Eigen::ThreadPoolDevice> threadpool_device_;
+  // Metrics of the pools with this pool's name, or nullptr if the pool wraps a
+  // user_threadpool.
+  ThreadPoolMetrics* metrics_ = nullptr;
   ThreadPool(const ThreadPool&) = delete;
   void operator=(const ThreadPool&) = delete;
 };
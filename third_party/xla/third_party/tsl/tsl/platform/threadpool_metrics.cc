@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/threadpool_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tsl/platform/mutex.h"
+
+namespace tsl {
+namespace thread {
+namespace {
+
+int SamplePeriodFromEnv() {
+  const char* value = std::getenv("TF_THREADPOOL_METRICS_SAMPLE_PERIOD");
+  if (value == nullptr) return 0;
+  return std::max(0, static_cast<int>(std::strtol(value, nullptr, 10)));
+}
+
+struct MetricsRegistry {
+  mutex mu;
+  std::map<std::string, ThreadPoolMetrics*> metrics TF_GUARDED_BY(mu);
+};
+
+MetricsRegistry& GetMetricsRegistry() {
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+void UpdateMax(std::atomic<int64_t>& max, int64_t value) {
+  int64_t current = max.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(current, value,
+                                    std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+namespace internal {
+
+std::atomic<int> threadpool_metrics_sample_period{SamplePeriodFromEnv()};
+
+}  // namespace internal
+
+ThreadPoolMetrics* ThreadPoolMetrics::Get(const std::string& name) {
+  MetricsRegistry& registry = GetMetricsRegistry();
+  mutex_lock l(registry.mu);
+  ThreadPoolMetrics*& metrics = registry.metrics[name];
+  if (metrics == nullptr) metrics = new ThreadPoolMetrics(name);
+  return metrics;
+}
+
+void ThreadPoolMetrics::AddThreads(int num_threads) {
+  num_threads_.fetch_add(num_threads, std::memory_order_relaxed);
+}
+
+void ThreadPoolMetrics::RecordScheduled(int64_t weight) {
+  scheduled_tasks_.fetch_add(weight, std::memory_order_relaxed);
+}
+
+void ThreadPoolMetrics::RecordStarted(int64_t weight, int64_t queue_wait_ns,
+                                      bool stolen) {
+  started_tasks_.fetch_add(weight, std::memory_order_relaxed);
+  total_queue_wait_ns_.fetch_add(weight * queue_wait_ns,
+                                 std::memory_order_relaxed);
+  UpdateMax(max_queue_wait_ns_, queue_wait_ns);
+  if (stolen) stolen_tasks_.fetch_add(weight, std::memory_order_relaxed);
+}
+
+void ThreadPoolMetrics::RecordFinished(int64_t weight, int64_t busy_ns) {
+  busy_ns_.fetch_add(weight * busy_ns, std::memory_order_relaxed);
+}
+
+ThreadPoolStats ThreadPoolMetrics::stats() const {
+  ThreadPoolStats stats;
+  stats.name = name_;
+  stats.num_threads = num_threads_.load(std::memory_order_relaxed);
+  stats.scheduled_tasks = scheduled_tasks_.load(std::memory_order_relaxed);
+  const int64_t started_tasks = started_tasks_.load(std::memory_order_relaxed);
+  stats.queued_tasks =
+      std::max<int64_t>(0, stats.scheduled_tasks - started_tasks);
+  stats.total_queue_wait_ns =
+      total_queue_wait_ns_.load(std::memory_order_relaxed);
+  stats.max_queue_wait_ns = max_queue_wait_ns_.load(std::memory_order_relaxed);
+  stats.busy_ns = busy_ns_.load(std::memory_order_relaxed);
+  stats.stolen_tasks = stolen_tasks_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void ThreadPoolMetrics::Reset() {
+  scheduled_tasks_.store(0, std::memory_order_relaxed);
+  started_tasks_.store(0, std::memory_order_relaxed);
+  total_queue_wait_ns_.store(0, std::memory_order_relaxed);
+  max_queue_wait_ns_.store(0, std::memory_order_relaxed);
+  busy_ns_.store(0, std::memory_order_relaxed);
+  stolen_tasks_.store(0, std::memory_order_relaxed);
+}
+
+void SetThreadPoolMetricsSamplePeriod(int period) {
+  internal::threadpool_metrics_sample_period.store(std::max(0, period),
+                                                   std::memory_order_relaxed);
+}
+
+int GetThreadPoolMetricsSamplePeriod() {
+  return internal::threadpool_metrics_sample_period.load(
+      std::memory_order_relaxed);
+}
+
+std::vector<ThreadPoolStats> GetThreadPoolStats() {
+  MetricsRegistry& registry = GetMetricsRegistry();
+  mutex_lock l(registry.mu);
+  std::vector<ThreadPoolStats> result;
+  result.reserve(registry.metrics.size());
+  for (const auto& entry : registry.metrics) {
+    result.push_back(entry.second->stats());
+  }
+  return result;
+}
+
+void ResetThreadPoolStats() {
+  MetricsRegistry& registry = GetMetricsRegistry();
+  mutex_lock l(registry.mu);
+  for (const auto& entry : registry.metrics) entry.second->Reset();
+}
+
+}  // namespace thread
+}  // namespace tsl
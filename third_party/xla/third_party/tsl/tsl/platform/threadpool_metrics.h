@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_THREADPOOL_METRICS_H_
+#define TENSORFLOW_TSL_PLATFORM_THREADPOOL_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Optional sampled instrumentation of tsl::thread::ThreadPool.
+//
+// Every ThreadPool reports to the ThreadPoolMetrics of its name, so pools that
+// share a name (e.g. the inter-op pools of several sessions) are aggregated.
+// While sampling is disabled (the default) scheduling a task costs one relaxed
+// atomic load. When it is enabled, one in every `sample_period` tasks
+// scheduled by each thread records its queueing delay, its run time and
+// whether it was stolen by a worker other than the one that scheduled it.
+//
+// Sampling is enabled with SetThreadPoolMetricsSamplePeriod() or the
+// TF_THREADPOOL_METRICS_SAMPLE_PERIOD environment variable.
+
+namespace tsl {
+namespace thread {
+
+// Estimated activity of the pools with one name. Counts and times are sampled
+// values scaled by the sample period in effect when they were recorded.
+struct ThreadPoolStats {
+  std::string name;
+  // Threads of the live pools with this name.
+  int64_t num_threads = 0;
+  int64_t scheduled_tasks = 0;
+  // Tasks that are scheduled but have not started running yet.
+  int64_t queued_tasks = 0;
+  int64_t total_queue_wait_ns = 0;
+  int64_t max_queue_wait_ns = 0;
+  // Sum over all threads of the time spent running tasks.
+  int64_t busy_ns = 0;
+  // Tasks scheduled from a worker and run by a different worker of the pool.
+  int64_t stolen_tasks = 0;
+};
+
+class ThreadPoolMetrics {
+ public:
+  // Returns the never-destroyed metrics of the pools named `name`.
+  static ThreadPoolMetrics* Get(const std::string& name);
+
+  ThreadPoolMetrics(const ThreadPoolMetrics&) = delete;
+  ThreadPoolMetrics& operator=(const ThreadPoolMetrics&) = delete;
+
+  void AddThreads(int num_threads);
+  void RecordScheduled(int64_t weight);
+  void RecordStarted(int64_t weight, int64_t queue_wait_ns, bool stolen);
+  void RecordFinished(int64_t weight, int64_t busy_ns);
+
+  ThreadPoolStats stats() const;
+  void Reset();
+
+ private:
+  explicit ThreadPoolMetrics(std::string name) : name_(std::move(name)) {}
+
+  const std::string name_;
+  std::atomic<int64_t> num_threads_{0};
+  std::atomic<int64_t> scheduled_tasks_{0};
+  std::atomic<int64_t> started_tasks_{0};
+  std::atomic<int64_t> total_queue_wait_ns_{0};
+  std::atomic<int64_t> max_queue_wait_ns_{0};
+  std::atomic<int64_t> busy_ns_{0};
+  std::atomic<int64_t> stolen_tasks_{0};
+};
+
+// Samples one in every `period` scheduled tasks on each thread; 0 disables
+// sampling.
+void SetThreadPoolMetricsSamplePeriod(int period);
+int GetThreadPoolMetricsSamplePeriod();
+
+// Returns the stats of all pool names, sorted by name.
+std::vector<ThreadPoolStats> GetThreadPoolStats();
+
+// Clears the sampled stats of all pools. Thread counts are kept.
+void ResetThreadPoolStats();
+
+namespace internal {
+
+extern std::atomic<int> threadpool_metrics_sample_period;
+
+// Returns the weight of the task being scheduled if it should be sampled, or
+// 0.
+inline int64_t SampleScheduledTask() {
+  const int period =
+      threadpool_metrics_sample_period.load(std::memory_order_relaxed);
+  if (period <= 0) return 0;
+  if (period == 1) return 1;
+  thread_local uint32_t counter = 0;
+  return ++counter % period == 0 ? period : 0;
+}
+
+}  // namespace internal
+
+}  // namespace thread
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_THREADPOOL_METRICS_H_
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/threadpool_metrics.h"
+
+#include <atomic>
+#include <string>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace thread {
+namespace {
+
+ThreadPoolStats FindStats(const std::string& name) {
+  for (const ThreadPoolStats& stats : GetThreadPoolStats()) {
+    if (stats.name == name) return stats;
+  }
+  return ThreadPoolStats();
+}
+
+class ThreadPoolMetricsTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ResetThreadPoolStats(); }
+  void TearDown() override { SetThreadPoolMetricsSamplePeriod(0); }
+};
+
+TEST_F(ThreadPoolMetricsTest, DisabledByDefault) {
+  {
+    ThreadPool pool(Env::Default(), "metrics_disabled", 2);
+    EXPECT_EQ(FindStats("metrics_disabled").num_threads, 2);
+    for (int i = 0; i < 10; ++i) pool.Schedule([]() {});
+  }
+  const ThreadPoolStats stats = FindStats("metrics_disabled");
+  EXPECT_EQ(stats.num_threads, 0);
+  EXPECT_EQ(stats.scheduled_tasks, 0);
+  EXPECT_EQ(stats.busy_ns, 0);
+}
+
+TEST_F(ThreadPoolMetricsTest, RecordsScheduledTasks) {
+  SetThreadPoolMetricsSamplePeriod(1);
+  std::atomic<int> done(0);
+  {
+    ThreadPool pool(Env::Default(), "metrics_sampled", 4);
+    for (int i = 0; i < 20; ++i) {
+      pool.Schedule([&done]() {
+        Env::Default()->SleepForMicroseconds(1000);
+        ++done;
+      });
+    }
+  }
+  EXPECT_EQ(done, 20);
+
+  const ThreadPoolStats stats = FindStats("metrics_sampled");
+  EXPECT_EQ(stats.num_threads, 0);
+  EXPECT_EQ(stats.scheduled_tasks, 20);
+  EXPECT_EQ(stats.queued_tasks, 0);
+  EXPECT_GE(stats.busy_ns, 20 * 1000 * 1000);
+  EXPECT_GE(stats.total_queue_wait_ns, stats.max_queue_wait_ns);
+  EXPECT_EQ(stats.stolen_tasks, 0);
+}
+
+TEST_F(ThreadPoolMetricsTest, ScalesSampledTasks) {
+  SetThreadPoolMetricsSamplePeriod(4);
+  {
+    ThreadPool pool(Env::Default(), "metrics_scaled", 1);
+    for (int i = 0; i < 40; ++i) pool.Schedule([]() {});
+  }
+  EXPECT_EQ(FindStats("metrics_scaled").scheduled_tasks, 40);
+}
+
+}  // namespace
+}  // namespace thread
+}  // namespace tsl
@@ -86,6 +86,9 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_cpu_use_thunk_runtime(true);
   opts.set_xla_cpu_enable_concurrency_optimized_scheduler(false);
   opts.set_xla_cpu_prefer_vector_width(256);
+  opts.set_xla_cpu_parallel_codegen_split_count(2);
+  opts.set_xla_cpu_thunk_executor_sequential_threshold_bytes(512);
+  opts.set_xla_cpu_thunk_executor_use_priority_ready_queue(false);
 
   opts.set_xla_cpu_enable_fast_math(false);
   // Disable forms of fast math that have caused users problems in the past.
@@ -276,6 +279,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_syntax_sugar_async_ops(false);
 
   opts.set_xla_gpu_per_fusion_autotune_cache_dir("");
+  opts.set_xla_gpu_per_fusion_autotune_cache_jitter_ms(0);
 
   opts.set_xla_gpu_autotune_gemm_rtol(0.1f);
 
@@ -829,6 +833,25 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       int32_setter_for(&DebugOptions::set_xla_cpu_prefer_vector_width),
       debug_options->xla_cpu_prefer_vector_width(),
       "Preferred vector with for the XLA:CPU LLVM backend."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(&DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      debug_options->xla_cpu_parallel_codegen_split_count(),
+      "Number of parts the XLA:CPU LLVM module is split into for parallel "
+      "compilation."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_thunk_executor_sequential_threshold_bytes",
+      int64_setter_for(
+          &DebugOptions::set_xla_cpu_thunk_executor_sequential_threshold_bytes),
+      debug_options->xla_cpu_thunk_executor_sequential_threshold_bytes(),
+      "Run XLA:CPU thunks sequentially if all of them use buffers of at most "
+      "this size in bytes."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_thunk_executor_use_priority_ready_queue",
+      bool_setter_for(
+          &DebugOptions::set_xla_cpu_thunk_executor_use_priority_ready_queue),
+      debug_options->xla_cpu_thunk_executor_use_priority_ready_queue(),
+      "Run ready XLA:CPU thunks in the order of their critical path length."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_crash_on_verification_failures",
       bool_setter_for(
@@ -1837,6 +1860,16 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "version checks must be done by the user (e.g. if you want to use "
       "separate caches for different versions of XLA, please use different "
       "directories). Default: no cache."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_per_fusion_autotune_cache_jitter_ms",
+      int32_setter_for(
+          &DebugOptions::set_xla_gpu_per_fusion_autotune_cache_jitter_ms),
+      debug_options->xla_gpu_per_fusion_autotune_cache_jitter_ms(),
+      "Experimental: On a per-fusion autotune cache miss, wait for a random "
+      "delay of up to this many milliseconds and check the cache directory "
+      "again before autotuning. Useful when many processes share the cache "
+      "directory, so that they reuse each other's results. Default: 0 (no "
+      "delay)."));
   flag_list->push_back(tsl::Flag(
       "xla_enable_command_buffers_during_profiling",
       bool_setter_for(
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <cstdint>
 #include <random>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -99,4 +100,61 @@ BENCHMARK(BM_DagExecution)
     ->Arg(8192)
     ->Arg(16384);
 
+static void BM_WideDagExecution(benchmark::State& state) {
+  int64_t width = state.range(0);
+  int64_t d0 = state.range(1);
+
+  // A graph of `width` independent reductions that ThunkExecutor can run
+  // concurrently on the intra-op thread pool.
+  std::string hlo = R"(
+    HloModule wide_dag_f32_$width_$d0
+
+    add {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      ROOT add = f32[] add(p0, p1)
+    }
+
+    ENTRY e {
+      p0 = f32[$d0,256] parameter(0)
+      c0 = f32[] constant(0)
+  )";
+  for (int64_t i = 0; i < width; ++i) {
+    absl::StrAppend(&hlo, "c", i + 1, " = f32[] constant(", i + 1, ")\n");
+    absl::StrAppend(&hlo, "bcast", i, " = f32[$d0,256] broadcast(c", i + 1,
+                    "), dimensions={}\n");
+    absl::StrAppend(&hlo, "add", i, " = f32[$d0,256] add(p0, bcast", i,
+                    ")\n");
+    absl::StrAppend(&hlo, "exp", i, " = f32[$d0,256] exponential(add", i,
+                    ")\n");
+    absl::StrAppend(&hlo, "r", i, " = f32[] reduce(exp", i,
+                    ", c0), dimensions={0,1}, to_apply=add\n");
+  }
+  absl::StrAppend(&hlo, "out0 = f32[] add(c0, r0)\n");
+  for (int64_t i = 1; i < width; ++i) {
+    absl::StrAppend(&hlo, "out", i, " = f32[] add(out", i - 1, ", r", i,
+                    ")\n");
+  }
+  absl::StrAppend(&hlo, "ROOT out = f32[] copy(out", width - 1, ")\n}\n");
+
+  std::minstd_rand0 engine;
+
+  auto shape = ShapeUtil::MakeShape(F32, {d0, 256});
+  auto p0 = *LiteralUtil::CreateRandomLiteral<F32>(shape, &engine, 1.0f, 0.1f);
+
+  std::vector<const Literal*> args = {&p0};
+  CHECK_OK(RunHloBenchmark(
+      state, hlo, args,
+      {{"$width", absl::StrCat(width)}, {"$d0", absl::StrCat(d0)}}));
+}
+
+BENCHMARK(BM_WideDagExecution)
+    ->MeasureProcessCPUTime()
+    ->ArgPair(4, 1024)
+    ->ArgPair(8, 1024)
+    ->ArgPair(16, 1024)
+    ->ArgPair(4, 8192)
+    ->ArgPair(8, 8192)
+    ->ArgPair(16, 8192);
+
 }  // namespace xla::cpu
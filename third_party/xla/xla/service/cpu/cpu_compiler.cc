@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/service/cpu/cpu_compiler.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -42,9 +43,13 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
@@ -55,6 +60,7 @@ limitations under the License.
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -115,6 +121,7 @@ limitations under the License.
 #include "xla/service/cpu/executable.pb.h"
 #include "xla/service/cpu/ir_emitter.h"
 #include "xla/service/cpu/ir_emitter2.h"
+#include "xla/service/cpu/metrics.h"
 #include "xla/service/cpu/parallel_task_assignment.h"
 #include "xla/service/cpu/simple_orc_jit.h"
 #include "xla/service/cpu/target_machine_features.h"
@@ -196,10 +203,12 @@ limitations under the License.
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/casts.h"
 #include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"  // IWYU pragma: keep
 #include "tsl/platform/status.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 
 #ifdef TF_LLVM_X86_AVAILABLE
 #include "llvm/TargetParser/X86TargetParser.h"
@@ -977,6 +986,107 @@ CreateOrcJITPostCompilationHook(const HloModule* module,
   };
 }
 
+// Returns the thread pool that compiles module parts when the caller does not
+// provide one in the compile options.
+tsl::thread::ThreadPool* GetCodegenThreadPool() {
+  static tsl::thread::ThreadPool* thread_pool = new tsl::thread::ThreadPool(
+      tsl::Env::Default(), "xla_cpu_codegen", tsl::port::MaxParallelism());
+  return thread_pool;
+}
+
+// Compiles LLVM module parts serialized as bitcode to object files in
+// parallel. LLVM contexts and target machines are not thread safe, so each part
+// is parsed into its own context and compiled with its own target machine.
+absl::StatusOr<std::vector<std::unique_ptr<llvm::MemoryBuffer>>>
+CompileModuleParts(const HloModuleConfig& config,
+                   absl::Span<const llvm::SmallVector<char, 0>> parts,
+                   const LLVMCompiler::ModuleHook& pre_optimization_hook,
+                   const LLVMCompiler::ModuleHook& post_optimization_hook,
+                   tsl::thread::ThreadPool* thread_pool) {
+  // IR hooks dump modules and are not expected to be called concurrently.
+  absl::Mutex hooks_mu;
+  auto serialize = [&](const LLVMCompiler::ModuleHook& hook)
+      -> LLVMCompiler::ModuleHook {
+    if (!hook) return nullptr;
+    return [&](const llvm::Module& module) {
+      absl::MutexLock lock(&hooks_mu);
+      hook(module);
+    };
+  };
+  LLVMCompiler::ModuleHook pre_hook = serialize(pre_optimization_hook);
+  LLVMCompiler::ModuleHook post_hook = serialize(post_optimization_hook);
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> obj_files(parts.size());
+  std::vector<absl::Status> statuses(parts.size());
+  auto compile_part = [&](size_t i) {
+    llvm::LLVMContext context;
+    std::string name = absl::StrCat("__compute_module_part_", i);
+    llvm::Expected<std::unique_ptr<llvm::Module>> module =
+        llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(
+                llvm::StringRef(parts[i].data(), parts[i].size()), name),
+            context);
+    if (!module) {
+      statuses[i] = Internal("Failed to parse module part %d: %s", i,
+                             llvm::toString(module.takeError()));
+      return;
+    }
+    std::unique_ptr<llvm::TargetMachine> target_machine =
+        SimpleOrcJIT::InferTargetMachineForJIT(CompilerTargetOptions(config),
+                                               CodeGenOptLevel(config));
+    CompilerFunctor compiler(
+        target_machine.get(), static_cast<int>(CodeGenOptLevel(config)),
+        options::OptimizeForSizeRequested(config),
+        config.debug_options().xla_llvm_disable_expensive_passes(),
+        options::SlpVectorizerDisabled(config),
+        llvm_ir::GetCpuFastMathFlags(config), pre_hook, post_hook);
+    llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> obj_file =
+        compiler(**module);
+    if (!obj_file) {
+      statuses[i] = Internal("Failed to compile module part %d: %s", i,
+                             llvm::toString(obj_file.takeError()));
+      return;
+    }
+    obj_files[i] = std::move(*obj_file);
+  };
+
+  // Parts are claimed one at a time by the calling thread and by tasks in the
+  // thread pool. The calling thread compiles parts until all of them are
+  // claimed, so compilation can't deadlock if it runs on a thread of the pool,
+  // and tasks that start after that only touch the shared state.
+  struct State {
+    explicit State(size_t num_parts)
+        : num_parts(num_parts), pending(num_parts) {}
+
+    void Run() {
+      for (size_t i = next_part++; i < num_parts; i = next_part++) {
+        compile_part(i);
+        pending.DecrementCount();
+      }
+    }
+
+    const size_t num_parts;
+    std::atomic<size_t> next_part = 0;
+    absl::BlockingCounter pending;
+    std::function<void(size_t)> compile_part;
+  };
+  if (parts.empty()) return obj_files;
+  auto state = std::make_shared<State>(parts.size());
+  state->compile_part = compile_part;
+  size_t num_tasks =
+      std::min<size_t>(parts.size(), thread_pool->NumThreads() + 1) - 1;
+  for (size_t i = 0; i < num_tasks; ++i) {
+    thread_pool->Schedule([state] { state->Run(); });
+  }
+  state->Run();
+  state->pending.Wait();
+
+  for (const absl::Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return obj_files;
+}
+
 void InitializeLLVMCommandLineOptions(const HloModuleConfig& config) {
   llvm_ir::InitializeLLVMCommandLineOptions(
       config.debug_options().xla_backend_extra_options());
@@ -1128,7 +1238,8 @@ CreateConstantAllocations(const BufferAssignment& assignment) {
 }
 
 absl::StatusOr<std::unique_ptr<CpuExecutable>>
-CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
+CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module,
+                                        tsl::thread::ThreadPool* thread_pool) {
   ModuleHook pre_optimization_ir_hook;
   ModuleHook post_optimization_ir_hook;
   std::tie(pre_optimization_ir_hook, post_optimization_ir_hook) =
@@ -1147,12 +1258,10 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   // CpuExecutable to an AOT compilation result.
   std::vector<std::string> obj_files;
 
-  // We split LLVM module and distribute it across separate DyLibs to enable
-  // parallel compilation at run time.
-  //
-  // TODO(b/359659598): Increase the number of dylibs to 32 and make compilation
-  // truly parallel. For now we use 2 dylibs to do basic sanity check.
-  constexpr size_t num_jit_dylibs = 2;
+  // We split LLVM module and distribute it across separate DyLibs, and compile
+  // module parts to object files in parallel.
+  const size_t num_jit_dylibs =
+      std::max(debug_options.xla_cpu_parallel_codegen_split_count(), 1);
 
   auto jit = SimpleOrcJIT::Create(
       CompilerTargetOptions(module->config()),
@@ -1225,6 +1334,7 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   };
 
   LLVMTargetMachineFeatures target_machine_features((*jit)->target_machine());
+  const uint64_t ir_emission_start_us = tsl::Env::Default()->NowMicros();
 
   // TODO(ezhulenev): Once we fully migrate to Thunks current IrEmitter should
   // be renamed to NestedIrEmitter and be used only for emitting nested (aka
@@ -1277,6 +1387,8 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
     }
 
     TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
+    const uint64_t codegen_start_us = tsl::Env::Default()->NowMicros();
+    RecordHloToLlvmDuration(codegen_start_us - ir_emission_start_us);
 
     // We define the number of module parts based on the total number of
     // external functions (kernels and comparators) that are called from thunks.
@@ -1295,15 +1407,41 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
     if (num_parts > 1) {
       VLOG(2) << "Splitting module into " << num_parts
               << " parts before codegen to enable parallel compilation";
+      // Module parts share the LLVM context of the original module, so we
+      // serialize them to bitcode to compile them on separate threads.
+      std::vector<llvm::SmallVector<char, 0>> parts;
       llvm::SplitModule(
           *llvm_module, num_parts,
-          [&, dylib_index = 0](auto llvm_module_part) mutable {
-            cantFail((*jit)->AddModule(
-                llvm::orc::ThreadSafeModule(std::move(llvm_module_part),
-                                            thread_safe_context),
-                dylib_index++ % num_jit_dylibs));
+          [&](std::unique_ptr<llvm::Module> llvm_module_part) {
+            llvm::raw_svector_ostream os(parts.emplace_back());
+            llvm::WriteBitcodeToFile(*llvm_module_part, os);
           },
           /*PreserveLocals=*/true);
+
+      TF_ASSIGN_OR_RETURN(
+          std::vector<std::unique_ptr<llvm::MemoryBuffer>> part_obj_files,
+          CompileModuleParts(
+              module->config(), parts, pre_optimization_ir_hook,
+              post_optimization_ir_hook,
+              thread_pool ? thread_pool : GetCodegenThreadPool()));
+
+      auto post_compilation_hook =
+          CreateOrcJITPostCompilationHook(module.get(), &obj_files);
+      for (size_t i = 0; i < part_obj_files.size(); ++i) {
+        llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_file =
+            llvm::object::ObjectFile::createObjectFile(
+                part_obj_files[i]->getMemBufferRef());
+        if (!obj_file) {
+          return Internal("Failed to load object file of module part %d: %s",
+                          i, llvm::toString(obj_file.takeError()));
+        }
+        post_compilation_hook(**obj_file);
+        if (auto err = (*jit)->AddObjFile(std::move(part_obj_files[i]),
+                                          i % num_jit_dylibs)) {
+          return Internal("Failed to add object file of module part %d: %s",
+                          i, llvm::toString(std::move(err)));
+        }
+      }
     } else {
       cantFail((*jit)->AddModule(llvm::orc::ThreadSafeModule(
           std::move(llvm_module), thread_safe_context)));
@@ -1344,6 +1482,8 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
                         comparator.name);
       }
     }
+    RecordLlvmToObjectDuration(tsl::Env::Default()->NowMicros() -
+                               codegen_start_us);
 
     // Create constant allocations from the buffer assignment.
     TF_ASSIGN_OR_RETURN(
@@ -1448,7 +1588,8 @@ absl::StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
 
   std::unique_ptr<CpuExecutable> cpu_executable;
   TF_ASSIGN_OR_RETURN(cpu_executable,
-                      CompileLegacyCpuExecutable(std::move(module)));
+                      CompileLegacyCpuExecutable(std::move(module),
+                                                 options.thread_pool));
 
   cpu_executable->set_debug_info(
       cpu_executable->buffer_assignment().GetStats().ToString());
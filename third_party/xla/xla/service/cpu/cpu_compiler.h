@@ -40,6 +40,7 @@ limitations under the License.
 #include "xla/service/llvm_compiler.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "xla/util.h"
+#include "tsl/platform/threadpool.h"
 
 namespace mlir {
 class DialectRegistry;
@@ -212,8 +213,10 @@ class CpuCompiler : public LLVMCompiler {
       LLVMTargetMachineFeatures* target_machine_features,
       const CompileOptions& compile_options, bool is_mlir_compile);
 
+  // Module parts are compiled on `thread_pool`, or on a thread pool shared by
+  // all compilations if it is null.
   absl::StatusOr<std::unique_ptr<CpuExecutable>> CompileLegacyCpuExecutable(
-      std::unique_ptr<HloModule> module);
+      std::unique_ptr<HloModule> module, tsl::thread::ThreadPool* thread_pool);
 
   CpuCompiler(const CpuCompiler&) = delete;
   CpuCompiler& operator=(const CpuCompiler&) = delete;
@@ -69,6 +69,7 @@ limitations under the License.
 #include "xla/stream_executor/host/host_stream.h"
 #include "xla/tsl/concurrency/async_value_ref.h"
 #include "xla/util.h"
+#include "xla/xla.pb.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
@@ -186,8 +187,17 @@ absl::StatusOr<std::unique_ptr<CpuExecutable>> CpuExecutable::Create(
   executable->jit_->DoneCompiling();
   executable->function_registry_ = FunctionRegistry(executable->jit_.get());
 
-  TF_ASSIGN_OR_RETURN(executable->thunks_,
-                      ThunkExecutor::Create(std::move(thunks)));
+  const DebugOptions& debug_options =
+      executable->module().config().debug_options();
+  ThunkExecutor::Options thunk_executor_options;
+  thunk_executor_options.execute_sequential_buffer_threshold =
+      debug_options.xla_cpu_thunk_executor_sequential_threshold_bytes();
+  thunk_executor_options.use_priority_ready_queue =
+      debug_options.xla_cpu_thunk_executor_use_priority_ready_queue();
+
+  TF_ASSIGN_OR_RETURN(
+      executable->thunks_,
+      ThunkExecutor::Create(std::move(thunks), thunk_executor_options));
 
   // Re-index constants by their allocation index to allow efficient lookup.
   for (auto& constant : constants) {
@@ -0,0 +1,32 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_METRICS_H_
+#define XLA_SERVICE_CPU_METRICS_H_
+
+#include <cstdint>
+
+namespace xla::cpu {
+
+// Emitting the LLVM module of an HLO module, up to its verification.
+void RecordHloToLlvmDuration(uint64_t time_usecs);
+
+// Splitting the LLVM module, running LLVM passes and compiling all module parts
+// to object files, up to looking up the compiled kernels and comparators.
+void RecordLlvmToObjectDuration(uint64_t time_usecs);
+
+}  // namespace xla::cpu
+
+#endif  // XLA_SERVICE_CPU_METRICS_H_
@@ -0,0 +1,130 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/service/compiler.h"
+#include "xla/service/cpu/cpu_executable.h"
+#include "xla/service/executable.h"
+#include "xla/tests/hlo_test_base.h"
+#include "xla/tests/literal_test_util.h"
+#include "xla/tests/verified_hlo_module.h"
+#include "xla/xla.pb.h"
+#include "tsl/platform/casts.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla::cpu {
+namespace {
+
+constexpr int kNumKernels = 16;
+
+// Compiles modules with more kernels than module parts, so that the LLVM
+// module is split and the parts are compiled to object files in parallel.
+class CpuParallelCodegenTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_use_thunk_runtime(true);
+    debug_options.set_xla_cpu_parallel_codegen_split_count(8);
+    return debug_options;
+  }
+
+  // Returns a module computing `p * (kNumKernels + 1)` with a chain of adds,
+  // which are compiled to separate kernels when HLO passes don't run.
+  absl::StatusOr<std::unique_ptr<VerifiedHloModule>> CreateModule() {
+    std::string hlo = R"(
+      HloModule Test
+
+      ENTRY main {
+        p = f32[4]{0} parameter(0)
+        add.0 = f32[4]{0} add(p, p))";
+    for (int i = 1; i < kNumKernels; ++i) {
+      absl::StrAppend(&hlo, "\n        add.", i, " = f32[4]{0} add(add.", i - 1,
+                      ", p)");
+    }
+    absl::StrAppend(&hlo, "\n        ROOT copy = f32[4]{0} copy(add.",
+                    kNumKernels - 1, ")\n      }");
+    return ParseAndReturnVerifiedModule(hlo);
+  }
+
+  Literal Argument() {
+    return LiteralUtil::CreateR1<float>({1.0f, 2.0f, -3.0f, 0.5f});
+  }
+
+  Literal ExpectedResult() {
+    constexpr float kScale = kNumKernels + 1;
+    return LiteralUtil::CreateR1<float>(
+        {kScale * 1.0f, kScale * 2.0f, kScale * -3.0f, kScale * 0.5f});
+  }
+};
+
+TEST_F(CpuParallelCodegenTest, ComputesResults) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          CreateModule());
+  Literal argument = Argument();
+  Literal result = ExecuteNoHloPasses(std::move(module), {&argument});
+  EXPECT_TRUE(LiteralTestUtil::Equal(ExpectedResult(), result));
+}
+
+TEST_F(CpuParallelCodegenTest, FindsKernelsOfAllParts) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          CreateModule());
+  std::vector<std::string> kernel_names;
+  for (const HloInstruction* instr :
+       module->entry_computation()->instructions()) {
+    if (instr->opcode() == HloOpcode::kAdd) {
+      kernel_names.push_back(instr->name());
+    }
+  }
+  ASSERT_EQ(kernel_names.size(), kNumKernels);
+
+  // Module parts are compiled on the caller's thread pool.
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "compile", 4);
+  Compiler::CompileOptions options;
+  options.thread_pool = &thread_pool;
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      backend().compiler()->RunBackend(
+          std::move(module), backend().default_stream_executor(), options));
+
+  auto* cpu_executable = tsl::down_cast<CpuExecutable*>(executable.get());
+  EXPECT_FALSE(cpu_executable->obj_files().empty());
+  for (const std::string& name : kernel_names) {
+    EXPECT_TRUE(cpu_executable->function_registry().FindKernel(name).ok())
+        << name;
+  }
+
+  Literal argument = Argument();
+  TF_ASSERT_OK_AND_ASSIGN(
+      Literal result, test_runner_.ExecuteWithExecutable(executable.get(),
+                                                         {&argument}));
+  EXPECT_TRUE(LiteralTestUtil::Equal(ExpectedResult(), result));
+}
+
+}  // namespace
+}  // namespace xla::cpu
@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
@@ -393,6 +394,37 @@ absl::StatusOr<std::optional<AutotuneResult>> TryFindInCache(
   }
   return std::nullopt;
 }
+
+// Waits for a random delay of up to `jitter_ms` and then looks `key` up in the
+// file-based cache again, in case another process sharing `cache_dir` has
+// published the result in the meantime. The jitter staggers processes that
+// start compiling the same program at the same time, so that only a few of
+// them autotune each fusion.
+absl::StatusOr<std::optional<AutotuneResult>> TryFindInCacheAfterJitter(
+    const AutotuneCacheKey& key, absl::string_view cache_dir,
+    int32_t jitter_ms) ABSL_LOCKS_EXCLUDED(autotune_cache_mu) {
+  if (cache_dir.empty() || jitter_ms <= 0) {
+    return std::nullopt;
+  }
+  static absl::Mutex bitgen_mu(absl::kConstInit);
+  static absl::BitGen* bitgen ABSL_GUARDED_BY(bitgen_mu) = new absl::BitGen();
+  int64_t delay_us;
+  {
+    absl::MutexLock lock(&bitgen_mu);
+    delay_us = absl::Uniform<int64_t>(*bitgen, 0, int64_t{jitter_ms} * 1000);
+  }
+  VLOG(2) << "Waiting " << delay_us
+          << "us before autotuning, key = " << key.ToString();
+  tsl::Env::Default()->SleepForMicroseconds(delay_us);
+
+  TF_ASSIGN_OR_RETURN(std::optional<AutotuneResult> opt_result,
+                      TryToFindInFileBasedCacheIfEnabled(key, cache_dir));
+  if (opt_result.has_value()) {
+    AddResultToInMemoryCache(key, opt_result.value());
+    VLOG(1) << "File-based autotune cache hit after jitter";
+  }
+  return opt_result;
+}
 }  // namespace
 
 /*static*/ AutotuneCacheKey AutotunerUtil::GetKey(
@@ -434,6 +466,13 @@ absl::StatusOr<std::optional<AutotuneResult>> TryFindInCache(
         key.ToString());
   }
 
+  TF_ASSIGN_OR_RETURN(
+      opt_res, TryFindInCacheAfterJitter(key, config.autotune_cache_dir(),
+                                         config.autotune_cache_jitter_ms()));
+  if (opt_res.has_value()) {
+    return opt_res.value();
+  }
+
   TF_ASSIGN_OR_RETURN(AutotuneResult autotune_result, autotune_fn());
 
   TF_ASSIGN_OR_RETURN(ResultAndInserted result_and_inserted,
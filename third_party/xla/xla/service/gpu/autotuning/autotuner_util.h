@@ -111,6 +111,9 @@ class AutotuneConfig {
   }
   // Empty string means no cache is used.
   const std::string& autotune_cache_dir() const { return autotune_cache_dir_; }
+  // Upper bound of the random delay before autotuning on a cache miss, to give
+  // other processes sharing `autotune_cache_dir` a chance to publish the result.
+  int32_t autotune_cache_jitter_ms() const { return autotune_cache_jitter_ms_; }
 
   AutotuneConfig(const AutotuneConfig& right)
       : config_(right.config_),
@@ -119,7 +122,8 @@ class AutotuneConfig {
         exhaustive_tiling_search_(right.exhaustive_tiling_search_),
         require_complete_aot_autotune_results_(
             right.require_complete_aot_autotune_results_),
-        autotune_cache_dir_(right.autotune_cache_dir_) {}
+        autotune_cache_dir_(right.autotune_cache_dir_),
+        autotune_cache_jitter_ms_(right.autotune_cache_jitter_ms_) {}
 
   AutotuneConfig(const std::variant<DeviceConfig, DevicelessConfig>& config,
                  const DebugOptions& debug_options)
@@ -132,7 +136,9 @@ class AutotuneConfig {
         require_complete_aot_autotune_results_(
             debug_options.xla_gpu_require_complete_aot_autotune_results()),
         autotune_cache_dir_(
-            debug_options.xla_gpu_per_fusion_autotune_cache_dir()) {}
+            debug_options.xla_gpu_per_fusion_autotune_cache_dir()),
+        autotune_cache_jitter_ms_(
+            debug_options.xla_gpu_per_fusion_autotune_cache_jitter_ms()) {}
 
   std::string GetModelStr() const {
     if (auto deviceless_config = std::get_if<DevicelessConfig>(&config_)) {
@@ -190,6 +196,7 @@ class AutotuneConfig {
   bool require_complete_aot_autotune_results_;
   mutable std::unique_ptr<se::DeviceMemoryAllocator> allocator_;
   std::string autotune_cache_dir_;
+  int32_t autotune_cache_jitter_ms_;
 };
 
 using AutotuneNoCacheFn = std::function<absl::StatusOr<AutotuneResult>()>;
@@ -345,6 +345,23 @@ TEST_F(FileBasedCacheTest, AutotuneReadsResultFromTheCacheDir) {
   EXPECT_EQ(ToString(result), ToString(result1_));
 }
 
+TEST_F(FileBasedCacheTest, AutotuneWithJitterWritesResultToTheCacheDir) {
+  AutotuneConfig config(DeviceConfig{executor_}, [&] {
+    DebugOptions options;
+    options.set_xla_gpu_per_fusion_autotune_cache_dir(cache_dir_);
+    options.set_xla_gpu_per_fusion_autotune_cache_jitter_ms(1);
+    return options;
+  }());
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      AutotuneResult result,
+      AutotunerUtil::Autotune(dot_, config, [&] { return result1_; }));
+  EXPECT_EQ(ToString(result), ToString(result1_));
+
+  ASSERT_THAT(GetFilesInDir(cache_dir_), ElementsAre(cache_filename_));
+  EXPECT_EQ(Read(cache_file_path_), ToString(result1_));
+}
+
 TEST_F(FileBasedCacheTest,
        RepeatedAutotuneCallsDontReadOrWriteTheCacheFileAgain) {
   auto check_autotune_cache_hit = [](const HloInstruction* instr,
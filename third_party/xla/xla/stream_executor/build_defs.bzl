@@ -15,7 +15,11 @@ def stream_executor_friends():
     return ["//..."]
 
 def stream_executor_internal():
-    return ["//..."]
+    return [
+        "//...",
+        # The GPU device of TensorFlow, which captures steps into command buffers.
+        "@org_tensorflow//tensorflow/core/common_runtime/gpu",
+    ]
 
 def tf_additional_cuda_platform_deps():
     return []
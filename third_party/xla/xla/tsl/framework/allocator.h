@@ -61,6 +61,11 @@ struct AllocationAttributes {
   // a memory chunk whose freed_at_count is at this value or earlier may be
   // returned.
   std::function<uint64()>* freed_by_func = nullptr;  // Not owned.
+  // If true, the buffer is a temporary of a kernel (e.g. scratch space) that
+  // is deallocated once the kernel has run, and is never kept by the kernel or
+  // returned as an output. Allocators may serve such buffers from a separate
+  // pool. Callers opt in explicitly; nothing sets it by default.
+  bool short_lived = false;
 
   AllocationAttributes(const AllocationAttributes&) = delete;
   void operator=(const AllocationAttributes&) = delete;
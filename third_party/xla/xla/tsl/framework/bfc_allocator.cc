@@ -19,13 +19,16 @@ limitations under the License.
 #include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "xla/tsl/framework/allocator_retry.h"
+#include "xla/tsl/framework/metrics.h"
 #include "xla/tsl/protobuf/bfc_memory_map.pb.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
+#include "tsl/platform/mutex_contention.h"
 #include "tsl/platform/numbers.h"
 #include "tsl/platform/stacktrace.h"
 #include "tsl/platform/str_util.h"
@@ -36,6 +39,29 @@ limitations under the License.
 
 namespace tsl {
 
+namespace {
+
+TSL_MUTEX_CONTENTION_SITE(allocate_contention_site, "BFCAllocator::Allocate");
+TSL_MUTEX_CONTENTION_SITE(deallocate_contention_site,
+                          "BFCAllocator::Deallocate");
+
+// The fast bins do not record the per-allocation debugging information.
+#ifdef TENSORFLOW_MEM_DEBUG
+constexpr bool kFastBinsSupported = false;
+#else
+constexpr bool kFastBinsSupported = true;
+#endif
+
+// Returns the index of the fast bin cache used by the calling thread.
+int FastBinCacheIndexForCurrentThread(int num_caches) {
+  static std::atomic<int> next_index{0};
+  thread_local const int index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index % num_caches;
+}
+
+}  // namespace
+
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
@@ -45,6 +71,13 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(std::move(sub_allocator)),
       name_(name),
+      fast_bins_enabled_(kFastBinsSupported && opts.fast_bin_max_bytes > 0),
+      fast_bin_max_bytes_(std::min(opts.fast_bin_max_bytes, kMaxFastBinBytes)),
+      fast_bin_chunk_maps_(fast_bins_enabled_
+                               ? new FastBinChunkMap[kNumFastBinShards]
+                               : nullptr),
+      fast_bin_caches_(fast_bins_enabled_ ? new FastBinCache[kNumFastBinShards]
+                                          : nullptr),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
   if (opts.allow_growth) {
@@ -423,10 +456,17 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  if (UseFastBins(rounded_bytes)) {
+    void* ptr = AllocateFromFastBins(rounded_bytes, num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
-  mutex_lock l(lock_);
+  profiled_mutex_lock l(lock_, allocate_contention_site());
   if (!timestamped_chunks_.empty()) {
     // Merge timestamped chunks whose counts have become safe for general use.
     MergeTimestampedChunks(0);
@@ -434,6 +474,7 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
   if (ptr != nullptr) {
     AddTraceMe("MemoryAllocation", ptr);
+    MaybeRecordMemoryTimeline(/*is_allocation=*/true, ptr);
     return ptr;
   }
 
@@ -442,6 +483,19 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
+      MaybeRecordMemoryTimeline(/*is_allocation=*/true, ptr);
+      return ptr;
+    }
+  }
+
+  if (fast_bins_enabled_) {
+    // Return the chunks cached in the fast bins, so that they can be coalesced
+    // with their neighbors.
+    FlushFastBins();
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      MaybeRecordMemoryTimeline(/*is_allocation=*/true, ptr);
       return ptr;
     }
   }
@@ -455,6 +509,7 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
       ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
       if (ptr != nullptr) {
         AddTraceMe("MemoryAllocation", ptr);
+        MaybeRecordMemoryTimeline(/*is_allocation=*/true, ptr);
         return ptr;
       }
     }
@@ -469,6 +524,7 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
+      MaybeRecordMemoryTimeline(/*is_allocation=*/true, ptr);
       return ptr;
     }
   }
@@ -551,6 +607,80 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
       /*level=*/tsl::profiler::TraceMeLevel::kInfo);
 }
 
+void BFCAllocator::MaybeRecordMemoryTimeline(bool is_allocation,
+                                             const void* ptr) {
+  if (opts_.memory_timeline_sample_rate <= 0) return;
+  const Chunk* chunk = ChunkFromHandle(region_manager_.get_handle(ptr));
+  MaybeRecordMemoryTimeline(is_allocation, chunk->ptr, chunk->requested_size,
+                            chunk->size);
+}
+
+void BFCAllocator::MaybeRecordMemoryTimeline(bool is_allocation,
+                                             const void* chunk_ptr,
+                                             int64_t req_bytes,
+                                             int64_t alloc_bytes) {
+  if (opts_.memory_timeline_sample_rate <= 0 ||
+      ++memory_timeline_actions_ % opts_.memory_timeline_sample_rate != 0) {
+    return;
+  }
+  MemoryTimelineEvent event;
+  event.time_micros = Env::Default()->NowMicros();
+  event.is_allocation = is_allocation;
+  event.address = reinterpret_cast<uint64>(chunk_ptr);
+  event.requested_bytes = req_bytes;
+  event.allocation_bytes = alloc_bytes;
+  const auto& annotation =
+      tsl::profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  if (annotation.pending_op_name != nullptr) {
+    event.op_name = annotation.pending_op_name;
+  }
+  event.step_id = annotation.pending_step_id;
+  event.bytes_in_use = stats_.bytes_in_use;
+  event.pool_bytes = *stats_.pool_bytes;
+  event.largest_free_block_bytes = LargestFreeChunk();
+  // GetFragmentation() is undefined while no memory is free.
+  event.fragmentation =
+      event.pool_bytes > event.bytes_in_use ? GetFragmentation() : 0;
+
+  tsl::metrics::UpdateBfcAllocatorFragmentation(name_, event.fragmentation);
+  tsl::profiler::TraceMe::InstantActivity(
+      [&]() {
+        return tsl::profiler::TraceMeEncode(
+            "MemoryTimeline",
+            {{"allocator_name", name_},
+             {"action",
+              event.is_allocation ? "allocation" : "deallocation"},
+             {"allocation_bytes", event.allocation_bytes},
+             {"bytes_allocated", event.bytes_in_use},
+             {"pool_bytes", event.pool_bytes},
+             {"largest_free_block_bytes", event.largest_free_block_bytes},
+             {"fragmentation", event.fragmentation},
+             {"tf_op", event.op_name},
+             {"id", event.step_id}});
+      },
+      /*level=*/tsl::profiler::TraceMeLevel::kInfo);
+
+  if (memory_timeline_.size() < kMemoryTimelineCapacity) {
+    memory_timeline_.push_back(std::move(event));
+  } else {
+    memory_timeline_[memory_timeline_next_] = std::move(event);
+    memory_timeline_next_ =
+        (memory_timeline_next_ + 1) % kMemoryTimelineCapacity;
+  }
+}
+
+std::vector<BFCAllocator::MemoryTimelineEvent> BFCAllocator::MemoryTimeline() {
+  mutex_lock l(lock_);
+  std::vector<MemoryTimelineEvent> timeline;
+  timeline.reserve(memory_timeline_.size());
+  timeline.insert(timeline.end(),
+                  memory_timeline_.begin() + memory_timeline_next_,
+                  memory_timeline_.end());
+  timeline.insert(timeline.end(), memory_timeline_.begin(),
+                  memory_timeline_.begin() + memory_timeline_next_);
+  return timeline;
+}
+
 void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
                                  size_t num_bytes, uint64 freed_before) {
   // First identify the first bin that could satisfy rounded_bytes.
@@ -605,6 +735,12 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (fast_bins_enabled_) {
+          UpdateFastBinBytesInUse(chunk->size);
+          if (UseFastBins(chunk->size)) {
+            RegisterFastBinChunk(h);
+          }
+        }
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -639,6 +775,161 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
   return nullptr;
 }
 
+bool BFCAllocator::UseFastBins(size_t rounded_bytes) const {
+  return fast_bins_enabled_ && rounded_bytes <= fast_bin_max_bytes_ &&
+         timing_counter_ == nullptr &&
+         !tsl::profiler::TraceMe::Active(tsl::profiler::TraceMeLevel::kInfo);
+}
+
+BFCAllocator::FastBinChunkMap& BFCAllocator::FastBinChunkMapFor(
+    const void* ptr) const {
+  const std::uintptr_t p_int = reinterpret_cast<std::uintptr_t>(ptr);
+  return fast_bin_chunk_maps_[(p_int >> kMinAllocationBits) %
+                              kNumFastBinShards];
+}
+
+bool BFCAllocator::FindFastBinChunk(const void* ptr,
+                                    FastBinChunk* chunk) const {
+  if (!fast_bins_enabled_) {
+    return false;
+  }
+  FastBinChunkMap& map = FastBinChunkMapFor(ptr);
+  mutex_lock l(map.mu);
+  auto it = map.chunks.find(ptr);
+  if (it == map.chunks.end()) {
+    return false;
+  }
+  *chunk = it->second;
+  return true;
+}
+
+void BFCAllocator::UpdateFastBinBytesInUse(int64_t delta) {
+  const int64_t bytes_in_use =
+      fast_bin_bytes_in_use_.fetch_add(delta, std::memory_order_relaxed) +
+      delta;
+  int64_t peak = fast_bin_peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (bytes_in_use > peak &&
+         !fast_bin_peak_bytes_in_use_.compare_exchange_weak(
+             peak, bytes_in_use, std::memory_order_relaxed)) {
+  }
+}
+
+void* BFCAllocator::AllocateFromFastBins(size_t rounded_bytes,
+                                         size_t num_bytes) {
+  void* ptr = nullptr;
+  {
+    FastBinCache& cache = fast_bin_caches_[FastBinCacheIndexForCurrentThread(
+        kNumFastBinShards)];
+    mutex_lock l(cache.mu);
+    std::vector<void*>& free_chunks =
+        cache.free_chunks[rounded_bytes / kMinAllocationSize - 1];
+    if (free_chunks.empty()) {
+      return nullptr;
+    }
+    ptr = free_chunks.back();
+    free_chunks.pop_back();
+    cache.cached_bytes -= rounded_bytes;
+  }
+  {
+    FastBinChunkMap& map = FastBinChunkMapFor(ptr);
+    mutex_lock l(map.mu);
+    FastBinChunk& chunk = map.chunks[ptr];
+    DCHECK_EQ(chunk.size, rounded_bytes);
+    chunk.requested_size = num_bytes;
+    chunk.allocation_id = next_allocation_id_++;
+  }
+  fast_bin_num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  int64_t largest =
+      fast_bin_largest_alloc_size_.load(std::memory_order_relaxed);
+  while (static_cast<int64_t>(rounded_bytes) > largest &&
+         !fast_bin_largest_alloc_size_.compare_exchange_weak(
+             largest, rounded_bytes, std::memory_order_relaxed)) {
+  }
+  UpdateFastBinBytesInUse(rounded_bytes);
+  VLOG(4) << "Returning from fast bins: " << ptr;
+  return ptr;
+}
+
+void BFCAllocator::RegisterFastBinChunk(ChunkHandle h) {
+  const Chunk* c = ChunkFromHandle(h);
+  FastBinChunkMap& map = FastBinChunkMapFor(c->ptr);
+  mutex_lock l(map.mu);
+  FastBinChunk& chunk = map.chunks[c->ptr];
+  chunk.size = c->size;
+  chunk.requested_size = c->requested_size;
+  chunk.allocation_id = c->allocation_id;
+}
+
+bool BFCAllocator::DeallocateToFastBins(void* ptr, size_t* requested_size) {
+  FastBinChunkMap& map = FastBinChunkMapFor(ptr);
+  mutex_lock l(map.mu);
+  auto it = map.chunks.find(ptr);
+  if (it == map.chunks.end()) {
+    return false;
+  }
+  const size_t size = it->second.size;
+  if (UseFastBins(size)) {
+    FastBinCache& cache = fast_bin_caches_[FastBinCacheIndexForCurrentThread(
+        kNumFastBinShards)];
+    mutex_lock cache_lock(cache.mu);
+    if (cache.cached_bytes + size <= kMaxFastBinCachedBytesPerShard) {
+      cache.free_chunks[size / kMinAllocationSize - 1].push_back(ptr);
+      cache.cached_bytes += size;
+      it->second.requested_size = 0;
+      it->second.allocation_id = -1;
+      UpdateFastBinBytesInUse(-static_cast<int64_t>(size));
+      return true;
+    }
+  }
+  *requested_size = it->second.requested_size;
+  map.chunks.erase(it);
+  return false;
+}
+
+void BFCAllocator::FlushFastBins() {
+  if (!fast_bins_enabled_) {
+    return;
+  }
+  std::vector<void*> to_free;
+  for (int i = 0; i < kNumFastBinShards; ++i) {
+    FastBinCache& cache = fast_bin_caches_[i];
+    mutex_lock l(cache.mu);
+    for (std::vector<void*>& free_chunks : cache.free_chunks) {
+      to_free.insert(to_free.end(), free_chunks.begin(), free_chunks.end());
+      free_chunks.clear();
+    }
+    cache.cached_bytes = 0;
+  }
+  VLOG(2) << "Flushing " << to_free.size() << " chunks from the fast bins of "
+          << Name();
+  for (void* ptr : to_free) {
+    {
+      FastBinChunkMap& map = FastBinChunkMapFor(ptr);
+      mutex_lock l(map.mu);
+      map.chunks.erase(ptr);
+    }
+    ChunkHandle h = region_manager_.get_handle(ptr);
+    CHECK(h != kInvalidChunkHandle);
+    MarkFree(h);
+    InsertFreeChunkIntoBin(TryToCoalesce(h, false));
+  }
+  // Bring the chunks that are still in use by clients up to date, so that
+  // memory dumps show the current requested sizes.
+  for (int i = 0; i < kNumFastBinShards; ++i) {
+    FastBinChunkMap& map = fast_bin_chunk_maps_[i];
+    mutex_lock l(map.mu);
+    for (const auto& [ptr, fast_bin_chunk] : map.chunks) {
+      if (fast_bin_chunk.allocation_id == -1) {
+        // Being cached, concurrently with this flush.
+        continue;
+      }
+      Chunk* c = ChunkFromHandle(region_manager_.get_handle(ptr));
+      c->requested_size = fast_bin_chunk.requested_size;
+      c->allocation_id = fast_bin_chunk.allocation_id;
+    }
+  }
+}
+
 void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
   // Allocate the new chunk before we do any ChunkFromHandle
   ChunkHandle h_new_chunk = AllocateChunk();
@@ -692,18 +983,31 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     VLOG(2) << "tried to deallocate nullptr";
     return;
   }
-  mutex_lock l(lock_);
+  size_t fast_bin_requested_size = 0;
+  if (fast_bins_enabled_ &&
+      DeallocateToFastBins(ptr, &fast_bin_requested_size)) {
+    return;
+  }
+  profiled_mutex_lock l(lock_, deallocate_contention_site());
 
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
   // Record chunk information before it's freed.
   Chunk* chunk = ChunkFromHandle(h);
+  if (fast_bin_requested_size > 0) {
+    // The chunk was reused by the fast bins since it was last allocated from
+    // the regular bins.
+    chunk->requested_size = fast_bin_requested_size;
+  }
   void* chunk_ptr = chunk->ptr;
   int64_t req_bytes = chunk->requested_size;
   int64_t alloc_bytes = chunk->size;
 
   MarkFree(h);
+  if (fast_bins_enabled_) {
+    UpdateFastBinBytesInUse(-alloc_bytes);
+  }
 
   // Consider coalescing it.
   if (timing_counter_) {
@@ -716,6 +1020,8 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
   // correct aggregation stats (bytes_in_use, fragmentation).
   AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
+  MaybeRecordMemoryTimeline(/*is_allocation=*/false, chunk_ptr, req_bytes,
+                            alloc_bytes);
 
   if (VLOG_IS_ON(4)) {
     LOG(INFO) << "F: " << RenderOccupancy();
@@ -936,6 +1242,10 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  FastBinChunk fast_bin_chunk;
+  if (FindFastBinChunk(ptr, &fast_bin_chunk)) {
+    return fast_bin_chunk.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -945,6 +1255,10 @@ size_t BFCAllocator::RequestedSize(const void* ptr) const {
 }
 
 size_t BFCAllocator::AllocatedSize(const void* ptr) const {
+  FastBinChunk fast_bin_chunk;
+  if (FindFastBinChunk(ptr, &fast_bin_chunk)) {
+    return fast_bin_chunk.size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -954,6 +1268,10 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) const {
 }
 
 int64_t BFCAllocator::AllocationId(const void* ptr) const {
+  FastBinChunk fast_bin_chunk;
+  if (FindFastBinChunk(ptr, &fast_bin_chunk)) {
+    return fast_bin_chunk.allocation_id;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1034,6 +1352,8 @@ string BFCAllocator::RenderOccupancy() {
 }
 
 void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
+  // Chunks cached in the fast bins are free, so show them as such.
+  FlushFastBins();
   const std::array<BinDebugInfo, kNumBins> bin_infos = get_bin_debug_info();
   LOG(INFO) << "BFCAllocator dump for " << Name();
   for (BinNum bin_num = 0; bin_num < kNumBins; bin_num++) {
@@ -1110,7 +1430,7 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
             << " available bytes: " << (memory_limit_ - *stats_.pool_bytes)
             << " curr_region_allocation_bytes_: "
             << curr_region_allocation_bytes_;
-  LOG(INFO) << "Stats: \n" << stats_.DebugString();
+  LOG(INFO) << "Stats: \n" << GetStatsInternal().DebugString();
 }
 
 void BFCAllocator::MaybeWriteMemoryMap() {
@@ -1140,15 +1460,19 @@ MemoryDump BFCAllocator::RecordMemoryMap() {
 }
 
 MemoryDump BFCAllocator::RecordMemoryMapInternal() {
+  // Chunks cached in the fast bins are free, so record them as such.
+  FlushFastBins();
+
   MemoryDump md;
   md.set_allocator_name(Name());
 
   // Record the general stats
+  const AllocatorStats stats = GetStatsInternal();
   tensorflow::MemAllocatorStats* mas = md.mutable_stats();
-  mas->set_num_allocs(stats_.num_allocs);
-  mas->set_bytes_in_use(stats_.bytes_in_use);
-  mas->set_peak_bytes_in_use(stats_.peak_bytes_in_use);
-  mas->set_largest_alloc_size(stats_.largest_alloc_size);
+  mas->set_num_allocs(stats.num_allocs);
+  mas->set_bytes_in_use(stats.bytes_in_use);
+  mas->set_peak_bytes_in_use(stats.peak_bytes_in_use);
+  mas->set_largest_alloc_size(stats.largest_alloc_size);
 
   // Record summary data for every bin.
   const std::array<BinDebugInfo, kNumBins> bin_infos = get_bin_debug_info();
@@ -1207,7 +1531,22 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  return GetStatsInternal();
+}
+
+AllocatorStats BFCAllocator::GetStatsInternal() {
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunk();
+  if (fast_bins_enabled_) {
+    stats.num_allocs += fast_bin_num_allocs_.load(std::memory_order_relaxed);
+    stats.bytes_in_use = fast_bin_bytes_in_use_.load(std::memory_order_relaxed);
+    stats.peak_bytes_in_use =
+        fast_bin_peak_bytes_in_use_.load(std::memory_order_relaxed);
+    stats.largest_alloc_size =
+        std::max(stats.largest_alloc_size,
+                 fast_bin_largest_alloc_size_.load(std::memory_order_relaxed));
+  }
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
@@ -1215,6 +1554,13 @@ bool BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
+  if (fast_bins_enabled_) {
+    fast_bin_num_allocs_.store(0, std::memory_order_relaxed);
+    fast_bin_peak_bytes_in_use_.store(
+        fast_bin_bytes_in_use_.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    fast_bin_largest_alloc_size_.store(0, std::memory_order_relaxed);
+  }
   return true;
 }
 
@@ -17,12 +17,14 @@ limitations under the License.
 #define XLA_TSL_FRAMEWORK_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "xla/tsl/framework/allocator.h"
 #include "xla/tsl/framework/allocator_retry.h"
@@ -69,7 +71,45 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If positive, allocations of at most this many bytes (capped at 4KiB) are
+    // served from sharded caches of free chunks ("fast bins") that bypass the
+    // allocator lock. Chunks in the fast bins are only returned to the regular
+    // bins, and coalesced, when a cache is full, when an allocation could not
+    // otherwise be satisfied, or before the memory map is dumped.
+    //
+    // Fast bins are not used while a timing counter is set or memory profiling
+    // is active, nor in TENSORFLOW_MEM_DEBUG builds.
+    size_t fast_bin_max_bytes = 0;
+
+    // If positive, one in this many allocations and deallocations is recorded
+    // in a ring buffer of the last kMemoryTimelineCapacity events (see
+    // MemoryTimeline()), emitted as a "MemoryTimeline" TraceMe, and updates the
+    // fragmentation exported through tsl::metrics. This is cheap enough to
+    // leave on in serving to watch fragmentation build up over time.
+    //
+    // Allocations served from the fast bins are not sampled.
+    int64_t memory_timeline_sample_rate = 0;
+  };
+
+  // A sampled allocation or deallocation, with the state of the allocator
+  // right after it.
+  struct MemoryTimelineEvent {
+    uint64 time_micros = 0;
+    bool is_allocation = false;
+    uint64 address = 0;
+    int64_t requested_bytes = 0;
+    int64_t allocation_bytes = 0;
+    // The op and step that requested the memory, if annotated.
+    std::string op_name;
+    int64_t step_id = 0;
+    int64_t bytes_in_use = 0;
+    int64_t pool_bytes = 0;
+    int64_t largest_free_block_bytes = 0;
+    double fragmentation = 0;
   };
+  static constexpr size_t kMemoryTimelineCapacity = 4096;
+
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
 
@@ -108,6 +148,10 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns the sampled events still in the ring buffer, oldest first. Empty
+  // unless Options::memory_timeline_sample_rate is positive.
+  std::vector<MemoryTimelineEvent> MemoryTimeline();
+
  private:
   struct Bin;
 
@@ -153,6 +197,15 @@ class BFCAllocator : public Allocator {
                   int64_t req_bytes, int64_t alloc_bytes)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Records one in opts_.memory_timeline_sample_rate calls in the memory
+  // timeline. Like AddTraceMe, must be called after the chunk was allocated or
+  // freed so that the recorded stats include it.
+  void MaybeRecordMemoryTimeline(bool is_allocation, const void* ptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void MaybeRecordMemoryTimeline(bool is_allocation, const void* chunk_ptr,
+                                 int64_t req_bytes, int64_t alloc_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   typedef size_t ChunkHandle;
@@ -278,6 +331,71 @@ class BFCAllocator : public Allocator {
   static constexpr size_t kMinAllocationBits = 8;
   static constexpr size_t kMinAllocationSize = 1 << kMinAllocationBits;
 
+  // Fast bins. See Options::fast_bin_max_bytes.
+  static constexpr size_t kMaxFastBinBytes = 4096;
+  static constexpr int kNumFastBinSizeClasses =
+      kMaxFastBinBytes / kMinAllocationSize;
+  static constexpr int kNumFastBinShards = 16;
+  static constexpr size_t kMaxFastBinCachedBytesPerShard = 1 << 20;
+
+  // Metadata of a chunk owned by the fast bins. The regular bins consider such
+  // a chunk in use until it is flushed, so these fields supersede the ones in
+  // its Chunk.
+  struct FastBinChunk {
+    size_t size = 0;
+    size_t requested_size = 0;
+    int64_t allocation_id = -1;
+  };
+
+  // The chunks owned by the fast bins, sharded by address.
+  struct alignas(64) FastBinChunkMap {
+    mutex mu;
+    absl::flat_hash_map<const void*, FastBinChunk> chunks TF_GUARDED_BY(mu);
+  };
+
+  // Free chunks owned by the fast bins, with one list per size class. Each
+  // thread allocates from one of these caches.
+  struct alignas(64) FastBinCache {
+    mutex mu;
+    std::array<std::vector<void*>, kNumFastBinSizeClasses> free_chunks
+        TF_GUARDED_BY(mu);
+    size_t cached_bytes TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Returns true if an allocation of 'rounded_bytes' may use the fast bins.
+  bool UseFastBins(size_t rounded_bytes) const;
+
+  // Returns a chunk of exactly 'rounded_bytes' from the calling thread's fast
+  // bin cache, or nullptr if the cache has none.
+  void* AllocateFromFastBins(size_t rounded_bytes, size_t num_bytes);
+
+  // Hands the chunk 'h', which was just allocated from the regular bins, over
+  // to the fast bins.
+  void RegisterFastBinChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Caches 'ptr' in the calling thread's fast bin cache. Returns false if
+  // 'ptr' must be freed to the regular bins instead. If 'ptr' was owned by the
+  // fast bins, it no longer is, and its requested size is stored in
+  // '*requested_size'.
+  bool DeallocateToFastBins(void* ptr, size_t* requested_size);
+
+  // Returns all cached fast bin chunks to the regular bins, and updates the
+  // chunks that the fast bins have handed out to clients.
+  void FlushFastBins() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Looks up 'ptr' in the fast bins. Returns false if 'ptr' is not owned by
+  // the fast bins.
+  bool FindFastBinChunk(const void* ptr, FastBinChunk* chunk) const;
+
+  FastBinChunkMap& FastBinChunkMapFor(const void* ptr) const;
+
+  // Adds 'delta' to the bytes in use tracked for the fast bins, and updates
+  // the peak.
+  void UpdateFastBinBytesInUse(int64_t delta);
+
+  // Returns the allocator stats, accounting for the fast bins.
+  AllocatorStats GetStatsInternal() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // BFCAllocator allocates memory into a collection of disjoint
   // AllocationRegions.  Each AllocationRegion corresponds to one call to
   // SubAllocator::Alloc().  (Actually, if a subsequent call to
@@ -572,6 +690,19 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Whether fast bins are enabled, and the largest allocation they serve.
+  const bool fast_bins_enabled_;
+  const size_t fast_bin_max_bytes_;
+  const std::unique_ptr<FastBinChunkMap[]> fast_bin_chunk_maps_;
+  const std::unique_ptr<FastBinCache[]> fast_bin_caches_;
+
+  // With fast bins enabled, stats_.bytes_in_use also counts the chunks that
+  // are cached in the fast bins. These track the stats that clients observe.
+  std::atomic<int64_t> fast_bin_bytes_in_use_{0};
+  std::atomic<int64_t> fast_bin_peak_bytes_in_use_{0};
+  std::atomic<int64_t> fast_bin_num_allocs_{0};
+  std::atomic<int64_t> fast_bin_largest_alloc_size_{0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -582,11 +713,19 @@ class BFCAllocator : public Allocator {
   ChunkHandle free_chunks_list_ TF_GUARDED_BY(lock_);
 
   // Counter containing the next unique identifier to assign to a
-  // newly-created chunk.
-  int64_t next_allocation_id_ TF_GUARDED_BY(lock_);
+  // newly-created chunk. Atomic, since the fast bins assign identifiers
+  // without holding lock_.
+  std::atomic<int64_t> next_allocation_id_;
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // The sampled memory timeline, a ring buffer of at most
+  // kMemoryTimelineCapacity events whose oldest is at memory_timeline_next_
+  // once full.
+  int64_t memory_timeline_actions_ TF_GUARDED_BY(lock_) = 0;
+  std::vector<MemoryTimelineEvent> memory_timeline_ TF_GUARDED_BY(lock_);
+  size_t memory_timeline_next_ TF_GUARDED_BY(lock_) = 0;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
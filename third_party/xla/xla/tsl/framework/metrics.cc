@@ -16,8 +16,11 @@ limitations under the License.
 #include "xla/tsl/framework/metrics.h"
 
 #include <cstdint>
+#include <string>
 
+#include "absl/strings/string_view.h"
 #include "tsl/lib/monitoring/counter.h"
+#include "tsl/lib/monitoring/gauge.h"
 
 namespace tsl {
 namespace metrics {
@@ -28,6 +31,12 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_fragmentation = monitoring::Gauge<double, 1>::New(
+    "/tensorflow/core/bfc_allocator_fragmentation",
+    "The fragmentation of the BFC allocator at its last sampled allocation or "
+    "deallocation: 1 - largest free chunk / total free bytes.",
+    "allocator");
+
 }  // namespace
 
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
@@ -37,5 +46,11 @@ void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
   }
 }
 
+void UpdateBfcAllocatorFragmentation(absl::string_view allocator_name,
+                                     double fragmentation) {
+  bfc_allocator_fragmentation->GetCell(std::string(allocator_name))
+      ->Set(fragmentation);
+}
+
 }  // namespace metrics
 }  // namespace tsl
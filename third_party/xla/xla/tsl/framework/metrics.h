@@ -18,12 +18,19 @@ limitations under the License.
 
 #include <cstdint>
 
+#include "absl/strings/string_view.h"
+
 namespace tsl {
 namespace metrics {
 
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs);
 
+// Updates the last sampled fragmentation of the BFC allocator `allocator_name`,
+// i.e. 1 - largest free chunk / total free bytes.
+void UpdateBfcAllocatorFragmentation(absl::string_view allocator_name,
+                                     double fragmentation);
+
 }  // namespace metrics
 }  // namespace tsl
 
@@ -14,12 +14,47 @@ limitations under the License.
 ==============================================================================*/
 #include "xla/tsl/framework/serving_device_selector_policies.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <deque>
+#include <limits>
 
 #include "absl/strings/string_view.h"
 #include "xla/tsl/framework/serving_device_selector.h"
 
 namespace tsl {
+namespace {
+
+using ProgramQueue =
+    std::deque<ServingDeviceSelector::DeviceState::ProgramInfo>;
+
+// Programs whose execution time is unknown count as 1ns.
+int64_t EstimatedLoadNs(const ProgramQueue& programs) {
+  int64_t load_ns = 0;
+  for (const auto& program : programs) {
+    int64_t time_ns = 0;
+    if (program.execution_info != nullptr) {
+      time_ns =
+          program.execution_info->MaybeGetValidTime(program.prefetch_results);
+    }
+    load_ns += std::max<int64_t>(time_ns, 1);
+  }
+  return load_ns;
+}
+
+int64_t EstimatedLoadNs(const ServingDeviceSelector::DeviceState& state) {
+  int64_t load_ns = 0;
+  for (const ProgramQueue& programs : state.enqueued_programs) {
+    load_ns += EstimatedLoadNs(programs);
+  }
+  for (const ProgramQueue& programs : state.scheduled_programs) {
+    load_ns += EstimatedLoadNs(programs);
+  }
+  return load_ns;
+}
+
+}  // namespace
 
 int RoundRobinPolicy::SelectDevice(
     absl::string_view program_fingerprint,
@@ -28,4 +63,23 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+int LeastLoadedPolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int start = ordinal_.fetch_add(1, std::memory_order_relaxed) %
+                    num_devices;
+  int selected = start;
+  int64_t min_load_ns = std::numeric_limits<int64_t>::max();
+  for (int i = 0; i < num_devices; ++i) {
+    const int device = (start + i) % num_devices;
+    const int64_t load_ns = EstimatedLoadNs(device_states.states[device]);
+    if (load_ns < min_load_ns) {
+      min_load_ns = load_ns;
+      selected = device;
+    }
+  }
+  return selected;
+}
+
 }  // namespace tsl